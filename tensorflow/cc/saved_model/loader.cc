@@ -15,8 +15,12 @@ limitations under the License.
 
 #include "tensorflow/cc/saved_model/loader.h"
 
+#include <algorithm>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/fingerprinting.h"
@@ -29,6 +33,9 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op_def.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_slice.h"
+#include "tensorflow/core/graph/tensor_id.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/sampler.h"
@@ -43,7 +50,10 @@ limitations under the License.
 #include "tensorflow/core/protobuf/saver.pb.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
 namespace {
@@ -205,6 +215,212 @@ Status RunOnce(const RunOptions& run_options,
   return run_status;
 }
 
+// Returns the number of threads that read the variables of a SavedModel
+// directly from its checkpoint, or 0 to restore them by running the RestoreV2
+// ops of the restore graph.
+int64_t NumParallelRestoreThreads() {
+  int64_t num_threads;
+  Status s = ReadInt64FromEnvVar("TF_SAVED_MODEL_RESTORE_THREADS",
+                                 /*default_val=*/0, &num_threads);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring TF_SAVED_MODEL_RESTORE_THREADS: " << s;
+    return 0;
+  }
+  return std::max<int64_t>(num_threads, 0);
+}
+
+// Returns whether variables read directly from the checkpoint alias read-only
+// memory mappings of its data files where possible, instead of being copied
+// out of them.
+bool MapRestoredVariables() {
+  bool map_variables;
+  Status s = ReadBoolFromEnvVar("TF_SAVED_MODEL_MMAP_VARIABLES",
+                                /*default_val=*/false, &map_variables);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring TF_SAVED_MODEL_MMAP_VARIABLES: " << s;
+    return false;
+  }
+  return map_variables;
+}
+
+// A tensor that a RestoreV2 op of the restore graph reads from the checkpoint.
+struct RestoredTensor {
+  // The output of the RestoreV2 op that produces the tensor.
+  string output_name;
+  string tensor_name;
+  string shape_and_slice;
+  DataType dtype;
+  // Estimated size of the tensor, used to balance the reader threads.
+  int64_t size = 0;
+  Tensor value;
+};
+
+// Finds the RestoreV2 ops that `restore_op_name` depends on and the tensors
+// they read. Returns false if a RestoreV2 op does not read from
+// `filename_tensor_name` or its tensor names are not constants, in which case
+// the restore graph has to run as is.
+bool FindRestoredTensors(const GraphDef& graph_def,
+                         const StringPiece restore_op_name,
+                         const StringPiece filename_tensor_name,
+                         std::vector<RestoredTensor>* restored_tensors) {
+  std::unordered_map<string, const NodeDef*> nodes;
+  for (const NodeDef& node : graph_def.node()) {
+    nodes[node.name()] = &node;
+  }
+  const auto get_const = [&nodes](const string& input, Tensor* value) {
+    const auto it = nodes.find(string(ParseTensorName(input).node()));
+    if (it == nodes.end() || it->second->op() != "Const") return false;
+    const auto attr = it->second->attr().find("value");
+    return attr != it->second->attr().end() &&
+           value->FromProto(attr->second.tensor());
+  };
+  const TensorId filename_tensor = ParseTensorName(filename_tensor_name);
+
+  std::unordered_set<string> visited = {string(restore_op_name)};
+  std::vector<string> stack = {string(restore_op_name)};
+  while (!stack.empty()) {
+    const auto it = nodes.find(stack.back());
+    stack.pop_back();
+    if (it == nodes.end()) return false;
+    const NodeDef& node = *it->second;
+    if (node.op() == "RestoreV2") {
+      Tensor tensor_names;
+      Tensor shape_and_slices;
+      const auto dtypes = node.attr().find("dtypes");
+      if (node.input_size() != 3 ||
+          ParseTensorName(node.input(0)) != filename_tensor ||
+          !get_const(node.input(1), &tensor_names) ||
+          !get_const(node.input(2), &shape_and_slices) ||
+          tensor_names.dtype() != DT_STRING ||
+          shape_and_slices.dtype() != DT_STRING ||
+          dtypes == node.attr().end() ||
+          tensor_names.NumElements() != dtypes->second.list().type_size() ||
+          shape_and_slices.NumElements() != tensor_names.NumElements()) {
+        return false;
+      }
+      for (int i = 0; i < tensor_names.NumElements(); ++i) {
+        RestoredTensor restored_tensor;
+        restored_tensor.output_name = strings::StrCat(node.name(), ":", i);
+        restored_tensor.tensor_name = tensor_names.flat<tstring>()(i);
+        restored_tensor.shape_and_slice = shape_and_slices.flat<tstring>()(i);
+        restored_tensor.dtype = dtypes->second.list().type(i);
+        restored_tensors->push_back(std::move(restored_tensor));
+      }
+      continue;
+    }
+    for (const string& input : node.input()) {
+      string input_node(ParseTensorName(input).node());
+      if (visited.insert(input_node).second) {
+        stack.push_back(std::move(input_node));
+      }
+    }
+  }
+  return true;
+}
+
+// Reads `restored_tensor` from `reader` the way the RestoreV2 kernel does.
+Status ReadRestoredTensor(BundleReader* reader, bool map_read_only,
+                          RestoredTensor* restored_tensor) {
+  if (restored_tensor->shape_and_slice.empty() && map_read_only) {
+    return reader->LookupReadOnly(restored_tensor->tensor_name,
+                                  &restored_tensor->value);
+  }
+  DataType dtype;
+  TensorShape full_shape;
+  TF_RETURN_IF_ERROR(reader->LookupDtypeAndShape(restored_tensor->tensor_name,
+                                                 &dtype, &full_shape));
+  if (restored_tensor->shape_and_slice.empty()) {
+    restored_tensor->value = Tensor(dtype, full_shape);
+    return reader->Lookup(restored_tensor->tensor_name,
+                          &restored_tensor->value);
+  }
+  TensorShape parsed_full_shape;
+  TensorSlice parsed_slice;
+  TensorShape parsed_slice_shape;
+  TF_RETURN_IF_ERROR(checkpoint::ParseShapeAndSlice(
+      restored_tensor->shape_and_slice, &parsed_full_shape, &parsed_slice,
+      &parsed_slice_shape));
+  if (!full_shape.IsSameSize(parsed_full_shape)) {
+    return errors::InvalidArgument(
+        "tensor_name = ", restored_tensor->tensor_name,
+        "; shape in shape_and_slice spec ", parsed_full_shape.DebugString(),
+        " does not match the shape stored in checkpoint: ",
+        full_shape.DebugString());
+  }
+  restored_tensor->value = Tensor(dtype, parsed_slice_shape);
+  return reader->LookupSlice(restored_tensor->tensor_name, parsed_slice,
+                             &restored_tensor->value);
+}
+
+// Reads `restored_tensors` from the checkpoint at `variables_path` on
+// `num_threads` threads. Each thread has its own reader and reads a run of
+// tensors that is contiguous in the checkpoint, so that the reads of all
+// threads proceed concurrently. With TF_SAVED_MODEL_MMAP_VARIABLES set, the
+// tensors alias read-only mappings of the checkpoint where possible; the model
+// must then never write to its variables.
+Status ReadRestoredTensors(const string& variables_path, int64_t num_threads,
+                           std::vector<RestoredTensor>* restored_tensors) {
+  BundleReader reader(Env::Default(), variables_path);
+  TF_RETURN_IF_ERROR(reader.status());
+  int64_t total_size = 0;
+  for (RestoredTensor& restored_tensor : *restored_tensors) {
+    DataType dtype;
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(reader.LookupDtypeAndShape(restored_tensor.tensor_name,
+                                                  &dtype, &shape));
+    if (dtype != restored_tensor.dtype) {
+      return errors::InvalidArgument(
+          "tensor_name = ", restored_tensor.tensor_name, "; expected dtype ",
+          DataTypeString(restored_tensor.dtype),
+          " does not equal original dtype ", DataTypeString(dtype));
+    }
+    restored_tensor.size =
+        std::max<int64_t>(1, shape.num_elements() * DataTypeSize(dtype));
+    total_size += restored_tensor.size;
+  }
+  TF_RETURN_IF_ERROR(reader.SortForSequentialAccess<RestoredTensor>(
+      *restored_tensors,
+      [](const RestoredTensor& restored_tensor) {
+        return restored_tensor.tensor_name;
+      }));
+
+  // Split the tensors into runs of about the same size.
+  num_threads = std::min<int64_t>(num_threads, restored_tensors->size());
+  std::vector<size_t> run_starts = {0};
+  int64_t size = 0;
+  for (size_t i = 0; i < restored_tensors->size(); ++i) {
+    size += (*restored_tensors)[i].size;
+    if (size * num_threads >= total_size * run_starts.size() &&
+        i + 1 < restored_tensors->size()) {
+      run_starts.push_back(i + 1);
+    }
+  }
+  run_starts.push_back(restored_tensors->size());
+
+  const bool map_read_only = MapRestoredVariables();
+  std::vector<Status> statuses(run_starts.size() - 1);
+  {
+    thread::ThreadPool pool(Env::Default(), "restore_saved_model",
+                            std::max<int64_t>(num_threads, 1));
+    for (size_t run = 0; run + 1 < run_starts.size(); ++run) {
+      pool.Schedule([&, run]() {
+        BundleReader run_reader(Env::Default(), variables_path);
+        statuses[run] = run_reader.status();
+        for (size_t i = run_starts[run];
+             statuses[run].ok() && i < run_starts[run + 1]; ++i) {
+          statuses[run] =
+              ReadRestoredTensor(&run_reader, map_read_only,
+                                 &(*restored_tensors)[i]);
+        }
+      });
+    }
+  }
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return OkStatus();
+}
+
 // RunInitOp will return OK if the initialization op was run successfully.
 // An empty init_op_name indicates that there are no init ops to run.
 Status RunInitOp(const RunOptions& run_options, const string& export_dir,
@@ -224,7 +440,7 @@ Status RunInitOp(const RunOptions& run_options, const string& export_dir,
 }
 
 Status RunRestore(const RunOptions& run_options, const string& export_dir,
-                  const StringPiece restore_op_name,
+                  const GraphDef& graph_def, const StringPiece restore_op_name,
                   const StringPiece variable_filename_const_op_name,
                   const std::vector<AssetFileDef>& asset_file_defs,
                   Session* session) {
@@ -258,6 +474,26 @@ Status RunRestore(const RunOptions& run_options, const string& export_dir,
 
   AddAssetsTensorsToInputs(export_dir, asset_file_defs, &inputs);
 
+  // Feeding every output of the RestoreV2 ops prunes them from the restore
+  // graph, which is then left to assign the fed values to the variables.
+  const int64_t num_threads = NumParallelRestoreThreads();
+  std::vector<RestoredTensor> restored_tensors;
+  if (num_threads > 0) {
+    if (FindRestoredTensors(graph_def, restore_op_name,
+                            variable_filename_const_op_name,
+                            &restored_tensors)) {
+      TF_RETURN_IF_ERROR(ReadRestoredTensors(variables_path, num_threads,
+                                             &restored_tensors));
+      for (RestoredTensor& restored_tensor : restored_tensors) {
+        inputs.push_back({std::move(restored_tensor.output_name),
+                          std::move(restored_tensor.value)});
+      }
+    } else {
+      LOG(INFO) << "The restore graph is not supported by parallel restore; "
+                   "running it as is.";
+    }
+  }
+
   RunMetadata run_metadata;
   return RunOnce(run_options, inputs, {}, {string(restore_op_name)},
                  nullptr /* outputs */, &run_metadata, session);
@@ -431,9 +667,235 @@ class LiteSessionWrapper : public Session {
     return wrapped_->ReleaseCallable(handle);
   }
 
+ protected:
+  Session* wrapped() const { return wrapped_.get(); }
+
  private:
   const std::unique_ptr<Session> wrapped_;
 };
+
+// Describes how the restore graph of a SavedModel restores each variable.
+struct RestoreGraphIndex {
+  // The input nodes of every node of the graph.
+  std::unordered_map<string, std::vector<string>> node_inputs;
+  // The nodes of the restore graph that restore each variable (e.g. Assign or
+  // AssignVariableOp), keyed by the variable node.
+  std::unordered_map<string, std::vector<string>> restore_nodes;
+  // The RestoreV2 outputs that each restore node depends on.
+  std::unordered_map<string, std::vector<string>> restore_node_outputs;
+  // The tensors read by the RestoreV2 ops, keyed by output name.
+  std::unordered_map<string, RestoredTensor> restored_tensors;
+};
+
+// Builds `index` for the restore graph of `meta_graph`. Returns false if the
+// restore graph cannot be split per variable.
+bool BuildRestoreGraphIndex(const MetaGraphDef& meta_graph,
+                            RestoreGraphIndex* index) {
+  const GraphDef& graph_def = meta_graph.graph_def();
+  const SaverDef& saver_def = meta_graph.saver_def();
+  std::vector<RestoredTensor> restored_tensors;
+  if (!FindRestoredTensors(graph_def, saver_def.restore_op_name(),
+                           saver_def.filename_tensor_name(),
+                           &restored_tensors)) {
+    return false;
+  }
+  for (RestoredTensor& restored_tensor : restored_tensors) {
+    string output_name = restored_tensor.output_name;
+    index->restored_tensors.emplace(std::move(output_name),
+                                    std::move(restored_tensor));
+  }
+  std::unordered_map<string, const NodeDef*> nodes;
+  for (const NodeDef& node : graph_def.node()) {
+    nodes[node.name()] = &node;
+    std::vector<string>& inputs = index->node_inputs[node.name()];
+    for (const string& input : node.input()) {
+      inputs.emplace_back(ParseTensorName(input).node());
+    }
+  }
+
+  // The restore nodes are the inputs of the restore op, looking through the
+  // NoOps that group them. Each one restores the state of its first input.
+  std::vector<const NodeDef*> restore_nodes;
+  std::unordered_set<string> visited = {saver_def.restore_op_name()};
+  std::vector<string> stack = {saver_def.restore_op_name()};
+  while (!stack.empty()) {
+    const auto it = nodes.find(stack.back());
+    stack.pop_back();
+    if (it == nodes.end()) return false;
+    if (it->second->op() != "NoOp") {
+      restore_nodes.push_back(it->second);
+      continue;
+    }
+    for (const string& input : it->second->input()) {
+      string input_node(ParseTensorName(input).node());
+      if (visited.insert(input_node).second) {
+        stack.push_back(std::move(input_node));
+      }
+    }
+  }
+  for (const NodeDef* restore_node : restore_nodes) {
+    if (restore_node->input_size() == 0) return false;
+    const TensorId state = ParseTensorName(restore_node->input(0));
+    if (state.node() == restore_node->name() ||
+        nodes.find(string(state.node())) == nodes.end()) {
+      return false;
+    }
+    index->restore_nodes[string(state.node())].push_back(
+        restore_node->name());
+    // Find the RestoreV2 outputs that the restored value is computed from.
+    std::vector<string>& outputs =
+        index->restore_node_outputs[restore_node->name()];
+    std::vector<string> inputs(restore_node->input().begin() + 1,
+                               restore_node->input().end());
+    std::unordered_set<string> visited_inputs;
+    while (!inputs.empty()) {
+      const TensorId input = ParseTensorName(inputs.back());
+      inputs.pop_back();
+      if (input.index() < 0) continue;
+      const auto it = nodes.find(string(input.node()));
+      if (it == nodes.end()) return false;
+      if (it->second->op() == "RestoreV2") {
+        outputs.push_back(input.ToString());
+        if (index->restored_tensors.find(outputs.back()) ==
+            index->restored_tensors.end()) {
+          return false;
+        }
+      } else if (visited_inputs.insert(it->second->name()).second) {
+        inputs.insert(inputs.end(), it->second->input().begin(),
+                      it->second->input().end());
+      }
+    }
+  }
+  return true;
+}
+
+// Session that restores each variable of a SavedModel the first time a step
+// needs it. A step is checked once per distinct set of fetches and targets.
+class LazyRestoreSession : public LiteSessionWrapper {
+ public:
+  LazyRestoreSession(std::unique_ptr<Session> wrapped,
+                     const RunOptions& run_options,
+                     const string& variables_path,
+                     const string& filename_tensor_name,
+                     std::vector<std::pair<string, Tensor>> asset_inputs,
+                     std::unique_ptr<RestoreGraphIndex> index)
+      : LiteSessionWrapper(std::move(wrapped)),
+        run_options_(run_options),
+        variables_path_(variables_path),
+        index_(std::move(index)) {
+    restore_inputs_.push_back(
+        {filename_tensor_name, CreateStringTensor(variables_path)});
+    restore_inputs_.insert(restore_inputs_.end(), asset_inputs.begin(),
+                           asset_inputs.end());
+  }
+
+  Status Run(const std::vector<std::pair<string, Tensor>>& inputs,
+             const std::vector<string>& output_tensor_names,
+             const std::vector<string>& target_node_names,
+             std::vector<Tensor>* outputs) override {
+    TF_RETURN_IF_ERROR(RestoreVariablesFor(output_tensor_names,
+                                           target_node_names));
+    return LiteSessionWrapper::Run(inputs, output_tensor_names,
+                                   target_node_names, outputs);
+  }
+
+  Status Run(const RunOptions& run_options,
+             const std::vector<std::pair<string, Tensor>>& inputs,
+             const std::vector<string>& output_tensor_names,
+             const std::vector<string>& target_node_names,
+             std::vector<Tensor>* outputs, RunMetadata* run_metadata) override {
+    TF_RETURN_IF_ERROR(RestoreVariablesFor(output_tensor_names,
+                                           target_node_names));
+    return LiteSessionWrapper::Run(run_options, inputs, output_tensor_names,
+                                   target_node_names, outputs, run_metadata);
+  }
+
+  Status MakeCallable(const CallableOptions& callable_options,
+                      CallableHandle* out_handle) override {
+    TF_RETURN_IF_ERROR(RestoreVariablesFor(
+        {callable_options.fetch().begin(), callable_options.fetch().end()},
+        {callable_options.target().begin(), callable_options.target().end()}));
+    return LiteSessionWrapper::MakeCallable(callable_options, out_handle);
+  }
+
+ private:
+  // Restores the variables that the step with `fetches` and `targets` may
+  // read and that are not restored yet.
+  Status RestoreVariablesFor(const std::vector<string>& fetches,
+                             const std::vector<string>& targets) {
+    mutex_lock l(mu_);
+    if (index_->restore_nodes.empty()) return OkStatus();
+    string key = absl::StrJoin(fetches, ",");
+    absl::StrAppend(&key, ";", absl::StrJoin(targets, ","));
+    if (checked_steps_.find(key) != checked_steps_.end()) return OkStatus();
+
+    std::vector<string> stack;
+    for (const string& fetch : fetches) {
+      stack.emplace_back(ParseTensorName(fetch).node());
+    }
+    stack.insert(stack.end(), targets.begin(), targets.end());
+    std::unordered_set<string> visited(stack.begin(), stack.end());
+    std::vector<string> variables;
+    while (!stack.empty()) {
+      const string node = std::move(stack.back());
+      stack.pop_back();
+      if (index_->restore_nodes.find(node) != index_->restore_nodes.end()) {
+        variables.push_back(node);
+      }
+      const auto it = index_->node_inputs.find(node);
+      if (it == index_->node_inputs.end()) continue;
+      for (const string& input : it->second) {
+        if (visited.insert(input).second) stack.push_back(input);
+      }
+    }
+
+    if (!variables.empty()) {
+      std::vector<string> restore_nodes;
+      std::unordered_set<string> outputs;
+      std::vector<RestoredTensor> restored_tensors;
+      for (const string& variable : variables) {
+        for (const string& restore_node : index_->restore_nodes[variable]) {
+          restore_nodes.push_back(restore_node);
+          for (const string& output :
+               index_->restore_node_outputs[restore_node]) {
+            if (outputs.insert(output).second) {
+              restored_tensors.push_back(index_->restored_tensors[output]);
+            }
+          }
+        }
+      }
+      VLOG(1) << "Restoring " << variables.size() << " variables from "
+              << variables_path_;
+      TF_RETURN_IF_ERROR(ReadRestoredTensors(
+          variables_path_, std::max<int64_t>(NumParallelRestoreThreads(), 1),
+          &restored_tensors));
+      std::vector<std::pair<string, Tensor>> inputs = restore_inputs_;
+      for (RestoredTensor& restored_tensor : restored_tensors) {
+        inputs.push_back({std::move(restored_tensor.output_name),
+                          std::move(restored_tensor.value)});
+      }
+      RunMetadata run_metadata;
+      TF_RETURN_IF_ERROR(RunOnce(run_options_, inputs, {}, restore_nodes,
+                                 /*outputs=*/nullptr, &run_metadata,
+                                 wrapped()));
+      for (const string& variable : variables) {
+        index_->restore_nodes.erase(variable);
+      }
+    }
+    checked_steps_.insert(std::move(key));
+    return OkStatus();
+  }
+
+  const RunOptions run_options_;
+  const string variables_path_;
+  // The filename and asset feeds of the restore graph.
+  std::vector<std::pair<string, Tensor>> restore_inputs_;
+
+  mutex mu_;
+  const std::unique_ptr<RestoreGraphIndex> index_ TF_GUARDED_BY(mu_);
+  // The fetches and targets of the steps whose variables are restored.
+  std::unordered_set<string> checked_steps_ TF_GUARDED_BY(mu_);
+};
 }  // namespace
 
 Status RestoreSession(const RunOptions& run_options,
@@ -444,6 +906,7 @@ Status RestoreSession(const RunOptions& run_options,
   TF_RETURN_IF_ERROR(internal::GetAssetFileDefs(meta_graph, &asset_file_defs));
   if (meta_graph.has_saver_def()) {
     TF_RETURN_IF_ERROR(RunRestore(run_options, export_dir,
+                                  meta_graph.graph_def(),
                                   meta_graph.saver_def().restore_op_name(),
                                   meta_graph.saver_def().filename_tensor_name(),
                                   asset_file_defs, session->get()));
@@ -467,11 +930,10 @@ Status RestoreSession(const RunOptions& run_options,
   return OkStatus();
 }
 
-Status LoadSavedModel(const SessionOptions& session_options,
-                      const RunOptions& run_options, const string& export_dir,
-                      const std::unordered_set<string>& tags,
-                      SavedModelBundleLite* const bundle) {
-  SavedModelBundle legacy_bundle;
+namespace {
+// Returns `session_options` adjusted for the session of a
+// SavedModelBundleLite.
+SessionOptions LiteSessionOptions(const SessionOptions& session_options) {
   SessionOptions rewritten_options(session_options);
   // We disallow calls to Session::Extend() on the returned session, so we can
   // reduce memory consumption by not storing the original GraphDef.
@@ -482,6 +944,16 @@ Status LoadSavedModel(const SessionOptions& session_options,
   // not storing the rewritten subgraph for each signature.
   rewritten_options.config.mutable_experimental()
       ->set_disable_output_partition_graphs(true);
+  return rewritten_options;
+}
+}  // namespace
+
+Status LoadSavedModel(const SessionOptions& session_options,
+                      const RunOptions& run_options, const string& export_dir,
+                      const std::unordered_set<string>& tags,
+                      SavedModelBundleLite* const bundle) {
+  SavedModelBundle legacy_bundle;
+  SessionOptions rewritten_options = LiteSessionOptions(session_options);
   // TODO(mrry): Consider specializing the session creation to reduce peak
   // RAM consumption by using `Session::Create(GraphDef&&)`.
   TF_RETURN_IF_ERROR(LoadSavedModel(rewritten_options, run_options, export_dir,
@@ -492,6 +964,65 @@ Status LoadSavedModel(const SessionOptions& session_options,
   return OkStatus();
 }
 
+Status LoadSavedModelLazily(const SessionOptions& session_options,
+                            const RunOptions& run_options,
+                            const string& export_dir,
+                            const std::unordered_set<string>& tags,
+                            SavedModelBundleLite* const bundle) {
+  metrics::SavedModelReadApi(kCCLoadLabel).IncrementBy(1);
+  const uint64 start_microseconds = Env::Default()->NowMicros();
+  MetaGraphDef meta_graph;
+  TF_RETURN_IF_ERROR(
+      ReadMetaGraphDefFromSavedModel(export_dir, tags, &meta_graph));
+  std::unique_ptr<Session> session;
+  TF_RETURN_IF_ERROR(LoadMetagraphIntoSession(
+      LiteSessionOptions(session_options), meta_graph, &session));
+
+  const string variables_directory =
+      io::JoinPath(export_dir, kSavedModelVariablesDirectory);
+  const string variables_index_path = io::JoinPath(
+      variables_directory, MetaFilename(kSavedModelVariablesFilename));
+  TF_ASSIGN_OR_RETURN(
+      bool variables_index_exists,
+      internal::FileExists(Env::Default(), variables_index_path));
+  auto index = std::make_unique<RestoreGraphIndex>();
+  if (!meta_graph.has_saver_def() || !variables_index_exists ||
+      !BuildRestoreGraphIndex(meta_graph, index.get())) {
+    LOG(INFO) << "Variables of SavedModel at " << export_dir
+              << " cannot be restored lazily; restoring all of them.";
+    TF_RETURN_IF_ERROR(
+        RestoreSession(run_options, meta_graph, export_dir, &session));
+    *bundle = SavedModelBundleLite(
+        std::make_unique<LiteSessionWrapper>(std::move(session)),
+        std::move(*meta_graph.mutable_signature_def()));
+    return OkStatus();
+  }
+
+  std::vector<AssetFileDef> asset_file_defs;
+  TF_RETURN_IF_ERROR(internal::GetAssetFileDefs(meta_graph, &asset_file_defs));
+  std::vector<std::pair<string, Tensor>> asset_inputs;
+  AddAssetsTensorsToInputs(export_dir, asset_file_defs, &asset_inputs);
+  auto lazy_session = std::make_unique<LazyRestoreSession>(
+      std::move(session), run_options,
+      io::JoinPath(variables_directory, kSavedModelVariablesFilename),
+      meta_graph.saver_def().filename_tensor_name(), std::move(asset_inputs),
+      std::move(index));
+  // The init op runs through the lazy session, which first restores the
+  // variables that it reads.
+  string init_op_name;
+  TF_RETURN_IF_ERROR(
+      internal::GetInitOp(export_dir, meta_graph, &init_op_name));
+  TF_RETURN_IF_ERROR(RunInitOp(run_options, export_dir, meta_graph,
+                               asset_file_defs, lazy_session.get(),
+                               init_op_name));
+  *bundle = SavedModelBundleLite(
+      std::move(lazy_session), std::move(*meta_graph.mutable_signature_def()));
+  LOG(INFO) << "SavedModel lazy load for tags { " << absl::StrJoin(tags, " ")
+            << " } took " << GetLatencyMicroseconds(start_microseconds)
+            << " microseconds.";
+  return OkStatus();
+}
+
 bool MaybeSavedModelDirectory(const string& export_dir) {
   const string saved_model_pb_path =
       io::JoinPath(export_dir, kSavedModelFilenamePb);
@@ -135,6 +135,18 @@ Status LoadSavedModel(const SessionOptions& session_options,
                       const std::unordered_set<string>& tags,
                       SavedModelBundleLite* const bundle);
 
+/// Like the SavedModelBundleLite overload of LoadSavedModel, but restores
+/// each variable the first time a Run() or MakeCallable() on the session of
+/// *bundle needs it, so that load time and memory grow with the variables the
+/// used signatures read. Variables read by the init op are restored while
+/// loading. SavedModels whose restore graph cannot be split per variable are
+/// restored in full.
+Status LoadSavedModelLazily(const SessionOptions& session_options,
+                            const RunOptions& run_options,
+                            const string& export_dir,
+                            const std::unordered_set<string>& tags,
+                            SavedModelBundleLite* const bundle);
+
 /// Checks whether the provided directory could contain a SavedModel. Note that
 /// the method does not load any data by itself. If the method returns `false`,
 /// the export directory definitely does not contain a SavedModel. If the method
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <stdlib.h>
+
 #include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/loader.h"
 #include "tensorflow/cc/saved_model/metrics.h"
@@ -141,6 +143,36 @@ TEST_F(LoaderTest, TagMatch) {
   CheckSavedModelBundle(export_dir, bundle);
 }
 
+TEST_F(LoaderTest, ParallelRestore) {
+  setenv("TF_SAVED_MODEL_RESTORE_THREADS", "4", /*overwrite=*/1);
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &bundle));
+  unsetenv("TF_SAVED_MODEL_RESTORE_THREADS");
+  CheckSavedModelBundle(export_dir, bundle);
+}
+
+TEST_F(LoaderTest, MappedParallelRestore) {
+  setenv("TF_SAVED_MODEL_RESTORE_THREADS", "2", /*overwrite=*/1);
+  setenv("TF_SAVED_MODEL_MMAP_VARIABLES", "true", /*overwrite=*/1);
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &bundle));
+  unsetenv("TF_SAVED_MODEL_MMAP_VARIABLES");
+  unsetenv("TF_SAVED_MODEL_RESTORE_THREADS");
+  CheckSavedModelBundle(export_dir, bundle);
+}
+
 TEST_F(LoaderTest, ReadMetaGraphFromSavedModel) {
   SavedModelBundle bundle;
   SessionOptions session_options;
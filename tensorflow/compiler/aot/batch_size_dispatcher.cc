@@ -0,0 +1,56 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/aot/batch_size_dispatcher.h"
+
+#include <memory>
+#include <utility>
+
+namespace tensorflow {
+namespace tfcompile {
+
+void BatchSizeDispatcher::Add(
+    int64_t batch_size, std::unique_ptr<XlaCompiledCpuFunction> function) {
+  if (pool_ != nullptr) {
+    function->set_thread_pool(pool_);
+  }
+  functions_[batch_size] = std::move(function);
+}
+
+XlaCompiledCpuFunction* BatchSizeDispatcher::Select(
+    int64_t batch_size, int64_t* compiled_batch_size) const {
+  auto it = functions_.lower_bound(batch_size);
+  if (it == functions_.end()) {
+    return nullptr;
+  }
+  if (compiled_batch_size != nullptr) {
+    *compiled_batch_size = it->first;
+  }
+  return it->second.get();
+}
+
+int64_t BatchSizeDispatcher::max_batch_size() const {
+  return functions_.empty() ? 0 : functions_.rbegin()->first;
+}
+
+void BatchSizeDispatcher::set_thread_pool(const Eigen::ThreadPoolDevice* pool) {
+  pool_ = pool;
+  for (auto& [batch_size, function] : functions_) {
+    function->set_thread_pool(pool);
+  }
+}
+
+}  // namespace tfcompile
+}  // namespace tensorflow
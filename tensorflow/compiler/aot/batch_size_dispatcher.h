@@ -0,0 +1,75 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_AOT_BATCH_SIZE_DISPATCHER_H_
+#define TENSORFLOW_COMPILER_AOT_BATCH_SIZE_DISPATCHER_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+
+#include "tensorflow/compiler/tf2xla/xla_compiled_cpu_function.h"
+
+namespace tensorflow {
+namespace tfcompile {
+
+// Picks between the batch-size-specialized variants of a computation generated
+// by tf_library(batch_sizes = [...]). Each variant is a separate generated
+// class, compiled with the leading dimension of all feeds set to its batch
+// size. Example:
+//
+//   BatchSizeDispatcher dispatcher;
+//   dispatcher.Add(1, std::make_unique<MyCompBatch1>());
+//   dispatcher.Add(8, std::make_unique<MyCompBatch8>());
+//   dispatcher.set_thread_pool(&device);
+//
+//   int64_t padded_batch_size;
+//   XlaCompiledCpuFunction* fn = dispatcher.Select(5, &padded_batch_size);
+//   // padded_batch_size == 8; fill fn->arg_data(i), padding up to 8 rows.
+//   fn->Run();
+class BatchSizeDispatcher {
+ public:
+  BatchSizeDispatcher() = default;
+  BatchSizeDispatcher(const BatchSizeDispatcher&) = delete;
+  BatchSizeDispatcher& operator=(const BatchSizeDispatcher&) = delete;
+
+  // Adds `function`, compiled for a leading feed dimension of `batch_size`.
+  // Replaces any function previously added for the same batch size.
+  void Add(int64_t batch_size,
+           std::unique_ptr<XlaCompiledCpuFunction> function);
+
+  // Returns the function compiled for the smallest batch size that is at
+  // least `batch_size`, and stores that batch size in `compiled_batch_size`
+  // if it is not null. Returns nullptr if `batch_size` is larger than every
+  // compiled batch size; callers then have to split the batch.
+  XlaCompiledCpuFunction* Select(int64_t batch_size,
+                                 int64_t* compiled_batch_size = nullptr) const;
+
+  // Returns the largest compiled batch size, or 0 if no function was added.
+  int64_t max_batch_size() const;
+
+  // Sets the intra-op thread pool on all added functions, and on functions
+  // added afterwards.
+  void set_thread_pool(const Eigen::ThreadPoolDevice* pool);
+
+ private:
+  std::map<int64_t, std::unique_ptr<XlaCompiledCpuFunction>> functions_;
+  const Eigen::ThreadPoolDevice* pool_ = nullptr;
+};
+
+}  // namespace tfcompile
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_AOT_BATCH_SIZE_DISPATCHER_H_
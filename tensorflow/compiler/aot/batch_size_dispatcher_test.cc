@@ -0,0 +1,71 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/aot/batch_size_dispatcher.h"
+
+#include <memory>
+
+#include "tensorflow/compiler/aot/test_graph_tfadd_batch1.h"
+#include "tensorflow/compiler/aot/test_graph_tfadd_batch4.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace tfcompile {
+namespace {
+
+TEST(BatchSizeDispatcherTest, SelectsSmallestFittingBatchSize) {
+  BatchSizeDispatcher dispatcher;
+  EXPECT_EQ(dispatcher.Select(1), nullptr);
+  EXPECT_EQ(dispatcher.max_batch_size(), 0);
+
+  dispatcher.Add(1, std::make_unique<AddCompBatch1>());
+  dispatcher.Add(4, std::make_unique<AddCompBatch4>());
+  EXPECT_EQ(dispatcher.max_batch_size(), 4);
+
+  int64_t compiled_batch_size = 0;
+  EXPECT_NE(dispatcher.Select(1, &compiled_batch_size), nullptr);
+  EXPECT_EQ(compiled_batch_size, 1);
+  EXPECT_NE(dispatcher.Select(2, &compiled_batch_size), nullptr);
+  EXPECT_EQ(compiled_batch_size, 4);
+  EXPECT_NE(dispatcher.Select(4, &compiled_batch_size), nullptr);
+  EXPECT_EQ(compiled_batch_size, 4);
+  EXPECT_EQ(dispatcher.Select(5, &compiled_batch_size), nullptr);
+}
+
+TEST(BatchSizeDispatcherTest, RunsSelectedFunction) {
+  BatchSizeDispatcher dispatcher;
+  dispatcher.Add(1, std::make_unique<AddCompBatch1>());
+  dispatcher.Add(4, std::make_unique<AddCompBatch4>());
+
+  int64_t compiled_batch_size = 0;
+  XlaCompiledCpuFunction* add = dispatcher.Select(3, &compiled_batch_size);
+  ASSERT_NE(add, nullptr);
+  ASSERT_EQ(compiled_batch_size, 4);
+  int32* x = static_cast<int32*>(add->arg_data(0));
+  int32* y = static_cast<int32*>(add->arg_data(1));
+  for (int i = 0; i < compiled_batch_size; ++i) {
+    x[i] = i;
+    y[i] = 10 * i;
+  }
+  ASSERT_TRUE(add->Run());
+  const int32* sum = static_cast<const int32*>(add->result_data(0));
+  for (int i = 0; i < compiled_batch_size; ++i) {
+    EXPECT_EQ(sum[i], 11 * i);
+  }
+}
+
+}  // namespace
+}  // namespace tfcompile
+}  // namespace tensorflow
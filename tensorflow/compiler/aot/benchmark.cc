@@ -23,6 +23,9 @@ limitations under the License.
 #include <sys/time.h>
 
 #include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <string>
 #include <utility>
@@ -44,6 +47,49 @@ static double NowMicros() {
   return static_cast<uint64>(tv.tv_sec) * 1000000 + tv.tv_usec;
 }
 
+// Parses `arg` as --<name>=<int64>, storing the value in `value`. Returns false
+// if `arg` is not a flag called `name`, and sets `ok` to false if the value is
+// malformed.
+static bool ParseInt64Flag(const char* arg, const char* name, int64_t* value,
+                           bool* ok) {
+  const size_t name_len = strlen(name);
+  if (strncmp(arg, "--", 2) != 0 || strncmp(arg + 2, name, name_len) != 0 ||
+      arg[2 + name_len] != '=') {
+    return false;
+  }
+  const char* begin = arg + 3 + name_len;
+  char* end = nullptr;
+  const long long parsed = strtoll(begin, &end, 10);  // NOLINT
+  if (end == begin || *end != '\0') {
+    *ok = false;
+  } else {
+    *value = parsed;
+  }
+  return true;
+}
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  bool ok = true;
+  for (int i = 1; i < argc; ++i) {
+    int64_t num_threads = options->num_threads;
+    if (ParseInt64Flag(argv[i], "max_iters", &options->max_iters, &ok) ||
+        ParseInt64Flag(argv[i], "max_micros", &options->max_micros, &ok)) {
+      continue;
+    }
+    if (ParseInt64Flag(argv[i], "num_threads", &num_threads, &ok)) {
+      if (num_threads <= 0) {
+        ok = false;
+      } else {
+        options->num_threads = num_threads;
+      }
+      continue;
+    }
+    fprintf(stderr, "Unknown flag: %s\n", argv[i]);
+    ok = false;
+  }
+  return ok;
+}
+
 void DumpStatsToStdout(const Stats& stats) {
   // Compute stats.
   std::vector<int64_t> sorted_us(stats.per_iter_us);
@@ -107,6 +153,11 @@ void DumpStatsToStdout(const Stats& stats) {
     printf("  %-*s %*.3f us\n", max_label_size, g.first.c_str(), max_digits + 4,
            g.second);
   }
+  if (stats.total_us > 0) {
+    printf("Throughput: %.3f items/s (%lld items per iteration)\n",
+           1e6 * count_us * stats.items_per_iter / stats.total_us,
+           static_cast<long long>(stats.items_per_iter));  // NOLINT
+  }
 }
 
 void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats) {
@@ -116,6 +167,7 @@ void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats) {
                              : options.max_micros;
   // NOLINTNEXTLINE
   printf("Running benchmark for %lld us\n", static_cast<long long>(max_us));
+  stats->items_per_iter = options.items_per_iter;
   const int64_t start_us = NowMicros();
   int64_t iters = 0;
   while (true) {
@@ -42,14 +42,28 @@ struct Options {
 
   int64_t max_iters = 0;   // Maximum iterations to run, ignored if <= 0.
   int64_t max_micros = 0;  // Maximum microseconds to run, ignored if <= 0.
+
+  // Number of items (e.g. the batch size) processed per iteration, used to
+  // report throughput.
+  int64_t items_per_iter = 1;
+
+  // Size of the thread pool the benchmarked function should run on. Not used
+  // by Benchmark itself; the caller creates the pool.
+  int num_threads = 1;
 };
 
+// ParseOptions overrides fields of `options` from command line flags of the
+// form --max_iters=N, --max_micros=N and --num_threads=N. Returns false on
+// unknown or malformed flags.
+bool ParseOptions(int argc, char** argv, Options* options);
+
 // Stats holds statistics collected during benchmarking.
 struct Stats {
   std::vector<int64_t> per_iter_us;  // Per-iteration deltas in us.
   int64_t total_us;                  // Total time in us.
+  int64_t items_per_iter;            // Copied from Options.
 
-  Stats() : total_us(0) { per_iter_us.reserve(5000); }
+  Stats() : total_us(0), items_per_iter(1) { per_iter_us.reserve(5000); }
 };
 
 // DumpStatsToStdout printfs to stdout stats in a multi-line human-friendly
@@ -40,6 +40,34 @@ TEST(Benchmark, Benchmark) {
   EXPECT_EQ(stats5.per_iter_us.size(), 5);
 }
 
+TEST(Benchmark, ItemsPerIter) {
+  AddComp add;
+
+  Options options;
+  options.max_iters = 3;
+  options.items_per_iter = 8;
+  Stats stats;
+  Benchmark(options, [&] { add.Run(); }, &stats);
+  EXPECT_EQ(stats.per_iter_us.size(), 3);
+  EXPECT_EQ(stats.items_per_iter, 8);
+}
+
+TEST(Benchmark, ParseOptions) {
+  const char* argv[] = {"benchmark", "--max_iters=10", "--num_threads=4"};
+  Options options;
+  EXPECT_TRUE(ParseOptions(3, const_cast<char**>(argv), &options));
+  EXPECT_EQ(options.max_iters, 10);
+  EXPECT_EQ(options.max_micros, 0);
+  EXPECT_EQ(options.num_threads, 4);
+
+  const char* bad_value[] = {"benchmark", "--num_threads=x"};
+  EXPECT_FALSE(ParseOptions(2, const_cast<char**>(bad_value), &options));
+  const char* bad_threads[] = {"benchmark", "--num_threads=0"};
+  EXPECT_FALSE(ParseOptions(2, const_cast<char**>(bad_threads), &options));
+  const char* unknown[] = {"benchmark", "--max_seconds=1"};
+  EXPECT_FALSE(ParseOptions(2, const_cast<char**>(unknown), &options));
+}
+
 }  // namespace
 }  // namespace benchmark
 }  // namespace tfcompile
@@ -159,6 +159,7 @@ Status CompileGraph(GraphDef graph_def, const tf2xla::Config& config,
       flags.entry_point,
       xla::cpu::CpuAotCompilationOptions::RelocationModel::BigPic);
   aot_opts.set_use_mlir_hlo_lowering(use_mlir_hlo_lowering);
+  aot_opts.set_max_parallelism(flags.parallelism);
 
   if (flags.sanitize_dataflow) {
     aot_opts.set_sanitize_dataflow(flags.sanitize_dataflow);
@@ -177,6 +178,20 @@ static Status ReadProtoFile(const string& fname, protobuf::Message* proto) {
   }
 }
 
+// Overrides the leading dimension of every feed in `config` with
+// `batch_size`.
+static Status SetFeedBatchSize(int64_t batch_size, tf2xla::Config* config) {
+  for (tf2xla::Feed& feed : *config->mutable_feed()) {
+    if (feed.shape().dim_size() == 0) {
+      return errors::InvalidArgument(
+          "--batch_size requires all feeds to have rank >= 1, but feed ",
+          feed.id().node_name(), " is a scalar");
+    }
+    feed.mutable_shape()->mutable_dim(0)->set_size(batch_size);
+  }
+  return OkStatus();
+}
+
 static absl::once_flag targets_init;
 
 static void InitializeTargets() {
@@ -238,6 +253,9 @@ Status Main(const MainFlags& flags) {
     return errors::InvalidArgument("Must specify --config");
   }
   TF_RETURN_IF_ERROR(ReadProtoFile(flags.config, &config));
+  if (flags.batch_size > 0) {
+    TF_RETURN_IF_ERROR(SetFeedBatchSize(flags.batch_size, &config));
+  }
   TF_RETURN_IF_ERROR(ValidateConfig(config));
   if (flags.dump_fetch_nodes) {
     std::set<string> nodes;
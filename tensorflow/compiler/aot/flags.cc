@@ -80,6 +80,15 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
       {"experimental_quantize", &flags->experimental_quantize,
        "If set, quantization passes will run and dump the result before HLO "
        "code generation."},
+      {"parallelism", &flags->parallelism,
+       "If greater than 1, parallel loops are partitioned into up to this "
+       "many tasks, which run on the thread pool passed to set_thread_pool() "
+       "on the generated class.  Otherwise the generated code is "
+       "single-threaded."},
+      {"batch_size", &flags->batch_size,
+       "If greater than 0, overrides the leading dimension of every feed "
+       "shape in the config, to compile a batch-size-specialized variant of "
+       "the same config.  All feeds must have rank >= 1."},
       {"sanitize_dataflow", &flags->sanitize_dataflow,
        "Enable DataFlow Sanitizer pass."},
       {"sanitize_abilists_dataflow", &flags->sanitize_abilists_dataflow,
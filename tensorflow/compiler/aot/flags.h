@@ -43,6 +43,8 @@ struct MainFlags {
   string out_session_module;
   string mlir_components;
   bool experimental_quantize = false;
+  int32 parallelism = 0;
+  int32 batch_size = 0;
 
   // Sanitizer pass options
   bool sanitize_dataflow = false;
@@ -151,7 +151,8 @@ def _tf_library(
         mlir_components = "None",
         deps = None,
         tags = [],
-        copts = []):
+        copts = [],
+        batch_size = 0):
     if not cpp_class:
         fail("cpp_class must be specified")
 
@@ -232,6 +233,8 @@ def _tf_library(
             "'" + arg.replace("'", "'\\''") + "'"
             for arg in (tfcompile_flags or [])
         ])
+    if batch_size:
+        flags += " --batch_size=" + str(batch_size)
 
     # Do this before we append the `select` into `flags`, because doing so
     # transforms `flags` into a variable of type `select`, and we can't call
@@ -317,6 +320,7 @@ def _tf_library(
             # needed.
             "//tensorflow/compiler/xla/service/cpu:runtime_conv2d",
             "//tensorflow/compiler/xla/service/cpu:runtime_custom_call_status",
+            "//tensorflow/compiler/xla/service/cpu:runtime_fork_join",
             "//tensorflow/compiler/xla/service/cpu:runtime_key_value_sort",
             "//tensorflow/compiler/xla/service/cpu:runtime_matmul",
             "//tensorflow/compiler/xla/service/cpu:runtime_topk",
@@ -341,7 +345,8 @@ def _tf_library(
     sed_replace = (
         "-e \"s|{{TFCOMPILE_HEADER}}|$(location " + header_file + ")|g\" " +
         "-e \"s|{{TFCOMPILE_CPP_CLASS}}|" + cpp_class + "|g\" " +
-        "-e \"s|{{TFCOMPILE_NAME}}|" + no_ns_name + "|g\" "
+        "-e \"s|{{TFCOMPILE_NAME}}|" + no_ns_name + "|g\" " +
+        "-e \"s|{{TFCOMPILE_BATCH_SIZE}}|" + str(batch_size or 1) + "|g\" "
     )
 
     if gen_test:
@@ -460,7 +465,8 @@ def tf_library(
         mlir_components = "None",
         deps = None,
         tags = [],
-        copts = []):
+        copts = [],
+        batch_sizes = None):
     """Compiles a TensorFlow graph into an executable with fast math enabled.
 
     Given an invocation of tf_library(name="foo", ...), generates the following
@@ -473,6 +479,12 @@ def tf_library(
                       useful for mobile devices or other platforms that can't
                       compile the full test libraries. Only created if
                       gen_benchmark=True.
+      foo_batch<N>:  For each N in batch_sizes, a cc_library (with its own
+                      test and benchmark) whose class <cpp_class>Batch<N> is
+                      compiled with the leading dimension of every feed set to
+                      N. Use tensorflow::tfcompile::BatchSizeDispatcher from
+                      //tensorflow/compiler/aot:batch_size_dispatcher to pick
+                      one at run time.
     The output header is called <name>.h.
 
     Args:
@@ -520,7 +532,11 @@ def tf_library(
         library, added to the standard deps if standard_runtime_deps is True.
       tags: tags to apply to subsidiary build rules.
       copts: list of copts to pass to cc rules.
+      batch_sizes: list of batch sizes to generate specialized variants for,
+        see foo_batch<N> above.
     """
+    if batch_sizes and not cpp_class:
+        fail("cpp_class must be specified")
     _tf_library(
         name,
         graph,
@@ -568,6 +584,31 @@ def tf_library(
             tags + ["notap", "local", "manual"],
             copts,
         )
+    for batch_size in batch_sizes or []:
+        _tf_library(
+            name = "%s_batch%d" % (name, batch_size),
+            graph = graph,
+            config = config,
+            debug_info = debug_info,
+            freeze_checkpoint = freeze_checkpoint,
+            freeze_saver = freeze_saver,
+            cpp_class = "%sBatch%d" % (cpp_class, batch_size),
+            gen_test = gen_test,
+            gen_benchmark = gen_benchmark,
+            gen_compiler_log = gen_compiler_log,
+            visibility = visibility,
+            testonly = testonly,
+            tfcompile_flags = tfcompile_flags,
+            tfcompile_tool = tfcompile_tool,
+            include_standard_runtime_deps = include_standard_runtime_deps,
+            enable_xla_hlo_profiling = enable_xla_hlo_profiling,
+            enable_tracemes = enable_tracemes,
+            mlir_components = mlir_components,
+            deps = deps,
+            tags = tags,
+            copts = copts,
+            batch_size = batch_size,
+        )
 
 def target_llvm_triple():
     """Returns the target LLVM triple to be used for compiling the target."""
@@ -642,8 +642,7 @@ Status GetBodyAndConstantsAndResources(FunctionLibraryRuntime* flr,
   std::vector<bool> const_args(arg_types.size());
   // If we can't analyze the const args. Bail out.
   TF_RETURN_IF_ERROR(
-      BackwardsConstAnalysis(*((*fbody)->graph), &const_args,
-                             /*compile_time_const_nodes=*/nullptr, flr));
+      BackwardsConstAnalysisForFunction(**fbody, function, &const_args, flr));
 
   for (size_t i = 0; i < const_args.size(); ++i) {
     if (const_args[i]) {
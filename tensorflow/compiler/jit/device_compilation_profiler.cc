@@ -16,15 +16,19 @@ limitations under the License.
 #include "tensorflow/compiler/jit/device_compilation_profiler.h"
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
 
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/tsl/platform/mutex.h"
@@ -65,8 +69,62 @@ constexpr int64_t kDefaultCompilationThreshold = 2;
 // Maximum number of ongoing compilations.
 constexpr int64_t kMaxNumOngoingCompilations = kNumAsyncDeviceCompilerThreads;
 
+DeviceCompilationProfiler::AdaptivePolicy AdaptivePolicyFromFlags() {
+  const XlaOpsCommonFlags* flags = GetXlaOpsCommonFlags();
+  DeviceCompilationProfiler::AdaptivePolicy policy;
+  policy.max_compile_time_us_per_execution =
+      flags->tf_xla_adaptive_jit_max_compile_time_us_per_execution;
+  policy.decisions_file = flags->tf_xla_adaptive_jit_decisions_file;
+  return policy;
+}
+
+absl::flat_hash_set<std::string> ReadUnprofitableClusters(
+    const std::string& decisions_file) {
+  absl::flat_hash_set<std::string> clusters;
+  if (decisions_file.empty() ||
+      !Env::Default()->FileExists(decisions_file).ok()) {
+    return clusters;
+  }
+  std::string contents;
+  Status status = ReadFileToString(Env::Default(), decisions_file, &contents);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to read XLA JIT decisions from " << decisions_file
+                 << ": " << status;
+    return clusters;
+  }
+  for (absl::string_view name :
+       absl::StrSplit(contents, '\n', absl::SkipEmpty())) {
+    clusters.emplace(name);
+  }
+  VLOG(1) << "Read " << clusters.size() << " unprofitable clusters from "
+          << decisions_file;
+  return clusters;
+}
+
+void PersistUnprofitableCluster(const std::string& decisions_file,
+                                const std::string& function_name) {
+  std::unique_ptr<WritableFile> file;
+  Status status = Env::Default()->NewAppendableFile(decisions_file, &file);
+  if (status.ok()) status = file->Append(absl::StrCat(function_name, "\n"));
+  if (status.ok()) status = file->Close();
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write XLA JIT decision for " << function_name
+                 << " to " << decisions_file << ": " << status;
+  }
+}
+
 }  // namespace
 
+DeviceCompilationProfiler::DeviceCompilationProfiler()
+    : DeviceCompilationProfiler(AdaptivePolicyFromFlags()) {}
+
+DeviceCompilationProfiler::DeviceCompilationProfiler(AdaptivePolicy policy)
+    : adaptive_policy_(std::move(policy)) {
+  mutex_lock lock(mu_);
+  persisted_unprofitable_clusters_ =
+      ReadUnprofitableClusters(adaptive_policy_.decisions_file);
+}
+
 DeviceCompilationProfiler::~DeviceCompilationProfiler() {
   mutex_lock lock(mu_);
   cluster_compile_stats_.clear();
@@ -166,6 +224,12 @@ bool DeviceCompilationProfiler::ShouldCompileCluster(
     return false;
   }
 
+  if (IsUnprofitableLocked(function, &it->second)) {
+    VLOG(2) << "Not compiling cluster " << function.name()
+            << " because its compile time does not pay off.";
+    return false;
+  }
+
   // TODO(b/255826209): Figure out if Lazy compilation is still needed given
   // that we always compile a cluster the first time it is executed (explained
   // below) regardless of compilation mode. If it is not, clean up the related
@@ -198,6 +262,31 @@ bool DeviceCompilationProfiler::ShouldCompileCluster(
   return reached_compile_threshold;
 }
 
+bool DeviceCompilationProfiler::IsUnprofitableLocked(
+    const NameAttrList& function, ClusterCompileStats* stats) {
+  if (stats->is_unprofitable) {
+    return true;
+  }
+  if (persisted_unprofitable_clusters_.contains(function.name())) {
+    stats->is_unprofitable = true;
+    return true;
+  }
+  const int64_t budget_us = adaptive_policy_.max_compile_time_us_per_execution;
+  if (budget_us <= 0 ||
+      stats->cumulative_compile_time_us <=
+          budget_us * stats->execution_count) {
+    return false;
+  }
+  VLOG(1) << "Marking " << function.name() << " as unprofitable, "
+          << stats->DebugString();
+  stats->is_unprofitable = true;
+  if (!adaptive_policy_.decisions_file.empty()) {
+    PersistUnprofitableCluster(adaptive_policy_.decisions_file,
+                               function.name());
+  }
+  return true;
+}
+
 void DeviceCompilationProfiler::IncrementOngoingAsyncCompilations() {
   mutex_lock lock(mu_);
   num_ongoing_compilations_++;
@@ -19,6 +19,7 @@ limitations under the License.
 #include <cstdint>
 #include <string>
 
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/compiler/jit/xla_compile_util.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 
@@ -28,7 +29,25 @@ namespace tensorflow {
 // the given cluster should be compiled or not.
 class DeviceCompilationProfiler : public ResourceBase {
  public:
-  DeviceCompilationProfiler() = default;
+  // Adaptive policy that stops compiling clusters whose compile time does not
+  // pay off, because they are slow to compile or rarely executed.
+  struct AdaptivePolicy {
+    // If positive, a cluster is marked unprofitable, and no longer compiled for
+    // new signatures, once its cumulative compile time exceeds this many
+    // microseconds per execution of the cluster. Signatures that are already
+    // compiled keep being used. Zero disables the policy.
+    int64_t max_compile_time_us_per_execution = 0;
+
+    // If non-empty, the names of clusters marked unprofitable are appended to
+    // this file, and the clusters it names are treated as unprofitable from
+    // the start. Cluster names are only stable across processes with
+    // --tf_xla_deterministic_cluster_names.
+    std::string decisions_file;
+  };
+
+  // Uses the policy configured by the --tf_xla_adaptive_jit_* flags.
+  DeviceCompilationProfiler();
+  explicit DeviceCompilationProfiler(AdaptivePolicy policy);
   ~DeviceCompilationProfiler() override;
 
   struct ClusterCompileStats {
@@ -46,12 +65,17 @@ class DeviceCompilationProfiler : public ResourceBase {
     // tagged megamorphic, it stays megamorphic forever.
     bool is_megamorphic = false;
 
+    // True if the adaptive policy decided that compiling this cluster doesn't
+    // pay off. Like `is_megamorphic`, this is sticky.
+    bool is_unprofitable = false;
+
     std::string DebugString() const {
       return absl::StrCat(
           "DeviceCompilationProfiler::ClusterCompileStats {compile_count=",
           compile_count, ", execution_count=", execution_count,
           ", cumulative_compile_time_us=", cumulative_compile_time_us,
-          ", is_megamorphic=", is_megamorphic, "}");
+          ", is_megamorphic=", is_megamorphic,
+          ", is_unprofitable=", is_unprofitable, "}");
     }
   };
 
@@ -84,8 +108,20 @@ class DeviceCompilationProfiler : public ResourceBase {
   std::string DebugString() const override;
 
  private:
+  // Applies the adaptive policy to `stats` before `function` is compiled for
+  // another signature. Returns true if the cluster is unprofitable.
+  bool IsUnprofitableLocked(const NameAttrList& function,
+                            ClusterCompileStats* stats)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const AdaptivePolicy adaptive_policy_;
+
   mutable mutex mu_;
 
+  // Clusters read from `adaptive_policy_.decisions_file`.
+  absl::flat_hash_set<std::string> persisted_unprofitable_clusters_
+      TF_GUARDED_BY(mu_);
+
   // Maps cluster names to compilation statistics for said cluster.
   absl::flat_hash_map<std::string, ClusterCompileStats> cluster_compile_stats_
       TF_GUARDED_BY(mu_);
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/device_compilation_profiler.h"
 
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -24,6 +25,10 @@ limitations under the License.
 #include "tensorflow/compiler/jit/tests/device_compiler_test_helper.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
 namespace {
@@ -182,6 +187,46 @@ TEST(DeviceCompilationProfilerTest, ShouldCompileClusterMegamorphic) {
       profiler->ShouldCompileCluster(function, DeviceCompileMode::kStrict, 0));
 }
 
+TEST(DeviceCompilationProfilerTest, ShouldCompileClusterUnprofitable) {
+  const std::string decisions_file =
+      io::JoinPath(testing::TmpDir(), "unprofitable_clusters");
+  Env::Default()->DeleteFile(decisions_file).IgnoreError();
+
+  DeviceCompilationProfiler::AdaptivePolicy policy;
+  policy.max_compile_time_us_per_execution = 100;
+  policy.decisions_file = decisions_file;
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+  {
+    DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler(policy);
+    core::ScopedUnref profiler_ref(profiler);
+
+    // The first compilation is always attempted.
+    EXPECT_TRUE(
+        profiler->ShouldCompileCluster(function, DeviceCompileMode::kLazy, 2));
+    TF_EXPECT_OK(profiler->RegisterCompilation(function, 1000, false));
+
+    // 1000us of compile time over two executions is over budget.
+    profiler->RegisterExecution(function);
+    EXPECT_FALSE(
+        profiler->ShouldCompileCluster(function, DeviceCompileMode::kLazy, 2));
+    TF_ASSERT_OK_AND_ASSIGN(auto stats, profiler->GetCompileStats(function));
+    EXPECT_TRUE(stats.is_unprofitable);
+
+    // Always compile for strict compile mode.
+    EXPECT_TRUE(profiler->ShouldCompileCluster(function,
+                                               DeviceCompileMode::kStrict, 0));
+  }
+
+  // The decision is read back by a new profiler, which then doesn't compile
+  // the cluster even on its first execution.
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler(policy);
+  core::ScopedUnref profiler_ref(profiler);
+  EXPECT_FALSE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kLazy, 2));
+}
+
 TEST(DeviceCompilationProfilerTest, ShouldCompileClusterAsync) {
   DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
   core::ScopedUnref profiler_ref(profiler);
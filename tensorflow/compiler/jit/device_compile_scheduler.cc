@@ -0,0 +1,153 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/device_compile_scheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+
+DeviceCompileScheduler::DeviceCompileScheduler(const Options& options)
+    : idle_timeout_us_(options.idle_timeout_us),
+      threads_(std::make_unique<thread::ThreadPool>(
+          Env::Default(), "async_compiler_threads",
+          std::max(options.num_threads, 1))) {}
+
+DeviceCompileScheduler::~DeviceCompileScheduler() {
+  TaskMap cancelled;
+  {
+    mutex_lock lock(mu_);
+    std::swap(cancelled, queue_);
+  }
+  metrics::UpdateXlaAsyncCompilationQueueDepth(
+      -static_cast<int64_t>(cancelled.size()));
+  for (auto& [signature, task] : cancelled) task.cancel();
+  threads_.reset();
+}
+
+void DeviceCompileScheduler::Schedule(
+    const DeviceCompilationClusterSignature& signature,
+    std::function<int64_t()> priority, std::function<void()> compile,
+    std::function<void()> cancel) {
+  {
+    mutex_lock lock(mu_);
+    const bool inserted =
+        queue_
+            .emplace(signature, Task{std::move(priority), std::move(compile),
+                                     std::move(cancel),
+                                     Env::Default()->NowMicros()})
+            .second;
+    DCHECK(inserted) << "Compilation already queued for "
+                     << signature.HumanString();
+  }
+  metrics::UpdateXlaAsyncCompilationQueueDepth(1);
+  // Every queued compilation gets a turn on the pool, so that each turn runs at
+  // most one compilation, picked when it starts.
+  threads_->Schedule([this] { RunNext(); });
+}
+
+void DeviceCompileScheduler::Touch(
+    const DeviceCompilationClusterSignature& signature) {
+  mutex_lock lock(mu_);
+  if (auto it = queue_.find(signature); it != queue_.end()) {
+    it->second.last_request_us = Env::Default()->NowMicros();
+  }
+}
+
+bool DeviceCompileScheduler::Cancel(
+    const DeviceCompilationClusterSignature& signature) {
+  std::optional<Task> task;
+  {
+    mutex_lock lock(mu_);
+    auto it = queue_.find(signature);
+    if (it == queue_.end()) return false;
+    task = std::move(it->second);
+    queue_.erase(it);
+  }
+  metrics::UpdateXlaAsyncCompilationQueueDepth(-1);
+  task->cancel();
+  return true;
+}
+
+int64_t DeviceCompileScheduler::queue_depth() const {
+  mutex_lock lock(mu_);
+  return queue_.size();
+}
+
+void DeviceCompileScheduler::RunNext() {
+  while (true) {
+    std::vector<Task> idle;
+    std::vector<std::pair<DeviceCompilationClusterSignature,
+                          std::function<int64_t()>>>
+        candidates;
+    {
+      mutex_lock lock(mu_);
+      const uint64 now_us = Env::Default()->NowMicros();
+      for (auto it = queue_.begin(); it != queue_.end();) {
+        if (idle_timeout_us_ > 0 &&
+            now_us - it->second.last_request_us >
+                static_cast<uint64>(idle_timeout_us_)) {
+          VLOG(2) << "Cancelling the idle compilation of "
+                  << it->first.HumanString();
+          idle.push_back(std::move(it->second));
+          queue_.erase(it++);
+        } else {
+          candidates.emplace_back(it->first, it->second.priority);
+          ++it;
+        }
+      }
+    }
+    metrics::UpdateXlaAsyncCompilationQueueDepth(
+        -static_cast<int64_t>(idle.size()));
+    for (Task& task : idle) task.cancel();
+    if (candidates.empty()) return;
+
+    // Evaluated without holding `mu_`, as priorities take other locks.
+    const DeviceCompilationClusterSignature* next = nullptr;
+    int64_t next_priority = std::numeric_limits<int64_t>::min();
+    for (const auto& [signature, priority] : candidates) {
+      const int64_t candidate_priority = priority();
+      if (next == nullptr || candidate_priority > next_priority) {
+        next = &signature;
+        next_priority = candidate_priority;
+      }
+    }
+
+    std::optional<Task> task;
+    {
+      mutex_lock lock(mu_);
+      // The compilation may have been cancelled in the meantime.
+      auto it = queue_.find(*next);
+      if (it == queue_.end()) continue;
+      task = std::move(it->second);
+      queue_.erase(it);
+    }
+    metrics::UpdateXlaAsyncCompilationQueueDepth(-1);
+    task->compile();
+    return;
+  }
+}
+
+}  // namespace tensorflow
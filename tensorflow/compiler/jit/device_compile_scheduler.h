@@ -0,0 +1,98 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_DEVICE_COMPILE_SCHEDULER_H_
+#define TENSORFLOW_COMPILER_JIT_DEVICE_COMPILE_SCHEDULER_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Runs the asynchronous compilations of a DeviceCompiler on a bounded pool of
+// threads. Waiting compilations are started in order of their priority (the
+// execution count of their cluster), which is evaluated again every time a
+// thread becomes free, so clusters that keep being executed on the fallback
+// path overtake the others. Waiting compilations whose signature hasn't been
+// requested for a while are cancelled.
+class DeviceCompileScheduler {
+ public:
+  struct Options {
+    // Number of compilations that run at the same time.
+    int num_threads = 1;
+
+    // If positive, compilations that wait longer than this since their
+    // signature was last requested are cancelled.
+    int64_t idle_timeout_us = 0;
+  };
+
+  explicit DeviceCompileScheduler(const Options& options);
+  // Cancels the waiting compilations and waits for the running ones.
+  ~DeviceCompileScheduler();
+
+  // Queues `compile` for `signature`, which must not already be queued.
+  // `priority` is called with no lock held by the scheduler whenever the next
+  // compilation is picked. `cancel` is called instead of `compile` if the
+  // compilation gets cancelled.
+  void Schedule(const DeviceCompilationClusterSignature& signature,
+                std::function<int64_t()> priority,
+                std::function<void()> compile, std::function<void()> cancel);
+
+  // Records that the compilation for `signature` is still wanted.
+  void Touch(const DeviceCompilationClusterSignature& signature);
+
+  // Cancels the compilation for `signature` if it hasn't started yet. Returns
+  // true if it was cancelled.
+  bool Cancel(const DeviceCompilationClusterSignature& signature);
+
+  // Number of compilations that haven't started yet.
+  int64_t queue_depth() const;
+
+ private:
+  struct Task {
+    std::function<int64_t()> priority;
+    std::function<void()> compile;
+    std::function<void()> cancel;
+    uint64 last_request_us;
+  };
+  using TaskMap =
+      absl::flat_hash_map<DeviceCompilationClusterSignature, Task,
+                          DeviceCompilationClusterSignature::Hash>;
+
+  // Runs the waiting compilation with the highest priority, if any, and
+  // cancels the idle ones.
+  void RunNext();
+
+  const int64_t idle_timeout_us_;
+
+  mutable mutex mu_;
+  TaskMap queue_ TF_GUARDED_BY(mu_);
+
+  // Destroyed first, so that running compilations finish before the queue.
+  std::unique_ptr<thread::ThreadPool> threads_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DeviceCompileScheduler);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_DEVICE_COMPILE_SCHEDULER_H_
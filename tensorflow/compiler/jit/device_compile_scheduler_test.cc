@@ -0,0 +1,157 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/device_compile_scheduler.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+
+namespace tensorflow {
+namespace {
+
+DeviceCompilationClusterSignature Signature(const std::string& name) {
+  DeviceCompilationClusterSignature signature;
+  signature.name = name;
+  return signature;
+}
+
+// Blocks the only thread of `scheduler` until the returned notification is
+// notified.
+std::unique_ptr<Notification> BlockScheduler(
+    DeviceCompileScheduler* scheduler, Notification* started) {
+  auto unblock = std::make_unique<Notification>();
+  scheduler->Schedule(
+      Signature("blocker"), [] { return 0; },
+      [started, unblock = unblock.get()] {
+        started->Notify();
+        unblock->WaitForNotification();
+      },
+      [] {});
+  return unblock;
+}
+
+TEST(DeviceCompileSchedulerTest, RunsHighestPriorityFirst) {
+  DeviceCompileScheduler::Options options;
+  options.num_threads = 1;
+  DeviceCompileScheduler scheduler(options);
+
+  Notification started;
+  auto unblock = BlockScheduler(&scheduler, &started);
+  started.WaitForNotification();
+
+  mutex mu;
+  std::vector<std::string> order;
+  Notification done;
+  std::atomic<int64_t> hot_priority(1);
+  auto compile = [&](const std::string& name) {
+    mutex_lock lock(mu);
+    order.push_back(name);
+    if (order.size() == 3) done.Notify();
+  };
+  scheduler.Schedule(
+      Signature("cold"), [] { return 5; }, [&] { compile("cold"); }, [] {});
+  scheduler.Schedule(
+      Signature("warm"), [] { return 10; }, [&] { compile("warm"); }, [] {});
+  scheduler.Schedule(
+      Signature("hot"), [&] { return hot_priority.load(); },
+      [&] { compile("hot"); }, [] {});
+  EXPECT_EQ(scheduler.queue_depth(), 3);
+
+  // "hot" is executed a lot while it waits.
+  hot_priority = 100;
+  unblock->Notify();
+  done.WaitForNotification();
+  EXPECT_EQ(order, std::vector<std::string>({"hot", "warm", "cold"}));
+  EXPECT_EQ(scheduler.queue_depth(), 0);
+}
+
+TEST(DeviceCompileSchedulerTest, Cancel) {
+  DeviceCompileScheduler::Options options;
+  options.num_threads = 1;
+  DeviceCompileScheduler scheduler(options);
+
+  Notification started;
+  auto unblock = BlockScheduler(&scheduler, &started);
+  started.WaitForNotification();
+
+  bool compiled = false;
+  bool cancelled = false;
+  scheduler.Schedule(
+      Signature("cluster"), [] { return 0; }, [&] { compiled = true; },
+      [&] { cancelled = true; });
+  EXPECT_TRUE(scheduler.Cancel(Signature("cluster")));
+  EXPECT_FALSE(scheduler.Cancel(Signature("cluster")));
+  EXPECT_TRUE(cancelled);
+  unblock->Notify();
+
+  EXPECT_EQ(scheduler.queue_depth(), 0);
+  EXPECT_FALSE(compiled);
+}
+
+TEST(DeviceCompileSchedulerTest, CancelsIdleCompilations) {
+  DeviceCompileScheduler::Options options;
+  options.num_threads = 1;
+  options.idle_timeout_us = 1000;
+  DeviceCompileScheduler scheduler(options);
+
+  Notification started;
+  auto unblock = BlockScheduler(&scheduler, &started);
+  started.WaitForNotification();
+
+  Notification idle_cancelled;
+  Notification used_compiled;
+  scheduler.Schedule(
+      Signature("idle"), [] { return 0; }, [] {},
+      [&] { idle_cancelled.Notify(); });
+  scheduler.Schedule(
+      Signature("used"), [] { return 0; }, [&] { used_compiled.Notify(); },
+      [] {});
+  Env::Default()->SleepForMicroseconds(2 * options.idle_timeout_us);
+  scheduler.Touch(Signature("used"));
+  unblock->Notify();
+
+  idle_cancelled.WaitForNotification();
+  used_compiled.WaitForNotification();
+}
+
+TEST(DeviceCompileSchedulerTest, DestructorCancelsWaitingCompilations) {
+  bool cancelled = false;
+  std::unique_ptr<Notification> unblock;
+  {
+    DeviceCompileScheduler::Options options;
+    options.num_threads = 1;
+    DeviceCompileScheduler scheduler(options);
+
+    Notification started;
+    unblock = BlockScheduler(&scheduler, &started);
+    started.WaitForNotification();
+    scheduler.Schedule(
+        Signature("cluster"), [] { return 0; }, [] {},
+        [&] { cancelled = true; });
+    unblock->Notify();
+  }
+  EXPECT_TRUE(cancelled);
+}
+
+}  // namespace
+}  // namespace tensorflow
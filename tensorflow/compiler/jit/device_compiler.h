@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/device_compilation_cache.h"
 #include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
 #include "tensorflow/compiler/jit/device_compilation_profiler.h"
+#include "tensorflow/compiler/jit/device_compile_scheduler.h"
 #include "tensorflow/compiler/jit/device_compiler_client.h"
 #include "tensorflow/compiler/jit/device_executable_persistor.h"
 #include "tensorflow/compiler/jit/flags.h"
@@ -39,7 +40,6 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/xla/client/local_client.h"
 #include "tensorflow/core/framework/op_kernel.h"
-#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 
@@ -165,8 +165,8 @@ class DeviceCompiler : public ResourceBase {
       compiler_client_;
   std::unique_ptr<DeviceCompilationCache<ExecutableType>> cache_;
 
-  // Pool of threads for asynchronous compilations.
-  std::unique_ptr<thread::ThreadPool> async_compiler_threads_;
+  // Runs the asynchronous compilations.
+  std::unique_ptr<DeviceCompileScheduler> async_compile_scheduler_;
 
   mutex cluster_mutexes_mu_;
   absl::flat_hash_map<DeviceCompilationClusterSignature, std::unique_ptr<mutex>,
@@ -212,9 +212,14 @@ DeviceCompiler<ExecutableType, ClientType>::DeviceCompiler(
     : persistor_(std::move(persistor)),
       compiler_client_(std::move(compiler_client)) {
   cache_ = std::make_unique<DeviceCompilationCache<ExecutableType>>();
-  async_compiler_threads_ = std::make_unique<tensorflow::thread::ThreadPool>(
-      tensorflow::Env::Default(), "async_compiler_threads",
-      kNumAsyncDeviceCompilerThreads);
+  DeviceCompileScheduler::Options scheduler_options;
+  scheduler_options.num_threads =
+      GetXlaOpsCommonFlags()->tf_xla_async_compilation_threads;
+  scheduler_options.idle_timeout_us =
+      GetXlaOpsCommonFlags()->tf_xla_async_compilation_idle_timeout_secs *
+      1000000;
+  async_compile_scheduler_ =
+      std::make_unique<DeviceCompileScheduler>(scheduler_options);
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -222,12 +227,12 @@ DeviceCompiler<ExecutableType, ClientType>::~DeviceCompiler() {
   // Since programs are owned by the cache, ensure any use of our programs have
   // completed by waiting for all stream executors to complete.
   compiler_client_->WaitForProgramsToFinish();
-  // Wait for all outstanding compilations to finish.
+  // Cancel waiting compilations and wait for the running ones to finish.
   // Resetting the pointer explicitly in the top level destructor.
   // Without this, the pointer would be reset when the AsyncCompilationState
   // is destructed, which is dependent on the order of the members in the
   // DeviceCompiler class, which is error prone if the order changes.
-  async_compiler_threads_.reset();
+  async_compile_scheduler_.reset();
   // TODO(b/110813685): Think about the program ownership model. Programs are
   // currently owned by the compilation cache which means we must wait for
   // program completion in the destructor. There are multiple compilation caches
@@ -362,14 +367,27 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
   // Don't move the above code into the thread function as it synchronously
   // updates the async compilation state!
 
-  // When the ThreadPool for the compilation cache is destroyed, it waits for
-  // compilations to have finished. This means that both 'entry' and 'this' will
-  // be alive for the duration of the compilation.
-  // !!Pay attention when additional variables must be captured by this lambda!!
-  // All values are captured by value. Make sure that all pointer values (like
-  // entry) do not get freed until the lambda has finished.
+  // When the scheduler for the compilation cache is destroyed, it cancels the
+  // waiting compilations and waits for the running ones to have finished. This
+  // means that both 'entry' and 'this' will be alive for the duration of the
+  // compilation.
+  // !!Pay attention when additional variables must be captured by these
+  // lambdas!! All values are captured by value. Make sure that all pointer
+  // values (like entry) do not get freed until the lambda has finished.
   const std::string& function_name = function.name();
-  async_compiler_threads_->Schedule([=] {
+  auto priority = [profiler, function]() -> int64_t {
+    auto stats = profiler->GetCompileStats(function);
+    return stats.ok() ? stats->execution_count : 0;
+  };
+  auto cancel = [this, signature, profiler, function_name] {
+    VLOG(2) << "Cancelled asynchronous compilation of cluster "
+            << function_name << '.';
+    profiler->DecrementOngoingAsyncCompilations();
+    // Let a later request queue the compilation again.
+    cache_->Store(signature, DeviceCompileState::kUncompiled, std::nullopt,
+                  std::nullopt, std::nullopt);
+  };
+  auto compile = [=] {
     VLOG(2) << "Starting asynchronous compilation of cluster " << function_name
             << '.';
     // We don't need to lock mu, but do it anyway to satisfy thread safety
@@ -387,7 +405,8 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
       cache_->Store(signature, std::nullopt, s.status(), std::nullopt,
                     std::nullopt);
     }
-  });
+  };
+  async_compile_scheduler_->Schedule(signature, priority, compile, cancel);
   return OkStatus();
 }
 
@@ -484,6 +503,7 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
   } else if (state == DeviceCompileState::kCompiling) {
     VLOG(2) << "Ongoing asynchronous compilation for signature: "
             << human_signature;
+    async_compile_scheduler_->Touch(signature);
     return OkStatus();
   } else if (state == DeviceCompileState::kCompiled) {
     VLOG(2) << "Already Compiled for signature: " << human_signature;
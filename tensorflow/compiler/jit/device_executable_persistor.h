@@ -16,20 +16,27 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 
+#include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 
+#include "tensorflow/compiler/jit/device_executable_remote_cache.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/compiler/xla/debug_options_flags.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
 #include "tensorflow/compiler/xla/service/hlo.pb.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/tsl/platform/statusor.h"
 
 namespace tensorflow {
@@ -37,6 +44,13 @@ namespace tensorflow {
 // Offers a way to persist and/or load compiled `ExecutableType`s along with the
 // corresponding HLO (`CompilationResult`) to/from `persistent_cache_directory`
 // (if one was provided during construction) on disk  using `ClientType`.
+//
+// If a `remote_cache` was provided as well, executables not found on disk are
+// looked up in it, and stored on disk when found there. Executables persisted
+// by this process are written back to it asynchronously. Remote entries are
+// additionally keyed by the TensorFlow version and the XLA flags, as they may
+// come from other binaries, and any failure to use them falls back to
+// compiling.
 template <typename ExecutableType, typename ClientType>
 class DeviceExecutablePersistor {
  public:
@@ -60,6 +74,10 @@ class DeviceExecutablePersistor {
 
     // The cache persistence prefix to use if serializing/deserialzing entries.
     std::string persistence_prefix;
+
+    // If non-null, a cache of executables shared with other processes. Should
+    // only be shared by processes compiling for the same devices.
+    std::shared_ptr<DeviceExecutableRemoteCache> remote_cache;
   };
 
   DeviceExecutablePersistor(const Config& config,
@@ -67,9 +85,10 @@ class DeviceExecutablePersistor {
   virtual ~DeviceExecutablePersistor() = default;
 
   // Returns std::nullopt if persistence is not enabled (i.e.
-  // `persistent_cache_directory_` is empty) or if the serialized entry is not
-  // found on disk. Otherwise, loads and returns the serialized executable
-  // (or returns a status).
+  // `persistent_cache_directory_` is empty and there is no remote cache) or if
+  // the serialized entry is not found on disk or in the remote cache.
+  // Otherwise, loads and returns the serialized executable (or returns a
+  // status).
   // TODO(b/255826209): Take in Signature instead of hash and string once cache
   // is refactored.
   std::optional<StatusOr<std::unique_ptr<ExecutableType>>> TryToLoadExecutable(
@@ -78,9 +97,9 @@ class DeviceExecutablePersistor {
       const XlaCompiler::CompilationResult& compilation_result,
       DeviceCompilerClient<ExecutableType, ClientType>* client) const;
 
-  // Tries to serialize an already built `executable` and persist it on disk. If
-  // unable to do so, tries to build a serialized executable using the AOT
-  // pipeline and persists that to disk.
+  // Tries to serialize an already built `executable` and persist it on disk
+  // and in the remote cache. If unable to do so, tries to build a serialized
+  // executable using the AOT pipeline and persists that.
   // TODO(b/255826209): Take in Signature instead hash and string once cache
   // is refactored.
   virtual Status TryToPersistExecutable(
@@ -128,9 +147,27 @@ class DeviceExecutablePersistor {
                                 const xla::HloModuleProto& hlo_module,
                                 const XlaSerializedCacheEntry& entry) const;
 
+  // Tries to load the executable for `key` from the remote cache. Returns
+  // std::nullopt if it isn't there or can't be used.
+  std::optional<StatusOr<std::unique_ptr<ExecutableType>>>
+  TryToLoadRemoteExecutable(
+      const XlaSerializedCacheKey& key, const std::string& signature_str,
+      const XlaCompiler::Options& options,
+      const XlaCompiler::CompilationResult& compilation_result,
+      DeviceCompilerClient<ExecutableType, ClientType>* client) const;
+
+  // Reads the cache entry for `key` from the remote cache and checks that it
+  // wasn't corrupted. Returns std::nullopt if no cache entry is found.
+  StatusOr<std::optional<XlaSerializedCacheEntry>> TryToReadRemoteEntry(
+      const XlaSerializedCacheKey& key) const;
+
+  // Schedules storing `entry` in the remote cache.
+  void WriteBackRemoteEntry(const XlaSerializedCacheEntry& entry) const;
+
   std::string XlaSerializedCacheKeyToString(
       const XlaSerializedCacheKey& key) const;
   std::string GetFilePath(const XlaSerializedCacheKey& key) const;
+  std::string GetRemoteCacheKey(const XlaSerializedCacheKey& key) const;
 
   const DeviceType device_type_;
   const bool disable_strict_signature_checks_;
@@ -140,6 +177,12 @@ class DeviceExecutablePersistor {
   // specified file system directory path.
   const std::string persistent_cache_directory_;
 
+  // If non-null, JIT-compiled executables are also shared through it.
+  const std::shared_ptr<DeviceExecutableRemoteCache> remote_cache_;
+
+  // Identifies the compiler that produced the executables in the remote cache.
+  const std::string compiler_fingerprint_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(DeviceExecutablePersistor);
 };
 
@@ -150,7 +193,14 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::
     : device_type_(device_type),
       disable_strict_signature_checks_(config.disable_strict_signature_checks),
       persistence_prefix_(config.persistence_prefix),
-      persistent_cache_directory_(config.persistent_cache_directory) {}
+      persistent_cache_directory_(config.persistent_cache_directory),
+      remote_cache_(config.remote_cache),
+      compiler_fingerprint_(
+          config.remote_cache == nullptr
+              ? ""
+              : absl::StrCat(TF_VERSION_STRING, "_",
+                             absl::Hex(DeterministicProtoHash64(
+                                 xla::GetDebugOptionsFromFlags())))) {}
 
 template <typename ExecutableType, typename ClientType>
 std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
@@ -174,6 +224,14 @@ std::string DeviceExecutablePersistor<ExecutableType, ClientType>::GetFilePath(
   return io::JoinPath(persistent_cache_directory_, file_name);
 }
 
+template <typename ExecutableType, typename ClientType>
+std::string
+DeviceExecutablePersistor<ExecutableType, ClientType>::GetRemoteCacheKey(
+    const XlaSerializedCacheKey& key) const {
+  return absl::StrCat(XlaSerializedCacheKeyToString(key), "__",
+                      compiler_fingerprint_);
+}
+
 template <typename ExecutableType, typename ClientType>
 XlaSerializedCacheKey
 DeviceExecutablePersistor<ExecutableType, ClientType>::BuildSerializedCacheKey(
@@ -220,6 +278,50 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
   return std::optional<XlaSerializedCacheEntry>(entry);
 }
 
+template <typename ExecutableType, typename ClientType>
+StatusOr<std::optional<XlaSerializedCacheEntry>>
+DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadRemoteEntry(
+    const XlaSerializedCacheKey& key) const {
+  TF_ASSIGN_OR_RETURN(std::optional<std::string> serialized_value,
+                      remote_cache_->Lookup(GetRemoteCacheKey(key)));
+  if (!serialized_value.has_value()) {
+    return StatusOr<std::optional<XlaSerializedCacheEntry>>(std::nullopt);
+  }
+
+  XlaRemoteCacheValue value;
+  if (!value.ParseFromString(*serialized_value) ||
+      Fingerprint64(value.serialized_entry()) != value.fingerprint()) {
+    return errors::DataLoss("Corrupted remote cache entry.");
+  }
+  XlaSerializedCacheEntry entry;
+  if (!entry.ParseFromString(value.serialized_entry())) {
+    return errors::DataLoss("Corrupted remote cache entry.");
+  }
+  return std::optional<XlaSerializedCacheEntry>(std::move(entry));
+}
+
+template <typename ExecutableType, typename ClientType>
+void DeviceExecutablePersistor<ExecutableType, ClientType>::
+    WriteBackRemoteEntry(const XlaSerializedCacheEntry& entry) const {
+  XlaRemoteCacheValue value;
+  if (!SerializeToStringDeterministic(entry,
+                                      value.mutable_serialized_entry())) {
+    LOG(WARNING) << "Failed to serialize the remote cache entry.";
+    return;
+  }
+  value.set_fingerprint(Fingerprint64(value.serialized_entry()));
+  // Shares ownership of the remote cache, as stores may outlive this object.
+  Env::Default()->SchedClosure(
+      [remote_cache = remote_cache_, key = GetRemoteCacheKey(entry.key()),
+       serialized_value = value.SerializeAsString()]() {
+        Status status = remote_cache->Store(key, serialized_value);
+        if (!status.ok()) {
+          LOG(WARNING) << "Failed to store " << key
+                       << " in the remote compilation cache: " << status;
+        }
+      });
+}
+
 template <typename ExecutableType, typename ClientType>
 Status
 DeviceExecutablePersistor<ExecutableType, ClientType>::VerifyLoadedCacheEntry(
@@ -306,7 +408,7 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToLoadExecutable(
     const XlaCompiler::Options& options,
     const XlaCompiler::CompilationResult& compilation_result,
     DeviceCompilerClient<ExecutableType, ClientType>* compiler_client) const {
-  if (persistent_cache_directory_.empty()) {
+  if (persistent_cache_directory_.empty() && remote_cache_ == nullptr) {
     return std::nullopt;
   }
 
@@ -317,14 +419,18 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToLoadExecutable(
       BuildSerializedCacheKey(signature_hash, hlo_module);
 
   std::optional<XlaSerializedCacheEntry> serialized_entry;
-  {
+  if (!persistent_cache_directory_.empty()) {
     XLA_SCOPED_LOGGING_TIMER(
         absl::StrCat("Try loading serialized cache entry:", signature_str));
     TF_ASSIGN_OR_RETURN(serialized_entry, TryToReadSerializedEntry(cache_key));
   }
 
   if (!serialized_entry.has_value()) {
-    return std::nullopt;
+    if (remote_cache_ == nullptr) {
+      return std::nullopt;
+    }
+    return TryToLoadRemoteExecutable(cache_key, signature_str, options,
+                                     compilation_result, compiler_client);
   }
 
   TF_RETURN_IF_ERROR(
@@ -335,6 +441,59 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToLoadExecutable(
                                          serialized_entry->executable());
 }
 
+template <typename ExecutableType, typename ClientType>
+std::optional<StatusOr<std::unique_ptr<ExecutableType>>>
+DeviceExecutablePersistor<ExecutableType, ClientType>::
+    TryToLoadRemoteExecutable(
+        const XlaSerializedCacheKey& key, const std::string& signature_str,
+        const XlaCompiler::Options& options,
+        const XlaCompiler::CompilationResult& compilation_result,
+        DeviceCompilerClient<ExecutableType, ClientType>* compiler_client)
+        const {
+  StatusOr<std::optional<XlaSerializedCacheEntry>> serialized_entry;
+  {
+    XLA_SCOPED_LOGGING_TIMER(
+        absl::StrCat("Try loading remote cache entry:", signature_str));
+    serialized_entry = TryToReadRemoteEntry(key);
+  }
+  if (!serialized_entry.ok()) {
+    LOG(WARNING) << "Not using the remote cache entry for " << signature_str
+                 << ": " << serialized_entry.status();
+    return std::nullopt;
+  }
+  if (!serialized_entry->has_value()) {
+    return std::nullopt;
+  }
+
+  Status status = VerifyLoadedCacheEntry(
+      key, compilation_result.computation->proto(), **serialized_entry);
+  if (!status.ok()) {
+    LOG(WARNING) << "Not using the remote cache entry for " << signature_str
+                 << ": " << status;
+    return std::nullopt;
+  }
+
+  VLOG(1) << "Loading remote cached entry for: " << signature_str;
+  StatusOr<std::unique_ptr<ExecutableType>> executable =
+      compiler_client->LoadExecutable(options, compilation_result,
+                                      (*serialized_entry)->executable());
+  if (!executable.ok()) {
+    LOG(WARNING) << "Failed to load the remote cache entry for "
+                 << signature_str << ": " << executable.status();
+    return std::nullopt;
+  }
+
+  // Keep the entry on disk, so that it is found there the next time.
+  if (!persistent_cache_directory_.empty()) {
+    status = SaveSerializedEntry(**serialized_entry);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to save the remote cache entry for "
+                   << signature_str << ": " << status;
+    }
+  }
+  return std::move(executable);
+}
+
 template <typename ExecutableType, typename ClientType>
 Status
 DeviceExecutablePersistor<ExecutableType, ClientType>::TryToPersistExecutable(
@@ -343,9 +502,9 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToPersistExecutable(
     const XlaCompiler::CompilationResult& compilation_result,
     const ExecutableType& executable,
     DeviceCompilerClient<ExecutableType, ClientType>* client) const {
-  if (persistent_cache_directory_.empty()) {
+  if (persistent_cache_directory_.empty() && remote_cache_ == nullptr) {
     VLOG(1) << "Not persisting executable. No `persistent_cache_directory` "
-               "provided.";
+               "or remote cache provided.";
     return OkStatus();
   }
 
@@ -354,7 +513,12 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToPersistExecutable(
   TF_ASSIGN_OR_RETURN(XlaSerializedCacheEntry serialized_entry,
                       SerializeEntry(signature_hash, options,
                                      compilation_result, executable, client));
-  TF_RETURN_IF_ERROR(SaveSerializedEntry(std::move(serialized_entry)));
+  if (!persistent_cache_directory_.empty()) {
+    TF_RETURN_IF_ERROR(SaveSerializedEntry(serialized_entry));
+  }
+  if (remote_cache_ != nullptr) {
+    WriteBackRemoteEntry(serialized_entry);
+  }
   return OkStatus();
 }
 
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <stdlib.h>
 
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
@@ -28,6 +29,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/function_ops.h"
 #include "tensorflow/cc/ops/math_ops.h"
 #include "tensorflow/compiler/jit/device_compiler_client.h"
+#include "tensorflow/compiler/jit/device_executable_remote_cache.h"
 #include "tensorflow/compiler/jit/pjrt_device_compiler_client.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
@@ -38,6 +40,9 @@ limitations under the License.
 #include "tensorflow/compiler/xla/pjrt/tfrt_cpu_pjrt_client.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/tfrt/common/create_pjrt_client_util.h"
@@ -192,6 +197,39 @@ class MockPjRtCompilerClient : public PjRtDeviceCompilerClient {
               (override));
 };
 
+// Keeps the values in memory, and notifies of the first store.
+class FakeRemoteCache : public DeviceExecutableRemoteCache {
+ public:
+  StatusOr<std::optional<std::string>> Lookup(
+      const std::string& key) override {
+    mutex_lock lock(mu_);
+    auto it = values_.find(key);
+    if (it == values_.end()) {
+      return StatusOr<std::optional<std::string>>(std::nullopt);
+    }
+    return std::optional<std::string>(it->second);
+  }
+
+  Status Store(const std::string& key, const std::string& value) override {
+    mutex_lock lock(mu_);
+    values_[key] = value;
+    if (!stored_.HasBeenNotified()) stored_.Notify();
+    return OkStatus();
+  }
+
+  void WaitForStore() { stored_.WaitForNotification(); }
+
+  void CorruptValues() {
+    mutex_lock lock(mu_);
+    for (auto& [key, value] : values_) value.back() ^= 1;
+  }
+
+ private:
+  mutex mu_;
+  std::map<std::string, std::string> values_ TF_GUARDED_BY(mu_);
+  Notification stored_;
+};
+
 std::string GetFilePath(XlaSerializedCacheKey key,
                         const std::string& persistent_cache_dir) {
   static constexpr char kXlaSerializedCacheKeySeparator[] = "__";
@@ -606,5 +644,78 @@ TEST_F(DeviceExecutionPersistorTest, PersistPjRtAndXlaExecutables) {
   EXPECT_EQ(entry.executable(), serialized_xla_executable_);
 }
 
+TEST_F(DeviceExecutionPersistorTest, PersistAndLoadRemoteCache) {
+  auto remote_cache = std::make_shared<FakeRemoteCache>();
+  XlaDeviceExecutablePersistor::Config persist_config(
+      /*persistent_cache_directory=*/"",
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  persist_config.remote_cache = remote_cache;
+  XlaDeviceExecutablePersistor persist_persistor(
+      persist_config, DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_EXPECT_OK(persist_persistor.TryToPersistExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+  remote_cache->WaitForStore();
+
+  // Another process, whose persistent cache directory doesn't have the entry.
+  const std::string local_dir = io::JoinPath(cache_dir_, "remote_read");
+  XlaDeviceExecutablePersistor::Config load_config(
+      /*persistent_cache_directory=*/local_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  load_config.remote_cache = remote_cache;
+  XlaDeviceExecutablePersistor load_persistor(load_config,
+                                              DefaultXlaOptions().device_type);
+
+  EXPECT_CALL(mock_client, LoadExecutable(_, _, serialized_xla_executable_))
+      .WillOnce(Return(ByMove(std::move(executable))));
+  auto loaded_executable = load_persistor.TryToLoadExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, &mock_client);
+  ASSERT_TRUE(loaded_executable.has_value());
+  TF_EXPECT_OK(loaded_executable->status());
+
+  // The entry was kept in the persistent cache directory.
+  auto key = CreateCacheKey(/*signature_hash=*/123, compilation_result_add_,
+                            load_persistor.device_type(),
+                            load_persistor.persistence_prefix());
+  TF_ASSERT_OK_AND_ASSIGN(auto entry, ReadCacheEntryFromFile(key, local_dir));
+  EXPECT_EQ(entry.executable(), serialized_xla_executable_);
+}
+
+TEST_F(DeviceExecutionPersistorTest, LoadRemoteCacheCorruptedEntry) {
+  auto remote_cache = std::make_shared<FakeRemoteCache>();
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/"",
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  config.remote_cache = remote_cache;
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_EXPECT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+  remote_cache->WaitForStore();
+  remote_cache->CorruptValues();
+
+  // Corrupted entries are ignored, so that the executable gets compiled.
+  EXPECT_CALL(mock_client, LoadExecutable(_, _, _)).Times(0);
+  auto loaded_executable = persistor.TryToLoadExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, &mock_client);
+  EXPECT_FALSE(loaded_executable.has_value());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,124 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/device_executable_remote_cache.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+
+namespace tensorflow {
+namespace {
+
+// Keeps each value in a file of `directory`. Values are written to a temporary
+// file first and then renamed, so that readers never see partial values.
+class FileSystemRemoteCache : public DeviceExecutableRemoteCache {
+ public:
+  explicit FileSystemRemoteCache(absl::string_view directory)
+      : directory_(directory) {}
+
+  StatusOr<std::optional<std::string>> Lookup(
+      const std::string& key) override {
+    Env* env = Env::Default();
+    const std::string file_path = GetFilePath(key);
+    Status status = env->FileExists(file_path);
+    if (errors::IsNotFound(status)) {
+      return StatusOr<std::optional<std::string>>(std::nullopt);
+    }
+    TF_RETURN_IF_ERROR(status);
+    std::string value;
+    TF_RETURN_IF_ERROR(ReadFileToString(env, file_path, &value));
+    return std::optional<std::string>(std::move(value));
+  }
+
+  Status Store(const std::string& key, const std::string& value) override {
+    Env* env = Env::Default();
+    TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory_));
+    const std::string file_path = GetFilePath(key);
+    std::string tmp_file_path = io::JoinPath(directory_, key);
+    if (!env->CreateUniqueFileName(&tmp_file_path, ".tmp")) {
+      return errors::Internal("Could not create a temporary file name for ",
+                              file_path);
+    }
+    TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_file_path, value));
+    Status status = env->RenameFile(tmp_file_path, file_path);
+    if (!status.ok()) env->DeleteFile(tmp_file_path).IgnoreError();
+    return status;
+  }
+
+ private:
+  std::string GetFilePath(const std::string& key) const {
+    return io::JoinPath(directory_, absl::StrCat(key, ".pb"));
+  }
+
+  const std::string directory_;
+};
+
+struct RemoteCacheRegistry {
+  mutex mu;
+  absl::flat_hash_map<std::string, DeviceExecutableRemoteCacheFactory>
+      factories TF_GUARDED_BY(mu);
+};
+
+RemoteCacheRegistry* GetRemoteCacheRegistry() {
+  static RemoteCacheRegistry* registry = new RemoteCacheRegistry;
+  return registry;
+}
+
+}  // namespace
+
+Status RegisterDeviceExecutableRemoteCache(
+    const std::string& scheme, DeviceExecutableRemoteCacheFactory factory) {
+  RemoteCacheRegistry* registry = GetRemoteCacheRegistry();
+  mutex_lock lock(registry->mu);
+  if (!registry->factories.emplace(scheme, std::move(factory)).second) {
+    return errors::AlreadyExists(
+        "A remote compilation cache is already registered for scheme ",
+        scheme);
+  }
+  return OkStatus();
+}
+
+StatusOr<std::unique_ptr<DeviceExecutableRemoteCache>>
+CreateDeviceExecutableRemoteCache(absl::string_view spec) {
+  if (spec.empty()) {
+    return errors::InvalidArgument("Empty remote compilation cache spec.");
+  }
+  StringPiece scheme, host, path;
+  io::ParseURI(spec, &scheme, &host, &path);
+  DeviceExecutableRemoteCacheFactory factory;
+  if (!scheme.empty()) {
+    RemoteCacheRegistry* registry = GetRemoteCacheRegistry();
+    mutex_lock lock(registry->mu);
+    auto it = registry->factories.find(std::string(scheme));
+    if (it != registry->factories.end()) factory = it->second;
+  }
+  if (factory) {
+    constexpr absl::string_view kSchemeSeparator = "://";
+    return factory(spec.substr(scheme.size() + kSchemeSeparator.size()));
+  }
+  return std::unique_ptr<DeviceExecutableRemoteCache>(
+      std::make_unique<FileSystemRemoteCache>(spec));
+}
+
+}  // namespace tensorflow
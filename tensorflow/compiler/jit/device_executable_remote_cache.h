@@ -0,0 +1,68 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_REMOTE_CACHE_H_
+#define TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_REMOTE_CACHE_H_
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+
+// A cache of serialized executables shared by many processes (e.g. all the
+// replicas of a job), consulted by `DeviceExecutablePersistor` when an
+// executable isn't found in its local `persistent_cache_directory`. Values are
+// opaque to the cache; the persistor checks their integrity when loading them.
+// Implementations must be thread-safe.
+class DeviceExecutableRemoteCache {
+ public:
+  virtual ~DeviceExecutableRemoteCache() = default;
+
+  // Returns std::nullopt if there is no value for `key`.
+  virtual StatusOr<std::optional<std::string>> Lookup(
+      const std::string& key) = 0;
+
+  // Stores `value` for `key`, replacing any existing value. Concurrent stores
+  // for the same key may happen from different processes, and must leave one
+  // of the values complete.
+  virtual Status Store(const std::string& key, const std::string& value) = 0;
+};
+
+// Creates a remote cache from the part of a remote cache spec that follows the
+// backend's scheme, e.g. "host:port/path" for "mycache://host:port/path".
+using DeviceExecutableRemoteCacheFactory =
+    std::function<StatusOr<std::unique_ptr<DeviceExecutableRemoteCache>>(
+        absl::string_view address)>;
+
+// Registers the backend used for remote cache specs with URI scheme `scheme`.
+// Fails if a backend is already registered for it.
+Status RegisterDeviceExecutableRemoteCache(
+    const std::string& scheme, DeviceExecutableRemoteCacheFactory factory);
+
+// Creates the remote cache described by `spec`. Specs whose scheme has a
+// registered backend are handled by it; any other spec is taken as a
+// directory of a file system known to `Env` (e.g. "gs://bucket/xla_cache").
+StatusOr<std::unique_ptr<DeviceExecutableRemoteCache>>
+CreateDeviceExecutableRemoteCache(absl::string_view spec);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_REMOTE_CACHE_H_
@@ -154,7 +154,19 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_persistent_cache_prefix",
            &mark_for_compilation_flags->tf_xla_persistent_cache_prefix,
            "Specifies the persistance cache prefix. Default is "
-           "\"xla_compile_cache\"")};
+           "\"xla_compile_cache\""),
+      Flag("tf_xla_remote_compilation_cache",
+           &mark_for_compilation_flags->tf_xla_remote_compilation_cache,
+           "If non-empty, JIT-compiled executables are shared with other "
+           "processes through the remote compilation cache with this spec: "
+           "either a directory of any supported file system, or a URI whose "
+           "scheme has a registered remote cache backend. Empty by default."),
+      Flag("tf_xla_batch_buckets",
+           &mark_for_compilation_flags->tf_xla_batch_buckets,
+           "(experimental) Comma separated list of batch sizes. Dynamic "
+           "leading dimensions of auto-clustered XLA cluster inputs are "
+           "padded up to the smallest bucket that fits, so that a cluster is "
+           "compiled at most once per bucket. Empty (disabled) by default.")};
   flag_list->insert(flag_list->end(), new_flags.begin(), new_flags.end());
 }
 
@@ -205,6 +217,8 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_disable_strict_signature_checks = false;
   mark_for_compilation_flags->tf_xla_persistent_cache_prefix =
       "xla_compile_cache";
+  mark_for_compilation_flags->tf_xla_remote_compilation_cache = "";
+  mark_for_compilation_flags->tf_xla_batch_buckets = "";
 
   device_flags = new XlaDeviceFlags;
   device_flags->tf_xla_compile_on_demand = false;
@@ -213,6 +227,10 @@ void AllocateAndParseFlags() {
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_async_compilation_threads = 2;
+  ops_flags->tf_xla_async_compilation_idle_timeout_secs = 0;
+  ops_flags->tf_xla_adaptive_jit_max_compile_time_us_per_execution = 0;
+  ops_flags->tf_xla_adaptive_jit_decisions_file = "";
   ops_flags->tf_xla_use_device_api = false;
 
   // The `enable_mlir_bridge` flag allows the user to explicitly request that
@@ -267,6 +285,29 @@ void AllocateAndParseFlags() {
             "When lazy compilation is enabled, asynchronous compilation starts "
             "the cluster compilation in the background, and the fallback path "
             "is executed until the compilation has finished."),
+       Flag("tf_xla_async_compilation_threads",
+            &ops_flags->tf_xla_async_compilation_threads,
+            "Number of asynchronous compilations that run at the same time. "
+            "The others wait, and start in order of the execution count of "
+            "their cluster."),
+       Flag("tf_xla_async_compilation_idle_timeout_secs",
+            &ops_flags->tf_xla_async_compilation_idle_timeout_secs,
+            "If positive, waiting asynchronous compilations whose signature "
+            "hasn't been requested for this many seconds are cancelled. "
+            "Disabled by default."),
+       Flag("tf_xla_adaptive_jit_max_compile_time_us_per_execution",
+            &ops_flags->tf_xla_adaptive_jit_max_compile_time_us_per_execution,
+            "If positive, a cluster stops being compiled for new signatures "
+            "once its cumulative compile time exceeds this many microseconds "
+            "per execution of the cluster, and runs in TF instead. Disabled "
+            "by default."),
+       Flag("tf_xla_adaptive_jit_decisions_file",
+            &ops_flags->tf_xla_adaptive_jit_decisions_file,
+            "If non-empty, the clusters that "
+            "--tf_xla_adaptive_jit_max_compile_time_us_per_execution stopped "
+            "compiling are appended to this file, and are not compiled by "
+            "later processes either. Use together with "
+            "--tf_xla_deterministic_cluster_names."),
        Flag("tf_xla_use_device_api", &ops_flags->tf_xla_use_device_api,
             "If true, uses the Device API (PjRt) for single device compilation."
             " Defaults to false."),
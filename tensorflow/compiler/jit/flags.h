@@ -101,6 +101,19 @@ struct MarkForCompilationPassFlags {
 
   // Specifies the persistance cache prefix. Default is "xla_compile_cache"
   string tf_xla_persistent_cache_prefix;
+
+  // If non-empty, JIT-compiled executables not found in
+  // `tf_xla_persistent_cache_directory` are looked up in, and written back to,
+  // the remote compilation cache with this spec (see
+  // CreateDeviceExecutableRemoteCache).
+  std::string tf_xla_remote_compilation_cache;
+
+  // If non-empty, a comma separated list of batch sizes (e.g. "8,16,32").
+  // Auto-clustered XLA clusters whose inputs have a dynamic leading dimension
+  // get that dimension padded up to the smallest bucket that fits, bounding
+  // the number of distinct shapes each cluster is compiled for.  See
+  // IncreaseDynamismForAutoJitPass.
+  string tf_xla_batch_buckets;
 };
 
 // Flags associated with the XLA bridge's xla_device module.
@@ -123,6 +136,19 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
   bool tf_xla_async_compilation;
+  // Number of asynchronous compilations that run at the same time. The others
+  // wait, ordered by the execution count of their cluster.
+  int32 tf_xla_async_compilation_threads;
+  // If positive, waiting asynchronous compilations whose signature hasn't been
+  // requested for this many seconds are cancelled.
+  int64_t tf_xla_async_compilation_idle_timeout_secs;
+  // If positive, _XlaCompile stops compiling a cluster for new signatures once
+  // its cumulative compile time exceeds this many microseconds per execution.
+  int64_t tf_xla_adaptive_jit_max_compile_time_us_per_execution;
+  // If non-empty, clusters that stopped being compiled because of
+  // `tf_xla_adaptive_jit_max_compile_time_us_per_execution` are recorded in
+  // this file, and are not compiled by later processes either.
+  std::string tf_xla_adaptive_jit_decisions_file;
   // If true, uses Device API (PjRt) for single device compilation. Defaults to
   // false.
   bool tf_xla_use_device_api;
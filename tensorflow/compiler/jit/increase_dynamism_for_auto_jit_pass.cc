@@ -15,16 +15,24 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/increase_dynamism_for_auto_jit_pass.h"
 #include <iterator>
+#include <map>
+#include <set>
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_replace.h"
+#include "absl/strings/str_split.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "tensorflow/cc/framework/scope_internal.h"
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/logging_ops.h"
 #include "tensorflow/cc/ops/math_ops.h"
 #include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/cc/ops/xla_ops.h"
 #include "tensorflow/compiler/xla/status_macros.h"
@@ -370,6 +378,435 @@ Status FindAndRewriteSlices(Graph* g, bool* changed) {
 
   return OkStatus();
 }
+// Returns the batch buckets configured by --tf_xla_batch_buckets, sorted and
+// deduplicated.  An empty result means batch bucketing is disabled.
+StatusOr<std::vector<int64_t>> ParseBatchBuckets(absl::string_view spec) {
+  std::vector<int64_t> buckets;
+  for (absl::string_view piece :
+       absl::StrSplit(spec, ',', absl::SkipWhitespace())) {
+    int64_t bucket;
+    if (!absl::SimpleAtoi(piece, &bucket) || bucket <= 0) {
+      return errors::InvalidArgument("Invalid batch bucket \"", piece,
+                                     "\" in --tf_xla_batch_buckets=", spec);
+    }
+    buckets.push_back(bucket);
+  }
+  absl::c_sort(buckets);
+  buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+  return buckets;
+}
+
+// Returns true if `n` computes every row of its output from the same row of
+// its (broadcasted) inputs.  Padding rows added to the batch dimension of such
+// an op's inputs only produce padding rows in its output.
+bool IsRowwiseElementwiseOp(const Node& n) {
+  static const auto* const kRowwiseElementwiseOps =
+      new absl::flat_hash_set<string>({
+          "Abs", "Add", "AddV2", "Cast", "Ceil", "ClipByValue", "Cos", "Div",
+          "DivNoNan", "Elu", "Equal", "Erf", "Exp", "Expm1", "Floor",
+          "FloorDiv", "FloorMod", "Greater", "GreaterEqual", "Identity",
+          "LeakyRelu", "Less", "LessEqual", "Log", "Log1p", "LogicalAnd",
+          "LogicalNot", "LogicalOr", "Maximum", "Minimum", "Mul", "MulNoNan",
+          "Neg", "NotEqual", "Pow", "RealDiv", "Reciprocal", "Relu", "Relu6",
+          "Rsqrt", "SelectV2", "Selu", "Sigmoid", "Sign", "Sin", "Softplus",
+          "Softsign", "Sqrt", "Square", "SquaredDifference", "Sub", "Tanh",
+      });
+  return kRowwiseElementwiseOps->contains(n.type_string());
+}
+
+// Given the rank of each operand of `n` that carries the dynamic batch
+// dimension (or -1 for operands that don't) and the inferred shapes of all
+// operands, returns the rank of `n`'s output if `n` keeps the rows of the
+// batch independent, and nullopt otherwise.  Ops that reduce over, reshape or
+// reorder the batch dimension are not row independent: padding their inputs
+// would change the unpadded part of their result.
+StatusOrOptional<int> GetRowwiseOutputRank(
+    const Node& n, absl::Span<const int> batch_ranks,
+    absl::Span<const PartialTensorShape> operand_shapes) {
+  auto other_operands_are_static = [&](int batch_operand) {
+    for (int i = 0, end = batch_ranks.size(); i < end; i++) {
+      if (i != batch_operand && batch_ranks[i] != -1) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  if (IsRowwiseElementwiseOp(n)) {
+    int rank = -1;
+    for (int batch_rank : batch_ranks) {
+      if (batch_rank == -1) continue;
+      if (rank != -1 && rank != batch_rank) {
+        return {std::nullopt};
+      }
+      rank = batch_rank;
+    }
+    // Static operands must broadcast along the batch dimension.
+    for (int i = 0, end = batch_ranks.size(); i < end; i++) {
+      if (batch_ranks[i] != -1) continue;
+      const PartialTensorShape& shape = operand_shapes[i];
+      if (shape.unknown_rank() || shape.dims() > rank ||
+          (shape.dims() == rank && shape.dim_size(0) != 1)) {
+        return {std::nullopt};
+      }
+    }
+    return {rank};
+  }
+
+  const string& op = n.type_string();
+  if (op == "BiasAdd" || op == "Softmax" || op == "LogSoftmax") {
+    if (batch_ranks[0] >= 2 && other_operands_are_static(0)) {
+      return {batch_ranks[0]};
+    }
+    return {std::nullopt};
+  }
+
+  if (op == "MatMul") {
+    bool transpose_a;
+    TF_RETURN_IF_ERROR(GetNodeAttr(n.def(), "transpose_a", &transpose_a));
+    if (!transpose_a && batch_ranks[0] == 2 && other_operands_are_static(0)) {
+      return {2};
+    }
+    return {std::nullopt};
+  }
+
+  if (op == "Conv2D" || op == "DepthwiseConv2dNative" || op == "MaxPool" ||
+      op == "AvgPool") {
+    // The batch dimension is the leading one in both NHWC and NCHW.
+    if (batch_ranks[0] == 4 && other_operands_are_static(0)) {
+      return {4};
+    }
+    return {std::nullopt};
+  }
+
+  return {std::nullopt};
+}
+
+// A tensor whose leading (batch) dimension is dynamic.
+struct BatchTensor {
+  Output tensor;
+  int rank;
+};
+
+// An XLA cluster whose dynamic batch dimension can be padded to a bucket.
+struct BatchBucketingCandidate {
+  string cluster_name;
+  string device_name;
+
+  // Distinct tensors flowing into the cluster with a dynamic batch dimension.
+  std::vector<BatchTensor> inputs;
+
+  // Distinct tensors flowing out of the cluster that carry the batch
+  // dimension of `inputs`.
+  std::vector<BatchTensor> outputs;
+};
+
+const PartialTensorShape* GetInferredShape(const GraphShapeInfo& shape_info,
+                                           const Node* n, int output) {
+  auto it = shape_info.find(n->name());
+  if (it == shape_info.end() || output >= static_cast<int>(it->second.size())) {
+    return nullptr;
+  }
+  return &it->second[output].shape;
+}
+
+// Returns a BatchBucketingCandidate for `cluster_name` if padding the dynamic
+// batch dimension of the cluster's inputs leaves the unpadded rows of the
+// cluster's outputs unchanged.  `cluster_nodes` must be in reverse post order.
+StatusOrOptional<BatchBucketingCandidate> GetBatchBucketingCandidate(
+    absl::string_view cluster_name, absl::Span<Node* const> cluster_nodes,
+    const GraphShapeInfo& shape_info) {
+  auto in_cluster = [&](const Node* n) {
+    return GetXlaClusterForNode(*n) == cluster_name;
+  };
+
+  BatchBucketingCandidate candidate;
+  candidate.cluster_name = string(cluster_name);
+  candidate.device_name = cluster_nodes.front()->assigned_device_name();
+  if (candidate.device_name.empty()) {
+    return {std::nullopt};
+  }
+
+  // Maps every tensor in or flowing into the cluster that carries the batch
+  // dimension to its rank.
+  std::map<std::pair<const Node*, int>, int> batch_ranks;
+  for (Node* n : cluster_nodes) {
+    std::vector<int> operand_batch_ranks(n->num_inputs(), -1);
+    std::vector<PartialTensorShape> operand_shapes(n->num_inputs());
+    bool has_batch_operand = false;
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge()) continue;
+
+      std::pair<const Node*, int> key(e->src(), e->src_output());
+      const PartialTensorShape* shape =
+          GetInferredShape(shape_info, e->src(), e->src_output());
+      if (shape != nullptr) {
+        operand_shapes[e->dst_input()] = *shape;
+      }
+
+      auto it = batch_ranks.find(key);
+      if (it == batch_ranks.end() && !in_cluster(e->src()) &&
+          shape != nullptr && shape->dims() >= 1 && shape->dim_size(0) == -1) {
+        it = batch_ranks.insert({key, shape->dims()}).first;
+        candidate.inputs.push_back(
+            {Output(e->src(), e->src_output()), shape->dims()});
+      }
+      if (it != batch_ranks.end()) {
+        operand_batch_ranks[e->dst_input()] = it->second;
+        has_batch_operand = true;
+      }
+    }
+
+    if (!has_batch_operand) continue;
+
+    TF_ASSIGN_OR_RETURN(
+        std::optional<int> output_rank,
+        GetRowwiseOutputRank(*n, operand_batch_ranks, operand_shapes));
+    if (!output_rank.has_value()) {
+      VLOG(2) << "Not bucketing the batch dimension of " << cluster_name
+              << ": " << n->name() << " (" << n->type_string()
+              << ") does not keep the rows of the batch independent";
+      return {std::nullopt};
+    }
+    batch_ranks[{n, 0}] = *output_rank;
+  }
+
+  std::set<std::pair<const Node*, int>> seen_outputs;
+  for (Node* n : cluster_nodes) {
+    for (const Edge* e : n->out_edges()) {
+      if (e->IsControlEdge() || in_cluster(e->dst())) continue;
+      std::pair<const Node*, int> key(n, e->src_output());
+      auto it = batch_ranks.find(key);
+      if (it != batch_ranks.end() && seen_outputs.insert(key).second) {
+        candidate.outputs.push_back({Output(n, e->src_output()), it->second});
+      }
+    }
+  }
+
+  if (candidate.inputs.empty() || candidate.outputs.empty()) {
+    return {std::nullopt};
+  }
+  return {candidate};
+}
+
+// Pads the batch dimension of the cluster described by `candidate` up to the
+// smallest of `buckets` that fits it (or to a multiple of the largest bucket
+// if none does) and slices the padding rows off the cluster's outputs.
+Status BucketBatchDimension(Graph* g, const BatchBucketingCandidate& candidate,
+                            absl::Span<const int64_t> buckets,
+                            GraphShapeInfo* shape_info) {
+  string host_name;
+  TF_RETURN_IF_ERROR(DeviceNameUtils::DeviceNameToCpuDeviceName(
+      candidate.device_name, &host_name));
+
+  Status status;
+  Scope device_scope =
+      NewInternalScope(g, &status, /*refiner=*/nullptr)
+          .NewSubScope(absl::StrCat(candidate.cluster_name, "/batch_bucketing"))
+          .WithAssignedDevice(candidate.device_name);
+  Scope host_scope = device_scope.WithAssignedDevice(host_name);
+
+  auto in_cluster = [&](const Node* n) {
+    return GetXlaClusterForNode(*n) == candidate.cluster_name;
+  };
+
+  // Constants get a control edge from the first batch input so that they end
+  // up in the same frame as the tensors they are combined with.
+  Node* anchor = candidate.inputs.front().tensor.node();
+  auto host_const = [&](absl::string_view name,
+                        const Input::Initializer& value) {
+    Output result = ops::Const(host_scope.WithOpName(name), value);
+    g->AddControlEdge(anchor, result.node());
+    return result;
+  };
+  auto host_vector_const = [&](absl::string_view name, int64_t size,
+                               int64_t value) {
+    Tensor t(DT_INT64, TensorShape({size}));
+    t.flat<int64_t>().setConstant(value);
+    return host_const(name, t);
+  };
+  auto batch_size_of = [&](const Output& x, int i) {
+    Output shape = ops::Shape(device_scope.WithOpName("shape_", i), x,
+                              ops::Shape::OutType(DT_INT64));
+    return ops::Slice(host_scope.WithOpName("batch_size_", i), shape,
+                      host_vector_const("begin", 1, 0),
+                      host_vector_const("size", 1, 1));
+  };
+
+  Tensor buckets_tensor(DT_INT64,
+                        TensorShape({static_cast<int64_t>(buckets.size())}));
+  absl::c_copy(buckets, buckets_tensor.flat<int64_t>().data());
+  Output buckets_const = host_const("buckets", buckets_tensor);
+  Output largest_bucket =
+      host_vector_const("largest_bucket", 1, buckets.back());
+  Output concat_axis = host_const("concat_axis", 0);
+
+  // padded_batch_size = batch_size <= largest_bucket
+  //     ? buckets[min(count(buckets < batch_size), len(buckets) - 1)]
+  //     : round_up(batch_size, largest_bucket)
+  Output batch_size = batch_size_of(candidate.inputs.front().tensor, 0);
+  Output bucket_index = ops::Minimum(
+      host_scope.WithOpName("bucket_index"),
+      ops::Sum(host_scope.WithOpName("smaller_buckets"),
+               ops::Cast(host_scope.WithOpName("is_smaller_bucket"),
+                         ops::Less(host_scope.WithOpName("less"),
+                                   buckets_const, batch_size),
+                         DT_INT64),
+               host_vector_const("reduction_axis", 1, 0),
+               ops::Sum::KeepDims(true)),
+      host_vector_const("last_bucket_index", 1, buckets.size() - 1));
+  Output bucket = ops::GatherV2(host_scope.WithOpName("bucket"),
+                                buckets_const, bucket_index,
+                                host_const("gather_axis", int64_t{0}));
+  Output rounded_batch_size = ops::Mul(
+      host_scope.WithOpName("rounded_batch_size"),
+      ops::FloorDiv(host_scope.WithOpName("largest_bucket_multiple"),
+                    ops::Add(host_scope.WithOpName("round_up"), batch_size,
+                             host_vector_const("largest_bucket_minus_one", 1,
+                                               buckets.back() - 1)),
+                    largest_bucket),
+      largest_bucket);
+  Output padded_batch_size = ops::SelectV2(
+      host_scope.WithOpName("padded_batch_size"),
+      ops::LessEqual(host_scope.WithOpName("fits_in_bucket"), batch_size,
+                     largest_bucket),
+      bucket, rounded_batch_size);
+
+  for (int i = 0, end = candidate.inputs.size(); i < end; i++) {
+    const BatchTensor& input = candidate.inputs[i];
+
+    std::vector<const Edge*> edges_to_rewire;
+    absl::c_copy_if(input.tensor.node()->out_edges(),
+                    std::back_inserter(edges_to_rewire), [&](const Edge* e) {
+                      return e->src_output() == input.tensor.index() &&
+                             in_cluster(e->dst());
+                    });
+
+    // All batch inputs must agree on the batch size, otherwise the rows we
+    // pad would not line up.
+    Output input_batch_size =
+        i == 0 ? batch_size : batch_size_of(input.tensor, i);
+    std::optional<ops::Assert> same_batch_size;
+    if (i != 0) {
+      same_batch_size.emplace(
+          host_scope.WithOpName("assert_same_batch_size_", i),
+          ops::All(host_scope.WithOpName("same_batch_size_", i),
+                   ops::Equal(host_scope.WithOpName("equal_batch_size_", i),
+                              input_batch_size, batch_size),
+                   host_vector_const("reduction_axis", 1, 0)),
+          std::initializer_list<Input>{input_batch_size, batch_size});
+    }
+
+    std::vector<Output> paddings = {
+        host_vector_const("zero", 1, 0),
+        ops::Sub(host_scope.WithOpName("batch_padding_", i), padded_batch_size,
+                 input_batch_size)};
+    if (input.rank > 1) {
+      paddings.push_back(host_vector_const("zeros", 2 * (input.rank - 1), 0));
+    }
+    Output paddings_matrix = ops::Reshape(
+        host_scope.WithOpName("paddings_", i),
+        ops::Concat(host_scope.WithOpName("flat_paddings_", i),
+                    InputList(paddings), concat_axis),
+        host_const("paddings_shape", {int64_t{input.rank}, int64_t{2}}));
+    Output padded = ops::Pad(device_scope.WithOpName("padded_input_", i),
+                             input.tensor, paddings_matrix);
+    if (same_batch_size.has_value()) {
+      g->AddControlEdge(same_batch_size->operation.node(), padded.node());
+    }
+
+    for (const Edge* e : edges_to_rewire) {
+      Node* dst = e->dst();
+      int dst_input = e->dst_input();
+      g->RemoveEdge(e);
+      g->AddEdge(padded.node(), 0, dst, dst_input);
+    }
+  }
+
+  for (int i = 0, end = candidate.outputs.size(); i < end; i++) {
+    const BatchTensor& output = candidate.outputs[i];
+
+    std::vector<const Edge*> edges_to_rewire;
+    absl::c_copy_if(output.tensor.node()->out_edges(),
+                    std::back_inserter(edges_to_rewire), [&](const Edge* e) {
+                      return e->src_output() == output.tensor.index() &&
+                             !in_cluster(e->dst());
+                    });
+
+    Output size = batch_size;
+    if (output.rank > 1) {
+      size = ops::Concat(host_scope.WithOpName("unpadded_size_", i),
+                         {batch_size, host_vector_const("minus_ones",
+                                                        output.rank - 1, -1)},
+                         concat_axis);
+    }
+    Output unpadded = ops::Slice(
+        device_scope.WithOpName("unpadded_output_", i), output.tensor,
+        host_vector_const("zeros", output.rank, 0), size);
+
+    for (const Edge* e : edges_to_rewire) {
+      Node* dst = e->dst();
+      int dst_input = e->dst_input();
+      g->RemoveEdge(e);
+      g->AddEdge(unpadded.node(), 0, dst, dst_input);
+    }
+
+    // Clusters downstream of this one see the batch dimension through the
+    // slice.
+    const PartialTensorShape* shape = GetInferredShape(
+        *shape_info, output.tensor.node(), output.tensor.index());
+    if (shape != nullptr) {
+      InferredShape inferred;
+      inferred.shape = *shape;
+      (*shape_info)[unpadded.node()->name()] = {inferred};
+    }
+  }
+
+  TF_RETURN_IF_ERROR(device_scope.status());
+  return status;
+}
+
+Status FindAndBucketBatchDimensions(Graph* g,
+                                    const FunctionLibraryDefinition* flib_def,
+                                    absl::Span<const int64_t> buckets,
+                                    bool* changed) {
+  *changed = false;
+
+  // Visit clusters in name order, and the nodes of each cluster in reverse
+  // post order, so that the rewrite is deterministic.
+  std::vector<Node*> rpo;
+  GetReversePostOrder(*g, &rpo, NodeComparatorName());
+  std::map<string, std::vector<Node*>> clusters;
+  for (Node* n : rpo) {
+    std::optional<absl::string_view> cluster = GetXlaClusterForNode(*n);
+    if (cluster.has_value()) {
+      clusters[string(*cluster)].push_back(n);
+    }
+  }
+  if (clusters.empty()) {
+    return OkStatus();
+  }
+
+  GraphShapeInfo shape_info;
+  TF_RETURN_IF_ERROR(InferShapes(g, /*arg_shapes=*/{}, flib_def, &shape_info));
+
+  for (const auto& cluster : clusters) {
+    TF_ASSIGN_OR_RETURN(
+        std::optional<BatchBucketingCandidate> candidate,
+        GetBatchBucketingCandidate(cluster.first, cluster.second, shape_info));
+    if (!candidate.has_value()) continue;
+
+    VLOG(3) << "Bucketing the batch dimension of " << cluster.first;
+    TF_RETURN_IF_ERROR(
+        BucketBatchDimension(g, *candidate, buckets, &shape_info));
+    *changed = true;
+  }
+
+  if (*changed) {
+    FixupSourceAndSinkEdges(g);
+  }
+  return OkStatus();
+}
 }  // namespace
 
 Status IncreaseDynamismForAutoJitPass::Run(
@@ -380,8 +817,17 @@ Status IncreaseDynamismForAutoJitPass::Run(
                     **options.graph, options.flib_def);
   }
 
+  TF_ASSIGN_OR_RETURN(std::vector<int64_t> batch_buckets,
+                      ParseBatchBuckets(flags->tf_xla_batch_buckets));
+
   bool changed;
   TF_RETURN_IF_ERROR(FindAndRewriteSlices(options.graph->get(), &changed));
+  if (!batch_buckets.empty()) {
+    bool bucketed;
+    TF_RETURN_IF_ERROR(FindAndBucketBatchDimensions(
+        options.graph->get(), options.flib_def, batch_buckets, &bucketed));
+    changed |= bucketed;
+  }
   if (changed && flags->tf_xla_clustering_debug) {
     DumpGraphToFile("increase_dynamism_for_auto_jit_pass", **options.graph,
                     options.flib_def);
@@ -43,6 +43,24 @@ namespace tensorflow {
 // only on the actual size of the XlaDynamicSlice.  This avoids recompilation
 // due to superficial changes that don't affect tensor shapes.
 //
+// Batch bucketing
+// ---------------
+//
+// If --tf_xla_batch_buckets is set, each XLA cluster whose inputs have a
+// dynamic leading ("batch") dimension is rewritten as
+//
+//   cluster(x_0, ..., x_n) =>
+//     Slice(cluster(Pad(x_0, bucket(n_0) - n_0), ...), size=[n_0, -1, ...])
+//
+// where n_i is the batch size of x_i and bucket(n) is the smallest configured
+// bucket >= n, or n rounded up to a multiple of the largest bucket.  The
+// cluster is then compiled once per bucket rather than once per batch size.
+// Only clusters in which every op that sees the batch dimension computes each
+// row independently of the others (elementwise ops, MatMul, convolutions,
+// pooling, ...) are rewritten, since for those the padding rows never leak
+// into the unpadded part of the result.  All batch inputs of a rewritten
+// cluster must have the same batch size at runtime.
+//
 // Future Work TODO(b/111210515)
 // -----------------------------
 //
@@ -18,9 +18,13 @@ limitations under the License.
 #include "tensorflow/cc/framework/ops.h"
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/cc/ops/nn_ops.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/node_matchers.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -454,5 +458,80 @@ TEST(SliceToDynamicSliceRewriteTest, DontRewriteSliceWithConstBegin) {
                                            Out(NodeWith(Op("Const"))))));
 }
 
+// Sets --tf_xla_batch_buckets for the duration of a test.
+auto SetBatchBuckets(const string& buckets) {
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  string old_buckets = flags->tf_xla_batch_buckets;
+  flags->tf_xla_batch_buckets = buckets;
+  return gtl::MakeCleanup(
+      [flags, old_buckets]() { flags->tf_xla_batch_buckets = old_buckets; });
+}
+
+TEST(BatchBucketingTest, PadsBatchDimension) {
+  auto reset_buckets = SetBatchBuckets("8,16");
+
+  Scope root = Scope::NewRootScope().ExitOnError().WithAssignedDevice(
+      kDeviceName);
+  Scope cluster = root.WithXlaCluster("cluster_0");
+
+  Output input = ops::Placeholder(root.WithOpName("input"), DT_FLOAT,
+                                  ops::Placeholder::Shape({-1, 4}));
+  Output weights =
+      ops::Const(cluster.WithOpName("weights"), 1.0f, TensorShape({4, 2}));
+  Output matmul = ops::MatMul(cluster.WithOpName("matmul"), input, weights);
+  Output relu = ops::Relu(cluster.WithOpName("relu"), matmul);
+  Output output = ops::Identity(root.WithOpName("output"), relu);
+
+  std::unique_ptr<Graph> result;
+  TF_ASSERT_OK(IncreaseDynamismForAutoJit(root, &result));
+
+  auto m_input = Out(NodeWith(Op("Placeholder"), Name("input")));
+  auto m_padded_input =
+      Out(NodeWith(Op("Pad"), AssignedDevice(kDeviceName), Inputs(m_input, _)));
+  EXPECT_THAT(testing::FindNodeByName(result.get(), "matmul"),
+              NodeWith(Op("MatMul"), Inputs(m_padded_input, _)));
+
+  auto m_relu = Out(NodeWith(Op("Relu"), Name("relu")));
+  auto m_unpadded_output = Out(NodeWith(
+      Op("Slice"), AssignedDevice(kDeviceName), Inputs(m_relu, _, _)));
+  EXPECT_THAT(testing::FindNodeByName(result.get(), "output"),
+              NodeWith(Op("Identity"), Inputs(m_unpadded_output)));
+}
+
+TEST(BatchBucketingTest, DontPadClusterReducingOverBatch) {
+  auto reset_buckets = SetBatchBuckets("8,16");
+
+  Scope root = Scope::NewRootScope().ExitOnError().WithAssignedDevice(
+      kDeviceName);
+  Scope cluster = root.WithXlaCluster("cluster_0");
+
+  Output input = ops::Placeholder(root.WithOpName("input"), DT_FLOAT,
+                                  ops::Placeholder::Shape({-1, 4}));
+  Output relu = ops::Relu(cluster.WithOpName("relu"), input);
+  Output sum = ops::Sum(cluster.WithOpName("sum"), relu,
+                        ops::Const(cluster.WithOpName("axis"), 0));
+  Output output = ops::Identity(root.WithOpName("output"), sum);
+
+  std::unique_ptr<Graph> result;
+  TF_ASSERT_OK(IncreaseDynamismForAutoJit(root, &result));
+
+  for (Node* n : result->nodes()) {
+    EXPECT_NE(n->type_string(), "Pad") << n->name();
+  }
+  EXPECT_THAT(testing::FindNodeByName(result.get(), "relu"),
+              NodeWith(Op("Relu"), Inputs(Out(NodeWith(Name("input"))))));
+}
+
+TEST(BatchBucketingTest, InvalidBuckets) {
+  auto reset_buckets = SetBatchBuckets("8,sixteen");
+
+  Scope root = Scope::NewRootScope().ExitOnError();
+  ops::Placeholder(root.WithOpName("input"), DT_FLOAT);
+
+  std::unique_ptr<Graph> result;
+  Status status = IncreaseDynamismForAutoJit(root, &result);
+  EXPECT_EQ(status.code(), error::INVALID_ARGUMENT) << status;
+}
+
 }  // namespace
 }  // namespace tensorflow
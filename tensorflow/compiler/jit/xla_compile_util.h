@@ -22,7 +22,8 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 
 namespace tensorflow {
-// The number of compiler threads to use for asynchronous device compilation.
+// The maximum number of asynchronous device compilations that are waiting or
+// running at the same time.
 inline constexpr int64_t kNumAsyncDeviceCompilerThreads = 10;
 
 enum class DeviceCompileMode {
@@ -22,6 +22,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/compiler/jit/device_executable_persistor.h"
+#include "tensorflow/compiler/jit/device_executable_remote_cache.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
@@ -46,6 +47,26 @@ XlaDeviceCompiler* CreateXlaDeviceCompiler(
                                std::move(compiler_client));
 }
 
+// Returns the remote compilation cache given by the flags, shared by all the
+// device compilers of the process, or nullptr if there is none.
+std::shared_ptr<DeviceExecutableRemoteCache> GetRemoteCompilationCache() {
+  static const auto* const remote_cache = [] {
+    auto* remote_cache = new std::shared_ptr<DeviceExecutableRemoteCache>;
+    const std::string& spec =
+        GetMarkForCompilationPassFlags()->tf_xla_remote_compilation_cache;
+    if (spec.empty()) return remote_cache;
+    auto created = CreateDeviceExecutableRemoteCache(spec);
+    if (created.ok()) {
+      *remote_cache = std::move(*created);
+    } else {
+      LOG(WARNING) << "Not using the remote compilation cache " << spec << ": "
+                   << created.status();
+    }
+    return remote_cache;
+  }();
+  return *remote_cache;
+}
+
 StatusOr<std::optional<std::set<int>>> GetAllowedGpus(
     FunctionLibraryRuntime* flr) {
   std::optional<std::set<int>> gpu_ids = std::nullopt;
@@ -88,6 +109,7 @@ Status BuildXlaDeviceCompiler(DeviceBase* device, FunctionLibraryRuntime* flr,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_directory,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix);
+  persistor_config.remote_cache = GetRemoteCompilationCache();
 
   if (platform_info.xla_device_metadata()) {
     *xla_device_compiler = CreateXlaDeviceCompiler(
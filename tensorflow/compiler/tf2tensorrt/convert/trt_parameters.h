@@ -53,6 +53,12 @@ string DebugString(const TrtPrecisionMode mode);
 //   inputs with the same dimensions as the input it is created for. The GPU
 //   engine will be run with optimal performance with such inputs.
 // - `kRangeOptimal`: create the profiles for both `Range` and `Optimal`.
+// - `kClustered`: weigh the provided inputs by how often each shape was seen,
+//   and create a small number of `Range` profiles, each covering a group of
+//   shapes of similar size that receives a similar share of the inputs. The
+//   optimal dimensions of each profile are the most frequent shape of its
+//   group. This suits inputs recorded from production traffic, where a few
+//   shapes dominate.
 // - `kImplicitBatchModeCompatible`: create the profiles that will produce the
 //   same GPU engines as the implicit_batch_mode would produce.
 enum class ProfileStrategy {
@@ -60,6 +66,7 @@ enum class ProfileStrategy {
   kOptimal,
   kRangeOptimal,
   kImplicitBatchModeCompatible,
+  kClustered,
 };
 
 string ProfileStrategyToName(const ProfileStrategy strategy);
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <numeric>
 
 #include "absl/algorithm/container.h"
 #include "tensorflow/compiler/tf2tensorrt/common/utils.h"
@@ -125,6 +126,76 @@ Status TrtShapeOptimizationProfile::RangeStrategy(
   return OkStatus();
 }
 
+// Maximum number of profiles created by the Clustered strategy. Each profile
+// adds an execution context, and makes the engine build slower.
+constexpr int kMaxClusteredProfiles = 4;
+
+// Returns the total number of elements described by dimvec, used to order the
+// shapes for clustering.
+int64_t NumElements(const std::vector<nvinfer1::Dims>& dimvec) {
+  int64_t total = 0;
+  for (const nvinfer1::Dims& dims : dimvec) {
+    int64_t n = 1;
+    for (int i = 0; i < dims.nbDims; i++) {
+      n *= std::max(dims.d[i], 0);
+    }
+    total += n;
+  }
+  return total;
+}
+
+Status TrtShapeOptimizationProfile::ClusteredStrategy(
+    const std::vector<std::vector<nvinfer1::Dims>>& collected_shapes,
+    const std::vector<int64_t>& counts) {
+  if (collected_shapes.empty()) return OkStatus();
+
+  // Order the shapes by size, and cut the ordered list into at most
+  // kMaxClusteredProfiles contiguous groups that receive roughly the same
+  // number of inputs.
+  std::vector<int> order(collected_shapes.size());
+  std::iota(order.begin(), order.end(), 0);
+  absl::c_stable_sort(order, [&](int a, int b) {
+    return NumElements(collected_shapes[a]) < NumElements(collected_shapes[b]);
+  });
+  const int64_t total_count = absl::c_accumulate(counts, int64_t{0});
+  const int num_groups =
+      std::min<int>(kMaxClusteredProfiles, collected_shapes.size());
+
+  int64_t seen = 0;
+  int group = 0;
+  int group_begin = 0;
+  for (int k = 0; k < order.size(); k++) {
+    seen += counts[order[k]];
+    const bool last = k + 1 == order.size();
+    // Close the group once it got its share of the inputs, but leave at least
+    // one shape for each remaining group.
+    const bool full = seen * num_groups >= total_count * (group + 1) ||
+                      order.size() - k - 1 == num_groups - group - 1;
+    if (!last && !full) continue;
+
+    std::vector<nvinfer1::Dims> min = collected_shapes[order[group_begin]];
+    std::vector<nvinfer1::Dims> max = min;
+    int opt_idx = order[group_begin];
+    for (int j = group_begin + 1; j <= k; j++) {
+      const std::vector<nvinfer1::Dims>& shapes = collected_shapes[order[j]];
+      TF_RETURN_IF_ERROR(ShapeProfileBinaryOp(
+          &min, shapes, [](int a, int b) { return std::min(a, b); }));
+      TF_RETURN_IF_ERROR(ShapeProfileBinaryOp(
+          &max, shapes, [](int a, int b) { return std::max(a, b); }));
+      if (counts[order[j]] > counts[opt_idx]) opt_idx = order[j];
+    }
+    VLOG(2) << "Initializing optimization profile config for "
+            << k + 1 - group_begin << " shape(s) with min=" << DebugString(min)
+            << ", opt=" << DebugString(collected_shapes[opt_idx])
+            << ", max=" << DebugString(max);
+    OptimizationProfileConfig profConfig{min, collected_shapes[opt_idx], max};
+    profiles_.push_back(std::move(profConfig));
+    group_begin = k + 1;
+    group++;
+  }
+  return OkStatus();
+}
+
 void TrtShapeOptimizationProfile::OptimalStrategy(
     const std::vector<std::vector<nvinfer1::Dims>>& collected_shapes) {
   for (auto& shape_vec : collected_shapes) {
@@ -243,10 +314,11 @@ void FixShapeValueProfile(OptimizationProfileConfig* prof,
   }
 }
 
-// Checks whether rhs is already contained in values.
-bool AlreadyCollected(const std::vector<std::vector<nvinfer1::Dims>>& values,
-                      const std::vector<nvinfer1::Dims>& rhs) {
-  for (auto& lhs : values) {
+// Returns the index of rhs in values, or -1 if it is not contained in values.
+int FindCollected(const std::vector<std::vector<nvinfer1::Dims>>& values,
+                  const std::vector<nvinfer1::Dims>& rhs) {
+  for (int k = 0; k < values.size(); k++) {
+    const auto& lhs = values[k];
     bool ret = lhs.size() == rhs.size();
     for (int i = 0; ret && i < lhs.size(); i++) {
       ret &= lhs[i].nbDims == rhs[i].nbDims;
@@ -254,9 +326,9 @@ bool AlreadyCollected(const std::vector<std::vector<nvinfer1::Dims>>& values,
         ret &= (lhs[i].d[j] == rhs[i].d[j]);
       }
     }
-    if (ret) return true;
+    if (ret) return k;
   }
-  return false;
+  return -1;
 }
 
 void TrtShapeOptimizationProfile::InitProfiles(
@@ -272,8 +344,10 @@ void TrtShapeOptimizationProfile::InitProfiles(
   // - Converts TensorShape -> nvinfer::Dims.
   // - Concatenates the shape values after the input shapes:
   //   dimvec = [dim0, dim1,..., shapeval0, shapval1, ...]
-  // - Ensures that the list is unique.
+  // - Ensures that the list is unique, and counts how often each element was
+  //   collected.
   std::vector<std::vector<nvinfer1::Dims>> collected_shapes;
+  std::vector<int64_t> collected_counts;
   for (int i = 0; i < input_shapes_.size(); i++) {
     auto shape_vec = input_shapes_[i];
     VLOG(2) << "Initprofiles, processing shape " << i;
@@ -290,8 +364,12 @@ void TrtShapeOptimizationProfile::InitProfiles(
       // that case consicutive elements in collected_shapes contain the user
       // defined values of min, opt and max, and it is valid the have min = opt
       // and opt = max.
-      if (!AlreadyCollected(collected_shapes, dimvec)) {
+      const int idx = FindCollected(collected_shapes, dimvec);
+      if (idx == -1) {
         collected_shapes.push_back(dimvec);
+        collected_counts.push_back(1);
+      } else {
+        collected_counts[idx]++;
       }
     }
   }
@@ -315,6 +393,10 @@ void TrtShapeOptimizationProfile::InitProfiles(
       VLOG(1) << "Creating profiles with Optimal strategy";
       OptimalStrategy(collected_shapes);
       break;
+    case ProfileStrategy::kClustered:
+      VLOG(1) << "Creating profiles with Clustered strategy";
+      TF_CHECK_OK(ClusteredStrategy(collected_shapes, collected_counts));
+      break;
   }
   // Define a mask that describe which input could be a shape tensor. Note
   // that here we can have false positives. The shape tensor mask will be
@@ -342,6 +342,10 @@ class TrtShapeOptimizationProfile {
       const std::vector<std::vector<nvinfer1::Dims>>& collected_shapes);
   Status RangeStrategy(
       const std::vector<std::vector<nvinfer1::Dims>>& collected_shapes);
+  // `counts[i]` is the number of times collected_shapes[i] was seen.
+  Status ClusteredStrategy(
+      const std::vector<std::vector<nvinfer1::Dims>>& collected_shapes,
+      const std::vector<int64_t>& counts);
 };
 
 }  // namespace tensorrt
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <string.h>
 
+#include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -152,7 +153,8 @@ INSTANTIATE_TEST_CASE_P(
     OptProfilesTestInstantiation, TrtShapeOptimizationProfileTest,
     ::testing::Values(ProfileStrategy::kRange, ProfileStrategy::kOptimal,
                       ProfileStrategy::kRangeOptimal,
-                      ProfileStrategy::kImplicitBatchModeCompatible));
+                      ProfileStrategy::kImplicitBatchModeCompatible,
+                      ProfileStrategy::kClustered));
 
 TEST_P(TrtShapeOptimizationProfileTest, Static) {
   // Static mode does not depend on strategies, we test only once.
@@ -223,6 +225,9 @@ TEST_P(TrtShapeOptimizationProfileTest, Dynamic) {
   switch (strategy_) {
     case (ProfileStrategy::kImplicitBatchModeCompatible):
     case (ProfileStrategy::kOptimal):
+    case (ProfileStrategy::kClustered):
+      // With fewer distinct shapes than the profile limit, the Clustered
+      // strategy puts every shape into its own profile.
       n_profiles_exp = input_profiles.size();
       break;
     case (ProfileStrategy::kRange):
@@ -242,7 +247,8 @@ TEST_P(TrtShapeOptimizationProfileTest, Dynamic) {
   // Check if the profiles are assigned correctly.
   for (auto dimvec : input_profiles) {
     bool test_optimal_prof = strategy_ == ProfileStrategy::kOptimal ||
-                             strategy_ == ProfileStrategy::kRangeOptimal;
+                             strategy_ == ProfileStrategy::kRangeOptimal ||
+                             strategy_ == ProfileStrategy::kClustered;
     CheckProfile(dimvec, &profile, true, test_optimal_prof);
   }
   bool has_prof = (strategy_ == ProfileStrategy::kRange ||
@@ -250,6 +256,53 @@ TEST_P(TrtShapeOptimizationProfileTest, Dynamic) {
   CheckProfile(unseen_shapes, &profile, has_prof, false);
 }
 
+TEST_P(TrtShapeOptimizationProfileTest, ClusteredFollowsTraffic) {
+  if (strategy_ != ProfileStrategy::kClustered) return;
+
+  nvinfer1::Dims3 dims(-1, -1, 10);
+  DefineNetwork(network_.get(), dims);
+
+  TrtShapeOptimizationProfile profile;
+  std::vector<bool> input_mask(2, true);
+  profile.SetInputMask(input_mask);
+
+  // Batch sizes seen in traffic, with the number of times each one was seen.
+  const std::vector<std::pair<int, int>> traffic{
+      {1, 50}, {2, 20}, {3, 5}, {4, 5}, {8, 10}, {16, 5}, {32, 5}};
+  for (const auto& [batch, count] : traffic) {
+    std::vector<nvinfer1::Dims3> dim_vec(2, nvinfer1::Dims3(batch, batch, 10));
+    for (int i = 0; i < count; i++) {
+      profile.AddShape(DimVecToShapeVec(dim_vec, true));
+    }
+  }
+  std::vector<PartialTensorShape> input_partial_shapes;
+  TF_CHECK_OK(GetNetworkInputShapes(network_.get(), &input_partial_shapes));
+  profile.InitProfiles(input_partial_shapes, strategy_);
+
+  TF_CHECK_OK(profile.ConfigureBuilder(builder_.get(), builder_config_.get(),
+                                       network_.get()));
+  engine = TrtUniquePtrType<nvinfer1::ICudaEngine>(
+      builder_->buildEngineWithConfig(*network_.get(), *builder_config_.get()));
+  ASSERT_NE(nullptr, engine);
+  TF_CHECK_OK(profile.CreateExecutionContexts(engine.get(), &exec_contexts_));
+
+  // The frequent small batches get their own profiles, the tail is covered by
+  // a single range profile.
+  EXPECT_EQ(exec_contexts_.size(), 4);
+  profile.SetShapeTensorMask(network_.get());
+  for (int batch : {1, 2, 3}) {
+    std::vector<nvinfer1::Dims3> dim_vec(2, nvinfer1::Dims3(batch, batch, 10));
+    CheckProfile(dim_vec, &profile, true, true);
+  }
+  for (int batch : {4, 8, 16, 32}) {
+    std::vector<nvinfer1::Dims3> dim_vec(2, nvinfer1::Dims3(batch, batch, 10));
+    CheckProfile(dim_vec, &profile, true, false);
+  }
+  // Unseen shapes inside the range of the last group are covered as well.
+  std::vector<nvinfer1::Dims3> unseen(2, nvinfer1::Dims3(20, 20, 10));
+  CheckProfile(unseen, &profile, true, false);
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 
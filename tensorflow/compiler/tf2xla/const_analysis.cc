@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/compiler/tf2xla/const_analysis.h"
 
+#include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/compiler/tf2xla/tf2xla_util.h"
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
 #include "tensorflow/compiler/xla/status_macros.h"
@@ -28,29 +30,55 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 
 namespace {
 
+// Compile-time constant arguments of function bodies, keyed by
+// FunctionFingerprint().
+struct FunctionConstArgsCache {
+  mutex mu;
+  absl::flat_hash_map<uint64, std::vector<bool>> const_args TF_GUARDED_BY(mu);
+};
+
+FunctionConstArgsCache& GetFunctionConstArgsCache() {
+  static FunctionConstArgsCache* cache = new FunctionConstArgsCache;
+  return *cache;
+}
+
+// Fingerprints the body and instantiation attributes of `function`, ignoring
+// its name so that identically defined functions share a fingerprint.
+uint64 FunctionFingerprint(const FunctionBody& fbody,
+                           const NameAttrList& function) {
+  FunctionDef fdef = fbody.fdef;
+  fdef.mutable_signature()->clear_name();
+  return Hash64Combine(
+      FunctionDefHash(fdef),
+      Hash64(Canonicalize(/*funcname=*/"", AttrSlice(&function.attr()))));
+}
+
 Status GetFunctionBody(FunctionLibraryRuntime* flib_runtime,
                        const NodeDef& node, StringPiece func_attr_name,
-                       const FunctionBody** fbody) {
-  NameAttrList name_attr_list;
-  TF_RETURN_IF_ERROR(GetNodeAttr(node, func_attr_name, &name_attr_list));
+                       const FunctionBody** fbody,
+                       NameAttrList* name_attr_list) {
+  TF_RETURN_IF_ERROR(GetNodeAttr(node, func_attr_name, name_attr_list));
   FunctionLibraryRuntime::Handle func_handle;
   TF_RETURN_IF_ERROR(flib_runtime->Instantiate(
-      name_attr_list.name(), AttrSlice(&name_attr_list.attr()), &func_handle));
+      name_attr_list->name(), AttrSlice(&name_attr_list->attr()),
+      &func_handle));
   *fbody = flib_runtime->GetFunctionBody(func_handle);
   return OkStatus();
 }
 
 Status GetFunctionBodies(FunctionLibraryRuntime* flib_runtime,
                          const NodeDef& node, StringPiece func_list_attr_name,
-                         std::vector<const FunctionBody*>* fbodies) {
-  std::vector<NameAttrList> name_attr_lists;
-  TF_RETURN_IF_ERROR(GetNodeAttr(node, func_list_attr_name, &name_attr_lists));
-  for (const NameAttrList& name_attr_list : name_attr_lists) {
+                         std::vector<const FunctionBody*>* fbodies,
+                         std::vector<NameAttrList>* name_attr_lists) {
+  TF_RETURN_IF_ERROR(GetNodeAttr(node, func_list_attr_name, name_attr_lists));
+  for (const NameAttrList& name_attr_list : *name_attr_lists) {
     FunctionLibraryRuntime::Handle func_handle;
     TF_RETURN_IF_ERROR(flib_runtime->Instantiate(
         name_attr_list.name(), AttrSlice(&name_attr_list.attr()),
@@ -62,18 +90,20 @@ Status GetFunctionBodies(FunctionLibraryRuntime* flib_runtime,
 
 Status CondConstInputIndices(
     absl::Span<const FunctionBody* const> branch_bodies,
+    absl::Span<const NameAttrList> branches,
     std::vector<int>* const_input_idxs, FunctionLibraryRuntime* flib_runtime) {
   TF_RET_CHECK(!branch_bodies.empty());
+  TF_RET_CHECK(branch_bodies.size() == branches.size());
   TF_RET_CHECK(branch_bodies[0] != nullptr);
   int num_inputs = branch_bodies[0]->fdef.signature().input_arg_size();
   // Stores indices of the "branch function" inputs that are expected to be
   // compile time constants.
   std::vector<bool> compile_time_const_arg_indices(num_inputs);
-  for (auto fbody : branch_bodies) {
-    TF_RET_CHECK(fbody != nullptr);
-    TF_RETURN_IF_ERROR(BackwardsConstAnalysis(
-        *(fbody->graph), &compile_time_const_arg_indices,
-        /*compile_time_const_nodes=*/nullptr, flib_runtime));
+  for (int i = 0, end = branch_bodies.size(); i < end; ++i) {
+    TF_RET_CHECK(branch_bodies[i] != nullptr);
+    TF_RETURN_IF_ERROR(BackwardsConstAnalysisForFunction(
+        *branch_bodies[i], branches[i], &compile_time_const_arg_indices,
+        flib_runtime));
   }
   for (int i = 0, end = compile_time_const_arg_indices.size(); i < end; i++) {
     if (compile_time_const_arg_indices[i]) {
@@ -95,8 +125,12 @@ Status GetCompileTimeConstInputs(const NodeDef& node, const OpKernel* op_kernel,
     // For While nodes, recurse into the body and cond graphs.
     const FunctionBody* fcond = nullptr;
     const FunctionBody* fbody = nullptr;
-    TF_RETURN_IF_ERROR(GetFunctionBody(flib_runtime, node, "cond", &fcond));
-    TF_RETURN_IF_ERROR(GetFunctionBody(flib_runtime, node, "body", &fbody));
+    NameAttrList cond;
+    NameAttrList body;
+    TF_RETURN_IF_ERROR(
+        GetFunctionBody(flib_runtime, node, "cond", &fcond, &cond));
+    TF_RETURN_IF_ERROR(
+        GetFunctionBody(flib_runtime, node, "body", &fbody, &body));
     TF_RET_CHECK(fcond);
     TF_RET_CHECK(fbody);
     int num_inputs = fbody->fdef.signature().input_arg_size();
@@ -104,12 +138,10 @@ Status GetCompileTimeConstInputs(const NodeDef& node, const OpKernel* op_kernel,
     // Stores which of the loop inputs are expected to be compile time
     // constants.
     std::vector<bool> compile_time_const_arg_indices(num_inputs);
-    TF_RETURN_IF_ERROR(BackwardsConstAnalysis(
-        *(fcond->graph), &compile_time_const_arg_indices,
-        /*compile_time_const_nodes=*/nullptr, flib_runtime));
-    TF_RETURN_IF_ERROR(BackwardsConstAnalysis(
-        *(fbody->graph), &compile_time_const_arg_indices,
-        /*compile_time_const_nodes=*/nullptr, flib_runtime));
+    TF_RETURN_IF_ERROR(BackwardsConstAnalysisForFunction(
+        *fcond, cond, &compile_time_const_arg_indices, flib_runtime));
+    TF_RETURN_IF_ERROR(BackwardsConstAnalysisForFunction(
+        *fbody, body, &compile_time_const_arg_indices, flib_runtime));
     for (int i = 0; i < num_inputs; i++) {
       if (compile_time_const_arg_indices[i]) {
         // Check that this input is actually a loop invariant.
@@ -136,26 +168,30 @@ Status GetCompileTimeConstInputs(const NodeDef& node, const OpKernel* op_kernel,
   } else if (node.op() == "If" || node.op() == "StatelessIf") {
     const FunctionBody* fthen = nullptr;
     const FunctionBody* felse = nullptr;
-    TF_RETURN_IF_ERROR(
-        GetFunctionBody(flib_runtime, node, "then_branch", &fthen));
-    TF_RETURN_IF_ERROR(
-        GetFunctionBody(flib_runtime, node, "else_branch", &felse));
-    return CondConstInputIndices({fthen, felse}, const_input_idxs,
+    std::vector<NameAttrList> branches(2);
+    TF_RETURN_IF_ERROR(GetFunctionBody(flib_runtime, node, "then_branch",
+                                       &fthen, &branches[0]));
+    TF_RETURN_IF_ERROR(GetFunctionBody(flib_runtime, node, "else_branch",
+                                       &felse, &branches[1]));
+    return CondConstInputIndices({fthen, felse}, branches, const_input_idxs,
                                  flib_runtime);
   } else if (node.op() == "Case" || node.op() == "StatelessCase") {
     std::vector<const FunctionBody*> branch_bodies;
-    TF_RETURN_IF_ERROR(
-        GetFunctionBodies(flib_runtime, node, "branches", &branch_bodies));
-    return CondConstInputIndices(branch_bodies, const_input_idxs, flib_runtime);
+    std::vector<NameAttrList> branches;
+    TF_RETURN_IF_ERROR(GetFunctionBodies(flib_runtime, node, "branches",
+                                         &branch_bodies, &branches));
+    return CondConstInputIndices(branch_bodies, branches, const_input_idxs,
+                                 flib_runtime);
   } else if (node.op() == "PartitionedCall" ||
              node.op() == "StatefulPartitionedCall") {
     const FunctionBody* fbody;
-    TF_RETURN_IF_ERROR(GetFunctionBody(flib_runtime, node, "f", &fbody));
+    NameAttrList function;
+    TF_RETURN_IF_ERROR(
+        GetFunctionBody(flib_runtime, node, "f", &fbody, &function));
     int num_inputs = fbody->fdef.signature().input_arg_size();
     std::vector<bool> compile_time_const_arg_indices(num_inputs);
-    TF_RETURN_IF_ERROR(BackwardsConstAnalysis(
-        *(fbody->graph), &compile_time_const_arg_indices,
-        /*compile_time_const_nodes=*/nullptr, flib_runtime));
+    TF_RETURN_IF_ERROR(BackwardsConstAnalysisForFunction(
+        *fbody, function, &compile_time_const_arg_indices, flib_runtime));
     for (int i = 0; i < num_inputs; i++) {
       if (compile_time_const_arg_indices[i]) {
         const_input_idxs->push_back(i);
@@ -293,6 +329,43 @@ Status BackwardsConstAnalysis(
   return status;
 }
 
+Status BackwardsConstAnalysisForFunction(
+    const FunctionBody& fbody, const NameAttrList& function,
+    std::vector<bool>* compile_time_const_arg_indices,
+    FunctionLibraryRuntime* flib_runtime) {
+  const uint64 fingerprint = FunctionFingerprint(fbody, function);
+  FunctionConstArgsCache& cache = GetFunctionConstArgsCache();
+  std::vector<bool> const_args;
+  bool cached = false;
+  {
+    mutex_lock lock(cache.mu);
+    auto it = cache.const_args.find(fingerprint);
+    if (it != cache.const_args.end()) {
+      const_args = it->second;
+      cached = true;
+    }
+  }
+  if (cached) {
+    VLOG(5) << "Using cached argument indices for function "
+            << function.name();
+  } else {
+    const_args.resize(compile_time_const_arg_indices->size());
+    TF_RETURN_IF_ERROR(BackwardsConstAnalysis(
+        *fbody.graph, &const_args, /*compile_time_const_nodes=*/nullptr,
+        flib_runtime));
+    mutex_lock lock(cache.mu);
+    cache.const_args.emplace(fingerprint, const_args);
+  }
+  for (int i = 0, end = std::min(const_args.size(),
+                                 compile_time_const_arg_indices->size());
+       i < end; ++i) {
+    if (const_args[i]) {
+      (*compile_time_const_arg_indices)[i] = true;
+    }
+  }
+  return OkStatus();
+}
+
 Status GetCompileTimeConstInputs(const OpKernel* op_kernel,
                                  std::vector<int>* const_input_idxs,
                                  FunctionLibraryRuntime* flib_runtime) {
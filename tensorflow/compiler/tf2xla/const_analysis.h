@@ -18,6 +18,8 @@ limitations under the License.
 
 #include <vector>
 
+#include "tensorflow/core/common_runtime/function_body.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
 
@@ -41,6 +43,20 @@ Status BackwardsConstAnalysis(
     FunctionLibraryRuntime* flib_runtime,
     std::function<bool(const Edge&)> edge_filter_input = nullptr);
 
+// Runs BackwardsConstAnalysis on the body of `function`, instantiated as
+// `fbody`, and marks its compile-time constant arguments in
+// `compile_time_const_arg_indices`.
+//
+// The result is memoized in a process-wide cache keyed by a fingerprint of the
+// function's body and instantiation attributes, not its name. Clusters with
+// identical bodies, and recompiles of a cluster for new shapes, reuse it
+// instead of rerunning the analysis. Function bodies are assumed to refer to
+// the functions they call by names that are unique within the process.
+Status BackwardsConstAnalysisForFunction(
+    const FunctionBody& fbody, const NameAttrList& function,
+    std::vector<bool>* compile_time_const_arg_indices,
+    FunctionLibraryRuntime* flib_runtime);
+
 // Given an op kernel and function library runtime, return all the indices of
 // inputs that need to be compile time constant.
 Status GetCompileTimeConstInputs(const OpKernel* op_kernel,
@@ -146,6 +146,39 @@ TEST(ConstAnalysisTest, StatefulPartitionedCall) {
   TestFunctionCall(/*is_stateful_partitioned_call=*/true);
 }
 
+TEST(ConstAnalysisTest, FunctionsWithIdenticalBodies) {
+  FunctionDefLibrary flib;
+  for (const char* name : {"Callee0", "Callee1"}) {
+    *flib.add_function() = FunctionDefHelper::Define(
+        name, {"t:float", "shape:int32"}, {"result:float"}, {},
+        {{{"result"}, "Reshape", {"t", "shape"}, {{"T", DT_FLOAT}}}});
+  }
+  FunctionLibraryDefinition flib_def(OpRegistry::Global(), flib);
+
+  OptimizerOptions opts;
+  std::unique_ptr<ProcessFunctionLibraryRuntime> pflr(
+      new ProcessFunctionLibraryRuntime(nullptr, Env::Default(),
+                                        /*config=*/nullptr,
+                                        TF_GRAPH_DEF_VERSION, &flib_def, opts));
+  FunctionLibraryRuntime* lib_runtime =
+      pflr->GetFLR(ProcessFunctionLibraryRuntime::kDefaultFLRDevice);
+
+  // The second function shares the analysis of the first.
+  for (const char* name : {"Callee0", "Callee1", "Callee0"}) {
+    NameAttrList function;
+    function.set_name(name);
+    FunctionLibraryRuntime::Handle handle;
+    TF_ASSERT_OK(lib_runtime->Instantiate(
+        function.name(), AttrSlice(&function.attr()), &handle));
+    const FunctionBody* fbody = lib_runtime->GetFunctionBody(handle);
+
+    std::vector<bool> const_args(2, false);
+    TF_ASSERT_OK(BackwardsConstAnalysisForFunction(*fbody, function,
+                                                   &const_args, lib_runtime));
+    EXPECT_EQ(const_args, std::vector<bool>({false, true}));
+  }
+}
+
 TEST(ConstAnalysisTest, DontFollowControlDependencies) {
   Scope root = Scope::NewRootScope();
 
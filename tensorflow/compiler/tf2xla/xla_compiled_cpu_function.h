@@ -127,6 +127,9 @@ class XlaCompiledCpuFunction {
   XlaCompiledCpuFunction& operator=(const XlaCompiledCpuFunction&) = delete;
 
   // Sets the intra-op thread pool used to run individual ops concurrently.
+  // Compiled with tfcompile --parallelism, partitions of parallel loops also
+  // run on this pool; without a pool they run sequentially on the caller's
+  // thread.
   void set_thread_pool(const Eigen::ThreadPoolDevice* pool) {
     run_options_.set_intra_op_thread_pool(pool);
   }
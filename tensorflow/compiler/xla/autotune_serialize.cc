@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/autotune_serialize.h"
 
+#include <algorithm>
+#include <optional>
 #include <string>
 
 #include "tensorflow/compiler/xla/autotune_results.pb.h"
@@ -29,35 +31,91 @@ namespace {
 constexpr int kVersion = 1;
 // LINT.ThenChange()
 
-}  // anonymous namespace
+Status CheckVersion(const AutotuneResults& results) {
+  if (results.version() != kVersion) {
+    return tsl::errors::InvalidArgument(absl::StrFormat(
+        "Version mismatch in autotune results.  Expected %d but was %d",
+        kVersion, results.version()));
+  }
+  return OkStatus();
+}
 
-Status LoadAutotuneResults(absl::string_view data) {
+StatusOr<AutotuneResults> ParseAutotuneResults(absl::string_view data) {
   AutotuneResults results;
   // The cast here is necessary for MacOS builds.
   if (!results.ParseFromString(std::string(data))) {  // NOLINT
     return tsl::errors::InvalidArgument(
         "Failed to parse autotune results string.");
   }
-  if (results.version() != kVersion) {
-    return tsl::errors::InvalidArgument(absl::StrFormat(
-        "Version mismatch in autotune results.  Expected %d but was %d",
-        kVersion, results.version()));
-  }
+  TF_RETURN_IF_ERROR(CheckVersion(results));
+  return results;
+}
 
+Status LoadAutotuneResults(const AutotuneResults& results) {
   TF_RETURN_IF_ERROR(gpu::GpuConvAlgorithmPicker::LoadAutotuneResults(results));
   TF_RETURN_IF_ERROR(gpu::GemmAlgorithmPicker::LoadAutotuneResults(results));
   return OkStatus();
 }
 
-StatusOr<std::string> SerializeAutotuneResults() {
+StatusOr<AutotuneResults> WriteAutotuneResults() {
   AutotuneResults results;
   results.set_version(kVersion);
 
   TF_RETURN_IF_ERROR(
       gpu::GpuConvAlgorithmPicker::WriteAutotuneResults(&results));
   TF_RETURN_IF_ERROR(gpu::GemmAlgorithmPicker::WriteAutotuneResults(&results));
+  return results;
+}
+
+// Removes the entries of `entries` which were not autotuned on `model_str`.
+void KeepEntriesForDevice(
+    absl::string_view model_str,
+    tsl::protobuf::RepeatedPtrField<AutotuneResults::Entry>* entries) {
+  entries->erase(std::remove_if(entries->begin(), entries->end(),
+                                [&](const AutotuneResults::Entry& entry) {
+                                  return entry.device() != model_str;
+                                }),
+                 entries->end());
+}
+
+}  // anonymous namespace
+
+Status LoadAutotuneResults(absl::string_view data) {
+  TF_ASSIGN_OR_RETURN(AutotuneResults results, ParseAutotuneResults(data));
+  return LoadAutotuneResults(results);
+}
 
+StatusOr<std::string> SerializeAutotuneResults() {
+  TF_ASSIGN_OR_RETURN(AutotuneResults results, WriteAutotuneResults());
   return results.SerializeAsString();
 }
 
+StatusOr<std::string> MergeAutotuneResults(absl::string_view base,
+                                           absl::string_view update) {
+  TF_ASSIGN_OR_RETURN(AutotuneResults merged, ParseAutotuneResults(base));
+  TF_ASSIGN_OR_RETURN(AutotuneResults update_results,
+                      ParseAutotuneResults(update));
+  gpu::MergeAutotuneResults(update_results, &merged);
+  return merged.SerializeAsString();
+}
+
+Status LoadAutotuneResultsFromStore(gpu::AutotuneResultsStore& store,
+                                    absl::string_view key) {
+  TF_ASSIGN_OR_RETURN(std::optional<AutotuneResults> results,
+                      store.Fetch(key));
+  if (!results.has_value()) return OkStatus();
+  TF_RETURN_IF_ERROR(CheckVersion(*results));
+  return LoadAutotuneResults(*results);
+}
+
+Status UploadAutotuneResultsToStore(gpu::AutotuneResultsStore& store,
+                                    absl::string_view key,
+                                    absl::string_view model_str) {
+  TF_ASSIGN_OR_RETURN(AutotuneResults results, WriteAutotuneResults());
+  KeepEntriesForDevice(model_str, results.mutable_dots());
+  KeepEntriesForDevice(model_str, results.mutable_convs());
+  if (results.dots().empty() && results.convs().empty()) return OkStatus();
+  return store.Upload(key, results);
+}
+
 }  // namespace xla
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <string>
 
+#include "tensorflow/compiler/xla/service/gpu/autotune_results_store.h"
 #include "tensorflow/compiler/xla/statusor.h"
 
 namespace xla {
@@ -65,6 +66,23 @@ namespace xla {
 StatusOr<std::string> SerializeAutotuneResults();
 Status LoadAutotuneResults(absl::string_view data);
 
+// Merges two strings returned by SerializeAutotuneResults(), e.g. to fold the
+// results fetched from another host into a local autotuning file.  Where the
+// two disagree, the algorithm in `update` is chosen.
+StatusOr<std::string> MergeAutotuneResults(absl::string_view base,
+                                           absl::string_view update);
+
+// Like LoadAutotuneResults(), but for the results stored under `key` in
+// `store`.  Does nothing if there are none.
+Status LoadAutotuneResultsFromStore(gpu::AutotuneResultsStore& store,
+                                    absl::string_view key);
+
+// Uploads the autotuning choices XLA has made for the device `model_str` to
+// `store` under `key`.
+Status UploadAutotuneResultsToStore(gpu::AutotuneResultsStore& store,
+                                    absl::string_view key,
+                                    absl::string_view model_str);
+
 }  // namespace xla
 
 #endif  // TENSORFLOW_COMPILER_XLA_AUTOTUNE_SERIALIZE_H_
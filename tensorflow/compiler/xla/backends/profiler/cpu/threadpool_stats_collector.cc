@@ -0,0 +1,166 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <map>
+#include <memory>
+#include <string>
+
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/threadpool.h"
+#include "tensorflow/tsl/profiler/lib/profiler_factory.h"
+#include "tensorflow/tsl/profiler/lib/profiler_interface.h"
+#include "tensorflow/tsl/profiler/protobuf/profiler_options.pb.h"
+#include "tensorflow/tsl/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/tsl/profiler/utils/time_utils.h"
+#include "tensorflow/tsl/profiler/utils/xplane_builder.h"
+#include "tensorflow/tsl/profiler/utils/xplane_schema.h"
+#include "tensorflow/tsl/profiler/utils/xplane_utils.h"
+
+namespace xla {
+namespace profiler {
+namespace {
+
+using ThreadPoolStats = tsl::thread::ThreadPool::Stats;
+
+// Returns the statistics of the thread pools that collect them, keyed by
+// pool name. Pools with the same name are added up.
+std::map<std::string, ThreadPoolStats> GetThreadPoolStats() {
+  std::map<std::string, ThreadPoolStats> result;
+  tsl::thread::ThreadPool::ForEachPoolStats([&](const ThreadPoolStats& stats) {
+    auto it = result.find(stats.name);
+    if (it == result.end()) {
+      result.emplace(stats.name, stats);
+    } else {
+      it->second.Add(stats);
+    }
+  });
+  return result;
+}
+
+// ThreadPoolStatsCollector reports how much work the thread pools that
+// collect statistics (see tsl::thread::ThreadPool::GetStats) did during the
+// profiling session, and how long that work waited in their queues: one line
+// per pool with a single event spanning the session.
+//
+// Thread-safety: This class is go/thread-compatible.
+class ThreadPoolStatsCollector : public tsl::profiler::ProfilerInterface {
+ public:
+  ThreadPoolStatsCollector() = default;
+
+  tsl::Status Start() override {
+    start_stats_ = GetThreadPoolStats();
+    start_ns_ = tsl::profiler::GetCurrentTimeNanos();
+    return tsl::OkStatus();
+  }
+
+  tsl::Status Stop() override {
+    stop_stats_ = GetThreadPoolStats();
+    stop_ns_ = tsl::profiler::GetCurrentTimeNanos();
+    return tsl::OkStatus();
+  }
+
+  tsl::Status CollectData(tsl::profiler::XSpace* space) override {
+    if (stop_stats_.empty()) return tsl::OkStatus();
+    tsl::profiler::XPlaneBuilder plane(
+        tsl::profiler::FindOrAddMutablePlaneWithName(
+            space, tsl::profiler::kThreadPoolsPlaneName));
+    const auto& event_metadata = *plane.GetOrCreateEventMetadata("ThreadPool");
+    const auto& num_threads = *plane.GetOrCreateStatMetadata("num_threads");
+    const auto& tasks_completed =
+        *plane.GetOrCreateStatMetadata("tasks_completed");
+    const auto& tasks_stolen = *plane.GetOrCreateStatMetadata("tasks_stolen");
+    const auto& queue_depth = *plane.GetOrCreateStatMetadata("queue_depth");
+    const auto& avg_wait_time_us =
+        *plane.GetOrCreateStatMetadata("avg_wait_time_us");
+    const auto& avg_run_time_us =
+        *plane.GetOrCreateStatMetadata("avg_run_time_us");
+    const auto& utilization = *plane.GetOrCreateStatMetadata("utilization");
+
+    const int64_t duration_ns = stop_ns_ - start_ns_;
+    int64_t line_id = 0;
+    for (const auto& it : stop_stats_) {
+      const ThreadPoolStats& stop = it.second;
+      // Pools created during the session are compared against zero.
+      ThreadPoolStats start;
+      start.busy_time_usecs_per_thread.resize(
+          stop.busy_time_usecs_per_thread.size());
+      auto start_it = start_stats_.find(it.first);
+      if (start_it != start_stats_.end() &&
+          start_it->second.num_threads == stop.num_threads) {
+        start = start_it->second;
+      }
+      const int64_t completed = stop.tasks_completed - start.tasks_completed;
+      int64_t busy_usecs = 0;
+      for (int i = 0; i < stop.busy_time_usecs_per_thread.size(); ++i) {
+        busy_usecs += stop.busy_time_usecs_per_thread[i] -
+                      start.busy_time_usecs_per_thread[i];
+      }
+
+      tsl::profiler::XLineBuilder line = plane.GetOrCreateLine(line_id++);
+      line.SetName(it.first);
+      line.SetTimestampNs(start_ns_);
+      tsl::profiler::XEventBuilder event = line.AddEvent(event_metadata);
+      event.SetOffsetNs(0);
+      event.SetDurationNs(duration_ns);
+      event.AddStatValue(num_threads, int64_t{stop.num_threads});
+      event.AddStatValue(tasks_completed, completed);
+      event.AddStatValue(tasks_stolen, stop.tasks_stolen - start.tasks_stolen);
+      event.AddStatValue(queue_depth, stop.queue_depth);
+      if (completed > 0) {
+        event.AddStatValue(avg_wait_time_us,
+                           static_cast<double>(stop.total_wait_time_usecs -
+                                               start.total_wait_time_usecs) /
+                               completed);
+        event.AddStatValue(avg_run_time_us,
+                           static_cast<double>(stop.total_run_time_usecs -
+                                               start.total_run_time_usecs) /
+                               completed);
+      }
+      if (duration_ns > 0 && stop.num_threads > 0) {
+        event.AddStatValue(utilization,
+                           1000.0 * busy_usecs /
+                               (static_cast<double>(duration_ns) *
+                                stop.num_threads));
+      }
+    }
+    stop_stats_.clear();
+    return tsl::OkStatus();
+  }
+
+ private:
+  std::map<std::string, ThreadPoolStats> start_stats_;
+  std::map<std::string, ThreadPoolStats> stop_stats_;
+  int64_t start_ns_ = 0;
+  int64_t stop_ns_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ThreadPoolStatsCollector);
+};
+
+std::unique_ptr<tsl::profiler::ProfilerInterface>
+CreateThreadPoolStatsCollector(const tensorflow::ProfileOptions& options) {
+  return options.host_tracer_level() > 0
+             ? std::make_unique<ThreadPoolStatsCollector>()
+             : nullptr;
+}
+
+}  // namespace
+
+auto register_thread_pool_stats_collector_factory = [] {
+  RegisterProfilerFactory(&CreateThreadPoolStatsCollector);
+  return 0;
+}();
+
+}  // namespace profiler
+}  // namespace xla
@@ -1648,7 +1648,8 @@ const char *GetTraceEventTypeName(const CuptiTracerEventType &type) {
 CuptiTracer::CuptiTracer(CuptiInterface *cupti_interface)
     : num_gpus_(NumGpus()),
       cupti_interface_(cupti_interface),
-      buffer_pool_(kBufferSizeInBytes) {}
+      buffer_pool_(
+          std::make_unique<tsl::profiler::BufferPool>(kBufferSizeInBytes)) {}
 
 /* static */ CuptiTracer *CuptiTracer::GetCuptiTracerSingleton() {
   static auto *singleton = new CuptiTracer(GetCuptiInterface());
@@ -1687,6 +1688,24 @@ void CuptiTracer::Enable(const CuptiTracerOptions &option,
         option, cupti_interface_, collector));
   }
 
+  // No buffer is held by CUPTI between sessions, so the pool can be replaced.
+  size_t buffer_size = option_->activity_buffer_size_in_bytes > 0
+                           ? option_->activity_buffer_size_in_bytes
+                           : kBufferSizeInBytes;
+  if (buffer_pool_->GetBufferSizeInBytes() != buffer_size) {
+    buffer_pool_ = std::make_unique<tsl::profiler::BufferPool>(buffer_size);
+  }
+  if (option_->enable_activity_api &&
+      option_->num_preallocated_activity_buffers > 0) {
+    std::vector<uint8_t *> buffers;
+    for (size_t i = 0; i < option_->num_preallocated_activity_buffers; ++i) {
+      uint8_t *buffer = buffer_pool_->GetOrCreateBuffer();
+      if (buffer == nullptr) break;
+      buffers.push_back(buffer);
+    }
+    for (uint8_t *buffer : buffers) buffer_pool_->ReclaimBuffer(buffer);
+  }
+
   Status status = EnableApiTracing();
   need_root_access_ |= status.code() == tsl::error::PERMISSION_DENIED;
   if (!status.ok()) return;
@@ -1862,6 +1881,15 @@ Status CuptiTracer::HandleCallback(CUpti_CallbackDomain domain,
     return tsl::errors::Internal("cutpi callback without context");
   }
 
+  // Without callback API events the activity API hook does nothing, and the
+  // callback is only needed to correlate launches with the annotation stack.
+  if (!option_->required_callback_api_events &&
+      !option_->enable_event_based_activity &&
+      (cbdata->callbackSite != CUPTI_API_EXIT ||
+       AnnotationStack::Get().empty())) {
+    return OkStatus();
+  }
+
   // Grab a correct device ID.
   tsl::uint32 device_id = -1;
   RETURN_IF_CUPTI_ERROR(
@@ -1932,19 +1960,19 @@ void CuptiTracer::ConfigureActivityUnifiedMemoryCounter(bool enable) {
 }
 
 void CuptiTracer::RequestActivityBuffer(uint8_t **buffer, size_t *size) {
-  *buffer = buffer_pool_.GetOrCreateBuffer();
+  *buffer = buffer_pool_->GetOrCreateBuffer();
   if (*buffer == nullptr) {
     LOG(WARNING)
         << "CUPTI Buffer not allocated, activity records will be dropped";
     *size = 0;
     return;
   }
-  *size = buffer_pool_.GetBufferSizeInBytes();
+  *size = buffer_pool_->GetBufferSizeInBytes();
 }
 
 Status CuptiTracer::ProcessActivityBuffer(CUcontext context, uint32_t stream_id,
                                           uint8_t *buffer, size_t size) {
-  absl::Cleanup buffer_cleanup = [&]() { buffer_pool_.ReclaimBuffer(buffer); };
+  absl::Cleanup buffer_cleanup = [&]() { buffer_pool_->ReclaimBuffer(buffer); };
   if (size == 0) {
     return OkStatus();
   }
@@ -53,6 +53,13 @@ struct CuptiTracerOptions {
   bool sync_devices_before_stop = false;
   // Whether to enable NVTX tracking, we need this for TensorRT tracking.
   bool enable_nvtx_tracking = false;
+  // Size of the buffers handed to CUPTI for activity records, if zero the
+  // default 32KB is used. Larger buffers mean CUPTI hands back completed
+  // buffers less often while the application is running.
+  size_t activity_buffer_size_in_bytes = 0;
+  // Number of activity buffers to allocate when tracing is enabled, so that
+  // CUPTI requests during the trace do not allocate memory.
+  size_t num_preallocated_activity_buffers = 0;
 };
 
 class CuptiDriverApiHook {
@@ -117,7 +124,7 @@ class CuptiTracer {
   explicit CuptiTracer(CuptiInterface* cupti_interface);
 
  private:
-  // Buffer size and alignment, 32K and 8 as in CUPTI samples.
+  // Default buffer size and alignment, 32K and 8 as in CUPTI samples.
   static constexpr size_t kBufferSizeInBytes = 32 * 1024;
 
   tsl::Status EnableApiTracing();
@@ -147,7 +154,8 @@ class CuptiTracer {
 
   std::unique_ptr<CuptiDriverApiHook> cupti_driver_api_hook_;
 
-  tsl::profiler::BufferPool buffer_pool_;
+  // Recreated by Enable() when a different buffer size is requested.
+  std::unique_ptr<tsl::profiler::BufferPool> buffer_pool_;
 };
 
 }  // namespace profiler
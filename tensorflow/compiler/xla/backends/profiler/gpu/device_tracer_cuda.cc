@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <stdlib.h>
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 
@@ -42,13 +43,15 @@ using tensorflow::ProfileOptions;
 using tensorflow::profiler::XSpace;
 using tsl::OkStatus;
 using tsl::ReadBoolFromEnvVar;
+using tsl::ReadInt64FromEnvVar;
 using tsl::Status;
 
 // GpuTracer for GPU.
 class GpuTracer : public tsl::profiler::ProfilerInterface {
  public:
-  GpuTracer(CuptiTracer* cupti_tracer, CuptiInterface* cupti_interface)
-      : cupti_tracer_(cupti_tracer) {
+  GpuTracer(CuptiTracer* cupti_tracer, CuptiInterface* cupti_interface,
+            bool gpu_activity_only = false)
+      : cupti_tracer_(cupti_tracer), gpu_activity_only_(gpu_activity_only) {
     VLOG(1) << "GpuTracer created.";
   }
   ~GpuTracer() override {}
@@ -72,6 +75,8 @@ class GpuTracer : public tsl::profiler::ProfilerInterface {
   State profiling_state_ = State::kNotStarted;
 
   CuptiTracer* cupti_tracer_;
+  // Only collect kernel and memcpy activities, see ProfileOptions.
+  const bool gpu_activity_only_;
   CuptiTracerOptions options_;
   std::unique_ptr<CuptiTraceCollector> cupti_collector_;
 };
@@ -142,8 +147,35 @@ Status GpuTracer::DoStart() {
                                : CUPTI_ACTIVITY_KIND_KERNEL);
   options_.activities_selected.push_back(CUPTI_ACTIVITY_KIND_MEMCPY);
   options_.activities_selected.push_back(CUPTI_ACTIVITY_KIND_MEMCPY2);
-  options_.activities_selected.push_back(CUPTI_ACTIVITY_KIND_OVERHEAD);
-  options_.activities_selected.push_back(CUPTI_ACTIVITY_KIND_MEMSET);
+  if (gpu_activity_only_) {
+    // Kernel launch and memcpy callbacks are kept to correlate the activities
+    // with the annotation stack, but no driver API events are recorded.
+    options_.cbids_selected.erase(
+        std::find(options_.cbids_selected.begin(),
+                  options_.cbids_selected.end(),
+                  CUPTI_DRIVER_TRACE_CBID_cuMemAlloc_v2),
+        options_.cbids_selected.end());
+    options_.required_callback_api_events = false;
+    options_.enable_event_based_activity = false;
+
+    // Large preallocated buffers, so that CUPTI rarely hands a buffer back
+    // or asks for memory while the steps run.
+    int64_t buffer_size_in_kb = 4 * 1024;
+    ReadInt64FromEnvVar("TF_GPU_CUPTI_ACTIVITY_BUFFER_SIZE_KB",
+                        buffer_size_in_kb, &buffer_size_in_kb)
+        .IgnoreError();
+    int64_t num_buffers = 8;
+    ReadInt64FromEnvVar("TF_GPU_CUPTI_NUM_PREALLOCATED_BUFFERS", num_buffers,
+                        &num_buffers)
+        .IgnoreError();
+    options_.activity_buffer_size_in_bytes =
+        std::max<int64_t>(buffer_size_in_kb, 1) * 1024;
+    options_.num_preallocated_activity_buffers =
+        std::max<int64_t>(num_buffers, 0);
+  } else {
+    options_.activities_selected.push_back(CUPTI_ACTIVITY_KIND_OVERHEAD);
+    options_.activities_selected.push_back(CUPTI_ACTIVITY_KIND_MEMSET);
+  }
 
 // CUDA/CUPTI 10 have issues (leaks and crashes) with CuptiFinalize.
 #if CUDA_VERSION >= 11000
@@ -232,7 +264,8 @@ std::unique_ptr<tsl::profiler::ProfilerInterface> CreateGpuTracer(
     return nullptr;
   }
   profiler::CuptiInterface* cupti_interface = profiler::GetCuptiInterface();
-  return std::make_unique<profiler::GpuTracer>(cupti_tracer, cupti_interface);
+  return std::make_unique<profiler::GpuTracer>(cupti_tracer, cupti_interface,
+                                               options.gpu_activity_only());
 }
 
 auto register_gpu_tracer_factory = [] {
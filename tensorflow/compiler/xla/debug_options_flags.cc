@@ -49,6 +49,7 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_dump_include_timestamp(false);
   opts.set_xla_dump_max_hlo_modules(-1);
   opts.set_xla_dump_module_metadata(false);
+  opts.set_xla_dump_hlo_pass_flamegraph(false);
   opts.set_xla_dump_hlo_as_long_text(false);
   opts.set_xla_dump_enable_mlir_pretty_form(true);
 #ifdef ENABLE_MKL
@@ -103,7 +104,7 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_gpu_normalize_layouts(true);
   opts.set_xla_gpu_simplify_all_fp_conversions(true);
   opts.set_xla_dump_latency_hiding_schedule(false);
-  opts.set_xla_gpu_enable_latency_hiding_scheduler(false);
+  opts.set_xla_gpu_enable_latency_hiding_scheduler(true);
 
   opts.set_xla_cpu_enable_mlir_tiling_and_fusion(true);
   opts.set_xla_cpu_enable_experimental_deallocation(true);
@@ -625,6 +626,13 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       debug_options->xla_dump_module_metadata(),
       "Dumps HloModuleMetadata as text protos to the directory specified "
       "by --xla_dump_to."));
+  flag_list->push_back(tsl::Flag(
+      "xla_dump_hlo_pass_flamegraph",
+      bool_setter_for(&DebugOptions::set_xla_dump_hlo_pass_flamegraph),
+      debug_options->xla_dump_hlo_pass_flamegraph(),
+      "Dumps the wall time of the HLO passes run on each module as folded "
+      "stacks, for use with flame graph tools, to the directory specified by "
+      "--xla_dump_to."));
   flag_list->push_back(
       tsl::Flag("xla_dump_compress_protos",
                 bool_setter_for(&DebugOptions::set_xla_dump_compress_protos),
@@ -663,6 +671,25 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       debug_options->xla_gpu_algorithm_denylist_path(),
       "An AlgorithmDenylist text proto file as a denylist of convolutions to "
       "avoid to use."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_autotune_results_store_dir",
+      string_setter_for(&DebugOptions::set_xla_gpu_autotune_results_store_dir),
+      debug_options->xla_gpu_autotune_results_store_dir(),
+      "Directory through which gemm and conv autotuning results are shared "
+      "between compilations and hosts with the same GPU model and cuDNN/cuBLAS "
+      "versions. Empty (the default) disables sharing."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_enable_host_memory_offload",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_host_memory_offload),
+      debug_options->xla_gpu_enable_host_memory_offload(),
+      "Offload activations to pinned host memory when a module does not fit "
+      "into device memory."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_fusion_profile_path",
+      string_setter_for(&DebugOptions::set_xla_gpu_fusion_profile_path),
+      debug_options->xla_gpu_fusion_profile_path(),
+      "ProfiledInstructionsProto with the measured fusion durations of an "
+      "earlier run, used to correct the fusion heuristics."));
   flag_list->push_back(
       tsl::Flag("xla_gpu_use_runtime_fusion",
                 bool_setter_for(&DebugOptions::set_xla_gpu_use_runtime_fusion),
@@ -852,12 +879,20 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
           &DebugOptions::set_xla_cpu_enable_experimental_deallocation),
       debug_options->xla_cpu_enable_experimental_deallocation(),
       "Enable experimental deallocation."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_force_compilation_parallelism",
+      int32_setter_for(
+          &DebugOptions::set_xla_cpu_force_compilation_parallelism),
+      debug_options->xla_cpu_force_compilation_parallelism(),
+      "If greater than 1, splits the LLVM module into up to this many parts "
+      "that are optimized and compiled in parallel on as many threads."));
   flag_list->push_back(
       tsl::Flag("xla_gpu_enable_latency_hiding_scheduler",
                 bool_setter_for(
                     &DebugOptions::set_xla_gpu_enable_latency_hiding_scheduler),
                 debug_options->xla_gpu_enable_latency_hiding_scheduler(),
-                "Enable latency-hiding scheduler for XLA:GPU"));
+                "Enable latency-hiding scheduler for XLA:GPU. It only runs on "
+                "modules with asynchronous collectives or transfers."));
   flag_list->push_back(tsl::Flag(
       "xla_partitioning_algorithm", setter_for_xla_partitioning_algorithm,
       DebugOptions::PartitioningAlgorithm_Name(
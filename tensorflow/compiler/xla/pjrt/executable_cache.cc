@@ -0,0 +1,232 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/pjrt/executable_cache.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/pjrt/metrics.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+#include "tensorflow/tsl/platform/path.h"
+
+namespace xla {
+
+PjRtExecutableCache::PjRtExecutableCache(PjRtClient* client, Options options)
+    : client_(client), options_(std::move(options)) {}
+
+PjRtExecutableCache::~PjRtExecutableCache() {
+  absl::MutexLock lock(&mu_);
+  while (!entries_.empty()) {
+    RemoveLocked(entries_.begin()->second.get());
+  }
+}
+
+Status PjRtExecutableCache::Insert(
+    const std::string& key, std::unique_ptr<PjRtLoadedExecutable> executable,
+    CompileOptions compile_options) {
+  if (executable == nullptr) {
+    return InvalidArgument("Cannot cache a null executable for key %s", key);
+  }
+  absl::MutexLock lock(&mu_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    RemoveLocked(it->second.get());
+  }
+  auto entry = std::make_unique<Entry>();
+  entry->key = key;
+  entry->compile_options = std::move(compile_options);
+  entry->size_in_bytes = executable->SizeOfGeneratedCodeInBytes();
+  entry->executable = std::move(executable);
+  Entry* entry_ptr = entry.get();
+  entries_[key] = std::move(entry);
+  MarkLoadedLocked(entry_ptr);
+  EvictLocked(/*incoming_bytes=*/0, /*keep=*/entry_ptr);
+  return OkStatus();
+}
+
+StatusOr<std::shared_ptr<PjRtLoadedExecutable>> PjRtExecutableCache::Get(
+    const std::string& key) {
+  absl::MutexLock lock(&mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return NotFound("No executable cached for key %s", key);
+  }
+  Entry* entry = it->second.get();
+  if (entry->executable != nullptr) {
+    lru_.splice(lru_.begin(), lru_, entry->lru_position);
+    ReportExecutableCacheHit();
+    return entry->executable;
+  }
+  EvictLocked(entry->size_in_bytes, /*keep=*/nullptr);
+  uint64_t start_time_usecs = tsl::Env::Default()->NowMicros();
+  TF_RETURN_IF_ERROR(ReloadLocked(entry));
+  ReportExecutableCacheReload(tsl::Env::Default()->NowMicros() -
+                              start_time_usecs);
+  return entry->executable;
+}
+
+int64_t PjRtExecutableCache::Release(int64_t bytes) {
+  absl::MutexLock lock(&mu_);
+  int64_t released = 0;
+  auto it = lru_.end();
+  while (released < bytes && it != lru_.begin()) {
+    Entry* entry = *--it;
+    if (entry->unserializable || entry->executable.use_count() > 1) {
+      continue;
+    }
+    int64_t size_in_bytes = entry->size_in_bytes;
+    // UnloadLocked erases `entry` from `lru_`, so step past it first.
+    auto next = std::next(it);
+    if (UnloadLocked(entry).ok()) {
+      released += size_in_bytes;
+      it = next;
+    }
+  }
+  return released;
+}
+
+bool PjRtExecutableCache::Contains(const std::string& key) const {
+  absl::MutexLock lock(&mu_);
+  return entries_.contains(key);
+}
+
+bool PjRtExecutableCache::IsLoaded(const std::string& key) const {
+  absl::MutexLock lock(&mu_);
+  auto it = entries_.find(key);
+  return it != entries_.end() && it->second->executable != nullptr;
+}
+
+int64_t PjRtExecutableCache::loaded_bytes() const {
+  absl::MutexLock lock(&mu_);
+  return loaded_bytes_;
+}
+
+bool PjRtExecutableCache::OverBudgetLocked(int64_t incoming_bytes) const {
+  if (options_.max_loaded_bytes >= 0 &&
+      loaded_bytes_ + incoming_bytes > options_.max_loaded_bytes) {
+    return true;
+  }
+  if (options_.min_free_device_bytes > 0) {
+    for (PjRtDevice* device : client_->addressable_devices()) {
+      StatusOr<tsl::AllocatorStats> stats = device->GetAllocatorStats();
+      if (!stats.ok() || !stats->bytes_limit.has_value()) {
+        continue;
+      }
+      if (*stats->bytes_limit - stats->bytes_in_use <
+          options_.min_free_device_bytes + incoming_bytes) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void PjRtExecutableCache::EvictLocked(int64_t incoming_bytes,
+                                      const Entry* keep) {
+  auto it = lru_.end();
+  while (it != lru_.begin() && OverBudgetLocked(incoming_bytes)) {
+    Entry* entry = *--it;
+    if (entry == keep || entry->unserializable ||
+        entry->executable.use_count() > 1) {
+      continue;
+    }
+    auto next = std::next(it);
+    if (UnloadLocked(entry).ok()) {
+      it = next;
+    }
+  }
+}
+
+Status PjRtExecutableCache::UnloadLocked(Entry* entry) {
+  if (entry->serialized.empty() && entry->serialized_path.empty()) {
+    StatusOr<std::string> serialized =
+        entry->executable->SerializeExecutable();
+    if (!serialized.ok()) {
+      VLOG(1) << "Keeping executable " << entry->key
+              << " loaded, it cannot be serialized: " << serialized.status();
+      entry->unserializable = true;
+      return serialized.status();
+    }
+    if (options_.serialized_dir.empty()) {
+      entry->serialized = *std::move(serialized);
+    } else {
+      std::string path =
+          tsl::io::JoinPath(options_.serialized_dir,
+                            absl::StrCat("executable_", next_file_id_++));
+      Status status =
+          tsl::WriteStringToFile(tsl::Env::Default(), path, *serialized);
+      if (!status.ok()) {
+        LOG(WARNING) << "Keeping executable " << entry->key
+                     << " loaded, failed to write it to " << path << ": "
+                     << status;
+        return status;
+      }
+      entry->serialized_path = std::move(path);
+    }
+  }
+  VLOG(2) << "Unloading executable " << entry->key << " ("
+          << entry->size_in_bytes << " bytes)";
+  entry->executable->Delete();
+  entry->executable.reset();
+  lru_.erase(entry->lru_position);
+  loaded_bytes_ -= entry->size_in_bytes;
+  ReportExecutableCacheEviction();
+  return OkStatus();
+}
+
+Status PjRtExecutableCache::ReloadLocked(Entry* entry) {
+  std::string from_file;
+  if (!entry->serialized_path.empty()) {
+    TF_RETURN_IF_ERROR(tsl::ReadFileToString(
+        tsl::Env::Default(), entry->serialized_path, &from_file));
+  }
+  const std::string& serialized =
+      entry->serialized_path.empty() ? entry->serialized : from_file;
+  VLOG(2) << "Reloading executable " << entry->key;
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<PjRtLoadedExecutable> executable,
+      client_->DeserializeExecutable(serialized, entry->compile_options));
+  entry->size_in_bytes = executable->SizeOfGeneratedCodeInBytes();
+  entry->executable = std::move(executable);
+  MarkLoadedLocked(entry);
+  return OkStatus();
+}
+
+void PjRtExecutableCache::MarkLoadedLocked(Entry* entry) {
+  lru_.push_front(entry);
+  entry->lru_position = lru_.begin();
+  loaded_bytes_ += entry->size_in_bytes;
+}
+
+void PjRtExecutableCache::RemoveLocked(Entry* entry) {
+  if (entry->executable != nullptr) {
+    lru_.erase(entry->lru_position);
+    loaded_bytes_ -= entry->size_in_bytes;
+  }
+  if (!entry->serialized_path.empty()) {
+    tsl::Env::Default()->DeleteFile(entry->serialized_path).IgnoreError();
+  }
+  // `entry` owns the key, so copy it before erasing.
+  std::string key = entry->key;
+  entries_.erase(key);
+}
+
+}  // namespace xla
@@ -0,0 +1,138 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_PJRT_EXECUTABLE_CACHE_H_
+#define TENSORFLOW_COMPILER_XLA_PJRT_EXECUTABLE_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/compiler/xla/statusor.h"
+
+namespace xla {
+
+// A thread-safe cache of the loaded executables of a PjRtClient that bounds
+// how much device memory they occupy.
+//
+// Unlike LRUCache, which drops its least recently used values, this cache
+// unloads them: an executable over budget is serialized with
+// PjRtExecutable::SerializeExecutable(), deleted from the devices, and kept
+// either in host memory or in a file under `Options::serialized_dir`. A later
+// Get() of the same key reloads it with PjRtClient::DeserializeExecutable().
+// Executables whose serialization is unsupported by the client are never
+// unloaded.
+//
+// Hit, reload, reload latency, and eviction counts are exported through
+// pjrt/metrics.h.
+class PjRtExecutableCache {
+ public:
+  struct Options {
+    // Upper bound on the summed SizeOfGeneratedCodeInBytes() of the loaded
+    // executables. Negative means unbounded.
+    int64_t max_loaded_bytes = -1;
+
+    // If positive, executables are also unloaded while any addressable device
+    // of the client reports, through PjRtDevice::GetAllocatorStats(), fewer
+    // free bytes than this.
+    int64_t min_free_device_bytes = 0;
+
+    // If non-empty, unloaded executables are written to files in this
+    // directory instead of being kept in host memory. The files are removed
+    // when the cache is destroyed.
+    std::string serialized_dir;
+  };
+
+  PjRtExecutableCache(PjRtClient* client, Options options);
+  ~PjRtExecutableCache();
+
+  PjRtExecutableCache(const PjRtExecutableCache&) = delete;
+  PjRtExecutableCache& operator=(const PjRtExecutableCache&) = delete;
+
+  // Adds `executable` under `key`, replacing any previous entry.
+  // `compile_options` must be the options `executable` was compiled with; they
+  // are passed to DeserializeExecutable() when the executable is reloaded.
+  // May unload other executables to make room.
+  Status Insert(const std::string& key,
+                std::unique_ptr<PjRtLoadedExecutable> executable,
+                CompileOptions compile_options);
+
+  // Returns the executable stored under `key`, reloading it if it was
+  // unloaded, or a NotFound error. The executable is not unloaded while the
+  // caller holds the returned pointer.
+  StatusOr<std::shared_ptr<PjRtLoadedExecutable>> Get(const std::string& key);
+
+  // Unloads least recently used executables that are not in use until at
+  // least `bytes` of generated code have been released, or no candidates
+  // remain. Returns the number of bytes released. Intended to be called by
+  // the framework when a device allocation fails.
+  int64_t Release(int64_t bytes);
+
+  bool Contains(const std::string& key) const;
+  bool IsLoaded(const std::string& key) const;
+
+  // Summed SizeOfGeneratedCodeInBytes() of the loaded executables.
+  int64_t loaded_bytes() const;
+
+ private:
+  struct Entry {
+    std::string key;
+    CompileOptions compile_options;
+    int64_t size_in_bytes = 0;
+    // Null while unloaded.
+    std::shared_ptr<PjRtLoadedExecutable> executable;
+    // Position in `lru_`; valid only while loaded.
+    std::list<Entry*>::iterator lru_position;
+    // The serialized executable, once it has been unloaded. Kept after a
+    // reload so that unloading it again does not re-serialize it. Empty if
+    // `serialized_path` is used instead.
+    std::string serialized;
+    std::string serialized_path;
+    // Set once SerializeExecutable() failed; such entries stay loaded.
+    bool unserializable = false;
+  };
+
+  bool OverBudgetLocked(int64_t incoming_bytes) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Unloads entries, least recently used first, while the cache would be over
+  // budget after loading `incoming_bytes` more. Never unloads `keep`.
+  void EvictLocked(int64_t incoming_bytes, const Entry* keep)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  Status UnloadLocked(Entry* entry) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  Status ReloadLocked(Entry* entry) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void MarkLoadedLocked(Entry* entry) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void RemoveLocked(Entry* entry) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  PjRtClient* const client_;
+  const Options options_;
+
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<std::string, std::unique_ptr<Entry>> entries_
+      ABSL_GUARDED_BY(mu_);
+  // Loaded entries, most recently used first.
+  std::list<Entry*> lru_ ABSL_GUARDED_BY(mu_);
+  int64_t loaded_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t next_file_id_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_PJRT_EXECUTABLE_CACHE_H_
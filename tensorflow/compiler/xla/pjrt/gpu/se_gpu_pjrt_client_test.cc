@@ -15,13 +15,16 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/pjrt/gpu/se_gpu_pjrt_client.h"
 
+#include <algorithm>
 #include <array>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/strings/match.h"
+#include "tensorflow/compiler/xla/pjrt/executable_cache.h"
 #include "tensorflow/compiler/xla/service/hlo_parser.h"
 #include "tensorflow/compiler/xla/test.h"
 #include "tensorflow/compiler/xla/tests/literal_test_util.h"
@@ -212,5 +215,86 @@ TEST(StreamExecutorGpuClientTest, RecvErrorNoDeadLock) {
                                 "of size 8 (0 already transferred)"));
 }
 
+TEST(StreamExecutorGpuClientTest, CopyBuffersToDevice) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto client, GetStreamExecutorGpuClient(true, /*allocator_config=*/{},
+                                              /*distributed_client=*/nullptr,
+                                              /*node_id=*/0));
+  if (client->addressable_devices().size() < 2) {
+    GTEST_SKIP() << "Test requires at least two GPUs";
+  }
+  PjRtDevice* src_device = client->addressable_devices()[0];
+  PjRtDevice* dst_device = client->addressable_devices()[1];
+
+  // The large literal is copied in chunks.
+  std::vector<Literal> literals;
+  literals.push_back(LiteralUtil::CreateR1<float>({1.0f, 2.0f, 3.0f}));
+  std::vector<float> large(10 << 20);
+  absl::c_iota(large, 0.0f);
+  literals.push_back(LiteralUtil::CreateR1<float>(large));
+  std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+  std::vector<PjRtBuffer*> buffer_ptrs;
+  for (const Literal& literal : literals) {
+    TF_ASSERT_OK_AND_ASSIGN(auto buffer,
+                            client->BufferFromHostLiteral(literal, src_device));
+    buffer_ptrs.push_back(buffer.get());
+    buffers.push_back(std::move(buffer));
+  }
+
+  TF_ASSERT_OK_AND_ASSIGN(auto copies,
+                          client->CopyBuffersToDevice(buffer_ptrs, dst_device));
+  ASSERT_EQ(copies.size(), literals.size());
+  for (int i = 0; i < copies.size(); ++i) {
+    EXPECT_EQ(copies[i]->device(), dst_device);
+    TF_ASSERT_OK_AND_ASSIGN(auto literal, copies[i]->ToLiteralSync());
+    EXPECT_TRUE(LiteralTestUtil::Equal(literals[i], *literal));
+  }
+}
+
+TEST(StreamExecutorGpuClientTest, ExecutableCacheUnloadsAndReloads) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto client, GetStreamExecutorGpuClient(true, /*allocator_config=*/{},
+                                              /*distributed_client=*/nullptr,
+                                              /*node_id=*/0));
+  static constexpr char const* kAddProgram = R"(HloModule Add
+    ENTRY Add() -> f32[2] {
+      a = f32[2] constant({1, 2})
+      ROOT add = f32[2] add(a, a)
+    })";
+  static constexpr char const* kMulProgram = R"(HloModule Mul
+    ENTRY Mul() -> f32[2] {
+      a = f32[2] constant({1, 2})
+      ROOT mul = f32[2] multiply(a, a)
+    })";
+  TF_ASSERT_OK_AND_ASSIGN(auto add, CompileExecutable(kAddProgram, *client));
+  TF_ASSERT_OK_AND_ASSIGN(auto mul, CompileExecutable(kMulProgram, *client));
+
+  // Room for only one of the two executables at a time.
+  PjRtExecutableCache::Options options;
+  options.max_loaded_bytes = std::max(add->SizeOfGeneratedCodeInBytes(),
+                                      mul->SizeOfGeneratedCodeInBytes());
+  options.serialized_dir = ::testing::TempDir();
+  PjRtExecutableCache cache(client.get(), options);
+  TF_ASSERT_OK(cache.Insert("add", std::move(add), CompileOptions()));
+  TF_ASSERT_OK(cache.Insert("mul", std::move(mul), CompileOptions()));
+  EXPECT_FALSE(cache.IsLoaded("add"));
+  EXPECT_TRUE(cache.IsLoaded("mul"));
+
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, cache.Get("add"));
+  EXPECT_TRUE(cache.IsLoaded("add"));
+  EXPECT_FALSE(cache.IsLoaded("mul"));
+  auto result = executable->Execute(/*argument_handles=*/{{}}, {});
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<xla::Literal> result_literal,
+                          ExtractSingleResult(result));
+  EXPECT_TRUE(LiteralTestUtil::Equal(LiteralUtil::CreateR1<float>({2, 4}),
+                                     *result_literal));
+
+  // An executable held by the caller is not unloaded.
+  TF_ASSERT_OK_AND_ASSIGN(auto mul_executable, cache.Get("mul"));
+  EXPECT_TRUE(cache.IsLoaded("add"));
+  EXPECT_TRUE(cache.IsLoaded("mul"));
+  EXPECT_FALSE(cache.Get("sub").ok());
+}
+
 }  // namespace
 }  // namespace xla
@@ -36,6 +36,7 @@ LocalDeviceState::LocalDeviceState(se::StreamExecutor* executor,
       event_pool_(allow_event_reuse),
       compute_semaphore_(
           /*capacity=*/max_inflight_computations),
+      launch_semaphore_(/*capacity=*/kMaxPendingLaunches),
       executor_(executor),
       client_(client),
       prng_seed_generator_(prng_seed_device_()),
@@ -65,9 +66,13 @@ LocalDeviceState::LocalDeviceState(se::StreamExecutor* executor,
       std::make_unique<WorkerThread>(tsl::Env::Default(), "py_xla_execute");
   callback_thread_ =
       std::make_unique<WorkerThread>(tsl::Env::Default(), "py_xla_callback");
+  launch_thread_ =
+      std::make_unique<WorkerThread>(tsl::Env::Default(), "py_xla_launch");
 }
 
 LocalDeviceState::~LocalDeviceState() {
+  // Blocks until the bookkeeping of the pending launches is done.
+  launch_thread_.reset();
   Status status = SynchronizeAllActivity();
   if (!status.ok()) {
     LOG(ERROR) << "Error when closing device: " << status;
@@ -132,6 +132,11 @@ class LocalDeviceState {
 
   WorkerThread* execute_thread() const { return execute_thread_.get(); }
 
+  // A worker thread for the bookkeeping of pipelined launches, and the
+  // semaphore bounding the number of launches pending on it.
+  WorkerThread* launch_thread() const { return launch_thread_.get(); }
+  Semaphore& launch_semaphore() { return launch_semaphore_; }
+
   // Enqueues a host callback on 'stream'. `stream` may, but need not, wait for
   // `callback` to complete. It is safe to call runtime methods from the
   // callback.
@@ -171,6 +176,10 @@ class LocalDeviceState {
   // stream by the host ahead of the device.
   Semaphore compute_semaphore_;
 
+  // Maximum number of pipelined launches whose bookkeeping is pending.
+  static constexpr int kMaxPendingLaunches = 2;
+  Semaphore launch_semaphore_;
+
   se::StreamExecutor* const executor_;
   LocalClient* const client_;
   std::unique_ptr<se::Stream> compute_stream_;
@@ -206,6 +215,11 @@ class LocalDeviceState {
   // semaphore during calls to Execute but release it from a callback and if
   // they are the same thread we might deadlock.
   std::unique_ptr<WorkerThread> callback_thread_;
+
+  // A worker thread, used for the bookkeeping of pipelined launches. It records
+  // usage events of the compute stream, so it is drained before the streams are
+  // synchronized on destruction.
+  std::unique_ptr<WorkerThread> launch_thread_;
 };
 
 }  // namespace xla
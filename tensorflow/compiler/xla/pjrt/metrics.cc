@@ -30,6 +30,27 @@ auto* pjrt_executable_execution_time_usecs = tsl::monitoring::Counter<0>::New(
     "The total time spent on PjRtExecutable::ExecuteHelper in "
     "microseconds.");
 
+auto* pjrt_executable_cache_hits = tsl::monitoring::Counter<0>::New(
+    "/jax/pjrt/pjrt_executable_cache_hits",
+    "The number of PjRtExecutableCache lookups that found the executable "
+    "loaded.");
+
+auto* pjrt_executable_cache_reloads = tsl::monitoring::Counter<0>::New(
+    "/jax/pjrt/pjrt_executable_cache_reloads",
+    "The number of PjRtExecutableCache lookups that reloaded an unloaded "
+    "executable.");
+
+auto* pjrt_executable_cache_reload_time_usecs =
+    tsl::monitoring::Counter<0>::New(
+        "/jax/pjrt/pjrt_executable_cache_reload_time_usecs",
+        "The total time spent reloading unloaded executables in "
+        "PjRtExecutableCache in microseconds.");
+
+auto* pjrt_executable_cache_evictions = tsl::monitoring::Counter<0>::New(
+    "/jax/pjrt/pjrt_executable_cache_evictions",
+    "The number of executables PjRtExecutableCache unloaded from the "
+    "devices.");
+
 }  // namespace
 
 void ReportExecutableEnqueueTime(const uint64_t running_time_usecs) {
@@ -43,4 +64,25 @@ void ReportExecutableEnqueueTime(const uint64_t running_time_usecs) {
   }
 }
 
+void ReportExecutableCacheHit() {
+  static auto* pjrt_executable_cache_hits_cell =
+      pjrt_executable_cache_hits->GetCell();
+  pjrt_executable_cache_hits_cell->IncrementBy(1);
+}
+
+void ReportExecutableCacheReload(const uint64_t reload_time_usecs) {
+  static auto* pjrt_executable_cache_reloads_cell =
+      pjrt_executable_cache_reloads->GetCell();
+  static auto* pjrt_executable_cache_reload_time_usecs_cell =
+      pjrt_executable_cache_reload_time_usecs->GetCell();
+  pjrt_executable_cache_reloads_cell->IncrementBy(1);
+  pjrt_executable_cache_reload_time_usecs_cell->IncrementBy(reload_time_usecs);
+}
+
+void ReportExecutableCacheEviction() {
+  static auto* pjrt_executable_cache_evictions_cell =
+      pjrt_executable_cache_evictions->GetCell();
+  pjrt_executable_cache_evictions_cell->IncrementBy(1);
+}
+
 }  // namespace xla
@@ -24,6 +24,16 @@ namespace xla {
 
 void ReportExecutableEnqueueTime(const uint64_t running_time_usecs);
 
+// Records a PjRtExecutableCache lookup that found the executable loaded.
+void ReportExecutableCacheHit();
+
+// Records a PjRtExecutableCache lookup that had to reload an unloaded
+// executable, and the time the reload took.
+void ReportExecutableCacheReload(const uint64_t reload_time_usecs);
+
+// Records a PjRtExecutableCache entry being unloaded from the devices.
+void ReportExecutableCacheEviction();
+
 }
 
 #endif  // TENSORFLOW_COMPILER_XLA_PJRT_METRICS_H_
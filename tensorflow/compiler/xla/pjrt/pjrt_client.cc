@@ -18,6 +18,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/base/casts.h"
 #include "absl/strings/substitute.h"
@@ -42,6 +43,19 @@ StatusOr<std::uintptr_t> PjRtClient::UnsafeBufferPointer(PjRtBuffer* buffer) {
   return absl::bit_cast<std::uintptr_t>(ptr);
 }
 
+StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
+PjRtClient::CopyBuffersToDevice(absl::Span<PjRtBuffer* const> buffers,
+                                PjRtDevice* dst_device) {
+  std::vector<std::unique_ptr<PjRtBuffer>> copies;
+  copies.reserve(buffers.size());
+  for (PjRtBuffer* buffer : buffers) {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<PjRtBuffer> copy,
+                        buffer->CopyToDevice(dst_device));
+    copies.push_back(std::move(copy));
+  }
+  return copies;
+}
+
 PjRtFuture<Status> PjRtBuffer::CopyRawToHostFuture(
     PjRtFuture<StatusOr<void*>> dst, int64_t offset, int64_t transfer_size) {
   StatusOr<void*> awaited_dst = dst.Await();
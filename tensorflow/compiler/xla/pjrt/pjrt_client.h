@@ -529,6 +529,14 @@ class PjRtClient {
     return Unimplemented("CreateErrorBuffer not supported.");
   }
 
+  // Copies each of `buffers` to `dst_device`, as PjRtBuffer::CopyToDevice
+  // does. Implementations may batch the copies so that they are enqueued
+  // together and all of the returned buffers become ready at the same time.
+  // The default implementation copies the buffers one at a time.
+  virtual StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
+  CopyBuffersToDevice(absl::Span<PjRtBuffer* const> buffers,
+                      PjRtDevice* dst_device);
+
   // A client may want to create a buffer, and hand the buffer to other PjRt
   // methods, before the data to store in the buffer is available to the client.
   // This is supported using CreateBuffersForAsyncHostToDevice, which returns an
@@ -1165,6 +1173,28 @@ struct ExecuteOptions {
   // Currently it is only applied to CPU implementations
   enum class ExecutionMode { kDefault = 0, kSynchronous, kAsynchronous };
   ExecutionMode execution_mode = ExecutionMode::kDefault;
+
+  // If non-empty, buffers whose memory the results are written into instead of
+  // newly allocated memory, one per leaf of the result (nullptr to allocate
+  // that leaf as usual). A buffer is donated if its memory is used: it becomes
+  // invalid, and the returned buffer of that leaf takes over its memory. Making
+  // the buffers with BufferFromHostBuffer and kZeroCopy semantics lets the
+  // execution write straight into host memory of the caller. A leaf whose
+  // memory the runtime can't use, e.g. because it is a parameter or its buffer
+  // is too small or insufficiently aligned, is allocated as usual and its
+  // buffer is left alone. Currently only supported on CPU, for executions on a
+  // single device.
+  absl::Span<PjRtBuffer* const> output_buffers;
+
+  // If true, the bookkeeping that follows the launch of the computation, i.e.
+  // recording the usage of the arguments and completing their donation, runs
+  // on a launch thread of the device instead of the calling thread, so that the
+  // caller may prepare the next execution meanwhile. Completion callbacks are
+  // still enqueued by the caller, in launch order. Arguments of an execution
+  // whose bookkeeping is still pending stay held, so later uses of them wait
+  // for it. The number of pending executions per device is bounded. Currently
+  // only applied to StreamExecutor implementations.
+  bool pipelined_launch = false;
 };
 
 // Represents a compiled computation that can be executed given handles to
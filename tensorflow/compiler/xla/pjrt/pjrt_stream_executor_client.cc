@@ -510,6 +510,72 @@ Status AddDestinationBufferSynchronization(
   return OkStatus();
 }
 
+// Leaves at least this large are copied between devices in chunks, each on its
+// own device-to-device stream, so that the copies can use more than one copy
+// engine and more of the bandwidth of the peer-to-peer links.
+constexpr int64_t kDeviceToDeviceChunkingThresholdBytes = 32ll << 20;
+constexpr int kMaxDeviceToDeviceChunks = 4;
+constexpr int64_t kDeviceToDeviceChunkAlignment = 256;
+
+// Enqueues copies of the leaves of `src_buffer` into those of `dst_buffer`.
+// Large leaves are split into chunks copied on several device-to-device streams
+// of `transfer_local_device`, which wait for `transfer_stream` and which
+// `transfer_stream` in turn waits for, so that all copies are complete when
+// work enqueued on `transfer_stream` afterwards runs.
+Status EnqueueDeviceToDeviceCopies(LocalDeviceState* transfer_local_device,
+                                   se::Stream* transfer_stream,
+                                   se::Stream* dst_stream,
+                                   const ShapedBuffer& src_buffer,
+                                   const ShapedBuffer& dst_buffer) {
+  absl::InlinedVector<se::Stream*, kMaxDeviceToDeviceChunks> chunk_streams;
+  for (const auto& leaf : src_buffer.buffers().leaves()) {
+    const ShapeIndex& index = leaf.first;
+    const se::DeviceMemoryBase& input_buffer = leaf.second;
+    const se::DeviceMemoryBase& output_buffer = dst_buffer.buffer(index);
+    TF_RET_CHECK(input_buffer.size() == output_buffer.size())
+        << "input: " << input_buffer.size()
+        << " output: " << output_buffer.size();
+    const int64_t size = input_buffer.size();
+    if (size == 0) {
+      continue;
+    }
+    if (size < kDeviceToDeviceChunkingThresholdBytes) {
+      TF_RETURN_IF_ERROR(transfer_local_device->ThenMemcpyDeviceToDevice(
+          transfer_stream, dst_stream, input_buffer, output_buffer));
+      continue;
+    }
+    const int64_t chunk_bytes =
+        RoundUpTo(CeilOfRatio<int64_t>(size, kMaxDeviceToDeviceChunks),
+                  kDeviceToDeviceChunkAlignment);
+    for (int64_t offset = 0; offset < size; offset += chunk_bytes) {
+      if (chunk_streams.size() < kMaxDeviceToDeviceChunks) {
+        se::Stream* stream = transfer_local_device->GetDeviceToDeviceStream();
+        if (stream != transfer_stream) {
+          // Waits for the definition events of the source buffer and for the
+          // allocation of the destination buffer.
+          stream->ThenWaitFor(transfer_stream);
+        }
+        chunk_streams.push_back(stream);
+      }
+      se::Stream* stream =
+          chunk_streams[(offset / chunk_bytes) % chunk_streams.size()];
+      const int64_t chunk_size = std::min(chunk_bytes, size - offset);
+      se::DeviceMemoryBase input_chunk(
+          static_cast<char*>(input_buffer.opaque()) + offset, chunk_size);
+      se::DeviceMemoryBase output_chunk(
+          static_cast<char*>(output_buffer.opaque()) + offset, chunk_size);
+      TF_RETURN_IF_ERROR(transfer_local_device->ThenMemcpyDeviceToDevice(
+          stream, dst_stream, input_chunk, output_chunk));
+    }
+  }
+  for (se::Stream* stream : chunk_streams) {
+    if (stream != transfer_stream) {
+      transfer_stream->ThenWaitFor(stream);
+    }
+  }
+  return OkStatus();
+}
+
 }  // namespace
 
 PjRtStreamExecutorBuffer::ScopedHold::~ScopedHold() {
@@ -995,6 +1061,413 @@ PjRtStreamExecutorClient::BufferFromHostLiteral(const LiteralSlice& literal,
   return std::unique_ptr<PjRtBuffer>(std::move(py_buffer));
 }
 
+namespace {
+
+// Double-buffered staging memory on the host for the raw data transfers of a
+// StreamExecutorAsyncHostToDeviceTransferManager. Each chunk of data is copied
+// into a free staging buffer, from which the device copies it asynchronously,
+// so the caller may free or refill its memory as soon as the chunk is staged.
+class HostToDeviceStagingBuffers {
+ public:
+  // Bytes in each of the staging buffers.
+  static constexpr int64_t kBufferSize = 16ll << 20;
+
+  explicit HostToDeviceStagingBuffers(tsl::Allocator* allocator)
+      : allocator_(allocator) {
+    for (int i = 0; i < kNumBuffers; ++i) {
+      buffers_.push_back(
+          allocator_->AllocateRaw(tsl::Allocator::kAllocatorAlignment,
+                                  kBufferSize));
+    }
+    free_buffers_ = buffers_;
+  }
+
+  HostToDeviceStagingBuffers(const HostToDeviceStagingBuffers&) = delete;
+  HostToDeviceStagingBuffers& operator=(const HostToDeviceStagingBuffers&) =
+      delete;
+
+  ~HostToDeviceStagingBuffers() {
+    for (void* buffer : buffers_) {
+      allocator_->DeallocateRaw(buffer);
+    }
+  }
+
+  // Blocks until a staging buffer is free, and returns it.
+  void* Acquire() {
+    absl::MutexLock lock(&mu_);
+    auto buffer_is_free = [&]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return !free_buffers_.empty();
+    };
+    mu_.Await(absl::Condition(&buffer_is_free));
+    void* buffer = free_buffers_.back();
+    free_buffers_.pop_back();
+    return buffer;
+  }
+
+  void Release(void* buffer) {
+    absl::MutexLock lock(&mu_);
+    free_buffers_.push_back(buffer);
+  }
+
+ private:
+  static constexpr int kNumBuffers = 2;
+
+  tsl::Allocator* const allocator_;
+  std::vector<void*> buffers_;
+  absl::Mutex mu_;
+  std::vector<void*> free_buffers_ ABSL_GUARDED_BY(mu_);
+};
+
+class StreamExecutorAsyncHostToDeviceTransferManager
+    : public PjRtClient::AsyncHostToDeviceTransferManager {
+ public:
+  static StatusOr<
+      std::unique_ptr<StreamExecutorAsyncHostToDeviceTransferManager>>
+  Create(absl::Span<const Shape> shapes, PjRtStreamExecutorDevice* device,
+         PjRtStreamExecutorClient* client) {
+    TF_ASSIGN_OR_RETURN(LocalDeviceState * local_device,
+                        device->GetLocalDeviceState());
+    TransferManager* transfer_manager =
+        client->client()->backend().transfer_manager();
+    std::vector<std::unique_ptr<PjRtStreamExecutorBuffer>> buffers;
+    buffers.reserve(shapes.size());
+    for (const Shape& shape : shapes) {
+      if (shape.IsTuple()) {
+        return Unimplemented(
+            "Async transfers into tuple buffers are not supported");
+      }
+      TF_ASSIGN_OR_RETURN(
+          Shape compact_shape,
+          transfer_manager->ChooseCompactLayoutForShape(shape));
+      TF_ASSIGN_OR_RETURN(
+          std::unique_ptr<PjRtStreamExecutorBuffer> buffer,
+          AllocateDestinationBuffer(compact_shape, device, local_device,
+                                    local_device->host_to_device_stream(),
+                                    /*is_uninitialized_create=*/false,
+                                    client));
+      buffers.push_back(std::move(buffer));
+    }
+    return std::unique_ptr<StreamExecutorAsyncHostToDeviceTransferManager>(
+        new StreamExecutorAsyncHostToDeviceTransferManager(
+            std::move(buffers), device, local_device, client));
+  }
+
+  ~StreamExecutorAsyncHostToDeviceTransferManager() override {
+    // Consumers would otherwise wait forever for the buffers whose transfers
+    // were never completed.
+    absl::MutexLock lock(&mu_);
+    for (int i = 0; i < device_buffers_.size(); ++i) {
+      if (device_buffers_[i].ok()) {
+        LOG(ERROR) << "Async transfer into buffer " << i
+                   << " was not completed; its contents are undefined";
+        DefineBufferLocked(i).IgnoreError();
+      }
+    }
+  }
+
+  size_t buffer_count() const override { return buffer_sizes_.size(); }
+
+  PjRtDevice* device() const override { return device_; }
+
+  std::unique_ptr<PjRtBuffer> RetrieveBuffer(int buffer_index) override {
+    absl::MutexLock lock(&mu_);
+    CHECK(buffers_[buffer_index] != nullptr)
+        << "Buffer " << buffer_index << " was already retrieved";
+    return std::move(buffers_[buffer_index]);
+  }
+
+  Status TransferLiteralToBuffer(
+      int buffer_index, const LiteralSlice& literal,
+      absl::AnyInvocable<void() &&> on_done) override {
+    tsl::profiler::TraceMe traceme(
+        "StreamExecutorAsyncHostToDeviceTransferManager::"
+        "TransferLiteralToBuffer");
+    absl::MutexLock lock(&mu_);
+    TF_RETURN_IF_ERROR(CheckTransferLocked(buffer_index));
+    se::Stream* h2d_stream = local_device_->host_to_device_stream();
+    TransferManager* transfer_manager =
+        client_->client()->backend().transfer_manager();
+    ShapedBuffer buffer = device_buffers_[buffer_index]->AsShapedBuffer(
+        buffers_on_device_shapes_[buffer_index]);
+    TF_RETURN_IF_ERROR(transfer_manager->TransferLiteralToDeviceAsync(
+        h2d_stream, literal, buffer));
+    ThenCallOnDone(std::move(on_done));
+    return DefineBufferLocked(buffer_index);
+  }
+
+  size_t buffer_size(int buffer_index) const override {
+    return buffer_sizes_[buffer_index];
+  }
+
+  Status TransferRawDataToBuffer(
+      int buffer_index, absl::string_view data,
+      absl::AnyInvocable<void() &&> on_done) override {
+    return TransferRawDataToSubBuffer(buffer_index, data.data(),
+                                      /*offset=*/0, data.size(),
+                                      /*is_last_transfer=*/true,
+                                      std::move(on_done));
+  }
+
+  Status TransferRawDataToSubBuffer(
+      int buffer_index, const void* data, int64_t offset,
+      int64_t transfer_size, bool is_last_transfer,
+      absl::AnyInvocable<void() &&> on_done) override {
+    tsl::profiler::TraceMe traceme(
+        "StreamExecutorAsyncHostToDeviceTransferManager::"
+        "TransferRawDataToSubBuffer");
+    absl::MutexLock lock(&mu_);
+    TF_RETURN_IF_ERROR(CheckTransferLocked(buffer_index));
+    if (offset < 0 || transfer_size < 0 ||
+        offset + transfer_size > buffer_sizes_[buffer_index]) {
+      return InvalidArgument(
+          "Transfer of %d bytes at offset %d is out of bounds of buffer %d of "
+          "size %d",
+          transfer_size, offset, buffer_index, buffer_sizes_[buffer_index]);
+    }
+    se::Stream* h2d_stream = local_device_->host_to_device_stream();
+    const se::DeviceMemoryBase& device_memory =
+        device_buffers_[buffer_index]->device_memory()[0];
+    char* dst = static_cast<char*>(device_memory.opaque()) + offset;
+    const char* src = static_cast<const char*>(data);
+    if (client_->should_stage_host_to_device_transfers()) {
+      if (staging_buffers_ == nullptr) {
+        staging_buffers_ = std::make_shared<HostToDeviceStagingBuffers>(
+            client_->host_memory_allocator());
+      }
+      for (int64_t staged = 0; staged < transfer_size;
+           staged += HostToDeviceStagingBuffers::kBufferSize) {
+        const int64_t size = std::min(HostToDeviceStagingBuffers::kBufferSize,
+                                      transfer_size - staged);
+        // Blocks while the device still copies out of both staging buffers.
+        void* staging_buffer = staging_buffers_->Acquire();
+        std::memcpy(staging_buffer, src + staged, size);
+        se::DeviceMemoryBase dst_chunk(dst + staged, size);
+        h2d_stream->ThenMemcpy(&dst_chunk, staging_buffer, size);
+        h2d_stream->ThenDoHostCallback(
+            [staging_buffers = staging_buffers_, staging_buffer]() {
+              staging_buffers->Release(staging_buffer);
+            });
+      }
+    } else if (transfer_size > 0) {
+      se::DeviceMemoryBase dst_chunk(dst, transfer_size);
+      h2d_stream->ThenMemcpy(&dst_chunk, src, transfer_size);
+    }
+    ThenCallOnDone(std::move(on_done));
+    if (is_last_transfer) {
+      return DefineBufferLocked(buffer_index);
+    }
+    return OkStatus();
+  }
+
+  void SetBufferError(int buffer_index, Status error) override {
+    absl::MutexLock lock(&mu_);
+    if (!CheckTransferLocked(buffer_index).ok()) return;
+    // Buffers can't carry errors, so consumers see undefined contents instead.
+    LOG(ERROR) << "Async transfer into buffer " << buffer_index
+               << " failed: " << error;
+    DefineBufferLocked(buffer_index).IgnoreError();
+  }
+
+  void AddTransferMetadata(const TransferMetadata& metadata) override {}
+
+ private:
+  StreamExecutorAsyncHostToDeviceTransferManager(
+      std::vector<std::unique_ptr<PjRtStreamExecutorBuffer>> buffers,
+      PjRtStreamExecutorDevice* device, LocalDeviceState* local_device,
+      PjRtStreamExecutorClient* client)
+      : buffers_(std::move(buffers)),
+        device_(device),
+        local_device_(local_device),
+        client_(client) {
+    for (const auto& buffer : buffers_) {
+      buffers_on_device_shapes_.push_back(buffer->on_device_shape());
+      device_buffers_.push_back(buffer->GetBufferWithUsageHold());
+      CHECK(device_buffers_.back().ok());
+      buffer_sizes_.push_back(
+          device_buffers_.back()->device_memory()[0].size());
+    }
+  }
+
+  Status CheckTransferLocked(int buffer_index)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (buffer_index < 0 || buffer_index >= device_buffers_.size()) {
+      return InvalidArgument("Invalid buffer index %d", buffer_index);
+    }
+    if (!device_buffers_[buffer_index].ok()) {
+      return InvalidArgument(
+          "Transfer into buffer %d after its last transfer", buffer_index);
+    }
+    return OkStatus();
+  }
+
+  // Calls `on_done` once the transfers enqueued so far have completed.
+  void ThenCallOnDone(absl::AnyInvocable<void() &&> on_done) {
+    if (!on_done) return;
+    local_device_->ThenExecuteCallback(
+        local_device_->host_to_device_stream(),
+        [on_done = std::make_shared<absl::AnyInvocable<void() &&>>(
+             std::move(on_done))]() { std::move(*on_done)(); });
+  }
+
+  // Makes buffer `buffer_index` available once the transfers enqueued so far
+  // have completed, and releases the hold of the transfers on it.
+  Status DefineBufferLocked(int buffer_index)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    PjRtStreamExecutorBuffer::ScopedHold device_buffer =
+        std::move(device_buffers_[buffer_index]);
+    std::shared_ptr<BufferSequencingEvent> event =
+        device_buffer->definition_events()[0];
+    return AddDestinationBufferSynchronization(
+        local_device_, std::move(device_buffer), event,
+        local_device_->host_to_device_stream());
+  }
+
+  absl::Mutex mu_;
+  // The buffers not yet retrieved.
+  std::vector<std::unique_ptr<PjRtStreamExecutorBuffer>> buffers_
+      ABSL_GUARDED_BY(mu_);
+  // Usage holds on the buffers, released by their last transfers. Declared
+  // after `buffers_`, since buffers can't be deleted while they are held.
+  std::vector<PjRtStreamExecutorBuffer::ScopedHold> device_buffers_
+      ABSL_GUARDED_BY(mu_);
+  std::vector<Shape> buffers_on_device_shapes_;
+  std::vector<int64_t> buffer_sizes_;
+  // Allocated on the first staged raw data transfer. Shared with the host
+  // callbacks that free the staging buffers again.
+  std::shared_ptr<HostToDeviceStagingBuffers> staging_buffers_
+      ABSL_GUARDED_BY(mu_);
+
+  PjRtStreamExecutorDevice* const device_;
+  LocalDeviceState* const local_device_;
+  PjRtStreamExecutorClient* const client_;
+};
+
+}  // namespace
+
+StatusOr<std::unique_ptr<PjRtClient::AsyncHostToDeviceTransferManager>>
+PjRtStreamExecutorClient::CreateBuffersForAsyncHostToDevice(
+    absl::Span<const Shape> shapes, PjRtDevice* device) {
+  tsl::profiler::TraceMe traceme(
+      "PjRtStreamExecutorClient::CreateBuffersForAsyncHostToDevice");
+  TF_ASSIGN_OR_RETURN(
+      auto transfer_manager,
+      StreamExecutorAsyncHostToDeviceTransferManager::Create(
+          shapes, tensorflow::down_cast<PjRtStreamExecutorDevice*>(device),
+          this));
+  return std::unique_ptr<PjRtClient::AsyncHostToDeviceTransferManager>(
+      std::move(transfer_manager));
+}
+
+StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
+PjRtStreamExecutorClient::CopyBuffersToDevice(
+    absl::Span<PjRtBuffer* const> buffers, PjRtDevice* dst_device) {
+  tsl::profiler::TraceMe traceme(
+      "PjRtStreamExecutorClient::CopyBuffersToDevice");
+  VLOG(1) << "PjRtStreamExecutorClient::CopyBuffersToDevice: "
+          << buffers.size() << " buffers to " << dst_device->DebugString();
+  // The copies can only share a transfer stream if they are all between the
+  // same two devices of this client.
+  PjRtDevice* src_device = buffers.empty() ? nullptr : buffers[0]->device();
+  bool can_batch = buffers.size() > 1 && src_device != dst_device &&
+                   dst_device->client() == this &&
+                   src_device->client() == this;
+  for (PjRtBuffer* buffer : buffers) {
+    can_batch = can_batch && buffer->device() == src_device;
+  }
+  if (!can_batch) {
+    return PjRtClient::CopyBuffersToDevice(buffers, dst_device);
+  }
+
+  LocalDeviceState* src_local_device =
+      tensorflow::down_cast<PjRtStreamExecutorDevice*>(src_device)
+          ->local_device_state();
+  TF_ASSIGN_OR_RETURN(
+      LocalDeviceState * dst_local_device,
+      tensorflow::down_cast<PjRtStreamExecutorDevice*>(dst_device)
+          ->GetLocalDeviceState());
+  LocalDeviceState* transfer_local_device =
+      EnqueueD2DTransfersOnSrcStream() ? src_local_device : dst_local_device;
+  CHECK_EQ(dst_local_device->allocation_model(),
+           transfer_local_device->allocation_model());
+
+  std::vector<PjRtStreamExecutorBuffer::ScopedHold> src_device_buffers;
+  src_device_buffers.reserve(buffers.size());
+  for (int i = 0; i < buffers.size(); ++i) {
+    src_device_buffers.push_back(
+        tensorflow::down_cast<PjRtStreamExecutorBuffer*>(buffers[i])
+            ->GetBufferWithUsageHold());
+    if (!src_device_buffers.back().ok()) {
+      return InvalidArgument(
+          "CopyBuffersToDevice called on deleted or donated buffer %d: %s", i,
+          src_device_buffers.back().status().ToString());
+    }
+  }
+
+  se::Stream* transfer_stream =
+      transfer_local_device->GetDeviceToDeviceStream();
+
+  // All of the destination buffers are defined by the same event, recorded
+  // once the copies of all of them have been enqueued.
+  auto definition_event = std::make_shared<BufferSequencingEvent>();
+  std::vector<std::unique_ptr<PjRtBuffer>> dst_buffers;
+  dst_buffers.reserve(buffers.size());
+  std::vector<PjRtStreamExecutorBuffer::ScopedHold> dst_device_buffers;
+  dst_device_buffers.reserve(buffers.size());
+  Status status = [&]() -> Status {
+    for (int i = 0; i < buffers.size(); ++i) {
+      const Shape& on_device_shape = buffers[i]->on_device_shape();
+      TF_ASSIGN_OR_RETURN(
+          std::unique_ptr<PjRtStreamExecutorBuffer> dst_buffer,
+          AllocateDestinationBuffer(
+              ShapeUtil::DeviceShapeToHostShape(on_device_shape), dst_device,
+              dst_local_device, transfer_stream,
+              /*is_uninitialized_create=*/false, this, definition_event));
+      WaitForBufferDefinitionEventsOnStream(*src_device_buffers[i],
+                                            transfer_stream);
+      // The holds are dropped before the buffers on error.
+      dst_device_buffers.push_back(dst_buffer->GetBufferWithUsageHold());
+      CHECK(dst_device_buffers.back().ok());
+      dst_buffers.push_back(std::move(dst_buffer));
+      TF_RETURN_IF_ERROR(EnqueueDeviceToDeviceCopies(
+          transfer_local_device, transfer_stream,
+          dst_local_device->compute_stream(),
+          src_device_buffers[i]->AsShapedBuffer(on_device_shape),
+          dst_device_buffers.back()->AsShapedBuffer(on_device_shape)));
+    }
+    TF_ASSIGN_OR_RETURN(
+        EventPool::Handle event,
+        transfer_local_device->event_pool().ThenAllocateAndRecordEvent(
+            transfer_stream));
+    definition_event->SetSequencingEvent(std::move(event), transfer_stream);
+    return OkStatus();
+  }();
+  if (!status.ok()) {
+    StallStreamOnError(transfer_local_device, transfer_stream);
+    if (transfer_local_device == dst_local_device) {
+      // Make sure that the source buffers remain valid until any copies that
+      // were enqueued before the error have completed.
+      for (PjRtStreamExecutorBuffer::ScopedHold& b : src_device_buffers) {
+        src_local_device->ThenRelease(transfer_stream, b.buffer());
+      }
+    }
+    return status;
+  }
+
+  // See AddDestinationBufferSynchronization and CopyToDevice for the choices
+  // of prefer_to_retain_reference.
+  for (PjRtStreamExecutorBuffer::ScopedHold& b : dst_device_buffers) {
+    RecordUsage(std::move(b), transfer_local_device, transfer_local_device,
+                definition_event, transfer_stream,
+                /*prefer_to_retain_reference=*/false);
+  }
+  for (PjRtStreamExecutorBuffer::ScopedHold& b : src_device_buffers) {
+    RecordUsage(std::move(b), src_local_device, transfer_local_device,
+                definition_event, transfer_stream,
+                /*prefer_to_retain_reference=*/true);
+  }
+  return dst_buffers;
+}
+
 StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
 PjRtStreamExecutorClient::MakeCrossHostReceiveBuffers(
     absl::Span<const Shape> shapes, PjRtDevice* device,
@@ -1448,19 +1921,9 @@ PjRtStreamExecutorBuffer::CopyToDeviceHelper(
   // Copy the leaf buffers.
   StatusOr<std::shared_ptr<BufferSequencingEvent>> copy_event_or =
       [&]() -> StatusOr<std::shared_ptr<BufferSequencingEvent>> {
-    for (const auto& leaf : src_buffer.buffers().leaves()) {
-      const ShapeIndex& index = leaf.first;
-      const se::DeviceMemoryBase& input_buffer = leaf.second;
-      const se::DeviceMemoryBase& output_buffer = dst_buffer.buffer(index);
-      TF_RET_CHECK(input_buffer.size() == output_buffer.size())
-          << "input: " << input_buffer.size()
-          << " output: " << output_buffer.size();
-      if (input_buffer.size() != 0) {
-        TF_RETURN_IF_ERROR(transfer_local_device->ThenMemcpyDeviceToDevice(
-            transfer_stream, dst_local_device->compute_stream(), input_buffer,
-            output_buffer));
-      }
-    }
+    TF_RETURN_IF_ERROR(EnqueueDeviceToDeviceCopies(
+        transfer_local_device, transfer_stream,
+        dst_local_device->compute_stream(), src_buffer, dst_buffer));
     std::shared_ptr<BufferSequencingEvent> event =
         dst_device_buffer->definition_events()[0];
     TF_RETURN_IF_ERROR(AddDestinationBufferSynchronization(
@@ -2436,21 +2899,6 @@ PjRtStreamExecutorExecutable::ExecuteHelper(
       device_ordinal, options, std::move(result_buffer), definition_event,
       device, compute_callbacks, buffers_to_release);
 
-  for (PjRtStreamExecutorBuffer::ScopedHold& b : device_buffers) {
-    // prefer_to_retain_reference=false because when using the
-    // ComputeSynchronized allocation model we don't need to retain a reference
-    // to the device_buffer during execution because by definition the compute
-    // stream is synchronized past the execution.
-    if (b.type() == PjRtStreamExecutorBuffer::ScopedHold::kUsage) {
-      RecordUsage(std::move(b), device_state, device_state, definition_event,
-                  stream,
-                  /*prefer_to_retain_reference=*/false, &buffers_to_release);
-    } else {
-      CHECK(b.type() == PjRtStreamExecutorBuffer::ScopedHold::kDonation);
-      b.ConfirmDonation();
-    }
-  }
-
   std::optional<PjRtFuture<Status>> future;
   if (fill_future) {
     auto promise = PjRtFuture<Status>::CreatePromise();
@@ -2458,13 +2906,69 @@ PjRtStreamExecutorExecutable::ExecuteHelper(
     compute_callbacks.push_back(
         [promise = std::move(promise)]() mutable { promise.Set(OkStatus()); });
   }
-  device_state->ThenExecuteCallback(
-      stream, [callbacks{std::move(compute_callbacks)},
-               buffers_to_release{std::move(buffers_to_release)}]() {
-        for (auto& fn : callbacks) {
-          fn();
+
+  auto record_usage =
+      [device_state, stream, definition_event](
+          std::vector<PjRtStreamExecutorBuffer::ScopedHold>& device_buffers,
+          std::vector<std::shared_ptr<TrackedDeviceBuffer>>*
+              buffers_to_release) {
+        for (PjRtStreamExecutorBuffer::ScopedHold& b : device_buffers) {
+          // prefer_to_retain_reference=false because when using the
+          // ComputeSynchronized allocation model we don't need to retain a
+          // reference to the device_buffer during execution because by
+          // definition the compute stream is synchronized past the execution.
+          if (b.type() == PjRtStreamExecutorBuffer::ScopedHold::kUsage) {
+            RecordUsage(std::move(b), device_state, device_state,
+                        definition_event, stream,
+                        /*prefer_to_retain_reference=*/false,
+                        buffers_to_release);
+          } else {
+            CHECK(b.type() == PjRtStreamExecutorBuffer::ScopedHold::kDonation);
+            b.ConfirmDonation();
+          }
         }
-      });
+      };
+  if (!options.pipelined_launch) {
+    record_usage(device_buffers, &buffers_to_release);
+    device_state->ThenExecuteCallback(
+        stream, [callbacks{std::move(compute_callbacks)},
+                 buffers_to_release{std::move(buffers_to_release)}]() {
+          for (auto& fn : callbacks) {
+            fn();
+          }
+        });
+  } else {
+    // The completion callback is enqueued before returning, so that it runs
+    // right after this execution and ahead of the next one, in launch order.
+    // Only the conversion of the argument holds moves to the launch thread.
+    // The buffers it retains are shared with the callback, and released once
+    // both the callback has run and the launch thread is done with them.
+    auto launch_buffers =
+        std::make_shared<std::vector<std::shared_ptr<TrackedDeviceBuffer>>>();
+    device_state->ThenExecuteCallback(
+        stream, [callbacks{std::move(compute_callbacks)},
+                 buffers_to_release{std::move(buffers_to_release)},
+                 launch_buffers]() {
+          for (auto& fn : callbacks) {
+            fn();
+          }
+        });
+    // Blocks while too many launches of the device are pending, so that the
+    // host doesn't get arbitrarily far ahead of the launch thread.
+    auto launch_reservation = std::make_shared<Semaphore::ScopedReservation>(
+        device_state->launch_semaphore().ScopedAcquire(1));
+    // WorkerThread requires a copyable closure but the holds are move-only.
+    auto holds =
+        std::make_shared<std::vector<PjRtStreamExecutorBuffer::ScopedHold>>(
+            std::move(device_buffers));
+    device_state->launch_thread()->Schedule(
+        [record_usage, holds = std::move(holds),
+         launch_buffers = std::move(launch_buffers),
+         launch_reservation = std::move(launch_reservation)]() {
+          tsl::profiler::TraceMe traceme("PipelinedLaunchBookkeeping");
+          record_usage(*holds, launch_buffers.get());
+        });
+  }
   ReportExecutableEnqueueTime(tsl::Env::Default()->NowMicros() -
                               start_time_usecs);
   return Result({/*future=*/std::move(future), /*buffers=*/std::move(outputs)});
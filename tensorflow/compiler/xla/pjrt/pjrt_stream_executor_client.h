@@ -226,11 +226,13 @@ class PjRtStreamExecutorClient : public PjRtClient {
       const Shape& shape, PjRtDevice* device,
       std::shared_ptr<BufferSequencingEvent> definition_event);
 
+  // Each of the buffers becomes available as soon as its own last transfer
+  // completes. Where host-to-device transfers are staged, raw data passes
+  // through a pair of staging buffers in host memory, so that a transfer can
+  // be enqueued while the previous one is in flight.
   StatusOr<std::unique_ptr<PjRtClient::AsyncHostToDeviceTransferManager>>
   CreateBuffersForAsyncHostToDevice(absl::Span<const Shape> shapes,
-                                    PjRtDevice* device) override {
-    return Unimplemented("Async transfer to buffers not implemented");
-  };
+                                    PjRtDevice* device) override;
 
   StatusOr<std::unique_ptr<PjRtBuffer>> BufferFromHostBuffer(
       const void* data, PrimitiveType type, absl::Span<int64_t const> dims,
@@ -242,6 +244,12 @@ class PjRtStreamExecutorClient : public PjRtClient {
   StatusOr<std::unique_ptr<PjRtBuffer>> BufferFromHostLiteral(
       const LiteralSlice& literal, PjRtDevice* device) override;
 
+  // Copies between two devices of this client are enqueued on a single
+  // transfer stream and complete with a single definition event shared by all
+  // of the returned buffers.
+  StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>> CopyBuffersToDevice(
+      absl::Span<PjRtBuffer* const> buffers, PjRtDevice* dst_device) override;
+
   StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
   MakeCrossHostReceiveBuffers(absl::Span<const Shape> shapes,
                               PjRtDevice* device,
@@ -15,25 +15,84 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/pjrt/pjrt_stream_executor_client.h"
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <gmock/gmock.h>
+#include "absl/algorithm/container.h"
 #include "absl/functional/any_invocable.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
 #include "tensorflow/compiler/xla/client/xla_builder.h"
+#include "tensorflow/compiler/xla/literal_util.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
 #include "tensorflow/compiler/xla/service/platform_util.h"
 #include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/stream_executor/device_memory_allocator.h"
 #include "tensorflow/compiler/xla/test.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
 
 namespace xla {
 namespace {
 
-xla::StatusOr<std::unique_ptr<PjRtStreamExecutorClient>> GetClient() {
+// Records the order in which device memory is deallocated. The memory itself
+// is only freed when the allocator is destroyed, so that addresses are not
+// reused while the test is running.
+class DeallocationRecordingAllocator : public se::DeviceMemoryAllocator {
+ public:
+  struct Log {
+    absl::Mutex mu;
+    std::vector<void*> deallocated ABSL_GUARDED_BY(mu);
+  };
+
+  DeallocationRecordingAllocator(se::StreamExecutor* executor, Log* log)
+      : se::DeviceMemoryAllocator(executor->platform()),
+        wrapped_(executor),
+        log_(log) {}
+
+  ~DeallocationRecordingAllocator() override {
+    for (const auto& [device_ordinal, mem] : freed_) {
+      wrapped_.Deallocate(device_ordinal, mem).IgnoreError();
+    }
+  }
+
+  StatusOr<se::OwningDeviceMemory> Allocate(int device_ordinal, uint64_t size,
+                                            bool retry_on_failure,
+                                            int64_t memory_space) override {
+    TF_ASSIGN_OR_RETURN(se::OwningDeviceMemory memory,
+                        wrapped_.Allocate(device_ordinal, size,
+                                          retry_on_failure, memory_space));
+    return se::OwningDeviceMemory(memory.Release(), device_ordinal, this);
+  }
+
+  using se::DeviceMemoryAllocator::Allocate;
+
+  Status Deallocate(int device_ordinal, se::DeviceMemoryBase mem) override {
+    if (mem.is_null()) return OkStatus();
+    absl::MutexLock lock(&log_->mu);
+    log_->deallocated.push_back(mem.opaque());
+    freed_.emplace_back(device_ordinal, mem);
+    return OkStatus();
+  }
+
+  StatusOr<se::Stream*> GetStream(int device_ordinal) override {
+    return wrapped_.GetStream(device_ordinal);
+  }
+
+ private:
+  se::StreamExecutorMemoryAllocator wrapped_;
+  Log* log_;
+  // Guarded by log_->mu.
+  std::vector<std::pair<int, se::DeviceMemoryBase>> freed_;
+};
+
+xla::StatusOr<std::unique_ptr<PjRtStreamExecutorClient>> GetClient(
+    DeallocationRecordingAllocator::Log* deallocation_log = nullptr) {
   LocalClient* local_client = xla::ClientLibrary::LocalClientOrDie();
   TF_ASSIGN_OR_RETURN(se::Platform * platform,
                       PlatformUtil::GetPlatform("Host"));
@@ -41,6 +100,11 @@ xla::StatusOr<std::unique_ptr<PjRtStreamExecutorClient>> GetClient() {
   config.ordinal = 0;
   TF_ASSIGN_OR_RETURN(se::StreamExecutor * executor,
                       platform->GetExecutor(config));
+  std::unique_ptr<se::DeviceMemoryAllocator> allocator;
+  if (deallocation_log != nullptr) {
+    allocator = std::make_unique<DeallocationRecordingAllocator>(
+        executor, deallocation_log);
+  }
   auto device_state = std::make_unique<LocalDeviceState>(
       executor, local_client, LocalDeviceState::kSynchronous,
       /*max_inflight_computations=*/32,
@@ -51,7 +115,7 @@ xla::StatusOr<std::unique_ptr<PjRtStreamExecutorClient>> GetClient() {
   devices.emplace_back(std::move(device));
   return std::make_unique<PjRtStreamExecutorClient>(
       "cpu", local_client, std::move(devices), /*process_index=*/0,
-      /*allocator=*/nullptr, /*host_memory_allocator=*/nullptr,
+      std::move(allocator), /*host_memory_allocator=*/nullptr,
       /*should_stage_host_to_device_transfers=*/false,
       /*gpu_run_options=*/nullptr);
 }
@@ -114,5 +178,150 @@ TEST(PjRtStreamExecutorClientTest, DonateSameBufferTwice) {
               ::testing::HasSubstr("f(donate(a), donate(a))"));
 }
 
+TEST(PjRtStreamExecutorClientTest, PipelinedLaunch) {
+  auto shape = xla::ShapeUtil::MakeScalarShape(xla::F32);
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  TF_ASSERT_OK_AND_ASSIGN(auto* device0, client->LookupDevice(0));
+  // f(donate(a), b)
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto executable,
+      ToyExecutable(*client, shape, [](XlaBuilder& builder) {
+        builder.SetUpAlias({0}, 0, {});
+      }));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<PjRtBuffer> a,
+      client->BufferFromHostLiteral(LiteralUtil::CreateR0<float>(1.0f),
+                                    device0));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<PjRtBuffer> b,
+      client->BufferFromHostLiteral(LiteralUtil::CreateR0<float>(2.0f),
+                                    device0));
+
+  ExecuteOptions options;
+  options.untuple_result = true;
+  options.pipelined_launch = true;
+  for (int i = 0; i < 4; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(auto results,
+                            executable->Execute({{a.get(), b.get()}}, options));
+    ASSERT_EQ(results[0].size(), 2);
+    a = std::move(results[0][0]);
+  }
+
+  TF_ASSERT_OK_AND_ASSIGN(auto literal, a->ToLiteralSync());
+  EXPECT_EQ(*literal, LiteralUtil::CreateR0<float>(9.0f));
+}
+
+TEST(PjRtStreamExecutorClientTest, PipelinedLaunchReleasesBuffersInOrder) {
+  auto shape = xla::ShapeUtil::MakeScalarShape(xla::F32);
+  DeallocationRecordingAllocator::Log log;
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient(&log));
+  TF_ASSERT_OK_AND_ASSIGN(auto* device0, client->LookupDevice(0));
+  // f(donate(a), b)
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto executable,
+      ToyExecutable(*client, shape, [](XlaBuilder& builder) {
+        builder.SetUpAlias({0}, 0, {});
+      }));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<PjRtBuffer> a,
+      client->BufferFromHostLiteral(LiteralUtil::CreateR0<float>(1.0f),
+                                    device0));
+
+  ExecuteOptions options;
+  options.untuple_result = true;
+  options.pipelined_launch = true;
+  constexpr int kNumLaunches = 8;
+  std::vector<void*> arguments;
+  std::vector<PjRtFuture<Status>> futures;
+  absl::Mutex mu;
+  std::vector<int> completed;
+  for (int i = 0; i < kNumLaunches; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<PjRtBuffer> b,
+        client->BufferFromHostLiteral(
+            LiteralUtil::CreateR0<float>(static_cast<float>(i)), device0));
+    TF_ASSERT_OK_AND_ASSIGN(std::uintptr_t pointer,
+                            client->UnsafeBufferPointer(b.get()));
+    arguments.push_back(reinterpret_cast<void*>(pointer));
+    std::optional<std::vector<PjRtFuture<Status>>> returned_futures(
+        std::in_place);
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto results,
+        executable->Execute({{a.get(), b.get()}}, options, returned_futures));
+    ASSERT_EQ(results[0].size(), 2);
+    ASSERT_EQ(returned_futures->size(), 1);
+    futures.push_back(returned_futures->front());
+    futures.back().OnReady([&mu, &completed, i](Status status) {
+      TF_EXPECT_OK(status);
+      absl::MutexLock lock(&mu);
+      completed.push_back(i);
+    });
+    a = std::move(results[0][0]);
+    // The launch still holds `b`; it is freed once the computation is done.
+    b.reset();
+  }
+  for (auto& future : futures) {
+    TF_EXPECT_OK(future.Await());
+  }
+  TF_ASSERT_OK_AND_ASSIGN(auto literal, a->ToLiteralSync());
+  // 1 + 0 + 1 + ... + 7.
+  EXPECT_EQ(*literal, LiteralUtil::CreateR0<float>(29.0f));
+
+  a.reset();
+  executable.reset();
+  client.reset();
+  std::vector<void*> released;
+  {
+    absl::MutexLock lock(&log.mu);
+    for (void* opaque : log.deallocated) {
+      if (absl::c_linear_search(arguments, opaque)) {
+        released.push_back(opaque);
+      }
+    }
+  }
+  EXPECT_THAT(released, ::testing::ElementsAreArray(arguments));
+  absl::MutexLock lock(&mu);
+  std::vector<int> expected_completions(kNumLaunches);
+  absl::c_iota(expected_completions, 0);
+  EXPECT_THAT(completed, ::testing::ElementsAreArray(expected_completions));
+}
+
+TEST(PjRtStreamExecutorClientTest, AsyncHostToDeviceTransferInChunks) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  TF_ASSERT_OK_AND_ASSIGN(auto* device0, client->LookupDevice(0));
+  Shape shape = ShapeUtil::MakeShape(F32, {4});
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto transfer_manager,
+      client->CreateBuffersForAsyncHostToDevice({shape}, device0));
+  ASSERT_EQ(transfer_manager->buffer_count(), 1);
+  ASSERT_EQ(transfer_manager->buffer_size(0), 4 * sizeof(float));
+  std::unique_ptr<PjRtBuffer> buffer = transfer_manager->RetrieveBuffer(0);
+
+  std::vector<float> data{1.0f, 2.0f, 3.0f, 4.0f};
+  absl::BlockingCounter done(2);
+  ASSERT_TRUE(transfer_manager
+                  ->TransferRawDataToSubBuffer(
+                      0, data.data(), /*offset=*/0, 2 * sizeof(float),
+                      /*is_last_transfer=*/false,
+                      [&]() { done.DecrementCount(); })
+                  .ok());
+  ASSERT_TRUE(transfer_manager
+                  ->TransferRawDataToSubBuffer(
+                      0, data.data() + 2, /*offset=*/2 * sizeof(float),
+                      2 * sizeof(float), /*is_last_transfer=*/true,
+                      [&]() { done.DecrementCount(); })
+                  .ok());
+  // No transfers after the last one.
+  EXPECT_FALSE(transfer_manager
+                   ->TransferRawDataToSubBuffer(
+                       0, data.data(), /*offset=*/0, sizeof(float),
+                       /*is_last_transfer=*/true, nullptr)
+                   .ok());
+
+  TF_ASSERT_OK_AND_ASSIGN(auto literal, buffer->ToLiteralSync());
+  EXPECT_EQ(*literal, LiteralUtil::CreateR1<float>({1.0f, 2.0f, 3.0f, 4.0f}));
+  done.Wait();
+}
+
 }  // namespace
 }  // namespace xla
@@ -93,6 +93,26 @@ class MarkEventReadyOnExit {
   tfrt::AsyncValueRef<CpuEvent> event_;
 };
 
+// Runs the on-delete callbacks of memory not owned by the runtime that was
+// donated to an execution, once the last result buffer aliasing it is gone.
+class DonatedMemoryReleaser {
+ public:
+  explicit DonatedMemoryReleaser(std::vector<std::function<void()>> callbacks)
+      : callbacks_(std::move(callbacks)) {}
+
+  DonatedMemoryReleaser(const DonatedMemoryReleaser&) = delete;
+  DonatedMemoryReleaser& operator=(const DonatedMemoryReleaser&) = delete;
+
+  ~DonatedMemoryReleaser() {
+    for (auto& callback : callbacks_) {
+      if (callback) callback();
+    }
+  }
+
+ private:
+  std::vector<std::function<void()>> callbacks_;
+};
+
 }  // namespace
 
 static const char kCpuPlatformName[] = "cpu";
@@ -1333,7 +1353,10 @@ Status TfrtCpuExecutable::SetUpDonation(bool tuple_inputs) {
 // and assemble the buffer pointers in order to call into CpuExecutable.
 static StatusOr<std::shared_ptr<MaybeOwningCpuMemory>> MemoryForAllocation(
     const BufferAllocation& allocation,
-    absl::Span<std::pair<bool, TrackedTfrtCpuDeviceBuffer*> const> arguments) {
+    absl::Span<std::pair<bool, TrackedTfrtCpuDeviceBuffer*> const> arguments,
+    const absl::flat_hash_map<BufferAllocation::Index,
+                              std::shared_ptr<MaybeOwningCpuMemory>>&
+        output_memory) {
   if (allocation.is_entry_computation_parameter()) {
     auto [can_donate, arg] = arguments[allocation.parameter_number()];
     std::shared_ptr<MaybeOwningCpuMemory> out =
@@ -1345,7 +1368,11 @@ static StatusOr<std::shared_ptr<MaybeOwningCpuMemory>> MemoryForAllocation(
     // If we don't own the buffer, we can't overwrite it or donate it. For
     // example we might be pointing to a buffer owned by the client whose
     // lifetime will not extend past the lifetime of the donated input buffer.
-    if ((!can_donate || !out->owns_data()) && !allocation.is_readonly()) {
+    // The exception is memory whose release the buffer is told about through
+    // its on-delete callback: that callback is passed on to the results.
+    if ((!can_donate ||
+         (!out->owns_data() && !arg->has_on_delete_callback())) &&
+        !allocation.is_readonly()) {
       TF_ASSIGN_OR_RETURN(
           auto copy, MaybeOwningCpuMemory::AllocateShared(allocation.size()));
       std::memcpy(copy->data(), out->data(), allocation.size());
@@ -1358,6 +1385,12 @@ static StatusOr<std::shared_ptr<MaybeOwningCpuMemory>> MemoryForAllocation(
     return std::make_shared<MaybeOwningCpuMemory>();
   }
 
+  // Output buffer donated by the caller.
+  if (auto it = output_memory.find(allocation.index());
+      it != output_memory.end()) {
+    return it->second;
+  }
+
   // Output and temporary buffer.
   TF_ASSIGN_OR_RETURN(auto out,
                       MaybeOwningCpuMemory::AllocateShared(allocation.size()));
@@ -1373,13 +1406,17 @@ static StatusOr<std::shared_ptr<MaybeOwningCpuMemory>> MemoryForAllocation(
 static StatusOr<std::vector<std::shared_ptr<MaybeOwningCpuMemory>>>
 CreateBufferTable(
     const BufferAssignment& assignment,
-    absl::Span<std::pair<bool, TrackedTfrtCpuDeviceBuffer*> const> arguments) {
+    absl::Span<std::pair<bool, TrackedTfrtCpuDeviceBuffer*> const> arguments,
+    const absl::flat_hash_map<BufferAllocation::Index,
+                              std::shared_ptr<MaybeOwningCpuMemory>>&
+        output_memory) {
   std::vector<std::shared_ptr<MaybeOwningCpuMemory>> buffers(
       assignment.Allocations().size());
   for (BufferAllocation::Index i = 0; i < assignment.Allocations().size();
        ++i) {
     const BufferAllocation& allocation = assignment.GetAllocation(i);
-    TF_ASSIGN_OR_RETURN(buffers[i], MemoryForAllocation(allocation, arguments));
+    TF_ASSIGN_OR_RETURN(buffers[i], MemoryForAllocation(allocation, arguments,
+                                                        output_memory));
   }
   return std::move(buffers);
 }
@@ -1569,12 +1606,119 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
 
   auto* cpu_executable =
       tensorflow::down_cast<cpu::CpuExecutable*>(cpu_executable_.get());
+  const BufferAssignment& buffer_assignment =
+      cpu_executable->buffer_assignment();
+
+  // Donated buffers whose memory is not owned by the runtime. Their on-delete
+  // callbacks are passed on to the results, which may alias that memory.
+  absl::InlinedVector<TrackedTfrtCpuDeviceBuffer*, 4> unowned_donated_buffers;
+
+  // Memory of the output buffers supplied by the caller, by the allocation of
+  // the result leaf it is used for.
+  absl::flat_hash_map<BufferAllocation::Index,
+                      std::shared_ptr<MaybeOwningCpuMemory>>
+      output_memory;
+  if (!options.output_buffers.empty()) {
+    if (options.output_buffers.size() != result_buffer_indices_.size()) {
+      return InvalidArgument(
+          "Execution supplied %d output buffers but the result has %d leaves",
+          options.output_buffers.size(), result_buffer_indices_.size());
+    }
+    for (int i = 0; i < options.output_buffers.size(); ++i) {
+      auto* tfrt_buffer =
+          tensorflow::down_cast<TfrtCpuBuffer*>(options.output_buffers[i]);
+      if (tfrt_buffer == nullptr) continue;
+      if (tfrt_buffer->device() != device) {
+        return InvalidArgument(
+            "Buffer passed to Execute() as output %d to replica %d is on "
+            "device %s, but replica is assigned to device %s.",
+            i, replica, tfrt_buffer->device()->DebugString(),
+            device->DebugString());
+      }
+      if (absl::c_linear_search(argument_handles, tfrt_buffer)) {
+        return InvalidArgument(
+            "Buffer passed to Execute() as output %d is also an argument", i);
+      }
+      const BufferAllocation& allocation =
+          buffer_assignment.GetAllocation(result_buffer_indices_[i]);
+      if (allocation.is_entry_computation_parameter() ||
+          allocation.is_constant() || allocation.is_thread_local() ||
+          output_memory.contains(allocation.index()) ||
+          tfrt_buffer->on_device_shape().IsTuple()) {
+        VLOG(2) << "Not writing result leaf " << i << " into its output buffer";
+        continue;
+      }
+      StatusOr<TfrtCpuBuffer::DonationTransaction> donation_transaction =
+          tfrt_buffer->AcquireDonation();
+      if (!donation_transaction.ok()) {
+        return InvalidArgument("Output buffer %d can't be donated: %s", i,
+                               donation_transaction.status().error_message());
+      }
+      TrackedTfrtCpuDeviceBuffer* tracked_buffer =
+          donation_transaction->device_buffer();
+      std::shared_ptr<MaybeOwningCpuMemory> memory =
+          tracked_buffer->Buffers()[0];
+      // XLA:CPU may generate code that requires aligned buffers. Aborting the
+      // donation transaction leaves the output buffer as it was.
+      if (memory->size() != allocation.size() ||
+          (absl::bit_cast<std::uintptr_t>(memory->data()) &
+           (cpu_function_runtime::MinAlign() - 1)) != 0) {
+        VLOG(2) << "Not writing result leaf " << i
+                << " into its output buffer of size " << memory->size();
+        continue;
+      }
+      // The results are written only once the earlier reads and writes of the
+      // output buffer are done.
+      const auto& definition_event = tracked_buffer->definition_event();
+      if (!definition_event.IsAvailable()) {
+        input_deps.push_back(definition_event.CopyRCRef());
+      }
+      for (const auto& ev : tracked_buffer->UsageEvents()) {
+        if (!ev.IsAvailable()) {
+          input_deps.push_back(ev.CopyRCRef());
+        }
+      }
+      if (!memory->owns_data()) {
+        unowned_donated_buffers.push_back(tracked_buffer);
+      }
+      output_memory[allocation.index()] = std::move(memory);
+      donation_transactions.push_back(std::move(*donation_transaction));
+    }
+  }
+
   TF_ASSIGN_OR_RETURN(
       std::vector<std::shared_ptr<MaybeOwningCpuMemory>> buffer_table,
-      CreateBufferTable(cpu_executable->buffer_assignment(), tracked_buffers));
+      CreateBufferTable(buffer_assignment, tracked_buffers, output_memory));
   auto result_buffers =
       CreateResultShapedBuffer(result_buffer_indices_, buffer_table);
 
+  // Donated arguments not owned by the runtime whose memory is used in place.
+  for (const auto& [can_donate, tracked_buffer] : tracked_buffers) {
+    if (!can_donate) continue;
+    for (const auto& memory : tracked_buffer->Buffers()) {
+      if (!memory->owns_data() &&
+          absl::c_linear_search(buffer_table, memory)) {
+        unowned_donated_buffers.push_back(tracked_buffer);
+        break;
+      }
+    }
+  }
+
+  // Takes over the on-delete callbacks of `unowned_donated_buffers`, so that
+  // they run once all result buffers are deleted rather than when the donated
+  // buffers are. Called once nothing can fail before the donations commit.
+  std::shared_ptr<DonatedMemoryReleaser> donated_memory_releaser;
+  auto take_over_donated_memory = [&] {
+    if (unowned_donated_buffers.empty()) return;
+    std::vector<std::function<void()>> callbacks;
+    callbacks.reserve(unowned_donated_buffers.size());
+    for (TrackedTfrtCpuDeviceBuffer* buffer : unowned_donated_buffers) {
+      callbacks.push_back(buffer->ReleaseOnDeleteCallback());
+    }
+    donated_memory_releaser =
+        std::make_shared<DonatedMemoryReleaser>(std::move(callbacks));
+  };
+
   // The choice of where we wait is arbitrary; the reason for the wait is
   // pacing to avoid problems such as memory fragmentation and running ahead
   // too far, not for correctness. Placing it before the executable launch
@@ -1635,6 +1779,7 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
                                          nullptr);
     }
 
+    take_over_donated_memory();
     for (auto& donation_transaction : donation_transactions) {
       std::move(donation_transaction).Commit();
     }
@@ -1658,6 +1803,7 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
     }
     std::vector<tfrt::RCReference<tfrt::AsyncValue>> input_deps_avs_copy =
         CopyAsyncValues(input_deps);
+    take_over_donated_memory();
     EnqueueWorkWhenReady(
         client()->pjrt_client_thread_pool(), input_deps,
         [cpu_executable, result_buffer,
@@ -1718,6 +1864,10 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
   }
 
   // Create output TFRT buffers.
+  auto on_delete_callback = [&]() -> std::function<void()> {
+    if (donated_memory_releaser == nullptr) return nullptr;
+    return [releaser = donated_memory_releaser]() {};
+  };
   const Shape& result_shape = cpu_executable_->result_shape();
   std::vector<std::unique_ptr<PjRtBuffer>> res;
   if (options.untuple_result && result_shape.IsTuple()) {
@@ -1731,7 +1881,7 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
       auto leaf_tracked_device_buffer =
           std::make_unique<TrackedTfrtCpuDeviceBuffer>(
               /*is_tuple=*/false, std::move(sub_buffer),
-              std::move(definition_events));
+              std::move(definition_events), on_delete_callback());
       auto leaf_buffer = std::make_unique<TfrtCpuBuffer>(
           result_shape.tuple_shapes(i), std::move(leaf_tracked_device_buffer),
           client_, device);
@@ -1741,7 +1891,7 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
     // Program execution writes to output buffers so it's a definition event.
     auto tracked_device_buffer = std::make_unique<TrackedTfrtCpuDeviceBuffer>(
         /*is_tuple=*/result_shape.IsTuple(), std::move(result_buffers),
-        /*definition_event=*/execute_event);
+        /*definition_event=*/execute_event, on_delete_callback());
     auto tfrt_output_buffer = std::make_unique<TfrtCpuBuffer>(
         result_shape, std::move(tracked_device_buffer), client_, device);
     res.push_back(std::move(tfrt_output_buffer));
@@ -1820,6 +1970,12 @@ TfrtCpuExecutable::Execute(
         argument_handles.size(), num_addressable_devices, num_replicas(),
         num_partitions());
   }
+  if (!options.output_buffers.empty() && num_addressable_devices != 1) {
+    return InvalidArgument(
+        "Output buffers may only be supplied when executing on a single "
+        "device, but the computation runs on %d local devices",
+        num_addressable_devices);
+  }
 
   VLOG(1) << "Executing computation " << name()
           << "; num_replicas=" << num_replicas()
@@ -143,5 +143,64 @@ TEST(TfrtCpuClientTest, HloSnapshot) {
       LiteralUtil::CreateR2<float>({{11.0, 22.0}, {33.0, 44.0}, {55.0, 66.0}}));
 }
 
+TEST(TfrtCpuClientTest, ExecuteIntoOutputBuffers) {
+  constexpr char kProgram[] = R"(
+    HloModule add
+    ENTRY add {
+      x = f32[3,2] parameter(0)
+      y = f32[3,2] parameter(1)
+      ROOT add = f32[3,2] add(x, y)
+    })";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetTfrtCpuClient(/*asynchronous=*/true));
+  TF_ASSERT_OK_AND_ASSIGN(auto hlo_module,
+                          ParseAndReturnUnverifiedModule(kProgram, {}));
+  XlaComputation xla_computation(hlo_module->ToProto());
+  TF_ASSERT_OK_AND_ASSIGN(auto pjrt_executable,
+                          client->Compile(xla_computation, {}));
+
+  Shape shape = ShapeUtil::MakeShape(F32, {3, 2});
+  std::vector<float> data{1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+  alignas(64) float output[6] = {};
+  bool output_released = false;
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto buffer,
+      client->BufferFromHostBuffer(
+          data.data(), shape.element_type(), shape.dimensions(),
+          /*byte_strides=*/std::nullopt,
+          PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall, nullptr,
+          client->addressable_devices()[0]));
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto output_buffer,
+      client->BufferFromHostBuffer(
+          output, shape.element_type(), shape.dimensions(),
+          /*byte_strides=*/std::nullopt,
+          PjRtClient::HostBufferSemantics::kZeroCopy,
+          [&]() { output_released = true; }, client->addressable_devices()[0]));
+
+  PjRtBuffer* output_buffers[] = {output_buffer.get()};
+  ExecuteOptions options;
+  options.execution_mode = ExecuteOptions::ExecutionMode::kSynchronous;
+  options.output_buffers = output_buffers;
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto result,
+      pjrt_executable->Execute(
+          /*argument_handles=*/{{buffer.get(), buffer.get()}}, options));
+  ASSERT_EQ(result.size(), 1);
+  ASSERT_EQ(result[0].size(), 1);
+  TF_ASSERT_OK_AND_ASSIGN(auto literal, result[0][0]->ToLiteralSync());
+
+  EXPECT_TRUE(output_buffer->IsDeleted());
+  EXPECT_EQ(*literal, LiteralUtil::CreateR2<float>(
+                          {{2.0, 4.0}, {6.0, 8.0}, {10.0, 12.0}}));
+  EXPECT_EQ(std::vector<float>(output, output + 6),
+            std::vector<float>({2.0, 4.0, 6.0, 8.0, 10.0, 12.0}));
+
+  output_buffer.reset();
+  EXPECT_FALSE(output_released);
+  result.clear();
+  EXPECT_TRUE(output_released);
+}
+
 }  // namespace
 }  // namespace xla
@@ -130,6 +130,15 @@ class TrackedTfrtCpuDeviceBuffer {
   // buffer is passed to a computation that aliases its inputs to outputs.
   void ReleaseDeviceMemory();
 
+  bool has_on_delete_callback() const { return on_delete_callback_ != nullptr; }
+
+  // Returns the callback to call when the buffer is destroyed, which this
+  // buffer then won't call. Used to extend the lifetime of memory the buffer
+  // does not own to the buffers it is donated to.
+  std::function<void()> ReleaseOnDeleteCallback() {
+    return std::exchange(on_delete_callback_, nullptr);
+  }
+
  private:
   bool is_tuple_;
   // If tuple, tuple index table is created and stored.
@@ -121,6 +121,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
 #include "tensorflow/compiler/xla/service/cpu/hlo_xla_runtime_pipeline.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emitter.h"
+#include "tensorflow/compiler/xla/service/cpu/onednn_rewriter.h"
 #include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime/collectives.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime/custom_call.h"
@@ -187,8 +188,11 @@ limitations under the License.
 #include "tensorflow/compiler/xla/translate/hlo_to_mhlo/hlo_to_mlir_hlo.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/tsl/platform/blocking_counter.h"
+#include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 
 namespace {
 
@@ -762,7 +766,8 @@ Status CpuCompiler::RunHloPassesThroughLayoutAssn(
 
 Status CpuCompiler::RunHloPassesAfterLayoutAssn(
     HloModule* module, bool is_aot_compile,
-    LLVMTargetMachineFeatures* target_machine_features, bool is_mlir_compile) {
+    LLVMTargetMachineFeatures* target_machine_features, bool is_mlir_compile,
+    int aot_max_parallelism) {
   {
     HloPassPipeline pipeline("hlo normalization");
     pipeline.AddPass<ReshapeDecomposer>();
@@ -788,6 +793,17 @@ Status CpuCompiler::RunHloPassesAfterLayoutAssn(
 
   pipeline.AddPass<ReshapeDecomposer>();
 
+#if defined(XLA_CPU_USE_ONEDNN)
+  // Fuse dots and convolutions with their bias and activation into oneDNN
+  // primitives. This needs the final layouts and has to run before fusion
+  // absorbs the epilogue into loop fusions.
+  const DebugOptions& debug_options = module->config().debug_options();
+  if (debug_options.xla_cpu_use_mkl_dnn() &&
+      debug_options.xla_cpu_multi_thread_eigen()) {
+    pipeline.AddPass<OneDnnRewriter>(target_machine_features);
+  }
+#endif  // XLA_CPU_USE_ONEDNN
+
   // Add a fusion pass now that layout assignment is done.
   pipeline.AddPass<CpuInstructionFusion>();
 
@@ -815,16 +831,20 @@ Status CpuCompiler::RunHloPassesAfterLayoutAssn(
   }();
 
   // Outline ops in the entry computation into calls to subcomputations.
-  const int max_parallelism =
-      module->config().intra_op_parallelism_threads() > 0
-          ? module->config().intra_op_parallelism_threads()
-          : tsl::port::NumSchedulableCPUs();
+  //
+  // For AOT this is only done when explicitly requested, because it brings in
+  // thread pool and thread synchronization dependencies which would likely
+  // increase binary size (and most AOT applications are single-threaded). The
+  // number of partitions can't depend on the build host, so AOT compiles use
+  // the requested parallelism instead of the number of CPUs.
+  int max_parallelism = aot_max_parallelism;
   if (!is_aot_compile) {
+    max_parallelism = module->config().intra_op_parallelism_threads() > 0
+                          ? module->config().intra_op_parallelism_threads()
+                          : tsl::port::NumSchedulableCPUs();
+  }
+  if (!is_aot_compile || max_parallelism > 1) {
     // Run ParallelTaskAssigner to assign parallel tasks to HLOs in module.
-    // Note this is not run for AOT because it would bring in thread pool
-    // and thread synchronization dependencies which would likely increase
-    // binary size (and most AOT applications are single-threaded).
-    // TODO(b/29630486) Support multi-threaded AOT.
     pipeline.AddPass<ParallelTaskAssigner>(
         max_parallelism, ShapeSizeBytesFunction(), target_machine_features);
   }
@@ -842,13 +862,15 @@ Status CpuCompiler::RunHloPassesAfterLayoutAssn(
 
 Status CpuCompiler::RunHloPasses(HloModule* module, bool is_aot_compile,
                                  llvm::TargetMachine* target_machine,
-                                 bool is_mlir_compile) {
+                                 bool is_mlir_compile,
+                                 int aot_max_parallelism) {
   LLVMTargetMachineFeatures target_machine_features(target_machine);
   TF_RETURN_IF_ERROR(RunHloPassesThroughLayoutAssn(
       module, is_aot_compile, &target_machine_features, is_mlir_compile));
 
   return RunHloPassesAfterLayoutAssn(module, is_aot_compile,
-                                     &target_machine_features, is_mlir_compile);
+                                     &target_machine_features, is_mlir_compile,
+                                     aot_max_parallelism);
 }
 
 namespace {
@@ -884,7 +906,8 @@ llvm::CodeGenOpt::Level CodeGenOptLevel(const HloModuleConfig& module_config) {
 std::pair<LLVMCompiler::ModuleHook, LLVMCompiler::ModuleHook> GetIRModuleHooks(
     const HloModule& hlo_module,
     const LLVMCompiler::ModuleHook& user_pre_optimization_hook,
-    const LLVMCompiler::ModuleHook& user_post_optimization_hook) {
+    const LLVMCompiler::ModuleHook& user_post_optimization_hook,
+    absl::string_view filename_suffix = "") {
   // Create the IR hooks. If applicable, each IR hook does the following:
   //
   //  * Calls the user supplied module hook.
@@ -892,14 +915,14 @@ std::pair<LLVMCompiler::ModuleHook, LLVMCompiler::ModuleHook> GetIRModuleHooks(
   //    --xla_dump_to
   const HloModule* hlo_module_ptr = &hlo_module;
   auto hook = [user_pre_optimization_hook, user_post_optimization_hook,
-               hlo_module_ptr](bool optimized,
-                               const llvm::Module& llvm_module) {
+               hlo_module_ptr, suffix = std::string(filename_suffix)](
+                  bool optimized, const llvm::Module& llvm_module) {
     const auto& user_hook =
         !optimized ? user_pre_optimization_hook : user_post_optimization_hook;
     if (user_hook) {
       user_hook(llvm_module);
     }
-    llvm_ir::DumpIrIfEnabled(*hlo_module_ptr, llvm_module, optimized);
+    llvm_ir::DumpIrIfEnabled(*hlo_module_ptr, llvm_module, optimized, suffix);
   };
   return {[hook](const llvm::Module& llvm_module) {
             return hook(/*optimized=*/false, llvm_module);
@@ -1006,10 +1029,11 @@ namespace {
 struct OrcJITPostCompilationHook {
   // Gets an std::function that implements this hook.
   static std::function<void(const llvm::object::ObjectFile& obj_file)> Create(
-      const HloModule* module) {
+      const HloModule* module, std::string file_suffix = "o") {
     // This struct is not copyable, but std::functions must be.  So to create an
     // std::function out of this struct, we have to wrap it in a shared_ptr.
-    auto wrapped = std::make_shared<OrcJITPostCompilationHook>(module);
+    auto wrapped = std::make_shared<OrcJITPostCompilationHook>(
+        module, std::move(file_suffix));
     return [wrapped](const llvm::object::ObjectFile& obj_file) {
       (*wrapped)(obj_file);
     };
@@ -1017,22 +1041,98 @@ struct OrcJITPostCompilationHook {
 
   // Constructor can't be private because we want to call it from
   // std::make_shared, but users should call Create() instead.
-  explicit OrcJITPostCompilationHook(const HloModule* module)
-      : module(module) {}
+  OrcJITPostCompilationHook(const HloModule* module, std::string file_suffix)
+      : module(module), file_suffix(std::move(file_suffix)) {}
 
  private:
   void operator()(const llvm::object::ObjectFile& obj_file) {
     if (!DumpingEnabledForHloModule(*module)) {
       return;
     }
-    DumpToFileInDir(*module, /*file_prefix=*/"", /*file_suffix=*/"o",
+    DumpToFileInDir(*module, /*file_prefix=*/"", file_suffix,
                     absl::string_view(obj_file.getData().data(),
                                       obj_file.getData().size()));
   }
 
   const HloModule* module;
+  const std::string file_suffix;
 };
 
+// Splits `llvm_module` into up to `parallelism` parts, optimizes and compiles
+// the parts to object files concurrently and adds them to `jit`, which links
+// them together. Every part gets its own LLVMContext and TargetMachine, since
+// neither is thread-safe.
+Status CompileModuleInParallel(
+    const HloModule& hlo_module, llvm::Module& llvm_module, int parallelism,
+    const LLVMCompiler::ModuleHook& user_pre_optimization_hook,
+    const LLVMCompiler::ModuleHook& user_post_optimization_hook,
+    SimpleOrcJIT* jit) {
+  XLA_SCOPED_LOGGING_TIMER("CpuCompiler - Compiling LLVM module in parallel");
+  // Subcomputations have internal linkage and are called from the entry
+  // computation, so they have to be externalized to spread them across parts.
+  std::vector<std::string> partitions =
+      llvm_ir::SplitModuleForParallelCompilation(llvm_module, parallelism,
+                                                 /*preserve_locals=*/false);
+  VLOG(1) << "Compiling " << hlo_module.name() << " as " << partitions.size()
+          << " LLVM modules in parallel";
+
+  const HloModuleConfig& config = hlo_module.config();
+  auto compile_partition =
+      [&](int i) -> StatusOr<std::unique_ptr<llvm::MemoryBuffer>> {
+    llvm::LLVMContext context;
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<llvm::Module> partition,
+                        llvm_ir::ParseModuleInContext(partitions[i], context));
+    std::unique_ptr<llvm::TargetMachine> target_machine =
+        SimpleOrcJIT::InferTargetMachineForJIT(CompilerTargetOptions(config),
+                                               CodeGenOptLevel(config));
+    const std::string suffix = absl::StrCat("part", i);
+    auto [pre_optimization_hook, post_optimization_hook] =
+        GetIRModuleHooks(hlo_module, user_pre_optimization_hook,
+                         user_post_optimization_hook, suffix);
+    CompilerFunctor compiler_functor(
+        target_machine.get(), CodeGenOptLevel(config),
+        options::OptimizeForSizeRequested(config),
+        config.debug_options().xla_llvm_disable_expensive_passes(),
+        llvm_ir::GetCpuFastMathFlags(config), pre_optimization_hook,
+        post_optimization_hook,
+        OrcJITPostCompilationHook::Create(&hlo_module,
+                                          absl::StrCat(suffix, ".o")));
+    llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> obj_file =
+        compiler_functor(*partition);
+    if (!obj_file) {
+      return InternalError("Compiling LLVM module part %d failed: %s", i,
+                           llvm::toString(obj_file.takeError()));
+    }
+    return std::move(*obj_file);
+  };
+
+  std::vector<StatusOr<std::unique_ptr<llvm::MemoryBuffer>>> obj_files(
+      partitions.size());
+  {
+    tsl::thread::ThreadPool thread_pool(tsl::Env::Default(),
+                                        "xla_cpu_llvm_compilation",
+                                        std::min<int>(parallelism,
+                                                      partitions.size()));
+    tsl::BlockingCounter counter(partitions.size());
+    for (int i = 0; i < partitions.size(); ++i) {
+      thread_pool.Schedule([&, i] {
+        obj_files[i] = compile_partition(i);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+
+  for (auto& obj_file : obj_files) {
+    TF_RETURN_IF_ERROR(obj_file.status());
+    if (llvm::Error err = jit->AddObjFile(std::move(*obj_file))) {
+      return InternalError("Adding object file to the JIT failed: %s",
+                           llvm::toString(std::move(err)));
+    }
+  }
+  return OkStatus();
+}
+
 void InitializeLLVMCommandLineOptions(const HloModuleConfig& config) {
   llvm_ir::InitializeLLVMCommandLineOptions(
       config.debug_options().xla_backend_extra_options());
@@ -1339,9 +1439,17 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
   TF_RETURN_IF_ERROR(VerifyLlvmModule(*llvm_module));
 
   // JIT compile the LLVM IR module to in-memory machine code.
-  llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
-                                                 std::move(llvm_context));
-  cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  const int compilation_parallelism =
+      module->config().debug_options().xla_cpu_force_compilation_parallelism();
+  if (compilation_parallelism > 1) {
+    TF_RETURN_IF_ERROR(CompileModuleInParallel(
+        *module, *llvm_module, compilation_parallelism,
+        user_pre_optimization_hook_, user_post_optimization_hook_, jit->get()));
+  } else {
+    llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
+                                                   std::move(llvm_context));
+    cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  }
 
   auto cpu_executable = std::make_unique<CpuExecutable>(
       std::move(*jit), std::move(assignment), std::move(module), function_name,
@@ -1583,7 +1691,8 @@ CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
 
     TF_RETURN_IF_ERROR(
         RunHloPasses(module, /*is_aot_compile=*/true, target_machine.get(),
-                     /*is_mlir_compile=*/options.use_mlir_hlo_lowering()));
+                     /*is_mlir_compile=*/options.use_mlir_hlo_lowering(),
+                     /*aot_max_parallelism=*/options.max_parallelism()));
 
     TF_ASSIGN_OR_RETURN(HloSchedule schedule,
                         ScheduleModule(module, BufferSizeBytesFunction()));
@@ -78,6 +78,12 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   bool use_mlir_hlo_lowering() const { return use_mlir_hlo_lowering_; }
   void set_use_mlir_hlo_lowering(bool value) { use_mlir_hlo_lowering_ = value; }
 
+  // The maximum number of partitions parallel loops are split into. The
+  // partitions run on the intra-op thread pool supplied at run time. Values
+  // <= 1 produce single-threaded code.
+  int max_parallelism() const { return max_parallelism_; }
+  void set_max_parallelism(int value) { max_parallelism_ = value; }
+
  private:
   const std::string triple_;
   const std::string cpu_name_;
@@ -85,6 +91,7 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   const std::string entry_point_name_;
   const RelocationModel relocation_model_;
   bool use_mlir_hlo_lowering_ = false;
+  int max_parallelism_ = 0;
 };
 
 class CpuXlaRuntimeAotCompilationResult : public AotCompilationResult {
@@ -210,9 +217,12 @@ class CpuCompiler : public LLVMCompiler {
 
   // Runs the HLO passes which are necessary for both optimizations and
   // correctness.
+  // `aot_max_parallelism` only applies to AOT compiles, see
+  // CpuAotCompilationOptions::max_parallelism().
   Status RunHloPasses(HloModule* module, bool is_aot_compile,
                       llvm::TargetMachine* target_machine,
-                      bool is_mlir_compile = false);
+                      bool is_mlir_compile = false,
+                      int aot_max_parallelism = 0);
 
   // Runs HLO passes up to and including layout assignment.
   Status RunHloPassesThroughLayoutAssn(
@@ -223,7 +233,8 @@ class CpuCompiler : public LLVMCompiler {
   // Runs HLO passes after layout assignment.
   Status RunHloPassesAfterLayoutAssn(
       HloModule* module, bool is_aot_compile,
-      LLVMTargetMachineFeatures* target_machine_features, bool is_mlir_compile);
+      LLVMTargetMachineFeatures* target_machine_features, bool is_mlir_compile,
+      int aot_max_parallelism);
 
   StatusOr<std::unique_ptr<CpuExecutable>> CompileLegacyCpuExecutable(
       std::unique_ptr<HloModule> module);
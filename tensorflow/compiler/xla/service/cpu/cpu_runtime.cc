@@ -96,6 +96,10 @@ extern const char* const kMKLSingleThreadedMatMulF32SymbolName =
     "__xla_cpu_runtime_MKLSingleThreadedMatMulF32";
 extern const char* const kMKLSingleThreadedMatMulF64SymbolName =
     "__xla_cpu_runtime_MKLSingleThreadedMatMulF64";
+extern const char* const kOneDnnMatMulF32SymbolName =
+    "__xla_cpu_runtime_OneDnnMatMulF32";
+extern const char* const kOneDnnConv2DF32SymbolName =
+    "__xla_cpu_runtime_OneDnnConv2DF32";
 extern const char* const kEigenConv2DF16SymbolName =
     "__xla_cpu_runtime_EigenConv2DF16";
 extern const char* const kEigenConv2DF32SymbolName =
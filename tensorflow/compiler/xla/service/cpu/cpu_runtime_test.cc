@@ -15,9 +15,11 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <tuple>
+#include <vector>
 
 #include "absl/strings/str_format.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -27,12 +29,15 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/runtime_matmul.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_matmul_acl.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_matmul_mkl.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_onednn.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_single_threaded_matmul.h"
 #include "tensorflow/compiler/xla/service/custom_call_status_internal.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/tsl/platform/cpu_info.h"
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/logging.h"
 #include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/platform/test_benchmark.h"
 
 namespace xla {
 namespace {
@@ -239,6 +244,129 @@ INSTANTIATE_TEST_CASE_P(MKLMatMulTestInstantiaion, MKLMatMulTest,
                         MKLMatMulTest::Name);
 #endif  // ENABLE_MKL
 
+// This takes 3 parameters:
+// * shape of the matmul
+// * transpose_lhs
+// * transpose_rhs
+using OneDnnMatMulTestParam = std::tuple<MatMulShape, bool, bool>;
+
+class OneDnnMatMulTest
+    : public CpuRuntimeTest,
+      public ::testing::WithParamInterface<OneDnnMatMulTestParam> {
+ public:
+  static std::string Name(
+      const ::testing::TestParamInfo<OneDnnMatMulTestParam>& info) {
+    MatMulShape shape = std::get<0>(info.param);
+    bool transpose_lhs = std::get<1>(info.param);
+    bool transpose_rhs = std::get<2>(info.param);
+
+    return absl::StrFormat("OneDnnMatMul_%d_%d_%d%s%s", shape.m, shape.k,
+                           shape.n, transpose_lhs ? "_Tlhs" : "",
+                           transpose_rhs ? "_Trhs" : "");
+  }
+};
+
+// Activation values of xla::cpu::OneDnnFusionConfig.
+constexpr int32_t kOneDnnRelu = 1;
+
+TEST_P(OneDnnMatMulTest, BiasRelu) {
+  MatMulShape shape = std::get<0>(GetParam());
+  bool transpose_lhs = std::get<1>(GetParam());
+  bool transpose_rhs = std::get<2>(GetParam());
+
+  auto a = MakeLinspaceArray2D(0.0, 1.0, shape.m, shape.k);
+  auto b = MakeLinspaceArray2D(-2.0, 2.0, shape.k, shape.n);
+  std::vector<float> bias(shape.n);
+  for (int64_t j = 0; j < shape.n; ++j) {
+    bias[j] = 0.5f - j % 3;
+  }
+  // The oneDNN runtime is row-major, so transposing an operand just means
+  // storing it transposed.
+  auto a_data = MaybeTransposeArray2D(*a, transpose_lhs);
+  auto b_data = MaybeTransposeArray2D(*b, transpose_rhs);
+  Array2D<float> c(shape.m, shape.n);
+
+  tsl::thread::ThreadPool pool(tsl::Env::Default(), "XLAEigen", 2);
+  Eigen::ThreadPoolDevice device(pool.AsEigenThreadPool(), pool.NumThreads());
+  ExecutableRunOptions run_options;
+  run_options.set_intra_op_thread_pool(&device);
+  __xla_cpu_runtime_OneDnnMatMulF32(&run_options, c.data(), a_data->data(),
+                                    b_data->data(), bias.data(), shape.m,
+                                    shape.n, shape.k, transpose_lhs,
+                                    transpose_rhs, kOneDnnRelu);
+
+  for (int i = 0; i < shape.m; ++i) {
+    for (int j = 0; j < shape.n; ++j) {
+      float sum = bias[j];
+      for (int k = 0; k < shape.k; ++k) {
+        sum += (*a)(i, k) * (*b)(k, j);
+      }
+      EXPECT_NEAR(std::max(sum, 0.0f), c(i, j), 0.01);
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(OneDnnMatMulTestInstantiaion, OneDnnMatMulTest,
+                         ::testing::Combine(::testing::ValuesIn(MatMulShapes),
+                                            ::testing::Bool(),
+                                            ::testing::Bool()),
+                         OneDnnMatMulTest::Name);
+
+// Compares the fused oneDNN matmul + bias + relu against the Eigen matmul
+// followed by a separate bias + relu pass, which is what XLA:CPU emits for the
+// same HLO without OneDnnRewriter. Args are m, k, n.
+void BM_EigenMatMulBiasRelu(::testing::benchmark::State& state) {
+  const int64_t m = state.range(0), k = state.range(1), n = state.range(2);
+  std::vector<float> lhs(m * k, 1.0f), rhs(k * n, 0.5f), bias(n, -1.0f);
+  std::vector<float> out(m * n);
+  tsl::thread::ThreadPool pool(tsl::Env::Default(), "XLAEigen",
+                               tsl::port::MaxParallelism());
+  Eigen::ThreadPoolDevice device(pool.AsEigenThreadPool(), pool.NumThreads());
+  ExecutableRunOptions run_options;
+  run_options.set_intra_op_thread_pool(&device);
+  for (auto s : state) {
+    // Row-major out = lhs * rhs is column-major out^T = rhs^T * lhs^T.
+    __xla_cpu_runtime_EigenMatMulF32(&run_options, out.data(), rhs.data(),
+                                     lhs.data(), n, m, k,
+                                     /*transpose_lhs=*/0, /*transpose_rhs=*/0);
+    for (int64_t i = 0; i < m; ++i) {
+      for (int64_t j = 0; j < n; ++j) {
+        out[i * n + j] = std::max(out[i * n + j] + bias[j], 0.0f);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * m * n * k);
+}
+
+void BM_OneDnnMatMulBiasRelu(::testing::benchmark::State& state) {
+  const int64_t m = state.range(0), k = state.range(1), n = state.range(2);
+  std::vector<float> lhs(m * k, 1.0f), rhs(k * n, 0.5f), bias(n, -1.0f);
+  std::vector<float> out(m * n);
+  tsl::thread::ThreadPool pool(tsl::Env::Default(), "XLAEigen",
+                               tsl::port::MaxParallelism());
+  Eigen::ThreadPoolDevice device(pool.AsEigenThreadPool(), pool.NumThreads());
+  ExecutableRunOptions run_options;
+  run_options.set_intra_op_thread_pool(&device);
+  for (auto s : state) {
+    __xla_cpu_runtime_OneDnnMatMulF32(&run_options, out.data(), lhs.data(),
+                                      rhs.data(), bias.data(), m, n, k,
+                                      /*transpose_lhs=*/0,
+                                      /*transpose_rhs=*/0, kOneDnnRelu);
+  }
+  state.SetItemsProcessed(state.iterations() * m * n * k);
+}
+
+#define BENCHMARK_MATMUL_BIAS_RELU(fn) \
+  BENCHMARK(fn)                        \
+      ->Args({1, 1024, 1024})          \
+      ->Args({32, 1024, 1024})         \
+      ->Args({256, 512, 1024})         \
+      ->Args({1024, 1024, 1024})       \
+      ->UseRealTime()
+
+BENCHMARK_MATMUL_BIAS_RELU(BM_EigenMatMulBiasRelu);
+BENCHMARK_MATMUL_BIAS_RELU(BM_OneDnnMatMulBiasRelu);
+
 TEST_F(CpuRuntimeTest, SuccessStatus) {
   XlaCustomCallStatus success_status;
   // Success is the default state.
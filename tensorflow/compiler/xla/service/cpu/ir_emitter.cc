@@ -62,6 +62,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/elemental_ir_emitter.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_function.h"
+#include "tensorflow/compiler/xla/service/cpu/onednn_rewriter.h"
 #include "tensorflow/compiler/xla/service/cpu/parallel_loop_emitter.h"
 #include "tensorflow/compiler/xla/service/elemental_ir_emitter.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/buffer_assignment_util.h"
@@ -2098,11 +2099,45 @@ Status IrEmitter::HandleDynamicUpdateSlice(
     auto operands = GetIrArraysForOperandsOf(dynamic_update_slice);
     return llvm_ir::EmitDynamicUpdateSliceInPlace(
         operands, GetIrArrayFor(dynamic_update_slice),
-        IrName(dynamic_update_slice, "in_place"), &b_);
+        IrName(dynamic_update_slice, "in_place"),
+        GetInPlaceDynamicUpdateSliceLoopEmitter(*dynamic_update_slice), &b_);
   }
   return DefaultAction(dynamic_update_slice);
 }
 
+llvm_ir::UpdateLoopEmitter IrEmitter::GetInPlaceDynamicUpdateSliceLoopEmitter(
+    const HloInstruction& op) {
+  const bool emit_parallel_loop = ShouldEmitParallelLoopFor(op);
+  return [this, emit_parallel_loop](const llvm_ir::BodyEmitter& body_emitter,
+                                    const Shape& update_shape,
+                                    absl::string_view name) -> Status {
+    if (!emit_parallel_loop) {
+      return llvm_ir::LoopEmitter(body_emitter, update_shape, &b_)
+          .EmitLoop(name);
+    }
+    // Each parallel task writes its own partition of the update, see
+    // GetParallelLoopShape.
+    std::vector<std::pair<llvm::Value*, llvm::Value*>> dynamic_loop_bounds =
+        compute_function_->GetDynamicLoopBounds();
+    return ParallelLoopEmitter(body_emitter, update_shape,
+                               &dynamic_loop_bounds, &b_)
+        .EmitLoop(name);
+  };
+}
+
+Shape IrEmitter::GetParallelLoopShape(HloInstruction* root) {
+  const bool is_in_place_dynamic_update_slice =
+      root->opcode() == HloOpcode::kDynamicUpdateSlice
+          ? !ShapeUtil::IsScalar(root->shape()) &&
+                llvm_ir::CanUpdateDynamicSliceInPlace(root, assignment_)
+          : root->opcode() == HloOpcode::kFusion &&
+                llvm_ir::CanEmitFusedDynamicUpdateSliceInPlace(root,
+                                                               assignment_);
+  return is_in_place_dynamic_update_slice
+             ? llvm_ir::GetInPlaceDynamicUpdateSliceLoopShape(root)
+             : root->shape();
+}
+
 Status IrEmitter::HandleRecv(HloInstruction* recv) {
   // TODO(b/33942983): Support Send/Recv on CPU.
   return Unimplemented("Recv is not implemented on CPU.");
@@ -2183,7 +2218,8 @@ Status IrEmitter::HandleFusion(HloInstruction* fusion) {
     TF_RETURN_IF_ERROR(EmitTargetAddressForOp(fusion));
     // Delegate to common implementation of fused in-place dynamic-update-slice.
     return llvm_ir::EmitFusedDynamicUpdateSliceInPlace(
-        fusion, GetIrArrayFor(fusion), &fused_emitter, &b_);
+        fusion, GetIrArrayFor(fusion), &fused_emitter,
+        GetInPlaceDynamicUpdateSliceLoopEmitter(*fusion), &b_);
   } else if (fusion->IsLoopFusion()) {
     VLOG(3) << "HandleFusion kLoop";
     CpuElementalIrEmitter elemental_emitter(hlo_module_config_, this, module_);
@@ -2258,7 +2294,7 @@ Status IrEmitter::HandleCall(HloInstruction* call) {
     // each call such that it only generates one partition of the output.
     HloInstruction* root = computation->root_instruction();
     TF_RETURN_IF_ERROR(EmitCallToParallelForkJoin(
-        call_args, root->shape(),
+        call_args, GetParallelLoopShape(root),
         backend_config_or->outer_dimension_partitions(), &b_, call_ir_function,
         computation->name()));
 
@@ -2428,6 +2464,100 @@ Status IrEmitter::HandleTopK(HloInstruction* hlo) {
   return OkStatus();
 }
 
+Status IrEmitter::HandleOneDnnMatMul(HloInstruction* hlo) {
+  TF_ASSIGN_OR_RETURN(const BackendConfig backend_config,
+                      hlo->backend_config<BackendConfig>());
+  const OneDnnFusionConfig& config = backend_config.onednn_fusion_config();
+  const HloInstruction* lhs = hlo->operand(0);
+  const HloInstruction* rhs = hlo->operand(1);
+  TF_RET_CHECK(hlo->operand_count() == (config.has_bias() ? 3 : 2));
+  TF_RET_CHECK(hlo->shape().element_type() == F32);
+  TF_RET_CHECK(LayoutUtil::IsMonotonicWithDim0Major(hlo->shape().layout()));
+  TF_RET_CHECK(LayoutUtil::IsMonotonicWithDim0Major(lhs->shape().layout()));
+  TF_RET_CHECK(LayoutUtil::IsMonotonicWithDim0Major(rhs->shape().layout()));
+
+  TF_RETURN_IF_ERROR(EmitTargetAddressForOp(hlo));
+  llvm::Type* float_ptr_type = b_.getFloatTy()->getPointerTo();
+  llvm::Value* bias_ptr =
+      config.has_bias()
+          ? BitCast(GetEmittedValueFor(hlo->operand(2)), float_ptr_type)
+          : llvm::ConstantPointerNull::get(
+                llvm::cast<llvm::PointerType>(float_ptr_type));
+  const int64_t m = hlo->shape().dimensions(0);
+  const int64_t n = hlo->shape().dimensions(1);
+  const int64_t k = lhs->shape().dimensions(config.transpose_lhs() ? 0 : 1);
+  EmitCallToFunc(runtime::kOneDnnMatMulF32SymbolName,
+                 {GetExecutableRunOptionsArgument(),
+                  BitCast(GetEmittedValueFor(hlo), float_ptr_type),
+                  BitCast(GetEmittedValueFor(lhs), float_ptr_type),
+                  BitCast(GetEmittedValueFor(rhs), float_ptr_type), bias_ptr,
+                  b_.getInt64(m), b_.getInt64(n), b_.getInt64(k),
+                  b_.getInt32(config.transpose_lhs()),
+                  b_.getInt32(config.transpose_rhs()),
+                  b_.getInt32(config.activation())},
+                 b_.getVoidTy(), /*does_not_throw=*/true,
+                 /*only_accesses_arg_memory=*/true);
+  return OkStatus();
+}
+
+Status IrEmitter::HandleOneDnnConvolution(HloInstruction* hlo) {
+  TF_ASSIGN_OR_RETURN(const BackendConfig backend_config,
+                      hlo->backend_config<BackendConfig>());
+  const OneDnnFusionConfig& config = backend_config.onednn_fusion_config();
+  const Shape& input_shape = hlo->operand(0)->shape();
+  const Shape& kernel_shape = hlo->operand(1)->shape();
+  const Shape& output_shape = hlo->shape();
+  TF_RET_CHECK(hlo->operand_count() == (config.has_bias() ? 3 : 2));
+  TF_RET_CHECK(output_shape.element_type() == F32);
+  TF_RET_CHECK(output_shape.dimensions_size() == 4);
+  TF_RET_CHECK(LayoutUtil::IsMonotonicWithDim0Major(output_shape.layout()));
+  TF_RET_CHECK(LayoutUtil::IsMonotonicWithDim0Major(input_shape.layout()));
+  TF_RET_CHECK(LayoutUtil::IsMonotonicWithDim0Major(kernel_shape.layout()));
+
+  // OneDnnRewriter only produces canonical NHWC/HWIO convolutions.
+  const Window& window = hlo->window();
+  TF_RET_CHECK(window.dimensions_size() == 2);
+  TF_RET_CHECK(!window_util::HasBaseDilation(window));
+
+  TF_RETURN_IF_ERROR(EmitTargetAddressForOp(hlo));
+  llvm::Type* float_ptr_type = b_.getFloatTy()->getPointerTo();
+  llvm::Value* bias_ptr =
+      config.has_bias()
+          ? BitCast(GetEmittedValueFor(hlo->operand(2)), float_ptr_type)
+          : llvm::ConstantPointerNull::get(
+                llvm::cast<llvm::PointerType>(float_ptr_type));
+  std::vector<llvm::Value*> args = {
+      GetExecutableRunOptionsArgument(),
+      BitCast(GetEmittedValueFor(hlo), float_ptr_type),
+      BitCast(GetEmittedValueFor(hlo->operand(0)), float_ptr_type),
+      BitCast(GetEmittedValueFor(hlo->operand(1)), float_ptr_type),
+      bias_ptr,
+  };
+  for (int64_t d : input_shape.dimensions()) {
+    args.push_back(b_.getInt64(d));
+  }
+  for (int64_t d : kernel_shape.dimensions()) {
+    args.push_back(b_.getInt64(d));
+  }
+  args.push_back(b_.getInt64(output_shape.dimensions(1)));
+  args.push_back(b_.getInt64(output_shape.dimensions(2)));
+  for (const WindowDimension& d : window.dimensions()) {
+    args.push_back(b_.getInt64(d.stride()));
+  }
+  for (const WindowDimension& d : window.dimensions()) {
+    args.push_back(b_.getInt64(d.padding_low()));
+    args.push_back(b_.getInt64(d.padding_high()));
+  }
+  for (const WindowDimension& d : window.dimensions()) {
+    args.push_back(b_.getInt64(d.window_dilation()));
+  }
+  args.push_back(b_.getInt32(config.activation()));
+  EmitCallToFunc(runtime::kOneDnnConv2DF32SymbolName, args, b_.getVoidTy(),
+                 /*does_not_throw=*/true,
+                 /*only_accesses_arg_memory=*/true);
+  return OkStatus();
+}
+
 Status IrEmitter::HandleCustomCall(HloInstruction* custom_call) {
   if (custom_call->custom_call_target() == "PadToStatic") {
     return HandlePadToStatic(custom_call);
@@ -2438,6 +2568,12 @@ Status IrEmitter::HandleCustomCall(HloInstruction* custom_call) {
   if (custom_call->custom_call_target() == "TopK") {
     return HandleTopK(custom_call);
   }
+  if (custom_call->custom_call_target() == kOneDnnMatMulCallTarget) {
+    return HandleOneDnnMatMul(custom_call);
+  }
+  if (custom_call->custom_call_target() == kOneDnnConvolutionCallTarget) {
+    return HandleOneDnnConvolution(custom_call);
+  }
 
   absl::Span<HloInstruction* const> operands(custom_call->operands());
   llvm::Type* i8_ptr_type = b_.getInt8PtrTy();
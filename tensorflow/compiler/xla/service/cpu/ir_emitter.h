@@ -42,6 +42,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/target_machine_features.h"
 #include "tensorflow/compiler/xla/service/hlo_module_config.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/alias_analysis.h"
+#include "tensorflow/compiler/xla/service/llvm_ir/dynamic_update_slice_util.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/fused_ir_emitter.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/ir_array.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/ir_builder_mixin.h"
@@ -190,6 +191,8 @@ class IrEmitter : public DfsHloVisitorWithDefault,
   Status HandleSliceToDynamic(HloInstruction* hlo);
   Status HandlePadToStatic(HloInstruction* hlo);
   Status HandleTopK(HloInstruction* hlo);
+  Status HandleOneDnnMatMul(HloInstruction* hlo);
+  Status HandleOneDnnConvolution(HloInstruction* hlo);
   Status HandleAllReduceSingleReplica(HloInstruction* crs);
   Status HandleAllReduceMultipleReplica(HloInstruction* crs);
 
@@ -546,6 +549,17 @@ class IrEmitter : public DfsHloVisitorWithDefault,
            op.parent()->root_instruction() == &op;
   }
 
+  // Returns the loop emitter for the in-place dynamic-update-slice 'op', which
+  // emits a parallel loop over the update if ShouldEmitParallelLoopFor(op).
+  llvm_ir::UpdateLoopEmitter GetInPlaceDynamicUpdateSliceLoopEmitter(
+      const HloInstruction& op);
+
+  // Returns the shape whose most-major dimensions 'root', the root of a
+  // parallelized computation, is partitioned along.  That's the update shape
+  // for in-place dynamic-update-slices and the output shape for everything
+  // else.
+  Shape GetParallelLoopShape(HloInstruction* root);
+
   // This struct contains all the state needed to emit instructions for
   // profiling a computation.
   class ProfilingState {
@@ -0,0 +1,232 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/onednn_rewriter.h"
+
+#include <vector>
+
+#include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_opcode.h"
+#include "tensorflow/compiler/xla/layout_util.h"
+#include "tensorflow/compiler/xla/service/cpu/backend_config.pb.h"
+#include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/window_util.h"
+#include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+bool IsRowMajorF32(const Shape& shape) {
+  return shape.IsArray() && shape.element_type() == F32 &&
+         LayoutUtil::IsMonotonicWithDim0Major(shape.layout());
+}
+
+// Returns true if `dot` can be computed by a oneDNN matmul, filling in whether
+// its operands are stored transposed.
+bool IsSupportedDot(const HloInstruction* dot, bool* transpose_lhs,
+                    bool* transpose_rhs) {
+  if (dot->opcode() != HloOpcode::kDot ||
+      dot->shape().dimensions_size() != 2) {
+    return false;
+  }
+  const HloInstruction* lhs = dot->operand(0);
+  const HloInstruction* rhs = dot->operand(1);
+  if (!IsRowMajorF32(dot->shape()) || !IsRowMajorF32(lhs->shape()) ||
+      !IsRowMajorF32(rhs->shape()) ||
+      ShapeUtil::IsZeroElementArray(lhs->shape()) ||
+      ShapeUtil::IsZeroElementArray(rhs->shape())) {
+    return false;
+  }
+  const DotDimensionNumbers& dnums = dot->dot_dimension_numbers();
+  if (dnums.lhs_batch_dimensions_size() != 0 ||
+      dnums.rhs_batch_dimensions_size() != 0 ||
+      dnums.lhs_contracting_dimensions_size() != 1 ||
+      dnums.rhs_contracting_dimensions_size() != 1) {
+    return false;
+  }
+  *transpose_lhs = dnums.lhs_contracting_dimensions(0) == 0;
+  *transpose_rhs = dnums.rhs_contracting_dimensions(0) == 1;
+  return true;
+}
+
+// Returns true if `conv` is a canonical 2D convolution that can be computed by
+// a oneDNN convolution_forward primitive.
+bool IsSupportedConvolution(
+    const HloInstruction* conv,
+    const TargetMachineFeatures& target_machine_features) {
+  if (conv->opcode() != HloOpcode::kConvolution ||
+      conv->shape().dimensions_size() != 4 ||
+      conv->feature_group_count() != 1 || conv->batch_group_count() != 1 ||
+      window_util::HasBaseDilation(conv->window())) {
+    return false;
+  }
+  if (!IsRowMajorF32(conv->shape()) ||
+      !IsRowMajorF32(conv->operand(0)->shape()) ||
+      !IsRowMajorF32(conv->operand(1)->shape())) {
+    return false;
+  }
+  return PotentiallyImplementedAsEigenConvolution(*conv,
+                                                  target_machine_features);
+}
+
+// Returns true if `hlo` is a constant or a broadcast of a constant whose
+// elements are all zero.
+bool IsZero(const HloInstruction* hlo) {
+  if (hlo->opcode() == HloOpcode::kBroadcast) {
+    hlo = hlo->operand(0);
+  }
+  return hlo->opcode() == HloOpcode::kConstant && hlo->literal().IsAll(0);
+}
+
+// If `result` is only used by `add(result, broadcast(bias))` with a rank-1
+// `bias` along the last dimension, returns the add and sets `*bias`.
+HloInstruction* MatchBiasAdd(HloInstruction* result, HloInstruction** bias) {
+  if (result->user_count() != 1) {
+    return nullptr;
+  }
+  HloInstruction* add = result->users()[0];
+  if (add->opcode() != HloOpcode::kAdd ||
+      !ShapeUtil::Equal(add->shape(), result->shape())) {
+    return nullptr;
+  }
+  HloInstruction* other =
+      add->mutable_operand(add->operand(0) == result ? 1 : 0);
+  const int64_t feature_dim = result->shape().dimensions_size() - 1;
+  if (other == result || other->opcode() != HloOpcode::kBroadcast ||
+      other->dimensions().size() != 1 ||
+      other->dimensions(0) != feature_dim ||
+      other->operand(0)->shape().element_type() != F32) {
+    return nullptr;
+  }
+  *bias = other->mutable_operand(0);
+  return add;
+}
+
+// If `result` is only used by a supported activation, returns the activation
+// and sets `*activation`.
+HloInstruction* MatchActivation(HloInstruction* result,
+                                OneDnnFusionConfig::Activation* activation) {
+  if (result->user_count() != 1) {
+    return nullptr;
+  }
+  HloInstruction* user = result->users()[0];
+  if (!ShapeUtil::Equal(user->shape(), result->shape())) {
+    return nullptr;
+  }
+  if (user->opcode() == HloOpcode::kTanh) {
+    *activation = OneDnnFusionConfig::TANH;
+    return user;
+  }
+  if (user->opcode() == HloOpcode::kMaximum) {
+    const HloInstruction* other =
+        user->operand(user->operand(0) == result ? 1 : 0);
+    if (other != result && IsZero(other)) {
+      *activation = OneDnnFusionConfig::RELU;
+      return user;
+    }
+  }
+  return nullptr;
+}
+
+// Replaces `hlo` and its epilogue with a oneDNN custom call. Returns false if
+// there is no epilogue to fuse.
+StatusOr<bool> RewriteWithEpilogue(HloInstruction* hlo,
+                                   absl::string_view target,
+                                   OneDnnFusionConfig config) {
+  HloInstruction* result = hlo;
+  HloInstruction* bias = nullptr;
+  if (HloInstruction* add = MatchBiasAdd(result, &bias)) {
+    config.set_has_bias(true);
+    result = add;
+  }
+  OneDnnFusionConfig::Activation activation;
+  if (HloInstruction* act = MatchActivation(result, &activation)) {
+    config.set_activation(activation);
+    result = act;
+  }
+  if (result == hlo) {
+    return false;
+  }
+
+  std::vector<HloInstruction*> operands = {hlo->mutable_operand(0),
+                                           hlo->mutable_operand(1)};
+  if (bias != nullptr) {
+    operands.push_back(bias);
+  }
+  HloComputation* computation = hlo->parent();
+  HloInstruction* custom_call =
+      computation->AddInstruction(HloInstruction::CreateCustomCall(
+          result->shape(), operands, target));
+  if (hlo->opcode() == HloOpcode::kConvolution) {
+    custom_call->set_window(hlo->window());
+    custom_call->set_convolution_dimension_numbers(
+        hlo->convolution_dimension_numbers());
+  }
+  BackendConfig backend_config;
+  *backend_config.mutable_onednn_fusion_config() = config;
+  TF_RETURN_IF_ERROR(custom_call->set_backend_config(backend_config));
+  custom_call->set_metadata(hlo->metadata());
+
+  VLOG(2) << "Fusing " << hlo->name() << " into " << target << " ending at "
+          << result->name();
+  TF_RETURN_IF_ERROR(computation->ReplaceInstruction(result, custom_call));
+  return true;
+}
+
+}  // namespace
+
+StatusOr<bool> OneDnnRewriter::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  bool changed = false;
+  for (HloComputation* computation :
+       module->MakeNonfusionComputations(execution_threads)) {
+    // Collect the candidates up front: rewriting removes the epilogue
+    // instructions, which would invalidate a post order taken beforehand.
+    std::vector<HloInstruction*> candidates;
+    for (HloInstruction* hlo : computation->MakeInstructionPostOrder()) {
+      if (hlo->opcode() == HloOpcode::kDot ||
+          hlo->opcode() == HloOpcode::kConvolution) {
+        candidates.push_back(hlo);
+      }
+    }
+    for (HloInstruction* hlo : candidates) {
+      OneDnnFusionConfig config;
+      if (bool transpose_lhs, transpose_rhs;
+          IsSupportedDot(hlo, &transpose_lhs, &transpose_rhs)) {
+        config.set_transpose_lhs(transpose_lhs);
+        config.set_transpose_rhs(transpose_rhs);
+        TF_ASSIGN_OR_RETURN(
+            bool rewritten,
+            RewriteWithEpilogue(hlo, kOneDnnMatMulCallTarget, config));
+        changed |= rewritten;
+      } else if (IsSupportedConvolution(hlo, target_machine_features_)) {
+        TF_ASSIGN_OR_RETURN(
+            bool rewritten,
+            RewriteWithEpilogue(hlo, kOneDnnConvolutionCallTarget, config));
+        changed |= rewritten;
+      }
+    }
+  }
+  return changed;
+}
+
+}  // namespace cpu
+}  // namespace xla
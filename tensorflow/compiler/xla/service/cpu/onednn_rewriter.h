@@ -0,0 +1,69 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_ONEDNN_REWRITER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_ONEDNN_REWRITER_H_
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
+#include "tensorflow/compiler/xla/service/cpu/target_machine_features.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace cpu {
+
+// Custom call targets emitted by OneDnnRewriter. Both are lowered by the IR
+// emitter into calls to the oneDNN runtime in runtime_onednn.h.
+inline constexpr absl::string_view kOneDnnMatMulCallTarget = "__onednn$matmul";
+inline constexpr absl::string_view kOneDnnConvolutionCallTarget =
+    "__onednn$convolution";
+
+// An HLO pass that fuses F32 dots and 2D convolutions together with their
+// epilogue into a single oneDNN primitive call. The matched patterns are
+//
+//   dot(lhs, rhs) [+ broadcast(bias)] [-> relu | tanh]
+//   convolution(input, kernel) [+ broadcast(bias)] [-> relu | tanh]
+//
+// where relu is max(x, 0), the bias is a rank-1 array broadcast along the last
+// (feature) dimension of the result, and at least one of the bias or the
+// activation is present: plain dots and convolutions are left to the existing
+// Eigen/MKL lowering. The match is replaced with a custom call whose
+// operands are (lhs, rhs[, bias]) and whose BackendConfig carries a
+// OneDnnFusionConfig describing the fused post-ops.
+//
+// Dots must be rank-2 without batch dimensions and convolutions must be in the
+// canonical NHWC/HWIO form produced by ConvCanonicalization. All operands must
+// be in the default (row-major) layout, so the pass has to run after layout
+// assignment.
+class OneDnnRewriter : public HloModulePass {
+ public:
+  explicit OneDnnRewriter(const TargetMachineFeatures* target_machine_features)
+      : target_machine_features_(*target_machine_features) {}
+
+  absl::string_view name() const override { return "onednn-rewriter"; }
+
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+ private:
+  const TargetMachineFeatures& target_machine_features_;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_ONEDNN_REWRITER_H_
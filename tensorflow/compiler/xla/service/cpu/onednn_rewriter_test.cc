@@ -0,0 +1,181 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/onednn_rewriter.h"
+
+#include <memory>
+
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/cpu/backend_config.pb.h"
+#include "tensorflow/compiler/xla/service/cpu/target_machine_features_fake.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+class OneDnnRewriterTest : public HloTestBase {
+ protected:
+  StatusOr<bool> RunRewriter(HloModule* module) {
+    TargetMachineFeaturesWithFakeAlignmentLogic target_machine_features(
+        [](int64_t shape_size) {
+          return TargetMachineFeatures::kEigenExpectedTensorAlignment;
+        });
+    return OneDnnRewriter(&target_machine_features).Run(module);
+  }
+
+  OneDnnFusionConfig GetConfig(const HloInstruction* custom_call) {
+    return custom_call->backend_config<BackendConfig>()
+        .value()
+        .onednn_fusion_config();
+  }
+};
+
+TEST_F(OneDnnRewriterTest, FusesDotBiasRelu) {
+  const char* const kHlo = R"(
+HloModule m
+
+ENTRY e {
+  lhs = f32[32,64] parameter(0)
+  rhs = f32[64,16] parameter(1)
+  bias = f32[16] parameter(2)
+  dot = f32[32,16] dot(lhs, rhs), lhs_contracting_dims={1},
+                                  rhs_contracting_dims={0}
+  bias_b = f32[32,16] broadcast(bias), dimensions={1}
+  add = f32[32,16] add(dot, bias_b)
+  zero = f32[] constant(0)
+  zero_b = f32[32,16] broadcast(zero), dimensions={}
+  ROOT relu = f32[32,16] maximum(add, zero_b)
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHlo));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunRewriter(module.get()));
+  EXPECT_TRUE(changed);
+
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_EQ(root->opcode(), HloOpcode::kCustomCall);
+  EXPECT_EQ(root->custom_call_target(), kOneDnnMatMulCallTarget);
+  EXPECT_EQ(root->operand_count(), 3);
+  EXPECT_EQ(root->operand(2)->name(), "bias");
+  OneDnnFusionConfig config = GetConfig(root);
+  EXPECT_TRUE(config.has_bias());
+  EXPECT_EQ(config.activation(), OneDnnFusionConfig::RELU);
+  EXPECT_FALSE(config.transpose_lhs());
+  EXPECT_FALSE(config.transpose_rhs());
+}
+
+TEST_F(OneDnnRewriterTest, FusesTransposedDotTanh) {
+  const char* const kHlo = R"(
+HloModule m
+
+ENTRY e {
+  lhs = f32[64,32] parameter(0)
+  rhs = f32[16,64] parameter(1)
+  dot = f32[32,16] dot(lhs, rhs), lhs_contracting_dims={0},
+                                  rhs_contracting_dims={1}
+  ROOT tanh = f32[32,16] tanh(dot)
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHlo));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunRewriter(module.get()));
+  EXPECT_TRUE(changed);
+
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_EQ(root->opcode(), HloOpcode::kCustomCall);
+  EXPECT_EQ(root->operand_count(), 2);
+  OneDnnFusionConfig config = GetConfig(root);
+  EXPECT_FALSE(config.has_bias());
+  EXPECT_EQ(config.activation(), OneDnnFusionConfig::TANH);
+  EXPECT_TRUE(config.transpose_lhs());
+  EXPECT_TRUE(config.transpose_rhs());
+}
+
+TEST_F(OneDnnRewriterTest, FusesConvolutionBias) {
+  const char* const kHlo = R"(
+HloModule m
+
+ENTRY e {
+  input = f32[8,28,28,32] parameter(0)
+  kernel = f32[3,3,32,64] parameter(1)
+  bias = f32[64] parameter(2)
+  conv = f32[8,28,28,64] convolution(input, kernel),
+      window={size=3x3 pad=1_1x1_1}, dim_labels=b01f_01io->b01f
+  bias_b = f32[8,28,28,64] broadcast(bias), dimensions={3}
+  ROOT add = f32[8,28,28,64] add(bias_b, conv)
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHlo));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunRewriter(module.get()));
+  EXPECT_TRUE(changed);
+
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_EQ(root->opcode(), HloOpcode::kCustomCall);
+  EXPECT_EQ(root->custom_call_target(), kOneDnnConvolutionCallTarget);
+  EXPECT_EQ(root->window().dimensions_size(), 2);
+  OneDnnFusionConfig config = GetConfig(root);
+  EXPECT_TRUE(config.has_bias());
+  EXPECT_EQ(config.activation(), OneDnnFusionConfig::NONE);
+}
+
+TEST_F(OneDnnRewriterTest, DoesNotRewriteWithoutEpilogue) {
+  const char* const kHlo = R"(
+HloModule m
+
+ENTRY e {
+  lhs = f32[32,64] parameter(0)
+  rhs = f32[64,16] parameter(1)
+  ROOT dot = f32[32,16] dot(lhs, rhs), lhs_contracting_dims={1},
+                                       rhs_contracting_dims={0}
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHlo));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunRewriter(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(OneDnnRewriterTest, DoesNotFuseDotWithMultipleUsers) {
+  const char* const kHlo = R"(
+HloModule m
+
+ENTRY e {
+  lhs = f32[32,64] parameter(0)
+  rhs = f32[64,16] parameter(1)
+  dot = f32[32,16] dot(lhs, rhs), lhs_contracting_dims={1},
+                                  rhs_contracting_dims={0}
+  tanh = f32[32,16] tanh(dot)
+  ROOT tuple = (f32[32,16], f32[32,16]) tuple(dot, tanh)
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHlo));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunRewriter(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(OneDnnRewriterTest, DoesNotRewriteNonF32) {
+  const char* const kHlo = R"(
+HloModule m
+
+ENTRY e {
+  lhs = f64[32,64] parameter(0)
+  rhs = f64[64,16] parameter(1)
+  dot = f64[32,16] dot(lhs, rhs), lhs_contracting_dims={1},
+                                  rhs_contracting_dims={0}
+  ROOT tanh = f64[32,16] tanh(dot)
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHlo));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunRewriter(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -56,6 +56,13 @@ class ParallelLoopEmitter : public llvm_ir::LoopEmitter {
                       const DynamicLoopBounds* dynamic_loop_bounds,
                       llvm::IRBuilder<>* b);
 
+  // Constructs a ParallelLoopEmitter which calls 'body_emitter' for every index
+  // of 'shape', using 'dynamic_loop_bounds' for its most-major dimensions.
+  ParallelLoopEmitter(const llvm_ir::BodyEmitter& body_emitter,
+                      const Shape& shape,
+                      const DynamicLoopBounds* dynamic_loop_bounds,
+                      llvm::IRBuilder<>* b);
+
   ParallelLoopEmitter(const ParallelLoopEmitter&) = delete;
   ParallelLoopEmitter& operator=(const ParallelLoopEmitter&) = delete;
   ~ParallelLoopEmitter() override = default;
@@ -30,6 +30,10 @@ limitations under the License.
 namespace xla {
 namespace cpu {
 
+// Partitions are aligned to (typical) cache lines, so that parallel tasks
+// don't write to the same cache line.
+constexpr int64_t kCacheLineBytes = 64;
+
 class SimpleCostModel : public ParallelCostModel {
  public:
   SimpleCostModel(const int64_t max_parallelism,
@@ -80,8 +84,11 @@ class DefaultCostModel : public ParallelCostModel {
       // TODO(b/29630486) Develop system bandwidth model.
       max_parallelism = std::min<int64_t>(
           max_parallelism_, std::ceil(std::sqrt(tsl::port::MaxParallelism())));
-      // Use shape size instruction cost and L2 cache size min per-thread cost.
-      instruction_cost = shape_size_(instruction->shape());
+      // Use bytes accessed instruction cost and L2 cache size min per-thread
+      // cost.  Unlike the output size, bytes accessed also accounts for the
+      // operands of e.g. reductions and fusions, and only for the updated
+      // elements of dynamic-update-slices.
+      instruction_cost = bytes_accessed;
       min_cost_per_thread = 256LL << 10;  // 256KB L2 Cache size.
     } else {
       // Use max parallelism for compute bound instructions.
@@ -139,14 +146,12 @@ int64_t ParallelTaskAssignment::GetTargetParallelTaskCount(
   // *) Emit custom loops (kSelectAndScatter).
   // *) Operations that are not thread safe (like infeed and rng).
   // *) Tuple-shaped.
-  // *) Operations that might be implemented as an in-place
-  //    dynamic-update-slice, because we can't know how many output elements
-  //    they will write (out-of-place will touch the whole output buffer, while
-  //    in-place will only touch the updated elements).
+  // Operations that might be implemented as an in-place dynamic-update-slice
+  // are partitioned along their update (see GetParallelTaskShape), which
+  // is valid whether or not they end up being emitted in place.
   // TODO(b/27458679) Parallelize instructions which are skipped here.
   auto opcode = instruction->opcode();
-  if (llvm_ir::MayBeImplementedAsInPlaceDynamicUpdateSlice(instruction) ||
-      instruction->shape().IsTuple() || opcode == HloOpcode::kRng ||
+  if (instruction->shape().IsTuple() || opcode == HloOpcode::kRng ||
       opcode == HloOpcode::kConstant) {
     return 1;
   }
@@ -172,6 +177,18 @@ int64_t ParallelTaskAssignment::GetTargetParallelTaskCount(
   return 1;
 }
 
+// Returns the shape whose outer dimensions 'instruction' is partitioned along.
+// In-place dynamic-update-slices only loop over (and are partitioned along)
+// their update.  The same partition counts are also valid for the output if the
+// dynamic-update-slice ends up being emitted out of place, since the update is
+// never larger than the output.
+static Shape GetParallelTaskShape(const HloInstruction* instruction) {
+  if (llvm_ir::MayBeImplementedAsInPlaceDynamicUpdateSlice(instruction)) {
+    return llvm_ir::GetInPlaceDynamicUpdateSliceLoopShape(instruction);
+  }
+  return instruction->shape();
+}
+
 StatusOr<bool> ParallelTaskAssigner::Run(
     HloModule* module,
     const absl::flat_hash_set<absl::string_view>& execution_threads) {
@@ -224,8 +241,10 @@ bool ParallelTaskAssigner::AssignParallelTasksHelper(
     // Get target parallel task count computed for 'instruction'.
     const int64_t target_parallel_task_count = (*it).second;
     // Assign feasible dimension partitions (based on actual dimension sizes).
-    auto dim_partition_counts = ShapePartitionAssigner(instruction->shape())
-                                    .Run(target_parallel_task_count);
+    const Shape partition_shape = GetParallelTaskShape(instruction);
+    auto dim_partition_counts =
+        ShapePartitionAssigner(partition_shape, kCacheLineBytes)
+            .Run(target_parallel_task_count);
     const int64_t total_partition_count =
         ShapePartitionAssigner::GetTotalPartitionCount(dim_partition_counts);
     if (total_partition_count <= 1) {
@@ -126,11 +126,13 @@ TEST_F(ParallelTaskAssignmentTest, InfeedOutfeedOperationNotParallelized) {
   EXPECT_FALSE(changed);
 }
 
-TEST_F(ParallelTaskAssignmentTest, InPlaceDynamicUpdateSliceNotParallelized) {
+TEST_F(ParallelTaskAssignmentTest,
+       SmallInPlaceDynamicUpdateSliceNotParallelized) {
   // A dynamic-update-slice within a while loop.  This construction is an easy
   // way to make a DUS which can be run "in-place" (i.e. the input and output
   // are the same buffer, and running the DUS only writes to the updated
-  // elements).
+  // elements).  Its cost is that of the (small) update, not of the (large)
+  // output, so it is not worth parallelizing.
   const std::string hlo_string = R"(
   HloModule test
 
@@ -32,6 +32,8 @@ using ComputeFunctionType = void (*)(void*, const void*, const void**, void**,
 // Dispatches 'num_partitions - 1' calls to 'function_ptr' in parallel.
 // Calls 'function_ptr' for first partition inline.
 // Uses blocking counter to synchronize threads after parallel calls complete.
+// If 'run_options' has no intra-op thread pool (e.g. ahead-of-time compiled
+// code run without calling set_thread_pool), all partitions run inline.
 //
 // The 'partitions' array has a total number of elements equal to
 // 'num_partitions * num_partitioned_dims * 2' (the '2' is necessary to specify
@@ -73,7 +75,6 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelForkJoin(
   const xla::ExecutableRunOptions* run_options =
       static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
   CHECK_NE(run_options, nullptr);
-  CHECK_NE(run_options->intra_op_thread_pool(), nullptr);
 
   ComputeFunctionType function =
       reinterpret_cast<ComputeFunctionType>(function_ptr);
@@ -82,25 +83,34 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelForkJoin(
 
   std::vector<XlaCustomCallStatus> statuses(num_partitions);
 
-  // Dispatch 'num_partitions - 1' compute functions to run in parallel.
-  tsl::BlockingCounter bc(num_partitions - 1);
-  for (int32_t i = 1; i < num_partitions; ++i) {
-    const int64_t offset = i * stride;
-    run_options->intra_op_thread_pool()->enqueueNoNotification(
-        [i, function, result_ptr, run_options_ptr, buffer_table, prof_counters,
-         partitions, offset, &bc, &statuses]() {
-          function(result_ptr, run_options_ptr, nullptr, buffer_table,
-                   &statuses[i], &partitions[offset], prof_counters);
-          bc.DecrementCount();
-          VLOG(3) << "ParallelForkJoin partition " << i << " done.";
-        });
-  }
+  if (run_options->intra_op_thread_pool() == nullptr) {
+    for (int32_t i = 0; i < num_partitions; ++i) {
+      function(result_ptr, run_options_ptr, params, buffer_table, &statuses[i],
+               &partitions[i * stride], prof_counters);
+    }
+    VLOG(3) << "ParallelForkJoin ran " << num_partitions
+            << " partitions inline.";
+  } else {
+    // Dispatch 'num_partitions - 1' compute functions to run in parallel.
+    tsl::BlockingCounter bc(num_partitions - 1);
+    for (int32_t i = 1; i < num_partitions; ++i) {
+      const int64_t offset = i * stride;
+      run_options->intra_op_thread_pool()->enqueueNoNotification(
+          [i, function, result_ptr, run_options_ptr, buffer_table,
+           prof_counters, partitions, offset, &bc, &statuses]() {
+            function(result_ptr, run_options_ptr, nullptr, buffer_table,
+                     &statuses[i], &partitions[offset], prof_counters);
+            bc.DecrementCount();
+            VLOG(3) << "ParallelForkJoin partition " << i << " done.";
+          });
+    }
 
-  // Call first compute function inline.
-  function(result_ptr, run_options_ptr, params, buffer_table, &statuses[0],
-           &partitions[0], prof_counters);
-  VLOG(3) << "ParallelForkJoin partition 0 done.";
-  bc.Wait();
+    // Call first compute function inline.
+    function(result_ptr, run_options_ptr, params, buffer_table, &statuses[0],
+             &partitions[0], prof_counters);
+    VLOG(3) << "ParallelForkJoin partition 0 done.";
+    bc.Wait();
+  }
 
   // Collect all error messages (if any).
   std::vector<std::pair<int32_t, absl::string_view>> error_messages;
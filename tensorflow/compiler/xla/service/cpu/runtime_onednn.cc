@@ -0,0 +1,309 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/runtime_onednn.h"
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "absl/base/dynamic_annotations.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/compiler/xla/executable_run_options.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_lightweight_check.h"
+
+#if defined(XLA_CPU_USE_ONEDNN)
+#include "absl/container/flat_hash_map.h"
+#include "dnnl.hpp"
+#if DNNL_CPU_THREADING_RUNTIME == DNNL_RUNTIME_THREADPOOL
+#include "dnnl_threadpool.hpp"
+#endif  // DNNL_CPU_THREADING_RUNTIME == DNNL_RUNTIME_THREADPOOL
+#else
+#include "tensorflow/compiler/xla/service/cpu/runtime_conv2d.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_matmul.h"
+#endif  // XLA_CPU_USE_ONEDNN
+
+namespace {
+
+// Must match xla::cpu::OneDnnFusionConfig::Activation.
+enum Activation : int32_t {
+  kNone = 0,
+  kRelu = 1,
+  kTanh = 2,
+};
+
+#if defined(XLA_CPU_USE_ONEDNN)
+
+using dnnl::algorithm;
+using dnnl::memory;
+
+// A least-recently-used cache of oneDNN primitives. Creating a primitive
+// JIT-compiles its kernel, which is usually much more expensive than running
+// it, so primitives are reused across calls with the same configuration. As
+// with the primitive factories in tensorflow/core/util/mkl_util.h the caches
+// are thread-local, so lookups need no locking.
+template <typename Primitive>
+class PrimitiveCache {
+ public:
+  using Key = std::vector<int64_t>;
+
+  static constexpr size_t kCapacity = 256;
+
+  template <typename CreateFn>
+  Primitive& GetOrCreate(const Key& key, CreateFn&& create) {
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return it->second->second;
+    }
+    if (entries_.size() >= kCapacity) {
+      index_.erase(entries_.back().first);
+      entries_.pop_back();
+    }
+    entries_.emplace_front(key, create());
+    index_[key] = entries_.begin();
+    return entries_.front().second;
+  }
+
+ private:
+  using Entry = std::pair<Key, Primitive>;
+  std::list<Entry> entries_;
+  absl::flat_hash_map<Key, typename std::list<Entry>::iterator> index_;
+};
+
+const dnnl::engine& CpuEngine() {
+  static const dnnl::engine* engine =
+      new dnnl::engine(dnnl::engine::kind::cpu, 0);
+  return *engine;
+}
+
+#if DNNL_CPU_THREADING_RUNTIME == DNNL_RUNTIME_THREADPOOL
+// Runs oneDNN's parallel regions on the intra-op Eigen thread pool that the
+// rest of the XLA:CPU runtime uses. parallel_for is synchronous: the calling
+// thread runs the first chunk and then waits for the others.
+class OneDnnThreadPool : public dnnl::threadpool_interop::threadpool_iface {
+ public:
+  explicit OneDnnThreadPool(const Eigen::ThreadPoolDevice* device)
+      : device_(device) {}
+
+  int get_num_threads() const override { return device_->numThreads(); }
+  bool get_in_parallel() const override {
+    return device_->currentThreadId() != -1;
+  }
+  uint64_t get_flags() const override { return 0; }
+
+  void parallel_for(int n, const std::function<void(int, int)>& fn) override {
+    // Nested parallel regions run inline so that we never block a pool thread
+    // on work queued behind it.
+    if (n <= 1 || get_in_parallel()) {
+      for (int i = 0; i < n; ++i) {
+        fn(i, n);
+      }
+      return;
+    }
+    Eigen::Barrier barrier(n - 1);
+    for (int i = 1; i < n; ++i) {
+      device_->getPool()->Schedule([&fn, &barrier, i, n] {
+        fn(i, n);
+        barrier.Notify();
+      });
+    }
+    fn(0, n);
+    barrier.Wait();
+  }
+
+ private:
+  const Eigen::ThreadPoolDevice* device_;
+};
+#endif  // DNNL_CPU_THREADING_RUNTIME == DNNL_RUNTIME_THREADPOOL
+
+dnnl::primitive_attr MakeAttr(int32_t activation) {
+  dnnl::post_ops ops;
+  if (activation == kRelu) {
+    ops.append_eltwise(1.0f, algorithm::eltwise_relu, 0.0f, 0.0f);
+  } else if (activation == kTanh) {
+    ops.append_eltwise(1.0f, algorithm::eltwise_tanh, 0.0f, 0.0f);
+  }
+  dnnl::primitive_attr attr;
+  attr.set_post_ops(ops);
+  return attr;
+}
+
+void Execute(const xla::ExecutableRunOptions* run_options,
+             const dnnl::primitive& primitive,
+             const std::unordered_map<int, memory>& args) {
+  XLA_LIGHTWEIGHT_CHECK(run_options->intra_op_thread_pool() != nullptr);
+#if DNNL_CPU_THREADING_RUNTIME == DNNL_RUNTIME_THREADPOOL
+  OneDnnThreadPool thread_pool(run_options->intra_op_thread_pool());
+  dnnl::stream stream =
+      dnnl::threadpool_interop::make_stream(CpuEngine(), &thread_pool);
+#else
+  dnnl::stream stream(CpuEngine());
+#endif  // DNNL_CPU_THREADING_RUNTIME == DNNL_RUNTIME_THREADPOOL
+  primitive.execute(stream, args);
+  stream.wait();
+}
+
+#else  // XLA_CPU_USE_ONEDNN
+
+// Applies the bias and activation to a row-major `rows` x `features` result.
+void ApplyEpilogue(float* out, const float* bias, int64_t rows,
+                   int64_t features, int32_t activation) {
+  for (int64_t i = 0; i < rows; ++i) {
+    float* row = out + i * features;
+    for (int64_t j = 0; j < features; ++j) {
+      float value = bias != nullptr ? row[j] + bias[j] : row[j];
+      if (activation == kRelu) {
+        value = std::max(value, 0.0f);
+      } else if (activation == kTanh) {
+        value = std::tanh(value);
+      }
+      row[j] = value;
+    }
+  }
+}
+
+#endif  // XLA_CPU_USE_ONEDNN
+
+}  // namespace
+
+ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_OneDnnMatMulF32(
+    const void* run_options_ptr, float* out, float* lhs, float* rhs,
+    float* bias, int64_t m, int64_t n, int64_t k, int32_t transpose_lhs,
+    int32_t transpose_rhs, int32_t activation) {
+  const xla::ExecutableRunOptions* run_options =
+      static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
+#if defined(XLA_CPU_USE_ONEDNN)
+  const memory::desc lhs_md({m, k}, memory::data_type::f32,
+                            transpose_lhs ? memory::format_tag::ba
+                                          : memory::format_tag::ab);
+  const memory::desc rhs_md({k, n}, memory::data_type::f32,
+                            transpose_rhs ? memory::format_tag::ba
+                                          : memory::format_tag::ab);
+  const memory::desc bias_md({1, n}, memory::data_type::f32,
+                             memory::format_tag::ab);
+  const memory::desc out_md({m, n}, memory::data_type::f32,
+                            memory::format_tag::ab);
+
+  thread_local PrimitiveCache<dnnl::matmul> cache;
+  const dnnl::matmul& matmul = cache.GetOrCreate(
+      {m, n, k, transpose_lhs, transpose_rhs, bias != nullptr, activation},
+      [&] {
+        dnnl::matmul::desc desc = bias != nullptr
+                                      ? dnnl::matmul::desc(lhs_md, rhs_md,
+                                                           bias_md, out_md)
+                                      : dnnl::matmul::desc(lhs_md, rhs_md,
+                                                           out_md);
+        return dnnl::matmul(dnnl::matmul::primitive_desc(
+            desc, MakeAttr(activation), CpuEngine()));
+      });
+
+  std::unordered_map<int, memory> args = {
+      {DNNL_ARG_SRC, memory(lhs_md, CpuEngine(), lhs)},
+      {DNNL_ARG_WEIGHTS, memory(rhs_md, CpuEngine(), rhs)},
+      {DNNL_ARG_DST, memory(out_md, CpuEngine(), out)},
+  };
+  if (bias != nullptr) {
+    args.insert({DNNL_ARG_BIAS, memory(bias_md, CpuEngine(), bias)});
+  }
+  Execute(run_options, matmul, args);
+#else
+  // The Eigen kernel is column-major; computing out^T = rhs^T * lhs^T gives
+  // the row-major product.
+  __xla_cpu_runtime_EigenMatMulF32(run_options, out, rhs, lhs, n, m, k,
+                                   transpose_rhs, transpose_lhs);
+  ApplyEpilogue(out, bias, m, n, activation);
+#endif  // XLA_CPU_USE_ONEDNN
+}
+
+ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_OneDnnConv2DF32(
+    const void* run_options_ptr, float* out, float* lhs, float* rhs,
+    float* bias, int64_t input_batch, int64_t input_rows, int64_t input_cols,
+    int64_t input_channels, int64_t kernel_rows, int64_t kernel_cols,
+    int64_t kernel_channels, int64_t kernel_filters, int64_t output_rows,
+    int64_t output_cols, int64_t row_stride, int64_t col_stride,
+    int64_t padding_top, int64_t padding_bottom, int64_t padding_left,
+    int64_t padding_right, int64_t rhs_row_dilation, int64_t rhs_col_dilation,
+    int32_t activation) {
+  const xla::ExecutableRunOptions* run_options =
+      static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
+#if defined(XLA_CPU_USE_ONEDNN)
+  const memory::desc lhs_md({input_batch, input_channels, input_rows,
+                             input_cols},
+                            memory::data_type::f32, memory::format_tag::nhwc);
+  const memory::desc rhs_md({kernel_filters, kernel_channels, kernel_rows,
+                             kernel_cols},
+                            memory::data_type::f32, memory::format_tag::hwio);
+  const memory::desc bias_md({kernel_filters}, memory::data_type::f32,
+                             memory::format_tag::a);
+  const memory::desc out_md({input_batch, kernel_filters, output_rows,
+                             output_cols},
+                            memory::data_type::f32, memory::format_tag::nhwc);
+
+  thread_local PrimitiveCache<dnnl::convolution_forward> cache;
+  const dnnl::convolution_forward& conv = cache.GetOrCreate(
+      {input_batch, input_rows, input_cols, input_channels, kernel_rows,
+       kernel_cols, kernel_filters, output_rows, output_cols, row_stride,
+       col_stride, padding_top, padding_bottom, padding_left, padding_right,
+       rhs_row_dilation, rhs_col_dilation, bias != nullptr, activation},
+      [&] {
+        // oneDNN counts dilation from 0, XLA from 1.
+        const memory::dims strides = {row_stride, col_stride};
+        const memory::dims dilates = {rhs_row_dilation - 1,
+                                      rhs_col_dilation - 1};
+        const memory::dims padding_l = {padding_top, padding_left};
+        const memory::dims padding_r = {padding_bottom, padding_right};
+        dnnl::convolution_forward::desc desc =
+            bias != nullptr
+                ? dnnl::convolution_forward::desc(
+                      dnnl::prop_kind::forward_inference,
+                      algorithm::convolution_direct, lhs_md, rhs_md, bias_md,
+                      out_md, strides, dilates, padding_l, padding_r)
+                : dnnl::convolution_forward::desc(
+                      dnnl::prop_kind::forward_inference,
+                      algorithm::convolution_direct, lhs_md, rhs_md, out_md,
+                      strides, dilates, padding_l, padding_r);
+        return dnnl::convolution_forward(
+            dnnl::convolution_forward::primitive_desc(
+                desc, MakeAttr(activation), CpuEngine()));
+      });
+
+  std::unordered_map<int, memory> args = {
+      {DNNL_ARG_SRC, memory(lhs_md, CpuEngine(), lhs)},
+      {DNNL_ARG_WEIGHTS, memory(rhs_md, CpuEngine(), rhs)},
+      {DNNL_ARG_DST, memory(out_md, CpuEngine(), out)},
+  };
+  if (bias != nullptr) {
+    args.insert({DNNL_ARG_BIAS, memory(bias_md, CpuEngine(), bias)});
+  }
+  Execute(run_options, conv, args);
+#else
+  __xla_cpu_runtime_EigenConv2DF32(
+      run_options, out, lhs, rhs, input_batch, input_rows, input_cols,
+      input_channels, kernel_rows, kernel_cols, kernel_channels,
+      kernel_filters, output_rows, output_cols, row_stride, col_stride,
+      padding_top, padding_bottom, padding_left, padding_right,
+      /*lhs_row_dilation=*/1, /*lhs_col_dilation=*/1, rhs_row_dilation,
+      rhs_col_dilation, /*feature_group_count=*/1);
+  ApplyEpilogue(out, bias, input_batch * output_rows * output_cols,
+                kernel_filters, activation);
+#endif  // XLA_CPU_USE_ONEDNN
+}
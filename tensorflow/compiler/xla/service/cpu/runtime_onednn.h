@@ -0,0 +1,48 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_RUNTIME_ONEDNN_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_RUNTIME_ONEDNN_H_
+
+#include <stdint.h>
+
+extern "C" {
+
+// Computes out = activation(lhs * rhs + bias) with a oneDNN matmul primitive.
+// Unlike the Eigen entry points all buffers are row-major: lhs is m x k (or
+// k x m if transpose_lhs), rhs is k x n (or n x k if transpose_rhs) and out is
+// m x n. `bias` has n elements and may be null. `activation` is a
+// xla::cpu::OneDnnFusionConfig::Activation value.
+extern void __xla_cpu_runtime_OneDnnMatMulF32(
+    const void* /* xla::ExecutableRunOptions* */ run_options_ptr, float* out,
+    float* lhs, float* rhs, float* bias, int64_t m, int64_t n, int64_t k,
+    int32_t transpose_lhs, int32_t transpose_rhs, int32_t activation);
+
+// Computes out = activation(conv2d(lhs, rhs) + bias) with a oneDNN
+// convolution_forward primitive. lhs is NHWC, rhs is HWIO and out is NHWC, as
+// for __xla_cpu_runtime_EigenConv2DF32. `bias` has kernel_filters elements
+// and may be null.
+extern void __xla_cpu_runtime_OneDnnConv2DF32(
+    const void* /* xla::ExecutableRunOptions* */ run_options_ptr, float* out,
+    float* lhs, float* rhs, float* bias, int64_t input_batch,
+    int64_t input_rows, int64_t input_cols, int64_t input_channels,
+    int64_t kernel_rows, int64_t kernel_cols, int64_t kernel_channels,
+    int64_t kernel_filters, int64_t output_rows, int64_t output_cols,
+    int64_t row_stride, int64_t col_stride, int64_t padding_top,
+    int64_t padding_bottom, int64_t padding_left, int64_t padding_right,
+    int64_t rhs_row_dilation, int64_t rhs_col_dilation, int32_t activation);
+}  // extern "C"
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_RUNTIME_ONEDNN_H_
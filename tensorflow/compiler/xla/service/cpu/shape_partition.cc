@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/cpu/shape_partition.h"
 
+#include <numeric>
+
 namespace xla {
 namespace cpu {
 
@@ -85,9 +87,42 @@ std::vector<int64_t> ShapePartitionAssigner::Run(
     }
   }
 
+  if (alignment_bytes_ > 1) {
+    AlignPartitions(outer_dims, &dimension_partition_counts);
+  }
+
   return dimension_partition_counts;
 }
 
+void ShapePartitionAssigner::AlignPartitions(
+    const std::vector<int64_t>& outer_dims,
+    std::vector<int64_t>* dimension_partition_counts) const {
+  // Partition boundaries along dimension 'outer_dims[i]' fall on multiples of
+  // (partition size * stride) elements, where stride is the number of
+  // elements in the dimensions that are more minor than 'outer_dims[i]'.
+  std::vector<int64_t> stride_bytes(shape_.rank());
+  int64_t stride = ShapeUtil::ByteSizeOfPrimitiveType(shape_.element_type());
+  for (int64_t dimension : shape_.layout().minor_to_major()) {
+    stride_bytes[dimension] = stride;
+    stride *= shape_.dimensions(dimension);
+  }
+
+  for (int64_t i = 0; i < outer_dims.size(); ++i) {
+    const int64_t dimension = outer_dims[i];
+    // Partition sizes (in elements of 'dimension') must be a multiple of
+    // 'granule' for boundaries to be aligned.
+    const int64_t granule =
+        alignment_bytes_ / std::gcd(alignment_bytes_, stride_bytes[dimension]);
+    int64_t& partition_count = (*dimension_partition_counts)[i];
+    // ShapePartitionIterator makes all but the last partition
+    // dim_size / partition_count elements large.
+    while (partition_count > 1 &&
+           (shape_.dimensions(dimension) / partition_count) % granule != 0) {
+      --partition_count;
+    }
+  }
+}
+
 int64_t ShapePartitionAssigner::GetTotalPartitionCount(
     const std::vector<int64_t>& dimension_partition_counts) {
   int64_t total_partition_count = 1;
@@ -62,9 +62,25 @@ namespace cpu {
 //
 //     [0, 4), [4, 8), [8, 12), [12, 16)
 //
+// If 'alignment_bytes' is greater than one, partition counts are lowered where
+// needed so that every partition boundary falls on a multiple of
+// 'alignment_bytes' from the start of the buffer.  Passing the cache line size
+// keeps parallel tasks from writing to the same cache line (false sharing).
+//
+// Example 3:
+//
+//   Let 'shape' = f32[8, 4] with layout {1, 0}, 'target_partition_count' = 8
+//   and 'alignment_bytes' = 64.
+//
+//   Each row is 16 bytes, so partitions must span a multiple of 4 rows, which
+//   results in the following partitions of the most-major dimension:
+//
+//     [0, 4), [4, 8)
+//
 class ShapePartitionAssigner {
  public:
-  ShapePartitionAssigner(const Shape& shape) : shape_(shape) {}
+  ShapePartitionAssigner(const Shape& shape, int64_t alignment_bytes = 1)
+      : shape_(shape), alignment_bytes_(alignment_bytes) {}
 
   // Returns dimension partition counts (starting at outer-most dimension).
   std::vector<int64_t> Run(int64_t target_partition_count);
@@ -74,7 +90,14 @@ class ShapePartitionAssigner {
       const std::vector<int64_t>& dimension_partition_counts);
 
  private:
+  // Lowers 'dimension_partition_counts' (for the outer dimensions
+  // 'outer_dims') so that partition boundaries are aligned to
+  // 'alignment_bytes_'.
+  void AlignPartitions(const std::vector<int64_t>& outer_dims,
+                       std::vector<int64_t>* dimension_partition_counts) const;
+
   const Shape& shape_;
+  const int64_t alignment_bytes_;
 };
 
 // ShapePartitionIterator iterates through outer-dimension partitions of
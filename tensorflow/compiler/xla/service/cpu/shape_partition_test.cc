@@ -91,6 +91,23 @@ TEST_F(ShapePartitionAssignerTest, Shape532WithLayout201) {
             expected_partitions);
 }
 
+TEST_F(ShapePartitionAssignerTest, Shape84WithLayout10AlignedToCacheLine) {
+  // Rows are 16 bytes long, so 64 byte aligned partitions span 4 rows.
+  Shape shape = ShapeUtil::MakeShapeWithDenseLayout(F32, {8, 4}, {1, 0});
+  ShapePartitionAssigner assigner(shape, /*alignment_bytes=*/64);
+  EXPECT_THAT(assigner.Run(/*target_partition_count=*/1), Vec({1}));
+  for (int64_t i = 2; i <= 8; ++i) {
+    EXPECT_THAT(assigner.Run(/*target_partition_count=*/i), Vec({2}));
+  }
+}
+
+TEST_F(ShapePartitionAssignerTest, Shape264WithLayout10AlignedToCacheLine) {
+  // Partitions of 32 elements of the minor dimension are 128 bytes long.
+  Shape shape = ShapeUtil::MakeShapeWithDenseLayout(F32, {2, 64}, {1, 0});
+  ShapePartitionAssigner assigner(shape, /*alignment_bytes=*/64);
+  EXPECT_THAT(assigner.Run(/*target_partition_count=*/4), Vec({2, 2}));
+}
+
 class ShapePartitionIteratorTest : public HloTestBase {
  protected:
   typedef std::vector<std::pair<int64_t, int64_t>> Partition;
@@ -79,6 +79,11 @@ class SimpleOrcJIT : public llvm::JITEventListener {
 
   llvm::Error AddModule(llvm::orc::ThreadSafeModule module);
 
+  // Adds an object file compiled outside of the JIT, e.g. one of several parts
+  // of a module that were compiled in parallel. Symbols are resolved across
+  // all modules and object files added to the JIT.
+  llvm::Error AddObjFile(std::unique_ptr<llvm::MemoryBuffer> obj_file);
+
   // Discards objects we no longer need once we are done compiling.
   void DoneCompiling();
 
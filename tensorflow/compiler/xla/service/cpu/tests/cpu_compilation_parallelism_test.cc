@@ -0,0 +1,86 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/tests/cpu_codegen_test.h"
+#include "tensorflow/compiler/xla/xla.pb.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+class CpuCompilationParallelismTest : public CpuCodegenTest {
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = CpuCodegenTest::GetDebugOptionsForTest();
+    // Split the LLVM module and compile the parts on multiple threads.
+    debug_options.set_xla_cpu_force_compilation_parallelism(4);
+    return debug_options;
+  }
+};
+
+TEST_F(CpuCompilationParallelismTest, SubcomputationsAndSharedConstant) {
+  const char* hlo_text = R"(
+HloModule Module
+
+add {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT add = f32[] add(x, y)
+}
+
+max {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT max = f32[] maximum(x, y)
+}
+
+cond {
+  state = (s32[], f32[4,10]) parameter(0)
+  i = s32[] get-tuple-element(state), index=0
+  limit = s32[] constant(3)
+  ROOT lt = pred[] compare(i, limit), direction=LT
+}
+
+body {
+  state = (s32[], f32[4,10]) parameter(0)
+  i = s32[] get-tuple-element(state), index=0
+  one = s32[] constant(1)
+  next_i = s32[] add(i, one)
+  v = f32[4,10] get-tuple-element(state), index=1
+  c0 = f32[4] constant({1, 2, 3, 4})
+  c = f32[4,10] broadcast(c0), dimensions={0}
+  next_v = f32[4,10] add(v, c)
+  ROOT next = (s32[], f32[4,10]) tuple(next_i, next_v)
+}
+
+ENTRY main {
+  p0 = f32[4,8,32] parameter(0)
+  p1 = f32[4,10,32] parameter(1)
+  zero = f32[] constant(0)
+  reduce_0 = f32[4,8] reduce(p0, zero), dimensions={2}, to_apply=add
+  reduce_1 = f32[4,10] reduce(p1, zero), dimensions={2}, to_apply=max
+  i0 = s32[] constant(0)
+  init = (s32[], f32[4,10]) tuple(i0, reduce_1)
+  loop = (s32[], f32[4,10]) while(init), condition=cond, body=body
+  result = f32[4,10] get-tuple-element(loop), index=1
+  ROOT tuple = (f32[4,8], f32[4,10]) tuple(reduce_0, result)
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-5, 1e-5}));
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
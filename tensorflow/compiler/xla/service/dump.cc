@@ -18,7 +18,9 @@ limitations under the License.
 #include <functional>
 #include <memory>
 #include <queue>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
@@ -516,6 +518,51 @@ static void DumpHloModuleMetadata(
   }
 }
 
+// Renders the passes run on a module as folded stacks, one line per pass run
+// with its self time in microseconds. Passes of nested pipelines are recorded
+// while the pipeline pass itself is running, so nesting is recovered from the
+// pass time intervals.
+static std::string HloPassMetadataToFoldedStacks(
+    const HloModuleMetadataProto& metadata) {
+  struct Frame {
+    std::string stack;
+    int64_t end_usec;
+    int64_t self_usec;
+  };
+  std::vector<Frame> frames;
+  // Indices into `frames` of the passes enclosing the current one.
+  std::vector<int64_t> open;
+  for (const HloPassMetadata& pass : metadata.pass_metadata()) {
+    // Skip passes that never finished, e.g. because they failed.
+    if (pass.end_timestamp_usec() < pass.start_timestamp_usec()) continue;
+    while (!open.empty() &&
+           frames[open.back()].end_usec <= pass.start_timestamp_usec()) {
+      open.pop_back();
+    }
+    int64_t duration_usec =
+        pass.end_timestamp_usec() - pass.start_timestamp_usec();
+    std::string stack;
+    if (open.empty()) {
+      stack = StrCat(pass.pipeline_name(), ";", pass.pass_name());
+    } else {
+      Frame& parent = frames[open.back()];
+      parent.self_usec -= duration_usec;
+      stack = StrCat(parent.stack, ";", pass.pass_name());
+    }
+    open.push_back(frames.size());
+    frames.push_back(
+        Frame{std::move(stack), pass.end_timestamp_usec(), duration_usec});
+  }
+
+  std::string folded;
+  for (const Frame& frame : frames) {
+    if (frame.self_usec > 0) {
+      absl::StrAppend(&folded, frame.stack, " ", frame.self_usec, "\n");
+    }
+  }
+  return folded;
+}
+
 static absl::Mutex mu(absl::kConstInit);
 
 // Maps a module's unique ID to a counter indicating how many times we've dumped
@@ -809,6 +856,20 @@ void DumpHloSnapshotIfEnabled(const HloSnapshot& snapshot,
   DumpToFileInDirImpl(filename, pb, canonical_opts);
 }
 
+void DumpHloPassFlameGraphIfEnabled(const HloModule& module) {
+  if (!module.config().debug_options().xla_dump_hlo_pass_flamegraph()) {
+    return;
+  }
+  CanonicalDebugOptions opts(module.config().debug_options());
+  if (!opts.should_dump_module(module.name())) {
+    return;
+  }
+  const HloModuleMetadataProto& metadata = module.metadata().proto();
+  DumpToFileInDirImpl(StrFormat("module_%04d.hlo_passes.folded",
+                                metadata.canonical_module_id()),
+                      HloPassMetadataToFoldedStacks(metadata), opts);
+}
+
 void DumpHloModuleMetadataIfEnabled(const std::vector<HloModule*>& modules) {
   absl::flat_hash_set<int64_t> dumped_module_ids;
   for (const HloModule* module : modules) {
@@ -128,6 +128,11 @@ void DumpHloSnapshotIfEnabled(const HloSnapshot& snapshot,
 
 void DumpHloModuleMetadataIfEnabled(const std::vector<HloModule*>& modules);
 
+// Dumps the wall time of the HLO passes run on `module` so far as folded
+// stacks (one "pipeline;pass;... self_usec" line per pass run), if
+// --xla_dump_hlo_pass_flamegraph is set.
+void DumpHloPassFlameGraphIfEnabled(const HloModule& module);
+
 // Returns true if we should dump data for an HloModule.  This is useful if you
 // want to check if DumpToFileInDir{,OrStdout} will do anything before
 // generating an expensive string.
@@ -0,0 +1,166 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_results_store.h"
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/stream_executor/blas.h"
+#include "tensorflow/compiler/xla/stream_executor/dnn.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/fingerprint.h"
+#include "tensorflow/tsl/platform/path.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+using EntryList = tsl::protobuf::RepeatedPtrField<AutotuneResults::Entry>;
+
+bool MergeEntries(const EntryList& update, EntryList* base) {
+  absl::flat_hash_map<std::pair<absl::string_view, absl::string_view>, int>
+      index;
+  for (int i = 0; i < base->size(); ++i) {
+    const AutotuneResults::Entry& entry = base->Get(i);
+    index[{entry.device(), entry.hlo()}] = i;
+  }
+
+  bool changed = false;
+  bool appended = false;
+  for (const AutotuneResults::Entry& entry : update) {
+    auto it = index.find(std::make_pair(absl::string_view(entry.device()),
+                                        absl::string_view(entry.hlo())));
+    if (it == index.end()) {
+      *base->Add() = entry;
+      changed = appended = true;
+      continue;
+    }
+    AutotuneResults::Entry* existing = base->Mutable(it->second);
+    if (existing->result().SerializeAsString() !=
+        entry.result().SerializeAsString()) {
+      *existing->mutable_result() = entry.result();
+      changed = true;
+    }
+  }
+
+  if (appended) {
+    std::sort(base->pointer_begin(), base->pointer_end(),
+              [](const auto* a, const auto* b) {
+                return std::make_pair(absl::string_view(a->device()),
+                                      absl::string_view(a->hlo())) <
+                       std::make_pair(absl::string_view(b->device()),
+                                      absl::string_view(b->hlo()));
+              });
+  }
+  return changed;
+}
+
+}  // namespace
+
+bool MergeAutotuneResults(const AutotuneResults& update,
+                          AutotuneResults* base) {
+  if (base->version() != update.version()) {
+    *base = update;
+    return true;
+  }
+  bool changed = MergeEntries(update.dots(), base->mutable_dots());
+  changed |= MergeEntries(update.convs(), base->mutable_convs());
+  return changed;
+}
+
+std::string FileAutotuneResultsStore::PathForKey(absl::string_view key) const {
+  // Keys contain spaces and punctuation, so name the file after a fingerprint
+  // of the key rather than the key itself.
+  return tsl::io::JoinPath(
+      directory_, absl::StrCat("autotune_",
+                               absl::Hex(tsl::Fingerprint64(key),
+                                         absl::kZeroPad16),
+                               ".pb"));
+}
+
+StatusOr<std::optional<AutotuneResults>> FileAutotuneResultsStore::Fetch(
+    absl::string_view key) {
+  tsl::Env* env = tsl::Env::Default();
+  std::string path = PathForKey(key);
+  if (!env->FileExists(path).ok()) return std::optional<AutotuneResults>();
+
+  std::string data;
+  TF_RETURN_IF_ERROR(tsl::ReadFileToString(env, path, &data));
+  AutotuneResults results;
+  if (!results.ParseFromString(data)) {
+    return tsl::errors::DataLoss("Failed to parse autotune results in ", path,
+                                 " stored for \"", key, "\".");
+  }
+  return std::optional<AutotuneResults>(std::move(results));
+}
+
+Status FileAutotuneResultsStore::Upload(absl::string_view key,
+                                        const AutotuneResults& results) {
+  TF_ASSIGN_OR_RETURN(std::optional<AutotuneResults> stored, Fetch(key));
+  AutotuneResults merged = stored.value_or(AutotuneResults());
+  if (!MergeAutotuneResults(results, &merged) && stored.has_value()) {
+    VLOG(2) << "No new autotune results to upload for \"" << key << "\"";
+    return OkStatus();
+  }
+
+  tsl::Env* env = tsl::Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory_));
+  std::string path = PathForKey(key);
+  std::string tmp_path = path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return tsl::errors::Internal("Failed to create a temporary file name for ",
+                                 path);
+  }
+  TF_RETURN_IF_ERROR(
+      tsl::WriteStringToFile(env, tmp_path, merged.SerializeAsString()));
+  TF_RETURN_IF_ERROR(env->RenameFile(tmp_path, path));
+  VLOG(1) << "Uploaded " << merged.dots_size() << " dot and "
+          << merged.convs_size() << " conv autotune results for \"" << key
+          << "\" to " << path;
+  return OkStatus();
+}
+
+std::unique_ptr<AutotuneResultsStore> CreateAutotuneResultsStore(
+    const DebugOptions& debug_options) {
+  const std::string& dir = debug_options.xla_gpu_autotune_results_store_dir();
+  if (dir.empty()) return nullptr;
+  return std::make_unique<FileAutotuneResultsStore>(dir);
+}
+
+StatusOr<std::string> AutotuneResultsStoreKey(
+    se::StreamExecutor* stream_exec) {
+  std::string dnn_version = "none";
+  if (se::dnn::DnnSupport* dnn = stream_exec->AsDnn()) {
+    TF_ASSIGN_OR_RETURN(se::dnn::VersionInfo version, dnn->GetVersion());
+    dnn_version = absl::StrCat(version.major_version(), ".",
+                               version.minor_version(), ".", version.patch());
+  }
+  std::string blas_version = "none";
+  if (se::blas::BlasSupport* blas = stream_exec->AsBlas()) {
+    TF_RETURN_IF_ERROR(blas->GetVersion(&blas_version));
+  }
+  return absl::StrCat(stream_exec->GetDeviceDescription().model_str(),
+                      "; dnn ", dnn_version, "; blas ", blas_version);
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,98 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_RESULTS_STORE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_RESULTS_STORE_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/autotune_results.pb.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/compiler/xla/stream_executor/stream_executor_pimpl.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/compiler/xla/xla.pb.h"
+
+namespace xla {
+namespace gpu {
+
+// A place to share autotuning results between hosts, so that a dot/conv only
+// has to be autotuned once per device model and library version instead of
+// once per process.
+//
+// Results are grouped under a key which identifies everything the picked
+// algorithms depend on (see AutotuneResultsStoreKey).  Before autotuning, the
+// compiler fetches the results stored under its key and loads them into the
+// algorithm pickers; afterwards it uploads whatever it has learned.
+class AutotuneResultsStore {
+ public:
+  virtual ~AutotuneResultsStore() = default;
+
+  // Returns the results stored under `key`, or nullopt if there are none.
+  virtual StatusOr<std::optional<AutotuneResults>> Fetch(
+      absl::string_view key) = 0;
+
+  // Merges `results` into the results stored under `key`.  See
+  // MergeAutotuneResults for the semantics.
+  virtual Status Upload(absl::string_view key,
+                        const AutotuneResults& results) = 0;
+};
+
+// An AutotuneResultsStore which keeps one serialized AutotuneResults file per
+// key in `directory`.  Any filesystem supported by tsl::Env works, so pointing
+// several hosts at the same network or cloud storage directory shares results
+// between them.  Uploads are written to a temporary file which is then renamed
+// over the old one, so readers never observe a partially written file; two
+// hosts uploading concurrently may however lose one another's new entries,
+// which only costs a re-autotune later.
+class FileAutotuneResultsStore : public AutotuneResultsStore {
+ public:
+  explicit FileAutotuneResultsStore(std::string directory)
+      : directory_(std::move(directory)) {}
+
+  StatusOr<std::optional<AutotuneResults>> Fetch(
+      absl::string_view key) override;
+  Status Upload(absl::string_view key, const AutotuneResults& results) override;
+
+  // The file in which the results for `key` are stored.
+  std::string PathForKey(absl::string_view key) const;
+
+ private:
+  std::string directory_;
+};
+
+// Returns the store configured by --xla_gpu_autotune_results_store_dir, or
+// nullptr if none is.
+std::unique_ptr<AutotuneResultsStore> CreateAutotuneResultsStore(
+    const DebugOptions& debug_options);
+
+// Returns the key under which results autotuned on `stream_exec` are stored:
+// its device model plus the cuDNN and cuBLAS versions it runs with, since
+// either library changing invalidates the results picked for it.
+StatusOr<std::string> AutotuneResultsStoreKey(se::StreamExecutor* stream_exec);
+
+// Merges the entries of `update` into `base`.  An entry of `update` replaces
+// the entry of `base` for the same device and HLO, if there is one.  The
+// entries of `base` are kept sorted, so merging is deterministic.  If the two
+// have different versions, `base` was written by an incompatible XLA and is
+// replaced by `update` wholesale.  Returns whether `base` changed.
+bool MergeAutotuneResults(const AutotuneResults& update, AutotuneResults* base);
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_RESULTS_STORE_H_
@@ -0,0 +1,112 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_results_store.h"
+
+#include <optional>
+#include <string>
+
+#include "tensorflow/compiler/xla/autotune_results.pb.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/path.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+AutotuneResults::Entry MakeEntry(absl::string_view device,
+                                 absl::string_view hlo, int64_t algorithm) {
+  AutotuneResults::Entry entry;
+  entry.set_device(std::string(device));
+  entry.set_hlo(std::string(hlo));
+  entry.mutable_result()->mutable_gemm()->set_algorithm(algorithm);
+  return entry;
+}
+
+TEST(AutotuneResultsStoreTest, MergeAddsAndReplacesEntries) {
+  AutotuneResults base;
+  base.set_version(1);
+  *base.add_dots() = MakeEntry("sm_80", "dot.2", 1);
+  *base.add_dots() = MakeEntry("sm_80", "dot.3", 2);
+
+  AutotuneResults update;
+  update.set_version(1);
+  *update.add_dots() = MakeEntry("sm_80", "dot.3", 5);
+  *update.add_dots() = MakeEntry("sm_80", "dot.1", 4);
+
+  EXPECT_TRUE(MergeAutotuneResults(update, &base));
+  ASSERT_EQ(base.dots_size(), 3);
+  EXPECT_EQ(base.dots(0).hlo(), "dot.1");
+  EXPECT_EQ(base.dots(0).result().gemm().algorithm(), 4);
+  EXPECT_EQ(base.dots(1).hlo(), "dot.2");
+  EXPECT_EQ(base.dots(1).result().gemm().algorithm(), 1);
+  EXPECT_EQ(base.dots(2).hlo(), "dot.3");
+  EXPECT_EQ(base.dots(2).result().gemm().algorithm(), 5);
+
+  // Merging the same results again is a no-op.
+  EXPECT_FALSE(MergeAutotuneResults(update, &base));
+}
+
+TEST(AutotuneResultsStoreTest, MergeDropsResultsOfOtherVersion) {
+  AutotuneResults base;
+  base.set_version(1);
+  *base.add_dots() = MakeEntry("sm_80", "dot.1", 1);
+
+  AutotuneResults update;
+  update.set_version(2);
+  *update.add_convs() = MakeEntry("sm_80", "conv.1", 3);
+
+  EXPECT_TRUE(MergeAutotuneResults(update, &base));
+  EXPECT_EQ(base.version(), 2);
+  EXPECT_EQ(base.dots_size(), 0);
+  EXPECT_EQ(base.convs_size(), 1);
+}
+
+TEST(AutotuneResultsStoreTest, FileStoreRoundTrip) {
+  std::string dir = tsl::io::JoinPath(tsl::testing::TmpDir(),
+                                      "autotune_results_store_round_trip");
+  FileAutotuneResultsStore store(dir);
+
+  TF_ASSERT_OK_AND_ASSIGN(std::optional<AutotuneResults> fetched,
+                          store.Fetch("sm_80; dnn 8.6.0; blas 11.11.3"));
+  EXPECT_FALSE(fetched.has_value());
+
+  AutotuneResults first;
+  first.set_version(1);
+  *first.add_dots() = MakeEntry("sm_80", "dot.1", 1);
+  TF_ASSERT_OK(store.Upload("sm_80; dnn 8.6.0; blas 11.11.3", first));
+
+  AutotuneResults second;
+  second.set_version(1);
+  *second.add_convs() = MakeEntry("sm_80", "conv.1", 2);
+  TF_ASSERT_OK(store.Upload("sm_80; dnn 8.6.0; blas 11.11.3", second));
+
+  TF_ASSERT_OK_AND_ASSIGN(fetched,
+                          store.Fetch("sm_80; dnn 8.6.0; blas 11.11.3"));
+  ASSERT_TRUE(fetched.has_value());
+  EXPECT_EQ(fetched->dots_size(), 1);
+  EXPECT_EQ(fetched->convs_size(), 1);
+
+  // Results for another library version are kept apart.
+  TF_ASSERT_OK_AND_ASSIGN(fetched,
+                          store.Fetch("sm_80; dnn 8.9.0; blas 11.11.3"));
+  EXPECT_FALSE(fetched.has_value());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,205 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/cuda_graph_thunk.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/hash/hash.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/compiler/xla/service/gpu/buffer_allocations.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+#include "tensorflow/tsl/profiler/lib/scoped_annotation.h"
+
+namespace xla {
+namespace gpu {
+
+using ::tsl::profiler::ScopedAnnotation;
+
+CudaGraphThunk::CudaGraphThunk(ThunkInfo thunk_info, ThunkSequence thunks)
+    : Thunk(Kind::kCudaGraph, thunk_info), thunks_(std::move(thunks)) {}
+
+/*static*/ bool CudaGraphThunk::IsCapturable(const Thunk& thunk) {
+  switch (thunk.kind()) {
+    case Kind::kCopy:
+    case Kind::kGemm:
+    case Kind::kKernel:
+    case Kind::kMemset32BitValue:
+    case Kind::kMemzero:
+    case Kind::kReusableKernel:
+      return true;
+    default:
+      return false;
+  }
+}
+
+std::string CudaGraphThunk::ToStringExtra(int indent) const {
+  std::string result = "\n";
+  absl::StrAppend(&result, thunks().ToString(indent + 1, nullptr));
+  return result;
+}
+
+Status CudaGraphThunk::Initialize(const GpuExecutable& executable,
+                                  se::StreamExecutor* executor) {
+  for (auto& thunk : thunks_) {
+    TF_RETURN_IF_ERROR(thunk->Initialize(executable, executor));
+  }
+
+#if GOOGLE_CUDA
+  absl::MutexLock lock(&mutex_);
+  if (instances_.contains(executor)) return OkStatus();
+
+  // Initialize (with memoization) BlasSupport here because cublasCreate fails
+  // during cuda graph capturing.
+  if (!executor->AsBlas()) {
+    return InternalError("Failed to initialize BLAS support");
+  }
+
+  GraphInstance instance;
+  instance.capture_stream = std::make_unique<se::Stream>(executor);
+  instance.capture_stream->Init();
+  if (!instance.capture_stream->ok()) {
+    return InternalError("Failed to create a stream for graph capture");
+  }
+  instances_.emplace(executor, std::move(instance));
+#endif  // GOOGLE_CUDA
+
+  return OkStatus();
+}
+
+#if GOOGLE_CUDA
+namespace {
+
+size_t HashBufferAddresses(const BufferAllocations& buffer_allocations) {
+  std::vector<const void*> ptrs;
+  ptrs.reserve(buffer_allocations.size());
+  for (BufferAllocation::Index i = 0; i < buffer_allocations.size(); ++i) {
+    ptrs.push_back(buffer_allocations.GetDeviceAddress(i).opaque());
+  }
+  return absl::HashOf(ptrs);
+}
+
+}  // namespace
+#endif  // GOOGLE_CUDA
+
+Status CudaGraphThunk::ExecuteOnStream(const ExecuteParams& params) {
+#if GOOGLE_CUDA
+  se::StreamExecutor* executor = params.stream->parent();
+  size_t ptrs_hash = HashBufferAddresses(*params.buffer_allocations);
+
+  // Graph instances are updated in place, so executions of this thunk on the
+  // same executor are serialized.
+  absl::MutexLock lock(&mutex_);
+  auto it = instances_.find(executor);
+  TF_RET_CHECK(it != instances_.end())
+      << "Initialize() not called for StreamExecutor " << executor;
+  GraphInstance& instance = it->second;
+
+  // If pointers did not change we can run the captured graph.
+  if (instance.exec && instance.ptrs_hash == ptrs_hash) {
+    VLOG(3) << "Execute cached graph instance";
+    return instance.exec.Launch(params.stream);
+  }
+
+  // Otherwise record the sub-thunks on the capture stream. Capturing does not
+  // execute anything, the recorded work only runs when the graph is launched.
+  ExecuteParams capture_params = params;
+  capture_params.stream = instance.capture_stream.get();
+  TF_ASSIGN_OR_RETURN(
+      se::gpu::OwnedCudaGraph graph,
+      se::gpu::CaptureCudaGraph(capture_params.stream, [&]() -> Status {
+        for (const auto& thunk : thunks_) {
+          ScopedAnnotation annotation(
+              [&] { return thunk->profile_annotation(); });
+          TF_RETURN_IF_ERROR(thunk->ExecuteOnStream(capture_params));
+        }
+        return OkStatus();
+      }));
+
+  if (instance.exec) {
+    VLOG(3) << "Update cached graph instance";
+    TF_RETURN_IF_ERROR(instance.exec.Update(std::move(graph)));
+  } else {
+    VLOG(3) << "Instantiate graph instance";
+    TF_ASSIGN_OR_RETURN(instance.exec,
+                        se::gpu::InstantiateCudaGraph(std::move(graph)));
+  }
+  instance.ptrs_hash = ptrs_hash;
+
+  return instance.exec.Launch(params.stream);
+#else   // GOOGLE_CUDA
+  for (const auto& thunk : thunks_) {
+    ScopedAnnotation annotation([&] { return thunk->profile_annotation(); });
+    TF_RETURN_IF_ERROR(thunk->ExecuteOnStream(params));
+  }
+  return OkStatus();
+#endif  // GOOGLE_CUDA
+}
+
+namespace {
+
+// Builds the ThunkInfo of a CudaGraphThunk wrapping `thunks`. The graph is
+// launched as a single unit, so it is annotated with the annotations of all
+// sub-thunks, and keeps the position of the first one in the profile.
+Thunk::ThunkInfo GetCudaGraphThunkInfo(const ThunkSequence& thunks) {
+  Thunk::ThunkInfo thunk_info(thunks.front()->op());
+  thunk_info.profile_index = thunks.front()->profile_index();
+  std::vector<std::string> annotations;
+  annotations.reserve(thunks.size());
+  for (const auto& thunk : thunks) {
+    annotations.push_back(thunk->profile_annotation());
+  }
+  thunk_info.profile_annotation = absl::StrJoin(annotations, ";");
+  return thunk_info;
+}
+
+}  // namespace
+
+void OutlineCudaGraphThunks(ThunkSequence* thunk_sequence) {
+  ThunkSequence outlined;
+  ThunkSequence run;
+
+  auto flush_run = [&] {
+    if (run.size() < 2) {
+      for (auto& thunk : run) outlined.push_back(std::move(thunk));
+    } else {
+      VLOG(2) << "Outlining " << run.size() << " thunks into a CUDA graph";
+      outlined.push_back(std::make_unique<CudaGraphThunk>(
+          GetCudaGraphThunkInfo(run), std::move(run)));
+    }
+    run = ThunkSequence();
+  };
+
+  for (auto& thunk : *thunk_sequence) {
+    if (CudaGraphThunk::IsCapturable(*thunk)) {
+      run.push_back(std::move(thunk));
+    } else {
+      flush_run();
+      outlined.push_back(std::move(thunk));
+    }
+  }
+  flush_run();
+
+  *thunk_sequence = std::move(outlined);
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,96 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_CUDA_GRAPH_THUNK_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_CUDA_GRAPH_THUNK_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/compiler/xla/service/gpu/thunk.h"
+#include "tensorflow/compiler/xla/stream_executor/stream_executor.h"
+
+#if GOOGLE_CUDA
+#include "tensorflow/compiler/xla/stream_executor/cuda/cuda_graph.h"
+#endif  // GOOGLE_CUDA
+
+namespace xla {
+namespace gpu {
+
+// A thunk that records a sequence of device-only sub-thunks (kernel launches,
+// gemms, device-to-device copies and memsets) into a CUDA graph on first
+// execution, and afterwards launches the whole sequence with a single graph
+// launch. If the buffer addresses change between executions, the graph is
+// re-captured and the instantiated graph is updated in place.
+//
+// Without CUDA the sub-thunks are executed sequentially.
+class CudaGraphThunk : public Thunk {
+ public:
+  CudaGraphThunk(ThunkInfo thunk_info, ThunkSequence thunks);
+  CudaGraphThunk(const CudaGraphThunk&) = delete;
+  CudaGraphThunk& operator=(const CudaGraphThunk&) = delete;
+
+  // Returns true if `thunk` only enqueues device work on the stream it is
+  // executed on, and therefore can be recorded into a CUDA graph.
+  static bool IsCapturable(const Thunk& thunk);
+
+  ThunkSequence& thunks() { return thunks_; }
+  const ThunkSequence& thunks() const { return thunks_; }
+  std::string ToStringExtra(int indent) const override;
+
+  void ClearCompileTimeInfo() override {
+    Thunk::ClearCompileTimeInfo();
+    for (auto& thunk : thunks_) thunk->ClearCompileTimeInfo();
+  }
+
+  Status Initialize(const GpuExecutable& executable,
+                    se::StreamExecutor* executor) override;
+  Status ExecuteOnStream(const ExecuteParams& params) override;
+
+ private:
+  // The list of sub-thunks.
+  ThunkSequence thunks_;
+
+#if GOOGLE_CUDA
+  struct GraphInstance {
+    // Stream the graph is captured on. We never capture on the stream passed
+    // to ExecuteOnStream because we do not want to accidentally record
+    // concurrent launches from other executables sharing it.
+    std::unique_ptr<se::Stream> capture_stream;
+    // Hash of the buffer addresses the graph was captured with.
+    size_t ptrs_hash = 0;
+    // Instantiated graph, null until the first capture.
+    se::gpu::OwnedCudaGraphExec exec;
+  };
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<se::StreamExecutor*, GraphInstance> instances_
+      ABSL_GUARDED_BY(mutex_);
+#endif  // GOOGLE_CUDA
+};
+
+// Replaces every run of at least two consecutive capturable thunks in
+// `thunk_sequence` with a CudaGraphThunk executing them. Thunks that involve
+// the host or other streams (infeed/outfeed, collectives, custom calls,
+// control flow) keep running individually between the graphs.
+void OutlineCudaGraphThunks(ThunkSequence* thunk_sequence);
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_CUDA_GRAPH_THUNK_H_
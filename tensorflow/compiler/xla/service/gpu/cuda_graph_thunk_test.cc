@@ -0,0 +1,162 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/cuda_graph_thunk.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/compiler/xla/service/gpu/buffer_allocations.h"
+#include "tensorflow/compiler/xla/service/gpu/thunk.h"
+#include "tensorflow/compiler/xla/service/service_executable_run_options.h"
+#include "tensorflow/compiler/xla/stream_executor/stream_executor.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+using ::testing::ElementsAre;
+
+// A thunk of an arbitrary kind that appends its name to `executed` when run.
+class FakeThunk : public Thunk {
+ public:
+  FakeThunk(Kind kind, std::string name, std::vector<std::string>* executed)
+      : Thunk(kind, MakeThunkInfo(name)),
+        name_(std::move(name)),
+        executed_(executed) {}
+
+  Status ExecuteOnStream(const ExecuteParams& params) override {
+    executed_->push_back(name_);
+    return OkStatus();
+  }
+
+  const std::string& name() const { return name_; }
+
+ private:
+  static ThunkInfo MakeThunkInfo(const std::string& name) {
+    ThunkInfo thunk_info(/*op=*/nullptr);
+    thunk_info.profile_annotation = name;
+    return thunk_info;
+  }
+
+  std::string name_;
+  std::vector<std::string>* executed_;
+};
+
+// Returns a description of `thunks`: the name of every fake thunk, with the
+// sub-thunks of CUDA graphs enclosed in braces.
+std::vector<std::string> Describe(const ThunkSequence& thunks) {
+  std::vector<std::string> result;
+  for (const auto& thunk : thunks) {
+    if (thunk->kind() != Thunk::kCudaGraph) {
+      result.push_back(static_cast<const FakeThunk&>(*thunk).name());
+      continue;
+    }
+    std::string graph = "{";
+    for (const auto& sub_thunk :
+         static_cast<const CudaGraphThunk&>(*thunk).thunks()) {
+      if (graph.size() > 1) graph += ",";
+      graph += static_cast<const FakeThunk&>(*sub_thunk).name();
+    }
+    result.push_back(graph + "}");
+  }
+  return result;
+}
+
+class CudaGraphThunkTest : public ::testing::Test {
+ protected:
+  void Add(Thunk::Kind kind, std::string name) {
+    thunks_.push_back(
+        std::make_unique<FakeThunk>(kind, std::move(name), &executed_));
+  }
+
+  ThunkSequence thunks_;
+  std::vector<std::string> executed_;
+};
+
+TEST_F(CudaGraphThunkTest, IsCapturable) {
+  std::vector<std::string> executed;
+  EXPECT_TRUE(CudaGraphThunk::IsCapturable(
+      FakeThunk(Thunk::kKernel, "kernel", &executed)));
+  EXPECT_TRUE(CudaGraphThunk::IsCapturable(
+      FakeThunk(Thunk::kMemzero, "memzero", &executed)));
+  EXPECT_FALSE(CudaGraphThunk::IsCapturable(
+      FakeThunk(Thunk::kInfeed, "infeed", &executed)));
+  EXPECT_FALSE(CudaGraphThunk::IsCapturable(
+      FakeThunk(Thunk::kCustomCall, "custom_call", &executed)));
+}
+
+TEST_F(CudaGraphThunkTest, LeavesLoneCapturableThunkAlone) {
+  Add(Thunk::kInfeed, "infeed");
+  Add(Thunk::kKernel, "kernel");
+  Add(Thunk::kOutfeed, "outfeed");
+  OutlineCudaGraphThunks(&thunks_);
+  EXPECT_THAT(Describe(thunks_), ElementsAre("infeed", "kernel", "outfeed"));
+}
+
+TEST_F(CudaGraphThunkTest, NonCapturableThunksSplitRuns) {
+  Add(Thunk::kKernel, "k0");
+  Add(Thunk::kGemm, "g0");
+  Add(Thunk::kCustomCall, "custom_call");
+  Add(Thunk::kMemzero, "m0");
+  Add(Thunk::kCopy, "c0");
+  Add(Thunk::kKernel, "k1");
+  Add(Thunk::kInfeed, "infeed");
+  Add(Thunk::kKernel, "k2");
+  OutlineCudaGraphThunks(&thunks_);
+  EXPECT_THAT(Describe(thunks_), ElementsAre("{k0,g0}", "custom_call",
+                                             "{m0,c0,k1}", "infeed", "k2"));
+}
+
+TEST_F(CudaGraphThunkTest, CarriesSubThunkAnnotations) {
+  Add(Thunk::kKernel, "k0");
+  Add(Thunk::kMemzero, "m0");
+  OutlineCudaGraphThunks(&thunks_);
+  ASSERT_EQ(thunks_.size(), 1);
+  EXPECT_EQ(thunks_[0]->profile_annotation(), "k0;m0");
+}
+
+#if !GOOGLE_CUDA
+TEST_F(CudaGraphThunkTest, ExecutesSubThunksInOrderWithoutCuda) {
+  Add(Thunk::kKernel, "k0");
+  Add(Thunk::kMemzero, "m0");
+  Add(Thunk::kGemm, "g0");
+  OutlineCudaGraphThunks(&thunks_);
+  ASSERT_EQ(thunks_.size(), 1);
+
+  se::Platform* platform =
+      se::MultiPlatformManager::PlatformWithName("Host").value();
+  se::StreamExecutor* executor = platform->ExecutorForDevice(0).value();
+  se::Stream stream(executor);
+  stream.Init();
+  ServiceExecutableRunOptions run_options;
+  BufferAllocations buffer_allocations({}, /*device_ordinal=*/0,
+                                       /*memory_allocator=*/nullptr);
+  Thunk::ExecuteParams params(run_options, buffer_allocations, &stream,
+                              /*async_comms_stream=*/nullptr);
+
+  TF_ASSERT_OK(thunks_[0]->ExecuteOnStream(params));
+  TF_ASSERT_OK(thunks_[0]->ExecuteOnStream(params));
+  EXPECT_THAT(executed_, ElementsAre("k0", "m0", "g0", "k0", "m0", "g0"));
+}
+#endif  // !GOOGLE_CUDA
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -42,10 +42,12 @@ class FusionInstructionMerger {
  public:
   explicit FusionInstructionMerger(HloComputation* computation,
                                    const GpuDeviceInfo& d,
-                                   HloCostAnalysis::ShapeSizeFunction f)
+                                   HloCostAnalysis::ShapeSizeFunction f,
+                                   const FusionProfile* fusion_profile)
       : computation_(computation),
         shape_size_function_(f),
         gpu_device_info_(d),
+        fusion_profile_(fusion_profile),
         dump_fusion_visualization_(computation->parent()
                                        ->config()
                                        .debug_options()
@@ -66,6 +68,7 @@ class FusionInstructionMerger {
   std::optional<GpuHloCostAnalysis> cost_analysis_;
   FusionInfoCache fusion_info_cache_;
   const GpuDeviceInfo& gpu_device_info_;
+  const FusionProfile* fusion_profile_;
   bool changed_ = false;
   bool dump_fusion_visualization_ = false;
 
@@ -79,6 +82,7 @@ class FusionInstructionMerger {
   int num_fail_fusion_too_large_ = 0;
   int num_fail_uncoalesced_read_ = 0;
   int num_fail_slower_if_fused_ = 0;
+  int num_fail_profiled_slower_ = 0;
 
   FusionInstructionMerger(const FusionInstructionMerger&) = delete;
   FusionInstructionMerger& operator=(const FusionInstructionMerger&) = delete;
@@ -170,6 +174,7 @@ Status FusionInstructionMerger::Run() {
           << " inefficient_fusion_emitter: "
           << num_fail_inefficient_fusion_emitter_
           << " slower_if_fused: " << num_fail_slower_if_fused_
+          << " profiled_slower: " << num_fail_profiled_slower_
           << " fusion_too_large: " << num_fail_fusion_too_large_ << " }";
   return OkStatus();
 }
@@ -248,6 +253,23 @@ FusionDecision FusionInstructionMerger::ShouldFuse(HloInstruction* producer) {
     }
   }
 
+  // Merges that were measured before take precedence over the performance
+  // model below.
+  bool profiled_as_profitable = false;
+  if (fusion_profile_ != nullptr) {
+    profiled_as_profitable = true;
+    for (const HloInstruction* user : producer->users()) {
+      FusionProfile::Verdict verdict =
+          fusion_profile_->Lookup(*producer, *user);
+      if (verdict == FusionProfile::Verdict::kUnprofitable) {
+        ++num_fail_profiled_slower_;
+        return FusionDecision{} << "merged with " << user->name()
+                                << " ran slower than estimated when profiled";
+      }
+      profiled_as_profitable &= verdict == FusionProfile::Verdict::kProfitable;
+    }
+  }
+
   if (!cost_analysis_) {
     VLOG(2) << "Running full HLO cost analysis for " << computation_->name();
     cost_analysis_.emplace(
@@ -265,6 +287,10 @@ FusionDecision FusionInstructionMerger::ShouldFuse(HloInstruction* producer) {
     }
   }
 
+  if (profiled_as_profitable) {
+    return {};
+  }
+
   GpuPerformanceModel::RunTimes t = GpuPerformanceModel::EstimateRunTimes(
       producer, &*cost_analysis_, gpu_device_info_, producer->users(),
       /*multi_output=*/false);
@@ -288,7 +314,8 @@ StatusOr<bool> FusionMerger::Run(
     XLA_VLOG_LINES(9, computation->ToString());
 
     FusionInstructionMerger fusion_merger(computation, gpu_device_info_,
-                                          shape_size_function_);
+                                          shape_size_function_,
+                                          fusion_profile_);
     TF_RETURN_IF_ERROR(fusion_merger.Run());
     changed |= fusion_merger.changed();
 
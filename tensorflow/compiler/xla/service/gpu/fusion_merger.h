@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSION_MERGER_H_
 
 #include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
+#include "tensorflow/compiler/xla/service/gpu/fusion_profile.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
@@ -61,9 +62,15 @@ namespace gpu {
 
 class FusionMerger : public HloModulePass {
  public:
+  // If `fusion_profile` is given, merges it found unprofitable are not made,
+  // and the ones it found profitable are made regardless of their estimated
+  // run time.
   explicit FusionMerger(const GpuDeviceInfo& d,
-                        HloCostAnalysis::ShapeSizeFunction f)
-      : gpu_device_info_(d), shape_size_function_(f) {}
+                        HloCostAnalysis::ShapeSizeFunction f,
+                        const FusionProfile* fusion_profile = nullptr)
+      : gpu_device_info_(d),
+        shape_size_function_(f),
+        fusion_profile_(fusion_profile) {}
   absl::string_view name() const override { return "fusion_merger"; }
 
   using HloPassInterface::Run;
@@ -74,6 +81,7 @@ class FusionMerger : public HloModulePass {
  private:
   const GpuDeviceInfo gpu_device_info_;
   HloCostAnalysis::ShapeSizeFunction shape_size_function_;
+  const FusionProfile* fusion_profile_;
 };
 
 }  // namespace gpu
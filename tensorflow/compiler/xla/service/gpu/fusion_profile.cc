@@ -0,0 +1,142 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/fusion_profile.h"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/time/time.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_performance_model.h"
+#include "tensorflow/compiler/xla/service/hlo_module_config.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+
+/*static*/ StatusOr<std::unique_ptr<FusionProfile>> FusionProfile::Create(
+    const ProfiledInstructionsProto& proto,
+    const GpuDeviceInfo& gpu_device_info,
+    const HloCostAnalysis::ShapeSizeFunction& shape_size) {
+  if (!proto.has_hlo_module()) {
+    return InvalidArgument(
+        "A fusion profile needs the module it was recorded on.");
+  }
+  TF_ASSIGN_OR_RETURN(HloModuleConfig config,
+                      HloModule::CreateModuleConfigFromProto(
+                          proto.hlo_module(), DebugOptions()));
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<HloModule> module,
+                      HloModule::CreateFromProto(proto.hlo_module(), config));
+
+  absl::flat_hash_map<std::string, absl::Duration> measured;
+  for (const ProfiledInstructionsProto::Instruction& instr :
+       proto.instructions()) {
+    measured[instr.name()] = absl::Microseconds(instr.duration_us());
+  }
+
+  auto profile = absl::WrapUnique(new FusionProfile());
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    GpuHloCostAnalysis cost_analysis(GpuHloCostAnalysis::Options{
+        shape_size, /*per_second_rates=*/{},
+        /*count_multiple_input_accesses=*/true});
+    TF_RETURN_IF_ERROR(computation->Accept(&cost_analysis));
+    for (const HloInstruction* fusion : computation->instructions()) {
+      auto it = measured.find(fusion->name());
+      if (fusion->opcode() != HloOpcode::kFusion || it == measured.end()) {
+        continue;
+      }
+      absl::Duration estimated =
+          GpuPerformanceModel::EstimateRunTimes(fusion, &cost_analysis,
+                                                gpu_device_info)
+              .time_unfused;
+      bool profitable = it->second <= estimated * kSlowdownThreshold;
+      VLOG(2) << "Fusion " << fusion->name() << " ran in " << it->second
+              << ", estimated " << estimated
+              << (profitable ? "" : "; unprofitable");
+      int64_t index = profile->profitable_.size();
+      profile->profitable_.push_back(profitable);
+      for (const HloInstruction* fused : fusion->fused_instructions()) {
+        if (fused->opcode() != HloOpcode::kParameter) {
+          profile->fusions_by_name_[fused->name()].push_back(index);
+        }
+      }
+    }
+  }
+  return profile;
+}
+
+/*static*/ StatusOr<std::unique_ptr<FusionProfile>> FusionProfile::Load(
+    const std::string& path, const GpuDeviceInfo& gpu_device_info,
+    const HloCostAnalysis::ShapeSizeFunction& shape_size) {
+  ProfiledInstructionsProto proto;
+  TF_RETURN_IF_ERROR(
+      tsl::ReadTextOrBinaryProto(tsl::Env::Default(), path, &proto));
+  return Create(proto, gpu_device_info, shape_size);
+}
+
+std::vector<int64_t> FusionProfile::FusionsContaining(
+    const HloInstruction& instr) const {
+  std::vector<int64_t> fusions;
+  auto add = [&](const HloInstruction& contained) {
+    auto it = fusions_by_name_.find(contained.name());
+    if (it != fusions_by_name_.end()) {
+      fusions.insert(fusions.end(), it->second.begin(), it->second.end());
+    }
+  };
+  if (instr.opcode() == HloOpcode::kFusion) {
+    for (const HloInstruction* fused : instr.fused_instructions()) {
+      add(*fused);
+    }
+  } else {
+    add(instr);
+  }
+  absl::c_sort(fusions);
+  fusions.erase(std::unique(fusions.begin(), fusions.end()), fusions.end());
+  return fusions;
+}
+
+FusionProfile::Verdict FusionProfile::Lookup(const HloInstruction& a,
+                                             const HloInstruction& b) const {
+  std::vector<int64_t> a_fusions = FusionsContaining(a);
+  std::vector<int64_t> b_fusions = FusionsContaining(b);
+  std::vector<int64_t> common;
+  absl::c_set_intersection(a_fusions, b_fusions, std::back_inserter(common));
+  if (common.empty()) {
+    return Verdict::kUnknown;
+  }
+  return absl::c_all_of(common, [&](int64_t i) { return profitable_[i]; })
+             ? Verdict::kProfitable
+             : Verdict::kUnprofitable;
+}
+
+int64_t FusionProfile::num_unprofitable_fusions() const {
+  return absl::c_count(profitable_, false);
+}
+
+}  // namespace gpu
+}  // namespace xla
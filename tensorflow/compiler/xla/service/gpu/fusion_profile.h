@@ -0,0 +1,94 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSION_PROFILE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSION_PROFILE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/compiler/xla/xla.pb.h"
+
+namespace xla {
+namespace gpu {
+
+// Measured run times of the fusions of an earlier compilation of a module,
+// used by the fusion passes to correct their static heuristics.
+//
+// The profile holds the durations of the fusion instructions of the profiled
+// executable together with its optimized module.  Fused instructions keep the
+// names of the instructions they were made from, and those names are stable
+// across compilations of the same module, so a profiled fusion is identified
+// by the names of the instructions it contains.
+//
+// A profiled fusion that ran more than kSlowdownThreshold times slower than
+// the GPU performance model estimates, e.g. because its kernel spills
+// registers or lost parallelism, is unprofitable: the fusion passes won't form
+// it again, so it is split into the fusions the heuristics make without it.
+// The other profiled fusions are profitable, and are formed even where the
+// performance model predicts a slowdown.
+class FusionProfile {
+ public:
+  static constexpr double kSlowdownThreshold = 1.5;
+
+  enum class Verdict {
+    // No profiled fusion contains both instructions.
+    kUnknown,
+    kProfitable,
+    kUnprofitable,
+  };
+
+  // `proto.hlo_module()` must be the module the profile was recorded on.
+  static StatusOr<std::unique_ptr<FusionProfile>> Create(
+      const ProfiledInstructionsProto& proto,
+      const GpuDeviceInfo& gpu_device_info,
+      const HloCostAnalysis::ShapeSizeFunction& shape_size);
+
+  // Reads a text or binary ProfiledInstructionsProto from `path`.
+  static StatusOr<std::unique_ptr<FusionProfile>> Load(
+      const std::string& path, const GpuDeviceInfo& gpu_device_info,
+      const HloCostAnalysis::ShapeSizeFunction& shape_size);
+
+  // Returns what the profile says about fusing `a` and `b`, either of which
+  // may be a fusion already.
+  Verdict Lookup(const HloInstruction& a, const HloInstruction& b) const;
+
+  int64_t num_unprofitable_fusions() const;
+
+ private:
+  FusionProfile() = default;
+
+  // Indices of the profiled fusions containing `instr` or, if it is a fusion,
+  // any of its fused instructions.
+  std::vector<int64_t> FusionsContaining(const HloInstruction& instr) const;
+
+  // Whether each profiled fusion is profitable.
+  std::vector<bool> profitable_;
+  // The profiled fusions each instruction of the profiled module was fused
+  // into, by instruction name.  Duplicated instructions are in several.
+  absl::flat_hash_map<std::string, std::vector<int64_t>> fusions_by_name_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSION_PROFILE_H_
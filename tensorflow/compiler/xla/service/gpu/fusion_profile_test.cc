@@ -0,0 +1,129 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/fusion_profile.h"
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/hlo/utils/hlo_matchers.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_device_info_for_tests.h"
+#include "tensorflow/compiler/xla/service/gpu/instruction_fusion.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/compiler/xla/xla.pb.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+// The optimized module of the profiled run, with `exp` and `neg` fused.
+constexpr absl::string_view kProfiledHlo = R"(
+HloModule m
+
+fused_computation {
+  p = f32[1024] parameter(0)
+  exp = f32[1024] exponential(p)
+  ROOT neg = f32[1024] negate(exp)
+}
+
+ENTRY e {
+  p0 = f32[1024] parameter(0)
+  ROOT fusion = f32[1024] fusion(p0), kind=kLoop, calls=fused_computation
+})";
+
+// The same module before fusion.
+constexpr absl::string_view kHlo = R"(
+HloModule m
+
+ENTRY e {
+  p0 = f32[1024] parameter(0)
+  exp = f32[1024] exponential(p0)
+  ROOT neg = f32[1024] negate(exp)
+})";
+
+class FusionProfileTest : public HloTestBase {
+ protected:
+  StatusOr<std::unique_ptr<FusionProfile>> CreateProfile(
+      double fusion_duration_us) {
+    TF_ASSIGN_OR_RETURN(auto profiled_module,
+                        ParseAndReturnVerifiedModule(kProfiledHlo));
+    ProfiledInstructionsProto proto;
+    ProfiledInstructionsProto::Instruction* instr = proto.add_instructions();
+    instr->set_name("fusion");
+    instr->set_duration_us(fusion_duration_us);
+    *proto.mutable_hlo_module() = profiled_module->ToProto();
+    return FusionProfile::Create(proto, device_info_, ShapeSize);
+  }
+
+  static int64_t ShapeSize(const Shape& shape) {
+    return ShapeUtil::ByteSizeOf(shape, /*pointer_size=*/8);
+  }
+
+  const GpuDeviceInfo device_info_ = TestGpuDeviceInfo::RTXA6000DeviceInfo();
+};
+
+TEST_F(FusionProfileTest, SlowFusionIsUnprofitable) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHlo));
+  TF_ASSERT_OK_AND_ASSIGN(auto profile, CreateProfile(1000));
+  EXPECT_EQ(profile->num_unprofitable_fusions(), 1);
+
+  const HloInstruction* exp = FindInstruction(module.get(), "exp");
+  const HloInstruction* neg = FindInstruction(module.get(), "neg");
+  EXPECT_EQ(profile->Lookup(*exp, *neg),
+            FusionProfile::Verdict::kUnprofitable);
+  EXPECT_EQ(profile->Lookup(*exp->operand(0), *exp),
+            FusionProfile::Verdict::kUnknown);
+}
+
+TEST_F(FusionProfileTest, FastFusionIsProfitable) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHlo));
+  TF_ASSERT_OK_AND_ASSIGN(auto profile, CreateProfile(1));
+  EXPECT_EQ(profile->num_unprofitable_fusions(), 0);
+  EXPECT_EQ(profile->Lookup(*FindInstruction(module.get(), "exp"),
+                            *FindInstruction(module.get(), "neg")),
+            FusionProfile::Verdict::kProfitable);
+}
+
+TEST_F(FusionProfileTest, RequiresProfiledModule) {
+  ProfiledInstructionsProto proto;
+  EXPECT_FALSE(FusionProfile::Create(proto, device_info_, ShapeSize).ok());
+}
+
+TEST_F(FusionProfileTest, InstructionFusionSkipsUnprofitableFusion) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHlo));
+  TF_ASSERT_OK_AND_ASSIGN(auto profile, CreateProfile(1000));
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool changed, GpuInstructionFusion(/*may_duplicate=*/true, device_info_,
+                                         profile.get())
+                        .Run(module.get()));
+  EXPECT_FALSE(changed);
+
+  TF_ASSERT_OK_AND_ASSIGN(profile, CreateProfile(1));
+  TF_ASSERT_OK_AND_ASSIGN(
+      changed, GpuInstructionFusion(/*may_duplicate=*/true, device_info_,
+                                    profile.get())
+                   .Run(module.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_THAT(module->entry_computation()->root_instruction(),
+              op::Fusion(op::Parameter(0)));
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -70,6 +70,21 @@ bool IsTritonSupportedInputType(
   }
 }
 
+// Data types that are tested to work as outputs of the triton GEMM emitter.
+bool IsTritonSupportedOutputType(
+    PrimitiveType t, se::CudaComputeCapability cuda_compute_capability) {
+  switch (t) {
+    case F16:
+    case F32:
+      return true;
+    case BF16:
+      return cuda_compute_capability.IsAtLeast(
+          stream_executor::CudaComputeCapability::AMPERE);
+    default:
+      return false;
+  }
+}
+
 Status RequireTritonFusibleConvert(
     const HloInstruction* input,
     se::CudaComputeCapability cuda_compute_capability) {
@@ -342,6 +357,57 @@ Status TryToFuse(const HloInstruction* hlo, DimensionOrder& dim_order,
   return RequireTritonGemmSupportedDimOrder(dim_order);
 }
 
+// Tells if `hlo`, the only user of the dot() result or of an already fused
+// epilogue instruction, can be applied by the triton GEMM emitter to the
+// output tile. Its other operands have to be either tensors of the output
+// shape, broadcasted scalar constants or vectors broadcasted along one of the
+// non-contracting dimensions of the output (biases).
+bool IsTritonFusibleEpilogue(
+    const HloInstruction& hlo, const HloInstruction& dot,
+    const se::CudaComputeCapability cuda_compute_capability) {
+  if (!ShapeUtil::EqualIgnoringElementType(hlo.shape(), dot.shape()) ||
+      !IsTritonSupportedOutputType(hlo.shape().element_type(),
+                                   cuda_compute_capability)) {
+    return false;
+  }
+  switch (hlo.opcode()) {
+    case HloOpcode::kConvert:
+    case HloOpcode::kNegate:
+      return true;
+    case HloOpcode::kAdd:
+    case HloOpcode::kSubtract:
+    case HloOpcode::kMultiply:
+    case HloOpcode::kDivide:
+    case HloOpcode::kMaximum:
+    case HloOpcode::kMinimum:
+      break;
+    default:
+      return false;
+  }
+  const int64_t batch_size =
+      dot.dot_dimension_numbers().lhs_batch_dimensions_size();
+  for (const HloInstruction* operand : hlo.operands()) {
+    if (ShapeUtil::EqualIgnoringElementType(operand->shape(), dot.shape())) {
+      continue;
+    }
+    if (operand->opcode() != HloOpcode::kBroadcast) {
+      return false;
+    }
+    const HloInstruction* input = operand->operand(0);
+    if (ShapeUtil::IsScalar(input->shape()) &&
+        input->opcode() == HloOpcode::kConstant) {
+      continue;
+    }
+    // Output dimensions are: optional batch, LHS and RHS non-contracting.
+    if (input->shape().rank() != 1 ||
+        (operand->dimensions(0) != batch_size &&
+         operand->dimensions(0) != batch_size + 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // Extracts into fused computations parts of HLO graph including dot()
 // operations that can target the triton GEMM emitter.
 class GemmRewriterTritonVisitor : public DfsHloRewriteVisitor {
@@ -357,8 +423,6 @@ class GemmRewriterTritonVisitor : public DfsHloRewriteVisitor {
       return OkStatus();
     }
 
-    // TODO(b/266857789): also fuse convert(dot()) at output if present:
-    // seen on s8xf32->bf16
     std::string suggested_name = absl::StrCat("triton_gemm_", dot->name());
     HloComputation::Builder builder(suggested_name);
     // Original instruction -> fused one.
@@ -366,6 +430,15 @@ class GemmRewriterTritonVisitor : public DfsHloRewriteVisitor {
         old_to_new_mapping;
     absl::flat_hash_set<const HloInstruction*> visited;
     std::vector<HloInstruction*> call_operands;
+    // Makes `hlo` an operand of the fusion.
+    auto add_parameter = [&](HloInstruction* hlo) {
+      HloInstruction* parameter =
+          builder.AddInstruction(HloInstruction::CreateParameter(
+              call_operands.size(), hlo->shape(),
+              absl::StrCat("parameter_", call_operands.size())));
+      call_operands.push_back(hlo);
+      return parameter;
+    };
     // Traverse and fuse dot() inputs bottom-up starting from direct operands.
     // If an input is not fusible stop there and make it a parameter of the new
     // fusion, otherwise put it onto stack and check its own inputs first.
@@ -418,11 +491,7 @@ class GemmRewriterTritonVisitor : public DfsHloRewriteVisitor {
       if (top_is_ready_to_fuse) {
         if (hlo->opcode() == HloOpcode::kParameter ||
             hlo->opcode() == HloOpcode::kGetTupleElement) {
-          old_to_new_mapping[hlo] =
-              builder.AddInstruction(HloInstruction::CreateParameter(
-                  call_operands.size(), hlo->shape(),
-                  absl::StrCat("parameter_", call_operands.size())));
-          call_operands.push_back(hlo);
+          old_to_new_mapping[hlo] = add_parameter(hlo);
         } else {
           std::vector<HloInstruction*> hlo_new_operands;
           for (HloInstruction* operand : hlo->operands()) {
@@ -430,11 +499,7 @@ class GemmRewriterTritonVisitor : public DfsHloRewriteVisitor {
             if (iter != old_to_new_mapping.end()) {
               hlo_new_operands.push_back(iter->second);
             } else {
-              hlo_new_operands.push_back(
-                  builder.AddInstruction(HloInstruction::CreateParameter(
-                      call_operands.size(), operand->shape(),
-                      absl::StrCat("parameter_", call_operands.size()))));
-              call_operands.push_back(operand);
+              hlo_new_operands.push_back(add_parameter(operand));
             }
           }
           old_to_new_mapping[hlo] = builder.AddInstruction(
@@ -443,23 +508,56 @@ class GemmRewriterTritonVisitor : public DfsHloRewriteVisitor {
         to_fuse.pop();
       }
     }
+    // Fuse the chain of elementwise instructions consuming the dot() result,
+    // so that it gets applied to the output tile instead of making another
+    // round trip through memory.
+    HloInstruction* fusion_output = dot;
+    while (fusion_output->user_count() == 1 &&
+           IsTritonFusibleEpilogue(*fusion_output->users()[0], *dot,
+                                   cuda_compute_capability_)) {
+      HloInstruction* user = fusion_output->users()[0];
+      VLOG(3) << "Fusing " << user->ToString();
+      std::vector<HloInstruction*> user_new_operands;
+      for (HloInstruction* operand : user->mutable_operands()) {
+        if (operand == fusion_output) {
+          user_new_operands.push_back(old_to_new_mapping.at(operand));
+        } else if (operand->opcode() == HloOpcode::kBroadcast) {
+          HloInstruction* input = operand->mutable_operand(0);
+          HloInstruction* new_input =
+              ShapeUtil::IsScalar(input->shape())
+                  ? builder.AddInstruction(input->Clone())
+                  : add_parameter(input);
+          user_new_operands.push_back(builder.AddInstruction(
+              operand->CloneWithNewOperands(operand->shape(), {new_input})));
+        } else {
+          user_new_operands.push_back(add_parameter(operand));
+        }
+      }
+      old_to_new_mapping[user] = builder.AddInstruction(
+          user->CloneWithNewOperands(user->shape(), user_new_operands));
+      fusion_output = user;
+    }
     HloComputation* computation =
         dot->GetModule()->AddComputationAndUnifyNamesAndIds(builder.Build(),
                                                             /*is_entry=*/false);
     HloInstruction* dot_fusion =
         dot->parent()->AddInstruction(HloInstruction::CreateFusion(
-            dot->shape(), HloInstruction::FusionKind::kCustom, call_operands,
+            fusion_output->shape(), HloInstruction::FusionKind::kCustom,
+            call_operands,
             computation));
     dot_fusion->GetModule()->SetAndUniquifyInstrName(dot_fusion,
                                                      suggested_name);
     dot_fusion->set_raw_backend_config_string(
         std::string(kTritonGemmBackendConfig));
-    if (dot->IsRoot()) {
-      dot->parent()->set_root_instruction(dot_fusion);
+    if (fusion_output->IsRoot()) {
+      fusion_output->parent()->set_root_instruction(dot_fusion);
       TF_RETURN_IF_ERROR(
-          dot->parent()->RemoveInstructionAndUnusedOperands(dot));
+          fusion_output->parent()->RemoveInstructionAndUnusedOperands(
+              fusion_output));
     } else {
-      TF_RETURN_IF_ERROR(dot->parent()->ReplaceInstruction(dot, dot_fusion));
+      TF_RETURN_IF_ERROR(
+          fusion_output->parent()->ReplaceInstruction(fusion_output,
+                                                      dot_fusion));
     }
     VLOG(5) << dot_fusion->ToString();
     MarkAsChanged();
@@ -474,7 +572,13 @@ StatusOr<bool> RunOnComputation(
     HloComputation* computation,
     se::CudaComputeCapability cuda_compute_capability) {
   GemmRewriterTritonVisitor visitor(cuda_compute_capability);
-  TF_RETURN_IF_ERROR(computation->Accept(&visitor));
+  // Epilogue fusion removes users of dot(), which a traversal of the graph
+  // being rewritten could still visit; so visit a snapshot of the dots.
+  for (HloInstruction* hlo : computation->MakeInstructionPostOrder()) {
+    if (hlo->opcode() == HloOpcode::kDot) {
+      TF_RETURN_IF_ERROR(visitor.HandleDot(hlo));
+    }
+  }
   return visitor.changed();
 }
 
@@ -557,21 +661,9 @@ bool IsTritonHandledGEMM(
   }
   const DotDimensionNumbers& dimension_numbers = dot.dot_dimension_numbers();
 
-  auto supported_output_type = [&](const PrimitiveType t) {
-    switch (t) {
-      case F16:
-      case F32:
-        return true;
-      case BF16:
-        return cuda_compute_capability.IsAtLeast(
-            stream_executor::CudaComputeCapability::AMPERE);
-      default:
-        return false;
-    }
-  };
-
   // TODO(b/266862493): Support more output types.
-  if (!supported_output_type(dot.shape().element_type())) {
+  if (!IsTritonSupportedOutputType(dot.shape().element_type(),
+                                   cuda_compute_capability)) {
     return false;
   }
 
@@ -614,9 +706,6 @@ bool IsTritonHandledGEMM(
          has_triton_fusible_inputs(
              dot.operand(1), FirstBatchDimensionIndex(dimension_numbers, 1),
              dimension_numbers.rhs_contracting_dimensions(0));
-
-  // TODO(b/266857789): either check that no output fusion (axpy, relu etc)
-  // is expected or actually support it.
 }
 
 StatusOr<bool> GemmRewriterTriton::Run(
@@ -54,6 +54,45 @@ ENTRY e {
                   .value());
 }
 
+TEST_F(GemmRewriterTritonTest, FuseElementwiseEpilogue) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+add {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT s = f32[] add(a, b)
+}
+
+ENTRY e {
+  p0 = f16[32,64] parameter(0)
+  p1 = s8[64,48] parameter(1)
+  c1 = f16[64,48] convert(p1)
+  d = f16[32,48] dot(p0, c1),
+    lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  bias = f16[48] parameter(2)
+  bias_b = f16[32,48] broadcast(bias), dimensions={1}
+  biased = f16[32,48] add(d, bias_b)
+  zero = f16[] constant(0)
+  zero_b = f16[32,48] broadcast(zero), dimensions={}
+  relu = f16[32,48] maximum(biased, zero_b)
+  c2 = f32[32,48] convert(relu)
+  init = f32[] constant(0)
+  ROOT r = f32[32] reduce(c2, init), dimensions={1}, to_apply=add
+})")
+                    .value();
+  EXPECT_TRUE(GemmRewriterTriton({se::CudaComputeCapability::AMPERE, 0})
+                  .Run(module.get())
+                  .value());
+  // The elementwise instructions are fused, the reduce() is not.
+  const HloInstruction* fusion =
+      module->entry_computation()->root_instruction()->operand(0);
+  ASSERT_EQ(fusion->opcode(), HloOpcode::kFusion);
+  EXPECT_EQ(fusion->operand_count(), 3);
+  EXPECT_EQ(fusion->fused_expression_root()->opcode(), HloOpcode::kConvert);
+  EXPECT_EQ(fusion->shape().element_type(), F32);
+}
+
 using TritonDotAnalysisTest = HloTestBase;
 
 TEST_F(TritonDotAnalysisTest, NopBitcasts) {
@@ -32,14 +32,12 @@ limitations under the License.
 
 #include "absl/strings/str_cat.h"
 #include "absl/types/variant.h"
-#include "llvm/AsmParser/Parser.h"
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/Support/raw_ostream.h"
-#include "llvm/Transforms/Utils/SplitModule.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "mlir/IR/Diagnostics.h"  // from @llvm-project
@@ -91,9 +89,11 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/all_reduce_blueconnect.h"
 #include "tensorflow/compiler/xla/service/gpu/conditional_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/conv_layout_normalization.h"
+#include "tensorflow/compiler/xla/service/gpu/cuda_graph_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/dot_dimension_sorter.h"
 #include "tensorflow/compiler/xla/service/gpu/for_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/fusion_merger.h"
+#include "tensorflow/compiler/xla/service/gpu/fusion_profile.h"
 #include "tensorflow/compiler/xla/service/gpu/gemm_broadcast_folding_rewriter.h"
 #include "tensorflow/compiler/xla/service/gpu/gemm_rewriter.h"
 #include "tensorflow/compiler/xla/service/gpu/gemm_rewriter_triton.h"
@@ -198,6 +198,8 @@ limitations under the License.
 #include "tensorflow/tsl/profiler/lib/traceme.h"
 
 #if GOOGLE_CUDA
+#include "tensorflow/compiler/xla/autotune_serialize.h"
+#include "tensorflow/compiler/xla/service/gpu/autotune_results_store.h"
 #include "tensorflow/compiler/xla/service/gpu/gemm_algorithm_picker.h"
 #include "tensorflow/compiler/xla/service/gpu/triton_autotuner.h"
 #endif  // GOOGLE_CUDA
@@ -675,6 +677,19 @@ Status GpuCompiler::OptimizeHloModule(
 
   const GpuDeviceInfo& gpu_device_info = gpu_target_config.gpu_device_info;
 
+  std::unique_ptr<FusionProfile> fusion_profile;
+  const std::string& fusion_profile_path =
+      hlo_module->config().debug_options().xla_gpu_fusion_profile_path();
+  if (!fusion_profile_path.empty()) {
+    TF_ASSIGN_OR_RETURN(fusion_profile,
+                        FusionProfile::Load(fusion_profile_path,
+                                            gpu_device_info,
+                                            ShapeSizeBytesFunction()));
+    VLOG(1) << "Loaded fusion profile from " << fusion_profile_path << " with "
+            << fusion_profile->num_unprofitable_fusions()
+            << " unprofitable fusions";
+  }
+
   {
     HloPassFix<HloPassPipeline> fusion("fusion");
     // We try to split variadic ops with many parameters into several such ops
@@ -686,12 +701,13 @@ Status GpuCompiler::OptimizeHloModule(
             LayoutAssignment::InstructionCanChangeLayout),
         /*debug_only=*/true);
     fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/false,
-                                         gpu_device_info);
+                                         gpu_device_info, fusion_profile.get());
     fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/true,
-                                         gpu_device_info);
-    fusion.AddPass<FusionMerger>(gpu_device_info, ShapeSizeBytesFunction());
-    fusion.AddPass<GpuMultiOutputFusion>(gpu_device_info,
-                                         ShapeSizeBytesFunction());
+                                         gpu_device_info, fusion_profile.get());
+    fusion.AddPass<FusionMerger>(gpu_device_info, ShapeSizeBytesFunction(),
+                                 fusion_profile.get());
+    fusion.AddPass<GpuMultiOutputFusion>(
+        gpu_device_info, ShapeSizeBytesFunction(), fusion_profile.get());
     fusion.AddPass<HloCSE>(/*is_layout_sensitive=*/true,
                            /*only_fusion_computations=*/true);
     fusion.AddPass<HloDCE>();
@@ -899,6 +915,29 @@ Status GpuCompiler::OptimizeHloPostLayoutAssignment(
     TF_RETURN_IF_ERROR(TritonAutotuner::LoadAutotuneResults(*autotune_results));
 #endif  // GOOGLE_CUDA
   }
+#if GOOGLE_CUDA
+  // Results shared by earlier compilations on the same kind of device let the
+  // pickers below skip autotuning.  The store is best-effort: if it is
+  // unavailable we just autotune as usual.
+  std::unique_ptr<AutotuneResultsStore> autotune_store;
+  std::string autotune_store_key;
+  if (stream_exec) {
+    autotune_store = CreateAutotuneResultsStore(debug_options);
+  }
+  if (autotune_store) {
+    StatusOr<std::string> key = AutotuneResultsStoreKey(stream_exec);
+    Status status = key.status();
+    if (key.ok()) {
+      autotune_store_key = *std::move(key);
+      status = LoadAutotuneResultsFromStore(*autotune_store,
+                                            autotune_store_key);
+    }
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to fetch shared autotune results: " << status;
+      autotune_store = nullptr;
+    }
+  }
+#endif  // GOOGLE_CUDA
   pipeline.AddPass<GpuConvAlgorithmPicker>(config);
 #if GOOGLE_CUDA
   pipeline.AddPass<GemmAlgorithmPicker>(config);
@@ -927,6 +966,17 @@ Status GpuCompiler::OptimizeHloPostLayoutAssignment(
   pipeline.AddPass<HloCSE>(/*is_layout_sensitive=*/true);
   TF_RETURN_IF_ERROR(pipeline.Run(hlo_module).status());
 
+#if GOOGLE_CUDA
+  if (autotune_store) {
+    Status status = UploadAutotuneResultsToStore(
+        *autotune_store, autotune_store_key,
+        stream_exec->GetDeviceDescription().model_str());
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to upload shared autotune results: " << status;
+    }
+  }
+#endif  // GOOGLE_CUDA
+
   return OkStatus();
 }
 
@@ -992,8 +1042,9 @@ static std::optional<bool> DummyCanShareBufferFunction(const HloInstruction*,
 StatusOr<std::unique_ptr<BufferAssignment>> GpuCompiler::AssignBuffers(
     HloModule* hlo_module, se::StreamExecutor* stream_exec) {
   const GpuDeviceInfo gpu_device_info = GetGpuDeviceInfo(stream_exec);
-  TF_RETURN_IF_ERROR(
-      ScheduleGpuModule(hlo_module, pointer_size_, gpu_device_info));
+  TF_RETURN_IF_ERROR(ScheduleGpuModule(
+      hlo_module, pointer_size_, gpu_device_info,
+      stream_exec->GetDeviceDescription().cuda_compute_capability()));
 
   auto buffer_size_bytes_function =
       [this](const BufferValue& buffer_value) -> int64_t {
@@ -1173,8 +1224,9 @@ static Status CompileModuleToLlvmIrImpl(
   results->llvm_module->setTargetTriple(target_triple);
   results->llvm_module->setDataLayout(data_layout);
 
-  TF_RETURN_IF_ERROR(
-      ScheduleGpuModule(hlo_module, pointer_size, gpu_device_info));
+  TF_RETURN_IF_ERROR(ScheduleGpuModule(hlo_module, pointer_size,
+                                       gpu_device_info,
+                                       cuda_compute_capability));
   {
     HloPassPipeline pipeline("opt-barrier-expander");
     pipeline.AddPass<OptimizationBarrierExpander>();
@@ -1285,6 +1337,9 @@ static Status CompileModuleToLlvmIrImpl(
   auto thunk_sequence = ir_emitter->ConsumeThunkSequence();
   ForAllThunks([](Thunk* thunk) { thunk->ClearCompileTimeInfo(); },
                thunk_sequence.get());
+  if (hlo_module->config().debug_options().xla_gpu_enable_cuda_graphs()) {
+    OutlineCudaGraphThunks(thunk_sequence.get());
+  }
   results->executable = std::move(thunk_sequence);
   return OkStatus();
 }
@@ -1421,80 +1476,33 @@ GpuCompiler::CompileToTargetBinary(const HloModuleConfig& module_config,
                                  /*shard_number=*/std::nullopt);
   }
 
-  std::vector<std::unique_ptr<llvm::Module>> llvm_modules;
-  int num_functions = 0;
-  for (llvm::Function& func : llvm_module->functions()) {
-    if (!func.isDeclaration() &&
-        func.getLinkage() == llvm::GlobalValue::LinkageTypes::ExternalLinkage) {
-      num_functions++;
-    }
-  }
-
-  // Record the name of some constant global variables and their initializers.
-  // We'll change the linkage type of these variables from external to internal
-  // to ensure constant-folding works properly after calling llvm::SplitModule.
-  llvm::DenseMap<llvm::StringRef, llvm::Constant*> const_initializer_map;
-  for (llvm::GlobalVariable& gv : llvm_module->globals()) {
-    if (gv.hasName() && gv.isConstant() && gv.hasInitializer() &&
-        gv.hasExternalLinkage()) {
-      llvm::Constant* initializer = gv.getInitializer();
-      unsigned int num_elements = 0;
-      if (auto* caz =
-              llvm::dyn_cast<llvm::ConstantAggregateZero>(initializer)) {
-        num_elements = caz->getElementCount().getFixedValue();
-      } else if (auto* cds = llvm::dyn_cast<llvm::ConstantDataSequential>(
-                     initializer)) {
-        num_elements = cds->getNumElements();
-      }
-      if (num_elements > 0) {
-        const_initializer_map[gv.getName()] = initializer;
-      }
-    }
+  std::vector<std::string> llvm_modules =
+      llvm_ir::SplitModuleForParallelCompilation(
+          *llvm_module, thread_pool->NumThreads(), /*preserve_locals=*/true);
+  if (llvm_modules.size() <= 1) {
+    // Nothing to parallelize, so skip the relocatable compile and link step.
+    return compile_single_module(llvm_module.get(), /*relocatable=*/false,
+                                 /*shard_number=*/std::nullopt);
   }
 
-  llvm::SplitModule(
-      *llvm_module,
-      std::max<unsigned>(
-          1, std::min<unsigned>(thread_pool->NumThreads(), num_functions)),
-      [&](std::unique_ptr<llvm::Module> module) {
-        // Change the linkage type of some global constant variables to internal
-        for (llvm::GlobalVariable& gv : module->globals()) {
-          if (gv.hasName() && gv.isConstant() && !gv.hasInitializer() &&
-              const_initializer_map.count(gv.getName()) != 0) {
-            gv.setInitializer(const_initializer_map[gv.getName()]);
-            gv.setLinkage(llvm::GlobalValue::InternalLinkage);
-          }
-        }
-        llvm_modules.push_back(std::move(module));
-      },
-      /*PreserveLocals=*/true);
-
   std::vector<StatusOr<BackendCompileResult>> compile_results(
       llvm_modules.size());
   tsl::BlockingCounter counter(llvm_modules.size());
   for (int i = 0; i < llvm_modules.size(); i++) {
     thread_pool->Schedule(
         [&compile_results, compile_single_module, i, &llvm_modules, &counter] {
-          llvm::Module* original_module = llvm_modules[i].get();
+          // Each thread parses its partition into its own context to avoid
+          // race conditions.
           llvm::LLVMContext context;
-
-          std::unique_ptr<llvm::Module> new_llvm_module;
-          // Switch to a new context by dumping and re-parsing LLVM IR. Each
-          // thread has its own context to avoid race conditions.
-          {
-            std::string ir = llvm_ir::DumpToString(original_module);
-            llvm::SMDiagnostic err;
-            new_llvm_module = llvm::parseAssemblyString(ir, err, context);
-            if (!new_llvm_module) {
-              std::string err_string;
-              llvm::raw_string_ostream os(err_string);
-              err.print(/*ProgName=*/nullptr, os, /*ShowColors=*/false);
-              LOG(FATAL) << "Failed to parse IR: " << err_string;
-            }
+          StatusOr<std::unique_ptr<llvm::Module>> new_llvm_module =
+              llvm_ir::ParseModuleInContext(llvm_modules[i], context);
+          if (new_llvm_module.ok()) {
+            compile_results[i] =
+                compile_single_module(new_llvm_module->get(),
+                                      /*relocatable=*/true, /*shard_number=*/i);
+          } else {
+            compile_results[i] = new_llvm_module.status();
           }
-
-          compile_results[i] = compile_single_module(
-              new_llvm_module.get(), /*relocatable=*/true, /*shard_number=*/i);
           counter.DecrementCount();
         });
   }
@@ -1516,12 +1524,15 @@ GpuCompiler::CompileToTargetBinary(const HloModuleConfig& module_config,
       this->LinkModules(stream_exec, std::move(submodule_compile_results),
                         module_config.debug_options());
   if (!maybe_backend_result.ok()) {
-    LOG(ERROR) << "The CUDA linking API did not work. Please use "
-                  "XLA_FLAGS=--xla_gpu_force_compilation_parallelism=1 to "
-                  "bypass it, but expect to get longer compilation time due to "
-                  "the lack of multi-threading. Original error: "
-               << maybe_backend_result.status();
-    return maybe_backend_result.status();
+    // SplitModule leaves `llvm_module` intact when preserving locals, so fall
+    // back to compiling it on a single thread.
+    LOG(WARNING) << "The CUDA linking API did not work, compiling the module "
+                    "on a single thread instead. Set "
+                    "XLA_FLAGS=--xla_gpu_force_compilation_parallelism=1 to "
+                    "skip the parallel attempt. Original error: "
+                 << maybe_backend_result.status();
+    return compile_single_module(llvm_module.get(), /*relocatable=*/false,
+                                 /*shard_number=*/std::nullopt);
   }
 
   return std::make_pair(ptx_snippets, std::move(*maybe_backend_result));
@@ -1952,6 +1963,9 @@ StatusOr<std::unique_ptr<Executable>> CompileLmhloToExecutable(
   }
 
   auto thunk_sequence = ir_emitter->ConsumeThunkSequence();
+  if (module_config.debug_options().xla_gpu_enable_cuda_graphs()) {
+    OutlineCudaGraphThunks(thunk_sequence.get());
+  }
 
   GpuVersion gpu_version = compiler->GetGpuVersion(stream_exec);
   return GpuExecutable::Create(
@@ -35,6 +35,7 @@ limitations under the License.
 #include "mlir/Parser/Parser.h"  // from @llvm-project
 #include "mlir/Support/DebugStringHelper.h"  // from @llvm-project
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/layout.h"
 #include "tensorflow/compiler/xla/map_util.h"
 #include "tensorflow/compiler/xla/mlir/runtime/ir/rt_ops.h"
 #include "tensorflow/compiler/xla/mlir/runtime/transforms/compilation_pipeline_gpu.h"
@@ -141,6 +142,12 @@ GpuExecutable::~GpuExecutable() {
   if (has_module()) {
     XlaDebugInfoManager::Get()->UnregisterModule(module().unique_id());
   }
+  absl::MutexLock lock(&host_buffers_mutex_);
+  for (auto& [key, buffers] : free_host_buffers_) {
+    for (void* buffer : buffers) {
+      key.first->HostMemoryDeallocate(buffer);
+    }
+  }
 }
 
 Status GpuExecutable::CheckCompatibilityWithServiceExecutableRunOptions(
@@ -391,6 +398,35 @@ StatusOr<se::DeviceMemoryBase> GpuExecutable::BufferForAllocation(
   }
 }
 
+StatusOr<se::DeviceMemoryBase> GpuExecutable::AllocateHostBuffer(
+    se::StreamExecutor* executor, int64_t size) {
+  {
+    absl::MutexLock lock(&host_buffers_mutex_);
+    auto it = free_host_buffers_.find({executor, size});
+    if (it != free_host_buffers_.end() && !it->second.empty()) {
+      void* buffer = it->second.back();
+      it->second.pop_back();
+      return se::DeviceMemoryBase(buffer, size);
+    }
+  }
+  void* buffer = executor->HostMemoryAllocate(size);
+  if (buffer == nullptr) {
+    return ResourceExhausted(
+        "Failed to allocate %d bytes of host memory.\n%s\n", size,
+        verbose_buffer_assignment_string_dumper_());
+  }
+  return se::DeviceMemoryBase(buffer, size);
+}
+
+void GpuExecutable::ReleaseHostBuffers(
+    se::StreamExecutor* executor,
+    absl::Span<const se::DeviceMemoryBase> buffers) {
+  absl::MutexLock lock(&host_buffers_mutex_);
+  for (const se::DeviceMemoryBase& buffer : buffers) {
+    free_host_buffers_[{executor, buffer.size()}].push_back(buffer.opaque());
+  }
+}
+
 static Status CheckAlignment(const BufferAllocation& allocation,
                              se::DeviceMemoryBase buffer, int arg_idx) {
   const int64_t expected_alignment = [&] {
@@ -415,16 +451,25 @@ static Status CheckAlignment(const BufferAllocation& allocation,
 StatusOr<BufferAllocations> GpuExecutable::GenerateBufferAllocations(
     VariantArguments arguments,
     const GpuExecutable::BufferAllocToDeviceMemoryMap* globals,
-    se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal) {
+    se::DeviceMemoryAllocator* const memory_allocator,
+    se::StreamExecutor* executor) {
   tsl::profiler::TraceMe hlo_module_activity(
       [&] { return std::string("Build buffer allocations"); },
       tsl::profiler::TraceMeLevel::kInfo);
 
+  const int device_ordinal = executor->device_ordinal();
   const int64_t num_buffers = allocations_.size();
   std::vector<se::DeviceMemoryBase> buffers;
   buffers.reserve(num_buffers);
   for (int64_t i = 0; i < num_buffers; ++i) {
     const BufferAllocation& allocation = allocations_[i];
+    if (allocation.color() == Layout::kHostMemorySpace &&
+        allocation.size() > 0) {
+      TF_ASSIGN_OR_RETURN(se::DeviceMemoryBase buffer,
+                          AllocateHostBuffer(executor, allocation.size()));
+      buffers.push_back(buffer);
+      continue;
+    }
     TF_ASSIGN_OR_RETURN(
         se::DeviceMemoryBase buffer,
         BufferForAllocation(arguments, globals, allocation, memory_allocator,
@@ -518,7 +563,7 @@ StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStreamImpl(
   TF_ASSIGN_OR_RETURN(
       BufferAllocations buffer_allocations,
       GenerateBufferAllocations(arguments, globals, memory_allocator,
-                                device_ordinal));
+                                executor));
   VLOG(2) << buffer_allocations.ToString();
   std::set<se::DeviceMemoryBase> buffers_in_result;
 
@@ -634,6 +679,22 @@ StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStreamImpl(
   TF_RETURN_IF_ERROR(ExecuteThunksOrXlaRuntime(
       run_options, buffer_allocations, block_host_until_done, gpu_lock));
 
+  // Host buffers can be reused once the stream is done with them.
+  std::vector<se::DeviceMemoryBase> host_buffers;
+  for (const BufferAllocation& allocation : allocations_) {
+    if (allocation.color() == Layout::kHostMemorySpace &&
+        allocation.size() > 0) {
+      host_buffers.push_back(
+          buffer_allocations.GetDeviceAddress(allocation.index()));
+    }
+  }
+  if (!host_buffers.empty()) {
+    run_options->stream()->ThenDoHostCallback(
+        [this, executor, host_buffers = std::move(host_buffers)] {
+          ReleaseHostBuffers(executor, host_buffers);
+        });
+  }
+
   // Free all temporary allocations.
   TF_RETURN_IF_ERROR(
       buffer_allocations.TearDown(buffers_in_result, allocations_));
@@ -673,7 +734,8 @@ Status GpuExecutable::ExecuteThunksOrXlaRuntime(
     // IrEmitterUnnested::BuildKernelThunkImpl().
     const BufferAllocation* temp_buffer = nullptr;
     for (const BufferAllocation& alloc : allocations_) {
-      if (alloc.IsPreallocatedTempBuffer()) {
+      if (alloc.IsPreallocatedTempBuffer() &&
+          alloc.color() != Layout::kHostMemorySpace) {
         // Retrieve the first seen temp buffer.
         if (temp_buffer == nullptr) temp_buffer = &alloc;
       }
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <optional>
 #include <string>
@@ -27,6 +28,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
@@ -228,7 +230,8 @@ class GpuExecutable : public Executable {
   StatusOr<BufferAllocations> GenerateBufferAllocations(
       VariantArguments arguments,
       const GpuExecutable::BufferAllocToDeviceMemoryMap* globals,
-      se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal);
+      se::DeviceMemoryAllocator* const memory_allocator,
+      se::StreamExecutor* executor);
 
   StatusOr<se::DeviceMemoryBase> BufferForAllocation(
       VariantArguments arguments,
@@ -237,6 +240,16 @@ class GpuExecutable : public Executable {
       se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal,
       int64_t arg_idx);
 
+  // Returns a pinned host buffer of `size` bytes for an allocation in
+  // Layout::kHostMemorySpace, reusing one released before if possible.
+  StatusOr<se::DeviceMemoryBase> AllocateHostBuffer(
+      se::StreamExecutor* executor, int64_t size);
+
+  // Makes `buffers` available to later executions.  Called from stream
+  // callbacks, so must not call into the GPU driver.
+  void ReleaseHostBuffers(se::StreamExecutor* executor,
+                          absl::Span<const se::DeviceMemoryBase> buffers);
+
   // The LLVM IR, in string format, of the unoptimized module generated for
   // this GpuExecutable. We save a string instead of an llvm::Module* because
   // leaving llvm::Module* in a singleton can cause the heap checker to emit
@@ -288,6 +301,13 @@ class GpuExecutable : public Executable {
   std::map<stream_executor::StreamExecutor*, BufferAllocToDeviceMemoryMap>
       module_globals_ ABSL_GUARDED_BY(module_handle_mutex_);
 
+  absl::Mutex host_buffers_mutex_;
+  // Pinned host buffers not in use by any execution, by executor and size.
+  // They back the allocations in Layout::kHostMemorySpace and are freed with
+  // the executable.
+  std::map<std::pair<se::StreamExecutor*, int64_t>, std::vector<void*>>
+      free_host_buffers_ ABSL_GUARDED_BY(host_buffers_mutex_);
+
   std::vector<ConstantInfo> constants_;
   const absl::flat_hash_map<ShapeIndex, OutputInfo> output_info_;
   // Retains shared ownership of on-device constants that are managed by XLA and
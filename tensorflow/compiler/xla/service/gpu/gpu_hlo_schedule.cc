@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/gpu/gpu_hlo_schedule.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <deque>
 #include <iostream>
@@ -24,10 +25,12 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_casting_utils.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instructions.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_schedule.h"
 #include "tensorflow/compiler/xla/service/buffer_value.h"
 #include "tensorflow/compiler/xla/service/gpu/cublas_cudnn.h"
+#include "tensorflow/compiler/xla/service/gpu/host_memory_offloader.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
@@ -179,6 +182,8 @@ SchedulerConfig GetSchedulerConfig(const GpuDeviceInfo& gpu_info) {
   SchedulerConfig config;
   config.all_reduce_overlap_limit = 1;
   config.collective_permute_overlap_limit = 1;
+  config.schedule_send_recvs = true;
+  config.schedule_copies = true;
   config.use_real_cost_model = false;
   config.aggressive_scheduling_policies = true;
 
@@ -187,26 +192,153 @@ SchedulerConfig GetSchedulerConfig(const GpuDeviceInfo& gpu_info) {
   return config;
 }
 
-class GpuLatencyEstimator : public ApproximateLatencyEstimator {
- public:
-  TimeCost NodeCost(const HloInstruction* instr) const override {
-    // Consider cublas/cuddn/softmax custom calls as medium cost. Since the
-    // latency between async-start and async-done is 5000 and cost of each
-    // custom call is 1000, the LHS will try to schedule approximately 5 of
-    // these in between each start/end pair.
-    if (instr->opcode() == HloOpcode::kCustomCall) {
-      if (IsCublasGemm(*instr) || IsCustomCallToDnnConvolution(*instr)) {
-        return ApproximateLatencyEstimator::kMediumCost;
-      }
-      // consider other custom calls as medium cost for now. Keeping the case
-      // explicitly separate for further tuning.
+// Hosts with more GPUs than this are rare, so collectives among more devices
+// are assumed to cross hosts.
+constexpr int64_t kMaxDevicesPerHost = 8;
+
+int64_t ArrayBytes(const Shape& shape) {
+  int64_t bytes = 0;
+  ShapeUtil::ForEachSubshape(shape, [&](const Shape& subshape,
+                                        const ShapeIndex& /*index*/) {
+    if (subshape.IsArray()) bytes += ShapeUtil::ByteSizeOfElements(subshape);
+  });
+  return bytes;
+}
+
+// Returns the bytes transferred by the asynchronous operation started by
+// `start`.
+int64_t TransferredBytes(const HloInstruction& start) {
+  if (start.opcode() == HloOpcode::kRecv) {
+    return ArrayBytes(start.shape().tuple_shapes(0));
+  }
+  int64_t bytes = 0;
+  for (const HloInstruction* operand : start.operands()) {
+    if (operand->shape().IsToken()) continue;
+    bytes += ArrayBytes(operand->shape());
+  }
+  return bytes;
+}
+
+}  // end namespace
+
+GpuLatencyModel GetLatencyModel(
+    const se::CudaComputeCapability& compute_capability) {
+  if (compute_capability.IsAtLeast(se::CudaComputeCapability::HOPPER)) {
+    // NVLink 4, PCIe 5, 400Gb/s network.
+    return {{3.0, 360.0}, {8.0, 48.0}, {12.0, 45.0}};
+  }
+  if (compute_capability.IsAtLeast(se::CudaComputeCapability::AMPERE)) {
+    // NVLink 3, PCIe 4, 200Gb/s network.
+    return {{4.0, 240.0}, {9.0, 24.0}, {14.0, 23.0}};
+  }
+  if (compute_capability.IsAtLeast(se::CudaComputeCapability::VOLTA)) {
+    // NVLink 2, PCIe 3, 100Gb/s network.
+    return {{5.0, 130.0}, {10.0, 12.0}, {16.0, 11.5}};
+  }
+  // Assume GPUs of older or unknown platforms only talk over PCIe 3.
+  return {{10.0, 12.0}, {10.0, 12.0}, {16.0, 11.5}};
+}
+
+bool IsCrossHostCollective(const HloInstruction& collective) {
+  const HloModuleConfig& config = collective.GetModule()->config();
+  const int64_t num_devices = config.replica_count() * config.num_partitions();
+  if (num_devices <= kMaxDevicesPerHost) return false;
+
+  if (auto* permute = DynCast<HloCollectivePermuteInstruction>(&collective)) {
+    return absl::c_any_of(permute->source_target_pairs(), [](const auto& pair) {
+      return pair.first / kMaxDevicesPerHost !=
+             pair.second / kMaxDevicesPerHost;
+    });
+  }
+  if (auto* other = DynCast<HloCollectiveInstruction>(&collective)) {
+    if (other->replica_groups().empty()) return true;
+    return absl::c_any_of(other->replica_groups(), [](const ReplicaGroup& g) {
+      return g.replica_ids_size() > kMaxDevicesPerHost;
+    });
+  }
+  return false;
+}
+
+GpuLatencyEstimator::GpuLatencyEstimator(
+    const se::CudaComputeCapability& compute_capability)
+    : model_(GetLatencyModel(compute_capability)) {}
+
+LatencyEstimator::TimeCost GpuLatencyEstimator::GetLatencyBetween(
+    const HloGraphNode& from, const HloGraphNode& target) const {
+  const HloInstruction& start = from.GetInstr();
+  const HloInstruction& done = target.GetInstr();
+  const LinkModel* link = nullptr;
+  // Send/recv are not covered by the approximate estimator, so give them the
+  // latency of any other async op before scaling.
+  TimeCost latency = kHighCost;
+  if ((start.opcode() == HloOpcode::kSend &&
+       done.opcode() == HloOpcode::kSendDone) ||
+      (start.opcode() == HloOpcode::kRecv &&
+       done.opcode() == HloOpcode::kRecvDone)) {
+    link = Cast<HloSendRecvInstruction>(&start)->is_host_transfer()
+               ? &model_.host
+               : &model_.cross_host;
+  } else {
+    latency = ApproximateLatencyEstimator::GetLatencyBetween(from, target);
+    if (latency < kHighCost) return latency;
+    if (start.opcode() == HloOpcode::kCopyStart) {
+      link = &model_.host;
+    } else {
+      const HloInstruction* collective =
+          start.opcode() == HloOpcode::kAsyncStart
+              ? start.async_wrapped_instruction()
+              : &start;
+      if (IsCrossHostCollective(*collective)) link = &model_.cross_host;
+    }
+  }
+  if (link == nullptr) return latency;
+
+  const int64_t bytes = TransferredBytes(start);
+  return latency * std::max(1.0, link->TransferTimeUs(bytes) /
+                                     model_.intra_host.TransferTimeUs(bytes));
+}
+
+LatencyEstimator::TimeCost GpuLatencyEstimator::NodeCost(
+    const HloInstruction* instr) const {
+  // Consider cublas/cuddn/softmax custom calls as medium cost. Since the
+  // latency between async-start and async-done is 5000 and cost of each
+  // custom call is 1000, the LHS will try to schedule approximately 5 of
+  // these in between each start/end pair.
+  if (instr->opcode() == HloOpcode::kCustomCall) {
+    if (IsCublasGemm(*instr) || IsCustomCallToDnnConvolution(*instr)) {
       return ApproximateLatencyEstimator::kMediumCost;
     }
-    return ApproximateLatencyEstimator::NodeCost(instr);
+    // consider other custom calls as medium cost for now. Keeping the case
+    // explicitly separate for further tuning.
+    return ApproximateLatencyEstimator::kMediumCost;
   }
-};
+  return ApproximateLatencyEstimator::NodeCost(instr);
+}
 
-}  // end namespace
+bool HasSupportedAsyncOps(const HloModule& module,
+                          const AsyncTracker& async_tracker) {
+  for (const HloComputation* computation : module.computations()) {
+    for (const HloInstruction* instr : computation->instructions()) {
+      if (async_tracker.IsSupportedAsyncStart(*instr)) return true;
+    }
+  }
+  return false;
+}
+
+Status RunLatencyHidingScheduler(HloModule* module,
+                                 HloPassInterface* scheduler) {
+  // The latency hiding scheduler is on by default, so don't fail compilation
+  // if it does; the memory scheduler's schedule is always valid.
+  HloSchedule memory_schedule = module->schedule();
+  Status status = scheduler->Run(module).status();
+  if (!status.ok()) {
+    LOG(WARNING) << "Latency hiding scheduler failed, falling back to the "
+                    "memory scheduler: "
+                 << status;
+    TF_RETURN_IF_ERROR(module->set_schedule(std::move(memory_schedule)));
+  }
+  return OkStatus();
+}
 
 int64_t GetSizeOfShape(const Shape& shape, int pointer_size) {
   int64_t size = ShapeUtil::ByteSizeOf(shape, pointer_size);
@@ -218,12 +350,44 @@ int64_t GetSizeOfShape(const Shape& shape, int pointer_size) {
   return size + metadata_size;
 }
 
-Status ScheduleGpuModule(HloModule* module, int64_t pointer_size,
-                         const GpuDeviceInfo& gpu_info) {
+namespace {
+
+// Offloads activations to pinned host memory if the scheduled module does not
+// fit into `memory_limit` and --xla_gpu_enable_host_memory_offload is set.
+Status MaybeOffloadToHostMemory(
+    HloModule* module, int64_t pointer_size, const GpuDeviceInfo& gpu_info,
+    const se::CudaComputeCapability& compute_capability,
+    int64_t memory_limit) {
+  if (!module->config().debug_options().xla_gpu_enable_host_memory_offload()) {
+    return OkStatus();
+  }
+  HostMemoryOffloader::Options options;
+  options.device_memory_limit = memory_limit;
+  options.host_bandwidth_bytes_per_second =
+      GetLatencyModel(compute_capability).host.gigabytes_per_second * 1e9;
+  HostMemoryOffloader offloader(
+      options,
+      [pointer_size](const Shape& shape) {
+        return GetSizeOfShape(shape, pointer_size);
+      },
+      gpu_info);
+  return offloader.Run(module).status();
+}
+
+}  // namespace
+
+Status ScheduleGpuModule(
+    HloModule* module, int64_t pointer_size, const GpuDeviceInfo& gpu_info,
+    const se::CudaComputeCapability& compute_capability) {
+  SchedulerConfig config = GetSchedulerConfig(gpu_info);
+  auto async_tracker = std::make_unique<AsyncTracker>(config);
+  // Without async ops there is no latency to hide, so keep the memory
+  // scheduler's schedule in that case.
   const bool enable_latency_hiding_scheduler =
       module->config()
           .debug_options()
-          .xla_gpu_enable_latency_hiding_scheduler();
+          .xla_gpu_enable_latency_hiding_scheduler() &&
+      HasSupportedAsyncOps(*module, *async_tracker);
   TF_ASSIGN_OR_RETURN(
       HloSchedule schedule,
       ScheduleGpuModuleWithMemoryScheduler(module, pointer_size,
@@ -231,11 +395,11 @@ Status ScheduleGpuModule(HloModule* module, int64_t pointer_size,
   TF_RETURN_IF_ERROR(module->set_schedule(std::move(schedule)));
 
   if (!enable_latency_hiding_scheduler) {
-    return OkStatus();
+    return MaybeOffloadToHostMemory(module, pointer_size, gpu_info,
+                                    compute_capability, config.memory_limit);
   }
-  SchedulerConfig config = GetSchedulerConfig(gpu_info);
-  auto latency_estimator = std::make_unique<GpuLatencyEstimator>();
-  auto async_tracker = std::make_unique<AsyncTracker>(config);
+  auto latency_estimator =
+      std::make_unique<GpuLatencyEstimator>(compute_capability);
 
   auto shape_size_in_bytes = [pointer_size](const Shape& shape) {
     return GetSizeOfShape(shape, pointer_size);
@@ -249,8 +413,9 @@ Status ScheduleGpuModule(HloModule* module, int64_t pointer_size,
       std::move(latency_estimator), std::move(async_tracker),
       std::move(scheduler_core), shape_size_in_bytes);
 
-  TF_RETURN_IF_ERROR(pipeline.Run(module).status());
-  return OkStatus();
+  TF_RETURN_IF_ERROR(RunLatencyHidingScheduler(module, &pipeline));
+  return MaybeOffloadToHostMemory(module, pointer_size, gpu_info,
+                                  compute_capability, config.memory_limit);
 }
 
 }  // namespace gpu
@@ -22,15 +22,81 @@ limitations under the License.
 #include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
 #include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/compiler/xla/service/latency_hiding_scheduler.h"
+#include "tensorflow/compiler/xla/stream_executor/device_description.h"
 
 namespace xla {
 namespace gpu {
 
 int64_t GetSizeOfShape(const Shape& shape, int pointer_size);
 
+// Time taken by a transfer of some bytes over a link.
+struct LinkModel {
+  double latency_us;
+  double gigabytes_per_second;
+
+  double TransferTimeUs(int64_t bytes) const {
+    return latency_us + bytes / (gigabytes_per_second * 1e3);
+  }
+};
+
+// Approximate models of the links a GPU transfers data over. The figures are
+// rough estimates of the effective bandwidths and latencies of typical systems
+// of each generation, not measurements or peak numbers.
+struct GpuLatencyModel {
+  // Between the GPUs of one host, e.g. NVLink.
+  LinkModel intra_host;
+  // Between a GPU and its host's memory (PCIe).
+  LinkModel host;
+  // Between GPUs of different hosts, e.g. InfiniBand.
+  LinkModel cross_host;
+};
+
+// Returns the link models of GPUs with `compute_capability`.
+GpuLatencyModel GetLatencyModel(
+    const se::CudaComputeCapability& compute_capability);
+
+// Returns whether `collective` is assumed to communicate between GPUs of
+// different hosts, i.e. whether some of its devices are more than a host size
+// apart.
+bool IsCrossHostCollective(const HloInstruction& collective);
+
+// Latency estimator of the GPU latency hiding scheduler.
+class GpuLatencyEstimator : public ApproximateLatencyEstimator {
+ public:
+  explicit GpuLatencyEstimator(
+      const se::CudaComputeCapability& compute_capability);
+
+  // Collectives within a host keep the approximate latency of an async op.
+  // Transfers to or from host memory and collectives across hosts are scaled
+  // up by how much slower their link is than the intra-host one for the same
+  // amount of data, so that more work is scheduled to overlap them.
+  TimeCost GetLatencyBetween(const HloGraphNode& from,
+                             const HloGraphNode& target) const override;
+  TimeCost NodeCost(const HloInstruction* instr) const override;
+
+ private:
+  GpuLatencyModel model_;
+};
+
+// Returns whether `module` has any asynchronous operation the latency hiding
+// scheduler could overlap with other work.
+bool HasSupportedAsyncOps(const HloModule& module,
+                          const AsyncTracker& async_tracker);
+
+// Runs the latency hiding `scheduler` on `module`. If it fails, logs a warning
+// and restores the schedule the module had before.
+Status RunLatencyHidingScheduler(HloModule* module,
+                                 HloPassInterface* scheduler);
+
 // Determines the schedule of HLO instructions for a module run on the GPU.
+// Unless disabled, modules with asynchronous collectives or transfers are
+// scheduled by the latency hiding scheduler, whose latency estimates depend on
+// the links of the `compute_capability` platform.
 Status ScheduleGpuModule(HloModule* module, int64_t pointer_size,
-                         const GpuDeviceInfo& gpu_info);
+                         const GpuDeviceInfo& gpu_info,
+                         const se::CudaComputeCapability& compute_capability);
 
 }  // namespace gpu
 }  // namespace xla
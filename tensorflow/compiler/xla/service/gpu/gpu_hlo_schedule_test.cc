@@ -21,14 +21,19 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_opcode.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/compiler/xla/service/latency_hiding_scheduler.h"
+#include "tensorflow/compiler/xla/stream_executor/device_description.h"
 #include "tensorflow/compiler/xla/test_helpers.h"
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/compiler/xla/tests/test_utils.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
 
 namespace xla {
 namespace gpu {
@@ -42,9 +47,11 @@ class GpuHloScheduleTest : public HloTestBase {
 
   SequentialHloOrdering BuildHloOrdering(HloModule* module) {
     Backend& test_backend = backend();
-    const GpuDeviceInfo gpu_device_info =
-        GetGpuDeviceInfo(test_backend.default_stream_executor());
-    TF_CHECK_OK(ScheduleGpuModule(module, /*pointer_size=*/8, gpu_device_info));
+    se::StreamExecutor* stream_exec = test_backend.default_stream_executor();
+    const GpuDeviceInfo gpu_device_info = GetGpuDeviceInfo(stream_exec);
+    TF_CHECK_OK(ScheduleGpuModule(
+        module, /*pointer_size=*/8, gpu_device_info,
+        stream_exec->GetDeviceDescription().cuda_compute_capability()));
     return SequentialHloOrdering{module->schedule()};
   }
 
@@ -301,6 +308,196 @@ TEST_F(GpuHloScheduleTest, LHSCostModel) {
   EXPECT_GT(count_between_pairs[1], 0);
 }
 
+TEST_F(GpuHloScheduleTest, GpuLatencyModel) {
+  const GpuLatencyModel hopper =
+      GetLatencyModel(se::CudaComputeCapability(9, 0));
+  const GpuLatencyModel ampere =
+      GetLatencyModel(se::CudaComputeCapability(8, 0));
+  const GpuLatencyModel volta =
+      GetLatencyModel(se::CudaComputeCapability(7, 0));
+  const GpuLatencyModel pascal =
+      GetLatencyModel(se::CudaComputeCapability(6, 0));
+
+  // Newer generations have faster links.
+  EXPECT_GT(hopper.intra_host.gigabytes_per_second,
+            ampere.intra_host.gigabytes_per_second);
+  EXPECT_GT(ampere.intra_host.gigabytes_per_second,
+            volta.intra_host.gigabytes_per_second);
+  EXPECT_GT(hopper.host.gigabytes_per_second, ampere.host.gigabytes_per_second);
+
+  // Within a generation, going through the host or the network is slower than
+  // staying within the host, except before NVLink.
+  constexpr int64_t kBytes = 1 << 20;
+  for (const GpuLatencyModel& model : {hopper, ampere, volta}) {
+    EXPECT_GT(model.host.TransferTimeUs(kBytes),
+              model.intra_host.TransferTimeUs(kBytes));
+    EXPECT_GT(model.cross_host.TransferTimeUs(kBytes),
+              model.intra_host.TransferTimeUs(kBytes));
+  }
+  EXPECT_EQ(pascal.host.TransferTimeUs(kBytes),
+            pascal.intra_host.TransferTimeUs(kBytes));
+}
+
+TEST_F(GpuHloScheduleTest, IsCrossHostCollective) {
+  const char* hlo_text = R"(
+  HloModule m
+  apply_op {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT apply_op = f32[] add(x, y)
+  }
+
+  ENTRY e {
+    p0 = f32[32] parameter(0)
+    ar-host = f32[32] all-reduce(p0), replica_groups={{0,1,2,3,4,5,6,7},{8,9,10,11,12,13,14,15}}, to_apply=apply_op
+    ar-all = f32[32] all-reduce(p0), replica_groups={}, to_apply=apply_op
+    cp-host = f32[32] collective-permute(p0), source_target_pairs={{0,1},{8,9}}
+    cp-cross = f32[32] collective-permute(p0), source_target_pairs={{0,8}}
+    ROOT t = (f32[32], f32[32], f32[32], f32[32]) tuple(ar-host, ar-all, cp-host, cp-cross)
+  })";
+
+  HloModuleConfig config = GetModuleConfig(
+      /*enable_latency_hiding_scheduler=*/true);
+  config.set_replica_count(16);
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_text, config));
+  auto is_cross_host = [&](absl::string_view name) {
+    return IsCrossHostCollective(*FindInstruction(module.get(), name));
+  };
+  EXPECT_FALSE(is_cross_host("ar-host"));
+  EXPECT_TRUE(is_cross_host("ar-all"));
+  EXPECT_FALSE(is_cross_host("cp-host"));
+  EXPECT_TRUE(is_cross_host("cp-cross"));
+
+  // All devices fit into one host.
+  config.set_replica_count(8);
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto small_module,
+      ParseAndReturnVerifiedModule(R"(
+  HloModule m
+  apply_op {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT apply_op = f32[] add(x, y)
+  }
+
+  ENTRY e {
+    p0 = f32[32] parameter(0)
+    ROOT ar-all = f32[32] all-reduce(p0), replica_groups={}, to_apply=apply_op
+  })",
+                                   config));
+  EXPECT_FALSE(
+      IsCrossHostCollective(*FindInstruction(small_module.get(), "ar-all")));
+}
+
+TEST_F(GpuHloScheduleTest, GpuLatencyEstimatorScalesSlowLinks) {
+  const char* hlo_text = R"(
+  HloModule m
+  apply_op {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT apply_op = f32[] add(x, y)
+  }
+
+  ENTRY e {
+    p0 = f32[1024] parameter(0)
+    ar-host-start = f32[1024] all-reduce-start(p0), replica_groups={{0,1,2,3,4,5,6,7},{8,9,10,11,12,13,14,15}}, to_apply=apply_op
+    ar-host-done = f32[1024] all-reduce-done(ar-host-start)
+    ar-all-start = f32[1024] all-reduce-start(p0), replica_groups={}, to_apply=apply_op
+    ar-all-done = f32[1024] all-reduce-done(ar-all-start)
+    copy-start = (f32[1024], f32[1024], u32[]) copy-start(p0)
+    copy-done = f32[1024] copy-done(copy-start)
+    token = token[] after-all()
+    send = (f32[1024], u32[], token[]) send(p0, token), channel_id=1, is_host_transfer=true
+    send-done = token[] send-done(send), channel_id=1, is_host_transfer=true
+    ROOT t = (f32[1024], f32[1024], f32[1024], token[]) tuple(ar-host-done, ar-all-done, copy-done, send-done)
+  })";
+
+  HloModuleConfig config = GetModuleConfig(
+      /*enable_latency_hiding_scheduler=*/true);
+  config.set_replica_count(16);
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_text, config));
+
+  GpuLatencyEstimator estimator(se::CudaComputeCapability(8, 0));
+  auto latency = [&](absl::string_view from, absl::string_view target) {
+    HloGraphNode from_node(FindInstruction(module.get(), from),
+                           /*original_position=*/0);
+    HloGraphNode target_node(FindInstruction(module.get(), target),
+                             /*original_position=*/1);
+    return estimator.GetLatencyBetween(from_node, target_node);
+  };
+
+  // Synchronous instructions and collectives within a host keep the
+  // approximate latencies.
+  EXPECT_EQ(latency("p0", "ar-host-start"),
+            ApproximateLatencyEstimator::kLowCost);
+  EXPECT_EQ(latency("ar-host-start", "ar-host-done"),
+            ApproximateLatencyEstimator::kHighCost);
+  // Collectives across hosts and transfers to the host take longer.
+  EXPECT_GT(latency("ar-all-start", "ar-all-done"),
+            ApproximateLatencyEstimator::kHighCost);
+  EXPECT_GT(latency("copy-start", "copy-done"),
+            ApproximateLatencyEstimator::kHighCost);
+  EXPECT_GT(latency("send", "send-done"),
+            ApproximateLatencyEstimator::kHighCost);
+}
+
+TEST_F(GpuHloScheduleTest, HasSupportedAsyncOps) {
+  const char* hlo_text = R"(
+  HloModule m
+
+  ENTRY e {
+    p0 = f32[32] parameter(0)
+    token = token[] after-all()
+    send = (f32[32], u32[], token[]) send(p0, token), channel_id=1, is_host_transfer=true
+    ROOT send-done = token[] send-done(send), channel_id=1, is_host_transfer=true
+  })";
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(hlo_text));
+
+  SchedulerConfig config;
+  EXPECT_FALSE(HasSupportedAsyncOps(*module, AsyncTracker(config)));
+  config.schedule_send_recvs = true;
+  EXPECT_TRUE(HasSupportedAsyncOps(*module, AsyncTracker(config)));
+}
+
+// A scheduler that clobbers the schedule and then fails.
+class FailingScheduler : public HloModulePass {
+ public:
+  absl::string_view name() const override { return "failing-scheduler"; }
+
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads)
+      override {
+    module->schedule().set_sequence(module->entry_computation(),
+                                    HloInstructionSequence());
+    return InternalError("Scheduling failed");
+  }
+};
+
+TEST_F(GpuHloScheduleTest, FallsBackToMemorySchedule) {
+  const char* hlo_text = R"(
+  HloModule m, is_scheduled=true
+
+  ENTRY e {
+    p0 = f32[32] parameter(0)
+    p1 = f32[32] parameter(1)
+    add0 = f32[32] add(p0, p1)
+    ROOT add1 = f32[32] add(add0, p1)
+  })";
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(hlo_text));
+  const std::vector<int> ids = module->schedule()
+                                   .sequence(module->entry_computation())
+                                   .ids();
+
+  FailingScheduler scheduler;
+  TF_ASSERT_OK(RunLatencyHidingScheduler(module.get(), &scheduler));
+  EXPECT_EQ(module->schedule().sequence(module->entry_computation()).ids(),
+            ids);
+}
+
 class GpuHloScheduleParameterizedTest
     : public GpuHloScheduleTest,
       public ::testing::WithParamInterface<bool> {};
@@ -0,0 +1,295 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/host_memory_offloader.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_opcode.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_schedule.h"
+#include "tensorflow/compiler/xla/hlo/utils/hlo_live_range.h"
+#include "tensorflow/compiler/xla/layout.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_performance_model.h"
+#include "tensorflow/compiler/xla/service/hlo_alias_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_buffer.h"
+#include "tensorflow/compiler/xla/service/hlo_value.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+using LogicalTime = HloLiveRange::LogicalTime;
+
+bool IsHostMemory(const Shape& shape) {
+  return shape.has_layout() &&
+         shape.layout().memory_space() == Layout::kHostMemorySpace;
+}
+
+// An interval of the entry schedule in which an offloading candidate is live
+// but not used.
+struct Offload {
+  HloInstruction* value;
+  // Schedule positions of the instruction defining or last using `value`
+  // before the interval, and of the first user of `value` after it.
+  LogicalTime begin;
+  LogicalTime end;
+  int64_t bytes;
+};
+
+// Estimated run time of each entry instruction and its prefix sums over the
+// schedule, so that the compute time of any interval can be looked up.
+class ComputeTimeline {
+ public:
+  static StatusOr<ComputeTimeline> Build(
+      const HloInstructionSequence& sequence, HloComputation* computation,
+      const HloCostAnalysis::ShapeSizeFunction& shape_size,
+      const GpuDeviceInfo& gpu_device_info) {
+    GpuHloCostAnalysis cost_analysis(GpuHloCostAnalysis::Options{
+        shape_size, /*per_second_rates=*/{},
+        /*count_multiple_input_accesses=*/true});
+    TF_RETURN_IF_ERROR(computation->Accept(&cost_analysis));
+
+    ComputeTimeline timeline;
+    timeline.prefix_sums_.reserve(sequence.size() + 1);
+    timeline.prefix_sums_.push_back(absl::ZeroDuration());
+    for (const HloInstruction* instr : sequence.instructions()) {
+      absl::Duration time = absl::ZeroDuration();
+      switch (instr->opcode()) {
+        case HloOpcode::kParameter:
+        case HloOpcode::kConstant:
+        case HloOpcode::kTuple:
+        case HloOpcode::kGetTupleElement:
+        case HloOpcode::kBitcast:
+          break;
+        default:
+          time = GpuPerformanceModel::EstimateRunTimes(instr, &cost_analysis,
+                                                       gpu_device_info)
+                     .time_unfused;
+      }
+      timeline.prefix_sums_.push_back(timeline.prefix_sums_.back() + time);
+    }
+    return timeline;
+  }
+
+  // Time spent in the instructions strictly between `begin` and `end`.
+  absl::Duration Between(LogicalTime begin, LogicalTime end) const {
+    return prefix_sums_[end] - prefix_sums_[begin + 1];
+  }
+
+ private:
+  std::vector<absl::Duration> prefix_sums_;
+};
+
+class Offloader {
+ public:
+  Offloader(HloModule* module, const HostMemoryOffloader::Options& options,
+            const HloCostAnalysis::ShapeSizeFunction& shape_size,
+            const GpuDeviceInfo& gpu_device_info)
+      : module_(module),
+        entry_(module->entry_computation()),
+        options_(options),
+        shape_size_(shape_size),
+        gpu_device_info_(gpu_device_info) {}
+
+  StatusOr<bool> Run() {
+    bool changed = false;
+    TF_ASSIGN_OR_RETURN(
+        ComputeTimeline timeline,
+        ComputeTimeline::Build(module_->schedule().sequence(entry_), entry_,
+                               shape_size_, gpu_device_info_));
+    // Each offload shifts the schedule positions, so the timeline is rebuilt
+    // after every rewrite.
+    while (true) {
+      TF_ASSIGN_OR_RETURN(std::optional<Offload> offload,
+                          FindOffload(timeline));
+      if (!offload.has_value()) break;
+      TF_RETURN_IF_ERROR(Apply(*offload));
+      changed = true;
+      TF_ASSIGN_OR_RETURN(
+          timeline,
+          ComputeTimeline::Build(module_->schedule().sequence(entry_), entry_,
+                                 shape_size_, gpu_device_info_));
+    }
+    return changed;
+  }
+
+ private:
+  // Returns the next value to offload, or nullopt once the peak fits into the
+  // memory limit or no value can lower it.
+  StatusOr<std::optional<Offload>> FindOffload(
+      const ComputeTimeline& timeline) {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<HloAliasAnalysis> alias_analysis,
+                        HloAliasAnalysis::Run(module_));
+    TF_ASSIGN_OR_RETURN(
+        std::unique_ptr<HloLiveRange> live_range,
+        HloLiveRange::Run(module_->schedule(), *alias_analysis, entry_));
+    const auto& live_ranges = live_range->buffer_live_ranges();
+
+    // Device memory in use at every point of the schedule, from a difference
+    // array over the buffer live ranges.
+    std::vector<int64_t> usage(live_range->schedule_end_time() + 2, 0);
+    for (const HloBuffer& buffer : alias_analysis->buffers()) {
+      std::optional<LogicalTime> start, end;
+      for (const HloValue* value : buffer.values()) {
+        auto it = live_ranges.find(value);
+        if (it == live_ranges.end()) continue;
+        start = std::min(start.value_or(it->second.start), it->second.start);
+        end = std::max(end.value_or(it->second.end), it->second.end);
+      }
+      const Shape& shape = buffer.values()[0]->shape();
+      if (!start.has_value() || IsHostMemory(shape)) continue;
+      int64_t bytes = shape_size_(shape);
+      usage[*start] += bytes;
+      usage[*end + 1] -= bytes;
+    }
+    LogicalTime peak_time = 0;
+    int64_t peak = 0, current = 0;
+    for (LogicalTime t = 0; t < usage.size(); ++t) {
+      current += usage[t];
+      if (current > peak) {
+        peak = current;
+        peak_time = t;
+      }
+    }
+    if (peak <= options_.device_memory_limit) return {std::nullopt};
+    VLOG(2) << "Peak device memory " << peak << " at " << peak_time
+            << " exceeds limit " << options_.device_memory_limit;
+
+    const auto& schedule = live_range->instruction_schedule();
+    std::optional<Offload> best;
+    for (const HloBuffer& buffer : alias_analysis->buffers()) {
+      if (buffer.values().size() != 1) continue;
+      const HloValue& value = buffer.GetUniqueValue();
+      HloInstruction* instr = value.defining_instruction();
+      if (instr->parent() != entry_ || !value.defining_index().empty() ||
+          !value.shape().IsArray() || value.live_out_of_module() ||
+          IsHostMemory(value.shape()) || offload_copies_.contains(instr) ||
+          instr->opcode() == HloOpcode::kParameter ||
+          instr->opcode() == HloOpcode::kConstant) {
+        continue;
+      }
+      int64_t bytes = shape_size_(value.shape());
+      if (bytes < options_.min_offload_bytes) continue;
+
+      // The unused interval of the value around the peak, if any.
+      LogicalTime begin = schedule.at(instr);
+      std::optional<LogicalTime> end;
+      for (const HloUse& use : value.GetUses()) {
+        LogicalTime time = schedule.at(use.instruction);
+        if (time <= peak_time) {
+          begin = std::max(begin, time);
+        } else {
+          end = std::min(end.value_or(time), time);
+        }
+      }
+      if (!end.has_value() || begin >= peak_time) continue;
+
+      absl::Duration transfer =
+          absl::Seconds(2.0 * bytes / options_.host_bandwidth_bytes_per_second);
+      if (timeline.Between(begin, *end) < 2 * transfer) continue;
+
+      Offload candidate{instr, begin, *end, bytes};
+      auto score = [](const Offload& o) {
+        return static_cast<double>(o.bytes) * (o.end - o.begin);
+      };
+      if (!best.has_value() || score(candidate) > score(*best)) {
+        best = candidate;
+      }
+    }
+    return best;
+  }
+
+  Status Apply(const Offload& offload) {
+    HloInstruction* value = offload.value;
+    const std::vector<HloInstruction*>& sequence = entry_sequence();
+    HloInstruction* before = sequence[offload.begin];
+    HloInstruction* user = sequence[offload.end];
+    VLOG(1) << "Offloading " << value->name() << " (" << offload.bytes
+            << " bytes) to host memory between " << before->name() << " and "
+            << user->name();
+
+    Shape host_shape = value->shape();
+    host_shape.mutable_layout()->set_memory_space(Layout::kHostMemorySpace);
+    HloInstruction* to_host = entry_->AddInstruction(
+        HloInstruction::CreateUnary(host_shape, HloOpcode::kCopy, value),
+        absl::StrCat(value->name(), ".host"));
+    HloInstruction* to_device = entry_->AddInstruction(
+        HloInstruction::CreateUnary(value->shape(), HloOpcode::kCopy, to_host),
+        absl::StrCat(value->name(), ".device"));
+    offload_copies_.insert(to_host);
+    offload_copies_.insert(to_device);
+
+    // Every user from `user` on reads the copy brought back to the device.
+    for (LogicalTime t = offload.end; t < sequence.size(); ++t) {
+      if (absl::c_linear_search(value->users(), sequence[t])) {
+        TF_RETURN_IF_ERROR(value->ReplaceUseWith(sequence[t], to_device));
+      }
+    }
+
+    HloInstructionSequence new_sequence;
+    for (LogicalTime t = 0; t < sequence.size(); ++t) {
+      if (t == offload.end) new_sequence.push_back(to_device);
+      new_sequence.push_back(sequence[t]);
+      if (t == offload.begin) new_sequence.push_back(to_host);
+    }
+    module_->schedule().set_sequence(entry_, std::move(new_sequence));
+    return OkStatus();
+  }
+
+  const std::vector<HloInstruction*>& entry_sequence() const {
+    return module_->schedule().sequence(entry_).instructions();
+  }
+
+  HloModule* module_;
+  HloComputation* entry_;
+  const HostMemoryOffloader::Options& options_;
+  const HloCostAnalysis::ShapeSizeFunction& shape_size_;
+  const GpuDeviceInfo& gpu_device_info_;
+  absl::flat_hash_set<const HloInstruction*> offload_copies_;
+};
+
+}  // namespace
+
+StatusOr<bool> HostMemoryOffloader::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  if (!module->has_schedule()) {
+    return InternalError("HostMemoryOffloader requires a scheduled module.");
+  }
+  TF_ASSIGN_OR_RETURN(
+      bool changed,
+      Offloader(module, options_, shape_size_, gpu_device_info_).Run());
+  if (changed) {
+    TF_RETURN_IF_ERROR(module->schedule().Verify());
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
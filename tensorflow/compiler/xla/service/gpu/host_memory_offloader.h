@@ -0,0 +1,88 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_MEMORY_OFFLOADER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_MEMORY_OFFLOADER_H_
+
+#include <cstdint>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/compiler/xla/statusor.h"
+
+namespace xla {
+namespace gpu {
+
+// Uses pinned host memory as an overflow memory space for activations that
+// would otherwise not fit into device memory.
+//
+// Runs on a scheduled module.  Like the heap simulator, it derives the device
+// memory in use at every point of the schedule from the live ranges of the
+// buffers.  While that exceeds `device_memory_limit`, it picks a value of the
+// entry computation which is live across the peak but not used there, and
+// offloads it for its longest unused interval:
+//
+//   v = op(...)          v = op(...)
+//   ...                  v.host = copy(v)    // in Layout::kHostMemorySpace
+//   user(v)       =>     ...
+//                        v.device = copy(v.host)
+//                        user(v.device)
+//
+// Preferred values are the ones which free the most memory for the longest;
+// a value is only offloaded if the work scheduled within its unused interval,
+// as estimated by the GPU cost analysis, takes at least twice as long as
+// moving it to the host and back over `host_bandwidth_bytes_per_second`.
+//
+// The offload copies currently run on the compute stream, so offloading trades
+// execution time for memory.  The schedule is updated in place.
+class HostMemoryOffloader : public HloModulePass {
+ public:
+  struct Options {
+    // Device memory available to the buffers of the module.
+    int64_t device_memory_limit;
+    // Buffers smaller than this are never offloaded.
+    int64_t min_offload_bytes = 1 << 20;
+    // Bandwidth of copies between device and pinned host memory.
+    double host_bandwidth_bytes_per_second = 12e9;
+  };
+
+  HostMemoryOffloader(const Options& options,
+                      HloCostAnalysis::ShapeSizeFunction shape_size,
+                      const GpuDeviceInfo& gpu_device_info)
+      : options_(options),
+        shape_size_(std::move(shape_size)),
+        gpu_device_info_(gpu_device_info) {}
+
+  absl::string_view name() const override { return "host-memory-offloader"; }
+
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+ private:
+  Options options_;
+  HloCostAnalysis::ShapeSizeFunction shape_size_;
+  GpuDeviceInfo gpu_device_info_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_MEMORY_OFFLOADER_H_
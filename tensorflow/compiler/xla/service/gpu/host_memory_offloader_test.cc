@@ -0,0 +1,110 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/host_memory_offloader.h"
+
+#include <memory>
+
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/hlo/utils/hlo_matchers.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_device_info_for_tests.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+// The entry keeps up to four f32[1024,1024] (4MiB) buffers live at once; `a`
+// is unused while `b`, `c` and `d` are computed.
+constexpr absl::string_view kHlo = R"(
+HloModule m, is_scheduled=true
+
+ENTRY e {
+  p0 = f32[1024,1024] parameter(0)
+  a = f32[1024,1024] exponential(p0)
+  b = f32[1024,1024] log(p0)
+  c = f32[1024,1024] sine(b)
+  d = f32[1024,1024] negate(c)
+  ROOT r = f32[1024,1024] add(a, d)
+})";
+
+constexpr int64_t kBufferBytes = 4 << 20;
+
+class HostMemoryOffloaderTest : public HloTestBase {
+ protected:
+  StatusOr<bool> RunOffloader(HloModule* module,
+                              const HostMemoryOffloader::Options& options) {
+    return HostMemoryOffloader(
+               options,
+               [](const Shape& shape) { return ShapeUtil::ByteSizeOf(shape); },
+               TestGpuDeviceInfo::RTXA6000DeviceInfo())
+        .Run(module);
+  }
+};
+
+TEST_F(HostMemoryOffloaderTest, OffloadsValueLiveAcrossPeak) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHlo));
+  HostMemoryOffloader::Options options;
+  options.device_memory_limit = 3 * kBufferBytes + kBufferBytes / 2;
+  // Make the transfers cheap enough to hide behind the elementwise ops.
+  options.host_bandwidth_bytes_per_second = 1e15;
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunOffloader(module.get(), options));
+  EXPECT_TRUE(changed);
+
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root,
+              op::Add(op::Copy(op::Copy(op::Exp(op::Parameter(0)))),
+                      op::Negate()));
+  const HloInstruction* to_host = root->operand(0)->operand(0);
+  EXPECT_EQ(to_host->shape().layout().memory_space(),
+            Layout::kHostMemorySpace);
+  EXPECT_EQ(root->operand(0)->shape().layout().memory_space(),
+            Layout::kDefaultMemorySpace);
+
+  // The copies are scheduled around the interval in which `a` is unused.
+  const auto& sequence =
+      module->schedule().sequence(module->entry_computation()).instructions();
+  ASSERT_EQ(sequence.size(), 8);
+  EXPECT_EQ(sequence[1]->name(), "a");
+  EXPECT_EQ(sequence[2], to_host);
+  EXPECT_EQ(sequence[6], root->operand(0));
+  EXPECT_EQ(sequence[7], root);
+}
+
+TEST_F(HostMemoryOffloaderTest, NoOffloadWithinMemoryLimit) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHlo));
+  HostMemoryOffloader::Options options;
+  options.device_memory_limit = 4 * kBufferBytes;
+  options.host_bandwidth_bytes_per_second = 1e15;
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunOffloader(module.get(), options));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(HostMemoryOffloaderTest, NoOffloadIfTransferCannotBeHidden) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHlo));
+  HostMemoryOffloader::Options options;
+  options.device_memory_limit = 3 * kBufferBytes + kBufferBytes / 2;
+  // With the default PCIe bandwidth, moving 4MiB takes much longer than the
+  // three elementwise ops.
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunOffloader(module.get(), options));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -101,6 +101,12 @@ FusionDecision GpuInstructionFusion::ShouldFuse(HloInstruction* consumer,
   auto producer = consumer->operand(operand_index);
 
   // The following checks are potentially expensive.
+  if (fusion_profile_ != nullptr &&
+      fusion_profile_->Lookup(*producer, *consumer) ==
+          FusionProfile::Verdict::kUnprofitable) {
+    return "the fusion ran slower than estimated when profiled";
+  }
+
   if (NoFusionPossible too_large =
           !FusionFitsInBudget(*consumer, *producer, device_info_,
                               /*is_consumer_producer_fusion=*/true)) {
@@ -23,6 +23,7 @@ limitations under the License.
 #include "absl/strings/string_view.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/fusion_node_indexing_evaluation.h"
+#include "tensorflow/compiler/xla/service/gpu/fusion_profile.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
 #include "tensorflow/compiler/xla/service/instruction_fusion.h"
 
@@ -31,9 +32,12 @@ namespace gpu {
 
 class GpuInstructionFusion : public InstructionFusion {
  public:
-  explicit GpuInstructionFusion(bool may_duplicate, const GpuDeviceInfo& d)
+  // If `fusion_profile` is given, fusions it found unprofitable are not formed.
+  explicit GpuInstructionFusion(bool may_duplicate, const GpuDeviceInfo& d,
+                                const FusionProfile* fusion_profile = nullptr)
       : InstructionFusion(GpuInstructionFusion::IsExpensive, may_duplicate),
-        device_info_(d) {}
+        device_info_(d),
+        fusion_profile_(fusion_profile) {}
 
   static bool IsExpensive(const HloInstruction& instruction);
 
@@ -67,6 +71,7 @@ class GpuInstructionFusion : public InstructionFusion {
       fusion_node_evaluations_;
 
   const GpuDeviceInfo device_info_;
+  const FusionProfile* fusion_profile_;
 };
 
 }  // namespace gpu
@@ -201,6 +201,36 @@ ma::ConstantOp CreateConst(mlir::ImplicitLocOpBuilder b, Type type, int value,
   LOG(FATAL) << "Constant type not supported: " << llvm_ir::DumpToString(type);
 }
 
+// Applies an elementwise epilogue instruction fused by GemmRewriterTriton to
+// the output tile.
+Value EmitEpilogueInstruction(mlir::ImplicitLocOpBuilder& b,
+                              const HloInstruction& hlo,
+                              mlir::ValueRange inputs) {
+  switch (hlo.opcode()) {
+    case HloOpcode::kBitcast:
+      return inputs[0];
+    case HloOpcode::kConvert:
+      return Cast(b, b.getLoc(), inputs[0],
+                  TritonType(b, hlo.shape().element_type()));
+    case HloOpcode::kNegate:
+      return b.create<ma::NegFOp>(inputs[0]);
+    case HloOpcode::kAdd:
+      return b.create<ma::AddFOp>(inputs[0], inputs[1]);
+    case HloOpcode::kSubtract:
+      return b.create<ma::SubFOp>(inputs[0], inputs[1]);
+    case HloOpcode::kMultiply:
+      return b.create<ma::MulFOp>(inputs[0], inputs[1]);
+    case HloOpcode::kDivide:
+      return b.create<ma::DivFOp>(inputs[0], inputs[1]);
+    case HloOpcode::kMaximum:
+      return b.create<ma::MaxFOp>(inputs[0], inputs[1]);
+    case HloOpcode::kMinimum:
+      return b.create<ma::MinFOp>(inputs[0], inputs[1]);
+    default:
+      LOG(FATAL) << "Unsupported epilogue instruction: " << hlo.ToString();
+  }
+}
+
 void CreateTritonPipeline(mlir::OpPassManager& pm,
                           const se::CudaComputeCapability& cc, int num_warps,
                           int num_stages) {
@@ -636,16 +666,19 @@ std::optional<LaunchDimensions> MatMul(
   auto out_offset_m =
       b.create<ma::MulIOp>(b.create<mt::ExpandDimsOp>(range_m, 1),
                            CreateConst(b, i32_ty, stride_out_m, shape_m_1));
-  mt::AddPtrOp out_ptrs_m =
-      build_addptr(build_splat(build_addptr(out, out_offset_batch), shape_m_1),
-                   out_offset_m);
-
   auto out_offset_n =
       b.create<ma::MulIOp>(b.create<mt::ExpandDimsOp>(range_n, 0),
                            CreateConst(b, i32_ty, stride_out_n, shape_1_n));
-  mt::AddPtrOp out_ptrs = build_addptr(
-      build_bcast(out_ptrs_m.getResult().cast<TensorValue>(), shape_m_n),
-      build_bcast(out_offset_n.getResult().cast<TensorValue>(), shape_m_n));
+  // Pointers to the output tile of a tensor shaped like the dot() output.
+  auto build_out_ptrs = [&](Value base) {
+    mt::AddPtrOp ptrs_m = build_addptr(
+        build_splat(build_addptr(base, out_offset_batch), shape_m_1),
+        out_offset_m);
+    return build_addptr(
+        build_bcast(ptrs_m.getResult().cast<TensorValue>(), shape_m_n),
+        build_bcast(out_offset_n.getResult().cast<TensorValue>(), shape_m_n));
+  };
+  mt::AddPtrOp out_ptrs = build_out_ptrs(out);
 
   // Output tile store mask: check that the indices are within [M, N].
   auto rm_cmp = b.create<ma::CmpIOp>(ma::CmpIPredicate::slt,
@@ -658,7 +691,77 @@ std::optional<LaunchDimensions> MatMul(
       build_bcast(rm_cmp.getResult().cast<TensorValue>(), shape_m_n),
       build_bcast(rn_cmp.getResult().cast<TensorValue>(), shape_m_n));
 
-  b.create<mt::StoreOp>(out_ptrs, Cast(b, loc, acc_final, root_ty), mask);
+  // Index of the output dimensions: optional batch, then M and N. A split
+  // LHS non-contracting dimension is M of the output, so it is offset by the
+  // program ID that iterates over its upper part.
+  const int64_t out_m_dim = batch ? 1 : 0;
+  const int64_t out_n_dim = out_m_dim + 1;
+  Value out_range_m = range_m;
+  if (lhs_nc_split) {
+    out_range_m = b.create<ma::AddIOp>(
+        range_m,
+        build_splat(b.create<ma::MulIOp>(pid2, CreateConst(b, i32_ty, m)),
+                    block_m));
+  }
+
+  // Loads the tile of an operand of the fused epilogue other than the
+  // preceding epilogue instruction.
+  auto emit_epilogue_operand = [&](const HloInstruction* hlo) -> Value {
+    Type ty = TritonType(b, hlo->shape().element_type());
+    if (hlo->opcode() == HloOpcode::kParameter) {
+      return b.create<mt::LoadOp>(
+          build_out_ptrs(fn.getArgument(hlo->parameter_number())), mask,
+          CreateConst(b, ty, 0, shape_m_n), mt::CacheModifier::NONE,
+          mt::EvictionPolicy::NORMAL, /*isVolatile=*/false);
+    }
+    CHECK_EQ(hlo->opcode(), HloOpcode::kBroadcast);
+    const HloInstruction* input = hlo->operand(0);
+    if (input->opcode() == HloOpcode::kConstant) {
+      const std::optional<double> value = input->literal().GetAsDouble({});
+      CHECK(value.has_value());
+      return build_splat(b.create<ma::ConstantOp>(b.getFloatAttr(ty, *value)),
+                         shape_m_n);
+    }
+    // A bias vector along M or N.
+    CHECK_EQ(input->opcode(), HloOpcode::kParameter);
+    const bool along_m = hlo->dimensions(0) == out_m_dim;
+    CHECK(along_m || hlo->dimensions(0) == out_n_dim);
+    const int block = along_m ? block_m : block_n;
+    Value range = along_m ? out_range_m : range_n;
+    Value range_mask = b.create<ma::CmpIOp>(
+        ma::CmpIPredicate::slt, along_m ? range_m : range_n,
+        CreateConst(b, i32_ty, along_m ? m : n, block));
+    Value bias = b.create<mt::LoadOp>(
+        build_addptr(
+            build_splat(fn.getArgument(input->parameter_number()), block),
+            range),
+        range_mask, CreateConst(b, ty, 0, block), mt::CacheModifier::NONE,
+        mt::EvictionPolicy::NORMAL, /*isVolatile=*/false);
+    return build_bcast(b.create<mt::ExpandDimsOp>(bias, along_m ? 1 : 0)
+                           .getResult()
+                           .cast<TensorValue>(),
+                       shape_m_n);
+  };
+
+  // Apply the epilogue fused after dot() on the output tile.
+  Value result = Cast(b, loc, acc_final, root_ty);
+  const HloInstruction* fusion_root = dot_instr->parent()->root_instruction();
+  for (const HloInstruction* hlo = dot_instr; hlo != fusion_root;) {
+    CHECK_EQ(hlo->user_count(), 1);
+    const HloInstruction* user = hlo->users()[0];
+    SmallVector<Value, 2> inputs;
+    for (const HloInstruction* operand : user->operands()) {
+      inputs.push_back(operand == hlo ? result
+                                      : emit_epilogue_operand(operand));
+    }
+    result = EmitEpilogueInstruction(b, *user, inputs);
+    hlo = user;
+  }
+
+  b.create<mt::StoreOp>(
+      out_ptrs,
+      Cast(b, loc, result, TritonType(b, fusion_root->shape().element_type())),
+      mask);
   return launch_dimensions;
 }
 
@@ -675,12 +778,17 @@ std::optional<LaunchDimensions> TritonWrapper(
   auto triton_module = mlir::ModuleOp::create(loc);
   b.setInsertionPointToEnd(triton_module.getBody());
 
-  const HloInstruction* root =
-      (hlo_computation->root_instruction()->opcode() == HloOpcode::kBitcast)
-          ? hlo_computation->root_instruction()->operand(0)
-          : hlo_computation->root_instruction();
-  CHECK_EQ(root->opcode(), HloOpcode::kDot);
-  VLOG(3) << root->parent()->ToString();
+  // The root is either the dot() or the last instruction of the epilogue
+  // fused after it.
+  const HloInstruction* dot = nullptr;
+  for (const HloInstruction* hlo : hlo_computation->instructions()) {
+    if (hlo->opcode() == HloOpcode::kDot) {
+      dot = hlo;
+      break;
+    }
+  }
+  CHECK_NE(dot, nullptr);
+  VLOG(3) << hlo_computation->ToString();
 
   VLOG(2) << config.DebugString();
 
@@ -704,7 +812,7 @@ std::optional<LaunchDimensions> TritonWrapper(
   b.setInsertionPointToStart(&fn.front());
 
   std::optional<LaunchDimensions> launch_dimensions =
-      generator(b, ::xla::Cast<HloDotInstruction>(root), fn, config,
+      generator(b, ::xla::Cast<HloDotInstruction>(dot), fn, config,
                 device_info.shared_memory_per_block);
   if (!launch_dimensions.has_value()) {
     return std::nullopt;
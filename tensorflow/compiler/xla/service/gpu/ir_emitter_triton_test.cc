@@ -363,6 +363,63 @@ ENTRY e {
 )");
 }
 
+TEST_F(TritonGemmTest, FuseBiasReluEpilogue) {
+  const std::string hlo_text = R"(
+HloModule t
+
+ENTRY e {
+  p0 = f16[127,65] parameter(0)
+  p1 = s8[65,93] parameter(1)
+  cp1 = f16[65,93] convert(p1)
+  d = f16[127,93] dot(p0, cp1),
+    lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  bias = f16[93] parameter(2)
+  bias_b = f16[127,93] broadcast(bias), dimensions={1}
+  add = f16[127,93] add(d, bias_b)
+  zero = f16[] constant(0)
+  zero_b = f16[127,93] broadcast(zero), dimensions={}
+  relu = f16[127,93] maximum(add, zero_b)
+  ROOT c = f32[127,93] convert(relu)
+})";
+
+  MatchOptimizedHlo(hlo_text, R"(
+; CHECK: ROOT
+; CHECK-SAME: fusion(
+; CHECK-SAME: kind=kCustom
+; CHECK-SAME: backend_config="{\"block_m\":\"
+)");
+
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-2, 1e-2}));
+}
+
+TEST_F(TritonGemmTest, FuseBatchedResidualAddEpilogue) {
+  const std::string hlo_text = R"(
+HloModule t
+
+ENTRY e {
+  x = f32[5,33,17] parameter(0)
+  y = f16[5,17,39] parameter(1)
+  cy = f32[5,17,39] convert(y)
+  d = f32[5,33,39] dot(x, cy),
+    lhs_contracting_dims={2}, rhs_contracting_dims={1},
+    lhs_batch_dims={0}, rhs_batch_dims={0}
+  residual = f32[5,33,39] parameter(2)
+  bias = f32[33] parameter(3)
+  bias_b = f32[5,33,39] broadcast(bias), dimensions={1}
+  add = f32[5,33,39] add(d, residual)
+  ROOT sub = f32[5,33,39] subtract(add, bias_b)
+})";
+
+  MatchOptimizedHlo(hlo_text, R"(
+; CHECK: ROOT
+; CHECK-SAME: fusion(
+; CHECK-SAME: kind=kCustom
+; CHECK-SAME: backend_config="{\"block_m\":\"
+)");
+
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-4, 1e-2}));
+}
+
 struct GemmTestParams {
   PrimitiveType lhs_ty;
   PrimitiveType rhs_ty;
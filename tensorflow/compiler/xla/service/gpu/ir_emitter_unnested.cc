@@ -3308,7 +3308,8 @@ StatusOr<std::vector<llvm_ir::IrArray>> IrEmitterUnnested::BuildKernelThunkImpl(
   }
   std::optional<const BufferAllocation*> temp_buffer;
   for (const BufferAllocation& alloc : ir_emitter_context_->allocations()) {
-    if (alloc.IsPreallocatedTempBuffer()) {
+    if (alloc.IsPreallocatedTempBuffer() &&
+        alloc.color() != Layout::kHostMemorySpace) {
       if (!temp_buffer.has_value()) {
         // Retrieve the first seen temp buffer.
         temp_buffer = &alloc;
@@ -99,7 +99,7 @@ HloInstruction* SelectPreferredFusionCandidate(
 std::vector<HloInstruction*> GetProducerConsumerMultiOutputFusionCandidates(
     const HloInstruction* producer, const HloReachabilityMap& reachability,
     FusionInfoCache* fusion_info_cache, GpuHloCostAnalysis* cost_analysis,
-    const GpuDeviceInfo& device_info) {
+    const GpuDeviceInfo& device_info, const FusionProfile* fusion_profile) {
   std::vector<HloInstruction*> fusion_candidates;
   const HloComputation* computation = producer->parent();
   const HloModule* module = computation->parent();
@@ -178,15 +178,27 @@ std::vector<HloInstruction*> GetProducerConsumerMultiOutputFusionCandidates(
       continue;
     }
 
-    GpuPerformanceModel::RunTimes t = GpuPerformanceModel::EstimateRunTimes(
-        producer, cost_analysis, device_info, {consumer},
-        /*multi_output=*/true);
-    if (t.time_fused > t.time_unfused) {
-      dump_negative_explanation(FusionDecision{}
-                                << "will execute slower if fused");
+    FusionProfile::Verdict verdict =
+        fusion_profile == nullptr
+            ? FusionProfile::Verdict::kUnknown
+            : fusion_profile->Lookup(*producer, *consumer);
+    if (verdict == FusionProfile::Verdict::kUnprofitable) {
+      dump_negative_explanation(
+          FusionDecision{} << "ran slower than estimated when profiled");
       continue;
     }
 
+    if (verdict != FusionProfile::Verdict::kProfitable) {
+      GpuPerformanceModel::RunTimes t = GpuPerformanceModel::EstimateRunTimes(
+          producer, cost_analysis, device_info, {consumer},
+          /*multi_output=*/true);
+      if (t.time_fused > t.time_unfused) {
+        dump_negative_explanation(FusionDecision{}
+                                  << "will execute slower if fused");
+        continue;
+      }
+    }
+
     fusion_candidates.push_back(consumer);
   }
   return fusion_candidates;
@@ -258,10 +270,22 @@ bool GpuMultiOutputFusion::FuseSiblings(HloInstruction* parent,
 
       VLOG(3) << "Considering " << (*i)->name() << " and " << (*j)->name();
 
+      auto not_profiled_slower = [&](const HloInstruction* a,
+                                     const HloInstruction* b) {
+        if (fusion_profile_ != nullptr &&
+            fusion_profile_->Lookup(*a, *b) ==
+                FusionProfile::Verdict::kUnprofitable) {
+          return FusionDecision{} << a->name() << " and " << b->name()
+                                  << " ran slower than estimated when profiled";
+        }
+        return FusionDecision{};
+      };
+
       if (NoFusionPossible sibling_fusible =
               (!IsSiblingFusionCandidate(*j) || !is_disconnected(*i, *j) ||
                !ShapesCompatibleForMultiOutputFusion(*(*i), *(*j)) ||
-               !LegalToFuse(*i, *j, device_info_, fusion_info_cache))) {
+               !LegalToFuse(*i, *j, device_info_, fusion_info_cache) ||
+               !not_profiled_slower(*i, *j))) {
         // We pick `j` arbitrarily as a consumer.
         if (dump_fusion) {
           RegisterFusionState(
@@ -354,7 +378,7 @@ StatusOr<bool> GpuMultiOutputFusion::DoMultiOutputFusion() {
     // traversal, and hence, not get into the way of subsequent fusion attempts.
     const auto candidates = GetProducerConsumerMultiOutputFusionCandidates(
         producer, *reachability_, &fusion_info_cache, &cost_analysis,
-        device_info_);
+        device_info_, fusion_profile_);
     auto* consumer_for_fusion = SelectPreferredFusionCandidate(candidates);
     if (consumer_for_fusion == nullptr) {
       continue;
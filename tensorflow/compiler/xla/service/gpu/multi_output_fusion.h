@@ -24,6 +24,7 @@ limitations under the License.
 #include "absl/strings/string_view.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_reachability.h"
+#include "tensorflow/compiler/xla/service/gpu/fusion_profile.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_fusible.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_hlo_cost_analysis.h"
@@ -93,9 +94,15 @@ namespace gpu {
 
 class GpuMultiOutputFusion : public HloModulePass {
  public:
+  // If `fusion_profile` is given, fusions it found unprofitable are not
+  // formed, and producer-consumer fusions it found profitable are formed
+  // regardless of their estimated run time.
   explicit GpuMultiOutputFusion(const GpuDeviceInfo& d,
-                                HloCostAnalysis::ShapeSizeFunction f)
-      : device_info_(d), shape_size_function_(f) {}
+                                HloCostAnalysis::ShapeSizeFunction f,
+                                const FusionProfile* fusion_profile = nullptr)
+      : device_info_(d),
+        shape_size_function_(f),
+        fusion_profile_(fusion_profile) {}
 
   absl::string_view name() const override { return "multi_output_fusion"; }
 
@@ -124,6 +131,7 @@ class GpuMultiOutputFusion : public HloModulePass {
 
   const GpuDeviceInfo device_info_;
   HloCostAnalysis::ShapeSizeFunction shape_size_function_;
+  const FusionProfile* fusion_profile_;
 };
 
 }  // namespace gpu
@@ -43,6 +43,7 @@ Thunk::ExecuteParams::ExecuteParams(
     CASE(kConvolutionReorder);
     CASE(kCopy);
     CASE(kCublasLtMatmul);
+    CASE(kCudaGraph);
     CASE(kCustomCall);
     CASE(kNcclAllGather);
     CASE(kNcclAllGatherStart);
@@ -53,6 +53,7 @@ class Thunk {
     kConvolutionReorder,
     kCopy,
     kCublasLtMatmul,
+    kCudaGraph,
     kCustomCall,
     kFft,
     kFor,
@@ -111,6 +112,7 @@ class Thunk {
   // related XLA runtime custom calls). nullptr at runtime. MLIR codegen will
   // cease the practice of lowering thunks to XLA runtime custom calls.
   mlir::Operation* op() { return op_; }
+  std::optional<int64_t> profile_index() const { return profile_index_; }
 
   // Prepares the thunk for execution on the given StreamExecutor.
   //
@@ -147,9 +149,6 @@ class Thunk {
 
   static absl::string_view KindToString(Thunk::Kind kind);
 
- protected:
-  std::optional<int64_t> profile_index() const { return profile_index_; }
-
  private:
   Kind kind_;
   std::optional<int64_t> profile_index_;
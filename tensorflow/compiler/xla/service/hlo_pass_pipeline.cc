@@ -28,20 +28,34 @@ limitations under the License.
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/tsl/lib/monitoring/sampler.h"
+#include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/logging.h"
 #include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/profiler/lib/traceme.h"
 
 namespace xla {
 
 namespace {
 
+auto* hlo_pass_duration_usecs_histogram = tsl::monitoring::Sampler<1>::New(
+    {"/xla/service/hlo_pass_duration_usecs_histogram",
+     "The wall-clock time spent running each HLO pass in microseconds.",
+     "pass"},
+    // These exponential buckets cover the following range:
+    // Minimum: 1 us
+    // Maximum: 1 us * 2 ^ 32 == ~1.2 hours
+    {tsl::monitoring::Buckets::Exponential(1, 2, 33)});
+
 void RecordPassStartMetadata(HloModule& module, const std::string& pass_name,
                              const std::string& pipeline_name) {
   module.metadata()->RecordPassStart();
   // An HloPassMetadata was just created so Status should always be OK.
   TF_CHECK_OK(module.metadata()->set_current_pass_name(pass_name));
   TF_CHECK_OK(module.metadata()->set_current_pass_pipeline_name(pipeline_name));
+  TF_CHECK_OK(module.metadata()->set_current_pass_instruction_count_before(
+      module.instruction_count()));
 }
 
 void RecordPassStartMetadata(HloModuleGroup& module_group,
@@ -61,6 +75,9 @@ Status AttemptRecordPassEndMetadata(HloModule& module,
       module.metadata()->set_current_pass_module_id(module.unique_id()));
   TF_RETURN_IF_ERROR(
       module.metadata()->set_current_pass_module_changed(module_changed));
+  TF_RETURN_IF_ERROR(
+      module.metadata()->set_current_pass_instruction_count_after(
+          module.instruction_count()));
   TF_RETURN_IF_ERROR(module.metadata()->RecordPassEnd());
   return OkStatus();
 }
@@ -175,8 +192,12 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
     HloPassInterface* pass = passes[i];
     XLA_SCOPED_LOGGING_TIMER(absl::StrCat("HLO pass: ", pass->name()));
     std::string pass_name = std::string(pass->name());
+    tsl::profiler::TraceMe trace_me(
+        [&] { return absl::StrCat("HLO pass: ", pass_name); },
+        tsl::profiler::TraceMeLevel::kInfo);
     VLOG(1) << "  HLO pass " << pass_name;
     VLOG(2) << "  Module hash " << absl::HashOf(*hlo);
+    const uint64_t start_usecs = tsl::Env::Default()->NowMicros();
     if (!pass->IsPassPipeline()) {
       compilation_stats_->StartPass(pass_name);
     }
@@ -221,6 +242,8 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
     }
     if (!pass->IsPassPipeline()) {
       compilation_stats_->EndPass(pass_name);
+      hlo_pass_duration_usecs_histogram->GetCell(pass_name)->Add(
+          tsl::Env::Default()->NowMicros() - start_usecs);
     }
   }
   return changed;
@@ -298,8 +321,16 @@ StatusOr<bool> HloPassPipeline::Run(
   VLOG(1) << "Running HLO pass pipeline on module " << module->name() << ": "
           << name();
 
-  return RunPassesInternal(module, module->config().debug_options(),
-                           execution_threads);
+  // Nested pipelines run while their enclosing pipeline pass is recorded in
+  // the module metadata.
+  const bool is_outermost = !module->metadata()->current_pass_id().ok();
+  TF_ASSIGN_OR_RETURN(
+      bool changed, RunPassesInternal(module, module->config().debug_options(),
+                                      execution_threads));
+  if (is_outermost) {
+    DumpHloPassFlameGraphIfEnabled(*module);
+  }
+  return changed;
 }
 
 StatusOr<bool> HloPassPipeline::RunOnModuleGroup(
@@ -112,6 +112,22 @@ class BazToQuxModuleGroupPass : public HloModuleGroupPass {
   }
 };
 
+// A module pass which negates the root of the entry computation.
+class NegateRootModulePass : public HloModulePass {
+  absl::string_view name() const override { return "negate-root"; }
+
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(HloModule* module,
+                     const absl::flat_hash_set<absl::string_view>&
+                         execution_threads) override {
+    HloComputation* entry = module->entry_computation();
+    HloInstruction* root = entry->root_instruction();
+    entry->set_root_instruction(entry->AddInstruction(
+        HloInstruction::CreateUnary(root->shape(), HloOpcode::kNegate, root)));
+    return true;
+  }
+};
+
 // An invariant checker pass which returns an error if there exists an
 // instruction named 'bar'.
 class BarBlowerUpper : public HloModulePass {
@@ -401,5 +417,33 @@ TEST_F(HloPassPipelineTest, SetHloModuleMetadata) {
   }
 }
 
+TEST_F(HloPassPipelineTest, RecordsInstructionCounts) {
+  const std::string module_str = R"(
+HloModule RecordsInstructionCounts
+
+ENTRY main {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT foo = f32[] multiply(a, b)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(module_str));
+  HloPassPipeline pipeline(TestName());
+  pipeline.AddPass<NegateRootModulePass>();
+  pipeline.AddPass<FooToBarModulePass>();
+  TF_ASSERT_OK(pipeline.Run(module.get()).status());
+
+  const HloModuleMetadataProto& metadata = module->metadata()->proto();
+  ASSERT_THAT(metadata.pass_metadata(), SizeIs(3));
+  const HloPassMetadata& negate_root = metadata.pass_metadata(1);
+  EXPECT_THAT(negate_root.pass_name(), StrEq("negate-root"));
+  EXPECT_EQ(negate_root.instruction_count_before(), 3);
+  EXPECT_EQ(negate_root.instruction_count_after(), 4);
+  const HloPassMetadata& foo_to_bar = metadata.pass_metadata(2);
+  EXPECT_EQ(foo_to_bar.instruction_count_before(), 4);
+  EXPECT_EQ(foo_to_bar.instruction_count_after(), 4);
+}
+
 }  // namespace
 }  // namespace xla
@@ -55,7 +55,8 @@ namespace xla {
 namespace {
 struct CanonicalAsyncOp {
   HloOpcode outer;  // kAsyncStart or kAsyncDone
-  HloOpcode inner;  // kAllReduce, kAllGather, kAllToAll, kCollectivePermute
+  // kAllReduce, kAllGather, kAllToAll, kCollectivePermute or kCopy
+  HloOpcode inner;
 };
 
 CanonicalAsyncOp GetCanonicalAsyncOp(const HloInstruction& hlo) {
@@ -69,12 +70,16 @@ CanonicalAsyncOp GetCanonicalAsyncOp(const HloInstruction& hlo) {
       return {HloOpcode::kAsyncStart, HloOpcode::kAllGather};
     case HloOpcode::kCollectivePermuteStart:
       return {HloOpcode::kAsyncStart, HloOpcode::kCollectivePermute};
+    case HloOpcode::kCopyStart:
+      return {HloOpcode::kAsyncStart, HloOpcode::kCopy};
     case HloOpcode::kAllReduceDone:
       return {HloOpcode::kAsyncDone, HloOpcode::kAllReduce};
     case HloOpcode::kAllGatherDone:
       return {HloOpcode::kAsyncDone, HloOpcode::kAllGather};
     case HloOpcode::kCollectivePermuteDone:
       return {HloOpcode::kAsyncDone, HloOpcode::kCollectivePermute};
+    case HloOpcode::kCopyDone:
+      return {HloOpcode::kAsyncDone, HloOpcode::kCopy};
     default:
       return {hlo.opcode(), hlo.opcode()};
   }
@@ -126,6 +131,8 @@ bool AsyncTracker::IsSupportedAsyncDone(const HloInstruction& hlo) const {
       case HloOpcode::kAllReduce:
       case HloOpcode::kCollectivePermute:
         return true;
+      case HloOpcode::kCopy:
+        return config_.schedule_copies;
       default:
         return false;
     }
@@ -147,6 +154,8 @@ bool AsyncTracker::IsSupportedAsyncStart(const HloInstruction& hlo) const {
       case HloOpcode::kAllReduce:
       case HloOpcode::kCollectivePermute:
         return true;
+      case HloOpcode::kCopy:
+        return config_.schedule_copies;
       default:
         return false;
     }
@@ -167,6 +176,8 @@ ResourcesVector AsyncTracker::GetResourcesFromInstruction(
         return ResourceType::kAllToAll;
       case HloOpcode::kCollectivePermute:
         return ResourceType::kCollectivePermute;
+      case HloOpcode::kCopy:
+        return ResourceType::kCopy;
       default:
         return ResourceType::kNoResource;
     }
@@ -312,6 +323,8 @@ void AsyncTracker::SetConcurrentResourceLimits(
       config_.send_recv_host_overlap_limit;
   max_concurrent_resource[ResourceTypeToIndex(ResourceType::kRecvHost)] =
       config_.send_recv_host_overlap_limit;
+  max_concurrent_resource[ResourceTypeToIndex(ResourceType::kCopy)] =
+      config_.copy_overlap_limit;
   // Set the limits for target-defined resources
   const int64_t first_target_resource =
       AsyncTracker::GetFirstTargetDefinedResource();
@@ -339,6 +352,8 @@ absl::string_view AsyncTracker::GetResourceName(int64_t resource_type) const {
       return "kSendHost";
     case ResourceTypeToIndex(ResourceType::kRecvHost):
       return "kRecvHost";
+    case ResourceTypeToIndex(ResourceType::kCopy):
+      return "kCopy";
     default:
       return "not a default resource";
   }
@@ -2524,6 +2524,43 @@ ENTRY entry {
             GetIndex(new_instruction_sequence, "cp1s"));
 }
 
+TEST_F(LatencyHidingSchedulerTest, CopyStartDoneOverlap) {
+  absl::string_view hlo_string = R"(
+HloModule module, is_scheduled=true
+
+ENTRY entry {
+  p0 = f32[16,64,256]{2,1,0} parameter(0)
+  p1 = f32[16,64,256]{2,1,0} parameter(1)
+  p2 = f32[1024,2048]{1,0} parameter(2)
+  cs = (f32[1024,2048]{1,0}, f32[1024,2048]{1,0}, u32[]) copy-start(p2)
+  cd = f32[1024,2048]{1,0} copy-done(cs)
+  c0 = f32[16,256,256]{2,1,0} convolution(p0, p1),
+    window={size=16 stride=15 lhs_dilate=16}, dim_labels=0fb_0io->0fb
+  ROOT tuple = (f32[16,256,256]{2,1,0}, f32[1024,2048]{1,0}) tuple(c0, cd)
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto hlo_module, ParseHloText(hlo_string));
+  HloSchedule& module_schedule = hlo_module->schedule();
+  auto sched_config = GetDefaultSchedConfig();
+  sched_config.schedule_copies = true;
+  EXPECT_TRUE(RunScheduler(hlo_module.get(), sched_config).ok());
+
+  std::vector<HloInstruction*> new_instruction_sequence =
+      module_schedule.sequence(hlo_module->entry_computation()).instructions();
+  if (VLOG_IS_ON(1)) {
+    for (auto* new_i : new_instruction_sequence) {
+      VLOG(1) << new_i->ToString();
+    }
+  }
+
+  // The convolution is scheduled between the copy-start and copy-done.
+  EXPECT_LT(GetIndex(new_instruction_sequence, "cs"),
+            GetIndex(new_instruction_sequence, "c0"));
+  EXPECT_LT(GetIndex(new_instruction_sequence, "c0"),
+            GetIndex(new_instruction_sequence, "cd"));
+}
+
 TEST_F(LatencyHidingSchedulerTest, AsyncTrackerTestForTargetDefinedResources) {
   // Extend AsyncTracker for a fake target with one target-defined resource
   class AsyncTrackerForMyTarget : public AsyncTracker {
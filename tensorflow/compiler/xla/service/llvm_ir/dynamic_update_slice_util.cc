@@ -15,7 +15,6 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/llvm_ir/dynamic_update_slice_util.h"
 
-#include "tensorflow/compiler/xla/service/cpu/backend_config.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/launch_dimensions.h"
 #include "tensorflow/compiler/xla/service/gpu/parallel_loop_emitter.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/llvm_util.h"
@@ -25,17 +24,11 @@ namespace xla {
 namespace llvm_ir {
 
 bool MayBeImplementedAsInPlaceDynamicUpdateSlice(const HloInstruction* instr) {
-  // Today we can't emit a dynamic-update-slice if the DUS node is parallelized;
-  // the emitter will not emit correct code.  It's possible to change this, but
-  // then ParallelTaskAssigner would have to somehow know whether a node *will*
-  // be emitted as an in-place DUS, and it can't, because it doesn't have a
-  // buffer assignment when it runs.
-  auto cpu_backend_config_or = instr->backend_config<xla::cpu::BackendConfig>();
-  if (cpu_backend_config_or.ok() &&
-      !cpu_backend_config_or->outer_dimension_partitions().empty()) {
-    return false;
-  }
-
+  // Parallelized (i.e. partitioned) dynamic-update-slices may still be emitted
+  // in place: the CPU backend partitions them along
+  // GetInPlaceDynamicUpdateSliceLoopShape, which is valid for both the in-place
+  // and the out-of-place loop.
+  //
   // Until we know the final buffer assignment, any unfused dynamic-update-slice
   // might be implementable as an in-place DUS.
   if (instr->opcode() == HloOpcode::kDynamicUpdateSlice) {
@@ -57,6 +50,20 @@ bool MayBeImplementedAsInPlaceDynamicUpdateSlice(const HloInstruction* instr) {
   return false;
 }
 
+Shape GetInPlaceDynamicUpdateSliceLoopShape(const HloInstruction* instr) {
+  CHECK(MayBeImplementedAsInPlaceDynamicUpdateSlice(instr));
+  if (instr->opcode() == HloOpcode::kDynamicUpdateSlice) {
+    return instr->operand(1)->shape();
+  }
+  // See EmitFusedDynamicUpdateSliceInPlaceImpl: the fused update is never
+  // materialized, so the loop over it uses the layout of the fusion output.
+  const HloInstruction* dynamic_update_slice = instr->fused_expression_root();
+  Shape update_shape = dynamic_update_slice->operand(1)->shape();
+  TF_CHECK_OK(LayoutUtil::CopyLayoutBetweenShapes(
+      dynamic_update_slice->shape(), &update_shape));
+  return update_shape;
+}
+
 bool CanUpdateDynamicSliceInPlace(HloInstruction* dynamic_update_slice,
                                   const BufferAssignment& assignment) {
   CHECK_EQ(HloOpcode::kDynamicUpdateSlice, dynamic_update_slice->opcode());
@@ -91,14 +98,12 @@ bool CanEmitFusedDynamicUpdateSliceInPlace(HloInstruction* fusion,
 
 // Shared implementation of EmitDynamicUpdateSliceInPlace and
 // EmitFusedDynamicUpdateSliceInPlace.
-//
-// Emits a sequential loop if launch_dimensions is null.
 using IndexGenerator = std::function<StatusOr<llvm::Value*>(int64_t)>;
 
 static Status EmitDynamicUpdateSliceInPlaceImpl(
     const Shape& update_shape, const IndexGenerator& start_indices_generator,
     bool is_signed, ElementGenerator update_array_generator,
-    const IrArray& output_array, const gpu::LaunchDimensions* launch_dimensions,
+    const IrArray& output_array, const UpdateLoopEmitter& update_loop_emitter,
     absl::string_view name, llvm::IRBuilder<>* b) {
   const Shape& output_shape = output_array.GetShape();
 
@@ -152,18 +157,35 @@ static Status EmitDynamicUpdateSliceInPlaceImpl(
     return OkStatus();
   };
 
-  if (launch_dimensions != nullptr) {
-    return gpu::ParallelLoopEmitter(loop_body_emitter, update_shape,
-                                    *launch_dimensions, b)
-        .EmitLoop(name);
-  }
-  return LoopEmitter(loop_body_emitter, update_shape, b).EmitLoop(name);
+  return update_loop_emitter(loop_body_emitter, update_shape, name);
+}
+
+// Emits a sequential loop over the update.
+static Status EmitSequentialUpdateLoop(const BodyEmitter& body_emitter,
+                                       const Shape& update_shape,
+                                       absl::string_view name,
+                                       llvm::IRBuilder<>* b) {
+  return LoopEmitter(body_emitter, update_shape, b).EmitLoop(name);
 }
 
 Status EmitDynamicUpdateSliceInPlace(absl::Span<const IrArray> operand_arrays,
                                      const IrArray& output_array,
                                      absl::string_view name,
                                      llvm::IRBuilder<>* b) {
+  return EmitDynamicUpdateSliceInPlace(
+      operand_arrays, output_array, name,
+      [b](const BodyEmitter& body_emitter, const Shape& update_shape,
+          absl::string_view loop_name) {
+        return EmitSequentialUpdateLoop(body_emitter, update_shape, loop_name,
+                                        b);
+      },
+      b);
+}
+
+Status EmitDynamicUpdateSliceInPlace(
+    absl::Span<const IrArray> operand_arrays, const IrArray& output_array,
+    absl::string_view name, const UpdateLoopEmitter& update_loop_emitter,
+    llvm::IRBuilder<>* b) {
   VLOG(2) << "EmitDynamicUpdateSliceInPlace for " << name;
 
   // No need to use operand_arrays[0], the input array of the
@@ -184,17 +206,15 @@ Status EmitDynamicUpdateSliceInPlace(absl::Span<const IrArray> operand_arrays,
   bool is_signed = ShapeUtil::ElementIsSigned(start_indices_array.GetShape());
   return EmitDynamicUpdateSliceInPlaceImpl(
       update_shape, start_indices_generator, is_signed, update_array_generator,
-      output_array, /*launch_dimensions=*/nullptr, name, b);
+      output_array, update_loop_emitter, name, b);
 }
 
 // Shared implementation for EmitFusedDynamicUpdateSliceInPlace and
 // EmitParallelFusedDynamicUpdateSliceInPlace.
-//
-// Emits a sequential loop if launch_dimensions is null.
 static Status EmitFusedDynamicUpdateSliceInPlaceImpl(
     const HloComputation* fusion, const IrArray& fusion_output_array,
-    FusedIrEmitter* fused_emitter,
-    const gpu::LaunchDimensions* launch_dimensions, llvm::IRBuilder<>* b) {
+    FusedIrEmitter* fused_emitter, const UpdateLoopEmitter& update_loop_emitter,
+    llvm::IRBuilder<>* b) {
   VLOG(2) << "EmitFusedDynamicUpdateSliceInPlace for " << fusion->ToString();
 
   auto* dynamic_update_slice = fusion->root_instruction();
@@ -233,16 +253,31 @@ static Status EmitFusedDynamicUpdateSliceInPlaceImpl(
   bool is_signed = ShapeUtil::ElementIsSigned(start_indices->shape());
   return EmitDynamicUpdateSliceInPlaceImpl(
       update_shape, start_indices_generator, is_signed, update_array_generator,
-      fusion_output_array, launch_dimensions, IrName(dynamic_update_slice), b);
+      fusion_output_array, update_loop_emitter, IrName(dynamic_update_slice),
+      b);
 }
 
 Status EmitFusedDynamicUpdateSliceInPlace(HloInstruction* fusion,
                                           const IrArray& fusion_output_array,
                                           FusedIrEmitter* fused_emitter,
                                           llvm::IRBuilder<>* b) {
+  return EmitFusedDynamicUpdateSliceInPlace(
+      fusion, fusion_output_array, fused_emitter,
+      [b](const BodyEmitter& body_emitter, const Shape& update_shape,
+          absl::string_view loop_name) {
+        return EmitSequentialUpdateLoop(body_emitter, update_shape, loop_name,
+                                        b);
+      },
+      b);
+}
+
+Status EmitFusedDynamicUpdateSliceInPlace(
+    HloInstruction* fusion, const IrArray& fusion_output_array,
+    FusedIrEmitter* fused_emitter, const UpdateLoopEmitter& update_loop_emitter,
+    llvm::IRBuilder<>* b) {
   return EmitFusedDynamicUpdateSliceInPlaceImpl(
       fusion->called_computations()[0], fusion_output_array, fused_emitter,
-      /*launch_dimensions=*/nullptr, b);
+      update_loop_emitter, b);
 }
 
 Status EmitParallelFusedDynamicUpdateSliceInPlace(
@@ -250,7 +285,15 @@ Status EmitParallelFusedDynamicUpdateSliceInPlace(
     FusedIrEmitter* fused_emitter,
     const gpu::LaunchDimensions& launch_dimensions, llvm::IRBuilder<>* b) {
   return EmitFusedDynamicUpdateSliceInPlaceImpl(
-      fusion, fusion_output_array, fused_emitter, &launch_dimensions, b);
+      fusion, fusion_output_array, fused_emitter,
+      [&launch_dimensions, b](const BodyEmitter& body_emitter,
+                              const Shape& update_shape,
+                              absl::string_view loop_name) {
+        return gpu::ParallelLoopEmitter(body_emitter, update_shape,
+                                        launch_dimensions, b)
+            .EmitLoop(loop_name);
+      },
+      b);
 }
 
 }  // namespace llvm_ir
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/launch_dimensions.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/fused_ir_emitter.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/ir_array.h"
+#include "tensorflow/compiler/xla/service/llvm_ir/loop_emitter.h"
 
 // Utilities related to emitting LLVM IR for various HLO ops.
 
@@ -31,6 +32,13 @@ namespace llvm_ir {
 using GeneratorForOperandIrArrays =
     std::function<std::vector<llvm_ir::IrArray>()>;
 
+// Emits a loop nest named 'name' over 'update_shape' which calls
+// 'body_emitter' for every index of the update.  Lets backends emit the loop of
+// an in-place dynamic-update-slice with their own (e.g. parallel) loop emitter.
+using UpdateLoopEmitter =
+    std::function<Status(const BodyEmitter& body_emitter,
+                         const Shape& update_shape, absl::string_view name)>;
+
 // Determines whether the given instruction might be implemented as an
 // in-place dynamic-update-slice after we have a buffer assignment.
 //
@@ -47,6 +55,13 @@ using GeneratorForOperandIrArrays =
 // problem by the time you're calling this function, but beware.
 bool MayBeImplementedAsInPlaceDynamicUpdateSlice(const HloInstruction* instr);
 
+// Returns the shape an in-place implementation of 'instr' iterates over: the
+// update operand of the dynamic-update-slice 'instr' (or of the root of the
+// fusion 'instr'), laid out the way the loop emitted for it is.
+//
+// 'instr' must satisfy MayBeImplementedAsInPlaceDynamicUpdateSlice.
+Shape GetInPlaceDynamicUpdateSliceLoopShape(const HloInstruction* instr);
+
 // Checks if we can emit code for the given DynamicUpdateSlice node that updates
 // its input in place.  Returns true if the dynamic-update-slice's
 // array-to-be-updated and output share the same BufferAllocation::Slice.
@@ -68,6 +83,13 @@ Status EmitDynamicUpdateSliceInPlace(absl::Span<const IrArray> operand_arrays,
                                      absl::string_view name,
                                      llvm::IRBuilder<>* b);
 
+// Same as above, except the loop over the update is emitted by
+// 'update_loop_emitter'.
+Status EmitDynamicUpdateSliceInPlace(
+    absl::Span<const IrArray> operand_arrays, const IrArray& output_array,
+    absl::string_view name, const UpdateLoopEmitter& update_loop_emitter,
+    llvm::IRBuilder<>* b);
+
 // Given a loop-fusion node whose root is a dynamic-update-slice op whose
 // array-to-be-updated and output share the same buffer slice, emits
 // (sequential) code for a fusion node that does the dynamic-update-slice in
@@ -77,6 +99,13 @@ Status EmitFusedDynamicUpdateSliceInPlace(HloInstruction* fusion,
                                           FusedIrEmitter* fused_emitter,
                                           llvm::IRBuilder<>* b);
 
+// Same as above, except the loop over the update is emitted by
+// 'update_loop_emitter'.
+Status EmitFusedDynamicUpdateSliceInPlace(
+    HloInstruction* fusion, const IrArray& fusion_output_array,
+    FusedIrEmitter* fused_emitter, const UpdateLoopEmitter& update_loop_emitter,
+    llvm::IRBuilder<>* b);
+
 // Same as EmitFusedDynamicUpdateSliceInPlace, except emits a parallel loop with
 // the given launch dimensions.
 Status EmitParallelFusedDynamicUpdateSliceInPlace(
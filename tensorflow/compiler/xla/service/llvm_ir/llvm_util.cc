@@ -24,16 +24,20 @@ limitations under the License.
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/AsmParser/Parser.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/GlobalValue.h"
 #include "llvm/IR/GlobalVariable.h"
 #include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Operator.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
 #include "llvm/Target/TargetOptions.h"
 #include "llvm/TargetParser/Triple.h"
 #include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "tensorflow/compiler/xla/debug_options_flags.h"
 #include "tensorflow/compiler/xla/layout_util.h"
 #include "tensorflow/compiler/xla/literal.h"
@@ -639,6 +643,79 @@ void DumpIrIfEnabled(const HloModule& hlo_module,
   }
 }
 
+std::vector<std::string> SplitModuleForParallelCompilation(
+    llvm::Module& module, int max_partitions, bool preserve_locals) {
+  int num_functions = 0;
+  for (llvm::Function& func : module.functions()) {
+    if (!func.isDeclaration() &&
+        (!preserve_locals || func.hasExternalLinkage())) {
+      num_functions++;
+    }
+  }
+
+  // Record the constant globals and their initializers. After splitting, a
+  // partition that only declares one of them gets its own internal copy of
+  // the definition, to ensure constant-folding still works.
+  llvm::DenseMap<llvm::StringRef, llvm::Constant*> const_initializer_map;
+  for (llvm::GlobalVariable& gv : module.globals()) {
+    // Externalized globals need a name that is consistent across partitions.
+    if (!preserve_locals && !gv.hasName()) {
+      gv.setName("split_global");
+    }
+    if (gv.hasName() && gv.isConstant() && gv.hasInitializer() &&
+        (!preserve_locals || gv.hasExternalLinkage())) {
+      llvm::Constant* initializer = gv.getInitializer();
+      unsigned int num_elements = 0;
+      if (auto* caz =
+              llvm::dyn_cast<llvm::ConstantAggregateZero>(initializer)) {
+        num_elements = caz->getElementCount().getFixedValue();
+      } else if (auto* cds = llvm::dyn_cast<llvm::ConstantDataSequential>(
+                     initializer)) {
+        num_elements = cds->getNumElements();
+      }
+      if (num_elements > 0) {
+        const_initializer_map[gv.getName()] = initializer;
+      }
+    }
+  }
+
+  // Print each partition as soon as it is created: the partitions share the
+  // context of `module`, so they must not be touched by other threads.
+  std::vector<std::string> partitions;
+  llvm::SplitModule(
+      module,
+      std::max<unsigned>(1, std::min<unsigned>(max_partitions, num_functions)),
+      [&](std::unique_ptr<llvm::Module> partition) {
+        for (llvm::GlobalVariable& gv : partition->globals()) {
+          if (gv.hasName() && gv.isConstant() && !gv.hasInitializer()) {
+            auto it = const_initializer_map.find(gv.getName());
+            if (it != const_initializer_map.end()) {
+              gv.setInitializer(it->second);
+              gv.setLinkage(llvm::GlobalValue::InternalLinkage);
+              gv.setVisibility(llvm::GlobalValue::DefaultVisibility);
+            }
+          }
+        }
+        partitions.push_back(DumpToString(partition.get()));
+      },
+      /*PreserveLocals=*/preserve_locals);
+  return partitions;
+}
+
+StatusOr<std::unique_ptr<llvm::Module>> ParseModuleInContext(
+    absl::string_view ir, llvm::LLVMContext& context) {
+  llvm::SMDiagnostic err;
+  std::unique_ptr<llvm::Module> module = llvm::parseAssemblyString(
+      llvm::StringRef(ir.data(), ir.size()), err, context);
+  if (!module) {
+    std::string err_string;
+    llvm::raw_string_ostream os(err_string);
+    err.print(/*ProgName=*/nullptr, os, /*ShowColors=*/false);
+    return InternalError("Failed to parse IR: %s", os.str());
+  }
+  return module;
+}
+
 llvm::Function* CreateCpuFunction(llvm::FunctionType* function_type,
                                   llvm::GlobalValue::LinkageTypes linkage,
                                   const HloModuleConfig& module_config,
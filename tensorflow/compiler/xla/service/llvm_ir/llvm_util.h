@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <stdint.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -269,6 +270,25 @@ void DumpIrIfEnabled(const HloModule& hlo_module,
                      const llvm::Module& llvm_module, bool optimized,
                      absl::string_view filename_suffix = "");
 
+// Splits `module` along function boundaries into at most `max_partitions`
+// modules so that they can be optimized and compiled in parallel, and returns
+// each of them printed as textual IR. LLVM contexts are not thread-safe, so
+// every compilation thread should parse its partition into its own context
+// with ParseModuleInContext.
+//
+// If `preserve_locals` is false, functions and globals with local linkage are
+// externalized so that they can be placed in any partition; otherwise they are
+// kept together with all of their users. In both cases constant globals with
+// an initializer are copied as internal constants into every partition that
+// uses them, so that they can still be constant-folded.
+std::vector<std::string> SplitModuleForParallelCompilation(
+    llvm::Module& module, int max_partitions, bool preserve_locals);
+
+// Parses textual IR produced by SplitModuleForParallelCompilation into
+// `context`.
+StatusOr<std::unique_ptr<llvm::Module>> ParseModuleInContext(
+    absl::string_view ir, llvm::LLVMContext& context);
+
 llvm::Function* CreateCpuFunction(llvm::FunctionType* function_type,
                                   llvm::GlobalValue::LinkageTypes linkage,
                                   const HloModuleConfig& module_config,
@@ -30,6 +30,7 @@ limitations under the License.
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_casting_utils.h"
@@ -2681,9 +2682,30 @@ StatusOr<bool> ShardingPropagation::Run(
   int64_t iterations = 0;
 
   std::unique_ptr<CallGraph> call_graph = CallGraph::Build(module);
+
+  // Propagation only changes shardings and never adds or removes
+  // instructions, so the post order of each computation is computed once
+  // instead of on every sweep.
+  std::vector<std::pair<const HloComputation*, std::vector<HloInstruction*>>>
+      post_orders;
+  for (const HloComputation* computation :
+       module->computations(execution_threads)) {
+    post_orders.emplace_back(computation,
+                             computation->MakeInstructionPostOrder());
+  }
+
   auto run_to_fix_point = [&](int64_t aggressiveness) {
+    XLA_SCOPED_LOGGING_TIMER(absl::StrCat(
+        "ShardingPropagation fix point, aggressiveness=", aggressiveness));
     absl::flat_hash_set<const HloInstruction*> already_inferred_from_operands;
     absl::flat_hash_set<const HloInstruction*> already_inferred_from_users;
+    // Computations that may contain instructions missing from the caches
+    // above. A sweep only visits these, all other computations are known to
+    // have nothing left to infer.
+    absl::flat_hash_set<const HloComputation*> dirty_computations;
+    for (const auto& entry : post_orders) {
+      dirty_computations.insert(entry.first);
+    }
     bool changed_last_iter = true;
     const bool may_merge_partial = is_spmd_ && aggressiveness > 0;
     while (changed_last_iter) {
@@ -2692,12 +2714,16 @@ StatusOr<bool> ShardingPropagation::Run(
       int64_t inferred_from_user_counter = 0;
       int64_t instruction_counter = 0;
       int64_t already_sharded_counter = 0;
-      for (const HloComputation* computation :
-           module->computations(execution_threads)) {
+      int64_t computation_counter = 0;
+      for (const auto& entry : post_orders) {
+        const HloComputation* computation = entry.first;
+        const std::vector<HloInstruction*>& instructions = entry.second;
+        if (!dirty_computations.erase(computation)) {
+          continue;
+        }
         VLOG(2) << "Consider computation: " << computation->name();
-        std::vector<HloInstruction*> instructions =
-            computation->MakeInstructionPostOrder();
 
+        ++computation_counter;
         instruction_counter += instructions.size();
         already_sharded_counter += absl::c_count_if(
             instructions,
@@ -2706,12 +2732,14 @@ StatusOr<bool> ShardingPropagation::Run(
                                HloInstruction* hlo_for_users = nullptr) {
           for (auto operand : hlo->operands()) {
             already_inferred_from_users.erase(operand);
+            dirty_computations.insert(operand->parent());
           }
           if (hlo_for_users == nullptr) {
             hlo_for_users = hlo;
           }
           for (auto user : hlo_for_users->users()) {
             already_inferred_from_operands.erase(user);
+            dirty_computations.insert(user->parent());
           }
         };
         // First iterate the HLO graph in post order taking shardings from
@@ -2735,6 +2763,9 @@ StatusOr<bool> ShardingPropagation::Run(
               clear_cache(instruction, man_conversion_op_after);
               already_inferred_from_operands.insert(instruction);
               changed_last_iter = true;
+            } else {
+              // Not cached, so it is retried on the next sweep.
+              dirty_computations.insert(computation);
             }
             continue;
           }
@@ -2788,6 +2819,8 @@ StatusOr<bool> ShardingPropagation::Run(
                 already_inferred_from_users.insert(man_conversion_op_after);
               }
               changed_last_iter = true;
+            } else {
+              dirty_computations.insert(computation);
             }
             continue;
           }
@@ -2809,7 +2842,8 @@ StatusOr<bool> ShardingPropagation::Run(
         }
       }
       VLOG(1) << "Sharding propagation iteration " << iterations << ";";
-      VLOG(1) << "  total instructions: " << instruction_counter;
+      VLOG(1) << "  computations visited: " << computation_counter;
+      VLOG(1) << "  instructions visited: " << instruction_counter;
       VLOG(1) << "  instructions already sharded: " << already_sharded_counter;
       VLOG(1) << "  shardings inferred from operands: "
               << inferred_from_operand_counter;
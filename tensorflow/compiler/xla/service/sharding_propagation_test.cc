@@ -21,12 +21,14 @@ limitations under the License.
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/str_replace.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_op_metadata.h"
 #include "tensorflow/compiler/xla/hlo/utils/hlo_matchers.h"
 #include "tensorflow/compiler/xla/protobuf_util.h"
 #include "tensorflow/compiler/xla/service/hlo_parser.h"
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/tsl/platform/test_benchmark.h"
 
 namespace op = xla::testing::opcode_matchers;
 
@@ -9121,5 +9123,95 @@ ENTRY %entry {
   EXPECT_THAT(module->entry_computation()->parameter_instruction(1),
               op::Sharding("{devices=[4]0,1,2,3}"));
 }
+
+// Builds a module whose entry computation is a chain of `num_ops` adds, with
+// the sharding only annotated on the parameter.
+std::string MakeLongChainHlo(int num_ops) {
+  std::string hlo_string = R"(
+HloModule module
+
+ENTRY %entry {
+  %add.0 = f32[64,64] parameter(0), sharding={devices=[2,2]0,1,2,3}
+)";
+  for (int i = 1; i <= num_ops; ++i) {
+    absl::StrAppend(&hlo_string, "  %add.", i, " = f32[64,64] add(%add.",
+                    i - 1, ", %add.0)\n");
+  }
+  absl::StrAppend(&hlo_string, "  ROOT %copy = f32[64,64] copy(%add.",
+                  num_ops, ")\n}\n");
+  return hlo_string;
+}
+
+// Builds a module with `num_whiles` sequential while loops, with the sharding
+// only annotated on the first loop's input.
+std::string MakeManyWhilesHlo(int num_whiles) {
+  constexpr absl::string_view kLoop = R"(
+%cond.$i {
+  %p.c$i = (f32[64,64], s32[]) parameter(0)
+  %i.c$i = s32[] get-tuple-element(%p.c$i), index=1
+  %limit.$i = s32[] constant(8)
+  ROOT %lt.$i = pred[] compare(%i.c$i, %limit.$i), direction=LT
+}
+
+%body.$i {
+  %p.b$i = (f32[64,64], s32[]) parameter(0)
+  %x.b$i = f32[64,64] get-tuple-element(%p.b$i), index=0
+  %i.b$i = s32[] get-tuple-element(%p.b$i), index=1
+  %one.$i = s32[] constant(1)
+  %next.$i = s32[] add(%i.b$i, %one.$i)
+  %mul.$i = f32[64,64] multiply(%x.b$i, %x.b$i)
+  ROOT %tuple.$i = (f32[64,64], s32[]) tuple(%mul.$i, %next.$i)
+}
+)";
+  constexpr absl::string_view kCall = R"(
+  %init.$i = (f32[64,64], s32[]) tuple(%x.$i, %zero)
+  %while.$i = (f32[64,64], s32[]) while(%init.$i), condition=%cond.$i, body=%body.$i
+  %x.$n = f32[64,64] get-tuple-element(%while.$i), index=0)";
+
+  std::string hlo_string = "HloModule module\n";
+  for (int i = 0; i < num_whiles; ++i) {
+    absl::StrAppend(&hlo_string,
+                    absl::StrReplaceAll(kLoop, {{"$i", absl::StrCat(i)}}));
+  }
+  absl::StrAppend(&hlo_string, R"(
+ENTRY %entry {
+  %x.0 = f32[64,64] parameter(0), sharding={devices=[2,2]0,1,2,3}
+  %zero = s32[] constant(0))");
+  for (int i = 0; i < num_whiles; ++i) {
+    absl::StrAppend(&hlo_string,
+                    absl::StrReplaceAll(kCall, {{"$i", absl::StrCat(i)},
+                                                {"$n", absl::StrCat(i + 1)}}));
+  }
+  absl::StrAppend(&hlo_string, "\n  ROOT %copy = f32[64,64] copy(%x.",
+                  num_whiles, ")\n}\n");
+  return hlo_string;
+}
+
+void RunShardingPropagationBenchmark(::testing::benchmark::State& state,
+                                     const std::string& hlo_string) {
+  for (auto s : state) {
+    state.PauseTiming();
+    auto module = ParseAndReturnUnverifiedModule(hlo_string).value();
+    state.ResumeTiming();
+    ASSERT_IS_OK(ShardingPropagation(/*is_spmd=*/true)
+                     .Run(module.get())
+                     .status());
+  }
+}
+
+void BM_ShardingPropagationLongChain(::testing::benchmark::State& state) {
+  RunShardingPropagationBenchmark(state, MakeLongChainHlo(state.range(0)));
+}
+
+void BM_ShardingPropagationManyWhiles(::testing::benchmark::State& state) {
+  RunShardingPropagationBenchmark(state, MakeManyWhilesHlo(state.range(0)));
+}
+
+BENCHMARK(BM_ShardingPropagationLongChain)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Arg(100000);
+BENCHMARK(BM_ShardingPropagationManyWhiles)->Arg(100)->Arg(1000)->Arg(5000);
+
 }  // namespace
 }  // namespace xla
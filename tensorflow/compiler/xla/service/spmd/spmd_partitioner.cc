@@ -4787,6 +4787,11 @@ HloInstruction* SpmdPartitioner::AllReduceAlongShardingDimsInternal(
 StatusOr<bool> SpmdPartitioner::PartitionComputation(
     HloComputation* computation, const HloSharding& root_sharding,
     int64_t* next_channel_id, SpmdLogger* logger, const CallGraph& call_graph) {
+  // Level 2 since this is also called for every nested computation.
+  XLA_SCOPED_LOGGING_TIMER_LEVEL(
+      absl::StrCat("SpmdPartitioner::PartitionComputation: ",
+                   computation->name()),
+      2);
   auto visitor = CreateVisitor(computation, num_partitions_, num_replicas_,
                                collective_ops_creator_, next_channel_id, logger,
                                options_, call_graph);
@@ -4806,8 +4811,11 @@ std::unique_ptr<SpmdPartitioningVisitor> SpmdPartitioner::CreateVisitor(
 StatusOr<bool> SpmdPartitioner::Run(
     HloModule* module,
     const absl::flat_hash_set<absl::string_view>& execution_threads) {
-  TF_RETURN_IF_ERROR(PreprocessSharding(module, execution_threads));
-  TF_RETURN_IF_ERROR(PreprocessHlos(module, execution_threads));
+  {
+    XLA_SCOPED_LOGGING_TIMER("SpmdPartitioner preprocessing");
+    TF_RETURN_IF_ERROR(PreprocessSharding(module, execution_threads));
+    TF_RETURN_IF_ERROR(PreprocessHlos(module, execution_threads));
+  }
 
   XLA_VLOG_LINES(1, SpmdLogger::ReportBeforePartition(
                         *module, options_.report_instruction_count));
@@ -4839,11 +4847,14 @@ StatusOr<bool> SpmdPartitioner::Run(
 
   std::unique_ptr<CallGraph> call_graph = CallGraph::Build(module);
   CHECK(call_graph->IsFlattened());
-  TF_ASSIGN_OR_RETURN(
-      bool partition_changed,
-      PartitionComputation(module->entry_computation(), root_sharding,
-                           &next_channel_id, &logger, *call_graph));
-  changed |= partition_changed;
+  {
+    XLA_SCOPED_LOGGING_TIMER("SpmdPartitioner partitioning");
+    TF_ASSIGN_OR_RETURN(
+        bool partition_changed,
+        PartitionComputation(module->entry_computation(), root_sharding,
+                             &next_channel_id, &logger, *call_graph));
+    changed |= partition_changed;
+  }
 
   // For the entry computation, make sure that the root instruction and the
   // parameters preserve their signatures.
@@ -1360,6 +1360,47 @@ GpuDriver::CreateMemoryHandle(GpuContext* context, uint64_t bytes) {
                       reinterpret_cast<void*>(dptr), ToString(result)));
 }
 
+/* static */ tsl::Status GpuDriver::IpcGetMemHandle(GpuContext* context,
+                                                    CUdeviceptr base,
+                                                    std::string* handle) {
+  ScopedActivateContext activation(context);
+  CUipcMemHandle ipc_handle;
+  RETURN_IF_CUDA_RES_ERROR(
+      cuIpcGetMemHandle(&ipc_handle, base),
+      absl::StrFormat("failed to get IPC handle of device pointer %p",
+                      reinterpret_cast<void*>(base)));
+  handle->assign(ipc_handle.reserved, sizeof(ipc_handle.reserved));
+  return ::tsl::OkStatus();
+}
+
+/* static */ tsl::StatusOr<CUdeviceptr> GpuDriver::IpcOpenMemHandle(
+    GpuContext* context, const std::string& handle) {
+  CUipcMemHandle ipc_handle;
+  if (handle.size() != sizeof(ipc_handle.reserved)) {
+    return tsl::errors::InvalidArgument("IPC memory handle of ", handle.size(),
+                                        " bytes, expected ",
+                                        sizeof(ipc_handle.reserved));
+  }
+  memcpy(ipc_handle.reserved, handle.data(), handle.size());
+  ScopedActivateContext activation(context);
+  CUdeviceptr ptr;
+  RETURN_IF_CUDA_RES_ERROR(
+      cuIpcOpenMemHandle(&ptr, ipc_handle,
+                         CU_IPC_MEM_LAZY_ENABLE_PEER_ACCESS),
+      "failed to open IPC memory handle");
+  return ptr;
+}
+
+/* static */ tsl::Status GpuDriver::IpcCloseMemHandle(GpuContext* context,
+                                                      CUdeviceptr ptr) {
+  ScopedActivateContext activation(context);
+  RETURN_IF_CUDA_RES_ERROR(
+      cuIpcCloseMemHandle(ptr),
+      absl::StrFormat("failed to close IPC memory handle mapped at %p",
+                      reinterpret_cast<void*>(ptr)));
+  return ::tsl::OkStatus();
+}
+
 /* static */ tsl::StatusOr<CUdevice> GpuDriver::GetPointerDevice(
     CUdeviceptr pointer) {
   auto result = GetPointerContext(pointer);
@@ -21,6 +21,7 @@ limitations under the License.
 #include <stddef.h>
 
 #include <cstdint>
+#include <string>
 
 #include "tensorflow/compiler/xla/stream_executor/device_options.h"
 #include "tensorflow/compiler/xla/stream_executor/gpu/gpu_types.h"
@@ -461,6 +462,25 @@ class GpuDriver {
   static tsl::Status GetPointerAddressRange(GpuDevicePtr dptr,
                                             GpuDevicePtr* base, size_t* size);
 
+  // -- Inter-process memory sharing.
+
+  // Returns in *handle an opaque handle of the device memory allocation
+  // starting at base, that another process can map with IpcOpenMemHandle(),
+  // via cuIpcGetMemHandle. base must have been allocated by DeviceAllocate().
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__MEM.html#group__CUDA__MEM_1g6f1b5be767b275f016523b2ac49ebec1
+  static tsl::Status IpcGetMemHandle(GpuContext* context, GpuDevicePtr base,
+                                     std::string* handle);
+
+  // Maps into the given context the device memory allocation of a handle
+  // returned by IpcGetMemHandle() in another process, via cuIpcOpenMemHandle.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__MEM.html#group__CUDA__MEM_1ga8bd126fcff919a0c996b7640f197b79
+  static tsl::StatusOr<GpuDevicePtr> IpcOpenMemHandle(
+      GpuContext* context, const std::string& handle);
+
+  // Unmaps memory mapped by IpcOpenMemHandle(), via cuIpcCloseMemHandle.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__MEM.html#group__CUDA__MEM_1gd6f5d5bcf6376c6853b64635b0157b9e
+  static tsl::Status IpcCloseMemHandle(GpuContext* context, GpuDevicePtr ptr);
+
   // -- Device-specific calls.
 
   // Returns the compute capability for the device; i.e (3, 5).
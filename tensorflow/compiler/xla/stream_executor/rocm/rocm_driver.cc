@@ -1019,6 +1019,47 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
                       reinterpret_cast<void*>(dptr), ToString(result).c_str())};
 }
 
+/* static */ tsl::Status GpuDriver::IpcGetMemHandle(GpuContext* context,
+                                                    hipDeviceptr_t base,
+                                                    std::string* handle) {
+  ScopedActivateContext activation{context};
+  hipIpcMemHandle_t ipc_handle;
+  RETURN_IF_ROCM_ERROR(
+      wrap::hipIpcGetMemHandle(&ipc_handle, base),
+      absl::StrFormat("failed to get IPC handle of device pointer %p",
+                      reinterpret_cast<void*>(base)));
+  handle->assign(ipc_handle.reserved, sizeof(ipc_handle.reserved));
+  return tsl::OkStatus();
+}
+
+/* static */ tsl::StatusOr<hipDeviceptr_t> GpuDriver::IpcOpenMemHandle(
+    GpuContext* context, const std::string& handle) {
+  hipIpcMemHandle_t ipc_handle;
+  if (handle.size() != sizeof(ipc_handle.reserved)) {
+    return tsl::errors::InvalidArgument("IPC memory handle of ", handle.size(),
+                                        " bytes, expected ",
+                                        sizeof(ipc_handle.reserved));
+  }
+  memcpy(ipc_handle.reserved, handle.data(), handle.size());
+  ScopedActivateContext activation{context};
+  void* ptr;
+  RETURN_IF_ROCM_ERROR(
+      wrap::hipIpcOpenMemHandle(&ptr, ipc_handle,
+                                hipIpcMemLazyEnablePeerAccess),
+      "failed to open IPC memory handle");
+  return reinterpret_cast<hipDeviceptr_t>(ptr);
+}
+
+/* static */ tsl::Status GpuDriver::IpcCloseMemHandle(GpuContext* context,
+                                                      hipDeviceptr_t ptr) {
+  ScopedActivateContext activation{context};
+  RETURN_IF_ROCM_ERROR(
+      wrap::hipIpcCloseMemHandle(reinterpret_cast<void*>(ptr)),
+      absl::StrFormat("failed to close IPC memory handle mapped at %p",
+                      reinterpret_cast<void*>(ptr)));
+  return tsl::OkStatus();
+}
+
 /* static */ tsl::StatusOr<MemorySpace> GpuDriver::GetPointerMemorySpace(
     hipDeviceptr_t pointer) {
   unsigned int value;
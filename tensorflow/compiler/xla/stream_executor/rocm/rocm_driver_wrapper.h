@@ -96,6 +96,9 @@ namespace wrap {
   __macro(hipHostRegister)                          \
   __macro(hipHostUnregister)                        \
   __macro(hipInit)                                  \
+  __macro(hipIpcCloseMemHandle)                     \
+  __macro(hipIpcGetMemHandle)                       \
+  __macro(hipIpcOpenMemHandle)                      \
   __macro(hipMalloc)                                \
   __macro(hipMemGetAddressRange)                    \
   __macro(hipMemGetInfo)                            \
@@ -77,7 +77,13 @@ const char* GetCollectiveName(const CollectiveParams* cp, bool nccl) {
       return "Permute";
 
     case ALL_TO_ALL_COLLECTIVE:
-      return nccl ? "NcclAllToAll" : "AllToAll";
+      if (nccl) return "NcclAllToAll";
+      return cp->instance.impl_details.communication_hint == "pipelined"
+                 ? "PipelinedAllToAll"
+                 : "AllToAll";
+
+    case ALL_TO_ALL_V_COLLECTIVE:
+      return "PipelinedAllToAllV";
 
     case REDUCE_SCATTER_COLLECTIVE:
       return nccl ? "NcclReduceScatter" : "undef";
@@ -87,6 +93,32 @@ const char* GetCollectiveName(const CollectiveParams* cp, bool nccl) {
   }
 }
 
+// Below this size, the extra intra-task steps of HierarchicalRingReduce cost
+// more than the inter-task steps they save.
+constexpr int64_t kMinHierarchicalReduceBytes = 64 * 1024;
+
+// Returns true iff `cp` is a reduction for which HierarchicalRingReduce is
+// expected to outperform RingReduce: a large tensor reduced over several
+// tasks with the same number (at least two) of devices each.
+bool PreferHierarchicalReduce(const CollectiveParams* cp) {
+  const string& hint = cp->instance.impl_details.communication_hint;
+  if (cp->instance.type != REDUCTION_COLLECTIVE || cp->group.num_tasks < 2 ||
+      !cp->group.same_num_devices_per_task ||
+      cp->group.group_size < 2 * cp->group.num_tasks ||
+      !(hint.empty() || hint == "auto" || hint == "hierarchical")) {
+    return false;
+  }
+  const int64_t num_bytes = cp->instance.shape.num_elements() *
+                            DataTypeSize(cp->instance.data_type);
+  if (hint != "hierarchical" && num_bytes < kMinHierarchicalReduceBytes) {
+    return false;
+  }
+  CollectiveImplementationInterface* col_impl;
+  return CollectiveRegistry::LookupParamResolverInstance(
+             "HierarchicalRingReduce", &col_impl)
+      .ok();
+}
+
 string TaskNameFromDeviceName(const string& device_name) {
   DeviceNameUtils::ParsedName parsed_device;
   CHECK(DeviceNameUtils::ParseFullName(device_name, &parsed_device));
@@ -280,6 +312,7 @@ void CollectiveParamResolverLocal::CompleteGroupLocal(
       }
       if (new_device) {
         FinishGroup(gr);
+        ReuseCommunicatorKey(gr);
       }
       // Copy to all pending CollGroupParams;
       *group_params = gr->group;
@@ -503,6 +536,26 @@ void CollectiveParamResolverLocal::FinishGroup(GroupRec* gr) {
       static_cast<int32>(gr->group.num_devices_per_task.size());
 }
 
+void CollectiveParamResolverLocal::ReuseCommunicatorKey(GroupRec* gr) {
+  string& communicator_key = gr->group.runtime_details.communicator_key;
+  if (!gr->status.ok() || communicator_key.empty()) return;
+  // The communicator of a group connects its devices in the order of their
+  // ranks, and is created anew when a device restarts.
+  string members;
+  for (const CollGroupMember& member : gr->group.members) {
+    strings::StrAppend(&members, member.device.name(), "#",
+                       member.device.incarnation(), "#", member.rank, ";");
+  }
+  mutex_lock l(communicator_keys_mu_);
+  auto it = communicator_keys_.insert({members, communicator_key}).first;
+  if (it->second != communicator_key) {
+    VLOG(2) << "Group " << gr->group.group_key
+            << " reuses the communicator of an earlier group with the same "
+               "members";
+    communicator_key = it->second;
+  }
+}
+
 void CollectiveParamResolverLocal::CancelGroup(int32 group_key) {
   std::vector<StatusCallback> pending_done;
   GroupRec* gr = nullptr;
@@ -713,6 +766,9 @@ void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
       CollectiveRegistry::LookupParamResolverInstance("NcclReduce", &col_impl)
           .ok();
   cp->instance.impl_details.collective_name = GetCollectiveName(cp, use_nccl);
+  if (!use_nccl && PreferHierarchicalReduce(cp)) {
+    cp->instance.impl_details.collective_name = "HierarchicalRingReduce";
+  }
   VLOG(1) << "AssignCollectiveType "
           << cp->instance.impl_details.collective_name;
 }
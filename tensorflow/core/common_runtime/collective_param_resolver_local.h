@@ -96,6 +96,12 @@ class CollectiveParamResolverLocal : public ParamResolverInterface {
   // Finishes the group parameters once all members of the group are there.
   void FinishGroup(GroupRec* gr) TF_EXCLUSIVE_LOCKS_REQUIRED(gr->mu);
 
+  // Gives the finished group `gr` the communicator key of an earlier group
+  // with the same members in the same order, so that NCCL reuses the
+  // communicator of that group instead of initializing a new one.
+  void ReuseCommunicatorKey(GroupRec* gr) TF_EXCLUSIVE_LOCKS_REQUIRED(gr->mu)
+      TF_LOCKS_EXCLUDED(communicator_keys_mu_);
+
   // Cancels the group if it's still pending.
   void CancelGroup(int32 group_key) TF_LOCKS_EXCLUDED(group_mu_);
 
@@ -208,6 +214,11 @@ class CollectiveParamResolverLocal : public ParamResolverInterface {
       instance_table_ TF_GUARDED_BY(instance_mu_);
   mutex status_mu_;
   Status status_ TF_GUARDED_BY(status_mu_);
+  // Maps the members of the groups completed by this resolver to their
+  // communicator key. Taken while holding the mutex of a GroupRec.
+  mutex communicator_keys_mu_;
+  gtl::FlatMap<string, string> communicator_keys_
+      TF_GUARDED_BY(communicator_keys_mu_);
 };
 
 }  // namespace tensorflow
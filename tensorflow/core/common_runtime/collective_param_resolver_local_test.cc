@@ -497,4 +497,59 @@ TEST_F(CollectiveParamResolverLocalTest, AbortNormalCompleteParamsAsync) {
   EXPECT_GT(num_ok.load(), 50);
 }
 
+class FakeNcclCommunicator : public NcclCommunicatorInterface {
+ public:
+  string GenerateCommunicatorKey() override {
+    return strings::StrCat("key", num_keys_++);
+  }
+
+  void Enqueue(std::shared_ptr<CollectiveContext> col_ctx,
+               StatusCallback done) override {
+    done(errors::Unimplemented("Enqueue"));
+  }
+
+  void StartAbort(const Status& s) override {}
+
+ private:
+  std::atomic<int> num_keys_{0};
+};
+
+TEST_F(CollectiveParamResolverLocalTest, ReuseCommunicatorKey) {
+  FakeNcclCommunicator nccl_communicator;
+  prl_.reset(new CollectiveParamResolverLocal(ConfigProto(), device_mgr_.get(),
+                                              drl_.get(), &nccl_communicator,
+                                              task_name_));
+  // Groups 1 and 2 have the same members, group 3 leaves out one device.
+  auto complete_group = [this](int group_key, int group_size) {
+    std::vector<CollGroupParams> groups(group_size);
+    BlockingCounter counter(group_size);
+    for (int i = 0; i < group_size; ++i) {
+      groups[i].group_key = group_key;
+      groups[i].group_size = group_size;
+      groups[i].device_type = DeviceType("CPU");
+      string device =
+          strings::StrCat("/job:localhost/replica:0/task:0/device:CPU:", i);
+      prl_->CompleteGroupAsync(GetDeviceAttributes(device), &groups[i],
+                               /*cancel_mgr=*/nullptr,
+                               [&counter](const Status& s) {
+                                 TF_EXPECT_OK(s);
+                                 counter.DecrementCount();
+                               });
+    }
+    counter.Wait();
+    for (const CollGroupParams& group : groups) {
+      EXPECT_EQ(group.runtime_details.communicator_key,
+                groups[0].runtime_details.communicator_key);
+    }
+    return groups[0].runtime_details.communicator_key;
+  };
+  const string key1 = complete_group(/*group_key=*/1, NUM_DEVS);
+  const string key2 = complete_group(/*group_key=*/2, NUM_DEVS);
+  const string key3 = complete_group(/*group_key=*/3, NUM_DEVS - 1);
+  EXPECT_EQ(key1, "key0");
+  EXPECT_EQ(key2, key1);
+  EXPECT_NE(key3, key1);
+  prl_.reset();
+}
+
 }  // namespace tensorflow
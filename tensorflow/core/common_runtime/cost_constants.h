@@ -31,6 +31,15 @@ inline constexpr char kNoOpCostName[] = "no_op";
 inline constexpr char kWithSmearSuffix[] = "_with_smear";
 inline constexpr char kNoSmearSuffix[] = "_no_smear";
 
+// Types of per-request cost and metrics attributed to the kernels of a step
+// (see RunOptions.Experimental.collect_cost_attribution). The time of each op
+// type and device is recorded under the prefix followed by its name.
+inline constexpr char kOpTimeCostPrefix[] = "op_time/";
+inline constexpr char kDeviceTimeCostPrefix[] = "device_time/";
+inline constexpr char kRendezvousWaitCostName[] = "rendezvous_wait";
+inline constexpr char kAllocatedBytesMetricName[] = "allocated_bytes";
+inline constexpr char kPeakMemoryBytesMetricName[] = "peak_memory_bytes";
+
 // Full names of per-request cost.
 inline constexpr char kTpuWithSmearCostName[] = "tpu_with_smear";
 inline constexpr char kTpuNoSmearCostName[] = "tpu_no_smear";
@@ -20,6 +20,9 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/common_runtime/cost_constants.h"
 #include "tensorflow/core/common_runtime/cost_measurement.h"
 #include "tensorflow/core/common_runtime/cost_measurement_registry.h"
 #include "tensorflow/core/common_runtime/request_cost_accessor_registry.h"
@@ -68,4 +71,28 @@ std::unique_ptr<RequestCostAccessor> CreateRequestCostAccessor() {
              : nullptr;
 }
 
+void RecordCostAttribution(const CostAttribution& attribution,
+                           RequestCost* request_cost) {
+  std::vector<std::pair<std::string, absl::Duration>> named_costs;
+  for (const auto& op_time : attribution.op_time_nanos()) {
+    named_costs.emplace_back(absl::StrCat(kOpTimeCostPrefix, op_time.first),
+                             absl::Nanoseconds(op_time.second));
+  }
+  for (const auto& device_time : attribution.device_time_nanos()) {
+    named_costs.emplace_back(
+        absl::StrCat(kDeviceTimeCostPrefix, device_time.first),
+        absl::Nanoseconds(device_time.second));
+  }
+  named_costs.emplace_back(
+      kRendezvousWaitCostName,
+      absl::Nanoseconds(attribution.rendezvous_wait_nanos()));
+  std::vector<std::pair<absl::string_view, absl::Duration>> costs(
+      named_costs.begin(), named_costs.end());
+  request_cost->RecordCost(costs);
+  request_cost->RecordMetrics(
+      {{kAllocatedBytesMetricName, attribution.allocated_bytes()}});
+  request_cost->RecordPeakMetrics(
+      {{kPeakMemoryBytesMetricName, attribution.peak_memory_bytes()}});
+}
+
 }  // namespace tensorflow
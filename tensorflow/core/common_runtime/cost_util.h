@@ -20,7 +20,9 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/common_runtime/cost_measurement.h"
+#include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/common_runtime/request_cost_accessor.h"
+#include "tensorflow/core/protobuf/config.pb.h"
 
 namespace tensorflow {
 
@@ -34,6 +36,11 @@ std::vector<std::unique_ptr<CostMeasurement>> CreateCostMeasurements(
 // CostMeasurement is unregistered..
 std::unique_ptr<RequestCostAccessor> CreateRequestCostAccessor();
 
+// Records the cost of a step in `request_cost`, under the cost and metric
+// types in cost_constants.h.
+void RecordCostAttribution(const CostAttribution& attribution,
+                           RequestCost* request_cost);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COST_UTIL_H_
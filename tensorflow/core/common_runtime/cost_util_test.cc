@@ -15,15 +15,21 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/cost_util.h"
 
+#include "absl/time/time.h"
 #include "tensorflow/core/common_runtime/cost_measurement.h"
 #include "tensorflow/core/common_runtime/cost_measurement_registry.h"
+#include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/common_runtime/request_cost_accessor_registry.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
 
 namespace tensorflow {
 namespace {
 
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
 class TestGcuCostMeasurement : public CostMeasurement {
  public:
   using CostMeasurement::CostMeasurement;
@@ -71,5 +77,30 @@ TEST(CreateRequestCostAccessorTest, Basic) {
   EXPECT_EQ(test_req_cost_accessor->GetRequestCost(), nullptr);
 }
 
+TEST(RecordCostAttributionTest, Basic) {
+  CostAttribution attribution;
+  (*attribution.mutable_op_time_nanos())["MatMul"] = 3000;
+  (*attribution.mutable_op_time_nanos())["_Recv"] = 2000;
+  (*attribution.mutable_device_time_nanos())["CPU:0"] = 5000;
+  attribution.set_rendezvous_wait_nanos(2000);
+  attribution.set_allocated_bytes(1024);
+  attribution.set_peak_memory_bytes(512);
+
+  RequestCost request_cost;
+  RecordCostAttribution(attribution, &request_cost);
+  attribution.set_peak_memory_bytes(256);
+  RecordCostAttribution(attribution, &request_cost);
+
+  EXPECT_THAT(request_cost.GetCosts(),
+              UnorderedElementsAre(
+                  Pair("op_time/MatMul", absl::Nanoseconds(6000)),
+                  Pair("op_time/_Recv", absl::Nanoseconds(4000)),
+                  Pair("device_time/CPU:0", absl::Nanoseconds(10000)),
+                  Pair("rendezvous_wait", absl::Nanoseconds(4000))));
+  EXPECT_THAT(request_cost.GetMetrics(),
+              UnorderedElementsAre(Pair("allocated_bytes", 2048),
+                                   Pair("peak_memory_bytes", 512)));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -37,6 +37,18 @@ namespace {
 //  - Should EventMgrs be shared between devices on a machine with multiple
 //  devices of the same type?
 static const int kNumThreads = 2;
+
+// Returns the number of callback threads requested by gpu_options, or the
+// default.
+int NumThreads(const GPUOptions& gpu_options) {
+  const int num_threads =
+      gpu_options.experimental().num_event_callback_threads();
+  if (num_threads < 0) {
+    LOG(ERROR) << "Invalid num_event_callback_threads: " << num_threads
+               << ". Using the default of " << kNumThreads << " threads.";
+  }
+  return num_threads > 0 ? num_threads : kNumThreads;
+}
 }  // namespace
 
 namespace device_event_mgr {
@@ -101,7 +113,8 @@ void InitThreadpoolLabels(thread::ThreadPool* threadpool) {
 
 EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
     : exec_(se),
-      threadpool_(Env::Default(), "Device_Event_Manager", kNumThreads) {
+      threadpool_(Env::Default(), "Device_Event_Manager",
+                  NumThreads(gpu_options)) {
   device_event_mgr::InitThreadpoolLabels(&threadpool_);
 }
 
@@ -156,30 +169,43 @@ void EventMgr::ThenExecute(se::Stream* stream, std::function<void()> func) {
   // while holding (1).  This means that to avoid a deadlock, we must drop the
   // lock on the EventMgr (3) before making any CUDA API calls (1)!
 
-  // Get an event and stream off the free list, lazily creating them if
-  // necessary.  There's currently no limit on the number of allocated events
-  // and streams.
+  // Get an event off the free list, lazily creating it if necessary.
+  // There's currently no limit on the number of allocated events and streams.
   //
   // If we have to create a new stream/event, don't call Init() while holding
   // mu_, because that's what touches the CUDA API and can cause deadlocks.
   std::unique_ptr<se::Event> event;
   bool is_new_event = false;
-  se::Stream* callback_stream;
-  bool is_new_stream = false;
   {
     mutex_lock lock(mu_);
-
-    // Get an event off the free list.
     if (free_events_.empty()) {
       free_events_.push_back(std::make_unique<se::Event>(exec_));
       is_new_event = true;
     }
     event = std::move(free_events_.back());
     free_events_.pop_back();
+  }
+  if (is_new_event) {
+    event->Init();
+  }
+  stream->ThenRecordEvent(event.get());
+
+  // If `stream` has no pending work, e.g. because the host is the bottleneck,
+  // `func` can run right away, which saves the latency of a host callback.
+  if (event->PollForStatus() == se::Event::Status::kComplete) {
+    threadpool_.Schedule(std::move(func));
+    mutex_lock lock(mu_);
+    free_events_.push_back(std::move(event));
+    return;
+  }
+
+  // Get the internal stream associated with `stream`, or grab one off the
+  // free list.
+  se::Stream* callback_stream;
+  bool is_new_stream = false;
+  {
+    mutex_lock lock(mu_);
 
-    // Get the internal stream associated with `stream`, or grab one off the
-    // free list.
-    //
     // Disable thread-safety analysis on this lambda because tsl::Mutex
     // currently lacks an AssertHeld function.  :(
     auto it = callback_streams_.lazy_emplace(
@@ -195,16 +221,12 @@ void EventMgr::ThenExecute(se::Stream* stream, std::function<void()> func) {
     callback_stream = it->second.first.get();
     it->second.second++;  // increment num_pending_events
   }
-  if (is_new_event) {
-    event->Init();
-  }
   if (is_new_stream) {
     callback_stream->Init();
   }
 
   // Set callback_stream to run `func` when `stream` finishes the work that's
   // currently pending.
-  stream->ThenRecordEvent(event.get());
   callback_stream->ThenWaitFor(event.get());
 
   // `mutable` is needed on the lambda so we can move `event` and `func`.
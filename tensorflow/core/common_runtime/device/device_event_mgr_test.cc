@@ -54,6 +54,8 @@ class TEST_EventMgrHelper {
     return em_->free_events_.size();
   }
 
+  int num_threads() { return em_->threadpool_.NumThreads(); }
+
  private:
   EventMgr* em_;
 };
@@ -102,6 +104,29 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+TEST(EventMgr, NumCallbackThreads) {
+  auto stream_exec = se::GPUMachineManager()->ExecutorForDevice(0).value();
+  GPUOptions gpu_options;
+  gpu_options.mutable_experimental()->set_num_event_callback_threads(4);
+  TEST_EventMgr em(stream_exec, gpu_options);
+  TEST_EventMgrHelper th(&em);
+  EXPECT_EQ(th.num_threads(), 4);
+
+  // Callbacks of an idle stream and of a busy one both run.
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  stream->Init();
+  Notification idle_note;
+  em.ThenExecute(stream.get(), [&idle_note]() { idle_note.Notify(); });
+  idle_note.WaitForNotification();
+  se::DeviceMemory<char> mem = stream_exec->AllocateArray<char>(1 << 20);
+  stream->ThenMemZero(&mem, 1 << 20);
+  Notification busy_note;
+  em.ThenExecute(stream.get(), [&busy_note]() { busy_note.Notify(); });
+  busy_note.WaitForNotification();
+  TF_EXPECT_OK(stream->BlockHostUntilDone());
+  stream_exec->Deallocate(&mem);
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
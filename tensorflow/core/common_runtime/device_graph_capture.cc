@@ -0,0 +1,138 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/device_graph_capture.h"
+
+#include <cstdint>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+absl::flat_hash_map<std::string, DeviceGraphCapture::Factory>*
+CaptureFactories() {
+  static auto* factories =
+      new absl::flat_hash_map<std::string, DeviceGraphCapture::Factory>;
+  return factories;
+}
+
+}  // namespace
+
+// static
+std::unique_ptr<DeviceGraphCapture> DeviceGraphCapture::Create(
+    Device* device) {
+  auto it = CaptureFactories()->find(device->device_type());
+  if (it == CaptureFactories()->end()) return nullptr;
+  return it->second(device);
+}
+
+// static
+bool DeviceGraphCapture::IsSupported(const std::string& device_type) {
+  return CaptureFactories()->contains(device_type);
+}
+
+// static
+void DeviceGraphCapture::Register(const std::string& device_type,
+                                  Factory factory) {
+  CHECK(CaptureFactories()->emplace(device_type, std::move(factory)).second)
+      << "Duplicate DeviceGraphCapture registration for " << device_type;
+}
+
+DeviceGraphCaptureAllocator::DeviceGraphCaptureAllocator(Allocator* wrapped)
+    : wrapped_(wrapped) {
+  DCHECK(wrapped_ != nullptr);
+}
+
+DeviceGraphCaptureAllocator::~DeviceGraphCaptureAllocator() {
+  DCHECK(live_.empty());
+  DCHECK(free_.empty());
+}
+
+std::string DeviceGraphCaptureAllocator::Name() { return wrapped_->Name(); }
+
+void* DeviceGraphCaptureAllocator::AllocateRaw(size_t alignment,
+                                               size_t num_bytes) {
+  mutex_lock l(mu_);
+  DCHECK(!released_) << "AllocateRaw called after ReleaseAndUnRef";
+  void* ptr = nullptr;
+  auto it = free_.find(num_bytes);
+  if (it != free_.end()) {
+    std::vector<void*>& ptrs = it->second;
+    for (size_t i = 0; i < ptrs.size(); ++i) {
+      if (reinterpret_cast<uintptr_t>(ptrs[i]) % alignment == 0) {
+        ptr = ptrs[i];
+        ptrs[i] = ptrs.back();
+        ptrs.pop_back();
+        break;
+      }
+    }
+    if (ptrs.empty()) free_.erase(it);
+  }
+  if (ptr == nullptr) {
+    ptr = wrapped_->AllocateRaw(alignment, num_bytes);
+    if (ptr == nullptr) return nullptr;
+    reserved_bytes_ += num_bytes;
+  }
+  live_.emplace(ptr, num_bytes);
+  return ptr;
+}
+
+void DeviceGraphCaptureAllocator::DeallocateRaw(void* ptr) {
+  bool should_delete;
+  {
+    mutex_lock l(mu_);
+    auto it = live_.find(ptr);
+    CHECK(it != live_.end()) << "Unknown pointer " << ptr;
+    const size_t num_bytes = it->second;
+    live_.erase(it);
+    if (released_) {
+      wrapped_->DeallocateRaw(ptr);
+    } else {
+      free_[num_bytes].push_back(ptr);
+    }
+    should_delete = MaybeDelete();
+  }
+  if (should_delete) delete this;
+}
+
+int64_t DeviceGraphCaptureAllocator::reserved_bytes() {
+  mutex_lock l(mu_);
+  return reserved_bytes_;
+}
+
+void DeviceGraphCaptureAllocator::ReleaseAndUnRef() {
+  bool should_delete;
+  {
+    mutex_lock l(mu_);
+    DCHECK(!released_);
+    released_ = true;
+    for (auto& entry : free_) {
+      for (void* ptr : entry.second) wrapped_->DeallocateRaw(ptr);
+    }
+    free_.clear();
+    should_delete = MaybeDelete();
+  }
+  if (should_delete) delete this;
+}
+
+bool DeviceGraphCaptureAllocator::MaybeDelete() {
+  return released_ && live_.empty();
+}
+
+}  // namespace tensorflow
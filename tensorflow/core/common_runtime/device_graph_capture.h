@@ -0,0 +1,140 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_DEVICE_GRAPH_CAPTURE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_DEVICE_GRAPH_CAPTURE_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+class Device;
+
+// A DeviceGraphCapture records the work that one step enqueues onto a device
+// and replays it in later steps without running the executor, e.g. as a CUDA
+// graph on a GPU device. Replaying is only correct for steps that enqueue the
+// same work on the same buffers, so the caller is responsible for running
+// steps with identical shapes, for serving all allocations of the captured
+// step from a DeviceGraphCaptureAllocator, and for copying (see
+// `EnqueueCopy()`) the inputs of each replayed step into the buffers that the
+// captured step read them from, and its outputs out of the buffers that the
+// captured step wrote them to.
+class DeviceGraphCapture {
+ public:
+  typedef std::function<std::unique_ptr<DeviceGraphCapture>(Device*)> Factory;
+
+  virtual ~DeviceGraphCapture() = default;
+
+  // Calls `fn`, which enqueues the work of one step onto the device, and
+  // records that work instead of executing it. Returns an error if the work
+  // cannot be captured (e.g. because `fn` synchronizes with the host), in
+  // which case the caller must fall back to running its steps normally. Must
+  // be called at most once.
+  virtual Status Capture(const std::function<Status()>& fn) = 0;
+
+  // Enqueues a copy of `src` into `dst`, which must have the same size and
+  // both live on the device, in order with the replayed work. The copy may not
+  // have completed when this returns.
+  virtual Status EnqueueCopy(const Tensor& src, const Tensor& dst) = 0;
+
+  // Enqueues the captured work. The work may not have completed when this
+  // returns.
+  virtual Status Replay() = 0;
+
+  // Returns a new capture for `device`, or nullptr if no factory has been
+  // registered for the type of `device`.
+  static std::unique_ptr<DeviceGraphCapture> Create(Device* device);
+
+  // Returns true iff a factory has been registered for `device_type`.
+  static bool IsSupported(const std::string& device_type);
+
+  // Registers `factory` for `device_type`. Note: This should only be called
+  // via the constructor of DeviceGraphCapture::Registration.
+  static void Register(const std::string& device_type, Factory factory);
+
+  // Object used to call Register() at static-initialization time.
+  // Note: This should only ever be used as a global-static object; no stack
+  // or heap instances.
+  class Registration {
+   public:
+    Registration(const std::string& device_type, Factory factory) {
+      Register(device_type, std::move(factory));
+    }
+  };
+};
+
+// DeviceGraphCaptureAllocator is a wrapper for an Allocator that keeps every
+// buffer it hands out reserved for as long as the captured work may be
+// replayed. Deallocated buffers are not returned to the wrapped allocator but
+// kept on a free list, from which later allocations of the same size and
+// alignment are served, so that the captured step uses no more memory than a
+// normal step that reuses freed buffers in order. This is correct as long as
+// all of the captured work is ordered on a single device stream. The buffers are returned to
+// the wrapped allocator once `ReleaseAndUnRef()` has been called.
+//
+// Like StepArenaAllocator, the wrapper deletes itself once
+// `ReleaseAndUnRef()` has been called and the last outstanding allocation has
+// been deallocated.
+class DeviceGraphCaptureAllocator : public Allocator {
+ public:
+  explicit DeviceGraphCaptureAllocator(Allocator* wrapped);
+
+  std::string Name() override;
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return wrapped_->GetMemoryType();
+  }
+
+  // Returns the number of bytes obtained from the wrapped allocator.
+  int64_t reserved_bytes();
+
+  // Returns the buffers on the free list to the wrapped allocator. After this
+  // call, the only further calls allowed on this wrapper are calls to
+  // DeallocateRaw with pointers that were allocated by this wrapper and have
+  // not yet been deallocated, which are forwarded to the wrapped allocator.
+  void ReleaseAndUnRef();
+
+ protected:
+  ~DeviceGraphCaptureAllocator() override;
+
+ private:
+  // Returns true iff this wrapper must be deleted.
+  bool MaybeDelete() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const wrapped_;
+  mutex mu_;
+  bool released_ TF_GUARDED_BY(mu_) = false;
+  int64_t reserved_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // The sizes of the buffers that are currently allocated.
+  absl::flat_hash_map<void*, size_t> live_ TF_GUARDED_BY(mu_);
+  // The deallocated buffers, by size.
+  absl::flat_hash_map<size_t, std::vector<void*>> free_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_DEVICE_GRAPH_CAPTURE_H_
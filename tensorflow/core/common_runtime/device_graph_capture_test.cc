@@ -0,0 +1,81 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/device_graph_capture.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Counts the calls made to an underlying allocator.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocs_;
+    ++num_live_;
+    return port::AlignedMalloc(num_bytes, alignment);
+  }
+  void DeallocateRaw(void* ptr) override {
+    --num_live_;
+    port::AlignedFree(ptr);
+  }
+
+  int num_allocs() const { return num_allocs_; }
+  int num_live() const { return num_live_; }
+
+ private:
+  int num_allocs_ = 0;
+  int num_live_ = 0;
+};
+
+TEST(DeviceGraphCaptureAllocatorTest, ReusesFreedBuffersOfTheSameSize) {
+  CountingAllocator base;
+  auto* allocator = new DeviceGraphCaptureAllocator(&base);
+  void* a = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  allocator->DeallocateRaw(a);
+  // The freed buffer is kept reserved and served again.
+  EXPECT_EQ(base.num_live(), 1);
+  void* b = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  EXPECT_EQ(a, b);
+  void* c = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 512);
+  EXPECT_NE(c, b);
+  EXPECT_EQ(base.num_allocs(), 2);
+  EXPECT_EQ(allocator->reserved_bytes(), 768);
+  allocator->DeallocateRaw(b);
+  allocator->DeallocateRaw(c);
+  EXPECT_EQ(base.num_live(), 2);
+  allocator->ReleaseAndUnRef();
+  EXPECT_EQ(base.num_live(), 0);
+}
+
+TEST(DeviceGraphCaptureAllocatorTest, LiveBuffersOutliveRelease) {
+  CountingAllocator base;
+  auto* allocator = new DeviceGraphCaptureAllocator(&base);
+  void* a = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 64);
+  void* b = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 64);
+  allocator->DeallocateRaw(b);
+  allocator->ReleaseAndUnRef();
+  EXPECT_EQ(base.num_live(), 1);
+  // Deallocating the last live buffer returns it and deletes the wrapper.
+  allocator->DeallocateRaw(a);
+  EXPECT_EQ(base.num_live(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -28,27 +28,34 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/constant_folding.h"
 #include "tensorflow/core/common_runtime/debugger_state_interface.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_graph_capture.h"
 #include "tensorflow/core/common_runtime/device_resolver_local.h"
+#include "tensorflow/core/common_runtime/cost_util.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
+#include "tensorflow/core/common_runtime/kernel_cost_estimates.h"
 #include "tensorflow/core/common_runtime/local_session_selection.h"
 #include "tensorflow/core/common_runtime/memory_types.h"
+#include "tensorflow/core/common_runtime/op_latency_sampler.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/graph_def_util.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/logging.h"
+#include "tensorflow/core/framework/memory_types.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/run_handler.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
@@ -81,6 +88,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/env_var.h"
+#include "tensorflow/tsl/profiler/lib/step_counter.h"
 
 namespace tensorflow {
 
@@ -156,6 +164,40 @@ string GetRendezvousKey(const string& tensor_name,
                          frame_iter.frame_id, ":", frame_iter.iter_id);
 }
 
+// Returns true iff replaying the captured device work of `graph` is
+// equivalent to running it: its ops must be stateless, and their inputs and
+// outputs must live on the device, since host code is not replayed.
+bool IsCapturablePartition(const Graph& graph, const DeviceType& device_type) {
+  MemoryTypeVector input_memory_types;
+  MemoryTypeVector output_memory_types;
+  for (const Node* n : graph.op_nodes()) {
+    if (n->IsArg() || n->IsRetval()) continue;
+    if (n->op_def().is_stateful()) return false;
+    if (!MemoryTypesForNode(graph.op_registry(), device_type, n->def(),
+                            &input_memory_types, &output_memory_types)
+             .ok()) {
+      return false;
+    }
+    for (MemoryType t : input_memory_types) {
+      if (t == HOST_MEMORY) return false;
+    }
+    for (MemoryType t : output_memory_types) {
+      if (t == HOST_MEMORY) return false;
+    }
+  }
+  return true;
+}
+
+// Returns a key that identifies the dtypes and shapes of `tensors`.
+string FeedSignature(const std::vector<Tensor>& tensors) {
+  string signature;
+  for (const Tensor& t : tensors) {
+    strings::StrAppend(&signature, DataTypeString(t.dtype()),
+                       t.shape().DebugString(), ";");
+  }
+  return signature;
+}
+
 }  // namespace
 
 class DirectSessionFactory : public SessionFactory {
@@ -382,6 +424,11 @@ DirectSession::DirectSession(const SessionOptions& options,
     }
     ++devices_added;
   }
+
+  if (!options_.config.experimental().graph_compile_cache_dir().empty()) {
+    graph_compile_cache_ = std::make_unique<GraphCompileCache>(
+        options_.env, options_.config.experimental().graph_compile_cache_dir());
+  }
 }
 
 DirectSession::~DirectSession() {
@@ -392,6 +439,7 @@ DirectSession::~DirectSession() {
   for (auto& it : executors_) {
     it.second.reset();
   }
+  retired_executors_.clear();
   callables_.clear();
   for (auto d : device_mgr_->ListDevices()) {
     d->op_segment()->RemoveHold(session_handle_);
@@ -507,7 +555,9 @@ Status DirectSession::RunInternal(
     int64_t step_id, const RunOptions& run_options,
     CallFrameInterface* call_frame, ExecutorsAndKeys* executors_and_keys,
     RunMetadata* run_metadata,
-    const thread::ThreadPoolOptions& threadpool_options) {
+    const thread::ThreadPoolOptions& threadpool_options,
+    const std::vector<Tensor>* fetch_buffers,
+    DeviceGraphCaptureAllocator* capture_allocator) {
   const uint64 start_time_usecs = options_.env->NowMicros();
   const int64_t executor_step_count =
       executors_and_keys->step_count.fetch_add(1);
@@ -533,6 +583,7 @@ Status DirectSession::RunInternal(
       },
       profiler::ContextType::kTfExecutor, step_id,
       profiler::TraceMeLevel::kInfo);
+  tsl::profiler::StepCounter::StepStarted();
 
   std::unique_ptr<DebuggerStateInterface> debugger_state;
   if (!run_options.debug_options().debug_tensor_watch_opts().empty()) {
@@ -616,14 +667,15 @@ Status DirectSession::RunInternal(
 
   std::unique_ptr<RunHandler> handler;
   if (ShouldUseRunHandlerPool(run_options) &&
-      run_options.experimental().use_run_handler_pool()) {
+      (run_options.experimental().use_run_handler_pool() ||
+       options_.config.experimental().use_run_handler_pool())) {
     VLOG(1) << "Using RunHandler to scheduler inter-op closures.";
     handler = GetOrCreateRunHandlerPool(options_)->Get(
         step_id, call_timeout,
         run_options.experimental().run_handler_pool_options());
     if (!handler) {
       return errors::DeadlineExceeded(
-          "Could not obtain RunHandler for request after waiting for ",
+          "Could not obtain RunHandler for request within its deadline of ",
           call_timeout, "ms.");
     }
   }
@@ -664,10 +716,13 @@ Status DirectSession::RunInternal(
   args.session_handle = session_handle_;
   args.tensor_store = &run_state.tensor_store;
   args.step_container = &run_state.step_container;
-  args.sync_on_finish = sync_on_finish_;
+  // A captured step only enqueues work on the device, so it must not wait
+  // for that work.
+  args.sync_on_finish = sync_on_finish_ && capture_allocator == nullptr;
   args.user_intra_op_threadpool = threadpool_options.intra_op_threadpool;
   args.run_all_kernels_inline = pool == nullptr;
   args.start_time_usecs = start_time_usecs;
+  args.default_allocator_override = capture_allocator;
   args.deadline = deadline;
 
   const bool do_trace = (run_options.trace_level() > RunOptions::NO_TRACE);
@@ -684,11 +739,17 @@ Status DirectSession::RunInternal(
           ((measure_step_count + 1) % build_cost_model_every == 0);
     }
   }
+  std::unique_ptr<CostAttributionCollector> cost_collector;
+  if (run_options.experimental().collect_cost_attribution()) {
+    cost_collector = std::make_unique<CostAttributionCollector>();
+  }
   if (do_trace || update_cost_model ||
       run_options.report_tensor_allocations_upon_oom()) {
     run_state.collector.reset(
         new StepStatsCollector(run_metadata->mutable_step_stats()));
     args.stats_collector = run_state.collector.get();
+  } else if (cost_collector != nullptr) {
+    args.stats_collector = cost_collector.get();
   }
 
   std::unique_ptr<DeviceProfilerSession> device_profiler_session;
@@ -706,9 +767,47 @@ Status DirectSession::RunInternal(
 
   Status run_status;
 
+  // If requested, give each CPU partition a per-step arena for its kernel
+  // allocations. The arenas are released once all executors are done.
+  std::vector<std::pair<Device*, StepArenaAllocator*>> step_arenas;
+  if (capture_allocator == nullptr &&
+      (options_.config.experimental().use_step_arena_allocator() ||
+       options_.config.experimental().use_static_memory_plan())) {
+    for (const auto& item : executors_and_keys->items) {
+      if (item.device->device_type() != DEVICE_CPU) continue;
+      step_arenas.emplace_back(
+          item.device,
+          new StepArenaAllocator(
+              item.device->GetAllocator(AllocatorAttributes()),
+              StepArenaAllocator::kDefaultChunkSize, item.memory_plan.get()));
+    }
+  }
+
+  // If requested, let the kernels that produce the fetched values allocate
+  // their outputs in the buffers of the caller's fetch tensors.
+  std::vector<std::vector<Executor::Args::PreallocatedOutput>>
+      preallocated_outputs;
+  if (fetch_buffers != nullptr) {
+    preallocated_outputs.resize(num_executors);
+    for (size_t i = 0; i < num_executors; ++i) {
+      const auto& item = executors_and_keys->items[i];
+      for (const auto& producer : item.retval_producers) {
+        const Tensor& buffer = (*fetch_buffers)[producer.retval_index];
+        if (buffer.IsInitialized() &&
+            buffer.dtype() ==
+                executors_and_keys->output_types[producer.retval_index] &&
+            buffer.RefCountIsOne()) {
+          preallocated_outputs[i].push_back(
+              {producer.node_id, producer.output_slot, &buffer});
+        }
+      }
+    }
+  }
+
   auto set_threadpool_args_for_item =
-      [&default_runner, &handler](const PerPartitionExecutorsAndLib& item,
-                                  Executor::Args* args) {
+      [&default_runner, &handler, &step_arenas, &preallocated_outputs,
+       executors_and_keys](const PerPartitionExecutorsAndLib& item,
+                           Executor::Args* args) {
         // TODO(azaks): support partial run.
         // TODO(azaks): if the device picks its own threadpool, we need to
         // assign
@@ -728,6 +827,17 @@ Status DirectSession::RunInternal(
           args->user_intra_op_threadpool =
               handler->AsIntraThreadPoolInterface();
         }
+        args->step_arena_allocator = nullptr;
+        for (const auto& device_and_arena : step_arenas) {
+          if (device_and_arena.first == item.device) {
+            args->step_arena_allocator = device_and_arena.second;
+            break;
+          }
+        }
+        if (!preallocated_outputs.empty()) {
+          args->preallocated_outputs =
+              preallocated_outputs[&item - executors_and_keys->items.data()];
+        }
       };
 
   if (can_execute_synchronously) {
@@ -767,6 +877,17 @@ Status DirectSession::RunInternal(
     }
   }
 
+  for (const auto& device_and_arena : step_arenas) {
+    const StepArenaAllocator::Stats arena_stats =
+        device_and_arena.second->ReleaseAndUnRef();
+    if (run_state.collector) {
+      NodeExecStats* node_stats = new NodeExecStats;
+      StepArenaAllocator::FillNodeExecStats(arena_stats, "_StepArena",
+                                            node_stats);
+      run_state.collector->Save(device_and_arena.first->name(), node_stats);
+    }
+  }
+
   if (step_cancellation_manager.IsCancelled()) {
     run_status.Update(errors::Cancelled("Run call was cancelled"));
   }
@@ -786,6 +907,25 @@ Status DirectSession::RunInternal(
         &session_state_));
   }
 
+  if (cost_collector != nullptr) {
+    // A traced step collects its costs in its step stats.
+    if (run_state.collector) {
+      run_state.collector->AttributeCosts(cost_collector.get());
+    }
+    CostAttribution attribution;
+    cost_collector->Fill(&attribution);
+    std::unique_ptr<RequestCostAccessor> request_cost_accessor =
+        CreateRequestCostAccessor();
+    if (request_cost_accessor != nullptr &&
+        request_cost_accessor->GetRequestCost() != nullptr) {
+      RecordCostAttribution(attribution,
+                            request_cost_accessor->GetRequestCost());
+    }
+    if (run_metadata != nullptr) {
+      *run_metadata->mutable_cost_attribution() = std::move(attribution);
+    }
+  }
+
   if (run_state.collector) {
     run_state.collector->Finalize();
   }
@@ -828,7 +968,13 @@ Status DirectSession::RunInternal(
       }
     }
   }
-  metrics::UpdateGraphExecTime(options_.env->NowMicros() - start_time_usecs);
+  const uint64 run_time_usecs = options_.env->NowMicros() - start_time_usecs;
+  metrics::UpdateGraphExecTime(run_time_usecs);
+  if (OpLatencySampler::Enabled()) {
+    OpLatencySampler::RecordModel(
+        options_.config.experimental().session_metadata().name(),
+        run_time_usecs);
+  }
 
   return OkStatus();
 }
@@ -1102,6 +1248,10 @@ Status DirectSession::PRun(const string& handle, const NamedTensorList& inputs,
     s = run_state->tensor_store.SaveTensors(output_names, &session_state_);
   }
 
+  // The run state of a finished partial run. It is destroyed once its
+  // executors are done, without holding `executor_lock_`, so that a stream of
+  // partial runs can overlap the tail of one step with the start of the next.
+  std::unique_ptr<PartialRunState> finished_run_state;
   {
     mutex_lock l(executor_lock_);
     // Delete the run state if there is an error or all fetches are done.
@@ -1125,11 +1275,16 @@ Status DirectSession::PRun(const string& handle, const NamedTensorList& inputs,
       done = run_state->PendingDone();
     }
     if (done) {
-      WaitForNotification(&run_state->executors_done, run_state,
-                          cancellation_manager_, operation_timeout_in_ms_);
-      partial_runs_.erase(handle);
+      auto prun_it = partial_runs_.find(handle);
+      finished_run_state = std::move(prun_it->second);
+      partial_runs_.erase(prun_it);
     }
   }
+  if (finished_run_state != nullptr) {
+    WaitForNotification(&finished_run_state->executors_done,
+                        finished_run_state.get(), cancellation_manager_,
+                        operation_timeout_in_ms_);
+  }
 
   return s;
 }
@@ -1331,6 +1486,8 @@ Status DirectSession::CreateExecutors(
   TF_RETURN_IF_ERROR(CreateGraphs(
       options, &graphs, &func_info->flib_def, run_state_args, &ek->input_types,
       &ek->output_types, &ek->collective_graph_key));
+  ek->awaiting_background_optimization =
+      run_state_args->awaiting_background_optimization;
 
   if (run_state_args->is_partial_run) {
     ek->graph = std::move(run_state_args->graph);
@@ -1389,6 +1546,10 @@ Status DirectSession::CreateExecutors(
     params.device = device;
     params.session_metadata = session_metadata;
     params.function_library = lib;
+    if (options_.config.experimental().use_measured_kernel_costs() &&
+        device->device_type() == DEVICE_CPU) {
+      params.kernel_cost_estimates = KernelCostEstimates::Global();
+    }
     auto opseg = device->op_segment();
     params.create_kernel =
         [this, lib, opseg](const std::shared_ptr<const NodeProperties>& props,
@@ -1432,8 +1593,36 @@ Status DirectSession::CreateExecutors(
     item->executor = nullptr;
     item->device = device;
     auto executor_type = options_.config.experimental().executor_type();
+    if (callable_options.reuse_fetch_buffers() &&
+        !run_state_args->is_partial_run &&
+        device->device_type() == DEVICE_CPU) {
+      for (const Node* n : partition_graph->op_nodes()) {
+        if (!n->IsRetval()) continue;
+        int index;
+        TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "index", &index));
+        const Edge* edge;
+        TF_RETURN_IF_ERROR(n->input_edge(0, &edge));
+        item->retval_producers.push_back(
+            {edge->src()->id(), edge->src_output(), index});
+      }
+      std::sort(item->retval_producers.begin(), item->retval_producers.end(),
+                [](const PerPartitionExecutorsAndLib::RetvalProducer& a,
+                   const PerPartitionExecutorsAndLib::RetvalProducer& b) {
+                  return a.node_id < b.node_id;
+                });
+    }
+    item->capturable =
+        options_.config.experimental().capture_device_graphs() &&
+        !run_state_args->is_partial_run &&
+        DeviceGraphCapture::IsSupported(device->device_type()) &&
+        IsCapturablePartition(*partition_graph,
+                              DeviceType(device->device_type()));
     TF_RETURN_IF_ERROR(
         NewExecutor(executor_type, params, *partition_graph, &item->executor));
+    if (options_.config.experimental().use_static_memory_plan() &&
+        device->device_type() == DEVICE_CPU) {
+      item->memory_plan = std::make_unique<StaticMemoryPlan>();
+    }
     if (!options_.config.experimental().disable_output_partition_graphs() ||
         options_.config.graph_options().build_cost_model() > 0) {
       item->graph = std::move(partition_graph);
@@ -1478,6 +1667,34 @@ Status DirectSession::CreateExecutors(
   return OkStatus();
 }
 
+bool DirectSession::EvictIfBackgroundOptimized(
+    const std::shared_ptr<ExecutorsAndKeys>& executors_and_keys) {
+  if (!executors_and_keys->awaiting_background_optimization) return false;
+  {
+    mutex_lock l(graph_state_lock_);
+    if (finalized_ || execution_state_ == nullptr ||
+        !execution_state_->HasBackgroundOptimizedGraph(
+            executors_and_keys->callable_options)) {
+      return false;
+    }
+  }
+  mutex_lock l(executor_lock_);
+  bool evicted = false;
+  for (auto it = executors_.begin(); it != executors_.end();) {
+    if (it->second == executors_and_keys) {
+      it = executors_.erase(it);
+      evicted = true;
+    } else {
+      ++it;
+    }
+  }
+  if (evicted) {
+    VLOG(1) << "Recreating executors from the background optimized graph";
+    retired_executors_.push_back(executors_and_keys);
+  }
+  return true;
+}
+
 Status DirectSession::GetOrCreateExecutors(
     gtl::ArraySlice<string> inputs, gtl::ArraySlice<string> outputs,
     gtl::ArraySlice<string> target_nodes, ExecutorsAndKeys** executors_and_keys,
@@ -1505,14 +1722,18 @@ Status DirectSession::GetOrCreateExecutors(
   }
 
   // See if we already have the executors for this run.
+  std::shared_ptr<ExecutorsAndKeys> cached;
   {
     mutex_lock l(executor_lock_);  // could use reader lock
     auto it = executors_.find(key);
     if (it != executors_.end()) {
-      *executors_and_keys = it->second.get();
-      return OkStatus();
+      cached = it->second;
     }
   }
+  if (cached != nullptr && !EvictIfBackgroundOptimized(cached)) {
+    *executors_and_keys = cached.get();
+    return OkStatus();
+  }
 
   // Slow lookup path, the unsorted key missed the cache.
   // Sort the inputs and outputs, and look up with the sorted key in case an
@@ -1538,14 +1759,18 @@ Status DirectSession::GetOrCreateExecutors(
   }
 
   // See if we already have the executors for this run.
+  cached = nullptr;
   {
     mutex_lock l(executor_lock_);
     auto it = executors_.find(sorted_key);
     if (it != executors_.end()) {
-      *executors_and_keys = it->second.get();
-      return OkStatus();
+      cached = it->second;
     }
   }
+  if (cached != nullptr && !EvictIfBackgroundOptimized(cached)) {
+    *executors_and_keys = cached.get();
+    return OkStatus();
+  }
 
   // Nothing found, so create the executors and store in the cache.
   // The executor_lock_ is intentionally released while executors are
@@ -1603,6 +1828,32 @@ Status DirectSession::CreateGraphs(
     return errors::FailedPrecondition("Session has been finalized.");
   }
 
+  // Partial runs need the full graph of the execution state, which the cache
+  // does not store.
+  string cache_key;
+  if (graph_compile_cache_ != nullptr && !run_state_args->is_partial_run &&
+      execution_state_->original_graph_def() != nullptr) {
+    cache_key = GraphCompileCache::ComputeKey(
+        *execution_state_->original_graph_def(), options_.config,
+        subgraph_options.callable_options, device_set_);
+    GraphCompileCacheEntry entry;
+    Status s = graph_compile_cache_->Lookup(cache_key, &entry);
+    if (s.ok()) {
+      s = CreateGraphsFromCacheEntry(entry, outputs, flib_def, input_types,
+                                     output_types, collective_graph_key);
+      if (s.ok()) {
+        VLOG(1) << "Loaded graphs for " << cache_key
+                << " from the graph compile cache";
+        return OkStatus();
+      }
+      outputs->clear();
+    }
+    if (!errors::IsNotFound(s)) {
+      LOG(WARNING) << "Ignoring graph compile cache entry " << cache_key
+                   << ": " << s;
+    }
+  }
+
   std::unique_ptr<ClientGraph> client_graph;
 
   std::unique_ptr<GraphExecutionState> temp_exec_state_holder;
@@ -1626,6 +1877,8 @@ Status DirectSession::CreateGraphs(
         execution_state->BuildGraph(subgraph_options, &client_graph));
   }
   *collective_graph_key = client_graph->collective_graph_key;
+  run_state_args->awaiting_background_optimization =
+      client_graph->awaiting_background_optimization;
 
   if (subgraph_options.callable_options.feed_size() !=
       client_graph->feed_types.size()) {
@@ -1729,8 +1982,93 @@ Status DirectSession::CreateGraphs(
   TF_RETURN_IF_ERROR(OptimizationPassRegistry::Global()->RunGrouping(
       OptimizationPassRegistry::POST_PARTITIONING, optimization_options));
 
-  Status s;
-  for (auto& partition : *outputs) {
+  // Only the fully optimized graphs are cached.
+  if (!cache_key.empty() && !client_graph->awaiting_background_optimization) {
+    GraphCompileCacheEntry entry;
+    for (const auto& partition : *outputs) {
+      GraphDef* graph_def =
+          &(*entry.mutable_partition_graphs())[partition.first];
+      partition.second->ToGraphDef(graph_def);
+      // The partitions share the library, which is stored once.
+      graph_def->clear_library();
+    }
+    *entry.mutable_library() = client_graph->flib_def->ToProto();
+    for (DataType dtype : client_graph->feed_types) {
+      entry.add_feed_types(dtype);
+    }
+    for (DataType dtype : client_graph->fetch_types) {
+      entry.add_fetch_types(dtype);
+    }
+    entry.set_collective_graph_key(client_graph->collective_graph_key);
+    entry.mutable_stateful_placements()->insert(stateful_placements_.begin(),
+                                                stateful_placements_.end());
+    Status s = graph_compile_cache_->Insert(cache_key, entry);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to store graph compile cache entry " << cache_key
+                   << ": " << s;
+    }
+  }
+
+  Status s = MaybeRewritePartitionGraphs(outputs);
+  *flib_def = std::move(client_graph->flib_def);
+  std::swap(*input_types, client_graph->feed_types);
+  std::swap(*output_types, client_graph->fetch_types);
+  return s;
+}
+
+Status DirectSession::CreateGraphsFromCacheEntry(
+    const GraphCompileCacheEntry& entry,
+    std::unordered_map<string, std::unique_ptr<Graph>>* outputs,
+    std::unique_ptr<FunctionLibraryDefinition>* flib_def,
+    DataTypeVector* input_types, DataTypeVector* output_types,
+    int64_t* collective_graph_key) {
+  for (const auto& placement_pair : entry.stateful_placements()) {
+    auto iter = stateful_placements_.find(placement_pair.first);
+    if (iter != stateful_placements_.end() &&
+        iter->second != placement_pair.second) {
+      return errors::Internal(
+          "Stateful placement mismatch. "
+          "Current assignment of ",
+          placement_pair.first, " to ", iter->second, " does not match ",
+          placement_pair.second);
+    }
+  }
+
+  auto lib = std::make_unique<FunctionLibraryDefinition>(OpRegistry::Global(),
+                                                         entry.library());
+  for (const auto& partition : entry.partition_graphs()) {
+    Device* d;
+    TF_RETURN_IF_ERROR(device_mgr_->LookupDevice(partition.first, &d));
+    std::unique_ptr<Graph> device_graph(new Graph(lib.get()));
+    device_graph->SetConstructionContext(ConstructionContext::kDirectSession);
+    GraphConstructorOptions device_opts;
+    device_opts.allow_internal_ops = true;
+    device_opts.expect_device_spec = true;
+    TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(device_opts, partition.second,
+                                              device_graph.get()));
+    outputs->emplace(partition.first, std::move(device_graph));
+  }
+  TF_RETURN_IF_ERROR(MaybeRewritePartitionGraphs(outputs));
+
+  for (const auto& placement_pair : entry.stateful_placements()) {
+    stateful_placements_.emplace(placement_pair.first, placement_pair.second);
+  }
+  *flib_def = std::move(lib);
+  input_types->clear();
+  for (int dtype : entry.feed_types()) {
+    input_types->push_back(static_cast<DataType>(dtype));
+  }
+  output_types->clear();
+  for (int dtype : entry.fetch_types()) {
+    output_types->push_back(static_cast<DataType>(dtype));
+  }
+  *collective_graph_key = entry.collective_graph_key();
+  return OkStatus();
+}
+
+Status DirectSession::MaybeRewritePartitionGraphs(
+    std::unordered_map<string, std::unique_ptr<Graph>>* graphs) {
+  for (auto& partition : *graphs) {
     const string& partition_name = partition.first;
     std::unique_ptr<Graph>* graph = &partition.second;
 
@@ -1739,17 +2077,10 @@ Status DirectSession::CreateGraphs(
 
     // Give the device an opportunity to rewrite its subgraph.
     Device* d;
-    s = device_mgr_->LookupDevice(partition_name, &d);
-    if (!s.ok()) break;
-    s = d->MaybeRewriteGraph(graph);
-    if (!s.ok()) {
-      break;
-    }
+    TF_RETURN_IF_ERROR(device_mgr_->LookupDevice(partition_name, &d));
+    TF_RETURN_IF_ERROR(d->MaybeRewriteGraph(graph));
   }
-  *flib_def = std::move(client_graph->flib_def);
-  std::swap(*input_types, client_graph->feed_types);
-  std::swap(*output_types, client_graph->fetch_types);
-  return s;
+  return OkStatus();
 }
 
 ::tensorflow::Status DirectSession::ListDevices(
@@ -1866,6 +2197,9 @@ Status DirectSession::MakeCallable(const CallableOptions& callable_options,
   RunStateArgs run_state_args(callable_options.run_options().debug_options());
   TF_RETURN_IF_ERROR(
       CreateExecutors(callable_options, &ek, &func_info, &run_state_args));
+  if (ek->items.size() == 1 && ek->items[0].capturable) {
+    ek->capture_cache = std::make_unique<CaptureCache>();
+  }
   {
     mutex_lock l(callables_lock_);
     *out_handle = next_callable_handle_++;
@@ -1996,6 +2330,18 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     actual_feed_tensors = &feed_tensors;
   }
 
+  if (executors_and_keys->capture_cache != nullptr &&
+      fetch_tensors != nullptr &&
+      !executors_and_keys->callable_options.reuse_fetch_buffers() &&
+      executors_and_keys->callable_options.run_options().trace_level() ==
+          RunOptions::NO_TRACE) {
+    bool replayed = false;
+    TF_RETURN_IF_ERROR(RunCapturedCallable(
+        step_id, *actual_feed_tensors, fetch_tensors, executors_and_keys.get(),
+        run_metadata, threadpool_options, &replayed));
+    if (replayed) return OkStatus();
+  }
+
   // A specialized CallFrame implementation that takes advantage of the
   // optimized RunCallable interface.
   RunCallableCallFrame call_frame(this, executors_and_keys.get(),
@@ -2005,9 +2351,20 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     LogMemory::RecordStep(step_id, run_state_args.handle);
   }
 
+  // The buffers of the caller's fetch tensors, which the step may reuse for
+  // the fetched values. `fetch_tensors` itself is overwritten by the call
+  // frame, so the step holds its own references.
+  std::vector<Tensor> fetch_buffers;
+  if (fetch_tensors != nullptr &&
+      executors_and_keys->callable_options.reuse_fetch_buffers()) {
+    fetch_buffers.swap(*fetch_tensors);
+    fetch_tensors->resize(fetch_buffers.size());
+  }
+
   TF_RETURN_IF_ERROR(RunInternal(
       step_id, executors_and_keys->callable_options.run_options(), &call_frame,
-      executors_and_keys.get(), run_metadata, threadpool_options));
+      executors_and_keys.get(), run_metadata, threadpool_options,
+      fetch_buffers.empty() ? nullptr : &fetch_buffers));
 
   if (fetch_tensors != nullptr) {
     size_t output_size = 0;
@@ -2020,6 +2377,122 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   return OkStatus();
 }
 
+DirectSession::CapturedStep::~CapturedStep() {
+  staging_feeds.clear();
+  captured_fetches.clear();
+  capture.reset();
+  if (allocator != nullptr) allocator->ReleaseAndUnRef();
+}
+
+::tensorflow::Status DirectSession::CaptureCallable(
+    int64_t step_id, const std::vector<Tensor>& feed_tensors,
+    ExecutorsAndKeys* executors_and_keys, RunMetadata* run_metadata,
+    const thread::ThreadPoolOptions& threadpool_options,
+    CapturedStep* captured) {
+  Device* device = executors_and_keys->items[0].device;
+  captured->capture = DeviceGraphCapture::Create(device);
+  if (captured->capture == nullptr) {
+    return errors::Unimplemented("Graph capture is not supported on ",
+                                 device->name());
+  }
+  Allocator* device_allocator = device->GetAllocator(AllocatorAttributes());
+  DeviceGraphCaptureAllocator* allocator =
+      new DeviceGraphCaptureAllocator(device_allocator);
+  captured->allocator = allocator;
+  // The feed buffers are initialized in case the capture executes the work.
+  for (const Tensor& t : feed_tensors) {
+    captured->staging_feeds.emplace_back(device_allocator, t.dtype(),
+                                         t.shape());
+    TF_RETURN_IF_ERROR(
+        captured->capture->EnqueueCopy(t, captured->staging_feeds.back()));
+  }
+  captured->captured_fetches.resize(executors_and_keys->output_types.size());
+  RunCallableCallFrame call_frame(this, executors_and_keys,
+                                  &captured->staging_feeds,
+                                  &captured->captured_fetches);
+  return captured->capture->Capture([&]() {
+    return RunInternal(step_id,
+                       executors_and_keys->callable_options.run_options(),
+                       &call_frame, executors_and_keys, run_metadata,
+                       threadpool_options, /*fetch_buffers=*/nullptr,
+                       allocator);
+  });
+}
+
+::tensorflow::Status DirectSession::RunCapturedCallable(
+    int64_t step_id, const std::vector<Tensor>& feed_tensors,
+    std::vector<Tensor>* fetch_tensors, ExecutorsAndKeys* executors_and_keys,
+    RunMetadata* run_metadata,
+    const thread::ThreadPoolOptions& threadpool_options, bool* replayed) {
+  *replayed = false;
+  CaptureCache* cache = executors_and_keys->capture_cache.get();
+  const string signature = FeedSignature(feed_tensors);
+  CapturedStep* captured;
+  {
+    mutex_lock l(cache->mu);
+    auto it = cache->steps.find(signature);
+    if (it == cache->steps.end()) {
+      if (cache->steps.size() >= CaptureCache::kMaxSignatures) {
+        return OkStatus();
+      }
+      it = cache->steps.emplace(signature, std::make_unique<CapturedStep>())
+               .first;
+    }
+    captured = it->second.get();
+  }
+
+  mutex_lock l(captured->mu);
+  // The first step with a signature warms up the kernels (e.g. their
+  // autotuning and lazily created handles), which may synchronize with the
+  // host and would thus fail to be captured.
+  if (captured->failed || captured->num_steps++ == 0) return OkStatus();
+
+  Device* device = executors_and_keys->items[0].device;
+  Allocator* device_allocator = device->GetAllocator(AllocatorAttributes());
+  if (captured->capture == nullptr) {
+    Status s = CaptureCallable(step_id, feed_tensors, executors_and_keys,
+                               run_metadata, threadpool_options, captured);
+    if (!s.ok()) {
+      VLOG(1) << "Running the steps with feed signature " << signature
+              << " without capturing them: " << s;
+      captured->failed = true;
+      captured->staging_feeds.clear();
+      captured->captured_fetches.clear();
+      captured->capture.reset();
+      if (captured->allocator != nullptr) {
+        captured->allocator->ReleaseAndUnRef();
+        captured->allocator = nullptr;
+      }
+      return OkStatus();
+    }
+    VLOG(1) << "Captured the steps with feed signature " << signature
+            << " using " << captured->allocator->reserved_bytes()
+            << " bytes of device memory";
+  }
+
+  // The captured work reads its inputs from, and writes its outputs to, the
+  // buffers of the captured step, so the values of this step are copied in
+  // and out around the replay.
+  for (size_t i = 0; i < feed_tensors.size(); ++i) {
+    TF_RETURN_IF_ERROR(captured->capture->EnqueueCopy(
+        feed_tensors[i], captured->staging_feeds[i]));
+  }
+  TF_RETURN_IF_ERROR(captured->capture->Replay());
+  fetch_tensors->resize(captured->captured_fetches.size());
+  for (size_t i = 0; i < captured->captured_fetches.size(); ++i) {
+    const Tensor& result = captured->captured_fetches[i];
+    Tensor fetch(device_allocator, result.dtype(), result.shape());
+    TF_RETURN_IF_ERROR(captured->capture->EnqueueCopy(result, fetch));
+    (*fetch_tensors)[i] = std::move(fetch);
+  }
+  if (sync_on_finish_) {
+    TF_RETURN_IF_ERROR(device->Sync());
+  }
+  executors_and_keys->step_count.fetch_add(1);
+  *replayed = true;
+  return OkStatus();
+}
+
 ::tensorflow::Status DirectSession::ReleaseCallable(CallableHandle handle) {
   mutex_lock l(callables_lock_);
   if (handle >= next_callable_handle_) {
@@ -25,13 +25,16 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/debugger_state_interface.h"
+#include "tensorflow/core/common_runtime/device_graph_capture.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/device_set.h"
 #include "tensorflow/core/common_runtime/executor.h"
+#include "tensorflow/core/common_runtime/graph_compile_cache.h"
 #include "tensorflow/core/common_runtime/graph_execution_state.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/session_factory.h"
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -148,6 +151,51 @@ class DirectSession : public Session {
     Device* device = nullptr;                // not owned.
     FunctionLibraryRuntime* flib = nullptr;  // not owned.
     std::unique_ptr<Executor> executor;
+    // Set iff `ConfigProto.Experimental.use_static_memory_plan` is true and
+    // `device` is a CPU device.
+    std::unique_ptr<StaticMemoryPlan> memory_plan;
+    // The nodes that produce the fetched values of this partition, sorted by
+    // `node_id`. Set iff `CallableOptions.reuse_fetch_buffers` is true and
+    // `device` is a CPU device.
+    struct RetvalProducer {
+      int node_id;
+      int output_slot;
+      int retval_index;
+    };
+    std::vector<RetvalProducer> retval_producers;
+    // True iff `ConfigProto.Experimental.capture_device_graphs` is true, a
+    // DeviceGraphCapture is registered for `device`, and the partition has no
+    // stateful ops and no inputs or outputs in host memory.
+    bool capturable = false;
+  };
+
+  // The captured device work of a callable for one signature of feed dtypes
+  // and shapes.
+  struct CapturedStep {
+    ~CapturedStep();
+
+    mutex mu;
+    // Number of steps that have been run with this signature.
+    int64_t num_steps TF_GUARDED_BY(mu) = 0;
+    // True if the work could not be captured, in which case the steps with
+    // this signature are run normally.
+    bool failed TF_GUARDED_BY(mu) = false;
+    std::unique_ptr<DeviceGraphCapture> capture TF_GUARDED_BY(mu);
+    // Serves all allocations of the captured step. Deletes itself.
+    DeviceGraphCaptureAllocator* allocator TF_GUARDED_BY(mu) = nullptr;
+    // The feed buffers read by the captured work, and the fetched values
+    // written by it.
+    std::vector<Tensor> staging_feeds TF_GUARDED_BY(mu);
+    std::vector<Tensor> captured_fetches TF_GUARDED_BY(mu);
+  };
+
+  struct CaptureCache {
+    // The maximum number of signatures captured per callable.
+    static constexpr int kMaxSignatures = 8;
+
+    mutex mu;
+    std::unordered_map<string, std::unique_ptr<CapturedStep>> steps
+        TF_GUARDED_BY(mu);
   };
 
   // An ExecutorsAndKeys is created for a given set of feeds/fetches.
@@ -176,6 +224,14 @@ class DirectSession : public Session {
     CallableOptions callable_options;
 
     int64_t collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
+
+    // Set iff this is a callable whose graph has a single, capturable
+    // partition.
+    std::unique_ptr<CaptureCache> capture_cache;
+
+    // True if the graph is to be replaced by the one being optimized in the
+    // background (see RewriterConfig.background_optimization).
+    bool awaiting_background_optimization = false;
   };
 
   // A FunctionInfo object is created for every unique set of feeds/fetches.
@@ -236,6 +292,8 @@ class DirectSession : public Session {
     std::unique_ptr<Graph> graph;
     const DebugOptions& debug_options;
     int64_t collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
+    // Set by CreateGraphs() if the graphs await a background optimization.
+    bool awaiting_background_optimization = false;
   };
 
   // Retrieves an already existing set of executors to run 'inputs' and
@@ -245,6 +303,13 @@ class DirectSession : public Session {
       gtl::ArraySlice<string> target_nodes,
       ExecutorsAndKeys** executors_and_keys, RunStateArgs* run_state_args);
 
+  // Returns true if `executors_and_keys` was created from a graph whose
+  // background optimization is now done, after removing it from executors_ so
+  // that the executors are recreated from the fully optimized graph.
+  bool EvictIfBackgroundOptimized(
+      const std::shared_ptr<ExecutorsAndKeys>& executors_and_keys)
+      TF_LOCKS_EXCLUDED(executor_lock_, graph_state_lock_);
+
   // Creates a set of executors to run the subgraph defined by
   // `callable_options`.
   ::tensorflow::Status CreateExecutors(
@@ -263,11 +328,45 @@ class DirectSession : public Session {
       RunStateArgs* run_state_args, DataTypeVector* input_types,
       DataTypeVector* output_types, int64_t* collective_graph_key);
 
+  // Creates the graphs of CreateGraphs() from an entry of the graph compile
+  // cache.
+  ::tensorflow::Status CreateGraphsFromCacheEntry(
+      const GraphCompileCacheEntry& entry,
+      std::unordered_map<string, std::unique_ptr<Graph>>* outputs,
+      std::unique_ptr<FunctionLibraryDefinition>* flib_def,
+      DataTypeVector* input_types, DataTypeVector* output_types,
+      int64_t* collective_graph_key)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(graph_state_lock_);
+
+  // Gives the device of each partition an opportunity to rewrite its graph.
+  ::tensorflow::Status MaybeRewritePartitionGraphs(
+      std::unordered_map<string, std::unique_ptr<Graph>>* graphs);
+
   ::tensorflow::Status RunInternal(
       int64_t step_id, const RunOptions& run_options,
       CallFrameInterface* call_frame, ExecutorsAndKeys* executors_and_keys,
       RunMetadata* run_metadata,
-      const thread::ThreadPoolOptions& threadpool_options);
+      const thread::ThreadPoolOptions& threadpool_options,
+      const std::vector<Tensor>* fetch_buffers = nullptr,
+      DeviceGraphCaptureAllocator* capture_allocator = nullptr);
+
+  // Runs a step of a callable with a `capture_cache` by replaying its captured
+  // device work, capturing it first if this is the second step with the
+  // signature of `feed_tensors`. Sets `*replayed` to false, without running
+  // the step, if the step must be run normally instead.
+  ::tensorflow::Status RunCapturedCallable(
+      int64_t step_id, const std::vector<Tensor>& feed_tensors,
+      std::vector<Tensor>* fetch_tensors, ExecutorsAndKeys* executors_and_keys,
+      RunMetadata* run_metadata,
+      const thread::ThreadPoolOptions& threadpool_options, bool* replayed);
+
+  // Captures the device work of a step of `executors_and_keys` into
+  // `captured`, whose buffers are left to be released by the caller on error.
+  ::tensorflow::Status CaptureCallable(
+      int64_t step_id, const std::vector<Tensor>& feed_tensors,
+      ExecutorsAndKeys* executors_and_keys, RunMetadata* run_metadata,
+      const thread::ThreadPoolOptions& threadpool_options,
+      CapturedStep* captured) TF_EXCLUSIVE_LOCKS_REQUIRED(captured->mu);
 
   // Returns whether inter-op execution uses a global pool or the input
   // `run_options` requests being run on inter_op_thread_pool = 0 in case
@@ -366,6 +465,10 @@ class DirectSession : public Session {
   // same ExecutorsAndKey object.
   std::unordered_map<string, std::shared_ptr<ExecutorsAndKeys>> executors_
       TF_GUARDED_BY(executor_lock_);
+  // The executors replaced in executors_ after a background optimization,
+  // which may still be used by the steps that started before.
+  std::vector<std::shared_ptr<ExecutorsAndKeys>> retired_executors_
+      TF_GUARDED_BY(executor_lock_);
 
   class RunCallableCallFrame;
   struct Callable {
@@ -405,6 +508,9 @@ class DirectSession : public Session {
   // library; it copies and modifies the function library.
   std::unique_ptr<FunctionLibraryDefinition> flib_def_;
 
+  // Set iff `ConfigProto.Experimental.graph_compile_cache_dir` is not empty.
+  std::unique_ptr<GraphCompileCache> graph_compile_cache_;
+
   // true if the Session has been Closed.
   mutex closed_lock_;
   bool closed_ TF_GUARDED_BY(closed_lock_) = false;
@@ -26,8 +26,10 @@ limitations under the License.
 #include "absl/memory/memory.h"
 #include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_graph_capture.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/function_testlib.h"
+#include "tensorflow/core/common_runtime/kernel_cost_estimates.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -44,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/test.h"
@@ -267,6 +270,37 @@ TEST_F(DirectSessionMinusAXTest,
       absl::StrContains(s.error_message(), "disable_output_partition_graphs"));
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithCostAttribution) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<std::pair<string, Tensor>> inputs;
+  std::vector<string> output_names = {y_ + ":0"};
+  std::vector<string> target_nodes = {y_neg_};
+  std::vector<Tensor> outputs;
+
+  for (const RunOptions::TraceLevel trace_level :
+       {RunOptions::NO_TRACE, RunOptions::SOFTWARE_TRACE}) {
+    RunOptions run_options;
+    run_options.set_trace_level(trace_level);
+    run_options.mutable_experimental()->set_collect_cost_attribution(true);
+    RunMetadata run_metadata;
+    TF_ASSERT_OK(session->Run(run_options, inputs, output_names, target_nodes,
+                              &outputs, &run_metadata));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+
+    const CostAttribution& attribution = run_metadata.cost_attribution();
+    EXPECT_EQ(1, attribution.op_time_nanos().count("MatMul"));
+    EXPECT_EQ(1, attribution.op_time_nanos().count("Neg"));
+    ASSERT_EQ(1, attribution.device_time_nanos().size());
+    EXPECT_EQ(0, attribution.rendezvous_wait_nanos());
+    EXPECT_GT(attribution.allocated_bytes(), 0);
+    EXPECT_GT(attribution.peak_memory_bytes(), 0);
+  }
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_FinalizeWithCallables) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
@@ -741,6 +775,242 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithOpts) {
   EXPECT_EQ(run_metadata.step_stats().dev_stats_size(), 2);
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithStepArena) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_experimental()->set_use_step_arena_allocator(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  RunOptions run_options;
+  run_options.set_trace_level(RunOptions::SOFTWARE_TRACE);
+  std::vector<Tensor> first_outputs;
+  for (int i = 0; i < 2; ++i) {
+    RunMetadata run_metadata;
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run(run_options, {}, {y_ + ":0"}, {y_neg_},
+                              &outputs, &run_metadata));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+    if (i == 0) first_outputs = outputs;
+
+    // Each CPU partition reports its arena statistics.
+    int num_arena_stats = 0;
+    for (const auto& dev_stats : run_metadata.step_stats().dev_stats()) {
+      for (const auto& node_stats : dev_stats.node_stats()) {
+        if (node_stats.node_name() == "_StepArena") ++num_arena_stats;
+      }
+    }
+    EXPECT_EQ(num_arena_stats, 2);
+  }
+
+  // Fetched tensors remain valid after their step's arena is released.
+  EXPECT_FLOAT_EQ(5.0, first_outputs[0].matrix<float>()(0, 0));
+}
+
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithStaticMemoryPlan) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_experimental()->set_use_static_memory_plan(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // The first step records the plan and later steps replay it.
+  std::vector<std::vector<Tensor>> all_outputs;
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {y_neg_}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+    all_outputs.push_back(outputs);
+  }
+  for (const auto& outputs : all_outputs) {
+    EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+  }
+}
+
+// Counts the captures and replays of the steps run on CPU devices. The
+// work of a step runs when it is captured, so replaying it does nothing.
+int num_cpu_graph_captures = 0;
+int num_cpu_graph_replays = 0;
+
+class FakeCPUGraphCapture : public DeviceGraphCapture {
+ public:
+  Status Capture(const std::function<Status()>& fn) override {
+    ++num_cpu_graph_captures;
+    return fn();
+  }
+  Status EnqueueCopy(const Tensor& src, const Tensor& dst) override {
+    if (src.TotalBytes() != dst.TotalBytes()) {
+      return errors::InvalidArgument("Mismatched copy");
+    }
+    if (src.TotalBytes() > 0) {
+      memcpy(const_cast<char*>(dst.tensor_data().data()),
+             src.tensor_data().data(), src.TotalBytes());
+    }
+    return OkStatus();
+  }
+  Status Replay() override {
+    ++num_cpu_graph_replays;
+    return OkStatus();
+  }
+};
+
+DeviceGraphCapture::Registration register_fake_cpu_graph_capture(
+    DEVICE_CPU, [](Device*) { return std::make_unique<FakeCPUGraphCapture>(); });
+
+TEST(DirectSessionTest, CaptureDeviceGraphs) {
+  Graph g(OpRegistry::Global());
+  Node* x;
+  TF_ASSERT_OK(NodeBuilder(g.NewName("x"), "Placeholder")
+                   .Attr("dtype", DT_FLOAT)
+                   .Device("/cpu:0")
+                   .Finalize(&g, &x));
+  Node* y;
+  TF_ASSERT_OK(NodeBuilder(g.NewName("y"), "Neg")
+                   .Input(x)
+                   .Attr("T", DT_FLOAT)
+                   .Device("/cpu:0")
+                   .Finalize(&g, &y));
+  GraphDef def;
+  g.ToGraphDef(&def);
+
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_experimental()->set_capture_device_graphs(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(
+      MakeCallableOptions({x->name() + ":0"}, {y->name() + ":0"}, {}),
+      &handle));
+
+  num_cpu_graph_captures = 0;
+  num_cpu_graph_replays = 0;
+  auto run = [&](const Tensor& feed) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->RunCallable(handle, {feed}, &outputs, nullptr));
+    ASSERT_EQ(1, outputs.size());
+    Tensor expected(DT_FLOAT, feed.shape());
+    for (int i = 0; i < feed.NumElements(); ++i) {
+      expected.flat<float>()(i) = -feed.flat<float>()(i);
+    }
+    test::ExpectTensorEqual<float>(expected, outputs[0]);
+  };
+
+  // The first step warms up, the second one is captured and replayed, and
+  // later steps are replayed.
+  Tensor x2 = test::AsTensor<float>({1, 2}, {2});
+  run(x2);
+  EXPECT_EQ(num_cpu_graph_captures, 0);
+  EXPECT_EQ(num_cpu_graph_replays, 0);
+  run(x2);
+  EXPECT_EQ(num_cpu_graph_captures, 1);
+  EXPECT_EQ(num_cpu_graph_replays, 1);
+  run(x2);
+  EXPECT_EQ(num_cpu_graph_captures, 1);
+  EXPECT_EQ(num_cpu_graph_replays, 2);
+
+  // A new feed shape warms up and is captured again.
+  Tensor x3 = test::AsTensor<float>({1, 2, 3}, {3});
+  run(x3);
+  EXPECT_EQ(num_cpu_graph_captures, 1);
+  run(x3);
+  EXPECT_EQ(num_cpu_graph_captures, 2);
+  EXPECT_EQ(num_cpu_graph_replays, 3);
+
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithMeasuredKernelCosts) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_experimental()->set_use_measured_kernel_costs(true);
+  const size_t num_estimates_before = KernelCostEstimates::Global()->size();
+  for (int i = 0; i < 2; ++i) {
+    std::unique_ptr<Session> session(NewSession(options));
+    ASSERT_TRUE(session != nullptr);
+    TF_ASSERT_OK(session->Create(def_));
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {y_neg_}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+    TF_ASSERT_OK(session->Close());
+  }
+  // The first session stores its estimates, which the second one reuses.
+  EXPECT_GT(KernelCostEstimates::Global()->size(), num_estimates_before);
+}
+
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithGraphCompileCache) {
+  Initialize({3, 2, -1, 0});
+  const string cache_dir =
+      io::JoinPath(testing::TmpDir(), "direct_session_graph_compile_cache");
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_experimental()->set_graph_compile_cache_dir(
+      cache_dir);
+  // The second session, like a restarted process, loads the graphs built by
+  // the first one.
+  for (int i = 0; i < 2; ++i) {
+    std::unique_ptr<Session> session(NewSession(options));
+    ASSERT_TRUE(session != nullptr);
+    TF_ASSERT_OK(session->Create(def_));
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {y_neg_}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+    TF_ASSERT_OK(session->Close());
+
+    std::vector<string> entries;
+    TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir, &entries));
+    EXPECT_EQ(1, entries.size());
+  }
+}
+
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithReusedFetchBuffers) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options = DefaultSessionOptions();
+  // Turn off constant folding so that `y_` is computed by its MatMul kernel.
+  options.config.mutable_graph_options()
+      ->mutable_optimizer_options()
+      ->set_opt_level(OptimizerOptions::L0);
+  options.config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_constant_folding(RewriterConfig::OFF);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  CallableOptions callable_options =
+      MakeCallableOptions({}, {y_ + ":0"}, {y_neg_});
+  callable_options.set_reuse_fetch_buffers(true);
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+  const void* buffer = outputs[0].data();
+
+  // The caller owns the only reference, so the buffer is reused.
+  outputs[0].matrix<float>()(0, 0) = 0.0;
+  TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+  EXPECT_EQ(buffer, outputs[0].data());
+
+  // A shared buffer is not overwritten.
+  Tensor copy = outputs[0];
+  TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+  EXPECT_NE(copy.data(), outputs[0].data());
+  EXPECT_FLOAT_EQ(5.0, copy.matrix<float>()(0, 0));
+
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithOpts_Callable) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
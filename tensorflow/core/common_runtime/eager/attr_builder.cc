@@ -255,6 +255,7 @@ const NodeDef& AttrBuilder::BuildNodeDef() {
 void AttrBuilder::CopyAttributes(const AttrBuilder& other) {
   encoded_attrs_.insert(other.encoded_attrs_.begin(),
                         other.encoded_attrs_.end());
+  InvalidateCacheKey();
 }
 
 Status AttrTypeByName(const AttrTypeMap& m, const string& attr_name,
@@ -291,6 +292,17 @@ inline tensorflow::Fprint128 CacheKeyHelper(StringPiece s, uint64 b) {
   return CacheKeyHelper(s, {b, b});
 }
 
+// Comparing the encoded attributes is much cheaper than fingerprinting them.
+bool SameEncodedAttrs(const gtl::FlatMap<string, string>& a,
+                      const gtl::FlatMap<string, string>& b) {
+  if (a.size() != b.size()) return false;
+  for (const auto& p : a) {
+    auto it = b.find(p.first);
+    if (it == b.end() || it->second != p.second) return false;
+  }
+  return true;
+}
+
 }  // namespace
 
 tensorflow::Fprint128 AttrBuilder::CacheKey(const StringPiece device) {
@@ -303,14 +315,31 @@ tensorflow::Fprint128 AttrBuilder::CacheKey(const StringPiece device) {
 }
 
 tensorflow::Fprint128 AttrBuilder::BuildCacheKeyForDevice(
-    const StringPiece device) const {
-  tensorflow::Fprint128 f = tensorflow::Fingerprint128(op_name());
-  f = tsl::FingerprintCat128(f, tensorflow::Fingerprint128(device));
+    const StringPiece device) {
+  if (!attrs_fingerprint_.has_value()) {
+    if (previous_attrs_fingerprint_.has_value() &&
+        SameEncodedAttrs(encoded_attrs_, previous_encoded_attrs_)) {
+      attrs_fingerprint_ = previous_attrs_fingerprint_;
+    } else {
+      attrs_fingerprint_ = BuildAttrsFingerprint();
+    }
+  }
+  tensorflow::Fprint128 f = tsl::FingerprintCat128(
+      attrs_fingerprint_->op_name, tensorflow::Fingerprint128(device));
+  CombineUnordered(attrs_fingerprint_->attrs, &f);
+  return f;
+}
+
+AttrBuilder::AttrsFingerprint AttrBuilder::BuildAttrsFingerprint() const {
+  AttrsFingerprint fingerprint;
+  fingerprint.op_name = tensorflow::Fingerprint128(op_name());
+  fingerprint.attrs = {0, 0};
   for (const auto& p : encoded_attrs_) {
     CombineUnordered(
-        CacheKeyHelper(p.first, tensorflow::Fingerprint128(p.second)), &f);
+        CacheKeyHelper(p.first, tensorflow::Fingerprint128(p.second)),
+        &fingerprint.attrs);
   }
-  return f;
+  return fingerprint;
 }
 
 void AttrBuilder::GetNameAttrList(
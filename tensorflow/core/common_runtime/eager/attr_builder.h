@@ -103,12 +103,21 @@ class AttrBuilder : public AbstractOpAttrs {
   }
 
   void Reset(const char* op) {
+    // Operations are commonly reset to the same op and given the same
+    // attributes for every execution. Keep the attributes and their
+    // fingerprint so that CacheKey can skip fingerprinting them again.
+    if (attrs_fingerprint_.has_value() && op_name_ == op) {
+      previous_encoded_attrs_.swap(encoded_attrs_);
+      previous_attrs_fingerprint_ = attrs_fingerprint_;
+    } else {
+      previous_encoded_attrs_.clear();
+      previous_attrs_fingerprint_ = absl::nullopt;
+    }
     op_name_ = op;
     num_inputs_ = 0;
     encoded_attrs_.clear();
     node_def_finalized_ = false;
-    cached_cache_key_ = absl::nullopt;
-    device_for_cached_cache_key_.clear();
+    InvalidateCacheKey();
   }
 
   const string& op_name() const { return op_name_; }
@@ -121,7 +130,7 @@ class AttrBuilder : public AbstractOpAttrs {
     SetAttrValue(value, &attr_tmp_);
     AddAttrIfNotPresent(attr_name, attr_tmp_);
     node_def_finalized_ = false;
-    cached_cache_key_ = absl::nullopt;
+    InvalidateCacheKey();
     return *this;
   }
 
@@ -129,7 +138,7 @@ class AttrBuilder : public AbstractOpAttrs {
 
   AttrBuilder& Set(StringPiece attr_name, const AttrValue& value) {
     AddAttrIfNotPresent(attr_name, value);
-    cached_cache_key_ = absl::nullopt;
+    InvalidateCacheKey();
     return *this;
   }
 
@@ -182,7 +191,21 @@ class AttrBuilder : public AbstractOpAttrs {
       absl::InlinedVector<DataType, 4>* type_list) const override;
 
  private:
-  tensorflow::Fprint128 BuildCacheKeyForDevice(const StringPiece device) const;
+  // The fingerprint of the op name, and the sum of the fingerprints of the
+  // attributes. Neither depends on the device.
+  struct AttrsFingerprint {
+    tensorflow::Fprint128 op_name;
+    tensorflow::Fprint128 attrs;
+  };
+
+  tensorflow::Fprint128 BuildCacheKeyForDevice(const StringPiece device);
+  AttrsFingerprint BuildAttrsFingerprint() const;
+
+  void InvalidateCacheKey() {
+    cached_cache_key_ = absl::nullopt;
+    device_for_cached_cache_key_.clear();
+    attrs_fingerprint_ = absl::nullopt;
+  }
 
   template <class T>
   void SetInAttrValueMap(AttrValueMap* m, const string& attr_name,
@@ -206,6 +229,12 @@ class AttrBuilder : public AbstractOpAttrs {
 
   absl::optional<tensorflow::Fprint128> cached_cache_key_;
   string device_for_cached_cache_key_;
+
+  absl::optional<AttrsFingerprint> attrs_fingerprint_;
+  // The attributes before the last Reset to the same op, and their
+  // fingerprint.
+  gtl::FlatMap<string, string> previous_encoded_attrs_;
+  absl::optional<AttrsFingerprint> previous_attrs_fingerprint_;
 };
 
 template <>
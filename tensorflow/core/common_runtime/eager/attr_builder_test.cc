@@ -85,6 +85,53 @@ TEST(AttrTypeMap, CacheKey) {
   ASSERT_FALSE(cache_key == a.CacheKey("cpu:0"));
 }
 
+TEST(AttrTypeMap, CacheKeyAfterReset) {
+  AttrBuilder a("op_name");
+  a.Set("T", TF_FLOAT);
+  a.Set("x", 1.0);
+  tensorflow::Fprint128 cache_key = a.CacheKey("cpu:0");
+  tensorflow::Fprint128 other_device_key = a.CacheKey("cpu:1");
+
+  // Resetting to the same op with the same attributes, set in a different
+  // order, reuses the attribute fingerprint and gives the same keys.
+  a.Reset("op_name");
+  a.Set("x", 1.0);
+  a.Set("T", TF_FLOAT);
+  ASSERT_TRUE(cache_key == a.CacheKey("cpu:0"));
+  ASSERT_TRUE(other_device_key == a.CacheKey("cpu:1"));
+
+  // The keys must match those of a freshly built AttrBuilder.
+  AttrBuilder b("op_name");
+  b.Set("T", TF_FLOAT);
+  b.Set("x", 1.0);
+  ASSERT_TRUE(cache_key == b.CacheKey("cpu:0"));
+
+  a.Reset("op_name");
+  a.Set("T", TF_FLOAT);
+  a.Set("x", 2.0);
+  ASSERT_FALSE(cache_key == a.CacheKey("cpu:0"));
+
+  a.Reset("op_name");
+  a.Set("T", TF_FLOAT);
+  ASSERT_FALSE(cache_key == a.CacheKey("cpu:0"));
+
+  a.Reset("other_op_name");
+  a.Set("T", TF_FLOAT);
+  a.Set("x", 1.0);
+  ASSERT_FALSE(cache_key == a.CacheKey("cpu:0"));
+}
+
+TEST(AttrTypeMap, CacheKeyAfterCopyAttributes) {
+  AttrBuilder a("op_name");
+  a.Set("T", TF_FLOAT);
+  tensorflow::Fprint128 cache_key = a.CacheKey("cpu:0");
+
+  AttrBuilder b("op_name");
+  b.Set("x", 1.0);
+  a.CopyAttributes(b);
+  ASSERT_FALSE(cache_key == a.CacheKey("cpu:0"));
+}
+
 string ToString(const AttrValueMap& m) {
   std::vector<string> strs;
   for (const auto& e : m) {
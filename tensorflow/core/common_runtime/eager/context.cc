@@ -490,6 +490,7 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
     mutex_lock ml(cache_mu_);
     default_executor_.WaitForAllPendingNodes().IgnoreError();
     kernel_cache_.clear();
+    ++kernel_cache_generation_;
     for (auto& entry : registered_functions_) {
       entry.second->cached_kernel_keys->clear();
     }
@@ -1082,6 +1083,7 @@ Status EagerContext::RemoveFunction(const string& func) {
       for (auto& key : *registered_function->cached_kernel_keys) {
         kernel_cache_.erase(key);
       }
+      ++kernel_cache_generation_;
       registered_functions_.erase(func);
     }
     registered_function->Unref();
@@ -1173,6 +1175,28 @@ core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedKernel(
   return new_ref;
 }
 
+core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedKernel(
+    Fprint128 cache_key, KernelCacheHint* hint) {
+  tf_shared_lock l(cache_mu_);
+  KernelAndDevice* kernel = nullptr;
+  if (hint->kernel != nullptr && hint->cache_key == cache_key &&
+      hint->generation == kernel_cache_generation_) {
+    kernel = hint->kernel;
+  } else {
+    auto iter = kernel_cache_.find(cache_key);
+    if (iter == kernel_cache_.end()) {
+      return nullptr;
+    }
+    kernel = iter->second.get();
+    hint->cache_key = cache_key;
+    hint->kernel = kernel;
+    hint->generation = kernel_cache_generation_;
+  }
+  core::RefCountPtr<KernelAndDevice> new_ref(kernel);
+  new_ref->Ref();
+  return new_ref;
+}
+
 Device* EagerContext::GetCachedDevice(Fprint128 device_cache_key) {
   tf_shared_lock l(device_cache_mu_);
   auto iter = device_cache_.find(device_cache_key);
@@ -1185,7 +1209,9 @@ void EagerContext::AddKernelToCache(Fprint128 cache_key,
   mutex_lock ml(cache_mu_);
   core::RefCountPtr<KernelAndDevice> new_ref(kernel);
   new_ref->Ref();
-  kernel_cache_[cache_key] = std::move(new_ref);
+  auto& entry = kernel_cache_[cache_key];
+  if (entry != nullptr) ++kernel_cache_generation_;
+  entry = std::move(new_ref);
   auto* registered_function =
       gtl::FindPtrOrNull(registered_functions_, kernel->name());
 
@@ -262,6 +262,20 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   core::RefCountPtr<KernelAndDevice> GetCachedKernel(Fprint128 cache_key);
   Device* GetCachedDevice(Fprint128 device_cache_key);
 
+  // The last kernel found in the kernel cache by an operation. It is only
+  // valid as long as no kernel has been removed from the cache since.
+  struct KernelCacheHint {
+    Fprint128 cache_key = {0, 0};
+    KernelAndDevice* kernel = nullptr;
+    int64_t generation = -1;
+  };
+
+  // Like GetCachedKernel, but returns the kernel in `hint` without looking up
+  // the cache if it is still valid and was cached with `cache_key`. Updates
+  // `hint` otherwise.
+  core::RefCountPtr<KernelAndDevice> GetCachedKernel(Fprint128 cache_key,
+                                                     KernelCacheHint* hint);
+
   void AddKernelToCache(Fprint128 cache_key, KernelAndDevice* kernel);
   void AddDeviceToCache(Fprint128 device_cache_key, Device* device);
 
@@ -756,6 +770,9 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   std::unordered_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
                      Fprint128Hasher>
       kernel_cache_ TF_GUARDED_BY(cache_mu_);
+  // Incremented whenever a kernel is removed from kernel_cache_, which
+  // invalidates all KernelCacheHints.
+  int64_t kernel_cache_generation_ TF_GUARDED_BY(cache_mu_) = 0;
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       TF_GUARDED_BY(cache_mu_);
   absl::flat_hash_map<Fprint128, Device*, Fprint128Hasher> device_cache_
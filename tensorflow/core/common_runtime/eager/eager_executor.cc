@@ -29,12 +29,32 @@ bool IsAsyncWaitForRemoteFunctionEnabled() {
                                  true, &enabled));
   return enabled;
 }
+
+mutex node_fuser_factory_mu(LINKER_INITIALIZED);
+
+EagerExecutor::NodeFuserFactory& GlobalNodeFuserFactory()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(node_fuser_factory_mu) {
+  static auto* factory = new EagerExecutor::NodeFuserFactory;
+  return *factory;
+}
+
+std::unique_ptr<EagerNodeFuser> CreateNodeFuser() {
+  mutex_lock l(node_fuser_factory_mu);
+  const EagerExecutor::NodeFuserFactory& factory = GlobalNodeFuserFactory();
+  return factory ? factory() : nullptr;
+}
 }  // namespace
 
+void EagerExecutor::SetNodeFuserFactory(NodeFuserFactory factory) {
+  mutex_lock l(node_fuser_factory_mu);
+  GlobalNodeFuserFactory() = std::move(factory);
+}
+
 EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
                              int in_flight_nodes_limit)
     : next_node_id_(0),
       ok_(true),
+      node_fuser_(async ? CreateNodeFuser() : nullptr),
       thread_(async ? tensorflow::Env::Default()->StartThread(
                           tensorflow::ThreadOptions(), "eager_async_executor",
                           std::bind(&EagerExecutor::Run, this))
@@ -157,7 +177,7 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
     } else {
       status = status_;
       if (status.ok()) {
-        node_queue_.push(std::move(item));
+        node_queue_.push_back(std::move(item));
         // If there were no previous nodes pending, wake the run thread to
         // start processing requests again.
         if (node_queue_.size() == 1) {
@@ -253,7 +273,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
     if (from_queue) {
       // Since this was from the async queue, pop it from the front of the queue
       DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-      node_queue_.pop();
+      node_queue_.pop_front();
     } else if (async) {
       // If it is an Async node then we will find the node in the unfinished
       // nodes list. However we only notify if we are at the front of the list
@@ -287,7 +307,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
       }
       while (!node_queue_.empty()) {
         items_to_destroy.push_front(std::move(node_queue_.front()));
-        node_queue_.pop();
+        node_queue_.pop_front();
       }
       for (auto& it : unfinished_nodes_) {
         items_to_destroy.push_front(std::move(it.second));
@@ -344,6 +364,7 @@ void EagerExecutor::NotifyWaiters(uint64 id) {
 void EagerExecutor::Run() {
   auto thread_exited_notifier =
       gtl::MakeCleanup([this] { thread_exited_notification_.Notify(); });
+  std::vector<core::RefCountPtr<NodeItem>> fusion_items;
   while (true) {
     core::RefCountPtr<NodeItem> curr_item;
     {
@@ -361,7 +382,26 @@ void EagerExecutor::Run() {
       // and register a notification for its completion.
       curr_item.reset(node_queue_.front().get());
       curr_item->Ref();
+      // Only nodes that are queued already are considered for fusion, there
+      // is no waiting for more nodes to arrive.
+      if (node_fuser_ != nullptr && node_queue_.size() > 1) {
+        const size_t window_size = node_fuser_->window_size();
+        for (const auto& item : node_queue_) {
+          if (fusion_items.size() >= window_size ||
+              item->node->AsAsync() != nullptr) {
+            break;
+          }
+          fusion_items.emplace_back(item.get());
+          item->Ref();
+        }
+      }
+    }
+    if (fusion_items.size() > 1) {
+      const int num_fused = MaybeRunFusedItems(fusion_items);
+      fusion_items.clear();
+      if (num_fused > 0) continue;
     }
+    fusion_items.clear();
     Status status = RunItem(std::move(curr_item), /*from_queue=*/true);
     if (!status.ok()) {
       VLOG(1) << "Failed to run item: " << status;
@@ -422,6 +462,32 @@ Status EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item,
   return status();
 }
 
+int EagerExecutor::MaybeRunFusedItems(
+    absl::Span<const core::RefCountPtr<NodeItem>> items) {
+  std::vector<EagerNode*> nodes;
+  nodes.reserve(items.size());
+  for (const auto& item : items) {
+    nodes.push_back(item->node.get());
+  }
+  int num_fused = 0;
+  std::unique_ptr<EagerNode> fused_node = node_fuser_->Fuse(nodes, &num_fused);
+  if (fused_node == nullptr) return 0;
+  DCHECK(num_fused >= 2 && num_fused <= static_cast<int>(items.size()));
+  DVLOG(3) << "Running Nodes: [id " << items[0]->id << " to "
+           << items[num_fused - 1]->id << "] as "
+           << fused_node->DebugString();
+  Status status = fused_node->Run();
+  if (!status.ok()) {
+    VLOG(1) << "Failed to run fused items: " << status;
+  }
+  // If the fused node failed, the first NodeDone aborts the other nodes and
+  // the following calls are no-ops.
+  for (int i = 0; i < num_fused; ++i) {
+    NodeDone(items[i], status, /*from_queue=*/true);
+  }
+  return num_fused;
+}
+
 Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
                                        bool from_queue) {
   tensorflow::mutex_lock l(node_queue_mutex_);
@@ -431,7 +497,7 @@ Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
 
   if (from_queue) {
     DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-    node_queue_.pop();
+    node_queue_.pop_front();
   }
 
   DVLOG(3) << "Add Node: [id " << item->id << "] to unfinished map.";
@@ -17,12 +17,15 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstddef>
+#include <deque>
+#include <functional>
 #include <map>
 #include <memory>
-#include <queue>
 #include <string>
 #include <vector>
 
+#include "absl/types/span.h"
+
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
@@ -39,6 +42,7 @@ limitations under the License.
 namespace tensorflow {
 
 class AsyncEagerNode;
+class AsyncExecuteNode;
 class AsyncRemoteExecuteNode;
 namespace eager {
 class EagerClient;
@@ -70,6 +74,7 @@ class EagerNode {
   // Returns nullptr iff this Eager node is synchronous.
   virtual AsyncEagerNode* AsAsync() { return nullptr; }
   virtual AsyncRemoteExecuteNode* AsAsyncRemoteExecuteNode() { return nullptr; }
+  virtual AsyncExecuteNode* AsAsyncExecuteNode() { return nullptr; }
 
   virtual string DebugString() const = 0;
 
@@ -109,8 +114,28 @@ class AsyncRemoteExecuteNode : public AsyncEagerNode {
 // TODO(agarwal): Support out-of-order execution and dispatching multiple
 // EagerNode in parallel.
 // TODO(agarwal): Implement optimizations over EagerNode traces.
+// Fuses consecutive synchronous nodes queued on an async EagerExecutor, so
+// that they run as a single node.
+class EagerNodeFuser {
+ public:
+  virtual ~EagerNodeFuser() {}
+
+  // The maximum number of nodes passed to Fuse.
+  virtual int window_size() const = 0;
+
+  // Returns a node that runs the first `*num_fused` (at least two) of `nodes`,
+  // which are in queue order, or nullptr if the first node must run on its
+  // own. If the returned node fails to run, it must Abort the first of the
+  // fused nodes, the executor aborts the others. The returned node does not
+  // own `nodes`.
+  virtual std::unique_ptr<EagerNode> Fuse(absl::Span<EagerNode* const> nodes,
+                                          int* num_fused) = 0;
+};
+
 class EagerExecutor {
  public:
+  using NodeFuserFactory = std::function<std::unique_ptr<EagerNodeFuser>()>;
+
   explicit EagerExecutor(bool async, bool enable_streaming_enqueue = true,
                          int in_flight_nodes_limit = 0);
 
@@ -163,6 +188,10 @@ class EagerExecutor {
   // callbacks are no longer safe to run.
   void RemoveCleanups(intptr_t key);
 
+  // Sets the factory of the EagerNodeFuser used by async executors created
+  // afterwards. An empty factory disables fusion of queued nodes.
+  static void SetNodeFuserFactory(NodeFuserFactory factory);
+
  private:
   // Possible states for this executor.
   // Executor starts in kActive state. When Shutdown() is called, Executor
@@ -207,6 +236,10 @@ class EagerExecutor {
   void Run();
 
   Status RunItem(core::RefCountPtr<NodeItem> item, bool from_queue);
+
+  // Runs a prefix of `items`, the nodes at the front of the queue, as one node
+  // created by `node_fuser_`. Returns the number of nodes that were run.
+  int MaybeRunFusedItems(absl::Span<const core::RefCountPtr<NodeItem>> items);
   Status MoveToUnfinished(core::RefCountPtr<NodeItem> item, bool from_queue);
 
   // The impl of WaitForAllPendingNodes
@@ -226,7 +259,7 @@ class EagerExecutor {
   condition_variable nodes_done_ TF_GUARDED_BY(node_queue_mutex_);
 
   // Queue of pending NodeItems. Ordered by NodeItem::id.
-  std::queue<core::RefCountPtr<NodeItem>> node_queue_
+  std::deque<core::RefCountPtr<NodeItem>> node_queue_
       TF_GUARDED_BY(node_queue_mutex_);
 
   // Ordered by NodeItem::id.
@@ -254,6 +287,10 @@ class EagerExecutor {
   ExecutorState state_ TF_GUARDED_BY(node_queue_mutex_) =
       ExecutorState::kActive;
 
+  // Fuses queued nodes before they are run. Only set in async mode, and must
+  // be initialized before `thread_` starts.
+  const std::unique_ptr<EagerNodeFuser> node_fuser_;
+
   // Thread object that calls the `Run` method in async mode.This thread runs
   // until state_ is set to kShuttingDown. It is `nullptr` in sync mode.
   const std::unique_ptr<Thread> thread_;
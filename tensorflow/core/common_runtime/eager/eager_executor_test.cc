@@ -17,6 +17,7 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
@@ -281,5 +282,122 @@ TEST(EagerExecutorTest, TestAsyncExecutorAddNodesAfterShutdown) {
       async_executor->AddOrExecute(std::move(node)),
       tensorflow::testing::StatusIs(tensorflow::error::FAILED_PRECONDITION));
 }
+
+class BlockingEagerNode : public EagerNode {
+ public:
+  explicit BlockingEagerNode(Notification* unblock) : unblock_(unblock) {}
+
+  Status Run() override {
+    unblock_->WaitForNotification();
+    return OkStatus();
+  }
+
+  void Abort(Status status) override {}
+  string DebugString() const override { return "blockingEagerNode"; }
+
+ private:
+  Notification* unblock_;
+};
+
+// Fuses all leading TestEagerNodes into a node that runs them in order.
+class TestEagerNodeFuser : public EagerNodeFuser {
+ public:
+  explicit TestEagerNodeFuser(std::vector<int>* fused_sizes)
+      : fused_sizes_(fused_sizes) {}
+
+  int window_size() const override { return 8; }
+
+  std::unique_ptr<EagerNode> Fuse(absl::Span<EagerNode* const> nodes,
+                                  int* num_fused) override {
+    std::vector<EagerNode*> fused;
+    for (EagerNode* node : nodes) {
+      if (node->DebugString() != "testEagerNode") break;
+      fused.push_back(node);
+    }
+    if (fused.size() < 2) return nullptr;
+    *num_fused = fused.size();
+    fused_sizes_->push_back(fused.size());
+    return std::make_unique<FusedNode>(std::move(fused));
+  }
+
+ private:
+  class FusedNode : public EagerNode {
+   public:
+    explicit FusedNode(std::vector<EagerNode*> nodes)
+        : nodes_(std::move(nodes)) {}
+
+    Status Run() override {
+      for (EagerNode* node : nodes_) {
+        TF_RETURN_IF_ERROR(node->Run());
+      }
+      return OkStatus();
+    }
+
+    void Abort(Status status) override {}
+    string DebugString() const override { return "fusedEagerNode"; }
+
+   private:
+    std::vector<EagerNode*> nodes_;
+  };
+
+  std::vector<int>* fused_sizes_;
+};
+
+TEST(EagerExecutorTest, TestAsyncExecutorFusesQueuedNodes) {
+  std::vector<int> fused_sizes;
+  EagerExecutor::SetNodeFuserFactory([&fused_sizes]() {
+    return std::make_unique<TestEagerNodeFuser>(&fused_sizes);
+  });
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+  EagerExecutor::SetNodeFuserFactory(nullptr);
+
+  // Keep the executor busy until all test nodes are queued.
+  Notification unblock;
+  TF_ASSERT_OK(async_executor->AddOrExecute(
+      std::make_unique<BlockingEagerNode>(&unblock)));
+  std::vector<std::unique_ptr<TestState>> states;
+  for (int i = 0; i < 3; ++i) {
+    states.push_back(std::make_unique<TestState>());
+    TF_ASSERT_OK(async_executor->AddOrExecute(
+        std::make_unique<TestEagerNode>(states.back().get())));
+  }
+  unblock.Notify();
+
+  TF_ASSERT_OK(async_executor->WaitForAllPendingNodes());
+  EXPECT_EQ(fused_sizes, std::vector<int>({3}));
+  for (const auto& state : states) {
+    ASSERT_EQ(state->read_state(), TestState::State::kSuccess);
+  }
+  TF_ASSERT_OK(async_executor->ShutDown());
+}
+
+TEST(EagerExecutorTest, TestAsyncExecutorFusedNodeFailure) {
+  std::vector<int> fused_sizes;
+  EagerExecutor::SetNodeFuserFactory([&fused_sizes]() {
+    return std::make_unique<TestEagerNodeFuser>(&fused_sizes);
+  });
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+  EagerExecutor::SetNodeFuserFactory(nullptr);
+
+  Notification unblock;
+  TF_ASSERT_OK(async_executor->AddOrExecute(
+      std::make_unique<BlockingEagerNode>(&unblock)));
+  auto state = std::make_unique<TestState>();
+  auto failing_state = std::make_unique<TestState>();
+  TF_ASSERT_OK(async_executor->AddOrExecute(
+      std::make_unique<TestEagerNode>(state.get())));
+  TF_ASSERT_OK(async_executor->AddOrExecute(std::make_unique<TestEagerNode>(
+      failing_state.get(), OkStatus(), errors::Internal("test"))));
+  unblock.Notify();
+
+  auto status = async_executor->WaitForAllPendingNodes();
+  ASSERT_EQ(status.code(), tensorflow::error::INTERNAL);
+  EXPECT_EQ(fused_sizes, std::vector<int>({2}));
+  ASSERT_EQ(state->read_state(), TestState::State::kSuccess);
+  ASSERT_EQ(failing_state->read_state(), TestState::State::kFailure);
+}
+
 }  // namespace
 }  // namespace tensorflow
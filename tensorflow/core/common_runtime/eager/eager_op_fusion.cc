@@ -0,0 +1,303 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/eager/eager_op_fusion.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/core/common_runtime/eager/context.h"
+#include "tensorflow/core/common_runtime/eager/eager_operation.h"
+#include "tensorflow/core/common_runtime/eager/execute.h"
+#include "tensorflow/core/common_runtime/eager/execute_node.h"
+#include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
+#include "tensorflow/core/common_runtime/eager/tensor_handle.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+bool IsFusableOp(const string& op) {
+  static const auto* const kFusableOps = new absl::flat_hash_set<string>({
+      "Abs",        "Add",     "AddV2",    "Ceil",    "Cos",
+      "Div",        "Elu",     "Erf",      "Exp",     "Floor",
+      "Log",        "Log1p",   "Maximum",  "Minimum", "Mul",
+      "Neg",        "Pow",     "RealDiv",  "Reciprocal",
+      "Relu",       "Relu6",   "Round",    "Rsqrt",   "Selu",
+      "Sigmoid",    "Sin",     "Softplus", "Sqrt",    "Square",
+      "SquaredDifference",     "Sub",      "Tanh",
+  });
+  return kFusableOps->contains(op);
+}
+
+// Results of these types stay in device memory, so the outputs of a fused
+// function are on the same devices as those of the individual kernels.
+bool IsFusableType(DataType dtype) {
+  return dtype == DT_HALF || dtype == DT_BFLOAT16 || dtype == DT_FLOAT ||
+         dtype == DT_DOUBLE;
+}
+
+// Returns `node` if it runs a local elementwise op kernel on a single device.
+AsyncExecuteNode* AsFusableNode(EagerNode* node) {
+  AsyncExecuteNode* execute_node = node->AsAsyncExecuteNode();
+  if (execute_node == nullptr ||
+      execute_node->eager_func_params().has_value() ||
+      execute_node->graph_collector() != nullptr ||
+      execute_node->cancellation_manager() != nullptr ||
+      execute_node->retvals().size() != 1) {
+    return nullptr;
+  }
+  KernelAndDevice* kernel = execute_node->kernel().get();
+  if (kernel->IsFunction() || kernel->kernel() == nullptr ||
+      !IsFusableOp(kernel->kernel()->type_string()) ||
+      kernel->num_outputs() != 1 ||
+      !IsFusableType(kernel->output_dtypes()[0])) {
+    return nullptr;
+  }
+  Device* device = kernel->device();
+  if (device == nullptr || kernel->OutputDevice(0) != device) {
+    return nullptr;
+  }
+  const auto& inputs = execute_node->inputs();
+  for (int i = 0; i < inputs.size(); ++i) {
+    if (inputs[i]->Type() != TensorHandle::LOCAL ||
+        kernel->InputDevice(i) != device) {
+      return nullptr;
+    }
+  }
+  return execute_node;
+}
+
+// Runs a chain of AsyncExecuteNodes as a single function.
+class FusedExecuteNode : public EagerNode {
+ public:
+  FusedExecuteNode(std::vector<AsyncExecuteNode*> nodes, bool jit_compile,
+                   EagerExecutor* executor)
+      : nodes_(std::move(nodes)),
+        jit_compile_(jit_compile),
+        executor_(executor) {}
+
+  Status Run() override {
+    Status status = RunFunction();
+    if (!status.ok()) {
+      Abort(status);
+    }
+    return status;
+  }
+
+  // The executor aborts the other nodes of the chain.
+  void Abort(Status status) override { nodes_[0]->Abort(status); }
+
+  string DebugString() const override {
+    return absl::StrCat(
+        "[FusedExecuteNode] kernels: ",
+        absl::StrJoin(nodes_, ", ",
+                      [](string* out, const AsyncExecuteNode* node) {
+                        absl::StrAppend(out, node->kernel()->name());
+                      }));
+  }
+
+ private:
+  Status RunFunction();
+
+  const std::vector<AsyncExecuteNode*> nodes_;
+  const bool jit_compile_;
+  EagerExecutor* const executor_;
+};
+
+Status FusedExecuteNode::RunFunction() {
+  EagerContext* ctx = nodes_[0]->ctx();
+  Device* device = nodes_[0]->kernel()->device();
+
+  absl::flat_hash_map<const TensorHandle*, int> producers;
+  for (int i = 0; i < nodes_.size(); ++i) {
+    producers[nodes_[i]->retvals()[0]] = i;
+  }
+
+  // Inputs produced outside of the chain become function arguments.
+  FunctionDef fdef;
+  OpDef* signature = fdef.mutable_signature();
+  std::vector<TensorHandle*> args;
+  absl::flat_hash_map<const TensorHandle*, int> arg_indices;
+  absl::flat_hash_map<const TensorHandle*, int> uses_in_chain;
+  std::vector<string> results(nodes_.size());
+  for (int i = 0; i < nodes_.size(); ++i) {
+    const OpKernel* kernel = nodes_[i]->kernel()->kernel();
+    const OpDef* op_def;
+    TF_RETURN_IF_ERROR(
+        ctx->FuncLibDef()->LookUpOpDef(kernel->type_string(), &op_def));
+    NodeDef* ndef = fdef.add_node_def();
+    *ndef = kernel->def();
+    ndef->set_name(absl::StrCat("n", i));
+    ndef->clear_device();
+    ndef->clear_input();
+    for (TensorHandle* input : nodes_[i]->inputs()) {
+      auto producer = producers.find(input);
+      if (producer != producers.end()) {
+        ndef->add_input(results[producer->second]);
+        ++uses_in_chain[input];
+        continue;
+      }
+      auto arg_index = arg_indices.emplace(input, args.size());
+      if (arg_index.second) {
+        args.push_back(input);
+        OpDef::ArgDef* arg = signature->add_input_arg();
+        arg->set_name(absl::StrCat("arg", arg_index.first->second));
+        arg->set_type(input->DataType());
+      }
+      ndef->add_input(absl::StrCat("arg", arg_index.first->second));
+    }
+    results[i] =
+        absl::StrCat(ndef->name(), ":", op_def->output_arg(0).name(), ":0");
+  }
+
+  // A result is observed if it is referenced by anything but its own node and
+  // the nodes of the chain consuming it. Nothing else can acquire a new
+  // reference, so the result is never observed if it is not observed now.
+  std::vector<int> observed;
+  for (int i = 0; i < nodes_.size(); ++i) {
+    TensorHandle* retval = nodes_[i]->retvals()[0];
+    if (retval->RefCount() > 1 + uses_in_chain[retval]) {
+      OpDef::ArgDef* ret = signature->add_output_arg();
+      ret->set_name(absl::StrCat("ret", observed.size()));
+      ret->set_type(retval->DataType());
+      (*fdef.mutable_ret())[ret->name()] = results[i];
+      observed.push_back(i);
+    }
+  }
+
+  if (!observed.empty()) {
+    if (jit_compile_) {
+      (*fdef.mutable_attr())[kXlaMustCompileAttr].set_b(true);
+    }
+    // Chains of the same ops with the same attributes share a function.
+    signature->set_name("__eager_fused");
+    const uint64 hash = FunctionDefHash(fdef);
+    signature->set_name(absl::StrCat("__eager_fused_", hash));
+    if (ctx->FindFunctionDef(signature->name()) == nullptr) {
+      TF_RETURN_IF_ERROR(ctx->AddFunctionDef(fdef));
+    }
+
+    EagerOperation op(ctx);
+    TF_RETURN_IF_ERROR(op.Reset(signature->name().c_str(),
+                                device->name().c_str(),
+                                /*remote=*/false, executor_));
+    for (TensorHandle* arg : args) {
+      TF_RETURN_IF_ERROR(op.AddInput(arg));
+    }
+    std::vector<TensorHandle*> outputs(observed.size());
+    int num_outputs = outputs.size();
+    TF_RETURN_IF_ERROR(EagerExecute(&op, outputs.data(), &num_outputs));
+
+    Status status;
+    for (int k = 0; k < observed.size(); ++k) {
+      core::RefCountPtr<TensorHandle> output(outputs[k]);
+      if (!status.ok()) continue;
+      const AsyncExecuteNode* node = nodes_[observed[k]];
+      const Device* output_device =
+          ctx->CanonicalDevice(node->kernel()->OutputDevice(0));
+      if (output->device() != output_device) {
+        status = errors::Internal("Fused function ", signature->name(),
+                                  " returned a result on an unexpected ",
+                                  "device for ", node->kernel()->name());
+        continue;
+      }
+      const Tensor* tensor;
+      status = output->Tensor(&tensor);
+      if (status.ok()) {
+        status =
+            node->retvals()[0]->SetTensor(Tensor(*tensor), output_device);
+      }
+    }
+    TF_RETURN_IF_ERROR(status);
+  }
+
+  int next_observed = 0;
+  for (int i = 0; i < nodes_.size(); ++i) {
+    if (next_observed < observed.size() && observed[next_observed] == i) {
+      ++next_observed;
+      continue;
+    }
+    nodes_[i]->Abort(errors::Internal(
+        "The result of ", nodes_[i]->kernel()->name(),
+        " was not materialized, since it was not referenced when it was "
+        "computed as part of a fused function."));
+  }
+  return OkStatus();
+}
+
+bool RegisterElementwiseOpFuser() {
+  int64_t window_size = 0;
+  TF_CHECK_OK(
+      ReadInt64FromEnvVar("TF_EAGER_OP_FUSION_WINDOW", 0, &window_size));
+  if (window_size < 2) return false;
+  bool jit_compile = false;
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_EAGER_OP_FUSION_JIT_COMPILE", false,
+                                 &jit_compile));
+  EagerExecutor::SetNodeFuserFactory([window_size, jit_compile]() {
+    return std::make_unique<ElementwiseOpFuser>(window_size, jit_compile);
+  });
+  return true;
+}
+
+static const bool elementwise_op_fuser_registered =
+    RegisterElementwiseOpFuser();
+
+}  // namespace
+
+ElementwiseOpFuser::ElementwiseOpFuser(int window_size, bool jit_compile)
+    : window_size_(window_size),
+      jit_compile_(jit_compile),
+      executor_(/*async=*/false) {}
+
+std::unique_ptr<EagerNode> ElementwiseOpFuser::Fuse(
+    absl::Span<EagerNode* const> nodes, int* num_fused) {
+  std::vector<AsyncExecuteNode*> chain;
+  absl::flat_hash_set<const TensorHandle*> results;
+  for (EagerNode* node : nodes) {
+    AsyncExecuteNode* execute_node = AsFusableNode(node);
+    if (execute_node == nullptr) break;
+    if (!chain.empty()) {
+      if (execute_node->ctx() != chain[0]->ctx() ||
+          execute_node->kernel()->device() != chain[0]->kernel()->device()) {
+        break;
+      }
+      if (!absl::c_any_of(execute_node->inputs(),
+                          [&results](const TensorHandle* input) {
+                            return results.contains(input);
+                          })) {
+        break;
+      }
+    }
+    chain.push_back(execute_node);
+    results.insert(execute_node->retvals()[0]);
+  }
+  if (chain.size() < 2) return nullptr;
+  *num_fused = chain.size();
+  return std::make_unique<FusedExecuteNode>(std::move(chain), jit_compile_,
+                                            &executor_);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,59 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_EAGER_OP_FUSION_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_EAGER_OP_FUSION_H_
+
+#include <memory>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/common_runtime/eager/eager_executor.h"
+
+namespace tensorflow {
+
+// Fuses chains of elementwise ops queued on an async EagerExecutor into a
+// single function, which is run in place of the individual kernels.
+//
+// A chain starts at the node at the front of the queue and extends over the
+// following queued nodes, as long as each of them consumes the result of an
+// earlier node of the chain. Only local, single output ops from a fixed list
+// of elementwise ops are fused, and all of them must run on the same device.
+//
+// Results that are no longer referenced outside of the chain by the time it
+// runs are not materialized: they become intermediate values of the function
+// and their handles are poisoned.
+//
+// Enabled for all async executors by setting TF_EAGER_OP_FUSION_WINDOW to the
+// maximum number of nodes in a chain. If TF_EAGER_OP_FUSION_JIT_COMPILE is
+// set, the fused functions are compiled with XLA.
+class ElementwiseOpFuser : public EagerNodeFuser {
+ public:
+  ElementwiseOpFuser(int window_size, bool jit_compile);
+
+  int window_size() const override { return window_size_; }
+
+  std::unique_ptr<EagerNode> Fuse(absl::Span<EagerNode* const> nodes,
+                                  int* num_fused) override;
+
+ private:
+  const int window_size_;
+  const bool jit_compile_;
+
+  // Runs the fused functions inline on the thread of the async executor.
+  EagerExecutor executor_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_EAGER_OP_FUSION_H_
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 #include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
+#include "tensorflow/core/common_runtime/eager/thread_local_pool.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/op_def.pb.h"
@@ -46,6 +47,14 @@ class EagerOperation : public ImmediateExecutionOperation {
 
   void Release() override { delete this; }
 
+  // Callers that don't reuse operations create one per op.
+  static void* operator new(size_t size) {
+    return ThreadLocalPool<EagerOperation>::Allocate(size);
+  }
+  static void operator delete(void* ptr, size_t size) {
+    ThreadLocalPool<EagerOperation>::Deallocate(ptr, size);
+  }
+
   void Clear() override;
   Status Reset(const char* op, const char* raw_device_name) override {
     return Reset(op, raw_device_name, false, nullptr);
@@ -151,6 +160,12 @@ class EagerOperation : public ImmediateExecutionOperation {
   AttrBuilder* MutableAttrs() { return &attrs_; }
   const AttrBuilder& Attrs() const { return attrs_; }
 
+  // Kept across Reset so that operations reused for the same op find their
+  // kernel without a kernel cache lookup.
+  tensorflow::EagerContext::KernelCacheHint* MutableKernelCacheHint() {
+    return &kernel_cache_hint_;
+  }
+
   // TensorHandleInputs and MutableTensorHandleInputs first check that all
   // inputs are TensorHandles, i.e. that there are no custom device inputs. They
   // return a bad status otherwise.
@@ -244,6 +259,7 @@ class EagerOperation : public ImmediateExecutionOperation {
   const char* op_name_ = nullptr;
   AttrBuilder attrs_;
   const AttrTypeMap* attr_types_;
+  tensorflow::EagerContext::KernelCacheHint kernel_cache_hint_;
 
   // The number of custom device TensorHandle inputs. These inputs need to be
   // processed by CustomDeviceOpHandler first.
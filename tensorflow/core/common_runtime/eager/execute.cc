@@ -1230,7 +1230,8 @@ Status GetOrCreateKernelAndDevice(
       GetKernelCacheKey(*op, op->MutableAttrs()->CacheKey(op->DeviceName()),
                         input_device_ptrs,
                         input_resource_variable_dtypes_and_shapes));
-  core::RefCountPtr<KernelAndDevice> kernel = ctx.GetCachedKernel(cache_key);
+  core::RefCountPtr<KernelAndDevice> kernel =
+      ctx.GetCachedKernel(cache_key, op->MutableKernelCacheHint());
   AbstractOperationPtr wrapped_op_releaser;
   // We can eliminate some overhead by running simple functions using regular
   // CallOp kernel. However, it is tricky to figure out which functions should
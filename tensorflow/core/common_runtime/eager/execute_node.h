@@ -228,6 +228,23 @@ class AsyncExecuteNode : public EagerNode {
     return out;
   }
 
+  AsyncExecuteNode* AsAsyncExecuteNode() final { return this; }
+
+  // Accessors used to run this node as part of a fused node.
+  EagerContext* ctx() const { return ctx_; }
+  const absl::InlinedVector<TensorHandle*, 4>& inputs() const {
+    return inputs_;
+  }
+  const absl::optional<EagerFunctionParams>& eager_func_params() const {
+    return eager_func_params_;
+  }
+  const core::RefCountPtr<KernelAndDevice>& kernel() const { return kernel_; }
+  GraphCollector* graph_collector() const { return graph_collector_; }
+  CancellationManager* cancellation_manager() const {
+    return cancellation_manager_;
+  }
+  absl::Span<TensorHandle* const> retvals() const { return retvals_; }
+
  private:
   EagerContext* ctx_;
   absl::InlinedVector<TensorHandle*, 4> inputs_;
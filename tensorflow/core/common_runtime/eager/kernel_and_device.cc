@@ -44,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
+#include "tensorflow/tsl/profiler/lib/step_counter.h"
 #if !defined(IS_MOBILE_PLATFORM)
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
@@ -432,6 +433,7 @@ Status KernelAndDeviceFunc::Run(
     n.WaitForNotification();
     return status;
   }
+  tsl::profiler::StepCounter::StepStarted();
   std::shared_ptr<FunctionLibraryRuntime::Options> opts =
       PrepareForRun(step_container, outputs, cancellation_manager,
                     eager_func_params, stack_trace, coordination_service_agent);
@@ -472,6 +474,7 @@ void KernelAndDeviceFunc::RunAsync(
                                        {{"_r", 1}});
       },
       profiler::TraceMeLevel::kInfo);
+  tsl::profiler::StepCounter::StepStarted();
   std::shared_ptr<FunctionLibraryRuntime::Options> opts = PrepareForRun(
       step_container, outputs, cancellation_manager, eager_func_params,
       absl::nullopt, coordination_service_agent);
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle_data.h"
+#include "tensorflow/core/common_runtime/eager/thread_local_pool.h"
 #include "tensorflow/core/common_runtime/function.h"
 #if !defined(IS_MOBILE_PLATFORM)
 #include "tensorflow/core/distributed_runtime/eager/remote_tensor_handle_data.h"
@@ -120,6 +121,14 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
                                               EagerContext* ctx);
 #endif  // IS_MOBILE_PLATFORM
 
+  // Every eager op creates its output handles, so their storage is recycled.
+  static void* operator new(size_t size) {
+    return ThreadLocalPool<TensorHandle>::Allocate(size);
+  }
+  static void operator delete(void* ptr, size_t size) {
+    ThreadLocalPool<TensorHandle>::Deallocate(ptr, size);
+  }
+
   // Templated struct `AutoReleaser` in
   // core/runtime_fallback/runtime/kernel_utils.h needs a Release() method
   // defined.
@@ -0,0 +1,128 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_THREAD_LOCAL_POOL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_THREAD_LOCAL_POOL_H_
+
+#include <cstddef>
+#include <new>
+
+#include "absl/base/config.h"
+
+namespace tensorflow {
+
+// Recycles the storage of objects of type T through a free list per thread.
+// Every eager op creates a few small, short-lived objects (its output
+// TensorHandles, an AsyncExecuteNode in async mode, the EagerOperation itself
+// when the caller doesn't reuse it), and small-op workloads otherwise spend a
+// large fraction of their time in malloc and free.
+//
+// T opts in by forwarding its class-specific allocation functions:
+//
+//   static void* operator new(size_t size) {
+//     return ThreadLocalPool<T>::Allocate(size);
+//   }
+//   static void operator delete(void* ptr, size_t size) {
+//     ThreadLocalPool<T>::Deallocate(ptr, size);
+//   }
+//
+// Storage freed on a different thread than it was allocated on joins the free
+// list of the freeing thread. Each list keeps at most kMaxFreeBlocks blocks and
+// returns the rest, and everything it holds at thread exit, to the heap.
+// Requests for any other size than sizeof(T), i.e. for subclasses of T, bypass
+// the pool, as do all requests in AddressSanitizer builds so that
+// use-after-free is still detected.
+template <typename T>
+class ThreadLocalPool {
+ public:
+  static constexpr int kMaxFreeBlocks = 64;
+
+  static constexpr bool enabled() {
+#ifdef ABSL_HAVE_ADDRESS_SANITIZER
+    return false;
+#else
+    return true;
+#endif
+  }
+
+  static void* Allocate(size_t size) {
+    FreeList& list = free_list_;
+    if (!enabled() || size != sizeof(T) || list.head == nullptr) {
+      return ::operator new(size);
+    }
+    Block* block = list.head;
+    list.head = block->next;
+    --list.size;
+    return block;
+  }
+
+  static void Deallocate(void* ptr, size_t size) {
+    FreeList& list = free_list_;
+    if (!enabled() || size != sizeof(T) || list.drained ||
+        list.size >= kMaxFreeBlocks) {
+      ::operator delete(ptr);
+      return;
+    }
+    static thread_local Drainer drainer;
+    (void)drainer;
+    Block* block = static_cast<Block*>(ptr);
+    block->next = list.head;
+    list.head = block;
+    ++list.size;
+  }
+
+  // Returns the number of blocks on the free list of the calling thread.
+  static int NumFreeBlocks() { return free_list_.size; }
+
+ private:
+  struct Block {
+    Block* next;
+  };
+  static_assert(sizeof(T) >= sizeof(Block), "T is too small to be pooled");
+  static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                "T is over-aligned");
+
+  // Trivially destructible, so that objects freed by other thread-local
+  // destructors after the list was drained still find it in a valid state.
+  struct FreeList {
+    Block* head;
+    int size;
+    bool drained;
+  };
+
+  // Returns the blocks of the calling thread to the heap when it exits.
+  struct Drainer {
+    ~Drainer() {
+      FreeList& list = free_list_;
+      while (list.head != nullptr) {
+        Block* block = list.head;
+        list.head = block->next;
+        ::operator delete(block);
+      }
+      list.size = 0;
+      list.drained = true;
+    }
+  };
+
+  static thread_local FreeList free_list_;
+};
+
+template <typename T>
+thread_local typename ThreadLocalPool<T>::FreeList
+    ThreadLocalPool<T>::free_list_ = {nullptr, 0, false};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_THREAD_LOCAL_POOL_H_
@@ -0,0 +1,97 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/eager/thread_local_pool.h"
+
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class Pooled {
+ public:
+  virtual ~Pooled() = default;
+
+  static void* operator new(size_t size) {
+    return ThreadLocalPool<Pooled>::Allocate(size);
+  }
+  static void operator delete(void* ptr, size_t size) {
+    ThreadLocalPool<Pooled>::Deallocate(ptr, size);
+  }
+
+ private:
+  int64_t payload_[4] = {};
+};
+
+class PooledSubclass : public Pooled {
+ private:
+  int64_t extra_payload_[4] = {};
+};
+
+class ThreadLocalPoolTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!ThreadLocalPool<Pooled>::enabled()) {
+      GTEST_SKIP() << "The pool is disabled in this build.";
+    }
+  }
+};
+
+TEST_F(ThreadLocalPoolTest, ReusesFreedStorage) {
+  Pooled* first = new Pooled;
+  delete first;
+  const int num_free_blocks = ThreadLocalPool<Pooled>::NumFreeBlocks();
+  EXPECT_GE(num_free_blocks, 1);
+
+  Pooled* second = new Pooled;
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(ThreadLocalPool<Pooled>::NumFreeBlocks(), num_free_blocks - 1);
+  delete second;
+}
+
+TEST_F(ThreadLocalPoolTest, SubclassesBypassThePool) {
+  const int num_free_blocks = ThreadLocalPool<Pooled>::NumFreeBlocks();
+  Pooled* subclass = new PooledSubclass;
+  delete subclass;
+  EXPECT_EQ(ThreadLocalPool<Pooled>::NumFreeBlocks(), num_free_blocks);
+}
+
+TEST_F(ThreadLocalPoolTest, FreeListIsBounded) {
+  std::vector<std::unique_ptr<Pooled>> objects;
+  for (int i = 0; i < 2 * ThreadLocalPool<Pooled>::kMaxFreeBlocks; ++i) {
+    objects.emplace_back(new Pooled);
+  }
+  objects.clear();
+  EXPECT_EQ(ThreadLocalPool<Pooled>::NumFreeBlocks(),
+            ThreadLocalPool<Pooled>::kMaxFreeBlocks);
+}
+
+TEST_F(ThreadLocalPoolTest, FreeListsArePerThread) {
+  std::unique_ptr<Pooled> object(new Pooled);
+  const int num_free_blocks = ThreadLocalPool<Pooled>::NumFreeBlocks();
+  std::thread thread([&object] {
+    object.reset();
+    EXPECT_EQ(ThreadLocalPool<Pooled>::NumFreeBlocks(), 1);
+  });
+  thread.join();
+  EXPECT_EQ(ThreadLocalPool<Pooled>::NumFreeBlocks(), num_free_blocks);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -30,10 +30,12 @@ class Tensor;
 // Either a tensor pointer (pass-by-reference) or a tensor (pass-by-value).
 struct Entry {
   enum class State {
-    NO_VALUE = 0,      // The default state for a newly-created Entry.
-    HAS_VALUE,         // `this->val` is valid.
-    HAS_CONST_TENSOR,  // `this->const_tensor` is valid.
-    HAS_REF_TENSOR,    // `this->ref_tensor` is valid.
+    NO_VALUE = 0,       // The default state for a newly-created Entry.
+    HAS_VALUE,          // `this->val` is valid.
+    HAS_CONST_TENSOR,   // `this->const_tensor` is valid.
+    HAS_REF_TENSOR,     // `this->ref_tensor` is valid.
+    HAS_SWAPPED_VALUE,  // `this->val` is the host copy of a device tensor
+                        // that was swapped out (see TensorSwapper).
   };
 
   Entry() : state(State::NO_VALUE) {}
@@ -42,6 +44,7 @@ struct Entry {
       case State::NO_VALUE:
         break;
       case State::HAS_VALUE:
+      case State::HAS_SWAPPED_VALUE:
         val.Init(*other.val);
         break;
       case State::HAS_CONST_TENSOR:
@@ -54,11 +57,11 @@ struct Entry {
   }
 
   ~Entry() {
-    if (state == State::HAS_VALUE) val.Destroy();
+    if (has_val()) val.Destroy();
   }
 
   Entry& operator=(const Entry& other) {
-    if (state == State::HAS_VALUE) {
+    if (has_val()) {
       val.Destroy();
     }
     state = other.state;
@@ -67,6 +70,7 @@ struct Entry {
       case State::NO_VALUE:
         break;
       case State::HAS_VALUE:
+      case State::HAS_SWAPPED_VALUE:
         val.Init(*other.val);
         break;
       case State::HAS_CONST_TENSOR:
@@ -80,7 +84,7 @@ struct Entry {
   }
 
   Entry& operator=(Entry&& other) {
-    if (state == State::HAS_VALUE) {
+    if (has_val()) {
       val.Destroy();
     }
     state = other.state;
@@ -89,6 +93,7 @@ struct Entry {
       case State::NO_VALUE:
         break;
       case State::HAS_VALUE:
+      case State::HAS_SWAPPED_VALUE:
         val.Init(std::move(*other.val));
         break;
       case State::HAS_CONST_TENSOR:
@@ -103,14 +108,20 @@ struct Entry {
 
   // Clears the <val> field, and sets this entry to the `NO_VALUE` state.
   void ClearVal() {
-    if (state == State::HAS_VALUE) {
+    if (has_val()) {
       val.Destroy();
     }
     state = State::NO_VALUE;
   }
 
+  // Returns true if `val` is valid.
+  bool has_val() const {
+    return state == State::HAS_VALUE || state == State::HAS_SWAPPED_VALUE;
+  }
+
   union {
-    // A tensor value. Valid iff `state_ == HAS_VALUE`.
+    // A tensor value. Valid iff `state_ == HAS_VALUE` or
+    // `state_ == HAS_SWAPPED_VALUE`.
     ManualConstructor<Tensor> val;
 
     // A pointer to a constant tensor value. Valid iff `state_ ==
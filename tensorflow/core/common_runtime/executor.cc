@@ -30,11 +30,15 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
+#include "tensorflow/core/common_runtime/kernel_cost_estimates.h"
+#include "tensorflow/core/common_runtime/op_latency_sampler.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/common_runtime/tensor_swapper.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -61,6 +65,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -139,17 +144,153 @@ struct KernelTimer {
   }
 };
 
+// Records which `WorkStealingReadyQueue` shard (if any) the current thread is
+// draining, so that nodes made ready on a worker thread are pushed to that
+// worker's own shard.
+class WorkStealingWorkerScope {
+ public:
+  WorkStealingWorkerScope(const void* queue, int shard)
+      : prev_queue_(queue_), prev_shard_(shard_) {
+    queue_ = queue;
+    shard_ = shard;
+  }
+  ~WorkStealingWorkerScope() {
+    queue_ = prev_queue_;
+    shard_ = prev_shard_;
+  }
+
+  // Returns the shard owned by the current thread in `queue`, or -1 if the
+  // current thread is not a worker of `queue`.
+  static int CurrentShard(const void* queue) {
+    return queue_ == queue ? shard_ : -1;
+  }
+
+ private:
+  const void* const prev_queue_;
+  const int prev_shard_;
+
+  static thread_local const void* queue_;
+  static thread_local int shard_;
+};
+thread_local const void* WorkStealingWorkerScope::queue_ = nullptr;
+thread_local int WorkStealingWorkerScope::shard_ = -1;
+
+// A set of per-worker ready queues used by the "WORK_STEALING_EXECUTOR".
+//
+// Instead of dispatching one `runner_` closure for every expensive ready node,
+// the executor pushes such nodes to the shard owned by the current worker and
+// starts at most `num_shards()` worker closures per step. A worker pops from
+// the back of its own shard (LIFO, so that a consumer runs while its producer's
+// outputs are still hot in cache) and, when its shard is empty, steals from the
+// front of the other shards.
+//
+// Every node in the queue is counted in `ExecutorState::num_outstanding_ops_`,
+// so the owning `ExecutorState` is alive whenever the queue is non-empty. The
+// queue itself is reference counted by the workers, which may outlive the step.
+template <class TaggedNode>
+class WorkStealingReadyQueue {
+ public:
+  struct Item {
+    TaggedNode node;
+    int64_t scheduled_nsec;
+  };
+
+  explicit WorkStealingReadyQueue(int num_shards)
+      : num_shards_(std::max(1, num_shards)),
+        shards_(new Shard[num_shards_]) {}
+
+  int num_shards() const { return num_shards_; }
+
+  // Returns a shard in round-robin order, for producers that are not workers.
+  int NextShard() {
+    return next_shard_.fetch_add(1, std::memory_order_relaxed) % num_shards_;
+  }
+
+  void Push(int shard, const TaggedNode& node, int64_t scheduled_nsec) {
+    Shard& s = shards_[shard];
+    {
+      mutex_lock l(s.mu);
+      s.items.push_back({node, scheduled_nsec});
+    }
+    num_items_.fetch_add(1);
+  }
+
+  // Pops a node from `shard`, or steals one from another shard if `shard` is
+  // empty. Returns nullopt if no node was found.
+  absl::optional<Item> Pop(int shard) {
+    if (num_items_.load() == 0) return absl::nullopt;
+    for (int i = 0; i < num_shards_; ++i) {
+      Shard& s = shards_[(shard + i) % num_shards_];
+      mutex_lock l(s.mu);
+      if (s.head == s.items.size()) continue;
+      absl::optional<Item> item;
+      if (i == 0) {
+        item.emplace(std::move(s.items.back()));
+        s.items.pop_back();
+      } else {
+        item.emplace(std::move(s.items[s.head]));
+        ++s.head;
+      }
+      if (s.head == s.items.size()) {
+        s.items.clear();
+        s.head = 0;
+      }
+      num_items_.fetch_sub(1);
+      return item;
+    }
+    return absl::nullopt;
+  }
+
+  bool HasItems() const { return num_items_.load() > 0; }
+
+  // Reserves a worker slot. Returns true if the caller must start a worker.
+  bool TryAddWorker() {
+    int active = num_active_workers_.load();
+    while (active < num_shards_) {
+      if (num_active_workers_.compare_exchange_weak(active, active + 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Releases a worker slot. The worker must re-check `HasItems()` afterwards,
+  // because a concurrent `Push()` may have observed all slots as taken.
+  void RemoveWorker() { num_active_workers_.fetch_sub(1); }
+
+ private:
+  struct alignas(64) Shard {
+    mutex mu;
+    // Items in `[head, items.size())` are pending. Stolen items are consumed
+    // from `head`, local items from the back.
+    std::vector<Item> items TF_GUARDED_BY(mu);
+    size_t head TF_GUARDED_BY(mu) = 0;
+  };
+
+  const int num_shards_;
+  std::unique_ptr<Shard[]> shards_;
+  std::atomic<int> next_shard_{0};
+  std::atomic<int64_t> num_items_{0};
+  std::atomic<int> num_active_workers_{0};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(WorkStealingReadyQueue);
+};
+
 // TODO(b/152925936): Re-evaluate these constants with current usage patterns.
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        bool use_work_stealing = false)
+      : immutable_state_(p), use_work_stealing_(use_work_stealing) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
-    kernel_stats_.Initialize(immutable_state_.graph_view());
+    kernel_stats_.Initialize(immutable_state_.graph_view(),
+                             immutable_state_.params().device,
+                             immutable_state_.params().kernel_cost_estimates);
     return OkStatus();
   }
 
@@ -164,15 +305,48 @@ class ExecutorImpl : public Executor {
    public:
     KernelStats() = default;
 
-    void Initialize(const GraphView& gview) {
+    ~KernelStats() {
+      if (shared_estimates_ == nullptr) return;
+      for (size_t i = 0; i < shared_estimate_keys_.size(); ++i) {
+        const uint64 estimate =
+            cost_estimates_[i].load(std::memory_order_relaxed);
+        if (!shared_estimate_keys_[i].empty() &&
+            estimate != kInitialCostEstimateCycles) {
+          shared_estimates_->Insert(shared_estimate_keys_[i], estimate);
+        }
+      }
+    }
+
+    // If `shared_estimates` is not null, the cost of every synchronous kernel
+    // is measured, and the estimates are seeded from and stored back into
+    // `shared_estimates`.
+    void Initialize(const GraphView& gview, const Device* device,
+                    KernelCostEstimates* shared_estimates) {
       is_expensive_.resize(gview.num_nodes());
       cost_estimates_ =
           std::make_unique<std::atomic_uint_fast64_t[]>(gview.num_nodes());
+      shared_estimates_ = shared_estimates;
+      if (shared_estimates_ != nullptr) {
+        shared_estimate_keys_.resize(gview.num_nodes());
+      }
       for (int32_t i = 0; i < gview.num_nodes(); ++i) {
         if (gview.node(i)) {
-          is_expensive_[i] =
-              gview.node(i)->kernel && gview.node(i)->kernel->IsExpensive();
+          OpKernel* kernel = gview.node(i)->kernel;
+          is_expensive_[i] = kernel && kernel->IsExpensive();
           cost_estimates_[i] = kInitialCostEstimateCycles;
+          if (shared_estimates_ != nullptr && kernel != nullptr &&
+              !kernel->AsAsync()) {
+            // Async kernels return before their work is done, so their
+            // measured cost would not be meaningful.
+            is_expensive_[i] = true;
+            shared_estimate_keys_[i] = KernelCostEstimates::Key(
+                device->name(), kernel->name(), kernel->type_string());
+            uint64 estimate;
+            if (shared_estimates_->Lookup(shared_estimate_keys_[i],
+                                          &estimate)) {
+              cost_estimates_[i] = estimate;
+            }
+          }
         }
       }
     }
@@ -219,10 +393,18 @@ class ExecutorImpl : public Executor {
     std::vector<bool> is_expensive_;
     // std::unique_ptr<std::atomic<bool>[]> is_expensive_;
     std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
+
+    // Not owned. If not null, `shared_estimate_keys_[i]` is the key of the
+    // i-th node's estimate in `shared_estimates_`.
+    KernelCostEstimates* shared_estimates_ = nullptr;
+    std::vector<std::string> shared_estimate_keys_;
   };
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  // If true, expensive ready nodes are distributed through a per-step
+  // `WorkStealingReadyQueue` instead of one `runner` closure per node.
+  const bool use_work_stealing_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(ExecutorImpl);
 };
@@ -281,7 +463,8 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                bool use_work_stealing);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -292,6 +475,7 @@ class ExecutorState {
   typedef
       typename PropagatorStateType::TaggedNodeReadyQueue TaggedNodeReadyQueue;
   typedef typename PropagatorStateType::TaggedNodeSeq TaggedNodeSeq;
+  typedef WorkStealingReadyQueue<TaggedNode> WorkStealingQueue;
 
   struct AsyncState;
 
@@ -303,11 +487,22 @@ class ExecutorState {
 
   Status ProcessSync(const NodeItem& item, OpKernelContext::Params* params,
                      EntryVector* outputs, NodeExecStatsInterface* stats);
+  // Returns the buffers in `preallocated_outputs_` for the outputs of `item`,
+  // indexed by output slot, or nullptr if there are none. The result points
+  // into `storage`.
+  const Tensor* const* GetPreallocatedOutputs(
+      const NodeItem& item, gtl::InlinedVector<const Tensor*, 4>* storage);
   void ProcessAsync(const NodeItem& item, const OpKernelContext::Params& params,
                     const TaggedNode& tagged_node, Entry* first_input,
                     NodeExecStatsInterface* stats,
                     activity_watcher::ActivityId activity_id);
   void ProcessNoop(NodeExecStatsInterface* stats);
+  // Returns the model name under which OpLatencySampler records the kernels
+  // of this step.
+  StringPiece model_name() const {
+    return session_metadata_ != nullptr ? StringPiece(session_metadata_->name())
+                                        : StringPiece();
+  }
   void ProcessConstTensor(const NodeItem& item, EntryVector* outputs,
                           NodeExecStatsInterface* stats);
 
@@ -337,6 +532,20 @@ class ExecutorState {
   // REQUIRES: `!ready->empty()`.
   void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
 
+  // Implementation of `ScheduleReady()` for the work-stealing mode: inexpensive
+  // nodes are inlined as usual, expensive nodes are pushed to `ws_queue_` and
+  // workers are started as needed to drain it.
+  void ScheduleReadyWorkStealing(TaggedNodeSeq* ready,
+                                 TaggedNodeReadyQueue* inline_ready,
+                                 int64_t scheduled_nsec);
+
+  // Drains `queue` on the current thread, stealing from other shards when
+  // `shard` is empty. This is static because `state` may be deleted as soon as
+  // the last outstanding node completes.
+  static void RunWorkStealingWorker(ExecutorState* state,
+                                    std::shared_ptr<WorkStealingQueue> queue,
+                                    int shard);
+
   // A wrapper for runner_ to keep track of the pending queue length. Op
   // execution should dispatch work using this function instead of using runner_
   // directly.
@@ -351,6 +560,10 @@ class ExecutorState {
   // step.
   DeviceContext* device_context_ = nullptr;
 
+  // Non-null iff long-lived device tensors may be swapped out to host memory
+  // in this step.
+  std::unique_ptr<TensorSwapper> tensor_swapper_;
+
   const bool vlog_;  // true if VLOG_IS_ON(1). Used to check vlog cheaply.
 
   // true if LogMemory::IsEnabled(). Used to check memory enabled cheaply.
@@ -394,6 +607,13 @@ class ExecutorState {
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
+  StepArenaAllocator* const step_arena_allocator_;  // Not owned.
+  Allocator* const default_allocator_override_;     // Not owned.
+  const gtl::ArraySlice<Executor::Args::PreallocatedOutput>
+      preallocated_outputs_;
+
+  // Non-null iff the work-stealing mode is enabled for this step.
+  std::shared_ptr<WorkStealingQueue> ws_queue_;
 
   PropagatorStateType propagator_;
 
@@ -415,7 +635,7 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, bool use_work_stealing)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -443,8 +663,14 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       runner_(args.runner),
       sync_on_finish_(args.sync_on_finish),
       run_all_kernels_inline_(args.run_all_kernels_inline),
+      step_arena_allocator_(args.step_arena_allocator),
+      default_allocator_override_(args.default_allocator_override),
+      preallocated_outputs_(args.preallocated_outputs),
       propagator_(immutable_state, step_id_, vlog_),
       num_outstanding_ops_(0) {
+  if (use_work_stealing && !run_all_kernels_inline_) {
+    ws_queue_ = std::make_shared<WorkStealingQueue>(port::MaxParallelism());
+  }
   if (args.user_intra_op_threadpool != nullptr) {
     Device* device = immutable_state_.params().device;
     user_device_ = RenamedDevice::NewRenamedDevice(
@@ -497,6 +723,14 @@ void ExecutorState<PropagatorStateType>::RunAsync(Executor::DoneCallback done) {
     done(get_context_status);
     return;
   }
+  // Steps that allocate from an arena or an override allocator keep all their
+  // tensors in it.
+  if (immutable_state_.tensor_swap_plan() != nullptr &&
+      device_context_ != nullptr && step_arena_allocator_ == nullptr &&
+      default_allocator_override_ == nullptr) {
+    tensor_swapper_ = std::make_unique<TensorSwapper>(
+        immutable_state_.tensor_swap_plan(), device, device_context_);
+  }
 
   // Initialize the ready queue.
   ready.reserve(immutable_state_.root_nodes().size());
@@ -576,6 +810,28 @@ bool MightTrace(const tracing::EventCollector* event_collector,
   return profiler::TraceMe::Active(profiler::GetTFTraceMeLevel(is_expensive));
 }
 
+template <class PropagatorStateType>
+const Tensor* const*
+ExecutorState<PropagatorStateType>::GetPreallocatedOutputs(
+    const NodeItem& item, gtl::InlinedVector<const Tensor*, 4>* storage) {
+  auto it = std::lower_bound(
+      preallocated_outputs_.begin(), preallocated_outputs_.end(), item.node_id,
+      [](const Executor::Args::PreallocatedOutput& output, int node_id) {
+        return output.node_id < node_id;
+      });
+  if (it == preallocated_outputs_.end() || it->node_id != item.node_id) {
+    return nullptr;
+  }
+  storage->assign(item.num_outputs, nullptr);
+  for (; it != preallocated_outputs_.end() && it->node_id == item.node_id;
+       ++it) {
+    if (it->output_slot < item.num_outputs) {
+      (*storage)[it->output_slot] = it->tensor;
+    }
+  }
+  return storage->data();
+}
+
 template <class PropagatorStateType>
 Status ExecutorState<PropagatorStateType>::ProcessSync(
     const NodeItem& item, OpKernelContext::Params* params, EntryVector* outputs,
@@ -587,6 +843,9 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   OpKernel* op_kernel = item.kernel;
   Device* device = immutable_state_.params().device;
   const bool is_expensive = kernel_stats_->IsExpensive(item);
+  const uint64 sample_start_us =
+      TF_PREDICT_FALSE(OpLatencySampler::ShouldSample()) ? EnvTime::NowMicros()
+                                                         : 0;
 
   if (TF_PREDICT_FALSE(MightTrace(event_collector_, is_expensive))) {
     tracing::ScopedRegion region(tracing::EventCategory::kCompute,
@@ -612,6 +871,10 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   } else {
     device->Compute(op_kernel, &ctx);
   }
+  if (TF_PREDICT_FALSE(sample_start_us != 0)) {
+    OpLatencySampler::RecordOp(model_name(), op_kernel->type_string_view(),
+                               EnvTime::NowMicros() - sample_start_us);
+  }
   nodestats::SetOpEnd(stats);
   if (outputs->size() < item.num_outputs) outputs->resize(item.num_outputs);
   s = ProcessOutputs(item, &ctx, outputs->data(), stats);
@@ -628,12 +891,20 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
   DCHECK(async_kernel != nullptr);
   AsyncState* state =
       new AsyncState(params, tagged_node, &item, first_input, stats);
+  const uint64 sample_start_us =
+      TF_PREDICT_FALSE(OpLatencySampler::ShouldSample()) ? EnvTime::NowMicros()
+                                                         : 0;
 
-  auto done = [this, state, activity_id]() {
+  auto done = [this, state, activity_id, sample_start_us]() {
     Device* device = immutable_state_.params().device;
     NodeExecStatsInterface* stats = state->stats;  // Shorthand
     Entry* first_input = state->first_input;       // Shorthand
 
+    if (TF_PREDICT_FALSE(sample_start_us != 0)) {
+      OpLatencySampler::RecordOp(model_name(),
+                                 state->item->kernel->type_string_view(),
+                                 EnvTime::NowMicros() - sample_start_us);
+    }
     nodestats::SetOpEnd(stats);
     EntryVector outputs(state->item->num_outputs);
     Status s = ProcessOutputs(*state->item, &state->ctx, outputs.data(), stats);
@@ -740,6 +1011,14 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
   params.slice_reader_cache = slice_reader_cache_;
   params.runner = &runner_;
   params.run_all_kernels_inline = run_all_kernels_inline_;
+  if (step_arena_allocator_ != nullptr) {
+    params.step_arena_allocator = step_arena_allocator_;
+    params.step_arena_wrapped_allocator = step_arena_allocator_->wrapped();
+  } else if (default_allocator_override_ != nullptr) {
+    params.step_arena_allocator = default_allocator_override_;
+    params.step_arena_wrapped_allocator =
+        device->GetAllocator(AllocatorAttributes());
+  }
   params.stats_collector = stats_collector_;
   params.inc_num_deferred_ops_function = [this]() {
     mutex_lock lock(num_deferred_ops_mu_);
@@ -876,6 +1155,10 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
 
       // Set up compute params.
       params.op_kernel = item.kernel;
+      DeviceContext* node_device_context = immutable_state_.device_context(id);
+      params.op_device_context = node_device_context != nullptr
+                                     ? node_device_context
+                                     : device_context_;
       params.frame_iter = propagator_.GetFrameAndIter(tagged_node);
       params.is_input_dead = is_input_dead;
       params.output_attr_array = item.output_attrs();
@@ -889,7 +1172,13 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
                      activity_id);
         launched_asynchronously = true;
       } else {
+        gtl::InlinedVector<const Tensor*, 4> preallocated_outputs;
+        if (TF_PREDICT_FALSE(!preallocated_outputs_.empty())) {
+          params.preallocated_outputs =
+              GetPreallocatedOutputs(item, &preallocated_outputs);
+        }
         s = ProcessSync(item, &params, &outputs, stats);
+        params.preallocated_outputs = nullptr;
       }
     }
 
@@ -981,6 +1270,22 @@ Status ExecutorState<PropagatorStateType>::PrepareInputs(
         break;
       }
 
+      case Entry::State::HAS_SWAPPED_VALUE: {
+        if (TF_PREDICT_FALSE(expect_ref)) {
+          return AttachDef(
+              errors::InvalidArgument(i, "-th input expects a ref type"),
+              item.kernel->def());
+        }
+        DCHECK(tensor_swapper_ != nullptr);
+        Status s = tensor_swapper_->SwapIn(entry);
+        if (TF_PREDICT_FALSE(!s.ok())) {
+          return AttachDef(s, item.kernel->def());
+        }
+        inp->mutex_if_ref = nullptr;
+        inp->tensor = entry->val.get();
+        break;
+      }
+
       case Entry::State::HAS_CONST_TENSOR: {
         if (TF_PREDICT_FALSE(expect_ref)) {
           return AttachDef(
@@ -1128,6 +1433,11 @@ Status ExecutorState<PropagatorStateType>::ProcessOutputs(
             LogMemory::RecordTensorOutput(ctx->op_kernel().name(),
                                           ctx->step_id(), i, *out->val);
           }
+          if (tensor_swapper_ != nullptr &&
+              ctx->output_memory_type(i) == DEVICE_MEMORY) {
+            tensor_swapper_->MaybeSwapOut(item.node_id, i,
+                                          ctx->op_device_context(), out);
+          }
         }
       } else {
         s.Update(
@@ -1155,6 +1465,7 @@ bool ExecutorState<PropagatorStateType>::NodeDone(
     DCHECK_NE(stats_collector_, nullptr);
     stats->Done(immutable_state_.params().device->name());
   }
+  if (tensor_swapper_ != nullptr) tensor_swapper_->NodeCompleted();
 
   if (TF_PREDICT_TRUE(s.ok())) {
     const size_t ready_size = ready->size();
@@ -1269,6 +1580,8 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         inline_ready->push_back(tagged_node);
       }
     }
+  } else if (ws_queue_ != nullptr) {
+    ScheduleReadyWorkStealing(ready, inline_ready, scheduled_nsec);
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     TaggedNodeSeq expensive_nodes;
@@ -1346,6 +1659,58 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   ready->clear();
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::ScheduleReadyWorkStealing(
+    TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready,
+    int64_t scheduled_nsec) {
+  WorkStealingQueue* queue = ws_queue_.get();
+  const int current_shard = WorkStealingWorkerScope::CurrentShard(queue);
+  const bool is_worker = current_shard >= 0;
+  int num_pushed = 0;
+  for (auto& tagged_node : *ready) {
+    const NodeItem& item = *tagged_node.node_item;
+    if (inline_ready != nullptr &&
+        (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item))) {
+      // Inline this inexpensive node.
+      inline_ready->push_back(tagged_node);
+    } else {
+      queue->Push(is_worker ? current_shard : queue->NextShard(), tagged_node,
+                  scheduled_nsec);
+      ++num_pushed;
+    }
+  }
+  // A worker picks up one of the pushed nodes itself once its `inline_ready`
+  // queue is drained; any other pushed node may need a new worker.
+  int num_workers_to_start = is_worker ? num_pushed - 1 : num_pushed;
+  for (; num_workers_to_start > 0 && queue->TryAddWorker();
+       --num_workers_to_start) {
+    RunTask(
+        [this, ws_queue = ws_queue_, shard = queue->NextShard()]() {
+          RunWorkStealingWorker(this, ws_queue, shard);
+        },
+        /*sample_rate=*/num_pushed);
+  }
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::RunWorkStealingWorker(
+    ExecutorState* state, std::shared_ptr<WorkStealingQueue> queue,
+    int shard) {
+  profiler::TraceMe activity("ExecutorState::RunWorkStealingWorker",
+                             profiler::TraceMeLevel::kVerbose);
+  WorkStealingWorkerScope scope(queue.get(), shard);
+  do {
+    while (absl::optional<typename WorkStealingQueue::Item> item =
+               queue->Pop(shard)) {
+      // `state` is alive while `item->node` is outstanding.
+      state->Process(item->node, item->scheduled_nsec);
+    }
+    queue->RemoveWorker();
+    // A concurrent `ScheduleReadyWorkStealing()` may have pushed a node after
+    // the last `Pop()` without starting a worker, so re-check before exiting.
+  } while (queue->HasItems() && queue->TryAddWorker());
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleFinish() {
   // Checks condition to decide if needs to invoke Finish(). If there are
@@ -1484,15 +1849,16 @@ void ExecutorState<PropagatorStateType>::Finish() {
 
 void ExecutorImpl::RunAsync(const Args& args, DoneCallback done) {
   if (OpOrderDeterminismRequired()) {
-    (new ExecutorState<OrderedPropagatorState>(args, immutable_state_,
-                                               &kernel_stats_))
+    (new ExecutorState<OrderedPropagatorState>(
+         args, immutable_state_, &kernel_stats_, use_work_stealing_))
         ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        use_work_stealing_))
         ->RunAsync(std::move(done));
   } else {
-    (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+    (new ExecutorState<SimplePropagatorState>(
+         args, immutable_state_, &kernel_stats_, use_work_stealing_))
         ->RunAsync(std::move(done));
   }
 }
@@ -1531,6 +1897,8 @@ class DefaultExecutorRegistrar {
     Factory* factory = new Factory;
     ExecutorFactory::Register("", factory);
     ExecutorFactory::Register("DEFAULT", factory);
+    ExecutorFactory::Register("WORK_STEALING_EXECUTOR",
+                              new WorkStealingFactory);
   }
 
  private:
@@ -1543,6 +1911,19 @@ class DefaultExecutorRegistrar {
       return OkStatus();
     }
   };
+
+  // Creates executors that schedule expensive nodes through per-worker
+  // work-stealing queues. See `WorkStealingReadyQueue`.
+  class WorkStealingFactory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      auto impl =
+          std::make_unique<ExecutorImpl>(params, /*use_work_stealing=*/true);
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return OkStatus();
+    }
+  };
 };
 static DefaultExecutorRegistrar registrar;
 
@@ -30,12 +30,14 @@ limitations under the License.
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/threadpool_interface.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/util/managed_stack_trace.h"
 
 namespace tensorflow {
 
+class StepArenaAllocator;
 class StepStatsCollector;
 
 // Executor runs a graph computation.
@@ -123,6 +125,27 @@ class Executor {
     // If true, all kernels will be treated as "inexpensive", and hence executed
     // on the scheduling thread.
     bool run_all_kernels_inline = false;
+
+    // If not null, allocations made by kernels from the device's default
+    // allocator during this step are served by this arena instead.
+    StepArenaAllocator* step_arena_allocator = nullptr;
+
+    // If not null and `step_arena_allocator` is null, allocations made by
+    // kernels from the device's default allocator during this step are served
+    // by this allocator instead (e.g. a DeviceGraphCaptureAllocator).
+    Allocator* default_allocator_override = nullptr;
+
+    // A buffer that the output `output_slot` of the synchronous kernel of node
+    // `node_id` is allocated in, if the kernel calls `allocate_output()` with
+    // the dtype and number of elements of `tensor`.
+    struct PreallocatedOutput {
+      int node_id;
+      int output_slot;
+      const Tensor* tensor;  // Not owned.
+    };
+    // Sorted by `node_id`. The tensors must stay alive, and their buffers must
+    // not be accessed by the caller, until the step is done.
+    gtl::ArraySlice<PreallocatedOutput> preallocated_outputs;
   };
   typedef std::function<void(const Status&)> DoneCallback;
   virtual void RunAsync(const Args& args, DoneCallback done) = 0;
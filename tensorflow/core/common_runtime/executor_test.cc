@@ -25,8 +25,10 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/common_runtime/kernel_cost_estimates.h"
 #include "tensorflow/core/common_runtime/lower_functional_ops.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
@@ -73,10 +75,13 @@ class ExecutorTest : public ::testing::Test {
   }
 
   // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  void Create(std::unique_ptr<const Graph> graph,
+              const string& executor_type = "",
+              KernelCostEstimates* kernel_cost_estimates = nullptr) {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
+    params.kernel_cost_estimates = kernel_cost_estimates;
     params.create_kernel =
         [this, version](const std::shared_ptr<const NodeProperties>& props,
                         OpKernel** kernel) {
@@ -88,7 +93,9 @@ class ExecutorTest : public ::testing::Test {
     };
     rendez_ = NewLocalRendezvous();
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    std::unique_ptr<Executor> exec;
+    TF_CHECK_OK(NewExecutor(executor_type, params, *graph, &exec));
+    exec_ = exec.release();
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
@@ -181,6 +188,41 @@ TEST_F(ExecutorTest, SimpleAdd) {
   EXPECT_EQ(2.0, V(out));  // out = 1.0 + 1.0 = 2.0
 }
 
+TEST_F(ExecutorTest, MeasuredKernelCosts) {
+  KernelCostEstimates estimates;
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Recv(g.get(), "b", "float", ALICE, 1, BOB);
+  auto tmp = test::graph::Add(g.get(), in0, in1);
+  test::graph::Send(g.get(), tmp, "c", BOB, 1, ALICE);
+  const string add_key =
+      KernelCostEstimates::Key(device_->name(), tmp->name(), "Add");
+  const string recv_key =
+      KernelCostEstimates::Key(device_->name(), in0->name(), "_Recv");
+  Create(std::move(g), /*executor_type=*/"", &estimates);
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "b"), args, V(2.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_EQ(3.0, V(out));
+
+  // The estimates are stored when the executor is destroyed.
+  uint64 cycles = 0;
+  EXPECT_FALSE(estimates.Lookup(add_key, &cycles));
+  delete exec_;
+  exec_ = nullptr;
+  ASSERT_TRUE(estimates.Lookup(add_key, &cycles));
+  EXPECT_GT(cycles, 0);
+  // Async kernels are not measured.
+  EXPECT_FALSE(estimates.Lookup(recv_key, &cycles));
+}
+
 TEST_F(ExecutorTest, SelfAdd) {
   // v0 <- a
   // v1 = v0 + v0
@@ -261,6 +303,69 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "WORK_STEALING_EXECUTOR");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
+TEST_F(ExecutorTest, RandomTreeWithControlFlow) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  // An unused Switch makes the executor use the `PropagatorState`.
+  test::graph::Switch(g.get(), test::graph::Constant(g.get(), V(1.0)),
+                      test::graph::Constant(g.get(), VB(false)));
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
+TEST_F(ExecutorTest, DeadFanInWithControlFlow) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Constant(g.get(), VB(true));
+  // Output 0 of the Switch is dead, and so is every node that depends on it.
+  auto dead = test::graph::Switch(g.get(), in0, in1);
+  std::vector<Node*> nodes;
+  for (int i = 0; i < 1024; ++i) {
+    nodes.push_back(test::graph::Identity(g.get(), dead, 0));
+  }
+  while (nodes.size() > 1) {
+    std::vector<Node*> sums;
+    for (int i = 0; i + 1 < nodes.size(); i += 2) {
+      sums.push_back(test::graph::Add(g.get(), nodes[i], nodes[i + 1]));
+    }
+    nodes.swap(sums);
+  }
+  test::graph::Send(g.get(), nodes.back(), "c", BOB, 1, ALICE);
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_TRUE(is_dead);
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -298,6 +403,25 @@ TEST_F(ExecutorTest, ConcurrentAddAssign) {
 }
 #endif
 
+#ifndef THREAD_SANITIZER
+TEST_F(ExecutorTest, ConcurrentAddAssignWorkStealing) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildConcurrentAddAssign(g.get());
+  Create(std::move(g), "WORK_STEALING_EXECUTOR");
+  for (int iters = 0; iters < 16; ++iters) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    TF_ASSERT_OK(Run(rendez));
+    Rendezvous::Args args;
+    Tensor out;
+    bool is_dead;
+    TF_ASSERT_OK(rendez->Recv(Key(ALICE, kIncarnation, BOB, "out"), args, &out,
+                              &is_dead));
+    EXPECT_LE(V(out), 1025.0);
+    rendez->Unref();
+  }
+}
+#endif
+
 TEST_F(ExecutorTest, SimpleSwitchLive) {
   auto g = std::make_unique<Graph>(OpRegistry::Global());
   auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
@@ -438,7 +562,8 @@ TEST_F(ExecutorTest, NoInputTensors) {
 // Create a graph that is 'depth' deep. At each level, fan-in and fan-out a
 // maximum of 'width' nodes. All nodes are no-ops and all dependencies are
 // control dependencies.
-static void BM_executor(::testing::benchmark::State& state) {
+static void BM_executor_helper(::testing::benchmark::State& state,
+                               const char* executor_type) {
   const int width = state.range(0);
   const int depth = state.range(1);
 
@@ -472,12 +597,23 @@ static void BM_executor(::testing::benchmark::State& state) {
   }
 
   FixupSourceAndSinkEdges(g);
-  test::Benchmark("cpu", g, /*old_benchmark_api=*/false).Run(state);
+  test::Benchmark("cpu", g, /*options=*/nullptr, /*init=*/nullptr,
+                  /*rendez=*/nullptr, executor_type,
+                  /*old_benchmark_api=*/false)
+      .Run(state);
 
   state.SetLabel(strings::StrCat("Nodes = ", cur));
   state.SetItemsProcessed(cur * static_cast<int64_t>(state.iterations()));
 }
 
+static void BM_executor(::testing::benchmark::State& state) {
+  BM_executor_helper(state, "");
+}
+
+static void BM_executor_work_stealing(::testing::benchmark::State& state) {
+  BM_executor_helper(state, "WORK_STEALING_EXECUTOR");
+}
+
 // Tall skinny graphs
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(16, 1024);
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(32, 8192);
@@ -489,6 +625,58 @@ BENCHMARK(BM_executor)->UseRealTime()->ArgPair(8192, 32);
 // Tall fat graph
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(1024, 1024);
 
+BENCHMARK(BM_executor_work_stealing)->UseRealTime()->ArgPair(16, 1024);
+BENCHMARK(BM_executor_work_stealing)->UseRealTime()->ArgPair(32, 8192);
+BENCHMARK(BM_executor_work_stealing)->UseRealTime()->ArgPair(1024, 16);
+BENCHMARK(BM_executor_work_stealing)->UseRealTime()->ArgPair(8192, 32);
+BENCHMARK(BM_executor_work_stealing)->UseRealTime()->ArgPair(1024, 1024);
+
+// Create a graph with `depth` layers of `width` no-ops each, where every
+// no-op of a layer depends on a single node that fans in the previous layer.
+// The graph contains a Switch, so the executor uses the `PropagatorState`.
+// The inter-op thread pool has `threads` threads.
+static void BM_executor_control_flow_fan_in(
+    ::testing::benchmark::State& state) {
+  const int threads = state.range(0);
+  const int width = state.range(1);
+  constexpr int kDepth = 8;
+
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Switch(g, test::graph::Constant(g, V(1.0)),
+                      test::graph::Constant(g, VB(false)));
+  Node* fan_in = test::graph::NoOp(g, {});
+  int64_t cur = 1;
+  for (int i = 0; i < kDepth; ++i) {
+    std::vector<Node*> layer;
+    layer.reserve(width);
+    for (int j = 0; j < width; ++j) {
+      layer.push_back(test::graph::NoOp(g, {fan_in}));
+    }
+    fan_in = test::graph::NoOp(g, layer);
+    cur += width + 1;
+  }
+
+  FixupSourceAndSinkEdges(g);
+  SessionOptions options;
+  options.config.set_inter_op_parallelism_threads(threads);
+  test::Benchmark("cpu", g, &options, /*init=*/nullptr, /*rendez=*/nullptr,
+                  /*executor_type=*/"", /*old_benchmark_api=*/false)
+      .Run(state);
+
+  state.SetLabel(strings::StrCat("Nodes = ", cur));
+  state.SetItemsProcessed(cur * static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_executor_control_flow_fan_in)
+    ->UseRealTime()
+    ->ArgPair(8, 1024)
+    ->ArgPair(16, 1024)
+    ->ArgPair(32, 1024)
+    ->ArgPair(64, 1024)
+    ->ArgPair(128, 1024)
+    ->ArgPair(8, 8192)
+    ->ArgPair(128, 8192);
+
 static void BM_const_identity(::testing::benchmark::State& state) {
   const int width = state.range(0);
   const int outputs_per_const = state.range(1);
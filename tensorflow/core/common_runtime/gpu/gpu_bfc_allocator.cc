@@ -95,6 +95,9 @@ GPUBFCAllocator::GPUBFCAllocator(
           o.garbage_collection = GetGarbageCollectionValue();
         }
         o.fragmentation_fraction = opts.fragmentation_fraction;
+        o.stream_ordered = opts.stream_ordered;
+        o.segregate_size_classes = opts.segregate_size_classes;
+        o.compaction_interval_micros = opts.compaction_interval_micros;
         return o;
       }()) {}
 
@@ -46,6 +46,9 @@ class GPUBFCAllocator : public tsl::BFCAllocator {
 
     double fragmentation_fraction = 0;
     bool allow_retry_on_failure = true;
+    bool stream_ordered = false;
+    bool segregate_size_classes = false;
+    int64_t compaction_interval_micros = 0;
   };
 
   GPUBFCAllocator(std::unique_ptr<tsl::SubAllocator> sub_allocator,
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/tsl/framework/device_id.h"
 #include "tensorflow/tsl/lib/gtl/inlined_vector.h"
 #include "tensorflow/tsl/lib/random/simple_philox.h"
+#include "tensorflow/tsl/platform/blocking_counter.h"
 #include "tensorflow/tsl/platform/logging.h"
 #include "tensorflow/tsl/platform/strcat.h"
 #include "tensorflow/tsl/platform/test.h"
@@ -232,6 +233,118 @@ TEST_P(GPUBFCAllocatorTest, ExerciseCoalescing) {
   a.DeallocateRaw(first_ptr_after);
 }
 
+TEST_P(GPUBFCAllocatorTest, StreamOrdered) {
+  GPUBFCAllocator::Options options;
+  options.stream_ordered = true;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", options);
+
+  // A chunk without other stream uses is reused as soon as it is freed.
+  void* p1 = a.AllocateRaw(1, 4096);
+  a.DeallocateRaw(p1);
+  void* p2 = a.AllocateRaw(1, 4096);
+  EXPECT_EQ(p1, p2);
+
+  // A chunk used by another stream stays allocated until the use completes.
+  const int64_t use_id = a.RecordStreamUse(p2);
+  EXPECT_GT(use_id, 0);
+  a.DeallocateRaw(p2);
+  void* p3 = a.AllocateRaw(1, 4096);
+  EXPECT_NE(p2, p3);
+  a.CompleteStreamUse(use_id);
+  void* p4 = a.AllocateRaw(1, 4096);
+  EXPECT_EQ(p2, p4);
+
+  // Pointers inside of a chunk are not tracked.
+  EXPECT_EQ(a.RecordStreamUse(static_cast<char*>(p4) + 256), 0);
+
+  // A use that completes before the chunk is freed does not delay its reuse.
+  const int64_t early_use_id = a.RecordStreamUse(p4);
+  a.CompleteStreamUse(early_use_id);
+  a.DeallocateRaw(p4);
+  void* p5 = a.AllocateRaw(1, 4096);
+  EXPECT_EQ(p4, p5);
+  a.DeallocateRaw(p3);
+  a.DeallocateRaw(p5);
+  CheckStats(&a, 5, 0, 8192, 4096);
+}
+
+TEST_P(GPUBFCAllocatorTest, StreamUsesAreNotTrackedByDefault) {
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", {});
+  void* p = a.AllocateRaw(1, 4096);
+  EXPECT_EQ(a.RecordStreamUse(p), 0);
+  a.DeallocateRaw(p);
+}
+
+TEST_P(GPUBFCAllocatorTest, SegregatedSizeClasses) {
+  GPUBFCAllocator::Options options;
+  options.allow_growth = true;
+  options.garbage_collection = true;
+  options.segregate_size_classes = true;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", options);
+
+  // The medium allocation gets a 2MiB region, and the small one does not use
+  // its remaining free space.
+  void* medium = a.AllocateRaw(1, 1 << 20);
+  void* small = a.AllocateRaw(1, 4096);
+  EXPECT_EQ(*a.GetStats()->pool_bytes, 4 << 20);
+  const char* medium_begin = static_cast<char*>(medium);
+  EXPECT_TRUE(static_cast<char*>(small) < medium_begin ||
+              static_cast<char*>(small) >= medium_begin + (2 << 20));
+  // Small allocations share the small region.
+  void* small2 = a.AllocateRaw(1, 4096);
+  EXPECT_EQ(*a.GetStats()->pool_bytes, 4 << 20);
+
+  a.DeallocateRaw(medium);
+  a.DeallocateRaw(small);
+  EXPECT_EQ(a.GetStats()->largest_free_block_bytes, 2 << 20);
+
+  // Regions are released once they have been free for a whole compaction.
+  a.Compact();
+  EXPECT_EQ(*a.GetStats()->pool_bytes, 4 << 20);
+  a.Compact();
+  EXPECT_EQ(*a.GetStats()->pool_bytes, 2 << 20);
+  a.DeallocateRaw(small2);
+  a.Compact();
+  a.Compact();
+  EXPECT_EQ(*a.GetStats()->pool_bytes, 0);
+}
+
+TEST_P(GPUBFCAllocatorTest, BackgroundCompaction) {
+  GPUBFCAllocator::Options options;
+  options.compaction_interval_micros = 1000;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", options);
+  void* p = a.AllocateRaw(1, 4096);
+  Env::Default()->SleepForMicroseconds(5000);
+  a.DeallocateRaw(p);
+  CheckStats(&a, 1, 0, 4096, 4096);
+}
+
+TEST_P(GPUBFCAllocatorTest, ThreadCache) {
+  GPUBFCAllocator::Options options;
+  options.thread_cache_bytes = 1 << 20;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 20, "GPU_0_bfc", options);
+
+  // A freed chunk is kept by the thread cache, and reused for an allocation
+  // of the same rounded size.
+  void* p1 = a.AllocateRaw(1, 1024);
+  a.DeallocateRaw(p1);
+  EXPECT_EQ(a.GetStats()->bytes_in_use, 1024);
+  void* p2 = a.AllocateRaw(1, 1000);
+  EXPECT_EQ(p1, p2);
+  a.DeallocateRaw(p2);
+
+  // The caches are flushed when the bins cannot satisfy an allocation.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 15; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, 64 << 10));
+    ASSERT_NE(ptrs.back(), nullptr);
+  }
+  for (void* p : ptrs) a.DeallocateRaw(p);
+  void* large = a.AllocateRaw(1, 512 << 10);
+  EXPECT_NE(large, nullptr);
+  a.DeallocateRaw(large);
+}
+
 TEST_P(GPUBFCAllocatorTest, AllocateZeroBufSize) {
   GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", {});
   float* ptr = TypedAllocator::Allocate<float>(&a, 0, {});
@@ -401,6 +514,40 @@ static void BM_AllocationThreaded(::testing::benchmark::State& state) {
 
 BENCHMARK(BM_AllocationThreaded)->Arg(1)->Arg(4)->Arg(16);
 
+// Small allocations from many threads, with and without thread caches.
+static void BM_AllocationContended(::testing::benchmark::State& state) {
+  const int num_threads = state.range(0);
+  GPUBFCAllocator::Options options;
+  options.thread_cache_bytes = state.range(1);
+  GPUBFCAllocator a(CreateSubAllocator(1ul << 36), 1uLL << 33, "GPU_0_bfc",
+                    options);
+  thread::ThreadPool pool(Env::Default(), "test", num_threads);
+  constexpr int kItersPerThread = 1000;
+
+  for (auto s : state) {
+    BlockingCounter counter(num_threads);
+    for (int t = 0; t < num_threads; t++) {
+      pool.Schedule([&a, &counter]() {
+        const std::vector<int> sizes = {256, 1024, 4096, 512, 16384};
+        for (int i = 0; i < kItersPerThread; i++) {
+          void* p = a.AllocateRaw(1, sizes[i % sizes.size()]);
+          a.DeallocateRaw(p);
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * num_threads * kItersPerThread);
+}
+
+BENCHMARK(BM_AllocationContended)
+    ->ArgPair(1, 0)
+    ->ArgPair(16, 0)
+    ->ArgPair(16, 1 << 20)
+    ->ArgPair(64, 0)
+    ->ArgPair(64, 1 << 20);
+
 // A more complex benchmark that defers deallocation of an object for
 // "delay" allocations.
 static void BM_AllocationDelayed(::testing::benchmark::State& state) {
@@ -633,6 +780,33 @@ TEST_F(GPUBFCAllocatorTest_SubAllocatorSpecific,
   void* big_alloc = a.AllocateRaw(1, k512MiB - size);
   EXPECT_NE(big_alloc, nullptr);
 }
+
+TEST_F(GPUBFCAllocatorTest_SubAllocatorSpecific,
+       VirtualAllocatorReleasesIdleTailMemory) {
+  GPUBFCAllocator::Options options;
+  options.allow_growth = true;
+  options.garbage_collection = true;
+  GPUBFCAllocator a(CreateVirtualMemorySubAllocator(1ull << 32), 1 << 30,
+                    "GPU_0_bfc", options);
+
+  // The second allocation extends the first 2MiB region by 4MiB.
+  void* first = a.AllocateRaw(1, 1 << 20);
+  void* second = a.AllocateRaw(1, 4 << 20);
+  EXPECT_EQ(*a.GetStats()->pool_bytes, 6 << 20);
+  a.DeallocateRaw(second);
+
+  // The extension is unmapped once it has been free for a whole compaction.
+  a.Compact();
+  EXPECT_EQ(*a.GetStats()->pool_bytes, 6 << 20);
+  a.Compact();
+  EXPECT_EQ(*a.GetStats()->pool_bytes, 2 << 20);
+
+  // The region grows back into the same addresses.
+  void* third = a.AllocateRaw(1, 4 << 20);
+  EXPECT_EQ(third, second);
+  a.DeallocateRaw(third);
+  a.DeallocateRaw(first);
+}
 #endif
 
 TEST_F(GPUBFCAllocatorTest_SubAllocatorSpecific,
@@ -34,6 +34,7 @@ limitations under the License.
 #include <tuple>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_split.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -44,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/common_runtime/local_device.h"
@@ -52,6 +54,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
 #include "tensorflow/core/graph/types.h"
@@ -231,6 +234,117 @@ class EigenGpuStreamDevice : public ::Eigen::StreamInterface {
   TF_DISALLOW_COPY_AND_ASSIGN(EigenGpuStreamDevice);
 };
 
+namespace {
+
+// The compute stream of the kernel being run by the current thread, if the
+// kernel's device has several compute streams.
+thread_local se::Stream* current_compute_stream = nullptr;
+
+// Sets `current_compute_stream` while an op is being run.
+class ScopedComputeStream {
+ public:
+  explicit ScopedComputeStream(se::Stream* stream)
+      : saved_(current_compute_stream) {
+    current_compute_stream = stream;
+  }
+  ~ScopedComputeStream() { current_compute_stream = saved_; }
+
+ private:
+  se::Stream* const saved_;
+};
+
+// Wraps the allocator of a GPU device that runs kernels on several compute
+// streams. A deallocated buffer may still be used by the kernels queued on the
+// compute stream that allocated it, so it is returned to the wrapped
+// allocator only once that stream has reached the deallocation. Buffers that
+// are not allocated by a kernel belong to `default_stream`.
+class StreamAwareGPUAllocator : public Allocator {
+ public:
+  StreamAwareGPUAllocator(Allocator* wrapped, EventMgr* em,
+                          se::Stream* default_stream)
+      : wrapped_(wrapped), em_(em), default_stream_(default_stream) {}
+
+  std::string Name() override { return wrapped_->Name(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return Record(wrapped_->AllocateRaw(alignment, num_bytes));
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    return Record(wrapped_->AllocateRaw(alignment, num_bytes, allocation_attr));
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    se::Stream* stream;
+    {
+      mutex_lock l(mu_);
+      auto it = streams_.find(ptr);
+      DCHECK(it != streams_.end());
+      stream = it == streams_.end() ? default_stream_ : it->second;
+      if (it != streams_.end()) streams_.erase(it);
+    }
+    Allocator* wrapped = wrapped_;
+    em_->ThenExecute(stream, [wrapped, ptr]() { wrapped->DeallocateRaw(ptr); });
+  }
+
+  bool TracksAllocationSizes() const override {
+    return wrapped_->TracksAllocationSizes();
+  }
+  size_t RequestedSize(const void* ptr) const override {
+    return wrapped_->RequestedSize(ptr);
+  }
+  size_t AllocatedSize(const void* ptr) const override {
+    return wrapped_->AllocatedSize(ptr);
+  }
+  int64_t AllocationId(const void* ptr) const override {
+    return wrapped_->AllocationId(ptr);
+  }
+  absl::optional<AllocatorStats> GetStats() override {
+    return wrapped_->GetStats();
+  }
+  bool ClearStats() override { return wrapped_->ClearStats(); }
+  AllocatorMemoryType GetMemoryType() const override {
+    return wrapped_->GetMemoryType();
+  }
+
+ private:
+  void* Record(void* ptr) {
+    if (ptr != nullptr) {
+      mutex_lock l(mu_);
+      streams_[ptr] = current_compute_stream != nullptr
+                          ? current_compute_stream
+                          : default_stream_;
+    }
+    return ptr;
+  }
+
+  Allocator* const wrapped_;    // Not owned.
+  EventMgr* const em_;          // Not owned.
+  se::Stream* default_stream_;  // Not owned.
+  mutex mu_;
+  absl::flat_hash_map<void*, se::Stream*> streams_ TF_GUARDED_BY(mu_);
+};
+
+// Keeps the inputs of the kernel run by `context` alive until `stream` has
+// finished with them. Their buffers are otherwise only fenced against the
+// streams that allocated them.
+void HoldInputsUntilStreamDone(EventMgr* em, se::Stream* stream,
+                               OpKernelContext* context) {
+  gtl::InlinedVector<TensorReference, 4> inputs;
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    if (context->has_input(i) && !context->input_is_ref(i)) {
+      inputs.push_back(TensorReference(context->input(i)));
+    }
+  }
+  if (inputs.empty()) return;
+  em->ThenExecute(stream, [inputs]() {
+    for (const auto& ref : inputs) ref.Unref();
+  });
+}
+
+}  // namespace
+
 // This factory helps to ensure that different GPU device objects that refer to
 // the same physical device and stream group id use the same stream group
 // object (and therefore the same CUDA streams). This is necessary since there
@@ -415,6 +529,9 @@ BaseGPUDevice::~BaseGPUDevice() {
   delete accelerator_device_info_;
   if (scratch_) gpu_allocator_->DeallocateRaw(scratch_);
   device_context_->Unref();
+  for (int i = 1; i < compute_stream_contexts_.size(); ++i) {
+    compute_stream_contexts_[i]->Unref();
+  }
 }
 
 // This should be idempotent if already initialized.
@@ -422,7 +539,11 @@ Status BaseGPUDevice::InitScratchBuffers() {
   mutex_lock l(scratch_init_mutex_);
   if (!scratch_) {
     DCHECK(stream_);
-    size_t scratch_buffer_size = Eigen::kGpuScratchSize + sizeof(unsigned int);
+    // Each compute stream gets its own scratch buffer.
+    const int num_streams =
+        std::max<int>(1, compute_stream_groups_.size());
+    size_t scratch_buffer_size =
+        num_streams * (Eigen::kGpuScratchSize + sizeof(unsigned int));
     profiler::ScopedMemoryDebugAnnotation op_annotation("ScratchBuffer");
     void* scratch_buffer = gpu_allocator_->AllocateRaw(
         Allocator::kAllocatorAlignment, scratch_buffer_size);
@@ -433,8 +554,8 @@ Status BaseGPUDevice::InitScratchBuffers() {
     }
     se::DeviceMemory<char> mem(
         se::DeviceMemoryBase(scratch_buffer, scratch_buffer_size));
-    TF_RETURN_IF_ERROR(executor_->SynchronousMemZero(
-        &mem, Eigen::kGpuScratchSize + sizeof(unsigned int)));
+    TF_RETURN_IF_ERROR(
+        executor_->SynchronousMemZero(&mem, scratch_buffer_size));
     scratch_ = static_cast<char*>(scratch_buffer);
   }
   return OkStatus();
@@ -470,6 +591,15 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
   em_ = EventMgrFactory::Singleton()->GetEventMgr(executor_,
                                                   options.config.gpu_options());
 
+  int num_compute_streams =
+      options.config.gpu_options().experimental().num_compute_streams();
+  if (num_compute_streams < 1) num_compute_streams = 1;
+  if (num_compute_streams > 8) {
+    LOG(ERROR) << "Illegal GPUOptions.experimental.num_compute_streams="
+               << num_compute_streams << " set to 1 instead.";
+    num_compute_streams = 1;
+  }
+
   GPUKernelTracker::Params tracker_params(
       options.config.gpu_options().experimental().kernel_tracker_max_interval(),
       options.config.gpu_options().experimental().kernel_tracker_max_bytes(),
@@ -493,6 +623,36 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
     kernel_tracker_.reset(new GPUKernelTracker(
         tracker_params, Env::Default(), stream_->compute, timing_counter,
         timestamped_allocator_ ? gpu_allocator_ : nullptr, em_));
+    if (num_compute_streams > 1) {
+      LOG(WARNING) << "GPUOptions.experimental.num_compute_streams="
+                   << num_compute_streams
+                   << " is not supported together with the GPU kernel "
+                      "tracker or the timestamped allocator; using a single "
+                      "compute stream.";
+      num_compute_streams = 1;
+    }
+  }
+
+  if (num_compute_streams > 1) {
+    compute_stream_groups_.push_back(stream_);
+    compute_stream_contexts_.push_back(device_context_);
+    for (int i = 1; i < num_compute_streams; ++i) {
+      StreamGroup* group = StreamGroupFactory::Global().GetOrCreate(
+          tf_device_id_, i, executor_, options.config.gpu_options());
+      compute_stream_groups_.push_back(group);
+      compute_stream_contexts_.push_back(
+          new GPUDeviceContext(i, group->compute,
+#if TENSORFLOW_USE_ROCM
+                               group->nccl,
+#endif
+                               group->host_to_device, group->device_to_host,
+                               group->device_to_device, host_memory_allocator));
+    }
+    stream_aware_allocator_ = std::make_unique<StreamAwareGPUAllocator>(
+        gpu_allocator_, em_, stream_->compute);
+    gpu_allocator_ = stream_aware_allocator_.get();
+    VLOG(1) << "Using " << num_compute_streams << " compute streams on "
+            << name();
   }
 
   accelerator_device_info_ = new DeviceBase::AcceleratorDeviceInfo;
@@ -503,6 +663,19 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
   TF_RETURN_IF_ERROR(
       GpuIdManager::TfToPlatformDeviceId(tf_device_id_, &platform_device_id));
   accelerator_device_info_->gpu_id = platform_device_id.value();
+  const double tensor_swapping_memory_fraction =
+      options.config.gpu_options()
+          .experimental()
+          .tensor_swapping_memory_fraction();
+  if (tensor_swapping_memory_fraction > 1) {
+    LOG(ERROR) << "Illegal GPUOptions.experimental."
+                  "tensor_swapping_memory_fraction="
+               << tensor_swapping_memory_fraction
+               << "; tensor swapping is disabled.";
+  } else if (tensor_swapping_memory_fraction > 0) {
+    accelerator_device_info_->tensor_swapping_memory_fraction =
+        tensor_swapping_memory_fraction;
+  }
   set_tensorflow_accelerator_device_info(accelerator_device_info_);
 
   // Whether and how the GPU device uses its own threadpool.
@@ -692,7 +865,16 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
     LogInputs(op_kernel, context);
   }
 
-  op_kernel->Compute(context);
+  for (se::Stream* wait_stream : gpu_device_context->wait_streams()) {
+    stream->ThenWaitFor(wait_stream);
+  }
+  if (!compute_stream_groups_.empty()) {
+    ScopedComputeStream scoped_compute_stream(stream);
+    op_kernel->Compute(context);
+    HoldInputsUntilStreamDone(em_, stream, context);
+  } else {
+    op_kernel->Compute(context);
+  }
 
   if (should_log_inputs_and_outputs) {
     LogOutputs(op_kernel, context);
@@ -747,7 +929,62 @@ Status BaseGPUDevice::Sync() {
   // enqueued the operation has completed.  We do use other streams for copies
   // and collectives, but in those cases the (Async)OpKernels themselves block
   // until the queued operation has finished.
-  return stream_->compute->BlockHostUntilDone();
+  if (compute_stream_groups_.empty()) {
+    return stream_->compute->BlockHostUntilDone();
+  }
+  for (StreamGroup* group : compute_stream_groups_) {
+    TF_RETURN_IF_ERROR(group->compute->BlockHostUntilDone());
+  }
+  return OkStatus();
+}
+
+Status BaseGPUDevice::FillContextMap(
+    const Graph* graph, std::vector<DeviceContext*>* device_context_map) {
+  if (compute_stream_contexts_.size() <= 1) return OkStatus();
+
+  std::vector<int> node_to_stream;
+  TF_RETURN_IF_ERROR(gpu_stream_util::AssignStreams(
+      graph, compute_stream_contexts_.size(), &node_to_stream));
+  auto stream_of = [&node_to_stream](const Node* n) {
+    return std::max(node_to_stream[n->id()], 0);
+  };
+
+  device_context_map->resize(graph->num_node_ids());
+  for (const Node* n : graph->op_nodes()) {
+    const int stream_id = stream_of(n);
+    // Wait for the other compute streams that ran producers of `n`, including
+    // producers that `n` only has a control dependency on.
+    gtl::InlinedVector<se::Stream*, 2> wait_streams;
+    for (const Edge* e : n->in_edges()) {
+      const Node* src = e->src();
+      if (!src->IsOp() || node_to_stream[src->id()] < 0) continue;
+      const int src_stream_id = stream_of(src);
+      if (src_stream_id == stream_id) continue;
+      se::Stream* wait_stream =
+          compute_stream_groups_[src_stream_id]->compute;
+      if (std::find(wait_streams.begin(), wait_streams.end(), wait_stream) ==
+          wait_streams.end()) {
+        wait_streams.push_back(wait_stream);
+      }
+    }
+
+    GPUDeviceContext* context = compute_stream_contexts_[stream_id];
+    if (wait_streams.empty()) {
+      context->Ref();
+    } else {
+      const StreamGroup* group = compute_stream_groups_[stream_id];
+      context = new GPUDeviceContext(
+          stream_id, group->compute,
+#if TENSORFLOW_USE_ROCM
+          group->nccl,
+#endif
+          group->host_to_device, group->device_to_host,
+          group->device_to_device, context->host_memory_allocator(),
+          std::move(wait_streams));
+    }
+    (*device_context_map)[n->id()] = context;
+  }
+  return OkStatus();
 }
 
 void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
@@ -778,6 +1015,19 @@ void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
   }
 
   ScopedActivateExecutorContext scoped_activation{stream->parent()};
+  for (se::Stream* wait_stream : gpu_device_context->wait_streams()) {
+    stream->ThenWaitFor(wait_stream);
+  }
+  if (!compute_stream_groups_.empty()) {
+    AsyncOpKernel::DoneCallback parent_done = std::move(done);
+    done = [this, stream, context, parent_done = std::move(parent_done)]() {
+      HoldInputsUntilStreamDone(em_, stream, context);
+      parent_done();
+    };
+    ScopedComputeStream scoped_compute_stream(stream);
+    op_kernel->ComputeAsync(context, std::move(done));
+    return;
+  }
   op_kernel->ComputeAsync(context, std::move(done));
 }
 
@@ -1172,11 +1422,19 @@ void BaseGPUDevice::ReinitializeDevice(OpKernelContext* context,
   ConcretePerOpGpuDevice* concrete_device =
       static_cast<ConcretePerOpGpuDevice*>(device);
   DCHECK(concrete_device);
-  DCHECK_EQ(stream_id, 0);
+  se::Stream* compute = stream_->compute;
+  char* scratch = scratch_;
+  if (!compute_stream_groups_.empty()) {
+    DCHECK_LT(stream_id, compute_stream_groups_.size());
+    compute = compute_stream_groups_[stream_id]->compute;
+    scratch += stream_id * (Eigen::kGpuScratchSize + sizeof(unsigned int));
+  } else {
+    DCHECK_EQ(stream_id, 0);
+  }
   const gpuStream_t* gpu_stream = reinterpret_cast<const gpuStream_t*>(
-      stream_->compute->implementation()->GpuStreamMemberHack());
+      compute->implementation()->GpuStreamMemberHack());
   concrete_device->Reinitialize(context, gpu_stream, tf_device_id_, allocator,
-                                scratch_);
+                                scratch);
 }
 
 PerOpGpuDevice* BaseGPUDevice::MakeGpuDevice() {
@@ -1193,7 +1451,6 @@ Status BaseGPUDevice::ReinitializeGpuDevice(OpKernelContext* context,
     const int stream_id = gpu_dc->stream_id();
     VLOG(1) << "  eigen_gpu_device(" << dc << ") => stream[" << stream_id
             << "]";
-    CHECK_EQ(stream_id, 0);
     ReinitializeDevice(context, device, stream_id, allocator);
   } else {
     ReinitializeDevice(context, device, 0, allocator);
@@ -92,6 +92,12 @@ class BaseGPUDevice : public LocalDevice {
 
   Status Sync() override;
 
+  // Assigns the nodes of `graph` to the compute streams of this device if
+  // `GPUOptions.Experimental.num_compute_streams` is greater than 1.
+  Status FillContextMap(
+      const Graph* graph,
+      std::vector<DeviceContext*>* device_context_map) override;
+
   void ComputeAsync(AsyncOpKernel* op_kernel, OpKernelContext* context,
                     AsyncOpKernel::DoneCallback done) override;
 
@@ -176,6 +182,16 @@ class BaseGPUDevice : public LocalDevice {
   class StreamGroupFactory;
 
   StreamGroup* stream_;
+  // The stream groups and device contexts of the compute streams of this
+  // device, starting with `stream_` and `device_context_`, if
+  // `GPUOptions.Experimental.num_compute_streams` is greater than 1. Empty
+  // otherwise.
+  gtl::InlinedVector<StreamGroup*, 4> compute_stream_groups_;
+  gtl::InlinedVector<GPUDeviceContext*, 4> compute_stream_contexts_;
+  // Defers the deallocation of buffers until their compute stream is done
+  // with them, if there are several compute streams. Replaces
+  // `gpu_allocator_`.
+  std::unique_ptr<Allocator> stream_aware_allocator_;
   mutex scratch_init_mutex_;
   char* scratch_ = nullptr;
   GPUDeviceContext* device_context_;
@@ -556,6 +556,67 @@ TEST_F(GPUDeviceTest, CopyTensorInSameDevice) {
   }
 }
 
+TEST_F(GPUDeviceTest, CopyLargeUnpinnedTensorToGPU) {
+  SessionOptions opts = MakeSessionOptions("0");
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+  Device* device = devices[0].get();
+  auto* device_info = device->tensorflow_accelerator_device_info();
+  CHECK(device_info);
+  DeviceContext* device_context = device_info->default_context;
+  Allocator* allocator = device->GetAllocator(AllocatorAttributes());
+
+  // Large enough to be staged through several pinned chunks, and not a
+  // multiple of the chunk size.
+  constexpr int kNumElements = (10 << 20) + 3;
+  Tensor cpu_tensor(cpu_allocator(), DT_FLOAT, TensorShape({kNumElements}));
+  auto input = cpu_tensor.tensor<float, 1>();
+  for (int i = 0; i < kNumElements; ++i) {
+    input(i) = i;
+  }
+  Tensor gpu_tensor(allocator, DT_FLOAT, TensorShape({kNumElements}));
+  CopyCPUToGPU(&cpu_tensor, &gpu_tensor, device, device_context);
+
+  Tensor output_cpu_tensor(cpu_allocator(), DT_FLOAT,
+                           TensorShape({kNumElements}));
+  CopyGPUToCPU(&gpu_tensor, &output_cpu_tensor, device, device_context);
+  auto output = output_cpu_tensor.tensor<float, 1>();
+  for (int i = 0; i < kNumElements; ++i) {
+    ASSERT_EQ(input(i), output(i)) << " for index " << i;
+  }
+}
+
+TEST_F(GPUDeviceTest, ExportGPUTensor) {
+  SessionOptions opts = MakeSessionOptions("0");
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+  Allocator* allocator = devices[0]->GetAllocator(AllocatorAttributes());
+  Tensor first(allocator, DT_FLOAT, TensorShape({1024}));
+  Tensor second(allocator, DT_FLOAT, TensorShape({2, 512}));
+
+  // Tensors of the same allocator region share its memory handle.
+  GPUTensorIpcHandle first_handle;
+  GPUTensorIpcHandle second_handle;
+  TF_ASSERT_OK(
+      GPUProcessState::singleton()->ExportGPUTensor(first, &first_handle));
+  TF_ASSERT_OK(
+      GPUProcessState::singleton()->ExportGPUTensor(second, &second_handle));
+  EXPECT_EQ(first_handle.memory_handle, second_handle.memory_handle);
+  EXPECT_EQ(second_handle.offset - first_handle.offset,
+            static_cast<char*>(second.data()) -
+                static_cast<char*>(first.data()));
+
+  GPUTensorIpcHandle parsed;
+  ASSERT_TRUE(parsed.ParseFromString(second_handle.SerializeAsString()));
+  EXPECT_EQ(parsed.memory_handle, second_handle.memory_handle);
+  EXPECT_EQ(parsed.offset, second_handle.offset);
+  EXPECT_EQ(parsed.dtype, DT_FLOAT);
+  EXPECT_EQ(parsed.shape, TensorShape({2, 512}));
+  EXPECT_FALSE(parsed.ParseFromString("invalid"));
+}
+
 TEST_F(GPUDeviceTest, DeviceDetails) {
   DeviceFactory* factory = DeviceFactory::GetFactory("GPU");
   std::vector<string> devices;
@@ -0,0 +1,96 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/compiler/xla/stream_executor/cuda/cuda_graph.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_graph_capture.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/stream_executor.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Captures the kernels that a step launches onto the compute stream of a GPU
+// device into a CUDA graph, and replays the instantiated graph on that stream.
+class GPUGraphCapture : public DeviceGraphCapture {
+ public:
+  explicit GPUGraphCapture(se::Stream* stream) : stream_(stream) {}
+
+  Status Capture(const std::function<Status()>& fn) override {
+    if (graph_exec_ != nullptr) {
+      return errors::FailedPrecondition("The step has already been captured");
+    }
+    // The executor launches kernels from its inter-op threads, so the capture
+    // must not be limited to the calling thread.
+    TF_ASSIGN_OR_RETURN(
+        se::gpu::OwnedCudaGraph graph,
+        se::gpu::CaptureCudaGraph(
+            stream_, [&fn]() { return fn(); }, cudaStreamCaptureModeRelaxed));
+    TF_ASSIGN_OR_RETURN(graph_exec_,
+                        se::gpu::InstantiateCudaGraph(std::move(graph)));
+    return OkStatus();
+  }
+
+  Status EnqueueCopy(const Tensor& src, const Tensor& dst) override {
+    const size_t total_bytes = src.TotalBytes();
+    if (total_bytes != dst.TotalBytes()) {
+      return errors::InvalidArgument("Cannot copy ", total_bytes,
+                                     " bytes into a buffer of ",
+                                     dst.TotalBytes(), " bytes");
+    }
+    if (total_bytes == 0 || src.data() == dst.data()) return OkStatus();
+    se::DeviceMemoryBase src_mem(const_cast<void*>(src.data()), total_bytes);
+    se::DeviceMemoryBase dst_mem(const_cast<void*>(dst.data()), total_bytes);
+    stream_->ThenMemcpy(&dst_mem, src_mem, total_bytes);
+    return OkStatus();
+  }
+
+  Status Replay() override {
+    if (graph_exec_ == nullptr) {
+      return errors::FailedPrecondition("The step has not been captured");
+    }
+    return graph_exec_.Launch(stream_);
+  }
+
+ private:
+  se::Stream* const stream_;  // Not owned.
+  se::gpu::OwnedCudaGraphExec graph_exec_;
+};
+
+std::unique_ptr<DeviceGraphCapture> CreateGPUGraphCapture(Device* device) {
+  const DeviceBase::AcceleratorDeviceInfo* info =
+      device->tensorflow_accelerator_device_info();
+  if (info == nullptr || info->stream == nullptr) return nullptr;
+  return std::make_unique<GPUGraphCapture>(info->stream);
+}
+
+DeviceGraphCapture::Registration register_gpu_graph_capture(
+    DEVICE_GPU, CreateGPUGraphCapture);
+
+}  // namespace
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <vector>
@@ -33,8 +34,14 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
 #include "tensorflow/core/common_runtime/pool_allocator.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/log_memory.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/tsl/framework/allocator.h"
 #include "tensorflow/tsl/framework/bfc_allocator.h"
 #include "tensorflow/tsl/framework/device_id.h"
@@ -44,6 +51,11 @@ limitations under the License.
 #include "tensorflow/tsl/platform/types.h"
 #include "tensorflow/tsl/util/env_var.h"
 
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+#include "tensorflow/compiler/xla/stream_executor/gpu/gpu_driver.h"
+#endif
+
 namespace tensorflow {
 
 // NOLINTNEXTLINE(clang-diagnostic-unused-function)
@@ -107,17 +119,16 @@ static std::unique_ptr<SubAllocator> CreateSubAllocator(
                       se::GPUMachineManager(), platform_device_id)
                       .value();
 
-  // FIXME(imintz): Observed OOM issues when using the virtual memory
-  // allocators. This should be reenabled when resolved.
-#if 0 && defined(GOOGLE_CUDA) && CUDA_VERSION >= 10020
+  const bool use_unified_memory =
+      options.per_process_gpu_memory_fraction() > 1.0 ||
+      options.experimental().use_unified_memory();
+  // The virtual memory allocator is opt-in: OOM issues were observed when it
+  // was the default.
+#if defined(GOOGLE_CUDA) && CUDA_VERSION >= 10020
   // Use the old allocator when unified memory is required.
   // TODO(imintz): Remove the cuMemAlloc capability of this allocator.
-  if (options.per_process_gpu_memory_fraction() > 1.0 ||
-      options.experimental().use_unified_memory()) {
-    return new se::DeviceMemAllocator(executor, platform_device_id,
-                                  /*use_unified_memory=*/true, alloc_visitors,
-                                  {});
-  } else {
+  if (options.experimental().use_virtual_memory_allocator() &&
+      !use_unified_memory) {
     auto* gpu_context = reinterpret_cast<stream_executor::gpu::GpuContext*>(
         executor->implementation()->GpuContextHack());
 
@@ -125,7 +136,8 @@ static std::unique_ptr<SubAllocator> CreateSubAllocator(
     platform_peer_gpu_ids.reserve(peer_gpu_ids.size());
     for (const tsl::TfDeviceId tf_device_id : peer_gpu_ids) {
       tsl::PlatformDeviceId platform_device_id;
-      TF_CHECK_OK(GpuIdManager::TfToPlatformDeviceId(tf_device_id, &platform_device_id));
+      TF_CHECK_OK(
+          GpuIdManager::TfToPlatformDeviceId(tf_device_id, &platform_device_id));
       platform_peer_gpu_ids.insert(platform_device_id);
     }
     std::vector<tsl::PlatformDeviceId> platform_peer_gpu_ids_vec(
@@ -136,20 +148,25 @@ static std::unique_ptr<SubAllocator> CreateSubAllocator(
     // collection.
     // TODO(imintz): Update BFC allocator to ensure it doesn't create holes in
     // the va space.
-    return GpuVirtualMemAllocator::Create(
-               alloc_visitors, {}, *gpu_context, platform_device_id,
-               /*virtual_address_space_size=*/total_bytes * 2,
-               platform_peer_gpu_ids_vec)
-        .value()
-        .release();
+    auto allocator = GpuVirtualMemAllocator::Create(
+        alloc_visitors, {}, *gpu_context, platform_device_id,
+        /*virtual_address_space_size=*/total_bytes * 2,
+        platform_peer_gpu_ids_vec);
+    if (allocator.ok()) {
+      return *std::move(allocator);
+    }
+    LOG(ERROR) << "Could not create the virtual memory allocator of GPU "
+               << platform_device_id.value() << ": " << allocator.status()
+               << ". Falling back to the device memory allocator.";
   }
 #else
-  return absl::WrapUnique(new se::DeviceMemAllocator(
-      executor, platform_device_id,
-      (options.per_process_gpu_memory_fraction() > 1.0 ||
-       options.experimental().use_unified_memory()),
-      alloc_visitors, {}));
+  if (options.experimental().use_virtual_memory_allocator()) {
+    LOG(ERROR) << "use_virtual_memory_allocator requires CUDA 10.2 or later."
+               << " Falling back to the device memory allocator.";
+  }
 #endif
+  return absl::WrapUnique(new se::DeviceMemAllocator(
+      executor, platform_device_id, use_unified_memory, alloc_visitors, {}));
 }
 
 Allocator* GPUProcessState::GetGPUAllocator(
@@ -197,6 +214,11 @@ Allocator* GPUProcessState::GetGPUAllocator(
               !options.experimental().disallow_retry_on_allocation_failure();
           o.fragmentation_fraction =
               options.experimental().internal_fragmentation_fraction();
+          o.stream_ordered = options.experimental().stream_ordered_allocator();
+          o.segregate_size_classes =
+              options.experimental().segregate_allocator_size_classes();
+          o.compaction_interval_micros =
+              options.experimental().allocator_compaction_interval_us();
           return o;
         }());
     Allocator* gpu_allocator = gpu_bfc_allocator.get();
@@ -353,6 +375,15 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
     mem_limit_bytes = limit_mb * (1LL << 20);
   }
 
+  // Pinned host memory is allocated by many inter-op threads for copies, so
+  // per-thread caches keep them off the allocator lock.
+  int64_t thread_cache_bytes = 0;
+  Status status = tsl::ReadInt64FromEnvVar(
+      "TF_GPU_HOST_BFC_THREAD_CACHE_BYTES", 0, &thread_cache_bytes);
+  if (!status.ok()) {
+    LOG(ERROR) << "GetGpuHostAllocator: " << status.error_message();
+  }
+
   while (static_cast<int>(gpu_host_allocators_.size()) <= numa_node) {
     while (gpu_host_alloc_visitors_.size() <= numa_node) {
       gpu_host_alloc_visitors_.push_back({});
@@ -367,6 +398,8 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
     tsl::BFCAllocator::Options allocator_opts;
     allocator_opts.allow_growth =
         !options.experimental().gpu_host_mem_disallow_growth();
+    allocator_opts.thread_cache_bytes =
+        std::max<int64_t>(thread_cache_bytes, 0);
     tsl::Allocator* allocator =
         new tsl::BFCAllocator(absl::WrapUnique(sub_allocator), mem_limit_bytes,
                               /*name=*/"gpu_host_bfc", allocator_opts);
@@ -446,6 +479,193 @@ void GPUProcessState::AddGpuHostFreeVisitor(
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 }
 
+string GPUTensorIpcHandle::SerializeAsString() const {
+  string serialized;
+  core::PutVarint64(&serialized, memory_handle.size());
+  serialized.append(memory_handle);
+  core::PutVarint64(&serialized, offset);
+  core::PutVarint32(&serialized, dtype);
+  core::PutVarint32(&serialized, shape.dims());
+  for (int64_t dim : shape.dim_sizes()) {
+    core::PutVarint64(&serialized, dim);
+  }
+  return serialized;
+}
+
+bool GPUTensorIpcHandle::ParseFromString(const string& serialized) {
+  StringPiece input(serialized);
+  uint64 handle_size;
+  if (!core::GetVarint64(&input, &handle_size) || input.size() < handle_size) {
+    return false;
+  }
+  memory_handle.assign(input.data(), handle_size);
+  input.remove_prefix(handle_size);
+  uint32 type;
+  uint32 num_dims;
+  if (!core::GetVarint64(&input, &offset) ||
+      !core::GetVarint32(&input, &type) || !DataType_IsValid(type) ||
+      !core::GetVarint32(&input, &num_dims)) {
+    return false;
+  }
+  dtype = static_cast<DataType>(type);
+  std::vector<int64_t> dims(num_dims);
+  for (int64_t& dim : dims) {
+    uint64 value;
+    if (!core::GetVarint64(&input, &value)) return false;
+    dim = static_cast<int64_t>(value);
+  }
+  return input.empty() && TensorShapeUtils::MakeShape(dims, &shape).ok();
+}
+
+// The buffer of a tensor imported by GPUProcessState::ImportGPUTensor(). It
+// keeps the mapping of its allocation alive.
+class GPUIpcTensorBuffer : public TensorBuffer {
+ public:
+  GPUIpcTensorBuffer(void* data, size_t size, std::pair<int, string> key)
+      : TensorBuffer(data), size_(size), key_(std::move(key)) {}
+
+  ~GPUIpcTensorBuffer() override {
+    GPUProcessState::singleton()->ReleaseIpcMapping(key_);
+  }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("gpu_ipc");
+  }
+  bool OwnsMemory() const override { return false; }
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kDevice;
+  }
+
+ private:
+  const size_t size_;
+  const std::pair<int, string> key_;
+};
+
+Status GPUProcessState::ExportGPUTensor(const Tensor& tensor,
+                                        GPUTensorIpcHandle* handle) {
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+  if (!DataTypeCanUseMemcpy(tensor.dtype())) {
+    return errors::InvalidArgument("Cannot export a GPU tensor of type ",
+                                   DataTypeString(tensor.dtype()));
+  }
+  if (tensor.TotalBytes() == 0) {
+    return errors::InvalidArgument("Cannot export an empty GPU tensor");
+  }
+  auto ptr = reinterpret_cast<se::gpu::GpuDevicePtr>(tensor.data());
+  TF_ASSIGN_OR_RETURN(se::gpu::GpuContext * context,
+                      se::gpu::GpuDriver::GetPointerContext(ptr));
+  se::gpu::GpuDevicePtr base;
+  size_t size;
+  TF_RETURN_IF_ERROR(
+      se::gpu::GpuDriver::GetPointerAddressRange(ptr, &base, &size));
+  TF_RETURN_IF_ERROR(se::gpu::GpuDriver::IpcGetMemHandle(
+      context, base, &handle->memory_handle));
+  handle->offset = static_cast<const char*>(tensor.data()) -
+                   reinterpret_cast<const char*>(base);
+  handle->dtype = tensor.dtype();
+  handle->shape = tensor.shape();
+  return OkStatus();
+#else
+  return errors::Unimplemented(
+      "Exporting GPU tensors requires a build with GPU support");
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}
+
+Status GPUProcessState::ImportGPUTensor(tsl::TfDeviceId tf_device_id,
+                                        const GPUTensorIpcHandle& handle,
+                                        Tensor* tensor) {
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+  if (!DataTypeCanUseMemcpy(handle.dtype)) {
+    return errors::InvalidArgument("Cannot import a GPU tensor of type ",
+                                   DataTypeString(handle.dtype));
+  }
+  tsl::PlatformDeviceId platform_device_id;
+  TF_RETURN_IF_ERROR(
+      GpuIdManager::TfToPlatformDeviceId(tf_device_id, &platform_device_id));
+  std::pair<int, string> key(platform_device_id.value(),
+                             handle.memory_handle);
+  const size_t num_bytes =
+      handle.shape.num_elements() * DataTypeSize(handle.dtype);
+
+  // The previous value of '*tensor' may release a mapping, which takes mu_,
+  // so it is only replaced once mu_ is released.
+  Tensor imported;
+  {
+    mutex_lock lock(mu_);
+    auto it = ipc_mappings_.find(key);
+    if (it == ipc_mappings_.end()) {
+      TF_ASSIGN_OR_RETURN(se::StreamExecutor * executor,
+                          se::DeviceIdUtil::ExecutorForPlatformDeviceId(
+                              se::GPUMachineManager(), platform_device_id));
+      auto* context = reinterpret_cast<se::gpu::GpuContext*>(
+          executor->implementation()->GpuContextHack());
+      TF_ASSIGN_OR_RETURN(
+          se::gpu::GpuDevicePtr base,
+          se::gpu::GpuDriver::IpcOpenMemHandle(context, handle.memory_handle));
+      se::gpu::GpuDevicePtr range_base;
+      size_t size;
+      Status status =
+          se::gpu::GpuDriver::GetPointerAddressRange(base, &range_base, &size);
+      if (!status.ok()) {
+        se::gpu::GpuDriver::IpcCloseMemHandle(context, base).IgnoreError();
+        return status;
+      }
+      it = ipc_mappings_
+               .emplace(key, IpcMapping{context, reinterpret_cast<void*>(base),
+                                        size, /*refs=*/0})
+               .first;
+    }
+    IpcMapping& mapping = it->second;
+    if (handle.offset > mapping.size ||
+        num_bytes > mapping.size - handle.offset) {
+      const size_t mapping_size = mapping.size;
+      if (mapping.refs == 0) {
+        se::gpu::GpuDriver::IpcCloseMemHandle(
+            static_cast<se::gpu::GpuContext*>(mapping.context),
+            reinterpret_cast<se::gpu::GpuDevicePtr>(mapping.base))
+            .IgnoreError();
+        ipc_mappings_.erase(it);
+      }
+      return errors::InvalidArgument(
+          "The imported GPU tensor of ", num_bytes, " bytes at offset ",
+          handle.offset, " exceeds its allocation of ", mapping_size, " bytes");
+    }
+    ++mapping.refs;
+    auto* buffer = new GPUIpcTensorBuffer(
+        static_cast<char*>(mapping.base) + handle.offset, num_bytes, key);
+    imported = Tensor(handle.dtype, handle.shape, buffer);
+    buffer->Unref();
+  }
+  *tensor = std::move(imported);
+  return OkStatus();
+#else
+  return errors::Unimplemented(
+      "Importing GPU tensors requires a build with GPU support");
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}
+
+void GPUProcessState::ReleaseIpcMapping(const std::pair<int, string>& key) {
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+  mutex_lock lock(mu_);
+  auto it = ipc_mappings_.find(key);
+  CHECK(it != ipc_mappings_.end());  // Crash OK
+  if (--it->second.refs > 0) return;
+  Status status = se::gpu::GpuDriver::IpcCloseMemHandle(
+      static_cast<se::gpu::GpuContext*>(it->second.context),
+      reinterpret_cast<se::gpu::GpuDevicePtr>(it->second.base));
+  if (!status.ok()) {
+    LOG(ERROR) << "Could not unmap an imported GPU allocation: " << status;
+  }
+  ipc_mappings_.erase(it);
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}
+
 void GPUProcessState::TestOnlyReset() {
   if (process_state_) {
     process_state_->ProcessState::TestOnlyReset();
@@ -19,12 +19,18 @@ limitations under the License.
 #include <functional>
 #include <map>
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/process_state.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
@@ -34,8 +40,27 @@ limitations under the License.
 namespace tensorflow {
 
 class GPUBFCAllocator;
+class GPUIpcTensorBuffer;
 class PoolAllocator;
 
+// Identifies the device memory of a GPU tensor exported with
+// GPUProcessState::ExportGPUTensor(), so that another process on the same
+// machine can alias it with GPUProcessState::ImportGPUTensor().
+struct GPUTensorIpcHandle {
+  // The IPC handle of the device memory allocation containing the tensor.
+  string memory_handle;
+  // The offset of the tensor data in that allocation.
+  uint64 offset = 0;
+  DataType dtype = DT_INVALID;
+  TensorShape shape;
+
+  // Serializes the handle for transfer to another process.
+  string SerializeAsString() const;
+  // Parses a handle serialized by SerializeAsString(). Returns false if
+  // 'serialized' is not a valid handle.
+  bool ParseFromString(const string& serialized);
+};
+
 // Singleton that manages per-process state when GPUs are present.
 class GPUProcessState {
  public:
@@ -130,6 +155,22 @@ class GPUProcessState {
 
   SharedCounter* GPUAllocatorCounter(tsl::TfDeviceId tf_device_id);
 
+  // Exports the device memory of 'tensor', e.g. constant or variable weights,
+  // for other processes on the same machine to alias. The memory must have
+  // been allocated by a device memory allocator (not the virtual memory nor
+  // the cudaMallocAsync one), and must stay allocated while it is imported, so
+  // the caller has to keep a reference to 'tensor' meanwhile.
+  Status ExportGPUTensor(const Tensor& tensor, GPUTensorIpcHandle* handle);
+
+  // Returns in '*tensor' a tensor on GPU 'tf_device_id' that aliases the
+  // memory of a tensor exported by ExportGPUTensor() in another process.
+  // Imported tensors must be treated as read-only, since their writes would
+  // be visible to every process sharing the memory. The memory is mapped
+  // once per allocation and unmapped when its last imported tensor is
+  // destroyed.
+  Status ImportGPUTensor(tsl::TfDeviceId tf_device_id,
+                         const GPUTensorIpcHandle& handle, Tensor* tensor);
+
  protected:
   // GPUProcessState is a singleton that should not normally be deleted except
   // at process shutdown.
@@ -168,6 +209,23 @@ class GPUProcessState {
       TF_GUARDED_BY(mu_);
   std::vector<std::vector<SubAllocator::Visitor>> gpu_host_free_visitors_
       TF_GUARDED_BY(mu_);
+
+ private:
+  friend class GPUIpcTensorBuffer;
+
+  // Unmaps the memory of an imported allocation once its last imported
+  // tensor is destroyed.
+  void ReleaseIpcMapping(const std::pair<int, string>& key);
+
+  struct IpcMapping {
+    void* context;  // The se::gpu::GpuContext of the mapping.
+    void* base;
+    size_t size;
+    int64_t refs;
+  };
+  // The imported allocations, by platform device id and memory handle.
+  std::map<std::pair<int, string>, IpcMapping> ipc_mappings_
+      TF_GUARDED_BY(mu_);
 };
 
 }  // namespace tensorflow
@@ -0,0 +1,68 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+
+namespace {
+
+// Returns true iff the value of `n` exists before the step starts.
+bool NeedsNoStream(const Node* n) {
+  return !n->IsOp() || n->IsConstant() || n->IsArg();
+}
+
+}  // namespace
+
+Status AssignStreams(const Graph* graph, int num_streams,
+                     std::vector<int>* node_to_stream) {
+  if (num_streams < 1) {
+    return errors::InvalidArgument("num_streams must be positive, but is ",
+                                   num_streams);
+  }
+  node_to_stream->assign(graph->num_node_ids(), -1);
+  // Whether each node has passed its stream on to one of its consumers.
+  std::vector<bool> passed_on(graph->num_node_ids(), false);
+  int next_stream = 0;
+
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph, &order);
+  for (const Node* n : order) {
+    if (NeedsNoStream(n)) continue;
+    int stream = -1;
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge()) continue;
+      const int src_id = e->src()->id();
+      if ((*node_to_stream)[src_id] >= 0 && !passed_on[src_id]) {
+        stream = (*node_to_stream)[src_id];
+        passed_on[src_id] = true;
+        break;
+      }
+    }
+    if (stream < 0) {
+      stream = next_stream;
+      next_stream = (next_stream + 1) % num_streams;
+    }
+    (*node_to_stream)[n->id()] = stream;
+  }
+  return OkStatus();
+}
+
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
@@ -0,0 +1,46 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
+
+#include <vector>
+
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+
+// Assigns the nodes of `graph` to `num_streams` compute streams, so that
+// independent branches of the graph (e.g. the towers of a multi-tower model)
+// can run concurrently, while chains of dependent ops stay on one stream and
+// need no synchronization between streams.
+//
+// Each op inherits the stream of the first producer of its data inputs that
+// has not passed its stream on to another consumer yet. Ops that cannot
+// inherit a stream start a new branch on the next stream in round-robin
+// order. Constants and arguments, whose values exist before the step starts,
+// do not take part in the assignment.
+//
+// Sets `(*node_to_stream)[id]` to the stream of the node with ID `id`, or to
+// -1 for nodes that do not need a stream.
+Status AssignStreams(const Graph* graph, int num_streams,
+                     std::vector<int>* node_to_stream);
+
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
@@ -0,0 +1,66 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include <vector>
+
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+namespace {
+
+TEST(AssignStreamsTest, IndependentBranchesUseDifferentStreams) {
+  Graph g(OpRegistry::Global());
+  Node* x = test::graph::Arg(&g, 0, DT_FLOAT);
+  Node* a1 = test::graph::Unary(&g, "Neg", x);
+  Node* a2 = test::graph::Unary(&g, "Neg", a1);
+  Node* b1 = test::graph::Unary(&g, "Neg", x);
+  Node* b2 = test::graph::Unary(&g, "Neg", b1);
+  Node* sum = test::graph::Binary(&g, "Add", a2, b2);
+
+  std::vector<int> node_to_stream;
+  TF_ASSERT_OK(AssignStreams(&g, 2, &node_to_stream));
+  EXPECT_EQ(node_to_stream[x->id()], -1);
+  // Each branch stays on one stream, and the branches do not share one.
+  EXPECT_EQ(node_to_stream[a1->id()], node_to_stream[a2->id()]);
+  EXPECT_EQ(node_to_stream[b1->id()], node_to_stream[b2->id()]);
+  EXPECT_NE(node_to_stream[a1->id()], node_to_stream[b1->id()]);
+  // The join continues one of the branches.
+  EXPECT_TRUE(node_to_stream[sum->id()] == node_to_stream[a2->id()] ||
+              node_to_stream[sum->id()] == node_to_stream[b2->id()]);
+}
+
+TEST(AssignStreamsTest, SingleStream) {
+  Graph g(OpRegistry::Global());
+  Node* x = test::graph::Arg(&g, 0, DT_FLOAT);
+  Node* a = test::graph::Unary(&g, "Neg", x);
+  Node* b = test::graph::Unary(&g, "Neg", x);
+
+  std::vector<int> node_to_stream;
+  TF_ASSERT_OK(AssignStreams(&g, 1, &node_to_stream));
+  EXPECT_EQ(node_to_stream[a->id()], 0);
+  EXPECT_EQ(node_to_stream[b->id()], 0);
+
+  EXPECT_FALSE(AssignStreams(&g, 0, &node_to_stream).ok());
+}
+
+}  // namespace
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
@@ -17,7 +17,11 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
@@ -38,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 // IMPLEMENTATION NOTE:
@@ -113,6 +118,155 @@ void* GetBase(const Tensor* src) {
 
 void* GetBase(Tensor* dst) { return DMAHelper::base(dst); }
 
+namespace {
+
+// Keeps the memory of a GPU tensor that a copy stream reads from being reused
+// before the copy completes. If the allocator of the tensor tracks the uses of
+// its memory by other streams (see
+// GPUOptions.Experimental.stream_ordered_allocator), the use is recorded, so
+// that the memory is reused as soon as the copy completes, even if the tensor
+// was released earlier. Otherwise, a reference to the tensor is held.
+class CopyStreamUse {
+ public:
+  CopyStreamUse(Allocator* allocator, const Tensor& tensor)
+      : allocator_(allocator),
+        use_id_(tensor.TotalBytes() > 0
+                    ? allocator->RecordStreamUse(GetBase(&tensor))
+                    : 0),
+        tensor_ref_(use_id_ != 0 ? Tensor() : tensor) {}
+
+  // Called once the copy has completed.
+  void Release() const {
+    if (use_id_ != 0) {
+      allocator_->CompleteStreamUse(use_id_);
+    } else {
+      tensor_ref_.Unref();
+    }
+  }
+
+ private:
+  Allocator* allocator_;  // Not owned.
+  int64_t use_id_;
+  TensorReference tensor_ref_;
+};
+
+// Returns the size of the pinned chunks that CPU->GPU copies needing staging
+// are split into, if they are larger than one chunk, so that filling a chunk
+// overlaps with the DMA out of the previous one. Can be set with
+// TF_GPU_STAGING_CHUNK_BYTES; 0 copies through a single staging buffer.
+int64_t StagingChunkBytes() {
+  static const int64_t chunk_bytes = [] {
+    int64_t bytes;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_GPU_STAGING_CHUNK_BYTES",
+                                    /*default_val=*/4 << 20, &bytes));
+    return bytes;
+  }();
+  return chunk_bytes;
+}
+
+// A pinned staging buffer of StagingChunkBytes() bytes, with an event marking
+// the completion of the last DMA out of it.
+struct StagingChunk {
+  void* data = nullptr;
+  std::unique_ptr<se::Event> copied;
+};
+
+// Keeps the staging chunks of the CPU->GPU copies from one host memory
+// allocator to one GPU, so that they are reused across copies.
+class StagingChunkPool {
+ public:
+  // Returns the pool for `allocator` and `executor`. Pools are never deleted.
+  static StagingChunkPool* Get(Allocator* allocator,
+                               se::StreamExecutor* executor) {
+    static mutex* mu = new mutex;
+    static auto* pools =
+        new absl::flat_hash_map<std::pair<Allocator*, se::StreamExecutor*>,
+                                StagingChunkPool*>;
+    mutex_lock l(*mu);
+    StagingChunkPool*& pool = (*pools)[{allocator, executor}];
+    if (pool == nullptr) pool = new StagingChunkPool(allocator, executor);
+    return pool;
+  }
+
+  // Returns a free chunk, or a chunk with a null `data` if the allocator is
+  // out of memory.
+  StagingChunk Acquire() {
+    {
+      mutex_lock l(mu_);
+      if (!free_chunks_.empty()) {
+        StagingChunk chunk = std::move(free_chunks_.back());
+        free_chunks_.pop_back();
+        return chunk;
+      }
+    }
+    StagingChunk chunk;
+    chunk.data = allocator_->AllocateRaw(Allocator::kAllocatorAlignment,
+                                         StagingChunkBytes());
+    chunk.copied = std::make_unique<se::Event>(executor_);
+    if (chunk.data != nullptr && !chunk.copied->Init()) {
+      allocator_->DeallocateRaw(chunk.data);
+      chunk.data = nullptr;
+    }
+    return chunk;
+  }
+
+  // Returns `chunk` to the pool once no DMA reads from it anymore.
+  void Release(StagingChunk chunk) {
+    if (chunk.data == nullptr) return;
+    {
+      mutex_lock l(mu_);
+      if (free_chunks_.size() < kMaxFreeChunks) {
+        free_chunks_.push_back(std::move(chunk));
+        return;
+      }
+    }
+    allocator_->DeallocateRaw(chunk.data);
+  }
+
+ private:
+  StagingChunkPool(Allocator* allocator, se::StreamExecutor* executor)
+      : allocator_(allocator), executor_(executor) {}
+
+  // Enough for a few concurrent copies.
+  static constexpr int kMaxFreeChunks = 8;
+
+  Allocator* const allocator_;          // Not owned.
+  se::StreamExecutor* const executor_;  // Not owned.
+  mutex mu_;
+  std::vector<StagingChunk> free_chunks_ TF_GUARDED_BY(mu_);
+};
+
+// The number of chunks a staged copy cycles through.
+constexpr int kNumStagingChunksPerCopy = 2;
+
+// Enqueues the copy of `total_bytes` bytes from pageable `src` to `dst` on
+// `stream` through `chunks`. The host copy of each chunk into staging memory
+// overlaps with the DMA of the previous chunk; before a chunk is refilled,
+// the host waits for the DMA out of it to complete.
+void ThenStagedMemcpy(se::Stream* stream, const char* src,
+                      DeviceMemoryBase* dst, int64_t total_bytes,
+                      StagingChunk* chunks) {
+  const int64_t chunk_bytes = StagingChunkBytes();
+  for (int64_t offset = 0, i = 0; offset < total_bytes;
+       offset += chunk_bytes, ++i) {
+    StagingChunk& chunk = chunks[i % kNumStagingChunksPerCopy];
+    if (i >= kNumStagingChunksPerCopy) {
+      // A failed DMA is reported by the stream once the copy completes.
+      while (chunk.copied->PollForStatus() == se::Event::Status::kPending) {
+        Env::Default()->SleepForMicroseconds(10);
+      }
+    }
+    const int64_t bytes = std::min(chunk_bytes, total_bytes - offset);
+    std::memcpy(chunk.data, src + offset, bytes);
+    DeviceMemoryBase dst_chunk(static_cast<char*>(dst->opaque()) + offset,
+                               bytes);
+    stream->ThenMemcpy(&dst_chunk, chunk.data, bytes);
+    stream->ThenRecordEvent(chunk.copied.get());
+  }
+}
+
+}  // namespace
+
 /*static*/
 void GPUUtil::SetProtoFromGPU(const Tensor& tensor, Device* dev,
                               const DeviceContext* device_context,
@@ -165,15 +319,15 @@ void GPUUtil::SetProtoFromGPU(const Tensor& tensor, Device* dev,
     DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
     send_device_to_host_stream->ThenMemcpy(buf, gpu_src_ptr, total_bytes);
   }
-  // Use of tensor may outlive stack scope, so keep a ref.
-  TensorReference tensor_ref(tensor);
+  // Use of tensor may outlive stack scope.
+  CopyStreamUse tensor_use(dev->GetAllocator(AllocatorAttributes()), tensor);
   dev_info->event_mgr->ThenExecute(
       send_device_to_host_stream, [send_device_to_host_stream, done, proto, buf,
-                                   total_bytes, alloc, tensor_ref]() {
+                                   total_bytes, alloc, tensor_use]() {
         if (!send_device_to_host_stream->ok()) {
           LOG(FATAL) << "SetProtoFromGPU: GPU Memcpy failed";
         }
-        tensor_ref.Unref();
+        tensor_use.Release();
         if (total_bytes > 0) {
           port::CopyFromArray(proto->mutable_tensor_content(), buf,
                               total_bytes);
@@ -237,12 +391,12 @@ void GPUUtil::DeviceToDeviceCopy(
                                              total_bytes);
   }
 
-  // Use of input may outlive stack scope, so keep a ref.
-  TensorReference input_ref(*input);
+  // Use of input may outlive stack scope.
+  CopyStreamUse input_use(src->GetAllocator(src_alloc_attr), *input);
   dev_info->event_mgr->ThenExecute(
       send_device_to_device_stream,
-      [done, send_device_to_device_stream, input_ref]() {
-        input_ref.Unref();
+      [done, send_device_to_device_stream, input_use]() {
+        input_use.Release();
         if (!send_device_to_device_stream->ok()) {
           LOG(FATAL) << "GPU->GPU Memcpy failed";
         }
@@ -299,15 +453,16 @@ void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
     void* dst_ptr = GetBase(cpu_tensor);
     send_device_to_host_stream->ThenMemcpy(dst_ptr, gpu_src_ptr, total_bytes);
   }
-  // Use of the input may outlive stack scope, so keep a ref.
-  TensorReference input_ref(*gpu_tensor);
+  // Use of the input may outlive stack scope.
+  CopyStreamUse input_use(gpu_device->GetAllocator(AllocatorAttributes()),
+                          *gpu_tensor);
   dev_info->event_mgr->ThenExecute(
       send_device_to_host_stream,
-      [send_device_to_host_stream, done, input_ref]() {
+      [send_device_to_host_stream, done, input_use]() {
         if (!send_device_to_host_stream->ok()) {
           LOG(FATAL) << "GPU->CPU Memcpy failed";
         }
-        input_ref.Unref();
+        input_use.Release();
         done(OkStatus());
       });
 }
@@ -344,6 +499,8 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
   bool do_staging = false;
   void* staging_buffer = nullptr;
   Allocator* host_memory_allocator = device_context->host_memory_allocator();
+  StagingChunkPool* staging_chunk_pool = nullptr;
+  std::shared_ptr<StagingChunk> staging_chunks;
 
   // Use of cpu_tensor may outlive stack scope, so keep a ref.
   TensorReference input_ref(*cpu_tensor);
@@ -364,7 +521,34 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
       }
     }
 
-    if (do_staging) {
+    if (do_staging && StagingChunkBytes() > 0 &&
+        total_bytes > StagingChunkBytes()) {
+      staging_chunk_pool = StagingChunkPool::Get(
+          host_memory_allocator, recv_host_to_device_stream->parent());
+      staging_chunks = std::shared_ptr<StagingChunk>(
+          new StagingChunk[kNumStagingChunksPerCopy],
+          [staging_chunk_pool](StagingChunk* chunks) {
+            for (int i = 0; i < kNumStagingChunksPerCopy; ++i) {
+              staging_chunk_pool->Release(std::move(chunks[i]));
+            }
+            delete[] chunks;
+          });
+      for (int i = 0; i < kNumStagingChunksPerCopy; ++i) {
+        staging_chunks.get()[i] = staging_chunk_pool->Acquire();
+        if (staging_chunks.get()[i].data == nullptr) {
+          // Fall back to a single staging buffer.
+          staging_chunks.reset();
+          break;
+        }
+      }
+    }
+
+    if (staging_chunks != nullptr) {
+      ThenStagedMemcpy(recv_host_to_device_stream,
+                       static_cast<const char*>(src_ptr), &gpu_dst_ptr,
+                       total_bytes, staging_chunks.get());
+      input_ref.Unref();
+    } else if (do_staging) {
       staging_buffer = host_memory_allocator->AllocateRaw(
           tensorflow::Allocator::kAllocatorAlignment, total_bytes);
       std::memcpy(staging_buffer, src_ptr, total_bytes);
@@ -381,8 +565,11 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
   dev_info->event_mgr->ThenExecute(
       recv_host_to_device_stream,
       [recv_host_to_device_stream, done, input_ref, do_staging, staging_buffer,
-       host_memory_allocator]() {
-        if (do_staging) {
+       staging_chunks, host_memory_allocator]() mutable {
+        if (staging_chunks != nullptr) {
+          // Returns the chunks to their pool.
+          staging_chunks.reset();
+        } else if (do_staging) {
           host_memory_allocator->DeallocateRaw(staging_buffer);
         } else {
           input_ref.Unref();
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 
+#include <utility>
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -36,7 +38,8 @@ class GPUDeviceContext : public DeviceContext {
                    se::Stream* host_to_device_stream,
                    se::Stream* device_to_host_stream,
                    gtl::InlinedVector<se::Stream*, 4> device_to_device_stream,
-                   Allocator* host_memory_allocator)
+                   Allocator* host_memory_allocator,
+                   gtl::InlinedVector<se::Stream*, 2> wait_streams = {})
       : stream_id_(stream_id),
         stream_(stream),
 #if TENSORFLOW_USE_ROCM
@@ -45,7 +48,8 @@ class GPUDeviceContext : public DeviceContext {
         host_to_device_stream_(host_to_device_stream),
         device_to_host_stream_(device_to_host_stream),
         device_to_device_stream_(device_to_device_stream),
-        host_memory_allocator_(host_memory_allocator) {
+        host_memory_allocator_(host_memory_allocator),
+        wait_streams_(std::move(wait_streams)) {
   }
 
   ~GPUDeviceContext() override {}
@@ -60,6 +64,11 @@ class GPUDeviceContext : public DeviceContext {
     return device_to_device_stream_[index % device_to_device_stream_.size()];
   }
   int stream_id() const { return stream_id_; }
+  // The other compute streams that produced inputs of the op using this
+  // context, which `stream()` must wait for before running the op.
+  const gtl::InlinedVector<se::Stream*, 2>& wait_streams() const {
+    return wait_streams_;
+  }
   Allocator* host_memory_allocator() const override {
     return host_memory_allocator_;
   }
@@ -100,6 +109,8 @@ class GPUDeviceContext : public DeviceContext {
   // The allocator to use for allocating pinned host memory.
   // Not owned.
   Allocator* host_memory_allocator_;
+  // Not owned.
+  gtl::InlinedVector<se::Stream*, 2> wait_streams_;
 };
 
 }  // namespace tensorflow
@@ -0,0 +1,91 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/graph_compile_cache.h"
+
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Appends `piece` to `*out`, prefixed by its length so that the concatenation
+// of the pieces is unambiguous.
+void AppendPiece(StringPiece piece, std::string* out) {
+  strings::StrAppend(out, piece.size(), ":", piece);
+}
+
+void AppendMessage(const protobuf::MessageLite& message, std::string* out) {
+  std::string serialized;
+  SerializeToStringDeterministic(message, &serialized);
+  AppendPiece(serialized, out);
+}
+
+}  // namespace
+
+GraphCompileCache::GraphCompileCache(Env* env, const std::string& dir)
+    : env_(env), dir_(dir) {}
+
+/*static*/ std::string GraphCompileCache::ComputeKey(
+    const GraphDef& graph_def, const ConfigProto& config,
+    const CallableOptions& callable_options, const DeviceSet& device_set) {
+  std::string data;
+  AppendPiece(TF_VERSION_STRING, &data);
+  AppendPiece(strings::StrCat(TF_GRAPH_DEF_VERSION), &data);
+  AppendMessage(graph_def, &data);
+  AppendMessage(config, &data);
+  AppendMessage(callable_options, &data);
+  for (const Device* device : device_set.devices()) {
+    // The incarnation of a device changes with every process, so only the
+    // attributes that describe the device itself are part of the key.
+    DeviceAttributes attributes = device->attributes();
+    attributes.clear_incarnation();
+    AppendMessage(attributes, &data);
+  }
+  const Fprint128 fingerprint = Fingerprint128(data);
+  return absl::StrFormat("%016x%016x", fingerprint.high64, fingerprint.low64);
+}
+
+std::string GraphCompileCache::EntryPath(const std::string& key) const {
+  return io::JoinPath(dir_, strings::StrCat(key, ".pb"));
+}
+
+Status GraphCompileCache::Lookup(const std::string& key,
+                                 GraphCompileCacheEntry* entry) const {
+  const std::string path = EntryPath(key);
+  TF_RETURN_IF_ERROR(env_->FileExists(path));
+  return ReadBinaryProto(env_, path, entry);
+}
+
+Status GraphCompileCache::Insert(const std::string& key,
+                                 const GraphCompileCacheEntry& entry) const {
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(dir_));
+  const std::string path = EntryPath(key);
+  const std::string temp_path =
+      strings::StrCat(path, ".tempstate", random::New64());
+  Status s = WriteBinaryProto(env_, temp_path, entry);
+  if (s.ok()) s = env_->RenameFile(temp_path, path);
+  if (!s.ok()) env_->DeleteFile(temp_path).IgnoreError();
+  return s;
+}
+
+}  // namespace tensorflow
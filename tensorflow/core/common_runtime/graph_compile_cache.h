@@ -0,0 +1,72 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GRAPH_COMPILE_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GRAPH_COMPILE_CACHE_H_
+
+#include <string>
+
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/graph_compile_cache.pb.h"
+
+namespace tensorflow {
+
+// A GraphCompileCache stores the placed, optimized and partitioned graphs that
+// DirectSession builds for a callable in a directory, so that a process that
+// is restarted with the same graph, configuration and devices can skip
+// placement, Grappler and partitioning.
+//
+// Each entry is stored in its own file, named after its key. Entries are
+// written to a temporary file first and then renamed, so that concurrent
+// writers (e.g. replicas sharing the directory) never expose partial entries.
+//
+// This class is thread-safe.
+class GraphCompileCache {
+ public:
+  GraphCompileCache(Env* env, const std::string& dir);
+
+  // Returns the key of the graphs built from `graph_def` for
+  // `callable_options` in a session configured by `config` with the devices
+  // in `device_set`. The key also covers the TensorFlow version, since
+  // placement and optimizations differ between versions.
+  static std::string ComputeKey(const GraphDef& graph_def,
+                                const ConfigProto& config,
+                                const CallableOptions& callable_options,
+                                const DeviceSet& device_set);
+
+  // Reads the entry for `key` into `entry`. Returns a NotFound error if there
+  // is no such entry.
+  Status Lookup(const std::string& key, GraphCompileCacheEntry* entry) const;
+
+  // Stores `entry` for `key`, replacing any existing entry.
+  Status Insert(const std::string& key,
+                const GraphCompileCacheEntry& entry) const;
+
+ private:
+  std::string EntryPath(const std::string& key) const;
+
+  Env* const env_;  // Not owned.
+  const std::string dir_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GraphCompileCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GRAPH_COMPILE_CACHE_H_
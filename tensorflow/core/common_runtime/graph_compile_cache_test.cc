@@ -0,0 +1,93 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/graph_compile_cache.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+GraphDef MakeGraphDef(const string& node_name) {
+  GraphDef graph_def;
+  NodeDef* node = graph_def.add_node();
+  node->set_name(node_name);
+  node->set_op("NoOp");
+  return graph_def;
+}
+
+TEST(GraphCompileCacheTest, KeyDependsOnInputs) {
+  DeviceSet device_set;
+  const GraphDef graph_a = MakeGraphDef("a");
+  const GraphDef graph_b = MakeGraphDef("b");
+  ConfigProto config;
+  CallableOptions callable_options;
+  callable_options.add_target("a");
+
+  const string key = GraphCompileCache::ComputeKey(graph_a, config,
+                                                   callable_options, device_set);
+  EXPECT_EQ(key, GraphCompileCache::ComputeKey(graph_a, config,
+                                               callable_options, device_set));
+  EXPECT_NE(key, GraphCompileCache::ComputeKey(graph_b, config,
+                                               callable_options, device_set));
+
+  ConfigProto other_config;
+  other_config.set_inter_op_parallelism_threads(2);
+  EXPECT_NE(key, GraphCompileCache::ComputeKey(graph_a, other_config,
+                                               callable_options, device_set));
+
+  CallableOptions other_callable_options;
+  other_callable_options.add_fetch("a:0");
+  EXPECT_NE(key, GraphCompileCache::ComputeKey(
+                     graph_a, config, other_callable_options, device_set));
+}
+
+TEST(GraphCompileCacheTest, InsertAndLookup) {
+  const string dir = io::JoinPath(testing::TmpDir(), "graph_compile_cache");
+  GraphCompileCache cache(Env::Default(), dir);
+
+  GraphCompileCacheEntry entry;
+  EXPECT_TRUE(errors::IsNotFound(cache.Lookup("key", &entry)));
+
+  (*entry.mutable_partition_graphs())["/device:CPU:0"] = MakeGraphDef("a");
+  entry.add_fetch_types(DT_FLOAT);
+  entry.set_collective_graph_key(7);
+  TF_ASSERT_OK(cache.Insert("key", entry));
+
+  // A second cache on the same directory (e.g. in a restarted process) sees
+  // the entry.
+  GraphCompileCache other_cache(Env::Default(), dir);
+  GraphCompileCacheEntry loaded;
+  TF_ASSERT_OK(other_cache.Lookup("key", &loaded));
+  ASSERT_EQ(loaded.partition_graphs_size(), 1);
+  EXPECT_EQ(loaded.partition_graphs().at("/device:CPU:0").node(0).name(), "a");
+  ASSERT_EQ(loaded.fetch_types_size(), 1);
+  EXPECT_EQ(loaded.fetch_types(0), DT_FLOAT);
+  EXPECT_EQ(loaded.collective_graph_key(), 7);
+
+  // No temporary files are left behind.
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(dir, &children));
+  EXPECT_EQ(children.size(), 1);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -102,7 +102,8 @@ class GraphConstructor {
           importing(false),
           validate_nodes(in.validate_nodes),
           validate_colocation_constraints(false),
-          add_default_attributes(in.add_default_attributes) {}
+          add_default_attributes(in.add_default_attributes),
+          thread_pool(in.thread_pool) {}
     Options(const ImportGraphDefOptions& in)  // NOLINT(runtime/explicit)
         : allow_internal_ops(false),
           expect_device_spec(false),
@@ -157,6 +158,10 @@ class GraphConstructor {
     bool add_default_attributes = true;
 
     string default_device;
+
+    // If set, nodes are prepared in parallel on this pool. Only used when not
+    // importing.
+    thread::ThreadPool* thread_pool = nullptr;
   };
 
   typedef gtl::ArraySlice<const NodeDef*> NodeDefSlice;
@@ -235,6 +240,15 @@ class GraphConstructor {
   Status IsNodeFullyMapped(const NodeDef& node_def, bool* is_node_mapped);
   Status ValidateColocationConstraints(const NodeDef& node_def);
   Status MakeNode(NodeDef&& node_def, Node** node);
+  Status MakeNode(Graph::PreparedNode&& prepared, Node** node);
+  void AssignDevice(Node* node);
+
+  // Consumes all NodeDefs and prepares them for Graph::AddNode() on
+  // opts_.thread_pool. The preparation of node i can fail independently of
+  // the others, so its status is kept and returned when node i is added.
+  void PrepareNodes(std::vector<Graph::PreparedNode>* prepared,
+                    std::vector<Status>* prepare_status);
+  Status PrepareNode(NodeDef&& node_def, Graph::PreparedNode* prepared);
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
@@ -779,11 +793,57 @@ Status GraphConstructor::MakeNode(NodeDef&& node_def, Node** node) {
   Status status;
   *node = g_->AddNode(std::move(node_def), &status);
   if (!status.ok()) return status;
+  AssignDevice(*node);
+  return OkStatus();
+}
+
+Status GraphConstructor::MakeNode(Graph::PreparedNode&& prepared,
+                                  Node** node) {
+  *node = g_->AddNode(std::move(prepared));
+  AssignDevice(*node);
+  return OkStatus();
+}
+
+void GraphConstructor::AssignDevice(Node* node) {
   if (opts_.expect_device_spec ||
-      (opts_.propagate_device_spec && !(*node)->def().device().empty())) {
-    (*node)->set_assigned_device_name((*node)->def().device());
+      (opts_.propagate_device_spec && !node->def().device().empty())) {
+    node->set_assigned_device_name(node->def().device());
   }
-  return OkStatus();
+}
+
+void GraphConstructor::PrepareNodes(
+    std::vector<Graph::PreparedNode>* prepared,
+    std::vector<Status>* prepare_status) {
+  const int num_nodes = node_def_count();
+  prepared->resize(num_nodes);
+  prepare_status->resize(num_nodes);
+  // Consuming is not thread-safe, but it is cheap compared to the preparation.
+  for (int i = 0; i < num_nodes; ++i) {
+    (*prepared)[i].node_def = consume_node_def(i);
+  }
+  // The nodes are independent of each other, so the work is split by index
+  // rather than in topological order.
+  const int64_t kCostPerNode = 10000;
+  opts_.thread_pool->ParallelFor(
+      num_nodes, kCostPerNode, [&](int64_t start, int64_t limit) {
+        for (int64_t i = start; i < limit; ++i) {
+          Graph::PreparedNode& node = (*prepared)[i];
+          (*prepare_status)[i] = PrepareNode(std::move(node.node_def), &node);
+        }
+      });
+}
+
+Status GraphConstructor::PrepareNode(NodeDef&& node_def,
+                                     Graph::PreparedNode* prepared) {
+  const OpDef* op_def;
+  TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
+  if (opts_.add_default_attributes) {
+    AddDefaultsToNodeDef(*op_def, &node_def);
+  }
+  if (opts_.validate_nodes) {
+    TF_RETURN_IF_ERROR(ValidateNodeDef(node_def, *op_def));
+  }
+  return g_->PrepareNode(std::move(node_def), prepared);
 }
 
 Status GraphConstructor::ValidateShape(Node* node) {
@@ -1135,6 +1195,12 @@ Status GraphConstructor::Convert() {
 
   std::vector<bool> input_already_exists;
 
+  std::vector<Graph::PreparedNode> prepared;
+  std::vector<Status> prepare_status;
+  if (opts_.thread_pool != nullptr && !opts_.importing) {
+    PrepareNodes(&prepared, &prepare_status);
+  }
+
   // Process the NodeDefs in topological order.
   // (InitFromEdges() sets this up by filling in ready_ with nodes that have no
   // inputs, pending_counts_ with the number of inputs for each node and
@@ -1146,7 +1212,12 @@ Status GraphConstructor::Convert() {
     inputs.clear();
     bool has_data_back_edge = false;
 
-    NodeDef node_def = consume_node_def(o);
+    NodeDef node_def;
+    if (prepared.empty()) {
+      node_def = consume_node_def(o);
+    } else {
+      node_def.Swap(&prepared[o].node_def);
+    }
 
     // input_already_exists[i] is true iff the i-th input of the node we're
     // importing refers to a preexisting node in g_ (i.e. input[i] existed prior
@@ -1242,6 +1313,8 @@ Status GraphConstructor::Convert() {
 
     if (opts_.importing) {
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
+    } else if (!prepared.empty()) {
+      TF_RETURN_IF_ERROR(prepare_status[o]);
     } else {
       const OpDef* op_def;
       TF_RETURN_IF_ERROR(
@@ -1254,7 +1327,12 @@ Status GraphConstructor::Convert() {
       }
     }
 
-    TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
+    if (prepared.empty()) {
+      TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
+    } else {
+      prepared[o].node_def.Swap(&node_def);
+      TF_RETURN_IF_ERROR(MakeNode(std::move(prepared[o]), &node));
+    }
 
     gdef_nodes_[node_name].node = node;
 
@@ -1291,7 +1369,9 @@ Status GraphConstructor::Convert() {
                  << " NODES IN A CYCLE";
     for (int64_t i = 0; i < node_def_count(); i++) {
       if (pending_count_[i] != 0) {
-        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(get_node_def(i))
+        const NodeDef& node_def =
+            prepared.empty() ? get_node_def(i) : prepared[i].node_def;
+        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(node_def)
                      << " WITH PENDING COUNT = " << pending_count_[i];
       }
     }
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/version.h"
 
@@ -914,6 +915,53 @@ TEST_F(GraphConstructorTest, SimpleModelWithControlEdges) {
   EXPECT_TRUE(HasControlEdge("t1", "t2"));
 }
 
+TEST_F(GraphConstructorTest, ThreadPool) {
+  string gdef_ascii =
+      "node { name: 'W1' op: 'TestParams' }"
+      "node { name: 'input' op: 'TestInput' }"
+      "node { name: 't0' op: 'TestMul' input: [ 'W1', 'input:1' ] }";
+  for (int i = 1; i < 100; ++i) {
+    strings::StrAppend(&gdef_ascii, "node { name: 't", i,
+                       "' op: 'TestMul' input: [ 't", i - 1, "', 'W1', '^t",
+                       (i - 1) / 2, "' ] }");
+  }
+  GraphDef def;
+  ASSERT_TRUE(protobuf::TextFormat::ParseFromString(gdef_ascii, &def));
+
+  Graph expected(OpRegistry::Global());
+  TF_ASSERT_OK(
+      ConvertGraphDefToGraph(GraphConstructorOptions(), def, &expected));
+
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  GraphConstructorOptions opts;
+  opts.thread_pool = &pool;
+  TF_ASSERT_OK(ConvertGraphDefToGraph(opts, def, &graph_));
+  EXPECT_EQ(expected.ToGraphDefDebug().DebugString(),
+            graph_.ToGraphDefDebug().DebugString());
+  EXPECT_TRUE(HasEdge("t98", 0, "t99", 0));
+  EXPECT_TRUE(HasControlEdge("t49", "t99"));
+}
+
+TEST_F(GraphConstructorTest, ThreadPoolError) {
+  // Errors are reported in the same order as without a pool, even though the
+  // unknown op is prepared before the type mismatch is found.
+  GraphDef def;
+  ASSERT_TRUE(protobuf::TextFormat::ParseFromString(
+      "node { name: 'input' op: 'TestInput' }"
+      "node { name: 'int' op: 'TestInt' input: [ 'input' ] }"
+      "node { name: 'unknown' op: 'ABC' }",
+      &def));
+  Graph expected(OpRegistry::Global());
+  Status expected_status =
+      ConvertGraphDefToGraph(GraphConstructorOptions(), def, &expected);
+  EXPECT_FALSE(expected_status.ok());
+
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  GraphConstructorOptions opts;
+  opts.thread_pool = &pool;
+  EXPECT_EQ(expected_status, ConvertGraphDefToGraph(opts, def, &graph_));
+}
+
 TEST_F(GraphConstructorTest, Error_ControlEdgeBeforeRealInput) {
   ExpectError(
       "node { name: 'W1' op: 'TestParams' }"
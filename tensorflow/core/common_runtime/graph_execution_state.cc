@@ -49,6 +49,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
@@ -69,6 +70,14 @@ bool IsCollectiveV2(const string& op) {
          op == "CollectiveBcastRecvV2" || op == "CollectiveBcastSendV2" ||
          op == "ColectiveReduceScatterV2";
 }
+
+// Returns the key of the graph optimized in the background for
+// `callable_options`.
+string BackgroundOptimizationKey(const CallableOptions& callable_options) {
+  string key;
+  SerializeToStringDeterministic(callable_options, &key);
+  return key;
+}
 }  // namespace
 
 GraphExecutionState::GraphExecutionState(
@@ -85,6 +94,13 @@ GraphExecutionState::GraphExecutionState(
       run_placer_(options.run_placer) {}
 
 GraphExecutionState::~GraphExecutionState() {
+  std::unique_ptr<thread::ThreadPool> background_optimization_pool;
+  {
+    mutex_lock l(background_mu_);
+    background_optimization_pool = std::move(background_optimization_pool_);
+  }
+  // Wait for the background optimizations, which use the state below.
+  background_optimization_pool.reset();
   node_name_to_cost_id_map_.clear();
   delete graph_;
 }
@@ -810,11 +826,53 @@ Status GraphExecutionState::OptimizeGraph(
       }
     }
 
-    // Now we can run the MetaOptimizer on the constructed GrapplerItem.
+    // With background optimization, the graph is optimized at tier O1 until
+    // it has been optimized at O2 in the background.
     GraphDef new_graph;
-    TF_RETURN_IF_ERROR(
-        grappler::RunMetaOptimizer(std::move(item), session_options_->config,
-                                   cpu_device, &cluster, &new_graph));
+    bool background_optimized = false;
+    if (BackgroundOptimizationEnabled()) {
+      const string key = BackgroundOptimizationKey(options.callable_options);
+      mutex_lock l(background_mu_);
+      auto it = background_optimized_graphs_.find(key);
+      if (it != background_optimized_graphs_.end()) {
+        new_graph = it->second;
+        background_optimized = true;
+      } else if (background_optimizations_started_.insert(key).second) {
+        if (background_optimization_pool_ == nullptr) {
+          background_optimization_pool_ = std::make_unique<thread::ThreadPool>(
+              Env::Default(), "graph_background_optimization", 1);
+        }
+        ConfigProto config = session_options_->config;
+        config.mutable_graph_options()
+            ->mutable_rewrite_options()
+            ->set_optimization_tier(RewriterConfig::O2);
+        auto background_item = std::make_shared<grappler::GrapplerItem>(item);
+        background_optimization_pool_->Schedule(
+            [this, key, config, background_item, cpu_device]() {
+              grappler::VirtualCluster cluster(device_set_);
+              GraphDef optimized_graph;
+              Status s = grappler::RunMetaOptimizer(
+                  std::move(*background_item), config, cpu_device, &cluster,
+                  &optimized_graph);
+              // A failed optimization is not retried: the graph stays
+              // optimized at O1.
+              if (!s.ok()) {
+                LOG(WARNING) << "Background graph optimization failed: " << s;
+                return;
+              }
+              VLOG(1) << "Background graph optimization done";
+              mutex_lock l(background_mu_);
+              background_optimized_graphs_[key] = std::move(optimized_graph);
+            });
+      }
+    }
+
+    // Now we can run the MetaOptimizer on the constructed GrapplerItem.
+    if (!background_optimized) {
+      TF_RETURN_IF_ERROR(
+          grappler::RunMetaOptimizer(std::move(item), session_options_->config,
+                                     cpu_device, &cluster, &new_graph));
+    }
 
     // Merge optimized graph function library with an original library.
     // Optimized graph might have new functions specialized for it's
@@ -854,6 +912,24 @@ Status GraphExecutionState::OptimizeGraph(
 #endif  // IS_MOBILE_PLATFORM
 }
 
+bool GraphExecutionState::BackgroundOptimizationEnabled() const {
+  if (session_options_ == nullptr ||
+      session_options_->config.graph_options().place_pruned_graph()) {
+    return false;
+  }
+  const RewriterConfig& rewrite_options =
+      session_options_->config.graph_options().rewrite_options();
+  return rewrite_options.optimization_tier() == RewriterConfig::O1 &&
+         rewrite_options.background_optimization();
+}
+
+bool GraphExecutionState::HasBackgroundOptimizedGraph(
+    const CallableOptions& callable_options) const {
+  const string key = BackgroundOptimizationKey(callable_options);
+  mutex_lock l(background_mu_);
+  return background_optimized_graphs_.contains(key);
+}
+
 Status GraphExecutionState::BuildGraph(const BuildGraphOptions& options,
                                        std::unique_ptr<ClientGraph>* out) {
   VLOG(1) << "BuildGraph";
@@ -870,6 +946,9 @@ Status GraphExecutionState::BuildGraph(const BuildGraphOptions& options,
   std::unique_ptr<Graph> optimized_graph;
   std::unique_ptr<FunctionLibraryDefinition> optimized_flib;
 
+  const bool awaiting_background_optimization =
+      BackgroundOptimizationEnabled() &&
+      !HasBackgroundOptimizedGraph(options.callable_options);
   Status s = OptimizeGraph(options, *graph_, flib_def_.get(), &optimized_graph,
                            &optimized_flib);
   if (!s.ok()) {
@@ -968,6 +1047,8 @@ Status GraphExecutionState::BuildGraph(const BuildGraphOptions& options,
       new ClientGraph(std::move(optimized_flib), rewrite_metadata.feed_types,
                       rewrite_metadata.fetch_types, collective_graph_key));
   CopyGraph(*optimized_graph, &dense_copy->graph);
+  dense_copy->awaiting_background_optimization =
+      awaiting_background_optimization;
 
   // TODO(vrv): We should check invariants of the graph here.
   metrics::UpdateGraphBuildTime(Env::Default()->NowMicros() - start_time_usecs);
@@ -21,6 +21,8 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/build_graph_options.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_set.h"
@@ -29,7 +31,9 @@ limitations under the License.
 #include "tensorflow/core/graph/costmodel.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -69,6 +73,9 @@ struct ClientGraph {
   DataTypeVector feed_types;
   DataTypeVector fetch_types;
   int64_t collective_graph_key;
+  // True if the graph is optimized at tier O1 while it is being optimized at
+  // O2 in the background (see RewriterConfig.background_optimization).
+  bool awaiting_background_optimization = false;
 };
 
 // GraphExecutionState is responsible for generating an
@@ -150,6 +157,13 @@ class GraphExecutionState {
       std::unique_ptr<Graph>* optimized_graph,
       std::unique_ptr<FunctionLibraryDefinition>* optimized_flib);
 
+  // Returns true if the graph for `callable_options` has been optimized in
+  // the background, so that BuildGraph() now returns the fully optimized
+  // graph instead of the one it returned with awaiting_background_optimization
+  // set.
+  bool HasBackgroundOptimizedGraph(
+      const CallableOptions& callable_options) const;
+
   // The graph returned by BuildGraph may contain only the pruned
   // graph, whereas some clients may want access to the full graph.
   const Graph* full_graph() { return graph_; }
@@ -228,6 +242,21 @@ class GraphExecutionState {
   // Whether to run Placer.
   bool run_placer_;
 
+  // Returns true if the graphs are optimized at tier O1 first and at O2 in the
+  // background.
+  bool BackgroundOptimizationEnabled() const;
+
+  // The graphs optimized in the background, by serialized CallableOptions.
+  mutable mutex background_mu_;
+  absl::flat_hash_map<string, GraphDef> background_optimized_graphs_
+      TF_GUARDED_BY(background_mu_);
+  // The graphs being optimized in the background, or that failed to be.
+  absl::flat_hash_set<string> background_optimizations_started_
+      TF_GUARDED_BY(background_mu_);
+  // Runs the background optimizations.
+  std::unique_ptr<thread::ThreadPool> background_optimization_pool_
+      TF_GUARDED_BY(background_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(GraphExecutionState);
 };
 
@@ -0,0 +1,385 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+
+enum Phase {
+  kReduceScatterPhase = 0,
+  kRingReduceScatterPhase = 1,
+  kRingAllGatherPhase = 2,
+  kAllGatherPhase = 3,
+};
+
+// Groups the ranks of the members of `col_params` by task, in order of first
+// appearance. Returns false if the tasks do not all have the same number of
+// devices.
+bool GroupRanksByTask(const CollectiveParams& col_params,
+                      std::vector<std::vector<int>>* ranks_by_task) {
+  absl::flat_hash_map<string, int> task_indices;
+  ranks_by_task->clear();
+  for (int rank = 0; rank < col_params.group.members.size(); ++rank) {
+    const string& task = col_params.group.members[rank].task;
+    auto it = task_indices.emplace(task, ranks_by_task->size()).first;
+    if (it->second == ranks_by_task->size()) ranks_by_task->emplace_back();
+    (*ranks_by_task)[it->second].push_back(rank);
+  }
+  for (const std::vector<int>& ranks : *ranks_by_task) {
+    if (ranks.size() != ranks_by_task->front().size()) return false;
+  }
+  return !ranks_by_task->empty();
+}
+
+}  // namespace
+
+HierarchicalRingReducer::HierarchicalRingReducer()
+    : col_ctx_(nullptr),
+      col_params_(nullptr),
+      num_tasks_(0),
+      num_local_devices_(0),
+      task_idx_(-1),
+      local_idx_(-1) {}
+
+Status HierarchicalRingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE) {
+    return errors::Internal("HierarchicalRingReduce expects a reduction, got ",
+                            col_params->instance.type);
+  }
+  std::vector<std::vector<int>> ranks_by_task;
+  if (!GroupRanksByTask(*col_params, &ranks_by_task)) {
+    return errors::InvalidArgument(
+        "HierarchicalRingReduce requires the same number of devices on every "
+        "task of group ",
+        col_params->group.group_key);
+  }
+  return OkStatus();
+}
+
+Status HierarchicalRingReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  if (!GroupRanksByTask(*col_params_, &ranks_by_task_)) {
+    return errors::InvalidArgument(
+        "HierarchicalRingReduce requires the same number of devices on every "
+        "task of group ",
+        col_params_->group.group_key);
+  }
+  num_tasks_ = ranks_by_task_.size();
+  num_local_devices_ = ranks_by_task_.front().size();
+  for (int t = 0; t < num_tasks_; ++t) {
+    for (int l = 0; l < num_local_devices_; ++l) {
+      if (ranks_by_task_[t][l] == col_params_->default_rank) {
+        task_idx_ = t;
+        local_idx_ = l;
+      }
+    }
+  }
+  if (task_idx_ < 0) {
+    return errors::Internal("Rank ", col_params_->default_rank,
+                            " is not a member of group ",
+                            col_params_->group.group_key);
+  }
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalRingReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Like `RingReducer`, this implementation doesn't require non-overlapping
+  // collectives.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    Notification note;
+    Status status;
+    profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    if (!status.ok()) {
+      done(status);
+      return;
+    }
+  }
+
+  AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  ca_.reset(MakeCollectiveAdapter(col_ctx_->output,
+                                  num_tasks_ * num_local_devices_,
+                                  col_ctx_->device->GetAllocator(attr)));
+  chunks_.clear();
+  for (int i = 0; i < num_tasks_ * num_local_devices_; ++i) {
+    chunks_.push_back(ca_->ChunkAlias(i));
+  }
+  Status s = PrepareGroupSizeTensor();
+  if (s.ok()) s = RunPhases();
+  if (s.ok()) {
+    // Recover the output from the adaptor.
+    ca_->ConsumeFinalValue(col_ctx_->output);
+  }
+  chunks_.clear();  // Give up Refs on output tensor.
+  done(s);
+}
+
+Status HierarchicalRingReducer::PrepareGroupSizeTensor() {
+  if (col_params_->final_op == nullptr) {
+    // Value won't be used, so no need to initialize.
+    return OkStatus();
+  }
+  Tensor group_size_val = ca_->Scalar(col_params_->group.group_size);
+  if (col_params_->group.device_type == "CPU") {
+    group_size_tensor_ = group_size_val;
+    return OkStatus();
+  }
+  group_size_tensor_ = ca_->Scalar(
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+      AllocationAttributes());
+  Notification note;
+  Status status;
+  col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+      &group_size_val, col_ctx_->device, &group_size_tensor_,
+      [&note, &status](const Status& s) {
+        status = s;
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+Status HierarchicalRingReducer::WaitForComputeStream() {
+  const DeviceBase::AcceleratorDeviceInfo* gpu_info =
+      col_ctx_->device->tensorflow_accelerator_device_info();
+  if (gpu_info == nullptr) return OkStatus();
+  // As in RingReducer, wait for the queued events on the compute stream so
+  // that temp buffers allocated on it are valid (e.g. for RDMA write).
+  Notification note;
+  Status s = gpu_info->default_context->ThenExecute(
+      col_ctx_->device, gpu_info->stream, [&note]() { note.Notify(); });
+  if (!s.ok()) {
+    return errors::Internal(
+        "Failed to dispatch ThenExecute in HierarchicalRingReducer");
+  }
+  note.WaitForNotification();
+  return OkStatus();
+}
+
+string HierarchicalRingReducer::BufKey(int phase, int chunk_idx,
+                                       int src_rank) const {
+  return strings::StrCat(col_ctx_->exec_key, ":h", phase, ":", chunk_idx, ":",
+                         src_rank);
+}
+
+Status HierarchicalRingReducer::RunTransfers(
+    std::vector<Transfer>* transfers) {
+  BlockingCounter counter(transfers->size());
+  mutex mu;
+  Status status;
+  auto done = [&counter, &mu, &status](const Status& s) {
+    if (!s.ok()) {
+      mutex_lock l(mu);
+      status.Update(s);
+    }
+    counter.DecrementCount();
+  };
+  for (const Transfer& t : *transfers) {
+    const CollGroupMember& peer = col_params_->group.members[t.peer];
+    VLOG(3) << "HierarchicalRingReduce rank=" << col_params_->default_rank
+            << (t.is_send ? " send " : " recv ") << t.key << " peer "
+            << t.peer;
+    if (t.is_send) {
+      col_ctx_->col_exec->remote_access()->PostToPeer(
+          peer.device.name(), peer.task, t.key, col_ctx_->device,
+          col_ctx_->op_ctx->op_device_context(),
+          col_ctx_->op_ctx->output_alloc_attr(0), t.tensor,
+          col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+          done);
+    } else {
+      col_ctx_->col_exec->remote_access()->RecvFromPeer(
+          peer.device.name(), peer.task, peer.is_local, t.key,
+          col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+          col_ctx_->op_ctx->output_alloc_attr(0), t.tensor,
+          col_ctx_->device_locality, 0 /*dev_to_dev_stream_index*/,
+          col_ctx_->op_ctx->cancellation_manager(), done);
+    }
+  }
+  counter.Wait();
+  return status;
+}
+
+Status HierarchicalRingReducer::RunPhases() {
+  {
+    profiler::TraceMe activity("IntraTaskReduceScatter",
+                               profiler::TraceMeLevel::kInfo);
+    TF_RETURN_IF_ERROR(IntraTaskReduceScatter());
+  }
+  {
+    profiler::TraceMe activity("InterTaskAllReduce",
+                               profiler::TraceMeLevel::kInfo);
+    TF_RETURN_IF_ERROR(InterTaskAllReduce());
+  }
+  profiler::TraceMe activity("IntraTaskAllGather",
+                             profiler::TraceMeLevel::kInfo);
+  return IntraTaskAllGather();
+}
+
+Status HierarchicalRingReducer::IntraTaskReduceScatter() {
+  const std::vector<int>& local_ranks = ranks_by_task_[task_idx_];
+  const int my_rank = col_params_->default_rank;
+  // Partial sums of our own shard, received from each other local device.
+  std::vector<Tensor> partials;
+  partials.reserve((num_local_devices_ - 1) * num_tasks_);
+  std::vector<Transfer> transfers;
+  for (int l = 0; l < num_local_devices_; ++l) {
+    if (l == local_idx_) continue;
+    for (int c = 0; c < num_tasks_; ++c) {
+      const int send_idx = ChunkIndex(l, c);
+      transfers.push_back({true, local_ranks[l],
+                           BufKey(kReduceScatterPhase, send_idx, my_rank),
+                           &chunks_[send_idx]});
+      const int recv_idx = ChunkIndex(local_idx_, c);
+      partials.push_back(ca_->TempChunk(recv_idx));
+      transfers.push_back(
+          {false, local_ranks[l],
+           BufKey(kReduceScatterPhase, recv_idx, local_ranks[l]),
+           &partials.back()});
+    }
+  }
+  if (transfers.empty()) return OkStatus();
+  TF_RETURN_IF_ERROR(WaitForComputeStream());
+  TF_RETURN_IF_ERROR(RunTransfers(&transfers));
+  int p = 0;
+  for (int l = 0; l < num_local_devices_; ++l) {
+    if (l == local_idx_) continue;
+    for (int c = 0; c < num_tasks_; ++c) {
+      TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op, &chunks_[ChunkIndex(local_idx_, c)],
+          &partials[p++]));
+    }
+  }
+  return OkStatus();
+}
+
+Status HierarchicalRingReducer::InterTaskAllReduce() {
+  const int my_rank = col_params_->default_rank;
+  const int next_rank =
+      ranks_by_task_[(task_idx_ + 1) % num_tasks_][local_idx_];
+  const int prev_rank =
+      ranks_by_task_[(task_idx_ + num_tasks_ - 1) % num_tasks_][local_idx_];
+  // Reduce-scatter of our shard over the ring of devices with the same local
+  // index: at step s, we forward our partial sum of chunk (t - s) and add the
+  // previous device's partial sum of chunk (t - s - 1).
+  for (int s = 0; s + 1 < num_tasks_; ++s) {
+    const int send_idx =
+        ChunkIndex(local_idx_, (task_idx_ - s + num_tasks_) % num_tasks_);
+    const int recv_idx = ChunkIndex(
+        local_idx_, (task_idx_ - s - 1 + 2 * num_tasks_) % num_tasks_);
+    Tensor partial = ca_->TempChunk(recv_idx);
+    TF_RETURN_IF_ERROR(WaitForComputeStream());
+    std::vector<Transfer> transfers = {
+        {true, next_rank, BufKey(kRingReduceScatterPhase, send_idx, my_rank),
+         &chunks_[send_idx]},
+        {false, prev_rank,
+         BufKey(kRingReduceScatterPhase, recv_idx, prev_rank), &partial}};
+    TF_RETURN_IF_ERROR(RunTransfers(&transfers));
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->merge_op, &chunks_[recv_idx], &partial));
+  }
+  // We now hold the complete sum of chunk (t + 1).
+  const int owned_idx = ChunkIndex(local_idx_, (task_idx_ + 1) % num_tasks_);
+  if (col_params_->final_op) {
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->final_op, &chunks_[owned_idx], &group_size_tensor_));
+  }
+  // All-gather over the same ring, receiving directly into the output.
+  for (int s = 0; s + 1 < num_tasks_; ++s) {
+    const int send_idx =
+        ChunkIndex(local_idx_, (task_idx_ + 1 - s + num_tasks_) % num_tasks_);
+    const int recv_idx =
+        ChunkIndex(local_idx_, (task_idx_ - s + num_tasks_) % num_tasks_);
+    std::vector<Transfer> transfers = {
+        {true, next_rank, BufKey(kRingAllGatherPhase, send_idx, my_rank),
+         &chunks_[send_idx]},
+        {false, prev_rank, BufKey(kRingAllGatherPhase, recv_idx, prev_rank),
+         &chunks_[recv_idx]}};
+    TF_RETURN_IF_ERROR(RunTransfers(&transfers));
+  }
+  return OkStatus();
+}
+
+Status HierarchicalRingReducer::IntraTaskAllGather() {
+  const std::vector<int>& local_ranks = ranks_by_task_[task_idx_];
+  const int my_rank = col_params_->default_rank;
+  std::vector<Transfer> transfers;
+  for (int l = 0; l < num_local_devices_; ++l) {
+    if (l == local_idx_) continue;
+    for (int c = 0; c < num_tasks_; ++c) {
+      const int send_idx = ChunkIndex(local_idx_, c);
+      transfers.push_back({true, local_ranks[l],
+                           BufKey(kAllGatherPhase, send_idx, my_rank),
+                           &chunks_[send_idx]});
+      const int recv_idx = ChunkIndex(l, c);
+      transfers.push_back({false, local_ranks[l],
+                           BufKey(kAllGatherPhase, recv_idx, local_ranks[l]),
+                           &chunks_[recv_idx]});
+    }
+  }
+  if (transfers.empty()) return OkStatus();
+  return RunTransfers(&transfers);
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalRingReduce, HierarchicalRingReducer);
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,103 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+class Device;
+
+// Two-level implementation of collective all-reduce for groups that span
+// several tasks with the same number of devices each.
+//
+// With H tasks of k devices each, the tensor is split into k shards of H
+// chunks. The device with local index l on task h
+//   1. reduce-scatters within its task, so that it holds shard l reduced over
+//      the devices of the task (intra-task links only),
+//   2. runs a ring all-reduce of shard l with the devices of local index l on
+//      the other tasks (k rings of H devices run in parallel, so each
+//      inter-task link carries 1/k of the tensor), and
+//   3. all-gathers the shards within its task.
+// Compared to a flat ring over all H * k devices, inter-task traffic drops
+// from 2 (H * k - 1) to 2 (H - 1) sequential steps per device.
+//
+// CollectiveParamResolverLocal selects this implementation for large
+// reductions over such groups unless NCCL is used.
+class HierarchicalRingReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalRingReducer();
+  ~HierarchicalRingReducer() override = default;
+
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Begins async execution of the hierarchical reduce algorithm.
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // A send of `tensor` to, or a receive into `tensor` from, group member
+  // `peer`.
+  struct Transfer {
+    bool is_send;
+    int peer;
+    string key;
+    Tensor* tensor;
+  };
+
+  // Runs `transfers` concurrently and waits for all of them to finish.
+  Status RunTransfers(std::vector<Transfer>* transfers);
+
+  // Returns the index of chunk `chunk` of shard `shard`.
+  int ChunkIndex(int shard, int chunk) const {
+    return shard * num_tasks_ + chunk;
+  }
+
+  // On GPU, waits until the work queued so far on the compute stream is done.
+  Status WaitForComputeStream();
+
+  string BufKey(int phase, int chunk_idx, int src_rank) const;
+
+  Status RunPhases();
+  Status IntraTaskReduceScatter();
+  Status InterTaskAllReduce();
+  Status IntraTaskAllGather();
+  Status PrepareGroupSizeTensor();
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+  // Ranks of the group members, indexed by task and by local index.
+  std::vector<std::vector<int>> ranks_by_task_;
+  int num_tasks_;
+  int num_local_devices_;
+  int task_idx_;
+  int local_idx_;
+  std::vector<Tensor> chunks_;
+  std::unique_ptr<CollectiveAdapter> ca_;
+  Tensor group_size_tensor_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
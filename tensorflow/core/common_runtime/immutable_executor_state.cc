@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 
 #include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
@@ -40,6 +41,9 @@ ImmutableExecutorState::~ImmutableExecutorState() {
       params_.delete_kernel(item->kernel);
     }
   }
+  for (DeviceContext* device_context : device_context_map_) {
+    if (device_context != nullptr) device_context->Unref();
+  }
 }
 
 namespace {
@@ -83,6 +87,11 @@ ImmutableExecutorState::FrameInfo* ImmutableExecutorState::EnsureFrameInfo(
 
 Status ImmutableExecutorState::Initialize(const Graph& graph) {
   TF_RETURN_IF_ERROR(gview_.Initialize(&graph));
+  TF_RETURN_IF_ERROR(
+      params_.device->FillContextMap(&graph, &device_context_map_));
+  if (!device_context_map_.empty()) {
+    device_context_map_.resize(gview_.num_nodes(), nullptr);
+  }
 
   // Build the information about frames in this subgraph.
   ControlFlowInfo cf_info;
@@ -256,6 +265,15 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
     }
   }
 
+  // Swapped out tensors are tracked within a single frame.
+  const DeviceBase::AcceleratorDeviceInfo* accelerator_device_info =
+      params_.device->tensorflow_accelerator_device_info();
+  if (!requires_control_flow_ && accelerator_device_info != nullptr &&
+      accelerator_device_info->tensor_swapping_memory_fraction > 0) {
+    tensor_swap_plan_ = TensorSwapPlan::Create(
+        graph, accelerator_device_info->tensor_swapping_memory_fraction);
+  }
+
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
   // for all nodes.
   InitializePending(&graph, cf_info);
@@ -24,6 +24,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/local_executor_params.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
+#include "tensorflow/core/common_runtime/tensor_swapper.h"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
@@ -101,6 +103,18 @@ class ImmutableExecutorState {
 
   bool requires_control_flow_support() const { return requires_control_flow_; }
 
+  // Returns the DeviceContext of the node with ID `id`, or nullptr if it uses
+  // the context of the executor's step (see Device::FillContextMap()).
+  DeviceContext* device_context(int id) const {
+    return device_context_map_.empty() ? nullptr : device_context_map_[id];
+  }
+
+  // Returns the tensors that may be swapped out of device memory, or nullptr if
+  // tensor swapping is disabled for the device or the graph has none.
+  const TensorSwapPlan* tensor_swap_plan() const {
+    return tensor_swap_plan_.get();
+  }
+
   // Copies the pending counts for nodes in this graph to the given array.
   //
   // This method provides a more efficient way of initializing
@@ -155,6 +169,12 @@ class ImmutableExecutorState {
   // Shallow copies of the constant tensors used in the graph.
   std::vector<Tensor> const_tensors_;
 
+  // The DeviceContext of each node, indexed by node ID, if the device assigns
+  // contexts per node. Owns one reference on each non-null element.
+  std::vector<DeviceContext*> device_context_map_;
+
+  std::unique_ptr<TensorSwapPlan> tensor_swap_plan_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ImmutableExecutorState);
 };
 
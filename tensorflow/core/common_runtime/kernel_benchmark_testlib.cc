@@ -15,8 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 
+#include <algorithm>
+#include <cstring>
+#include <map>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -36,10 +41,13 @@ limitations under the License.
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace test {
@@ -141,6 +149,130 @@ void Benchmark::Run(benchmark::State& state) {
   RunWithRendezvousArgs({}, {}, state);
 }
 
+namespace {
+
+// Single precision floating point operations per cycle of one core, assuming
+// two fused multiply-add units per core.
+double CpuFlopsPerCycle() {
+  if (port::TestCPUFeature(port::CPUFeature::AVX512F)) return 64;
+  if (port::TestCPUFeature(port::CPUFeature::AVX2) &&
+      port::TestCPUFeature(port::CPUFeature::FMA)) {
+    return 32;
+  }
+  if (port::TestCPUFeature(port::CPUFeature::AVX)) return 16;
+  return 8;
+}
+
+// Measures the bandwidth of a memcpy split across the threads of `pool`; the
+// read and the written bytes are both counted.
+double MeasureCpuBytesPerSecond(thread::ThreadPool* pool) {
+  constexpr int64_t kBytes = 256 << 20;
+  // Filling the buffers faults their pages in before the measurement.
+  std::vector<char> src(kBytes, 1);
+  std::vector<char> dst(kBytes, 0);
+  const int64_t block_size =
+      (kBytes + pool->NumThreads() - 1) / pool->NumThreads();
+  double best = 0;
+  for (int i = 0; i < 5; ++i) {
+    const uint64 start_micros = Env::Default()->NowMicros();
+    pool->ParallelFor(
+        kBytes,
+        thread::ThreadPool::SchedulingParams(
+            thread::ThreadPool::SchedulingStrategy::kFixedBlockSize,
+            absl::nullopt, block_size),
+        [&](int64_t first, int64_t last) {
+          std::memcpy(dst.data() + first, src.data() + first, last - first);
+        });
+    const uint64 elapsed_micros =
+        std::max<uint64>(Env::Default()->NowMicros() - start_micros, 1);
+    best = std::max(best, 2.0 * kBytes * 1e6 / elapsed_micros);
+  }
+  return best;
+}
+
+}  // namespace
+
+MachinePeaks Benchmark::GetMachinePeaks() {
+  static mutex* mu = new mutex();
+  static auto* peaks_by_device = new std::map<string, MachinePeaks>();
+  const string device_type = device_->device_type();
+  mutex_lock l(*mu);
+  auto it = peaks_by_device->find(device_type);
+  if (it != peaks_by_device->end()) return it->second;
+
+  MachinePeaks peaks;
+  float gflops = 0;
+  float gbps = 0;
+  TF_CHECK_OK(ReadFloatFromEnvVar(
+      absl::StrCat("TF_BENCHMARK_", device_type, "_PEAK_GFLOPS"), 0, &gflops));
+  TF_CHECK_OK(ReadFloatFromEnvVar(
+      absl::StrCat("TF_BENCHMARK_", device_type, "_PEAK_GBPS"), 0, &gbps));
+  peaks.flops_per_second = gflops * 1e9;
+  peaks.bytes_per_second = gbps * 1e9;
+
+  if (device_type == DEVICE_CPU) {
+    if (peaks.flops_per_second == 0) {
+      const double cores = port::NumSchedulableCPUs() /
+                           std::max(port::NumHyperthreadsPerCore(), 1);
+      peaks.flops_per_second = std::max(
+          cores * port::NominalCPUFrequency() * CpuFlopsPerCycle(), 0.0);
+    }
+    if (peaks.bytes_per_second == 0) {
+      peaks.bytes_per_second = MeasureCpuBytesPerSecond(pool_);
+    }
+  } else {
+    const DeviceBase::AcceleratorDeviceInfo* info =
+        device_->tensorflow_accelerator_device_info();
+    if (info != nullptr && info->stream != nullptr) {
+      const se::DeviceDescription& description =
+          info->stream->parent()->GetDeviceDescription();
+      if (peaks.flops_per_second == 0) {
+        peaks.flops_per_second = 2.0 * description.core_count() *
+                                 description.fpus_per_core() *
+                                 description.clock_rate_ghz() * 1e9;
+      }
+      if (peaks.bytes_per_second == 0) {
+        peaks.bytes_per_second = description.memory_bandwidth();
+      }
+    }
+  }
+  LOG(INFO) << device_type << " peaks used for roofline reporting: "
+            << peaks.flops_per_second * 1e-9 << " GFLOP/s, "
+            << peaks.bytes_per_second * 1e-9 << " GB/s";
+  peaks_by_device->emplace(device_type, peaks);
+  return peaks;
+}
+
+void Benchmark::ReportRoofline(benchmark::State& state, double flops,
+                               double bytes) {
+  using ::benchmark::Counter;
+  const double iterations = state.iterations();
+  state.counters["FLOP/s"] = Counter(flops * iterations, Counter::kIsRate);
+  state.counters["bytes/s"] = Counter(bytes * iterations, Counter::kIsRate);
+  if (bytes > 0) state.counters["FLOP/byte"] = flops / bytes;
+
+  // The rate of "seconds at peak per iteration" is the fraction of the peak
+  // that was achieved.
+  const MachinePeaks peaks = GetMachinePeaks();
+  double roofline_seconds = 0;
+  if (peaks.flops_per_second > 0) {
+    const double seconds = flops / peaks.flops_per_second;
+    state.counters["compute_peak_frac"] =
+        Counter(seconds * iterations, Counter::kIsRate);
+    roofline_seconds = std::max(roofline_seconds, seconds);
+  }
+  if (peaks.bytes_per_second > 0) {
+    const double seconds = bytes / peaks.bytes_per_second;
+    state.counters["bandwidth_peak_frac"] =
+        Counter(seconds * iterations, Counter::kIsRate);
+    roofline_seconds = std::max(roofline_seconds, seconds);
+  }
+  if (peaks.flops_per_second > 0 && peaks.bytes_per_second > 0) {
+    state.counters["roofline_frac"] =
+        Counter(roofline_seconds * iterations, Counter::kIsRate);
+  }
+}
+
 string GetRendezvousKey(const Node* node) {
   string send_device;
   TF_CHECK_OK(GetNodeAttr(node->attrs(), "send_device", &send_device));
@@ -37,6 +37,13 @@ class StaticDeviceMgr;
 
 namespace test {
 
+// Peak throughput of a device, used to put benchmark results on a roofline.
+// A value of 0 means the peak is unknown.
+struct MachinePeaks {
+  double flops_per_second = 0;
+  double bytes_per_second = 0;
+};
+
 class Benchmark {
  public:
   // "device" must be either "cpu" or "gpu".  Takes ownership of "g",
@@ -63,6 +70,23 @@ class Benchmark {
       const std::vector<std::pair<string, Tensor>>& inputs,
       const std::vector<string>& outputs, benchmark::State& state);
 
+  // Reports the throughput achieved by Run() for a graph that executes
+  // `flops` floating point operations and moves `bytes` bytes between the
+  // kernels and device memory per iteration. Sets the rate counters
+  // "FLOP/s" and "bytes/s", the arithmetic intensity "FLOP/byte" and, for the
+  // peaks that are known, the fractions "compute_peak_frac",
+  // "bandwidth_peak_frac" and "roofline_frac" of the attainable throughput.
+  //
+  // The peaks are read from TF_BENCHMARK_<DEVICE>_PEAK_GFLOPS and
+  // TF_BENCHMARK_<DEVICE>_PEAK_GBPS if set. Otherwise GPU peaks come from the
+  // device description, the CPU compute peak from the core count, frequency
+  // and vector width, and the CPU bandwidth peak from a parallel memcpy that
+  // runs once per process.
+  void ReportRoofline(benchmark::State& state, double flops, double bytes);
+
+  // Returns the peaks ReportRoofline() compares against.
+  MachinePeaks GetMachinePeaks();
+
  private:
   thread::ThreadPool* pool_ = nullptr;  // Not owned.
   Device* device_ = nullptr;            // Not owned.
@@ -0,0 +1,56 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/kernel_cost_estimates.h"
+
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+
+/*static*/ KernelCostEstimates* KernelCostEstimates::Global() {
+  static KernelCostEstimates* global = new KernelCostEstimates;
+  return global;
+}
+
+/*static*/ std::string KernelCostEstimates::Key(StringPiece device_name,
+                                                StringPiece node_name,
+                                                StringPiece op_type) {
+  return strings::StrCat(device_name, ";", node_name, ";", op_type);
+}
+
+bool KernelCostEstimates::Lookup(const std::string& key,
+                                 uint64* cycles) const {
+  tf_shared_lock l(mu_);
+  auto it = estimates_.find(key);
+  if (it == estimates_.end()) return false;
+  *cycles = it->second;
+  return true;
+}
+
+void KernelCostEstimates::Insert(const std::string& key, uint64 cycles) {
+  mutex_lock l(mu_);
+  estimates_[key] = cycles;
+}
+
+absl::flat_hash_map<std::string, uint64> KernelCostEstimates::GetAll() const {
+  tf_shared_lock l(mu_);
+  return estimates_;
+}
+
+size_t KernelCostEstimates::size() const {
+  tf_shared_lock l(mu_);
+  return estimates_.size();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,72 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_COST_ESTIMATES_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_COST_ESTIMATES_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// KernelCostEstimates stores the kernel costs (in CPU cycles) measured by
+// executors, so that executors created later for the same kernels (e.g. by a
+// later session) start with warm estimates, instead of assuming that every
+// kernel is expensive until enough executions have been measured.
+//
+// An executor created with `LocalExecutorParams::kernel_cost_estimates` set
+// measures every synchronous kernel, seeds its estimates from this object,
+// and stores its estimates back when it is destroyed.
+//
+// This class is thread-safe.
+class KernelCostEstimates {
+ public:
+  KernelCostEstimates() = default;
+
+  // Returns a process-wide instance.
+  static KernelCostEstimates* Global();
+
+  // Returns the key under which the cost of the kernel for node `node_name`
+  // of type `op_type` on device `device_name` is stored.
+  static std::string Key(StringPiece device_name, StringPiece node_name,
+                         StringPiece op_type);
+
+  // Sets `*cycles` to the estimate stored for `key` and returns true, or
+  // returns false if there is none.
+  bool Lookup(const std::string& key, uint64* cycles) const;
+
+  // Stores `cycles` as the estimate for `key`.
+  void Insert(const std::string& key, uint64 cycles);
+
+  // Returns a copy of all stored estimates, e.g. for exporting them.
+  absl::flat_hash_map<std::string, uint64> GetAll() const;
+
+  size_t size() const;
+
+ private:
+  mutable mutex mu_;
+  absl::flat_hash_map<std::string, uint64> estimates_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(KernelCostEstimates);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_COST_ESTIMATES_H_
@@ -0,0 +1,56 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/kernel_cost_estimates.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(KernelCostEstimatesTest, InsertAndLookup) {
+  KernelCostEstimates estimates;
+  const std::string key = KernelCostEstimates::Key("/device:CPU:0", "a", "Add");
+  uint64 cycles = 0;
+  EXPECT_FALSE(estimates.Lookup(key, &cycles));
+
+  estimates.Insert(key, 100);
+  ASSERT_TRUE(estimates.Lookup(key, &cycles));
+  EXPECT_EQ(cycles, 100);
+
+  estimates.Insert(key, 50);
+  ASSERT_TRUE(estimates.Lookup(key, &cycles));
+  EXPECT_EQ(cycles, 50);
+  EXPECT_EQ(estimates.size(), 1);
+}
+
+TEST(KernelCostEstimatesTest, KeysDistinguishDevicesAndOps) {
+  KernelCostEstimates estimates;
+  estimates.Insert(KernelCostEstimates::Key("/device:CPU:0", "a", "Add"), 1);
+  estimates.Insert(KernelCostEstimates::Key("/device:CPU:1", "a", "Add"), 2);
+  estimates.Insert(KernelCostEstimates::Key("/device:CPU:0", "a", "Mul"), 3);
+
+  const auto all = estimates.GetAll();
+  ASSERT_EQ(all.size(), 3);
+  EXPECT_EQ(all.at(KernelCostEstimates::Key("/device:CPU:0", "a", "Add")), 1);
+  EXPECT_EQ(all.at(KernelCostEstimates::Key("/device:CPU:1", "a", "Add")), 2);
+  EXPECT_EQ(all.at(KernelCostEstimates::Key("/device:CPU:0", "a", "Mul")), 3);
+}
+
+TEST(KernelCostEstimatesTest, GlobalIsASingleton) {
+  EXPECT_EQ(KernelCostEstimates::Global(), KernelCostEstimates::Global());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -27,6 +27,7 @@ class Device;
 class StepStatsCollector;
 class SessionMetadata;
 class FunctionLibraryRuntime;
+class KernelCostEstimates;
 class NodeProperties;
 class OpKernel;
 using tsl::Status;
@@ -52,6 +53,13 @@ struct LocalExecutorParams {
 
   // Whether control flow nodes are allowed to be executed synchronously.
   bool allow_control_flow_sync_execution = false;
+
+  // If not null, the executor measures the cost of every synchronous kernel
+  // (not only of those for which `OpKernel::IsExpensive()` returns true), and
+  // runs kernels whose measured cost is below a threshold inline. The initial
+  // estimates are read from `kernel_cost_estimates`, and the final estimates
+  // are stored back into it when the executor is destroyed. Not owned.
+  KernelCostEstimates* kernel_cost_estimates = nullptr;
 };
 
 }  // end namespace tensorflow
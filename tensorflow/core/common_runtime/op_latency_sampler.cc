@@ -0,0 +1,157 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/op_latency_sampler.h"
+
+#include <array>
+#include <string>
+
+#include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+// The number of samples buffered per thread.
+constexpr int kBufferSize = 256;
+
+// The longest time that a sample stays buffered, unless its thread stops
+// recording samples.
+constexpr uint64 kMaxBufferedMicros = 10 * 1000 * 1000;
+
+auto* sampled_op_latency_usecs = monitoring::Sampler<2>::New(
+    {"/tensorflow/core/sampled_op_latency_usecs",
+     "The execution time in microseconds of kernels sampled by the op latency "
+     "sampler.",
+     "model_name", "op_type"},
+    // Powers of 2 up to about 8 seconds.
+    {monitoring::Buckets::Exponential(1, 2, 24)});
+
+auto* sampled_model_latency_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/sampled_model_latency_usecs",
+     "The run time in microseconds of session steps, recorded by the op "
+     "latency sampler.",
+     "model_name"},
+    // Powers of 2 up to about 80 seconds.
+    {monitoring::Buckets::Exponential(10, 2, 24)});
+
+int64_t ReadSamplingPeriod() {
+  int64_t period;
+  Status s = ReadInt64FromEnvVar("TF_OP_LATENCY_SAMPLING_PERIOD",
+                                 /*default_val=*/0, &period);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring TF_OP_LATENCY_SAMPLING_PERIOD: " << s;
+    return 0;
+  }
+  return period > 0 ? period : 0;
+}
+
+// The samples buffered by one thread.
+class ThreadSamples {
+ public:
+  ~ThreadSamples() { Flush(); }
+
+  void Add(StringPiece model_name, StringPiece op_type, bool is_model,
+           uint64 duration_us) {
+    const uint64 now_us = EnvTime::NowMicros();
+    if (size_ == 0) oldest_us_ = now_us;
+    // Assigning to the buffered strings reuses their storage, so that
+    // recording a sample does not allocate once the buffer is warm.
+    Sample& sample = samples_[size_++];
+    sample.model_name.assign(model_name.data(), model_name.size());
+    sample.op_type.assign(op_type.data(), op_type.size());
+    sample.is_model = is_model;
+    sample.duration_us = duration_us;
+    if (size_ == kBufferSize || now_us - oldest_us_ >= kMaxBufferedMicros) {
+      Flush();
+    }
+  }
+
+  void Flush() {
+    // Consecutive samples are often of the same kernel type, so the cell of
+    // the previous sample is reused when possible.
+    const Sample* previous = nullptr;
+    monitoring::SamplerCell* cell = nullptr;
+    for (int i = 0; i < size_; ++i) {
+      const Sample& sample = samples_[i];
+      if (previous == nullptr || sample.is_model != previous->is_model ||
+          sample.model_name != previous->model_name ||
+          sample.op_type != previous->op_type) {
+        cell = sample.is_model
+                   ? sampled_model_latency_usecs->GetCell(sample.model_name)
+                   : sampled_op_latency_usecs->GetCell(sample.model_name,
+                                                       sample.op_type);
+      }
+      cell->Add(static_cast<double>(sample.duration_us));
+      previous = &sample;
+    }
+    size_ = 0;
+  }
+
+  // The number of calls to ShouldSample() left until the next sample.
+  int64_t countdown = 0;
+
+ private:
+  struct Sample {
+    std::string model_name;
+    std::string op_type;
+    bool is_model = false;
+    uint64 duration_us = 0;
+  };
+
+  std::array<Sample, kBufferSize> samples_;
+  int size_ = 0;
+  uint64 oldest_us_ = 0;
+};
+
+ThreadSamples* GetThreadSamples() {
+  thread_local ThreadSamples samples;
+  return &samples;
+}
+
+}  // namespace
+
+int64_t OpLatencySampler::period() {
+  static const int64_t period = ReadSamplingPeriod();
+  return period;
+}
+
+bool OpLatencySampler::ShouldSample() {
+  const int64_t sampling_period = period();
+  if (TF_PREDICT_TRUE(sampling_period == 0)) return false;
+  ThreadSamples* samples = GetThreadSamples();
+  if (--samples->countdown > 0) return false;
+  samples->countdown = sampling_period;
+  return true;
+}
+
+void OpLatencySampler::RecordOp(StringPiece model_name, StringPiece op_type,
+                                uint64 duration_us) {
+  GetThreadSamples()->Add(model_name, op_type, /*is_model=*/false,
+                          duration_us);
+}
+
+void OpLatencySampler::RecordModel(StringPiece model_name,
+                                   uint64 duration_us) {
+  GetThreadSamples()->Add(model_name, /*op_type=*/"", /*is_model=*/true,
+                          duration_us);
+}
+
+void OpLatencySampler::Flush() { GetThreadSamples()->Flush(); }
+
+}  // namespace tensorflow
@@ -0,0 +1,67 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_OP_LATENCY_SAMPLER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_OP_LATENCY_SAMPLER_H_
+
+#include <cstdint>
+
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// OpLatencySampler is an always-on, low-overhead alternative to profiling
+// sessions for production servers. When TF_OP_LATENCY_SAMPLING_PERIOD is set
+// to N > 0, executors time 1 in every N kernels they run and sessions time
+// every step, and the samples are exported as latency histograms through the
+// monitoring API:
+//
+//   /tensorflow/core/sampled_op_latency_usecs{model_name, op_type}
+//   /tensorflow/core/sampled_model_latency_usecs{model_name}
+//
+// where "model_name" is the name in the session's SessionMetadata, or empty if
+// it has none.
+//
+// Recording a sample takes no lock: samples are buffered in a fixed-size
+// buffer per thread, which is added to the histograms when it is full, when
+// its oldest sample is more than a few seconds old, or when the thread exits.
+class OpLatencySampler {
+ public:
+  // Returns the sampling period, or 0 if sampling is disabled.
+  static int64_t period();
+
+  // Returns whether sampling is enabled.
+  static bool Enabled() { return period() > 0; }
+
+  // Returns whether the kernel about to be run by the calling thread should be
+  // timed, which is true for 1 in every period() calls on each thread.
+  static bool ShouldSample();
+
+  // Records that a kernel of type `op_type` run for model `model_name` took
+  // `duration_us` microseconds.
+  static void RecordOp(StringPiece model_name, StringPiece op_type,
+                       uint64 duration_us);
+
+  // Records that a step of model `model_name` took `duration_us`
+  // microseconds.
+  static void RecordModel(StringPiece model_name, uint64 duration_us);
+
+  // Adds the samples buffered by the calling thread to the histograms.
+  static void Flush();
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_OP_LATENCY_SAMPLER_H_
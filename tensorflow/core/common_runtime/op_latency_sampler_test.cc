@@ -0,0 +1,76 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/op_latency_sampler.h"
+
+#include <stdlib.h>
+
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/lib/monitoring/test_utils.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using monitoring::testing::CellReader;
+using monitoring::testing::Histogram;
+
+// The sampling period is read once, so every test sets the same period
+// before using the sampler.
+void EnableSampling() {
+  setenv("TF_OP_LATENCY_SAMPLING_PERIOD", "3", /*overwrite=*/1);
+  ASSERT_EQ(OpLatencySampler::period(), 3);
+}
+
+TEST(OpLatencySamplerTest, SamplesOneInPeriod) {
+  EnableSampling();
+  int num_sampled = 0;
+  for (int i = 0; i < 30; ++i) {
+    if (OpLatencySampler::ShouldSample()) ++num_sampled;
+  }
+  EXPECT_EQ(num_sampled, 10);
+}
+
+TEST(OpLatencySamplerTest, RecordsBufferedSamples) {
+  EnableSampling();
+  CellReader<Histogram> op_latency("/tensorflow/core/sampled_op_latency_usecs");
+  CellReader<Histogram> model_latency(
+      "/tensorflow/core/sampled_model_latency_usecs");
+  OpLatencySampler::RecordOp("model", "MatMul", 100);
+  OpLatencySampler::RecordOp("model", "MatMul", 300);
+  OpLatencySampler::RecordOp("model", "Add", 5);
+  OpLatencySampler::RecordModel("model", 1000);
+
+  // Samples are buffered until they are flushed.
+  EXPECT_FLOAT_EQ(op_latency.Delta("model", "MatMul").num(), 0.0);
+  OpLatencySampler::Flush();
+
+  Histogram matmul = op_latency.Delta("model", "MatMul");
+  EXPECT_FLOAT_EQ(matmul.num(), 2.0);
+  EXPECT_FLOAT_EQ(matmul.sum(), 400.0);
+  EXPECT_FLOAT_EQ(op_latency.Delta("model", "Add").num(), 1.0);
+  EXPECT_FLOAT_EQ(model_latency.Delta("model").sum(), 1000.0);
+}
+
+TEST(OpLatencySamplerTest, FlushesFullBuffer) {
+  EnableSampling();
+  CellReader<Histogram> op_latency("/tensorflow/core/sampled_op_latency_usecs");
+  for (int i = 0; i < 1000; ++i) {
+    OpLatencySampler::RecordOp("", "Identity", 1);
+  }
+  EXPECT_GE(op_latency.Delta("", "Identity").num(), 1000.0 - 256);
+}
+
+}  // namespace
+}  // namespace tensorflow
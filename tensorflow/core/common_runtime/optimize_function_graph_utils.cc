@@ -90,12 +90,24 @@ Status ValidateMultiDeviceOptions(
 
 Status SetArgShape(const std::unordered_map<int, DtypeAndPartialTensorShape>&
                        input_resource_dtypes_and_shapes,
+                   const std::unordered_map<int, PartialTensorShape>&
+                       input_shapes,
                    const std::vector<Node*>& arg_nodes) {
   for (Node* n : arg_nodes) {
     int index;
     TF_RETURN_IF_ERROR(GetNodeAttr(n->def(), "index", &index));
     DataType dtype;
     TF_RETURN_IF_ERROR(GetNodeAttr(n->def(), "T", &dtype));
+    auto shape_iter = input_shapes.find(index);
+    if (shape_iter != input_shapes.end() && dtype != DT_RESOURCE) {
+      // The _Arg shape function reads the static shape of the argument from
+      // `_output_shapes`.
+      TensorShapeProto shape_proto;
+      shape_iter->second.AsProto(&shape_proto);
+      AttrValue shape_attr_value;
+      *shape_attr_value.mutable_list()->add_shape() = shape_proto;
+      n->AddAttr("_output_shapes", shape_attr_value);
+    }
     if (dtype == DT_RESOURCE) {
       auto dtype_and_shape_iter = input_resource_dtypes_and_shapes.find(index);
       if (dtype_and_shape_iter != input_resource_dtypes_and_shapes.end()) {
@@ -389,7 +401,8 @@ StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraph(
   }
 
   TF_RETURN_IF_ERROR(
-      SetArgShape(options.input_resource_dtypes_and_shapes, arg_nodes));
+      SetArgShape(options.input_resource_dtypes_and_shapes,
+                  options.input_shapes, arg_nodes));
   TF_RETURN_IF_ERROR(PinArgsAndRets(
       options.input_devices, options.output_devices, dev_set, arg_nodes,
       ret_nodes, lib_def,
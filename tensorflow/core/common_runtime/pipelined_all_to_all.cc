@@ -0,0 +1,412 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/pipelined_all_to_all.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+namespace {
+
+// A chunk of the slice of a flattened tensor exchanged with a peer.
+struct Chunk {
+  int peer;
+  // Index of the chunk within the slice.
+  int index;
+  Tensor tensor;
+};
+
+// Splits the slices of the flattened `tensor` into chunks of at most
+// `chunk_size` elements, in the order in which they are exchanged: in step s
+// the slice of peer (rank + direction * s) modulo the group size.
+std::vector<Chunk> MakeChunks(const Tensor& tensor,
+                              const std::vector<int64_t>& offsets,
+                              const std::vector<int64_t>& sizes, int rank,
+                              int direction, int64_t chunk_size) {
+  const int group_size = offsets.size();
+  std::vector<Chunk> chunks;
+  for (int step = 0; step < group_size; ++step) {
+    const int peer =
+        ((rank + direction * step) % group_size + group_size) % group_size;
+    const int64_t end = offsets[peer] + sizes[peer];
+    int index = 0;
+    for (int64_t begin = offsets[peer]; begin < end; begin += chunk_size) {
+      const int64_t limit = std::min(begin + chunk_size, end);
+      chunks.push_back({peer, index++, tensor.Slice(begin, limit)});
+    }
+  }
+  return chunks;
+}
+
+// State of a single PipelinedAllToAll::Exchange() call, which deletes itself
+// once all chunks are exchanged.
+class ChunkedExchange {
+ public:
+  ChunkedExchange(std::shared_ptr<CollectiveContext> col_ctx,
+                  const string& key_prefix, std::vector<Chunk> sends,
+                  std::vector<Chunk> recvs, StatusCallback done)
+      : col_ctx_(std::move(col_ctx)),
+        key_prefix_(strings::StrCat(col_ctx_->exec_key, ":", key_prefix)),
+        done_(std::move(done)) {
+    sends_.chunks = std::move(sends);
+    sends_.is_send = true;
+    recvs_.chunks = std::move(recvs);
+    recvs_.is_send = false;
+    // The extra count is released at the end of Start(), so that the
+    // exchange cannot complete while chunks are still being issued there.
+    num_pending_ = sends_.chunks.size() + recvs_.chunks.size() + 1;
+  }
+
+  void Start() {
+    for (int i = 0; i < PipelinedAllToAll::kMaxPendingChunks; ++i) {
+      int recv;
+      int send;
+      {
+        mutex_lock l(mu_);
+        recv = TakeNext(&recvs_);
+        send = TakeNext(&sends_);
+      }
+      if (recv >= 0) Dispatch(&recvs_, recv);
+      if (send >= 0) Dispatch(&sends_, send);
+    }
+    bool last;
+    {
+      mutex_lock l(mu_);
+      last = --num_pending_ == 0;
+    }
+    if (last) Finish();
+  }
+
+ private:
+  struct Queue {
+    std::vector<Chunk> chunks;
+    bool is_send;
+    // Index of the next chunk to dispatch.
+    int next = 0;
+  };
+
+  // Returns the index of the next chunk of `queue` to dispatch, or -1 if there
+  // is none. After an error the remaining chunks are counted as done instead.
+  int TakeNext(Queue* queue) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (queue->next < queue->chunks.size()) {
+      const int index = queue->next++;
+      if (status_.ok()) return index;
+      --num_pending_;
+    }
+    return -1;
+  }
+
+  void Dispatch(Queue* queue, int index) {
+    Chunk& chunk = queue->chunks[index];
+    const CollectiveParams* col_params = col_ctx_->col_params.get();
+    const int rank = col_params->default_rank;
+    const CollGroupMember& peer = col_params->group.members[chunk.peer];
+    auto done = [this, queue](const Status& s) { ChunkDone(queue, s); };
+    if (queue->is_send) {
+      col_ctx_->col_exec->remote_access()->PostToPeer(
+          peer.device.name(), peer.task,
+          strings::StrCat(key_prefix_, ":", rank, ":", chunk.peer, ":",
+                          chunk.index),
+          col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+          col_ctx_->op_ctx->output_alloc_attr(0), &chunk.tensor,
+          col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+          done);
+    } else {
+      col_ctx_->col_exec->remote_access()->RecvFromPeer(
+          peer.device.name(), peer.task, peer.is_local,
+          strings::StrCat(key_prefix_, ":", chunk.peer, ":", rank, ":",
+                          chunk.index),
+          col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+          col_ctx_->op_ctx->output_alloc_attr(0),
+          &chunk.tensor, col_ctx_->device_locality,
+          /*dev_to_dev_stream_index=*/0,
+          col_ctx_->op_ctx->cancellation_manager(), done);
+    }
+  }
+
+  // Issues the next chunk of `queue` in place of the one that is done.
+  void ChunkDone(Queue* queue, const Status& s) {
+    int next;
+    bool last;
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+      --num_pending_;
+      next = TakeNext(queue);
+      last = num_pending_ == 0;
+    }
+    if (next >= 0) {
+      Dispatch(queue, next);
+    } else if (last) {
+      Finish();
+    }
+  }
+
+  void Finish() {
+    Status s;
+    {
+      mutex_lock l(mu_);
+      s = status_;
+    }
+    StatusCallback done = std::move(done_);
+    delete this;
+    done(s);
+  }
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const string key_prefix_;
+  Queue sends_;
+  Queue recvs_;
+  StatusCallback done_;
+  mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+  int64_t num_pending_ TF_GUARDED_BY(mu_);
+};
+
+// Returns a 1-D tensor sharing the buffer of `tensor`.
+Tensor Flatten(const Tensor& tensor) {
+  Tensor flat;
+  CHECK(flat.CopyFrom(tensor, TensorShape({tensor.NumElements()})));
+  return flat;
+}
+
+// Returns the number of elements in a row of `tensor`, i.e. along its first
+// dimension.
+int64_t RowSize(const Tensor& tensor) {
+  int64_t row_size = 1;
+  for (int d = 1; d < tensor.dims(); ++d) row_size *= tensor.dim_size(d);
+  return row_size;
+}
+
+}  // namespace
+
+PipelinedAllToAll::PipelinedAllToAll()
+    : col_ctx_(nullptr), col_params_(nullptr), done_(nullptr) {}
+
+Status PipelinedAllToAll::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  if (col_ctx->input->dims() == 0 ||
+      col_ctx->input->dim_size(0) != col_ctx->col_params->group.group_size) {
+    return errors::InvalidArgument(
+        "input to all-to-all first dimension size (",
+        col_ctx->input->dims() == 0 ? 0 : col_ctx->input->dim_size(0),
+        ") must be the same as the group size (",
+        col_ctx->col_params->group.group_size, ")");
+  }
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void PipelinedAllToAll::Run(StatusCallback done) {
+  done_ = std::move(done);
+  if (col_ctx_->input->SharesBufferWith(*col_ctx_->output)) {
+    // The input is forwarded to the output, and we need to use a temp buffer.
+    output_buffer_ = Tensor(
+        col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0)),
+        col_ctx_->output->dtype(), col_ctx_->output->shape());
+  } else {
+    output_buffer_ = *col_ctx_->output;
+  }
+  const int group_size = col_params_->group.group_size;
+  std::vector<int64_t> splits(group_size, 1);
+  std::vector<int> identity(group_size);
+  std::vector<int> rank(group_size);
+  for (int i = 0; i < group_size; ++i) {
+    identity[i] = i;
+    // Select output index based on user specified rank, if available.
+    rank[i] = col_params_->group.members[i].rank;
+  }
+  Exchange("", *col_ctx_->input, RowSlices(*col_ctx_->input, splits, identity),
+           &output_buffer_, RowSlices(output_buffer_, splits, rank),
+           [this](const Status& s) { Finish(s); });
+}
+
+void PipelinedAllToAll::Exchange(const string& key_prefix, const Tensor& input,
+                                 const Slices& send, Tensor* output,
+                                 const Slices& recv, StatusCallback done) {
+  const int64_t chunk_size =
+      std::max<int64_t>(1, kChunkBytes / DataTypeSize(input.dtype()));
+  const int rank = col_params_->default_rank;
+  auto* exchange = new ChunkedExchange(
+      col_ctx_, key_prefix,
+      MakeChunks(Flatten(input), send.offsets, send.sizes, rank,
+                 /*direction=*/1, chunk_size),
+      MakeChunks(Flatten(*output), recv.offsets, recv.sizes, rank,
+                 /*direction=*/-1, chunk_size),
+      std::move(done));
+  exchange->Start();
+}
+
+/*static*/ PipelinedAllToAll::Slices PipelinedAllToAll::RowSlices(
+    const Tensor& tensor, const std::vector<int64_t>& splits,
+    const std::vector<int>& rank) {
+  const int group_size = splits.size();
+  std::vector<int64_t> rows_at_index(group_size);
+  for (int i = 0; i < group_size; ++i) rows_at_index[rank[i]] = splits[i];
+  std::vector<int64_t> row_offsets(group_size, 0);
+  for (int i = 1; i < group_size; ++i) {
+    row_offsets[i] = row_offsets[i - 1] + rows_at_index[i - 1];
+  }
+  const int64_t row_size = RowSize(tensor);
+  Slices slices;
+  for (int i = 0; i < group_size; ++i) {
+    slices.offsets.push_back(row_offsets[rank[i]] * row_size);
+    slices.sizes.push_back(splits[i] * row_size);
+  }
+  return slices;
+}
+
+void PipelinedAllToAll::Finish(const Status& s) {
+  if (!s.ok() || col_ctx_->output->SharesBufferWith(output_buffer_)) {
+    done_(s);
+    return;
+  }
+  // We are using a temp buffer. Copy to the output tensor.
+  CollectiveRemoteAccessLocal::MemCpyAsync(
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->op_device_context(), col_ctx_->device, col_ctx_->device,
+      col_ctx_->op_ctx->input_alloc_attr(0),
+      col_ctx_->op_ctx->output_alloc_attr(0), &output_buffer_, col_ctx_->output,
+      /*dev_to_dev_stream_index*/ 0, done_);
+}
+
+Status PipelinedAllToAllV::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  const CollectiveParams& col_params = *col_ctx->col_params;
+  const int group_size = col_params.group.group_size;
+  const Tensor& input = *col_ctx->input;
+  const Tensor& output = *col_ctx->output;
+  if (col_params.send_splits.size() != group_size ||
+      col_params.recv_splits.size() != group_size) {
+    return errors::InvalidArgument(
+        "all-to-all send and receive splits must have one entry per group "
+        "member (",
+        group_size, "), got ", col_params.send_splits.size(), " and ",
+        col_params.recv_splits.size());
+  }
+  if (input.dims() == 0 || output.dims() != input.dims()) {
+    return errors::InvalidArgument(
+        "input and output of all-to-all must have the same rank of at least "
+        "1, got shapes ",
+        input.shape().DebugString(), " and ", output.shape().DebugString());
+  }
+  for (int d = 1; d < input.dims(); ++d) {
+    if (input.dim_size(d) != output.dim_size(d)) {
+      return errors::InvalidArgument(
+          "input and output of all-to-all must have the same row shape, got "
+          "shapes ",
+          input.shape().DebugString(), " and ", output.shape().DebugString());
+    }
+  }
+  int64_t send_rows = 0;
+  int64_t recv_rows = 0;
+  for (int i = 0; i < group_size; ++i) {
+    if (col_params.send_splits[i] < 0 || col_params.recv_splits[i] < 0) {
+      return errors::InvalidArgument("all-to-all splits must be non-negative");
+    }
+    send_rows += col_params.send_splits[i];
+    recv_rows += col_params.recv_splits[i];
+  }
+  if (send_rows != input.dim_size(0) || recv_rows != output.dim_size(0)) {
+    return errors::InvalidArgument(
+        "all-to-all send and receive splits must sum up to the first "
+        "dimension of the input (",
+        input.dim_size(0), ") and output (", output.dim_size(0), "), got ",
+        send_rows, " and ", recv_rows);
+  }
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void PipelinedAllToAllV::Run(StatusCallback done) {
+  done_ = std::move(done);
+  if (col_ctx_->input->SharesBufferWith(*col_ctx_->output)) {
+    output_buffer_ = Tensor(
+        col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0)),
+        col_ctx_->output->dtype(), col_ctx_->output->shape());
+  } else {
+    output_buffer_ = *col_ctx_->output;
+  }
+  const int group_size = col_params_->group.group_size;
+  std::vector<int> identity(group_size);
+  for (int i = 0; i < group_size; ++i) identity[i] = i;
+
+  // Exchange the number of rows first, so that mismatched splits are reported
+  // as an error instead of corrupting the output.
+  send_sizes_ = Tensor(DT_INT64, TensorShape({group_size}));
+  recv_sizes_ = Tensor(DT_INT64, TensorShape({group_size}));
+  std::copy(col_params_->send_splits.begin(), col_params_->send_splits.end(),
+            send_sizes_.flat<int64_t>().data());
+  const Slices sizes =
+      RowSlices(send_sizes_, std::vector<int64_t>(group_size, 1), identity);
+  Exchange("sizes", send_sizes_, sizes, &recv_sizes_, sizes,
+           [this, identity](const Status& s) {
+             if (!s.ok()) {
+               done_(s);
+               return;
+             }
+             const int group_size = col_params_->group.group_size;
+             std::vector<int> rank(group_size);
+             for (int i = 0; i < group_size; ++i) {
+               const int64_t rows = recv_sizes_.flat<int64_t>()(i);
+               if (rows != col_params_->recv_splits[i]) {
+                 done_(errors::InvalidArgument(
+                     "all-to-all rank ", col_params_->default_rank,
+                     " expects ", col_params_->recv_splits[i],
+                     " rows from rank ", i, ", which sends ", rows));
+                 return;
+               }
+               rank[i] = col_params_->group.members[i].rank;
+             }
+             Exchange("rows", *col_ctx_->input,
+                      RowSlices(*col_ctx_->input, col_params_->send_splits,
+                                identity),
+                      &output_buffer_,
+                      RowSlices(output_buffer_, col_params_->recv_splits, rank),
+                      [this](const Status& s) { Finish(s); });
+           });
+}
+
+namespace {
+REGISTER_COLLECTIVE(PipelinedAllToAll, PipelinedAllToAll);
+REGISTER_COLLECTIVE(PipelinedAllToAllV, PipelinedAllToAllV);
+}  // namespace
+
+}  // namespace tensorflow
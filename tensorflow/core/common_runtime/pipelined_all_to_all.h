@@ -0,0 +1,103 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PIPELINED_ALL_TO_ALL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_PIPELINED_ALL_TO_ALL_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/device.h"
+
+namespace tensorflow {
+
+// Implementation of collective all-to-all that splits the slice exchanged with
+// every peer into chunks of at most kChunkBytes, and keeps at most
+// kMaxPendingChunks sends and receives in flight at a time. In step s of the
+// exchange, rank r sends to rank r + s and receives from rank r - s (modulo
+// the group size), so that every rank receives from a single peer at a time
+// instead of from all of them at once.
+//
+// Selected for all-to-all collectives with communication_hint "pipelined".
+class PipelinedAllToAll : public CollectiveImplementationInterface {
+ public:
+  static constexpr int64_t kChunkBytes = 1 << 20;
+  static constexpr int kMaxPendingChunks = 8;
+
+  PipelinedAllToAll();
+
+  void Run(StatusCallback done) override;
+
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override {
+    return OkStatus();
+  }
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+ protected:
+  // Element offsets and sizes of the slices of a flattened tensor exchanged
+  // with each member of the group, indexed by default rank.
+  struct Slices {
+    std::vector<int64_t> offsets;
+    std::vector<int64_t> sizes;
+  };
+
+  // Sends the `send` slices of `input` to, and receives the `recv` slices of
+  // `output` from, each member of the group, as described above. `key_prefix`
+  // distinguishes concurrent exchanges of the same collective.
+  void Exchange(const string& key_prefix, const Tensor& input,
+                const Slices& send, Tensor* output, const Slices& recv,
+                StatusCallback done);
+
+  // Returns the slices of `tensor` for `splits[i]` rows to or from member i,
+  // where row i is stored at index `rank[i]` of `tensor`.
+  static Slices RowSlices(const Tensor& tensor,
+                          const std::vector<int64_t>& splits,
+                          const std::vector<int>& rank);
+
+  // Calls done_ once the exchange into output_buffer_ is done, copying it to
+  // the output first if it is a temporary buffer.
+  void Finish(const Status& s);
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+  Tensor output_buffer_;
+  StatusCallback done_;
+};
+
+// Variable-size variant of PipelinedAllToAll. Member i of the group is sent
+// col_params->send_splits[i] consecutive rows of the input, the first
+// dimension of which is the sum of send_splits, and the rows received from
+// the members are concatenated in the same order as in AllToAll. The
+// receiving sizes in col_params->recv_splits are exchanged before the data,
+// and must match what the peers send.
+class PipelinedAllToAllV : public PipelinedAllToAll {
+ public:
+  void Run(StatusCallback done) override;
+
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+ private:
+  Tensor send_sizes_;
+  Tensor recv_sizes_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_PIPELINED_ALL_TO_ALL_H_
@@ -0,0 +1,245 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/pipelined_all_to_all.h"
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kNumDevices = 3;
+
+class PipelinedAllToAllTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    test_env_ = CreateCollectiveTestEnv(/*num_workers*/ 1,
+                                        /*num_devices_per_worker*/ kNumDevices,
+                                        DEVICE_CPU);
+  }
+
+  // Runs `collective_name` on every device, with inputs[i] and outputs[i] on
+  // device i, and returns the status of each device.
+  std::vector<Status> Run(
+      const string& collective_name, CollectiveType collective_type,
+      std::vector<Tensor>* inputs, std::vector<Tensor>* outputs,
+      const std::vector<std::vector<int64_t>>& splits = {},
+      const std::vector<std::vector<int32>>& device_ranks = {{}}) {
+    std::vector<Status> statuses(kNumDevices);
+    BlockingCounter counter(kNumDevices);
+    for (int i = 0; i < kNumDevices; ++i) {
+      SchedClosure([&, i]() {
+        auto col_params = CreateCollectiveParams(
+            *test_env_, i, collective_name, collective_type,
+            (*inputs)[i].dtype(), (*inputs)[i].shape(), device_ranks);
+        for (int j = 0; j < splits.size(); ++j) {
+          col_params->send_splits.push_back(splits[i][j]);
+          col_params->recv_splits.push_back(splits[j][i]);
+        }
+        Device* device = nullptr;
+        TF_CHECK_OK(test_env_->device_mgr->LookupDevice(
+            col_params->group.members[i].device.name(), &device));
+        statuses[i] = RunCollective(test_env_.get(), col_params.get(), device,
+                                    &(*inputs)[i], &(*outputs)[i]);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    return statuses;
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+};
+
+TEST_F(PipelinedAllToAllTest, Success) {
+  std::vector<Tensor> tensors = {
+      test::AsTensor<double>({1., 2., 3.}),
+      test::AsTensor<double>({4., 5., 6.}),
+      test::AsTensor<double>({7., 8., 9.}),
+  };
+  for (const Status& s :
+       Run("PipelinedAllToAll", ALL_TO_ALL_COLLECTIVE, &tensors, &tensors)) {
+    TF_EXPECT_OK(s);
+  }
+  test::ExpectTensorEqual<double>(tensors[0],
+                                  test::AsTensor<double>({1., 4., 7.}));
+  test::ExpectTensorEqual<double>(tensors[1],
+                                  test::AsTensor<double>({2., 5., 8.}));
+  test::ExpectTensorEqual<double>(tensors[2],
+                                  test::AsTensor<double>({3., 6., 9.}));
+}
+
+TEST_F(PipelinedAllToAllTest, SuccessDifferentRank) {
+  std::vector<Tensor> tensors = {
+      test::AsTensor<double>({1., 2., 3.}),
+      test::AsTensor<double>({4., 5., 6.}),
+      test::AsTensor<double>({7., 8., 9.}),
+  };
+  for (const Status& s :
+       Run("PipelinedAllToAll", ALL_TO_ALL_COLLECTIVE, &tensors, &tensors,
+           /*splits=*/{}, /*device_ranks=*/{{2, 1, 0}})) {
+    TF_EXPECT_OK(s);
+  }
+  test::ExpectTensorEqual<double>(tensors[0],
+                                  test::AsTensor<double>({7., 4., 1.}));
+  test::ExpectTensorEqual<double>(tensors[1],
+                                  test::AsTensor<double>({8., 5., 2.}));
+  test::ExpectTensorEqual<double>(tensors[2],
+                                  test::AsTensor<double>({9., 6., 3.}));
+}
+
+TEST_F(PipelinedAllToAllTest, MultipleChunks) {
+  // Each slice is split into three chunks, so that there are more chunks to
+  // send than can be in flight at a time.
+  static_assert(3 * kNumDevices > PipelinedAllToAll::kMaxPendingChunks);
+  const int64_t row_size =
+      2 * PipelinedAllToAll::kChunkBytes / sizeof(float) + 7;
+  std::vector<Tensor> inputs;
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < kNumDevices; ++i) {
+    Tensor input(DT_FLOAT, TensorShape({kNumDevices, row_size}));
+    auto matrix = input.matrix<float>();
+    for (int j = 0; j < kNumDevices; ++j) {
+      for (int64_t k = 0; k < row_size; ++k) matrix(j, k) = i * 10 + j + k;
+    }
+    inputs.push_back(input);
+    outputs.emplace_back(DT_FLOAT, input.shape());
+  }
+  for (const Status& s :
+       Run("PipelinedAllToAll", ALL_TO_ALL_COLLECTIVE, &inputs, &outputs)) {
+    TF_EXPECT_OK(s);
+  }
+  for (int i = 0; i < kNumDevices; ++i) {
+    auto matrix = outputs[i].matrix<float>();
+    for (int j = 0; j < kNumDevices; ++j) {
+      for (int64_t k = 0; k < row_size; k += 1001) {
+        ASSERT_EQ(matrix(j, k), j * 10 + i + k);
+      }
+      ASSERT_EQ(matrix(j, row_size - 1), j * 10 + i + row_size - 1);
+    }
+  }
+}
+
+TEST_F(PipelinedAllToAllTest, WrongFirstDimensionSize) {
+  std::vector<Tensor> tensors = {
+      test::AsTensor<double>({1., 2.}),
+      test::AsTensor<double>({4., 5.}),
+      test::AsTensor<double>({7., 8.}),
+  };
+  for (const Status& s :
+       Run("PipelinedAllToAll", ALL_TO_ALL_COLLECTIVE, &tensors, &tensors)) {
+    EXPECT_TRUE(errors::IsInvalidArgument(s));
+  }
+}
+
+// Returns the input of the variable-size all-to-all on `rank`: the rows sent to
+// rank j are {100 * rank + 10 * j + r, -r} for r in [0, splits[rank][j]).
+Tensor SplitsInput(const std::vector<std::vector<int64_t>>& splits, int rank) {
+  std::vector<int> values;
+  for (int j = 0; j < kNumDevices; ++j) {
+    for (int r = 0; r < splits[rank][j]; ++r) {
+      values.push_back(100 * rank + 10 * j + r);
+      values.push_back(-r);
+    }
+  }
+  return test::AsTensor<int>(
+      values, {static_cast<int64_t>(values.size() / 2), 2});
+}
+
+TEST_F(PipelinedAllToAllTest, VariableSize) {
+  // splits[i][j] is the number of rows rank i sends to rank j.
+  const std::vector<std::vector<int64_t>> splits = {
+      {1, 0, 3}, {2, 2, 0}, {0, 4, 1}};
+  std::vector<Tensor> inputs;
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < kNumDevices; ++i) {
+    inputs.push_back(SplitsInput(splits, i));
+    int64_t recv_rows = 0;
+    for (int j = 0; j < kNumDevices; ++j) recv_rows += splits[j][i];
+    outputs.emplace_back(DT_INT32, TensorShape({recv_rows, 2}));
+  }
+  for (const Status& s : Run("PipelinedAllToAllV", ALL_TO_ALL_V_COLLECTIVE,
+                             &inputs, &outputs, splits)) {
+    TF_EXPECT_OK(s);
+  }
+  test::ExpectTensorEqual<int>(
+      outputs[0], test::AsTensor<int>({0, 0, 100, 0, 101, -1}, {3, 2}));
+  test::ExpectTensorEqual<int>(
+      outputs[1],
+      test::AsTensor<int>({110, 0, 111, -1, 210, 0, 211, -1, 212, -2, 213, -3},
+                          {6, 2}));
+  test::ExpectTensorEqual<int>(
+      outputs[2], test::AsTensor<int>({20, 0, 21, -1, 22, -2, 220, 0}, {4, 2}));
+}
+
+TEST_F(PipelinedAllToAllTest, VariableSizeMismatchedSplits) {
+  // Every rank expects one row from each rank, but sends none to itself and
+  // two to the next rank, so every rank fails before exchanging any rows.
+  std::vector<std::vector<int64_t>> send_splits(
+      kNumDevices, std::vector<int64_t>(kNumDevices, 1));
+  for (int i = 0; i < kNumDevices; ++i) {
+    --send_splits[i][i];
+    ++send_splits[i][(i + 1) % kNumDevices];
+  }
+  std::vector<Status> statuses(kNumDevices);
+  BlockingCounter counter(kNumDevices);
+  for (int i = 0; i < kNumDevices; ++i) {
+    SchedClosure([&, i]() {
+      Tensor input = SplitsInput(send_splits, i);
+      Tensor output(DT_INT32, TensorShape({kNumDevices, 2}));
+      auto col_params = CreateCollectiveParams(
+          *test_env_, i, "PipelinedAllToAllV", ALL_TO_ALL_V_COLLECTIVE,
+          DT_INT32, input.shape());
+      col_params->send_splits = send_splits[i];
+      col_params->recv_splits = std::vector<int64_t>(kNumDevices, 1);
+      Device* device = nullptr;
+      TF_CHECK_OK(test_env_->device_mgr->LookupDevice(
+          col_params->group.members[i].device.name(), &device));
+      statuses[i] = RunCollective(test_env_.get(), col_params.get(), device,
+                                  &input, &output);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  for (const Status& s : statuses) {
+    EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  }
+}
+
+TEST_F(PipelinedAllToAllTest, VariableSizeWrongSplits) {
+  const std::vector<std::vector<int64_t>> splits = {
+      {1, 1, 1}, {1, 1, 1}, {1, 1, 1}};
+  std::vector<Tensor> inputs;
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < kNumDevices; ++i) {
+    // One row short of what the splits send.
+    inputs.push_back(test::AsTensor<int>({1, 2, 3, 4}, {2, 2}));
+    outputs.emplace_back(DT_INT32, TensorShape({3, 2}));
+  }
+  for (const Status& s : Run("PipelinedAllToAllV", ALL_TO_ALL_V_COLLECTIVE,
+                             &inputs, &outputs, splits)) {
+    EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -53,9 +53,11 @@ limitations under the License.
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/dump_graph.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/reffed_status_callback.h"
 #include "tensorflow/tsl/platform/statusor.h"
 #if !defined(IS_MOBILE_PLATFORM)
@@ -66,6 +68,52 @@ namespace tensorflow {
 
 const char ProcessFunctionLibraryRuntime::kDefaultFLRDevice[] = "null";
 
+namespace {
+
+int64_t OptimizedGraphCacheSizeFromEnv() {
+  int64_t size;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_MULTI_DEVICE_FUNCTION_GRAPH_CACHE_SIZE",
+                                  /*default_val=*/0, &size));
+  return size;
+}
+
+// Returns the key under which the optimized graph of the multi-device
+// function `function_name` instantiated as `function_key` is cached. Besides
+// the instantiation key, it covers the definitions of the function and of the
+// functions it calls, which may have been replaced since, and the names of
+// the devices that the function may be placed on.
+uint64 OptimizedGraphCacheKey(
+    const string& function_key, const string& function_name,
+    const FunctionLibraryDefinition& lib_def, const DeviceSet& dev_set,
+    const std::vector<CompositeDevice*>& composite_devices) {
+  uint64 key = Fingerprint64(function_key);
+  const FunctionDef* fdef = lib_def.Find(function_name);
+  if (fdef != nullptr) {
+    key = FingerprintCat64(key, FunctionDefHash(*fdef));
+    const FunctionLibraryDefinition reachable =
+        lib_def.ReachableDefinitions(*fdef);
+    std::vector<string> names = reachable.ListFunctionNames();
+    std::sort(names.begin(), names.end());
+    for (const string& name : names) {
+      key = FingerprintCat64(key, FunctionDefHash(*reachable.Find(name)));
+    }
+  }
+  std::vector<string> devices;
+  for (const Device* device : dev_set.devices()) {
+    devices.push_back(device->name());
+  }
+  for (const CompositeDevice* device : composite_devices) {
+    devices.push_back(device->name());
+  }
+  std::sort(devices.begin(), devices.end());
+  for (const string& device : devices) {
+    key = FingerprintCat64(key, Fingerprint64(device));
+  }
+  return key;
+}
+
+}  // namespace
+
 void ProcessFunctionLibraryRuntime::FunctionData::DistributedInit(
     DistributedFunctionLibraryRuntime* parent, const string& function_name,
     const FunctionLibraryDefinition& lib_def, AttrSlice attrs,
@@ -110,7 +158,8 @@ ProcessFunctionLibraryRuntime::ProcessFunctionLibraryRuntime(
       rendezvous_factory_(std::move(rendezvous_factory)),
       optimizer_options_(optimizer_options),
       graph_def_version_(graph_def_version),
-      stats_publisher_factory_(std::move(stats_publisher_factory)) {
+      stats_publisher_factory_(std::move(stats_publisher_factory)),
+      optimized_graph_cache_size_(OptimizedGraphCacheSizeFromEnv()) {
   if (device_mgr == nullptr) {
     (*flr_map_)[nullptr] = NewFunctionLibraryRuntime(
         nullptr, env, config_ ? &(*config_) : nullptr, nullptr,
@@ -563,13 +612,46 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
       options.lib_def != nullptr
           ? options.lib_def->FindOptimizedFunctionGraph(function_name)
           : lib_def_->FindOptimizedFunctionGraph(function_name);
+  // Else look up the optimized graph of an earlier instantiation.
+  uint64 optimized_graph_key = 0;
+  std::shared_ptr<const OptimizedFunctionGraph> cached_graph_proto;
+  if (optimized_graph_proto == nullptr && optimized_graph_cache_size_ > 0) {
+    optimized_graph_key = OptimizedGraphCacheKey(
+        function_key, function_name,
+        options.lib_def != nullptr ? *options.lib_def : *lib_def_, *dev_set,
+        composite_devices);
+    tf_shared_lock l(mu_);
+    auto it = optimized_graph_cache_.find(optimized_graph_key);
+    if (it != optimized_graph_cache_.end()) {
+      cached_graph_proto = it->second;
+    }
+  }
+  if (cached_graph_proto != nullptr) {
+    VLOG(1) << "Reusing the optimized graph of MultiDevice function \""
+            << function_name << "\"";
+  }
   StatusOr<OptimizedFunctionGraphInfo> optimized_graph_info =
-      optimized_graph_proto == nullptr
-          ? OptimizeFunctionGraph(function_name, attrs, options, *dev_set,
+      optimized_graph_proto != nullptr
+          ? OptimizedFunctionGraphInfo::FromProto(*optimized_graph_proto)
+      : cached_graph_proto != nullptr
+          ? OptimizedFunctionGraphInfo::FromProto(*cached_graph_proto)
+          : OptimizeFunctionGraph(function_name, attrs, options, *dev_set,
                                   lib_def_, composite_devices, cpu_device,
-                                  default_device, env_)
-          : OptimizedFunctionGraphInfo::FromProto(*optimized_graph_proto);
+                                  default_device, env_);
   if (!optimized_graph_info.ok()) return optimized_graph_info.status();
+  if (optimized_graph_key != 0 && cached_graph_proto == nullptr) {
+    auto proto = std::make_shared<const OptimizedFunctionGraph>(
+        OptimizedFunctionGraphInfo::ToProto(*optimized_graph_info));
+    mutex_lock l(mu_);
+    if (optimized_graph_cache_.emplace(optimized_graph_key, std::move(proto))
+            .second) {
+      optimized_graph_cache_order_.push_back(optimized_graph_key);
+      if (optimized_graph_cache_order_.size() > optimized_graph_cache_size_) {
+        optimized_graph_cache_.erase(optimized_graph_cache_order_.front());
+        optimized_graph_cache_order_.pop_front();
+      }
+    }
+  }
 
   // Resets the library registration correctly.
   optimized_graph_info->function_graph->mutable_flib_def()
@@ -616,6 +698,11 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
       function_name, function_key, optimized_graph_info->num_return_nodes,
       std::move(optimized_graph_info->lib_def),
       std::move(optimized_graph_info->ret_types));
+  if (options.shape_specialization_threshold > 0 &&
+      options.max_shape_specializations > 0) {
+    data->shape_specializations_ = std::make_unique<ShapeSpecializations>(
+        this, function_name, attrs, options);
+  }
 
   int i = 0;
   // Generate a random function_name to avoid one function reuse the partition
@@ -747,6 +834,14 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   }
   TF_RETURN_IF_ERROR(group.as_summary_status());
 
+  // Cross-process runs register their rendezvous under the run's step id, so
+  // only local functions can reuse one across runs.
+  if (options.reuse_rendezvous_across_runs && !data->is_cross_process_ &&
+      rendezvous_factory_) {
+    data->rendezvous_pool_ =
+        std::make_unique<RendezvousPool>(&rendezvous_factory_, device_mgr_);
+  }
+
   *handle = AddMultiDeviceHandle(std::move(data), function_key);
   VLOG(1) << "Instantiated MultiDevice function \"" << function_name
           << "\" with handle " << *handle;
@@ -1164,6 +1259,9 @@ Status ProcessFunctionLibraryRuntime::ReleaseMultiDeviceHandle(
   // If we are here we are releasing the last instantiation of `handle`.
   // Release all component function handles.
   Status overall_status;
+  if (mdata->shape_specializations_ != nullptr) {
+    overall_status = mdata->shape_specializations_->ReleaseAll();
+  }
   for (const auto& it : mdata->glue_) {
     const string& device = it.first;
     FunctionLibraryRuntime::Handle flr_handle = it.second.handle;
@@ -1189,6 +1287,135 @@ Status ProcessFunctionLibraryRuntime::ReleaseMultiDeviceHandle(
   return overall_status;
 }
 
+void ProcessFunctionLibraryRuntime::RefMultiDeviceHandle(
+    FunctionLibraryRuntime::Handle handle) {
+  mutex_lock l(mu_);
+  ++mdevice_data_[handle]->instantiation_counter_;
+}
+
+namespace {
+// The maximum number of input shape signatures whose runs are counted for a
+// function before the counts are reset.
+constexpr int kMaxCountedShapeSignatures = 1024;
+
+// Returns a key identifying the shapes of `args`. Resource handles are left out
+// since their shapes are always scalar.
+string InputShapeSignature(gtl::ArraySlice<Tensor> args) {
+  string signature;
+  for (const Tensor& arg : args) {
+    if (arg.dtype() != DT_RESOURCE) {
+      for (int d = 0; d < arg.dims(); ++d) {
+        strings::StrAppend(&signature, arg.dim_size(d), ",");
+      }
+    }
+    signature.push_back(';');
+  }
+  return signature;
+}
+}  // namespace
+
+ProcessFunctionLibraryRuntime::ShapeSpecializations::ShapeSpecializations(
+    ProcessFunctionLibraryRuntime* pflr, const string& function_name,
+    AttrSlice attrs, const FunctionLibraryRuntime::InstantiateOptions& options)
+    : pflr_(pflr),
+      function_name_(function_name),
+      attrs_(attrs.begin(), attrs.end()),
+      options_(options) {}
+
+FunctionLibraryRuntime::Handle
+ProcessFunctionLibraryRuntime::ShapeSpecializations::Acquire(
+    gtl::ArraySlice<Tensor> args) {
+  const string signature = InputShapeSignature(args);
+  {
+    mutex_lock l(mu_);
+    auto it = variant_index_.find(signature);
+    if (it != variant_index_.end()) {
+      variants_.splice(variants_.begin(), variants_, it->second);
+      pflr_->RefMultiDeviceHandle(it->second->second);
+      return it->second->second;
+    }
+    if (counts_.size() >= kMaxCountedShapeSignatures &&
+        !counts_.contains(signature)) {
+      // Too many distinct shapes: start counting over, but remember the
+      // variants that failed to instantiate or are being instantiated.
+      absl::erase_if(counts_, [](const auto& count) {
+        return count.second >= 0;
+      });
+    }
+    int& count = counts_[signature];
+    if (count < 0 || ++count < options_.shape_specialization_threshold) {
+      return kInvalidHandle;
+    }
+    count = -1;
+  }
+
+  FunctionLibraryRuntime::InstantiateOptions options = options_;
+  options.shape_specialization_threshold = 0;
+  options.graph_collector = nullptr;
+  for (int i = 0; i < args.size(); ++i) {
+    if (args[i].dtype() != DT_RESOURCE) {
+      options.input_shapes[i] = PartialTensorShape(args[i].shape().dim_sizes());
+    }
+  }
+  VLOG(1) << "Specializing multi-device function \"" << function_name_
+          << "\" to input shapes " << signature;
+  FunctionLibraryRuntime::Handle handle;
+  Status s = pflr_->InstantiateMultiDevice(function_name_, AttrSlice(&attrs_),
+                                           options, &handle);
+  if (!s.ok()) {
+    // The signature keeps a count of -1, so that runs with these shapes keep
+    // using the generic function.
+    LOG(WARNING) << "Failed to specialize multi-device function \""
+                 << function_name_ << "\" to input shapes " << signature
+                 << ": " << s;
+    return kInvalidHandle;
+  }
+
+  FunctionLibraryRuntime::Handle evicted = kInvalidHandle;
+  {
+    mutex_lock l(mu_);
+    counts_.erase(signature);
+    variants_.emplace_front(signature, handle);
+    variant_index_[signature] = variants_.begin();
+    if (variants_.size() > options_.max_shape_specializations) {
+      evicted = variants_.back().second;
+      variant_index_.erase(variants_.back().first);
+      variants_.pop_back();
+    }
+    pflr_->RefMultiDeviceHandle(handle);
+  }
+  // Runs in flight on the evicted variant hold their own references.
+  if (evicted != kInvalidHandle) {
+    Release(evicted);
+  }
+  return handle;
+}
+
+void ProcessFunctionLibraryRuntime::ShapeSpecializations::Release(
+    FunctionLibraryRuntime::Handle handle) {
+  Status s = pflr_->ReleaseHandle(handle);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to release shape-specialized variant of "
+                 << "multi-device function \"" << function_name_
+                 << "\": " << s;
+  }
+}
+
+Status ProcessFunctionLibraryRuntime::ShapeSpecializations::ReleaseAll() {
+  std::list<std::pair<string, FunctionLibraryRuntime::Handle>> variants;
+  {
+    mutex_lock l(mu_);
+    variants.swap(variants_);
+    variant_index_.clear();
+    counts_.clear();
+  }
+  Status status;
+  for (const auto& variant : variants) {
+    status.Update(pflr_->ReleaseHandle(variant.second));
+  }
+  return status;
+}
+
 Status ProcessFunctionLibraryRuntime::ReleaseHandle(
     FunctionLibraryRuntime::Handle handle) {
   // Return directly if all function handles has already been released.
@@ -1212,9 +1439,60 @@ Status ProcessFunctionLibraryRuntime::ReleaseHandle(
   return errors::InvalidArgument("Handle not found: ", handle);
 }
 
+ProcessFunctionLibraryRuntime::RendezvousPool::~RendezvousPool() {
+  for (Rendezvous* rendezvous : idle_) {
+    CleanUp(rendezvous, step_ids_[rendezvous]);
+  }
+}
+
+Status ProcessFunctionLibraryRuntime::RendezvousPool::Acquire(
+    int64_t step_id, Rendezvous** rendezvous) {
+  {
+    mutex_lock l(mu_);
+    if (!idle_.empty()) {
+      *rendezvous = idle_.back();
+      idle_.pop_back();
+      return OkStatus();
+    }
+  }
+  TF_RETURN_IF_ERROR((*factory_)(step_id, device_mgr_, rendezvous));
+  mutex_lock l(mu_);
+  step_ids_[*rendezvous] = step_id;
+  return OkStatus();
+}
+
+void ProcessFunctionLibraryRuntime::RendezvousPool::Release(
+    Rendezvous* rendezvous, const Status& status) {
+  int64_t step_id;
+  {
+    mutex_lock l(mu_);
+    if (status.ok() && idle_.size() < kMaxIdle) {
+      idle_.push_back(rendezvous);
+      return;
+    }
+    auto it = step_ids_.find(rendezvous);
+    DCHECK(it != step_ids_.end());
+    step_id = it->second;
+    step_ids_.erase(it);
+  }
+  CleanUp(rendezvous, step_id);
+}
+
+void ProcessFunctionLibraryRuntime::RendezvousPool::CleanUp(
+    Rendezvous* rendezvous, int64_t step_id) {
+  rendezvous->Unref();
+  Status s = factory_->CleanUp(step_id);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+  }
+}
+
 void ProcessFunctionLibraryRuntime::CleanupCreatedRendezvous(
-    const Rendezvous* created_rendezvous, const int64_t step_id) const {
-  if (created_rendezvous) {
+    Rendezvous* created_rendezvous, const int64_t step_id,
+    RendezvousPool* pool, const Status& status) const {
+  if (created_rendezvous && pool) {
+    pool->Release(created_rendezvous, status);
+  } else if (created_rendezvous) {
     DCHECK(rendezvous_factory_);
     created_rendezvous->Unref();
     Status s = rendezvous_factory_.CleanUp(step_id);
@@ -1228,10 +1506,10 @@ FunctionLibraryRuntime::DoneCallback
 ProcessFunctionLibraryRuntime::ApplyCleanUpToDoneCallback(
     std::vector<std::unique_ptr<CleanUpItem>>* items,
     FunctionLibraryRuntime::DoneCallback done, const int64_t step_id,
-    const Rendezvous* created_rendezvous) const {
-  return [this, items, done = std::move(done), step_id,
-          created_rendezvous](const Status& status) {
-    this->CleanupCreatedRendezvous(created_rendezvous, step_id);
+    Rendezvous* created_rendezvous, RendezvousPool* pool) const {
+  return [this, items, done = std::move(done), step_id, created_rendezvous,
+          pool](const Status& status) {
+    this->CleanupCreatedRendezvous(created_rendezvous, step_id, pool, status);
     auto* local_status = new Status(status);
     CleanUp(items, [local_status, done](const Status& cleanup_status) {
       local_status->Update(cleanup_status);
@@ -1243,7 +1521,7 @@ ProcessFunctionLibraryRuntime::ApplyCleanUpToDoneCallback(
 }
 
 Status ProcessFunctionLibraryRuntime::CreateRendezvous(
-    FunctionLibraryRuntime::Options& opts,
+    FunctionLibraryRuntime::Options& opts, RendezvousPool* pool,
     Rendezvous** created_rendezvous) const {
   DCHECK(opts.rendezvous == nullptr);
   if (!rendezvous_factory_) {
@@ -1252,7 +1530,10 @@ Status ProcessFunctionLibraryRuntime::CreateRendezvous(
         "ProcessFunctionLibraryRuntime was created without a rendezvous "
         "factory.");
   }
-  Status s = rendezvous_factory_(opts.step_id, device_mgr_, created_rendezvous);
+  Status s =
+      pool != nullptr
+          ? pool->Acquire(opts.step_id, created_rendezvous)
+          : rendezvous_factory_(opts.step_id, device_mgr_, created_rendezvous);
   if (s.ok()) {
     opts.rendezvous = *created_rendezvous;
     opts.create_rendezvous = false;
@@ -1319,10 +1600,27 @@ void ProcessFunctionLibraryRuntime::Run(
     FunctionLibraryRuntime::Handle handle, gtl::ArraySlice<Tensor> args,
     std::vector<Tensor>* rets,
     FunctionLibraryRuntime::DoneCallback done) const {
+  const MultiDeviceFunctionData* data = IsMultiDevice(handle);
+  if (data != nullptr && data->shape_specializations_ != nullptr) {
+    ShapeSpecializations* specializations = data->shape_specializations_.get();
+    const FunctionLibraryRuntime::Handle specialized =
+        specializations->Acquire(args);
+    if (specialized != kInvalidHandle) {
+      return Run(opts, specialized, args, rets,
+                 [specializations, specialized,
+                  done = std::move(done)](const Status& s) {
+                   specializations->Release(specialized);
+                   done(s);
+                 });
+    }
+  }
+
   FunctionLibraryRuntime::Options new_opts = opts;
   Rendezvous* created_rendezvous = nullptr;
+  RendezvousPool* rendezvous_pool =
+      data != nullptr ? data->rendezvous_pool_.get() : nullptr;
   if (!opts.rendezvous) {
-    Status s = CreateRendezvous(new_opts, &created_rendezvous);
+    Status s = CreateRendezvous(new_opts, rendezvous_pool, &created_rendezvous);
     if (!s.ok()) {
       done(s);
       return;
@@ -1331,7 +1629,8 @@ void ProcessFunctionLibraryRuntime::Run(
 
   auto* cleanup_items = new std::vector<std::unique_ptr<CleanUpItem>>;
   done = ApplyCleanUpToDoneCallback(cleanup_items, std::move(done),
-                                    new_opts.step_id, created_rendezvous);
+                                    new_opts.step_id, created_rendezvous,
+                                    rendezvous_pool);
   std::vector<FunctionRet>* function_rets = new std::vector<FunctionRet>;
   done = [rets, function_rets, done = std::move(done)](const Status& s) {
     Status status = s;
@@ -1504,12 +1803,26 @@ Status ProcessFunctionLibraryRuntime::RunSync(
     FunctionLibraryRuntime::Handle handle, gtl::ArraySlice<Tensor> args,
     std::vector<Tensor>* rets) const {
   MultiDeviceFunctionData* multi_device_data = IsMultiDevice(handle);
+  if (multi_device_data && multi_device_data->shape_specializations_) {
+    ShapeSpecializations* specializations =
+        multi_device_data->shape_specializations_.get();
+    const FunctionLibraryRuntime::Handle specialized =
+        specializations->Acquire(args);
+    if (specialized != kInvalidHandle) {
+      Status s = RunSync(orig_opts, specialized, args, rets);
+      specializations->Release(specialized);
+      return s;
+    }
+  }
   if (multi_device_data && multi_device_data->enable_sync_execution) {
     metrics::IncrementTestCounter("pflr_runsync", "sync");
     FunctionLibraryRuntime::Options new_opts = orig_opts;
     Rendezvous* created_rendezvous = nullptr;
+    RendezvousPool* rendezvous_pool =
+        multi_device_data->rendezvous_pool_.get();
     if (!new_opts.rendezvous) {
-      TF_RETURN_IF_ERROR(CreateRendezvous(new_opts, &created_rendezvous));
+      TF_RETURN_IF_ERROR(
+          CreateRendezvous(new_opts, rendezvous_pool, &created_rendezvous));
     }
 
     std::vector<FunctionRet> function_rets;
@@ -1520,7 +1833,8 @@ Status ProcessFunctionLibraryRuntime::RunSync(
 
     Status status = RunMultiDeviceSync(new_opts, handle, &function_rets,
                                        std::move(get_component_args));
-    CleanupCreatedRendezvous(created_rendezvous, new_opts.step_id);
+    CleanupCreatedRendezvous(created_rendezvous, new_opts.step_id,
+                             rendezvous_pool, status);
     status.Update(FunctionRetsToTensors(&function_rets, rets));
     return status;
   } else {
@@ -1571,8 +1885,10 @@ void ProcessFunctionLibraryRuntime::Run(
 
   FunctionLibraryRuntime::Options new_opts = opts;
   Rendezvous* created_rendezvous = nullptr;
+  RendezvousPool* rendezvous_pool =
+      data != nullptr ? data->rendezvous_pool_.get() : nullptr;
   if (!opts.rendezvous) {
-    Status s = CreateRendezvous(new_opts, &created_rendezvous);
+    Status s = CreateRendezvous(new_opts, rendezvous_pool, &created_rendezvous);
     if (!s.ok()) {
       done(s);
       return;
@@ -1586,7 +1902,7 @@ void ProcessFunctionLibraryRuntime::Run(
 #else   // !IS_MOBILE_PLATFORM
   auto* cleanup_items = new std::vector<std::unique_ptr<CleanUpItem>>;
   done = ApplyCleanUpToDoneCallback(cleanup_items, done, opts.step_id,
-                                    created_rendezvous);
+                                    created_rendezvous, rendezvous_pool);
 
   auto get_component_args = [&args](const ComponentFunctionData& comp_data,
                                     InternalArgs* comp_args) -> Status {
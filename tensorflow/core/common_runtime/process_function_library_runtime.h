@@ -15,11 +15,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_FUNCTION_LIBRARY_RUNTIME_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_PROCESS_FUNCTION_LIBRARY_RUNTIME_H_
 
+#include <deque>
 #include <functional>
+#include <list>
 #include <optional>
 #include <string>
 #include <unordered_map>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/types/variant.h"
 #include "tensorflow/core/common_runtime/composite_device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -288,6 +291,88 @@ class ProcessFunctionLibraryRuntime {
     AsyncAttributes async_attributes;
   };
 
+  // Shape-specialized variants of a multi-device function instantiated with
+  // a positive InstantiateOptions::shape_specialization_threshold. A variant
+  // is instantiated with the concrete input shapes once the function has been
+  // run often enough with them, and at most
+  // InstantiateOptions::max_shape_specializations variants are kept alive.
+  class ShapeSpecializations {
+   public:
+    ShapeSpecializations(
+        ProcessFunctionLibraryRuntime* pflr, const string& function_name,
+        AttrSlice attrs,
+        const FunctionLibraryRuntime::InstantiateOptions& options);
+
+    // Returns the handle of the variant specialized to the shapes of `args`,
+    // instantiating it if these shapes have been seen often enough, or
+    // kInvalidHandle if the generic function should be run instead. A valid
+    // handle holds a reference that the caller must drop with Release once
+    // the run is done.
+    FunctionLibraryRuntime::Handle Acquire(gtl::ArraySlice<Tensor> args);
+
+    // Drops a reference returned by Acquire.
+    void Release(FunctionLibraryRuntime::Handle handle);
+
+    // Releases all the variants.
+    Status ReleaseAll();
+
+   private:
+    ProcessFunctionLibraryRuntime* const pflr_;
+    const string function_name_;
+    const AttrValueMap attrs_;
+    const FunctionLibraryRuntime::InstantiateOptions options_;
+
+    mutex mu_;
+    // The number of runs with each input shape signature that has no variant
+    // yet, or -1 if the variant is being instantiated or failed to.
+    absl::flat_hash_map<string, int> counts_ TF_GUARDED_BY(mu_);
+    // The variants by input shape signature, most recently used first.
+    std::list<std::pair<string, FunctionLibraryRuntime::Handle>> variants_
+        TF_GUARDED_BY(mu_);
+    absl::flat_hash_map<
+        string,
+        std::list<std::pair<string, FunctionLibraryRuntime::Handle>>::iterator>
+        variant_index_ TF_GUARDED_BY(mu_);
+  };
+
+  // Rendezvous kept between the runs of a multi-device function instantiated
+  // with InstantiateOptions::reuse_rendezvous_across_runs. A rendezvous is
+  // handed to one run at a time and only goes back to the pool when that run
+  // succeeded, so that it never holds tensors or an abort status from a
+  // previous run. Internally synchronized.
+  class RendezvousPool {
+   public:
+    RendezvousPool(const Rendezvous::Factory* factory,
+                   const DeviceMgr* device_mgr)
+        : factory_(factory), device_mgr_(device_mgr) {}
+    ~RendezvousPool();
+
+    // Returns an idle rendezvous in `*rendezvous`, or creates one for
+    // `step_id` if there is none.
+    Status Acquire(int64_t step_id, Rendezvous** rendezvous);
+
+    // Returns a rendezvous obtained from Acquire after the run using it
+    // finished with `status`.
+    void Release(Rendezvous* rendezvous, const Status& status);
+
+   private:
+    // The maximum number of idle rendezvous kept, i.e. the number of
+    // concurrent runs served without creating a rendezvous.
+    static constexpr int kMaxIdle = 8;
+
+    // Drops `rendezvous`, which was created for `step_id`.
+    void CleanUp(Rendezvous* rendezvous, int64_t step_id);
+
+    const Rendezvous::Factory* const factory_;
+    const DeviceMgr* const device_mgr_;
+
+    mutex mu_;
+    // The step id that each rendezvous handed out by this pool was created
+    // for, which the factory needs to clean it up.
+    absl::flat_hash_map<Rendezvous*, int64_t> step_ids_ TF_GUARDED_BY(mu_);
+    std::vector<Rendezvous*> idle_ TF_GUARDED_BY(mu_);
+  };
+
   // Data structure holding information for a single instantiated multi-device
   // function.
   // The fields are filled in during instantiation. Once the object is
@@ -327,6 +412,14 @@ class ProcessFunctionLibraryRuntime {
     // Maps the device name to the information about the component function
     // be run on this device.
     std::unordered_map<string, ComponentFunctionData> glue_;
+
+    // Set if the function has shape-specialized variants. Internally
+    // synchronized.
+    std::unique_ptr<ShapeSpecializations> shape_specializations_;
+
+    // Set if runs of the function that are not given a rendezvous share
+    // rendezvous across runs.
+    std::unique_ptr<RendezvousPool> rendezvous_pool_;
   };
 
   struct CleanUpItem {
@@ -380,6 +473,10 @@ class ProcessFunctionLibraryRuntime {
 
   Status ReleaseMultiDeviceHandle(FunctionLibraryRuntime::Handle handle);
 
+  // Adds a reference to the multi-device function `handle`, to be dropped with
+  // ReleaseHandle.
+  void RefMultiDeviceHandle(FunctionLibraryRuntime::Handle handle);
+
   Status InstantiateMultiDevice(
       const string& function_name, AttrSlice attrs,
       const FunctionLibraryRuntime::InstantiateOptions& options,
@@ -404,16 +501,22 @@ class ProcessFunctionLibraryRuntime {
                    std::vector<std::unique_ptr<CleanUpItem>>* cleanup_items,
                    FunctionLibraryRuntime::DoneCallback done) const;
 
+  // Creates the rendezvous for a run that was not given one, taking it from
+  // `pool` if not null.
   Status CreateRendezvous(FunctionLibraryRuntime::Options& opts,
+                          RendezvousPool* pool,
                           Rendezvous** created_rendezvous) const;
 
-  void CleanupCreatedRendezvous(const Rendezvous* created_rendezvous,
-                                const int64_t step_id) const;
+  // Drops a rendezvous created by CreateRendezvous once the run using it
+  // finished with `status`.
+  void CleanupCreatedRendezvous(Rendezvous* created_rendezvous,
+                                const int64_t step_id, RendezvousPool* pool,
+                                const Status& status) const;
 
   FunctionLibraryRuntime::DoneCallback ApplyCleanUpToDoneCallback(
       std::vector<std::unique_ptr<CleanUpItem>>* items,
       FunctionLibraryRuntime::DoneCallback done, const int64_t step_id,
-      const Rendezvous* rendezvous) const;
+      Rendezvous* rendezvous, RendezvousPool* pool) const;
 
   void CleanUp(std::vector<std::unique_ptr<CleanUpItem>>* items,
                FunctionLibraryRuntime::DoneCallback done) const;
@@ -546,6 +649,20 @@ class ProcessFunctionLibraryRuntime {
   // instantiated function.
   std::vector<std::unique_ptr<StatsPublisherInterface>> stats_publishers_
       TF_GUARDED_BY(mu_);
+
+  // The maximum number of entries in optimized_graph_cache_, set by the
+  // TF_MULTI_DEVICE_FUNCTION_GRAPH_CACHE_SIZE environment variable. Zero
+  // disables the cache.
+  const int64_t optimized_graph_cache_size_;
+  // Optimized graphs of the multi-device functions instantiated so far, by
+  // OptimizedGraphCacheKey. Instantiating a function again, e.g. after it was
+  // released or on a new but equivalent device set, skips graph optimization.
+  // This assumes that `optimize_graph_fn` and the optimization passes give
+  // the same graph for the same function, options and devices.
+  absl::flat_hash_map<uint64, std::shared_ptr<const OptimizedFunctionGraph>>
+      optimized_graph_cache_ TF_GUARDED_BY(mu_);
+  // The keys of optimized_graph_cache_, oldest first.
+  std::deque<uint64> optimized_graph_cache_order_ TF_GUARDED_BY(mu_);
   std::vector<std::unique_ptr<tsl::Notification>> stats_publisher_completed_
       TF_GUARDED_BY(mu_);
 };
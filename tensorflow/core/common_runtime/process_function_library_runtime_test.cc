@@ -1100,6 +1100,116 @@ TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_CreateKernelsEagerly) {
   EXPECT_TRUE(errors::IsInternal(status));
 }
 
+TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_ShapeSpecialization) {
+  Init({test::function::XTimesTwo()});
+  FunctionLibraryRuntime::InstantiateOptions inst_opts =
+      MakeOptions("CPU:0", {"CPU:0"}, {"CPU:0"});
+  inst_opts.shape_specialization_threshold = 2;
+  inst_opts.max_shape_specializations = 1;
+  // Records the static shape of the argument of each instantiation.
+  std::vector<string> arg_shapes;
+  inst_opts.optimize_graph_fn =
+      [&arg_shapes](std::vector<string>, std::vector<string>,
+                    FunctionLibraryDefinition*, const DeviceSet&, Device*,
+                    std::unique_ptr<Graph>* graph) -> Status {
+    for (const Node* node : (*graph)->op_nodes()) {
+      if (!node->IsArg()) continue;
+      const AttrValue* shapes = node->attrs().Find("_output_shapes");
+      arg_shapes.push_back(
+          shapes == nullptr
+              ? "?"
+              : PartialTensorShape(shapes->list().shape(0)).DebugString());
+    }
+    return OkStatus();
+  };
+
+  FunctionLibraryRuntime::Handle handle;
+  TF_CHECK_OK(Instantiate("XTimesTwo", {{"T", DT_FLOAT}}, inst_opts, &handle));
+  EXPECT_EQ(arg_shapes, std::vector<string>({"?"}));
+
+  auto x2 = test::AsTensor<float>({1, 2});
+  auto x3 = test::AsTensor<float>({1, 2, 3});
+  Tensor y;
+  // The second run with a [2] input instantiates a specialized variant.
+  for (int i = 0; i < 3; ++i) {
+    TF_CHECK_OK(RunInstantiated(handle, {}, {x2}, {&y}));
+    test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4}));
+  }
+  EXPECT_EQ(arg_shapes, std::vector<string>({"?", "[2]"}));
+
+  // The variant for [3] inputs takes the place of the one for [2] inputs.
+  for (int i = 0; i < 2; ++i) {
+    TF_CHECK_OK(RunInstantiated(handle, {}, {x3}, {&y}));
+    test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6}));
+  }
+  EXPECT_EQ(arg_shapes, std::vector<string>({"?", "[2]", "[3]"}));
+
+  // Releasing the function releases its variants.
+  TF_CHECK_OK(proc_flr_->ReleaseHandle(handle));
+  Status status = RunInstantiated(handle, {}, {x3}, {&y});
+  EXPECT_TRUE(errors::IsNotFound(status)) << status;
+}
+
+TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_OptimizedGraphCache) {
+  setenv("TF_MULTI_DEVICE_FUNCTION_GRAPH_CACHE_SIZE", "4", /*overwrite=*/1);
+  Init({test::function::XTimesTwo()});
+  unsetenv("TF_MULTI_DEVICE_FUNCTION_GRAPH_CACHE_SIZE");
+  FunctionLibraryRuntime::InstantiateOptions inst_opts =
+      MakeOptions("CPU:0", {"CPU:0"}, {"CPU:0"});
+  int num_optimizations = 0;
+  inst_opts.optimize_graph_fn =
+      [&num_optimizations](std::vector<string>, std::vector<string>,
+                           FunctionLibraryDefinition*, const DeviceSet&,
+                           Device*, std::unique_ptr<Graph>*) -> Status {
+    ++num_optimizations;
+    return OkStatus();
+  };
+
+  auto x = test::AsTensor<float>({1, 2, 3, 4});
+  Tensor y;
+  // Instantiating the function again after releasing it reuses the graph
+  // optimized for the first instantiation.
+  for (int i = 0; i < 2; ++i) {
+    FunctionLibraryRuntime::Handle handle;
+    TF_CHECK_OK(
+        Instantiate("XTimesTwo", {{"T", DT_FLOAT}}, inst_opts, &handle));
+    TF_CHECK_OK(RunInstantiated(handle, {}, {x}, {&y}));
+    test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
+    TF_CHECK_OK(proc_flr_->ReleaseHandle(handle));
+  }
+  EXPECT_EQ(num_optimizations, 1);
+
+  // Another instantiation key misses the cache.
+  FunctionLibraryRuntime::Handle handle;
+  TF_CHECK_OK(Instantiate("XTimesTwo", {{"T", DT_INT32}}, inst_opts, &handle));
+  EXPECT_EQ(num_optimizations, 2);
+  TF_CHECK_OK(proc_flr_->ReleaseHandle(handle));
+}
+
+TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_ReuseRendezvous) {
+  Init({test::function::XTimesTwo()});
+  FunctionLibraryRuntime::InstantiateOptions inst_opts =
+      MakeOptions("CPU:0", {"CPU:0"}, {"CPU:0"});
+  inst_opts.reuse_rendezvous_across_runs = true;
+  FunctionLibraryRuntime::Handle handle;
+  TF_CHECK_OK(Instantiate("XTimesTwo", {{"T", DT_FLOAT}}, inst_opts, &handle));
+
+  auto x = test::AsTensor<float>({1, 2, 3, 4});
+  Tensor y;
+  for (int64_t step_id = 1; step_id <= 3; ++step_id) {
+    FunctionLibraryRuntime::Options opts(step_id);
+    TF_CHECK_OK(RunInstantiated(handle, opts, {x}, {&y}));
+    test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
+  }
+  // All the runs share the rendezvous created for the first one, which stays
+  // alive until the function is released.
+  EXPECT_EQ(1, rendezvous_ref_counts_.size());
+  EXPECT_EQ(1, rendezvous_ref_counts_[1]);
+
+  TF_CHECK_OK(proc_flr_->ReleaseHandle(handle));
+  EXPECT_EQ(0, rendezvous_ref_counts_[1]);
+}
+
 TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_StateHandle) {
   auto T = DT_INT32;
   // The expected sequence of outputs from this function is [6, 4, 0, 1, ...].
@@ -32,6 +32,7 @@ const Tensor* GetTensorValueForDump(const Entry& input) {
     case Entry::State::NO_VALUE:
       return kEmptyTensor;
     case Entry::State::HAS_VALUE:
+    case Entry::State::HAS_SWAPPED_VALUE:
       return input.val.get();
     case Entry::State::HAS_CONST_TENSOR:
       return input.const_tensor;
@@ -42,6 +42,11 @@ PropagatorState::PropagatorState(const ImmutableExecutorState& immutable_state,
       0, new PropagatorState::IterationState(0, root_frame_->pending_counts,
                                              root_frame_->total_input_tensors));
 
+  // The root frame never creates another iteration, so its pending counts can
+  // be updated without holding its lock. When VLOG is enabled, nodes are
+  // marked as started and completed with non-atomic updates under the lock.
+  root_frame_->lock_free = !vlog_;
+
   outstanding_frames_.emplace(root_frame_->frame_id, root_frame_);
 }
 
@@ -331,9 +336,14 @@ void PropagatorState::DeleteFrame(FrameState* frame, TaggedNodeSeq* ready) {
         }
       };
 
+      // NOTE: The pending counts of `parent_iter_state` are updated
+      // atomically, because a `lock_free` parent frame may concurrently
+      // update them without holding `parent_frame->mu`.
       auto propagate_to_non_merge = [&](PendingCounts::Handle dst_pending_id) {
-        parent_iter_state->increment_dead_count(dst_pending_id);
-        return parent_iter_state->decrement_pending(dst_pending_id, 1) == 0;
+        return parent_iter_state
+                   ->adjust_for_activation_atomic(dst_pending_id,
+                                                  /*increment_dead=*/true)
+                   .pending_count == 0;
       };
 
       for (const EdgeInfo& e : item->output_edges()) {
@@ -345,11 +355,11 @@ void PropagatorState::DeleteFrame(FrameState* frame, TaggedNodeSeq* ready) {
         bool dst_ready;
         // We know this is a dead input to dst.
         if (dst_item.is_merge) {
-          parent_iter_state->increment_dead_count(dst_pending_id);
-          const int dead_cnt = parent_iter_state->dead_count(dst_pending_id);
-          dst_dead = (dead_cnt == dst_item.num_inputs);
-          dst_ready =
-              (parent_iter_state->pending(dst_pending_id) == 1) && dst_dead;
+          const PendingCounts::AdjustResult adjust_result =
+              parent_iter_state->adjust_for_increment_dead_atomic(
+                  dst_pending_id);
+          dst_dead = (adjust_result.dead_count == dst_item.num_inputs);
+          dst_ready = (adjust_result.pending_count == 1) && dst_dead;
         } else {
           dst_ready = propagate_to_non_merge(dst_pending_id);
         }
@@ -365,10 +375,11 @@ void PropagatorState::DeleteFrame(FrameState* frame, TaggedNodeSeq* ready) {
         bool dst_ready;
         // We know this is a dead input to dst.
         if (dst_item.is_merge) {
-          parent_iter_state->decrement_pending(dst_pending_id, 2);
-          int count = parent_iter_state->pending(dst_pending_id);
-          int dead_cnt = parent_iter_state->dead_count(dst_pending_id);
-          dst_dead = (dead_cnt == dst_item.num_inputs);
+          const PendingCounts::AdjustResult adjust_result =
+              parent_iter_state->adjust_for_decrement_pending_atomic(
+                  dst_pending_id, 2);
+          const int count = adjust_result.pending_count;
+          dst_dead = (adjust_result.dead_count == dst_item.num_inputs);
           dst_ready = (count == 0) || ((count == 1) && dst_dead);
         } else {
           dst_dead = true;
@@ -379,6 +390,10 @@ void PropagatorState::DeleteFrame(FrameState* frame, TaggedNodeSeq* ready) {
     }
   }
 
+  // A `lock_free` frame may still be accessed by threads that observed its
+  // last outstanding op, so it is deleted with the PropagatorState.
+  if (frame->lock_free) return;
+
   // Delete the frame.
   if (vlog_) VLOG(2) << "Delete frame " << frame->frame_id;
   {
@@ -645,6 +660,10 @@ int PropagatorState::FrameState::ActivateNodesSlowPathShared(
 bool PropagatorState::FrameState::ActivateNodesAndAdjustOutstanding(
     const NodeItem* item, const bool is_dead, IterationState* iter_state,
     EntryVector* outputs, TaggedNodeSeq* ready, int decrement_activation) {
+  if (lock_free) {
+    return ActivateNodesAndAdjustOutstandingLockFree(
+        item, is_dead, iter_state, outputs, ready, decrement_activation);
+  }
   if (TF_PREDICT_FALSE(item->is_any_consumer_merge_or_control_trigger)) {
     tf_shared_lock l(mu);
     int activated =
@@ -668,6 +687,25 @@ bool PropagatorState::FrameState::ActivateNodesAndAdjustOutstanding(
   }
 }
 
+bool PropagatorState::FrameState::ActivateNodesAndAdjustOutstandingLockFree(
+    const NodeItem* item, const bool is_dead, IterationState* iter_state,
+    EntryVector* outputs, TaggedNodeSeq* ready, int decrement_activation) {
+  DCHECK(lock_free);
+  // The pending counts are only ever updated atomically in a `lock_free`
+  // frame, and `iter_state` is kept alive by the op being propagated (or, for
+  // an exit node, by its outstanding child frame).
+  int activated;
+  if (TF_PREDICT_FALSE(item->is_any_consumer_merge_or_control_trigger)) {
+    activated = ActivateNodesSlowPathInternal<true>(item, is_dead, iter_state,
+                                                    outputs, ready);
+  } else {
+    activated = ActivateNodesFastPathInternal<true>(item, is_dead, iter_state,
+                                                    outputs, ready);
+  }
+  return AdjustOutstandingOpsLockFree(iter_state,
+                                      activated - decrement_activation, ready);
+}
+
 int PropagatorState::FrameState::ActivateNodesLocked(const NodeItem* item,
                                                      const bool is_dead,
                                                      IterationState* iter_state,
@@ -850,6 +888,9 @@ bool PropagatorState::FrameState::AdjustOutstandingOps(
   if (delta == 0) {
     return false;
   }
+  if (lock_free) {
+    return AdjustOutstandingOpsLockFree(iter_state, delta, ready);
+  }
   {
     tf_shared_lock sl(mu);
     if (TF_PREDICT_TRUE(!AdjustOutstandingOpsFastPath(iter_state, delta))) {
@@ -867,6 +908,21 @@ bool PropagatorState::FrameState::AdjustOutstandingOpsFastPath(
   return (old_val + delta == 0) && IsIterationDone(iter_state);
 }
 
+bool PropagatorState::FrameState::AdjustOutstandingOpsLockFree(
+    IterationState* iter_state, int delta, TaggedNodeSeq* ready) {
+  DCHECK(lock_free);
+  if (delta == 0) return false;
+  const int64_t iter_num = iter_state->iter_num;
+  auto old_val = iter_state->outstanding_ops.fetch_add(delta);
+  if (TF_PREDICT_TRUE(old_val + delta != 0)) return false;
+  mutex_lock l(mu);
+  // Another thread that holds `mu` (e.g. after the last child frame of this
+  // iteration is done) may have observed the drop to zero first, and already
+  // deleted the iteration.
+  if (GetIteration(iter_num) != iter_state) return false;
+  return CleanupIterations(iter_state, ready);
+}
+
 // Decrement the outstanding op count and clean up the iterations in the
 // frame. Return true iff the execution of the frame is done.
 bool PropagatorState::FrameState::DecrementOutstandingOpsLocked(
@@ -310,6 +310,13 @@ class PropagatorState {
     int total_input_tensors = 0;
     std::vector<const NodeItem*>* nodes = nullptr;
 
+    // If true, activations and adjustments of `outstanding_ops` in this frame
+    // update the pending counts and `outstanding_ops` atomically without
+    // acquiring `mu`, which is only taken when an iteration may be done. This
+    // is only enabled for the root frame, which has a single iteration and is
+    // not deleted before the PropagatorState.
+    bool lock_free = false;
+
     // Lock ordering: ExecutorState.mu_ < mu < iter_mu;
     // during structured traversal: parent_frame->mu < mu.
     mutex mu;
@@ -346,6 +353,10 @@ class PropagatorState {
     bool AdjustOutstandingOpsFastPath(IterationState* iter_state, int delta)
         TF_SHARED_LOCKS_REQUIRED(mu);
 
+    // Variant of `AdjustOutstandingOps()` for frames with `lock_free` set.
+    bool AdjustOutstandingOpsLockFree(IterationState* iter_state, int delta,
+                                      TaggedNodeSeq* ready);
+
     // Convenience methods for the above 'Adjust' calls where delta takes the
     // common value of -1.
     bool DecrementOutstandingOps(IterationState* iter_state,
@@ -392,6 +403,12 @@ class PropagatorState {
         const NodeItem* item, const bool is_dead, IterationState* iter_state,
         EntryVector* outputs, TaggedNodeSeq* ready, int decrement_activation);
 
+    // Variant of the above for frames with `lock_free` set, which does not
+    // acquire `mu` unless the iteration may be done.
+    bool ActivateNodesAndAdjustOutstandingLockFree(
+        const NodeItem* item, const bool is_dead, IterationState* iter_state,
+        EntryVector* outputs, TaggedNodeSeq* ready, int decrement_activation);
+
     // Same as the above, but requires 'mu' already held in exclusive mode.
     int ActivateNodesLocked(const NodeItem* item, const bool is_dead,
                             IterationState* iter_state, EntryVector* outputs,
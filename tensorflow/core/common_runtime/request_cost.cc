@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/request_cost.h"
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 
@@ -36,4 +37,26 @@ absl::flat_hash_map<std::string, absl::Duration> RequestCost::GetCosts() const {
   return cost_map_;
 }
 
+void RequestCost::RecordMetrics(
+    const std::vector<std::pair<absl::string_view, double>>& metrics) {
+  absl::MutexLock lock(&mutex_);
+  for (const auto& metric : metrics) {
+    metric_map_[metric.first] += metric.second;
+  }
+}
+
+void RequestCost::RecordPeakMetrics(
+    const std::vector<std::pair<absl::string_view, double>>& metrics) {
+  absl::MutexLock lock(&mutex_);
+  for (const auto& metric : metrics) {
+    auto it = metric_map_.try_emplace(metric.first, metric.second).first;
+    it->second = std::max(it->second, metric.second);
+  }
+}
+
+absl::flat_hash_map<std::string, double> RequestCost::GetMetrics() const {
+  absl::MutexLock lock(&mutex_);
+  return metric_map_;
+}
+
 }  // namespace tensorflow
@@ -39,11 +39,29 @@ class RequestCost {
   // rpc request, when all the costs have been collected.
   absl::flat_hash_map<std::string, absl::Duration> GetCosts() const;
 
+  // Records metrics that are not durations, e.g. bytes. The inputs should be
+  // pairs of metric type and value, and values of the same type are added.
+  // It's thread-safe, and can be called from different threads.
+  void RecordMetrics(
+      const std::vector<std::pair<absl::string_view, double>>& metrics);
+
+  // Like RecordMetrics(), but keeps the largest value of each type, e.g. for
+  // peak memory.
+  void RecordPeakMetrics(
+      const std::vector<std::pair<absl::string_view, double>>& metrics);
+
+  // Gets all types of metrics for processing an rpc request.
+  // It's thread-safe.
+  absl::flat_hash_map<std::string, double> GetMetrics() const;
+
  private:
   mutable absl::Mutex mutex_;
   // Map from cost type to cost.
   absl::flat_hash_map<std::string, absl::Duration> cost_map_
       ABSL_GUARDED_BY(mutex_);
+  // Map from metric type to value.
+  absl::flat_hash_map<std::string, double> metric_map_
+      ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace tensorflow
@@ -48,5 +48,18 @@ TEST(RequestCostTest, Basic) {
                                    Pair("cpu_v2", absl::Milliseconds(44))));
 }
 
+TEST(RequestCostTest, Metrics) {
+  RequestCost request_cost;
+
+  request_cost.RecordMetrics({{"allocated_bytes", 100}});
+  request_cost.RecordMetrics({{"allocated_bytes", 20}});
+  request_cost.RecordPeakMetrics({{"peak_memory_bytes", 50}});
+  request_cost.RecordPeakMetrics({{"peak_memory_bytes", 30}});
+  EXPECT_THAT(request_cost.GetMetrics(),
+              UnorderedElementsAre(Pair("allocated_bytes", 120),
+                                   Pair("peak_memory_bytes", 50)));
+  EXPECT_TRUE(request_cost.GetCosts().empty());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -18,9 +18,11 @@ limitations under the License.
 #include <limits>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/eval_const_tensor.h"
 #include "tensorflow/core/common_runtime/function_utils.h"
@@ -34,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/tsl/platform/statusor.h"
 
 namespace tensorflow {
@@ -64,6 +67,43 @@ namespace {
 constexpr char kArgOp[] = "_Arg";
 constexpr char kRetvalOp[] = "_Retval";
 
+// Returns the index of the first input of 'c' whose shape is the same handle as
+// input 'i'.
+int FirstInputWithSameShape(InferenceContext* c, int i) {
+  for (int j = 0; j < i; ++j) {
+    if (c->input(j).SameHandle(c->input(i))) return j;
+  }
+  return i;
+}
+
+// Returns the distinct unknown dimensions of the inputs of 'c', in order.
+std::vector<DimensionHandle> UnknownInputDims(InferenceContext* c) {
+  std::vector<DimensionHandle> dims;
+  for (int i = 0; i < c->num_inputs(); ++i) {
+    ShapeHandle s = c->input(i);
+    if (FirstInputWithSameShape(c, i) != i || !c->RankKnown(s)) continue;
+    for (int d = 0; d < c->Rank(s); ++d) {
+      DimensionHandle dim = c->Dim(s, d);
+      if (c->ValueKnown(dim)) continue;
+      if (absl::c_none_of(dims, [&](DimensionHandle other) {
+            return other.SameHandle(dim);
+          })) {
+        dims.push_back(dim);
+      }
+    }
+  }
+  return dims;
+}
+
+// Returns the index of 'dim' in 'dims', appending it if it is not there.
+int64_t FindOrAddDim(DimensionHandle dim, std::vector<DimensionHandle>* dims) {
+  for (int64_t k = 0; k < dims->size(); ++k) {
+    if ((*dims)[k].SameHandle(dim)) return k;
+  }
+  dims->push_back(dim);
+  return dims->size() - 1;
+}
+
 }  // namespace
 
 // Runs shape inference for the given node using the given ShapeRefiner.
@@ -263,11 +303,24 @@ Status ShapeRefiner::AddNodeInternal(
         "', did you forget to define it?");
   }
 
+  std::string memo_key;
+  if (memoize_shape_inference_ && outer_context == nullptr &&
+      !(function_library_ && IsFunctionCall(*function_library_, *node))) {
+    memo_key = ShapeFnMemoKey(node, ic.get());
+  }
+
   std::unique_ptr<ExtendedInferenceContext> ec(
       new ExtendedInferenceContext(std::move(ic), node));
 
-  // Run the shape inference function, and return if there was an error.
-  TF_RETURN_IF_ERROR(RunShapeFn(node, op_reg_data, ec.get(), outer_context));
+  auto memoized = memo_key.empty() ? memoized_shapes_.end()
+                                   : memoized_shapes_.find(memo_key);
+  if (memoized != memoized_shapes_.end()) {
+    SetMemoizedShapes(memoized->second, ec->get_context());
+  } else {
+    // Run the shape inference function, and return if there was an error.
+    TF_RETURN_IF_ERROR(RunShapeFn(node, op_reg_data, ec.get(), outer_context));
+    if (!memo_key.empty()) MemoizeShapeFn(memo_key, ec->get_context());
+  }
 
   // Store the resulting context object in the map.
   node_to_context_[node].swap(ec);
@@ -832,6 +885,121 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
   return OkStatus();
 }
 
+std::string ShapeRefiner::ShapeFnMemoKey(const Node* node,
+                                         InferenceContext* c) const {
+  // Source nodes have cheap shape functions but possibly large attrs, such as
+  // the values of constants.
+  if (c->num_inputs() == 0) return "";
+  for (int i = 0; i < c->num_inputs(); ++i) {
+    if (c->input(i).SameHandle(ShapeHandle()) ||
+        c->input_handle_shapes_and_types(i) != nullptr) {
+      return "";
+    }
+  }
+
+  std::string key = node->type_string();
+  std::vector<std::pair<StringPiece, const AttrValue*>> attrs;
+  for (const auto& attr : node->attrs()) {
+    attrs.emplace_back(attr.first, &attr.second);
+  }
+  std::sort(attrs.begin(), attrs.end());
+  for (const auto& attr : attrs) {
+    const std::string value = attr.second->SerializeAsString();
+    strings::StrAppend(&key, ";", attr.first.size(), ":", attr.first,
+                       value.size(), ":", value);
+  }
+
+  // Unknown dimensions are keyed by their index in UnknownInputDims(), so that
+  // inputs sharing unknown dimensions produce different keys than inputs that
+  // do not.
+  std::vector<DimensionHandle> unknown_dims;
+  for (int i = 0; i < c->num_inputs(); ++i) {
+    ShapeHandle s = c->input(i);
+    const int same_shape = FirstInputWithSameShape(c, i);
+    if (same_shape != i) {
+      strings::StrAppend(&key, ";=", same_shape);
+    } else if (!c->RankKnown(s)) {
+      strings::StrAppend(&key, ";?");
+    } else {
+      strings::StrAppend(&key, ";[");
+      for (int d = 0; d < c->Rank(s); ++d) {
+        DimensionHandle dim = c->Dim(s, d);
+        if (c->ValueKnown(dim)) {
+          strings::StrAppend(&key, c->Value(dim), ",");
+        } else {
+          strings::StrAppend(&key, "?", FindOrAddDim(dim, &unknown_dims), ",");
+        }
+      }
+      strings::StrAppend(&key, "]");
+    }
+  }
+  return key;
+}
+
+void ShapeRefiner::MemoizeShapeFn(const std::string& key, InferenceContext* c) {
+  for (int i = 0; i < c->num_inputs(); ++i) {
+    if (c->requested_input_tensor(i) ||
+        c->requested_input_tensor_as_partial_shape(i)) {
+      return;
+    }
+  }
+  for (int i = 0; i < c->num_outputs(); ++i) {
+    if (c->output_handle_shapes_and_types(i) != nullptr) return;
+  }
+
+  MemoizedShapes shapes;
+  std::vector<DimensionHandle> unknown_dims = UnknownInputDims(c);
+  for (int i = 0; i < c->num_outputs(); ++i) {
+    ShapeHandle s = c->output(i);
+    MemoizedShapes::Output output;
+    for (int j = 0; j < c->num_inputs(); ++j) {
+      if (s.SameHandle(c->input(j))) {
+        output.input = j;
+        break;
+      }
+    }
+    if (output.input < 0 && c->RankKnown(s)) {
+      output.rank_known = true;
+      for (int d = 0; d < c->Rank(s); ++d) {
+        DimensionHandle dim = c->Dim(s, d);
+        output.dims.push_back(c->ValueKnown(dim)
+                                  ? c->Value(dim)
+                                  : -1 - FindOrAddDim(dim, &unknown_dims));
+      }
+    }
+    shapes.outputs.push_back(std::move(output));
+  }
+  memoized_shapes_.emplace(key, std::move(shapes));
+}
+
+void ShapeRefiner::SetMemoizedShapes(const MemoizedShapes& shapes,
+                                     InferenceContext* c) {
+  std::vector<DimensionHandle> unknown_dims = UnknownInputDims(c);
+  for (int i = 0; i < c->num_outputs(); ++i) {
+    const MemoizedShapes::Output& output = shapes.outputs[i];
+    if (output.input >= 0) {
+      c->set_output(i, c->input(output.input));
+    } else if (!output.rank_known) {
+      c->set_output(i, c->UnknownShape());
+    } else {
+      std::vector<DimensionHandle> dims;
+      for (int64_t dim : output.dims) {
+        if (dim >= 0) {
+          dims.push_back(c->MakeDim(dim));
+          continue;
+        }
+        // New unknown dimensions are numbered in the order they were created.
+        const int64_t k = -1 - dim;
+        while (unknown_dims.size() <= k) {
+          unknown_dims.push_back(c->UnknownDim());
+        }
+        dims.push_back(unknown_dims[k]);
+      }
+      c->set_output(i, c->MakeShape(dims));
+    }
+  }
+}
+
 bool ShapeRefiner::SameDefinedShape(InferenceContext* c, ShapeHandle s0,
                                     ShapeHandle s1) {
   if (s0.SameHandle(s1)) {
@@ -156,6 +156,16 @@ class ShapeRefiner {
     return function_library_ != nullptr;
   }
 
+  // If true, the output shapes computed by a shape function are memoized by
+  // the op, attrs and input shapes of the node, and reused for later nodes with
+  // the same signature instead of running the shape function again. This pays
+  // off on large graphs with many repeated nodes, e.g. unrolled loops or
+  // replicas. Nodes whose shape function reads the values of its inputs, and
+  // nodes with resource or variant handle shapes, are never memoized.
+  void set_memoize_shape_inference(bool memoize) {
+    memoize_shape_inference_ = memoize;
+  }
+
  private:
   friend class ShapeRefinerTest;
   friend class ::tensorflow::grappler::GraphProperties;
@@ -293,6 +303,34 @@ class ShapeRefiner {
                     ExtendedInferenceContext* ec,
                     shape_inference::InferenceContext* outer_context = nullptr);
 
+  // Output shapes of a memoized shape function.
+  struct MemoizedShapes {
+    struct Output {
+      // If non-negative, the output is the shape of this input.
+      int input = -1;
+      bool rank_known = false;
+      // A non-negative entry is a known dimension size, and a negative entry
+      // -1-k is the k-th unknown dimension, counting the unknown dimensions of
+      // the inputs first and then the new ones created by the shape function.
+      std::vector<int64_t> dims;
+    };
+    std::vector<Output> outputs;
+  };
+
+  // Returns the key under which the outputs of the shape function of 'node'
+  // with the inputs of 'c' are memoized, or an empty string if they cannot be.
+  std::string ShapeFnMemoKey(const Node* node,
+                             shape_inference::InferenceContext* c) const;
+
+  // Memoizes the outputs of the shape function that was run on 'c' under
+  // 'key', unless they depend on more than the input shapes.
+  void MemoizeShapeFn(const std::string& key,
+                      shape_inference::InferenceContext* c);
+
+  // Sets the outputs of 'c' to the memoized 'shapes'.
+  static void SetMemoizedShapes(const MemoizedShapes& shapes,
+                                shape_inference::InferenceContext* c);
+
   int32 graph_def_version_;
   const OpRegistryInterface* const ops_registry_;
 
@@ -326,6 +364,9 @@ class ShapeRefiner {
   // are refined.
   absl::flat_hash_map<std::string, std::unique_ptr<const Graph>> functions_;
 
+  bool memoize_shape_inference_ = false;
+  absl::flat_hash_map<std::string, MemoizedShapes> memoized_shapes_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ShapeRefiner);
 };
 
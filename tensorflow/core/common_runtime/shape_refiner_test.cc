@@ -59,6 +59,10 @@ class ShapeRefinerTest : public ::testing::Test {
     return ShapeRefiner::IsUpdatedShapesOrTypes(c, existing, updated);
   }
 
+  int64_t NumMemoizedShapes(const ShapeRefiner& m) {
+    return m.memoized_shapes_.size();
+  }
+
   static constexpr int64_t kMaxTensorSize = ShapeRefiner::kMaxTensorSize;
 
   void TestStridedSlice(const PartialTensorShape& input_shape, int begin,
@@ -151,6 +155,68 @@ TEST_F(ShapeRefinerTest, MatMul) {
   EXPECT_SHAPE("[2,2]", m, mm, 0);
 }
 
+TEST_F(ShapeRefinerTest, MemoizeShapeInference) {
+  ShapeRefiner m(TF_GRAPH_DEF_VERSION, OpRegistry::Global());
+  m.set_memoize_shape_inference(true);
+
+  Scope root = Scope::NewRootScope();
+  auto shape = ops::Placeholder::Shape(PartialTensorShape({-1, 2}));
+  auto a0 = ops::Placeholder(root, DT_FLOAT, shape);
+  auto a1 = ops::Placeholder(root, DT_FLOAT, shape);
+  auto b = ops::Placeholder(
+      root, DT_FLOAT, ops::Placeholder::Shape(PartialTensorShape({2, 3})));
+  auto mm0 = ops::MatMul(root, a0, b);
+  auto mm1 = ops::MatMul(root, a1, b);
+  auto mm2 = ops::MatMul(root, b, b, ops::MatMul::TransposeA(true));
+
+  TF_ASSERT_OK(m.AddNode(a0.node()));
+  TF_ASSERT_OK(m.AddNode(a1.node()));
+  TF_ASSERT_OK(m.AddNode(b.node()));
+  // Nodes without inputs are not memoized.
+  EXPECT_EQ(0, NumMemoizedShapes(m));
+  TF_ASSERT_OK(m.AddNode(mm0.node()));
+  TF_ASSERT_OK(m.AddNode(mm1.node()));
+  EXPECT_EQ(1, NumMemoizedShapes(m));
+  TF_ASSERT_OK(m.AddNode(mm2.node()));
+  EXPECT_EQ(2, NumMemoizedShapes(m));
+
+  EXPECT_SHAPE("[?,3]", m, mm0, 0);
+  EXPECT_SHAPE("[?,3]", m, mm1, 0);
+  EXPECT_SHAPE("[3,3]", m, mm2, 0);
+
+  // The memoized output refers to the unknown dimension of its own input.
+  shape_inference::InferenceContext* a1_ctx = m.GetContext(a1.node());
+  shape_inference::InferenceContext* mm1_ctx = m.GetContext(mm1.node());
+  EXPECT_TRUE(SameHandle(a1_ctx->Dim(a1_ctx->output(0), 0),
+                         mm1_ctx->Dim(mm1_ctx->output(0), 0)));
+  shape_inference::InferenceContext* a0_ctx = m.GetContext(a0.node());
+  EXPECT_FALSE(SameHandle(a0_ctx->Dim(a0_ctx->output(0), 0),
+                          mm1_ctx->Dim(mm1_ctx->output(0), 0)));
+}
+
+TEST_F(ShapeRefinerTest, MemoizeShapeInferenceSkipsInputTensors) {
+  ShapeRefiner m(TF_GRAPH_DEF_VERSION, OpRegistry::Global());
+  m.set_memoize_shape_inference(true);
+
+  Scope root = Scope::NewRootScope();
+  auto a = ops::Const(root, {{1.0f, 2.0f, 3.0f}, {4.0f, 5.0f, 6.0f}});
+  auto shape0 = ops::Const(root, {3, 2});
+  auto shape1 = ops::Const(root, {1, 6});
+  auto reshape0 = ops::Reshape(root, a, shape0);
+  auto reshape1 = ops::Reshape(root, a, shape1);
+
+  TF_ASSERT_OK(m.AddNode(a.node()));
+  TF_ASSERT_OK(m.AddNode(shape0.node()));
+  TF_ASSERT_OK(m.AddNode(shape1.node()));
+  TF_ASSERT_OK(m.AddNode(reshape0.node()));
+  TF_ASSERT_OK(m.AddNode(reshape1.node()));
+
+  // The output shape of Reshape depends on the value of its shape input.
+  EXPECT_EQ(0, NumMemoizedShapes(m));
+  EXPECT_SHAPE("[3,2]", m, reshape0, 0);
+  EXPECT_SHAPE("[1,6]", m, reshape1, 0);
+}
+
 TEST_F(ShapeRefinerTest, BadShapes) {
   ShapeRefiner m(TF_GRAPH_DEF_VERSION, OpRegistry::Global());
   Scope root = Scope::NewRootScope();
@@ -0,0 +1,106 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+inline bool LifetimesOverlap(const StaticMemoryPlan::Record& a,
+                             const StaticMemoryPlan::Record& b) {
+  return a.alloc_time < b.free_time && b.alloc_time < a.free_time;
+}
+
+}  // namespace
+
+/*static*/ std::shared_ptr<const StaticMemoryPlan::Layout>
+StaticMemoryPlan::ComputeLayout(const std::vector<Record>& records,
+                                size_t header_space) {
+  auto layout = std::make_shared<Layout>();
+  const int num_records = records.size();
+  layout->header_space = header_space;
+  layout->offsets.resize(num_records);
+  layout->slice_sizes.resize(num_records);
+  for (int i = 0; i < num_records; ++i) {
+    DCHECK_EQ(header_space % records[i].alignment, 0);
+    layout->slice_sizes[i] =
+        (header_space + records[i].num_bytes + header_space - 1) /
+        header_space * header_space;
+    layout->records_by_size[{records[i].num_bytes, records[i].alignment}]
+        .push_back(i);
+  }
+
+  // Greedy by size: place the largest slices first, each at the lowest offset
+  // that does not overlap an already placed slice with an overlapping
+  // lifetime.
+  std::vector<int> order(num_records);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return layout->slice_sizes[a] > layout->slice_sizes[b];
+  });
+  // Indices of the placed records, sorted by offset.
+  std::vector<int> placed;
+  placed.reserve(num_records);
+  for (int i : order) {
+    const size_t slice_size = layout->slice_sizes[i];
+    size_t offset = 0;
+    for (int p : placed) {
+      if (!LifetimesOverlap(records[i], records[p])) continue;
+      if (offset + slice_size <= layout->offsets[p]) break;
+      offset = std::max(offset, layout->offsets[p] + layout->slice_sizes[p]);
+    }
+    layout->offsets[i] = offset;
+    layout->size = std::max(layout->size, offset + slice_size);
+    placed.insert(std::upper_bound(placed.begin(), placed.end(), offset,
+                                   [&](size_t value, int p) {
+                                     return value < layout->offsets[p];
+                                   }),
+                  i);
+  }
+  return layout;
+}
+
+std::shared_ptr<const StaticMemoryPlan::Layout> StaticMemoryPlan::StartStep(
+    bool* record) {
+  mutex_lock l(mu_);
+  *record = false;
+  if (layout_ != nullptr) return layout_;
+  if (!recording_) {
+    recording_ = true;
+    *record = true;
+  }
+  return nullptr;
+}
+
+void StaticMemoryPlan::FinishRecording(const std::vector<Record>& records,
+                                       size_t header_space) {
+  std::shared_ptr<const Layout> layout =
+      records.empty() ? nullptr : ComputeLayout(records, header_space);
+  mutex_lock l(mu_);
+  recording_ = false;
+  layout_ = std::move(layout);
+}
+
+void StaticMemoryPlan::Invalidate(const std::shared_ptr<const Layout>& layout) {
+  mutex_lock l(mu_);
+  if (layout_ == layout) layout_ = nullptr;
+}
+
+}  // namespace tensorflow
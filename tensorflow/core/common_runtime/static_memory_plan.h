@@ -0,0 +1,108 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A StaticMemoryPlan records the lifetimes of the allocations made by one
+// executor during a warm-up step, and assigns each of them an offset in a
+// single buffer such that allocations with overlapping lifetimes do not
+// overlap in memory (using the greedy-by-size heuristic of TFLite's
+// ArenaPlanner). Later steps replay the plan through a StepArenaAllocator,
+// which serves each allocation from its preassigned slice of one buffer.
+//
+// A replayed allocation is matched to the recorded allocation with the same
+// size and alignment and the same rank among allocations of that size. If a
+// step makes an allocation that does not match the plan (e.g. because a shape
+// changed), or whose planned slice is still in use, the allocation falls back
+// to the arena's chunks and the plan is discarded, so that the next step
+// records a new one.
+//
+// This class is thread-safe.
+class StaticMemoryPlan {
+ public:
+  static constexpr int64_t kNeverFreed = std::numeric_limits<int64_t>::max();
+
+  // An allocation observed during the recording step. Times are taken from a
+  // per-step logical clock that ticks on every allocation and deallocation.
+  struct Record {
+    size_t num_bytes;
+    size_t alignment;
+    int64_t alloc_time;
+    int64_t free_time = kNeverFreed;
+  };
+
+  // An immutable offset assignment computed from the records of one step.
+  struct Layout {
+    // Total size of the buffer.
+    size_t size = 0;
+    // Byte offset of each record's slice in the buffer, indexed like the
+    // records the layout was computed from.
+    std::vector<size_t> offsets;
+    // Size of each record's slice.
+    std::vector<size_t> slice_sizes;
+    // For each (num_bytes, alignment), the indices of the matching records in
+    // allocation order.
+    absl::flat_hash_map<std::pair<size_t, size_t>, std::vector<int>>
+        records_by_size;
+    // Number of bytes that each slice reserves in front of the allocation,
+    // for use by the allocator. Each offset is `header_space`-aligned.
+    size_t header_space = 0;
+  };
+
+  // Computes a layout for `records`. Every slice reserves `header_space`
+  // bytes in front of the allocation, and all offsets honor the recorded
+  // alignments, which must divide `header_space`.
+  static std::shared_ptr<const Layout> ComputeLayout(
+      const std::vector<Record>& records, size_t header_space);
+
+  StaticMemoryPlan() = default;
+
+  // Called at the start of a step. Returns the current layout if there is
+  // one. Otherwise, sets `*record` to true iff the calling step must record
+  // its allocations (at most one step records at a time).
+  std::shared_ptr<const Layout> StartStep(bool* record);
+
+  // Called at the end of the recording step.
+  void FinishRecording(const std::vector<Record>& records,
+                       size_t header_space);
+
+  // Discards `layout` if it is the current layout, so that the next step
+  // records a new plan.
+  void Invalidate(const std::shared_ptr<const Layout>& layout);
+
+ private:
+  mutex mu_;
+  std::shared_ptr<const Layout> layout_ TF_GUARDED_BY(mu_);
+  bool recording_ TF_GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticMemoryPlan);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
@@ -0,0 +1,96 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using Record = StaticMemoryPlan::Record;
+
+TEST(StaticMemoryPlanTest, DisjointLifetimesShareMemory) {
+  // Three allocations of 64 bytes that are live one after another.
+  std::vector<Record> records = {
+      {64, 16, 0, 1}, {64, 16, 2, 3}, {64, 16, 4, 5}};
+  auto layout = StaticMemoryPlan::ComputeLayout(records, 16);
+  ASSERT_EQ(layout->offsets.size(), 3);
+  EXPECT_EQ(layout->offsets[0], 0);
+  EXPECT_EQ(layout->offsets[1], 0);
+  EXPECT_EQ(layout->offsets[2], 0);
+  EXPECT_EQ(layout->slice_sizes[0], 16 + 64);
+  EXPECT_EQ(layout->size, 16 + 64);
+}
+
+TEST(StaticMemoryPlanTest, OverlappingLifetimesDoNotOverlap) {
+  std::vector<Record> records = {{64, 16, 0, 3},
+                                 {128, 16, 1, 4},
+                                 {32, 16, 2, StaticMemoryPlan::kNeverFreed},
+                                 {64, 16, 5, 6}};
+  auto layout = StaticMemoryPlan::ComputeLayout(records, 16);
+  for (int i = 0; i < records.size(); ++i) {
+    EXPECT_EQ(layout->offsets[i] % 16, 0);
+    EXPECT_LE(layout->offsets[i] + layout->slice_sizes[i], layout->size);
+    for (int j = 0; j < i; ++j) {
+      const bool lifetimes_overlap =
+          records[i].alloc_time < records[j].free_time &&
+          records[j].alloc_time < records[i].free_time;
+      const bool slices_overlap =
+          layout->offsets[i] < layout->offsets[j] + layout->slice_sizes[j] &&
+          layout->offsets[j] < layout->offsets[i] + layout->slice_sizes[i];
+      EXPECT_FALSE(lifetimes_overlap && slices_overlap) << i << " " << j;
+    }
+  }
+  // The last allocation reuses the memory of one of the first two.
+  EXPECT_LT(layout->size, 16 * 4 + 64 + 128 + 32 + 64);
+  EXPECT_EQ(layout->records_by_size.at({64, 16}), (std::vector<int>{0, 3}));
+}
+
+TEST(StaticMemoryPlanTest, RecordsOnceThenReplays) {
+  StaticMemoryPlan plan;
+  bool record = false;
+  EXPECT_EQ(plan.StartStep(&record), nullptr);
+  EXPECT_TRUE(record);
+  // A concurrent step neither records nor replays.
+  EXPECT_EQ(plan.StartStep(&record), nullptr);
+  EXPECT_FALSE(record);
+
+  plan.FinishRecording({{64, 16, 0, 1}}, 16);
+  auto layout = plan.StartStep(&record);
+  ASSERT_NE(layout, nullptr);
+  EXPECT_FALSE(record);
+
+  plan.Invalidate(layout);
+  EXPECT_EQ(plan.StartStep(&record), nullptr);
+  EXPECT_TRUE(record);
+}
+
+TEST(StaticMemoryPlanTest, InvalidatingAnOldLayoutIsANoop) {
+  StaticMemoryPlan plan;
+  bool record = false;
+  plan.StartStep(&record);
+  plan.FinishRecording({{64, 16, 0, 1}}, 16);
+  auto old_layout = plan.StartStep(&record);
+  plan.Invalidate(old_layout);
+  plan.StartStep(&record);
+  plan.FinishRecording({{32, 16, 0, 1}}, 16);
+  plan.Invalidate(old_layout);
+  EXPECT_NE(plan.StartStep(&record), nullptr);
+}
+
+}  // namespace
+}  // namespace tensorflow
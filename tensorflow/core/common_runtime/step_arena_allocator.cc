@@ -0,0 +1,272 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Returns the number of bytes reserved in front of an allocation with the
+// given alignment to hold its header.
+inline size_t HeaderSpace(size_t header_size, size_t alignment) {
+  return (header_size + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+StepArenaAllocator::StepArenaAllocator(Allocator* wrapped, size_t chunk_size,
+                                       StaticMemoryPlan* plan)
+    : wrapped_(wrapped), chunk_size_(chunk_size), plan_(plan) {
+  DCHECK(wrapped_ != nullptr);
+  if (plan_ != nullptr) {
+    bool record = false;
+    layout_ = plan_->StartStep(&record);
+    recording_ = record;
+  }
+}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  DCHECK_EQ(num_live_chunks_, 0);
+  DCHECK_EQ(num_live_fallbacks_, 0);
+}
+
+std::string StepArenaAllocator::Name() { return wrapped_->Name(); }
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  alignment = std::max(alignment, alignof(Header));
+  const size_t header_space = HeaderSpace(sizeof(Header), alignment);
+  mutex_lock l(mu_);
+  DCHECK(!released_) << "AllocateRaw called after ReleaseAndUnRef";
+  void* ptr = nullptr;
+  if (layout_ != nullptr && !plan_is_stale_ &&
+      alignment <= Allocator::kAllocatorAlignment) {
+    ptr = AllocateFromPlan(alignment, num_bytes);
+    if (ptr != nullptr) ++stats_.num_planned_allocations;
+  }
+  if (ptr == nullptr && num_bytes + header_space <= chunk_size_ / 4) {
+    ptr = AllocateFromChunk(alignment, num_bytes);
+    if (ptr != nullptr) ++stats_.num_arena_allocations;
+  }
+  if (ptr == nullptr) {
+    void* raw = wrapped_->AllocateRaw(alignment, header_space + num_bytes);
+    if (raw == nullptr) return nullptr;
+    ptr = static_cast<char*>(raw) + header_space;
+    Header* header = static_cast<Header*>(ptr) - 1;
+    header->chunk = nullptr;
+    header->raw = raw;
+    header->num_bytes = num_bytes;
+    header->record = -1;
+    ++num_live_fallbacks_;
+    ++stats_.num_fallback_allocations;
+  }
+  if (recording_ && alignment <= Allocator::kAllocatorAlignment) {
+    Header* header = static_cast<Header*>(ptr) - 1;
+    header->record = records_.size();
+    records_.push_back({num_bytes, alignment, clock_++});
+  }
+  stats_.requested_bytes += num_bytes;
+  bytes_in_use_ += num_bytes;
+  stats_.peak_bytes_in_use =
+      std::max(stats_.peak_bytes_in_use, bytes_in_use_);
+  return ptr;
+}
+
+void* StepArenaAllocator::AllocateFromChunk(size_t alignment,
+                                            size_t num_bytes) {
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    if (current_ != nullptr) {
+      const uintptr_t base = reinterpret_cast<uintptr_t>(current_->data);
+      uintptr_t start = base + current_->used + sizeof(Header);
+      start = (start + alignment - 1) / alignment * alignment;
+      if (start + num_bytes <= base + current_->size) {
+        current_->used = start + num_bytes - base;
+        ++current_->refs;
+        Header* header = reinterpret_cast<Header*>(start) - 1;
+        header->chunk = current_;
+        header->raw = nullptr;
+        header->num_bytes = num_bytes;
+        header->record = -1;
+        return reinterpret_cast<void*>(start);
+      }
+      // The current chunk is full: drop the arena's reference on it. It is
+      // released once its remaining allocations are deallocated.
+      Chunk* full = current_;
+      current_ = nullptr;
+      UnRefChunk(full);
+    }
+    void* data = wrapped_->AllocateRaw(Allocator::kAllocatorAlignment,
+                                       chunk_size_);
+    if (data == nullptr) return nullptr;
+    current_ = new Chunk{static_cast<char*>(data), chunk_size_, 0, 1};
+    ++num_live_chunks_;
+    ++stats_.num_chunks;
+    stats_.chunk_bytes += chunk_size_;
+  }
+  return nullptr;
+}
+
+void* StepArenaAllocator::AllocateFromPlan(size_t alignment,
+                                           size_t num_bytes) {
+  static_assert(sizeof(Header) <= Allocator::kAllocatorAlignment,
+                "Planned slices reserve kAllocatorAlignment header bytes");
+  const auto key = std::make_pair(num_bytes, alignment);
+  auto it = layout_->records_by_size.find(key);
+  int& num_served = num_served_by_size_[key];
+  if (it == layout_->records_by_size.end() ||
+      num_served >= static_cast<int>(it->second.size())) {
+    // This step allocates more (or other) buffers than the recorded one.
+    plan_is_stale_ = true;
+    return nullptr;
+  }
+  const int record = it->second[num_served];
+  const size_t start = layout_->offsets[record];
+  const size_t end = start + layout_->slice_sizes[record];
+  auto next = live_slices_.upper_bound(start);
+  if ((next != live_slices_.end() && next->first < end) ||
+      (next != live_slices_.begin() && std::prev(next)->second > start)) {
+    // The allocations of this step are not ordered like the recorded ones.
+    plan_is_stale_ = true;
+    return nullptr;
+  }
+  if (planned_ == nullptr) {
+    void* data =
+        wrapped_->AllocateRaw(Allocator::kAllocatorAlignment, layout_->size);
+    if (data == nullptr) return nullptr;
+    planned_ = new Chunk{static_cast<char*>(data), layout_->size,
+                         layout_->size, 1};
+    ++num_live_chunks_;
+    ++stats_.num_chunks;
+    stats_.chunk_bytes += layout_->size;
+  }
+  ++num_served;
+  live_slices_.emplace(start, end);
+  ++planned_->refs;
+  char* ptr = planned_->data + start + layout_->header_space;
+  Header* header = reinterpret_cast<Header*>(ptr) - 1;
+  header->chunk = planned_;
+  header->raw = nullptr;
+  header->num_bytes = num_bytes;
+  header->record = record;
+  return ptr;
+}
+
+void StepArenaAllocator::UnRefChunk(Chunk* chunk) {
+  if (--chunk->refs == 0) {
+    wrapped_->DeallocateRaw(chunk->data);
+    delete chunk;
+    --num_live_chunks_;
+  }
+}
+
+bool StepArenaAllocator::ShouldDelete() const {
+  return released_ && num_live_chunks_ == 0 && num_live_fallbacks_ == 0;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  Header* header = static_cast<Header*>(ptr) - 1;
+  bool should_delete;
+  {
+    mutex_lock l(mu_);
+    bytes_in_use_ -= header->num_bytes;
+    if (header->record >= 0) {
+      if (layout_ != nullptr) {
+        live_slices_.erase(layout_->offsets[header->record]);
+      } else if (!released_) {
+        records_[header->record].free_time = clock_++;
+      }
+    }
+    if (header->chunk == nullptr) {
+      wrapped_->DeallocateRaw(header->raw);
+      --num_live_fallbacks_;
+    } else {
+      UnRefChunk(header->chunk);
+    }
+    should_delete = ShouldDelete();
+  }
+  if (should_delete) delete this;
+}
+
+absl::optional<AllocatorStats> StepArenaAllocator::GetStats() {
+  mutex_lock l(mu_);
+  AllocatorStats stats;
+  stats.num_allocs =
+      stats_.num_arena_allocations + stats_.num_fallback_allocations;
+  stats.bytes_in_use = bytes_in_use_;
+  stats.peak_bytes_in_use = stats_.peak_bytes_in_use;
+  return stats;
+}
+
+StepArenaAllocator::Stats StepArenaAllocator::ReleaseAndUnRef() {
+  Stats stats;
+  bool should_delete;
+  bool finish_recording = false;
+  std::vector<StaticMemoryPlan::Record> records;
+  std::shared_ptr<const StaticMemoryPlan::Layout> stale_layout;
+  {
+    mutex_lock l(mu_);
+    DCHECK(!released_);
+    released_ = true;
+    if (current_ != nullptr) {
+      Chunk* last = current_;
+      current_ = nullptr;
+      UnRefChunk(last);
+    }
+    if (planned_ != nullptr) {
+      Chunk* planned = planned_;
+      planned_ = nullptr;
+      UnRefChunk(planned);
+    }
+    if (recording_) {
+      finish_recording = true;
+      records = std::move(records_);
+    }
+    if (plan_is_stale_) stale_layout = layout_;
+    stats_.num_escaped_chunks = num_live_chunks_;
+    stats = stats_;
+    should_delete = ShouldDelete();
+  }
+  // Allocations that are still live are treated as never freed by the plan.
+  if (finish_recording) {
+    plan_->FinishRecording(records, Allocator::kAllocatorAlignment);
+  }
+  if (stale_layout != nullptr) plan_->Invalidate(stale_layout);
+  if (should_delete) delete this;
+  return stats;
+}
+
+/*static*/ void StepArenaAllocator::FillNodeExecStats(
+    const Stats& stats, const std::string& name, NodeExecStats* node_stats) {
+  node_stats->set_node_name(name);
+  node_stats->set_timeline_label(strings::StrCat(
+      "arena_allocations=", stats.num_arena_allocations,
+      " fallback_allocations=", stats.num_fallback_allocations,
+      " planned_allocations=", stats.num_planned_allocations,
+      " chunks=", stats.num_chunks,
+      " escaped_chunks=", stats.num_escaped_chunks));
+  AllocatorMemoryUsed* memory = node_stats->add_memory();
+  memory->set_allocator_name(name);
+  memory->set_total_bytes(stats.requested_bytes);
+  memory->set_peak_bytes(stats.peak_bytes_in_use);
+  memory->set_allocator_bytes_in_use(stats.chunk_bytes);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,175 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class NodeExecStats;
+
+// StepArenaAllocator is a wrapper for an Allocator that serves the
+// allocations made during a single step from large, bump-pointer chunks
+// obtained from the wrapped allocator. It is used by DirectSession to replace
+// the many small calls into the device's CPU allocator made by kernel
+// temporaries and outputs with a few chunk-sized calls per step.
+//
+// Each chunk counts the allocations that were carved out of it. A chunk is
+// returned to the wrapped allocator as a whole once the step has ended (see
+// `ReleaseAndUnRef()`) and all of its allocations have been deallocated, so
+// tensors that escape the step (e.g. fetched outputs or variable values) stay
+// valid and merely pin their chunk. Requests larger than a quarter of a chunk
+// are forwarded directly to the wrapped allocator.
+//
+// If a StaticMemoryPlan is given, the arena either records the lifetimes of
+// its allocations for that plan, or serves matching allocations from the
+// preassigned slices of a single planned buffer (see StaticMemoryPlan).
+//
+// Like TrackingAllocator, the wrapper deletes itself once `ReleaseAndUnRef()`
+// has been called and the last outstanding allocation has been deallocated.
+class StepArenaAllocator : public Allocator {
+ public:
+  static constexpr size_t kDefaultChunkSize = 1 << 20;
+
+  // Statistics about the allocations served by one StepArenaAllocator.
+  struct Stats {
+    // Number of allocations served from arena chunks.
+    int64_t num_arena_allocations = 0;
+    // Number of allocations forwarded to the wrapped allocator.
+    int64_t num_fallback_allocations = 0;
+    // Number of chunks obtained from the wrapped allocator.
+    int64_t num_chunks = 0;
+    // Total bytes obtained from the wrapped allocator for chunks.
+    int64_t chunk_bytes = 0;
+    // Total bytes requested through this wrapper.
+    int64_t requested_bytes = 0;
+    // High watermark of bytes requested through this wrapper and not yet
+    // deallocated.
+    int64_t peak_bytes_in_use = 0;
+    // Number of chunks that still held live allocations when the step ended.
+    int64_t num_escaped_chunks = 0;
+    // Number of allocations served from the slices of a StaticMemoryPlan.
+    int64_t num_planned_allocations = 0;
+  };
+
+  // `plan`, if not null, must outlive this wrapper's step.
+  StepArenaAllocator(Allocator* wrapped, size_t chunk_size = kDefaultChunkSize,
+                     StaticMemoryPlan* plan = nullptr);
+
+  std::string Name() override;
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  absl::optional<AllocatorStats> GetStats() override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return wrapped_->GetMemoryType();
+  }
+
+  // Returns the wrapped allocator.
+  Allocator* wrapped() const { return wrapped_; }
+
+  // Marks the end of the step and returns the collected statistics. Chunks
+  // without live allocations are released immediately. After this call, the
+  // only further calls allowed on this wrapper are calls to DeallocateRaw
+  // with pointers that were allocated by this wrapper and have not yet been
+  // deallocated.
+  Stats ReleaseAndUnRef();
+
+  // Fills `node_stats` with a summary of `stats` suitable for inclusion in a
+  // `DeviceStepStats`.
+  static void FillNodeExecStats(const Stats& stats, const std::string& name,
+                                NodeExecStats* node_stats);
+
+ protected:
+  ~StepArenaAllocator() override;
+
+ private:
+  struct Chunk {
+    char* data;
+    size_t size;
+    size_t used;
+    // Number of live allocations in this chunk, plus one while the chunk is
+    // the arena's current chunk.
+    int64_t refs;
+  };
+
+  // Header stored immediately before every pointer returned by AllocateRaw.
+  struct Header {
+    // The chunk the allocation was carved out of, or nullptr if the
+    // allocation was forwarded to `wrapped_`.
+    Chunk* chunk;
+    // The pointer returned by `wrapped_` for forwarded allocations.
+    void* raw;
+    size_t num_bytes;
+    // Index of the allocation in `records_` while recording, or of its
+    // record in `layout_` if it was served from the planned buffer, else -1.
+    int record;
+  };
+
+  void* AllocateFromChunk(size_t alignment, size_t num_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Serves the allocation from its slice of the planned buffer, or returns
+  // nullptr and marks the plan as stale if it does not match the plan.
+  void* AllocateFromPlan(size_t alignment, size_t num_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void UnRefChunk(Chunk* chunk) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns true iff this wrapper must be deleted.
+  bool ShouldDelete() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const wrapped_;  // Not owned.
+  const size_t chunk_size_;
+
+  mutex mu_;
+  Chunk* current_ TF_GUARDED_BY(mu_) = nullptr;
+  // Chunks that have not yet been returned to `wrapped_`.
+  int64_t num_live_chunks_ TF_GUARDED_BY(mu_) = 0;
+  // Forwarded allocations that have not yet been deallocated.
+  int64_t num_live_fallbacks_ TF_GUARDED_BY(mu_) = 0;
+  bool released_ TF_GUARDED_BY(mu_) = false;
+  Stats stats_ TF_GUARDED_BY(mu_);
+  int64_t bytes_in_use_ TF_GUARDED_BY(mu_) = 0;
+
+  // Static memory plan support.
+  StaticMemoryPlan* const plan_;  // Not owned.
+  bool recording_ TF_GUARDED_BY(mu_) = false;
+  int64_t clock_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<StaticMemoryPlan::Record> records_ TF_GUARDED_BY(mu_);
+  std::shared_ptr<const StaticMemoryPlan::Layout> layout_ TF_GUARDED_BY(mu_);
+  // The planned buffer, allocated on first use.
+  Chunk* planned_ TF_GUARDED_BY(mu_) = nullptr;
+  // Number of allocations of each (size, alignment) served so far.
+  absl::flat_hash_map<std::pair<size_t, size_t>, int> num_served_by_size_
+      TF_GUARDED_BY(mu_);
+  // Live planned slices, as map from offset to end offset.
+  std::map<size_t, size_t> live_slices_ TF_GUARDED_BY(mu_);
+  bool plan_is_stale_ TF_GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
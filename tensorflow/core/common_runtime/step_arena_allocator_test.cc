@@ -0,0 +1,187 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Counts the calls made to an underlying allocator.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocs_;
+    ++num_live_;
+    return port::AlignedMalloc(num_bytes, alignment);
+  }
+  void DeallocateRaw(void* ptr) override {
+    --num_live_;
+    port::AlignedFree(ptr);
+  }
+
+  int num_allocs() const { return num_allocs_; }
+  int num_live() const { return num_live_; }
+
+ private:
+  int num_allocs_ = 0;
+  int num_live_ = 0;
+};
+
+TEST(StepArenaAllocatorTest, SmallAllocationsShareOneChunk) {
+  CountingAllocator base;
+  auto* arena = new StepArenaAllocator(&base, /*chunk_size=*/4096);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 16; ++i) {
+    void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, 32);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) %
+                  Allocator::kAllocatorAlignment,
+              0);
+    ptrs.push_back(ptr);
+  }
+  EXPECT_EQ(base.num_allocs(), 1);
+  for (void* ptr : ptrs) arena->DeallocateRaw(ptr);
+  // The current chunk is kept until the end of the step.
+  EXPECT_EQ(base.num_live(), 1);
+
+  const StepArenaAllocator::Stats stats = arena->ReleaseAndUnRef();
+  EXPECT_EQ(stats.num_arena_allocations, 16);
+  EXPECT_EQ(stats.num_fallback_allocations, 0);
+  EXPECT_EQ(stats.num_chunks, 1);
+  EXPECT_EQ(stats.requested_bytes, 16 * 32);
+  EXPECT_EQ(stats.peak_bytes_in_use, 16 * 32);
+  EXPECT_EQ(stats.num_escaped_chunks, 0);
+  EXPECT_EQ(base.num_live(), 0);
+}
+
+TEST(StepArenaAllocatorTest, LargeAllocationsAreForwarded) {
+  CountingAllocator base;
+  auto* arena = new StepArenaAllocator(&base, /*chunk_size=*/4096);
+  void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, 2048);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(base.num_allocs(), 1);
+  arena->DeallocateRaw(ptr);
+  EXPECT_EQ(base.num_live(), 0);
+
+  const StepArenaAllocator::Stats stats = arena->ReleaseAndUnRef();
+  EXPECT_EQ(stats.num_arena_allocations, 0);
+  EXPECT_EQ(stats.num_fallback_allocations, 1);
+  EXPECT_EQ(stats.num_chunks, 0);
+}
+
+TEST(StepArenaAllocatorTest, EscapingTensorPinsItsChunk) {
+  CountingAllocator base;
+  auto* arena = new StepArenaAllocator(&base, /*chunk_size=*/4096);
+  Tensor escaped;
+  {
+    Tensor temp(arena, DT_FLOAT, TensorShape({8}));
+    escaped = Tensor(arena, DT_FLOAT, TensorShape({8}));
+    escaped.flat<float>().setConstant(3.0f);
+  }
+  // Fill the chunk so that a second one is needed.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; ++i) {
+    ptrs.push_back(arena->AllocateRaw(Allocator::kAllocatorAlignment, 512));
+  }
+  for (void* ptr : ptrs) arena->DeallocateRaw(ptr);
+
+  const StepArenaAllocator::Stats stats = arena->ReleaseAndUnRef();
+  EXPECT_GT(stats.num_chunks, 1);
+  EXPECT_EQ(stats.num_escaped_chunks, 1);
+  EXPECT_EQ(base.num_live(), 1);
+  EXPECT_EQ(escaped.flat<float>()(0), 3.0f);
+
+  // Releasing the last tensor releases the chunk and the arena itself.
+  escaped = Tensor();
+  EXPECT_EQ(base.num_live(), 0);
+}
+
+// Runs one step that allocates two buffers with disjoint lifetimes and one
+// with an overlapping lifetime.
+StepArenaAllocator::Stats RunPlannedStep(Allocator* base,
+                                         StaticMemoryPlan* plan,
+                                         size_t last_size = 256) {
+  auto* arena = new StepArenaAllocator(base, /*chunk_size=*/4096, plan);
+  void* a = arena->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  void* b = arena->AllocateRaw(Allocator::kAllocatorAlignment, 128);
+  arena->DeallocateRaw(a);
+  void* c = arena->AllocateRaw(Allocator::kAllocatorAlignment, last_size);
+  arena->DeallocateRaw(b);
+  arena->DeallocateRaw(c);
+  return arena->ReleaseAndUnRef();
+}
+
+TEST(StepArenaAllocatorTest, ReplaysStaticMemoryPlan) {
+  CountingAllocator base;
+  StaticMemoryPlan plan;
+  StepArenaAllocator::Stats stats = RunPlannedStep(&base, &plan);
+  EXPECT_EQ(stats.num_planned_allocations, 0);
+  EXPECT_EQ(stats.num_arena_allocations, 3);
+
+  for (int step = 0; step < 2; ++step) {
+    const int num_allocs_before = base.num_allocs();
+    stats = RunPlannedStep(&base, &plan);
+    EXPECT_EQ(stats.num_planned_allocations, 3);
+    EXPECT_EQ(stats.num_arena_allocations, 0);
+    EXPECT_EQ(stats.num_chunks, 1);
+    // `a` and `c` share a slice, so the buffer holds two allocations.
+    EXPECT_LT(stats.chunk_bytes, 256 + 128 + 256);
+    EXPECT_EQ(base.num_allocs(), num_allocs_before + 1);
+    EXPECT_EQ(base.num_live(), 0);
+  }
+}
+
+TEST(StepArenaAllocatorTest, MismatchedStepInvalidatesPlan) {
+  CountingAllocator base;
+  StaticMemoryPlan plan;
+  RunPlannedStep(&base, &plan);
+  // The last allocation has a different size than the recorded one.
+  StepArenaAllocator::Stats stats =
+      RunPlannedStep(&base, &plan, /*last_size=*/512);
+  EXPECT_EQ(stats.num_planned_allocations, 2);
+  EXPECT_EQ(stats.num_arena_allocations, 1);
+  // The next step records a new plan, and the one after replays it.
+  stats = RunPlannedStep(&base, &plan, /*last_size=*/512);
+  EXPECT_EQ(stats.num_planned_allocations, 0);
+  stats = RunPlannedStep(&base, &plan, /*last_size=*/512);
+  EXPECT_EQ(stats.num_planned_allocations, 3);
+  EXPECT_EQ(base.num_live(), 0);
+}
+
+TEST(StepArenaAllocatorTest, FillNodeExecStats) {
+  StepArenaAllocator::Stats stats;
+  stats.num_arena_allocations = 3;
+  stats.requested_bytes = 96;
+  stats.peak_bytes_in_use = 64;
+  stats.chunk_bytes = 4096;
+  NodeExecStats node_stats;
+  StepArenaAllocator::FillNodeExecStats(stats, "_StepArena", &node_stats);
+  EXPECT_EQ(node_stats.node_name(), "_StepArena");
+  ASSERT_EQ(node_stats.memory_size(), 1);
+  EXPECT_EQ(node_stats.memory(0).total_bytes(), 96);
+  EXPECT_EQ(node_stats.memory(0).peak_bytes(), 64);
+  EXPECT_EQ(node_stats.memory(0).allocator_bytes_in_use(), 4096);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 
+#include <algorithm>
 #include <memory>
+#include <tuple>
 
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
@@ -29,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/protobuf/config.pb.h"
 
 namespace tensorflow {
 namespace {
@@ -557,4 +560,110 @@ void StepStatsCollector::FinalizeInternal() {
     }
   }
 }
+
+void StepStatsCollector::AttributeCosts(CostAttributionCollector* costs) {
+  mutex_lock l(mu_);
+  for (const auto& dev_stat : dev_stats_) {
+    for (const auto& stats : dev_stat.second) {
+      // Stats saved without a node, such as those of step arenas, are not
+      // the cost of a kernel.
+      if (stats->node_ == nullptr) continue;
+      const NodeExecStats* node_stats = stats->stats();
+      int64_t allocated_bytes = 0;
+      int64_t peak_bytes = 0;
+      for (const AllocatorMemoryUsed& memory : node_stats->memory()) {
+        allocated_bytes += memory.total_bytes();
+        peak_bytes += memory.peak_bytes();
+      }
+      costs->Add(stats->node_->op(), dev_stat.first,
+                 node_stats->op_end_rel_nanos() -
+                     node_stats->op_start_rel_nanos(),
+                 allocated_bytes, peak_bytes);
+    }
+  }
+}
+
+namespace {
+
+// Records the cost of one node execution in a CostAttributionCollector.
+class CostAttributionNodeStats : public NodeExecStatsInterface {
+ public:
+  CostAttributionNodeStats(const NodeDef* node,
+                           CostAttributionCollector* collector)
+      : node_(node), collector_(collector) {}
+
+  void Done(const string& device) override {
+    collector_->Add(node_->op(), device,
+                    compute_end_nanos_ - compute_start_nanos_,
+                    allocated_bytes_, peak_bytes_);
+    delete this;
+  }
+  void RecordExecutorStarted() override {}
+  void RecordComputeStarted() override {
+    compute_start_nanos_ = EnvTime::NowNanos();
+  }
+  void RecordComputeEnded() override {
+    compute_end_nanos_ = EnvTime::NowNanos();
+  }
+  void RecordExecutorEnded() override {}
+  bool TrackAllocations() const override { return true; }
+  void SetMemory(OpKernelContext* ctx) override {
+    for (const auto& allocator_pair : ctx->ConsumeWrappedAllocators()) {
+      TrackingAllocator* tracking_allocator = allocator_pair.second;
+      auto sizes = tracking_allocator->GetSizes();
+      allocated_bytes_ += std::get<0>(sizes);
+      peak_bytes_ += std::get<1>(sizes);
+      tracking_allocator->GetRecordsAndUnRef();
+    }
+  }
+  void SetOutput(int slot, const Tensor* tensor) override {}
+  void SetScheduled(int64_t nanos) override {}
+
+ private:
+  const NodeDef* const node_;                  // Not owned.
+  CostAttributionCollector* const collector_;  // Not owned.
+  int64_t compute_start_nanos_ = 0;
+  int64_t compute_end_nanos_ = 0;
+  int64_t allocated_bytes_ = 0;
+  int64_t peak_bytes_ = 0;
+};
+
+bool IsRendezvousRecv(StringPiece op_type) {
+  return op_type == "_Recv" || op_type == "_HostRecv" || op_type == "Recv" ||
+         op_type == "HostRecv";
+}
+
+}  // namespace
+
+NodeExecStatsInterface* CostAttributionCollector::CreateNodeExecStats(
+    const NodeDef* node) {
+  return new CostAttributionNodeStats(node, this);
+}
+
+void CostAttributionCollector::Add(StringPiece op_type, StringPiece device,
+                                   int64_t compute_nanos,
+                                   int64_t allocated_bytes,
+                                   int64_t peak_bytes) {
+  // A kernel that failed before it was computed has no compute time.
+  compute_nanos = std::max<int64_t>(compute_nanos, 0);
+  mutex_lock l(mu_);
+  op_time_nanos_[string(op_type)] += compute_nanos;
+  device_time_nanos_[string(device)] += compute_nanos;
+  if (IsRendezvousRecv(op_type)) rendezvous_wait_nanos_ += compute_nanos;
+  allocated_bytes_ += allocated_bytes;
+  peak_memory_bytes_ = std::max(peak_memory_bytes_, peak_bytes);
+}
+
+void CostAttributionCollector::Fill(CostAttribution* attribution) const {
+  mutex_lock l(mu_);
+  attribution->Clear();
+  attribution->mutable_op_time_nanos()->insert(op_time_nanos_.begin(),
+                                               op_time_nanos_.end());
+  attribution->mutable_device_time_nanos()->insert(device_time_nanos_.begin(),
+                                                   device_time_nanos_.end());
+  attribution->set_rendezvous_wait_nanos(rendezvous_wait_nanos_);
+  attribution->set_allocated_bytes(allocated_bytes_);
+  attribution->set_peak_memory_bytes(peak_memory_bytes_);
+}
+
 }  // namespace tensorflow
@@ -31,6 +31,8 @@ limitations under the License.
 namespace tensorflow {
 
 class AllocatorMemoryUsed;
+class CostAttribution;
+class CostAttributionCollector;
 class CostModelManager;
 class Graph;
 class NodeDef;
@@ -185,6 +187,10 @@ class StepStatsCollector : public StepStatsCollectorInterface {
   // swaps the content of StepStats* from constructor with 'ss'.
   void FinalizeAndSwap(StepStats* step_stats);
 
+  // Adds the costs of the nodes collected so far to `costs`. Must be called
+  // before Finalize.
+  void AttributeCosts(CostAttributionCollector* costs);
+
  private:
   // TODO(suharshs): Make this configurable if its not possible to find a value
   // that works for all cases.
@@ -203,6 +209,38 @@ class StepStatsCollector : public StepStatsCollectorInterface {
   uint64 collected_nodes_ TF_GUARDED_BY(mu_) = 0;
 };
 
+// CostAttributionCollector attributes the cost of a step to the kernels that
+// ran it, for per-request accounting. Unlike StepStatsCollector it only keeps
+// totals, so it is cheap enough to use on every step.
+class CostAttributionCollector : public StepStatsCollectorInterface {
+ public:
+  CostAttributionCollector() = default;
+
+  NodeExecStatsInterface* CreateNodeExecStats(const NodeDef* node) override;
+  string ReportAllocsOnResourceExhausted(const string& err) override {
+    return "";
+  }
+
+  // Adds the cost of one execution of a kernel of type `op_type` on `device`,
+  // which ran for `compute_nanos`, allocated `allocated_bytes` in total and
+  // held at most `peak_bytes` at once.
+  void Add(StringPiece op_type, StringPiece device, int64_t compute_nanos,
+           int64_t allocated_bytes, int64_t peak_bytes);
+
+  // Sets `*attribution` to the costs added so far.
+  void Fill(CostAttribution* attribution) const;
+
+ private:
+  mutable mutex mu_;
+  std::unordered_map<string, int64_t> op_time_nanos_ TF_GUARDED_BY(mu_);
+  std::unordered_map<string, int64_t> device_time_nanos_ TF_GUARDED_BY(mu_);
+  int64_t rendezvous_wait_nanos_ TF_GUARDED_BY(mu_) = 0;
+  int64_t allocated_bytes_ TF_GUARDED_BY(mu_) = 0;
+  int64_t peak_memory_bytes_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(CostAttributionCollector);
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_STATS_COLLECTOR_H_
@@ -0,0 +1,145 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/streaming_partial_run.h"
+
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+/*static*/ Status StreamingPartialRun::Create(
+    Session* session, const std::vector<string>& input_names,
+    const std::vector<string>& output_names,
+    const std::vector<string>& target_nodes, const Options& options,
+    std::unique_ptr<StreamingPartialRun>* out) {
+  if (session == nullptr) {
+    return errors::InvalidArgument("StreamingPartialRun requires a session.");
+  }
+  if (options.max_in_flight < 1) {
+    return errors::InvalidArgument(
+        "StreamingPartialRun requires max_in_flight >= 1, got ",
+        options.max_in_flight);
+  }
+  if (input_names.empty()) {
+    return errors::InvalidArgument(
+        "StreamingPartialRun requires at least one input.");
+  }
+  if (output_names.empty()) {
+    // Feed() would finish a partial run without fetches, leaving no run for
+    // Fetch() to complete.
+    return errors::InvalidArgument(
+        "StreamingPartialRun requires at least one output.");
+  }
+  out->reset(new StreamingPartialRun(session, input_names, output_names,
+                                     target_nodes, options));
+  return OkStatus();
+}
+
+StreamingPartialRun::StreamingPartialRun(
+    Session* session, const std::vector<string>& input_names,
+    const std::vector<string>& output_names,
+    const std::vector<string>& target_nodes, const Options& options)
+    : session_(session),
+      input_names_(input_names),
+      output_names_(output_names),
+      target_nodes_(target_nodes),
+      options_(options) {}
+
+StreamingPartialRun::~StreamingPartialRun() {
+  Close();
+  // Finish the partial runs in flight, so that the session does not keep
+  // their state until it is closed.
+  mutex_lock fetch_lock(fetch_mu_);
+  mutex_lock l(mu_);
+  while (!fed_handles_.empty()) {
+    std::vector<Tensor> unused_outputs;
+    Status s = session_->PRun(fed_handles_.front(), /*inputs=*/{},
+                              output_names_, &unused_outputs);
+    if (!s.ok()) {
+      LOG(WARNING) << "Error finishing a streaming partial run: " << s;
+    }
+    fed_handles_.pop_front();
+  }
+}
+
+Status StreamingPartialRun::Feed(
+    const std::vector<std::pair<string, Tensor>>& inputs) {
+  if (inputs.size() != input_names_.size()) {
+    return errors::InvalidArgument("Expected ", input_names_.size(),
+                                   " inputs for the chunk, got ",
+                                   inputs.size());
+  }
+  mutex_lock feed_lock(feed_mu_);
+  {
+    mutex_lock l(mu_);
+    while (!closed_ && num_in_flight_ >= options_.max_in_flight) {
+      cond_var_.wait(l);
+    }
+    if (closed_) {
+      return errors::FailedPrecondition(
+          "Feed() called on a closed StreamingPartialRun.");
+    }
+    ++num_in_flight_;
+  }
+
+  string handle;
+  Status s =
+      session_->PRunSetup(input_names_, output_names_, target_nodes_, &handle);
+  if (s.ok()) {
+    std::vector<Tensor> unused_outputs;
+    s = session_->PRun(handle, inputs, /*output_names=*/{}, &unused_outputs);
+  }
+
+  mutex_lock l(mu_);
+  if (s.ok()) {
+    fed_handles_.push_back(std::move(handle));
+  } else {
+    --num_in_flight_;
+  }
+  cond_var_.notify_all();
+  return s;
+}
+
+Status StreamingPartialRun::Fetch(std::vector<Tensor>* outputs) {
+  mutex_lock fetch_lock(fetch_mu_);
+  string handle;
+  {
+    mutex_lock l(mu_);
+    while (fed_handles_.empty() && !(closed_ && num_in_flight_ == 0)) {
+      cond_var_.wait(l);
+    }
+    if (fed_handles_.empty()) {
+      return errors::OutOfRange("StreamingPartialRun is closed.");
+    }
+    handle = std::move(fed_handles_.front());
+    fed_handles_.pop_front();
+  }
+
+  outputs->clear();
+  Status s = session_->PRun(handle, /*inputs=*/{}, output_names_, outputs);
+
+  mutex_lock l(mu_);
+  --num_in_flight_;
+  cond_var_.notify_all();
+  return s;
+}
+
+void StreamingPartialRun::Close() {
+  mutex_lock l(mu_);
+  closed_ = true;
+  cond_var_.notify_all();
+}
+
+}  // namespace tensorflow
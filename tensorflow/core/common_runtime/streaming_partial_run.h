@@ -0,0 +1,121 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STREAMING_PARTIAL_RUN_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STREAMING_PARTIAL_RUN_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+
+// StreamingPartialRun pipelines successive chunks of a stream (e.g. frames of
+// an audio stream) through the same graph of a Session. Each chunk is one
+// partial run (see `Session::PRunSetup()`): `Feed()` sets up the run and
+// sends the chunk's inputs, and `Fetch()` receives the outputs of the oldest
+// chunk that has not been fetched yet. Since every partial run is a step of
+// its own, the executors of up to `max_in_flight` chunks run concurrently, so
+// that the next chunk starts executing while the previous one is finishing,
+// instead of paying the full step latency of `Session::Run()` per chunk.
+//
+// `Feed()` blocks while `max_in_flight` chunks have been fed but not fetched,
+// which bounds the memory held by a producer that is faster than the
+// consumer.
+//
+// Chunks in flight are independent steps: reads and writes of state shared
+// across chunks (e.g. resource variables that carry a recurrent state) are
+// only ordered by the graph itself, so graphs that depend on such ordering
+// should use `max_in_flight == 1` or thread the state through the feeds and
+// fetches.
+//
+// Feed() and Fetch() may be called from different threads. Concurrent calls
+// to Feed() (or to Fetch()) are serialized.
+class StreamingPartialRun {
+ public:
+  struct Options {
+    // Maximum number of chunks that have been fed but not yet fetched.
+    int max_in_flight = 2;
+  };
+
+  // Creates a stream that feeds `input_names`, fetches `output_names` and
+  // runs `target_nodes` for every chunk. `session` must outlive the stream.
+  // Both `input_names` and `output_names` must be non-empty.
+  static Status Create(Session* session,
+                       const std::vector<string>& input_names,
+                       const std::vector<string>& output_names,
+                       const std::vector<string>& target_nodes,
+                       const Options& options,
+                       std::unique_ptr<StreamingPartialRun>* out);
+
+  // Fetches and discards the outputs of the chunks still in flight.
+  ~StreamingPartialRun();
+
+  // Starts a new chunk with `inputs`, which must contain a value for every
+  // input name. Blocks while `max_in_flight` chunks are in flight. Returns
+  // FailedPrecondition after `Close()`.
+  Status Feed(const std::vector<std::pair<string, Tensor>>& inputs);
+
+  // Fetches the outputs of the oldest chunk in flight into `outputs`, in the
+  // order of the output names. Blocks until a chunk has been fed. Returns
+  // OutOfRange once the stream is closed and all chunks have been fetched.
+  Status Fetch(std::vector<Tensor>* outputs);
+
+  // Marks the end of the stream: subsequent calls to `Feed()` fail, and
+  // `Fetch()` returns OutOfRange once the remaining chunks are fetched.
+  void Close();
+
+ private:
+  StreamingPartialRun(Session* session, const std::vector<string>& input_names,
+                      const std::vector<string>& output_names,
+                      const std::vector<string>& target_nodes,
+                      const Options& options);
+
+  Session* const session_;  // Not owned.
+  const std::vector<string> input_names_;
+  const std::vector<string> output_names_;
+  const std::vector<string> target_nodes_;
+  const Options options_;
+
+  // Serializes the callers of Feed() and Fetch() respectively, so that
+  // chunks are fetched in the order in which they were fed.
+  mutex feed_mu_;
+  mutex fetch_mu_;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  // Handles of the chunks that have been fed and not yet fetched, oldest
+  // first.
+  std::deque<string> fed_handles_ TF_GUARDED_BY(mu_);
+  // Number of chunks that have been fed or are being fed, and whose outputs
+  // have not been fetched yet.
+  int num_in_flight_ TF_GUARDED_BY(mu_) = 0;
+  bool closed_ TF_GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StreamingPartialRun);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STREAMING_PARTIAL_RUN_H_
@@ -0,0 +1,173 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/streaming_partial_run.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+class StreamingPartialRunTest : public ::testing::Test {
+ protected:
+  // Builds a graph that computes `output = input + 1`.
+  void SetUp() override {
+    Graph g(OpRegistry::Global());
+    Tensor zero(DT_FLOAT, TensorShape({}));
+    zero.scalar<float>()() = 0.0f;
+    Tensor one(DT_FLOAT, TensorShape({}));
+    one.scalar<float>()() = 1.0f;
+    Node* input = test::graph::Constant(&g, zero);
+    Node* output = test::graph::Add(&g, input, test::graph::Constant(&g, one));
+    input_name_ = input->name();
+    output_name_ = output->name() + ":0";
+    GraphDef def;
+    g.ToGraphDef(&def);
+
+    session_.reset(NewSession(SessionOptions()));
+    ASSERT_TRUE(session_ != nullptr);
+    TF_ASSERT_OK(session_->Create(def));
+  }
+
+  std::vector<std::pair<string, Tensor>> Chunk(float value) {
+    return {{input_name_, test::AsScalar<float>(value)}};
+  }
+
+  std::unique_ptr<StreamingPartialRun> CreateStream(int max_in_flight) {
+    StreamingPartialRun::Options options;
+    options.max_in_flight = max_in_flight;
+    std::unique_ptr<StreamingPartialRun> stream;
+    TF_CHECK_OK(StreamingPartialRun::Create(
+        session_.get(), {input_name_}, {output_name_}, {}, options, &stream));
+    return stream;
+  }
+
+  std::unique_ptr<Session> session_;
+  string input_name_;
+  string output_name_;
+};
+
+TEST_F(StreamingPartialRunTest, FetchesChunksInFeedOrder) {
+  auto stream = CreateStream(/*max_in_flight=*/3);
+  TF_ASSERT_OK(stream->Feed(Chunk(1.0f)));
+  TF_ASSERT_OK(stream->Feed(Chunk(2.0f)));
+  TF_ASSERT_OK(stream->Feed(Chunk(3.0f)));
+
+  std::vector<Tensor> outputs;
+  for (float expected : {2.0f, 3.0f, 4.0f}) {
+    TF_ASSERT_OK(stream->Fetch(&outputs));
+    ASSERT_EQ(outputs.size(), 1);
+    EXPECT_EQ(outputs[0].scalar<float>()(), expected);
+  }
+}
+
+TEST_F(StreamingPartialRunTest, PipelinesProducerAndConsumerThreads) {
+  constexpr int kNumChunks = 32;
+  auto stream = CreateStream(/*max_in_flight=*/2);
+  std::unique_ptr<Thread> producer(Env::Default()->StartThread(
+      ThreadOptions(), "producer", [this, &stream]() {
+        for (int i = 0; i < kNumChunks; ++i) {
+          TF_EXPECT_OK(stream->Feed(Chunk(i)));
+        }
+        stream->Close();
+      }));
+
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < kNumChunks; ++i) {
+    TF_ASSERT_OK(stream->Fetch(&outputs));
+    ASSERT_EQ(outputs.size(), 1);
+    EXPECT_EQ(outputs[0].scalar<float>()(), i + 1.0f);
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(stream->Fetch(&outputs)));
+  producer.reset();
+}
+
+TEST_F(StreamingPartialRunTest, FeedBlocksWhileMaxChunksAreInFlight) {
+  auto stream = CreateStream(/*max_in_flight=*/1);
+  TF_ASSERT_OK(stream->Feed(Chunk(1.0f)));
+
+  Notification second_fed;
+  std::unique_ptr<Thread> producer(Env::Default()->StartThread(
+      ThreadOptions(), "producer", [this, &stream, &second_fed]() {
+        TF_EXPECT_OK(stream->Feed(Chunk(2.0f)));
+        second_fed.Notify();
+      }));
+  Env::Default()->SleepForMicroseconds(50 * 1000);
+  EXPECT_FALSE(second_fed.HasBeenNotified());
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(stream->Fetch(&outputs));
+  EXPECT_EQ(outputs[0].scalar<float>()(), 2.0f);
+  second_fed.WaitForNotification();
+  TF_ASSERT_OK(stream->Fetch(&outputs));
+  EXPECT_EQ(outputs[0].scalar<float>()(), 3.0f);
+}
+
+TEST_F(StreamingPartialRunTest, FeedFailsAfterClose) {
+  auto stream = CreateStream(/*max_in_flight=*/2);
+  TF_ASSERT_OK(stream->Feed(Chunk(1.0f)));
+  stream->Close();
+  EXPECT_TRUE(errors::IsFailedPrecondition(stream->Feed(Chunk(2.0f))));
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(stream->Fetch(&outputs));
+  EXPECT_EQ(outputs[0].scalar<float>()(), 2.0f);
+  EXPECT_TRUE(errors::IsOutOfRange(stream->Fetch(&outputs)));
+}
+
+TEST_F(StreamingPartialRunTest, DestructorFinishesChunksInFlight) {
+  auto stream = CreateStream(/*max_in_flight=*/2);
+  TF_ASSERT_OK(stream->Feed(Chunk(1.0f)));
+  TF_ASSERT_OK(stream->Feed(Chunk(2.0f)));
+  stream.reset();
+  // The session accepts new partial runs after the stream is gone.
+  stream = CreateStream(/*max_in_flight=*/1);
+  TF_ASSERT_OK(stream->Feed(Chunk(5.0f)));
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(stream->Fetch(&outputs));
+  EXPECT_EQ(outputs[0].scalar<float>()(), 6.0f);
+}
+
+TEST_F(StreamingPartialRunTest, InvalidOptions) {
+  StreamingPartialRun::Options options;
+  options.max_in_flight = 0;
+  std::unique_ptr<StreamingPartialRun> stream;
+  EXPECT_TRUE(errors::IsInvalidArgument(StreamingPartialRun::Create(
+      session_.get(), {input_name_}, {output_name_}, {}, options, &stream)));
+}
+
+TEST_F(StreamingPartialRunTest, RequiresOutputs) {
+  std::unique_ptr<StreamingPartialRun> stream;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      StreamingPartialRun::Create(session_.get(), {input_name_},
+                                  /*output_names=*/{}, {}, {}, &stream)));
+  EXPECT_EQ(stream, nullptr);
+}
+
+}  // namespace
+}  // namespace tensorflow
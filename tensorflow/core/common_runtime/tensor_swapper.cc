@@ -0,0 +1,260 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/tensor_swapper.h"
+
+#include <limits>
+
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/notification.h"
+
+namespace tensorflow {
+
+/*static*/ std::unique_ptr<TensorSwapPlan> TensorSwapPlan::Create(
+    const Graph& graph, double memory_fraction) {
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+  std::vector<int> positions(graph.num_node_ids(), -1);
+  for (int i = 0; i < order.size(); ++i) {
+    positions[order[i]->id()] = i;
+  }
+
+  std::unique_ptr<TensorSwapPlan> plan(new TensorSwapPlan(memory_fraction));
+  plan->consumer_positions_.resize(graph.num_node_ids());
+  bool has_candidates = false;
+  for (const Node* n : graph.op_nodes()) {
+    if (n->num_outputs() == 0) continue;
+    // The number of data consumers of each output, and the position of the
+    // last one.
+    gtl::InlinedVector<int, 2> num_consumers(n->num_outputs(), 0);
+    gtl::InlinedVector<int, 2> consumer_positions(n->num_outputs(), -1);
+    for (const Edge* e : n->out_edges()) {
+      if (e->IsControlEdge()) continue;
+      ++num_consumers[e->src_output()];
+      consumer_positions[e->src_output()] =
+          e->dst()->IsOp() ? positions[e->dst()->id()] : -1;
+    }
+    const int position = positions[n->id()];
+    for (int i = 0; i < n->num_outputs(); ++i) {
+      if (num_consumers[i] != 1 || consumer_positions[i] < 0 ||
+          consumer_positions[i] - position < kMinSwapDistance) {
+        consumer_positions[i] = -1;
+      } else {
+        has_candidates = true;
+      }
+    }
+    plan->consumer_positions_[n->id()] = std::move(consumer_positions);
+  }
+  if (!has_candidates) return nullptr;
+  return plan;
+}
+
+struct TensorSwapper::SwappedTensor {
+  SwappedTensor(Device* device, DeviceContext* device_context,
+                Allocator* device_allocator)
+      : device(device),
+        device_context(device_context),
+        device_allocator(device_allocator) {
+    device_context->Ref();
+  }
+  ~SwappedTensor() { device_context->Unref(); }
+
+  Device* const device;
+  DeviceContext* const device_context;
+  Allocator* const device_allocator;
+
+  // The host copy.
+  Tensor host;
+
+  mutex mu;
+  bool copied_out TF_GUARDED_BY(mu) = false;
+  bool swap_in_requested TF_GUARDED_BY(mu) = false;
+
+  // Valid once `restored` is notified. If copying the tensor to the host
+  // failed, `device_tensor` is the original tensor.
+  Status status;
+  Tensor device_tensor;
+  Notification restored;
+};
+
+TensorSwapper::TensorSwapper(const TensorSwapPlan* plan, Device* device,
+                             DeviceContext* device_context)
+    : plan_(plan),
+      device_(device),
+      device_context_(device_context),
+      device_allocator_(device->GetAllocator(AllocatorAttributes())),
+      host_allocator_([device] {
+        AllocatorAttributes attr;
+        attr.set_on_host(true);
+        attr.set_gpu_compatible(true);
+        return device->GetAllocator(attr);
+      }()),
+      next_prefetch_position_(std::numeric_limits<int64_t>::max()) {}
+
+bool TensorSwapper::UnderMemoryPressure() const {
+  absl::optional<AllocatorStats> stats = device_allocator_->GetStats();
+  return stats.has_value() && stats->bytes_limit.has_value() &&
+         stats->bytes_in_use >
+             plan_->memory_fraction() * stats->bytes_limit.value();
+}
+
+void TensorSwapper::MaybeSwapOut(int id, int slot,
+                                 DeviceContext* producer_context,
+                                 Entry* entry) {
+  DCHECK(entry->state == Entry::State::HAS_VALUE);
+  const int consumer_position = plan_->swap_consumer_position(id, slot);
+  if (consumer_position < 0) return;
+  const Tensor& tensor = *entry->val;
+  // Swapping out a tensor only releases its memory if no other tensor shares
+  // its buffer.
+  if (tensor.TotalBytes() < TensorSwapPlan::kMinSwapBytes ||
+      !tensor.RefCountIsOne() || !DMAHelper::CanUseDMA(&tensor) ||
+      !UnderMemoryPressure()) {
+    return;
+  }
+
+  auto swapped = std::make_shared<SwappedTensor>(device_, device_context_,
+                                                 device_allocator_);
+  swapped->host = Tensor(host_allocator_, tensor.dtype(), tensor.shape());
+  if (!swapped->host.IsInitialized()) return;
+
+  VLOG(2) << "Swapping out output " << slot << " of node " << id << " ("
+          << tensor.TotalBytes() << " bytes)";
+  Tensor* device_tensor = new Tensor(std::move(*entry->val));
+  entry->ClearVal();
+  entry->state = Entry::State::HAS_SWAPPED_VALUE;
+  entry->val.Init(swapped->host);
+  {
+    mutex_lock l(mu_);
+    swapped_[DMAHelper::base(&swapped->host)] = swapped;
+    pending_prefetches_.emplace(
+        consumer_position - TensorSwapPlan::kPrefetchDistance, swapped);
+    next_prefetch_position_.store(pending_prefetches_.top().first,
+                                  std::memory_order_relaxed);
+  }
+
+  producer_context->CopyDeviceTensorToCPU(
+      device_tensor, /*tensor_name=*/"", device_, &swapped->host,
+      [swapped, device_tensor](const Status& s) {
+        bool swap_in;
+        {
+          mutex_lock l(swapped->mu);
+          swapped->copied_out = true;
+          swap_in = swapped->swap_in_requested;
+          swapped->status = s;
+          if (!s.ok()) {
+            // Keep the tensor on the device.
+            swapped->device_tensor = std::move(*device_tensor);
+          }
+        }
+        // Releases the device memory, unless the copy failed.
+        delete device_tensor;
+        if (swap_in) StartSwapIn(swapped);
+      });
+}
+
+/*static*/ void TensorSwapper::RequestSwapIn(
+    const std::shared_ptr<SwappedTensor>& swapped) {
+  {
+    mutex_lock l(swapped->mu);
+    if (swapped->swap_in_requested) return;
+    swapped->swap_in_requested = true;
+    if (!swapped->copied_out) return;
+  }
+  StartSwapIn(swapped);
+}
+
+/*static*/ void TensorSwapper::StartSwapIn(
+    const std::shared_ptr<SwappedTensor>& swapped) {
+  if (!swapped->status.ok()) {
+    // The tensor was not copied out and is still on the device.
+    swapped->status = OkStatus();
+    swapped->restored.Notify();
+    return;
+  }
+  const Tensor& host = swapped->host;
+  swapped->device_tensor =
+      Tensor(swapped->device_allocator, host.dtype(), host.shape());
+  if (!swapped->device_tensor.IsInitialized()) {
+    swapped->status = errors::ResourceExhausted(
+        "OOM when copying back a swapped out tensor of shape ",
+        host.shape().DebugString(), " and type ",
+        DataTypeString(host.dtype()));
+    swapped->restored.Notify();
+    return;
+  }
+  swapped->device_context->CopyCPUTensorToDevice(
+      &swapped->host, swapped->device, &swapped->device_tensor,
+      [swapped](const Status& s) {
+        swapped->status = s;
+        swapped->restored.Notify();
+      });
+}
+
+Status TensorSwapper::SwapIn(Entry* entry) {
+  DCHECK(entry->state == Entry::State::HAS_SWAPPED_VALUE);
+  std::shared_ptr<SwappedTensor> swapped;
+  {
+    mutex_lock l(mu_);
+    // Each swapped out tensor has a single consumer.
+    auto it = swapped_.find(DMAHelper::base(entry->val.get()));
+    if (it == swapped_.end()) {
+      return errors::Internal("Unknown swapped out tensor");
+    }
+    swapped = std::move(it->second);
+    swapped_.erase(it);
+  }
+  RequestSwapIn(swapped);
+  swapped->restored.WaitForNotification();
+  TF_RETURN_IF_ERROR(swapped->status);
+
+  entry->ClearVal();
+  entry->state = Entry::State::HAS_VALUE;
+  entry->val.Init(std::move(swapped->device_tensor));
+  // The host copy is no longer needed, even if `swapped` stays in
+  // `pending_prefetches_` for a while.
+  swapped->host = Tensor();
+  return OkStatus();
+}
+
+void TensorSwapper::NodeCompleted() {
+  const int64_t num_completed =
+      num_completed_nodes_.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (num_completed <
+      next_prefetch_position_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  std::vector<std::shared_ptr<SwappedTensor>> due;
+  {
+    mutex_lock l(mu_);
+    while (!pending_prefetches_.empty() &&
+           pending_prefetches_.top().first <= num_completed) {
+      due.push_back(pending_prefetches_.top().second);
+      pending_prefetches_.pop();
+    }
+    next_prefetch_position_.store(pending_prefetches_.empty()
+                                      ? std::numeric_limits<int64_t>::max()
+                                      : pending_prefetches_.top().first,
+                                  std::memory_order_relaxed);
+  }
+  for (const auto& swapped : due) {
+    RequestSwapIn(swapped);
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,148 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_TENSOR_SWAPPER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_TENSOR_SWAPPER_H_
+
+#include <atomic>
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/entry.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Estimates how long the tensors of a graph stay alive before they are
+// consumed, from the distance between their producer and their consumer in a
+// topological order of the graph, to pick the tensors that `TensorSwapper`
+// may move to host memory.
+class TensorSwapPlan {
+ public:
+  // Output tensors of at least this many bytes may be swapped out.
+  static constexpr int64_t kMinSwapBytes = 1 << 20;
+  // Output tensors may be swapped out if their consumer follows their producer
+  // by at least this many nodes in the topological order.
+  static constexpr int kMinSwapDistance = 64;
+  // Swapped out tensors are copied back once the executor has completed as
+  // many nodes as precede their consumer in the topological order, minus this
+  // many.
+  static constexpr int kPrefetchDistance = 16;
+
+  // Returns the plan for `graph`, or nullptr if no output of `graph` may be
+  // swapped out. Tensors are swapped out while the device allocator uses more
+  // than `memory_fraction` of its memory limit.
+  static std::unique_ptr<TensorSwapPlan> Create(const Graph& graph,
+                                                double memory_fraction);
+
+  // Returns the position of the only consumer of output `slot` of node `id` in
+  // the topological order, or -1 if that output may not be swapped out.
+  int swap_consumer_position(int id, int slot) const {
+    const auto& positions = consumer_positions_[id];
+    return slot < positions.size() ? positions[slot] : -1;
+  }
+
+  double memory_fraction() const { return memory_fraction_; }
+
+ private:
+  explicit TensorSwapPlan(double memory_fraction)
+      : memory_fraction_(memory_fraction) {}
+
+  const double memory_fraction_;
+  // Indexed by node ID, then by output slot.
+  std::vector<gtl::InlinedVector<int, 2>> consumer_positions_;
+};
+
+// Moves device tensors that wait a long time for their consumer to host memory
+// while the device allocator is close to its memory limit, and copies them
+// back shortly before they are used. On GPUs, the copies run on the dedicated
+// host-to-device and device-to-host streams, so that they overlap with
+// computation.
+//
+// A swapped out tensor is stored in the executor as an entry in the
+// `HAS_SWAPPED_VALUE` state, which holds its host copy. One `TensorSwapper` is
+// used by the executor of a single step. This class is thread-safe.
+class TensorSwapper {
+ public:
+  // Does not take ownership of any argument.
+  TensorSwapper(const TensorSwapPlan* plan, Device* device,
+                DeviceContext* device_context);
+
+  // Called with the entry holding output `slot` of node `id`, a tensor in
+  // device memory produced in `producer_context`. If the device allocator is
+  // close to its limit and the tensor may be swapped out, starts copying the
+  // tensor to host memory and replaces it by its host copy in `*entry`. Its
+  // device memory is released once the copy completes.
+  void MaybeSwapOut(int id, int slot, DeviceContext* producer_context,
+                    Entry* entry);
+
+  // Replaces the host copy in `*entry`, which must be in the
+  // `HAS_SWAPPED_VALUE` state, by the device tensor, after waiting for the
+  // tensor to be copied back to the device.
+  Status SwapIn(Entry* entry);
+
+  // Called when the executor completes a node. Starts copying back the
+  // swapped out tensors whose consumers are expected to run soon.
+  void NodeCompleted();
+
+ private:
+  struct SwappedTensor;
+  using PendingPrefetch = std::pair<int64_t, std::shared_ptr<SwappedTensor>>;
+  struct LaterPrefetch {
+    bool operator()(const PendingPrefetch& a, const PendingPrefetch& b) const {
+      return a.first > b.first;
+    }
+  };
+
+  bool UnderMemoryPressure() const;
+
+  // Starts copying `swapped` back to the device, once it has been copied out.
+  static void RequestSwapIn(const std::shared_ptr<SwappedTensor>& swapped);
+  static void StartSwapIn(const std::shared_ptr<SwappedTensor>& swapped);
+
+  const TensorSwapPlan* const plan_;
+  Device* const device_;
+  DeviceContext* const device_context_;
+  Allocator* const device_allocator_;
+  Allocator* const host_allocator_;
+
+  std::atomic<int64_t> num_completed_nodes_{0};
+  // The earliest prefetch position in `pending_prefetches_`.
+  std::atomic<int64_t> next_prefetch_position_;
+
+  mutex mu_;
+  // The swapped out tensors, by the base address of their host copy.
+  absl::flat_hash_map<const void*, std::shared_ptr<SwappedTensor>> swapped_
+      TF_GUARDED_BY(mu_);
+  std::priority_queue<PendingPrefetch, std::vector<PendingPrefetch>,
+                      LaterPrefetch>
+      pending_prefetches_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(TensorSwapper);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_TENSOR_SWAPPER_H_
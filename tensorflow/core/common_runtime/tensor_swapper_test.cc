@@ -0,0 +1,71 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/tensor_swapper.h"
+
+#include <memory>
+
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns the last node of a chain of `length` Neg nodes starting at `input`,
+// which runs after `after`.
+Node* NegChain(Graph* g, Node* input, Node* after, int length) {
+  Node* n = input;
+  for (int i = 0; i < length; ++i) {
+    n = test::graph::Unary(g, "Neg", n);
+    if (i == 0) g->AddControlEdge(after, n);
+  }
+  return n;
+}
+
+TEST(TensorSwapPlanTest, SwapsOutputsWithDistantConsumer) {
+  Graph g(OpRegistry::Global());
+  Node* x = test::graph::Arg(&g, 0, DT_FLOAT);
+  Node* early = test::graph::Unary(&g, "Neg", x);
+  Node* chain = NegChain(&g, x, early, 2 * TensorSwapPlan::kMinSwapDistance);
+  Node* sum = test::graph::Binary(&g, "Add", early, chain);
+
+  std::unique_ptr<TensorSwapPlan> plan =
+      TensorSwapPlan::Create(g, /*memory_fraction=*/0.5);
+  ASSERT_NE(plan, nullptr);
+  EXPECT_EQ(plan->memory_fraction(), 0.5);
+  // `early` waits for the whole chain before `sum` consumes it.
+  EXPECT_GE(plan->swap_consumer_position(early->id(), 0), 0);
+  // The chain is consumed right away.
+  EXPECT_EQ(plan->swap_consumer_position(chain->id(), 0), -1);
+  EXPECT_EQ(plan->swap_consumer_position(sum->id(), 0), -1);
+  EXPECT_EQ(plan->swap_consumer_position(x->id(), 0), -1);
+}
+
+TEST(TensorSwapPlanTest, NoPlanWithoutCandidates) {
+  Graph g(OpRegistry::Global());
+  Node* x = test::graph::Arg(&g, 0, DT_FLOAT);
+  Node* early = test::graph::Unary(&g, "Neg", x);
+  Node* chain = NegChain(&g, x, early, 2 * TensorSwapPlan::kMinSwapDistance);
+  // `early` has a second consumer, and swapped out tensors are only copied
+  // back for a single one.
+  test::graph::Binary(&g, "Add", early, chain);
+  test::graph::Unary(&g, "Neg", early);
+
+  EXPECT_EQ(TensorSwapPlan::Create(g, /*memory_fraction=*/0.5), nullptr);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -26,6 +26,9 @@ info. It does not have any negative impact on performance. */
 #endif
 #endif  // ENABLE_ONEDNN_OPENMP && ENABLE_MKL &&_OPENMP
 
+#include <algorithm>
+#include <vector>
+
 #include "absl/base/call_once.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/local_device.h"
@@ -40,7 +43,12 @@ info. It does not have any negative impact on performance. */
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/types.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session_options.h"
@@ -48,11 +56,45 @@ info. It does not have any negative impact on performance. */
 
 #ifdef INTEL_MKL
 #include "tensorflow/core/common_runtime/mkl_cpu_allocator.h"
-#include "tensorflow/core/platform/cpu_info.h"
 #endif  // INTEL_MKL
 
 namespace tensorflow {
 
+namespace {
+
+// Returns the process-wide inter-op thread pool of the CPU devices on
+// `numa_node`, whose threads are pinned to that node.
+thread::ThreadPool* GetNumaInterOpThreadPool(const SessionOptions& options,
+                                             int numa_node) {
+  static mutex* mu = new mutex;
+  static std::vector<thread::ThreadPool*>* pools =
+      new std::vector<thread::ThreadPool*>;
+  mutex_lock l(*mu);
+  if (numa_node >= pools->size()) pools->resize(numa_node + 1, nullptr);
+  thread::ThreadPool*& pool = (*pools)[numa_node];
+  if (pool == nullptr) {
+    // Split the session's inter-op threads across the nodes, or use all the
+    // cores of this node by default.
+    int32_t num_threads = options.config.inter_op_parallelism_threads();
+    if (num_threads > 0) {
+      num_threads = std::max(1, num_threads / port::NUMANumNodes());
+    } else {
+      num_threads = port::MaxParallelism(numa_node);
+    }
+    ThreadOptions thread_opts;
+    thread_opts.numa_node = numa_node;
+    pool = new thread::ThreadPool(
+        options.env, thread_opts, strings::StrCat("numa_", numa_node, "_Compute"),
+        num_threads, !options.config.experimental().disable_thread_spinning(),
+        /*allocator=*/nullptr);
+    VLOG(1) << "Created inter-op thread pool for NUMA node " << numa_node
+            << " with " << num_threads << " threads";
+  }
+  return pool;
+}
+
+}  // namespace
+
 ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
                                    const string& name, Bytes memory_limit,
                                    const DeviceLocality& locality,
@@ -61,6 +103,13 @@ ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
                                name, DEVICE_CPU, memory_limit, locality)),
       allocator_(allocator),
       scoped_allocator_mgr_(new ScopedAllocatorMgr(name)) {
+  if (options.config.experimental().use_numa_affinity() &&
+      options.config.experimental().use_numa_inter_op_thread_pools() &&
+      locality.numa_node() != port::kNUMANoAffinity) {
+    set_tensorflow_device_thread_pool(
+        GetNumaInterOpThreadPool(options, locality.numa_node()));
+  }
+
   auto s = NodeFileWriter::GetNodeFileWriterIfEnabled(name, env());
   if (!s.ok()) {
     LOG(ERROR) << s.status();
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/threadpool_device.h"
 
+#include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -68,5 +70,33 @@ TEST(ThreadPoolDeviceTest, CopyTensor) {
   device_context->Unref();
 }
 
+TEST(ThreadPoolDeviceTest, NumaDevicesShareInterOpThreadPoolPerNode) {
+  SessionOptions options;
+  options.config.mutable_experimental()->set_use_numa_affinity(true);
+  options.config.mutable_experimental()->set_use_numa_inter_op_thread_pools(
+      true);
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory(DEVICE_CPU)->CreateDevices(
+      options, "/job:localhost/replica:0/task:0", &devices));
+  // There is one CPU device per NUMA node by default.
+  ASSERT_EQ(devices.size(), port::NUMANumNodes());
+  for (int i = 0; i < devices.size(); ++i) {
+    EXPECT_EQ(devices[i]->attributes().locality().numa_node(), i);
+    thread::ThreadPool* pool = devices[i]->tensorflow_device_thread_pool();
+    ASSERT_NE(pool, nullptr);
+    Notification done;
+    pool->Schedule([&done]() { done.Notify(); });
+    done.WaitForNotification();
+  }
+
+  // Devices on the same node share the node's pool.
+  DeviceLocality locality;
+  locality.set_numa_node(0);
+  ThreadPoolDevice device(options, "/device:CPU:7", Bytes(256), locality,
+                          cpu_allocator());
+  EXPECT_EQ(device.tensorflow_device_thread_pool(),
+            devices[0]->tensorflow_device_thread_pool());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,305 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/columnar_utils.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// The size of the trailer that follows the footer: the footer size and the
+// file magic.
+constexpr size_t kTrailerSize = sizeof(uint64) + sizeof(kColumnarFileMagic) - 1;
+
+int64_t NumRows(const ColumnarColumnSchema& column,
+                const ColumnarChunk& chunk) {
+  if (column.ragged()) {
+    return chunk.row_splits.NumElements() - 1;
+  }
+  return chunk.values.dims() > 0 ? chunk.values.dim_size(0) : -1;
+}
+
+// Checks that `chunk` is a valid chunk of `num_rows` rows of `column`.
+Status ValidateChunk(const ColumnarColumnSchema& column,
+                     const ColumnarChunk& chunk, int64_t num_rows) {
+  if (chunk.values.dtype() != column.dtype()) {
+    return errors::InvalidArgument(
+        "Column ", column.name(), " has type ",
+        DataTypeString(column.dtype()), " but its chunk has type ",
+        DataTypeString(chunk.values.dtype()), ".");
+  }
+  if (column.ragged()) {
+    if (chunk.values.dims() != 1 || chunk.row_splits.dtype() != DT_INT64 ||
+        chunk.row_splits.dims() != 1 ||
+        chunk.row_splits.NumElements() != num_rows + 1) {
+      return errors::InvalidArgument(
+          "The chunk of ragged column ", column.name(),
+          " must have vector values and ", num_rows + 1,
+          " int64 row splits, but got values of shape ",
+          chunk.values.shape().DebugString(), " and row splits of shape ",
+          chunk.row_splits.shape().DebugString(), ".");
+    }
+    auto splits = chunk.row_splits.vec<int64_t>();
+    if (splits(0) != 0 || splits(num_rows) != chunk.values.NumElements()) {
+      return errors::InvalidArgument("Invalid row splits for ragged column ",
+                                     column.name(), ".");
+    }
+    for (int64_t i = 0; i < num_rows; ++i) {
+      if (splits(i) > splits(i + 1)) {
+        return errors::InvalidArgument("Row splits for ragged column ",
+                                       column.name(),
+                                       " must be non-decreasing.");
+      }
+    }
+    return OkStatus();
+  }
+  TensorShape expected_shape;
+  TF_RETURN_IF_ERROR(
+      TensorShape::BuildTensorShape({num_rows}, &expected_shape));
+  TF_ASSIGN_OR_RETURN(TensorShape row_shape,
+                      TensorShape::BuildTensorShape(column.row_shape()));
+  TF_RETURN_IF_ERROR(expected_shape.AppendShapeWithStatus(row_shape));
+  if (chunk.values.shape() != expected_shape) {
+    return errors::InvalidArgument(
+        "The chunk of column ", column.name(), " must have shape ",
+        expected_shape.DebugString(), " but got ",
+        chunk.values.shape().DebugString(), ".");
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+Status ColumnarFileWriter::Create(Env* env, const std::string& filename,
+                                  std::vector<ColumnarColumnSchema> columns,
+                                  std::unique_ptr<ColumnarFileWriter>* writer) {
+  absl::flat_hash_set<std::string> names;
+  for (const ColumnarColumnSchema& column : columns) {
+    if (column.name().empty() || !names.insert(column.name()).second) {
+      return errors::InvalidArgument(
+          "Column names must be non-empty and unique, got \"", column.name(),
+          "\".");
+    }
+    if (!column.ragged()) {
+      TF_RETURN_IF_ERROR(TensorShape::IsValidShape(column.row_shape()));
+    }
+  }
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  writer->reset(new ColumnarFileWriter(std::move(file)));
+  (*writer)->footer_.set_version(kColumnarFileVersion);
+  for (ColumnarColumnSchema& column : columns) {
+    *(*writer)->footer_.add_columns() = std::move(column);
+  }
+  return OkStatus();
+}
+
+ColumnarFileWriter::ColumnarFileWriter(std::unique_ptr<WritableFile> file)
+    : file_(std::move(file)) {}
+
+Status ColumnarFileWriter::WriteRowGroup(
+    const std::vector<ColumnarChunk>& chunks) {
+  if (chunks.size() != footer_.columns_size()) {
+    return errors::InvalidArgument("Expected ", footer_.columns_size(),
+                                   " column chunks, got ", chunks.size(), ".");
+  }
+  const int64_t num_rows =
+      chunks.empty() ? 0 : NumRows(footer_.columns(0), chunks[0]);
+  if (num_rows < 0) {
+    return errors::InvalidArgument("The chunk of column ",
+                                   footer_.columns(0).name(),
+                                   " must have at least one dimension.");
+  }
+  ColumnarRowGroup* row_group = footer_.add_row_groups();
+  row_group->set_num_rows(num_rows);
+  for (int i = 0; i < chunks.size(); ++i) {
+    const ColumnarColumnSchema& column = footer_.columns(i);
+    TF_RETURN_IF_ERROR(ValidateChunk(column, chunks[i], num_rows));
+    ColumnarChunkData data;
+    chunks[i].values.AsProtoTensorContent(data.mutable_values());
+    if (column.ragged()) {
+      auto splits = chunks[i].row_splits.vec<int64_t>();
+      data.mutable_row_splits()->Reserve(splits.size());
+      for (int64_t j = 0; j < splits.size(); ++j) {
+        data.add_row_splits(splits(j));
+      }
+    }
+    std::string serialized;
+    if (!data.SerializeToString(&serialized)) {
+      return errors::Internal("Failed to serialize the chunk of column ",
+                              column.name(), ".");
+    }
+    TF_RETURN_IF_ERROR(file_->Append(serialized));
+    ColumnarChunkLocation* location = row_group->add_chunks();
+    location->set_offset(offset_);
+    location->set_size(serialized.size());
+    location->set_crc32c(
+        crc32c::Mask(crc32c::Value(serialized.data(), serialized.size())));
+    offset_ += serialized.size();
+  }
+  return OkStatus();
+}
+
+Status ColumnarFileWriter::Close() {
+  std::string serialized;
+  if (!footer_.SerializeToString(&serialized)) {
+    return errors::Internal("Failed to serialize the columnar file footer.");
+  }
+  char size[sizeof(uint64)];
+  core::EncodeFixed64(size, serialized.size());
+  serialized.append(size, sizeof(size));
+  serialized.append(kColumnarFileMagic, sizeof(kColumnarFileMagic) - 1);
+  TF_RETURN_IF_ERROR(file_->Append(serialized));
+  return file_->Close();
+}
+
+Status ColumnarFileReader::Open(Env* env, const std::string& filename,
+                                std::unique_ptr<ColumnarFileReader>* reader) {
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  if (file_size < kTrailerSize) {
+    return errors::DataLoss(filename, " is not a columnar file: it is too "
+                            "small to hold a footer.");
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+
+  char trailer_scratch[kTrailerSize];
+  StringPiece trailer;
+  TF_RETURN_IF_ERROR(file->Read(file_size - kTrailerSize, kTrailerSize,
+                                &trailer, trailer_scratch));
+  if (trailer.size() != kTrailerSize ||
+      trailer.substr(sizeof(uint64)) != kColumnarFileMagic) {
+    return errors::DataLoss(filename, " is not a columnar file.");
+  }
+  const uint64 footer_size = core::DecodeFixed64(trailer.data());
+  if (footer_size > file_size - kTrailerSize) {
+    return errors::DataLoss("Invalid footer size in columnar file ", filename,
+                            ".");
+  }
+  std::string footer_scratch(footer_size, '\0');
+  StringPiece footer;
+  TF_RETURN_IF_ERROR(file->Read(file_size - kTrailerSize - footer_size,
+                                footer_size, &footer, &footer_scratch[0]));
+
+  reader->reset(new ColumnarFileReader(filename, std::move(file)));
+  ColumnarFileFooter& parsed = (*reader)->footer_;
+  if (!parsed.ParseFromArray(footer.data(), footer.size())) {
+    return errors::DataLoss("Failed to parse the footer of columnar file ",
+                            filename, ".");
+  }
+  if (parsed.version() != kColumnarFileVersion) {
+    return errors::Unimplemented("Unsupported version ", parsed.version(),
+                                 " of columnar file ", filename, ".");
+  }
+  for (const ColumnarColumnSchema& column : parsed.columns()) {
+    Status s = column.ragged()
+                   ? PartialTensorShape::IsValidShape(column.row_shape())
+                   : TensorShape::IsValidShape(column.row_shape());
+    if (!s.ok()) {
+      return errors::DataLoss("Invalid row shape for column ", column.name(),
+                              " of columnar file ", filename, ": ",
+                              s.error_message());
+    }
+  }
+  // Chunks are stored before the footer.
+  const uint64 data_size = file_size - kTrailerSize - footer_size;
+  for (const ColumnarRowGroup& row_group : parsed.row_groups()) {
+    if (row_group.num_rows() < 0 ||
+        row_group.chunks_size() != parsed.columns_size()) {
+      return errors::DataLoss("Invalid row group in columnar file ", filename,
+                              ".");
+    }
+    for (const ColumnarChunkLocation& location : row_group.chunks()) {
+      if (location.offset() < 0 || location.size() < 0 ||
+          static_cast<uint64>(location.offset()) > data_size ||
+          static_cast<uint64>(location.size()) >
+              data_size - static_cast<uint64>(location.offset())) {
+        return errors::DataLoss("Invalid chunk location in columnar file ",
+                                filename, ".");
+      }
+    }
+  }
+  return OkStatus();
+}
+
+ColumnarFileReader::ColumnarFileReader(std::string filename,
+                                       std::unique_ptr<RandomAccessFile> file)
+    : filename_(std::move(filename)), file_(std::move(file)) {}
+
+StatusOr<int64_t> ColumnarFileReader::FindColumn(
+    absl::string_view name) const {
+  for (int64_t i = 0; i < footer_.columns_size(); ++i) {
+    if (footer_.columns(i).name() == name) return i;
+  }
+  return errors::NotFound("Column ", name, " not found in columnar file ",
+                          filename_, ".");
+}
+
+Status ColumnarFileReader::ReadChunk(int64_t row_group, int64_t column,
+                                     ColumnarChunk* chunk) const {
+  if (row_group < 0 || row_group >= footer_.row_groups_size() || column < 0 ||
+      column >= footer_.columns_size()) {
+    return errors::OutOfRange("Invalid chunk (", row_group, ", ", column,
+                              ") of columnar file ", filename_, ".");
+  }
+  const ColumnarRowGroup& group = footer_.row_groups(row_group);
+  const ColumnarChunkLocation& location = group.chunks(column);
+  std::string scratch(location.size(), '\0');
+  StringPiece data;
+  TF_RETURN_IF_ERROR(
+      file_->Read(location.offset(), location.size(), &data, &scratch[0]));
+  if (data.size() != location.size() ||
+      crc32c::Unmask(location.crc32c()) !=
+          crc32c::Value(data.data(), data.size())) {
+    return errors::DataLoss("Corrupted chunk (", row_group, ", ", column,
+                            ") in columnar file ", filename_, ".");
+  }
+  ColumnarChunkData parsed;
+  if (!parsed.ParseFromArray(data.data(), data.size()) ||
+      !chunk->values.FromProto(parsed.values())) {
+    return errors::DataLoss("Failed to parse chunk (", row_group, ", ", column,
+                            ") of columnar file ", filename_, ".");
+  }
+  const ColumnarColumnSchema& schema = footer_.columns(column);
+  if (schema.ragged()) {
+    chunk->row_splits = Tensor(DT_INT64, {parsed.row_splits_size()});
+    auto splits = chunk->row_splits.vec<int64_t>();
+    for (int i = 0; i < parsed.row_splits_size(); ++i) {
+      splits(i) = parsed.row_splits(i);
+    }
+  } else {
+    chunk->row_splits = Tensor();
+  }
+  Status s = ValidateChunk(schema, *chunk, group.num_rows());
+  if (!s.ok()) {
+    return errors::DataLoss("Invalid chunk (", row_group, ", ", column,
+                            ") in columnar file ", filename_, ": ",
+                            s.error_message());
+  }
+  return OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,104 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_COLUMNAR_UTILS_H_
+#define TENSORFLOW_CORE_DATA_COLUMNAR_UTILS_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/columnar.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+
+// Utilities for reading and writing the columnar file format described in
+// columnar.proto.
+
+constexpr char kColumnarFileMagic[] = "TFCOLMN1";
+constexpr int64_t kColumnarFileVersion = 1;
+
+// The values of one column in one row group.
+struct ColumnarChunk {
+  // For a dense column, a tensor of shape `[num_rows] + row_shape`. For a
+  // ragged column, a vector holding the values of all rows.
+  Tensor values;
+  // For a ragged column, an int64 vector of `num_rows + 1` row splits into
+  // `values`. Empty for a dense column.
+  Tensor row_splits;
+};
+
+// Writes a columnar file one row group at a time.
+class ColumnarFileWriter {
+ public:
+  // Creates a writer for a new file `filename` with the given schema.
+  static Status Create(Env* env, const std::string& filename,
+                       std::vector<ColumnarColumnSchema> columns,
+                       std::unique_ptr<ColumnarFileWriter>* writer);
+
+  // Appends a row group. `chunks` must hold one chunk per column, in schema
+  // order, with the same number of rows each.
+  Status WriteRowGroup(const std::vector<ColumnarChunk>& chunks);
+
+  // Writes the footer and closes the file.
+  Status Close();
+
+ private:
+  explicit ColumnarFileWriter(std::unique_ptr<WritableFile> file);
+
+  std::unique_ptr<WritableFile> file_;
+  ColumnarFileFooter footer_;
+  int64_t offset_ = 0;
+};
+
+// Reads the chunks of a columnar file. Different chunks can be read
+// concurrently.
+class ColumnarFileReader {
+ public:
+  // Opens `filename` and reads its footer.
+  static Status Open(Env* env, const std::string& filename,
+                     std::unique_ptr<ColumnarFileReader>* reader);
+
+  const ColumnarFileFooter& footer() const { return footer_; }
+  int64_t num_row_groups() const { return footer_.row_groups_size(); }
+
+  // Returns the index of the column named `name`.
+  StatusOr<int64_t> FindColumn(absl::string_view name) const;
+
+  // Reads the chunk of column `column` in row group `row_group`. Only the
+  // bytes of that chunk are read from the file.
+  Status ReadChunk(int64_t row_group, int64_t column,
+                   ColumnarChunk* chunk) const;
+
+ private:
+  ColumnarFileReader(std::string filename,
+                     std::unique_ptr<RandomAccessFile> file);
+
+  const std::string filename_;
+  const std::unique_ptr<RandomAccessFile> file_;
+  ColumnarFileFooter footer_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_COLUMNAR_UTILS_H_
@@ -0,0 +1,221 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/columnar_utils.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/test_util.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::data::testing::LocalTempFilename;
+using ::tensorflow::testing::StatusIs;
+
+std::vector<ColumnarColumnSchema> TestSchema() {
+  std::vector<ColumnarColumnSchema> columns(3);
+  columns[0].set_name("ids");
+  columns[0].set_dtype(DT_INT64);
+  columns[1].set_name("embedding");
+  columns[1].set_dtype(DT_FLOAT);
+  columns[1].mutable_row_shape()->add_dim()->set_size(2);
+  columns[2].set_name("tokens");
+  columns[2].set_dtype(DT_STRING);
+  columns[2].set_ragged(true);
+  return columns;
+}
+
+// Returns a row group with `num_rows` rows, where row `i` has id
+// `first_id + i`, embedding `[i, -i]` and `i % 3` tokens.
+std::vector<ColumnarChunk> TestRowGroup(int64_t first_id, int64_t num_rows) {
+  std::vector<ColumnarChunk> chunks(3);
+  chunks[0].values = Tensor(DT_INT64, {num_rows});
+  chunks[1].values = Tensor(DT_FLOAT, {num_rows, 2});
+  chunks[2].row_splits = Tensor(DT_INT64, {num_rows + 1});
+  std::vector<tstring> tokens;
+  chunks[2].row_splits.vec<int64_t>()(0) = 0;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    chunks[0].values.vec<int64_t>()(i) = first_id + i;
+    chunks[1].values.matrix<float>()(i, 0) = i;
+    chunks[1].values.matrix<float>()(i, 1) = -i;
+    for (int64_t j = 0; j < i % 3; ++j) {
+      tokens.push_back(absl::StrCat("token_", first_id + i, "_", j));
+    }
+    chunks[2].row_splits.vec<int64_t>()(i + 1) = tokens.size();
+  }
+  chunks[2].values = test::AsTensor<tstring>(tokens);
+  return chunks;
+}
+
+// Writes a columnar file with one row group and replaces its footer with the
+// result of applying `update` to it.
+void WriteFileWithFooter(const std::string& filename,
+                         std::function<void(ColumnarFileFooter&)> update) {
+  std::unique_ptr<ColumnarFileWriter> writer;
+  TF_ASSERT_OK(ColumnarFileWriter::Create(Env::Default(), filename,
+                                          TestSchema(), &writer));
+  TF_ASSERT_OK(writer->WriteRowGroup(TestRowGroup(0, 5)));
+  TF_ASSERT_OK(writer->Close());
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+
+  const std::string magic = kColumnarFileMagic;
+  const size_t trailer_size = sizeof(uint64) + magic.size();
+  const uint64 footer_size =
+      core::DecodeFixed64(&contents[contents.size() - trailer_size]);
+  const size_t data_size = contents.size() - trailer_size - footer_size;
+  ColumnarFileFooter footer;
+  ASSERT_TRUE(footer.ParseFromArray(&contents[data_size], footer_size));
+  update(footer);
+  std::string serialized = footer.SerializeAsString();
+  char size[sizeof(uint64)];
+  core::EncodeFixed64(size, serialized.size());
+  contents = absl::StrCat(contents.substr(0, data_size), serialized,
+                          absl::string_view(size, sizeof(size)), magic);
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, contents));
+}
+
+TEST(ColumnarUtilsTest, WriteAndRead) {
+  const std::string filename = LocalTempFilename();
+  std::unique_ptr<ColumnarFileWriter> writer;
+  TF_ASSERT_OK(ColumnarFileWriter::Create(Env::Default(), filename,
+                                          TestSchema(), &writer));
+  const std::vector<ColumnarChunk> row_group0 = TestRowGroup(0, 5);
+  const std::vector<ColumnarChunk> row_group1 = TestRowGroup(5, 3);
+  TF_ASSERT_OK(writer->WriteRowGroup(row_group0));
+  TF_ASSERT_OK(writer->WriteRowGroup(row_group1));
+  TF_ASSERT_OK(writer->Close());
+
+  std::unique_ptr<ColumnarFileReader> reader;
+  TF_ASSERT_OK(ColumnarFileReader::Open(Env::Default(), filename, &reader));
+  ASSERT_EQ(reader->num_row_groups(), 2);
+  EXPECT_EQ(reader->footer().row_groups(0).num_rows(), 5);
+  EXPECT_EQ(reader->footer().row_groups(1).num_rows(), 3);
+  TF_ASSERT_OK_AND_ASSIGN(int64_t tokens, reader->FindColumn("tokens"));
+  EXPECT_EQ(tokens, 2);
+  EXPECT_THAT(reader->FindColumn("labels"),
+              StatusIs(error::NOT_FOUND));
+
+  ColumnarChunk chunk;
+  TF_ASSERT_OK(reader->ReadChunk(/*row_group=*/1, /*column=*/1, &chunk));
+  test::ExpectEqual(chunk.values, row_group1[1].values);
+  TF_ASSERT_OK(reader->ReadChunk(/*row_group=*/0, tokens, &chunk));
+  test::ExpectEqual(chunk.values, row_group0[2].values);
+  test::ExpectEqual(chunk.row_splits, row_group0[2].row_splits);
+}
+
+TEST(ColumnarUtilsTest, InvalidRowGroup) {
+  std::unique_ptr<ColumnarFileWriter> writer;
+  TF_ASSERT_OK(ColumnarFileWriter::Create(
+      Env::Default(), LocalTempFilename(), TestSchema(), &writer));
+  std::vector<ColumnarChunk> chunks = TestRowGroup(0, 5);
+  chunks[1].values = Tensor(DT_FLOAT, {5, 3});
+  EXPECT_THAT(writer->WriteRowGroup(chunks),
+              StatusIs(error::INVALID_ARGUMENT));
+  chunks = TestRowGroup(0, 5);
+  chunks.pop_back();
+  EXPECT_THAT(writer->WriteRowGroup(chunks),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST(ColumnarUtilsTest, DuplicateColumnNames) {
+  std::vector<ColumnarColumnSchema> columns = TestSchema();
+  columns[1].set_name("ids");
+  std::unique_ptr<ColumnarFileWriter> writer;
+  EXPECT_THAT(ColumnarFileWriter::Create(Env::Default(), LocalTempFilename(),
+                                         columns, &writer),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST(ColumnarUtilsTest, NotAColumnarFile) {
+  const std::string filename = LocalTempFilename();
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 "this is not a columnar file"));
+  std::unique_ptr<ColumnarFileReader> reader;
+  EXPECT_THAT(ColumnarFileReader::Open(Env::Default(), filename, &reader),
+              StatusIs(error::DATA_LOSS));
+}
+
+TEST(ColumnarUtilsTest, CorruptedChunk) {
+  const std::string filename = LocalTempFilename();
+  std::unique_ptr<ColumnarFileWriter> writer;
+  TF_ASSERT_OK(ColumnarFileWriter::Create(Env::Default(), filename,
+                                          TestSchema(), &writer));
+  TF_ASSERT_OK(writer->WriteRowGroup(TestRowGroup(0, 5)));
+  TF_ASSERT_OK(writer->Close());
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  contents[0] ^= 0xff;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, contents));
+
+  std::unique_ptr<ColumnarFileReader> reader;
+  TF_ASSERT_OK(ColumnarFileReader::Open(Env::Default(), filename, &reader));
+  ColumnarChunk chunk;
+  EXPECT_THAT(reader->ReadChunk(/*row_group=*/0, /*column=*/0, &chunk),
+              StatusIs(error::DATA_LOSS));
+  // Other chunks are unaffected.
+  TF_EXPECT_OK(reader->ReadChunk(/*row_group=*/0, /*column=*/1, &chunk));
+}
+
+TEST(ColumnarUtilsTest, NegativeRowShape) {
+  const std::string filename = LocalTempFilename();
+  WriteFileWithFooter(filename, [](ColumnarFileFooter& footer) {
+    footer.mutable_columns(1)->mutable_row_shape()->mutable_dim(0)->set_size(
+        -5);
+  });
+  std::unique_ptr<ColumnarFileReader> reader;
+  EXPECT_THAT(ColumnarFileReader::Open(Env::Default(), filename, &reader),
+              StatusIs(error::DATA_LOSS));
+}
+
+TEST(ColumnarUtilsTest, OversizedRowShape) {
+  const std::string filename = LocalTempFilename();
+  WriteFileWithFooter(filename, [](ColumnarFileFooter& footer) {
+    TensorShapeProto* row_shape =
+        footer.mutable_columns(1)->mutable_row_shape();
+    row_shape->mutable_dim(0)->set_size(int64_t{1} << 40);
+    row_shape->add_dim()->set_size(int64_t{1} << 40);
+  });
+  std::unique_ptr<ColumnarFileReader> reader;
+  EXPECT_THAT(ColumnarFileReader::Open(Env::Default(), filename, &reader),
+              StatusIs(error::DATA_LOSS));
+}
+
+TEST(ColumnarUtilsTest, ChunkPastEndOfFile) {
+  const std::string filename = LocalTempFilename();
+  WriteFileWithFooter(filename, [](ColumnarFileFooter& footer) {
+    ColumnarChunkLocation* location =
+        footer.mutable_row_groups(0)->mutable_chunks(2);
+    location->set_size(int64_t{1} << 40);
+  });
+  std::unique_ptr<ColumnarFileReader> reader;
+  EXPECT_THAT(ColumnarFileReader::Open(Env::Default(), filename, &reader),
+              StatusIs(error::DATA_LOSS));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
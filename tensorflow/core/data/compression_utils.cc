@@ -14,7 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <zstd.h>
+
+#include <algorithm>
+#include <cstring>
 #include <limits>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -35,8 +40,24 @@ namespace {
 
 // Increment this when making changes to the `CompressedElement` proto. The
 // `UncompressElement` function will determine what to read according to the
-// version.
-constexpr int kCompressedElementVersion = 0;
+// version. Version 1 added the `codec` field.
+constexpr int kCompressedElementVersion = 1;
+
+// Snappy-compressed elements have the same format as in version 0, so they are
+// written with version 0 to stay readable by older readers.
+constexpr int kSnappyCompressedElementVersion = 0;
+
+// Zstd elements smaller than this are always compressed, since checking
+// whether they compress well costs more than it can save.
+constexpr size_t kMinAdaptiveCompressionBytes = 4 << 10;  // 4KB
+
+// For elements larger than twice this size, the first bytes are compressed
+// first to estimate whether the rest of the element is worth compressing.
+constexpr size_t kCompressibilitySampleBytes = 64 << 10;  // 64KB
+
+// Fast zstd level, which typically compresses better than Snappy at a similar
+// speed.
+constexpr int kZstdCompressionLevel = 1;
 
 }  // namespace
 
@@ -57,14 +78,166 @@ class Iov {
 
   size_t NumPieces() const { return iov_.size(); }
 
+  // Returns the pieces covering the first `num_bytes` bytes.
+  Iov Prefix(size_t num_bytes) const {
+    size_t num_pieces = 0;
+    for (size_t bytes = 0; num_pieces < idx_ && bytes < num_bytes;
+         ++num_pieces) {
+      bytes += iov_[num_pieces].iov_len;
+    }
+    Iov prefix(num_pieces);
+    for (size_t i = 0; i < num_pieces; ++i) {
+      prefix.Add(iov_[i].iov_base,
+                 std::min(iov_[i].iov_len, num_bytes - prefix.NumBytes()));
+    }
+    return prefix;
+  }
+
  private:
   std::vector<struct iovec> iov_;
   size_t idx_;
   size_t num_bytes_;
 };
 
+namespace {
+
+// Returns true if compressing `uncompressed_size` bytes into `compressed_size`
+// bytes saves less than 1/8 of the size.
+bool IsIncompressible(size_t uncompressed_size, size_t compressed_size) {
+  return compressed_size >= uncompressed_size - uncompressed_size / 8;
+}
+
+// Returns true if the first `kCompressibilitySampleBytes` of `iov` do not
+// compress well. Snappy is used for the estimate because it gives up quickly
+// on incompressible data.
+bool SampleIsIncompressible(const Iov& iov) {
+  Iov sample = iov.Prefix(kCompressibilitySampleBytes);
+  std::string compressed;
+  if (!port::Snappy_CompressFromIOVec(sample.Data(), sample.NumBytes(),
+                                      &compressed)) {
+    return false;
+  }
+  return IsIncompressible(sample.NumBytes(), compressed.size());
+}
+
+Status ZstdCompress(Iov& iov, std::string* out) {
+  std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> context(
+      ZSTD_createCCtx(), &ZSTD_freeCCtx);
+  if (context == nullptr) {
+    return errors::ResourceExhausted(
+        "Failed to create a zstd compression context.");
+  }
+  size_t result = ZSTD_CCtx_setParameter(
+      context.get(), ZSTD_c_compressionLevel, kZstdCompressionLevel);
+  if (!ZSTD_isError(result)) {
+    // Records the uncompressed size in the frame header.
+    result = ZSTD_CCtx_setPledgedSrcSize(context.get(), iov.NumBytes());
+  }
+  if (ZSTD_isError(result)) {
+    return errors::Internal("Failed to configure zstd compression: ",
+                            ZSTD_getErrorName(result));
+  }
+
+  out->resize(ZSTD_compressBound(iov.NumBytes()));
+  ZSTD_outBuffer output = {out->data(), out->size(), 0};
+  for (size_t i = 0; i <= iov.NumPieces(); ++i) {
+    const bool last = i == iov.NumPieces();
+    ZSTD_inBuffer input = {nullptr, 0, 0};
+    if (!last) {
+      input = {iov.Data()[i].iov_base, iov.Data()[i].iov_len, 0};
+    }
+    do {
+      result = ZSTD_compressStream2(context.get(), &output, &input,
+                                    last ? ZSTD_e_end : ZSTD_e_continue);
+      if (ZSTD_isError(result)) {
+        return errors::Internal("Failed to compress using zstd: ",
+                                ZSTD_getErrorName(result));
+      }
+    } while (last ? result != 0 : input.pos < input.size);
+  }
+  out->resize(output.pos);
+  return OkStatus();
+}
+
+Status ZstdUncompress(const std::string& compressed, Iov& iov) {
+  unsigned long long uncompressed_size =
+      ZSTD_getFrameContentSize(compressed.data(), compressed.size());
+  if (uncompressed_size == ZSTD_CONTENTSIZE_ERROR ||
+      uncompressed_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+    return errors::Internal(
+        "Could not get zstd uncompressed length. Compressed data size: ",
+        compressed.size());
+  }
+  if (uncompressed_size != static_cast<size_t>(iov.NumBytes())) {
+    return errors::Internal(
+        "Uncompressed size mismatch. Zstd expects ", uncompressed_size,
+        " whereas the tensor metadata suggests ", iov.NumBytes());
+  }
+
+  std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> context(
+      ZSTD_createDCtx(), &ZSTD_freeDCtx);
+  if (context == nullptr) {
+    return errors::ResourceExhausted(
+        "Failed to create a zstd decompression context.");
+  }
+  // Decompresses directly into the tensor buffers.
+  ZSTD_inBuffer input = {compressed.data(), compressed.size(), 0};
+  for (size_t i = 0; i < iov.NumPieces(); ++i) {
+    ZSTD_outBuffer output = {iov.Data()[i].iov_base, iov.Data()[i].iov_len, 0};
+    while (output.pos < output.size) {
+      size_t result = ZSTD_decompressStream(context.get(), &output, &input);
+      if (ZSTD_isError(result)) {
+        return errors::Internal("Failed to perform zstd decompression: ",
+                                ZSTD_getErrorName(result));
+      }
+      if (result == 0 && output.pos < output.size) {
+        return errors::Internal(
+            "Failed to perform zstd decompression: the compressed data ended "
+            "before the element was complete.");
+      }
+    }
+  }
+  return OkStatus();
+}
+
+void CopyFromIov(Iov& iov, std::string* out) {
+  out->resize(iov.NumBytes());
+  char* pos = out->data();
+  for (size_t i = 0; i < iov.NumPieces(); ++i) {
+    if (iov.Data()[i].iov_len > 0) {
+      std::memcpy(pos, iov.Data()[i].iov_base, iov.Data()[i].iov_len);
+      pos += iov.Data()[i].iov_len;
+    }
+  }
+}
+
+Status CopyToIov(const std::string& data, Iov& iov) {
+  if (data.size() != iov.NumBytes()) {
+    return errors::Internal("Uncompressed size mismatch. The element has ",
+                            data.size(),
+                            " bytes whereas the tensor metadata suggests ",
+                            iov.NumBytes());
+  }
+  const char* pos = data.data();
+  for (size_t i = 0; i < iov.NumPieces(); ++i) {
+    if (iov.Data()[i].iov_len > 0) {
+      std::memcpy(iov.Data()[i].iov_base, pos, iov.Data()[i].iov_len);
+      pos += iov.Data()[i].iov_len;
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out) {
+  return CompressElement(element, CompressedElement::CODEC_SNAPPY, out);
+}
+
+Status CompressElement(const std::vector<Tensor>& element,
+                       CompressedElement::Codec codec,
+                       CompressedElement* out) {
   // First pass: preprocess the non`memcpy`able tensors.
   size_t num_string_tensors = 0;
   size_t num_string_tensor_strings = 0;
@@ -122,27 +295,65 @@ Status CompressElement(const std::vector<Tensor>& element,
     }
   }
 
-  if (iov.NumBytes() > kuint32max) {
+  if (codec == CompressedElement::CODEC_SNAPPY &&
+      iov.NumBytes() > kuint32max) {
     return errors::OutOfRange("Encountered dataset element of size ",
                               iov.NumBytes(),
                               ", exceeding the 4GB Snappy limit.");
   }
-  if (!port::Snappy_CompressFromIOVec(iov.Data(), iov.NumBytes(),
-                                      out->mutable_data())) {
-    return errors::Internal("Failed to compress using snappy.");
+  // Already compressed data, e.g. encoded images, is sent as is instead of
+  // spending CPU on compressing it again. Only zstd, which readers have to
+  // support explicitly, falls back to raw elements: Snappy elements stay in the
+  // version 0 format that every reader understands.
+  const bool adaptive = codec == CompressedElement::CODEC_ZSTD &&
+                        iov.NumBytes() >= kMinAdaptiveCompressionBytes;
+  if (adaptive && iov.NumBytes() > 2 * kCompressibilitySampleBytes &&
+      SampleIsIncompressible(iov)) {
+    codec = CompressedElement::CODEC_NONE;
   }
-  out->set_version(kCompressedElementVersion);
+  switch (codec) {
+    case CompressedElement::CODEC_SNAPPY:
+      if (!port::Snappy_CompressFromIOVec(iov.Data(), iov.NumBytes(),
+                                          out->mutable_data())) {
+        return errors::Internal("Failed to compress using snappy.");
+      }
+      break;
+    case CompressedElement::CODEC_ZSTD:
+      TF_RETURN_IF_ERROR(ZstdCompress(iov, out->mutable_data()));
+      break;
+    case CompressedElement::CODEC_NONE:
+      CopyFromIov(iov, out->mutable_data());
+      break;
+    default:
+      return errors::InvalidArgument("Unsupported compression codec: ",
+                                     CompressedElement::Codec_Name(codec));
+  }
+  if (adaptive && codec != CompressedElement::CODEC_NONE &&
+      IsIncompressible(iov.NumBytes(), out->data().size())) {
+    codec = CompressedElement::CODEC_NONE;
+    CopyFromIov(iov, out->mutable_data());
+  }
+  out->set_codec(codec);
+  out->set_version(codec == CompressedElement::CODEC_SNAPPY
+                       ? kSnappyCompressedElementVersion
+                       : kCompressedElementVersion);
   VLOG(3) << "Compressed element from " << iov.NumBytes() << " bytes to "
-          << out->data().size() << " bytes";
+          << out->data().size() << " bytes with "
+          << CompressedElement::Codec_Name(codec);
   return OkStatus();
 }
 
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out) {
-  if (compressed.version() != kCompressedElementVersion) {
+  if (compressed.version() < 0 ||
+      compressed.version() > kCompressedElementVersion) {
     return errors::Internal("Unsupported compressed element version: ",
                             compressed.version());
   }
+  // Elements written before version 1 are always compressed with Snappy.
+  const CompressedElement::Codec codec =
+      compressed.version() >= 1 ? compressed.codec()
+                                : CompressedElement::CODEC_SNAPPY;
   int num_components = compressed.component_metadata_size();
   out->clear();
   out->reserve(num_components);
@@ -193,22 +404,36 @@ Status UncompressElement(const CompressedElement& compressed,
 
   // Step 2: Uncompress into the iovec.
   const std::string& compressed_data = compressed.data();
-  size_t uncompressed_size;
-  if (!port::Snappy_GetUncompressedLength(
-          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
-    return errors::Internal(
-        "Could not get snappy uncompressed length. Compressed data size: ",
-        compressed_data.size());
-  }
-  if (uncompressed_size != static_cast<size_t>(iov.NumBytes())) {
-    return errors::Internal(
-        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
-        " whereas the tensor metadata suggests ", iov.NumBytes());
-  }
-  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
-                                      compressed_data.size(), iov.Data(),
-                                      iov.NumPieces())) {
-    return errors::Internal("Failed to perform snappy decompression.");
+  switch (codec) {
+    case CompressedElement::CODEC_SNAPPY: {
+      size_t uncompressed_size;
+      if (!port::Snappy_GetUncompressedLength(compressed_data.data(),
+                                              compressed_data.size(),
+                                              &uncompressed_size)) {
+        return errors::Internal(
+            "Could not get snappy uncompressed length. Compressed data size: ",
+            compressed_data.size());
+      }
+      if (uncompressed_size != static_cast<size_t>(iov.NumBytes())) {
+        return errors::Internal(
+            "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
+            " whereas the tensor metadata suggests ", iov.NumBytes());
+      }
+      if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
+                                          compressed_data.size(), iov.Data(),
+                                          iov.NumPieces())) {
+        return errors::Internal("Failed to perform snappy decompression.");
+      }
+      break;
+    }
+    case CompressedElement::CODEC_ZSTD:
+      TF_RETURN_IF_ERROR(ZstdUncompress(compressed_data, iov));
+      break;
+    case CompressedElement::CODEC_NONE:
+      TF_RETURN_IF_ERROR(CopyToIov(compressed_data, iov));
+      break;
+    default:
+      return errors::Internal("Unsupported compression codec: ", codec);
   }
 
   // Third pass: deserialize nonstring, non`memcpy`able tensors.
@@ -35,6 +35,14 @@ namespace data {
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out);
 
+// Like `CompressElement` above, which uses Snappy, but compresses with `codec`.
+// Zstd elements which do not compress well, e.g. encoded images, are stored
+// uncompressed instead, which is recorded in `out->codec()`. Snappy elements
+// are always Snappy-compressed in the version 0 format, and are the only ones
+// limited to 4GB.
+Status CompressElement(const std::vector<Tensor>& element,
+                       CompressedElement::Codec codec, CompressedElement* out);
+
 // Uncompresses a `CompressedElement` into a vector of tensor components.
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out);
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <random>
 #include <string>
 #include <vector>
 
@@ -27,9 +28,23 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+using ::testing::AnyOf;
 using ::testing::HasSubstr;
+using ::testing::Lt;
 using ::tsl::testing::StatusIs;
 
+// Returns `size` random bytes, which do not compress.
+tstring RandomBytes(size_t size) {
+  std::mt19937 generator(/*seed=*/0);
+  std::uniform_int_distribution<int> distribution(0, 255);
+  tstring bytes;
+  bytes.resize_uninitialized(size);
+  for (size_t i = 0; i < size; ++i) {
+    bytes.mdata()[i] = static_cast<char>(distribution(generator));
+  }
+  return bytes;
+}
+
 TEST(CompressionUtilsTest, Exceeds4GB) {
   std::vector<Tensor> element = {
       CreateTensor<int64_t>(TensorShape{1024, 1024, 513})};  // Just over 4GB.
@@ -39,6 +54,70 @@ TEST(CompressionUtilsTest, Exceeds4GB) {
                        HasSubstr("exceeding the 4GB Snappy limit")));
 }
 
+TEST(CompressionUtilsTest, IncompressibleZstdElementIsStoredUncompressed) {
+  for (size_t size : {size_t{16 << 10}, size_t{1 << 20}}) {
+    std::vector<Tensor> element = {
+        CreateTensor<tstring>(TensorShape{1}, {RandomBytes(size)}),
+        CreateTensor<int64_t>(TensorShape{2}, {1, 2})};
+    CompressedElement compressed;
+    TF_ASSERT_OK(
+        CompressElement(element, CompressedElement::CODEC_ZSTD, &compressed));
+    EXPECT_EQ(compressed.codec(), CompressedElement::CODEC_NONE);
+    EXPECT_EQ(compressed.version(), 1);
+    EXPECT_EQ(compressed.data().size(), size + 2 * sizeof(int64_t));
+
+    std::vector<Tensor> round_trip_element;
+    TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+    test::ExpectEqual(element[0], round_trip_element[0]);
+    test::ExpectEqual(element[1], round_trip_element[1]);
+  }
+}
+
+TEST(CompressionUtilsTest, SnappyElementsAreAlwaysVersion0) {
+  for (size_t size : {size_t{16}, size_t{16 << 10}, size_t{1 << 20}}) {
+    for (const tstring& bytes : {RandomBytes(size), tstring(size, 'a')}) {
+      std::vector<Tensor> element = {
+          CreateTensor<tstring>(TensorShape{1}, {bytes})};
+      CompressedElement compressed;
+      TF_ASSERT_OK(CompressElement(element, &compressed));
+      EXPECT_EQ(compressed.codec(), CompressedElement::CODEC_SNAPPY);
+      EXPECT_EQ(compressed.version(), 0);
+
+      CompressedElement explicitly_snappy;
+      TF_ASSERT_OK(CompressElement(element, CompressedElement::CODEC_SNAPPY,
+                                   &explicitly_snappy));
+      EXPECT_EQ(explicitly_snappy.codec(), CompressedElement::CODEC_SNAPPY);
+      EXPECT_EQ(explicitly_snappy.version(), 0);
+
+      std::vector<Tensor> round_trip_element;
+      TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+      test::ExpectEqual(element[0], round_trip_element[0]);
+    }
+  }
+}
+
+TEST(CompressionUtilsTest, CompressibleElementIsCompressedWithZstd) {
+  std::vector<Tensor> element = {CreateTensor<int64_t>(
+      TensorShape{128, 128}, std::vector<int64_t>(128 * 128, 0))};
+  CompressedElement compressed;
+  TF_ASSERT_OK(
+      CompressElement(element, CompressedElement::CODEC_ZSTD, &compressed));
+  EXPECT_EQ(compressed.codec(), CompressedElement::CODEC_ZSTD);
+  EXPECT_EQ(compressed.version(), 1);
+  EXPECT_THAT(compressed.data().size(), Lt(128 * 128 * sizeof(int64_t) / 8));
+}
+
+TEST(CompressionUtilsTest, CorruptedUncompressedElement) {
+  std::vector<Tensor> element = {CreateTensor<int64_t>(TensorShape{2}, {1, 2})};
+  CompressedElement compressed;
+  TF_ASSERT_OK(
+      CompressElement(element, CompressedElement::CODEC_NONE, &compressed));
+  compressed.mutable_data()->pop_back();
+  std::vector<Tensor> round_trip_element;
+  EXPECT_THAT(UncompressElement(compressed, &round_trip_element),
+              StatusIs(error::INTERNAL, HasSubstr("size mismatch")));
+}
+
 std::vector<std::vector<Tensor>> TestCases() {
   return {
       // Single int64.
@@ -86,6 +165,22 @@ TEST_P(ParameterizedCompressionUtilsTest, RoundTrip) {
       ExpectEqual(element, round_trip_element, /*compare_order=*/true));
 }
 
+TEST_P(ParameterizedCompressionUtilsTest, RoundTripWithCodecs) {
+  std::vector<Tensor> element = GetParam();
+  for (CompressedElement::Codec codec :
+       {CompressedElement::CODEC_SNAPPY, CompressedElement::CODEC_ZSTD,
+        CompressedElement::CODEC_NONE}) {
+    CompressedElement compressed;
+    TF_ASSERT_OK(CompressElement(element, codec, &compressed));
+    EXPECT_THAT(compressed.codec(),
+                AnyOf(codec, CompressedElement::CODEC_NONE));
+    std::vector<Tensor> round_trip_element;
+    TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+    TF_EXPECT_OK(
+        ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+  }
+}
+
 TEST_P(ParameterizedCompressionUtilsTest, CompressedElementVersion) {
   std::vector<Tensor> element = GetParam();
   CompressedElement compressed;
@@ -98,7 +193,7 @@ TEST_P(ParameterizedCompressionUtilsTest, VersionMismatch) {
   CompressedElement compressed;
   TF_ASSERT_OK(CompressElement(element, &compressed));
 
-  compressed.set_version(1);
+  compressed.set_version(2);
   std::vector<Tensor> round_trip_element;
   EXPECT_THAT(UncompressElement(compressed, &round_trip_element),
               StatusIs(error::INTERNAL));
@@ -78,6 +78,9 @@ get_dataset_experiments() {
 constexpr char kMapAndBatchFusionOpt[] = "map_and_batch_fusion";
 constexpr char kNoopEliminationOpt[] = "noop_elimination";
 constexpr char kMapParallelizationOpt[] = "map_parallelization";
+constexpr char kMapVectorizationOpt[] = "map_vectorization";
+constexpr char kColumnarProjectionPushdownOpt[] =
+    "columnar_projection_pushdown";
 constexpr char kShuffleAndRepeatFusionOpt[] = "shuffle_and_repeat_fusion";
 constexpr char kFilterFusionOpt[] = "filter_fusion";
 constexpr char kMapAndFilterFusionOpt[] = "map_and_filter_fusion";
@@ -166,6 +169,22 @@ void DefaultOptimizationGraphRewrites(
       optimization_disabled->insert(kMapParallelizationOpt);
     }
   }
+  if (optimization_options.optional_map_vectorization_case() ==
+      OptimizationOptions::kMapVectorization) {
+    if (optimization_options.map_vectorization()) {
+      optimization_enabled->insert(kMapVectorizationOpt);
+    } else {
+      optimization_disabled->insert(kMapVectorizationOpt);
+    }
+  }
+  if (optimization_options.optional_columnar_projection_pushdown_case() ==
+      OptimizationOptions::kColumnarProjectionPushdown) {
+    if (optimization_options.columnar_projection_pushdown()) {
+      optimization_enabled->insert(kColumnarProjectionPushdownOpt);
+    } else {
+      optimization_disabled->insert(kColumnarProjectionPushdownOpt);
+    }
+  }
   if (optimization_options.optional_filter_parallelization_case() ==
       OptimizationOptions::kFilterParallelization) {
     if (optimization_options.filter_parallelization()) {
@@ -955,6 +974,8 @@ REGISTER_DATASET_EXPERIMENT("autotune_buffer_optimization",
                             RandomJobSamplePercentage<5>, IndependentHostTasks);
 REGISTER_DATASET_EXPERIMENT(kFilterParallelizationOpt,
                             RandomJobSamplePercentage<0>, AllTasks);
+REGISTER_DATASET_EXPERIMENT("iterator_stats", RandomJobSamplePercentage<0>,
+                            AllTasks);
 REGISTER_DATASET_EXPERIMENT("min_outer_interleave_parallelism",
                             RandomJobSamplePercentage<0>, AllTasks);
 REGISTER_DATASET_EXPERIMENT("reduce_interleave_prefetch",
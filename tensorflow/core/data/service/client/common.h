@@ -42,6 +42,10 @@ struct DataServiceParams final {
   TargetWorkers target_workers = TargetWorkers::TARGET_WORKERS_UNSPECIFIED;
   DataServiceMetadata metadata;
   std::optional<CrossTrainerCacheOptions> cross_trainer_cache_options;
+  // The maximum number of elements to fetch with each GetElement request, or
+  // `model::kAutotune` to adapt it to the element size and request latency.
+  // Values other than 1 also allow several requests in flight per task.
+  int64_t max_elements_per_request = 1;
 };
 
 }  // namespace data
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/client/data_service_client.h"
 
 #include <algorithm>
+#include <cmath>
 #include <functional>
 #include <limits>
 #include <memory>
@@ -55,6 +56,31 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+// Upper bound on the number of elements per request when
+// `max_elements_per_request` is autotuned.
+constexpr int64_t kMaxAutotunedElementsPerRequest = 64;
+// Upper bound on the number of concurrent batched requests per task.
+constexpr int64_t kMaxRequestsPerTask = 4;
+// Autotuning keeps the expected size of a batched response below this many
+// bytes.
+constexpr double kTargetResponseBytes = 8 << 20;
+// Weight of the latest sample in the moving averages used for autotuning.
+constexpr double kMovingAverageWeight = 0.2;
+
+double UpdateMovingAverage(double average, double sample) {
+  if (average <= 0.0) {
+    return sample;
+  }
+  return (1.0 - kMovingAverageWeight) * average +
+         kMovingAverageWeight * sample;
+}
+
+bool UseBatchedRequests(const DataServiceParams& params) {
+  return params.max_elements_per_request != 1 &&
+         !params.num_consumers.has_value() &&
+         !params.cross_trainer_cache_options.has_value();
+}
+
 bool IsColocatedTask(const TaskInfo& task) {
   return absl::c_any_of(task.worker_tags(), [](std::string_view worker_tag) {
     return absl::AsciiStrToUpper(worker_tag) == kColocatedWorkerTag;
@@ -66,7 +92,13 @@ bool IsColocatedTask(const TaskInfo& task) {
 
 DataServiceClient::DataServiceClient(const DataServiceParams& params)
     : params_(params),
-      max_outstanding_requests_(params.max_outstanding_requests) {}
+      batched_requests_(UseBatchedRequests(params)),
+      max_outstanding_requests_(params.max_outstanding_requests) {
+  if (batched_requests_ &&
+      params.max_elements_per_request != model::kAutotune) {
+    elements_per_request_ = params.max_elements_per_request;
+  }
+}
 
 DataServiceClient::~DataServiceClient() {
   VLOG(2) << "Destroying data service client for iteration id "
@@ -129,6 +161,18 @@ StatusOr<GetNextResult> DataServiceClient::GetNext(
     ctx_ = context_factory();
   }
   EnsureThreadsStarted();
+  if (batched_requests_ && last_get_next_return_micros_ > 0) {
+    avg_consumer_interval_micros_ = UpdateMovingAverage(
+        avg_consumer_interval_micros_,
+        std::max<int64_t>(
+            Env::Default()->NowMicros() - last_get_next_return_micros_, 1));
+  }
+  // Runs before `l` is released.
+  auto record_return = gtl::MakeCleanup([this]() TF_NO_THREAD_SAFETY_ANALYSIS {
+    if (batched_requests_) {
+      last_get_next_return_micros_ = Env::Default()->NowMicros();
+    }
+  });
   std::shared_ptr<Result> result;
   do {
     while (!ResultReady() && !Finished() && !cancelled_ && status_.ok()) {
@@ -203,6 +247,10 @@ TraceMeMetadata DataServiceClient::GetTraceMeMetadata() const {
       "max_outstanding_requests",
       strings::Printf(
           "%lld", static_cast<long long>(params_.max_outstanding_requests))));
+  result.push_back(std::make_pair(
+      "max_elements_per_request",
+      strings::Printf(
+          "%lld", static_cast<long long>(params_.max_elements_per_request))));
   return result;
 }
 
@@ -513,8 +561,12 @@ void DataServiceClient::UpdateBufferSize() TF_LOCKS_EXCLUDED(mu_) {
 
 void DataServiceClient::UpdateWorkerThreads() TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock l(mu_);
-  const int64_t max_num_threads =
-      std::min<int64_t>(tasks_.size(), max_outstanding_requests_);
+  // Batched requests may keep up to `kMaxRequestsPerTask` requests in flight
+  // for each task.
+  const int64_t max_requests_per_task =
+      batched_requests_ ? kMaxRequestsPerTask : 1;
+  const int64_t max_num_threads = std::min<int64_t>(
+      tasks_.size() * max_requests_per_task, max_outstanding_requests_);
   while (num_running_worker_threads_ < max_num_threads && !cancelled_ &&
          status_.ok()) {
     num_running_worker_threads_++;
@@ -538,13 +590,16 @@ void DataServiceClient::RunWorkerThread(std::function<void()> done)
   });
   VLOG(1) << "Starting worker thread";
   std::shared_ptr<Task> task_to_process;
+  // The number of elements reserved in `outstanding_requests_` for the
+  // current request.
+  int64_t num_elements = 0;
   while (true) {
     std::shared_ptr<Result> result;
     {
       mutex_lock l(mu_);
       if (task_to_process) {
-        task_to_process->in_use = false;
-        --outstanding_requests_;
+        --task_to_process->in_use;
+        outstanding_requests_ -= num_elements;
         task_to_process = nullptr;
         worker_thread_cv_.notify_one();
       }
@@ -561,8 +616,13 @@ void DataServiceClient::RunWorkerThread(std::function<void()> done)
         worker_thread_cv_.wait(l);
       }
       DCHECK(task_to_process != nullptr);
-      task_to_process->in_use = true;
-      ++outstanding_requests_;
+      ++task_to_process->in_use;
+      num_elements = NumElementsToRequest();
+      outstanding_requests_ += num_elements;
+      if (batched_requests_) {
+        metrics::RecordTFDataServiceGetElementPipeliningDepth(
+            outstanding_requests_);
+      }
       if (IsCoordinatedRead()) {
         // Reserve a spot in the results_ queue.
         results_.push(std::make_shared<Result>());
@@ -575,15 +635,15 @@ void DataServiceClient::RunWorkerThread(std::function<void()> done)
       VLOG(3) << "Processing task " << task_to_process->info.task_id();
     }
     int64_t deadline_micros = kint64max;
-    Status s =
-        GetElementTraced(task_to_process.get(), deadline_micros,
-                         /*enqueue_result=*/!IsCoordinatedRead(), result);
+    Status s = GetElementTraced(task_to_process.get(), deadline_micros,
+                                /*enqueue_result=*/!IsCoordinatedRead(),
+                                num_elements, result);
     if (!s.ok()) {
       mutex_lock l(mu_);
       VLOG(1) << "Failed to get element from worker "
               << task_to_process->info.worker_address() << ": " << s;
-      task_to_process->in_use = false;
-      --outstanding_requests_;
+      --task_to_process->in_use;
+      outstanding_requests_ -= num_elements;
       status_ = errors::CreateWithUpdatedMessage(
           s, absl::StrCat("Failed to get element from worker ",
                           task_to_process->info.worker_address(), ": ",
@@ -619,7 +679,7 @@ std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
   for (int i = 0; i < tasks_.size(); ++i) {
     std::shared_ptr<Task>& task = tasks_[next_task_index_];
     if (IsCoordinatedRead() &&
-        (task->in_use ||
+        (task->in_use > 0 ||
          current_round_ >= round_robin_round_limit_.value_or(
                                std::numeric_limits<int64_t>::max()))) {
       VLOG(4) << "No round robin task found. in_use: " << task->in_use
@@ -628,7 +688,7 @@ std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
               << round_robin_round_limit_.value_or(-1);
       return nullptr;
     }
-    if (current_round_ < task->info.starting_round() || task->in_use ||
+    if (current_round_ < task->info.starting_round() || TaskBusy(*task) ||
         task->end_of_sequence || task->removed) {
       VLOG(3) << "Skipping task " << next_task_index_
               << ". starting round: " << task->info.starting_round()
@@ -646,6 +706,14 @@ std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
   return nullptr;
 }
 
+bool DataServiceClient::TaskBusy(const Task& task) const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (batched_requests_) {
+    return task.in_use >= requests_per_task_;
+  }
+  return task.in_use > 0;
+}
+
 // Increments the next task index, starting over if all tasks have been
 // processed.
 void DataServiceClient::AdvanceTaskIndex() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -656,11 +724,64 @@ void DataServiceClient::AdvanceTaskIndex() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   }
 }
 
-Status DataServiceClient::TryGetElement(const Task& task,
+// Returns the number of elements to ask for in the next request. Batched
+// requests reserve their elements in `outstanding_requests_`, so a request
+// never asks for more elements than `max_outstanding_requests_` allows.
+int64_t DataServiceClient::NumElementsToRequest() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (!batched_requests_) {
+    return 1;
+  }
+  const int64_t available = max_outstanding_requests_ - results_.size() -
+                            outstanding_requests_;
+  return std::max<int64_t>(std::min(elements_per_request_, available), 1);
+}
+
+void DataServiceClient::UpdateBatchingParameters(const GetElementResult& result,
+                                                 int64_t rtt_micros)
+    TF_LOCKS_EXCLUDED(mu_) {
+  const size_t num_results = 1 + result.additional_results.size();
+  const double element_bytes =
+      static_cast<double>(result.EstimatedMemoryUsageBytes()) / num_results;
+  mutex_lock l(mu_);
+  avg_element_bytes_ = UpdateMovingAverage(avg_element_bytes_, element_bytes);
+  avg_rtt_micros_ = UpdateMovingAverage(avg_rtt_micros_, rtt_micros);
+  if (avg_consumer_interval_micros_ <= 0.0 || tasks_.empty()) {
+    return;
+  }
+  // The number of elements the consumer takes while a request is in flight.
+  // Keeping that many elements in flight hides the request latency.
+  const double needed = std::ceil(avg_rtt_micros_ /
+                                  avg_consumer_interval_micros_);
+  if (params_.max_elements_per_request == model::kAutotune) {
+    const double max_elements_by_size =
+        std::max(kTargetResponseBytes / std::max(avg_element_bytes_, 1.0), 1.0);
+    elements_per_request_ = static_cast<int64_t>(
+        std::clamp(std::min(needed, max_elements_by_size), 1.0,
+                   static_cast<double>(kMaxAutotunedElementsPerRequest)));
+  }
+  const int64_t requests_per_task = static_cast<int64_t>(std::clamp(
+      std::ceil(needed / (elements_per_request_ * tasks_.size())), 1.0,
+      static_cast<double>(kMaxRequestsPerTask)));
+  if (requests_per_task > requests_per_task_) {
+    worker_thread_cv_.notify_all();
+  }
+  requests_per_task_ = requests_per_task;
+  VLOG(3) << "Batching " << elements_per_request_ << " elements per request "
+          << "with " << requests_per_task_ << " requests per task. Average "
+          << "element size: " << avg_element_bytes_ << " bytes, request "
+          << "latency: " << avg_rtt_micros_ << "us, consumer interval: "
+          << avg_consumer_interval_micros_ << "us.";
+}
+
+Status DataServiceClient::TryGetElement(const Task& task, int64_t num_elements,
                                         GetElementResult& result) {
   GetElementRequest req;
   req.set_task_id(task.info.task_id());
   req.set_skipped_previous_round(task.skipped_previous_round);
+  if (num_elements > 1) {
+    req.set_max_elements(num_elements);
+  }
   if (IsCoordinatedRead()) {
     req.set_consumer_index(params_.consumer_index.value());
     req.set_round_index(task.round);
@@ -676,36 +797,49 @@ void DataServiceClient::ProcessGetElementResponse(
     bool enqueue_result, GetElementResult& get_element_result,
     std::shared_ptr<Result> result, Task& task) TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock l(mu_);
-  result->ready = true;
-  result->end_of_sequence = get_element_result.end_of_sequence;
-  result->skip = get_element_result.skip;
-  if (!get_element_result.end_of_sequence && !get_element_result.skip) {
-    task.skipped_previous_round = false;
-    result->element = std::move(get_element_result.components);
-    result->element_index = get_element_result.element_index;
-    result->task_id = task.info.task_id();
-  } else if (get_element_result.skip) {
-    task.skipped_previous_round = true;
-  } else {
-    task.end_of_sequence = true;
-    finished_tasks_++;
-  }
-  if (enqueue_result && !result->end_of_sequence) {
-    ctx_->RecordBufferEnqueue(result->element);
-    results_.push(std::move(result));
+  // Elements of batched responses after the first one get their own results.
+  std::vector<GetElementResult> additional_results =
+      std::move(get_element_result.additional_results);
+  for (size_t i = 0; i <= additional_results.size(); ++i) {
+    GetElementResult& current_result =
+        i == 0 ? get_element_result : additional_results[i - 1];
+    if (i > 0) {
+      result = std::make_shared<Result>();
+    }
+    result->ready = true;
+    result->end_of_sequence = current_result.end_of_sequence;
+    result->skip = current_result.skip;
+    if (!current_result.end_of_sequence && !current_result.skip) {
+      task.skipped_previous_round = false;
+      result->element = std::move(current_result.components);
+      result->element_index = current_result.element_index;
+      result->task_id = task.info.task_id();
+    } else if (current_result.skip) {
+      task.skipped_previous_round = true;
+    } else if (!task.end_of_sequence) {
+      // Concurrent batched requests may all observe the end of the task.
+      task.end_of_sequence = true;
+      finished_tasks_++;
+    }
+    if (enqueue_result && !result->end_of_sequence) {
+      ctx_->RecordBufferEnqueue(result->element);
+      results_.push(std::move(result));
+    }
   }
   get_next_cv_.notify_all();
 }
 
 Status DataServiceClient::GetElementTraced(Task* task, int64_t deadline_micros,
                                            bool enqueue_result,
+                                           int64_t num_elements,
                                            std::shared_ptr<Result> result)
     TF_LOCKS_EXCLUDED(mu_) {
   VLOG(3) << "Getting an element for task id " << task->info.task_id();
   tensorflow::profiler::TraceMe activity(
       "GetDataServiceElement", tensorflow::profiler::TraceMeLevel::kInfo);
   activity.AppendMetadata([&]() {
-    return profiler::TraceMeEncode({{"address", task->info.worker_address()}});
+    return profiler::TraceMeEncode({{"address", task->info.worker_address()},
+                                    {"num_elements", num_elements}});
   });
   if (IsCoordinatedRead()) {
     VLOG(3) << "Requesting element from consumer index "
@@ -716,7 +850,8 @@ Status DataServiceClient::GetElementTraced(Task* task, int64_t deadline_micros,
            {"round_index", task->round}});
     });
   }
-  Status s = GetElement(task, deadline_micros, enqueue_result, result);
+  Status s =
+      GetElement(task, deadline_micros, enqueue_result, num_elements, result);
   mutex_lock l(mu_);
   VLOG(3) << "Got an element for task id " << task->info.task_id();
   return s;
@@ -753,13 +888,20 @@ Status DataServiceClient::MaybeRemoveTask(Task& task, int64_t deadline_micros,
 }
 
 Status DataServiceClient::GetElement(Task* task, int64_t deadline_micros,
-                                     bool enqueue_result,
+                                     bool enqueue_result, int64_t num_elements,
                                      std::shared_ptr<Result> result)
     TF_LOCKS_EXCLUDED(mu_) {
   GetElementResult get_element_result;
   for (int num_retries = 0;; ++num_retries) {
-    Status s = TryGetElement(*task, get_element_result);
-    if (s.ok()) break;
+    const int64_t start_micros = Env::Default()->NowMicros();
+    Status s = TryGetElement(*task, num_elements, get_element_result);
+    if (s.ok()) {
+      if (batched_requests_) {
+        UpdateBatchingParameters(get_element_result,
+                                 Env::Default()->NowMicros() - start_micros);
+      }
+      break;
+    }
     if (!IsPreemptedError(s)) {
       if (!params_.data_transfer_protocol.empty() ||
           DefaultDataTransferProtocol() == kGrpcTransferProtocol) {
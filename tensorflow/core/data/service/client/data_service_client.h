@@ -94,8 +94,9 @@ class DataServiceClient {
     // deleted from `tasks_` on the next dispatcher heartbeat.
     bool removed = false;
     bool skipped_previous_round = false;
-    // Indicates whether a worker thread is currently processing the task.
-    bool in_use TF_GUARDED_BY(&DataServiceClient::mu_) = false;
+    // Number of worker threads currently processing the task. This is at most
+    // one unless requests are batched.
+    int64_t in_use TF_GUARDED_BY(&DataServiceClient::mu_) = 0;
     // Indicates whether the worker has returned end_of_sequence for the task.
     bool end_of_sequence TF_GUARDED_BY(&DataServiceClient::mu_) = false;
   };
@@ -153,16 +154,26 @@ class DataServiceClient {
   // Searches for a task to process, visiting tasks in-order and giving every
   // task a chance to proceed.
   std::shared_ptr<Task> GetTaskToProcess();
+  // Returns whether `task` cannot take another concurrent request.
+  bool TaskBusy(const Task& task) const;
   void AdvanceTaskIndex();
-  Status TryGetElement(const Task& task, GetElementResult& result);
+  // Returns the number of elements to ask for in the next request.
+  int64_t NumElementsToRequest() const;
+  // Adapts `elements_per_request_` and `requests_per_task_` after a batched
+  // request returned `result` in `rtt_micros`.
+  void UpdateBatchingParameters(const GetElementResult& result,
+                                int64_t rtt_micros);
+  Status TryGetElement(const Task& task, int64_t num_elements,
+                       GetElementResult& result);
   void ProcessGetElementResponse(bool enqueue_result,
                                  GetElementResult& get_element_result,
                                  std::shared_ptr<Result> result, Task& task);
   Status GetElementTraced(Task* task, int64_t deadline_micros,
-                          bool enqueue_result, std::shared_ptr<Result> result);
+                          bool enqueue_result, int64_t num_elements,
+                          std::shared_ptr<Result> result);
   Status MaybeRemoveTask(Task& task, int64_t deadline_micros, Result& result);
   Status GetElement(Task* task, int64_t deadline_micros, bool enqueue_result,
-                    std::shared_ptr<Result> result);
+                    int64_t num_elements, std::shared_ptr<Result> result);
   bool ResultReady() const;
   std::shared_ptr<Result> PopNextResult();
   bool IsCoordinatedRead() const;
@@ -170,6 +181,10 @@ class DataServiceClient {
 
   const DataServiceParams params_;
 
+  // Whether GetElement requests may fetch several elements, with several
+  // requests in flight per task. Never true for coordinated reads.
+  const bool batched_requests_;
+
   mutable mutex mu_;
   condition_variable get_next_cv_ TF_GUARDED_BY(mu_);
   condition_variable worker_thread_cv_ TF_GUARDED_BY(mu_);
@@ -185,6 +200,17 @@ class DataServiceClient {
   // elements as well as completed requests which haven't yet been produced.
   int64_t max_outstanding_requests_ TF_GUARDED_BY(mu_);
 
+  // When `batched_requests_` is true, the number of elements to ask for with
+  // each request and the number of concurrent requests per task.
+  int64_t elements_per_request_ TF_GUARDED_BY(mu_) = 1;
+  int64_t requests_per_task_ TF_GUARDED_BY(mu_) = 1;
+  // Moving averages used to adapt the batching parameters.
+  double avg_element_bytes_ TF_GUARDED_BY(mu_) = 0.0;
+  double avg_rtt_micros_ TF_GUARDED_BY(mu_) = 0.0;
+  // Average time the consumer spends between two `GetNext` calls.
+  double avg_consumer_interval_micros_ TF_GUARDED_BY(mu_) = 0.0;
+  int64_t last_get_next_return_micros_ TF_GUARDED_BY(mu_) = 0;
+
   // The number of threads in `worker_threads_` which are still running.
   int64_t num_running_worker_threads_ TF_GUARDED_BY(mu_) = 0;
 
@@ -20,17 +20,24 @@ limitations under the License.
 #include <functional>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/service/cross_trainer_cache_spill.h"
 #include "tensorflow/core/data/service/logging_utils.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace data {
@@ -46,6 +53,13 @@ namespace data {
 // collected when the cache becomes full. Consequently, trainers read from a
 // sliding window through the dataset and may not read the full dataset.
 //
+// Optionally, elements garbage collected from memory are spilled to a local
+// disk instead of being dropped (see `CrossTrainerCacheSpillOptions`). Trainers
+// which fall behind the in-memory window then read the spilled elements, which
+// are prefetched back into memory ahead of them, rather than skipping data.
+// This requires the `CachableSequence` to implement `SerializeElement` and
+// `DeserializeElement`.
+//
 // The `CrossTrainerCache` class is thread-safe.
 //
 // Example usage:
@@ -89,6 +103,20 @@ class CachableSequence {
 
   // Returns the estimated size of the element in bytes.
   virtual size_t GetElementSizeBytes(const ElementType&) const = 0;
+
+  // Serializes an element to spill it to disk. Only needs to be implemented if
+  // the cache spills elements. May be called concurrently with `GetNext`.
+  virtual StatusOr<std::string> SerializeElement(const ElementType&) const {
+    return errors::Unimplemented(
+        "This cachable sequence does not support spilling elements to disk.");
+  }
+
+  // Restores an element serialized by `SerializeElement`. May be called
+  // concurrently from multiple threads.
+  virtual StatusOr<ElementType> DeserializeElement(absl::string_view) const {
+    return errors::Unimplemented(
+        "This cachable sequence does not support spilling elements to disk.");
+  }
 };
 
 // Sliding-window cache shared across concurrent trainers.
@@ -98,9 +126,12 @@ class CrossTrainerCache {
   // Creates a `CrossTrainerCache` with `max_cache_size_bytes` of memory budget.
   // The cache should be able to hold at least one element, i.e.:
   // REQUIRES: `max_cache_size_bytes >= max(GetElementSizeBytes(*))`
+  // If `spill_options.directory` is set, elements freed from memory are spilled
+  // to that directory, using up to `spill_options.max_size_bytes` of disk.
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
-      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+      const CrossTrainerCacheSpillOptions& spill_options = {});
   virtual ~CrossTrainerCache() = default;
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
@@ -134,10 +165,17 @@ class CrossTrainerCache {
   // data is not ready, one of the trainers need to extend the cache.
   bool IsElementReady(const std::string& trainer_id);
 
+  // Returns true if the next element for `trainer_id` has been freed from
+  // memory but is still spilled on disk.
+  bool IsElementSpilled(const std::string& trainer_id);
+
   // Returns the absolute element index relative to the dataset (not relative to
   // the cached elements).
   size_t GetElementIndex(const std::string& trainer_id);
 
+  // Returns the absolute index of the oldest element in memory or on disk.
+  size_t GetOldestElementIndex() const;
+
   // Returns the next element for `trainer_id`.
   StatusOr<std::shared_ptr<const ElementType>> GetElement(
       const std::string& trainer_id);
@@ -149,9 +187,31 @@ class CrossTrainerCache {
   // `new_element_size_bytes` is the size of the new element being inserted.
   void FreeSpace(size_t new_element_size_bytes);
 
+  // Writes the elements that `FreeSpace(new_element_size_bytes)` is about to
+  // free to the spill log.
+  Status SpillElements(size_t new_element_size_bytes);
+
+  // Reads and deserializes the spilled element at absolute index `index`.
+  StatusOr<std::shared_ptr<const ElementType>> ReadSpilledElement(
+      size_t index) const;
+
+  // Asynchronously reads the spilled elements following `index` into
+  // `prefetched_elements_`.
+  void PrefetchSpilledElements(size_t index);
+
+  // Drops prefetched elements which are no longer spilled, and the oldest ones
+  // if there are more than `kMaxPrefetchedElements`.
+  void TrimPrefetchedElements();
+
   // Records the cache hit rate and cache size.
   void RecordMetrics(const CacheQueryResult& result);
 
+  // Number of spilled elements read ahead of a trainer that reads from disk.
+  static constexpr size_t kSpillPrefetchSize = 4;
+  // Maximum number of prefetched spilled elements kept in memory, in addition
+  // to `max_cache_size_bytes_`.
+  static constexpr size_t kMaxPrefetchedElements = 16;
+
   // Maximum cache size in bytes.
   const size_t max_cache_size_bytes_;
 
@@ -178,18 +238,37 @@ class CrossTrainerCache {
   // `trainer_to_element_index_map_[trainer_id] - cache_start_index_`.
   absl::flat_hash_map<std::string, size_t> trainer_to_element_index_map_
       TF_GUARDED_BY(mu_);
+
+  // Log of the elements freed from `cache_`. Null if spilling is disabled.
+  std::unique_ptr<CrossTrainerCacheSpillLog> spill_log_;
+  // Spilled elements read back into memory, keyed by absolute element index.
+  absl::flat_hash_map<size_t, std::shared_ptr<const ElementType>>
+      prefetched_elements_ TF_GUARDED_BY(mu_);
+  // Indices of the spilled elements being prefetched.
+  absl::flat_hash_set<size_t> prefetching_elements_ TF_GUARDED_BY(mu_);
+  // Threads prefetching spilled elements. Declared last so that pending
+  // prefetches finish before the other members are destroyed.
+  std::unique_ptr<thread::ThreadPool> prefetch_thread_pool_;
 };
 
 template <class ElementType>
 CrossTrainerCache<ElementType>::CrossTrainerCache(
     size_t max_cache_size_bytes,
-    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence)
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+    const CrossTrainerCacheSpillOptions& spill_options)
     : max_cache_size_bytes_(max_cache_size_bytes),
       cachable_sequence_(std::move(cachable_sequence)) {
   DCHECK_GT(max_cache_size_bytes, 0)
       << "CrossTrainerCache size must be greater than 0.";
   VLOG(2) << "Initialized tf.data service cross-trainer cache with "
           << FormatBytes(max_cache_size_bytes) << " of memory.";
+  if (!spill_options.directory.empty()) {
+    spill_log_ = std::make_unique<CrossTrainerCacheSpillLog>(Env::Default(),
+                                                            spill_options);
+    prefetch_thread_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "tf_data_cross_trainer_cache_prefetch",
+        /*num_threads=*/2);
+  }
 }
 
 template <class ElementType>
@@ -212,20 +291,30 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
     const std::string& trainer_id) {
   bool should_extend_cache = false;
   while (true) {
+    std::optional<size_t> spilled_index;
     {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(status_);
-      if (IsElementReady(trainer_id)) {
+      if (IsElementSpilled(trainer_id)) {
+        size_t element_index = GetElementIndex(trainer_id);
+        auto it = prefetched_elements_.find(element_index);
+        if (it != prefetched_elements_.end()) {
+          std::shared_ptr<const ElementType> element = it->second;
+          trainer_to_element_index_map_[trainer_id] = element_index + 1;
+          PrefetchSpilledElements(element_index + 1);
+          return CacheQueryResult{element, /*is_cache_hit=*/true};
+        }
+        should_extend_cache = false;
+        spilled_index = element_index;
+      } else if (IsElementReady(trainer_id)) {
         TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
                             GetElement(trainer_id));
         return CacheQueryResult{element,
                                 /*is_cache_hit=*/!should_extend_cache};
-      }
-
-      // Extends the cache or waits for another thread to extend the cache. When
-      // concurrent trainers wait for the next element, only one of them should
-      // extend the cache.
-      if (extending_cache_) {
+      } else if (extending_cache_) {
+        // Extends the cache or waits for another thread to extend the cache.
+        // When concurrent trainers wait for the next element, only one of them
+        // should extend the cache.
         should_extend_cache = false;
         cv_.wait(l);
       } else {
@@ -234,6 +323,21 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
       }
     }
 
+    if (spilled_index.has_value()) {
+      StatusOr<std::shared_ptr<const ElementType>> element =
+          ReadSpilledElement(*spilled_index);
+      if (errors::IsNotFound(element.status())) {
+        // The element has been dropped from the disk. Retries with the oldest
+        // remaining element.
+        continue;
+      }
+      TF_RETURN_IF_ERROR(element.status());
+      mutex_lock l(mu_);
+      trainer_to_element_index_map_[trainer_id] = *spilled_index + 1;
+      PrefetchSpilledElements(*spilled_index + 1);
+      return CacheQueryResult{*std::move(element), /*is_cache_hit=*/true};
+    }
+
     if (should_extend_cache) {
       Status s = ExtendCache();
       mutex_lock l(mu_);
@@ -267,16 +371,36 @@ CrossTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
   return result;
 }
 
+template <class ElementType>
+bool CrossTrainerCache<ElementType>::IsElementSpilled(
+    const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  return GetElementIndex(trainer_id) < cache_start_index_;
+}
+
 template <class ElementType>
 size_t CrossTrainerCache<ElementType>::GetElementIndex(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   size_t element_index = trainer_to_element_index_map_[trainer_id];
-  if (element_index < cache_start_index_) {
-    element_index = cache_start_index_;
+  size_t oldest_element_index = GetOldestElementIndex();
+  if (element_index < oldest_element_index) {
+    element_index = oldest_element_index;
   }
   return element_index;
 }
 
+template <class ElementType>
+size_t CrossTrainerCache<ElementType>::GetOldestElementIndex() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (spill_log_ != nullptr) {
+    size_t spill_start_index = spill_log_->start_index();
+    if (spill_start_index < cache_start_index_ &&
+        spill_log_->Contains(spill_start_index)) {
+      return spill_start_index;
+    }
+  }
+  return cache_start_index_;
+}
+
 template <class ElementType>
 Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
   TF_ASSIGN_OR_RETURN(ElementType element, cachable_sequence_->GetNext());
@@ -289,6 +413,9 @@ Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
         " and cache size: ", max_cache_size_bytes_);
   }
 
+  if (spill_log_ != nullptr) {
+    TF_RETURN_IF_ERROR(SpillElements(new_element_size_bytes));
+  }
   mutex_lock l(mu_);
   TF_RETURN_IF_ERROR(status_);
   FreeSpace(new_element_size_bytes);
@@ -316,6 +443,101 @@ void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
           << FormatBytes(cache_size_bytes_) << ".";
 }
 
+template <class ElementType>
+Status CrossTrainerCache<ElementType>::SpillElements(
+    size_t new_element_size_bytes) TF_LOCKS_EXCLUDED(mu_) {
+  // Only the thread extending the cache modifies `cache_`, so the elements
+  // `FreeSpace` will free can be serialized and written without the lock.
+  std::vector<std::shared_ptr<const ElementType>> elements;
+  size_t start_index = 0;
+  {
+    mutex_lock l(mu_);
+    start_index = cache_start_index_;
+    size_t cache_size_bytes = cache_size_bytes_;
+    for (size_t i = 0; i < cache_.size() &&
+                       cache_size_bytes + new_element_size_bytes >
+                           max_cache_size_bytes_;
+         ++i) {
+      elements.push_back(cache_[i]);
+      cache_size_bytes -= cachable_sequence_->GetElementSizeBytes(*cache_[i]);
+    }
+  }
+
+  for (size_t i = 0; i < elements.size(); ++i) {
+    TF_ASSIGN_OR_RETURN(std::string serialized,
+                        cachable_sequence_->SerializeElement(*elements[i]));
+    Status s = spill_log_->Append(start_index + i, serialized);
+    if (!s.ok()) {
+      // Trainers behind this element skip to the next spilled element.
+      LOG(WARNING) << "Failed to spill tf.data service cross-trainer cache "
+                   << "element " << start_index + i << " to disk: " << s;
+    }
+  }
+  if (!elements.empty()) {
+    VLOG(3) << "Spilled " << elements.size() << " element(s) of tf.data "
+            << "service cross-trainer cache to disk. Disk usage: "
+            << FormatBytes(spill_log_->size_bytes()) << ".";
+  }
+  return OkStatus();
+}
+
+template <class ElementType>
+StatusOr<std::shared_ptr<const ElementType>>
+CrossTrainerCache<ElementType>::ReadSpilledElement(size_t index) const
+    TF_LOCKS_EXCLUDED(mu_) {
+  TF_ASSIGN_OR_RETURN(std::string serialized, spill_log_->Read(index));
+  TF_ASSIGN_OR_RETURN(ElementType element,
+                      cachable_sequence_->DeserializeElement(serialized));
+  return std::make_shared<const ElementType>(std::move(element));
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::PrefetchSpilledElements(size_t index)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  for (size_t i = index; i < index + kSpillPrefetchSize; ++i) {
+    if (i >= cache_start_index_) {
+      // The remaining elements are in memory.
+      return;
+    }
+    if (prefetched_elements_.contains(i) ||
+        !prefetching_elements_.insert(i).second) {
+      continue;
+    }
+    prefetch_thread_pool_->Schedule([this, i]() {
+      StatusOr<std::shared_ptr<const ElementType>> element =
+          ReadSpilledElement(i);
+      mutex_lock l(mu_);
+      prefetching_elements_.erase(i);
+      if (element.ok()) {
+        prefetched_elements_[i] = *std::move(element);
+        TrimPrefetchedElements();
+      } else if (!errors::IsNotFound(element.status())) {
+        VLOG(2) << "Failed to prefetch tf.data service cross-trainer cache "
+                << "element " << i << ": " << element.status();
+      }
+    });
+  }
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::TrimPrefetchedElements()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  size_t oldest_element_index = GetOldestElementIndex();
+  absl::erase_if(prefetched_elements_, [oldest_element_index](const auto& kv) {
+    return kv.first < oldest_element_index;
+  });
+  while (prefetched_elements_.size() > kMaxPrefetchedElements) {
+    auto oldest = prefetched_elements_.begin();
+    for (auto it = prefetched_elements_.begin();
+         it != prefetched_elements_.end(); ++it) {
+      if (it->first < oldest->first) {
+        oldest = it;
+      }
+    }
+    prefetched_elements_.erase(oldest);
+  }
+}
+
 template <class ElementType>
 void CrossTrainerCache<ElementType>::Cancel(Status status)
     TF_LOCKS_EXCLUDED(mu_) {
@@ -0,0 +1,199 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/cross_trainer_cache_spill.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/service/logging_utils.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// The log is split into this many segments, so that dropping the oldest
+// segment frees a fraction of the log at a time.
+constexpr size_t kNumSegments = 4;
+
+}  // namespace
+
+CrossTrainerCacheSpillLog::Segment::Segment(Env* env, std::string filename,
+                                            size_t start_index)
+    : env(env), filename(std::move(filename)), start_index(start_index) {}
+
+CrossTrainerCacheSpillLog::Segment::~Segment() {
+  reader.reset();
+  if (writer) {
+    writer->Close().IgnoreError();
+    writer.reset();
+  }
+  Status s = env->DeleteFile(filename);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete tf.data service cross-trainer cache "
+                 << "spill file " << filename << ": " << s;
+  }
+}
+
+CrossTrainerCacheSpillLog::CrossTrainerCacheSpillLog(
+    Env* env, const CrossTrainerCacheSpillOptions& options)
+    : env_(env),
+      options_(options),
+      max_segment_size_bytes_(
+          std::max<size_t>(options.max_size_bytes / kNumSegments, 1)) {
+  VLOG(2) << "Initialized tf.data service cross-trainer cache spill log in "
+          << options_.directory << " with "
+          << FormatBytes(options_.max_size_bytes) << " of disk space.";
+}
+
+Status CrossTrainerCacheSpillLog::Append(size_t index,
+                                         absl::string_view element) {
+  mutex_lock l(mu_);
+  if (index != EndIndex()) {
+    segments_.clear();
+    size_bytes_ = 0;
+  }
+  next_index_ = index;
+  if (segments_.empty() ||
+      segments_.back()->offsets.back() >= max_segment_size_bytes_) {
+    TF_RETURN_IF_ERROR(AddSegment(index));
+  }
+
+  Segment& segment = *segments_.back();
+  Status s = segment.writer->Append(element);
+  if (s.ok()) {
+    // Flushes so that the element is visible to `Read`.
+    s = segment.writer->Flush();
+  }
+  if (!s.ok()) {
+    // The segment is in an unknown state. Drops it so the log stays readable.
+    size_bytes_ -= segment.offsets.back();
+    segments_.pop_back();
+    return s;
+  }
+  segment.offsets.push_back(segment.offsets.back() + element.size());
+  size_bytes_ += element.size();
+  ++next_index_;
+
+  while (segments_.size() > 1 && size_bytes_ > options_.max_size_bytes) {
+    size_bytes_ -= segments_.front()->offsets.back();
+    segments_.pop_front();
+  }
+  return OkStatus();
+}
+
+Status CrossTrainerCacheSpillLog::AddSegment(size_t start_index)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (file_prefix_.empty()) {
+    TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(options_.directory));
+    std::string prefix =
+        io::JoinPath(options_.directory, "cross_trainer_cache_");
+    if (!env_->CreateUniqueFileName(&prefix, "")) {
+      return errors::Internal(
+          "Failed to create a unique file name for the tf.data service "
+          "cross-trainer cache spill log in ",
+          options_.directory);
+    }
+    file_prefix_ = std::move(prefix);
+  }
+  if (!segments_.empty()) {
+    // Seals the previous segment.
+    TF_RETURN_IF_ERROR(segments_.back()->writer->Close());
+    segments_.back()->writer.reset();
+  }
+
+  auto segment = std::make_shared<Segment>(
+      env_, absl::StrCat(file_prefix_, "_", next_segment_id_++), start_index);
+  TF_RETURN_IF_ERROR(env_->NewWritableFile(segment->filename,
+                                           &segment->writer));
+  TF_RETURN_IF_ERROR(
+      env_->NewRandomAccessFile(segment->filename, &segment->reader));
+  segments_.push_back(std::move(segment));
+  return OkStatus();
+}
+
+StatusOr<std::string> CrossTrainerCacheSpillLog::Read(size_t index) const {
+  std::shared_ptr<Segment> segment;
+  uint64_t begin, end;
+  {
+    // New offsets may be appended to the last segment concurrently, so the
+    // offsets are read under the lock.
+    tf_shared_lock l(mu_);
+    if (segments_.empty() || index < segments_.front()->start_index ||
+        index >= EndIndex()) {
+      return errors::NotFound("Element ", index,
+                              " is not in the tf.data service cross-trainer "
+                              "cache spill log.");
+    }
+    auto it = std::upper_bound(
+        segments_.begin(), segments_.end(), index,
+        [](size_t index, const std::shared_ptr<Segment>& segment) {
+          return index < segment->start_index;
+        });
+    segment = *(--it);
+    begin = segment->offsets[index - segment->start_index];
+    end = segment->offsets[index - segment->start_index + 1];
+  }
+  std::string element(end - begin, '\0');
+  StringPiece result;
+  TF_RETURN_IF_ERROR(
+      segment->reader->Read(begin, end - begin, &result, element.data()));
+  if (result.size() != end - begin) {
+    return errors::DataLoss("Failed to read element ", index, " from ",
+                            segment->filename, ": expected ", end - begin,
+                            " bytes, got ", result.size());
+  }
+  if (result.data() != element.data()) {
+    element.assign(result.data(), result.size());
+  }
+  return element;
+}
+
+bool CrossTrainerCacheSpillLog::Contains(size_t index) const {
+  tf_shared_lock l(mu_);
+  return !segments_.empty() && index >= segments_.front()->start_index &&
+         index < EndIndex();
+}
+
+size_t CrossTrainerCacheSpillLog::start_index() const {
+  tf_shared_lock l(mu_);
+  return segments_.empty() ? next_index_ : segments_.front()->start_index;
+}
+
+size_t CrossTrainerCacheSpillLog::size_bytes() const {
+  tf_shared_lock l(mu_);
+  return size_bytes_;
+}
+
+size_t CrossTrainerCacheSpillLog::EndIndex() const
+    TF_SHARED_LOCKS_REQUIRED(mu_) {
+  return segments_.empty() ? next_index_
+                           : segments_.back()->start_index +
+                                 segments_.back()->offsets.size() - 1;
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,122 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_SPILL_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_SPILL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Options for spilling elements evicted from a `CrossTrainerCache` to local
+// disk. Spilling is disabled if `directory` is empty.
+struct CrossTrainerCacheSpillOptions {
+  // Local directory to write the spilled elements to. It should be on a fast
+  // local disk, e.g. an SSD.
+  std::string directory;
+
+  // Maximum size of the spilled elements in bytes.
+  size_t max_size_bytes = 0;
+};
+
+// Append-only log of serialized cache elements on local disk. Elements are
+// identified by their absolute index in the cached sequence and must be
+// appended in order. The log is split into segment files; when it exceeds
+// `max_size_bytes`, the oldest segment is deleted. Each segment is the plain
+// concatenation of its elements, and their offsets are kept in memory.
+//
+// This class is thread-safe. The files are deleted when the log is destroyed.
+class CrossTrainerCacheSpillLog {
+ public:
+  CrossTrainerCacheSpillLog(Env* env,
+                            const CrossTrainerCacheSpillOptions& options);
+  CrossTrainerCacheSpillLog(const CrossTrainerCacheSpillLog&) = delete;
+  CrossTrainerCacheSpillLog& operator=(const CrossTrainerCacheSpillLog&) =
+      delete;
+
+  // Appends the serialized element with absolute index `index`. If `index`
+  // does not directly follow the last element in the log, the log is cleared
+  // first, so the log always holds a contiguous range of elements.
+  Status Append(size_t index, absl::string_view element);
+
+  // Reads the element with absolute index `index`. Returns NOT_FOUND if the
+  // element is not in the log.
+  StatusOr<std::string> Read(size_t index) const;
+
+  // Returns true if the element with absolute index `index` is in the log.
+  bool Contains(size_t index) const;
+
+  // Returns the absolute index of the oldest element in the log, or the index
+  // of the next element to append if the log is empty.
+  size_t start_index() const;
+
+  // Returns the total size of the logged elements in bytes.
+  size_t size_bytes() const;
+
+ private:
+  struct Segment {
+    Segment(Env* env, std::string filename, size_t start_index);
+    ~Segment();
+
+    Env* const env;
+    const std::string filename;
+    // Absolute index of the first element in this segment.
+    const size_t start_index;
+    // Offsets of the elements in the file, followed by the file size, so
+    // element `i` spans [offsets[i], offsets[i + 1]).
+    std::vector<uint64_t> offsets = {0};
+    std::unique_ptr<WritableFile> writer;
+    std::unique_ptr<RandomAccessFile> reader;
+  };
+
+  // Starts a new segment for elements starting at `start_index`.
+  Status AddSegment(size_t start_index) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns the index after the last element in the log.
+  size_t EndIndex() const TF_SHARED_LOCKS_REQUIRED(mu_);
+
+  Env* const env_;
+  const CrossTrainerCacheSpillOptions options_;
+  // Spilled elements are written to segments of this size.
+  const size_t max_segment_size_bytes_;
+
+  mutable mutex mu_;
+  // Unique prefix of the segment file names of this log.
+  std::string file_prefix_ TF_GUARDED_BY(mu_);
+  int64_t next_segment_id_ TF_GUARDED_BY(mu_) = 0;
+  // Segments ordered from oldest to newest. Readers hold a reference to the
+  // segment while reading, so a segment dropped during a read is deleted
+  // after the read finishes.
+  std::deque<std::shared_ptr<Segment>> segments_ TF_GUARDED_BY(mu_);
+  size_t next_index_ TF_GUARDED_BY(mu_) = 0;
+  size_t size_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_SPILL_H_
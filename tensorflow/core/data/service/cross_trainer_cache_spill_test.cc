@@ -0,0 +1,104 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/cross_trainer_cache_spill.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::IsOkAndHolds;
+using ::tensorflow::testing::StatusIs;
+using ::testing::IsEmpty;
+
+CrossTrainerCacheSpillOptions SpillOptions(size_t max_size_bytes) {
+  CrossTrainerCacheSpillOptions options;
+  EXPECT_TRUE(Env::Default()->LocalTempFilename(&options.directory));
+  options.max_size_bytes = max_size_bytes;
+  return options;
+}
+
+TEST(CrossTrainerCacheSpillLogTest, AppendAndRead) {
+  CrossTrainerCacheSpillLog log(Env::Default(), SpillOptions(1024));
+  TF_ASSERT_OK(log.Append(0, "Element 0"));
+  TF_ASSERT_OK(log.Append(1, ""));
+  TF_ASSERT_OK(log.Append(2, "Element 2"));
+  EXPECT_EQ(log.start_index(), 0);
+  EXPECT_EQ(log.size_bytes(), 18);
+  EXPECT_THAT(log.Read(0), IsOkAndHolds("Element 0"));
+  EXPECT_THAT(log.Read(1), IsOkAndHolds(IsEmpty()));
+  EXPECT_THAT(log.Read(2), IsOkAndHolds("Element 2"));
+  EXPECT_THAT(log.Read(3), StatusIs(error::NOT_FOUND));
+}
+
+TEST(CrossTrainerCacheSpillLogTest, DropsOldestSegments) {
+  // Segments hold up to a quarter of the log, i.e. 2 elements of 5 bytes.
+  CrossTrainerCacheSpillLog log(Env::Default(), SpillOptions(40));
+  for (int i = 0; i < 100; ++i) {
+    TF_ASSERT_OK(log.Append(i, "abcde"));
+  }
+  EXPECT_LE(log.size_bytes(), 40);
+  EXPECT_GT(log.start_index(), 90);
+  EXPECT_FALSE(log.Contains(0));
+  EXPECT_TRUE(log.Contains(99));
+  EXPECT_THAT(log.Read(0), StatusIs(error::NOT_FOUND));
+  EXPECT_THAT(log.Read(log.start_index()), IsOkAndHolds("abcde"));
+  EXPECT_THAT(log.Read(99), IsOkAndHolds("abcde"));
+}
+
+TEST(CrossTrainerCacheSpillLogTest, NonContiguousAppendClearsLog) {
+  CrossTrainerCacheSpillLog log(Env::Default(), SpillOptions(1024));
+  TF_ASSERT_OK(log.Append(0, "Element 0"));
+  TF_ASSERT_OK(log.Append(1, "Element 1"));
+  TF_ASSERT_OK(log.Append(5, "Element 5"));
+  EXPECT_EQ(log.start_index(), 5);
+  EXPECT_FALSE(log.Contains(1));
+  EXPECT_THAT(log.Read(5), IsOkAndHolds("Element 5"));
+}
+
+TEST(CrossTrainerCacheSpillLogTest, EmptyLog) {
+  CrossTrainerCacheSpillLog log(Env::Default(), SpillOptions(1024));
+  EXPECT_EQ(log.start_index(), 0);
+  EXPECT_EQ(log.size_bytes(), 0);
+  EXPECT_FALSE(log.Contains(0));
+  EXPECT_THAT(log.Read(0), StatusIs(error::NOT_FOUND));
+}
+
+TEST(CrossTrainerCacheSpillLogTest, DeletesFiles) {
+  CrossTrainerCacheSpillOptions options = SpillOptions(1024);
+  {
+    CrossTrainerCacheSpillLog log(Env::Default(), options);
+    TF_ASSERT_OK(log.Append(0, "Element 0"));
+    std::vector<std::string> files;
+    TF_ASSERT_OK(Env::Default()->GetChildren(options.directory, &files));
+    EXPECT_EQ(files.size(), 1);
+  }
+  std::vector<std::string> files;
+  TF_ASSERT_OK(Env::Default()->GetChildren(options.directory, &files));
+  EXPECT_THAT(files, IsEmpty());
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
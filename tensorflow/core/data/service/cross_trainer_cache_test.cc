@@ -22,7 +22,9 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
@@ -44,8 +46,10 @@ namespace {
 using ::tensorflow::monitoring::testing::CellReader;
 using ::tensorflow::testing::IsOkAndHolds;
 using ::tensorflow::testing::StatusIs;
+using ::testing::AllOf;
 using ::testing::Gt;
 using ::testing::HasSubstr;
+using ::testing::Lt;
 using ::testing::Pointee;
 using ::testing::UnorderedElementsAreArray;
 
@@ -61,6 +65,23 @@ class InfiniteRange : public CachableSequence<int64_t> {
   int64_t next_ = 0;
 };
 
+// `InfiniteRange` which supports spilling elements to disk.
+class SpillableInfiniteRange : public InfiniteRange {
+ public:
+  StatusOr<std::string> SerializeElement(
+      const int64_t& element) const override {
+    return absl::StrCat(element);
+  }
+  StatusOr<int64_t> DeserializeElement(
+      absl::string_view serialized) const override {
+    int64_t element = 0;
+    if (!absl::SimpleAtoi(serialized, &element)) {
+      return errors::DataLoss("Failed to parse element: ", serialized);
+    }
+    return element;
+  }
+};
+
 class TensorDataset : public CachableSequence<Tensor> {
  public:
   StatusOr<Tensor> GetNext() override { return Tensor("Test Tensor"); }
@@ -129,6 +150,13 @@ std::vector<int64_t> GetRange(const size_t range) {
   return result;
 }
 
+CrossTrainerCacheSpillOptions SpillOptions(size_t max_size_bytes) {
+  CrossTrainerCacheSpillOptions options;
+  EXPECT_TRUE(Env::Default()->LocalTempFilename(&options.directory));
+  options.max_size_bytes = max_size_bytes;
+  return options;
+}
+
 bool SequenceIsIncreasing(const std::vector<int64_t> sequence) {
   for (int i = 1; i < sequence.size(); ++i) {
     if (sequence[i - 1] > sequence[i - 1]) {
@@ -190,6 +218,58 @@ TEST(CrossTrainerCacheTest, SlowTrainersSkipData) {
   EXPECT_THAT(cache.Get("Slow trainer 2"), IsOkAndHolds(Pointee(Gt(94))));
 }
 
+TEST(CrossTrainerCacheTest, SlowTrainersReadSpilledData) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SpillableInfiniteRange>(),
+      SpillOptions(/*max_size_bytes=*/1024 * 1024));
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 1; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // The elements freed from memory are read back from disk.
+  for (int i = 1; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(100)));
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(100)));
+}
+
+TEST(CrossTrainerCacheTest, SlowTrainersSkipDataBeyondSpillSize) {
+  // Each element takes 1-2 bytes on disk, so the disk holds at most 40 of
+  // them.
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SpillableInfiniteRange>(),
+      SpillOptions(/*max_size_bytes=*/80));
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 1; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // The slow trainer skips the elements dropped from disk, then reads the
+  // remaining elements in order.
+  StatusOr<std::shared_ptr<const int64_t>> element = cache.Get("Slow trainer");
+  ASSERT_THAT(element, IsOkAndHolds(Pointee(AllOf(Gt(50), Lt(95)))));
+  for (int64_t i = **element + 1; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
+TEST(CrossTrainerCacheTest, SpillingRequiresSerialization) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      SpillOptions(/*max_size_bytes=*/1024 * 1024));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_THAT(cache.Get("Trainer ID"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_THAT(cache.Get("Trainer ID"), StatusIs(error::UNIMPLEMENTED));
+}
+
 TEST(CrossTrainerCacheTest, NewTrainersStartLate) {
   CrossTrainerCache<int64_t> cache(
       /*max_cache_size_bytes=*/5 * sizeof(int64_t),
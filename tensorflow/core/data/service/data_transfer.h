@@ -60,6 +60,10 @@ struct GetElementResult {
   // reading from the worker. This is used for load balancing when doing round
   // robin reads.
   bool skip = false;
+  // Further results returned by a request that sets
+  // `GetElementRequest.max_elements`, in the order they were produced. Only the
+  // last one may have `end_of_sequence` or `skip` set.
+  std::vector<GetElementResult> additional_results;
 };
 
 // Client for communicating with the tf.data service transfer server.
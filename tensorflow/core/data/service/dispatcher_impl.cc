@@ -243,11 +243,14 @@ Status DataServiceDispatcherImpl::Start() {
           *iteration, split_providers_[iteration->iteration_id]));
     }
   }
-  for (const auto& client_id : state_.ListActiveClientIds()) {
-    // Conservatively pretend we just received a heartbeat from all clients, so
-    // that we don't garbage collect iterations too early.
-    latest_client_heartbeats_time_[client_id] =
-        absl::FromUnixMicros(env_->NowMicros());
+  {
+    mutex_lock heartbeat_lock(heartbeat_mu_);
+    for (const auto& client_id : state_.ListActiveClientIds()) {
+      // Conservatively pretend we just received a heartbeat from all clients,
+      // so that we don't garbage collect iterations too early.
+      latest_client_heartbeats_time_[client_id] =
+          absl::FromUnixMicros(env_->NowMicros());
+    }
   }
   // Initialize the journal writer in `Start` so that we fail fast in case it
   // can't be initialized.
@@ -303,7 +306,7 @@ Status DataServiceDispatcherImpl::RestoreSplitProviders(
 Status DataServiceDispatcherImpl::FindTasksToDelete(
     const absl::flat_hash_set<int64_t>& current_tasks,
     const std::vector<std::shared_ptr<const Task>>& assigned_tasks,
-    WorkerHeartbeatResponse* response) {
+    WorkerHeartbeatResponse* response) const {
   absl::flat_hash_set<int64_t> assigned_ids;
   for (const auto& assigned : assigned_tasks) {
     assigned_ids.insert(assigned->task_id);
@@ -323,20 +326,38 @@ Status DataServiceDispatcherImpl::FindNewTasks(
     WorkerHeartbeatResponse* response) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   // Check for round-robin iterations that had tasks on the worker removed. Now
   // that the worker is back, we create a new pending task for the worker.
+  for (const auto& iteration : FindIterationsMissingTasks(assigned_tasks)) {
+    VLOG(1) << "Creating pending task for reconnected worker "
+            << worker_address;
+    TF_RETURN_IF_ERROR(CreatePendingTask(iteration, worker_address));
+  }
+  // Refresh assigned_tasks to include newly added pending tasks.
+  TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, assigned_tasks));
+  return AddNewTasks(current_tasks, assigned_tasks, response);
+}
+
+std::vector<std::shared_ptr<const Iteration>>
+DataServiceDispatcherImpl::FindIterationsMissingTasks(
+    const std::vector<std::shared_ptr<const Task>>& assigned_tasks) const
+    TF_SHARED_LOCKS_REQUIRED(mu_) {
   absl::flat_hash_set<int64_t> assigned_iteration_ids;
   for (const auto& task : assigned_tasks) {
     assigned_iteration_ids.insert(task->iteration->iteration_id);
   }
+  std::vector<std::shared_ptr<const Iteration>> iterations;
   for (const auto& iteration : state_.ListIterations()) {
     if (!assigned_iteration_ids.contains(iteration->iteration_id) &&
         iteration->IsRoundRobin() && !iteration->finished) {
-      VLOG(1) << "Creating pending task for reconnected worker "
-              << worker_address;
-      TF_RETURN_IF_ERROR(CreatePendingTask(iteration, worker_address));
+      iterations.push_back(iteration);
     }
   }
-  // Refresh assigned_tasks to include newly added pending tasks.
-  TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, assigned_tasks));
+  return iterations;
+}
+
+Status DataServiceDispatcherImpl::AddNewTasks(
+    const absl::flat_hash_set<int64_t>& current_tasks,
+    const std::vector<std::shared_ptr<const Task>>& assigned_tasks,
+    WorkerHeartbeatResponse* response) const TF_SHARED_LOCKS_REQUIRED(mu_) {
   for (const auto& task : assigned_tasks) {
     if (current_tasks.contains(task->task_id)) {
       continue;
@@ -347,15 +368,54 @@ Status DataServiceDispatcherImpl::FindNewTasks(
   return OkStatus();
 }
 
+StatusOr<bool> DataServiceDispatcherImpl::WorkerHeartbeatReadOnly(
+    const WorkerHeartbeatRequest& request,
+    WorkerHeartbeatResponse& response) const TF_SHARED_LOCKS_REQUIRED(mu_) {
+  // Snapshot managers update their streams on every worker heartbeat.
+  if (!snapshots_.empty()) {
+    return false;
+  }
+  std::vector<std::shared_ptr<const Task>> assigned_tasks;
+  if (!state_.TasksForWorker(request.worker_address(), assigned_tasks).ok()) {
+    // New workers are registered under the exclusive lock.
+    return false;
+  }
+  if (!FindIterationsMissingTasks(assigned_tasks).empty()) {
+    return false;
+  }
+  absl::flat_hash_set<int64_t> current_tasks;
+  current_tasks.insert(request.current_tasks().cbegin(),
+                       request.current_tasks().cend());
+  TF_RETURN_IF_ERROR(
+      FindTasksToDelete(current_tasks, assigned_tasks, &response));
+  TF_RETURN_IF_ERROR(AddNewTasks(current_tasks, assigned_tasks, &response));
+  return true;
+}
+
 Status DataServiceDispatcherImpl::WorkerHeartbeat(
     const WorkerHeartbeatRequest* request, WorkerHeartbeatResponse* response) {
   TF_RETURN_IF_ERROR(CheckStarted());
   VLOG(4) << "Received worker heartbeat request from worker "
           << request->worker_address();
-  mutex_lock l(mu_);
   const std::string& worker_address = request->worker_address();
-  latest_worker_heartbeats_time_[worker_address] =
-      absl::FromUnixMicros(env_->NowMicros());
+  {
+    mutex_lock heartbeat_lock(heartbeat_mu_);
+    latest_worker_heartbeats_time_[worker_address] =
+        absl::FromUnixMicros(env_->NowMicros());
+  }
+  {
+    // Most heartbeats only read the state, so they are first handled under a
+    // shared lock and run concurrently with each other.
+    tf_shared_lock l(mu_);
+    TF_ASSIGN_OR_RETURN(bool handled,
+                        WorkerHeartbeatReadOnly(*request, *response));
+    if (handled) {
+      VLOG(4) << "Finished read-only worker heartbeat for worker at address "
+              << worker_address;
+      return OkStatus();
+    }
+  }
+  mutex_lock l(mu_);
   // Assigned tasks from the perspective of the dispatcher.
   std::vector<std::shared_ptr<const Task>> assigned_tasks;
   Status s = state_.TasksForWorker(worker_address, assigned_tasks);
@@ -397,24 +457,26 @@ Status DataServiceDispatcherImpl::WorkerUpdate(
     const WorkerUpdateRequest* request, WorkerUpdateResponse* response) {
   TF_RETURN_IF_ERROR(CheckStarted());
   mutex_lock l(mu_);
+  // Journals all the completed tasks of the request with a single sync.
+  std::vector<Update> finish_updates;
+  absl::flat_hash_set<int64_t> finished_task_ids;
   for (auto& update : request->updates()) {
     int64_t task_id = update.task_id();
     std::shared_ptr<const Task> task;
     TF_RETURN_IF_ERROR(state_.TaskFromId(task_id, task));
     if (update.completed()) {
-      if (task->finished) {
+      if (task->finished || !finished_task_ids.insert(task_id).second) {
         VLOG(1) << "Received completion update for already-finished task "
                 << task->task_id << " on worker " << task->worker_address;
         continue;
       }
-      Update update;
-      update.mutable_finish_task()->set_task_id(task_id);
-      TF_RETURN_IF_ERROR(Apply(update));
+      Update& finish_update = finish_updates.emplace_back();
+      finish_update.mutable_finish_task()->set_task_id(task_id);
       VLOG(3) << "Task " << task_id << " from iteration "
               << task->iteration->iteration_id << " completed";
     }
   }
-  return OkStatus();
+  return ApplyBatch(finish_updates);
 }
 
 Status DataServiceDispatcherImpl::GetDatasetDef(
@@ -809,6 +871,7 @@ Status DataServiceDispatcherImpl::AcquireIterationClientId(
   acquire_iteration_client->set_iteration_id(iteration->iteration_id);
   TF_RETURN_IF_ERROR(Apply(update));
   // Does not release clients before they start to read from the dataset.
+  mutex_lock heartbeat_lock(heartbeat_mu_);
   latest_client_heartbeats_time_[iteration_client_id] = absl::InfiniteFuture();
   return OkStatus();
 }
@@ -941,11 +1004,22 @@ Status DataServiceDispatcherImpl::AssignTask(std::shared_ptr<const Task> task)
 Status DataServiceDispatcherImpl::ClientHeartbeat(
     const ClientHeartbeatRequest* request, ClientHeartbeatResponse* response) {
   TF_RETURN_IF_ERROR(CheckStarted());
-  mutex_lock l(mu_);
   VLOG(4) << "Received heartbeat from client id "
           << request->iteration_client_id();
-  latest_client_heartbeats_time_[request->iteration_client_id()] =
-      absl::FromUnixMicros(env_->NowMicros());
+  {
+    mutex_lock heartbeat_lock(heartbeat_mu_);
+    latest_client_heartbeats_time_[request->iteration_client_id()] =
+        absl::FromUnixMicros(env_->NowMicros());
+  }
+  {
+    tf_shared_lock l(mu_);
+    TF_ASSIGN_OR_RETURN(bool handled,
+                        ClientHeartbeatReadOnly(*request, *response));
+    if (handled) {
+      return OkStatus();
+    }
+  }
+  mutex_lock l(mu_);
   std::shared_ptr<const Iteration> iteration;
   Status s = state_.IterationForIterationClientId(
       request->iteration_client_id(), iteration);
@@ -1006,29 +1080,54 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
       TF_RETURN_IF_ERROR(Apply(update));
     }
   }
-  if (!iteration->pending_tasks.empty()) {
-    response->set_block_round(iteration->pending_tasks.front().target_round);
+  return PopulateClientHeartbeatResponse(*iteration, *response);
+}
+
+StatusOr<bool> DataServiceDispatcherImpl::ClientHeartbeatReadOnly(
+    const ClientHeartbeatRequest& request,
+    ClientHeartbeatResponse& response) const TF_SHARED_LOCKS_REQUIRED(mu_) {
+  // Round-robin clients update `round_robin_rounds_`.
+  if (request.optional_current_round_case() ==
+      ClientHeartbeatRequest::kCurrentRound) {
+    return false;
+  }
+  std::shared_ptr<const Iteration> iteration;
+  if (!state_.IterationForIterationClientId(request.iteration_client_id(),
+                                            iteration)
+           .ok() ||
+      iteration->garbage_collected || !iteration->pending_tasks.empty()) {
+    // Errors and pending tasks are handled under the exclusive lock.
+    return false;
+  }
+  TF_RETURN_IF_ERROR(PopulateClientHeartbeatResponse(*iteration, response));
+  return true;
+}
+
+Status DataServiceDispatcherImpl::PopulateClientHeartbeatResponse(
+    const Iteration& iteration, ClientHeartbeatResponse& response) const
+    TF_SHARED_LOCKS_REQUIRED(mu_) {
+  if (!iteration.pending_tasks.empty()) {
+    response.set_block_round(iteration.pending_tasks.front().target_round);
   }
 
   std::vector<std::shared_ptr<const Task>> tasks;
-  TF_RETURN_IF_ERROR(state_.TasksForIteration(iteration->iteration_id, tasks));
+  TF_RETURN_IF_ERROR(state_.TasksForIteration(iteration.iteration_id, tasks));
   for (const auto& task : tasks) {
-    TaskInfo* task_info = response->mutable_task_info()->Add();
+    TaskInfo* task_info = response.mutable_task_info()->Add();
     task_info->set_worker_address(task->worker_address);
     *task_info->mutable_transfer_servers() = {task->transfer_servers.begin(),
                                               task->transfer_servers.end()};
     *task_info->mutable_worker_tags() = {task->worker_tags.begin(),
                                          task->worker_tags.end()};
     task_info->set_task_id(task->task_id);
-    task_info->set_iteration_id(iteration->iteration_id);
+    task_info->set_iteration_id(iteration.iteration_id);
     task_info->set_worker_uid(task->worker_uid);
     task_info->set_starting_round(task->starting_round);
   }
-  response->set_iteration_finished(iteration->finished);
-  response->set_deployment_mode(config_.deployment_mode());
-  VLOG(4) << "Found " << response->task_info_size()
-          << " tasks for iteration client id "
-          << request->iteration_client_id();
+  response.set_iteration_finished(iteration.finished);
+  response.set_deployment_mode(config_.deployment_mode());
+  VLOG(4) << "Found " << response.task_info_size()
+          << " tasks for iteration " << iteration.iteration_id;
   return OkStatus();
 }
 
@@ -1103,7 +1202,7 @@ Status DataServiceDispatcherImpl::GetSnapshotSplit(
 
 Status DataServiceDispatcherImpl::PopulateTaskDef(
     std::shared_ptr<const Task> task, TaskDef* task_def) const
-    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    TF_SHARED_LOCKS_REQUIRED(mu_) {
   task_def->set_dataset_id(task->iteration->job->dataset_id);
   task_def->set_iteration_id(task->iteration->iteration_id);
   task_def->set_worker_address(task->worker_address);
@@ -1141,7 +1240,7 @@ Status DataServiceDispatcherImpl::PopulateTaskDef(
 }
 
 Status DataServiceDispatcherImpl::CheckStarted() TF_LOCKS_EXCLUDED(mu_) {
-  mutex_lock l(mu_);
+  tf_shared_lock l(mu_);
   if (!started_) {
     return errors::Unavailable("Dispatcher has not started yet.");
   }
@@ -1173,6 +1272,17 @@ Status DataServiceDispatcherImpl::Apply(const Update& update)
   return state_.Apply(update);
 }
 
+Status DataServiceDispatcherImpl::ApplyBatch(const std::vector<Update>& updates)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (journal_writer_.has_value()) {
+    TF_RETURN_IF_ERROR(journal_writer_.value()->WriteBatch(updates));
+  }
+  for (const Update& update : updates) {
+    TF_RETURN_IF_ERROR(state_.Apply(update));
+  }
+  return OkStatus();
+}
+
 void DataServiceDispatcherImpl::MaintenanceThread() {
   int64_t next_check_micros = 0;
   while (true) {
@@ -1211,25 +1321,27 @@ void DataServiceDispatcherImpl::MaintenanceThread() {
 Status DataServiceDispatcherImpl::ReleaseMissingClients()
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   int64_t now = env_->NowMicros();
+  std::vector<Update> updates;
+  mutex_lock heartbeat_lock(heartbeat_mu_);
   for (const auto& client_id : state_.ListActiveClientIds()) {
     if (absl::FromUnixMicros(now) >
         latest_client_heartbeats_time_[client_id] +
             absl::Milliseconds(config_.client_timeout_ms())) {
       LOG(INFO) << "Releasing timed-out client with id " << client_id;
-      Update update;
+      Update& update = updates.emplace_back();
       ReleaseIterationClientUpdate* release_client =
           update.mutable_release_iteration_client();
       release_client->set_iteration_client_id(client_id);
       release_client->set_time_micros(now);
-      TF_RETURN_IF_ERROR(Apply(update));
     }
   }
-  return OkStatus();
+  return ApplyBatch(updates);
 }
 
 void DataServiceDispatcherImpl::DetectMissingWorkers()
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   int64_t now = env_->NowMicros();
+  mutex_lock heartbeat_lock(heartbeat_mu_);
   for (auto it = latest_worker_heartbeats_time_.begin();
        it != latest_worker_heartbeats_time_.end();) {
     if (absl::FromUnixMicros(now) >
@@ -238,7 +238,7 @@ class DataServiceDispatcherImpl {
       const absl::flat_hash_set<int64_t>& current_tasks,
       const std::vector<std::shared_ptr<const DispatcherState::Task>>&
           assigned_tasks,
-      WorkerHeartbeatResponse* response);
+      WorkerHeartbeatResponse* response) const;
   // Finds new tasks that should be assigned to a worker and adds them to
   // the heartbeat response.
   Status FindNewTasks(
@@ -246,6 +246,36 @@ class DataServiceDispatcherImpl {
       const absl::flat_hash_set<int64_t>& current_tasks,
       std::vector<std::shared_ptr<const DispatcherState::Task>>& assigned_tasks,
       WorkerHeartbeatResponse* response);
+  // Returns the unfinished round-robin iterations which have no task in
+  // `assigned_tasks`, i.e. need a pending task for a reconnected worker.
+  std::vector<std::shared_ptr<const DispatcherState::Iteration>>
+  FindIterationsMissingTasks(
+      const std::vector<std::shared_ptr<const DispatcherState::Task>>&
+          assigned_tasks) const TF_SHARED_LOCKS_REQUIRED(mu_);
+  // Adds the tasks in `assigned_tasks` which are not in `current_tasks` to the
+  // heartbeat response.
+  Status AddNewTasks(
+      const absl::flat_hash_set<int64_t>& current_tasks,
+      const std::vector<std::shared_ptr<const DispatcherState::Task>>&
+          assigned_tasks,
+      WorkerHeartbeatResponse* response) const TF_SHARED_LOCKS_REQUIRED(mu_);
+  // Handles a worker heartbeat which does not need to update the dispatcher
+  // state, which is the common case for a registered worker. Returns false
+  // without modifying `response` if the heartbeat needs a state update and
+  // must be handled under the exclusive lock instead.
+  StatusOr<bool> WorkerHeartbeatReadOnly(
+      const WorkerHeartbeatRequest& request,
+      WorkerHeartbeatResponse& response) const TF_SHARED_LOCKS_REQUIRED(mu_);
+  // Handles a client heartbeat which does not need to update the dispatcher
+  // state. Returns false without modifying `response` otherwise.
+  StatusOr<bool> ClientHeartbeatReadOnly(
+      const ClientHeartbeatRequest& request,
+      ClientHeartbeatResponse& response) const TF_SHARED_LOCKS_REQUIRED(mu_);
+  // Fills out the task list and status of `iteration` in a client heartbeat
+  // response.
+  Status PopulateClientHeartbeatResponse(
+      const DispatcherState::Iteration& iteration,
+      ClientHeartbeatResponse& response) const TF_SHARED_LOCKS_REQUIRED(mu_);
   // Acquires an iteration client id to read from the given iteration and sets
   // `iteration_client_id`.
   Status AcquireIterationClientId(
@@ -293,7 +323,7 @@ class DataServiceDispatcherImpl {
   // Fills out a TaskDef with information about a task.
   Status PopulateTaskDef(std::shared_ptr<const DispatcherState::Task> task,
                          TaskDef* task_def) const
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+      TF_SHARED_LOCKS_REQUIRED(mu_);
   // Checks that the dispatcher has started, returning UNAVAILABLE if it hasn't.
   Status CheckStarted() TF_LOCKS_EXCLUDED(mu_);
   // Records that a split was produced by a call to `GetSplit`.
@@ -302,6 +332,10 @@ class DataServiceDispatcherImpl {
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Applies a state update, updating both the journal and the in-memory state.
   Status Apply(const Update& update) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Applies a sequence of independent state updates, syncing the journal once
+  // for the whole batch.
+  Status ApplyBatch(const std::vector<Update>& updates)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Applies a state update, but doesn't update the journal. Only meant to be
   // used when recovering state when the dispatcher starts.
   Status ApplyWithoutJournaling(const Update& update)
@@ -346,12 +380,15 @@ class DataServiceDispatcherImpl {
   // Map from task id to a TaskRemover which determines when to remove the task.
   absl::flat_hash_map<int64_t, std::shared_ptr<TaskRemover>>
       remove_task_requests_ TF_GUARDED_BY(mu_);
+  // Guards the heartbeat times, so that heartbeats can be recorded without
+  // holding `mu_` exclusively. If both are held, `mu_` is acquired first.
+  mutable mutex heartbeat_mu_ TF_ACQUIRED_AFTER(mu_);
   // Map from client id to the time of the client's last heartbeat.
   absl::flat_hash_map<int64_t, absl::Time> latest_client_heartbeats_time_
-      TF_GUARDED_BY(mu_);
+      TF_GUARDED_BY(heartbeat_mu_);
   // Map from worker address to the time of the worker's last heartbeat.
   absl::flat_hash_map<std::string, absl::Time> latest_worker_heartbeats_time_
-      TF_GUARDED_BY(mu_);
+      TF_GUARDED_BY(heartbeat_mu_);
 
   // Managers for all snapshot processes created or recovered during the
   // lifetime of this dispatcher instance.
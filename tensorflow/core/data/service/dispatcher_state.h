@@ -260,9 +260,10 @@ class DispatcherState {
   // Returns NOT_FOUND if the iteration_client_id is unknown or has been
   // released.
   Status IterationForIterationClientId(
-      int64_t iteration_client_id, std::shared_ptr<const Iteration>& iteration);
+      int64_t iteration_client_id,
+      std::shared_ptr<const Iteration>& iteration) const;
   // Returns a list of all active client ids.
-  std::vector<int64_t> ListActiveClientIds();
+  std::vector<int64_t> ListActiveClientIds() const;
   // Returns the next available iteration client id.
   int64_t NextAvailableIterationClientId() const;
 
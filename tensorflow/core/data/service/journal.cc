@@ -77,20 +77,40 @@ Status FileJournalWriter::EnsureInitialized() {
 
 Status FileJournalWriter::Write(const Update& update) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
+  TF_RETURN_IF_ERROR(WriteRecord(update));
+  return Sync();
+}
+
+Status FileJournalWriter::WriteBatch(const std::vector<Update>& updates) {
+  if (updates.empty()) {
+    return OkStatus();
+  }
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  for (const Update& update : updates) {
+    TF_RETURN_IF_ERROR(WriteRecord(update));
+  }
+  VLOG(4) << "Wrote a batch of " << updates.size() << " journal entries";
+  return Sync();
+}
+
+Status FileJournalWriter::WriteRecord(const Update& update) {
   std::string s = update.SerializeAsString();
   if (s.empty()) {
     return errors::Internal("Failed to serialize update ", update.DebugString(),
                             " to string");
   }
   TF_RETURN_IF_ERROR(writer_->WriteRecord(s));
-  TF_RETURN_IF_ERROR(writer_->Flush());
-  TF_RETURN_IF_ERROR(file_->Sync());
   if (VLOG_IS_ON(4)) {
     VLOG(4) << "Wrote journal entry: " << update.DebugString();
   }
   return OkStatus();
 }
 
+Status FileJournalWriter::Sync() {
+  TF_RETURN_IF_ERROR(writer_->Flush());
+  return file_->Sync();
+}
+
 FileJournalReader::FileJournalReader(Env* env, StringPiece journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -37,6 +38,8 @@ class JournalWriter {
   virtual ~JournalWriter() = default;
   // Writes and syncs an update to the journal.
   virtual Status Write(const Update& update) = 0;
+  // Writes `updates` to the journal in order, and syncs them once at the end.
+  virtual Status WriteBatch(const std::vector<Update>& updates) = 0;
   // Initializes the writer if it is not yet initialized.
   virtual Status EnsureInitialized() = 0;
 };
@@ -56,7 +59,8 @@ class JournalWriter {
 // journal file name. For example, if the journal directory contains
 // "journal_0", "journal_1", and "journal_2", the writer will write to
 // "journal_3". The writer will flush updates as they are written, so that they
-// can be stored durably in case of machine failure.
+// can be stored durably in case of machine failure. `WriteBatch` flushes once
+// per batch, so a batch of updates costs a single file sync.
 class FileJournalWriter : public JournalWriter {
  public:
   // Creates a journal writer to write to the given journal directory.
@@ -67,9 +71,15 @@ class FileJournalWriter : public JournalWriter {
   FileJournalWriter& operator=(const FileJournalWriter&) = delete;
 
   Status Write(const Update& update) override;
+  Status WriteBatch(const std::vector<Update>& updates) override;
   Status EnsureInitialized() override;
 
  private:
+  // Appends `update` to the journal file without syncing it.
+  Status WriteRecord(const Update& update);
+  // Flushes and syncs the records written so far.
+  Status Sync();
+
   Env* env_;
   const std::string journal_dir_;
   std::unique_ptr<WritableFile> file_;
@@ -100,6 +100,20 @@ TEST(Journal, RoundTripMultiple) {
   TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
 }
 
+TEST(Journal, RoundTripBatch) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  std::vector<Update> updates = {MakeCreateIterationUpdate(),
+                                 MakeRegisterDatasetUpdate(),
+                                 MakeFinishTaskUpdate()};
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_EXPECT_OK(writer.WriteBatch({updates[0], updates[1]}));
+  TF_EXPECT_OK(writer.WriteBatch({}));
+  TF_EXPECT_OK(writer.Write(updates[2]));
+
+  TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
+}
+
 TEST(Journal, AppendExistingJournal) {
   std::string journal_dir;
   EXPECT_TRUE(NewJournalDir(journal_dir));
@@ -0,0 +1,638 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_transfer.h"
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/shm_transfer.pb.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/random.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Alignment of the components written to the ring.
+constexpr size_t kAlignment = Allocator::kAllocatorAlignment;
+constexpr uint32 kMaxMessageSize = std::numeric_limits<int32>::max();
+constexpr int kMaxPort = 1 << 30;
+constexpr int kMaxBindAttempts = 100;
+
+size_t AlignUp(size_t n) {
+  return (n + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// Returns the address of the abstract Unix socket of the server with `port`.
+socklen_t SocketAddress(int port, sockaddr_un* addr) {
+  const std::string name = absl::StrCat("tf_data_shm_transfer_", port);
+  std::memset(addr, 0, sizeof(*addr));
+  addr->sun_family = AF_UNIX;
+  // A leading NUL byte places the name in the abstract namespace, so that it
+  // does not outlive the socket.
+  std::memcpy(addr->sun_path + 1, name.data(), name.size());
+  return offsetof(sockaddr_un, sun_path) + 1 + name.size();
+}
+
+Status WriteFully(int fd, const char* data, size_t n) {
+  while (n > 0) {
+    const ssize_t written = send(fd, data, n, MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return errors::Unavailable(
+          errors::IOError("Failed to write to shm transfer socket", errno)
+              .error_message());
+    }
+    data += written;
+    n -= written;
+  }
+  return OkStatus();
+}
+
+Status ReadFully(int fd, char* data, size_t n) {
+  while (n > 0) {
+    const ssize_t read = recv(fd, data, n, 0);
+    if (read < 0) {
+      if (errno == EINTR) continue;
+      return errors::Unavailable(
+          errors::IOError("Failed to read from shm transfer socket", errno)
+              .error_message());
+    }
+    if (read == 0) {
+      return errors::Unavailable("The shm transfer socket was closed.");
+    }
+    data += read;
+    n -= read;
+  }
+  return OkStatus();
+}
+
+// Sends `message` prefixed by its length.
+Status SendMessage(int fd, const protobuf::Message& message) {
+  const size_t size = message.ByteSizeLong();
+  if (size > kMaxMessageSize) {
+    return errors::InvalidArgument("Shm transfer message of ", size,
+                                   " bytes exceeds the limit of ",
+                                   kMaxMessageSize, " bytes.");
+  }
+  std::string buffer(sizeof(uint32), '\0');
+  core::EncodeFixed32(&buffer[0], size);
+  if (!message.AppendToString(&buffer)) {
+    return errors::Internal("Failed to serialize shm transfer message.");
+  }
+  return WriteFully(fd, buffer.data(), buffer.size());
+}
+
+Status ReceiveMessage(int fd, protobuf::Message* message) {
+  char header[sizeof(uint32)];
+  TF_RETURN_IF_ERROR(ReadFully(fd, header, sizeof(header)));
+  const uint32 size = core::DecodeFixed32(header);
+  if (size > kMaxMessageSize) {
+    return errors::DataLoss("Invalid shm transfer message size ", size, ".");
+  }
+  std::string buffer(size, '\0');
+  TF_RETURN_IF_ERROR(ReadFully(fd, &buffer[0], size));
+  if (!message->ParseFromString(buffer)) {
+    return errors::DataLoss("Failed to parse shm transfer message.");
+  }
+  return OkStatus();
+}
+
+// Returns true if `tensor` is sent through the ring.
+bool UsesRing(const Tensor& tensor) {
+  return DataTypeCanUseMemcpy(tensor.dtype()) && tensor.TotalBytes() > 0;
+}
+
+}  // namespace
+
+class ShmDataTransferServer::Connection {
+ public:
+  Connection(int fd, std::string segment_name, const GetElementT& get_element,
+             size_t ring_size)
+      : fd_(fd),
+        segment_name_(std::move(segment_name)),
+        get_element_(get_element),
+        ring_size_(ring_size) {}
+
+  ~Connection() {
+    Cancel();
+    thread_.reset();
+    if (ring_ != nullptr) munmap(ring_, ring_size_);
+    if (segment_created_ && !segment_unlinked_) {
+      shm_unlink(segment_name_.c_str());
+    }
+    close(fd_);
+  }
+
+  // Creates the ring and starts serving the connection.
+  Status Start() {
+    const int shm_fd =
+        shm_open(segment_name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (shm_fd < 0) {
+      return errors::IOError(
+          absl::StrCat("Failed to create shared memory segment ",
+                       segment_name_),
+          errno);
+    }
+    segment_created_ = true;
+    if (ftruncate(shm_fd, ring_size_) != 0) {
+      const int error = errno;
+      close(shm_fd);
+      return errors::IOError(
+          absl::StrCat("Failed to resize shared memory segment ",
+                       segment_name_),
+          error);
+    }
+    void* ring = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      shm_fd, 0);
+    const int error = errno;
+    close(shm_fd);
+    if (ring == MAP_FAILED) {
+      return errors::IOError(
+          absl::StrCat("Failed to map shared memory segment ", segment_name_),
+          error);
+    }
+    ring_ = static_cast<char*>(ring);
+    thread_ = absl::WrapUnique(Env::Default()->StartThread(
+        {}, "tf_data_shm_transfer_connection", [this]() { Serve(); }));
+    return OkStatus();
+  }
+
+  // Unblocks the connection's pending socket operations. Requests that are
+  // waiting for an element still return once the element is produced.
+  void Cancel() { shutdown(fd_, SHUT_RDWR); }
+
+  bool done() const { return done_; }
+
+ private:
+  void Serve() {
+    ShmTransferHandshake handshake;
+    handshake.set_segment_name(segment_name_);
+    handshake.set_ring_size(ring_size_);
+    Status s = SendMessage(fd_, handshake);
+    while (s.ok()) {
+      ShmGetElementRequest request;
+      s = ReceiveMessage(fd_, &request);
+      if (!s.ok()) break;
+      if (!segment_unlinked_) {
+        // The client maps the segment before sending its first request.
+        shm_unlink(segment_name_.c_str());
+        segment_unlinked_ = true;
+      }
+      released_ =
+          std::max(released_, std::min(request.released_offset(), head_));
+      ShmGetElementResponse response;
+      HandleRequest(request.request(), &response);
+      s = SendMessage(fd_, response);
+    }
+    VLOG(2) << "Shm transfer connection " << segment_name_
+            << " finished: " << s;
+    done_ = true;
+  }
+
+  void HandleRequest(const GetElementRequest& request,
+                     ShmGetElementResponse* response) {
+    GetElementResult result;
+    Status s = get_element_(&request, &result);
+    if (!s.ok()) {
+      response->set_code(static_cast<int32>(s.code()));
+      response->set_error_message(std::string(s.error_message()));
+      return;
+    }
+    response->set_element_index(result.element_index);
+    response->set_end_of_sequence(result.end_of_sequence);
+    response->set_skip(result.skip);
+
+    size_t ring_bytes = 0;
+    for (const Tensor& component : result.components) {
+      if (UsesRing(component)) ring_bytes += AlignUp(component.TotalBytes());
+    }
+    uint64 offset = 0;
+    const bool use_ring = ring_bytes > 0 && Allocate(ring_bytes, &offset);
+    for (const Tensor& component : result.components) {
+      ShmElementComponent* out = response->add_components();
+      if (use_ring && UsesRing(component)) {
+        out->set_dtype(component.dtype());
+        component.shape().AsProto(out->mutable_tensor_shape());
+        out->set_ring_offset(offset);
+        const StringPiece data = component.tensor_data();
+        std::memcpy(ring_ + offset % ring_size_, data.data(), data.size());
+        offset += AlignUp(data.size());
+      } else if (DataTypeCanUseMemcpy(component.dtype())) {
+        component.AsProtoTensorContent(out->mutable_inline_tensor());
+      } else {
+        component.AsProtoField(out->mutable_inline_tensor());
+      }
+    }
+    if (use_ring) response->set_ring_end(offset);
+  }
+
+  // Reserves `size` contiguous ring bytes and returns their logical offset in
+  // `*offset`. Returns false if the client still references too much of the
+  // ring.
+  bool Allocate(size_t size, uint64* offset) {
+    uint64 start = head_;
+    const uint64 position = start % ring_size_;
+    if (position + size > ring_size_) start += ring_size_ - position;
+    if (start + size - released_ > ring_size_) return false;
+    head_ = start + size;
+    *offset = start;
+    return true;
+  }
+
+  const int fd_;
+  const std::string segment_name_;
+  const GetElementT& get_element_;
+  const size_t ring_size_;
+  char* ring_ = nullptr;
+  bool segment_created_ = false;
+
+  // Only accessed by the serving thread while it runs.
+  bool segment_unlinked_ = false;
+  // Logical offset following the data written so far.
+  uint64 head_ = 0;
+  // Logical offset up to which the client no longer references the ring.
+  uint64 released_ = 0;
+
+  std::atomic<bool> done_{false};
+  std::unique_ptr<Thread> thread_;
+};
+
+ShmDataTransferServer::ShmDataTransferServer(GetElementT get_element,
+                                             size_t ring_size)
+    : get_element_(std::move(get_element)),
+      ring_size_(std::max(AlignUp(ring_size), kAlignment)) {}
+
+ShmDataTransferServer::~ShmDataTransferServer() {
+  cancelled_ = true;
+  if (listen_fd_ >= 0) shutdown(listen_fd_, SHUT_RDWR);
+  accept_thread_.reset();
+  std::vector<std::unique_ptr<Connection>> connections;
+  {
+    mutex_lock l(mu_);
+    connections.swap(connections_);
+  }
+  for (auto& connection : connections) connection->Cancel();
+  connections.clear();
+  if (listen_fd_ >= 0) close(listen_fd_);
+}
+
+Status ShmDataTransferServer::Start() {
+  listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listen_fd_ < 0) {
+    return errors::IOError("Failed to create shm transfer socket", errno);
+  }
+  for (int attempt = 0; attempt < kMaxBindAttempts && port_ < 0; ++attempt) {
+    const int port = 1 + random::New64() % (kMaxPort - 1);
+    sockaddr_un addr;
+    const socklen_t addr_len = SocketAddress(port, &addr);
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), addr_len) == 0) {
+      port_ = port;
+    } else if (errno != EADDRINUSE) {
+      return errors::IOError("Failed to bind shm transfer socket", errno);
+    }
+  }
+  if (port_ < 0) {
+    return errors::Unavailable("Failed to find an unused shm transfer port.");
+  }
+  if (listen(listen_fd_, SOMAXCONN) != 0) {
+    return errors::IOError("Failed to listen on shm transfer socket", errno);
+  }
+  accept_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+      {}, "tf_data_shm_transfer_server", [this]() { AcceptLoop(); }));
+  VLOG(1) << "Started shm transfer server on port " << port_;
+  return OkStatus();
+}
+
+int ShmDataTransferServer::get_port() { return port_; }
+
+StatusOr<std::string> ShmDataTransferServer::GetCompatibilityInfo() const {
+  return port::Hostname();
+}
+
+void ShmDataTransferServer::AcceptLoop() {
+  while (!cancelled_) {
+    const int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (cancelled_) break;
+      if (errno != EINTR) {
+        LOG(WARNING) << errors::IOError(
+            "Failed to accept shm transfer connection", errno);
+        Env::Default()->SleepForMicroseconds(10 * 1000);
+      }
+      continue;
+    }
+    mutex_lock l(mu_);
+    connections_.erase(
+        std::remove_if(connections_.begin(), connections_.end(),
+                       [](const std::unique_ptr<Connection>& connection) {
+                         return connection->done();
+                       }),
+        connections_.end());
+    auto connection = std::make_unique<Connection>(
+        fd,
+        absl::StrCat("/tf_data_shm_transfer_", getpid(), "_", port_, "_",
+                     next_connection_id_++),
+        get_element_, ring_size_);
+    Status s = connection->Start();
+    if (!s.ok()) {
+      // Destroying the connection closes the client's socket.
+      LOG(WARNING) << "Failed to start shm transfer connection: " << s;
+      continue;
+    }
+    connections_.push_back(std::move(connection));
+  }
+}
+
+// The client's mapping of its connection's ring. Tensors that alias the ring
+// share ownership of the mapping.
+class ShmDataTransferClient::Ring
+    : public std::enable_shared_from_this<ShmDataTransferClient::Ring> {
+ public:
+  // Keeps the ring up to `end` reserved until destroyed.
+  class Reservation {
+   public:
+    Reservation(std::shared_ptr<Ring> ring, uint64 end)
+        : ring_(std::move(ring)), end_(end) {}
+    ~Reservation() { ring_->Release(end_); }
+
+    Ring* ring() const { return ring_.get(); }
+
+   private:
+    const std::shared_ptr<Ring> ring_;
+    const uint64 end_;
+  };
+
+  // A component that aliases the ring.
+  class Buffer : public TensorBuffer {
+   public:
+    Buffer(char* data, size_t size, std::shared_ptr<Reservation> reservation)
+        : TensorBuffer(data),
+          size_(size),
+          reservation_(std::move(reservation)) {}
+
+    size_t size() const override { return size_; }
+    TensorBuffer* root_buffer() override { return this; }
+    void FillAllocationDescription(
+        AllocationDescription* proto) const override {
+      proto->set_requested_bytes(size_);
+      proto->set_allocator_name("shm_transfer");
+    }
+    bool OwnsMemory() const override { return false; }
+
+   private:
+    const size_t size_;
+    const std::shared_ptr<Reservation> reservation_;
+  };
+
+  Ring(char* data, size_t size) : data_(data), size_(size) {}
+  ~Ring() { munmap(data_, size_); }
+
+  // Returns a reservation of the ring up to `end`, which must be larger than
+  // the end of all previous reservations.
+  std::shared_ptr<Reservation> Reserve(uint64 end) {
+    mutex_lock l(mu_);
+    reserved_.push_back({end, false});
+    return std::make_shared<Reservation>(shared_from_this(), end);
+  }
+
+  // Returns the `size` bytes at logical offset `offset`.
+  StatusOr<char*> Data(uint64 offset, size_t size) const {
+    const uint64 position = offset % size_;
+    if (position + size > size_) {
+      return errors::DataLoss("Invalid shm transfer ring range [", offset,
+                              ", ", offset + size, ") for a ring of ", size_,
+                              " bytes.");
+    }
+    return data_ + position;
+  }
+
+  uint64 released_offset() {
+    mutex_lock l(mu_);
+    return released_offset_;
+  }
+
+ private:
+  void Release(uint64 end) {
+    mutex_lock l(mu_);
+    for (auto& reserved : reserved_) {
+      if (reserved.first == end) {
+        reserved.second = true;
+        break;
+      }
+    }
+    while (!reserved_.empty() && reserved_.front().second) {
+      released_offset_ = reserved_.front().first;
+      reserved_.pop_front();
+    }
+  }
+
+  char* const data_;
+  const size_t size_;
+
+  mutex mu_;
+  // End offsets of the reservations in order, and whether they were released.
+  std::deque<std::pair<uint64, bool>> reserved_ TF_GUARDED_BY(mu_);
+  uint64 released_offset_ TF_GUARDED_BY(mu_) = 0;
+};
+
+Status ShmDataTransferClient::Create(const std::string& address,
+                                     std::unique_ptr<DataTransferClient>* out) {
+  const size_t colon = address.rfind(':');
+  int port;
+  if (colon == std::string::npos ||
+      !absl::SimpleAtoi(address.substr(colon + 1), &port)) {
+    return errors::InvalidArgument("Invalid shm transfer address ", address,
+                                   "; expected <host>:<port>.");
+  }
+  const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return errors::IOError("Failed to create shm transfer socket", errno);
+  }
+  sockaddr_un addr;
+  const socklen_t addr_len = SocketAddress(port, &addr);
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), addr_len) != 0) {
+    const int error = errno;
+    close(fd);
+    return errors::Unavailable(
+        errors::IOError(
+            absl::StrCat("Failed to connect to shm transfer server ", address),
+            error)
+            .error_message());
+  }
+  ShmTransferHandshake handshake;
+  Status s = ReceiveMessage(fd, &handshake);
+  if (!s.ok()) {
+    close(fd);
+    return s;
+  }
+  const int shm_fd = shm_open(handshake.segment_name().c_str(), O_RDWR, 0);
+  if (shm_fd < 0) {
+    const int error = errno;
+    close(fd);
+    return errors::IOError(absl::StrCat("Failed to open shared memory segment ",
+                                        handshake.segment_name()),
+                           error);
+  }
+  // The mapping is writable so that consumers can forward the components'
+  // buffers to kernels that update them in place.
+  void* data = mmap(nullptr, handshake.ring_size(), PROT_READ | PROT_WRITE,
+                    MAP_SHARED, shm_fd, 0);
+  const int error = errno;
+  close(shm_fd);
+  if (data == MAP_FAILED) {
+    close(fd);
+    return errors::IOError(absl::StrCat("Failed to map shared memory segment ",
+                                        handshake.segment_name()),
+                           error);
+  }
+  *out = absl::WrapUnique(new ShmDataTransferClient(
+      fd, std::make_shared<Ring>(static_cast<char*>(data),
+                                 handshake.ring_size())));
+  return OkStatus();
+}
+
+ShmDataTransferClient::ShmDataTransferClient(int fd, std::shared_ptr<Ring> ring)
+    : fd_(fd), ring_(std::move(ring)) {}
+
+ShmDataTransferClient::~ShmDataTransferClient() { close(fd_); }
+
+Status ShmDataTransferClient::GetElement(const GetElementRequest& req,
+                                         GetElementResult& result) {
+  mutex_lock l(mu_);
+  if (cancelled_) {
+    return errors::Cancelled("The shm transfer client has been cancelled.");
+  }
+  ShmGetElementRequest request;
+  *request.mutable_request() = req;
+  request.set_released_offset(ring_->released_offset());
+  ShmGetElementResponse response;
+  Status s = SendMessage(fd_, request);
+  if (s.ok()) s = ReceiveMessage(fd_, &response);
+  if (!s.ok()) {
+    if (cancelled_) {
+      return errors::Cancelled("The shm transfer client has been cancelled.");
+    }
+    return s;
+  }
+  if (response.code() != static_cast<int32>(absl::StatusCode::kOk)) {
+    return Status(static_cast<absl::StatusCode>(response.code()),
+                  response.error_message());
+  }
+
+  std::shared_ptr<Ring::Reservation> reservation;
+  if (response.ring_end() > 0) {
+    reservation = ring_->Reserve(response.ring_end());
+  }
+  std::vector<Tensor> components;
+  components.reserve(response.components_size());
+  for (const ShmElementComponent& component : response.components()) {
+    if (component.has_inline_tensor()) {
+      Tensor tensor;
+      if (!tensor.FromProto(component.inline_tensor())) {
+        return errors::DataLoss("Failed to parse shm transfer component.");
+      }
+      components.push_back(std::move(tensor));
+      continue;
+    }
+    if (reservation == nullptr || !DataTypeCanUseMemcpy(component.dtype())) {
+      return errors::DataLoss("Invalid shm transfer ring component.");
+    }
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(
+        TensorShape::BuildTensorShape(component.tensor_shape(), &shape));
+    const size_t size = shape.num_elements() * DataTypeSize(component.dtype());
+    TF_ASSIGN_OR_RETURN(char* data,
+                        ring_->Data(component.ring_offset(), size));
+    auto* buffer = new Ring::Buffer(data, size, reservation);
+    components.push_back(Tensor(component.dtype(), shape, buffer));
+    buffer->Unref();
+  }
+  result.components = std::move(components);
+  result.element_index = response.element_index();
+  result.end_of_sequence = response.end_of_sequence();
+  result.skip = response.skip();
+  return OkStatus();
+}
+
+void ShmDataTransferClient::TryCancel() {
+  cancelled_ = true;
+  shutdown(fd_, SHUT_RDWR);
+}
+
+Status ShmDataTransferClient::CheckCompatibility(
+    const std::string& compatibility_info) const {
+  const std::string hostname = port::Hostname();
+  if (compatibility_info != hostname) {
+    return errors::FailedPrecondition(
+        "The shm data transfer protocol requires the tf.data service worker "
+        "to run on the same host as its client, but the worker runs on ",
+        compatibility_info, " and the client on ", hostname, ".");
+  }
+  return OkStatus();
+}
+
+class ShmTransferRegistrar {
+ public:
+  ShmTransferRegistrar() {
+    DataTransferServer::Register(
+        kShmTransferProtocol,
+        [](DataTransferServer::GetElementT get_element,
+           std::shared_ptr<DataTransferServer>* out) {
+          *out = std::make_shared<ShmDataTransferServer>(get_element);
+          return OkStatus();
+        });
+    DataTransferClient::Register(
+        kShmTransferProtocol, [](DataTransferClient::Config config,
+                                 std::unique_ptr<DataTransferClient>* out) {
+          return ShmDataTransferClient::Create(config.address, out);
+        });
+  }
+};
+static ShmTransferRegistrar shm_transfer_registrar;
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // defined(__linux__)
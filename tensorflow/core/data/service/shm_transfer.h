@@ -0,0 +1,114 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHM_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHM_TRANSFER_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Transfer protocol for consumers that run on the same host as the tf.data
+// service worker, e.g. the trainer processes of a multi-process job sharing
+// one host-local worker.
+//
+// Each client connection gets its own POSIX shared memory ring buffer. The
+// server copies the components of every element into the ring and sends
+// their offsets over a Unix domain socket; the client wraps the ring memory in
+// tensors without copying or deserializing it. Ring space is reclaimed once
+// the client has dropped all tensors of an element. Components that cannot be
+// memcpy'd (e.g. strings), and elements that do not fit in the free space of
+// the ring, are sent inline over the socket as `TensorProto`s.
+//
+// The server listens on an abstract Unix socket named after its "port", so
+// clients must share the server's network namespace. Only Linux is supported.
+constexpr const char kShmTransferProtocol[] = "shm";
+
+class ShmDataTransferServer : public DataTransferServer {
+ public:
+  // Size of the ring buffer of each connection.
+  static constexpr size_t kDefaultRingSize = 64 << 20;
+
+  explicit ShmDataTransferServer(GetElementT get_element,
+                                 size_t ring_size = kDefaultRingSize);
+  ~ShmDataTransferServer() override;
+
+  Status Start() override;
+  int get_port() override;
+  // Returns the hostname of the server, which must match the client's.
+  StatusOr<std::string> GetCompatibilityInfo() const override;
+
+ private:
+  class Connection;
+
+  void AcceptLoop();
+
+  const GetElementT get_element_;
+  const size_t ring_size_;
+  int port_ = -1;
+  int listen_fd_ = -1;
+  std::atomic<bool> cancelled_{false};
+  std::unique_ptr<Thread> accept_thread_;
+
+  mutex mu_;
+  int64_t next_connection_id_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<std::unique_ptr<Connection>> connections_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShmDataTransferServer);
+};
+
+class ShmDataTransferClient : public DataTransferClient {
+ public:
+  // Connects to the server whose `get_port()` follows the last ':' in
+  // `address`, and maps the connection's ring buffer.
+  static Status Create(const std::string& address,
+                       std::unique_ptr<DataTransferClient>* out);
+  ~ShmDataTransferClient() override;
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override;
+  void TryCancel() override;
+  Status CheckCompatibility(
+      const std::string& compatibility_info) const override;
+
+ private:
+  class Ring;
+
+  ShmDataTransferClient(int fd, std::shared_ptr<Ring> ring);
+
+  const int fd_;
+  // Shared with the tensors that alias the ring.
+  const std::shared_ptr<Ring> ring_;
+  std::atomic<bool> cancelled_{false};
+  // Serializes requests on the connection.
+  mutex mu_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShmDataTransferClient);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHM_TRANSFER_H_
@@ -0,0 +1,206 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_transfer.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+using ::testing::HasSubstr;
+
+constexpr int64_t kNumValues = 256;
+
+// Produces elements with a float vector filled with the element index and a
+// string scalar, until `num_elements` elements have been produced.
+DataTransferServer::GetElementT MakeGetElement(int64_t num_elements) {
+  auto next_index = std::make_shared<int64_t>(0);
+  return [next_index, num_elements](const GetElementRequest* request,
+                                    GetElementResult* result) {
+    if (*next_index == num_elements) {
+      result->end_of_sequence = true;
+      return OkStatus();
+    }
+    const int64_t index = (*next_index)++;
+    Tensor values(DT_FLOAT, TensorShape({kNumValues}));
+    values.flat<float>().setConstant(index);
+    result->components.push_back(std::move(values));
+    result->components.push_back(
+        Tensor(tstring(absl::StrCat("element ", index))));
+    result->element_index = index;
+    return OkStatus();
+  };
+}
+
+StatusOr<std::unique_ptr<DataTransferClient>> Connect(
+    const std::shared_ptr<DataTransferServer>& server) {
+  std::unique_ptr<DataTransferClient> client;
+  TF_RETURN_IF_ERROR(DataTransferClient::Build(
+      kShmTransferProtocol,
+      {"grpc", absl::StrCat("localhost:", server->get_port())}, &client));
+  return client;
+}
+
+void ExpectElement(const GetElementResult& result, int64_t index) {
+  EXPECT_FALSE(result.end_of_sequence);
+  EXPECT_EQ(result.element_index, index);
+  ASSERT_EQ(result.components.size(), 2);
+  Tensor expected(DT_FLOAT, TensorShape({kNumValues}));
+  expected.flat<float>().setConstant(index);
+  test::ExpectEqual(result.components[0], expected);
+  test::ExpectEqual(result.components[1],
+                    Tensor(tstring(absl::StrCat("element ", index))));
+}
+
+TEST(ShmTransferTest, GetElements) {
+  std::shared_ptr<DataTransferServer> server;
+  TF_ASSERT_OK(DataTransferServer::Build(kShmTransferProtocol,
+                                         MakeGetElement(/*num_elements=*/10),
+                                         &server));
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          Connect(server));
+  for (int64_t i = 0; i < 10; ++i) {
+    GetElementResult result;
+    TF_ASSERT_OK(client->GetElement(GetElementRequest(), result));
+    ExpectElement(result, i);
+  }
+  GetElementResult result;
+  TF_ASSERT_OK(client->GetElement(GetElementRequest(), result));
+  EXPECT_TRUE(result.end_of_sequence);
+  EXPECT_TRUE(result.components.empty());
+}
+
+TEST(ShmTransferTest, RingComponentsAliasTheRing) {
+  auto server = std::make_shared<ShmDataTransferServer>(
+      MakeGetElement(/*num_elements=*/1));
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          Connect(server));
+  GetElementResult result;
+  TF_ASSERT_OK(client->GetElement(GetElementRequest(), result));
+  ASSERT_EQ(result.components.size(), 2);
+  TensorDescription description;
+  result.components[0].FillDescription(&description);
+  EXPECT_EQ(description.allocation_description().allocator_name(),
+            "shm_transfer");
+  // Strings are sent inline.
+  result.components[1].FillDescription(&description);
+  EXPECT_NE(description.allocation_description().allocator_name(),
+            "shm_transfer");
+  // The components stay valid after the client and server are gone.
+  client.reset();
+  server.reset();
+  ExpectElement(result, 0);
+}
+
+TEST(ShmTransferTest, ElementsOutliveRingCapacity) {
+  // The ring holds fewer than four elements, so elements that are still
+  // referenced force the server to send later elements inline.
+  auto server = std::make_shared<ShmDataTransferServer>(
+      MakeGetElement(/*num_elements=*/20),
+      /*ring_size=*/3 * kNumValues * sizeof(float) + 64);
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          Connect(server));
+  std::vector<GetElementResult> held;
+  for (int64_t i = 0; i < 10; ++i) {
+    GetElementResult result;
+    TF_ASSERT_OK(client->GetElement(GetElementRequest(), result));
+    held.push_back(std::move(result));
+  }
+  for (int64_t i = 0; i < 10; ++i) ExpectElement(held[i], i);
+  // Releasing the elements makes the ring usable again.
+  held.clear();
+  for (int64_t i = 10; i < 20; ++i) {
+    GetElementResult result;
+    TF_ASSERT_OK(client->GetElement(GetElementRequest(), result));
+    ExpectElement(result, i);
+  }
+}
+
+TEST(ShmTransferTest, PropagatesErrors) {
+  auto server = std::make_shared<ShmDataTransferServer>(
+      [](const GetElementRequest* request, GetElementResult* result) {
+        return errors::NotFound("task ", request->task_id(), " not found");
+      });
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          Connect(server));
+  GetElementRequest request;
+  request.set_task_id(7);
+  GetElementResult result;
+  EXPECT_THAT(client->GetElement(request, result),
+              StatusIs(error::NOT_FOUND, HasSubstr("task 7 not found")));
+  // The connection remains usable.
+  EXPECT_THAT(client->GetElement(request, result),
+              StatusIs(error::NOT_FOUND));
+}
+
+TEST(ShmTransferTest, Cancel) {
+  auto server = std::make_shared<ShmDataTransferServer>(
+      MakeGetElement(/*num_elements=*/10));
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          Connect(server));
+  client->TryCancel();
+  GetElementResult result;
+  EXPECT_THAT(client->GetElement(GetElementRequest(), result),
+              StatusIs(error::CANCELLED));
+}
+
+TEST(ShmTransferTest, InvalidAddress) {
+  std::unique_ptr<DataTransferClient> client;
+  EXPECT_THAT(DataTransferClient::Build(kShmTransferProtocol,
+                                        {"grpc", "localhost"}, &client),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST(ShmTransferTest, CheckCompatibility) {
+  auto server = std::make_shared<ShmDataTransferServer>(
+      MakeGetElement(/*num_elements=*/1));
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::string compatibility_info,
+                          server->GetCompatibilityInfo());
+  EXPECT_EQ(compatibility_info, port::Hostname());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          Connect(server));
+  TF_EXPECT_OK(client->CheckCompatibility(compatibility_info));
+  EXPECT_THAT(client->CheckCompatibility("another-host"),
+              StatusIs(error::FAILED_PRECONDITION, HasSubstr("same host")));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
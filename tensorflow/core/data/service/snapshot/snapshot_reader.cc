@@ -14,17 +14,23 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/snapshot/snapshot_reader.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/common.h"
+#include "tensorflow/core/data/service/snapshot/file_utils.h"
+#include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/path.h"
 #include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/status_to_from_proto.h"
 #include "tensorflow/tsl/platform/statusor.h"
+#include "tensorflow/tsl/protobuf/status.pb.h"
 
 namespace tensorflow {
 namespace data {
@@ -32,6 +38,9 @@ namespace {
 
 constexpr int64_t kTFRecordReaderOutputBufferSize = 256 << 20;  // 256MB
 
+// How often a read-while-write reader checks for newly committed chunks.
+constexpr absl::Duration kReadWhileWritePollInterval = absl::Seconds(1);
+
 }
 
 SnapshotReader::SnapshotReader(const SnapshotReaderParams& params)
@@ -54,12 +63,13 @@ StatusOr<GetNextResult> SnapshotReader::GetNext() {
 }
 
 Status SnapshotReader::EnsureInitialized() {
-  if (!chunk_files_.empty()) {
+  if (initialized_) {
     return OkStatus();
   }
 
-  TF_ASSIGN_OR_RETURN(chunk_files_, GetChunkFiles());
+  TF_RETURN_IF_ERROR(UpdateChunkFiles());
   TF_RETURN_IF_ERROR(InitializeNextRecordReader());
+  initialized_ = true;
   if (end_of_sequence_) {
     return errors::NotFound("Failed to read distributed tf.data snapshot ",
                             params_.DebugString(), ": No snapshot is written.");
@@ -67,17 +77,59 @@ Status SnapshotReader::EnsureInitialized() {
   return OkStatus();
 }
 
-StatusOr<std::vector<std::string>> SnapshotReader::GetChunkFiles() {
+Status SnapshotReader::UpdateChunkFiles() {
   std::string chunks_directory = params_.CommittedChunksDirectory();
-  std::vector<string> chunk_files;
-  TF_RETURN_IF_ERROR(params_.env->GetChildren(chunks_directory, &chunk_files));
-  for (std::string& chunk_file : chunk_files) {
-    chunk_file = tsl::io::JoinPath(chunks_directory, chunk_file);
+  if (params_.read_while_write &&
+      !params_.env->FileExists(chunks_directory).ok()) {
+    // No chunk has been committed yet.
+    return OkStatus();
+  }
+  TF_ASSIGN_OR_RETURN(std::vector<std::string> chunk_files,
+                      GetChildren(chunks_directory, params_.env));
+  std::vector<std::string> new_chunk_files;
+  for (const std::string& chunk_file : chunk_files) {
+    std::string chunk_path = tsl::io::JoinPath(chunks_directory, chunk_file);
+    if (known_chunk_files_.insert(chunk_path).second) {
+      new_chunk_files.push_back(std::move(chunk_path));
+    }
+  }
+  std::sort(new_chunk_files.begin(), new_chunk_files.end());
+  chunk_files_.insert(chunk_files_.end(), new_chunk_files.begin(),
+                      new_chunk_files.end());
+  return OkStatus();
+}
+
+Status SnapshotReader::WaitForNextChunk() {
+  while (next_chunk_index_ >= chunk_files_.size()) {
+    if (params_.env->FileExists(SnapshotErrorFilePath(params_.snapshot_path))
+            .ok()) {
+      StatusProto status_proto;
+      TF_RETURN_IF_ERROR(ReadTextProto(
+          params_.env, SnapshotErrorFilePath(params_.snapshot_path),
+          &status_proto));
+      TF_RETURN_IF_ERROR(tsl::StatusFromProto(status_proto));
+    }
+    // Checks for the DONE file before listing the chunks, so chunks committed
+    // right before the snapshot finishes are not missed.
+    bool snapshot_done =
+        params_.env->FileExists(SnapshotDoneFilePath(params_.snapshot_path))
+            .ok();
+    TF_RETURN_IF_ERROR(UpdateChunkFiles());
+    if (next_chunk_index_ < chunk_files_.size() || snapshot_done) {
+      return OkStatus();
+    }
+    VLOG(1) << "Waiting for a new chunk of distributed tf.data snapshot "
+            << params_.DebugString();
+    params_.env->SleepForMicroseconds(
+        absl::ToInt64Microseconds(kReadWhileWritePollInterval));
   }
-  return chunk_files;
+  return OkStatus();
 }
 
 Status SnapshotReader::InitializeNextRecordReader() {
+  if (params_.read_while_write) {
+    TF_RETURN_IF_ERROR(WaitForNextChunk());
+  }
   if (next_chunk_index_ >= chunk_files_.size()) {
     end_of_sequence_ = true;
     tfrecord_reader_ = nullptr;
@@ -20,6 +20,7 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/substitute.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
@@ -47,6 +48,12 @@ struct SnapshotReaderParams {
   // The Tensorflow environment.
   Env* env = nullptr;
 
+  // If true, the snapshot may still be written while it is read. Chunks are
+  // read as they are committed, and the end of the sequence is only reached
+  // after the snapshot is done and all committed chunks are read. If the
+  // snapshot fails, the reader returns the snapshot's error.
+  bool read_while_write = false;
+
   std::string CommittedChunksDirectory() const {
     return tensorflow::data::CommittedChunksDirectory(snapshot_path);
   }
@@ -77,18 +84,25 @@ class SnapshotReader {
   // Initializes the reader if it's not already initialized. This is called when
   // `GetNext` is first called.
   Status EnsureInitialized();
-  // Returns a list of the committed chunks.
-  StatusOr<std::vector<std::string>> GetChunkFiles();
+  // Appends the newly committed chunks to `chunk_files_`.
+  Status UpdateChunkFiles();
+  // In read-while-write mode, blocks until there is a committed chunk that has
+  // not been read, or until the snapshot is done. Returns the snapshot's error
+  // if the snapshot has failed.
+  Status WaitForNextChunk();
   // If a chunk file is exhausted, starts reading the next chunk file. If there
   // are no more files to read, `end_of_sequence_` will be set to true.
   Status InitializeNextRecordReader();
 
   const SnapshotReaderParams params_;
 
-  // A list of the committed chunks to read.
+  // A list of the committed chunks to read, in the order they are read.
   std::vector<std::string> chunk_files_;
+  // The committed chunks in `chunk_files_`.
+  absl::flat_hash_set<std::string> known_chunk_files_;
   // The index of the next chunk to read.
   uint64_t next_chunk_index_ = 0;
+  bool initialized_ = false;
   bool end_of_sequence_ = false;
 
   std::unique_ptr<snapshot_util::TFRecordReader> tfrecord_reader_;
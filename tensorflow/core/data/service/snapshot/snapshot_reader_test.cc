@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/snapshot/file_utils.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/service/snapshot/snapshot_stream_writer.h"
 #include "tensorflow/core/data/service/task_runner.h"
@@ -30,13 +31,16 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/protobuf/snapshot.pb.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
 #include "tensorflow/tsl/lib/io/compression.h"
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/status_matchers.h"
+#include "tensorflow/tsl/platform/status_to_from_proto.h"
 #include "tensorflow/tsl/platform/statusor.h"
 #include "tensorflow/tsl/protobuf/error_codes.pb.h"
+#include "tensorflow/tsl/protobuf/status.pb.h"
 
 namespace tensorflow {
 namespace data {
@@ -72,11 +76,12 @@ StatusOr<std::string> CreateSnapshotDirectory() {
 
 template <class T>
 StatusOr<std::vector<T>> ReadSnapshot(const std::string& base_path,
-                                      const std::string& compression) {
+                                      const std::string& compression,
+                                      bool read_while_write = false) {
   experimental::DistributedSnapshotMetadata metadata;
   metadata.set_compression(compression);
   SnapshotReaderParams params{base_path, metadata, DataTypeVector{DT_INT64},
-                              Env::Default()};
+                              Env::Default(), read_while_write};
   SnapshotReader reader(params);
   std::vector<T> result;
   while (true) {
@@ -141,6 +146,51 @@ TEST(SnapshotReaderTest, EmptyDataset) {
               IsOkAndHolds(IsEmpty()));
 }
 
+TEST(SnapshotReaderTest, ReadWhileWrite) {
+  int64_t range = 10, num_writers = 2;
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, CreateSnapshotDirectory());
+
+  StatusOr<std::vector<int64_t>> result;
+  std::unique_ptr<Thread> reader_thread(Env::Default()->StartThread(
+      ThreadOptions(), "snapshot_reader", [&snapshot_path, &result]() {
+        result = ReadSnapshot<int64_t>(snapshot_path,
+                                       tsl::io::compression::kNone,
+                                       /*read_while_write=*/true);
+      }));
+
+  std::vector<std::unique_ptr<SnapshotStreamWriter>> writers;
+  for (int i = 0; i < num_writers; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
+                            TestIterator(testing::RangeDataset(range)));
+    SnapshotWriterParams writer_params{
+        snapshot_path, /*stream_index=*/i, tsl::io::compression::kNone,
+        Env::Default(), /*max_chunk_size_bytes=*/1};
+    writers.push_back(std::make_unique<SnapshotStreamWriter>(
+        writer_params, std::move(iterator)));
+  }
+  for (std::unique_ptr<SnapshotStreamWriter>& writer : writers) {
+    EXPECT_THAT(writer->Wait(), IsOkAndHolds(true));
+  }
+  TF_ASSERT_OK(AtomicallyWriteStringToFile(SnapshotDoneFilePath(snapshot_path),
+                                           "", Env::Default()));
+  reader_thread.reset();
+
+  EXPECT_THAT(result, IsOkAndHolds(UnorderedElementsAre(
+                          0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6, 7,
+                          8, 9)));
+}
+
+TEST(SnapshotReaderTest, ReadWhileWriteSnapshotError) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, CreateSnapshotDirectory());
+  StatusProto status_proto =
+      tsl::StatusToProto(errors::Internal("Snapshot error"));
+  TF_ASSERT_OK(AtomicallyWriteTextProto(SnapshotErrorFilePath(snapshot_path),
+                                        status_proto, Env::Default()));
+  EXPECT_THAT(ReadSnapshot<int64_t>(snapshot_path, tsl::io::compression::kNone,
+                                    /*read_while_write=*/true),
+              StatusIs(error::INTERNAL, "Snapshot error"));
+}
+
 TEST(SnapshotReaderTest, SnapshotDoesNotExist) {
   TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_does_not_exist,
                           CreateSnapshotDirectory());
@@ -28,8 +28,11 @@ limitations under the License.
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
@@ -46,6 +49,8 @@ namespace {
 constexpr int64_t kWaitBeforeSkipUs = 100 * 1000;  // 100ms.
 constexpr size_t kDefaultCrossTrainerCacheSizeBytes =
     10 * (size_t{1} << 30);  // 10GB
+constexpr size_t kDefaultCrossTrainerCacheSpillSizeBytes =
+    100 * (size_t{1} << 30);  // 100GB
 
 }  // namespace
 
@@ -94,8 +99,15 @@ Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
         worker_config.cross_trainer_cache_size_bytes() > 0
             ? worker_config.cross_trainer_cache_size_bytes()
             : kDefaultCrossTrainerCacheSizeBytes;
-    out = std::make_unique<CachingTaskRunner>(std::move(iterator),
-                                              max_cache_size_bytes);
+    CrossTrainerCacheSpillOptions spill_options;
+    spill_options.directory =
+        worker_config.cross_trainer_cache_spill_directory();
+    spill_options.max_size_bytes =
+        worker_config.cross_trainer_cache_spill_size_bytes() > 0
+            ? worker_config.cross_trainer_cache_spill_size_bytes()
+            : kDefaultCrossTrainerCacheSpillSizeBytes;
+    out = std::make_unique<CachingTaskRunner>(
+        std::move(iterator), max_cache_size_bytes, spill_options);
   } else {
     out = std::make_unique<FirstComeFirstServedTaskRunner>(std::move(iterator));
   }
@@ -163,13 +175,20 @@ void FirstComeFirstServedTaskRunner::Cancel() {
   buffer_.Cancel(errors::Cancelled("tf.data service FCFS task is cancelled."));
 }
 
-CachingTaskRunner::CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                                     size_t max_cache_size_bytes)
+CachingTaskRunner::CachingTaskRunner(
+    std::unique_ptr<TaskIterator> iterator, size_t max_cache_size_bytes,
+    const CrossTrainerCacheSpillOptions& spill_options)
     : fcfs_task_runner_(std::move(iterator)),
       cache_(max_cache_size_bytes,
-             std::make_unique<GetElementResultSequence>(fcfs_task_runner_)) {
+             std::make_unique<GetElementResultSequence>(fcfs_task_runner_),
+             spill_options) {
   LOG(INFO) << "Initialized tf.data service cross-trainer cache with "
             << FormatBytes(max_cache_size_bytes) << " of memory.";
+  if (!spill_options.directory.empty()) {
+    LOG(INFO) << "The cross-trainer cache spills up to "
+              << FormatBytes(spill_options.max_size_bytes) << " to "
+              << spill_options.directory << ".";
+  }
 }
 
 CachingTaskRunner::~CachingTaskRunner() { Cancel(); }
@@ -203,6 +222,62 @@ size_t CachingTaskRunner::GetElementResultSequence::GetElementSizeBytes(
   return element.EstimatedMemoryUsageBytes();
 }
 
+StatusOr<std::string>
+CachingTaskRunner::GetElementResultSequence::SerializeElement(
+    const GetElementResult& element) const {
+  GetElementResponse proto;
+  proto.set_element_index(element.element_index);
+  proto.set_end_of_sequence(element.end_of_sequence);
+  proto.set_skip_task(element.skip);
+  const CompressedElement* compressed = nullptr;
+  if (element.components.size() == 1 &&
+      element.components[0].dtype() == DT_VARIANT &&
+      TensorShapeUtils::IsScalar(element.components[0].shape())) {
+    compressed =
+        element.components[0].scalar<Variant>()().get<CompressedElement>();
+  }
+  if (compressed != nullptr) {
+    *proto.mutable_compressed() = *compressed;
+  } else {
+    for (const Tensor& component : element.components) {
+      component.AsProtoTensorContent(
+          proto.mutable_uncompressed()->add_components());
+    }
+  }
+  return proto.SerializeAsString();
+}
+
+StatusOr<GetElementResult>
+CachingTaskRunner::GetElementResultSequence::DeserializeElement(
+    absl::string_view serialized) const {
+  GetElementResponse proto;
+  if (!proto.ParseFromArray(serialized.data(), serialized.size())) {
+    return errors::DataLoss(
+        "Failed to parse a spilled tf.data service cross-trainer cache "
+        "element.");
+  }
+  GetElementResult result;
+  result.element_index = proto.element_index();
+  result.end_of_sequence = proto.end_of_sequence();
+  result.skip = proto.skip_task();
+  if (proto.has_compressed()) {
+    Tensor tensor(DT_VARIANT, TensorShape({}));
+    tensor.scalar<Variant>()() = std::move(*proto.mutable_compressed());
+    result.components.push_back(std::move(tensor));
+    return result;
+  }
+  for (const TensorProto& component : proto.uncompressed().components()) {
+    Tensor tensor;
+    if (!tensor.FromProto(component)) {
+      return errors::DataLoss(
+          "Failed to parse a component of a spilled tf.data service "
+          "cross-trainer cache element.");
+    }
+    result.components.push_back(std::move(tensor));
+  }
+  return result;
+}
+
 void CachingTaskRunner::Cancel() {
   VLOG(2) << "Cancelling tf.data service cross-trainer cache task.";
   if (!cache_.IsCancelled()) {
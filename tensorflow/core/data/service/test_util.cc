@@ -77,6 +77,20 @@ FunctionDef XTimesX() {
       /*ret_def=*/{{"y", "y:z:0"}});
 }
 
+FunctionDef XDivXMinusN(int64_t n) {
+  return FunctionDefHelper::Create(
+      /*function_name=*/"XDivXMinusN",
+      /*in_def=*/{"x: int64"},
+      /*out_def=*/{"y: int64"},
+      /*attr_def=*/{},
+      /*node_def=*/
+      {{{"n"}, "Const", {}, {{"value", AsScalar<int64_t>(n)},
+                             {"dtype", DT_INT64}}},
+       {{"d"}, "Sub", {"x", "n:output:0"}, {{"T", DT_INT64}}},
+       {{"y"}, "Div", {"x", "d:z:0"}, {{"T", DT_INT64}}}},
+      /*ret_def=*/{{"y", "y:z:0"}});
+}
+
 Status CreateTestFiles(const std::vector<tstring>& filenames,
                        const std::vector<tstring>& contents) {
   if (filenames.size() != contents.size()) {
@@ -133,6 +147,26 @@ DatasetDef RangeSquareDataset(const int64_t range) {
   return dataset_def;
 }
 
+DatasetDef RangeDatasetWithError(const int64_t range,
+                                 const int64_t error_index) {
+  DatasetDef dataset_def;
+  *dataset_def.mutable_graph() = GDef(
+      {NDef("start", "Const", /*inputs=*/{},
+            {{"value", AsScalar<int64_t>(0)}, {"dtype", DT_INT64}}),
+       NDef("stop", "Const", /*inputs=*/{},
+            {{"value", AsScalar<int64_t>(range)}, {"dtype", DT_INT64}}),
+       NDef("step", "Const", /*inputs=*/{},
+            {{"value", AsScalar<int64_t>(1)}, {"dtype", DT_INT64}}),
+       NDef("range", "RangeDataset", /*inputs=*/{"start", "stop", "step"},
+            {{"output_shapes", gtl::ArraySlice<TensorShape>{TensorShape()}},
+             {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}}),
+       GetMapNode("map", "range", "XDivXMinusN"),
+       NDef("dataset", "_Retval", /*inputs=*/{"map"},
+            {{"T", DT_VARIANT}, {"index", 0}})},
+      {XDivXMinusN(error_index)});
+  return dataset_def;
+}
+
 DatasetDef RangeDatasetWithShardHint(const int64_t range) {
   DatasetDef dataset_def;
   *dataset_def.mutable_graph() = GDef(
@@ -43,6 +43,11 @@ DatasetDef RangeDataset(int64_t range);
 // tf.data.Dataset.range(range).map(lambda x: x*x).
 DatasetDef RangeSquareDataset(int64_t range);
 
+// Returns a test dataset representing
+// tf.data.Dataset.range(range).map(lambda x: x // (x - error_index)), whose
+// element at `error_index` fails with an integer division by zero error.
+DatasetDef RangeDatasetWithError(int64_t range, int64_t error_index);
+
 // Returns a test dataset representing
 // tf.data.Dataset.range(range).shard(SHARD_HINT, SHARD_HINT).
 DatasetDef RangeDatasetWithShardHint(int64_t range);
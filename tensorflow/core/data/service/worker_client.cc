@@ -130,6 +130,29 @@ class GrpcDataTransferClient : public DataTransferClient {
     if (!s.ok()) {
       return grpc_util::WrapError("Failed to get element", s);
     }
+    TF_RETURN_IF_ERROR(ParseResponse(resp, result));
+    for (GetElementResponse& additional_resp :
+         *resp.mutable_additional_elements()) {
+      result.additional_results.emplace_back();
+      TF_RETURN_IF_ERROR(
+          ParseResponse(additional_resp, result.additional_results.back()));
+    }
+    return OkStatus();
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel GrpcDataTransferClient.";
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    for (const auto& ctx : active_contexts_) {
+      ctx->TryCancel();
+    }
+  }
+
+ private:
+  // Moves the element in `resp` into `result`.
+  static Status ParseResponse(GetElementResponse& resp,
+                              GetElementResult& result) {
     result.end_of_sequence = resp.end_of_sequence();
     result.skip = resp.skip_task();
     switch (resp.element_case()) {
@@ -153,16 +176,6 @@ class GrpcDataTransferClient : public DataTransferClient {
     return OkStatus();
   }
 
-  void TryCancel() override {
-    VLOG(2) << "Cancel GrpcDataTransferClient.";
-    mutex_lock l(mu_);
-    cancelled_ = true;
-    for (const auto& ctx : active_contexts_) {
-      ctx->TryCancel();
-    }
-  }
-
- private:
   mutex mu_;
   std::unique_ptr<WorkerService::Stub> stub_;
   // Set of all currently active clients contexts. Used to support
@@ -48,6 +48,7 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+using ::tensorflow::data::testing::RangeDatasetWithError;
 using ::tensorflow::data::testing::RangeSquareDataset;
 using ::tensorflow::testing::StatusIs;
 using ::testing::MatchesRegex;
@@ -65,7 +66,10 @@ class WorkerClientTest : public ::testing::Test {
 
   // Creates a dataset and returns the dataset ID.
   StatusOr<std::string> RegisterDataset(const int64_t range) {
-    const auto dataset_def = RangeSquareDataset(range);
+    return RegisterDataset(RangeSquareDataset(range));
+  }
+
+  StatusOr<std::string> RegisterDataset(const DatasetDef& dataset_def) {
     std::string dataset_id;
     TF_RETURN_IF_ERROR(dispatcher_client_->RegisterDataset(
         dataset_def, DataServiceMetadata(),
@@ -199,6 +203,68 @@ TEST_F(WorkerClientTest, GrpcRead) {
                        MatchesRegex("Local worker.*is no longer available.*")));
 }
 
+TEST_F(WorkerClientTest, BatchedGrpcResponse) {
+  const int64_t range = 5;
+  TF_ASSERT_OK_AND_ASSIGN(const std::string dataset_id, RegisterDataset(range));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t iteration_client_id,
+                          CreateIteration(dataset_id));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t task_id,
+                          GetTaskToRead(iteration_client_id));
+  std::shared_ptr<DataServiceWorkerImpl> worker =
+      LocalWorkers::Get(GetWorkerAddress());
+  ASSERT_NE(worker, nullptr);
+
+  GetElementRequest request;
+  request.set_task_id(task_id);
+  request.set_max_elements(3);
+  GetElementResponse response;
+  TF_ASSERT_OK(worker->GetElement(&request, &response));
+  EXPECT_FALSE(response.end_of_sequence());
+  ASSERT_EQ(response.additional_elements_size(), 2);
+  EXPECT_FALSE(response.additional_elements(1).end_of_sequence());
+
+  // The second response holds the last two elements, followed by the end of
+  // sequence.
+  response.Clear();
+  TF_ASSERT_OK(worker->GetElement(&request, &response));
+  EXPECT_FALSE(response.end_of_sequence());
+  ASSERT_EQ(response.additional_elements_size(), 2);
+  EXPECT_FALSE(response.additional_elements(0).end_of_sequence());
+  EXPECT_TRUE(response.additional_elements(1).end_of_sequence());
+  EXPECT_TRUE(response.additional_elements(0).has_uncompressed());
+  EXPECT_FALSE(response.additional_elements(1).has_uncompressed());
+}
+
+TEST_F(WorkerClientTest, BatchedResponseReturnsErrorOnNextRequest) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      const std::string dataset_id,
+      RegisterDataset(RangeDatasetWithError(/*range=*/5, /*error_index=*/2)));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t iteration_client_id,
+                          CreateIteration(dataset_id));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t task_id,
+                          GetTaskToRead(iteration_client_id));
+  std::shared_ptr<DataServiceWorkerImpl> worker =
+      LocalWorkers::Get(GetWorkerAddress());
+  ASSERT_NE(worker, nullptr);
+
+  // The iterator fails on the third element, so the first response holds the
+  // two elements before it.
+  GetElementRequest request;
+  request.set_task_id(task_id);
+  request.set_max_elements(4);
+  GetElementResponse response;
+  TF_ASSERT_OK(worker->GetElement(&request, &response));
+  EXPECT_FALSE(response.end_of_sequence());
+  ASSERT_EQ(response.additional_elements_size(), 1);
+  EXPECT_FALSE(response.additional_elements(0).end_of_sequence());
+
+  // The error is returned by the next request instead of being dropped.
+  response.Clear();
+  EXPECT_THAT(worker->GetElement(&request, &response),
+              StatusIs(error::INVALID_ARGUMENT,
+                       MatchesRegex(".*Integer division by zero.*")));
+}
+
 TEST_F(WorkerClientTest, LocalServerShutsDown) {
   TF_ASSERT_OK_AND_ASSIGN(const std::string dataset_id,
                           RegisterDataset(/*range=*/5));
@@ -74,6 +74,9 @@ namespace {
 constexpr absl::Duration kRetryInterval = absl::Seconds(5);
 constexpr absl::Duration kDefaultHeartBeatInterval = absl::Seconds(30);
 constexpr absl::Duration kDefaultDispatcherTimeout = absl::Hours(1);
+// A batched GetElement response stops taking further elements once it holds
+// this many bytes.
+constexpr size_t kMaxBatchedResponseBytes = 64 << 20;
 
 using WorkerConfig = experimental::WorkerConfig;
 
@@ -284,6 +287,9 @@ Status DataServiceWorkerImpl::GetElementResult(
       return errors::Unavailable("Task ", request->task_id(), " not found");
     }
     task = it->second.get();
+    if (!task->pending_error.ok()) {
+      return std::exchange(task->pending_error, OkStatus());
+    }
     task->outstanding_requests++;
   }
   auto cleanup = gtl::MakeCleanup([&] {
@@ -438,11 +444,61 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
   TF_RETURN_IF_ERROR(GetElementResult(request, &result));
   response->set_end_of_sequence(result.end_of_sequence);
   response->set_skip_task(result.skip);
-  if (!response->end_of_sequence() && !response->skip_task()) {
-    TF_RETURN_IF_ERROR(
-        MoveElementToResponse(std::move(result.components), *response));
-    VLOG(3) << "Producing an element for task " << request->task_id();
+  if (response->end_of_sequence() || response->skip_task()) {
+    return OkStatus();
+  }
+  TF_RETURN_IF_ERROR(
+      MoveElementToResponse(std::move(result.components), *response));
+  VLOG(3) << "Producing an element for task " << request->task_id();
+
+  // Round-robin and cross-trainer cache reads are synchronized per element, so
+  // they always get one element per request.
+  if (request->max_elements() <= 1 || request->has_round_index() ||
+      !request->trainer_id().empty()) {
+    return OkStatus();
+  }
+  // The elements gathered so far have already been consumed from the task, so
+  // an error on an additional element returns them now and the error on the
+  // next request. Task runners only return a buffered error once, so it is
+  // kept here.
+  auto defer_error = [this, request](const Status& s) {
+    VLOG(1) << "Failed to get an additional element for task "
+            << request->task_id() << ": " << s;
+    mutex_lock l(mu_);
+    auto it = tasks_.find(request->task_id());
+    if (it != tasks_.end()) {
+      it->second->pending_error = s;
+    }
+  };
+  size_t response_bytes = response->ByteSizeLong();
+  for (int64_t i = 1; i < request->max_elements() &&
+                      response_bytes < kMaxBatchedResponseBytes;
+       ++i) {
+    struct GetElementResult additional_result;
+    Status s = GetElementResult(request, &additional_result);
+    if (!s.ok()) {
+      defer_error(s);
+      break;
+    }
+    GetElementResponse* additional_response =
+        response->add_additional_elements();
+    additional_response->set_end_of_sequence(
+        additional_result.end_of_sequence);
+    additional_response->set_skip_task(additional_result.skip);
+    if (additional_result.end_of_sequence || additional_result.skip) {
+      break;
+    }
+    s = MoveElementToResponse(std::move(additional_result.components),
+                              *additional_response);
+    if (!s.ok()) {
+      response->mutable_additional_elements()->RemoveLast();
+      defer_error(s);
+      break;
+    }
+    response_bytes += additional_response->ByteSizeLong();
   }
+  VLOG(3) << "Producing " << response->additional_elements_size()
+          << " additional elements for task " << request->task_id();
   return OkStatus();
 }
 
@@ -100,6 +100,9 @@ class DataServiceWorkerImpl {
     mutex mu;
     bool initialized TF_GUARDED_BY(mu) = false;
     int64_t outstanding_requests TF_GUARDED_BY(&DataServiceWorkerImpl::mu_) = 0;
+    // Error hit while filling a batched GetElement response. The elements
+    // before it were already returned, so it is returned by the next request.
+    Status pending_error TF_GUARDED_BY(&DataServiceWorkerImpl::mu_);
     std::unique_ptr<TaskRunner> task_runner;
   };
 
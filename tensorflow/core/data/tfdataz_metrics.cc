@@ -91,9 +91,12 @@ absl::Duration ApproximateLatencyEstimator::GetAverageLatency(Duration duration)
   return absl::Duration(absl::Microseconds(interval_latency)) / interval_count;
 }
 
-TfDatazMetricsCollector::TfDatazMetricsCollector(const Env& env,
-                                                 IteratorBase* iterator)
-    : iterator_(iterator), latency_estimator_(env) {}
+TfDatazMetricsCollector::TfDatazMetricsCollector(
+    const Env& env, IteratorBase* iterator,
+    std::shared_ptr<IteratorStatsRegistry> iterator_stats)
+    : iterator_(iterator),
+      iterator_stats_(std::move(iterator_stats)),
+      latency_estimator_(env) {}
 
 void TfDatazMetricsCollector::RecordGetNextLatency(
     int64_t get_next_latency_usec) {
@@ -121,6 +124,12 @@ int64_t TfDatazMetricsCollector::GetIteratorTotalMemoryUsage() {
   return iterator_->TotalBufferedBytes();
 }
 
+absl::flat_hash_map<std::string, IteratorStats>
+TfDatazMetricsCollector::GetIteratorStats() {
+  if (!iterator_stats_) return {};
+  return iterator_stats_->GetStats();
+}
+
 namespace {
 static mutex* get_tfdataz_metrics_registry_lock() {
   static mutex tfdataz_metrics_registry_lock(LINKER_INITIALIZED);
@@ -23,6 +23,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -96,7 +97,11 @@ class TfDatazMetricsCollector {
   // We only collect metrics for CPU devices. This is a heuristic to avoid
   // collecting metrics for device-side iterators created by the multi-device
   // iterator mechanism.
-  TfDatazMetricsCollector(const Env& env, IteratorBase* iterator);
+  // If `iterator_stats` is set, it is the registry in which the iterators of
+  // the pipeline record their resource usage.
+  TfDatazMetricsCollector(
+      const Env& env, IteratorBase* iterator,
+      std::shared_ptr<IteratorStatsRegistry> iterator_stats = nullptr);
 
   // Records `GetNext` call latency.
   void RecordGetNextLatency(int64_t get_next_latency_usec);
@@ -115,8 +120,14 @@ class TfDatazMetricsCollector {
   // buffered in all nodes in the subtree.
   int64_t GetIteratorTotalMemoryUsage();
 
+  // Returns the cumulative resource usage of the iterators in the pipeline,
+  // keyed by iterator prefix. Returns an empty map if the pipeline does not
+  // collect iterator stats.
+  absl::flat_hash_map<std::string, IteratorStats> GetIteratorStats();
+
  private:
   IteratorBase* iterator_;  // not owned
+  std::shared_ptr<IteratorStatsRegistry> iterator_stats_;
   ApproximateLatencyEstimator latency_estimator_;
 };
 
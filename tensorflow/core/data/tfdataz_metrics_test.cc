@@ -210,6 +210,20 @@ TEST(TfDatazMetricsRegistryTest, Register) {
   EXPECT_EQ(TfDatazMetricsRegistry::GetIteratorMetricCollectors().size(), 2);
 }
 
+TEST(TfDatazMetricsCollectorTest, GetIteratorStats) {
+  std::unique_ptr<IteratorBase> iterator;
+  TfDatazMetricsCollector collector(*Env::Default(), iterator.get());
+  EXPECT_TRUE(collector.GetIteratorStats().empty());
+
+  auto iterator_stats = std::make_shared<IteratorStatsRegistry>();
+  iterator_stats->GetOrCreate("Iterator::Range")->num_elements.fetch_add(3);
+  TfDatazMetricsCollector stats_collector(*Env::Default(), iterator.get(),
+                                          iterator_stats);
+  auto stats = stats_collector.GetIteratorStats();
+  ASSERT_EQ(stats.size(), 1);
+  EXPECT_EQ(stats["Iterator::Range"].num_elements, 3);
+}
+
 TEST(TfDatazMetricsRegistryTest, Deregister) {
   std::unique_ptr<IteratorBase> iterator;
   auto collector_one = std::make_shared<TfDatazMetricsCollector>(
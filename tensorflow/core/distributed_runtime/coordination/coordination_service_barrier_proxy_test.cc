@@ -90,6 +90,8 @@ class MockCoordinationServiceAgent : public CoordinationServiceAgent {
                StatusOr<std::vector<KeyValueEntry>>(const std::string& key));
   MOCK_METHOD2(GetKeyValueDirAsync,
                void(const std::string& key, StatusOrValueDirCallback done));
+  MOCK_METHOD1(GetKeyValues, StatusOr<std::vector<std::string>>(
+                                 const std::vector<std::string>& keys));
   MOCK_METHOD2(InsertKeyValue,
                Status(const std::string& key, const std::string& value));
   MOCK_METHOD1(DeleteKeyValue, Status(const std::string& key));
@@ -102,6 +104,10 @@ class MockCoordinationServiceAgent : public CoordinationServiceAgent {
                void(const std::string& barrier_id, absl::Duration timeout,
                     const std::vector<CoordinatedTask>& tasks,
                     StatusCallback done));
+  MOCK_METHOD4(WaitAtHierarchicalBarrier,
+               Status(const std::string& barrier_id, absl::Duration timeout,
+                      const std::vector<CoordinatedTask>& tasks,
+                      int group_size));
   MOCK_METHOD2(CancelBarrierAsync,
                void(const std::string& barrier_id, StatusCallback done));
   MOCK_METHOD0(GetEnv, StatusOr<Env*>());
@@ -0,0 +1,104 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/eager/enqueue_batcher.h"
+
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace eager {
+
+EnqueueBatcher::EnqueueBatcher(int64_t window_micros, int max_batch_size,
+                               SendFn send)
+    : window_micros_(window_micros),
+      max_batch_size_(max_batch_size),
+      state_(std::make_shared<State>(std::move(send))) {}
+
+EnqueueBatcher::~EnqueueBatcher() {
+  mutex_lock l(state_->mu);
+  state_->closed = true;
+  while (!state_->batches.empty()) {
+    state_->FlushLocked(state_->batches.begin()->first);
+  }
+}
+
+bool EnqueueBatcher::SendsImmediately(const EnqueueRequest& request) {
+  for (const QueueItem& item : request.queue()) {
+    if (item.has_operation()) {
+      if (item.operation().name() == "_Send") return true;
+    } else if (!item.has_handle_to_decref()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void EnqueueBatcher::Add(const EnqueueRequest& request,
+                         EnqueueResponse* response, StatusCallback done) {
+  const uint64 context_id = request.context_id();
+  mutex_lock l(state_->mu);
+  std::unique_ptr<Batch>& batch = state_->batches[context_id];
+  if (batch == nullptr) {
+    batch = std::make_unique<Batch>();
+    batch->request.set_context_id(context_id);
+    std::weak_ptr<State> weak_state = state_;
+    Env::Default()->SchedClosureAfter(window_micros_, [weak_state,
+                                                       context_id]() {
+      std::shared_ptr<State> state = weak_state.lock();
+      if (state == nullptr) return;
+      mutex_lock l(state->mu);
+      if (state->closed) return;
+      state->FlushLocked(context_id);
+    });
+  }
+  for (const QueueItem& item : request.queue()) {
+    *batch->request.add_queue() = item;
+  }
+  batch->items.push_back({response, request.queue_size(), std::move(done)});
+  if (batch->request.queue_size() >= max_batch_size_ ||
+      SendsImmediately(request)) {
+    state_->FlushLocked(context_id);
+  }
+}
+
+void EnqueueBatcher::Flush(uint64 context_id) {
+  mutex_lock l(state_->mu);
+  state_->FlushLocked(context_id);
+}
+
+void EnqueueBatcher::State::FlushLocked(uint64 context_id) {
+  auto it = batches.find(context_id);
+  if (it == batches.end()) return;
+  std::shared_ptr<Batch> batch = std::move(it->second);
+  batches.erase(it);
+  // Sending under `mu` keeps the batches of a context in order.
+  send(batch->request, &batch->response, [batch](const Status& status) {
+    int next = 0;
+    for (Batch::Item& item : batch->items) {
+      for (int i = 0; i < item.num_queue_items &&
+                      next < batch->response.queue_response_size();
+           ++i, ++next) {
+        item.response->add_queue_response()->Swap(
+            batch->response.mutable_queue_response(next));
+      }
+      item.done(status);
+    }
+  });
+}
+
+}  // namespace eager
+}  // namespace tensorflow
@@ -0,0 +1,98 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_BATCHER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_BATCHER_H_
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
+
+namespace tensorflow {
+namespace eager {
+
+// Coalesces the EnqueueRequests sent to one destination over a streaming
+// enqueue call. Requests for the same context that arrive within a time window
+// are merged into a single request, and the responses are split up again when
+// it completes. Requests are sent in the order in which they were added.
+//
+// A pending batch is sent when its window expires, when it reaches the maximum
+// batch size, or when a request is added that someone may be waiting on:
+//  - a remote _Send, whose tensor a local _Recv is already waiting for, so that
+//    the tensor is fetched as soon as its producer finishes;
+//  - any queue item other than an operation or a tensor handle to decref, such
+//    as function registration or executor syncs.
+class EnqueueBatcher {
+ public:
+  // Sends `request`. Must send requests in the order of the calls.
+  using SendFn =
+      std::function<void(const EnqueueRequest& request,
+                         EnqueueResponse* response, StatusCallback done)>;
+
+  EnqueueBatcher(int64_t window_micros, int max_batch_size, SendFn send);
+  ~EnqueueBatcher();
+
+  // Adds `request` to the pending batch of its context. `response` is filled
+  // with the responses for the queue items of `request` before `done` is
+  // called with the status of the batch. `request` can be deleted as soon as
+  // Add returns.
+  void Add(const EnqueueRequest& request, EnqueueResponse* response,
+           StatusCallback done);
+
+  // Sends the pending batch of `context_id`, if any.
+  void Flush(uint64 context_id);
+
+ private:
+  struct Batch {
+    struct Item {
+      EnqueueResponse* response;
+      int num_queue_items;
+      StatusCallback done;
+    };
+
+    EnqueueRequest request;
+    EnqueueResponse response;
+    std::vector<Item> items;
+  };
+
+  // Shared with the window timers, which can outlive the batcher.
+  struct State {
+    const SendFn send;
+    mutex mu;
+    bool closed TF_GUARDED_BY(mu) = false;
+    std::unordered_map<uint64, std::unique_ptr<Batch>> batches
+        TF_GUARDED_BY(mu);
+
+    explicit State(SendFn send) : send(std::move(send)) {}
+    void FlushLocked(uint64 context_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu);
+  };
+
+  static bool SendsImmediately(const EnqueueRequest& request);
+
+  const int64_t window_micros_;
+  const int max_batch_size_;
+  const std::shared_ptr<State> state_;
+};
+
+}  // namespace eager
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_BATCHER_H_
@@ -0,0 +1,159 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/eager/enqueue_batcher.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace eager {
+namespace {
+
+constexpr uint64 kContextId = 7;
+constexpr int64_t kLongWindowMicros = 60 * 1000 * 1000;
+
+// Records the sent requests and responds to every queue item with its
+// operation id as the shape rank.
+class FakeStream {
+ public:
+  EnqueueBatcher::SendFn SendFn(Status status = OkStatus()) {
+    return [this, status](const EnqueueRequest& request,
+                          EnqueueResponse* response, StatusCallback done) {
+      {
+        mutex_lock l(mu_);
+        requests_.push_back(request);
+      }
+      for (const QueueItem& item : request.queue()) {
+        response->add_queue_response()->add_shape()->add_dim()->set_size(
+            item.operation().id());
+      }
+      done(status);
+    };
+  }
+
+  std::vector<EnqueueRequest> requests() {
+    mutex_lock l(mu_);
+    return requests_;
+  }
+
+ private:
+  mutex mu_;
+  std::vector<EnqueueRequest> requests_ TF_GUARDED_BY(mu_);
+};
+
+EnqueueRequest OpRequest(const std::vector<int>& op_ids,
+                         const string& op_name = "AddV2") {
+  EnqueueRequest request;
+  request.set_context_id(kContextId);
+  for (int id : op_ids) {
+    Operation* op = request.add_queue()->mutable_operation();
+    op->set_id(id);
+    op->set_name(op_name);
+  }
+  return request;
+}
+
+int64_t ResponseId(const EnqueueResponse& response, int i) {
+  return response.queue_response(i).shape(0).dim(0).size();
+}
+
+TEST(EnqueueBatcherTest, MergesRequestsAndSplitsResponses) {
+  FakeStream stream;
+  EnqueueBatcher batcher(kLongWindowMicros, /*max_batch_size=*/100,
+                         stream.SendFn());
+  EnqueueResponse response_1, response_2;
+  Status status_1 = errors::Unknown("not done");
+  Status status_2 = errors::Unknown("not done");
+  batcher.Add(OpRequest({1, 2}), &response_1,
+              [&status_1](const Status& s) { status_1 = s; });
+  batcher.Add(OpRequest({3}), &response_2,
+              [&status_2](const Status& s) { status_2 = s; });
+  EXPECT_TRUE(stream.requests().empty());
+
+  batcher.Flush(kContextId);
+  ASSERT_EQ(stream.requests().size(), 1);
+  EXPECT_EQ(stream.requests()[0].context_id(), kContextId);
+  EXPECT_EQ(stream.requests()[0].queue_size(), 3);
+  TF_EXPECT_OK(status_1);
+  TF_EXPECT_OK(status_2);
+  ASSERT_EQ(response_1.queue_response_size(), 2);
+  EXPECT_EQ(ResponseId(response_1, 0), 1);
+  EXPECT_EQ(ResponseId(response_1, 1), 2);
+  ASSERT_EQ(response_2.queue_response_size(), 1);
+  EXPECT_EQ(ResponseId(response_2, 0), 3);
+}
+
+TEST(EnqueueBatcherTest, SendsRemoteSendImmediately) {
+  FakeStream stream;
+  EnqueueBatcher batcher(kLongWindowMicros, /*max_batch_size=*/100,
+                         stream.SendFn());
+  EnqueueResponse response_1, response_2;
+  batcher.Add(OpRequest({1}), &response_1, [](const Status& s) {});
+  batcher.Add(OpRequest({2}, "_Send"), &response_2, [](const Status& s) {});
+  ASSERT_EQ(stream.requests().size(), 1);
+  EXPECT_EQ(stream.requests()[0].queue_size(), 2);
+  EXPECT_EQ(response_2.queue_response_size(), 1);
+}
+
+TEST(EnqueueBatcherTest, SendsFullBatch) {
+  FakeStream stream;
+  EnqueueBatcher batcher(kLongWindowMicros, /*max_batch_size=*/2,
+                         stream.SendFn());
+  EnqueueResponse responses[3];
+  for (int i = 0; i < 3; ++i) {
+    batcher.Add(OpRequest({i}), &responses[i], [](const Status& s) {});
+  }
+  ASSERT_EQ(stream.requests().size(), 1);
+  EXPECT_EQ(stream.requests()[0].queue_size(), 2);
+  EXPECT_EQ(responses[2].queue_response_size(), 0);
+}
+
+TEST(EnqueueBatcherTest, SendsBatchWhenWindowExpires) {
+  FakeStream stream;
+  EnqueueBatcher batcher(/*window_micros=*/1000, /*max_batch_size=*/100,
+                         stream.SendFn());
+  EnqueueResponse response;
+  Notification done;
+  batcher.Add(OpRequest({1}), &response,
+              [&done](const Status& s) { done.Notify(); });
+  done.WaitForNotification();
+  EXPECT_EQ(stream.requests().size(), 1);
+  EXPECT_EQ(response.queue_response_size(), 1);
+}
+
+TEST(EnqueueBatcherTest, PropagatesErrorToAllRequests) {
+  FakeStream stream;
+  EnqueueBatcher batcher(kLongWindowMicros, /*max_batch_size=*/100,
+                         stream.SendFn(errors::Internal("remote failure")));
+  EnqueueResponse response_1, response_2;
+  Status status_1, status_2;
+  batcher.Add(OpRequest({1}), &response_1,
+              [&status_1](const Status& s) { status_1 = s; });
+  batcher.Add(OpRequest({2}), &response_2,
+              [&status_2](const Status& s) { status_2 = s; });
+  batcher.Flush(kContextId);
+  EXPECT_EQ(status_1.code(), error::INTERNAL);
+  EXPECT_EQ(status_2.code(), error::INTERNAL);
+}
+
+}  // namespace
+}  // namespace eager
+}  // namespace tensorflow
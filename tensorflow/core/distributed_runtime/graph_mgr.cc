@@ -53,6 +53,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 #include "tensorflow/core/util/env_var.h"
+#include "tensorflow/tsl/profiler/lib/step_counter.h"
 
 namespace tensorflow {
 
@@ -432,6 +433,7 @@ void GraphMgr::ExecuteAsync(
       },
       profiler::ContextType::kTfExecutor, step_id,
       profiler::TraceMeLevel::kInfo);
+  tsl::profiler::StepCounter::StepStarted();
   // Lookup an item. Holds one ref while executing.
   Item* item = nullptr;
   {
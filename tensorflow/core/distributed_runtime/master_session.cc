@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/profile_handler.h"
 #include "tensorflow/core/common_runtime/stats_publisher_interface.h"
 #include "tensorflow/core/debug/debug_graph_utils.h"
+#include "tensorflow/core/distributed_runtime/error_payloads.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/scheduler.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
@@ -1284,11 +1285,16 @@ Status MasterSession::Create(GraphDef&& graph_def,
         std::move(graph_def), execution_options, &execution_state_));
   }
   should_delete_worker_sessions_ = true;
+  cluster_def_ = cluster_def;
   return CreateWorkerSessions(cluster_def);
 }
 
 Status MasterSession::CreateWorkerSessions(const ClusterDef& cluster_def) {
-  const std::vector<string> worker_names = filtered_worker_list_;
+  return CreateWorkerSessions(cluster_def, filtered_worker_list_);
+}
+
+Status MasterSession::CreateWorkerSessions(
+    const ClusterDef& cluster_def, const std::vector<string>& worker_names) {
   WorkerCacheInterface* worker_cache = get_worker_cache();
 
   struct WorkerGroup {
@@ -1321,6 +1327,25 @@ Status MasterSession::CreateWorkerSessions(const ClusterDef& cluster_def) {
                                    &task_name, &local_device_name);
   const int64_t client_device_incarnation =
       devices_->client_device()->attributes().incarnation();
+  std::unordered_map<string, int64_t> device_incarnations;
+  {
+    mutex_lock l(mu_);
+    device_incarnations = device_incarnations_;
+  }
+
+  // In elastic mode, the failure of a worker task must not be propagated to
+  // the other tasks by the coordination service.
+  std::vector<string> recoverable_jobs;
+  if (elastic_worker_recovery()) {
+    for (const string& worker_name : filtered_worker_list_) {
+      DeviceNameUtils::ParsedName name;
+      if (DeviceNameUtils::ParseFullName(worker_name, &name) && name.has_job &&
+          std::find(recoverable_jobs.begin(), recoverable_jobs.end(),
+                    name.job) == recoverable_jobs.end()) {
+        recoverable_jobs.push_back(name.job);
+      }
+    }
+  }
 
   Status status = OkStatus();
   // Create all the workers & kick off the computations.
@@ -1334,8 +1359,13 @@ Status MasterSession::CreateWorkerSessions(const ClusterDef& cluster_def) {
         session_opts_.config.experimental()
             .share_cluster_devices_in_session()) {
       for (const auto& remote_dev : devices_->devices()) {
-        *workers[i].request.add_cluster_device_attributes() =
-            remote_dev->attributes();
+        DeviceAttributes* attrs =
+            workers[i].request.add_cluster_device_attributes();
+        *attrs = remote_dev->attributes();
+        auto it = device_incarnations.find(attrs->name());
+        if (it != device_incarnations.end()) {
+          attrs->set_incarnation(it->second);
+        }
       }
 
       if (!session_opts_.config.share_cluster_devices_in_session() &&
@@ -1387,6 +1417,13 @@ Status MasterSession::CreateWorkerSessions(const ClusterDef& cluster_def) {
     }
     // Specify master task as coordination service leader.
     coordination_config.set_service_leader(task_name);
+    for (const string& job : recoverable_jobs) {
+      if (std::find(coordination_config.recoverable_jobs().begin(),
+                    coordination_config.recoverable_jobs().end(),
+                    job) == coordination_config.recoverable_jobs().end()) {
+        coordination_config.add_recoverable_jobs(job);
+      }
+    }
     *workers[i]
          .request.mutable_server_def()
          ->mutable_default_session_config()
@@ -1477,6 +1514,158 @@ Status MasterSession::DeleteWorkerSessions() {
   return status;
 }
 
+bool MasterSession::elastic_worker_recovery() const {
+  return session_opts_.config.experimental().enable_elastic_worker_recovery();
+}
+
+void MasterSession::MaybeScheduleWorkerRecovery(const Status& s) {
+  if (s.ok() || !elastic_worker_recovery()) return;
+  if (errors::IsUnavailable(s) || errors::IsAborted(s) ||
+      s.GetPayload(kWorkerPossiblyRestarted).has_value()) {
+    mutex_lock l(mu_);
+    needs_worker_recovery_ = true;
+  }
+}
+
+Status MasterSession::MaybeRecoverWorkers() {
+  if (!elastic_worker_recovery()) return OkStatus();
+  mutex_lock recovery_lock(recovery_mu_);
+  std::unordered_map<string, int64_t> old_device_incarnations;
+  {
+    mutex_lock l(mu_);
+    if (!needs_worker_recovery_) return OkStatus();
+    old_device_incarnations = device_incarnations_;
+  }
+
+  WorkerCacheInterface* worker_cache = get_worker_cache();
+  const std::vector<string>& worker_names = filtered_worker_list_;
+
+  struct WorkerGroup {
+    // The worker name. (Not owned.)
+    const string* name;
+
+    // The worker referenced by name. (Not owned.)
+    WorkerInterface* worker = nullptr;
+
+    CallOptions call_opts;
+
+    // Request and responses used for a given worker.
+    GetStatusRequest request;
+    GetStatusResponse response;
+    Status status = OkStatus();
+  };
+  BlockingCounter done(worker_names.size());
+  std::vector<WorkerGroup> workers(worker_names.size());
+
+  // Release the workers.
+  auto cleanup = gtl::MakeCleanup([&workers, worker_cache] {
+    for (auto&& worker_group : workers) {
+      if (worker_group.worker != nullptr) {
+        worker_cache->ReleaseWorker(*worker_group.name, worker_group.worker);
+      }
+    }
+  });
+
+  for (size_t i = 0; i < worker_names.size(); ++i) {
+    workers[i].name = &worker_names[i];
+    workers[i].worker = worker_cache->GetOrCreateWorker(worker_names[i]);
+    // A replacement task may not be up yet: fail the step rather than wait.
+    workers[i].call_opts.SetTimeout(10000);
+    if (workers[i].worker == nullptr) {
+      workers[i].status =
+          errors::Unavailable("Could not create worker ", worker_names[i]);
+      done.DecrementCount();
+      continue;
+    }
+    auto cb = [i, &workers, &done](const Status& s) {
+      workers[i].status = s;
+      done.DecrementCount();
+    };
+    workers[i].worker->GetStatusAsync(&workers[i].call_opts,
+                                      &workers[i].request,
+                                      &workers[i].response,
+                                      /*fail_fast=*/true, cb);
+  }
+  done.Wait();
+
+  // A worker whose devices have a new incarnation has been restarted, and
+  // has lost its worker session and registered graphs.
+  std::vector<string> restarted_workers;
+  std::unordered_map<string, int64_t> device_incarnations =
+      old_device_incarnations;
+  for (size_t i = 0; i < workers.size(); ++i) {
+    if (!workers[i].status.ok()) {
+      return errors::Unavailable("Could not recover worker ", worker_names[i],
+                                 " of session ", handle_, ": ",
+                                 workers[i].status.error_message());
+    }
+    bool restarted = false;
+    for (const DeviceAttributes& attrs :
+         workers[i].response.device_attributes()) {
+      Device* d = devices_->FindDeviceByName(attrs.name());
+      if (d == nullptr) continue;
+      auto it = device_incarnations.find(attrs.name());
+      const int64_t incarnation = it != device_incarnations.end()
+                                      ? it->second
+                                      : d->attributes().incarnation();
+      if (attrs.incarnation() != incarnation) {
+        device_incarnations[attrs.name()] = attrs.incarnation();
+        restarted = true;
+      }
+    }
+    if (restarted) restarted_workers.push_back(worker_names[i]);
+  }
+  if (restarted_workers.empty()) {
+    mutex_lock l(mu_);
+    needs_worker_recovery_ = false;
+    return OkStatus();
+  }
+
+  LOG(INFO) << "Session " << handle_ << " recovering restarted workers: "
+            << absl::StrJoin(restarted_workers, ", ");
+  {
+    mutex_lock l(mu_);
+    device_incarnations_ = device_incarnations;
+  }
+  if (should_delete_worker_sessions_) {
+    Status s = CreateWorkerSessions(cluster_def_, restarted_workers);
+    if (!s.ok()) {
+      mutex_lock l(mu_);
+      device_incarnations_ = std::move(old_device_incarnations);
+      return s;
+    }
+  }
+
+  // The partitions of every graph embed the incarnations of the devices in
+  // their rendezvous keys, so each graph is partitioned and registered again
+  // on its next use. The other workers keep their worker sessions, and thus
+  // their state.
+  std::vector<ReffedClientGraph*> to_unref;
+  {
+    mutex_lock l(mu_);
+    ClearRunsTable(&to_unref, &run_graphs_);
+    ClearRunsTable(&to_unref, &partial_run_graphs_);
+    for (auto& p : callables_) {
+      ReffedClientGraph* callable = p.second;
+      std::unique_ptr<ClientGraph> client_graph;
+      Status s = execution_state_->BuildGraph(callable->build_graph_options(),
+                                              &client_graph);
+      if (!s.ok()) {
+        LOG(WARNING) << "Could not rebuild callable " << p.first << ": " << s;
+        continue;
+      }
+      p.second = new ReffedClientGraph(
+          handle_, callable->build_graph_options(), std::move(client_graph),
+          session_opts_, stats_publisher_factory_, false /* is_partial */,
+          worker_cache, !should_delete_worker_sessions_);
+      to_unref.push_back(callable);
+    }
+    needs_worker_recovery_ = false;
+  }
+  for (ReffedClientGraph* rcg : to_unref) rcg->Unref();
+  return OkStatus();
+}
+
 Status MasterSession::ListDevices(ListDevicesResponse* resp) const {
   if (worker_cache_) {
     // This is a ClusterSpec-propagated session, and thus env_->local_devices
@@ -1636,6 +1825,7 @@ Status MasterSession::PartialRunSetup(const PartialRunSetupRequest* req,
   BuildGraphOptions opts;
   BuildBuildGraphOptions(*req, &opts);
   int64_t count = 0;
+  TF_RETURN_IF_ERROR(MaybeRecoverWorkers());
   TF_RETURN_IF_ERROR(StartStep(opts, true, &rcg, &count));
 
   rcg->Ref();
@@ -1699,9 +1889,13 @@ Status MasterSession::BuildAndRegisterPartitions(ReffedClientGraph* rcg) {
     Device* d = devices_->FindDeviceByName(name);
     if (d == nullptr) {
       return PartitionOptions::kIllegalIncarnation;
-    } else {
-      return d->attributes().incarnation();
     }
+    mutex_lock l(mu_);
+    auto it = device_incarnations_.find(name);
+    if (it != device_incarnations_.end()) {
+      return it->second;
+    }
+    return d->attributes().incarnation();
   };
   popts.control_flow_added = false;
   const bool enable_bfloat16_sendrecv =
@@ -1722,9 +1916,9 @@ Status MasterSession::BuildAndRegisterPartitions(ReffedClientGraph* rcg) {
     popts.need_to_record_start_times = true;
   }
 
-  TF_RETURN_IF_ERROR(rcg->RegisterPartitions(std::move(popts)));
-
-  return OkStatus();
+  Status s = rcg->RegisterPartitions(std::move(popts));
+  MaybeScheduleWorkerRecovery(s);
+  return s;
 }
 
 Status MasterSession::DoPartialRun(CallOptions* opts,
@@ -1924,6 +2118,7 @@ Status MasterSession::PostRunCleanup(MasterSession::ReffedClientGraph* rcg,
                                      const Status& run_status,
                                      RunMetadata* out_run_metadata) {
   Status s = run_status;
+  MaybeScheduleWorkerRecovery(s);
   if (s.ok()) {
     pss->end_micros = Env::Default()->NowMicros();
     if (rcg->collective_graph_key() !=
@@ -1972,6 +2167,7 @@ Status MasterSession::DoRunWithLocalExecution(
   BuildBuildGraphOptions(req, session_opts_.config, &bgopts);
   ReffedClientGraph* rcg = nullptr;
   int64_t count;
+  TF_RETURN_IF_ERROR(MaybeRecoverWorkers());
   TF_RETURN_IF_ERROR(StartStep(bgopts, false, &rcg, &count));
 
   // Unref "rcg" when out of scope.
@@ -2017,6 +2213,7 @@ Status MasterSession::MakeCallable(const MakeCallableRequest& req,
   opts.callable_options = req.options();
   opts.use_function_convention = false;
 
+  TF_RETURN_IF_ERROR(MaybeRecoverWorkers());
   ReffedClientGraph* callable;
 
   {
@@ -2058,6 +2255,10 @@ Status MasterSession::DoRunCallable(CallOptions* opts, ReffedClientGraph* rcg,
   auto cleanup = gtl::MakeCleanup([this] { MarkRunCompletion(); });
 
   // Prepare.
+  if (elastic_worker_recovery()) {
+    // The callable may have been rebuilt by a worker recovery.
+    TF_RETURN_IF_ERROR(BuildAndRegisterPartitions(rcg));
+  }
   int64_t count = rcg->get_and_increment_execution_count();
 
   const uint64 step_id = NewStepId(rcg->collective_graph_key());
@@ -2082,6 +2283,7 @@ Status MasterSession::RunCallable(CallOptions* opts,
                                   const RunCallableRequest& req,
                                   RunCallableResponse* resp) {
   UpdateLastAccessTime();
+  TF_RETURN_IF_ERROR(MaybeRecoverWorkers());
   ReffedClientGraph* callable;
   {
     mutex_lock l(mu_);
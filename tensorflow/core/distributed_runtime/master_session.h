@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_MASTER_SESSION_H_
 
 #include <atomic>
+#include <unordered_map>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/debugger_state_interface.h"
@@ -29,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/cluster.pb.h"
 #include "tensorflow/core/protobuf/master.pb.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -219,9 +221,40 @@ class MasterSession : public core::RefCounted {
   // workers.
   Status CreateWorkerSessions(const ClusterDef& cluster_def);
 
+  // Creates sessions on the workers in "worker_names" only.
+  Status CreateWorkerSessions(const ClusterDef& cluster_def,
+                              const std::vector<string>& worker_names);
+
   bool should_delete_worker_sessions_ = false;
   Status DeleteWorkerSessions();
 
+  // The cluster membership passed to Create(), which is propagated again to
+  // restarted workers.
+  ClusterDef cluster_def_;
+
+  // Elastic worker recovery (see
+  // ConfigProto.Experimental.enable_elastic_worker_recovery).
+  bool elastic_worker_recovery() const;
+
+  // In elastic mode, schedules a recovery before the next step if "s"
+  // indicates that a worker is unreachable or has restarted.
+  void MaybeScheduleWorkerRecovery(const Status& s);
+
+  // If a recovery is scheduled, finds the workers whose devices changed
+  // incarnation, creates worker sessions on them, and discards the graphs
+  // registered by this session so that they are partitioned and registered
+  // again with the new incarnations. Returns an error (and keeps the
+  // recovery scheduled) if a worker is still unreachable.
+  Status MaybeRecoverWorkers();
+
+  // Serializes recoveries.
+  mutex recovery_mu_;
+  bool needs_worker_recovery_ TF_GUARDED_BY(mu_) = false;
+
+  // The current incarnation of the devices of restarted workers, which
+  // supersedes the one in `devices_`.
+  std::unordered_map<string, int64_t> device_incarnations_ TF_GUARDED_BY(mu_);
+
   Status StartStep(const BuildGraphOptions& opts, bool is_partial,
                    ReffedClientGraph** out_rcg, int64_t* out_count);
   void ClearRunsTable(std::vector<ReffedClientGraph*>* to_unref,
@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_client.h"
 
+#include <memory>
 #include <string>
 
 #include "grpcpp/generic/generic_stub.h"
 #include "tensorflow/core/distributed_runtime/call_options.h"
+#include "tensorflow/core/distributed_runtime/eager/enqueue_batcher.h"
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_service.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_state.h"
@@ -72,6 +74,24 @@ bool EnableStreaming() {
   return result;
 }
 
+// Setting "TF_EAGER_STREAMING_ENQUEUE_BATCH_WINDOW_US" to a positive value
+// batches the streaming enqueue requests sent to a worker within that many
+// microseconds into a single request, see EnqueueBatcher. A batch is sent
+// early once it holds "TF_EAGER_STREAMING_ENQUEUE_MAX_BATCH_SIZE" queue items.
+int64_t StreamingEnqueueBatchWindowMicros() {
+  int64_t result;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_STREAMING_ENQUEUE_BATCH_WINDOW_US",
+                                  0, &result));
+  return result;
+}
+
+int64_t StreamingEnqueueMaxBatchSize() {
+  int64_t result;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_STREAMING_ENQUEUE_MAX_BATCH_SIZE",
+                                  128, &result));
+  return result;
+}
+
 // Ref-counted thread to handle callbacks for completed requests a GRPC
 // completion queue. The thread might be shared by multiple eager clients, and
 // each one of them should hold a reference count to ensure that the thread
@@ -122,6 +142,17 @@ class GrpcEagerClient : public EagerClient {
     // outlives the client.
     thread_->Ref();
     cq_ = thread->completion_queue();
+    const int64_t batch_window_micros = StreamingEnqueueBatchWindowMicros();
+    if (EnableStreaming() && batch_window_micros > 0) {
+      enqueue_batcher_ = std::make_unique<EnqueueBatcher>(
+          batch_window_micros, StreamingEnqueueMaxBatchSize(),
+          [this](const EnqueueRequest& request, EnqueueResponse* response,
+                 StatusCallback done) {
+            mutex_lock l(mu_);
+            EnqueueDispatcherLocked(request.context_id())
+                .SendNextRequest(request, response, std::move(done));
+          });
+    }
   }
   ~GrpcEagerClient() override { thread_->Unref(); }
 
@@ -143,11 +174,25 @@ class GrpcEagerClient : public EagerClient {
 
   CLIENT_METHOD(CreateContext);
   CLIENT_METHOD(UpdateContext);
-  CLIENT_METHOD(WaitQueueDone);
   CLIENT_METHOD(KeepAlive);
 
 #undef CLIENT_METHOD
 
+  void WaitQueueDoneAsync(const WaitQueueDoneRequest* request,
+                          WaitQueueDoneResponse* response,
+                          StatusCallback done) override {
+    // Batched requests must reach the remote queue before it is waited on.
+    if (enqueue_batcher_ != nullptr) {
+      enqueue_batcher_->Flush(request->context_id());
+    }
+    StatusCallback done_wrapped = callback_wrapper(std::move(done));
+    new RPCState<protobuf::Message>(
+        &stub_, cq_, "/tensorflow.eager.EagerService/WaitQueueDone", *request,
+        response, std::move(done_wrapped), /*call_opts=*/nullptr,
+        /*threadpool=*/nullptr, /*max_retries=*/0, /*fail_fast=*/true,
+        &target_);
+  }
+
 #define CLIENT_CANCELABLE_METHOD(method)                                      \
   void method##Async(CallOptions* call_opts, const method##Request* request,  \
                      method##Response* response, StatusCallback done)         \
@@ -167,6 +212,9 @@ class GrpcEagerClient : public EagerClient {
   void CloseContextAsync(const CloseContextRequest* request,
                          CloseContextResponse* response,
                          StatusCallback done) override {
+    if (enqueue_batcher_ != nullptr) {
+      enqueue_batcher_->Flush(request->context_id());
+    }
     StatusCallback done_wrapped = callback_wrapper(std::move(done));
     new RPCState<protobuf::Message>(
         &stub_, cq_, "/tensorflow.eager.EagerService/CloseContext", *request,
@@ -199,20 +247,19 @@ class GrpcEagerClient : public EagerClient {
     // 2. The flag set in the eager executor.
     // Streaming enqueue is allowed only when the both are enabled.
     if (EnableStreaming() && enable_streaming_enqueue) {
-      mutex_lock l(mu_);
-      auto it = enqueue_dispatchers_.find(request->context_id());
-      if (it == enqueue_dispatchers_.end()) {
-        auto it_and_bool = enqueue_dispatchers_.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(request->context_id()),
-            std::forward_as_tuple(
-                &stub_, cq_,
-                "/tensorflow.eager.EagerService/StreamingEnqueue"));
-        it = it_and_bool.first;
+      if (enqueue_batcher_ != nullptr) {
+        enqueue_batcher_->Add(*request, response, std::move(done_wrapped));
+        return;
       }
+      mutex_lock l(mu_);
       // TODO(haoyuzhang): Consider supporting cancellation for streaming RPC?
-      it->second.SendNextRequest(*request, response, std::move(done_wrapped));
+      EnqueueDispatcherLocked(request->context_id())
+          .SendNextRequest(*request, response, std::move(done_wrapped));
     } else {
+      // Keep the order with streaming requests that are still batched.
+      if (enqueue_batcher_ != nullptr) {
+        enqueue_batcher_->Flush(request->context_id());
+      }
       Notification n;
       Status status;
       EnqueueAsync(call_opts, request, response,
@@ -237,6 +284,25 @@ class GrpcEagerClient : public EagerClient {
   std::unordered_map<uint64, StreamingRPCDispatcher<EnqueueResponse>>
       enqueue_dispatchers_ TF_GUARDED_BY(mu_);
 
+  // Set if streaming enqueue requests are batched. Must not be called with
+  // `mu_` held, since it sends batches through `enqueue_dispatchers_`.
+  std::unique_ptr<EnqueueBatcher> enqueue_batcher_;
+
+  StreamingRPCDispatcher<EnqueueResponse>& EnqueueDispatcherLocked(
+      uint64 context_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    auto it = enqueue_dispatchers_.find(context_id);
+    if (it == enqueue_dispatchers_.end()) {
+      it = enqueue_dispatchers_
+               .emplace(std::piecewise_construct,
+                        std::forward_as_tuple(context_id),
+                        std::forward_as_tuple(
+                            &stub_, cq_,
+                            "/tensorflow.eager.EagerService/StreamingEnqueue"))
+               .first;
+    }
+    return it->second;
+  }
+
   StatusCallback callback_wrapper(StatusCallback done) {
     Ref();
     return [this, done = std::move(done)](const Status& status) {
@@ -0,0 +1,81 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/rpc/grpc_encoded_tensor_cache.h"
+
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
+
+namespace tensorflow {
+
+GrpcEncodedTensorCache::GrpcEncodedTensorCache(int64_t window_micros,
+                                               int64_t max_bytes, Env* env)
+    : window_micros_(window_micros), max_bytes_(max_bytes), env_(env) {}
+
+void GrpcEncodedTensorCache::EncodeTensorToByteBuffer(
+    bool is_dead, const Tensor& val, bool require_ack,
+    RecvTensorPayloadCodec codec, ::grpc::ByteBuffer* result) {
+  // Dead and empty tensors have no buffer to identify them by.
+  if (is_dead || !val.IsInitialized() || val.NumElements() == 0) {
+    grpc::EncodeTensorToByteBuffer(is_dead, val, require_ack, codec, result);
+    return;
+  }
+  Key key{DMAHelper::base(&val), val.dtype(), val.shape().dim_sizes(),
+          require_ack, codec};
+  const int64_t now_micros = env_->NowMicros();
+  {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end() && it->second.expiration_micros > now_micros) {
+      ++num_hits_;
+      // Copying a ByteBuffer only references its slices.
+      *result = it->second.encoded;
+      return;
+    }
+  }
+
+  // Concurrent misses for the same tensor may encode it more than once, but
+  // only the first encoding is cached.
+  grpc::EncodeTensorToByteBuffer(is_dead, val, require_ack, codec, result);
+  const int64_t num_bytes = result->Length();
+  if (num_bytes > max_bytes_) return;
+
+  mutex_lock l(mu_);
+  EvictLocked(now_micros);
+  if (entries_.contains(key)) return;
+  entries_.emplace(key, Entry{val, *result, now_micros + window_micros_});
+  insertion_order_.push_back(std::move(key));
+  cached_bytes_ += num_bytes;
+  EvictLocked(now_micros);
+}
+
+void GrpcEncodedTensorCache::EvictLocked(int64_t now_micros) {
+  while (!insertion_order_.empty()) {
+    auto it = entries_.find(insertion_order_.front());
+    if (it->second.expiration_micros > now_micros &&
+        cached_bytes_ <= max_bytes_) {
+      break;
+    }
+    cached_bytes_ -= it->second.encoded.Length();
+    entries_.erase(it);
+    insertion_order_.pop_front();
+  }
+}
+
+int64_t GrpcEncodedTensorCache::num_hits() const {
+  mutex_lock l(mu_);
+  return num_hits_;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,108 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_ENCODED_TENSOR_CACHE_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_ENCODED_TENSOR_CACHE_H_
+
+#include <deque>
+
+#include "grpcpp/impl/codegen/byte_buffer.h"
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+// Caches the encoded RecvTensor responses of recently sent tensors, so that a
+// tensor that is read by many receivers (e.g. a variable on a parameter
+// server that all workers read in the same step) is encoded once, and every
+// receiver is sent the same refcounted slices.
+//
+// Responses are keyed by the identity of the tensor's buffer, together with
+// its type, shape and encoding options. Each entry holds a reference to the
+// tensor, so the buffer cannot be reused for another value while it is
+// cached, and resource variable updates copy the buffer instead of modifying
+// it in place. Legacy reference variables are however updated in place: a
+// receiver may be sent a value that is up to `window_micros` old.
+//
+// This class is thread-safe.
+class GrpcEncodedTensorCache {
+ public:
+  // Entries expire `window_micros` after they were added, and the oldest
+  // entries are evicted when the cached responses hold more than `max_bytes`.
+  GrpcEncodedTensorCache(int64_t window_micros, int64_t max_bytes,
+                         Env* env = Env::Default());
+
+  // Like grpc::EncodeTensorToByteBuffer(), but shares the encoding of `val`
+  // with the earlier calls for the same tensor.
+  void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
+                                bool require_ack, RecvTensorPayloadCodec codec,
+                                ::grpc::ByteBuffer* result);
+
+  // Number of calls to EncodeTensorToByteBuffer() served from the cache.
+  int64_t num_hits() const;
+
+ private:
+  struct Key {
+    const void* data;
+    DataType dtype;
+    gtl::InlinedVector<int64_t, 4> dims;
+    bool require_ack;
+    RecvTensorPayloadCodec codec;
+
+    bool operator==(const Key& other) const {
+      return data == other.data && dtype == other.dtype &&
+             dims == other.dims && require_ack == other.require_ack &&
+             codec == other.codec;
+    }
+    template <typename H>
+    friend H AbslHashValue(H h, const Key& key) {
+      h = H::combine(std::move(h), key.data, key.dtype, key.require_ack,
+                     key.codec);
+      return H::combine_contiguous(std::move(h), key.dims.data(),
+                                   key.dims.size());
+    }
+  };
+
+  struct Entry {
+    // Pins the buffer that the entry's key refers to.
+    Tensor tensor;
+    ::grpc::ByteBuffer encoded;
+    int64_t expiration_micros;
+  };
+
+  // Removes the expired entries and the oldest entries beyond `max_bytes_`.
+  void EvictLocked(int64_t now_micros) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64_t window_micros_;
+  const int64_t max_bytes_;
+  Env* const env_;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<Key, Entry> entries_ TF_GUARDED_BY(mu_);
+  // Keys of `entries_` in insertion order, which is also expiration order.
+  std::deque<Key> insertion_order_ TF_GUARDED_BY(mu_);
+  int64_t cached_bytes_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_hits_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GrpcEncodedTensorCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_ENCODED_TENSOR_CACHE_H_
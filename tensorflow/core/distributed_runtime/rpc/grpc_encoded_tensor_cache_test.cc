@@ -0,0 +1,104 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/rpc/grpc_encoded_tensor_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "grpcpp/support/byte_buffer.h"
+#include "grpcpp/support/slice.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+namespace {
+
+std::string Flatten(const ::grpc::ByteBuffer& buf) {
+  std::vector<::grpc::Slice> slices;
+  (void)buf.Dump(&slices);
+  std::string result;
+  for (const auto& s : slices) {
+    result.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+  return result;
+}
+
+TEST(GrpcEncodedTensorCacheTest, SharesEncodingOfSameTensor) {
+  GrpcEncodedTensorCache cache(/*window_micros=*/60 * 1000 * 1000,
+                               /*max_bytes=*/1 << 20);
+  Tensor t = test::AsTensor<float>({1, 2, 3, 4});
+  Tensor alias = t;
+  ::grpc::ByteBuffer first, second;
+  cache.EncodeTensorToByteBuffer(false, t, false, PAYLOAD_CODEC_NONE, &first);
+  cache.EncodeTensorToByteBuffer(false, alias, false, PAYLOAD_CODEC_NONE,
+                                 &second);
+  EXPECT_EQ(cache.num_hits(), 1);
+  EXPECT_EQ(Flatten(first), Flatten(second));
+
+  RecvTensorResponse response;
+  ASSERT_TRUE(response.ParseFromString(Flatten(second)));
+  Tensor decoded;
+  ASSERT_TRUE(decoded.FromProto(response.tensor()));
+  test::ExpectTensorEqual<float>(t, decoded);
+}
+
+TEST(GrpcEncodedTensorCacheTest, DistinguishesTensorsAndOptions) {
+  GrpcEncodedTensorCache cache(/*window_micros=*/60 * 1000 * 1000,
+                               /*max_bytes=*/1 << 20);
+  Tensor t = test::AsTensor<float>({1, 2, 3, 4});
+  Tensor copy = test::AsTensor<float>({1, 2, 3, 4});
+  Tensor reshaped;
+  ASSERT_TRUE(reshaped.CopyFrom(t, TensorShape({2, 2})));
+  ::grpc::ByteBuffer buf;
+  cache.EncodeTensorToByteBuffer(false, t, false, PAYLOAD_CODEC_NONE, &buf);
+  cache.EncodeTensorToByteBuffer(false, copy, false, PAYLOAD_CODEC_NONE, &buf);
+  cache.EncodeTensorToByteBuffer(false, reshaped, false, PAYLOAD_CODEC_NONE,
+                                 &buf);
+  cache.EncodeTensorToByteBuffer(false, t, true, PAYLOAD_CODEC_NONE, &buf);
+  cache.EncodeTensorToByteBuffer(true, t, false, PAYLOAD_CODEC_NONE, &buf);
+  EXPECT_EQ(cache.num_hits(), 0);
+}
+
+TEST(GrpcEncodedTensorCacheTest, EvictsBeyondMaxBytes) {
+  Tensor t1(DT_FLOAT, TensorShape({256}));
+  Tensor t2(DT_FLOAT, TensorShape({256}));
+  t1.flat<float>().setZero();
+  t2.flat<float>().setZero();
+  // Room for a single encoded tensor.
+  GrpcEncodedTensorCache cache(/*window_micros=*/60 * 1000 * 1000,
+                               /*max_bytes=*/1500);
+  ::grpc::ByteBuffer buf;
+  cache.EncodeTensorToByteBuffer(false, t1, false, PAYLOAD_CODEC_NONE, &buf);
+  cache.EncodeTensorToByteBuffer(false, t2, false, PAYLOAD_CODEC_NONE, &buf);
+  cache.EncodeTensorToByteBuffer(false, t2, false, PAYLOAD_CODEC_NONE, &buf);
+  EXPECT_EQ(cache.num_hits(), 1);
+  cache.EncodeTensorToByteBuffer(false, t1, false, PAYLOAD_CODEC_NONE, &buf);
+  EXPECT_EQ(cache.num_hits(), 1);
+}
+
+TEST(GrpcEncodedTensorCacheTest, EntriesExpire) {
+  GrpcEncodedTensorCache cache(/*window_micros=*/1000, /*max_bytes=*/1 << 20);
+  Tensor t = test::AsTensor<float>({1, 2, 3, 4});
+  ::grpc::ByteBuffer buf;
+  cache.EncodeTensorToByteBuffer(false, t, false, PAYLOAD_CODEC_NONE, &buf);
+  Env::Default()->SleepForMicroseconds(10 * 1000);
+  cache.EncodeTensorToByteBuffer(false, t, false, PAYLOAD_CODEC_NONE, &buf);
+  EXPECT_EQ(cache.num_hits(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_remote_worker.h"
 
+#include <atomic>
 #include <utility>
 
 #include "grpcpp/generic/generic_stub.h"
 #include "grpcpp/grpcpp.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
@@ -31,8 +33,11 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
@@ -40,6 +45,22 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+// Returns true iff RunGraph requests should be sent on a StreamingRunGraph
+// stream, when possible.
+bool UseStreamingRunGraph() {
+  static const bool use_streaming = [] {
+    bool value = false;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_GRPC_WORKER_STREAMING_RUN_GRAPH", false, &value));
+    return value;
+  }();
+  return use_streaming;
+}
+
+}  // namespace
+
 class GrpcRemoteWorker : public WorkerInterface {
  public:
   explicit GrpcRemoteWorker(SharedGrpcChannelPtr channel,
@@ -66,6 +87,9 @@ class GrpcRemoteWorker : public WorkerInterface {
         instancesource_(Method(GrpcWorkerMethod::kCompleteInstance)),
         getstepsequence_(Method(GrpcWorkerMethod::kGetStepSequence)),
         markrecvfinished_(Method(GrpcWorkerMethod::kMarkRecvFinished)),
+        recvtensorbatch_(Method(GrpcWorkerMethod::kRecvTensorBatch)),
+        streamingrungraph_(Method(GrpcWorkerMethod::kStreamingRunGraph)),
+        rungraph_stream_(&stub_, cq_, streamingrungraph_),
         logger_(logger),
         target_(target) {}
 
@@ -111,6 +135,12 @@ class GrpcRemoteWorker : public WorkerInterface {
   void RunGraphAsync(CallOptions* call_opts, RunGraphRequestWrapper* request,
                      MutableRunGraphResponseWrapper* response,
                      StatusCallback done) override {
+    if (AcquireRunGraphStream(call_opts)) {
+      StreamRunGraph(call_opts, request->ToProto(),
+                     get_proto_from_wrapper(response), std::move(done),
+                     /*force_template=*/false);
+      return;
+    }
     IssueRequest(&request->ToProto(), get_proto_from_wrapper(response),
                  rungraph_, std::move(done), call_opts);
   }
@@ -256,6 +286,29 @@ class GrpcRemoteWorker : public WorkerInterface {
     IssueRequest(request, response, recvtensor_, callback, call_opts);
   }
 
+  void RecvTensorBatchAsync(CallOptions* call_opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override {
+    VLOG(1) << "RecvTensorBatchAsync req: " << request->requests_size()
+            << " tensors";
+    auto callback = [this, request, response, done](Status s) {
+      if (s.ok()) {
+        for (int i = 0; i < response->responses_size() &&
+                        i < request->requests_size();
+             ++i) {
+          if (response->responses(i).require_ack()) {
+            IssueMarkRecvFinishedRequest(request->requests(i).request_id());
+          }
+        }
+      }
+      // Note done() can delete this worker object, so we need to call done()
+      // last.
+      done(s);
+    };
+    IssueRequest(request, response, recvtensorbatch_, callback, call_opts);
+  }
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override {
     IssueRequest(request, response, logging_, done);
@@ -299,6 +352,103 @@ class GrpcRemoteWorker : public WorkerInterface {
     IssueRequest(&request, response, markrecvfinished_, done);
   }
 
+  // Returns true if the next RunGraph request may be sent on
+  // `rungraph_stream_`, in which case the caller must call
+  // `ReleaseRunGraphStream()` when it completes. The stream carries at most
+  // one request at a time: the worker serves the requests of a stream in
+  // order, so queueing the RunGraph of one step behind that of another
+  // could deadlock steps that depend on each other.
+  bool AcquireRunGraphStream(CallOptions* call_opts) {
+    if (!UseStreamingRunGraph() || rungraph_stream_unsupported_ ||
+        (call_opts != nullptr && call_opts->GetTimeout() > 0)) {
+      return false;
+    }
+    return !rungraph_stream_busy_.exchange(true);
+  }
+
+  void ReleaseRunGraphStream() { rungraph_stream_busy_ = false; }
+
+  // Sends `request` on `rungraph_stream_`, delta-encoded against the template
+  // last sent for the same graph unless `force_template` is true.
+  void StreamRunGraph(CallOptions* call_opts, const RunGraphRequest& request,
+                      RunGraphResponse* response, StatusCallback done,
+                      bool force_template) {
+    auto* stream_request = new StreamingRunGraphRequest;
+    auto* stream_response = new StreamingRunGraphResponse;
+    RunGraphRequest* run_template = stream_request->mutable_request();
+    *run_template = request;
+    run_template->clear_step_id();
+    run_template->clear_send();
+    run_template->clear_request_id();
+    string serialized;
+    SerializeToStringDeterministic(*run_template, &serialized);
+    const uint64 template_id = Fingerprint64(serialized);
+    bool is_template = force_template;
+    {
+      mutex_lock l(rungraph_templates_mu_);
+      is_template |= rungraph_templates_.insert(template_id).second;
+    }
+    if (!is_template) stream_request->clear_request();
+    stream_request->set_template_id(template_id);
+    stream_request->set_is_template(is_template);
+    stream_request->mutable_request()->set_step_id(request.step_id());
+    *stream_request->mutable_request()->mutable_send() = request.send();
+    stream_request->mutable_request()->set_request_id(request.request_id());
+
+    if (call_opts != nullptr) {
+      call_opts->SetCancelCallback([this]() { rungraph_stream_.CancelCall(); });
+    }
+    rungraph_stream_.SendNextRequest(
+        *stream_request, stream_response,
+        [this, call_opts, &request, response, stream_request, stream_response,
+         template_id, is_template, done = std::move(done)](const Status& s) {
+          if (call_opts != nullptr) call_opts->ClearCancelCallback();
+          if (s.ok() && stream_response->unknown_template() && !is_template) {
+            // The worker no longer knows the template, e.g. because it was
+            // restarted. Resend the complete request.
+            delete stream_request;
+            delete stream_response;
+            StreamRunGraph(call_opts, request, response, done,
+                           /*force_template=*/true);
+            return;
+          }
+          if (!s.ok() || stream_response->unknown_template()) {
+            {
+              mutex_lock l(rungraph_templates_mu_);
+              rungraph_templates_.erase(template_id);
+            }
+            delete stream_request;
+            delete stream_response;
+            ReleaseRunGraphStream();
+            if (errors::IsUnimplemented(s)) {
+              // The worker does not serve StreamingRunGraph, so it did not
+              // run the request.
+              rungraph_stream_unsupported_ = true;
+              IssueRequest(&request, response, rungraph_, done,
+                           call_opts);
+              return;
+            }
+            done(s.ok() ? errors::Internal("Unknown RunGraph template")
+                        : s);
+            return;
+          }
+          *response = std::move(*stream_response->mutable_response());
+          delete stream_request;
+          delete stream_response;
+          ReleaseRunGraphStream();
+          // The worker always returns errors in the response body.
+          Status status;
+          if (!request.store_errors_in_response_body() &&
+              response->status_code() != error::OK) {
+            status = Status(static_cast<error::Code>(response->status_code()),
+                            response->status_error_message());
+            response->clear_status_code();
+            response->clear_status_error_message();
+          }
+          done(status);
+        });
+  }
+
   // Helper function for initializing the RpcMethod objects below.
   const char* Method(GrpcWorkerMethod id) { return GrpcWorkerMethodName(id); }
 
@@ -331,6 +481,17 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::string instancesource_;
   const ::grpc::string getstepsequence_;
   const ::grpc::string markrecvfinished_;
+  const ::grpc::string recvtensorbatch_;
+  const ::grpc::string streamingrungraph_;
+
+  // Long-lived stream for RunGraph requests, see UseStreamingRunGraph().
+  StreamingRPCDispatcher<StreamingRunGraphResponse> rungraph_stream_;
+  std::atomic<bool> rungraph_stream_busy_{false};
+  std::atomic<bool> rungraph_stream_unsupported_{false};
+  mutex rungraph_templates_mu_;
+  // Ids of the templates sent on `rungraph_stream_`.
+  absl::flat_hash_set<uint64> rungraph_templates_
+      TF_GUARDED_BY(rungraph_templates_mu_);
 
   // Support for logging.
   WorkerCacheLogger* logger_;
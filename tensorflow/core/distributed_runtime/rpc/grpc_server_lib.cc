@@ -23,6 +23,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "grpcpp/grpcpp.h"
 #include "grpcpp/security/credentials.h"
 #include "grpcpp/server_builder.h"
@@ -45,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 #include "tensorflow/core/distributed_runtime/rpc_collective_executor_mgr.h"
 #include "tensorflow/core/distributed_runtime/server_lib.h"
+#include "tensorflow/core/distributed_runtime/tensor_transport.h"
 #include "tensorflow/core/distributed_runtime/worker_cache_wrapper.h"
 #include "tensorflow/core/distributed_runtime/worker_env.h"
 #include "tensorflow/core/framework/op.h"
@@ -95,6 +97,18 @@ RendezvousMgrInterface* NewRpcRendezvousMgr(const WorkerEnv* env) {
   return new RpcRendezvousMgr(env);
 }
 
+// Servers started with the "grpc+<name>" protocol send RecvTensor payloads
+// through the tensor transport registered under <name>.
+constexpr char kGrpcProtocol[] = "grpc";
+constexpr char kTensorTransportProtocolPrefix[] = "grpc+";
+
+// Returns the name of the tensor transport selected by `protocol`, or an
+// empty string if `protocol` does not select one.
+std::string TensorTransportName(const std::string& protocol) {
+  if (!absl::StartsWith(protocol, kTensorTransportProtocolPrefix)) return "";
+  return protocol.substr(strlen(kTensorTransportProtocolPrefix));
+}
+
 }  // namespace
 
 GrpcServer::GrpcServer(const ServerDef& server_def, Env* env)
@@ -216,6 +230,14 @@ Status GrpcServer::Init(const GrpcServerOptions& opts) {
   master_env_.experimental_num_shards = std::max(1, num_tasks);
   worker_env_.experimental_num_shards = master_env_.experimental_num_shards;
 
+  const std::string tensor_transport_name =
+      TensorTransportName(server_def_.protocol());
+  if (!tensor_transport_name.empty()) {
+    TF_RETURN_IF_ERROR(TensorTransport::Create(
+        tensor_transport_name, &worker_env_, &tensor_transport_));
+    worker_env_.tensor_transport = tensor_transport_.get();
+  }
+
   worker_env_.rendezvous_mgr = opts.rendezvous_mgr_func == nullptr
                                    ? new RpcRendezvousMgr(&worker_env_)
                                    : opts.rendezvous_mgr_func(&worker_env_);
@@ -628,7 +650,11 @@ namespace {
 class GrpcServerFactory : public ServerFactory {
  public:
   bool AcceptsOptions(const ServerDef& server_def) override {
-    return server_def.protocol() == "grpc";
+    if (server_def.protocol() == kGrpcProtocol) return true;
+    const std::string tensor_transport_name =
+        TensorTransportName(server_def.protocol());
+    return !tensor_transport_name.empty() &&
+           TensorTransport::IsRegistered(tensor_transport_name);
   }
 
   Status NewServer(const ServerDef& server_def, const Options& options,
@@ -120,6 +120,75 @@ TEST(GrpcSessionTest, BasicNonProtoAPI) {
   }
 }
 
+TEST(GrpcSessionTest, StreamingRunGraph) {
+  // Inherited by the cluster's servers, whose master runs the graphs.
+  setenv("TF_GRPC_WORKER_STREAMING_RUN_GRAPH", "true", /*overwrite=*/1);
+  GraphDef graph;
+  string node_names[3];
+  // c = a * b
+  CreateGraphDef(&graph, node_names);
+
+  std::unique_ptr<test::TestCluster> cluster;
+  TF_CHECK_OK(test::TestCluster::MakeTestCluster(Devices(1, 0), 2, &cluster));
+  unsetenv("TF_GRPC_WORKER_STREAMING_RUN_GRAPH");
+
+  std::unique_ptr<Session> session(
+      NewRemote(Options(cluster->targets()[0], 1)));
+  ASSERT_TRUE(session != nullptr);
+  TF_CHECK_OK(session->Create(graph));
+  // Later steps only send the changing fields of their RunGraph requests.
+  for (int iters = 0; iters < 10; ++iters) {
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session->Run({}, {node_names[2] + ":0"}, {}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    ASSERT_EQ(4.0, outputs[0].flat<float>()(0));
+  }
+  // A failed step does not end the stream.
+  EXPECT_FALSE(session->Run({}, {"unknown_node:0"}, {}, nullptr).ok());
+  std::vector<Tensor> outputs;
+  TF_CHECK_OK(session->Run({}, {node_names[2] + ":0"}, {}, &outputs));
+  ASSERT_EQ(4.0, outputs[0].flat<float>()(0));
+  TF_CHECK_OK(session->Close());
+}
+
+TEST(GrpcSessionTest, ElasticWorkerRecovery) {
+  GraphDef graph;
+  string node_names[3];
+  // c = a * b
+  CreateGraphDef(&graph, node_names);
+
+  std::unique_ptr<test::TestCluster> cluster;
+  TF_CHECK_OK(test::TestCluster::MakeTestCluster(Devices(1, 0), 2, &cluster));
+
+  SessionOptions options = Options(cluster->targets()[0], 1);
+  options.config.mutable_experimental()->set_enable_elastic_worker_recovery(
+      true);
+  std::unique_ptr<Session> session(NewRemote(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_CHECK_OK(session->Create(graph));
+
+  CallableOptions opts;
+  opts.add_fetch(node_names[2] + ":0");
+  Session::CallableHandle handle;
+  TF_CHECK_OK(session->MakeCallable(opts, &handle));
+  for (int iters = 0; iters < 3; ++iters) {
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+    ASSERT_EQ(1, outputs.size());
+    ASSERT_EQ(4.0, outputs[0].flat<float>()(0));
+  }
+  // A step that fails for another reason than a worker failure does not
+  // trigger a recovery.
+  EXPECT_FALSE(session->Run({}, {"unknown_node:0"}, {}, nullptr).ok());
+  std::vector<Tensor> outputs;
+  TF_CHECK_OK(session->Run({}, {node_names[2] + ":0"}, {}, &outputs));
+  ASSERT_EQ(4.0, outputs[0].flat<float>()(0));
+  TF_CHECK_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+  ASSERT_EQ(4.0, outputs[0].flat<float>()(0));
+  TF_CHECK_OK(session->ReleaseCallable(handle));
+  TF_CHECK_OK(session->Close());
+}
+
 TEST(GrpcSessionTest, BasicCallable) {
   GraphDef graph;
   string node_names[3];
@@ -18,10 +18,13 @@ limitations under the License.
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/distributed_runtime/tensor_payload_codec.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/framework/variant_tensor_data.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/io/proto_encode_helper.h"
 #include "tensorflow/core/platform/env.h"
@@ -39,6 +42,30 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
   result->Swap(&tmp);
 }
 
+void EncodeRecvTensorBatchResponseToByteBuffer(
+    const std::vector<::grpc::ByteBuffer>& responses,
+    ::grpc::ByteBuffer* result) {
+  // Each response is a length-delimited RecvTensorBatchResponse::responses
+  // field: a tag and varint32 length, followed by the (shared) slices of the
+  // encoded RecvTensorResponse.
+  const int kMaxHeaderBytes = 1 + 5;
+  std::vector<::grpc::Slice> slices;
+  for (const ::grpc::ByteBuffer& response : responses) {
+    char header[kMaxHeaderBytes];
+    io::ProtoEncodeHelper e(header, kMaxHeaderBytes);
+    e.WriteVarlengthBeginning(RecvTensorBatchResponse::kResponsesFieldNumber,
+                              response.Length());
+    slices.emplace_back(e.data(), e.size());
+    std::vector<::grpc::Slice> response_slices;
+    (void)response.Dump(&response_slices);
+    for (::grpc::Slice& slice : response_slices) {
+      slices.push_back(std::move(slice));
+    }
+  }
+  ::grpc::ByteBuffer tmp(slices.data(), slices.size());
+  result->Swap(&tmp);
+}
+
 // We generate a RecvTensorResponse protocol buffer encoding into "*result",
 // but where possible, we share the underlying Tensor buffer for "val", to
 // avoid an extra copy.
@@ -134,6 +161,155 @@ static void EncodeSkeleton(const Tensor& val, io::ProtoEncodeHelper* e) {
 #endif
 }
 
+// Returns the size of the TensorProto encoding of the memcpy-able tensor
+// `val`, with its data in the tensor_content field.
+static size_t EncodedTensorProtoSize(const Tensor& val) {
+  gtl::InlinedVector<char, 128> skeleton(SkeletonEncodingSizeUpperBound(val));
+  io::ProtoEncodeHelper e(skeleton.data(), skeleton.size());
+  EncodeSkeleton(val, &e);
+  return e.size() +
+         VarLengthEncodingSize(TensorProto::kTensorContentFieldNumber,
+                               val.tensor_data().size());
+}
+
+// Accumulates a protocol buffer encoding as a sequence of grpc::Slices, in
+// which the data of large tensors shares the backing store of the tensor.
+class SliceEncoder {
+ public:
+  explicit SliceEncoder(size_t large_tensor_bytes)
+      : large_tensor_bytes_(large_tensor_bytes) {}
+
+  void WriteRawBytes(StringPiece bytes) {
+    pending_.append(bytes.data(), bytes.size());
+  }
+
+  void WriteVarlengthBeginning(uint32 tag, uint32 len) {
+    char header[kMaxHeaderBytes];
+    io::ProtoEncodeHelper e(header, kMaxHeaderBytes);
+    e.WriteVarlengthBeginning(tag, len);
+    pending_.append(e.data(), e.size());
+  }
+
+  void WriteString(uint32 tag, StringPiece value) {
+    WriteVarlengthBeginning(tag, value.size());
+    pending_.append(value.data(), value.size());
+  }
+
+  // Writes the TensorProto encoding of the memcpy-able tensor `val`, as
+  // field `tag`.
+  void WriteTensor(uint32 tag, const Tensor& val) {
+    gtl::InlinedVector<char, 128> skeleton(
+        SkeletonEncodingSizeUpperBound(val));
+    io::ProtoEncodeHelper e_skeleton(skeleton.data(), skeleton.size());
+    EncodeSkeleton(val, &e_skeleton);
+    WriteVarlengthBeginning(tag, EncodedTensorProtoSize(val));
+    pending_.append(e_skeleton.data(), e_skeleton.size());
+
+    StringPiece tdata = val.tensor_data();
+    WriteVarlengthBeginning(TensorProto::kTensorContentFieldNumber,
+                            tdata.size());
+    if (tdata.size() <= large_tensor_bytes_) {
+      pending_.append(tdata.data(), tdata.size());
+      return;
+    }
+    Flush();
+    const TensorBuffer* buf = DMAHelper::buffer(&val);
+    buf->Ref();
+    slices_.emplace_back(
+        const_cast<void*>(static_cast<const void*>(tdata.data())),
+        tdata.size(),
+        [](void* backing) { static_cast<TensorBuffer*>(backing)->Unref(); },
+        const_cast<TensorBuffer*>(buf));
+  }
+
+  size_t Finish(::grpc::ByteBuffer* result) {
+    Flush();
+    size_t total_bytes = 0;
+    for (const ::grpc::Slice& slice : slices_) total_bytes += slice.size();
+    ::grpc::ByteBuffer tmp(slices_.data(), slices_.size());
+    result->Swap(&tmp);
+    return total_bytes;
+  }
+
+ private:
+  static constexpr int kMaxHeaderBytes = 2 + 5;
+
+  void Flush() {
+    if (pending_.empty()) return;
+    slices_.emplace_back(pending_.data(), pending_.size());
+    pending_.clear();
+  }
+
+  const size_t large_tensor_bytes_;
+  string pending_;
+  std::vector<::grpc::Slice> slices_;
+};
+
+// Encodes the DT_VARIANT tensor `val` into "*result" without building the
+// TensorProto of its elements, when every element encodes into memcpy-able
+// tensors only (e.g. RaggedTensorVariant). Returns false otherwise.
+//
+// The encoding parses as the TensorProto that val.AsProtoTensorContent()
+// produces, except that the tensors inside variant_val keep their data in
+// tensor_content.
+static bool EncodeVariantTensorToByteBuffer(const RecvTensorResponse& response,
+                                            const Tensor& val,
+                                            size_t large_tensor_bytes,
+                                            ::grpc::ByteBuffer* result) {
+  const int64_t num_elements = val.NumElements();
+  const auto elements = val.flat<Variant>();
+  std::vector<VariantTensorData> encoded(num_elements);
+  std::vector<size_t> encoded_sizes(num_elements);
+  gtl::InlinedVector<char, 128> skeleton(SkeletonEncodingSizeUpperBound(val));
+  io::ProtoEncodeHelper e_skeleton(skeleton.data(), skeleton.size());
+  EncodeSkeleton(val, &e_skeleton);
+  size_t tensor_proto_bytes = e_skeleton.size();
+  for (int64_t i = 0; i < num_elements; ++i) {
+    VariantTensorData& data = encoded[i];
+    elements(i).Encode(&data);
+    size_t size =
+        VarLengthEncodingSize(VariantTensorDataProto::kTypeNameFieldNumber,
+                              data.type_name().size()) +
+        VarLengthEncodingSize(VariantTensorDataProto::kMetadataFieldNumber,
+                              data.metadata_string().size());
+    for (const Tensor& tensor : data.tensors()) {
+      if (!DataTypeCanUseMemcpy(tensor.dtype())) return false;
+      size += VarLengthEncodingSize(VariantTensorDataProto::kTensorsFieldNumber,
+                                    EncodedTensorProtoSize(tensor));
+    }
+    encoded_sizes[i] = size;
+    tensor_proto_bytes +=
+        VarLengthEncodingSize(TensorProto::kVariantValFieldNumber, size);
+  }
+  if (tensor_proto_bytes > static_cast<size_t>(kint32max)) return false;
+
+  string header;  // All of RecvTensorResponse except the tensor() field
+  response.AppendToString(&header);
+  SliceEncoder e(large_tensor_bytes);
+  e.WriteRawBytes(header);
+  e.WriteVarlengthBeginning(RecvTensorResponse::kTensorFieldNumber,
+                            tensor_proto_bytes);
+  e.WriteRawBytes(StringPiece(e_skeleton.data(), e_skeleton.size()));
+  for (int64_t i = 0; i < num_elements; ++i) {
+    const VariantTensorData& data = encoded[i];
+    e.WriteVarlengthBeginning(TensorProto::kVariantValFieldNumber,
+                              encoded_sizes[i]);
+    e.WriteString(VariantTensorDataProto::kTypeNameFieldNumber,
+                  data.type_name());
+    e.WriteString(VariantTensorDataProto::kMetadataFieldNumber,
+                  data.metadata_string());
+    for (const Tensor& tensor : data.tensors()) {
+      e.WriteTensor(VariantTensorDataProto::kTensorsFieldNumber, tensor);
+    }
+  }
+  const size_t total_bytes = e.Finish(result);
+  CHECK_EQ(total_bytes,
+           header.size() +
+               VarLengthEncodingSize(RecvTensorResponse::kTensorFieldNumber,
+                                     tensor_proto_bytes));
+  return true;
+}
+
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
                               ::grpc::ByteBuffer* result) {
   const int kLargeTensorBytes = 1024;
@@ -152,6 +328,11 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
   }
   response.set_require_ack(require_ack);
   response.set_send_start_micros(Env::Default()->NowMicros());
+  if (val.dtype() == DT_VARIANT &&
+      EncodeVariantTensorToByteBuffer(response, val, kLargeTensorBytes,
+                                      result)) {
+    return;
+  }
   if (!DataTypeCanUseMemcpy(val.dtype())) {
     // Straightforward but slow path for complicated kinds of tensor data
     // TODO(jeff,sanjay): If this becomes an issue, we could
@@ -249,5 +430,25 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
   }
 }
 
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+                              RecvTensorPayloadCodec codec,
+                              ::grpc::ByteBuffer* result) {
+  std::string encoded;
+  if (is_dead || codec == PAYLOAD_CODEC_NONE ||
+      !EncodeTensorPayload(codec, val, &encoded)) {
+    EncodeTensorToByteBuffer(is_dead, val, require_ack, result);
+    return;
+  }
+  RecvTensorResponse response;
+  response.set_require_ack(require_ack);
+  response.set_send_start_micros(Env::Default()->NowMicros());
+  response.set_payload_codec(codec);
+  TensorProto* proto = response.mutable_tensor();
+  proto->set_dtype(val.dtype());
+  val.shape().AsProto(proto->mutable_tensor_shape());
+  proto->set_tensor_content(std::move(encoded));
+  EncodeRecvTensorResponseToByteBuffer(response, result);
+}
+
 }  // namespace grpc
 }  // namespace tensorflow
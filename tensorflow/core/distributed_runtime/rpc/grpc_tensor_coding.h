@@ -16,11 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 
+#include <vector>
+
 #include "grpcpp/impl/codegen/byte_buffer.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace tensorflow {
 class Tensor;
-class RecvTensorResponse;
 
 // TODO(jeff,sanjay): this should not be grpc specific.  Instead of
 // grpc::ByteBuffer*, it should accept an object of an interface type
@@ -35,6 +37,16 @@ namespace grpc {
 void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
                                           ::grpc::ByteBuffer* result);
 
+// Encode "responses", each of which holds an encoded RecvTensorResponse
+// (e.g. produced by EncodeTensorToByteBuffer), into a byte buffer in a format
+// that is parseable as a RecvTensorBatchResponse. The slices of "responses"
+// are shared, not copied.
+//
+// Discards original contents of *result.
+void EncodeRecvTensorBatchResponseToByteBuffer(
+    const std::vector<::grpc::ByteBuffer>& responses,
+    ::grpc::ByteBuffer* result);
+
 // Encode a Tensor into a byte buffer in a format that is parseable
 // as a RecvTensorResponse protocol buffer holding "val".
 //
@@ -49,6 +61,13 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
                               ::grpc::ByteBuffer* result);
 
+// Like above, but encodes the tensor content of "val" with "codec" and sets
+// "RecvTensorResponse::payload_codec" accordingly. Falls back to the plain
+// encoding if "codec" does not support "val" or does not shrink its content.
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+                              RecvTensorPayloadCodec codec,
+                              ::grpc::ByteBuffer* result);
+
 }  // namespace grpc
 }  // namespace tensorflow
 
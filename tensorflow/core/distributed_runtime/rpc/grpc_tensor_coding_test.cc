@@ -17,8 +17,13 @@ limitations under the License.
 
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
+#include "tensorflow/core/distributed_runtime/tensor_payload_codec.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/framework/variant_encode_decode.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
@@ -52,6 +57,30 @@ class GrpcTensorCodingTest : public ::testing::Test {
     EXPECT_EQ(t.DebugString(), result_tensor.DebugString());
   }
 
+  RecvTensorResponse EncodeWithCodec(const Tensor& t,
+                                     RecvTensorPayloadCodec codec) {
+    ::grpc::ByteBuffer buf;
+    grpc::EncodeTensorToByteBuffer(false, t, false, codec, &buf);
+    std::vector<::grpc::Slice> slices;
+    (void)buf.Dump(&slices);
+    string tmp;
+    for (const auto& s : slices) {
+      tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+    }
+    RecvTensorResponse response;
+    EXPECT_TRUE(response.ParseFromString(tmp));
+    return response;
+  }
+
+  Tensor Decode(const RecvTensorResponse& response) {
+    Tensor result;
+    TF_EXPECT_OK(DecodeTensorPayload(
+        response.payload_codec(), response.tensor().dtype(),
+        TensorShape(response.tensor().tensor_shape()),
+        response.tensor().tensor_content(), cpu_allocator(), &result));
+    return result;
+  }
+
   template <typename T>
   void DoTest(DataType dt) {
     gtl::InlinedVector<T, 4> v;
@@ -100,4 +129,116 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(GrpcTensorCodingTest, SnappyPayload) {
+  Tensor t(DT_INT64, TensorShape({64, 64}));
+  test::FillFn<int64_t>(&t, [](int i) { return i % 7; });
+  RecvTensorResponse response = EncodeWithCodec(t, PAYLOAD_CODEC_SNAPPY);
+  EXPECT_EQ(response.payload_codec(), PAYLOAD_CODEC_SNAPPY);
+  EXPECT_LT(response.tensor().tensor_content().size(), t.TotalBytes());
+  test::ExpectTensorEqual<int64_t>(Decode(response), t);
+}
+
+TEST_F(GrpcTensorCodingTest, Bfloat16Payload) {
+  Tensor t(DT_FLOAT, TensorShape({32, 8}));
+  // Small integers are exactly representable as bfloat16.
+  test::FillFn<float>(&t, [](int i) { return static_cast<float>(i - 128); });
+  RecvTensorResponse response = EncodeWithCodec(t, PAYLOAD_CODEC_BFLOAT16);
+  EXPECT_EQ(response.payload_codec(), PAYLOAD_CODEC_BFLOAT16);
+  EXPECT_EQ(response.tensor().dtype(), DT_FLOAT);
+  EXPECT_EQ(response.tensor().tensor_content().size(), t.TotalBytes() / 2);
+  test::ExpectTensorEqual<float>(Decode(response), t);
+}
+
+TEST_F(GrpcTensorCodingTest, UnsupportedPayloadCodecFallsBack) {
+  Tensor t(DT_INT32, TensorShape({256}));
+  test::FillIota<int32>(&t, 0);
+  RecvTensorResponse response = EncodeWithCodec(t, PAYLOAD_CODEC_BFLOAT16);
+  EXPECT_EQ(response.payload_codec(), PAYLOAD_CODEC_NONE);
+  Tensor result;
+  EXPECT_TRUE(result.FromProto(response.tensor()));
+  test::ExpectTensorEqual<int32>(result, t);
+
+  // A payload that snappy does not shrink is sent as is.
+  Tensor small(DT_FLOAT, TensorShape({2}));
+  test::FillValues<float>(&small, {1.5f, -2.25f});
+  response = EncodeWithCodec(small, PAYLOAD_CODEC_SNAPPY);
+  EXPECT_EQ(response.payload_codec(), PAYLOAD_CODEC_NONE);
+}
+
+TEST_F(GrpcTensorCodingTest, BatchResponse) {
+  std::vector<Tensor> tensors;
+  tensors.push_back(test::AsTensor<float>({1.0f, 2.0f, 3.0f}));
+  // Large enough to share the tensor buffer instead of copying it.
+  Tensor large(DT_INT32, TensorShape({1024}));
+  test::FillIota<int32>(&large, 0);
+  tensors.push_back(large);
+  tensors.push_back(test::AsTensor<tstring>({"a", "bc"}));
+
+  std::vector<::grpc::ByteBuffer> responses(tensors.size());
+  for (int i = 0; i < tensors.size(); ++i) {
+    grpc::EncodeTensorToByteBuffer(false, tensors[i], true, &responses[i]);
+  }
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeRecvTensorBatchResponseToByteBuffer(responses, &buf);
+  std::vector<::grpc::Slice> slices;
+  (void)buf.Dump(&slices);
+  string tmp;
+  for (const auto& s : slices) {
+    tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+
+  RecvTensorBatchResponse batch;
+  ASSERT_TRUE(batch.ParseFromString(tmp));
+  ASSERT_EQ(batch.responses_size(), tensors.size());
+  for (int i = 0; i < tensors.size(); ++i) {
+    EXPECT_TRUE(batch.responses(i).require_ack());
+    Tensor result;
+    ASSERT_TRUE(result.FromProto(batch.responses(i).tensor()));
+    EXPECT_EQ(result.DebugString(), tensors[i].DebugString());
+  }
+}
+
+TEST_F(GrpcTensorCodingTest, VariantTensor) {
+  // Tensors stored in Variants encode into a single memcpy-able tensor, the
+  // same way as the splits and values of ragged tensors.
+  Tensor large(DT_INT64, TensorShape({512}));
+  test::FillIota<int64_t>(&large, 0);
+  Tensor t(DT_VARIANT, TensorShape({3}));
+  t.flat<Variant>()(0) = test::AsTensor<float>({1.0f, 2.0f});
+  t.flat<Variant>()(1) = large;
+  t.flat<Variant>()(2) = Tensor(DT_INT32, TensorShape({0}));
+  RecvTensorResponse response = EncodeWithCodec(t, PAYLOAD_CODEC_NONE);
+  Tensor result;
+  ASSERT_TRUE(result.FromProto(response.tensor()));
+  ASSERT_EQ(result.dtype(), DT_VARIANT);
+  ASSERT_EQ(result.NumElements(), 3);
+  for (int i = 0; i < 3; ++i) {
+    const Tensor* expected = t.flat<Variant>()(i).get<Tensor>();
+    const Tensor* actual = result.flat<Variant>()(i).get<Tensor>();
+    ASSERT_NE(actual, nullptr);
+    EXPECT_EQ(actual->DebugString(/*num_values=*/1000),
+              expected->DebugString(/*num_values=*/1000));
+  }
+
+  // Variants holding string tensors take the generic encoding.
+  Tensor strings_variant(DT_VARIANT, TensorShape({}));
+  strings_variant.scalar<Variant>()() = test::AsTensor<tstring>({"a", "bc"});
+  response = EncodeWithCodec(strings_variant, PAYLOAD_CODEC_NONE);
+  ASSERT_TRUE(result.FromProto(response.tensor()));
+  EXPECT_EQ(result.scalar<Variant>()().get<Tensor>()->DebugString(),
+            test::AsTensor<tstring>({"a", "bc"}).DebugString());
+}
+
+TEST_F(GrpcTensorCodingTest, CorruptPayloadIsRejected) {
+  Tensor result;
+  EXPECT_FALSE(DecodeTensorPayload(PAYLOAD_CODEC_SNAPPY, DT_INT64,
+                                   TensorShape({8}), "garbage",
+                                   cpu_allocator(), &result)
+                   .ok());
+  EXPECT_FALSE(DecodeTensorPayload(PAYLOAD_CODEC_BFLOAT16, DT_FLOAT,
+                                   TensorShape({8}), "abc", cpu_allocator(),
+                                   &result)
+                   .ok());
+}
+
 }  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <unordered_map>
@@ -23,6 +24,7 @@ limitations under the License.
 #include "grpcpp/alarm.h"
 #include "grpcpp/server_builder.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/buf_rendezvous.h"
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device.h"
@@ -37,6 +39,8 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
+#include "tensorflow/core/distributed_runtime/tensor_payload_codec.h"
+#include "tensorflow/core/distributed_runtime/tensor_transport.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
@@ -149,6 +153,18 @@ class GrpcWorkerServiceThread {
     SETUP_FOR_REQUEST(RunGraph, 100, true);
     SETUP_FOR_REQUEST(CleanupGraph, 100, false);
     SETUP_FOR_REQUEST(MarkRecvFinished, 10, false);
+    // Each StreamingRunGraph call enqueues the next one when it is opened, so
+    // one pending call is enough.
+    {
+      mutex_lock l(shutdown_mu_);
+      if (!is_shutdown_) {
+        StreamingCall<StreamingRunGraphRequest, StreamingRunGraphResponse>::
+            EnqueueRequest(
+                worker_service_, cq_.get(),
+                &grpc::WorkerService::AsyncService::RequestStreamingRunGraph,
+                &GrpcWorkerServiceThread::StreamingRunGraphHandler);
+      }
+    }
 
     // TODO(ncteisen): Determine a better policy for enqueuing the
     // appropriate number of each request type.
@@ -159,13 +175,20 @@ class GrpcWorkerServiceThread {
          ++i) {
       EnqueueRecvTensorRequestRaw();
     }
+    for (int i = 0;
+         i < gtl::FindWithDefault(
+                 queue_depth_,
+                 static_cast<int>(GrpcWorkerMethod::kRecvTensorBatch), 100);
+         ++i) {
+      EnqueueRecvTensorBatchRequestRaw();
+    }
 
     void* tag;
     bool ok;
 
     while (cq_->Next(&tag, &ok)) {
-      tsl::UntypedCall<GrpcWorkerServiceThread>::Tag* callback_tag =
-          static_cast<tsl::UntypedCall<GrpcWorkerServiceThread>::Tag*>(tag);
+      tsl::GrpcCallTag<GrpcWorkerServiceThread>* callback_tag =
+          static_cast<tsl::GrpcCallTag<GrpcWorkerServiceThread>*>(tag);
       CHECK(callback_tag);
       callback_tag->OnCompleted(this, ok);
     }
@@ -186,6 +209,11 @@ class GrpcWorkerServiceThread {
   using WorkerCall =
       tsl::Call<GrpcWorkerServiceThread, grpc::WorkerService::AsyncService,
                 RequestMessage, ResponseMessage>;
+  template <class RequestMessage, class ResponseMessage>
+  using StreamingCall =
+      tsl::ServerBidirectionalStreamingCall<GrpcWorkerServiceThread,
+                                            grpc::WorkerService::AsyncService,
+                                            RequestMessage, ResponseMessage>;
 
   // Handle all non-cancellable simple methods with a standard wrapper.
   // The boolean `may_block_on_compute_pool` indicates whether or not the
@@ -265,6 +293,19 @@ class GrpcWorkerServiceThread {
     ENQUEUE_REQUEST(RunGraph, true);
   }
 
+  // Called for each request received on a StreamingRunGraph stream. The next
+  // request of the stream is only read once the response has been sent, so
+  // `call->request()` stays valid until then.
+  void StreamingRunGraphHandler(
+      StreamingCall<StreamingRunGraphRequest, StreamingRunGraphResponse>*
+          call) {
+    Schedule([this, call]() {
+      worker_->GrpcStreamingRunGraphAsync(&call->request(),
+                                          call->mutable_response(),
+                                          [call]() { call->SendResponse(); });
+    });
+  }
+
   void RecvTensorHandlerRaw(
       WorkerCall<RecvTensorRequest, ::grpc::ByteBuffer>* call) {
     Schedule([this, call]() {
@@ -285,6 +326,26 @@ class GrpcWorkerServiceThread {
     EnqueueRecvTensorRequestRaw();
   }
 
+  void RecvTensorBatchHandlerRaw(
+      WorkerCall<RecvTensorBatchRequest, ::grpc::ByteBuffer>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+
+      worker_->GrpcRecvTensorBatchAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(3) << "Bad response from RecvTensorBatch:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    EnqueueRecvTensorBatchRequestRaw();
+  }
+
   void RecvBufHandler(WorkerCall<RecvBufRequest, RecvBufResponse>* call) {
     Schedule([this, call]() {
       CallOptions* call_opts = new CallOptions;
@@ -354,6 +415,19 @@ class GrpcWorkerServiceThread {
     }
   }
 
+  void EnqueueRecvTensorBatchRequestRaw() {
+    mutex_lock l(shutdown_mu_);
+    if (!is_shutdown_) {
+      tsl::Call<GrpcWorkerServiceThread, grpc::WorkerService::AsyncService,
+                RecvTensorBatchRequest, ::grpc::ByteBuffer>::
+          EnqueueRequestForMethod(
+              worker_service_, cq_.get(),
+              static_cast<int>(GrpcWorkerMethod::kRecvTensorBatch),
+              &GrpcWorkerServiceThread::RecvTensorBatchHandlerRaw,
+              true /* supports cancel*/);
+    }
+  }
+
   GrpcWorker* const worker_ = nullptr;  // Not owned.
   std::unique_ptr<::grpc::ServerCompletionQueue> cq_;
   std::unique_ptr<Thread> thread_;
@@ -429,6 +503,56 @@ GrpcWorker::GrpcWorker(WorkerEnv* worker_env, const ConfigProto& config)
   if (config.rpc_options().cache_rpc_response()) {
     EnableResponseCache();
   }
+  const RPCOptions& rpc_options = config.rpc_options();
+  if (rpc_options.recv_tensor_compression() == "snappy") {
+    recv_tensor_compression_ = PAYLOAD_CODEC_SNAPPY;
+  } else if (!rpc_options.recv_tensor_compression().empty()) {
+    LOG(ERROR) << "Ignoring unsupported RecvTensor compression: "
+               << rpc_options.recv_tensor_compression();
+  }
+  recv_tensor_compression_min_bytes_ =
+      rpc_options.recv_tensor_compression_min_bytes() > 0
+          ? rpc_options.recv_tensor_compression_min_bytes()
+          : 64 << 10;
+  recv_tensor_bfloat16_tensor_names_.assign(
+      rpc_options.recv_tensor_bfloat16_tensor_names().begin(),
+      rpc_options.recv_tensor_bfloat16_tensor_names().end());
+  if (rpc_options.recv_tensor_broadcast_read_window_us() > 0) {
+    // Bounds the memory pinned by tensors that are no longer read.
+    static constexpr int64_t kMaxBroadcastReadBytes = 1LL << 30;
+    encoded_tensor_cache_ = std::make_unique<GrpcEncodedTensorCache>(
+        rpc_options.recv_tensor_broadcast_read_window_us(),
+        kMaxBroadcastReadBytes);
+  }
+}
+
+RecvTensorPayloadCodec GrpcWorker::ChoosePayloadCodec(
+    const RecvTensorRequest& request, const Tensor& tensor) const {
+  if (request.accepted_payload_codecs().empty()) return PAYLOAD_CODEC_NONE;
+  auto accepts = [&request](RecvTensorPayloadCodec codec) {
+    return std::find(request.accepted_payload_codecs().begin(),
+                     request.accepted_payload_codecs().end(),
+                     codec) != request.accepted_payload_codecs().end();
+  };
+  if (!recv_tensor_bfloat16_tensor_names_.empty() &&
+      tensor.dtype() == DT_FLOAT && accepts(PAYLOAD_CODEC_BFLOAT16)) {
+    Rendezvous::ParsedKey parsed;
+    if (Rendezvous::ParseKey(request.rendezvous_key(), &parsed).ok()) {
+      for (const std::string& name : recv_tensor_bfloat16_tensor_names_) {
+        if (absl::StrContains(parsed.edge_name, name)) {
+          return PAYLOAD_CODEC_BFLOAT16;
+        }
+      }
+    }
+  }
+  if (recv_tensor_compression_ != PAYLOAD_CODEC_NONE &&
+      tensor.TotalBytes() >= recv_tensor_compression_min_bytes_ &&
+      RecvTensorPayloadCodecSupports(recv_tensor_compression_,
+                                     tensor.dtype()) &&
+      accepts(recv_tensor_compression_)) {
+    return recv_tensor_compression_;
+  }
+  return PAYLOAD_CODEC_NONE;
 }
 
 void GrpcWorker::EnableResponseCache() {
@@ -449,11 +573,26 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
+  TensorTransport* tensor_transport = env_->tensor_transport;
+  auto do_response = [this, request, response, done, cache_enabled,
+                      tensor_transport](const Tensor& tensor, bool is_dead,
+                                        const Status& status) {
     if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      RecvTensorResponse metadata;
+      if (MaybeExportTensor(tensor_transport, *request, tensor, is_dead,
+                            &metadata)) {
+        grpc::EncodeRecvTensorResponseToByteBuffer(metadata, response);
+      } else {
+        const RecvTensorPayloadCodec codec =
+            is_dead ? PAYLOAD_CODEC_NONE : ChoosePayloadCodec(*request, tensor);
+        if (encoded_tensor_cache_ != nullptr) {
+          encoded_tensor_cache_->EncodeTensorToByteBuffer(
+              is_dead, tensor, cache_enabled, codec, response);
+        } else {
+          grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, codec,
+                                         response);
+        }
+      }
     }
     done(status);
   };
@@ -593,6 +732,102 @@ void SetTensorInRecvBufResp(int64_t max_chunk_bytes, const Tensor* tensor,
 }
 }  // namespace
 
+void GrpcWorker::GrpcStreamingRunGraphAsync(
+    const StreamingRunGraphRequest* request,
+    StreamingRunGraphResponse* response, std::function<void()> done) {
+  // Bounds the memory held by templates of graphs that are no longer run.
+  static constexpr int kMaxRunGraphTemplates = 1024;
+  RunGraphRequest* run_request = new RunGraphRequest;
+  {
+    mutex_lock l(run_graph_templates_mu_);
+    if (request->is_template()) {
+      if (run_graph_templates_.size() >= kMaxRunGraphTemplates) {
+        run_graph_templates_.clear();
+      }
+      RunGraphRequest& run_template =
+          run_graph_templates_[request->template_id()];
+      run_template = request->request();
+      run_template.clear_step_id();
+      run_template.clear_send();
+      run_template.clear_request_id();
+      *run_request = request->request();
+    } else {
+      auto it = run_graph_templates_.find(request->template_id());
+      if (it == run_graph_templates_.end()) {
+        delete run_request;
+        response->set_unknown_template(true);
+        done();
+        return;
+      }
+      *run_request = it->second;
+      run_request->set_step_id(request->request().step_id());
+      *run_request->mutable_send() = request->request().send();
+      run_request->set_request_id(request->request().request_id());
+    }
+  }
+  // Keep the stream alive across failed steps.
+  run_request->set_store_errors_in_response_body(true);
+  CallOptions* call_opts = new CallOptions;
+  ProtoRunGraphRequest* wrapped_request = new ProtoRunGraphRequest(run_request);
+  NonOwnedProtoRunGraphResponse* wrapped_response =
+      new NonOwnedProtoRunGraphResponse(response->mutable_response());
+  RunGraphAsync(call_opts, wrapped_request, wrapped_response,
+                [run_request, call_opts, wrapped_request, wrapped_response,
+                 done = std::move(done)](const Status& s) {
+                  if (!s.ok()) wrapped_response->set_status(s);
+                  delete call_opts;
+                  delete wrapped_request;
+                  delete wrapped_response;
+                  delete run_request;
+                  done();
+                });
+}
+
+void GrpcWorker::GrpcRecvTensorBatchAsync(CallOptions* opts,
+                                          const RecvTensorBatchRequest* request,
+                                          ::grpc::ByteBuffer* response,
+                                          StatusCallback done) {
+  const int num_requests = request->requests_size();
+  if (num_requests == 0) {
+    grpc::EncodeRecvTensorBatchResponseToByteBuffer({}, response);
+    done(OkStatus());
+    return;
+  }
+  struct BatchState {
+    explicit BatchState(int n) : responses(n), opts(n), num_pending(n) {}
+    std::vector<::grpc::ByteBuffer> responses;
+    // Each request gets its own options, since GrpcRecvTensorAsync installs
+    // its own cancellation callback.
+    std::vector<CallOptions> opts;
+    mutex mu;
+    int num_pending TF_GUARDED_BY(mu);
+    Status status TF_GUARDED_BY(mu);
+  };
+  auto state = std::make_shared<BatchState>(num_requests);
+  opts->SetCancelCallback([state]() {
+    for (CallOptions& opts : state->opts) opts.StartCancel();
+  });
+  for (int i = 0; i < num_requests; ++i) {
+    GrpcRecvTensorAsync(
+        &state->opts[i], &request->requests(i), &state->responses[i],
+        [state, opts, response, done](const Status& s) {
+          Status status;
+          {
+            mutex_lock l(state->mu);
+            state->status.Update(s);
+            if (--state->num_pending > 0) return;
+            status = state->status;
+          }
+          opts->ClearCancelCallback();
+          if (status.ok()) {
+            grpc::EncodeRecvTensorBatchResponseToByteBuffer(state->responses,
+                                                            response);
+          }
+          done(status);
+        });
+  }
+}
+
 void GrpcWorker::RecvBufAsync(CallOptions* opts, const RecvBufRequest* request,
                               RecvBufResponse* response, StatusCallback done) {
   const int64_t request_id = request->request_id();
@@ -17,12 +17,18 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_WORKER_SERVICE_H_
 
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "grpcpp/server_builder.h"
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_encoded_tensor_cache.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_response_cache.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 #include "tensorflow/tsl/distributed_runtime/rpc/async_service_interface.h"
 
@@ -51,6 +57,20 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  // Serves each request of a RecvTensorBatch like GrpcRecvTensorAsync, and
+  // concatenates the encoded responses without copying tensor contents.
+  virtual void GrpcRecvTensorBatchAsync(CallOptions* opts,
+                                        const RecvTensorBatchRequest* request,
+                                        ::grpc::ByteBuffer* response,
+                                        StatusCallback done);
+
+  // Runs the RunGraph request received on a StreamingRunGraph stream,
+  // completing it from the template it refers to (see worker.proto). Errors
+  // are returned in `response`, and `done` is called when it is filled.
+  virtual void GrpcStreamingRunGraphAsync(
+      const StreamingRunGraphRequest* request,
+      StreamingRunGraphResponse* response, std::function<void()> done);
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -68,8 +88,24 @@ class GrpcWorker : public Worker {
   void RemoveCacheEntryForId(int64_t request_id);
 
  private:
+  // Returns the codec to encode the content of `tensor` with in the response
+  // to `request`, based on the codecs accepted by the requester and on the
+  // `RPCOptions` this worker was created with.
+  RecvTensorPayloadCodec ChoosePayloadCodec(const RecvTensorRequest& request,
+                                            const Tensor& tensor) const;
+
   std::unique_ptr<GrpcResponseCache> response_cache_;
   const int32 recv_buf_max_chunk_;
+  RecvTensorPayloadCodec recv_tensor_compression_ = PAYLOAD_CODEC_NONE;
+  int64_t recv_tensor_compression_min_bytes_;
+  std::vector<std::string> recv_tensor_bfloat16_tensor_names_;
+  // Set iff `recv_tensor_broadcast_read_window_us` is positive.
+  std::unique_ptr<GrpcEncodedTensorCache> encoded_tensor_cache_;
+
+  mutex run_graph_templates_mu_;
+  // StreamingRunGraph request templates, by template id.
+  absl::flat_hash_map<uint64, RunGraphRequest> run_graph_templates_
+      TF_GUARDED_BY(run_graph_templates_mu_);
 };
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* worker_env,
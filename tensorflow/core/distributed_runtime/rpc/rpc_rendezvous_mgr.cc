@@ -15,12 +15,17 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <atomic>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/tensor_transport.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/types.h"
@@ -31,11 +36,29 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+// The maximum number of RecvTensor calls sent in one RecvTensorBatch.
+constexpr int kMaxRecvTensorBatchSize = 128;
+
+// Returns how long receives from the same worker are held back to be sent in
+// one RecvTensorBatch RPC, or 0 if receives are not batched.
+int64_t RecvTensorBatchWindowMicros() {
+  static const int64_t window_micros = []() {
+    int64_t micros;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_RPC_RECV_TENSOR_BATCH_WINDOW_US", 0,
+                                    &micros));
+    return micros;
+  }();
+  return window_micros;
+}
+
+class RpcRecvTensorCall;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
   RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id)
@@ -49,6 +72,26 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // A call that waits to be sent in a RecvTensorBatch.
+  struct PendingRecv {
+    RpcRecvTensorCall* call;
+    std::function<void()> recv_done;
+  };
+
+  // Starts `call`, or queues it to be sent together with the other calls to
+  // the same worker that start within the batching window.
+  void StartCall(RpcRecvTensorCall* call, std::function<void()> recv_done);
+
+  // Sends the calls queued for `src_worker` in one RecvTensorBatch.
+  void FlushBatch(const string& src_worker);
+
+  mutex batch_mu_;
+  absl::flat_hash_map<string, std::vector<PendingRecv>> pending_recvs_
+      TF_GUARDED_BY(batch_mu_);
+  // Set once a worker rejects RecvTensorBatch, e.g. because it runs an older
+  // version; later calls are then sent on their own.
+  std::atomic<bool> batching_unsupported_{false};
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
 
@@ -59,7 +102,8 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
 
   void Init(WorkerInterface* wi, int64_t step_id, StringPiece key,
             AllocatorAttributes alloc_attrs, Device* dst_device,
-            const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done) {
+            const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done,
+            TensorTransport* tensor_transport = nullptr) {
     wi_ = wi;
     alloc_attrs_ = alloc_attrs;
     dst_device_ = dst_device;
@@ -68,6 +112,18 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    // Out-of-band and encoded payloads are written into a host buffer
+    // allocated by `resp_`, so they are only used for host destinations.
+    const bool on_host = alloc_attrs.on_host() ||
+                         dst_device->attributes().device_type() == DEVICE_CPU;
+    if (on_host) {
+      req_.add_accepted_payload_codecs(PAYLOAD_CODEC_SNAPPY);
+      req_.add_accepted_payload_codecs(PAYLOAD_CODEC_BFLOAT16);
+    }
+    if (tensor_transport != nullptr && on_host) {
+      tensor_transport_ = tensor_transport;
+      RequestTensorTransport(*tensor_transport_, &req_);
+    }
   }
 
   void Reset() {
@@ -78,6 +134,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
 
     alloc_attrs_ = AllocatorAttributes();
     dst_device_ = nullptr;
+    tensor_transport_ = nullptr;
     // We don't clear opts_ and assume that Init will set up the state for
     // opts_ appropriately.
     req_.Clear();
@@ -101,6 +158,28 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     StartRTCall(std::move(recv_done));
   }
 
+  // Completes the RPC of this call with status `s`: imports the tensor from
+  // the TensorTransport if needed, then calls `recv_done`.
+  void OnResponse(const Status& s, std::function<void()> recv_done) {
+    if (!s.ok()) {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    if (s.ok() && tensor_transport_ != nullptr) {
+      MaybeImportTensor(tensor_transport_, resp_.metadata(),
+                        resp_.mutable_tensor(),
+                        [this, recv_done](const Status& import_status) {
+                          if (!import_status.ok()) {
+                            mutex_lock l(mu_);
+                            status_.Update(import_status);
+                          }
+                          recv_done();
+                        });
+      return;
+    }
+    recv_done();
+  }
+
   void StartAbort(const Status& s) override {
     {
       mutex_lock l(mu_);
@@ -141,11 +220,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
       // Make sure the Rendezvous abort checking is finished before running the
       // callback, which might destroy the current call object.
       abort_checked->WaitForNotification();
-      if (!s.ok()) {
-        mutex_lock l(mu_);
-        status_.Update(s);
-      }
-      recv_done();
+      OnResponse(s, std::move(recv_done));
     };
     wi_->RecvTensorAsync(&opts_, &req_, &resp_, std::move(cb));
 
@@ -171,6 +246,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   WorkerInterface* wi_;  // Not owned.
   AllocatorAttributes alloc_attrs_;
   Device* dst_device_;
+  TensorTransport* tensor_transport_ = nullptr;  // Not owned.
   CallOptions opts_;
   RecvTensorRequest req_;
   TensorResponse resp_;
@@ -268,7 +344,7 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   }
 
   call->Init(rwi, step_id_, parsed.FullKey(), recv_args.alloc_attrs, dst_device,
-             recv_args, std::move(done));
+             recv_args, std::move(done), env_->tensor_transport);
 
   // Record "call" in calls_ so that it can be aborted cleanly.
   RegisterCall(call, recv_args);
@@ -287,7 +363,7 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 
   // Start "call".
   Ref();
-  call->Start([this, call, recv_args, worker_cache]() {
+  StartCall(call, [this, call, recv_args, worker_cache]() {
     // Removes "call" from calls_. Prevent StartAbort().
     DeregisterCall(call, recv_args);
     // If StartAbort was called prior to DeregisterCall, then the
@@ -303,6 +379,119 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   });
 }
 
+void RpcRemoteRendezvous::StartCall(RpcRecvTensorCall* call,
+                                    std::function<void()> recv_done) {
+  const int64_t window_micros = RecvTensorBatchWindowMicros();
+  if (window_micros <= 0 || batching_unsupported_) {
+    call->Start(std::move(recv_done));
+    return;
+  }
+  const string src_worker = call->src_worker_;
+  bool schedule_flush;
+  bool flush_now;
+  {
+    mutex_lock l(batch_mu_);
+    std::vector<PendingRecv>& recvs = pending_recvs_[src_worker];
+    recvs.push_back({call, std::move(recv_done)});
+    schedule_flush = recvs.size() == 1;
+    flush_now = recvs.size() >= kMaxRecvTensorBatchSize;
+  }
+  if (flush_now) {
+    FlushBatch(src_worker);
+  } else if (schedule_flush) {
+    Ref();
+    env_->env->SchedClosureAfter(window_micros, [this, src_worker]() {
+      FlushBatch(src_worker);
+      Unref();
+    });
+  }
+}
+
+void RpcRemoteRendezvous::FlushBatch(const string& src_worker) {
+  struct Batch {
+    std::vector<PendingRecv> recvs;
+    CallOptions opts;
+    RecvTensorBatchRequest request;
+    RecvTensorBatchResponse response;
+  };
+  auto batch = std::make_shared<Batch>();
+  std::vector<PendingRecv> recvs;
+  {
+    mutex_lock l(batch_mu_);
+    auto it = pending_recvs_.find(src_worker);
+    if (it == pending_recvs_.end()) return;
+    recvs = std::move(it->second);
+    pending_recvs_.erase(it);
+  }
+  for (PendingRecv& recv : recvs) {
+    if (!recv.call->status().ok()) {
+      // Aborted while it was queued.
+      recv.recv_done();
+    } else {
+      batch->recvs.push_back(std::move(recv));
+    }
+  }
+  if (batch->recvs.empty()) return;
+  if (batch->recvs.size() == 1) {
+    PendingRecv& recv = batch->recvs[0];
+    recv.call->Start(std::move(recv.recv_done));
+    return;
+  }
+
+  CallOptions* batch_opts = &batch->opts;
+  for (PendingRecv& recv : batch->recvs) {
+    *batch->request.add_requests() = recv.call->req_;
+    recv.call->resp_.InitAlloc(recv.call->dst_device_, recv.call->alloc_attrs_);
+    // Aborting any of the calls cancels the whole batch.
+    recv.call->opts_.SetCancelCallback(
+        [batch_opts]() { batch_opts->StartCancel(); });
+  }
+  auto abort_checked = std::make_shared<Notification>();
+  // All calls are to the same worker, so any of their interfaces can be used.
+  WorkerInterface* wi = batch->recvs[0].call->wi_;
+  wi->RecvTensorBatchAsync(
+      batch_opts, &batch->request, &batch->response,
+      [this, batch, abort_checked](const Status& s) {
+        // Make sure the abort checking is finished before running the
+        // callbacks, which might destroy the calls.
+        abort_checked->WaitForNotification();
+        for (PendingRecv& recv : batch->recvs) {
+          recv.call->opts_.ClearCancelCallback();
+        }
+        if (errors::IsUnimplemented(s)) {
+          VLOG(1) << "RecvTensorBatch is not supported by the source worker; "
+                     "falling back to RecvTensor.";
+          batching_unsupported_ = true;
+          for (PendingRecv& recv : batch->recvs) {
+            recv.call->Start(std::move(recv.recv_done));
+          }
+          return;
+        }
+        for (int i = 0; i < static_cast<int>(batch->recvs.size()); ++i) {
+          RpcRecvTensorCall* call = batch->recvs[i].call;
+          Status call_status = s;
+          if (s.ok()) {
+            call_status =
+                i < batch->response.responses_size()
+                    ? call->resp_.InitFrom(batch->response.mutable_responses(i))
+                    : errors::Internal("Missing response ", i,
+                                       " in RecvTensorBatch");
+          }
+          call->OnResponse(call_status, std::move(batch->recvs[i].recv_done));
+        }
+      });
+
+  // As in RpcRecvTensorCall::StartRTCall, check whether one of the calls was
+  // aborted before its cancellation was forwarded to the batch.
+  for (PendingRecv& recv : batch->recvs) {
+    if (!recv.call->status().ok()) {
+      batch_opts->StartCancel();
+      break;
+    }
+  }
+  abort_checked->Notify();
+}
+
 }  // namespace
 
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
@@ -18,6 +18,7 @@ limitations under the License.
 #include "google/protobuf/any.pb.h"
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/distributed_runtime/tensor_payload_codec.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 
@@ -53,7 +54,20 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
   Status s;
   meta_.Swap(response);
-  if (on_host_) {
+  if (meta_.payload_codec() != PAYLOAD_CODEC_NONE) {
+    if (on_host_) {
+      s = TensorShape::IsValidShape(meta_.tensor().tensor_shape());
+    } else {
+      s = errors::InvalidArgument(
+          "Cannot decode an encoded RecvTensor payload into device memory");
+    }
+    if (s.ok()) {
+      s = DecodeTensorPayload(meta_.payload_codec(), meta_.tensor().dtype(),
+                              TensorShape(meta_.tensor().tensor_shape()),
+                              meta_.tensor().tensor_content(), allocator_,
+                              &tensor_);
+    }
+  } else if (on_host_) {
     if (!tensor_.FromProto(allocator_, meta_.tensor())) {
       s = errors::InvalidArgument("Cannot parse tensor from response");
     }
@@ -87,6 +101,10 @@ Status TensorResponse::ParseFrom(Source* source) {
     if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
       return errors::InvalidArgument("Cannot parse tensor from response");
     }
+    if (meta_.payload_codec() != PAYLOAD_CODEC_NONE) {
+      return errors::InvalidArgument(
+          "Cannot decode an encoded RecvTensor payload into device memory");
+    }
     Status s =
         device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
     // Reduce memory usage for big tensors.
@@ -280,11 +298,24 @@ bool TensorResponse::ParseSlow(Source* source) {
     return false;
   }
 
-  Tensor parsed(meta_.tensor().dtype());
-  if (!parsed.FromProto(allocator_, meta_.tensor())) {
-    return false;
+  if (meta_.payload_codec() != PAYLOAD_CODEC_NONE) {
+    // The tensor content was encoded by the sender (see
+    // `RecvTensorRequest.accepted_payload_codecs`).
+    if (!TensorShape::IsValid(meta_.tensor().tensor_shape()) ||
+        !DecodeTensorPayload(meta_.payload_codec(), meta_.tensor().dtype(),
+                             TensorShape(meta_.tensor().tensor_shape()),
+                             meta_.tensor().tensor_content(), allocator_,
+                             &tensor_)
+             .ok()) {
+      return false;
+    }
+  } else {
+    Tensor parsed(meta_.tensor().dtype());
+    if (!parsed.FromProto(allocator_, meta_.tensor())) {
+      return false;
+    }
+    tensor_ = std::move(parsed);
   }
-  tensor_ = std::move(parsed);
 
   // Reduce memory usage for big tensors.
   {
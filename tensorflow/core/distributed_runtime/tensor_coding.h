@@ -82,6 +82,10 @@ class TensorResponse {
   // live only until *this is destroyed or modified.
   const Tensor& tensor() const { return tensor_; }
 
+  // Return a pointer to the parsed tensor, e.g. so that a TensorTransport can
+  // fill in contents that were sent out of band.
+  Tensor* mutable_tensor() { return &tensor_; }
+
   // Return a reference to the parsed tensor metadata (no contents).
   // The result will remain live only until *this is destroyed or
   // modified.
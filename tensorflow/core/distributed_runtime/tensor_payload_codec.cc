@@ -0,0 +1,124 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/tensor_payload_codec.h"
+
+#include "tensorflow/core/framework/bfloat16.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/snappy.h"
+
+namespace tensorflow {
+
+const char* RecvTensorPayloadCodecName(RecvTensorPayloadCodec codec) {
+  switch (codec) {
+    case PAYLOAD_CODEC_NONE:
+      return "none";
+    case PAYLOAD_CODEC_SNAPPY:
+      return "snappy";
+    case PAYLOAD_CODEC_BFLOAT16:
+      return "bfloat16";
+    default:
+      return "unknown";
+  }
+}
+
+bool RecvTensorPayloadCodecSupports(RecvTensorPayloadCodec codec,
+                                    DataType dtype) {
+  switch (codec) {
+    case PAYLOAD_CODEC_SNAPPY:
+      return DataTypeCanUseMemcpy(dtype);
+    case PAYLOAD_CODEC_BFLOAT16:
+      return dtype == DT_FLOAT;
+    default:
+      return false;
+  }
+}
+
+bool EncodeTensorPayload(RecvTensorPayloadCodec codec, const Tensor& val,
+                         std::string* encoded) {
+  if (!RecvTensorPayloadCodecSupports(codec, val.dtype())) return false;
+  const uint64 start_micros = Env::Default()->NowMicros();
+  const StringPiece tdata = val.tensor_data();
+  switch (codec) {
+    case PAYLOAD_CODEC_SNAPPY:
+      if (!port::Snappy_Compress(tdata.data(), tdata.size(), encoded)) {
+        return false;
+      }
+      break;
+    case PAYLOAD_CODEC_BFLOAT16: {
+      const int64_t num_elements = val.NumElements();
+      encoded->resize(num_elements * sizeof(bfloat16));
+      RoundFloatToBFloat16(val.flat<float>().data(),
+                           reinterpret_cast<bfloat16*>(&(*encoded)[0]),
+                           num_elements);
+      break;
+    }
+    default:
+      return false;
+  }
+  if (encoded->size() >= tdata.size()) return false;
+  metrics::RecordRecvTensorPayloadEncoded(
+      RecvTensorPayloadCodecName(codec), tdata.size(), encoded->size(),
+      Env::Default()->NowMicros() - start_micros);
+  return true;
+}
+
+Status DecodeTensorPayload(RecvTensorPayloadCodec codec, DataType dtype,
+                           const TensorShape& shape, StringPiece encoded,
+                           Allocator* allocator, Tensor* result) {
+  if (!RecvTensorPayloadCodecSupports(codec, dtype)) {
+    return errors::InvalidArgument("RecvTensor payload codec ",
+                                   RecvTensorPayloadCodecName(codec),
+                                   " does not support ", DataTypeString(dtype));
+  }
+  const uint64 start_micros = Env::Default()->NowMicros();
+  Tensor decoded(allocator, dtype, shape);
+  StringPiece buf = decoded.tensor_data();
+  switch (codec) {
+    case PAYLOAD_CODEC_SNAPPY: {
+      size_t length;
+      if (!port::Snappy_GetUncompressedLength(encoded.data(), encoded.size(),
+                                              &length) ||
+          length != buf.size() ||
+          !port::Snappy_Uncompress(encoded.data(), encoded.size(),
+                                   const_cast<char*>(buf.data()))) {
+        return errors::DataLoss("Cannot uncompress RecvTensor payload");
+      }
+      break;
+    }
+    case PAYLOAD_CODEC_BFLOAT16: {
+      const int64_t num_elements = decoded.NumElements();
+      if (encoded.size() != num_elements * sizeof(bfloat16)) {
+        return errors::DataLoss("Unexpected bfloat16 RecvTensor payload size ",
+                                encoded.size(), " for ", num_elements,
+                                " elements");
+      }
+      BFloat16ToFloat(reinterpret_cast<const bfloat16*>(encoded.data()),
+                      decoded.flat<float>().data(), num_elements);
+      break;
+    }
+    default:
+      break;
+  }
+  metrics::RecordRecvTensorPayloadDecoded(
+      RecvTensorPayloadCodecName(codec),
+      Env::Default()->NowMicros() - start_micros);
+  *result = std::move(decoded);
+  return OkStatus();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,50 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_PAYLOAD_CODEC_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_PAYLOAD_CODEC_H_
+
+#include <string>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+// Returns a short name for `codec`, e.g. for use as a metric label.
+const char* RecvTensorPayloadCodecName(RecvTensorPayloadCodec codec);
+
+// Returns true iff `codec` can encode tensors of type `dtype`.
+bool RecvTensorPayloadCodecSupports(RecvTensorPayloadCodec codec,
+                                    DataType dtype);
+
+// Encodes the content of `val` with `codec` into `*encoded`. Returns false,
+// leaving `*encoded` unspecified, if `codec` does not support `val` or if the
+// encoded content would not be smaller than `val.TotalBytes()`.
+bool EncodeTensorPayload(RecvTensorPayloadCodec codec, const Tensor& val,
+                         std::string* encoded);
+
+// Decodes `encoded`, produced by `EncodeTensorPayload(codec, ...)` for a
+// tensor of type `dtype` and shape `shape`, into a new tensor allocated from
+// `allocator`.
+Status DecodeTensorPayload(RecvTensorPayloadCodec codec, DataType dtype,
+                           const TensorShape& shape, StringPiece encoded,
+                           Allocator* allocator, Tensor* result);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_PAYLOAD_CODEC_H_
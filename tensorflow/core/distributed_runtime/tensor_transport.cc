@@ -0,0 +1,134 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/tensor_transport.h"
+
+#include <unordered_map>
+#include <utility>
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+
+namespace tensorflow {
+
+namespace {
+mutex* get_tensor_transport_lock() {
+  static mutex tensor_transport_lock(LINKER_INITIALIZED);
+  return &tensor_transport_lock;
+}
+
+typedef std::unordered_map<string, TensorTransport::Factory>
+    TensorTransportFactories;
+TensorTransportFactories* tensor_transport_factories() {
+  static TensorTransportFactories* factories = new TensorTransportFactories;
+  return factories;
+}
+
+// Returns the options in `options` if they negotiate a TensorTransport.
+bool GetTensorTransportOptions(const protobuf::Any& options,
+                               TensorTransportOptions* out) {
+  return options.Is<TensorTransportOptions>() && options.UnpackTo(out);
+}
+}  // namespace
+
+/* static */
+void TensorTransport::Register(const std::string& name, Factory factory) {
+  mutex_lock l(*get_tensor_transport_lock());
+  if (!tensor_transport_factories()->insert({name, std::move(factory)})
+           .second) {
+    LOG(ERROR) << "Two tensor transports are being registered under " << name;
+  }
+}
+
+/* static */
+bool TensorTransport::IsRegistered(const std::string& name) {
+  mutex_lock l(*get_tensor_transport_lock());
+  return tensor_transport_factories()->count(name) > 0;
+}
+
+/* static */
+Status TensorTransport::Create(const std::string& name, const WorkerEnv* env,
+                               std::unique_ptr<TensorTransport>* out) {
+  Factory factory;
+  {
+    mutex_lock l(*get_tensor_transport_lock());
+    auto it = tensor_transport_factories()->find(name);
+    if (it == tensor_transport_factories()->end()) {
+      return errors::NotFound("No tensor transport registered under ", name);
+    }
+    factory = it->second;
+  }
+  return factory(env, out);
+}
+
+void RequestTensorTransport(const TensorTransport& transport,
+                            RecvTensorRequest* request) {
+  TensorTransportOptions options;
+  options.set_transport(transport.name());
+  request->set_dma_ok(true);
+  request->mutable_transport_options()->PackFrom(options);
+}
+
+bool MaybeExportTensor(TensorTransport* transport,
+                       const RecvTensorRequest& request, const Tensor& tensor,
+                       bool is_dead, RecvTensorResponse* response) {
+  if (transport == nullptr || !request.dma_ok() || is_dead ||
+      !DataTypeCanUseMemcpy(tensor.dtype()) ||
+      static_cast<int64_t>(tensor.TotalBytes()) < transport->min_bytes()) {
+    return false;
+  }
+  TensorTransportOptions options;
+  if (!GetTensorTransportOptions(request.transport_options(), &options) ||
+      options.transport() != transport->name()) {
+    return false;
+  }
+  Status s = transport->ExportTensor(tensor, options.mutable_data());
+  if (!s.ok()) {
+    VLOG(1) << "Inlining tensor for " << request.rendezvous_key()
+            << " since it could not be exported through "
+            << transport->name() << ": " << s;
+    return false;
+  }
+  response->Clear();
+  response->set_is_dead(false);
+  response->set_send_start_micros(Env::Default()->NowMicros());
+  response->mutable_tensor()->set_dtype(tensor.dtype());
+  tensor.shape().AsProto(response->mutable_tensor()->mutable_tensor_shape());
+  response->mutable_transport_options()->PackFrom(options);
+  return true;
+}
+
+void MaybeImportTensor(TensorTransport* transport,
+                       const RecvTensorResponse& metadata, Tensor* tensor,
+                       StatusCallback done) {
+  TensorTransportOptions options;
+  if (!metadata.has_transport_options() ||
+      !GetTensorTransportOptions(metadata.transport_options(), &options)) {
+    done(OkStatus());
+    return;
+  }
+  if (transport == nullptr || options.transport() != transport->name()) {
+    done(errors::Internal("RecvTensor response was sent through the unknown "
+                          "tensor transport \"",
+                          options.transport(), "\""));
+    return;
+  }
+  transport->ImportTensor(options.data(), tensor, std::move(done));
+}
+
+}  // namespace tensorflow
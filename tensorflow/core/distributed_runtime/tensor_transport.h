@@ -0,0 +1,121 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_TRANSPORT_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_TRANSPORT_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+struct WorkerEnv;
+
+// A TensorTransport moves the payload of RecvTensor responses out of band,
+// e.g. with RDMA, while the RecvTensor RPC itself only carries the tensor
+// metadata. Transports are registered by name with
+// `TensorTransport::Register()`, and selected by starting a server with the
+// "grpc+<name>" protocol.
+//
+// A transfer is negotiated over the RecvTensor RPC as follows:
+//
+// 1. A client whose worker has a transport calls `RequestTensorTransport()`,
+//    which sets `dma_ok` and names the transport in the request's
+//    `transport_options`.
+// 2. If the server has the same transport and the tensor can be sent through
+//    it, `MaybeExportTensor()` calls `ExportTensor()`, which makes the payload
+//    available to the client (e.g. by registering its buffer as a memory
+//    region) and returns a descriptor. The response carries the descriptor in
+//    its `transport_options` in place of the tensor content.
+// 3. The client allocates the destination tensor from the receiving device's
+//    allocator, as it does for inlined payloads, and `MaybeImportTensor()`
+//    calls `ImportTensor()` to write the payload directly into it.
+//
+// Servers without the transport ignore the request options and inline the
+// payload, so a transport can be rolled out one job at a time.
+//
+// Implementations must be thread-safe.
+class TensorTransport {
+ public:
+  // Payloads smaller than this are inlined in the RPC response by default,
+  // since the RPC is cheaper than an out-of-band transfer for them.
+  static constexpr int64_t kDefaultMinBytes = 64 << 10;
+
+  using Factory = std::function<Status(const WorkerEnv* env,
+                                       std::unique_ptr<TensorTransport>* out)>;
+
+  virtual ~TensorTransport() {}
+
+  // Registers a factory for the transport named `name`. `env` is the
+  // environment of the worker that will use the transport; its devices are
+  // set when the factory is called.
+  static void Register(const std::string& name, Factory factory);
+
+  // Returns true iff a transport named `name` has been registered.
+  static bool IsRegistered(const std::string& name);
+
+  // Creates the transport named `name` for the worker with environment `env`.
+  static Status Create(const std::string& name, const WorkerEnv* env,
+                       std::unique_ptr<TensorTransport>* out);
+
+  // The name this transport was registered with.
+  virtual const std::string& name() const = 0;
+
+  // The minimum payload size for tensors sent through this transport.
+  virtual int64_t min_bytes() const { return kDefaultMinBytes; }
+
+  // Server side: makes the payload of `tensor` available to the client and
+  // stores in `*descriptor` the data the client passes to `ImportTensor()`.
+  // The transport keeps `tensor` alive until the client has read the payload
+  // or the transfer has failed.
+  virtual Status ExportTensor(const Tensor& tensor,
+                              std::string* descriptor) = 0;
+
+  // Client side: writes the payload described by `descriptor` into `tensor`,
+  // which has been allocated with the dtype and shape of the sent tensor, and
+  // calls `done` when the payload has been received.
+  virtual void ImportTensor(const std::string& descriptor, Tensor* tensor,
+                            StatusCallback done) = 0;
+};
+
+// Client side: requests that the response to `request` be sent through
+// `transport`.
+void RequestTensorTransport(const TensorTransport& transport,
+                            RecvTensorRequest* request);
+
+// Server side: if `request` asked for `transport` and `tensor` can be sent
+// through it, exports `tensor` and fills `response` with its metadata and
+// descriptor. Returns false if the tensor must be inlined in the response
+// instead.
+bool MaybeExportTensor(TensorTransport* transport,
+                       const RecvTensorRequest& request, const Tensor& tensor,
+                       bool is_dead, RecvTensorResponse* response);
+
+// Client side: if `metadata` carries a descriptor for `transport`, imports
+// the payload into `tensor` and calls `done` once it has been received.
+// Otherwise calls `done` immediately with an OK status, or with an error if
+// the descriptor is for an unknown transport.
+void MaybeImportTensor(TensorTransport* transport,
+                       const RecvTensorResponse& metadata, Tensor* tensor,
+                       StatusCallback done);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_TRANSPORT_H_
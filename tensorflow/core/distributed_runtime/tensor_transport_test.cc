@@ -0,0 +1,183 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/tensor_transport.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kFakeTransport[] = "fake_transport";
+
+// Transfers tensors through a map within the process.
+class FakeTensorTransport : public TensorTransport {
+ public:
+  const std::string& name() const override { return name_; }
+
+  int64_t min_bytes() const override { return 16; }
+
+  Status ExportTensor(const Tensor& tensor, std::string* descriptor) override {
+    mutex_lock l(mu_);
+    *descriptor = std::to_string(next_id_++);
+    exported_[*descriptor] = tensor;
+    return OkStatus();
+  }
+
+  void ImportTensor(const std::string& descriptor, Tensor* tensor,
+                    StatusCallback done) override {
+    Tensor exported;
+    {
+      mutex_lock l(mu_);
+      auto it = exported_.find(descriptor);
+      if (it == exported_.end()) {
+        done(errors::NotFound("Unknown descriptor ", descriptor));
+        return;
+      }
+      exported = it->second;
+      exported_.erase(it);
+    }
+    tensor->flat<float>() = exported.flat<float>();
+    done(OkStatus());
+  }
+
+  int64_t num_exported() {
+    mutex_lock l(mu_);
+    return exported_.size();
+  }
+
+ private:
+  const std::string name_ = kFakeTransport;
+  mutex mu_;
+  int64_t next_id_ TF_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<std::string, Tensor> exported_ TF_GUARDED_BY(mu_);
+};
+
+class TensorTransportRegistrar {
+ public:
+  TensorTransportRegistrar() {
+    TensorTransport::Register(
+        kFakeTransport,
+        [](const WorkerEnv* env, std::unique_ptr<TensorTransport>* out) {
+          *out = std::make_unique<FakeTensorTransport>();
+          return OkStatus();
+        });
+  }
+};
+static TensorTransportRegistrar registrar;
+
+Status ImportTensorSync(TensorTransport* transport,
+                        const RecvTensorResponse& metadata, Tensor* tensor) {
+  Status status;
+  MaybeImportTensor(transport, metadata, tensor,
+                    [&status](const Status& s) { status = s; });
+  return status;
+}
+
+TEST(TensorTransportTest, Registry) {
+  EXPECT_TRUE(TensorTransport::IsRegistered(kFakeTransport));
+  EXPECT_FALSE(TensorTransport::IsRegistered("unknown"));
+  std::unique_ptr<TensorTransport> transport;
+  TF_ASSERT_OK(
+      TensorTransport::Create(kFakeTransport, /*env=*/nullptr, &transport));
+  EXPECT_EQ(transport->name(), kFakeTransport);
+  EXPECT_TRUE(errors::IsNotFound(
+      TensorTransport::Create("unknown", /*env=*/nullptr, &transport)));
+}
+
+TEST(TensorTransportTest, ExportAndImport) {
+  FakeTensorTransport transport;
+  RecvTensorRequest request;
+  RequestTensorTransport(transport, &request);
+  EXPECT_TRUE(request.dma_ok());
+
+  Tensor sent = test::AsTensor<float>({1, 2, 3, 4, 5, 6, 7, 8}, {2, 4});
+  RecvTensorResponse response;
+  ASSERT_TRUE(MaybeExportTensor(&transport, request, sent,
+                                /*is_dead=*/false, &response));
+  EXPECT_EQ(transport.num_exported(), 1);
+  // The response carries the metadata but not the payload.
+  EXPECT_EQ(response.tensor().dtype(), DT_FLOAT);
+  EXPECT_EQ(TensorShape(response.tensor().tensor_shape()), sent.shape());
+  EXPECT_TRUE(response.tensor().tensor_content().empty());
+  TensorTransportOptions options;
+  ASSERT_TRUE(response.transport_options().UnpackTo(&options));
+  EXPECT_EQ(options.transport(), kFakeTransport);
+
+  Tensor received(DT_FLOAT, sent.shape());
+  TF_ASSERT_OK(ImportTensorSync(&transport, response, &received));
+  test::ExpectTensorEqual<float>(received, sent);
+  EXPECT_EQ(transport.num_exported(), 0);
+}
+
+TEST(TensorTransportTest, InlinesUnsuitableTensors) {
+  FakeTensorTransport transport;
+  RecvTensorRequest request;
+  RequestTensorTransport(transport, &request);
+  RecvTensorResponse response;
+
+  // Smaller than `min_bytes()`.
+  EXPECT_FALSE(MaybeExportTensor(&transport, request,
+                                 test::AsTensor<float>({1, 2}),
+                                 /*is_dead=*/false, &response));
+  // Dead.
+  Tensor large = test::AsTensor<float>({1, 2, 3, 4, 5, 6, 7, 8});
+  EXPECT_FALSE(MaybeExportTensor(&transport, request, large,
+                                 /*is_dead=*/true, &response));
+  // Not memcpy-able.
+  EXPECT_FALSE(MaybeExportTensor(
+      &transport, request,
+      test::AsTensor<tstring>({"a", "b", "c", "d", "e", "f", "g", "h"}),
+      /*is_dead=*/false, &response));
+  // Not requested by the client.
+  EXPECT_FALSE(MaybeExportTensor(&transport, RecvTensorRequest(), large,
+                                 /*is_dead=*/false, &response));
+  // No transport on the server.
+  EXPECT_FALSE(MaybeExportTensor(/*transport=*/nullptr, request, large,
+                                 /*is_dead=*/false, &response));
+  EXPECT_EQ(transport.num_exported(), 0);
+}
+
+TEST(TensorTransportTest, ImportInlinedResponse) {
+  FakeTensorTransport transport;
+  Tensor received(DT_FLOAT, TensorShape({2}));
+  TF_EXPECT_OK(ImportTensorSync(&transport, RecvTensorResponse(), &received));
+  TF_EXPECT_OK(ImportTensorSync(/*transport=*/nullptr, RecvTensorResponse(),
+                                &received));
+}
+
+TEST(TensorTransportTest, ImportFromUnknownTransport) {
+  FakeTensorTransport transport;
+  RecvTensorRequest request;
+  RequestTensorTransport(transport, &request);
+  Tensor sent = test::AsTensor<float>({1, 2, 3, 4, 5, 6, 7, 8});
+  RecvTensorResponse response;
+  ASSERT_TRUE(MaybeExportTensor(&transport, request, sent,
+                                /*is_dead=*/false, &response));
+  Tensor received(DT_FLOAT, sent.shape());
+  EXPECT_TRUE(errors::IsInternal(
+      ImportTensorSync(/*transport=*/nullptr, response, &received)));
+}
+
+}  // namespace
+}  // namespace tensorflow
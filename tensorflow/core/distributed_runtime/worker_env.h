@@ -38,6 +38,7 @@ class Device;
 class DeviceMgr;
 class RendezvousMgrInterface;
 class SessionMgr;
+class TensorTransport;
 
 // The worker environment class, which holds a bag of pointers to
 // per-worker singletons.
@@ -77,6 +78,10 @@ struct WorkerEnv {
 
   // A pool of threads for scheduling compute work.
   thread::ThreadPool* compute_pool = nullptr;
+
+  // If set, the out-of-band transport used for the payloads of RecvTensor
+  // responses (see tensor_transport.h).
+  TensorTransport* tensor_transport = nullptr;
 };
 
 }  // end namespace tensorflow
@@ -49,6 +49,7 @@ enum CollectiveType {
   PERMUTE_COLLECTIVE,
   ALL_TO_ALL_COLLECTIVE,
   REDUCE_SCATTER_COLLECTIVE,
+  ALL_TO_ALL_V_COLLECTIVE,
   UNDEFINED_COLLECTIVE,
 };
 
@@ -156,6 +157,9 @@ struct CollectiveParams : public core::RefCounted {
   std::vector<int> subdiv_rank;
   OpKernel* merge_op = nullptr;  // reduction only
   OpKernel* final_op = nullptr;  // reduction only
+  // Number of rows sent to and received from each rank, all-to-all-v only.
+  std::vector<int64_t> send_splits;
+  std::vector<int64_t> recv_splits;
   string ToString() const;
   bool run_group_initialization = true;
 };
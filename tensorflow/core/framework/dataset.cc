@@ -16,6 +16,11 @@ limitations under the License.
 
 #include <unordered_map>
 
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+#include "absl/strings/ascii.h"
 #include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/function.h"
@@ -34,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/public/version.h"
 
 // On Windows, disable some macros that would break compile
@@ -399,6 +405,75 @@ int32_t GetRunnerThreadpoolSizeFromOpKernelContext(OpKernelContext* ctx) {
   }
 }
 
+namespace {
+
+// Resource usage of the `GetNext` call in progress on the current thread.
+struct GetNextFrame {
+  // Wall and CPU time of the nested `GetNext` calls made on this thread.
+  int64_t input_wall_time_ns = 0;
+  int64_t input_cpu_time_ns = 0;
+};
+
+thread_local GetNextFrame* current_get_next_frame = nullptr;
+
+// Returns the CPU time consumed by the calling thread, or 0 if the platform
+// does not provide a per-thread CPU clock.
+int64_t ThreadCpuNanos() {
+#if defined(__linux__)
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+    return static_cast<int64_t>(ts.tv_sec) * EnvTime::kSecondsToNanos +
+           ts.tv_nsec;
+  }
+#endif
+  return 0;
+}
+
+// Replaces the indices in brackets that tf.data appends to the prefixes of
+// per-element iterators (e.g. "Iterator::FlatMap[3]::Map") with "[]".
+std::string NormalizeIteratorPrefix(const std::string& prefix) {
+  std::string result;
+  result.reserve(prefix.size());
+  for (size_t i = 0; i < prefix.size(); ++i) {
+    result.push_back(prefix[i]);
+    if (prefix[i] != '[') continue;
+    size_t j = i + 1;
+    while (j < prefix.size() && absl::ascii_isdigit(prefix[j])) ++j;
+    if (j > i + 1 && j < prefix.size() && prefix[j] == ']') i = j - 1;
+  }
+  return result;
+}
+
+}  // namespace
+
+std::shared_ptr<IteratorStatsRegistry::Counters>
+IteratorStatsRegistry::GetOrCreate(const std::string& prefix) {
+  const std::string key = NormalizeIteratorPrefix(prefix);
+  mutex_lock l(mu_);
+  auto& counters = counters_[key];
+  if (counters == nullptr) {
+    counters = std::make_shared<Counters>();
+  }
+  return counters;
+}
+
+absl::flat_hash_map<std::string, IteratorStats>
+IteratorStatsRegistry::GetStats() const {
+  absl::flat_hash_map<std::string, IteratorStats> result;
+  tf_shared_lock l(mu_);
+  for (const auto& [prefix, counters] : counters_) {
+    IteratorStats& stats = result[prefix];
+    stats.num_elements = counters->num_elements.load(std::memory_order_relaxed);
+    stats.bytes_produced =
+        counters->bytes_produced.load(std::memory_order_relaxed);
+    stats.wall_time_ns = counters->wall_time_ns.load(std::memory_order_relaxed);
+    stats.cpu_time_ns = counters->cpu_time_ns.load(std::memory_order_relaxed);
+    stats.input_time_ns =
+        counters->input_time_ns.load(std::memory_order_relaxed);
+  }
+  return result;
+}
+
 Status IteratorBase::InitializeBase(IteratorContext* ctx,
                                     const IteratorBase* parent) {
   parent_ = parent;
@@ -415,6 +490,9 @@ Status IteratorBase::InitializeBase(IteratorContext* ctx,
     model->AddNode(std::move(factory), prefix(), parent->model_node(), &node_);
     cleanup_fns_.push_back([this, model]() { model->RemoveNode(node_); });
   }
+  if (const auto& iterator_stats = ctx->iterator_stats()) {
+    stats_counters_ = iterator_stats->GetOrCreate(prefix());
+  }
   return OkStatus();
 }
 
@@ -958,8 +1036,46 @@ Status DatasetBaseIterator::GetNext(IteratorContext* ctx,
     }
     node_->record_start(now_nanos);
   }
+  GetNextFrame frame;
+  GetNextFrame* parent_frame = current_get_next_frame;
+  int64_t start_wall_nanos = 0;
+  int64_t start_cpu_nanos = 0;
+  if (stats_counters_) {
+    current_get_next_frame = &frame;
+    start_wall_nanos = EnvTime::NowNanos();
+    start_cpu_nanos = ThreadCpuNanos();
+  }
   out_tensors->clear();
   Status s = GetNextInternal(ctx, out_tensors, end_of_sequence);
+  if (stats_counters_) {
+    const int64_t wall_nanos = EnvTime::NowNanos() - start_wall_nanos;
+    const int64_t cpu_nanos = ThreadCpuNanos() - start_cpu_nanos;
+    current_get_next_frame = parent_frame;
+    if (parent_frame) {
+      parent_frame->input_wall_time_ns += wall_nanos;
+      parent_frame->input_cpu_time_ns += cpu_nanos;
+    }
+    const int64_t self_cpu_nanos = cpu_nanos - frame.input_cpu_time_ns;
+    int64_t num_bytes = 0;
+    if (s.ok() && !*end_of_sequence) {
+      num_bytes = GetAllocatedBytes(*out_tensors);
+      stats_counters_->num_elements.fetch_add(1, std::memory_order_relaxed);
+      stats_counters_->bytes_produced.fetch_add(num_bytes,
+                                                std::memory_order_relaxed);
+    }
+    stats_counters_->wall_time_ns.fetch_add(wall_nanos,
+                                            std::memory_order_relaxed);
+    stats_counters_->cpu_time_ns.fetch_add(self_cpu_nanos,
+                                           std::memory_order_relaxed);
+    stats_counters_->input_time_ns.fetch_add(frame.input_wall_time_ns,
+                                             std::memory_order_relaxed);
+    activity.AppendMetadata([&]() {
+      return profiler::TraceMeEncode({{"cpu_time_ns", self_cpu_nanos},
+                                      {"input_time_ns",
+                                       frame.input_wall_time_ns},
+                                      {"bytes", num_bytes}});
+    });
+  }
   ctx->SaveCheckpoint(this);
   if (!SymbolicCheckpointCompatible()) {
     ctx->UpdateCheckpointStatus([this]() {
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_DATASET_H_
 #define TENSORFLOW_CORE_FRAMEWORK_DATASET_H_
 
+#include <atomic>
 #include <deque>
 #include <iterator>
 #include <memory>
@@ -718,6 +719,60 @@ class SerializationContext {
   TF_DISALLOW_COPY_AND_ASSIGN(SerializationContext);
 };
 
+// Cumulative resource usage of `GetNext` calls on the iterators that share a
+// prefix.
+struct IteratorStats {
+  // Number of elements produced.
+  int64_t num_elements = 0;
+  // Total size in bytes of the elements produced.
+  int64_t bytes_produced = 0;
+  // Wall time spent in `GetNext`, including the time spent in the `GetNext`
+  // calls this iterator makes on its inputs from the calling thread.
+  int64_t wall_time_ns = 0;
+  // CPU time spent by the calling thread in `GetNext`, excluding the CPU time
+  // of the `GetNext` calls this iterator makes on its inputs from that thread.
+  // Zero on platforms without a per-thread CPU clock.
+  int64_t cpu_time_ns = 0;
+  // Wall time spent in the `GetNext` calls this iterator makes on its inputs
+  // from the calling thread. `wall_time_ns - input_time_ns` is the time spent
+  // in the iterator itself, either computing or blocked on a buffer filled by
+  // a background thread.
+  int64_t input_time_ns = 0;
+};
+
+// Collects `IteratorStats` for the iterators of one input pipeline.
+//
+// Iterators created by the same transformation for different input elements
+// (e.g. the inner iterators of `flat_map` or `interleave`) share an entry.
+//
+// This class is thread-safe.
+class IteratorStatsRegistry {
+ public:
+  // Lock-free counters updated by the iterators that share a prefix.
+  struct Counters {
+    std::atomic<int64_t> num_elements{0};
+    std::atomic<int64_t> bytes_produced{0};
+    std::atomic<int64_t> wall_time_ns{0};
+    std::atomic<int64_t> cpu_time_ns{0};
+    std::atomic<int64_t> input_time_ns{0};
+  };
+
+  IteratorStatsRegistry() = default;
+
+  // Returns the counters for iterators with the given prefix.
+  std::shared_ptr<Counters> GetOrCreate(const std::string& prefix);
+
+  // Returns a snapshot of the stats, keyed by iterator prefix.
+  absl::flat_hash_map<std::string, IteratorStats> GetStats() const;
+
+ private:
+  mutable mutex mu_;
+  absl::flat_hash_map<std::string, std::shared_ptr<Counters>> counters_
+      TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(IteratorStatsRegistry);
+};
+
 // A cut-down version of `OpKernelContext` for running computations in
 // iterators. Note that we cannot simply use `OpKernelContext` here because we
 // might run computation in an iterator whose lifetime is not nested within the
@@ -751,7 +806,8 @@ class IteratorContext {
           thread_factory(ctx->thread_factory()),
           thread_pool(ctx->thread_pool()),
           id_registry(ctx->id_registry()),
-          warm_start(ctx->warm_start()) {}
+          warm_start(ctx->warm_start()),
+          iterator_stats(ctx->iterator_stats()) {}
 
     explicit Params(OpKernelContext* ctx)
         : collective_executor(ctx->collective_executor()),
@@ -850,6 +906,9 @@ class IteratorContext {
     // the iterator is created. Otherwise, they are started upon first `GetNext`
     // request. Default value is set to false to ensure backward compatibility.
     bool warm_start = false;
+
+    // If set, iterators record their resource usage in this registry.
+    std::shared_ptr<IteratorStatsRegistry> iterator_stats = nullptr;
   };
 
   explicit IteratorContext(IteratorContext* ctx)
@@ -930,6 +989,10 @@ class IteratorContext {
 
   bool warm_start() { return params_.warm_start; }
 
+  const std::shared_ptr<IteratorStatsRegistry>& iterator_stats() {
+    return params_.iterator_stats;
+  }
+
   std::unique_ptr<thread::ThreadPool> CreateThreadPool(const string& name,
                                                        int num_threads) {
     if (params_.thread_pool) {
@@ -1183,10 +1246,13 @@ class IteratorBase : public Checkpointable {
  private:
   // For access to `AddCleanupFunction` and `Restore`.
   friend class DatasetBase;
-  friend class DatasetBaseIterator;  // for access to `node_`
+  friend class DatasetBaseIterator;  // for access to `node_`, `stats_counters_`
 
   std::vector<std::function<void()>> cleanup_fns_;
   std::shared_ptr<model::Node> node_ = nullptr;
+  // Set iff the iterator records its resource usage in an
+  // `IteratorStatsRegistry`.
+  std::shared_ptr<IteratorStatsRegistry::Counters> stats_counters_ = nullptr;
   const IteratorBase* parent_ = nullptr;  // Not owned.
   uint64_t id_ = 0;
   uint64_t parent_id_ = 0;
@@ -157,5 +157,31 @@ TEST(DatasetTest, IsDatasetOp) {
   }
 }
 
+TEST(IteratorStatsRegistryTest, GetOrCreate) {
+  IteratorStatsRegistry registry;
+  auto map_counters = registry.GetOrCreate("Iterator::Map");
+  EXPECT_EQ(registry.GetOrCreate("Iterator::Map"), map_counters);
+  map_counters->num_elements.fetch_add(2);
+  map_counters->bytes_produced.fetch_add(16);
+  registry.GetOrCreate("Iterator::Map::Range")->wall_time_ns.fetch_add(5);
+
+  auto stats = registry.GetStats();
+  ASSERT_EQ(stats.size(), 2);
+  EXPECT_EQ(stats["Iterator::Map"].num_elements, 2);
+  EXPECT_EQ(stats["Iterator::Map"].bytes_produced, 16);
+  EXPECT_EQ(stats["Iterator::Map::Range"].wall_time_ns, 5);
+}
+
+TEST(IteratorStatsRegistryTest, PerElementIteratorsShareCounters) {
+  IteratorStatsRegistry registry;
+  auto counters = registry.GetOrCreate("Iterator::FlatMap[0]::Range");
+  EXPECT_EQ(registry.GetOrCreate("Iterator::FlatMap[12]::Range"), counters);
+  EXPECT_NE(registry.GetOrCreate("Iterator::FlatMap[x]::Range"), counters);
+
+  auto stats = registry.GetStats();
+  EXPECT_TRUE(stats.contains("Iterator::FlatMap[]::Range"));
+  EXPECT_TRUE(stats.contains("Iterator::FlatMap[x]::Range"));
+}
+
 }  // namespace data
 }  // namespace tensorflow
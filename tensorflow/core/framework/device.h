@@ -31,6 +31,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/control_flow.h"
@@ -151,6 +152,18 @@ class Device : public DeviceBase {
     return OkStatus();
   }
 
+  // Sets `(*device_context_map)[id]` to the DeviceContext to use for the node
+  // with ID `id` of `graph`, which is to be run on this device, e.g. to spread
+  // independent ops over several streams. Leaves `device_context_map` empty
+  // if all nodes use the context of TryGetDeviceContext().
+  //
+  // The caller takes ownership of one reference on each non-null
+  // DeviceContext* in `device_context_map`, and should call Unref().
+  virtual Status FillContextMap(
+      const Graph* graph, std::vector<DeviceContext*>* device_context_map) {
+    return OkStatus();
+  }
+
   // Returns the op segment of this device.  The caller can reuse op
   // kernels registered for the same session running on this device.
   OpSegment* op_segment() { return &op_seg_; }
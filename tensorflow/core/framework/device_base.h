@@ -160,6 +160,9 @@ class DeviceBase {
     DeviceContext* default_context = nullptr;
     EventMgr* event_mgr = nullptr;
     int gpu_id = -1;
+    // If positive, executors swap long-lived tensors out to host memory while
+    // more than this fraction of the device memory limit is in use.
+    double tensor_swapping_memory_fraction = 0;
   };
 
   // Does not take ownership.
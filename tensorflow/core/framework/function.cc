@@ -1090,6 +1090,20 @@ string Canonicalize(const string& funcname, AttrSlice attrs,
                                       iter.second.shape.DebugString(),
                                       AttrKeyAndValue::kCEscape));
   }
+  for (const auto& iter : options.input_shapes) {
+    entries.push_back(AttrKeyAndValue("_input_shape", iter.first,
+                                      iter.second.DebugString(),
+                                      AttrKeyAndValue::kCEscape));
+  }
+  if (options.shape_specialization_threshold > 0) {
+    entries.push_back(AttrKeyAndValue(
+        "_shape_specialization", -1,
+        absl::StrCat(options.shape_specialization_threshold, ":",
+                     options.max_shape_specializations)));
+  }
+  if (options.reuse_rendezvous_across_runs) {
+    entries.push_back(AttrKeyAndValue("_reuse_rendezvous", -1, "true"));
+  }
   if (options.lib_def) {
     entries.push_back(AttrKeyAndValue(
         "_lib_def", -1,
@@ -725,6 +725,35 @@ class FunctionLibraryRuntime {
     std::unordered_map<int, DtypeAndPartialTensorShape>
         input_resource_dtypes_and_shapes;
 
+    // This interface is EXPERIMENTAL and subject to change.
+    //
+    // For multi-device functions, a mapping from _Arg node index to the static
+    // shape of a non-resource argument. The function is optimized for, and
+    // must only be run with, arguments of these shapes.
+    std::unordered_map<int, PartialTensorShape> input_shapes;
+
+    // This interface is EXPERIMENTAL and subject to change.
+    //
+    // If positive, once a multi-device function has been run this many times
+    // with the same input shapes, it is instantiated again with these shapes
+    // as `input_shapes`, so that graph optimizations can rely on them, and the
+    // subsequent runs with these shapes are dispatched to the specialized
+    // function. Runs with other shapes keep using the generic function.
+    int shape_specialization_threshold = 0;
+
+    // The maximum number of shape-specialized functions kept alive for a
+    // multi-device function. The least recently used one is released to make
+    // room for a new one.
+    int max_shape_specializations = 4;
+
+    // This interface is EXPERIMENTAL and subject to change.
+    //
+    // If true, runs of a multi-device function that executes within this
+    // process and whose caller does not provide a rendezvous reuse the
+    // rendezvous created for an earlier successful run, instead of creating
+    // and cleaning one up per run.
+    bool reuse_rendezvous_across_runs = false;
+
     // This interface is EXPERIMENTAL and subject to change.
     //
     // If non-null, the runtime will use `lib_def` to resolve function(s) named
@@ -16,13 +16,21 @@ limitations under the License.
 #include "tensorflow/core/framework/metrics.h"
 
 #include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/protobuf/data_service.pb.h"
+#include "tensorflow/tsl/lib/monitoring/collection_registry.h"
 #include "tensorflow/tsl/lib/monitoring/counter.h"
 #include "tensorflow/tsl/lib/monitoring/gauge.h"
+#include "tensorflow/tsl/lib/monitoring/metric_def.h"
 #include "tensorflow/tsl/lib/monitoring/sampler.h"
+#include "tensorflow/tsl/platform/mutex.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 
 namespace tensorflow {
 namespace metrics {
@@ -65,6 +73,24 @@ auto* graph_unused_outputs = tsl::monitoring::Counter<1>::New(
     "/tensorflow/core/graph_unused_outputs",
     "The number of unused outputs for ops of a given type.", "name");
 
+auto* recv_tensor_payload_raw_bytes = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/recv_tensor_payload_raw_bytes",
+    "The number of bytes of RecvTensor payloads before encoding, by codec.",
+    "codec");
+
+auto* recv_tensor_payload_encoded_bytes = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/recv_tensor_payload_encoded_bytes",
+    "The number of bytes of RecvTensor payloads after encoding, by codec.",
+    "codec");
+
+auto* recv_tensor_payload_encode_usecs = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/recv_tensor_payload_encode_usecs",
+    "The time spent encoding RecvTensor payloads, by codec.", "codec");
+
+auto* recv_tensor_payload_decode_usecs = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/recv_tensor_payload_decode_usecs",
+    "The time spent decoding RecvTensor payloads, by codec.", "codec");
+
 auto* tf_data_fetch_op_counter = tsl::monitoring::Counter<1>::New(
     "/tensorflow/data/fetch_op",
     "The number of times a tf.data operation that fetches output(s) of a "
@@ -178,6 +204,14 @@ auto* tf_data_service_snapshot_bytes_committed =
         "/tensorflow/data/service/snapshot_bytes_committed",
         "tf.data service distributed snapshot committed bytes.");
 
+auto* tf_data_service_get_element_pipelining_depth =
+    tsl::monitoring::Sampler<0>::New(
+        {"/tensorflow/data/service/get_element_pipelining_depth",
+         "The number of elements in flight when a tf.data service client "
+         "issues a batched GetElement request."},
+        // Power of 2 with bucket count of 12 (from 1 to 2048).
+        {tsl::monitoring::Buckets::Exponential(1, 2, 12)});
+
 auto* tf_data_service_data_transfer_protocol_used =
     tsl::monitoring::Counter<1>::New(
         "/tensorflow/data/service/data_transfer_protocol_used",
@@ -259,11 +293,23 @@ auto* function_graph_optimization_time_usecs = tsl::monitoring::Counter<0>::New(
     "The amount of time TensorFlow has spent optimizing function graphs, in "
     "microseconds. ");
 
+auto* grappler_function_cache_lookups = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/grappler/function_cache_lookups",
+    "The number of lookups of optimized function bodies in the Grappler "
+    "function optimization cache.",
+    "result");
+
 auto* xla_compilations = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilations",
     "The number of XLA compilations used to collect "
     "/tensorflow/core/xla_compilation_time_usecs");
 
+auto* xla_async_compilation_queue_depth =
+    tsl::monitoring::Gauge<int64_t, 0>::New(
+        "/tensorflow/core/xla_async_compilation_queue_depth",
+        "The number of asynchronous XLA compilations waiting for a compiler "
+        "thread.");
+
 auto* xla_compilation_time_usecs = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilation_time_usecs",
     "The total time spent on compiling XLA graphs in microseconds.");
@@ -303,6 +349,155 @@ auto* tf1_features_by_graph_count = tsl::monitoring::Counter<5>::New(
     "Marks which tf1 feature (if any) a graph contains.", "device", "context",
     "control_flow", "ref_variable", "manual_control_deps");
 
+// Thread pools collect their statistics themselves when
+// TF_ENABLE_THREADPOOL_STATS is set (see tsl::thread::ThreadPool::GetStats);
+// the metrics below only read them when they are collected. Pools with the
+// same name, e.g. the per-session inter-op pools, are reported together.
+using ThreadPoolStats = tsl::thread::ThreadPool::Stats;
+
+std::map<std::string, ThreadPoolStats> ThreadPoolStatsByName() {
+  std::map<std::string, ThreadPoolStats> result;
+  tsl::thread::ThreadPool::ForEachPoolStats([&](const ThreadPoolStats& stats) {
+    auto it = result.find(stats.name);
+    if (it == result.end()) {
+      result.emplace(stats.name, stats);
+    } else {
+      it->second.Add(stats);
+    }
+  });
+  return result;
+}
+
+HistogramProto ThreadPoolHistogramProto(const std::vector<int64_t>& bins,
+                                        int64_t sum) {
+  HistogramProto histogram;
+  int64_t num = 0;
+  for (int i = 0; i < bins.size(); ++i) {
+    histogram.add_bucket_limit(i + 1 < bins.size()
+                                   ? static_cast<double>(int64_t{1} << i)
+                                   : std::numeric_limits<double>::max());
+    histogram.add_bucket(bins[i]);
+    num += bins[i];
+  }
+  histogram.set_num(num);
+  histogram.set_sum(sum);
+  return histogram;
+}
+
+template <typename MetricDefType, typename CollectFn>
+std::unique_ptr<tsl::monitoring::CollectionRegistry::RegistrationHandle>
+RegisterThreadPoolMetric(const MetricDefType* metric_def,
+                         CollectFn collect_pool) {
+  return tsl::monitoring::CollectionRegistry::Default()->Register(
+      metric_def, [=](tsl::monitoring::MetricCollectorGetter getter) {
+        auto collector = getter.Get(metric_def);
+        for (const auto& it : ThreadPoolStatsByName()) {
+          collect_pool(it.first, it.second, &collector);
+        }
+      });
+}
+
+using tsl::monitoring::MetricDef;
+using tsl::monitoring::MetricKind;
+
+const auto* thread_pool_num_threads =
+    new MetricDef<MetricKind::kGauge, int64_t, 1>(
+        "/tensorflow/core/thread_pool/num_threads",
+        "The number of threads of the thread pool.", "pool");
+
+const auto* thread_pool_queue_depth =
+    new MetricDef<MetricKind::kGauge, int64_t, 1>(
+        "/tensorflow/core/thread_pool/queue_depth",
+        "The number of tasks scheduled on the thread pool that have not "
+        "started running yet.",
+        "pool");
+
+const auto* thread_pool_tasks_completed =
+    new MetricDef<MetricKind::kCumulative, int64_t, 1>(
+        "/tensorflow/core/thread_pool/tasks_completed",
+        "The number of tasks the thread pool has run.", "pool");
+
+const auto* thread_pool_tasks_stolen =
+    new MetricDef<MetricKind::kCumulative, int64_t, 1>(
+        "/tensorflow/core/thread_pool/tasks_stolen",
+        "The number of tasks scheduled from a thread of the pool that were "
+        "run by another thread of the pool.",
+        "pool");
+
+const auto* thread_pool_busy_usecs =
+    new MetricDef<MetricKind::kCumulative, int64_t, 2>(
+        "/tensorflow/core/thread_pool/busy_usecs",
+        "The time each thread of the pool spent running tasks in "
+        "microseconds.",
+        "pool", "thread");
+
+const auto* thread_pool_wait_time_usecs =
+    new MetricDef<MetricKind::kCumulative, HistogramProto, 1>(
+        "/tensorflow/core/thread_pool/wait_time_usecs",
+        "The time tasks waited in the thread pool queue in microseconds.",
+        "pool");
+
+const auto* thread_pool_run_time_usecs =
+    new MetricDef<MetricKind::kCumulative, HistogramProto, 1>(
+        "/tensorflow/core/thread_pool/run_time_usecs",
+        "The run time of the tasks of the thread pool in microseconds.",
+        "pool");
+
+auto* thread_pool_metric_registrations = [] {
+  auto* handles = new std::vector<std::unique_ptr<
+      tsl::monitoring::CollectionRegistry::RegistrationHandle>>();
+  handles->push_back(RegisterThreadPoolMetric(
+      thread_pool_num_threads,
+      [](const std::string& pool, const ThreadPoolStats& stats,
+         auto* collector) {
+        collector->CollectValue({pool}, int64_t{stats.num_threads});
+      }));
+  handles->push_back(RegisterThreadPoolMetric(
+      thread_pool_queue_depth,
+      [](const std::string& pool, const ThreadPoolStats& stats,
+         auto* collector) {
+        collector->CollectValue({pool}, stats.queue_depth);
+      }));
+  handles->push_back(RegisterThreadPoolMetric(
+      thread_pool_tasks_completed,
+      [](const std::string& pool, const ThreadPoolStats& stats,
+         auto* collector) {
+        collector->CollectValue({pool}, stats.tasks_completed);
+      }));
+  handles->push_back(RegisterThreadPoolMetric(
+      thread_pool_tasks_stolen,
+      [](const std::string& pool, const ThreadPoolStats& stats,
+         auto* collector) {
+        collector->CollectValue({pool}, stats.tasks_stolen);
+      }));
+  handles->push_back(RegisterThreadPoolMetric(
+      thread_pool_busy_usecs,
+      [](const std::string& pool, const ThreadPoolStats& stats,
+         auto* collector) {
+        for (int i = 0; i < stats.busy_time_usecs_per_thread.size(); ++i) {
+          collector->CollectValue({pool, absl::StrCat(i)},
+                                  stats.busy_time_usecs_per_thread[i]);
+        }
+      }));
+  handles->push_back(RegisterThreadPoolMetric(
+      thread_pool_wait_time_usecs,
+      [](const std::string& pool, const ThreadPoolStats& stats,
+         auto* collector) {
+        collector->CollectValue(
+            {pool}, ThreadPoolHistogramProto(stats.wait_time_histogram,
+                                             stats.total_wait_time_usecs));
+      }));
+  handles->push_back(RegisterThreadPoolMetric(
+      thread_pool_run_time_usecs,
+      [](const std::string& pool, const ThreadPoolStats& stats,
+         auto* collector) {
+        collector->CollectValue(
+            {pool}, ThreadPoolHistogramProto(stats.run_time_histogram,
+                                             stats.total_run_time_usecs));
+      }));
+  return handles;
+}();
+
 tsl::monitoring::Counter<2>* GetGraphOptimizationCounter() {
   static auto* graph_optimization_counter = tsl::monitoring::Counter<2>::New(
       "/tensorflow/core/graph_optimization_usecs",
@@ -458,6 +653,10 @@ void RecordTFDataServiceSnapshotBytesCommitted(int64_t bytes) {
   tf_data_service_snapshot_bytes_committed->GetCell()->IncrementBy(bytes);
 }
 
+void RecordTFDataServiceGetElementPipeliningDepth(int64_t num_elements) {
+  tf_data_service_get_element_pipelining_depth->GetCell()->Add(num_elements);
+}
+
 void RecordTFDataFilename(const string& name, const string& filename) {
   tf_data_filename_counter->GetCell(name, filename)->IncrementBy(1);
 }
@@ -557,6 +756,11 @@ void UpdateFunctionGraphOptimizationTime(const uint64 running_time_usecs) {
   }
 }
 
+void RecordGrapplerFunctionCacheLookup(bool hit) {
+  grappler_function_cache_lookups->GetCell(hit ? "hit" : "miss")
+      ->IncrementBy(1);
+}
+
 void UpdateTpuVariableDistributionTime(const uint64 distribution_time_usecs) {
   if (distribution_time_usecs > 0) {
     tpu_variable_distribution_time_usecs->GetCell()->IncrementBy(
@@ -574,10 +778,31 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs) {
   }
 }
 
+void UpdateXlaAsyncCompilationQueueDepth(int64_t delta) {
+  static tsl::mutex* mu = new tsl::mutex;
+  static int64_t queue_depth = 0;
+  tsl::mutex_lock lock(*mu);
+  queue_depth += delta;
+  xla_async_compilation_queue_depth->GetCell()->Set(queue_depth);
+}
+
 void RecordUnusedOutput(const string& op_name) {
   graph_unused_outputs->GetCell(op_name)->IncrementBy(1);
 }
 
+void RecordRecvTensorPayloadEncoded(const string& codec, int64_t raw_bytes,
+                                    int64_t encoded_bytes,
+                                    int64_t encode_usecs) {
+  recv_tensor_payload_raw_bytes->GetCell(codec)->IncrementBy(raw_bytes);
+  recv_tensor_payload_encoded_bytes->GetCell(codec)->IncrementBy(
+      encoded_bytes);
+  recv_tensor_payload_encode_usecs->GetCell(codec)->IncrementBy(encode_usecs);
+}
+
+void RecordRecvTensorPayloadDecoded(const string& codec, int64_t decode_usecs) {
+  recv_tensor_payload_decode_usecs->GetCell(codec)->IncrementBy(decode_usecs);
+}
+
 void IncrementTestCounter(const string& name, const string& label) {
   test_counters->GetCell(name, label)->IncrementBy(1);
 }
@@ -147,6 +147,10 @@ void RecordTFDataServiceCrossTrainerCacheSizeBytes(size_t bytes);
 // Records distributed tf.data snapshot bytes committed.
 void RecordTFDataServiceSnapshotBytesCommitted(int64_t bytes);
 
+// Records the number of elements in flight when a tf.data service client
+// issues a batched GetElement request.
+void RecordTFDataServiceGetElementPipeliningDepth(int64_t num_elements);
+
 // Records the file name read by a tf.data Dataset.
 //
 // The `name` argument identifies the Dataset type (e.g. "TFRecordDataset").
@@ -195,6 +199,16 @@ void UpdateGraphPendingQueueLength(uint64 len);
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
+// Records that a RecvTensor payload of `raw_bytes` bytes was encoded with
+// `codec` into `encoded_bytes` bytes in `encode_usecs`.
+void RecordRecvTensorPayloadEncoded(const string& codec, int64_t raw_bytes,
+                                    int64_t encoded_bytes,
+                                    int64_t encode_usecs);
+
+// Records that a RecvTensor payload encoded with `codec` was decoded in
+// `decode_usecs`.
+void RecordRecvTensorPayloadDecoded(const string& codec, int64_t decode_usecs);
+
 // Updates the metrics stored about time spent building graphs.
 //
 // By "GraphBuild", we refer to building a client graph, which is a sub-graph of
@@ -213,6 +227,10 @@ void UpdateGraphBuildTime(const uint64 running_time_usecs);
 // Updates the metric stored for time spent optimizing function graphs.
 void UpdateFunctionGraphOptimizationTime(const uint64 running_time_usecs);
 
+// Records a lookup of a function body in the Grappler function optimization
+// cache, which reuses optimized bodies across MetaOptimizer invocations.
+void RecordGrapplerFunctionCacheLookup(bool hit);
+
 // Records the activity of the first phase of the mlir bridge using the
 // tf_metadata.tf_mlir_bridge_first_phase_count metric.
 // device_type: tpu, cpu, gpu, etc.
@@ -338,6 +356,10 @@ void UpdateTpuVariableDistributionTime(const uint64 distribution_time_usecs);
 // Updates the metrics stored about time XLA spents compiling graphs.
 void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 
+// Adds `delta` to the number of asynchronous XLA compilations waiting for a
+// compiler thread, across all devices.
+void UpdateXlaAsyncCompilationQueueDepth(int64_t delta);
+
 // Increments (by 1) a simple integer counter that is exposed for testing.
 void IncrementTestCounter(const string& name, const string& label);
 
@@ -51,6 +51,9 @@ constexpr double kOutlierSigmas = 2.0;
 // processing time. For example, a value of 1 would mean that the target time is
 // faster than 84% of the gap times.
 constexpr double kTargetTimeSigmas = 1.0;
+// The share of the RAM budget that stays available to the tunable buffers, no
+// matter how much memory the in-memory caches are expected to need.
+constexpr double kMinTunableRamBudgetShare = 0.5;
 
 constexpr char kFlatMap[] = "FlatMap";
 constexpr char kInterleave[] = "Interleave";
@@ -262,6 +265,11 @@ inline bool IsAsyncNode(const std::shared_ptr<Node> node) {
   return node->IsAsync();
 }
 
+// Helper function for node traversal that returns only in-memory cache nodes.
+inline bool IsMemoryCacheNode(const std::shared_ptr<Node> node) {
+  return node->IsMemoryCache();
+}
+
 // Wrapper for the square function to reduce verbosity.
 inline double Square(double x) { return x * x; }
 
@@ -860,6 +868,49 @@ class KnownRatio : public Node {
   const double ratio_;
 };
 
+class MemoryCache : public KnownRatio {
+ public:
+  MemoryCache(Node::Args args, int64_t cardinality)
+      : KnownRatio(args, /*ratio=*/1), cardinality_(cardinality) {}
+
+  virtual ~MemoryCache() {}
+
+  bool IsMemoryCache() const override { return true; }
+
+  Status ToProto(ModelProto::Node* node_proto) const {
+    TF_RETURN_IF_ERROR(KnownRatio::ToProto(node_proto));
+    node_proto->set_node_class(NodeClass::MEMORY_CACHE);
+    node_proto->set_cardinality(cardinality_);
+    return OkStatus();
+  }
+
+ protected:
+  std::shared_ptr<Node> Clone(std::shared_ptr<Node> output) const override
+      TF_SHARED_LOCKS_REQUIRED(mu_) {
+    return std::make_shared<MemoryCache>(Args{id_, name_, std::move(output)},
+                                         cardinality_);
+  }
+
+  // The cached elements are recorded as buffered elements.
+  double ModeledBufferedBytes() const override TF_SHARED_LOCKS_REQUIRED(mu_) {
+    return buffered_bytes_;
+  }
+
+  // The cache is expected to grow to `cardinality_` elements of the average
+  // size measured so far.
+  double MaximumBufferedBytes() const override TF_SHARED_LOCKS_REQUIRED(mu_) {
+    const double buffered_bytes = buffered_bytes_;
+    if (cardinality_ <= 0) {
+      return buffered_bytes;
+    }
+    return std::max(buffered_bytes, AverageBufferedElementSize() *
+                                        static_cast<double>(cardinality_));
+  }
+
+ private:
+  const int64_t cardinality_;
+};
+
 class AsyncRatio : public Node {
  public:
   AsyncRatio(Node::Args args, double ratio, double memory_ratio,
@@ -1407,6 +1458,11 @@ std::shared_ptr<Node> MakeSourceNode(Node::Args args) {
   return MakeKnownRatioNode(std::move(args), 0);
 }
 
+std::shared_ptr<Node> MakeMemoryCacheNode(Node::Args args,
+                                          int64_t cardinality) {
+  return std::make_shared<MemoryCache>(std::move(args), cardinality);
+}
+
 std::shared_ptr<Node> MakeUnknownRatioNode(Node::Args args) {
   return std::make_shared<UnknownRatio>(std::move(args));
 }
@@ -2015,14 +2071,7 @@ void Node::TotalBufferedBytesHelper(Node::NodeValues* total_bytes) const
     return;
   }
 
-  double result = 0;
-  auto* parameter = gtl::FindOrNull(parameters_, kBufferSize);
-  if (!parameter) {
-    parameter = gtl::FindOrNull(parameters_, kParallelism);
-  }
-  if (parameter) {
-    result = buffered_bytes_;
-  }
+  double result = ModeledBufferedBytes();
   for (auto& input : inputs_) {
     result += total_bytes->at(input->long_name());
   }
@@ -2047,6 +2096,13 @@ double Node::MaximumBufferedBytes() const TF_SHARED_LOCKS_REQUIRED(mu_) {
   return 0;
 }
 
+double Node::ModeledBufferedBytes() const TF_SHARED_LOCKS_REQUIRED(mu_) {
+  if (parameters_.contains(kBufferSize) || parameters_.contains(kParallelism)) {
+    return buffered_bytes_;
+  }
+  return 0;
+}
+
 Status Node::ToProto(ModelProto::Node* node_proto) const {
   tf_shared_lock l(mu_);
   node_proto->set_id(id_);
@@ -2158,6 +2214,9 @@ Status Node::FromProto(ModelProto::Node node_proto,
       *node = std::make_shared<AsyncUnknownRatio>(
           args, /*parameters=*/std::vector<std::shared_ptr<Parameter>>());
       break;
+    case NodeClass::MEMORY_CACHE:
+      *node = std::make_shared<MemoryCache>(args, node_proto.cardinality());
+      break;
     default:
       *node = std::make_shared<Unknown>(args);
   }
@@ -2281,6 +2340,7 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64_t cpu_budget,
   if (experiments_.contains("autotune_buffer_optimization")) {
     OptimizeBuffers(snapshot, optimization_params.ram_budget());
   }
+  CheckMemoryCacheBudget(snapshot, optimization_params.ram_budget());
   {
     // Save the snapshot of the model proto including the parameters used by
     // autotune. This will be used as the model proto returned in `tfstreamz`.
@@ -2351,9 +2411,11 @@ bool Model::ShouldStop(int64_t cpu_budget, int64_t ram_budget,
   bool all_max = AreAllParametersMax(
       *cpu_budget_reached ? buffer_size_parameters : parameters);
 
-  // If all parameters have reached their maximum values or RAM budget is
-  // reached, we stop the iterations.
-  return all_max || TotalMaximumBufferedBytes(snapshot) > ram_budget;
+  // If all parameters have reached their maximum values or the RAM budget left
+  // by the in-memory caches is reached, we stop the iterations.
+  const double cache_bytes = MemoryCacheBytes(snapshot);
+  return all_max || TotalMaximumBufferedBytes(snapshot) - cache_bytes >
+                        TunableRamBudget(ram_budget, cache_bytes);
 }
 
 // TODO(jsimsa): Add support for tracking and using the model input time.
@@ -2516,23 +2578,39 @@ void Model::OptimizeHillClimbHelper(
     }
     pair.second->value = pair.second->min;
   }
+  // The in-memory caches need the same memory whatever the parameter values
+  // are, so only the tunable buffers are checked against what they leave.
+  const double cache_bytes = MemoryCacheBytes(snapshot);
+  const double ram_budget =
+      TunableRamBudget(optimization_params.ram_budget(), cache_bytes);
+  auto buffered_bytes = [this, &snapshot, cache_bytes]() {
+    return TotalMaximumBufferedBytes(snapshot) - cache_bytes;
+  };
   while (!cancellation_manager->IsCancelled()) {
     const double output_time =
         OutputTime(snapshot, optimization_params.model_input_time(),
                    /*gradients=*/nullptr);
-    if (should_stop(parameters, processing_time, output_time,
-                    TotalMaximumBufferedBytes(snapshot))) {
+    if (should_stop(parameters, processing_time, output_time, buffered_bytes(),
+                    ram_budget)) {
       break;
     }
 
     double best_delta = -1.0L;
     Parameter* best_parameter = nullptr;
+    bool ram_budget_limited = false;
     for (auto& pair : parameters) {
       if (pair.second->value >= pair.second->max ||
           (skip_buffer_sizes && (pair.second->name == kBufferSize))) {
         continue;
       }
       pair.second->value++;
+      // Only consider increments that keep the tunable buffers within the
+      // RAM budget left by the in-memory caches.
+      if (buffered_bytes() > ram_budget) {
+        pair.second->value--;
+        ram_budget_limited = true;
+        continue;
+      }
       double new_output_time =
           OutputTime(snapshot, optimization_params.model_input_time(),
                      /*gradients=*/nullptr);
@@ -2545,10 +2623,13 @@ void Model::OptimizeHillClimbHelper(
       pair.second->value--;
     }
     if (!best_parameter) {
+      if (ram_budget_limited) {
+        metrics::RecordTFDataAutotuneStoppingCriteria("max_buffered_bytes");
+      }
       VLOG(2) << "Failed to find a tunable parameter that would further "
-                 "decrease the output time. This suggests that the hill-climb "
-                 "optimization got stuck in a local maximum. The optimization "
-                 "attempt will stop now.";
+                 "decrease the output time within the RAM budget. This "
+                 "suggests that the hill-climb optimization got stuck in a "
+                 "local maximum. The optimization attempt will stop now.";
       break;
     }
     best_parameter->value++;
@@ -2616,6 +2697,9 @@ void Model::OptimizeStageBasedParallelism(
     return;
   }
   NodeParallelismParameters node_parallelism;
+  const double cache_bytes = MemoryCacheBytes(snapshot);
+  const double ram_budget =
+      TunableRamBudget(optimization_params.ram_budget(), cache_bytes);
   std::pair<double, Node*> critical_root = critical_root_status.value();
   while (critical_root.first > target_time_nsec) {
     Parameter* parallelism_parameter =
@@ -2637,8 +2721,7 @@ void Model::OptimizeStageBasedParallelism(
       break;
     }
     parallelism_parameter->value += 1.0;
-    if (TotalMaximumBufferedBytes(snapshot) >
-        optimization_params.ram_budget()) {
+    if (TotalMaximumBufferedBytes(snapshot) - cache_bytes > ram_budget) {
       // Increasing the parallelism by 1 exceeded ram budget. Reduce it back and
       // stop optimization because we cannot improve the most critical stage.
       // There is also a decent chance that the current optimization iteration
@@ -2748,6 +2831,47 @@ bool Model::UpsizeBuffers(std::shared_ptr<Node> snapshot, int64_t ram_budget) {
   return upsized;
 }
 
+void Model::CheckMemoryCacheBudget(std::shared_ptr<Node> snapshot,
+                                   int64_t ram_budget) {
+  const double cache_bytes = MemoryCacheBytes(snapshot);
+  if (cache_bytes > ram_budget) {
+    constexpr float TEN_MINUTES = 60.0 * 10.0;
+    LOG_EVERY_N_SEC(WARNING, TEN_MINUTES)
+        << "The in-memory caches of the input pipeline are expected to need "
+        << static_cast<int64_t>(cache_bytes)
+        << " bytes, which exceeds the autotuning RAM budget of " << ram_budget
+        << " bytes. Consider caching to a file with `dataset.cache(filename)` "
+           "or caching a smaller part of the input pipeline (message logged "
+           "every 10 minutes).";
+  }
+}
+
+double Model::MemoryCacheBytes(std::shared_ptr<Node> snapshot) {
+  Node::NodeVector caches =
+      snapshot->CollectNodes(TraversalOrder::BFS, IsMemoryCacheNode);
+  if (snapshot->IsMemoryCache()) {
+    caches.push_back(snapshot);
+  }
+  double cache_bytes = 0;
+  for (const auto& cache : caches) {
+    if (!cache->autotune()) {
+      continue;
+    }
+    // Exclude the buffers of the cache's inputs.
+    double input_bytes = 0;
+    for (const auto& input : cache->inputs()) {
+      input_bytes += input->TotalMaximumBufferedBytes();
+    }
+    cache_bytes += cache->TotalMaximumBufferedBytes() - input_bytes;
+  }
+  return cache_bytes;
+}
+
+double Model::TunableRamBudget(int64_t ram_budget, double cache_bytes) {
+  return std::max(static_cast<double>(ram_budget) - cache_bytes,
+                  kMinTunableRamBudgetShare * ram_budget);
+}
+
 void Model::ResetBufferWatermarks() {
   Node::NodeVector nodes =
       output()->CollectNodes(TraversalOrder::BFS, IsAsyncNode);
@@ -2763,12 +2887,12 @@ void Model::OptimizeHillClimb(std::shared_ptr<Node> snapshot,
   auto should_stop = [&optimization_params](const ModelParameters& parameters,
                                             double processing_time,
                                             double output_time,
-                                            double buffered_bytes) {
+                                            double buffered_bytes,
+                                            double ram_budget) {
     const bool all_max = AreAllParametersMax(parameters);
     const bool output_time_budget_exceeded =
         output_time < processing_time / optimization_params.cpu_budget();
-    const bool ram_budget_exceeded =
-        buffered_bytes > optimization_params.ram_budget();
+    const bool ram_budget_exceeded = buffered_bytes > ram_budget;
     if (all_max) {
       metrics::RecordTFDataAutotuneStoppingCriteria("all_max");
     }
@@ -2788,13 +2912,11 @@ void Model::OptimizeMaxParallelism(
     std::shared_ptr<Node> snapshot,
     const OptimizationParams& optimization_params,
     CancellationManager* cancellation_manager) {
-  auto should_stop = [&optimization_params](const ModelParameters& parameters,
-                                            double processing_time,
-                                            double output_time,
-                                            double buffered_bytes) {
+  auto should_stop = [](const ModelParameters& parameters,
+                        double processing_time, double output_time,
+                        double buffered_bytes, double ram_budget) {
     const bool all_max = AreAllParametersMax(parameters);
-    const bool ram_budget_exceeded =
-        buffered_bytes > optimization_params.ram_budget();
+    const bool ram_budget_exceeded = buffered_bytes > ram_budget;
     if (all_max) {
       metrics::RecordTFDataAutotuneStoppingCriteria("all_max");
     }
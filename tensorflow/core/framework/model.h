@@ -389,6 +389,9 @@ class Node {
   // Returns true for asynchronous nodes; false otherwise.
   virtual bool IsAsync() const { return false; }
 
+  // Returns true for nodes that cache their input in memory; false otherwise.
+  virtual bool IsMemoryCache() const { return false; }
+
   // Returns the ratio of the node, which is defined as the number of elements
   // per input needed by the node to produce an element, e.g. batch size of a
   // `Batch`. It can be 0 if the ratio is unknown.
@@ -667,6 +670,11 @@ class Node {
   // that the optimization algorithm respects the memory budget.
   virtual double MaximumBufferedBytes() const TF_SHARED_LOCKS_REQUIRED(mu_);
 
+  // Returns the bytes currently buffered by the node itself that count towards
+  // the memory budget. By default only nodes with a tunable buffer size or
+  // parallelism are assumed to buffer bytes.
+  virtual double ModeledBufferedBytes() const TF_SHARED_LOCKS_REQUIRED(mu_);
+
   // Restores node from the proto. Note that this is not done recursively, i.e.
   // input nodes are not restored.
   static Status FromProtoHelper(ModelProto::Node node_proto,
@@ -750,6 +758,14 @@ std::shared_ptr<Node> MakeAsyncKnownRatioNode(
 // Source nodes represent data sources.
 std::shared_ptr<Node> MakeSourceNode(Node::Args args);
 
+// MemoryCache nodes represent datasets that cache their input elements in
+// memory and produce them one-for-one. The bytes recorded as buffered by the
+// node (i.e. the cached elements) count towards the memory budget. If
+// `cardinality` is positive, the node is expected to cache `cardinality`
+// elements eventually, and the budget reserves room for all of them based on
+// the measured element size.
+std::shared_ptr<Node> MakeMemoryCacheNode(Node::Args args, int64_t cardinality);
+
 // UnknownMany nodes represent datasets that synchronously consume an
 // unknown number of input elements per output.
 //
@@ -866,9 +882,10 @@ class Model {
 
  private:
   // Determines whether optimization should stop given total processing time,
-  // estimated output time, and estimated number of buffers bytes.
-  using StopPredicate =
-      std::function<bool(const ModelParameters&, double, double, double)>;
+  // estimated output time, estimated number of bytes of the tunable buffers,
+  // and the part of the RAM budget available to the tunable buffers.
+  using StopPredicate = std::function<bool(const ModelParameters&, double,
+                                           double, double, double)>;
 
   static constexpr int64_t kOptimizationPeriodMinMs = 10;
   static constexpr int64_t kOptimizationPeriodMaxMs =
@@ -886,6 +903,23 @@ class Model {
   // respecting the ram budget. Returns true if any buffer is upsized.
   bool UpsizeBuffers(std::shared_ptr<Node> snapshot, int64_t ram_budget);
 
+  // Logs a warning if the in-memory caches of the nodes rooted at `snapshot`
+  // are expected to need more memory than `ram_budget`, which leaves no room
+  // for the buffers tuned by autotuning.
+  void CheckMemoryCacheBudget(std::shared_ptr<Node> snapshot,
+                              int64_t ram_budget);
+
+  // Returns the number of bytes the in-memory caches of the nodes rooted at
+  // `snapshot` are expected to need, excluding the buffers of their inputs.
+  // The result does not depend on the tunable parameters.
+  double MemoryCacheBytes(std::shared_ptr<Node> snapshot);
+
+  // Returns the part of `ram_budget` available to the tunable buffers when
+  // in-memory caches are expected to need `cache_bytes`. The tunable buffers
+  // always keep at least `kMinTunableRamBudgetShare` of the budget, so that
+  // a cache that does not fit does not pin all parallelism at its minimum.
+  static double TunableRamBudget(int64_t ram_budget, double cache_bytes);
+
   // Reset buffer watermarks of all asynchronous nodes to their buffered
   // elements.
   void ResetBufferWatermarks();
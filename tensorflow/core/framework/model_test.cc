@@ -1345,6 +1345,84 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
                          ::testing::Values(0, 1, 2, 3));
 
+TEST(MemoryCacheTest, BufferedBytes) {
+  std::shared_ptr<Node> cache =
+      model::MakeMemoryCacheNode({1, "Cache", nullptr}, /*cardinality=*/10);
+  EXPECT_TRUE(cache->IsMemoryCache());
+  EXPECT_EQ(cache->TotalBufferedBytes(), 0);
+  EXPECT_EQ(cache->TotalMaximumBufferedBytes(), 0);
+
+  cache->record_buffer_event(20, 1);
+  cache->record_buffer_event(30, 1);
+  EXPECT_EQ(cache->TotalBufferedBytes(), 50);
+  // The cache is expected to hold 10 elements of 25 bytes.
+  EXPECT_EQ(cache->TotalMaximumBufferedBytes(), 250);
+
+  std::shared_ptr<Node> snapshot = cache->Snapshot();
+  EXPECT_TRUE(snapshot->IsMemoryCache());
+  EXPECT_EQ(snapshot->TotalMaximumBufferedBytes(), 250);
+
+  ModelProto::Node node_proto;
+  TF_ASSERT_OK(cache->ToProto(&node_proto));
+  EXPECT_EQ(node_proto.node_class(), NodeClass::MEMORY_CACHE);
+  std::shared_ptr<Node> restored;
+  TF_ASSERT_OK(Node::FromProto(node_proto, nullptr, &restored));
+  EXPECT_TRUE(restored->IsMemoryCache());
+  EXPECT_EQ(restored->TotalMaximumBufferedBytes(), 250);
+
+  std::shared_ptr<Node> unknown_cardinality =
+      model::MakeMemoryCacheNode({2, "Cache", nullptr}, /*cardinality=*/0);
+  unknown_cardinality->record_buffer_event(20, 1);
+  EXPECT_EQ(unknown_cardinality->TotalBufferedBytes(), 20);
+  EXPECT_EQ(unknown_cardinality->TotalMaximumBufferedBytes(), 20);
+}
+
+class OptimizeWithMemoryCacheTest
+    : public ::testing::TestWithParam<std::tuple<int64_t, double>> {};
+
+TEST_P(OptimizeWithMemoryCacheTest, Model) {
+  const int64_t ram_budget = std::get<0>(GetParam());
+  const double expected_parallelism = std::get<1>(GetParam());
+
+  std::shared_ptr<Node> map = model::MakeAsyncKnownRatioNode(
+      {1, "ParallelMap", nullptr}, 1,
+      {model::MakeParameter(
+          "parallelism",
+          std::make_shared<SharedState>(/*value=*/model::kAutotune,
+                                        std::make_shared<mutex>(),
+                                        std::make_shared<condition_variable>()),
+          /*min=*/1, /*max=*/10)});
+  map->record_buffer_event(100, 1);
+  map->record_element();
+  map->record_bytes_produced(100);
+  std::shared_ptr<Node> cache =
+      model::MakeMemoryCacheNode({2, "Cache", map}, /*cardinality=*/10);
+  cache->record_buffer_event(50, 1);
+  cache->record_element();
+  cache->record_bytes_produced(50);
+
+  model::Model model;
+  model.AddNode([&map](model::Node::Args args) { return map; }, "ParallelMap",
+                nullptr, &map);
+  model.AddNode([&cache](model::Node::Args args) { return cache; }, "Cache",
+                map, &cache);
+
+  CancellationManager cancellation_manager;
+  model.Optimize(model::AutotuneAlgorithm::MAX_PARALLELISM, /*cpu_budget=*/40,
+                 ram_budget, /*model_input_time=*/0, &cancellation_manager);
+  // The cache reserves 500 bytes of the budget, and each parallel call
+  // buffers 100 bytes. The parallel calls keep at least half of the budget
+  // when the cache needs more than that.
+  EXPECT_EQ(map->parameter_value("parallelism"), expected_parallelism);
+}
+
+INSTANTIATE_TEST_SUITE_P(Test, OptimizeWithMemoryCacheTest,
+                         ::testing::Values(std::make_tuple(1000, 5),
+                                           std::make_tuple(1200, 7),
+                                           std::make_tuple(10000, 10),
+                                           std::make_tuple(800, 4),
+                                           std::make_tuple(400, 2)));
+
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
   EXPECT_FALSE(source->is_recording());
@@ -379,6 +379,10 @@ Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
     CHECK(allocator);
   } else {
     allocator = params_->device->GetAllocator(attr);
+    if (TF_PREDICT_FALSE(params_->step_arena_allocator != nullptr) &&
+        allocator == params_->step_arena_wrapped_allocator) {
+      allocator = params_->step_arena_allocator;
+    }
   }
   if (TF_PREDICT_FALSE(track_allocations())) {
     DCHECK(tracking_state_);
@@ -808,6 +812,16 @@ Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
       op_kernel().name_view().data(), step_id(), "output", type,
       [&shape]() { return shape.DebugString(); });
   auto output_tensor = std::make_unique<Tensor>();
+  if (TF_PREDICT_FALSE(params_->preallocated_outputs != nullptr) &&
+      attr.scope_id == 0) {
+    const Tensor* preallocated = params_->preallocated_outputs[index];
+    if (preallocated != nullptr && preallocated->dtype() == type &&
+        output_tensor->CopyFrom(*preallocated, shape)) {
+      outputs_[index] = TensorValue(output_tensor.release());
+      *output = outputs_[index].tensor;
+      return OkStatus();
+    }
+  }
   Status s = allocate_tensor(type, shape, output_tensor.get(), attr);
   if (s.ok()) {
     outputs_[index] = TensorValue(output_tensor.release());
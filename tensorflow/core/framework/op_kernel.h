@@ -672,6 +672,12 @@ class OpKernelContext {
     bool run_all_kernels_inline = false;
     const std::string* executor_type = nullptr;
 
+    // Per-step arena support. If non-null, allocations that would be served
+    // by `step_arena_wrapped_allocator` are served by `step_arena_allocator`
+    // instead.
+    Allocator* step_arena_allocator = nullptr;
+    Allocator* step_arena_wrapped_allocator = nullptr;
+
     // TensorSliceReaderCache support.
     checkpoint::TensorSliceReaderCacheWrapper* slice_reader_cache = nullptr;
 
@@ -691,6 +697,11 @@ class OpKernelContext {
     // outputs are required.
     bool* outputs_required_array = nullptr;
 
+    // If not null, `allocate_output(i, ...)` shares the buffer of
+    // `preallocated_outputs[i]` (if not null) instead of allocating a new one,
+    // provided that the dtype and number of elements match.
+    const Tensor* const* preallocated_outputs = nullptr;
+
     // For access to distributed coordination service.
     tsl::CoordinationServiceAgent* coordination_service_agent = nullptr;
   };
@@ -19,8 +19,11 @@ limitations under the License.
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <list>
 #include <memory>
+#include <set>
+#include <utility>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/run_handler_util.h"
@@ -40,6 +43,14 @@ namespace {
 static constexpr int32_t kMaxConcurrentHandlers = 128;
 // LINT.ThenChange(//tensorflow/core/framework/run_handler_test.cc)
 
+// Minimum number of completed requests before the pool uses their run times
+// to shed requests that cannot meet their deadline.
+static constexpr int64_t kMinCompletedRequestsForShedding = 16;
+
+// Deadline of requests without a deadline, which are scheduled after all
+// requests with a deadline of the same priority.
+static constexpr uint64 kNoDeadline = std::numeric_limits<uint64>::max();
+
 typedef typename internal::RunHandlerEnvironment::Task Task;
 typedef Eigen::RunQueue<Task, 1024> Queue;
 
@@ -735,11 +746,14 @@ class RunHandler::Impl {
   // Stores now time (in microseconds) since unix epoch when the handler is
   // requested via RunHandlerPool::Get().
   uint64 start_time_us() const { return start_time_us_; }
+  // Time (in microseconds since unix epoch) by which the request must be done,
+  // or kNoDeadline.
+  uint64 deadline_us() const { return deadline_us_; }
   int64_t step_id() const { return step_id_; }
   void ScheduleInterOpClosure(std::function<void()> fn);
   void ScheduleIntraOpClosure(std::function<void()> fn);
 
-  void Reset(int64_t step_id,
+  void Reset(int64_t step_id, uint64 deadline_us,
              const RunOptions::Experimental::RunHandlerPoolOptions& options);
 
   RunHandlerPool::Impl* pool_impl() { return pool_impl_; }
@@ -764,6 +778,7 @@ class RunHandler::Impl {
 
   RunHandlerPool::Impl* pool_impl_;  // NOT OWNED.
   uint64 start_time_us_;
+  uint64 deadline_us_;
   int64_t step_id_;
   std::unique_ptr<thread::ThreadPoolInterface> thread_pool_interface_;
   internal::ThreadWorkSource tws_;
@@ -841,12 +856,21 @@ class RunHandlerPool::Impl {
                     static_cast<int32>(ParamFromEnvWithDefault(
                         "TF_RUN_HANDLER_MAX_CONCURRENT_HANDLERS",
                         kMaxConcurrentHandlers))));
+    const uint64 now_us = EnvTime::NowMicros();
+    const uint64 deadline_us =
+        timeout_in_ms > 0 ? now_us + timeout_in_ms * 1000 : kNoDeadline;
     uint64 version;
     int num_active_requests;
     RunHandler::Impl* handler_impl;
     {
       mutex_lock l(mu_);
-      if (!has_free_handler()) {
+      if (options.shed_infeasible_requests() &&
+          !CanMeetDeadline(deadline_us, now_us)) {
+        VLOG(1) << "Shedding request " << step_id
+                << " that cannot meet its deadline";
+        return nullptr;
+      }
+      if (!has_free_handler() || !handler_waiters_.empty()) {
         profiler::TraceMe activity(
             [&] {
               return strings::StrCat("WaitingForHandler#step_id=", step_id,
@@ -857,35 +881,53 @@ class RunHandlerPool::Impl {
             strings::StrCat("RunHandlerPool::Impl::Get waiting for a handler "
                             "with timeout in millisecond",
                             timeout_in_ms));
-        if (timeout_in_ms == 0) {
-          mu_.Await(Condition(this, &Impl::has_free_handler));
-        } else if (!mu_.AwaitWithDeadline(
-                       Condition(this, &Impl::has_free_handler),
-                       EnvTime::NowNanos() + timeout_in_ms * 1000 * 1000)) {
+        // Free handlers are handed out to the waiting requests in the order
+        // in which the requests are scheduled (see SchedulingKey()).
+        HandlerWaiter waiter{
+            this, handler_waiters_.emplace(
+                      SchedulingKey(options.priority(), deadline_us))};
+        bool acquired = true;
+        if (deadline_us == kNoDeadline) {
+          mu_.Await(Condition(&waiter, &HandlerWaiter::CanAcquire));
+        } else {
+          acquired = mu_.AwaitWithDeadline(
+              Condition(&waiter, &HandlerWaiter::CanAcquire),
+              deadline_us * 1000);
+        }
+        handler_waiters_.erase(waiter.position);
+        if (!acquired) return nullptr;
+        if (options.shed_infeasible_requests() &&
+            !CanMeetDeadline(deadline_us, EnvTime::NowMicros())) {
+          VLOG(1) << "Shedding request " << step_id
+                  << " that cannot meet its deadline";
           return nullptr;
         }
       }
-      // Remove the last entry from free_handlers_ and add to the end of
+      // Remove the last entry from free_handlers_ and add it to
       // sorted_active_handlers_.
       handler_impl = free_handlers_.back();
-      handler_impl->Reset(step_id, options);
+      handler_impl->Reset(step_id, deadline_us, options);
       free_handlers_.pop_back();
-
-      num_active_requests = sorted_active_handlers_.size() + 1;
+      sorted_active_handlers_.push_back(handler_impl);
+
+      // Requests whose deadline has passed are scheduled last, so that they
+      // do not delay requests that can still meet theirs. The sort is stable,
+      // so requests with the same key run in the order of their arrival.
+      const uint64 sort_time_us = EnvTime::NowMicros();
+      sorted_active_handlers_.sort([sort_time_us](RunHandler::Impl* a,
+                                                  RunHandler::Impl* b) {
+        const bool a_missed = a->deadline_us() < sort_time_us;
+        const bool b_missed = b->deadline_us() < sort_time_us;
+        if (a_missed != b_missed) return b_missed;
+        return SchedulingKey(a->priority(), a->deadline_us()) <
+               SchedulingKey(b->priority(), b->deadline_us());
+      });
+
+      num_active_requests = sorted_active_handlers_.size();
       thread_work_sources->resize(num_active_requests);
-      int priority = options.priority();
-      auto it = sorted_active_handlers_.cbegin();
-      bool new_handler_inserted = false;
-      for (int i = 0; i < num_active_requests; ++i) {
-        if (!new_handler_inserted && (it == sorted_active_handlers_.cend() ||
-                                      priority > (*it)->priority())) {
-          sorted_active_handlers_.insert(it, handler_impl);
-          new_handler_inserted = true;
-          // Point to the newly added handler.
-          --it;
-        }
-        (*thread_work_sources)[i] = (*it)->tws();
-        ++it;
+      int i = 0;
+      for (RunHandler::Impl* active_handler : sorted_active_handlers_) {
+        (*thread_work_sources)[i++] = active_handler->tws();
       }
       version = ++version_;
     }
@@ -903,6 +945,7 @@ class RunHandlerPool::Impl {
     uint64 now = tensorflow::EnvTime::NowMicros();
     double elapsed = (now - handler->start_time_us()) / 1000.0;
     time_hist_.Add(elapsed);
+    ++num_completed_requests_;
 
     // Erase from and update sorted_active_handlers_. Add it to the end of
     // free_handlers_.
@@ -934,7 +977,46 @@ class RunHandlerPool::Impl {
     return ret;
   }
 
+  std::vector<int64_t> GetActiveHandlerStepIdsForTesting()
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    std::vector<int64_t> ret;
+    for (const auto& handler_impl : sorted_active_handlers_) {
+      ret.push_back(handler_impl->step_id());
+    }
+    return ret;
+  }
+
  private:
+  // Requests are scheduled by decreasing priority, then by earliest deadline.
+  typedef std::pair<int64_t, uint64> SchedulingKeyType;
+  static SchedulingKeyType SchedulingKey(int64_t priority, uint64 deadline_us) {
+    return {-priority, deadline_us};
+  }
+
+  // A request waiting in Get() for a free handler.
+  struct HandlerWaiter {
+    Impl* pool_impl;
+    std::multiset<SchedulingKeyType>::iterator position;
+
+    bool CanAcquire() TF_EXCLUSIVE_LOCKS_REQUIRED(pool_impl->mu_) {
+      return pool_impl->has_free_handler() &&
+             pool_impl->handler_waiters_.begin() == position;
+    }
+  };
+
+  // Returns false if the median run time of the completed requests exceeds
+  // the time left until `deadline_us`.
+  bool CanMeetDeadline(uint64 deadline_us, uint64 now_us)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (deadline_us == kNoDeadline) return true;
+    if (deadline_us <= now_us) return false;
+    if (num_completed_requests_ < kMinCompletedRequestsForShedding) {
+      return true;
+    }
+    return (deadline_us - now_us) / 1000.0 >= time_hist_.Median();
+  }
+
   void RecomputePoolStats(
       int num_active_requests, uint64 version,
       const Eigen::MaxSizeVector<internal::ThreadWorkSource*>&
@@ -953,17 +1035,21 @@ class RunHandlerPool::Impl {
 
   std::unique_ptr<internal::RunHandlerThreadPool> run_handler_thread_pool_;
   // Thread compatible part used only by lock under RunHandlerPool.
-  // Handlers are sorted by start time.
-  // TODO(azaks): sort by the remaining latency budget.
+  // Handlers are sorted by decreasing priority, then by earliest deadline,
+  // then by start time. Handlers whose deadline had passed when the list was
+  // last sorted come last.
   // TODO(chaox): Consider other data structure for maintaining the sorted
-  // active handlers if the searching overhead(currently O(n)) becomes the
-  // bottleneck.
+  // active handlers if the sorting overhead (currently O(n log n) per Get())
+  // becomes the bottleneck.
   std::list<RunHandler::Impl*> sorted_active_handlers_ TF_GUARDED_BY(mu_);
   std::vector<RunHandler::Impl*> free_handlers_ TF_GUARDED_BY(mu_);
+  // Scheduling keys of the requests waiting for a free handler.
+  std::multiset<SchedulingKeyType> handler_waiters_ TF_GUARDED_BY(mu_);
   std::vector<std::unique_ptr<RunHandler::Impl>> handlers_ TF_GUARDED_BY(mu_);
 
   // Histogram of elapsed runtime of every handler (in ms).
   histogram::Histogram time_hist_ TF_GUARDED_BY(mu_);
+  int64_t num_completed_requests_ TF_GUARDED_BY(mu_) = 0;
 
   int64_t iterations_ TF_GUARDED_BY(mu_);
   mutex mu_;
@@ -1059,7 +1145,7 @@ void RunHandler::Impl::ThreadPoolInterfaceWrapper::Schedule(
 RunHandler::Impl::Impl(RunHandlerPool::Impl* pool_impl)
     : pool_impl_(pool_impl) {
   thread_pool_interface_.reset(new ThreadPoolInterfaceWrapper(this));
-  Reset(0, RunOptions::Experimental::RunHandlerPoolOptions());
+  Reset(0, kNoDeadline, RunOptions::Experimental::RunHandlerPoolOptions());
 }
 
 void RunHandler::Impl::ScheduleInterOpClosure(std::function<void()> fn) {
@@ -1075,9 +1161,10 @@ void RunHandler::Impl::ScheduleIntraOpClosure(std::function<void()> fn) {
 }
 
 void RunHandler::Impl::Reset(
-    int64_t step_id,
+    int64_t step_id, uint64 deadline_us,
     const RunOptions::Experimental::RunHandlerPoolOptions& options) {
   start_time_us_ = tensorflow::Env::Default()->NowMicros();
+  deadline_us_ = deadline_us;
   step_id_ = step_id;
   options_ = options;
   tws_.SetTracemeId(step_id);
@@ -1103,6 +1190,11 @@ std::vector<int64_t> RunHandlerPool::GetActiveHandlerPrioritiesForTesting()
   return impl_->GetActiveHandlerPrioritiesForTesting();
 }
 
+std::vector<int64_t> RunHandlerPool::GetActiveHandlerStepIdsForTesting()
+    const {
+  return impl_->GetActiveHandlerStepIdsForTesting();
+}
+
 RunHandler::RunHandler(Impl* impl) : impl_(impl) {}
 
 void RunHandler::ScheduleInterOpClosure(std::function<void()> fn) {
@@ -62,7 +62,13 @@ class RunHandlerPool {
   // and is being used by a client.  It becomes 'inactive' once more when the
   // unique_ptr is destroyed.
   //
-  // Will block unless there is an inactive handler.
+  // Will block unless there is an inactive handler. If `timeout_in_ms` is
+  // positive, it sets the deadline of the request: Get() returns nullptr if no
+  // handler becomes inactive before the deadline, or if
+  // `options.shed_infeasible_requests()` is true and recent requests indicate
+  // that the request cannot be done by its deadline. Waiting requests obtain
+  // handlers, and active requests are scheduled, by decreasing priority and
+  // then by earliest deadline.
   std::unique_ptr<RunHandler> Get(
       int64_t step_id = 0, int64_t timeout_in_ms = 0,
       const RunOptions::Experimental::RunHandlerPoolOptions& options =
@@ -72,6 +78,10 @@ class RunHandlerPool {
   // order of the active handler list.
   std::vector<int64_t> GetActiveHandlerPrioritiesForTesting() const;
 
+  // Get the step ids of the active handlers, in the order of the active
+  // handler list.
+  std::vector<int64_t> GetActiveHandlerStepIdsForTesting() const;
+
  private:
   class Impl;
   friend class RunHandler;
@@ -82,7 +92,7 @@ class RunHandlerPool {
 // RunHandler can be used to schedule inter/intra-op closures to run on a global
 // pool shared across all Session::Run(s). The closures are enqueued to a
 // handler specific queue, from which the work is stolen in a priority order
-// (time of the Get() call).
+// (priority and deadline of the request, then time of the Get() call).
 //
 // It can only be created via RunHandlerPool::Get().
 //
@@ -113,6 +113,56 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, DeadlineSchedulingTest) {
+  int num_threads = 2;
+  std::unique_ptr<RunHandlerPool> pool(
+      new RunHandlerPool(num_threads, num_threads));
+
+  RunOptions::Experimental::RunHandlerPoolOptions options;
+  auto handler1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  auto handler2 = pool->Get(/*step_id=*/2, /*timeout_in_ms=*/100000, options);
+  auto handler3 = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/10000, options);
+
+  // Requests of the same priority are ordered by deadline, and requests
+  // without a deadline come last.
+  std::vector<int64_t> sorted_active_list =
+      pool->GetActiveHandlerStepIdsForTesting();
+  ASSERT_EQ(sorted_active_list.size(), 3);
+  EXPECT_EQ(sorted_active_list[0], 3);
+  EXPECT_EQ(sorted_active_list[1], 2);
+  EXPECT_EQ(sorted_active_list[2], 1);
+
+  // Priorities take precedence over deadlines.
+  options.set_priority(1);
+  auto handler4 = pool->Get(/*step_id=*/4, /*timeout_in_ms=*/0, options);
+  sorted_active_list = pool->GetActiveHandlerStepIdsForTesting();
+  ASSERT_EQ(sorted_active_list.size(), 4);
+  EXPECT_EQ(sorted_active_list[0], 4);
+  EXPECT_EQ(sorted_active_list[1], 3);
+}
+
+TEST(RunHandlerUtilTest, ShedInfeasibleRequestsTest) {
+  int num_threads = 2;
+  std::unique_ptr<RunHandlerPool> pool(
+      new RunHandlerPool(num_threads, num_threads));
+
+  // Record the run times of a few requests that take about 10ms each.
+  for (int i = 0; i < 16; ++i) {
+    auto handler = pool->Get(i);
+    Env::Default()->SleepForMicroseconds(10000);
+  }
+
+  RunOptions::Experimental::RunHandlerPoolOptions options;
+  // Without shedding, only the deadline of waiting for a handler applies.
+  EXPECT_NE(pool->Get(/*step_id=*/16, /*timeout_in_ms=*/1, options), nullptr);
+
+  options.set_shed_infeasible_requests(true);
+  EXPECT_EQ(pool->Get(/*step_id=*/17, /*timeout_in_ms=*/1, options), nullptr);
+  EXPECT_NE(pool->Get(/*step_id=*/18, /*timeout_in_ms=*/10000, options),
+            nullptr);
+  EXPECT_NE(pool->Get(/*step_id=*/19, /*timeout_in_ms=*/0, options), nullptr);
+}
+
 TEST(RunHandlerThreadPool, EnqueueTask) {
   Eigen::MaxSizeVector<mutex> waiters_mu(2);
   waiters_mu.resize(2);
@@ -811,5 +861,38 @@ TEST_F(RunHandlerTest, TestWaitTimeout) {
   EXPECT_NE(next_handle.get(), nullptr);
 }
 
+TEST_F(RunHandlerTest, TestWaitersAcquireHandlersByDeadline) {
+  std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(1, 1));
+
+  std::vector<std::unique_ptr<RunHandler>> blocking_handles;
+  const int32_t kMaxConcurrentHandlers = 128;  // Copied from run_handler.cc.
+  blocking_handles.reserve(kMaxConcurrentHandlers);
+  for (int i = 0; i < kMaxConcurrentHandlers; ++i) {
+    blocking_handles.push_back(pool->Get(i));
+  }
+
+  // A request without a deadline starts waiting before a request with a
+  // deadline, but the latter obtains the first released handler.
+  mutex mu;
+  std::vector<int64_t> acquired;
+  auto tp = std::make_unique<thread::ThreadPool>(Env::Default(), "test", 2);
+  auto get = [&pool, &mu, &acquired](int64_t step_id, int64_t timeout_in_ms) {
+    auto handle = pool->Get(step_id, timeout_in_ms);
+    ASSERT_NE(handle.get(), nullptr);
+    mutex_lock l(mu);
+    acquired.push_back(step_id);
+  };
+  tp->Schedule([&get]() { get(128, 0); });
+  Env::Default()->SleepForMicroseconds(20000);
+  tp->Schedule([&get]() { get(129, 100000); });
+  Env::Default()->SleepForMicroseconds(20000);
+
+  blocking_handles[0].reset();
+  tp.reset();
+  ASSERT_EQ(acquired.size(), 2);
+  EXPECT_EQ(acquired[0], 129);
+  EXPECT_EQ(acquired[1], 128);
+}
+
 }  // namespace
 }  // namespace tensorflow
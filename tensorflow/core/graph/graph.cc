@@ -535,22 +535,21 @@ StatusOr<Node*> Graph::AddNode(NodeDef node_def) {
 }
 
 Node* Graph::AddNode(NodeDef node_def, Status* status) {
-  const OpRegistrationData* op_reg_data;
-  status->Update(ops_.LookUp(node_def.op(), &op_reg_data));
+  PreparedNode prepared;
+  status->Update(PrepareNode(std::move(node_def), &prepared));
   if (!status->ok()) return nullptr;
+  return AddNode(std::move(prepared));
+}
+
+Status Graph::PrepareNode(NodeDef node_def, PreparedNode* prepared) const {
+  const OpRegistrationData* op_reg_data;
+  TF_RETURN_IF_ERROR(ops_.LookUp(node_def.op(), &op_reg_data));
 
   DataTypeVector inputs;
   DataTypeVector outputs;
-  status->Update(
-      InOutTypesForNode(node_def, op_reg_data->op_def, &inputs, &outputs));
-  if (!status->ok()) {
-    *status = AttachDef(*status, node_def);
-    return nullptr;
-  }
-
-  Node::NodeClass node_class = op_reg_data->is_function_op
-                                   ? Node::NC_FUNCTION_OP
-                                   : Node::GetNodeClassForOp(node_def.op());
+  Status s =
+      InOutTypesForNode(node_def, op_reg_data->op_def, &inputs, &outputs);
+  if (!s.ok()) return AttachDef(s, node_def);
 
   if (node_def.has_experimental_type()) {
     VLOG(3) << "AddNode: node has type set, skipping type constructor "
@@ -558,23 +557,36 @@ Node* Graph::AddNode(NodeDef node_def, Status* status) {
   } else {
     if (op_reg_data->type_ctor != nullptr) {
       VLOG(3) << "AddNode: found type constructor for " << node_def.name();
-      Status s =
-          full_type::SpecializeType(AttrSlice(node_def), op_reg_data->op_def,
+      s = full_type::SpecializeType(AttrSlice(node_def), op_reg_data->op_def,
                                     *(node_def.mutable_experimental_type()));
       if (!s.ok()) {
-        *status = errors::InvalidArgument("type error: ", s.ToString());
         VLOG(3) << "AddNode: type inference failed for " << node_def.name()
                 << ": " << s;
-        return nullptr;
+        return errors::InvalidArgument("type error: ", s.ToString());
       }
     } else {
       VLOG(3) << "AddNode: no type constructor for " << node_def.name();
     }
   }
 
+  prepared->node_def = std::move(node_def);
+  prepared->op_reg_data = op_reg_data;
+  prepared->inputs = std::move(inputs);
+  prepared->outputs = std::move(outputs);
+  return OkStatus();
+}
+
+Node* Graph::AddNode(PreparedNode prepared) {
+  const OpRegistrationData* op_reg_data = prepared.op_reg_data;
+  Node::NodeClass node_class =
+      op_reg_data->is_function_op
+          ? Node::NC_FUNCTION_OP
+          : Node::GetNodeClassForOp(prepared.node_def.op());
+
   Node* node = AllocateNode(
-      std::make_shared<NodeProperties>(&op_reg_data->op_def,
-                                       std::move(node_def), inputs, outputs),
+      std::make_shared<NodeProperties>(
+          &op_reg_data->op_def, std::move(prepared.node_def),
+          std::move(prepared.inputs), std::move(prepared.outputs)),
       nullptr, node_class);
   return node;
 }
@@ -561,6 +561,25 @@ class Graph {
   // Same as above, but using StatusOr. This method is always preferred.
   StatusOr<Node*> AddNode(NodeDef node_def);
 
+  // A NodeDef together with its op and input/output types, as resolved by
+  // PrepareNode().
+  struct PreparedNode {
+    NodeDef node_def;
+    const OpRegistrationData* op_reg_data = nullptr;
+    DataTypeVector inputs;
+    DataTypeVector outputs;
+  };
+
+  // Infers the Op and input/output types for 'node_def' as AddNode() does,
+  // without adding it to this graph. Unlike AddNode(), this may be called
+  // concurrently from multiple threads, e.g. to prepare the nodes of a large
+  // GraphDef in parallel before adding them in order.
+  Status PrepareNode(NodeDef node_def, PreparedNode* prepared) const;
+
+  // Adds a node prepared by PrepareNode() to this graph, and returns it.
+  // *this owns the returned instance.
+  Node* AddNode(PreparedNode prepared);
+
   // Copies *node, which may belong to another graph, to a new node,
   // which is returned.  Does not copy any edges.  *this owns the
   // returned instance.
@@ -0,0 +1,264 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/measured_cost_table.h"
+
+#include <map>
+#include <utility>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/robust_stats.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+constexpr char kStreamAll[] = "/stream:all";
+
+// Returns the type of the device that produced dev_stats, or an empty string
+// if the stats must be skipped. GPU profiles report every kernel twice, once
+// on the timeline of its stream and once on the aggregated "/stream:all"
+// timeline, and also report memcpys and synchronizations separately.
+string MeasuredDeviceType(absl::string_view device) {
+  const size_t stream = device.find("/stream:");
+  if (stream != absl::string_view::npos) {
+    if (device.substr(stream) != kStreamAll) return "";
+    device = device.substr(0, stream);
+  } else if (absl::EndsWith(device, "/memcpy") ||
+             absl::EndsWith(device, "/sync")) {
+    return "";
+  }
+  DeviceNameUtils::ParsedName parsed;
+  if (!DeviceNameUtils::ParseFullName(device, &parsed) || !parsed.has_type) {
+    return "";
+  }
+  return parsed.type;
+}
+
+double ExecutionTimeNs(const NodeExecStats& stats) {
+  if (stats.op_end_rel_nanos() > stats.op_start_rel_nanos()) {
+    return stats.op_end_rel_nanos() - stats.op_start_rel_nanos();
+  }
+  return 1000.0 * (stats.op_end_rel_micros() - stats.op_start_rel_micros());
+}
+
+}  // namespace
+
+string MeasuredCostTable::Key(const OpInfo& op_info) {
+  string key = absl::StrCat(op_info.op(), ";", op_info.device().type());
+  for (const auto& input : op_info.inputs()) {
+    absl::StrAppend(&key, ";", DataTypeString(input.dtype()),
+                    PartialTensorShape(input.shape()).DebugString());
+  }
+  // Attributes are serialized in a canonical order. Internal attributes (e.g.
+  // _class or _output_shapes) don't affect the computation.
+  std::map<string, const AttrValue*> attrs;
+  for (const auto& attr : op_info.attr()) {
+    if (!absl::StartsWith(attr.first, "_")) {
+      attrs.emplace(attr.first, &attr.second);
+    }
+  }
+  for (const auto& attr : attrs) {
+    absl::StrAppend(&key, ";", attr.first, "=",
+                    SummarizeAttrValue(*attr.second));
+  }
+  return key;
+}
+
+void MeasuredCostTable::AddMeasurement(const OpInfo& op_info,
+                                       double execution_time_ns) {
+  const string key = Key(op_info);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    it = entries_.emplace(key, Entry()).first;
+    it->second.op_info = op_info;
+  }
+  Entry& entry = it->second;
+  entry.execution_times_ns.push_back(execution_time_ns);
+  entry.mean_execution_time_ns = RobustStats(entry.execution_times_ns).mean();
+}
+
+Status MeasuredCostTable::AddStepStats(const GrapplerItem& item,
+                                       const StepStats& step_stats) {
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(
+      /*assume_valid_feeds=*/true, /*aggressive_shape_inference=*/false,
+      /*include_tensor_values=*/false));
+
+  std::unordered_map<string, const NodeDef*> name_to_node;
+  for (const NodeDef& node : item.graph.node()) {
+    name_to_node[node.name()] = &node;
+  }
+
+  // The execution time of each node on each device type. A node may show up
+  // several times per step, e.g. once per kernel it launched on a GPU.
+  std::map<std::pair<string, string>, double> execution_times_ns;
+  for (const auto& dev_stats : step_stats.dev_stats()) {
+    const string device_type = MeasuredDeviceType(dev_stats.device());
+    if (device_type.empty()) continue;
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      // GPU profiles name the kernels after the "name:type" of their node.
+      const string node_name =
+          string(absl::string_view(node_stats.node_name())
+                     .substr(0, node_stats.node_name().find(':')));
+      if (name_to_node.find(node_name) == name_to_node.end()) continue;
+      execution_times_ns[{node_name, device_type}] +=
+          ExecutionTimeNs(node_stats);
+    }
+  }
+
+  int num_nodes_without_properties = 0;
+  for (const auto& execution_time : execution_times_ns) {
+    const NodeDef& node = *name_to_node[execution_time.first.first];
+    if (!properties.HasInputProperties(node.name())) {
+      ++num_nodes_without_properties;
+      continue;
+    }
+    OpInfo op_info;
+    op_info.set_op(node.op());
+    *op_info.mutable_attr() = node.attr();
+    for (const auto& input : properties.GetInputProperties(node.name())) {
+      *op_info.add_inputs() = input;
+    }
+    op_info.mutable_device()->set_type(execution_time.first.second);
+    AddMeasurement(op_info, execution_time.second);
+  }
+  VLOG(1) << "Added "
+          << execution_times_ns.size() - num_nodes_without_properties
+          << " measurements from step stats, skipped "
+          << num_nodes_without_properties << " nodes without properties";
+  return OkStatus();
+}
+
+Status MeasuredCostTable::AddOpPerformanceList(
+    const OpPerformanceList& op_performance_list) {
+  for (const auto& op_performance : op_performance_list.op_performance()) {
+    if (op_performance.compute_cost() < 0) {
+      return errors::InvalidArgument("Negative measured cost for op ",
+                                     op_performance.op().op());
+    }
+    AddMeasurement(op_performance.op(), op_performance.compute_cost());
+  }
+  return OkStatus();
+}
+
+OpPerformanceList MeasuredCostTable::ToOpPerformanceList() const {
+  // Emit the entries in a deterministic order.
+  std::map<string, const Entry*> sorted_entries;
+  for (const auto& entry : entries_) {
+    sorted_entries.emplace(entry.first, &entry.second);
+  }
+  OpPerformanceList op_performance_list;
+  for (const auto& entry : sorted_entries) {
+    OpPerformance* op_performance = op_performance_list.add_op_performance();
+    *op_performance->mutable_op() = entry.second->op_info;
+    op_performance->set_compute_cost(
+        static_cast<int64_t>(entry.second->mean_execution_time_ns));
+    op_performance->mutable_execution_time_normal()->set_mu(
+        entry.second->mean_execution_time_ns);
+  }
+  return op_performance_list;
+}
+
+Status MeasuredCostTable::Load(Env* env, const string& filename) {
+  OpPerformanceList op_performance_list;
+  TF_RETURN_IF_ERROR(
+      ReadTextOrBinaryProto(env, filename, &op_performance_list));
+  return AddOpPerformanceList(op_performance_list);
+}
+
+Status MeasuredCostTable::Save(Env* env, const string& filename) const {
+  return WriteBinaryProto(env, filename, ToOpPerformanceList());
+}
+
+bool MeasuredCostTable::Lookup(const OpInfo& op_info,
+                               Costs::Duration* execution_time) const {
+  auto it = entries_.find(Key(op_info));
+  if (it == entries_.end()) return false;
+  *execution_time = Costs::Duration(it->second.mean_execution_time_ns);
+  return true;
+}
+
+std::shared_ptr<const MeasuredCostTable> MeasuredCostTable::Default() {
+  static std::shared_ptr<const MeasuredCostTable>* table = [] {
+    string filename;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_GRAPPLER_MEASURED_COST_TABLE", "",
+                                     &filename));
+    auto* table = new std::shared_ptr<const MeasuredCostTable>();
+    if (filename.empty()) return table;
+    auto loaded = std::make_shared<MeasuredCostTable>();
+    Status status = loaded->Load(Env::Default(), filename);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to load the measured cost table " << filename
+                   << ": " << status;
+      return table;
+    }
+    VLOG(1) << "Loaded " << loaded->size() << " measured costs from "
+            << filename;
+    *table = std::move(loaded);
+    return table;
+  }();
+  return *table;
+}
+
+MeasuredOpLevelCostEstimator::MeasuredOpLevelCostEstimator(
+    std::shared_ptr<const MeasuredCostTable> table)
+    : table_(std::move(table)) {}
+
+Costs MeasuredOpLevelCostEstimator::PredictCosts(
+    const OpContext& op_context) const {
+  Costs costs = OpLevelCostEstimator::PredictCosts(op_context);
+  Costs::Duration measured;
+  if (!table_->Lookup(op_context.op_info, &measured)) {
+    return costs;
+  }
+  // Keep the analytical split between compute and memory time, and scale it
+  // to the measured execution time.
+  const double analytical = costs.execution_time.count();
+  if (analytical > 0) {
+    const double scale = measured.count() / analytical;
+    costs.compute_time = Costs::Duration(costs.compute_time.count() * scale);
+    costs.memory_time = Costs::Duration(costs.memory_time.count() * scale);
+  } else {
+    costs.compute_time = measured;
+    costs.memory_time = Costs::Duration(0);
+  }
+  costs.execution_time = measured;
+  costs.inaccurate = false;
+  costs.num_ops_with_unknown_shapes = 0;
+  return costs;
+}
+
+std::unique_ptr<OpLevelCostEstimator> CreateDefaultOpLevelCostEstimator() {
+  std::shared_ptr<const MeasuredCostTable> table = MeasuredCostTable::Default();
+  if (table == nullptr) {
+    return std::make_unique<OpLevelCostEstimator>();
+  }
+  return std::make_unique<MeasuredOpLevelCostEstimator>(std::move(table));
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
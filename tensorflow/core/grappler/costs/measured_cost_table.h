@@ -0,0 +1,112 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_COST_TABLE_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_COST_TABLE_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// A table of per-op execution times measured on real hardware. Ops are keyed
+// by their type, device type, input dtypes and shapes and non-internal
+// attributes, so that a measurement taken for one node applies to every node
+// of another graph that runs the same computation. The table is persisted as
+// an OpPerformanceList, where compute_cost holds the measured time.
+class MeasuredCostTable {
+ public:
+  MeasuredCostTable() = default;
+
+  // Adds the execution times recorded in step_stats for the nodes of
+  // item.graph. Node stats that don't match a node of the graph are ignored.
+  // Stats produced from a GPU profile (see ConvertGpuXSpaceToStepStats) are
+  // accepted as well: only the aggregated "/stream:all" timeline of each GPU
+  // is used, and the kernels launched by a node are summed up.
+  Status AddStepStats(const GrapplerItem& item, const StepStats& step_stats);
+
+  // Adds the entries of a previously persisted table. Each entry counts as a
+  // single measurement.
+  Status AddOpPerformanceList(const OpPerformanceList& op_performance_list);
+
+  // Returns the persisted form of the table, with one entry per distinct op.
+  // The cost of each entry is a robust mean of its measurements, which is not
+  // skewed by the occasional outlier (e.g. a step that was preempted).
+  OpPerformanceList ToOpPerformanceList() const;
+
+  Status Load(Env* env, const string& filename);
+  Status Save(Env* env, const string& filename) const;
+
+  // Looks up the measured execution time of the op described by op_info.
+  // Returns false if the op was never measured.
+  bool Lookup(const OpInfo& op_info, Costs::Duration* execution_time) const;
+
+  int size() const { return entries_.size(); }
+
+  // Returns the table named by the TF_GRAPPLER_MEASURED_COST_TABLE environment
+  // variable, loaded once per process, or nullptr if the variable is unset or
+  // the table can't be loaded.
+  static std::shared_ptr<const MeasuredCostTable> Default();
+
+  // Returns the key identifying the computation described by op_info.
+  static string Key(const OpInfo& op_info);
+
+ private:
+  struct Entry {
+    OpInfo op_info;
+    std::vector<double> execution_times_ns;
+    double mean_execution_time_ns = 0;
+  };
+
+  void AddMeasurement(const OpInfo& op_info, double execution_time_ns);
+
+  std::unordered_map<string, Entry> entries_;
+};
+
+// An OpLevelCostEstimator that consults a measured cost table first, and falls
+// back to the analytical estimates for the ops that were never measured. The
+// memory estimates always come from the analytical model.
+class MeasuredOpLevelCostEstimator : public OpLevelCostEstimator {
+ public:
+  explicit MeasuredOpLevelCostEstimator(
+      std::shared_ptr<const MeasuredCostTable> table);
+  ~MeasuredOpLevelCostEstimator() override {}
+
+  Costs PredictCosts(const OpContext& op_context) const override;
+
+ private:
+  std::shared_ptr<const MeasuredCostTable> table_;
+};
+
+// Returns the op level cost estimator used by default by the analytical cost
+// estimator: a MeasuredOpLevelCostEstimator if a default measured cost table
+// is configured, and a plain OpLevelCostEstimator otherwise.
+std::unique_ptr<OpLevelCostEstimator> CreateDefaultOpLevelCostEstimator();
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_COST_TABLE_H_
@@ -0,0 +1,173 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/measured_cost_table.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class MeasuredCostTableTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Scope s = Scope::NewRootScope();
+    auto a = ops::Placeholder(s.WithOpName("a"), DT_FLOAT,
+                              ops::Placeholder::Shape({32, 64}));
+    auto b = ops::Placeholder(s.WithOpName("b"), DT_FLOAT,
+                              ops::Placeholder::Shape({64, 16}));
+    auto matmul = ops::MatMul(s.WithOpName("matmul"), a, b);
+    TF_CHECK_OK(s.ToGraphDef(&item_.graph));
+    item_.fetch = {"matmul"};
+  }
+
+  // Returns the OpInfo the virtual scheduler builds for the MatMul node.
+  OpInfo MatMulOpInfo(const string& device_type, int64_t rows = 32) const {
+    OpInfo op_info;
+    for (const NodeDef& node : item_.graph.node()) {
+      if (node.name() == "matmul") {
+        op_info.set_op(node.op());
+        *op_info.mutable_attr() = node.attr();
+      }
+    }
+    auto* a = op_info.add_inputs();
+    a->set_dtype(DT_FLOAT);
+    TensorShape({rows, 64}).AsProto(a->mutable_shape());
+    auto* b = op_info.add_inputs();
+    b->set_dtype(DT_FLOAT);
+    TensorShape({64, 16}).AsProto(b->mutable_shape());
+    op_info.mutable_device()->set_type(device_type);
+    return op_info;
+  }
+
+  static void AddNodeStats(const string& node_name, int64_t start_micros,
+                           int64_t end_micros, DeviceStepStats* dev_stats) {
+    NodeExecStats* node_stats = dev_stats->add_node_stats();
+    node_stats->set_node_name(node_name);
+    node_stats->set_op_start_rel_micros(start_micros);
+    node_stats->set_op_end_rel_micros(end_micros);
+  }
+
+  GrapplerItem item_;
+};
+
+TEST_F(MeasuredCostTableTest, AddStepStats) {
+  StepStats step_stats;
+  DeviceStepStats* dev_stats = step_stats.add_dev_stats();
+  dev_stats->set_device("/job:localhost/replica:0/task:0/device:CPU:0");
+  AddNodeStats("matmul", 10, 260, dev_stats);
+  AddNodeStats("unknown_node", 0, 1000, dev_stats);
+
+  MeasuredCostTable table;
+  TF_ASSERT_OK(table.AddStepStats(item_, step_stats));
+  EXPECT_EQ(1, table.size());
+
+  Costs::Duration execution_time;
+  ASSERT_TRUE(table.Lookup(MatMulOpInfo("CPU"), &execution_time));
+  EXPECT_EQ(Costs::MicroSeconds(250), execution_time);
+  EXPECT_FALSE(table.Lookup(MatMulOpInfo("GPU"), &execution_time));
+  EXPECT_FALSE(table.Lookup(MatMulOpInfo("CPU", 128), &execution_time));
+}
+
+TEST_F(MeasuredCostTableTest, AddGpuProfile) {
+  // The kernels launched by a node are reported under "name:type", both on
+  // the timeline of their stream and on the aggregated timeline.
+  StepStats step_stats;
+  DeviceStepStats* stream = step_stats.add_dev_stats();
+  stream->set_device("/device:GPU:0/stream:7");
+  AddNodeStats("matmul:MatMul", 0, 30, stream);
+  AddNodeStats("matmul:MatMul", 40, 50, stream);
+  DeviceStepStats* all_streams = step_stats.add_dev_stats();
+  all_streams->set_device("/device:GPU:0/stream:all");
+  AddNodeStats("matmul:MatMul", 0, 30, all_streams);
+  AddNodeStats("matmul:MatMul", 40, 50, all_streams);
+  DeviceStepStats* memcpy = step_stats.add_dev_stats();
+  memcpy->set_device("/device:GPU:0/memcpy");
+  AddNodeStats("matmul:MatMul", 50, 100, memcpy);
+
+  MeasuredCostTable table;
+  TF_ASSERT_OK(table.AddStepStats(item_, step_stats));
+  Costs::Duration execution_time;
+  ASSERT_TRUE(table.Lookup(MatMulOpInfo("GPU"), &execution_time));
+  EXPECT_EQ(Costs::MicroSeconds(40), execution_time);
+}
+
+TEST_F(MeasuredCostTableTest, RobustToOutliers) {
+  MeasuredCostTable table;
+  for (int64_t micros : {100, 101, 99, 100, 5000}) {
+    StepStats step_stats;
+    DeviceStepStats* dev_stats = step_stats.add_dev_stats();
+    dev_stats->set_device("/job:localhost/replica:0/task:0/device:CPU:0");
+    AddNodeStats("matmul", 0, micros, dev_stats);
+    TF_ASSERT_OK(table.AddStepStats(item_, step_stats));
+  }
+  Costs::Duration execution_time;
+  ASSERT_TRUE(table.Lookup(MatMulOpInfo("CPU"), &execution_time));
+  EXPECT_NEAR(100, execution_time.asMicroSeconds().count(), 2);
+}
+
+TEST_F(MeasuredCostTableTest, SaveAndLoad) {
+  StepStats step_stats;
+  DeviceStepStats* dev_stats = step_stats.add_dev_stats();
+  dev_stats->set_device("/job:localhost/replica:0/task:0/device:CPU:0");
+  AddNodeStats("matmul", 0, 250, dev_stats);
+  MeasuredCostTable table;
+  TF_ASSERT_OK(table.AddStepStats(item_, step_stats));
+
+  const string filename =
+      io::JoinPath(testing::TmpDir(), "measured_cost_table.pb");
+  TF_ASSERT_OK(table.Save(Env::Default(), filename));
+  MeasuredCostTable loaded;
+  TF_ASSERT_OK(loaded.Load(Env::Default(), filename));
+  EXPECT_EQ(1, loaded.size());
+  Costs::Duration execution_time;
+  ASSERT_TRUE(loaded.Lookup(MatMulOpInfo("CPU"), &execution_time));
+  EXPECT_EQ(Costs::MicroSeconds(250), execution_time);
+}
+
+TEST_F(MeasuredCostTableTest, MeasuredOpLevelCostEstimator) {
+  StepStats step_stats;
+  DeviceStepStats* dev_stats = step_stats.add_dev_stats();
+  dev_stats->set_device("/job:localhost/replica:0/task:0/device:CPU:0");
+  AddNodeStats("matmul", 0, 250, dev_stats);
+  auto table = std::make_shared<MeasuredCostTable>();
+  TF_ASSERT_OK(table->AddStepStats(item_, step_stats));
+
+  OpLevelCostEstimator analytical;
+  MeasuredOpLevelCostEstimator measured(table);
+  OpContext op_context;
+  op_context.name = "matmul";
+  op_context.op_info = MatMulOpInfo("CPU");
+  Costs costs = measured.PredictCosts(op_context);
+  EXPECT_EQ(Costs::MicroSeconds(250), costs.execution_time);
+  EXPECT_FALSE(costs.inaccurate);
+  EXPECT_EQ(analytical.PredictCosts(op_context).temporary_memory,
+            costs.temporary_memory);
+
+  // Ops that were never measured use the analytical estimates.
+  op_context.op_info = MatMulOpInfo("CPU", 128);
+  EXPECT_EQ(analytical.PredictCosts(op_context).execution_time,
+            measured.PredictCosts(op_context).execution_time);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,130 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Builds a measured cost table from profiles of a graph, to be consumed by
+// the Grappler cost model through TF_GRAPPLER_MEASURED_COST_TABLE. Usage:
+//
+//   measured_cost_table_tool --graph=graph.pbtxt \
+//     --run_metadata=step_0.pb,step_1.pb --xspace=gpu_trace.xplane.pb \
+//     --input_table=old_table.pb --output_table=table.pb
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/grappler/costs/measured_cost_table.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/profiler/convert/xplane_to_step_stats.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+std::vector<string> SplitFiles(const string& files) {
+  return absl::StrSplit(files, ',', absl::SkipEmpty());
+}
+
+Status BuildMeasuredCostTable(const string& graph_file,
+                              const string& run_metadata_files,
+                              const string& xspace_files,
+                              const string& input_table,
+                              const string& output_table) {
+  Env* env = Env::Default();
+  GrapplerItem item;
+  item.id = graph_file;
+  TF_RETURN_IF_ERROR(ReadTextOrBinaryProto(env, graph_file, &item.graph));
+
+  MeasuredCostTable table;
+  if (!input_table.empty()) {
+    TF_RETURN_IF_ERROR(table.Load(env, input_table));
+  }
+  for (const string& file : SplitFiles(run_metadata_files)) {
+    RunMetadata run_metadata;
+    TF_RETURN_IF_ERROR(ReadTextOrBinaryProto(env, file, &run_metadata));
+    TF_RETURN_IF_ERROR(table.AddStepStats(item, run_metadata.step_stats()));
+  }
+  for (const string& file : SplitFiles(xspace_files)) {
+    profiler::XSpace xspace;
+    TF_RETURN_IF_ERROR(ReadBinaryProto(env, file, &xspace));
+    StepStats step_stats;
+    profiler::ConvertGpuXSpaceToStepStats(xspace, &step_stats);
+    TF_RETURN_IF_ERROR(table.AddStepStats(item, step_stats));
+  }
+  LOG(INFO) << "Writing " << table.size() << " measured costs to "
+            << output_table;
+  return table.Save(env, output_table);
+}
+
+int ParseFlagsAndBuildMeasuredCostTable(int argc, char* argv[]) {
+  string graph;
+  string run_metadata;
+  string xspace;
+  string input_table;
+  string output_table;
+  std::vector<Flag> flag_list = {
+      Flag("graph", &graph, "profiled GraphDef, in text or binary format"),
+      Flag("run_metadata", &run_metadata,
+           "comma separated RunMetadata files holding the step stats of "
+           "profiled steps"),
+      Flag("xspace", &xspace,
+           "comma separated XSpace files from the profiler, e.g. the "
+           "*.xplane.pb files of a TensorBoard profile"),
+      Flag("input_table", &input_table,
+           "optional existing table to merge the measurements into"),
+      Flag("output_table", &output_table, "output measured cost table"),
+  };
+  string usage = Flags::Usage(argv[0], flag_list);
+
+  const bool parse_result = Flags::Parse(&argc, argv, flag_list);
+  // We need to call this to set up global state for TensorFlow.
+  port::InitMain(argv[0], &argc, &argv);
+
+  if (!parse_result) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+  if (argc > 1) {
+    LOG(ERROR) << "Unknown argument " << argv[1] << ".\n" << usage;
+    return -1;
+  }
+  if (graph.empty() || output_table.empty()) {
+    LOG(ERROR) << "graph and output_table can't be empty.\n" << usage;
+    return -1;
+  }
+
+  Status status = BuildMeasuredCostTable(graph, run_metadata, xspace,
+                                         input_table, output_table);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message() << "\n" << usage;
+    return -1;
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
+
+int main(int argc, char* argv[]) {
+  return tensorflow::grappler::ParseFlagsAndBuildMeasuredCostTable(argc, argv);
+}
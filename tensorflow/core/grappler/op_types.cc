@@ -485,6 +485,10 @@ bool IsRelu6Grad(const NodeDef& node) { return node.op() == "Relu6Grad"; }
 
 bool IsReshape(const NodeDef& node) { return (node.op() == "Reshape"); }
 
+bool IsResourceGather(const NodeDef& node) {
+  return node.op() == "ResourceGather";
+}
+
 bool IsRestore(const NodeDef& node) {
   return (node.op() == "Restore" || node.op() == "RestoreV2" ||
           node.op() == "RestoreSlice");
@@ -536,6 +540,11 @@ bool IsSoftplusGrad(const NodeDef& node) { return node.op() == "SoftplusGrad"; }
 
 bool IsSoftsignGrad(const NodeDef& node) { return node.op() == "SoftsignGrad"; }
 
+bool IsSparseSegmentReduction(const NodeDef& node) {
+  return node.op() == "SparseSegmentSum" || node.op() == "SparseSegmentMean" ||
+         node.op() == "SparseSegmentSqrtN";
+}
+
 bool IsSplit(const NodeDef& node) { return node.op() == "Split"; }
 
 bool IsSplitV(const NodeDef& node) { return node.op() == "SplitV"; }
@@ -580,6 +589,10 @@ bool IsStridedSliceGrad(const NodeDef& node) {
   return node.op() == "StridedSliceGrad";
 }
 
+bool IsStringSplitV2(const NodeDef& node) {
+  return node.op() == "StringSplitV2";
+}
+
 bool IsStringToHashBucketFast(const NodeDef& node) {
   return node.op() == "StringToHashBucketFast";
 }
@@ -154,6 +154,7 @@ bool IsRelu6(const NodeDef& node);
 bool IsRelu6Grad(const NodeDef& node);
 bool IsReluGrad(const NodeDef& node);
 bool IsReshape(const NodeDef& node);
+bool IsResourceGather(const NodeDef& node);
 bool IsRestore(const NodeDef& node);
 bool IsRetval(const NodeDef& node);
 bool IsReverse(const NodeDef& node);
@@ -174,6 +175,7 @@ bool IsSnapshot(const NodeDef& node);
 bool IsSoftmax(const NodeDef& node);
 bool IsSoftplusGrad(const NodeDef& node);
 bool IsSoftsignGrad(const NodeDef& node);
+bool IsSparseSegmentReduction(const NodeDef& node);
 bool IsSplit(const NodeDef& node);
 bool IsSplitV(const NodeDef& node);
 bool IsSqrt(const NodeDef& node);
@@ -189,6 +191,7 @@ bool IsStatefulPartitionedCall(const NodeDef& node);
 bool IsStopGradient(const NodeDef& node);
 bool IsStridedSlice(const NodeDef& node);
 bool IsStridedSliceGrad(const NodeDef& node);
+bool IsStringSplitV2(const NodeDef& node);
 bool IsStringToHashBucketFast(const NodeDef& node);
 bool IsSub(const NodeDef& node);
 bool IsSum(const NodeDef& node);
@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 
 #include <cmath>
+#include <map>
 
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
@@ -49,10 +50,14 @@ limitations under the License.
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/denormal.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/setround.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/bcast.h"
+#include "tensorflow/core/util/memmapped_file_system.h"
+#include "tensorflow/core/util/memmapped_file_system_writer.h"
 #include "tensorflow/core/util/overflow.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 
@@ -64,6 +69,76 @@ using TensorVector = gtl::InlinedVector<TensorValue, 4>;
 const int64_t kMaxConstantSize = 100 * 1024;
 
 namespace {
+// Default limit on the size of the folded constants saved into a memmapped
+// package.
+constexpr int64_t kDefaultMemmappedPackageMaxBytes = 1LL << 30;
+
+// The large folded constants saved into one memmapped package file. All the
+// ConstantFolding passes of the process that use the same file share the
+// package, since each pass, e.g. over the functions of the graph library,
+// folds only some of its constants. The tensors are kept until the end of the
+// process, bounded by the size limit of the package, since the package format
+// can only be written in one go.
+class MemmappedConstantPackage {
+ public:
+  static MemmappedConstantPackage* Get(const string& filename) {
+    static mutex mu(LINKER_INITIALIZED);
+    static auto* packages =
+        new absl::flat_hash_map<string, MemmappedConstantPackage*>();
+    mutex_lock l(mu);
+    MemmappedConstantPackage*& package = (*packages)[filename];
+    if (package == nullptr) package = new MemmappedConstantPackage(filename);
+    return package;
+  }
+
+  // Adds `tensor` to the package, unless its tensors would then exceed
+  // `max_bytes`, and returns the name of its region. Identical tensors share
+  // a region.
+  bool Add(const Tensor& tensor, int64_t max_bytes, string* region_name) {
+    const uint64 fingerprint = FingerprintCat64(
+        Fingerprint64(strings::StrCat(DataTypeString(tensor.dtype()),
+                                      tensor.shape().DebugString())),
+        Fingerprint64(tensor.tensor_data()));
+    *region_name =
+        strings::StrCat(MemmappedFileSystem::kMemmappedPackagePrefix,
+                        "folded_constant_", strings::Hex(fingerprint));
+    mutex_lock l(mu_);
+    if (tensors_.count(*region_name) > 0) return true;
+    if (total_bytes_ + tensor.TotalBytes() > max_bytes) return false;
+    tensors_.emplace(*region_name, tensor);
+    total_bytes_ += tensor.TotalBytes();
+    modified_ = true;
+    return true;
+  }
+
+  // Rewrites the package file if tensors were added since the last write.
+  Status Write(Env* env) {
+    mutex_lock l(mu_);
+    if (!modified_) return OkStatus();
+    const string tmp_filename = strings::StrCat(filename_, ".tmp");
+    MemmappedFileSystemWriter writer;
+    TF_RETURN_IF_ERROR(writer.InitializeToFile(env, tmp_filename));
+    for (const auto& tensor : tensors_) {
+      TF_RETURN_IF_ERROR(writer.SaveTensor(tensor.second, tensor.first));
+    }
+    TF_RETURN_IF_ERROR(writer.FlushAndClose());
+    TF_RETURN_IF_ERROR(env->RenameFile(tmp_filename, filename_));
+    modified_ = false;
+    return OkStatus();
+  }
+
+ private:
+  explicit MemmappedConstantPackage(const string& filename)
+      : filename_(filename) {}
+
+  const string filename_;
+  mutex mu_;
+  // Sorted by region name, so that the package is deterministic.
+  std::map<string, Tensor> tensors_ TF_GUARDED_BY(mu_);
+  int64_t total_bytes_ TF_GUARDED_BY(mu_) = 0;
+  bool modified_ TF_GUARDED_BY(mu_) = false;
+};
+
 template <typename T>
 bool AllValuesAre(const TensorProto& proto, const T& value) {
   Tensor tensor;
@@ -190,12 +265,18 @@ float QuantizedTypeMaxAsFloat(DataType data_type) {
 ConstantFolding::ConstantFolding(RewriterConfig::Toggle opt_level,
                                  DeviceBase* cpu_device,
                                  bool disable_compressed_tensor_optimization,
-                                 bool fold_quantization_emulation)
+                                 bool fold_quantization_emulation,
+                                 const string& memmapped_package,
+                                 int64_t memmapped_package_max_bytes)
     : opt_level_(opt_level),
       cpu_device_(cpu_device),
       disable_compressed_tensor_optimization_(
           disable_compressed_tensor_optimization),
-      fold_quantization_emulation_(fold_quantization_emulation) {
+      fold_quantization_emulation_(fold_quantization_emulation),
+      memmapped_package_(memmapped_package),
+      memmapped_package_max_bytes_(memmapped_package_max_bytes > 0
+                                       ? memmapped_package_max_bytes
+                                       : kDefaultMemmappedPackageMaxBytes) {
   resource_mgr_.reset(new ResourceMgr());
 }
 
@@ -1034,7 +1115,12 @@ bool ConstantFolding::IsFoldableUncached(
         if (num_bytes < 0) {  // Overflown
           return false;
         }
-        if (num_bytes > input_size_bytes && num_bytes > kMaxConstantSize) {
+        // Large outputs can still be saved into the memmapped package.
+        const int64_t max_constant_size =
+            memmapped_package_.empty()
+                ? kMaxConstantSize
+                : std::max(kMaxConstantSize, memmapped_package_max_bytes_);
+        if (num_bytes > input_size_bytes && num_bytes > max_constant_size) {
           // Do not fold nodes if the in-memory size of output is too large.
           // Notice that this is not exactly the same check used in
           // CreateNodeDef() where the actual encoded size is checked.
@@ -1338,6 +1424,30 @@ Status ConstantFolding::EvaluateNode(const NodeDef& node,
                                               resource_mgr_.get(), output);
 }
 
+Status ConstantFolding::CreateMemmappedNodeDef(const string& name,
+                                               const TensorValue& tensor,
+                                               NodeDef* node) const {
+  // ImmutableConst maps the raw tensor buffer.
+  if (!DataTypeCanUseMemcpy(tensor->dtype()) || tensor->NumElements() == 0) {
+    return errors::InvalidArgument("Can't memory-map ", name, " of type ",
+                                   DataTypeString(tensor->dtype()));
+  }
+  string region_name;
+  if (!MemmappedConstantPackage::Get(memmapped_package_)
+           ->Add(*tensor.tensor, memmapped_package_max_bytes_, &region_name)) {
+    return errors::ResourceExhausted(
+        "Can't fold ", name, ", the memmapped package ", memmapped_package_,
+        " would exceed ", memmapped_package_max_bytes_, " bytes");
+  }
+  node->set_name(name);
+  node->set_op("ImmutableConst");
+  node->clear_attr();
+  (*node->mutable_attr())["dtype"].set_type(tensor->dtype());
+  tensor->shape().AsProto((*node->mutable_attr())["shape"].mutable_shape());
+  (*node->mutable_attr())["memory_region_name"].set_s(region_name);
+  return OkStatus();
+}
+
 Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
                                             std::vector<NodeDef>* outputs,
                                             bool* result_too_large) {
@@ -1407,6 +1517,10 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
     if (output_tensors[i].tensor) {
       Status s = CreateNodeDef(node_name, output_tensors[i], &outputs->at(i),
                                total_inputs_size);
+      if (!s.ok() && !memmapped_package_.empty()) {
+        s = CreateMemmappedNodeDef(node_name, output_tensors[i],
+                                   &outputs->at(i));
+      }
       if (!s.ok()) {
         *result_too_large = true;
         return s;
@@ -1565,7 +1679,7 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
     // We rewrite the existing node if it only has a single output, and
     // create new nodes otherwise.
     if (const_nodes.size() == 1) {
-      node->set_op("Const");
+      node->set_op(const_node->op());
       // Note we need to clear the inputs in NodeMap before we clear the inputs
       // in the node, otherwise NodeMap would see empty inputs and effectively
       // does nothing.
@@ -1576,6 +1690,8 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
         node_map_->AddOutput(NodeName(input), node->name());
       }
       *node->mutable_attr() = const_node->attr();
+      // ImmutableConst only runs on the host.
+      if (IsImmutableConst(*node)) node->clear_device();
       break;
     } else {
       if (node_map_->GetNode(const_node->name())) {
@@ -1585,7 +1701,9 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
       }
       NodeDef* added_node = output_graph->add_node();
       *added_node = *const_node;
-      added_node->set_device(node->device());
+      if (!IsImmutableConst(*added_node)) {
+        added_node->set_device(node->device());
+      }
       node_map_->AddNode(added_node->name(), added_node);
       for (const auto& input : added_node->input()) {
         node_map_->AddOutput(NodeName(input), added_node->name());
@@ -4085,6 +4203,10 @@ Status ConstantFolding::Optimize(Cluster* cluster, const GrapplerItem& item,
   *optimized_graph->mutable_library() = item.graph.library();
   *optimized_graph->mutable_versions() = item.graph.versions();
 
+  if (!memmapped_package_.empty()) {
+    TF_RETURN_IF_ERROR(MemmappedConstantPackage::Get(memmapped_package_)
+                           ->Write(Env::Default()));
+  }
   return OkStatus();
 }
 
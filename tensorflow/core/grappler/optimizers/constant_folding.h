@@ -48,9 +48,14 @@ class ConstantFolding : public GraphOptimizer {
   explicit ConstantFolding(DeviceBase* cpu_device,
                            bool disable_compressed_tensor_optimization = false,
                            bool fold_quantization_emulation = true);
+  // If `memmapped_package` is not empty, outputs too large for the GraphDef
+  // are saved into that memmapped package, up to `memmapped_package_max_bytes`
+  // in total, and folded into ImmutableConst nodes.
   ConstantFolding(RewriterConfig::Toggle opt_level, DeviceBase* cpu_device,
                   bool disable_compressed_tensor_optimization = false,
-                  bool fold_quantization_emulation = true);
+                  bool fold_quantization_emulation = true,
+                  const string& memmapped_package = "",
+                  int64_t memmapped_package_max_bytes = 0);
 
   ~ConstantFolding() override {}
 
@@ -92,6 +97,8 @@ class ConstantFolding : public GraphOptimizer {
                       const gtl::InlinedVector<TensorValue, 4>& inputs,
                       gtl::InlinedVector<TensorValue, 4>* output) const;
 
+  Status CreateMemmappedNodeDef(const string& name, const TensorValue& tensor,
+                                NodeDef* node) const;
   Status EvaluateOneFoldable(const NodeDef& node, std::vector<NodeDef>* outputs,
                              bool* result_too_large);
 
@@ -340,6 +347,8 @@ class ConstantFolding : public GraphOptimizer {
   bool graph_contains_assign_or_inplace_op_;
   bool disable_compressed_tensor_optimization_;
   bool fold_quantization_emulation_;
+  string memmapped_package_;
+  int64_t memmapped_package_max_bytes_;
 };
 
 }  // end namespace grappler
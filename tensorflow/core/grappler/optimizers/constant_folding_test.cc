@@ -29,7 +29,9 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/tensor_coding.h"
+#include "tensorflow/core/util/memmapped_file_system.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -3236,6 +3238,60 @@ TEST_F(ConstantFoldingTest, LargeConstant) {
   test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
 }
 
+TEST_F(ConstantFoldingTest, LargeConstantMemmapped) {
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  // Generate a 256 by 256 constant, non-compressible matrix.
+  Output mat_diag =
+      ops::Const(scope.WithOpName("mat_diag"), 3.14f, TensorShape({256}));
+  Output mat = ops::Diag(scope.WithOpName("mat"), mat_diag);
+  Output out = ops::Identity(scope.WithOpName("out"), mat);
+
+  GrapplerItem item;
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+  item.fetch.push_back("out");
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), 1);
+
+  // The package is too small for the matrix, which stays unfolded.
+  const string small_package =
+      io::JoinPath(testing::TmpDir(), "small_constant_package");
+  ConstantFolding small_optimizer(
+      RewriterConfig::ON, /*cpu_device=*/nullptr,
+      /*disable_compressed_tensor_optimization=*/false,
+      /*fold_quantization_emulation=*/true, small_package,
+      /*memmapped_package_max_bytes=*/1024);
+  GraphDef output;
+  TF_EXPECT_OK(small_optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+  NodeMap small_node_map(&output);
+  ASSERT_NE(small_node_map.GetNode("mat"), nullptr);
+  EXPECT_EQ(small_node_map.GetNode("mat")->op(), "Diag");
+
+  const string package =
+      io::JoinPath(testing::TmpDir(), "large_constant_package");
+  ConstantFolding optimizer(RewriterConfig::ON, /*cpu_device=*/nullptr,
+                            /*disable_compressed_tensor_optimization=*/false,
+                            /*fold_quantization_emulation=*/true, package);
+  TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+
+  // The matrix has been folded into the package rather than into the graph.
+  NodeMap node_map(&output);
+  const NodeDef* mat_node = node_map.GetNode("mat");
+  ASSERT_NE(mat_node, nullptr);
+  EXPECT_EQ(mat_node->op(), "ImmutableConst");
+  EXPECT_EQ(mat_node->input_size(), 0);
+  EXPECT_EQ(mat_node->attr().at("dtype").type(), DT_FLOAT);
+  EXPECT_LT(output.ByteSizeLong(), kMaxConstantSize);
+
+  MemmappedEnv memmapped_env(Env::Default());
+  TF_ASSERT_OK(memmapped_env.InitializeFromFile(package));
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  TF_ASSERT_OK(memmapped_env.NewReadOnlyMemoryRegionFromFile(
+      mat_node->attr().at("memory_region_name").s(), &region));
+  const StringPiece expected_data = tensors_expected[0].tensor_data();
+  ASSERT_EQ(region->length(), expected_data.size());
+  EXPECT_EQ(0, memcmp(region->data(), expected_data.data(), region->length()));
+}
+
 TEST_F(ConstantFoldingTest, SwitchIdenticalInputs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output x = ops::Placeholder(s.WithOpName("x"), DT_BOOL,
@@ -0,0 +1,163 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/optimizers/data/columnar_projection_pushdown.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/platform/protobuf.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kColumnarDataset[] = "ColumnarDataset";
+constexpr char kParseExampleDatasetV2[] = "ParseExampleDatasetV2";
+constexpr char kOutputExamples[] = "output_examples";
+
+// The number of inputs of `ParseExampleDatasetV2` before `dense_defaults`.
+constexpr int kNumParseInputsBeforeDefaults = 2;
+
+bool IsFullyDefined(const TensorShapeProto& shape) {
+  if (shape.unknown_rank()) return false;
+  for (const auto& dim : shape.dim()) {
+    if (dim.size() < 0) return false;
+  }
+  return true;
+}
+
+// Returns true if `node` is a constant without elements, i.e. the default of
+// a required feature.
+bool IsEmptyConst(const NodeDef* node) {
+  if (node == nullptr || node->op() != "Const") return false;
+  const AttrValue* value = gtl::FindOrNull(node->attr(), "value");
+  if (value == nullptr || !value->has_tensor()) return false;
+  const TensorShapeProto& shape = value->tensor().tensor_shape();
+  if (shape.unknown_rank()) return false;
+  for (const auto& dim : shape.dim()) {
+    if (dim.size() == 0) return true;
+  }
+  return false;
+}
+
+// Returns true if the features parsed by `parse_node` can be read as columns.
+bool CanPushDownProjection(const NodeDef& parse_node,
+                           const MutableGraphView& graph) {
+  const auto& attrs = parse_node.attr();
+  if (!attrs.contains("sparse_keys") || !attrs.contains("dense_keys") ||
+      !attrs.contains("dense_shapes") || !attrs.contains("output_types") ||
+      !attrs.contains("output_shapes")) {
+    return false;
+  }
+  if (attrs.at("sparse_keys").list().s_size() > 0) return false;
+  const int num_dense = attrs.at("dense_keys").list().s_size();
+  const auto& dense_shapes = attrs.at("dense_shapes").list();
+  if (dense_shapes.shape_size() != num_dense) return false;
+  for (const auto& shape : dense_shapes.shape()) {
+    if (!IsFullyDefined(shape)) return false;
+  }
+  int num_inputs = 0;
+  for (const string& input : parse_node.input()) {
+    if (!IsControlInput(input)) ++num_inputs;
+  }
+  if (num_inputs != kNumParseInputsBeforeDefaults + num_dense) return false;
+  for (int i = 0; i < num_dense; ++i) {
+    const NodeDef* default_node = graph.GetNode(
+        NodeName(parse_node.input(kNumParseInputsBeforeDefaults + i)));
+    if (!IsEmptyConst(default_node)) return false;
+  }
+  return true;
+}
+
+NodeDef MakeColumnarNode(const NodeDef& columnar_node,
+                         const NodeDef& parse_node, MutableGraphView* graph) {
+  NodeDef new_node = columnar_node;
+  graph_utils::SetUniqueGraphNodeName("columnar_projection", graph->graph(),
+                                      &new_node);
+  auto& attrs = *new_node.mutable_attr();
+  const auto& parse_attrs = parse_node.attr();
+  attrs["dense_columns"] = parse_attrs.at("dense_keys");
+  AttrValue empty_list;
+  empty_list.mutable_list();
+  for (const char* name :
+       {"ragged_columns", "ragged_value_types", "ragged_split_types"}) {
+    attrs[name] = empty_list;
+  }
+  if (parse_attrs.contains("ragged_keys")) {
+    attrs["ragged_columns"] = parse_attrs.at("ragged_keys");
+    attrs["ragged_value_types"] = parse_attrs.at("ragged_value_types");
+    attrs["ragged_split_types"] = parse_attrs.at("ragged_split_types");
+  }
+  attrs[kOutputExamples].set_b(false);
+  graph_utils::CopyShapesAndTypesAttrs(parse_node, &new_node);
+  graph_utils::MaybeSetFusedMetadata(columnar_node, parse_node, &new_node);
+  return new_node;
+}
+
+}  // namespace
+
+Status ColumnarProjectionPushdown::OptimizeAndCollectStats(
+    Cluster* cluster, const GrapplerItem& item, GraphDef* output,
+    OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() != kParseExampleDatasetV2) continue;
+
+    // Use a more descriptive variable name now that we know the node type.
+    const NodeDef& parse_node = node;
+    NodeDef* columnar_node = graph_utils::GetInputNode(parse_node, graph);
+    if (columnar_node == nullptr || columnar_node->op() != kColumnarDataset) {
+      continue;
+    }
+    const AttrValue* output_examples =
+        gtl::FindOrNull(columnar_node->attr(), kOutputExamples);
+    if (output_examples == nullptr || !output_examples->b()) continue;
+    // The columnar dataset may not have other consumers than the parse.
+    if (graph.GetFanouts(*columnar_node, /*include_controlled_nodes=*/true)
+            .size() != 1) {
+      continue;
+    }
+    if (!CanPushDownProjection(parse_node, graph)) continue;
+
+    NodeDef* new_node =
+        graph.AddNode(MakeColumnarNode(*columnar_node, parse_node, &graph));
+    TF_RETURN_IF_ERROR(graph.UpdateFanouts(parse_node.name(), new_node->name()));
+
+    // Mark the `ColumnarDataset` and `ParseExampleDatasetV2` nodes for
+    // removal.
+    nodes_to_delete.insert(columnar_node->name());
+    nodes_to_delete.insert(parse_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(ColumnarProjectionPushdown,
+                            "columnar_projection_pushdown");
+
+}  // namespace grappler
+}  // namespace tensorflow
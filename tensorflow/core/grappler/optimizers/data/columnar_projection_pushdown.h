@@ -0,0 +1,55 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_COLUMNAR_PROJECTION_PUSHDOWN_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_COLUMNAR_PROJECTION_PUSHDOWN_H_
+
+#include "tensorflow/core/grappler/optimizers/data/optimizer_base.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// This optimization rewrites a `ColumnarDataset` that emits serialized
+// `tf.Example`s followed by `ParseExampleDatasetV2` into a `ColumnarDataset`
+// that reads only the parsed features as columns, so that the columns that
+// are not parsed are never read and no `tf.Example`s are built and parsed.
+//
+// The rewrite requires that the parse has no sparse features, that every
+// dense feature is required (has an empty default) and has a fully defined
+// shape, and that the columnar dataset has no other consumer. The rewritten
+// dataset requires that the dense and ragged features are stored as dense
+// columns of the same row shape and as ragged columns respectively.
+class ColumnarProjectionPushdown : public TFDataOptimizerBase {
+ public:
+  ColumnarProjectionPushdown() = default;
+  ~ColumnarProjectionPushdown() override = default;
+
+  string name() const override { return "columnar_projection_pushdown"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return OkStatus();
+  }
+
+  Status OptimizeAndCollectStats(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output,
+                                 OptimizationStats* stats) override;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_COLUMNAR_PROJECTION_PUSHDOWN_H_
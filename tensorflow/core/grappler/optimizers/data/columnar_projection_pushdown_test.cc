@@ -0,0 +1,167 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/optimizers/data/columnar_projection_pushdown.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+NodeDef MakeColumnarNode(bool output_examples) {
+  return NDef("columnar", "ColumnarDataset",
+              {"filenames", "batch_size", "num_parallel_reads"},
+              {{"dense_columns", gtl::ArraySlice<tstring>{}},
+               {"ragged_columns", gtl::ArraySlice<tstring>{}},
+               {"ragged_value_types", gtl::ArraySlice<DataType>{}},
+               {"ragged_split_types", gtl::ArraySlice<DataType>{}},
+               {"output_examples", output_examples},
+               {"output_types", gtl::ArraySlice<DataType>{DT_STRING}},
+               {"output_shapes", gtl::ArraySlice<PartialTensorShape>{{-1}}}});
+}
+
+// Returns a parse of the dense feature `ids`, the ragged feature `tokens`, and
+// the given sparse features.
+NodeDef MakeParseNode(gtl::ArraySlice<tstring> sparse_keys = {}) {
+  return NDef(
+      "parse", "ParseExampleDatasetV2",
+      {"columnar", "num_parallel_calls", "ids_default"},
+      {{"sparse_keys", sparse_keys},
+       {"dense_keys", gtl::ArraySlice<tstring>{"ids"}},
+       {"sparse_types", gtl::ArraySlice<DataType>{}},
+       {"Tdense", gtl::ArraySlice<DataType>{DT_INT64}},
+       {"dense_shapes", gtl::ArraySlice<PartialTensorShape>{{}}},
+       {"ragged_keys", gtl::ArraySlice<tstring>{"tokens"}},
+       {"ragged_value_types", gtl::ArraySlice<DataType>{DT_STRING}},
+       {"ragged_split_types", gtl::ArraySlice<DataType>{DT_INT64}},
+       {"deterministic", "default"},
+       {"output_types", gtl::ArraySlice<DataType>{DT_INT64, DT_VARIANT}},
+       {"output_shapes",
+        gtl::ArraySlice<PartialTensorShape>{{-1}, {}}}});
+}
+
+GraphDef MakeGraph(const NodeDef& columnar_node, const NodeDef& parse_node,
+                   const Tensor& ids_default) {
+  return test::function::GDef(
+      {NDef("filenames", "Const", {},
+            {{"value", test::AsTensor<tstring>({"file"})},
+             {"dtype", DT_STRING}}),
+       NDef("batch_size", "Const", {}, {{"value", 4}, {"dtype", DT_INT64}}),
+       NDef("num_parallel_reads", "Const", {},
+            {{"value", 2}, {"dtype", DT_INT64}}),
+       NDef("num_parallel_calls", "Const", {},
+            {{"value", 2}, {"dtype", DT_INT64}}),
+       NDef("ids_default", "Const", {},
+            {{"value", ids_default}, {"dtype", DT_INT64}}),
+       columnar_node, parse_node, NDef("sink", "Identity", {"parse"}, {})},
+      {});
+}
+
+Tensor EmptyDefault() { return Tensor(DT_INT64, TensorShape({0})); }
+
+TEST(ColumnarProjectionPushdownTest, PushesDownParsedFeatures) {
+  GrapplerItem item;
+  item.graph = MakeGraph(MakeColumnarNode(/*output_examples=*/true),
+                         MakeParseNode(), EmptyDefault());
+
+  ColumnarProjectionPushdown optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("columnar", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("parse", output));
+
+  const NodeDef& columnar_node = output.node(
+      graph_utils::FindGraphNodeWithOp("ColumnarDataset", output));
+  EXPECT_EQ(columnar_node.input(0), "filenames");
+  EXPECT_EQ(columnar_node.input(1), "batch_size");
+  EXPECT_EQ(columnar_node.input(2), "num_parallel_reads");
+  const auto& attrs = columnar_node.attr();
+  EXPECT_FALSE(attrs.at("output_examples").b());
+  ASSERT_EQ(attrs.at("dense_columns").list().s_size(), 1);
+  EXPECT_EQ(attrs.at("dense_columns").list().s(0), "ids");
+  ASSERT_EQ(attrs.at("ragged_columns").list().s_size(), 1);
+  EXPECT_EQ(attrs.at("ragged_columns").list().s(0), "tokens");
+  EXPECT_EQ(attrs.at("ragged_value_types").list().type(0), DT_STRING);
+  EXPECT_EQ(attrs.at("ragged_split_types").list().type(0), DT_INT64);
+  ASSERT_EQ(attrs.at("output_types").list().type_size(), 2);
+  EXPECT_EQ(attrs.at("output_types").list().type(0), DT_INT64);
+  EXPECT_EQ(attrs.at("output_types").list().type(1), DT_VARIANT);
+
+  const NodeDef& sink_node =
+      output.node(graph_utils::FindGraphNodeWithName("sink", output));
+  EXPECT_EQ(sink_node.input(0), columnar_node.name());
+}
+
+TEST(ColumnarProjectionPushdownTest, NoPushdownWithoutExampleOutput) {
+  GrapplerItem item;
+  item.graph = MakeGraph(MakeColumnarNode(/*output_examples=*/false),
+                         MakeParseNode(), EmptyDefault());
+
+  ColumnarProjectionPushdown optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("columnar", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("parse", output));
+}
+
+TEST(ColumnarProjectionPushdownTest, NoPushdownWithDefaultValue) {
+  GrapplerItem item;
+  item.graph = MakeGraph(MakeColumnarNode(/*output_examples=*/true),
+                         MakeParseNode(), test::AsScalar<int64_t>(-1));
+
+  ColumnarProjectionPushdown optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("columnar", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("parse", output));
+}
+
+TEST(ColumnarProjectionPushdownTest, NoPushdownWithSparseFeatures) {
+  GrapplerItem item;
+  item.graph = MakeGraph(MakeColumnarNode(/*output_examples=*/true),
+                         MakeParseNode(/*sparse_keys=*/{"labels"}),
+                         EmptyDefault());
+
+  ColumnarProjectionPushdown optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("columnar", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("parse", output));
+}
+
+TEST(ColumnarProjectionPushdownTest, NoPushdownWithOtherConsumers) {
+  GrapplerItem item;
+  item.graph = MakeGraph(MakeColumnarNode(/*output_examples=*/true),
+                         MakeParseNode(), EmptyDefault());
+  *item.graph.add_node() = NDef("other_sink", "Identity", {"columnar"}, {});
+
+  ColumnarProjectionPushdown optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("columnar", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("parse", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -441,6 +441,7 @@ const auto* kDeterministicAttrOps = new absl::flat_hash_set<string>{
     "ParallelInterleaveDatasetV4",
     "ParallelMapDatasetV2",
     "ParallelBatchDataset",
+    "ShuffleDatasetV3",
 };
 }  // anonymous namespace
 
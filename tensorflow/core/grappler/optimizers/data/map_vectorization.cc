@@ -0,0 +1,296 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <functional>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/platform/protobuf.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kMapDataset[] = "MapDataset";
+constexpr char kParallelMapV2[] = "ParallelMapDatasetV2";
+constexpr char kOutputShapes[] = "output_shapes";
+constexpr char kOutputTypes[] = "output_types";
+
+bool IsBatch(const NodeDef& node) {
+  return node.op() == "BatchDataset" || node.op() == "BatchDatasetV2";
+}
+
+// Returns true if `op` computes each element of its output from the elements
+// at the same position in its inputs, with numpy-style broadcasting.
+bool IsElementwiseOp(const string& op) {
+  static const auto* const kElementwiseOps = new absl::flat_hash_set<string>{
+      // Unary ops.
+      "Abs", "Cast", "Ceil", "Cos", "Erf", "Exp", "Expm1", "Floor", "Identity",
+      "IsFinite", "IsInf", "IsNan", "Log", "Log1p", "LogicalNot", "Neg",
+      "Reciprocal", "Relu", "Relu6", "Rint", "Round", "Rsqrt", "Sigmoid",
+      "Sign", "Sin", "Sqrt", "Square", "Tanh",
+      // Binary ops.
+      "Add", "AddV2", "Div", "DivNoNan", "Equal", "FloorDiv", "FloorMod",
+      "Greater", "GreaterEqual", "Less", "LessEqual", "LogicalAnd",
+      "LogicalOr", "Maximum", "Minimum", "Mul", "NotEqual", "Pow", "RealDiv",
+      "SquaredDifference", "Sub", "TruncateDiv"};
+  return kElementwiseOps->contains(op);
+}
+
+bool IsScalarConst(const NodeDef& node) {
+  if (node.op() != "Const") return false;
+  const AttrValue* value = gtl::FindOrNull(node.attr(), "value");
+  return value != nullptr && value->has_tensor() &&
+         !value->tensor().tensor_shape().unknown_rank() &&
+         value->tensor().tensor_shape().dim_size() == 0;
+}
+
+// Returns the name of the function argument or node that produces the
+// function input `input`, or an empty string for a control input.
+StringPiece InputSource(StringPiece input) {
+  if (absl::StartsWith(input, "^")) return StringPiece();
+  return input.substr(0, input.find(':'));
+}
+
+// Returns true if `function` only uses elementwise ops and scalar constants,
+// and every output depends on an argument, so that applying it to a batch of
+// elements of the same shape computes the batch of its per-element results.
+bool IsVectorizable(const FunctionDef& function) {
+  absl::flat_hash_map<string, const NodeDef*> nodes;
+  for (const NodeDef& node : function.node_def()) {
+    if (!IsElementwiseOp(node.op()) && !IsScalarConst(node)) {
+      VLOG(1) << "Cannot vectorize " << function.signature().name()
+              << " because of node " << node.name() << " (" << node.op()
+              << ")";
+      return false;
+    }
+    nodes[node.name()] = &node;
+  }
+
+  // Memoized results of `depends_on_arg`, computed on the fly (the nodes are
+  // not necessarily topologically sorted).
+  absl::flat_hash_map<string, bool> depends_on_arg;
+  for (const auto& arg : function.signature().input_arg()) {
+    depends_on_arg[arg.name()] = true;
+  }
+  std::function<bool(StringPiece)> compute = [&](StringPiece name) {
+    auto it = depends_on_arg.find(name);
+    if (it != depends_on_arg.end()) return it->second;
+    // Guard against cycles.
+    depends_on_arg[name] = false;
+    bool result = false;
+    auto node_it = nodes.find(name);
+    if (node_it != nodes.end()) {
+      for (const string& input : node_it->second->input()) {
+        StringPiece source = InputSource(input);
+        if (!source.empty() && compute(source)) result = true;
+      }
+    }
+    depends_on_arg[name] = result;
+    return result;
+  };
+
+  for (const auto& ret : function.ret()) {
+    if (!compute(InputSource(ret.second))) {
+      VLOG(1) << "Cannot vectorize " << function.signature().name()
+              << " because output " << ret.first
+              << " does not depend on its arguments";
+      return false;
+    }
+  }
+  return function.control_ret().empty();
+}
+
+bool IsFullyDefined(const TensorShapeProto& shape) {
+  if (shape.unknown_rank()) return false;
+  for (const auto& dim : shape.dim()) {
+    if (dim.size() < 0) return false;
+  }
+  return true;
+}
+
+// Returns true if all components of the elements produced by `node` have the
+// same fully defined shape.
+bool HasUniformElementShape(const NodeDef& node) {
+  const AttrValue* shapes = gtl::FindOrNull(node.attr(), kOutputShapes);
+  if (shapes == nullptr || shapes->list().shape_size() == 0) return false;
+  const TensorShapeProto& first = shapes->list().shape(0);
+  if (!IsFullyDefined(first)) return false;
+  for (const auto& shape : shapes->list().shape()) {
+    if (shape.dim_size() != first.dim_size()) return false;
+    for (int i = 0; i < shape.dim_size(); ++i) {
+      if (shape.dim(i).size() != first.dim(i).size()) return false;
+    }
+  }
+  return true;
+}
+
+// Returns the vectorizable map function of `map_node` if the map can be moved
+// after its batch consumer, or nullptr otherwise.
+const FunctionDef* GetVectorizableFunction(
+    const NodeDef& map_node, const MutableGraphView& graph,
+    const FunctionLibraryDefinition& function_library) {
+  // Captured inputs are not batched with the elements, so maps with captured
+  // inputs are not supported.
+  if (map_node.op() == kMapDataset) {
+    if (map_node.input_size() != 1) return nullptr;
+  } else if (map_node.op() == kParallelMapV2) {
+    if (map_node.input_size() != 2) return nullptr;
+  } else {
+    return nullptr;
+  }
+  // The map may not have other consumers than the batch.
+  if (graph.GetFanouts(map_node, /*include_controlled_nodes=*/true).size() !=
+      1) {
+    return nullptr;
+  }
+  const NodeDef* input_node = graph_utils::GetInputNode(map_node, graph);
+  if (input_node == nullptr || !HasUniformElementShape(*input_node)) {
+    return nullptr;
+  }
+  const FunctionDef* function =
+      function_library.Find(map_node.attr().at("f").func().name());
+  if (function == nullptr || !IsVectorizable(*function)) return nullptr;
+  return function;
+}
+
+// Returns a copy of `function` without the shape annotations that only hold
+// for a single element.
+FunctionDef MakeVectorizedFunction(const FunctionDef& function,
+                                   FunctionDefLibrary* library) {
+  FunctionDef vectorized = function;
+  graph_utils::SetUniqueGraphFunctionName(
+      absl::StrCat("vectorized_", function.signature().name()), library,
+      &vectorized);
+  for (NodeDef& node : *vectorized.mutable_node_def()) {
+    node.mutable_attr()->erase("_output_shapes");
+  }
+  for (auto& arg_attr : *vectorized.mutable_arg_attr()) {
+    arg_attr.second.mutable_attr()->erase("_output_shapes");
+  }
+  return vectorized;
+}
+
+NodeDef MakeBatchNode(const NodeDef& map_node, const NodeDef& batch_node,
+                      const NodeDef& input_node, MutableGraphView* graph) {
+  NodeDef new_node = batch_node;
+  graph_utils::SetUniqueGraphNodeName("vectorized_batch", graph->graph(),
+                                      &new_node);
+  new_node.set_input(0, map_node.input(0));
+
+  int64_t batch_dim = -1;
+  const AttrValue* batch_shapes =
+      gtl::FindOrNull(batch_node.attr(), kOutputShapes);
+  if (batch_shapes != nullptr && batch_shapes->list().shape_size() > 0 &&
+      batch_shapes->list().shape(0).dim_size() > 0) {
+    batch_dim = batch_shapes->list().shape(0).dim(0).size();
+  }
+  AttrValue shapes;
+  for (const auto& shape : input_node.attr().at(kOutputShapes).list().shape()) {
+    TensorShapeProto* batched = shapes.mutable_list()->add_shape();
+    batched->add_dim()->set_size(batch_dim);
+    for (const auto& dim : shape.dim()) *batched->add_dim() = dim;
+  }
+  (*new_node.mutable_attr())[kOutputShapes] = std::move(shapes);
+
+  DataTypeVector types;
+  if (graph_utils::GetDatasetOutputTypesAttr(input_node, &types).ok()) {
+    AttrValue types_attr;
+    for (DataType type : types) types_attr.mutable_list()->add_type(type);
+    (*new_node.mutable_attr())[kOutputTypes] = std::move(types_attr);
+  }
+  return new_node;
+}
+
+NodeDef MakeMapNode(const NodeDef& map_node, const NodeDef& batch_node,
+                    const NodeDef& new_batch_node,
+                    const FunctionDef& vectorized_function,
+                    MutableGraphView* graph) {
+  NodeDef new_node = map_node;
+  graph_utils::SetUniqueGraphNodeName("vectorized_map", graph->graph(),
+                                      &new_node);
+  new_node.set_input(0, new_batch_node.name());
+  *(*new_node.mutable_attr())["f"].mutable_func()->mutable_name() =
+      vectorized_function.signature().name();
+  graph_utils::CopyShapesAndTypesAttrs(batch_node, &new_node);
+  graph_utils::MaybeSetFusedMetadata(map_node, batch_node, &new_node);
+  return new_node;
+}
+
+}  // namespace
+
+Status MapVectorization::OptimizeAndCollectStats(Cluster* cluster,
+                                                 const GrapplerItem& item,
+                                                 GraphDef* output,
+                                                 OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+
+  for (const NodeDef& node : item.graph.node()) {
+    if (!IsBatch(node)) continue;
+
+    // Use a more descriptive variable name now that we know the node type.
+    const NodeDef& batch_node = node;
+    NodeDef* map_node = graph_utils::GetInputNode(batch_node, graph);
+    if (map_node == nullptr) continue;
+    const FunctionDef* function =
+        GetVectorizableFunction(*map_node, graph, function_library);
+    if (function == nullptr) continue;
+    const NodeDef* input_node = graph_utils::GetInputNode(*map_node, graph);
+
+    FunctionDef vectorized_function =
+        MakeVectorizedFunction(*function, output->mutable_library());
+    TF_RETURN_IF_ERROR(function_library.AddFunctionDef(vectorized_function));
+    *output->mutable_library()->add_function() = vectorized_function;
+
+    NodeDef* new_batch_node = graph.AddNode(
+        MakeBatchNode(*map_node, batch_node, *input_node, &graph));
+    NodeDef* new_map_node =
+        graph.AddNode(MakeMapNode(*map_node, batch_node, *new_batch_node,
+                                  vectorized_function, &graph));
+    TF_RETURN_IF_ERROR(
+        graph.UpdateFanouts(batch_node.name(), new_map_node->name()));
+
+    // Mark the `Map` and `Batch` nodes for removal.
+    nodes_to_delete.insert(map_node->name());
+    nodes_to_delete.insert(batch_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapVectorization, "map_vectorization");
+
+}  // namespace grappler
+}  // namespace tensorflow
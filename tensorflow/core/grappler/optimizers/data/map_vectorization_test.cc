@@ -0,0 +1,164 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using graph_tests_utils::MakeBatchV2Node;
+using graph_tests_utils::MakeMapNode;
+using graph_tests_utils::MakeParallelMapV2Node;
+using test::function::NDef;
+
+// Returns a range dataset node whose elements have the given shape.
+NodeDef MakeRangeNode(const PartialTensorShape& element_shape) {
+  return NDef("range", "RangeDataset", {"start", "stop", "step"},
+              {{"output_shapes", gtl::ArraySlice<PartialTensorShape>{
+                                     element_shape}},
+               {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}});
+}
+
+GraphDef MakeMapAndBatchGraph(const NodeDef& map_node,
+                              const PartialTensorShape& element_shape,
+                              const FunctionDef& function) {
+  return test::function::GDef(
+      {NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT32}}),
+       NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT32}}),
+       NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT32}}),
+       NDef("num_parallel_calls", "Const", {},
+            {{"value", 2}, {"dtype", DT_INT64}}),
+       NDef("batch_size", "Const", {}, {{"value", 4}, {"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", false}, {"dtype", DT_BOOL}}),
+       MakeRangeNode(element_shape), map_node,
+       MakeBatchV2Node("batch", map_node.name(), "batch_size",
+                       "drop_remainder", /*parallel_copy=*/false),
+       NDef("sink", "Identity", {"batch"}, {})},
+      {function});
+}
+
+TEST(MapVectorizationTest, VectorizesElementwiseMap) {
+  GrapplerItem item;
+  item.graph = MakeMapAndBatchGraph(MakeMapNode("map", "range"),
+                                    PartialTensorShape({}),
+                                    test::function::XTimesTwo());
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("batch", output));
+
+  const NodeDef& batch_node = output.node(
+      graph_utils::FindGraphNodeWithOp("BatchDatasetV2", output));
+  EXPECT_EQ(batch_node.input(0), "range");
+  EXPECT_EQ(batch_node.input(1), "batch_size");
+  EXPECT_EQ(batch_node.input(2), "drop_remainder");
+  const auto& batch_shapes = batch_node.attr().at("output_shapes").list();
+  ASSERT_EQ(batch_shapes.shape_size(), 1);
+  EXPECT_EQ(batch_shapes.shape(0).dim_size(), 1);
+
+  const NodeDef& map_node =
+      output.node(graph_utils::FindGraphNodeWithOp("MapDataset", output));
+  EXPECT_EQ(map_node.input(0), batch_node.name());
+  const string& function_name = map_node.attr().at("f").func().name();
+  EXPECT_NE(function_name, "XTimesTwo");
+  EXPECT_TRUE(
+      graph_utils::ContainsGraphFunctionWithName(function_name,
+                                                  output.library()));
+
+  const NodeDef& sink_node =
+      output.node(graph_utils::FindGraphNodeWithName("sink", output));
+  EXPECT_EQ(sink_node.input(0), map_node.name());
+}
+
+TEST(MapVectorizationTest, VectorizesParallelMap) {
+  GrapplerItem item;
+  item.graph = MakeMapAndBatchGraph(
+      MakeParallelMapV2Node("map", "range", "num_parallel_calls", "XTimesTwo",
+                            "default"),
+      PartialTensorShape({3}), test::function::XTimesTwo());
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+
+  const NodeDef& map_node = output.node(
+      graph_utils::FindGraphNodeWithOp("ParallelMapDatasetV2", output));
+  EXPECT_EQ(map_node.input(1), "num_parallel_calls");
+  EXPECT_EQ(map_node.attr().at("deterministic").s(), "default");
+  const NodeDef& batch_node =
+      output.node(graph_utils::FindGraphNodeWithName(map_node.input(0),
+                                                     output));
+  const auto& batch_shape =
+      batch_node.attr().at("output_shapes").list().shape(0);
+  ASSERT_EQ(batch_shape.dim_size(), 2);
+  EXPECT_EQ(batch_shape.dim(1).size(), 3);
+}
+
+TEST(MapVectorizationTest, DoesNotVectorizeNonElementwiseFunction) {
+  GrapplerItem item;
+  item.graph = MakeMapAndBatchGraph(
+      MakeMapNode("map", "range", "RandomUniform"), PartialTensorShape({}),
+      test::function::RandomUniform());
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, DoesNotVectorizeUnknownElementShape) {
+  GrapplerItem item;
+  item.graph = MakeMapAndBatchGraph(MakeMapNode("map", "range"),
+                                    PartialTensorShape({-1}),
+                                    test::function::XTimesTwo());
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, DoesNotVectorizeMapWithOtherConsumers) {
+  GrapplerItem item;
+  item.graph = MakeMapAndBatchGraph(MakeMapNode("map", "range"),
+                                    PartialTensorShape({}),
+                                    test::function::XTimesTwo());
+  *item.graph.add_node() = NDef("other_sink", "Identity", {"map"}, {});
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
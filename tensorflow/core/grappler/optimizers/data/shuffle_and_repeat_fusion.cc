@@ -40,6 +40,7 @@ constexpr char kShuffleAndRepeatDataset[] = "ShuffleAndRepeatDataset";
 constexpr char kShuffleAndRepeatDatasetV2[] = "ShuffleAndRepeatDatasetV2";
 
 constexpr char kReshuffleEachIteration[] = "reshuffle_each_iteration";
+constexpr char kNumShards[] = "num_shards";
 
 Status FuseShuffleV1AndRepeat(const NodeDef& shuffle_node,
                               const NodeDef& repeat_node,
@@ -178,6 +179,11 @@ Status ShuffleAndRepeatFusion::OptimizeAndCollectStats(
                                                 &graph, output, &fused_node));
 
     } else if (shuffle_node.op() == kShuffleDatasetV3) {
+      // `ShuffleAndRepeatDatasetV2` does not support a sharded buffer.
+      if (shuffle_node.attr().contains(kNumShards) &&
+          shuffle_node.attr().at(kNumShards).i() > 1) {
+        continue;
+      }
       TF_RETURN_IF_ERROR(FuseShuffleV3AndRepeat(shuffle_node, repeat_node,
                                                 &graph, output, &fused_node));
     } else {
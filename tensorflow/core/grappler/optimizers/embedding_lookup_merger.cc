@@ -0,0 +1,349 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/embedding_lookup_merger.h"
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <set>
+#include <unordered_set>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+constexpr char kOptimizedNodePrefix[] = "EmbeddingLookupMerger";
+
+// Returns the name of the attribute holding the type of the gathered rows.
+const char* GatherDataTypeAttr(const NodeDef& gather) {
+  return IsResourceGather(gather) ? "dtype" : "Tparams";
+}
+
+bool IsScalarZero(const NodeDef& node) {
+  if (!IsConstant(node) || node.attr().count("value") == 0) return false;
+  Tensor value;
+  if (!value.FromProto(node.attr().at("value").tensor())) return false;
+  if (value.NumElements() != 1) return false;
+  if (value.dtype() == DT_INT32) return value.flat<int32>()(0) == 0;
+  if (value.dtype() == DT_INT64) return value.flat<int64_t>()(0) == 0;
+  return false;
+}
+
+class EmbeddingLookupMergerImpl {
+ public:
+  EmbeddingLookupMergerImpl(const GrapplerItem& item, bool deduplicate_ids,
+                            GraphDef* optimized_graph)
+      : item_(item),
+        deduplicate_ids_(deduplicate_ids),
+        graph_(optimized_graph),
+        properties_(item),
+        nodes_to_preserve_(item.NodesToPreserve()) {}
+
+  Status Optimize();
+
+ private:
+  // Returns true if `gather` can be merged with other lookups, and sets `key`
+  // to a string that is equal for all the lookups it can be merged with.
+  bool IsMergeable(const NodeDef& gather, string* key) const;
+
+  // Drops from `lookups` the ones that some other lookup of the group depends
+  // on: merging them would create a cycle.
+  void DropDependentLookups(std::vector<NodeDef*>* lookups) const;
+
+  Status MergeLookups(const std::vector<NodeDef*>& lookups);
+
+  NodeDef* AddNode(NodeDef&& node);
+
+  const GrapplerItem& item_;
+  const bool deduplicate_ids_;
+  GraphDef* graph_;
+  GraphProperties properties_;
+  FrameView frames_;
+  std::unique_ptr<NodeMap> node_map_;
+  const std::unordered_set<string> nodes_to_preserve_;
+  std::set<string> nodes_to_delete_;
+};
+
+bool EmbeddingLookupMergerImpl::IsMergeable(const NodeDef& gather,
+                                            string* key) const {
+  if (!IsGather(gather) || nodes_to_preserve_.count(gather.name()) > 0 ||
+      HasControlInputs(gather)) {
+    return false;
+  }
+  int batch_dims = 0;
+  if (TryGetNodeAttr(gather, "batch_dims", &batch_dims) && batch_dims != 0) {
+    return false;
+  }
+  const int num_regular_inputs = gather.op() == "GatherV2" ? 3 : 2;
+  if (gather.input_size() != num_regular_inputs) return false;
+  if (gather.op() == "GatherV2") {
+    const NodeDef* axis = node_map_->GetNode(gather.input(2));
+    if (axis == nullptr || !IsScalarZero(*axis)) return false;
+  }
+
+  // The ids must be a vector, so that the rows of the merged lookup can be
+  // split back without any reshaping.
+  if (!properties_.HasInputProperties(gather.name())) return false;
+  const auto& input_props = properties_.GetInputProperties(gather.name());
+  if (input_props.size() < 2 || input_props[1].shape().unknown_rank() ||
+      input_props[1].shape().dim_size() != 1) {
+    return false;
+  }
+
+  // The remapper fuses a ResourceGather feeding a single SparseSegment
+  // reduction into one kernel, which is better than merging the lookup.
+  const auto& fanouts = node_map_->GetOutputs(gather.name());
+  if (IsResourceGather(gather) && fanouts.size() == 1) {
+    const NodeDef* consumer = *fanouts.begin();
+    if (IsSparseSegmentReduction(*consumer) &&
+        NodeName(consumer->input(0)) == gather.name()) {
+      return false;
+    }
+  }
+
+  DataType dtype;
+  DataType tindices;
+  if (!GetNodeAttr(gather, GatherDataTypeAttr(gather), &dtype).ok() ||
+      !GetNodeAttr(gather, "Tindices", &tindices).ok()) {
+    return false;
+  }
+  const TensorId params = ParseTensorName(gather.input(0));
+  *key = absl::StrCat(gather.op(), ";", params.node(), ":", params.index(),
+                      ";", gather.device(), ";", DataTypeString(dtype), ";",
+                      DataTypeString(tindices), ";",
+                      absl::StrJoin(frames_.Frames(gather), ","));
+  return true;
+}
+
+void EmbeddingLookupMergerImpl::DropDependentLookups(
+    std::vector<NodeDef*>* lookups) const {
+  std::unordered_set<const NodeDef*> visited;
+  std::deque<const NodeDef*> queue;
+  for (const NodeDef* lookup : *lookups) {
+    const NodeDef* ids = node_map_->GetNode(lookup->input(1));
+    if (ids != nullptr && visited.insert(ids).second) queue.push_back(ids);
+  }
+  while (!queue.empty()) {
+    const NodeDef* node = queue.front();
+    queue.pop_front();
+    for (const string& input : node->input()) {
+      const NodeDef* fanin = node_map_->GetNode(input);
+      if (fanin != nullptr && visited.insert(fanin).second) {
+        queue.push_back(fanin);
+      }
+    }
+  }
+  lookups->erase(std::remove_if(lookups->begin(), lookups->end(),
+                                [&visited](const NodeDef* lookup) {
+                                  return visited.count(lookup) > 0;
+                                }),
+                 lookups->end());
+}
+
+NodeDef* EmbeddingLookupMergerImpl::AddNode(NodeDef&& node) {
+  NodeDef* added = graph_->add_node();
+  added->Swap(&node);
+  node_map_->AddNode(added->name(), added);
+  for (const string& input : added->input()) {
+    node_map_->AddOutput(NodeName(input), added->name());
+  }
+  return added;
+}
+
+Status EmbeddingLookupMergerImpl::MergeLookups(
+    const std::vector<NodeDef*>& lookups) {
+  const NodeDef& first = *lookups[0];
+  const string prefix = AddPrefixToNodeName(first.name(), kOptimizedNodePrefix);
+  if (node_map_->NodeExists(prefix)) {
+    return errors::AlreadyExists("Node ", prefix, " already exists");
+  }
+  const int num_lookups = lookups.size();
+  const DataType dtype = first.attr().at(GatherDataTypeAttr(first)).type();
+  const DataType tindices = first.attr().at("Tindices").type();
+  VLOG(2) << "Merge " << num_lookups << " lookups of " << first.input(0)
+          << " into " << prefix;
+
+  NodeDef axis;
+  axis.set_name(absl::StrCat(prefix, "/axis"));
+  axis.set_op("Const");
+  axis.set_device(first.device());
+  (*axis.mutable_attr())["dtype"].set_type(DT_INT32);
+  Tensor zero(DT_INT32, TensorShape({}));
+  zero.scalar<int32>()() = 0;
+  zero.AsProtoTensorContent((*axis.mutable_attr())["value"].mutable_tensor());
+  // Anchor the constant in the frame of the lookups.
+  const string anchor = AsControlDependency(NodeName(first.input(1)));
+  axis.add_input(anchor);
+  const string axis_name = AddNode(std::move(axis))->name();
+
+  NodeDef ids;
+  ids.set_name(absl::StrCat(prefix, "/ids"));
+  ids.set_op("ConcatV2");
+  ids.set_device(first.device());
+  for (const NodeDef* lookup : lookups) ids.add_input(lookup->input(1));
+  ids.add_input(axis_name);
+  auto* ids_attr = ids.mutable_attr();
+  SetAttrValue(num_lookups, &(*ids_attr)["N"]);
+  SetAttrValue(tindices, &(*ids_attr)["T"]);
+  SetAttrValue(DT_INT32, &(*ids_attr)["Tidx"]);
+  string gather_ids = AddNode(std::move(ids))->name();
+
+  string unique_name;
+  if (deduplicate_ids_) {
+    NodeDef unique;
+    unique.set_name(absl::StrCat(prefix, "/unique"));
+    unique.set_op("Unique");
+    unique.set_device(first.device());
+    unique.add_input(gather_ids);
+    SetAttrValue(tindices, &(*unique.mutable_attr())["T"]);
+    SetAttrValue(DT_INT32, &(*unique.mutable_attr())["out_idx"]);
+    unique_name = AddNode(std::move(unique))->name();
+    gather_ids = unique_name;
+  }
+
+  NodeDef gather = first;
+  gather.set_name(absl::StrCat(prefix, "/gather"));
+  gather.set_input(1, gather_ids);
+  string rows = AddNode(std::move(gather))->name();
+
+  if (deduplicate_ids_) {
+    // Expand the unique rows back to one row per id.
+    NodeDef expand;
+    expand.set_name(absl::StrCat(prefix, "/expand"));
+    expand.set_op("GatherV2");
+    expand.set_device(first.device());
+    expand.add_input(rows);
+    expand.add_input(absl::StrCat(unique_name, ":1"));
+    expand.add_input(axis_name);
+    auto* expand_attr = expand.mutable_attr();
+    SetAttrValue(dtype, &(*expand_attr)["Tparams"]);
+    SetAttrValue(DT_INT32, &(*expand_attr)["Tindices"]);
+    SetAttrValue(DT_INT32, &(*expand_attr)["Taxis"]);
+    SetAttrValue(0, &(*expand_attr)["batch_dims"]);
+    rows = AddNode(std::move(expand))->name();
+  }
+
+  NodeDef sizes;
+  sizes.set_name(absl::StrCat(prefix, "/sizes"));
+  sizes.set_op("Pack");
+  sizes.set_device(first.device());
+  for (int i = 0; i < num_lookups; ++i) {
+    NodeDef size;
+    size.set_name(absl::StrCat(prefix, "/size_", i));
+    size.set_op("Size");
+    size.set_device(first.device());
+    size.add_input(lookups[i]->input(1));
+    SetAttrValue(tindices, &(*size.mutable_attr())["T"]);
+    SetAttrValue(DT_INT32, &(*size.mutable_attr())["out_type"]);
+    sizes.add_input(AddNode(std::move(size))->name());
+  }
+  SetAttrValue(num_lookups, &(*sizes.mutable_attr())["N"]);
+  SetAttrValue(DT_INT32, &(*sizes.mutable_attr())["T"]);
+  SetAttrValue(0, &(*sizes.mutable_attr())["axis"]);
+  const string sizes_name = AddNode(std::move(sizes))->name();
+
+  NodeDef split;
+  split.set_name(absl::StrCat(prefix, "/split"));
+  split.set_op("SplitV");
+  split.set_device(first.device());
+  split.add_input(rows);
+  split.add_input(sizes_name);
+  split.add_input(axis_name);
+  SetAttrValue(num_lookups, &(*split.mutable_attr())["num_split"]);
+  SetAttrValue(dtype, &(*split.mutable_attr())["T"]);
+  SetAttrValue(DT_INT32, &(*split.mutable_attr())["Tlen"]);
+  const string split_name = AddNode(std::move(split))->name();
+
+  // Redirect the consumers of each lookup to its slice of the merged rows.
+  for (int i = 0; i < num_lookups; ++i) {
+    const string& lookup_name = lookups[i]->name();
+    const auto fanouts = node_map_->GetOutputs(lookup_name);
+    for (NodeDef* consumer : fanouts) {
+      for (int j = 0; j < consumer->input_size(); ++j) {
+        const TensorId input = ParseTensorName(consumer->input(j));
+        if (input.node() != lookup_name) continue;
+        const string new_input =
+            input.index() == Graph::kControlSlot
+                ? AsControlDependency(split_name)
+                : absl::StrCat(split_name, ":", i);
+        node_map_->UpdateInput(consumer->name(), consumer->input(j),
+                               new_input);
+        consumer->set_input(j, new_input);
+      }
+    }
+    nodes_to_delete_.insert(lookup_name);
+  }
+  return OkStatus();
+}
+
+Status EmbeddingLookupMergerImpl::Optimize() {
+  TF_RETURN_IF_ERROR(properties_.InferStatically(
+      /*assume_valid_feeds=*/false, /*aggressive_shape_inference=*/false,
+      /*include_tensor_values=*/false));
+  TF_RETURN_IF_ERROR(frames_.InferFromGraph(*graph_));
+  node_map_ = std::make_unique<NodeMap>(graph_);
+
+  // Group the lookups by table, in graph order.
+  std::map<string, std::vector<NodeDef*>> groups;
+  for (NodeDef& node : *graph_->mutable_node()) {
+    string key;
+    if (IsMergeable(node, &key)) groups[key].push_back(&node);
+  }
+
+  for (auto& group : groups) {
+    std::vector<NodeDef*>& lookups = group.second;
+    if (lookups.size() < 2) continue;
+    DropDependentLookups(&lookups);
+    if (lookups.size() < 2) continue;
+    TF_RETURN_IF_ERROR(MergeLookups(lookups));
+  }
+
+  if (nodes_to_delete_.empty()) {
+    return errors::Aborted("Nothing to do.");
+  }
+  EraseNodesFromGraph(nodes_to_delete_, graph_);
+  return OkStatus();
+}
+
+}  // namespace
+
+Status EmbeddingLookupMerger::Optimize(Cluster* cluster,
+                                       const GrapplerItem& item,
+                                       GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  EmbeddingLookupMergerImpl impl(item, deduplicate_ids_, optimized_graph);
+  return impl.Optimize();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
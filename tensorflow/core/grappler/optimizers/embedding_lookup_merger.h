@@ -0,0 +1,57 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_EMBEDDING_LOOKUP_MERGER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_EMBEDDING_LOOKUP_MERGER_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Merges the embedding lookups that gather rows of the same table, e.g. the
+// Gather/ResourceGather ops that several feature columns emit for one shared
+// embedding variable, into a single gather:
+//
+//   ids_0, ..., ids_n -> ConcatV2 -> Gather(table) -> SplitV -> rows_0, ...
+//
+// The ids must be vectors. Lookups that feed a single SparseSegment reduction
+// are left alone, since the remapper fuses those into one kernel already.
+// With the AGGRESSIVE level the merged ids are also deduplicated with Unique
+// before the gather, which pays off when the features share many ids.
+class EmbeddingLookupMerger : public GraphOptimizer {
+ public:
+  EmbeddingLookupMerger() : EmbeddingLookupMerger(RewriterConfig::ON) {}
+  explicit EmbeddingLookupMerger(RewriterConfig::Toggle opt_level)
+      : deduplicate_ids_(opt_level == RewriterConfig::AGGRESSIVE) {}
+
+  ~EmbeddingLookupMerger() override {}
+
+  string name() const override { return "embedding_lookup_merger"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+ private:
+  bool deduplicate_ids_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_EMBEDDING_LOOKUP_MERGER_H_
@@ -0,0 +1,182 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/embedding_lookup_merger.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class EmbeddingLookupMergerTest : public GrapplerTest {
+ protected:
+  // Two feature columns looking up the same embedding table.
+  GrapplerItem TwoLookupsOfSameTable() {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    Output table = ops::Const(s.WithOpName("table"),
+                              GenerateRandomTensor<DT_FLOAT>({10, 4}));
+    Output ids_0 = ops::Placeholder(s.WithOpName("ids_0"), DT_INT32,
+                                    ops::Placeholder::Shape({-1}));
+    Output ids_1 = ops::Placeholder(s.WithOpName("ids_1"), DT_INT32,
+                                    ops::Placeholder::Shape({-1}));
+    Output axis = ops::Const(s.WithOpName("axis"), 0);
+    Output lookup_0 = ops::GatherV2(s.WithOpName("lookup_0"), table, ids_0,
+                                    axis);
+    Output lookup_1 = ops::GatherV2(s.WithOpName("lookup_1"), table, ids_1,
+                                    axis);
+    Output out_0 = ops::Identity(s.WithOpName("out_0"), lookup_0);
+    Output out_1 = ops::Identity(s.WithOpName("out_1"), lookup_1);
+
+    GrapplerItem item;
+    item.fetch = {"out_0", "out_1"};
+    item.feed = {{"ids_0", test::AsTensor<int32>({1, 3, 3, 7})},
+                 {"ids_1", test::AsTensor<int32>({3, 0})}};
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    return item;
+  }
+
+  void VerifyMergedLookups(const GrapplerItem& item, const GraphDef& output) {
+    int num_gathers = 0;
+    for (const NodeDef& node : output.node()) {
+      if (node.op() == "GatherV2") ++num_gathers;
+      if (node.name() == "out_0") {
+        EXPECT_EQ("EmbeddingLookupMerger/lookup_0/split:0", node.input(0));
+      } else if (node.name() == "out_1") {
+        EXPECT_EQ("EmbeddingLookupMerger/lookup_0/split:1", node.input(0));
+      }
+    }
+    EXPECT_EQ(deduplicate_ids_ ? 2 : 1, num_gathers);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), tensors.size());
+    for (int i = 0; i < tensors.size(); ++i) {
+      test::ExpectTensorEqual<float>(tensors[i], tensors_expected[i]);
+    }
+  }
+
+  bool deduplicate_ids_ = false;
+};
+
+TEST_F(EmbeddingLookupMergerTest, MergeLookupsOfSameTable) {
+  GrapplerItem item = TwoLookupsOfSameTable();
+  GraphDef output;
+  EmbeddingLookupMerger optimizer(RewriterConfig::ON);
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  VerifyMergedLookups(item, output);
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("Unique", node.op());
+  }
+}
+
+TEST_F(EmbeddingLookupMergerTest, MergeAndDeduplicateIds) {
+  GrapplerItem item = TwoLookupsOfSameTable();
+  GraphDef output;
+  EmbeddingLookupMerger optimizer(RewriterConfig::AGGRESSIVE);
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  deduplicate_ids_ = true;
+  VerifyMergedLookups(item, output);
+  int num_unique = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.op() == "Unique") ++num_unique;
+  }
+  EXPECT_EQ(1, num_unique);
+}
+
+TEST_F(EmbeddingLookupMergerTest, DontMergeLookupsOfDifferentTables) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output table_0 = ops::Const(s.WithOpName("table_0"),
+                              GenerateRandomTensor<DT_FLOAT>({10, 4}));
+  Output table_1 = ops::Const(s.WithOpName("table_1"),
+                              GenerateRandomTensor<DT_FLOAT>({10, 4}));
+  Output ids = ops::Placeholder(s.WithOpName("ids"), DT_INT32,
+                                ops::Placeholder::Shape({-1}));
+  Output axis = ops::Const(s.WithOpName("axis"), 0);
+  Output lookup_0 = ops::GatherV2(s.WithOpName("lookup_0"), table_0, ids, axis);
+  Output lookup_1 = ops::GatherV2(s.WithOpName("lookup_1"), table_1, ids, axis);
+
+  GrapplerItem item;
+  item.fetch = {"lookup_0", "lookup_1"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  GraphDef output;
+  EmbeddingLookupMerger optimizer(RewriterConfig::ON);
+  EXPECT_EQ(optimizer.Optimize(nullptr, item, &output),
+            errors::Aborted("Nothing to do."));
+}
+
+TEST_F(EmbeddingLookupMergerTest, DontMergeDependentLookups) {
+  // The ids of the second lookup are the result of the first one.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output table = ops::Const(s.WithOpName("table"), {1, 2, 3, 4, 0});
+  Output ids = ops::Placeholder(s.WithOpName("ids"), DT_INT32,
+                                ops::Placeholder::Shape({-1}));
+  Output axis = ops::Const(s.WithOpName("axis"), 0);
+  Output lookup_0 = ops::GatherV2(s.WithOpName("lookup_0"), table, ids, axis);
+  Output lookup_1 =
+      ops::GatherV2(s.WithOpName("lookup_1"), table, lookup_0, axis);
+  Output out = ops::Identity(s.WithOpName("out"), lookup_1);
+
+  GrapplerItem item;
+  item.fetch = {"out"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  GraphDef output;
+  EmbeddingLookupMerger optimizer(RewriterConfig::ON);
+  EXPECT_EQ(optimizer.Optimize(nullptr, item, &output),
+            errors::Aborted("Nothing to do."));
+}
+
+TEST_F(EmbeddingLookupMergerTest, DontMergeLookupsFusedBySparseSegment) {
+  // The remapper fuses each ResourceGather with its SparseSegmentSum.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output table = ops::VarHandleOp(s.WithOpName("table"), DT_FLOAT, {10, 4});
+  Output ids_0 = ops::Placeholder(s.WithOpName("ids_0"), DT_INT32,
+                                  ops::Placeholder::Shape({-1}));
+  Output ids_1 = ops::Placeholder(s.WithOpName("ids_1"), DT_INT32,
+                                  ops::Placeholder::Shape({-1}));
+  Output segment_ids = ops::Placeholder(s.WithOpName("segment_ids"), DT_INT32,
+                                        ops::Placeholder::Shape({-1}));
+  Output indices = ops::Placeholder(s.WithOpName("indices"), DT_INT32,
+                                    ops::Placeholder::Shape({-1}));
+  Output lookup_0 =
+      ops::ResourceGather(s.WithOpName("lookup_0"), table, ids_0, DT_FLOAT);
+  Output lookup_1 =
+      ops::ResourceGather(s.WithOpName("lookup_1"), table, ids_1, DT_FLOAT);
+  Output sum_0 = ops::SparseSegmentSum(s.WithOpName("sum_0"), lookup_0,
+                                       indices, segment_ids);
+  Output sum_1 = ops::SparseSegmentSum(s.WithOpName("sum_1"), lookup_1,
+                                       indices, segment_ids);
+
+  GrapplerItem item;
+  item.fetch = {"sum_0", "sum_1"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  GraphDef output;
+  EmbeddingLookupMerger optimizer(RewriterConfig::ON);
+  EXPECT_EQ(optimizer.Optimize(nullptr, item, &output),
+            errors::Aborted("Nothing to do."));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -15,11 +15,17 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer.h"
 
+#include <algorithm>
+#include <optional>
 #include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/kernel_shape_util.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -29,7 +35,12 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer_factory.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
+#include "tensorflow/core/util/autotune_maps/conv_layout_timings.h"
+#include "tensorflow/core/util/padding.h"
+#include "tensorflow/core/util/tensor_format.h"
+#include "tensorflow/tsl/lib/strings/proto_serialization.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -40,6 +51,9 @@ constexpr char kNHWC[] = "NHWC";
 constexpr char kNCHW[] = "NCHW";
 constexpr float kGPURatioThreshold = 0.5;
 constexpr float kConvGPUExpectedDtypeThreshold = 0.5;
+// Memory bandwidth assumed for GPUs that don't report one, used to estimate
+// the cost of transposes.
+constexpr int64_t kDefaultGPUBandwidthKBps = 100 * 1024 * 1024;
 
 struct MutableNodeViewFormatter {
   void operator()(std::string* out, utils::MutableNodeView* node_view) const {
@@ -142,11 +156,226 @@ inline bool ConvBackpropExists(const TransposeContext& context,
   return false;
 }
 
+// Time to read and write `bytes` once, as a transpose does.
+absl::Duration TransposeTime(int64_t bytes, int64_t bandwidth_kbps) {
+  return absl::Seconds(2.0 * bytes / (bandwidth_kbps * 1024.0));
+}
+
+int64_t TensorBytes(const OpInfo::TensorProperties& properties) {
+  const PartialTensorShape shape(properties.shape());
+  if (!shape.IsFullyDefined()) return -1;
+  return shape.num_elements() * DataTypeSize(properties.dtype());
+}
+
+// Builds the parameters under which conv autotuning records the run time of
+// the Conv2D `node`, the way the GPU kernel computes them, leaving the compute
+// data format to the caller.
+bool GetConv2DParameters(const TransposeContext& context, const NodeDef& node,
+                         const string& device_identifier,
+                         ConvParametersProto* params) {
+  const auto& input_props =
+      context.graph_properties->GetInputProperties(node.name());
+  if (input_props.size() != 2) return false;
+  const PartialTensorShape input_shape(input_props[0].shape());
+  const PartialTensorShape filter_shape(input_props[1].shape());
+  if (!input_shape.IsFullyDefined() || input_shape.dims() != 4 ||
+      !filter_shape.IsFullyDefined() || filter_shape.dims() != 4) {
+    return false;
+  }
+  string data_format_str;
+  TensorFormat data_format;
+  string padding_str;
+  Padding padding;
+  std::vector<int32> strides;
+  std::vector<int32> dilations;
+  std::vector<int64_t> explicit_paddings;
+  if (!TryGetNodeAttr(node, "data_format", &data_format_str) ||
+      !FormatFromString(data_format_str, &data_format) ||
+      !TryGetNodeAttr(node, "padding", &padding_str) ||
+      !GetPaddingFromString(padding_str, &padding).ok() ||
+      !TryGetNodeAttr(node, "strides", &strides) || strides.size() != 4) {
+    return false;
+  }
+  if (!TryGetNodeAttr(node, "dilations", &dilations)) dilations = {1, 1, 1, 1};
+  if (dilations.size() != 4) return false;
+  if (padding == EXPLICIT &&
+      (!TryGetNodeAttr(node, "explicit_paddings", &explicit_paddings) ||
+       explicit_paddings.size() != 8)) {
+    return false;
+  }
+
+  const auto dim = [&](char dimension) {
+    return input_shape.dim_size(GetTensorDimIndex(data_format, dimension));
+  };
+  const auto attr = [&](const std::vector<int32>& values, char dimension) {
+    return values[GetTensorDimIndex(data_format, dimension)];
+  };
+  const int64_t patch_depths = filter_shape.dim_size(2);
+  if (patch_depths <= 0 || dim('C') % patch_depths != 0) return false;
+
+  int64_t in_size[2] = {dim('H'), dim('W')};
+  int64_t common_padding[2];
+  const char dimensions[2] = {'H', 'W'};
+  for (int i = 0; i < 2; ++i) {
+    int64_t padding_before = -1, padding_after = -1;
+    if (padding == EXPLICIT) {
+      GetExplicitPaddingForDim(explicit_paddings, data_format, dimensions[i],
+                               &padding_before, &padding_after);
+    }
+    int64_t out_size;
+    if (!GetWindowedOutputSizeVerboseV2(
+             in_size[i], filter_shape.dim_size(i),
+             attr(dilations, dimensions[i]), attr(strides, dimensions[i]),
+             padding, &out_size, &padding_before, &padding_after)
+             .ok()) {
+      return false;
+    }
+    // Like the kernel, pad the input for asymmetric padding.
+    in_size[i] += std::abs(padding_after - padding_before);
+    common_padding[i] = std::min(padding_before, padding_after);
+  }
+
+  params->set_batch(dim('N'));
+  params->set_in_depths(dim('C'));
+  params->add_in(in_size[0]);
+  params->add_in(in_size[1]);
+  params->set_out_depths(filter_shape.dim_size(3));
+  params->add_filter(filter_shape.dim_size(0));
+  params->add_filter(filter_shape.dim_size(1));
+  params->add_filter(patch_depths);
+  params->add_dilation(attr(dilations, 'H'));
+  params->add_dilation(attr(dilations, 'W'));
+  params->add_stride(attr(strides, 'H'));
+  params->add_stride(attr(strides, 'W'));
+  params->add_padding(common_padding[0]);
+  params->add_padding(common_padding[1]);
+  params->set_dtype(input_props[0].dtype());
+  params->set_group_count(dim('C') / patch_depths);
+  params->set_device_identifier(device_identifier);
+  return true;
+}
+
+// Picks the data format of the GPU convolutions from the run times measured
+// by conv autotuning, if they cover all the Conv2D nodes of the graph. Since
+// the graph is converted as a whole, the convolutions form a single region,
+// whose cost in a data format is the run time of its convolutions plus the
+// transposes needed where they meet ops that aren't converted along.
+// Convolutions whose data format the kernel doesn't compute in natively are
+// charged the transposes the kernel does internally. The decision is kept with
+// the autotune maps, so that the same convolutions get the same data format
+// when the autotune maps are loaded again.
+std::optional<string> GetMeasuredDataFormat(const TransposeContext& context,
+                                            const Cluster& cluster) {
+  // Run times are recorded per GPU model.
+  std::optional<string> device_identifier;
+  int64_t bandwidth_kbps = kDefaultGPUBandwidthKBps;
+  for (const auto& device : cluster.GetDevices()) {
+    if (device.second.type() != kGPU) continue;
+    if (device_identifier.has_value() &&
+        *device_identifier != device.second.model()) {
+      return std::nullopt;
+    }
+    device_identifier = device.second.model();
+    if (device.second.bandwidth() > 0) {
+      bandwidth_kbps = device.second.bandwidth();
+    }
+  }
+  if (!device_identifier.has_value()) return std::nullopt;
+
+  const ConvLayoutTimings* timings = ConvLayoutTimings::Global();
+  absl::Duration nhwc_cost;
+  absl::Duration nchw_cost;
+  std::vector<string> region;
+  for (const auto& node : context.graph_view->GetNodes()) {
+    const NodeDef& node_def = *node.node();
+    if (!IsConv2D(node_def)) continue;
+    const string& device_name = GetDeviceName(node_def);
+    string device_type;
+    string task;
+    if (!DeviceNameUtils::SplitDeviceName(device_name, &task, &device_type) ||
+        !absl::StrContains(absl::AsciiStrToLower(device_type),
+                           absl::AsciiStrToLower(kGPU))) {
+      continue;
+    }
+
+    ConvParametersProto params;
+    if (!GetConv2DParameters(context, node_def, *device_identifier,
+                             &params)) {
+      return std::nullopt;
+    }
+    const auto& input_props =
+        context.graph_properties->GetInputProperties(node_def.name());
+    const auto& output_props =
+        context.graph_properties->GetOutputProperties(node_def.name());
+    if (output_props.empty()) return std::nullopt;
+    const int64_t input_bytes = TensorBytes(input_props[0]);
+    const int64_t output_bytes = TensorBytes(output_props[0]);
+    if (input_bytes < 0 || output_bytes < 0) return std::nullopt;
+
+    string region_key;
+    if (!tsl::SerializeToStringDeterministic(params, &region_key)) {
+      return std::nullopt;
+    }
+    region.push_back(std::move(region_key));
+
+    params.set_data_format(FORMAT_NHWC);
+    const std::optional<absl::Duration> nhwc_time = timings->GetRunTime(params);
+    params.set_data_format(FORMAT_NCHW);
+    const std::optional<absl::Duration> nchw_time = timings->GetRunTime(params);
+    if (!nchw_time.has_value()) return std::nullopt;
+    nchw_cost += *nchw_time;
+    nhwc_cost += nhwc_time.has_value()
+                     ? *nhwc_time
+                     : *nchw_time + TransposeTime(input_bytes + output_bytes,
+                                                  bandwidth_kbps);
+
+    int64_t boundary_bytes = 0;
+    const auto not_converted = [](const NodeDef& other) {
+      return !IsLayoutSensitiveOp(other) && !IsLayoutAgnosticOp(other);
+    };
+    if (not_converted(*node.GetRegularFanin(0).node_view()->node())) {
+      boundary_bytes += input_bytes;
+    }
+    for (const auto& fanout : node.GetRegularFanout(0)) {
+      if (not_converted(*fanout.node_view()->node())) {
+        boundary_bytes += output_bytes;
+        break;
+      }
+    }
+    const absl::Duration boundary_cost =
+        TransposeTime(boundary_bytes, bandwidth_kbps);
+    string data_format;
+    if (TryGetNodeAttr(node_def, "data_format", &data_format) &&
+        data_format == kNHWC) {
+      nchw_cost += boundary_cost;
+    } else {
+      nhwc_cost += boundary_cost;
+    }
+  }
+  if (region.empty()) return std::nullopt;
+
+  std::sort(region.begin(), region.end());
+  const string region_name = absl::StrCat(
+      "layout_region_", absl::Hex(Fingerprint64(absl::StrJoin(region, ""))));
+  std::optional<string> decision = timings->GetLayoutDecision(region_name);
+  if (!decision.has_value()) {
+    decision = nhwc_cost < nchw_cost ? kNHWC : kNCHW;
+    ConvLayoutTimings::Global()->RecordLayoutDecision(region_name, *decision);
+  }
+  VLOG(2) << "Measured cost of the convolutions: " << nhwc_cost << " in NHWC, "
+          << nchw_cost << " in NCHW; using " << *decision;
+  return decision;
+}
+
 inline std::pair<string, string> GetSrcAndDstDataFormats(
-    const TransposeContext& context, GpuStats gpu_stats) {
+    const TransposeContext& context, const Cluster& cluster,
+    GpuStats gpu_stats) {
   string src_format = kNHWC;
   string dst_format = kNCHW;
 
+  const std::optional<string> measured_format =
+      context.enforced_layout.empty() ? GetMeasuredDataFormat(context, cluster)
+                                      : std::nullopt;
   const bool is_NHWC_enforced =
       (!context.enforced_layout.empty() && context.enforced_layout == "NHWC");
   const bool volta_ready =
@@ -166,8 +395,12 @@ inline std::pair<string, string> GetSrcAndDstDataFormats(
         NumConvOnDeviceWithDataTypeOverThreshold(context, kGPU, DT_FLOAT) &&
         !ConvBackpropExists(context, kGPU, DT_FLOAT)));
   // We swap only if NHWC is enforced or no layout is enforced and the devices
-  // config meet the thresholds
-  if (is_NHWC_enforced || (context.enforced_layout.empty() && should_swap)) {
+  // config meet the thresholds. Measured run times of the convolutions take
+  // precedence over the devices config.
+  if (measured_format.has_value()) {
+    if (*measured_format == kNHWC) std::swap(src_format, dst_format);
+  } else if (is_NHWC_enforced ||
+             (context.enforced_layout.empty() && should_swap)) {
     std::swap(src_format, dst_format);
   }
 
@@ -486,7 +719,8 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
     TF_RETURN_IF_ERROR(TransposeContext::InitializeTransposeContext(
         /*assume_valid_feeds=*/is_aggressive, item, cluster, &context));
 
-    const auto src_dst_formats = GetSrcAndDstDataFormats(context, gpu_stats);
+    const auto src_dst_formats =
+        GetSrcAndDstDataFormats(context, *cluster, gpu_stats);
     context.AssignDeviceAndDataFormats(kGPU, src_dst_formats.first,
                                        src_dst_formats.second);
   } else {
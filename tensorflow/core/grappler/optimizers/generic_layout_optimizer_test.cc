@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/cc/ops/const_op.h"
 #include "tensorflow/cc/ops/nn_ops.h"
@@ -34,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/autotune_maps/conv_layout_timings.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -322,6 +324,61 @@ TEST_F(GenericLayoutOptimizerTest, GPUDevice) {
   VerifyDataFormatAttributeMatch(conv_node, "NCHW");
 }
 
+TEST_F(GenericLayoutOptimizerTest, GPUDeviceMeasuredDataFormat) {
+#if !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+  GTEST_SKIP() << "Neither CUDA nor ROCm is enabled";
+#endif  // !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto conv =
+      SimpleConv2D(&s, 4, 2, "VALID", "/job:w/replica:0/task:0/device:GPU:0");
+  Output fetch = ops::Identity(s.WithOpName("Fetch"), {conv});
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // The parameters conv autotuning records the run times of Conv2D under.
+  ConvParametersProto params;
+  params.set_batch(8);
+  params.set_in_depths(3);
+  params.add_in(4);
+  params.add_in(4);
+  params.set_out_depths(2);
+  params.add_filter(2);
+  params.add_filter(2);
+  params.add_filter(3);
+  params.add_dilation(1);
+  params.add_dilation(1);
+  params.add_stride(1);
+  params.add_stride(1);
+  params.add_padding(0);
+  params.add_padding(0);
+  params.set_dtype(DT_FLOAT);
+  params.set_group_count(1);
+  ConvLayoutTimings* timings = ConvLayoutTimings::Global();
+  timings->Clear();
+  params.set_data_format(FORMAT_NHWC);
+  timings->RecordRunTime(params, absl::Microseconds(1));
+  params.set_data_format(FORMAT_NCHW);
+  timings->RecordRunTime(params, absl::Microseconds(100));
+
+  GenericLayoutOptimizer optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+
+  Status status;
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  auto* conv_node = graph_view.GetNode("Conv2D");
+  ASSERT_NE(conv_node, nullptr);
+  VerifyDataFormatAttributeMatch(conv_node, "NHWC");
+
+  // The decision is saved with the autotune maps.
+  AutotuneMapsProto proto;
+  timings->ToProto(&proto);
+  ASSERT_EQ(proto.layout_decisions_size(), 1);
+  EXPECT_EQ(proto.layout_decisions().begin()->second, "NHWC");
+  timings->Clear();
+}
+
 TEST_F(GenericLayoutOptimizerTest, CPUDevice) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   auto conv = SimpleConv2D(&s, 4, 2, "VALID", "/CPU:0");
@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/static_schedule.h"
 #include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/frame.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/grappler/utils/traversal.h"
 #include "tensorflow/core/lib/math/math_util.h"
@@ -440,6 +441,18 @@ void RecomputeSubgraph(
   }
 }
 
+// Returns true for the nodes whose inputs we may want to recompute. This
+// matches node names that contain recomputation_targets_name_scope as a name
+// scope, meaning it either begins with or contains the name scope. Defaults to
+// "gradients/" which will match any node names that begins with "gradients/"
+// or contains "/gradients/".
+bool IsRecomputationTarget(const string& recomputation_targets_name_scope,
+                           const NodeDef& node) {
+  return absl::StartsWith(node.name(), recomputation_targets_name_scope) ||
+         static_cast<int>(
+             node.name().find("/" + recomputation_targets_name_scope)) != -1;
+}
+
 void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                                 const string& recomputation_targets_name_scope,
                                 GraphDef* graph, const GrapplerItem& item) {
@@ -461,15 +474,7 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
   }
   std::function<bool(const NodeDef&)> is_target =
       [&recomputation_targets_name_scope](const NodeDef& node) {
-        // Nodes whose inputs we may want to recompute. This matches node names
-        // that contain recomputation_targets_name_scope as a name scope,
-        // meaning it either begins with or contains the name scope.
-        // Defaults to "gradients/" which will match any node names that begins
-        // with "gradients/" or contains "/gradients/".
-        return absl::StartsWith(node.name(),
-                                recomputation_targets_name_scope) ||
-               static_cast<int>(node.name().find(
-                   "/" + recomputation_targets_name_scope)) != -1;
+        return IsRecomputationTarget(recomputation_targets_name_scope, node);
       };
 
   if (optimization_level == RewriterConfig::RECOMPUTATION_HEURISTICS ||
@@ -512,6 +517,161 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
   }
 }
 
+// Recomputes cheap forward ops during the backward pass, the way XLA's
+// HloRematerialization does, until the estimated peak memory usage of every
+// device fits in its budget: memory_budget if set, otherwise the memory size
+// of the device. The candidates are the ops whose outputs are live at the peak
+// and are consumed by recomputation targets. Recomputing an op frees its
+// outputs until they are needed by the targets, but keeps its inputs alive
+// until then: an op is picked only if that saves memory at the peak, the ones
+// that save the most first.
+bool RematerializationPass(Cluster* cluster, int64_t memory_budget,
+                           const string& recomputation_targets_name_scope,
+                           std::unique_ptr<GraphMemory>* memory_ptr,
+                           GrapplerItem* item,
+                           std::unordered_set<string>* skip_list) {
+  if ((*memory_ptr) == nullptr) {
+    memory_ptr->reset(new GraphMemory(*item));
+    Status s = (*memory_ptr)->InferStatically(cluster->GetDevices());
+    if (!s.ok()) {
+      memory_ptr->reset();
+      VLOG(1) << "Failed to infer memory usage: " << s.error_message();
+      return false;
+    }
+  }
+  const GraphMemory& memory = **memory_ptr;
+
+  GraphProperties properties(*item);
+  if (!properties
+           .InferStatically(/*assume_valid_feeds=*/true,
+                            /*aggressive_shape_inference=*/false,
+                            /*include_tensor_values=*/false)
+           .ok()) {
+    return false;
+  }
+  FrameView frames;
+  if (!frames.InferFromGraph(item->graph).ok()) {
+    return false;
+  }
+  NodeMap node_map(&item->graph);
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+  const std::unordered_set<string> cheap_to_recompute_ops =
+      GetCheapToRecomputeOps();
+  auto is_target = [&recomputation_targets_name_scope](const NodeDef& node) {
+    return IsRecomputationTarget(recomputation_targets_name_scope, node);
+  };
+
+  std::set<string> nodes_to_recompute;
+  for (const auto& device : cluster->GetDevices()) {
+    const string& name = device.first;
+    const int64_t budget =
+        memory_budget > 0 ? memory_budget : device.second.memory_size();
+    if (budget <= 0) {
+      VLOG(1) << "Memory budget unknown for device " << name;
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    if (mem_usage.used_memory <= budget) {
+      continue;
+    }
+    const int64_t required_savings = mem_usage.used_memory - budget;
+
+    // The total size of the outputs of each node that are live at the peak.
+    std::unordered_map<string, int64_t> live_bytes;
+    std::unordered_set<string> live_tensors;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      live_bytes[live_tensor.node] += live_tensor.memory_used;
+      live_tensors.insert(
+          strings::StrCat(live_tensor.node, ":", live_tensor.output_id));
+    }
+
+    std::vector<std::pair<int64_t, string>> candidates;
+    for (const auto& live : live_bytes) {
+      const string& node_name = live.first;
+      const NodeDef* node = node_map.GetNode(node_name);
+      // Don't bother with small tensors.
+      if (node == nullptr || live.second <= 1024 || is_target(*node) ||
+          feeds.count(node_name) > 0 || skip_list->count(node_name) > 0 ||
+          !frames.Frames(*node).empty() || !IsFreeOfSideEffect(*node) ||
+          (cheap_to_recompute_ops.count(node->op()) == 0 &&
+           node->attr().count(kRecomputeHint) == 0)) {
+        continue;
+      }
+      bool feeds_target = false;
+      for (const NodeDef* output : node_map.GetOutputs(node_name)) {
+        feeds_target |= is_target(*output);
+      }
+      if (!feeds_target || !properties.HasInputProperties(node_name)) {
+        continue;
+      }
+      // The inputs that are not live at the peak anyway must be kept alive
+      // until the recomputation.
+      int64_t savings = live.second;
+      const auto& input_props = properties.GetInputProperties(node_name);
+      for (int i = 0; i < node->input_size(); ++i) {
+        if (IsControlInput(node->input(i))) break;
+        int port;
+        const string input_name = ParseNodeName(node->input(i), &port);
+        if (i < input_props.size() &&
+            live_tensors.count(strings::StrCat(input_name, ":", port)) == 0) {
+          savings -= CalculateTensorSize(input_props[i]);
+        }
+      }
+      if (savings > 0) {
+        candidates.emplace_back(savings, node_name);
+      }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const std::pair<int64_t, string>& a,
+                 const std::pair<int64_t, string>& b) {
+                return a.first > b.first ||
+                       (a.first == b.first && a.second < b.second);
+              });
+
+    int64_t savings = 0;
+    for (const auto& candidate : candidates) {
+      if (savings >= required_savings) break;
+      if (nodes_to_recompute.insert(candidate.second).second) {
+        savings += candidate.first;
+      }
+    }
+    VLOG(1) << "Rematerializing " << nodes_to_recompute.size()
+            << " nodes to save " << savings << " of the " << required_savings
+            << " bytes over the budget of " << name;
+  }
+  if (nodes_to_recompute.empty()) {
+    return false;
+  }
+  // Don't attempt to recompute these nodes again in a subsequent pass.
+  skip_list->insert(nodes_to_recompute.begin(), nodes_to_recompute.end());
+
+  // The topological sort invalidates all NodeDef pointers.
+  if (!TopologicalSort(&item->graph).ok()) {
+    return false;
+  }
+  NodeMap sorted_node_map(&item->graph);
+  std::unordered_map<const NodeDef*, int> topological_numbering;
+  for (int node_number = 0; node_number < item->graph.node_size();
+       ++node_number) {
+    topological_numbering[item->graph.mutable_node(node_number)] =
+        item->graph.node_size() - node_number - 1;
+  }
+  std::unordered_set<const NodeDef*> recomputed_source_nodes;
+  std::unordered_set<NodeDef*> target_nodes;
+  for (const string& node_name : nodes_to_recompute) {
+    recomputed_source_nodes.insert(sorted_node_map.GetNode(node_name));
+    for (NodeDef* output : sorted_node_map.GetOutputs(node_name)) {
+      if (is_target(*output)) target_nodes.insert(output);
+    }
+  }
+  RecomputeSubgraph(recomputed_source_nodes, target_nodes, sorted_node_map,
+                    topological_numbering, &item->graph);
+  return true;
+}
+
 bool SchedulingPass(Cluster* cluster, std::unique_ptr<GraphMemory>* memory_ptr,
                     GrapplerItem* item) {
   // Look for AddN nodes (and equivalent) and record input names.
@@ -1422,6 +1582,17 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
         }
       }
 
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      if (optimization_level_ == RewriterConfig::REMATERIALIZATION_HEURISTICS) {
+        if (RematerializationPass(cluster, memory_budget_,
+                                  recomputation_targets_name_scope_, &memory,
+                                  &optimized_item, &skip_list)) {
+          // Reset the inferred memory usage since the graph changed.
+          memory.reset();
+          updated_graph = true;
+        }
+      }
+
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
@@ -346,6 +346,42 @@ TEST_F(MemoryOptimizerTest, SwappingHeuristics) {
 #endif
 }
 
+TEST_F(MemoryOptimizerTest, RematerializationHeuristics) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
+                           {128, 128, 8}, DT_FLOAT);
+  Output a = ops::Relu(s.WithOpName("a").WithDevice("/gpu:0"), v);
+  Output b = ops::Exp(s.WithOpName("b").WithDevice("/gpu:0"), a);
+  Output c = ops::Exp(s.WithOpName("c").WithDevice("/gpu:0"), b);
+  Output d = ops::Mul(s.WithOpName("gradients/d").WithDevice("/gpu:0"), a, c);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/d"};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  // The budget defaults to the 1MB of memory of the device, which is too
+  // small to keep "a" alive while "b" and "c" are computed.
+  MemoryOptimizer optimizer(RewriterConfig::REMATERIALIZATION_HEURISTICS,
+                            "gradients/");
+  GraphDef output;
+  Status status = optimizer.Optimize(cluster.get(), item, &output);
+  TF_EXPECT_OK(status);
+
+  NodeMap node_map(&output);
+  const NodeDef* recomputed_a = node_map.GetNode("Recomputed/a");
+  ASSERT_NE(nullptr, recomputed_a);
+  EXPECT_EQ("Relu", recomputed_a->op());
+  EXPECT_EQ("v", recomputed_a->input(0));
+  const NodeDef* gradient = node_map.GetNode("gradients/d");
+  ASSERT_NE(nullptr, gradient);
+  EXPECT_EQ("Recomputed/a", gradient->input(0));
+  EXPECT_EQ("c", gradient->input(1));
+  // Forward ops which are not cheap to recompute are left alone.
+  EXPECT_EQ(nullptr, node_map.GetNode("Recomputed/b"));
+}
+
 TEST_F(MemoryOptimizerTest, UnswappableInputs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
@@ -16,10 +16,14 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 
 #include <algorithm>
+#include <deque>
 #include <functional>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
@@ -41,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
 #include "tensorflow/core/grappler/optimizers/debug_stripper.h"
 #include "tensorflow/core/grappler/optimizers/dependency_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/embedding_lookup_merger.h"
 #include "tensorflow/core/grappler/optimizers/function_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/implementation_selector.h"
@@ -48,6 +53,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/pipeline_parallel.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/shape_optimizer.h"
@@ -59,7 +65,14 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
@@ -107,6 +120,22 @@ bool IsRunOnceOptimizer(const string& name) {
          absl::StartsWith(name, "auto_mixed_precision");
 }
 
+// Check if optimizer is too expensive to run at optimization tier O1.
+bool IsExpensiveOptimizer(const string& name) {
+  static const auto* const kExpensiveOptimizers =
+      new absl::flat_hash_set<string>{"arithmetic_optimizer",
+                                      "autoparallel",
+                                      "embedding_lookup_merger",
+                                      "layout",
+                                      "loop_optimizer",
+                                      "memory_optimizer",
+                                      "pin_to_host_optimizer",
+                                      "pipeline_parallel",
+                                      "remapper",
+                                      "scoped_allocator_optimizer"};
+  return kExpensiveOptimizers->contains(name);
+}
+
 // Creates a function library stub from a real function library: copy only
 // signatures and attributes of all the function defined in fdef_lib. This stub
 // can be swapped with real function library in a graph, before passing it to
@@ -125,6 +154,117 @@ FunctionDefLibrary GetFunctionDefLibraryStub(
   return stub;
 }
 
+// Optimized function bodies shared by all the MetaOptimizer invocations in the
+// process. Every new trace of a tf.function optimizes its whole function
+// library again, although most of the functions in it did not change.
+class FunctionOptimizationCache {
+ public:
+  struct Entry {
+    FunctionDef optimized_func;
+    // Specialized functions created while optimizing the function body.
+    std::vector<FunctionDef> new_funcs;
+  };
+
+  // The capacity, in functions, is read from TF_GRAPPLER_FUNCTION_CACHE_SIZE.
+  // Zero disables the cache.
+  static FunctionOptimizationCache* Global() {
+    static FunctionOptimizationCache* cache = [] {
+      int64_t capacity;
+      TF_CHECK_OK(ReadInt64FromEnvVar("TF_GRAPPLER_FUNCTION_CACHE_SIZE",
+                                      kDefaultCapacity, &capacity));
+      return new FunctionOptimizationCache(capacity);
+    }();
+    return cache;
+  }
+
+  bool enabled() const { return capacity_ > 0; }
+
+  bool Lookup(uint64 key, Entry* entry) TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return false;
+    *entry = it->second;
+    return true;
+  }
+
+  // Evicts the oldest entry when full.
+  void Insert(uint64 key, Entry entry) TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    if (!entries_.emplace(key, std::move(entry)).second) return;
+    insertion_order_.push_back(key);
+    if (insertion_order_.size() > capacity_) {
+      entries_.erase(insertion_order_.front());
+      insertion_order_.pop_front();
+    }
+  }
+
+ private:
+  static constexpr int64_t kDefaultCapacity = 1024;
+
+  explicit FunctionOptimizationCache(int64_t capacity) : capacity_(capacity) {}
+
+  const int64_t capacity_;
+  mutex mu_;
+  absl::flat_hash_map<uint64, Entry> entries_ TF_GUARDED_BY(mu_);
+  std::deque<uint64> insertion_order_ TF_GUARDED_BY(mu_);
+};
+
+uint64 HashProto(const protobuf::MessageLite& proto) {
+  string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  return Fingerprint64(serialized);
+}
+
+// Returns the key of `func` in the FunctionOptimizationCache: everything that
+// the optimized body depends on. That is the function and all the functions it
+// calls, the optimizer configuration, the available devices and the options
+// of the function item.
+uint64 FunctionOptimizationKey(const FunctionDef& func,
+                               const FunctionLibraryDefinition& flib,
+                               const RewriterConfig& cfg,
+                               const Cluster* cluster, int producer,
+                               bool allow_non_differentiable_rewrites,
+                               bool is_tpu_graph, bool xla_auto_clustering_on) {
+  uint64 key = HashProto(func);
+  const FunctionLibraryDefinition reachable = flib.ReachableDefinitions(func);
+  std::vector<string> callees = reachable.ListFunctionNames();
+  std::sort(callees.begin(), callees.end());
+  for (const string& callee : callees) {
+    key = FingerprintCat64(key, HashProto(*reachable.Find(callee)));
+    key = FingerprintCat64(key, Fingerprint64(reachable.FindGradient(callee)));
+  }
+  key = FingerprintCat64(key, HashProto(cfg));
+  if (cluster != nullptr) {
+    std::vector<string> devices = cluster->GetDeviceNames();
+    std::sort(devices.begin(), devices.end());
+    for (const string& device : devices) {
+      key = FingerprintCat64(key, Fingerprint64(device));
+      key = FingerprintCat64(key, HashProto(cluster->GetDevices().at(device)));
+    }
+  }
+  key = FingerprintCat64(key, producer);
+  key = FingerprintCat64(key, (allow_non_differentiable_rewrites ? 1 : 0) |
+                                  (is_tpu_graph ? 2 : 0) |
+                                  (xla_auto_clustering_on ? 4 : 0));
+  return key;
+}
+
+// Returns the number of threads optimizing the function library, read from
+// TF_GRAPPLER_FUNCTION_OPTIMIZATION_THREADS. One optimizes functions
+// sequentially.
+int NumFunctionOptimizationThreads() {
+  static const int num_threads = [] {
+    constexpr int64_t kMaxDefaultThreads = 16;
+    int64_t num_threads;
+    TF_CHECK_OK(ReadInt64FromEnvVar(
+        "TF_GRAPPLER_FUNCTION_OPTIMIZATION_THREADS",
+        std::min<int64_t>(port::MaxParallelism(), kMaxDefaultThreads),
+        &num_threads));
+    return std::max<int64_t>(num_threads, 1);
+  }();
+  return num_threads;
+}
+
 uint64 DeadlineMicroSeconds(const RewriterConfig& cfg) {
   if (cfg.meta_optimizer_timeout_ms() <= 0) return 0;  // no deadline
   return Env::Default()->NowMicros() + cfg.meta_optimizer_timeout_ms() * 1000;
@@ -213,9 +353,11 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
                                /*lower_control_flow=*/LowerControlFlow()));
   MK_OPT("constfold", "constant_folding",
          new ConstantFolding(
-             cpu_device_,
+             RewriterConfig::ON, cpu_device_,
              cfg_.experimental_disable_compressed_tensor_optimization(),
-             !cfg_.experimental_disable_folding_quantization_emulation()));
+             !cfg_.experimental_disable_folding_quantization_emulation(),
+             cfg_.constant_folding_memmapped_package(),
+             cfg_.constant_folding_memmapped_package_max_bytes()));
   MK_OPT("shape", "shape_optimization", new ShapeOptimizer());
   MK_OPT("remap", "remapping",
          new Remapper(cfg_.remapping(), cfg_.cpu_layout_conversion(),
@@ -243,8 +385,13 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
          new CommonSubgraphElimination(cfg_.common_subgraph_elimination()));
   MK_OPT("arithmetic", "arithmetic_optimization",
          new ArithmeticOptimizer(cfg_.arithmetic_optimization()));
+  MK_OPT("embedding_lookup_merger", "embedding_lookup_merging",
+         new EmbeddingLookupMerger(cfg_.embedding_lookup_merging()));
   MK_OPT("autoparallel", "auto_parallel",
          new AutoParallel(cfg_.auto_parallel().num_replicas()));
+  MK_OPT("pipeline_parallel", "pipeline_parallel",
+         new PipelineParallel(cfg_.pipeline_parallel().num_stages(),
+                              cfg_.pipeline_parallel().num_micro_batches()));
   MK_OPT("loop", "loop_optimization",
          new LoopOptimizer(cfg_.loop_optimization(), cpu_device_));
   MK_OPT("dependency", "dependency_optimization",
@@ -355,7 +502,9 @@ Status MetaOptimizer::InitializeOptimizers(
       optimizers->push_back(std::make_unique<ConstantFolding>(
           cfg_.constant_folding(), cpu_device_,
           cfg_.experimental_disable_compressed_tensor_optimization(),
-          !cfg_.experimental_disable_folding_quantization_emulation()));
+          !cfg_.experimental_disable_folding_quantization_emulation(),
+          cfg_.constant_folding_memmapped_package(),
+          cfg_.constant_folding_memmapped_package_max_bytes()));
     }
   }
   if (BOTH_NOT_OFF(shape_optimization)) {
@@ -411,6 +560,12 @@ Status MetaOptimizer::InitializeOptimizers(
           cfg_.arithmetic_optimization()));
     }
   }
+  if ((USER_IS_ON(embedding_lookup_merging) ||
+       cfg_.embedding_lookup_merging() == RewriterConfig::AGGRESSIVE) &&
+      PLUGIN_NOT_OFF(embedding_lookup_merging)) {
+    optimizers->push_back(std::make_unique<EmbeddingLookupMerger>(
+        cfg_.embedding_lookup_merging()));
+  }
   if (BOTH_NOT_OFF(layout_optimizer)) {
     if (USER_IS_EXPERIMENTAL_MLIR(layout_optimizer) ||
         USER_IS_EXPERIMENTAL_BOTH(layout_optimizer)) {
@@ -465,17 +620,25 @@ Status MetaOptimizer::InitializeOptimizers(
     if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
       optimizers->push_back(
           // Use the default target node name prefix "gradients/"
-          std::make_unique<MemoryOptimizer>(cfg_.memory_optimization()));
+          std::make_unique<MemoryOptimizer>(
+              cfg_.memory_optimization(), "gradients/",
+              cfg_.memory_optimizer_budget_bytes()));
     } else {
       optimizers->push_back(std::make_unique<MemoryOptimizer>(
           cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
+          cfg_.memory_optimizer_target_node_name_scope(),
+          cfg_.memory_optimizer_budget_bytes()));
     }
   }
   if (cfg_.auto_parallel().enable() && PLUGIN_IS_ON(auto_parallel)) {
     optimizers->push_back(
         std::make_unique<AutoParallel>(cfg_.auto_parallel().num_replicas()));
   }
+  if (cfg_.pipeline_parallel().enable() && PLUGIN_IS_ON(pipeline_parallel)) {
+    optimizers->push_back(std::make_unique<PipelineParallel>(
+        cfg_.pipeline_parallel().num_stages(),
+        cfg_.pipeline_parallel().num_micro_batches()));
+  }
 
 #ifndef ENABLE_MKL
   if (BOTH_ARE_ON(scoped_allocator_optimization)) {
@@ -621,6 +784,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
     PRINT_CFG(function_optimization)
     PRINT_CFG(common_subgraph_elimination)
     PRINT_CFG(arithmetic_optimization)
+    PRINT_CFG(embedding_lookup_merging)
     PRINT_CFG(debug_stripper)
     PRINT_CFG(constant_folding)
     PRINT_CFG(shape_optimization)
@@ -657,6 +821,9 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
     user_cfg.toggle_config["auto_parallel"] = cfg_.auto_parallel().enable()
                                                   ? RewriterConfig::ON
                                                   : RewriterConfig::OFF;
+    user_cfg.toggle_config["pipeline_parallel"] =
+        cfg_.pipeline_parallel().enable() ? RewriterConfig::ON
+                                          : RewriterConfig::OFF;
   } else {
     for (const string& optimizer_name : cfg_.optimizers()) {
       if (optimizer_name == "pruning") user_cfg.disable_model_pruning = true;
@@ -669,6 +836,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
       PRINT_CFG("function", "function_optimization")
       PRINT_CFG("common_subgraph_elimination", "common_subgraph_elimination")
       PRINT_CFG("arithmetic", "arithmetic_optimization")
+      PRINT_CFG("embedding_lookup_merger", "embedding_lookup_merging")
       PRINT_CFG("debug_stripper", "debug_stripper")
       PRINT_CFG("constfold", "constant_folding")
       PRINT_CFG("shape", "shape_optimization")
@@ -684,6 +852,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
       PRINT_CFG("dependency", "dependency_optimization")
       PRINT_CFG("memory", "memory_optimization")
       PRINT_CFG("autoparallel", "auto_parallel")
+      PRINT_CFG("pipeline_parallel", "pipeline_parallel")
       PRINT_CFG("scoped_allocator", "scoped_allocator_optimization")
 #undef PRINT_CFG
     }
@@ -877,7 +1046,10 @@ Status MetaOptimizer::OptimizeGraph(
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -900,6 +1072,16 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
     TF_RETURN_IF_ERROR(InitializeOptimizersByName(device_types, &optimizers));
   }
   PrintUserAndPluginConfigs(device_types);
+  if (cfg_.optimization_tier() == RewriterConfig::O0) {
+    optimizers.clear();
+  } else if (cfg_.optimization_tier() == RewriterConfig::O1) {
+    optimizers.erase(
+        std::remove_if(optimizers.begin(), optimizers.end(),
+                       [](const std::unique_ptr<GraphOptimizer>& optimizer) {
+                         return IsExpensiveOptimizer(optimizer->name());
+                       }),
+        optimizers.end());
+  }
 
   return OptimizeGraph(std::move(optimizers), cluster, std::move(item),
                        optimized_graph);
@@ -922,18 +1104,56 @@ Status MetaOptimizer::RunOptimizer(
         GetFunctionDefLibraryStub(*optimized_graph_function_library);
   }
 
+  // A pass over its time budget is skipped, and otherwise stopped when it
+  // runs out of it.
+  const int64_t pass_budget_usec = cfg_.meta_optimizer_pass_budget_ms() * 1000;
+  uint64 deadline_usec = this->deadline_usec();
+  if (pass_budget_usec > 0) {
+    int64_t remaining_usec;
+    {
+      mutex_lock l(pass_time_mu_);
+      remaining_usec = pass_budget_usec - pass_time_usec_[optimizer->name()];
+    }
+    if (remaining_usec <= 0) {
+      if (!is_function_library_aware) {
+        optimized_graph->set_allocated_library(
+            optimized_graph_function_library.release());
+      }
+      optimization_result->results.push_back(
+          {optimizer->name(), "skipped, out of time budget.", OkStatus()});
+      return OkStatus();
+    }
+    const uint64 pass_deadline_usec =
+        Env::Default()->NowMicros() + remaining_usec;
+    if (deadline_usec == 0 || pass_deadline_usec < deadline_usec) {
+      deadline_usec = pass_deadline_usec;
+    }
+  }
+
   // This swaps the current optimized_graph into optimized item and
   // resets optimized_graph to an empty graph.
   optimized_item->graph = std::move(*optimized_graph);
   *optimized_graph = GraphDef();
-  optimizer->set_deadline_usec(this->deadline_usec());
+  optimizer->set_deadline_usec(deadline_usec);
   tensorflow::metrics::ScopedCounter<2> timings(
       tensorflow::metrics::GetGraphOptimizationCounter(),
       {kGrapplerCategory, optimizer->name()});
   Status status =
       optimizer->Optimize(cluster, *optimized_item, optimized_graph);
-  auto duration_ms = timings.DurationMicroSec().value() / 1000.0f;
+  const int64_t duration_usec = timings.DurationMicroSec().value();
+  auto duration_ms = duration_usec / 1000.0f;
   timings.ReportAndStop();
+  if (pass_budget_usec > 0) {
+    mutex_lock l(pass_time_mu_);
+    int64_t& pass_time_usec = pass_time_usec_[optimizer->name()];
+    pass_time_usec += duration_usec;
+    if (pass_time_usec >= pass_budget_usec &&
+        pass_time_usec - duration_usec < pass_budget_usec) {
+      LOG(WARNING) << optimizer->name() << " ran out of its time budget of "
+                   << cfg_.meta_optimizer_pass_budget_ms()
+                   << "ms and will be skipped.";
+    }
+  }
 
   string message;
   if (!status.ok()) {
@@ -1152,11 +1372,93 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   // True if this is a TPU graph using the old bridge.
   bool is_tpu_graph = IsLegacyTPUBridgeGraphDef(*optimized_graph);
 
+  // Optimized bodies are not reused when custom optimizers might not be
+  // deterministic.
+  FunctionOptimizationCache* function_cache =
+      FunctionOptimizationCache::Global();
+  const bool use_function_cache =
+      function_cache->enabled() && cfg_.custom_optimizers().empty();
+
+  // The state of one function body optimized in a pass over the library.
+  struct FunctionOptimization {
+    const FunctionDef* func;
+    bool allow_non_differentiable_rewrites;
+    uint64 cache_key = 0;
+    // Set if the body was found in the function cache.
+    bool cached = false;
+    FunctionOptimizationCache::Entry cached_entry;
+    // Otherwise, the function item and its optimized body graph.
+    GrapplerFunctionItem func_item;
+    GraphDef optimized_func_graph;
+    Status status;
+  };
+
+  // Optimizes the body of `f->func` against the current `flib`.
+  const auto optimize_function = [&](FunctionOptimization* f) -> Status {
+    // Make a GrapplerItem from a FunctionDef.
+    GrapplerFunctionItem& func_item = f->func_item;
+    TF_RETURN_IF_ERROR(
+        MakeGrapplerFunctionItem(*f->func, flib, producer, &func_item));
+
+    func_item.optimization_options().allow_non_differentiable_rewrites =
+        f->allow_non_differentiable_rewrites;
+
+    // Device set available to the function is defined only by the runtime,
+    // when we instantiate and execute the function. We can't use all devices
+    // available to the main graph, because after partitioning the function
+    // call node might execute on a remote worker.
+    if (!func_item.devices().empty()) {
+      return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    }
+
+    // We are not allowed to prune certain types of ops from the graph
+    // instantiated by the function definition, because we must guarantee
+    // function execution semantics wrt side effects (see
+    // function_optimizer.cc).
+    func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
+        false;
+
+    // Optimize function body graph.
+    f->optimized_func_graph.Clear();
+    if (is_tpu_graph) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only exception is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+          func_item.graph.release_library());
+      *func_item.graph.mutable_library() =
+          GetFunctionDefLibraryStub(*func_item_function_library);
+
+      return implementation_selector.Optimize(cluster, func_item,
+                                              &f->optimized_func_graph);
+    }
+    GrapplerFunctionItem func_item_copy = func_item;
+    return OptimizeGraph(cluster, std::move(func_item_copy),
+                         &f->optimized_func_graph);
+  };
+
+  // Function bodies of a pass are optimized in parallel against the library
+  // at the start of the pass, and merged back in library order.
+  const int num_threads = NumFunctionOptimizationThreads();
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
+    std::vector<std::unique_ptr<FunctionOptimization>> pass;
     int function_idx = 0;
     for (const FunctionDef& func : optimized_graph->library().function()) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
@@ -1189,75 +1491,102 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
+      auto f = std::make_unique<FunctionOptimization>();
+      f->func = &func;
+      // If we need to compute the gradient of optimized function at runtime,
+      // we can't perform non-differentiable rewrites.
+      f->allow_non_differentiable_rewrites =
           !differentiable_functions.contains(func_name);
 
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
+      // Reuse the body optimized by an earlier invocation, if nothing it
+      // depends on has changed.
+      if (use_function_cache) {
+        f->cache_key = FunctionOptimizationKey(
+            func, flib, cfg_, cluster, producer,
+            f->allow_non_differentiable_rewrites, is_tpu_graph,
+            xla_auto_clustering_on_);
+        f->cached = function_cache->Lookup(f->cache_key, &f->cached_entry);
+        metrics::RecordGrapplerFunctionCacheLookup(f->cached);
       }
+      pass.push_back(std::move(f));
+    }
 
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (is_tpu_graph) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+    std::vector<FunctionOptimization*> to_optimize;
+    for (const auto& f : pass) {
+      if (!f->cached) to_optimize.push_back(f.get());
+    }
+    if (num_threads > 1 && to_optimize.size() > 1) {
+      thread::ThreadPool pool(
+          Env::Default(), "grappler_function_optimization",
+          std::min<int>(num_threads, to_optimize.size()));
+      BlockingCounter counter(to_optimize.size());
+      for (FunctionOptimization* f : to_optimize) {
+        pool.Schedule([&, f]() {
+          f->status = optimize_function(f);
+          counter.DecrementCount();
+        });
+      }
+      counter.Wait();
+    } else {
+      for (FunctionOptimization* f : to_optimize) {
+        f->status = optimize_function(f);
+        if (!f->status.ok()) break;
+      }
+    }
+
+    // Functions added to the library by this pass.
+    absl::flat_hash_set<string> new_func_names;
+    for (const auto& f : pass) {
+      const string& func_name = f->func->signature().name();
+      if (f->cached) {
+        VLOG(3) << "Reuse optimized function: function=" << func_name;
+        for (const FunctionDef& func_def : f->cached_entry.new_funcs) {
+          if (flib.Find(func_def.signature().name()) == nullptr) {
+            TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+            new_func_names.insert(func_def.signature().name());
+          }
+        }
+        TF_RETURN_IF_ERROR(
+            flib.ReplaceFunction(func_name, f->cached_entry.optimized_func));
+        continue;
+      }
+      TF_RETURN_IF_ERROR(f->status);
+
+      // A function specialized by an earlier function of the pass, but
+      // differently, might be called by this optimized body: optimize it
+      // again against the merged library, as a sequential pass would have.
+      for (const FunctionDef& func_def :
+           f->optimized_func_graph.library().function()) {
+        const string& name = func_def.signature().name();
+        if (new_func_names.contains(name) &&
+            !FunctionDefsEqual(*flib.Find(name), func_def)) {
+          VLOG(3) << "Optimize function again: function=" << func_name;
+          TF_RETURN_IF_ERROR(optimize_function(f.get()));
+          break;
+        }
       }
 
       // Function body optimization might have created new specialized
       // functions for each instantiation context. Add them to the library.
+      std::vector<FunctionDef> new_funcs;
       for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
+           f->optimized_func_graph.library().function()) {
         if (flib.Find(func_def.signature().name()) == nullptr) {
           TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+          new_func_names.insert(func_def.signature().name());
+          if (use_function_cache) new_funcs.push_back(func_def);
         }
       }
 
       // Convert optimized graph back to FunctionDef.
       FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
+      f->func_item.SwapFunctionBody(std::move(f->optimized_func_graph));
+      TF_RETURN_IF_ERROR(MakeFunctionDef(f->func_item, flib, &optimized_func));
+
+      if (use_function_cache) {
+        function_cache->Insert(f->cache_key,
+                               {optimized_func, std::move(new_funcs)});
+      }
 
       // Replace optimized function with a new FunctionDef.
       TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
@@ -1325,7 +1654,8 @@ void MetaOptimizer::PrintResult() { VLOG(1) << GetResultString(); }
 
 bool MetaOptimizerEnabled(const ConfigProto& cfg) {
   const auto& rewrite_cfg = cfg.graph_options().rewrite_options();
-  if (rewrite_cfg.disable_meta_optimizer()) {
+  if (rewrite_cfg.disable_meta_optimizer() ||
+      rewrite_cfg.optimization_tier() == RewriterConfig::O0) {
     return false;
   }
   return !rewrite_cfg.disable_model_pruning() ||
@@ -1339,6 +1669,7 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
          rewrite_cfg.loop_optimization() != RewriterConfig::OFF ||
          rewrite_cfg.dependency_optimization() != RewriterConfig::OFF ||
          rewrite_cfg.auto_parallel().enable() ||
+         rewrite_cfg.pipeline_parallel().enable() ||
          rewrite_cfg.memory_optimization() != RewriterConfig::NO_MEM_OPT ||
          rewrite_cfg.debug_stripper() == RewriterConfig::ON ||
 #ifndef ENABLE_MKL
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -420,6 +421,140 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibrary) {
   test::ExpectTensorEqual<int>(tensors_expected[1], tensors[1]);
 }
 
+TEST_F(MetaOptimizerTest, ReuseOptimizedFunctionBodies) {
+  using test::function::NDef;
+  monitoring::testing::CellReader<int64_t> cache_lookups(
+      "/tensorflow/core/grappler/function_cache_lookups");
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+  rewriter_config.set_function_optimization(RewriterConfig::ON);
+  rewriter_config.add_optimizers("function");
+  rewriter_config.set_min_graph_nodes(-1);
+
+  //   CachedMul(x, y) = x * y
+  //  *CachedSquare(x) = CachedMul(x, x)
+  //
+  //  * - marked as noinline
+  FunctionDef mul_func = FunctionDefHelper::Create(
+      "CachedMul", {"x:T", "y:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"mul"}, "Mul", {"x", "y"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "mul:z:0"}});
+  FunctionDef square_func = FunctionDefHelper::Create(
+      "CachedSquare", {"x:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"my_mul"}, "CachedMul", {"x", "x"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "my_mul:z:0"}});
+  (*square_func.mutable_attr())["_noinline"].set_b(true);
+
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(
+      {NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("square", "CachedSquare", {"a"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("out", "Identity", {"square:0"}, {{"T", DT_FLOAT}}, kDevice)},
+      /*funcs=*/
+      {mul_func, square_func});
+
+  // The first invocation optimizes the specialized function body.
+  GraphDef output;
+  MetaOptimizer optimizer(nullptr, config_proto);
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(cache_lookups.Delta("hit"), 0);
+  EXPECT_GT(cache_lookups.Delta("miss"), 0);
+
+  // The second invocation reuses it.
+  GraphDef cached_output;
+  MetaOptimizer cached_optimizer(nullptr, config_proto);
+  TF_EXPECT_OK(cached_optimizer.Optimize(nullptr, item, &cached_output));
+  EXPECT_GT(cache_lookups.Delta("hit"), 0);
+  EXPECT_EQ(cache_lookups.Delta("miss"), 0);
+
+  FunctionLibraryDefinition flib(OpRegistry::Global(), output.library());
+  FunctionLibraryDefinition cached_flib(OpRegistry::Global(),
+                                        cached_output.library());
+  EXPECT_EQ(flib.num_functions(), cached_flib.num_functions());
+  for (const string& name : flib.ListFunctionNames()) {
+    const FunctionDef* cached_func = cached_flib.Find(name);
+    ASSERT_NE(cached_func, nullptr) << name;
+    EXPECT_TRUE(FunctionDefsEqual(*flib.Find(name), *cached_func)) << name;
+  }
+}
+
+TEST_F(MetaOptimizerTest, OptimizeManyFunctions) {
+  using test::function::NDef;
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+  rewriter_config.set_function_optimization(RewriterConfig::ON);
+  rewriter_config.add_optimizers("function");
+  rewriter_config.set_min_graph_nodes(-1);
+
+  // Define function library, where the bodies of all the MyPower_i functions
+  // are optimized in the same pass:
+  //
+  //  *MyPow(x, y)    = x ^ y
+  //  *MyPower_i(x)   = MyPow(x, x)
+  //
+  //  * - marked as noinline
+  constexpr int kNumFunctions = 16;
+  FunctionDef pow_func = FunctionDefHelper::Create(
+      "MyPow", {"x:T", "y:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"pow"}, "Pow", {"x", "y"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "pow:z:0"}});
+  (*pow_func.mutable_attr())["_noinline"].set_b(true);
+  std::vector<FunctionDef> funcs = {pow_func};
+  std::vector<NodeDef> nodes = {
+      NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice)};
+  for (int i = 0; i < kNumFunctions; ++i) {
+    const string name = absl::StrCat("MyPower_", i);
+    FunctionDef power_func = FunctionDefHelper::Create(
+        name, {"x:T"}, {"z:T"}, {"T: {float, double}"},
+        {{{"my_pow"}, "MyPow", {"x", "x"}, {{"T", "$T"}}}},
+        /*ret_def=*/
+        {{"z", "my_pow:z:0"}});
+    (*power_func.mutable_attr())["_noinline"].set_b(true);
+    funcs.push_back(power_func);
+    nodes.push_back(NDef(absl::StrCat("power_", i), name, {"a"},
+                         {{"T", DT_FLOAT}}, kDevice));
+  }
+
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(nodes, funcs);
+
+  GraphDef output;
+  MetaOptimizer optimizer(nullptr, config_proto);
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // Every specialized MyPower_i calls its own specialization of MyPow.
+  FunctionLibraryDefinition optimized_flib(OpRegistry::Global(),
+                                           output.library());
+  for (int i = 0; i < kNumFunctions; ++i) {
+    const string power =
+        absl::Substitute("MyPower_$0_specialized_for_power_$0_at_tf_graph", i);
+    const FunctionDef* power_func = optimized_flib.Find(power);
+    ASSERT_NE(power_func, nullptr) << power;
+    const string pow =
+        absl::Substitute("MyPow_specialized_for_my_pow_at_$0", power);
+    ASSERT_NE(optimized_flib.Find(pow), nullptr) << pow;
+    int count = 0;
+    for (const NodeDef& node : power_func->node_def()) {
+      if (node.name() == "my_pow") {
+        count++;
+        EXPECT_EQ(pow, node.op());
+      }
+    }
+    EXPECT_EQ(1, count);
+  }
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryPruneUnusedOutputs) {
   using test::function::NDef;
 
@@ -792,6 +927,55 @@ TEST_F(MetaOptimizerTest, OptimizerDoesNotTimeOut) {
   EXPECT_EQ(original_node_size + 2, output.node_size());
 }
 
+TEST_F(MetaOptimizerTest, OptimizerRunsOutOfPassBudget) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  ConfigProto config;
+  RewriterConfig& rewriter_config =
+      *config.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("SleepingOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_meta_optimizer_pass_budget_ms(500);
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+
+  MetaOptimizer optimizer(nullptr, config);
+  GraphDef output;
+  GraphDef original = item.graph;
+  // Unlike a meta optimizer timeout, running out of the pass budget only stops
+  // the pass, which is then skipped on the second iteration.
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  CompareGraphs(original, output);
+  EXPECT_TRUE(absl::StrContains(optimizer.GetResultString(),
+                                "skipped, out of time budget."));
+}
+
+TEST_F(MetaOptimizerTest, OptimizationTierO1SkipsExpensivePasses) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  ConfigProto config;
+  RewriterConfig& rewriter_config =
+      *config.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("constfold");
+  rewriter_config.add_optimizers("arithmetic");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::ONE);
+  rewriter_config.set_optimization_tier(RewriterConfig::O1);
+
+  MetaOptimizer optimizer(nullptr, config);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  const string results = optimizer.GetResultString();
+  EXPECT_TRUE(absl::StrContains(results, "constant_folding")) << results;
+  EXPECT_FALSE(absl::StrContains(results, "arithmetic_optimizer")) << results;
+
+  rewriter_config.set_optimization_tier(RewriterConfig::O0);
+  EXPECT_FALSE(MetaOptimizerEnabled(config));
+}
+
 TEST_F(MetaOptimizerTest, RunPostOptimizationVerifiersOnValidGraph) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
   GrapplerItem item;
@@ -0,0 +1,337 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/pipeline_parallel.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/virtual_placer.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+const char kPipelineParallelPrefix[] = "PipelineParallel";
+
+string MicroBatchPrefix(int micro_batch) {
+  return strings::StrCat(kPipelineParallelPrefix, "-MicroBatch-", micro_batch);
+}
+
+// Name of the NoOp that completes once `stage` is done with `micro_batch`.
+string StageDoneName(int stage, int micro_batch) {
+  return strings::StrCat(kPipelineParallelPrefix, "-Stage-", stage,
+                         "/MicroBatch-", micro_batch, "-Done");
+}
+
+Costs::NanoSeconds PredictExecutionTime(const GraphProperties& properties,
+                                        const OpLevelCostEstimator& estimator,
+                                        const VirtualPlacer& placer,
+                                        const NodeDef& node) {
+  OpContext op_context;
+  op_context.op_info.set_op(node.op());
+  *op_context.op_info.mutable_attr() = node.attr();
+  for (auto& input : properties.GetInputProperties(node.name())) {
+    *op_context.op_info.add_inputs() = input;
+  }
+  for (auto& output : properties.GetOutputProperties(node.name())) {
+    *op_context.op_info.add_outputs() = output;
+  }
+  *op_context.op_info.mutable_device() = placer.get_device(node);
+  // Count every node, so that graphs of ops unknown to the cost model are
+  // still split by node count.
+  return std::max(estimator.PredictCosts(op_context).execution_time,
+                  Costs::NanoSeconds(1));
+}
+
+NodeDef* AddAxisConst(const string& name, const string& device,
+                      GraphDef* graph) {
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op("Const");
+  node->set_device(device);
+  (*node->mutable_attr())["dtype"].set_type(DT_INT32);
+  TensorProto* value = (*node->mutable_attr())["value"].mutable_tensor();
+  value->set_dtype(DT_INT32);
+  value->mutable_tensor_shape();
+  value->add_int_val(0);
+  return node;
+}
+
+}  // namespace
+
+Status PipelineParallel::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                  GraphDef* output) {
+  if (num_stages_ < 2 || num_micro_batches_ < 2 || cluster == nullptr) {
+    return errors::Aborted("Nothing to do.");
+  }
+
+  std::vector<string> devices;
+  for (const auto& device : cluster->GetDevices()) {
+    if (device.second.type() == "GPU") devices.push_back(device.first);
+  }
+  std::sort(devices.begin(), devices.end());
+  const int num_stages = std::min<int>(num_stages_, devices.size());
+  if (num_stages < 2) {
+    return errors::Aborted("Not enough GPUs to pipeline across.");
+  }
+
+  // The fed tensors whose statically known batch dimension splits evenly are
+  // the ones that get micro-batched.
+  absl::flat_hash_map<string, DataType> batch_inputs;
+  for (const auto& feed : item.feed) {
+    int position;
+    const string node_name = ParseNodeName(feed.first, &position);
+    const Tensor& tensor = feed.second;
+    if (position != 0 || tensor.dtype() == DT_INVALID || tensor.dims() < 1 ||
+        tensor.dim_size(0) < num_micro_batches_ ||
+        tensor.dim_size(0) % num_micro_batches_ != 0) {
+      continue;
+    }
+    batch_inputs[node_name] = tensor.dtype();
+  }
+  if (batch_inputs.empty()) {
+    return errors::Aborted("No fed batch to split into micro-batches.");
+  }
+
+  std::vector<const NodeDef*> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(item.graph, &topo_order));
+
+  // Everything computed from a batch input is pipelined.
+  absl::flat_hash_map<string, const NodeDef*> pipelined;
+  std::vector<const NodeDef*> pipelined_nodes;
+  for (const NodeDef* node : topo_order) {
+    bool from_batch = false;
+    for (const string& input : node->input()) {
+      if (IsControlInput(input)) continue;
+      const string input_name = NodeName(input);
+      if (batch_inputs.contains(input_name) || pipelined.contains(input_name)) {
+        from_batch = true;
+        break;
+      }
+    }
+    if (!from_batch) continue;
+    if (IsControlFlow(*node) || !IsFreeOfSideEffect(*node)) {
+      return errors::Aborted("Can't pipeline ", node->op(), " node ",
+                             node->name());
+    }
+    pipelined[node->name()] = node;
+    pipelined_nodes.push_back(node);
+  }
+
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(
+      properties.InferStatically(/*assume_valid_feeds=*/true,
+                                 /*aggressive_shape_inference=*/false,
+                                 /*include_tensor_values=*/false));
+
+  // The fetched pipelined tensors are concatenated back into a full batch
+  // under their original name, so they have to be the first output of a node
+  // of known type and rank.
+  absl::flat_hash_map<string, DataType> fetch_types;
+  const std::unordered_set<string> nodes_to_preserve =
+      item.NodesToPreserve();
+  for (const string& fetch : item.fetch) {
+    int position;
+    const string node_name = ParseNodeName(fetch, &position);
+    if (!pipelined.contains(node_name)) continue;
+    const auto& outputs = properties.GetOutputProperties(node_name);
+    if (position != 0 || outputs.empty() ||
+        outputs[0].shape().unknown_rank() ||
+        outputs[0].shape().dim_size() < 1) {
+      return errors::Aborted("Can't reassemble the batch of fetch ", fetch);
+    }
+    fetch_types[node_name] = outputs[0].dtype();
+  }
+  if (fetch_types.empty()) {
+    return errors::Aborted("No fetch depends on the fed batch.");
+  }
+  for (const NodeDef* node : pipelined_nodes) {
+    if (nodes_to_preserve.count(node->name()) > 0 &&
+        !fetch_types.contains(node->name())) {
+      return errors::Aborted("Can't pipeline preserved node ", node->name());
+    }
+  }
+
+  // Cut the pipelined nodes into stages of roughly equal cost. Stages follow
+  // the topological order, so data only ever flows to the same or a later
+  // stage.
+  OpLevelCostEstimator estimator;
+  VirtualPlacer placer(cluster->GetDevices());
+  std::vector<Costs::NanoSeconds> costs;
+  costs.reserve(pipelined_nodes.size());
+  Costs::NanoSeconds total_cost(0);
+  for (const NodeDef* node : pipelined_nodes) {
+    costs.push_back(PredictExecutionTime(properties, estimator, placer, *node));
+    total_cost += costs.back();
+  }
+  absl::flat_hash_map<string, int> stages;
+  Costs::NanoSeconds cost_so_far(0);
+  for (int i = 0; i < pipelined_nodes.size(); ++i) {
+    const int stage = std::min<int>(
+        num_stages - 1, cost_so_far.count() * num_stages / total_cost.count());
+    stages[pipelined_nodes[i]->name()] = stage;
+    cost_so_far += costs[i];
+  }
+
+  // A node is an entry of its stage if none of its inputs come from the same
+  // stage, and an exit if none of its outputs stay in it.
+  absl::flat_hash_set<string> has_fanin_in_stage;
+  absl::flat_hash_set<string> has_fanout_in_stage;
+  for (const NodeDef* node : pipelined_nodes) {
+    for (const string& input : node->input()) {
+      const string input_name = NodeName(input);
+      auto it = stages.find(input_name);
+      if (it != stages.end() && it->second == stages[node->name()]) {
+        has_fanin_in_stage.insert(node->name());
+        has_fanout_in_stage.insert(input_name);
+      }
+    }
+  }
+
+  // Keep ops pinned to a non-GPU device, e.g. because they lack a GPU kernel,
+  // where they are.
+  auto stage_device = [&](const NodeDef& node) -> string {
+    DeviceNameUtils::ParsedName parsed;
+    if (!node.device().empty() &&
+        DeviceNameUtils::ParseFullName(node.device(), &parsed) &&
+        parsed.has_type && parsed.type != DEVICE_GPU) {
+      return node.device();
+    }
+    return devices[stages[node.name()]];
+  };
+
+  // A control dependency on a pipelined node now waits for all of its
+  // micro-batches; fetched nodes keep their name and need no rewriting.
+  for (const NodeDef& node : item.graph.node()) {
+    if (pipelined.contains(node.name())) continue;
+    NodeDef* new_node = output->add_node();
+    *new_node = node;
+    new_node->clear_input();
+    for (const string& input : node.input()) {
+      const string input_name = NodeName(input);
+      if (!IsControlInput(input) || !pipelined.contains(input_name) ||
+          fetch_types.contains(input_name)) {
+        new_node->add_input(input);
+        continue;
+      }
+      for (int m = 0; m < num_micro_batches_; ++m) {
+        new_node->add_input(AsControlDependency(
+            AddPrefixToNodeName(input_name, MicroBatchPrefix(m))));
+      }
+    }
+  }
+
+  for (const auto& batch_input : batch_inputs) {
+    const string split_name = strings::StrCat(kPipelineParallelPrefix,
+                                              "-Split/", batch_input.first);
+    NodeDef* axis =
+        AddAxisConst(strings::StrCat(split_name, "/axis"), devices[0], output);
+    NodeDef* split = output->add_node();
+    split->set_name(split_name);
+    split->set_op("Split");
+    split->set_device(devices[0]);
+    split->add_input(axis->name());
+    split->add_input(batch_input.first);
+    (*split->mutable_attr())["T"].set_type(batch_input.second);
+    (*split->mutable_attr())["num_split"].set_i(num_micro_batches_);
+  }
+
+  for (int m = 0; m < num_micro_batches_; ++m) {
+    const string prefix = MicroBatchPrefix(m);
+    for (const NodeDef* node : pipelined_nodes) {
+      const int stage = stages[node->name()];
+      NodeDef* new_node = output->add_node();
+      *new_node = *node;
+      new_node->set_name(AddPrefixToNodeName(node->name(), prefix));
+      new_node->set_device(stage_device(*node));
+      for (int i = 0; i < new_node->input_size(); ++i) {
+        const string& input = new_node->input(i);
+        const string input_name = NodeName(input);
+        if (pipelined.contains(input_name)) {
+          *new_node->mutable_input(i) = AddPrefixToNodeName(input, prefix);
+        } else if (!IsControlInput(input) &&
+                   batch_inputs.contains(input_name)) {
+          *new_node->mutable_input(i) = strings::StrCat(
+              kPipelineParallelPrefix, "-Split/", input_name, ":", m);
+        }
+      }
+      // A stage starts on the next micro-batch once it is done with the
+      // previous one.
+      if (m > 0 && !has_fanin_in_stage.contains(node->name())) {
+        new_node->add_input(AsControlDependency(StageDoneName(stage, m - 1)));
+      }
+    }
+    if (m == num_micro_batches_ - 1) break;
+    std::vector<NodeDef*> done_nodes(num_stages, nullptr);
+    for (const NodeDef* node : pipelined_nodes) {
+      if (has_fanout_in_stage.contains(node->name())) continue;
+      const int stage = stages[node->name()];
+      if (done_nodes[stage] == nullptr) {
+        done_nodes[stage] = output->add_node();
+        done_nodes[stage]->set_name(StageDoneName(stage, m));
+        done_nodes[stage]->set_op("NoOp");
+        done_nodes[stage]->set_device(devices[stage]);
+      }
+      done_nodes[stage]->add_input(
+          AsControlDependency(AddPrefixToNodeName(node->name(), prefix)));
+    }
+  }
+
+  for (const auto& fetch : fetch_types) {
+    const string device = stage_device(*pipelined[fetch.first]);
+    NodeDef* axis = AddAxisConst(
+        strings::StrCat(kPipelineParallelPrefix, "-Concat/", fetch.first,
+                        "/axis"),
+        device, output);
+    NodeDef* concat = output->add_node();
+    concat->set_name(fetch.first);
+    concat->set_op("ConcatV2");
+    concat->set_device(device);
+    for (int m = 0; m < num_micro_batches_; ++m) {
+      concat->add_input(AddPrefixToNodeName(fetch.first, MicroBatchPrefix(m)));
+    }
+    concat->add_input(axis->name());
+    (*concat->mutable_attr())["T"].set_type(fetch.second);
+    (*concat->mutable_attr())["N"].set_i(num_micro_batches_);
+    (*concat->mutable_attr())["Tidx"].set_type(DT_INT32);
+  }
+
+  *output->mutable_library() = item.graph.library();
+  *output->mutable_versions() = item.graph.versions();
+  VLOG(1) << "Pipelined " << pipelined_nodes.size() << " nodes into "
+          << num_stages << " stages of " << num_micro_batches_
+          << " micro-batches";
+  return OkStatus();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
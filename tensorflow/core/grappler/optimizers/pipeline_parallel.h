@@ -0,0 +1,60 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_PIPELINE_PARALLEL_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_PIPELINE_PARALLEL_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Pipelines a model that is too big for a single device across the GPUs of the
+// cluster, GPipe style. The part of the graph computed from the fed batch is
+// cut, in topological order, into stages of roughly equal estimated cost, and
+// each stage is placed on its own GPU. The fed batch is split into
+// micro-batches along dimension 0, every stage is replicated once per
+// micro-batch, and the fetched tensors are concatenated back together.
+//
+// Stage boundaries are plain cross-device edges, which graph partitioning turns
+// into rendezvous Send/Recv pairs, so the pipeline runs on the normal executor:
+// while stage s works on micro-batch m, stage s - 1 already works on
+// micro-batch m + 1. Each stage processes its micro-batches in order.
+//
+// Like AutoParallel, this assumes that the pipelined ops treat dimension 0 as
+// an independent batch dimension.
+class PipelineParallel : public GraphOptimizer {
+ public:
+  PipelineParallel(int num_stages, int num_micro_batches)
+      : num_stages_(num_stages), num_micro_batches_(num_micro_batches) {}
+  ~PipelineParallel() override {}
+
+  string name() const override { return "pipeline_parallel"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+
+ private:
+  int num_stages_;
+  int num_micro_batches_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_PIPELINE_PARALLEL_H_
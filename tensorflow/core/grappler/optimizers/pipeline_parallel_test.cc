@@ -0,0 +1,128 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/pipeline_parallel.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class PipelineParallelTest : public ::testing::Test {
+ public:
+  std::unique_ptr<VirtualCluster> CreateVirtualCluster() const {
+    DeviceProperties gpu_device;
+    gpu_device.set_type("GPU");
+    gpu_device.set_frequency(1000);
+    gpu_device.set_num_cores(60);
+    gpu_device.set_bandwidth(32);
+    std::unordered_map<string, DeviceProperties> devices;
+    devices["/job:localhost/replica:0/task:0/device:GPU:0"] = gpu_device;
+    devices["/job:localhost/replica:0/task:0/device:GPU:1"] = gpu_device;
+    return std::unique_ptr<VirtualCluster>(new VirtualCluster(devices));
+  }
+
+  // Two identical layers, each a MatMul followed by a Relu.
+  GrapplerItem CreateItem() const {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                                ops::Placeholder::Shape({8, 16}));
+    Output w = ops::Const(s.WithOpName("w"), 1.0f, {16, 16});
+    Output a = ops::MatMul(s.WithOpName("a"), x, w);
+    Output b = ops::Relu(s.WithOpName("b"), a);
+    Output c = ops::MatMul(s.WithOpName("c"), b, w);
+    Output d = ops::Relu(s.WithOpName("d"), c);
+
+    GrapplerItem item;
+    item.fetch.push_back("d");
+    item.feed.emplace_back("x", Tensor(DT_FLOAT, {8, 16}));
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    return item;
+  }
+};
+
+TEST_F(PipelineParallelTest, SplitsIntoStagesAndMicroBatches) {
+  std::unique_ptr<VirtualCluster> cluster = CreateVirtualCluster();
+  GrapplerItem item = CreateItem();
+
+  PipelineParallel pipeline(/*num_stages=*/2, /*num_micro_batches=*/4);
+  GraphDef output;
+  TF_EXPECT_OK(pipeline.Optimize(cluster.get(), item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* split = node_map.GetNode("PipelineParallel-Split/x");
+  ASSERT_NE(split, nullptr);
+  EXPECT_EQ("Split", split->op());
+  EXPECT_EQ(4, split->attr().at("num_split").i());
+  EXPECT_EQ("x", split->input(1));
+
+  const string gpu0 = "/job:localhost/replica:0/task:0/device:GPU:0";
+  const string gpu1 = "/job:localhost/replica:0/task:0/device:GPU:1";
+  for (int m = 0; m < 4; ++m) {
+    const string prefix = strings::StrCat("PipelineParallel-MicroBatch-", m);
+    const NodeDef* a = node_map.GetNode(strings::StrCat(prefix, "/a"));
+    const NodeDef* c = node_map.GetNode(strings::StrCat(prefix, "/c"));
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(c, nullptr);
+    EXPECT_EQ(strings::StrCat("PipelineParallel-Split/x:", m), a->input(0));
+    EXPECT_EQ(strings::StrCat(prefix, "/b"), c->input(0));
+    EXPECT_EQ(gpu0, a->device());
+    EXPECT_EQ(gpu1, c->device());
+    if (m > 0) {
+      // Each stage takes on the next micro-batch once done with the last one.
+      EXPECT_EQ(strings::StrCat("^PipelineParallel-Stage-0/MicroBatch-",
+                                m - 1, "-Done"),
+                a->input(2));
+      EXPECT_EQ(strings::StrCat("^PipelineParallel-Stage-1/MicroBatch-",
+                                m - 1, "-Done"),
+                c->input(2));
+    }
+  }
+
+  // The fetch keeps its name and reassembles the full batch.
+  const NodeDef* d = node_map.GetNode("d");
+  ASSERT_NE(d, nullptr);
+  EXPECT_EQ("ConcatV2", d->op());
+  ASSERT_EQ(5, d->input_size());
+  EXPECT_EQ("PipelineParallel-MicroBatch-0/d", d->input(0));
+  EXPECT_EQ("PipelineParallel-MicroBatch-3/d", d->input(3));
+  EXPECT_EQ(nullptr, node_map.GetNode("a"));
+}
+
+TEST_F(PipelineParallelTest, NothingToDoWithoutFedBatch) {
+  std::unique_ptr<VirtualCluster> cluster = CreateVirtualCluster();
+  GrapplerItem item = CreateItem();
+  // A batch of 6 can't be split into 4 micro-batches.
+  item.feed[0].second = Tensor(DT_FLOAT, {6, 16});
+
+  PipelineParallel pipeline(/*num_stages=*/2, /*num_micro_batches=*/4);
+  GraphDef output;
+  EXPECT_TRUE(
+      errors::IsAborted(pipeline.Optimize(cluster.get(), item, &output)));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <map>
 #include <set>
 #include <unordered_set>
@@ -23,6 +25,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/graph_view.h"
@@ -67,6 +70,19 @@ namespace grappler {
 //
 // Sigmoid + Mul -> _MklSwish  // This fusion only works on Intel CPU.
 //
+// StringSplitV2 + StringToHashBucketFast -> _StringSplitToHashBucketFast
+//
+// MatMul with constant block-sparse weights -> _BlockSparseMatMul
+//
+// MatMul with constant weights -> _DynamicQuantizedMatMul  // This rewrite
+//   only works on CPU, and only if TF_ENABLE_DYNAMIC_QUANTIZED_MATMUL is set.
+//
+// ResourceGather + SparseSegment{Sum,Mean,SqrtN}
+//   -> _FusedResourceSparseSegmentReduction  // This fusion only works on CPU.
+//
+// BatchMatMul + Mul (optional) + Softmax + BatchMatMul
+//   -> _FusedScaledDotProductAttention  // This fusion only works on CPU.
+//
 //
 // In all cases, the supported activation functions are Relu, Relu6, and Elu.
 //
@@ -81,6 +97,14 @@ constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kFusedBatchNormGradEx[] = "_FusedBatchNormGradEx";
 constexpr char kTensorToHashBucket[] = "_TensorToHashBucketFast";
+constexpr char kStringSplitToHashBucket[] = "_StringSplitToHashBucketFast";
+constexpr char kBlockSparseMatMul[] = "_BlockSparseMatMul";
+constexpr char kDynamicQuantizedMatMul[] = "_DynamicQuantizedMatMul";
+constexpr char kFusedResourceSparseSegmentReduction[] =
+    "_FusedResourceSparseSegmentReduction";
+constexpr char kFusedScaledDotProductAttention[] =
+    "_FusedScaledDotProductAttention";
+constexpr char kFusedElementwise[] = "_FusedElementwise";
 
 constexpr char kDataFormat[] = "data_format";
 constexpr char kIsTraining[] = "is_training";
@@ -151,6 +175,76 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// StringSplitV2 whose tokens only feed a StringToHashBucketFast, that can be
+// replaced with a split that hashes the tokens instead of copying them.
+struct StringSplitToHashBucket {
+  StringSplitToHashBucket() = default;
+  StringSplitToHashBucket(int string_split, int string_to_hash_bucket)
+      : string_split(string_split),
+        string_to_hash_bucket(string_to_hash_bucket) {}
+
+  int string_split = kMissingIndex;
+  int string_to_hash_bucket = kMissingIndex;
+};
+
+// MatMul whose constant weights are mostly zero blocks, that can be replaced
+// with a matmul visiting only the nonzero blocks. The weights are converted
+// to the block-sparse format while matching.
+struct BlockSparseMatMul {
+  int matmul = kMissingIndex;
+  // The dense weights, if nothing else reads them.
+  int weights = kMissingIndex;
+  Tensor block_values;
+  Tensor block_col_ptr;
+  Tensor block_row_indices;
+};
+
+// MatMul with constant weights, that can be replaced with a matmul of int8
+// weights quantized per output channel. The weights are quantized while
+// matching.
+struct DynamicQuantizedMatMul {
+  int matmul = kMissingIndex;
+  // The float weights, if nothing else reads them.
+  int weights = kMissingIndex;
+  // The transposed int8 weights, and the scale of every output channel.
+  Tensor b;
+  Tensor b_scales;
+};
+
+// Attention of queries against keys and values, computed as
+// Softmax(scale * query * transpose(key)) * value. The optional Mul applies a
+// constant scale to the scores.
+struct ScaledDotProductAttention {
+  int scores = kMissingIndex;
+  int scale = kMissingIndex;
+  int softmax = kMissingIndex;
+  int output = kMissingIndex;
+  float scale_value = 1.0f;
+};
+
+// Chain of elementwise ops, where every op but the last feeds only the next
+// one, that can be replaced with a single pass over memory.
+struct FusedElementwise {
+  // The ops of the chain, from the first to the last.
+  std::vector<int> ops;
+  // For every op, the input port that reads the preceding op (or the input of
+  // the chain for the first op).
+  std::vector<int> chain_ports;
+};
+
+// ResourceGather feeding only a SparseSegment{Sum,Mean,SqrtN}, that can be
+// replaced with a reduction reading the variable rows directly.
+struct ResourceGatherWithSparseSegmentReduction {
+  ResourceGatherWithSparseSegmentReduction() = default;
+  ResourceGatherWithSparseSegmentReduction(int resource_gather,
+                                           int sparse_segment_reduction)
+      : resource_gather(resource_gather),
+        sparse_segment_reduction(sparse_segment_reduction) {}
+
+  int resource_gather = kMissingIndex;
+  int sparse_segment_reduction = kMissingIndex;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -359,6 +453,19 @@ bool BlasLtMatmulEnabled() {
   return is_enabled;
 }
 
+// Dynamic quantization changes the numerics of the model, so it is only enabled
+// on request.
+bool DynamicQuantizedMatMulEnabled() {
+  static bool is_enabled = [] {
+    bool is_enabled = false;
+    TF_CHECK_OK(tensorflow::ReadBoolFromEnvVar(
+        "TF_ENABLE_DYNAMIC_QUANTIZED_MATMUL", /*default_val=*/false,
+        &is_enabled));
+    return is_enabled;
+  }();
+  return is_enabled;
+}
+
 bool IsGpuCompatibleDataFormat(const RemapperContext& ctx,
                                const NodeDef* conv2d) {
   DCHECK(IsConv2D(*conv2d)) << "Expected Conv2D op";
@@ -2319,6 +2426,544 @@ bool FindTensorToHashBucket(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+bool FindStringSplitToHashBucket(const RemapperContext& ctx, int node_index,
+                                 StringSplitToHashBucket* matched) {
+  // Root of the pattern must be a StringToHashBucketFast on CPU.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+
+  if (!IsStringToHashBucketFast(*node_def) ||
+      HasControlFaninOrFanout(*node_view) || !NodeIsOnCpu(node_def)) {
+    return false;
+  }
+
+  // Input to the StringToHashBucketFast must be the tokens of a StringSplitV2,
+  // and nothing else may read the tokens.
+  if (node_view->NumRegularFanins() < 1) return false;
+
+  const auto& regular_fanin_0 = node_view->GetRegularFanin(0);
+  if (regular_fanin_0.index() != 1) return false;
+  const auto* split_node_view = regular_fanin_0.node_view();
+  const auto* split_node_def = split_node_view->node();
+
+  if (!IsStringSplitV2(*split_node_def) ||
+      HasControlFaninOrFanout(*split_node_view) ||
+      split_node_view->GetRegularFanout(1).size() != 1 ||
+      IsInPreserveSet(ctx, split_node_def) || !NodeIsOnCpu(split_node_def))
+    return false;
+
+  *matched = StringSplitToHashBucket(split_node_view->node_index(), node_index);
+
+  return true;
+}
+
+// Weights with fewer elements are left dense.
+constexpr int64_t kMinBlockSparseWeights = 64 * 64;
+// Weights are only converted if the stored blocks hold at most this fraction
+// of the weights; denser weights are faster with the dense matmul.
+constexpr double kMaxBlockSparseDensity = 0.3;
+
+// Converts the [k, n] matrix `weights` to the block-sparse format of
+// _BlockSparseMatMul with blocks of `block_rows` x `block_cols`, if the
+// shape is a multiple of the block shape.
+bool ToBlockColumns(const Tensor& weights, bool transpose, int block_rows,
+                    int block_cols, BlockSparseMatMul* matched) {
+  const auto w = weights.matrix<float>();
+  const int64_t k = transpose ? w.dimension(1) : w.dimension(0);
+  const int64_t n = transpose ? w.dimension(0) : w.dimension(1);
+  if (k % block_rows != 0 || n % block_cols != 0) return false;
+  auto weight = [&](int64_t row, int64_t col) {
+    return transpose ? w(col, row) : w(row, col);
+  };
+
+  const int64_t num_block_rows = k / block_rows;
+  const int64_t num_block_cols = n / block_cols;
+  std::vector<int32> col_ptr = {0};
+  std::vector<int32> row_indices;
+  for (int64_t block_col = 0; block_col < num_block_cols; ++block_col) {
+    for (int64_t block_row = 0; block_row < num_block_rows; ++block_row) {
+      bool is_zero = true;
+      for (int i = 0; i < block_rows && is_zero; ++i) {
+        for (int j = 0; j < block_cols && is_zero; ++j) {
+          is_zero = weight(block_row * block_rows + i,
+                           block_col * block_cols + j) == 0.0f;
+        }
+      }
+      if (!is_zero) row_indices.push_back(block_row);
+    }
+    col_ptr.push_back(row_indices.size());
+  }
+
+  const int64_t num_blocks = row_indices.size();
+  matched->block_values =
+      Tensor(DT_FLOAT, TensorShape({num_blocks, block_rows, block_cols}));
+  matched->block_col_ptr =
+      Tensor(DT_INT32, TensorShape({num_block_cols + 1}));
+  matched->block_row_indices = Tensor(DT_INT32, TensorShape({num_blocks}));
+  auto values = matched->block_values.tensor<float, 3>();
+  std::copy(col_ptr.begin(), col_ptr.end(),
+            matched->block_col_ptr.vec<int32>().data());
+  std::copy(row_indices.begin(), row_indices.end(),
+            matched->block_row_indices.vec<int32>().data());
+  for (int64_t block_col = 0; block_col < num_block_cols; ++block_col) {
+    for (int32 p = col_ptr[block_col]; p < col_ptr[block_col + 1]; ++p) {
+      for (int i = 0; i < block_rows; ++i) {
+        for (int j = 0; j < block_cols; ++j) {
+          values(p, i, j) = weight(row_indices[p] * block_rows + i,
+                                   block_col * block_cols + j);
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool FindBlockSparseMatMul(const RemapperContext& ctx, int node_index,
+                           BlockSparseMatMul* matched) {
+  // Root of the pattern must be a float MatMul on CPU.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+
+  if (!IsMatMul(*node_def) || HasControlFaninOrFanout(*node_view) ||
+      !NodeIsOnCpu(node_def) || !HasDataType(node_def, DT_FLOAT)) {
+    return false;
+  }
+  bool transpose_a;
+  bool transpose_b;
+  if (!GetNodeAttr(*node_def, "transpose_a", &transpose_a).ok() ||
+      transpose_a ||
+      !GetNodeAttr(*node_def, "transpose_b", &transpose_b).ok()) {
+    return false;
+  }
+
+  // The weights must be a constant.
+  if (node_view->NumRegularFanins() < 2) return false;
+  const auto* weights_node_view = node_view->GetRegularFanin(1).node_view();
+  const auto* weights_node_def = weights_node_view->node();
+  if (!IsConstant(*weights_node_def)) return false;
+  Tensor weights;
+  if (!weights.FromProto(weights_node_def->attr().at("value").tensor()) ||
+      weights.dtype() != DT_FLOAT || weights.dims() != 2 ||
+      weights.NumElements() < kMinBlockSparseWeights) {
+    return false;
+  }
+
+  // Keeps the supported block shape that stores the fewest weights.
+  bool found = false;
+  for (const auto& block_shape :
+       {std::make_pair(4, 4), std::make_pair(8, 1)}) {
+    BlockSparseMatMul candidate;
+    if (!ToBlockColumns(weights, transpose_b, block_shape.first,
+                        block_shape.second, &candidate)) {
+      continue;
+    }
+    const int64_t stored = candidate.block_values.NumElements();
+    if (stored > kMaxBlockSparseDensity * weights.NumElements()) continue;
+    if (!found || stored < matched->block_values.NumElements()) {
+      *matched = std::move(candidate);
+      found = true;
+    }
+  }
+  if (!found) return false;
+
+  matched->matmul = node_index;
+  if (!HasControlFaninOrFanout(*weights_node_view) &&
+      weights_node_view->NumRegularFanouts() == 1 &&
+      !IsInPreserveSet(ctx, weights_node_def)) {
+    matched->weights = weights_node_view->node_index();
+  }
+  return true;
+}
+
+// Weights with fewer elements are left in float.
+constexpr int64_t kMinDynamicQuantizedWeights = 128 * 128;
+// Largest inner dimension whose int8 dot products cannot overflow int32.
+constexpr int64_t kMaxDynamicQuantizedInnerDim =
+    std::numeric_limits<int32>::max() / (127 * 127);
+
+bool FindDynamicQuantizedMatMul(const RemapperContext& ctx, int node_index,
+                                DynamicQuantizedMatMul* matched) {
+  if (!DynamicQuantizedMatMulEnabled()) return false;
+
+  // Root of the pattern must be a float MatMul on CPU.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+
+  if (!IsMatMul(*node_def) || HasControlFaninOrFanout(*node_view) ||
+      !NodeIsOnCpu(node_def) || !HasDataType(node_def, DT_FLOAT)) {
+    return false;
+  }
+  bool transpose_a;
+  bool transpose_b;
+  if (!GetNodeAttr(*node_def, "transpose_a", &transpose_a).ok() ||
+      transpose_a ||
+      !GetNodeAttr(*node_def, "transpose_b", &transpose_b).ok()) {
+    return false;
+  }
+
+  // The weights must be a finite constant.
+  if (node_view->NumRegularFanins() < 2) return false;
+  const auto* weights_node_view = node_view->GetRegularFanin(1).node_view();
+  const auto* weights_node_def = weights_node_view->node();
+  if (!IsConstant(*weights_node_def)) return false;
+  Tensor weights;
+  if (!weights.FromProto(weights_node_def->attr().at("value").tensor()) ||
+      weights.dtype() != DT_FLOAT || weights.dims() != 2 ||
+      weights.NumElements() < kMinDynamicQuantizedWeights) {
+    return false;
+  }
+  const auto w = weights.matrix<float>();
+  const int64_t k = transpose_b ? w.dimension(1) : w.dimension(0);
+  const int64_t n = transpose_b ? w.dimension(0) : w.dimension(1);
+  if (k > kMaxDynamicQuantizedInnerDim) return false;
+  auto weight = [&](int64_t row, int64_t col) {
+    return transpose_b ? w(col, row) : w(row, col);
+  };
+
+  // Quantizes every output channel symmetrically to [-127, 127].
+  matched->b = Tensor(DT_INT8, TensorShape({n, k}));
+  matched->b_scales = Tensor(DT_FLOAT, TensorShape({n}));
+  auto b = matched->b.matrix<int8>();
+  auto b_scales = matched->b_scales.vec<float>();
+  for (int64_t col = 0; col < n; ++col) {
+    float max_abs = 0.0f;
+    for (int64_t row = 0; row < k; ++row) {
+      max_abs = std::max(max_abs, std::abs(weight(row, col)));
+    }
+    if (!std::isfinite(max_abs)) return false;
+    const float scale = max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+    for (int64_t row = 0; row < k; ++row) {
+      b(col, row) = static_cast<int8>(std::max(
+          -127.0f, std::min(127.0f, std::round(weight(row, col) / scale))));
+    }
+    b_scales(col) = scale;
+  }
+
+  matched->matmul = node_index;
+  if (!HasControlFaninOrFanout(*weights_node_view) &&
+      weights_node_view->NumRegularFanouts() == 1 &&
+      !IsInPreserveSet(ctx, weights_node_def)) {
+    matched->weights = weights_node_view->node_index();
+  }
+  return true;
+}
+
+bool FindResourceGatherWithSparseSegmentReduction(
+    RemapperContext* ctx, int node_index,
+    ResourceGatherWithSparseSegmentReduction* matched) {
+  // Root of the pattern must be a SparseSegment{Sum,Mean,SqrtN} on CPU.
+  const auto* node_view = ctx->graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+
+  if (!IsSparseSegmentReduction(*node_def) ||
+      HasControlFaninOrFanout(*node_view) || !NodeIsOnCpu(node_def)) {
+    return false;
+  }
+  if (!HasDataType(node_def, DT_FLOAT) && !HasDataType(node_def, DT_DOUBLE) &&
+      !HasDataType(node_def, DT_HALF) && !HasDataType(node_def, DT_BFLOAT16)) {
+    return false;
+  }
+
+  // The reduced data must be the output of a ResourceGather that feeds nothing
+  // else.
+  if (node_view->NumRegularFanins() < 3) return false;
+
+  const auto& regular_fanin_0 = node_view->GetRegularFanin(0);
+  const auto* gather_node_view = regular_fanin_0.node_view();
+  const auto* gather_node_def = gather_node_view->node();
+
+  if (!IsResourceGather(*gather_node_def) ||
+      HasControlFaninOrFanout(*gather_node_view) ||
+      !HasAtMostOneFanoutAtPort0(*gather_node_view) ||
+      IsInPreserveSet(*ctx, gather_node_def) || !NodeIsOnCpu(gather_node_def))
+    return false;
+
+  int batch_dims;
+  if (!GetNodeAttr(*gather_node_def, "batch_dims", &batch_dims).ok() ||
+      batch_dims != 0) {
+    return false;
+  }
+
+  // The gather indices must be a vector, so that the gathered rows are the
+  // rows of the variable.
+  if (!ctx->inferred_graph_properties) {
+    Status s = ctx->graph_properties.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/false,
+        /*include_output_tensor_values=*/false);
+    if (!s.ok()) return false;
+    ctx->inferred_graph_properties = true;
+  }
+  const auto& gather_props =
+      ctx->graph_properties.GetInputProperties(gather_node_def->name());
+  if (gather_props.size() < 2 || gather_props[1].shape().unknown_rank() ||
+      gather_props[1].shape().dim_size() != 1) {
+    return false;
+  }
+
+  *matched = ResourceGatherWithSparseSegmentReduction(
+      gather_node_view->node_index(), node_index);
+
+  return true;
+}
+
+// Returns true if the batch dimensions of `a` and `b`, all dimensions but the
+// last two, are known to be equal.
+bool HaveSameBatchDims(const TensorShapeProto& a, const TensorShapeProto& b) {
+  if (a.unknown_rank() || b.unknown_rank() || a.dim_size() < 3 ||
+      a.dim_size() != b.dim_size()) {
+    return false;
+  }
+  for (int i = 0; i < a.dim_size() - 2; ++i) {
+    // Unknown dimensions with the same symbolic id are equal.
+    if (a.dim(i).size() == -1 || a.dim(i).size() != b.dim(i).size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool FindScaledDotProductAttention(RemapperContext* ctx, int node_index,
+                                   ScaledDotProductAttention* matched) {
+  // A node of the attention, other than the root, must feed only the next
+  // node of the attention.
+  auto is_fusable = [&](const utils::MutableNodeView& node_view) {
+    const auto* node_def = node_view.node();
+    return !HasControlFaninOrFanout(node_view) &&
+           HasAtMostOneFanoutAtPort0(node_view) &&
+           !IsInPreserveSet(*ctx, node_def) && NodeIsOnCpu(node_def) &&
+           HasDataType(node_def, DT_FLOAT);
+  };
+  auto has_adjoints = [](const NodeDef& node_def, bool adj_x, bool adj_y) {
+    bool node_adj_x;
+    bool node_adj_y;
+    return GetNodeAttr(node_def, "adj_x", &node_adj_x).ok() &&
+           GetNodeAttr(node_def, "adj_y", &node_adj_y).ok() &&
+           node_adj_x == adj_x && node_adj_y == adj_y;
+  };
+
+  // Root of the pattern must be a float BatchMatMul of the probabilities and
+  // the values on CPU.
+  const auto* node_view = ctx->graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+
+  if (!IsAnyBatchMatMul(*node_def) || HasControlFaninOrFanout(*node_view) ||
+      !NodeIsOnCpu(node_def) || !HasDataType(node_def, DT_FLOAT) ||
+      !has_adjoints(*node_def, false, false) ||
+      node_view->NumRegularFanins() < 2) {
+    return false;
+  }
+
+  const auto* softmax_node_view = node_view->GetRegularFanin(0).node_view();
+  if (!IsSoftmax(*softmax_node_view->node()) ||
+      !is_fusable(*softmax_node_view) ||
+      softmax_node_view->NumRegularFanins() < 1) {
+    return false;
+  }
+
+  // The scores may be scaled by a scalar constant on either side.
+  ScaledDotProductAttention attention;
+  const auto* scores_node_view =
+      softmax_node_view->GetRegularFanin(0).node_view();
+  if (IsMul(*scores_node_view->node())) {
+    if (!is_fusable(*scores_node_view) ||
+        scores_node_view->NumRegularFanins() < 2) {
+      return false;
+    }
+    const auto* mul_node_view = scores_node_view;
+    bool found_scale = false;
+    for (int i = 0; i < 2 && !found_scale; ++i) {
+      const auto* constant_node_view =
+          mul_node_view->GetRegularFanin(i).node_view();
+      const auto* other_node_view =
+          mul_node_view->GetRegularFanin(1 - i).node_view();
+      Tensor scale;
+      if (IsConstant(*constant_node_view->node()) &&
+          scale.FromProto(
+              constant_node_view->node()->attr().at("value").tensor()) &&
+          scale.dtype() == DT_FLOAT && scale.NumElements() == 1 &&
+          IsAnyBatchMatMul(*other_node_view->node())) {
+        attention.scale_value = scale.flat<float>()(0);
+        scores_node_view = other_node_view;
+        found_scale = true;
+      }
+    }
+    if (!found_scale) return false;
+    attention.scale = mul_node_view->node_index();
+  }
+
+  const auto* scores_node_def = scores_node_view->node();
+  if (!IsAnyBatchMatMul(*scores_node_def) || !is_fusable(*scores_node_view) ||
+      !has_adjoints(*scores_node_def, false, true) ||
+      scores_node_view->NumRegularFanins() < 2) {
+    return false;
+  }
+
+  // Queries, keys and values must have the same batch dimensions, because the
+  // fused attention does not broadcast.
+  if (!ctx->inferred_graph_properties) {
+    Status s = ctx->graph_properties.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/false,
+        /*include_output_tensor_values=*/false);
+    if (!s.ok()) return false;
+    ctx->inferred_graph_properties = true;
+  }
+  const auto& scores_props =
+      ctx->graph_properties.GetInputProperties(scores_node_def->name());
+  const auto& output_props =
+      ctx->graph_properties.GetInputProperties(node_def->name());
+  if (scores_props.size() < 2 || output_props.size() < 2 ||
+      !HaveSameBatchDims(scores_props[0].shape(), scores_props[1].shape()) ||
+      !HaveSameBatchDims(scores_props[0].shape(), output_props[1].shape())) {
+    return false;
+  }
+
+  attention.scores = scores_node_view->node_index();
+  attention.softmax = softmax_node_view->node_index();
+  attention.output = node_index;
+  *matched = attention;
+
+  return true;
+}
+
+bool IsFusableUnaryElementwise(const NodeDef& node) {
+  static const auto* const kOps = new absl::flat_hash_set<string>(
+      {"Abs", "Exp", "Log", "Neg", "Relu", "Relu6", "Rsqrt", "Sigmoid", "Sqrt",
+       "Square", "Tanh"});
+  return kOps->contains(node.op());
+}
+
+bool IsFusableBinaryElementwise(const NodeDef& node, bool* commutative) {
+  static const auto* const kCommutativeOps = new absl::flat_hash_set<string>(
+      {"Add", "AddV2", "Maximum", "Minimum", "Mul"});
+  *commutative = kCommutativeOps->contains(node.op());
+  return *commutative || node.op() == "RealDiv" || node.op() == "Sub";
+}
+
+// Returns true if 'cast' converts a chain of type 'src' to a type supported
+// by _FusedElementwise.
+bool IsFusableElementwiseCast(const NodeDef& cast, DataType* src) {
+  if (!IsCast(cast)) return false;
+  bool truncate = false;
+  if (TryGetNodeAttr(cast, "Truncate", &truncate) && truncate) return false;
+  *src = GetDataTypeFromAttr(cast, "SrcT");
+  const DataType dst = GetDataTypeFromAttr(cast, "DstT");
+  return (*src == DT_FLOAT &&
+          (dst == DT_HALF || dst == DT_BFLOAT16 || dst == DT_FLOAT)) ||
+         (*src == DT_DOUBLE && (dst == DT_FLOAT || dst == DT_DOUBLE));
+}
+
+bool FindFusedElementwise(RemapperContext* ctx, int node_index,
+                          const std::vector<bool>& nodes_to_delete,
+                          FusedElementwise* matched) {
+  constexpr int kMaxFusedElementwiseOps = 16;
+
+  // Root of the pattern must be an elementwise op or Cast on CPU.
+  const auto* node_view = ctx->graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (HasControlFaninOrFanout(*node_view) || !NodeIsOnCpu(node_def)) {
+    return false;
+  }
+  bool commutative;
+  DataType dtype = GetDataTypeFromAttr(*node_def, "T");
+  if (!IsFusableElementwiseCast(*node_def, &dtype) &&
+      !IsFusableUnaryElementwise(*node_def) &&
+      !IsFusableBinaryElementwise(*node_def, &commutative)) {
+    return false;
+  }
+  if (dtype != DT_FLOAT && dtype != DT_DOUBLE) return false;
+
+  if (!ctx->inferred_graph_properties) {
+    Status s = ctx->graph_properties.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/false,
+        /*include_output_tensor_values=*/false);
+    if (!s.ok()) return false;
+    ctx->inferred_graph_properties = true;
+  }
+  const auto& root_props =
+      ctx->graph_properties.GetOutputProperties(node_def->name());
+  if (root_props.empty() || Rank(root_props[0].shape()) < 0) return false;
+  // The fused ops do not broadcast: every op of the chain produces this shape,
+  // and every other operand is a scalar or has this shape too.
+  const TensorShapeProto& shape = root_props[0].shape();
+
+  // Returns the input ports of 'view' that can read the chain, in order of
+  // preference.
+  auto chain_port_candidates = [&](const utils::MutableNodeView& view) {
+    std::vector<int> ports;
+    const NodeDef& def = *view.node();
+    bool is_commutative = false;
+    if (!IsFusableBinaryElementwise(def, &is_commutative)) {
+      ports.push_back(0);
+      return ports;
+    }
+    const auto& props = ctx->graph_properties.GetInputProperties(def.name());
+    if (props.size() != 2) return ports;
+    for (int port : {0, 1}) {
+      if (port == 1 && !is_commutative) break;
+      const TensorShapeProto& other = props[1 - port].shape();
+      if (ShapesSymbolicallyEqual(props[port].shape(), shape) &&
+          (Rank(other) == 0 || ShapesSymbolicallyEqual(other, shape))) {
+        ports.push_back(port);
+      }
+    }
+    return ports;
+  };
+  // Returns true if 'view' can be fused into the chain ahead of its consumer.
+  auto is_fusable_input = [&](const utils::MutableNodeView& view) {
+    const NodeDef* def = view.node();
+    bool unused;
+    return view.node_index() < nodes_to_delete.size() &&
+           !nodes_to_delete[view.node_index()] &&
+           (IsFusableUnaryElementwise(*def) ||
+            IsFusableBinaryElementwise(*def, &unused)) &&
+           HasDataType(def, dtype) && def->device() == node_def->device() &&
+           !HasControlFaninOrFanout(view) && HasAtMostOneFanoutAtPort0(view) &&
+           !IsInPreserveSet(*ctx, def);
+  };
+
+  std::vector<int> ops = {node_index};
+  std::vector<int> chain_ports;
+  const utils::MutableNodeView* current = node_view;
+  while (true) {
+    const std::vector<int> ports = chain_port_candidates(*current);
+    const utils::MutableNodeView* input = nullptr;
+    int chain_port = ports.empty() ? -1 : ports[0];
+    if (ops.size() < kMaxFusedElementwiseOps) {
+      for (int port : ports) {
+        const auto& fanin = current->GetRegularFanin(port);
+        if (fanin.index() == 0 && is_fusable_input(*fanin.node_view())) {
+          input = fanin.node_view();
+          chain_port = port;
+          break;
+        }
+      }
+    }
+    if (chain_port < 0) {
+      // 'current' cannot read the chain input without broadcasting, so the
+      // chain starts at its consumer.
+      ops.pop_back();
+      break;
+    }
+    chain_ports.push_back(chain_port);
+    if (input == nullptr) break;
+    ops.push_back(input->node_index());
+    current = input;
+  }
+  if (ops.size() < 2) return false;
+
+  std::reverse(ops.begin(), ops.end());
+  std::reverse(chain_ports.begin(), chain_ports.end());
+  matched->ops = std::move(ops);
+  matched->chain_ports = std::move(chain_ports);
+  return true;
+}
+
 bool FindFusedBatchMatMul(RemapperContext* ctx, int node_index,
                           std::map<string, int>* matched_nodes_map,
                           std::set<int>* remove_node_indices) {
@@ -3543,6 +4188,312 @@ Status AddTensorToHashBucketNode(RemapperContext* ctx,
   return OkStatus();
 }
 
+Status AddStringSplitToHashBucketNode(RemapperContext* ctx,
+                                     const StringSplitToHashBucket& matched,
+                                     std::vector<bool>* invalidated_nodes,
+                                     std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& string_split = graph->node(matched.string_split);
+  const NodeDef& string_to_hash_bucket =
+      graph->node(matched.string_to_hash_bucket);
+  VLOG(2) << "Fuse StringSplitV2 with StringToHashBucketFast:"
+          << " string_split=" << string_split.name()
+          << " string_to_hash_bucket=" << string_to_hash_bucket.name()
+          << " on device=" << string_split.device();
+
+  // The fused node keeps the name of the split, so that the consumers of the
+  // indices and shape are unchanged. The hash bucket node forwards the hashed
+  // tokens under its own name.
+  NodeDef fused_op;
+  fused_op.set_name(string_split.name());
+  fused_op.set_device(string_split.device());
+  fused_op.add_input(string_split.input(0));  // 0: input
+  fused_op.add_input(string_split.input(1));  // 1: sep
+  fused_op.set_op(kStringSplitToHashBucket);
+
+  auto* attr = fused_op.mutable_attr();
+  auto& src_attr0 = string_split.attr();
+  auto& src_attr1 = string_to_hash_bucket.attr();
+  (*attr)["maxsplit"] = src_attr0.at("maxsplit");
+  (*attr)["num_buckets"] = src_attr1.at("num_buckets");
+
+  NodeDef identity_op;
+  identity_op.set_name(string_to_hash_bucket.name());
+  identity_op.set_device(string_to_hash_bucket.device());
+  identity_op.add_input(string_to_hash_bucket.input(0));
+  identity_op.set_op("Identity");
+  SetAttrValue(DT_INT64, &(*identity_op.mutable_attr())["T"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  mutation->AddNode(std::move(identity_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.string_split] = true;
+  (*invalidated_nodes)[matched.string_to_hash_bucket] = true;
+
+  return OkStatus();
+}
+
+Status AddBlockSparseMatMulNode(RemapperContext* ctx,
+                                const BlockSparseMatMul& matched,
+                                std::vector<bool>* invalidated_nodes,
+                                std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& matmul = graph->node(matched.matmul);
+  VLOG(2) << "Convert MatMul to block-sparse: matmul=" << matmul.name()
+          << " blocks=" << matched.block_values.dim_size(0)
+          << " block_shape=" << matched.block_values.dim_size(1) << "x"
+          << matched.block_values.dim_size(2)
+          << " on device=" << matmul.device();
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+
+  // The block-sparse weights are new constants next to the MatMul.
+  auto add_constant = [&](const string& suffix, const Tensor& value) {
+    NodeDef constant;
+    constant.set_name(
+        absl::StrCat(matmul.name(), "/BlockSparseMatMul/", suffix));
+    constant.set_op("Const");
+    constant.set_device(matmul.device());
+    SetAttrValue(value.dtype(), &(*constant.mutable_attr())["dtype"]);
+    value.AsProtoTensorContent(
+        (*constant.mutable_attr())["value"].mutable_tensor());
+    const string name = constant.name();
+    mutation->AddNode(std::move(constant), &status);
+    return name;
+  };
+  const string block_values =
+      add_constant("block_values", matched.block_values);
+  TF_RETURN_IF_ERROR(status);
+  const string block_col_ptr =
+      add_constant("block_col_ptr", matched.block_col_ptr);
+  TF_RETURN_IF_ERROR(status);
+  const string block_row_indices =
+      add_constant("block_row_indices", matched.block_row_indices);
+  TF_RETURN_IF_ERROR(status);
+
+  NodeDef fused_op;
+  fused_op.set_name(matmul.name());
+  fused_op.set_device(matmul.device());
+  fused_op.set_op(kBlockSparseMatMul);
+  fused_op.add_input(matmul.input(0));    // 0: a
+  fused_op.add_input(block_values);       // 1: block_values
+  fused_op.add_input(block_col_ptr);      // 2: block_col_ptr
+  fused_op.add_input(block_row_indices);  // 3: block_row_indices
+  (*fused_op.mutable_attr())["T"] = matmul.attr().at("T");
+
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.matmul] = true;
+  if (matched.weights != kMissingIndex) {
+    (*nodes_to_delete)[matched.weights] = true;
+  }
+
+  return OkStatus();
+}
+
+Status AddDynamicQuantizedMatMulNode(RemapperContext* ctx,
+                                     const DynamicQuantizedMatMul& matched,
+                                     std::vector<bool>* invalidated_nodes,
+                                     std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& matmul = graph->node(matched.matmul);
+  VLOG(2) << "Quantize MatMul weights to int8: matmul=" << matmul.name()
+          << " weights=" << matched.b.shape().DebugString()
+          << " on device=" << matmul.device();
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+
+  // The quantized weights are new constants next to the MatMul.
+  auto add_constant = [&](const string& suffix, const Tensor& value) {
+    NodeDef constant;
+    constant.set_name(
+        absl::StrCat(matmul.name(), "/DynamicQuantizedMatMul/", suffix));
+    constant.set_op("Const");
+    constant.set_device(matmul.device());
+    SetAttrValue(value.dtype(), &(*constant.mutable_attr())["dtype"]);
+    value.AsProtoTensorContent(
+        (*constant.mutable_attr())["value"].mutable_tensor());
+    const string name = constant.name();
+    mutation->AddNode(std::move(constant), &status);
+    return name;
+  };
+  const string b = add_constant("b", matched.b);
+  TF_RETURN_IF_ERROR(status);
+  const string b_scales = add_constant("b_scales", matched.b_scales);
+  TF_RETURN_IF_ERROR(status);
+
+  NodeDef fused_op;
+  fused_op.set_name(matmul.name());
+  fused_op.set_device(matmul.device());
+  fused_op.set_op(kDynamicQuantizedMatMul);
+  fused_op.add_input(matmul.input(0));  // 0: a
+  fused_op.add_input(b);                // 1: b
+  fused_op.add_input(b_scales);         // 2: b_scales
+  (*fused_op.mutable_attr())["T"] = matmul.attr().at("T");
+
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.matmul] = true;
+  if (matched.weights != kMissingIndex) {
+    (*nodes_to_delete)[matched.weights] = true;
+  }
+
+  return OkStatus();
+}
+
+Status AddFusedResourceSparseSegmentReductionNode(
+    RemapperContext* ctx,
+    const ResourceGatherWithSparseSegmentReduction& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& resource_gather = graph->node(matched.resource_gather);
+  const NodeDef& reduction = graph->node(matched.sparse_segment_reduction);
+  VLOG(2) << "Fuse ResourceGather with " << reduction.op() << ":"
+          << " resource_gather=" << resource_gather.name()
+          << " reduction=" << reduction.name()
+          << " on device=" << reduction.device();
+
+  string combiner;
+  if (reduction.op() == "SparseSegmentSum") {
+    combiner = "sum";
+  } else if (reduction.op() == "SparseSegmentMean") {
+    combiner = "mean";
+  } else {
+    combiner = "sqrtn";
+  }
+
+  NodeDef fused_op;
+  fused_op.set_name(reduction.name());
+  fused_op.set_device(reduction.device());
+  fused_op.set_op(kFusedResourceSparseSegmentReduction);
+  fused_op.add_input(resource_gather.input(0));  // 0: resource
+  fused_op.add_input(resource_gather.input(1));  // 1: gather_indices
+  fused_op.add_input(reduction.input(1));        // 2: indices
+  fused_op.add_input(reduction.input(2));        // 3: segment_ids
+
+  auto* attr = fused_op.mutable_attr();
+  auto& src_attr0 = resource_gather.attr();
+  auto& src_attr1 = reduction.attr();
+  (*attr)["dtype"] = src_attr0.at("dtype");
+  (*attr)["Tgather"] = src_attr0.at("Tindices");
+  (*attr)["Tidx"] = src_attr1.at("Tidx");
+  (*attr)["Tsegmentids"] = src_attr1.at("Tsegmentids");
+  SetAttrValue(combiner, &(*attr)["combiner"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.sparse_segment_reduction] = true;
+  (*nodes_to_delete)[matched.resource_gather] = true;
+
+  return OkStatus();
+}
+
+Status AddScaledDotProductAttentionNode(
+    RemapperContext* ctx, const ScaledDotProductAttention& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& scores = graph->node(matched.scores);
+  const NodeDef& output = graph->node(matched.output);
+  VLOG(2) << "Fuse scaled dot-product attention:"
+          << " scores=" << scores.name() << " output=" << output.name()
+          << " scale=" << matched.scale_value
+          << " on device=" << output.device();
+
+  NodeDef fused_op;
+  fused_op.set_name(output.name());
+  fused_op.set_device(output.device());
+  fused_op.set_op(kFusedScaledDotProductAttention);
+  fused_op.add_input(scores.input(0));  // 0: query
+  fused_op.add_input(scores.input(1));  // 1: key
+  fused_op.add_input(output.input(1));  // 2: value
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = output.attr().at("T");
+  SetAttrValue(matched.scale_value, &(*attr)["scale"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.output] = true;
+  (*nodes_to_delete)[matched.scores] = true;
+  if (matched.scale != kMissingIndex) {
+    (*nodes_to_delete)[matched.scale] = true;
+  }
+  (*nodes_to_delete)[matched.softmax] = true;
+
+  return OkStatus();
+}
+
+Status AddFusedElementwiseNode(RemapperContext* ctx,
+                               const FusedElementwise& matched,
+                               std::vector<bool>* invalidated_nodes,
+                               std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& first = graph->node(matched.ops.front());
+  const NodeDef& last = graph->node(matched.ops.back());
+
+  NodeDef fused_op;
+  fused_op.set_name(last.name());
+  fused_op.set_device(last.device());
+  fused_op.set_op(kFusedElementwise);
+  fused_op.add_input(first.input(matched.chain_ports.front()));  // 0: x
+
+  std::vector<string> fused_ops;
+  for (int i = 0; i < matched.ops.size(); ++i) {
+    const NodeDef& node = graph->node(matched.ops[i]);
+    fused_ops.push_back(node.op());
+    bool unused;
+    if (IsFusableBinaryElementwise(node, &unused)) {
+      fused_op.add_input(node.input(1 - matched.chain_ports[i]));
+    }
+  }
+  VLOG(2) << "Fuse elementwise ops: " << absl::StrJoin(fused_ops, ",")
+          << " into " << last.name() << " on device=" << last.device();
+
+  auto* attr = fused_op.mutable_attr();
+  DataType dtype;
+  if (IsFusableElementwiseCast(last, &dtype)) {
+    SetAttrValue(dtype, &(*attr)["T"]);
+    (*attr)["Tout"] = last.attr().at("DstT");
+  } else {
+    (*attr)["T"] = last.attr().at("T");
+    (*attr)["Tout"] = last.attr().at("T");
+  }
+  SetAttrValue(fused_op.input_size() - 1, &(*attr)["num_args"]);
+  SetAttrValue(fused_ops, &(*attr)["fused_ops"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.ops.back()] = true;
+  for (int i = 0; i + 1 < matched.ops.size(); ++i) {
+    (*nodes_to_delete)[matched.ops[i]] = true;
+  }
+
+  return OkStatus();
+}
+
 Status AddFusedBatchMatMul(RemapperContext* ctx,
                            const std::map<string, int>& matched_nodes_map,
                            const std::set<int>& remove_node_indices,
@@ -4140,6 +5091,49 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    BlockSparseMatMul block_sparse_matmul;
+    if (allow_non_differentiable_rewrites &&
+        FindBlockSparseMatMul(ctx, i, &block_sparse_matmul)) {
+      TF_RETURN_IF_ERROR(AddBlockSparseMatMulNode(
+          &ctx, block_sparse_matmul, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
+    DynamicQuantizedMatMul dynamic_quantized_matmul;
+    if (allow_non_differentiable_rewrites &&
+        FindDynamicQuantizedMatMul(ctx, i, &dynamic_quantized_matmul)) {
+      TF_RETURN_IF_ERROR(AddDynamicQuantizedMatMulNode(
+          &ctx, dynamic_quantized_matmul, &invalidated_nodes,
+          &nodes_to_delete));
+      continue;
+    }
+
+    StringSplitToHashBucket string_split_to_hash_bucket;
+    if (allow_non_differentiable_rewrites &&
+        FindStringSplitToHashBucket(ctx, i, &string_split_to_hash_bucket)) {
+      TF_RETURN_IF_ERROR(AddStringSplitToHashBucketNode(
+          &ctx, string_split_to_hash_bucket, &invalidated_nodes,
+          &nodes_to_delete));
+      continue;
+    }
+
+    ResourceGatherWithSparseSegmentReduction gather_with_reduction;
+    if (allow_non_differentiable_rewrites &&
+        FindResourceGatherWithSparseSegmentReduction(&ctx, i,
+                                                     &gather_with_reduction)) {
+      TF_RETURN_IF_ERROR(AddFusedResourceSparseSegmentReductionNode(
+          &ctx, gather_with_reduction, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
+    ScaledDotProductAttention attention;
+    if (allow_non_differentiable_rewrites &&
+        FindScaledDotProductAttention(&ctx, i, &attention)) {
+      TF_RETURN_IF_ERROR(AddScaledDotProductAttentionNode(
+          &ctx, attention, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
@@ -4149,6 +5143,23 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     }
   }
 
+  // Fuse chains of elementwise ops last, so that they do not take activations
+  // and side inputs away from the fusions above. Without XLA every op of a
+  // chain makes its own pass over memory; this is opt-in because it trades
+  // the op-by-op graph for a single opaque node.
+  if (allow_non_differentiable_rewrites &&
+      opt_level_ == RewriterConfig::AGGRESSIVE &&
+      !ctx.xla_auto_clustering_on) {
+    for (int i = num_nodes - 1; i >= 0; --i) {
+      if (invalidated_nodes[i] || nodes_to_delete[i]) continue;
+      FusedElementwise fused_elementwise;
+      if (FindFusedElementwise(&ctx, i, nodes_to_delete, &fused_elementwise)) {
+        TF_RETURN_IF_ERROR(AddFusedElementwiseNode(
+            &ctx, fused_elementwise, &invalidated_nodes, &nodes_to_delete));
+      }
+    }
+  }
+
   // Remove invalidated nodes.
   utils::Mutation* mutation = ctx.graph_view.GetMutationBuilder();
   for (int i = 0; i < num_nodes; ++i) {
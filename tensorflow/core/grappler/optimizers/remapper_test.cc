@@ -41,6 +41,8 @@ class RemapperTest : public GrapplerTest {
     setenv("TF_USE_CUDNN_BATCHNORM_SPATIAL_PERSISTENT", "1", 1 /* replace */);
     // This is a requirement for fusing FusedMatmul + BiasAdd (+ Activation).
     setenv("TF_USE_CUBLASLT", "1", 1 /* replace */);
+    // This is a requirement for quantizing MatMul weights to int8.
+    setenv("TF_ENABLE_DYNAMIC_QUANTIZED_MATMUL", "1", 1 /* replace */);
   }
 };
 
@@ -1414,6 +1416,292 @@ TEST_F(RemapperTensorToHashBucketTest, I32) { RunTest<DT_INT32>(); }
 
 TEST_F(RemapperTensorToHashBucketTest, I64) { RunTest<DT_INT64>(); }
 
+TEST_F(RemapperTest, BlockSparseMatMul) {
+  using ::tensorflow::ops::Placeholder;
+
+  for (bool transpose_b : {false, true}) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    // Only one 4x4 block in eight is nonzero.
+    Tensor weights_t(DT_FLOAT, TensorShape({64, 64}));
+    auto weights_matrix = weights_t.matrix<float>();
+    for (int i = 0; i < 64; ++i) {
+      for (int j = 0; j < 64; ++j) {
+        weights_matrix(i, j) = ((i / 4) + 3 * (j / 4)) % 8 == 0 ? i - j : 0;
+      }
+    }
+
+    auto input = Placeholder(s.WithOpName("input"), DT_FLOAT,
+                             ops::Placeholder::Shape({3, 64}));
+    auto weights = ops::Const(s.WithOpName("weights"), weights_t);
+    auto matmul =
+        ops::MatMul(s.WithOpName("matmul"), input, weights,
+                    ops::MatMul::Attrs().TransposeB(transpose_b));
+    auto fetch = ops::Identity(s.WithOpName("fetch"), matmul);
+
+    auto input_t = GenerateRandomTensor<DT_FLOAT>({3, 64});
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"input", input_t}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.name(), "weights");
+      if (node.name() == "matmul") {
+        EXPECT_EQ(node.op(), "_BlockSparseMatMul");
+        ASSERT_EQ(node.input_size(), 4);
+        EXPECT_EQ(node.input(0), "input");
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 1);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-4);
+  }
+}
+
+TEST_F(RemapperTest, DynamicQuantizedMatMul) {
+  using ::tensorflow::ops::Placeholder;
+
+  for (bool transpose_b : {false, true}) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto input = Placeholder(s.WithOpName("input"), DT_FLOAT,
+                             ops::Placeholder::Shape({3, 128}));
+    auto weights = ops::Const(s.WithOpName("weights"),
+                              GenerateRandomTensor<DT_FLOAT>({128, 128}));
+    auto matmul =
+        ops::MatMul(s.WithOpName("matmul"), input, weights,
+                    ops::MatMul::Attrs().TransposeB(transpose_b));
+    auto fetch = ops::Identity(s.WithOpName("fetch"), matmul);
+
+    auto input_t = GenerateRandomTensor<DT_FLOAT>({3, 128});
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"input", input_t}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.name(), "weights");
+      if (node.name() == "matmul") {
+        EXPECT_EQ(node.op(), "_DynamicQuantizedMatMul");
+        ASSERT_EQ(node.input_size(), 3);
+        EXPECT_EQ(node.input(0), "input");
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 1);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectClose(tensors[0], tensors_expected[0], 1e-1, /*rtol=*/5e-2);
+  }
+}
+
+TEST_F(RemapperTest, FuseScaledDotProductAttention) {
+  using ::tensorflow::ops::Placeholder;
+
+  for (bool with_scale : {false, true}) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                             ops::Placeholder::Shape({2, 3, 10, 8}));
+    auto key = Placeholder(s.WithOpName("key"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 3, 200, 8}));
+    auto value = Placeholder(s.WithOpName("value"), DT_FLOAT,
+                             ops::Placeholder::Shape({2, 3, 200, 4}));
+    Output scores =
+        ops::BatchMatMulV2(s.WithOpName("scores"), query, key,
+                           ops::BatchMatMulV2::Attrs().AdjY(true));
+    if (with_scale) {
+      auto scale = ops::Const(s.WithOpName("scale"), 0.35f, {});
+      scores = ops::Mul(s.WithOpName("scaled_scores"), scale, scores);
+    }
+    auto softmax = ops::Softmax(s.WithOpName("softmax"), scores);
+    auto output = ops::BatchMatMulV2(s.WithOpName("output"), softmax, value);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), output);
+
+    auto query_t = GenerateRandomTensor<DT_FLOAT>({2, 3, 10, 8});
+    auto key_t = GenerateRandomTensor<DT_FLOAT>({2, 3, 200, 8});
+    auto value_t = GenerateRandomTensor<DT_FLOAT>({2, 3, 200, 4});
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"query", query_t}, {"key", key_t}, {"value", value_t}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output_graph;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output_graph));
+
+    int found = 0;
+    for (const NodeDef& node : output_graph.node()) {
+      EXPECT_NE(node.name(), "scores");
+      EXPECT_NE(node.name(), "softmax");
+      if (node.name() == "output") {
+        EXPECT_EQ(node.op(), "_FusedScaledDotProductAttention");
+        ASSERT_EQ(node.input_size(), 3);
+        EXPECT_EQ(node.input(0), "query");
+        EXPECT_EQ(node.input(1), "key");
+        EXPECT_EQ(node.input(2), "value");
+        EXPECT_FLOAT_EQ(node.attr().at("scale").f(), with_scale ? 0.35f : 1.0f);
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 1);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output_graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+  }
+}
+
+TEST_F(RemapperTest, FuseStringSplitWithStringToHashBucket) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input = Placeholder(s.WithOpName("input"), DT_STRING,
+                           ops::Placeholder::Shape({3}));
+  auto sep = ops::Const(s.WithOpName("sep"), string(" "), {});
+  auto split = ops::StringSplitV2(s.WithOpName("split"), input, sep);
+  int num_buckets = 100;
+  auto to_bucket = ops::StringToHashBucketFast(s.WithOpName("to_bucket"),
+                                               split.values, num_buckets);
+  auto fetch_indices = ops::Identity(s.WithOpName("fetch_indices"),
+                                     split.indices);
+  auto fetch_values = ops::Identity(s.WithOpName("fetch_values"), to_bucket);
+  auto fetch_shape = ops::Identity(s.WithOpName("fetch_shape"), split.shape);
+
+  Tensor input_t(DT_STRING, TensorShape({3}));
+  test::FillValues<tstring>(&input_t, {"a b c", "", "hello world"});
+
+  GrapplerItem item;
+  item.fetch = {"fetch_indices", "fetch_values", "fetch_shape"};
+  item.feed = {{"input", input_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "split") {
+      EXPECT_EQ(node.op(), "_StringSplitToHashBucketFast");
+      ASSERT_EQ(node.input_size(), 2);
+      EXPECT_EQ(node.input(0), "input");
+      EXPECT_EQ(node.input(1), "sep");
+      EXPECT_EQ(node.attr().at("num_buckets").i(), num_buckets);
+      found++;
+    } else if (node.name() == "to_bucket") {
+      EXPECT_EQ(node.op(), "Identity");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "split:1");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 2);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 3);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 3);
+  for (int i = 0; i < 3; ++i) {
+    test::ExpectTensorEqual<int64_t>(tensors[i], tensors_expected[i]);
+  }
+}
+
+TEST_F(RemapperTest, FuseResourceGatherWithSparseSegmentMean) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto variable = ops::VarHandleOp(s.WithOpName("variable"), DT_FLOAT,
+                                   TensorShape({100, 16}));
+  auto ids = Placeholder(s.WithOpName("ids"), DT_INT32,
+                         ops::Placeholder::Shape({6}));
+  auto idx = Placeholder(s.WithOpName("idx"), DT_INT32,
+                         ops::Placeholder::Shape({8}));
+  auto segment_ids = Placeholder(s.WithOpName("segment_ids"), DT_INT32,
+                                 ops::Placeholder::Shape({8}));
+  auto gather =
+      ops::ResourceGather(s.WithOpName("gather"), variable, ids, DT_FLOAT);
+  auto mean = ops::SparseSegmentMean(s.WithOpName("mean"), gather, idx,
+                                     segment_ids);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), mean);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "gather");
+    if (node.name() == "mean") {
+      EXPECT_EQ(node.op(), "_FusedResourceSparseSegmentReduction");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "variable");
+      EXPECT_EQ(node.input(1), "ids");
+      EXPECT_EQ(node.input(2), "idx");
+      EXPECT_EQ(node.input(3), "segment_ids");
+      EXPECT_EQ(node.attr().at("combiner").s(), "mean");
+      EXPECT_EQ(node.attr().at("dtype").type(), DT_FLOAT);
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+}
+
 class RemapperFuseMatMulWithBiasTest : public RemapperTest {
  public:
   template <DataType DTYPE>
@@ -2506,5 +2794,105 @@ class RemapperLeakyReluTest : public GrapplerTest {
 TEST_F(RemapperLeakyReluTest, F32) { RunTest<DT_FLOAT>(); }
 TEST_F(RemapperLeakyReluTest, BF16) { RunTest<DT_BFLOAT16>(); }
 
+class RemapperFuseElementwiseTest : public GrapplerTest {
+ protected:
+  template <DataType DTYPE>
+  void RunTest() {
+    using ::tensorflow::ops::Placeholder;
+
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    auto shape = ops::Placeholder::Shape({8, 32});
+
+    // y = cast(relu(x * scale + bias))
+    auto x = Placeholder(s.WithOpName("x"), DT_FLOAT, shape);
+    auto bias = Placeholder(s.WithOpName("bias"), DT_FLOAT, shape);
+    auto scale = ops::Const(s.WithOpName("scale"), 0.5f);
+    auto mul = ops::Mul(s.WithOpName("mul"), x, scale);
+    auto add = ops::AddV2(s.WithOpName("add"), mul, bias);
+    Output out = ops::Relu(s.WithOpName("relu"), add);
+    string root = "relu";
+    std::vector<string> expected_ops = {"Mul", "AddV2", "Relu"};
+    if (DTYPE != DT_FLOAT) {
+      out = ops::Cast(s.WithOpName("cast"), out, DTYPE);
+      root = "cast";
+      expected_ops.push_back("Cast");
+    }
+    auto fetch = ops::Identity(s.WithOpName("fetch"), out);
+
+    auto x_t = GenerateRandomTensor<DT_FLOAT>({8, 32});
+    auto bias_t = GenerateRandomTensor<DT_FLOAT>({8, 32});
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"x", x_t}, {"bias", bias_t}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::AGGRESSIVE);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.name(), "mul");
+      EXPECT_NE(node.name(), "add");
+      if (node.name() == root) {
+        EXPECT_EQ(node.op(), "_FusedElementwise");
+        ASSERT_EQ(node.input_size(), 3);
+        EXPECT_EQ(node.input(0), "x");
+        EXPECT_EQ(node.input(1), "scale");
+        EXPECT_EQ(node.input(2), "bias");
+        EXPECT_EQ(node.attr().at("num_args").i(), 2);
+        EXPECT_EQ(node.attr().at("T").type(), DT_FLOAT);
+        EXPECT_EQ(node.attr().at("Tout").type(), DTYPE);
+        const auto& fused_ops = node.attr().at("fused_ops").list().s();
+        ASSERT_EQ(fused_ops.size(), expected_ops.size());
+        for (int i = 0; i < expected_ops.size(); ++i) {
+          EXPECT_EQ(fused_ops[i], expected_ops[i]);
+        }
+        ++found;
+      }
+    }
+    EXPECT_EQ(found, 1);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    const double tol = DTYPE == DT_FLOAT ? 1e-6 : 1e-3;
+    test::ExpectClose(tensors[0], tensors_expected[0], tol, tol);
+  }
+};
+
+TEST_F(RemapperFuseElementwiseTest, F32) { RunTest<DT_FLOAT>(); }
+TEST_F(RemapperFuseElementwiseTest, F32ToF16) { RunTest<DT_HALF>(); }
+
+TEST_F(RemapperFuseElementwiseTest, NotFusedWithoutAggressive) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                            ops::Placeholder::Shape({8, 32}));
+  auto exp = ops::Exp(s.WithOpName("exp"), x);
+  auto tanh = ops::Tanh(s.WithOpName("tanh"), exp);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), tanh);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedElementwise");
+  }
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/scoped_allocator.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
+#include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/node_def_util.h"
@@ -70,6 +71,54 @@ bool HasOpName(const string& node_name, const string& op_name) {
   return node_name.substr(begin, end - begin) == op_name;
 }
 
+// Returns true iff `n` is a CollectiveReduceV2, whose data inputs after the
+// first (group size, group key and instance key) are not combined: the
+// combined op takes them from the first op of the group.
+bool HasSideInputs(const NodeDef& n) { return n.op() == "CollectiveReduceV2"; }
+
+// Returns true iff the tensors named by `a` and `b` are known to hold the same
+// value, i.e. they are the same tensor or Const ops with equal values.
+bool SameInputValue(NodeMap* node_map, const string& a, const string& b) {
+  if (a == b) return true;
+  const NodeDef* a_node = node_map->GetNode(a);
+  const NodeDef* b_node = node_map->GetNode(b);
+  if (a_node == nullptr || b_node == nullptr || !IsConstant(*a_node) ||
+      !IsConstant(*b_node)) {
+    return false;
+  }
+  const AttrValue* a_value = AttrSlice(*a_node).Find("value");
+  const AttrValue* b_value = AttrSlice(*b_node).Find("value");
+  return a_value != nullptr && b_value != nullptr &&
+         AreAttrValuesEqual(*a_value, *b_value);
+}
+
+// Returns non-OK unless the ops with side inputs in `ops` can be combined into
+// one op that takes the side inputs of `ops[0]`: they must be in the same
+// group and must not take ordering tokens.
+Status CheckSideInputs(NodeMap* node_map, const std::vector<NodeDef*>& ops) {
+  for (const NodeDef* n : ops) {
+    int num_ordering_tokens = 0;
+    if (GetNodeAttr(AttrSlice(*n), "Nordering_token", &num_ordering_tokens)
+            .ok() &&
+        num_ordering_tokens > 0) {
+      return errors::Aborted("Node ", n->name(),
+                             " has ordering tokens, which are not supported "
+                             "by ScopedAllocatorOptimizer");
+    }
+    if (n->input_size() < 4 || IsControlInput(n->input(3))) {
+      return errors::Internal("Node ", n->name(), " has too few inputs");
+    }
+    // Group size and group key.
+    for (int i : {1, 2}) {
+      if (!SameInputValue(node_map, ops[0]->input(i), n->input(i))) {
+        return errors::Aborted("Nodes ", ops[0]->name(), " and ", n->name(),
+                               " are not known to be in the same group");
+      }
+    }
+  }
+  return OkStatus();
+}
+
 Status GetOutputDataType(
     const std::vector<OpInfo::TensorProperties>& output_props, int output_index,
     DataType* dtype) {
@@ -268,6 +317,8 @@ Status GetInputs(ScopedAllocatorOptimizer* sa_opti, int64_t invocation_count,
     for (const auto& input_name : n->input()) {
       if (!IsControlInput(input_name)) {
         if (inode) {
+          // Side inputs are not combined.
+          if (HasSideInputs(*n)) break;
           return errors::Internal("Found more than one input for node ",
                                   n->name());
         }
@@ -451,6 +502,9 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
                        std::vector<TensorShape>* input_shapes,
                        std::vector<InputDesc>* inputs, TensorShape* sa_shape) {
     CHECK(graph_properties_);
+    if (HasSideInputs(*ops[0])) {
+      LOG_WARNING_AND_RETURN_IF_ERROR(CheckSideInputs(node_map, ops));
+    }
     LOG_WARNING_AND_RETURN_IF_ERROR(
         CheckTypesAndGetShapes(*graph_properties_, ops, dtype, input_shapes));
     LOG_WARNING_AND_RETURN_IF_ERROR(
@@ -606,6 +660,7 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
     absl::flat_hash_map<string, string> sac_ctl_inputs;
     for (int i = 0, end = ops.size(); i < end; ++i) {
       NodeDef* old_op = ops[i];
+      int num_data_inputs = 0;
       for (const string& old_op_input : old_op->input()) {
         int position = 0;
         string input_name = ParseNodeName(old_op_input, &position);
@@ -614,6 +669,9 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
           if (op_instance_names.find(old_op_input) == op_instance_names.end()) {
             sac_ctl_inputs.emplace(old_op_input, input_name);
           }
+        } else if (num_data_inputs++ > 0 && HasSideInputs(*old_op)) {
+          // A side input: taken by the replacement op from ops[0].
+          continue;
         } else {
           // TODO(tucker): remove redundant check.
           // A data input: illegal if from another member of the op set.
@@ -677,10 +735,25 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
     }
     op_builder.Attr("_forward_input", {0, 0});
     op_builder.Input(sac_name, 0, dtype);
+    std::vector<string> side_input_nodes;
+    if (HasSideInputs(*ops[0])) {
+      // Group size, group key and instance key, checked by CheckSideInputs,
+      // followed by the empty list of ordering tokens.
+      for (int i = 1; i <= 3; ++i) {
+        int position = 0;
+        string input_node = ParseNodeName(ops[0]->input(i), &position);
+        op_builder.Input(input_node, position, DT_INT32);
+        side_input_nodes.push_back(input_node);
+      }
+      op_builder.Input(std::vector<NodeDefBuilder::NodeOut>{});
+    }
     NodeDef* sa_op_node = graph->add_node();
     LOG_WARNING_AND_RETURN_IF_ERROR(op_builder.Finalize(sa_op_node));
     node_map->AddNode(sa_op_name, sa_op_node);
     node_map->AddOutput(sac_name, sa_op_name);
+    for (const string& input_node : side_input_nodes) {
+      node_map->AddOutput(input_node, sa_op_name);
+    }
     return OkStatus();
   }
 
@@ -888,13 +961,13 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
 
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
     RewriterConfig::Toggle opt_level, const ScopedAllocatorOptions& opts)
-    : opt_level_(opt_level) {
+    : opt_level_(opt_level), max_bucket_bytes_(opts.max_bucket_bytes()) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
   if (opts.enable_op_size() == 0) {
     // Opts handled by default:
-    for (const auto& op_name : {"CollectiveReduce"}) {
+    for (const auto& op_name : {"CollectiveReduce", "CollectiveReduceV2"}) {
       op_name_set_.insert(op_name);
       rewriters_[op_name] = r;
     }
@@ -1060,6 +1133,38 @@ void PartitionByLoopStructure(const FrameView& frame_view,
   }
 }
 
+// Splits `nodes`, in order, into buckets whose outputs total at most
+// `max_bucket_bytes`. A node whose output alone exceeds the limit gets a
+// bucket of its own. If `max_bucket_bytes` is not positive, returns a single
+// bucket.
+void SplitIntoBuckets(const GraphProperties& graph_properties,
+                      int64_t max_bucket_bytes,
+                      const std::vector<NodeDef*>& nodes,
+                      std::vector<std::vector<NodeDef*>>* buckets) {
+  if (max_bucket_bytes <= 0) {
+    buckets->push_back(nodes);
+    return;
+  }
+  int64_t bucket_bytes = 0;
+  for (NodeDef* nd : nodes) {
+    int64_t num_bytes = 0;
+    if (graph_properties.HasOutputProperties(nd->name())) {
+      const auto& props = graph_properties.GetOutputProperties(nd->name());
+      if (!props.empty() && TensorShape::IsValid(props[0].shape()) &&
+          !props[0].shape().unknown_rank()) {
+        num_bytes = TensorShape(props[0].shape()).num_elements() *
+                    DataTypeSize(props[0].dtype());
+      }
+    }
+    if (buckets->empty() || bucket_bytes + num_bytes > max_bucket_bytes) {
+      buckets->emplace_back();
+      bucket_bytes = 0;
+    }
+    buckets->back().push_back(nd);
+    bucket_bytes += num_bytes;
+  }
+}
+
 // Identify outputs that are inputs to multiple sets of nodes.
 void IdentifyRepeatedInputs(const std::vector<NodeDef*>& nodes,
                             absl::flat_hash_set<string>* seen_outputs,
@@ -1121,7 +1226,8 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
         // in the same Tree struct.  Split those groups into subgroups that
         // share identical loop nesting.
         status = ApplyToAll(root.get(), [this, rewriter, graph, &frame_view,
-                                         &op_name, invocation_count](Tree* t) {
+                                         &graph_properties, &op_name,
+                                         invocation_count](Tree* t) {
           VLOG(2) << "applied to tree node " << t->edge_ << " at depth "
                   << t->depth_ << " of size " << t->nodes_.size();
           if (t->nodes_.size() > 1) {
@@ -1129,13 +1235,19 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
             PartitionByLoopStructure(frame_view, t->nodes_, &loop_groups);
             for (auto& lg : loop_groups) {
               if (lg.size() > 1) {
-                bool applied = false;
-                Status s = OrderNodeSet(&lg);
-                TF_RETURN_IF_ERROR(s);
-                VLOG(1) << "Applying Rewriter for " << op_name;
-                s = rewriter->Rewrite(this, invocation_count, graph, op_name,
-                                      lg, &applied);
-                LOG_WARNING_AND_RETURN_IF_ERROR(s);
+                TF_RETURN_IF_ERROR(OrderNodeSet(&lg));
+                std::vector<std::vector<NodeDef*>> buckets;
+                SplitIntoBuckets(graph_properties, max_bucket_bytes_, lg,
+                                 &buckets);
+                for (const auto& bucket : buckets) {
+                  if (bucket.size() <= 1) continue;
+                  bool applied = false;
+                  VLOG(1) << "Applying Rewriter for " << op_name
+                          << " to a bucket of size " << bucket.size();
+                  Status s = rewriter->Rewrite(this, invocation_count, graph,
+                                               op_name, bucket, &applied);
+                  LOG_WARNING_AND_RETURN_IF_ERROR(s);
+                }
               }
             }
           }
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.pb.h"  // NOLINT
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
@@ -596,6 +597,92 @@ TEST_F(ScopedAllocatorOptimizerTest, ConstInput) {
   }
   EXPECT_EQ(num_identity_ops, 2);
 }
+// Returns the number of nodes in `graph` with op `op`.
+int CountOps(const GraphDef& graph, const string& op) {
+  int count = 0;
+  for (const NodeDef& node : graph.node()) {
+    if (node.op() == op) ++count;
+  }
+  return count;
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, MaxBucketBytes) {
+  GrapplerItem item;
+  {
+    Scope s = Scope::NewRootScope();
+    s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+    Output a = ops::Const<float>(s.WithOpName("a"), {1.0, 0.0, 0.0, -1.0},
+                                 {2, 2});
+    for (int i = 0; i < 4; ++i) {
+      Output add = ops::Add(s.WithOpName(strings::StrCat("s", i)), a, a);
+      ops::Abs(s.WithOpName(strings::StrCat("a", i)), add);
+    }
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  }
+  SetShapes(&item.graph);
+
+  // Each Abs output has 16 bytes, so the four ops are combined in pairs.
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("Abs");
+  opts.set_max_bucket_bytes(32);
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+  EXPECT_EQ(CountOps(optimized_graph, "_ScopedAllocator"), 2);
+  EXPECT_EQ(CountOps(optimized_graph, "_ScopedAllocatorSplit"), 2);
+  EXPECT_EQ(CountOps(optimized_graph, "Abs"), 2);
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, CollectiveReduceV2) {
+  GrapplerItem item;
+  {
+    Scope s = Scope::NewRootScope();
+    s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+    Output a = ops::Const<float>(s.WithOpName("a"), {1.0, 0.0, 0.0, -1.0},
+                                 {2, 2});
+    for (int i = 1; i <= 2; ++i) {
+      ops::Add(s.WithOpName(strings::StrCat("s", i)), a, a);
+      // Each collective has its own, equal group size and group key.
+      ops::Const<int32>(s.WithOpName(strings::StrCat("gs", i)), 1);
+      ops::Const<int32>(s.WithOpName(strings::StrCat("gk", i)), 1);
+      ops::Const<int32>(s.WithOpName(strings::StrCat("ik", i)), i);
+    }
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  }
+  for (int i = 1; i <= 2; ++i) {
+    TF_CHECK_OK(
+        NodeDefBuilder(strings::StrCat("c", i), "CollectiveReduceV2")
+            .Device("/job:localhost/replica:0/task:0/device:CPU:0")
+            .Input(strings::StrCat("s", i), 0, DT_FLOAT)
+            .Input(strings::StrCat("gs", i), 0, DT_INT32)
+            .Input(strings::StrCat("gk", i), 0, DT_INT32)
+            .Input(strings::StrCat("ik", i), 0, DT_INT32)
+            .Input(std::vector<NodeDefBuilder::NodeOut>{})
+            .Attr("merge_op", "Add")
+            .Attr("final_op", "Id")
+            .Finalize(item.graph.add_node()));
+  }
+  SetShapes(&item.graph);
+
+  ScopedAllocatorOptions opts;
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+  EXPECT_EQ(CountOps(optimized_graph, "_ScopedAllocator"), 1);
+  const NodeDef* combined = nullptr;
+  for (const NodeDef& node : optimized_graph.node()) {
+    if (node.op() == "CollectiveReduceV2") {
+      ASSERT_EQ(combined, nullptr);
+      combined = &node;
+    }
+  }
+  ASSERT_NE(combined, nullptr);
+  // The combined op takes its keys from the first op.
+  ASSERT_GE(combined->input_size(), 4);
+  EXPECT_EQ(combined->input(1), "gs1");
+  EXPECT_EQ(combined->input(2), "gk1");
+  EXPECT_EQ(combined->input(3), "ik1");
+}
 #endif  // ENABLE_MKL
 
 }  // namespace
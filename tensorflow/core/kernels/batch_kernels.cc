@@ -53,6 +53,7 @@ constexpr char kMaxInflightBatchesAttr[] = "_max_inflight_batches";
 constexpr char kBatchesToAverageOverAttr[] = "_batches_to_average_over";
 constexpr char kFullBatchSchedulingBoostMicros[] =
     "_full_batch_scheduling_boost_micros";
+constexpr char kEnableRaggedBatchingAttr[] = "_enable_ragged_batching";
 
 // Default thread count in the per-process batching thread pool.
 constexpr int64_t kBatchThreadPoolSize = 128;
@@ -155,6 +156,7 @@ class BatchResource : public serving::BatchResourceBase {
                        int32_t max_enqueued_batches,
                        const std::vector<int32>& allowed_batch_sizes,
                        bool enable_large_batch_splitting,
+                       bool enable_ragged_batching,
                        std::unique_ptr<BatchResource>* resource) {
     BatcherT::Options batcher_options;
     batcher_options.num_batch_threads = num_batch_threads;
@@ -167,7 +169,7 @@ class BatchResource : public serving::BatchResourceBase {
             num_batch_threads, max_execution_batch_size, batch_timeout_micros,
             max_enqueued_batches, allowed_batch_sizes,
             enable_large_batch_splitting, /*disable_padding=*/false),
-        allowed_batch_sizes));
+        allowed_batch_sizes, enable_ragged_batching));
     return OkStatus();
   }
 
@@ -177,7 +179,7 @@ class BatchResource : public serving::BatchResourceBase {
       int32_t max_batch_size, int32_t batch_timeout_micros,
       int32_t max_enqueued_batches,
       const std::vector<int32>& allowed_batch_sizes,
-      std::unique_ptr<BatchResource>* resource) {
+      bool enable_ragged_batching, std::unique_ptr<BatchResource>* resource) {
     std::shared_ptr<AdaptiveBatcherT> batcher;
     TF_RETURN_IF_ERROR(AdaptiveBatcherT::Create(
         adaptive_shared_batch_scheduler_options, &batcher));
@@ -188,7 +190,7 @@ class BatchResource : public serving::BatchResourceBase {
             max_batch_size, batch_timeout_micros, max_enqueued_batches,
             true /* enable large batch split */, allowed_batch_sizes,
             /*disable_padding=*/false),
-        allowed_batch_sizes));
+        allowed_batch_sizes, enable_ragged_batching));
     return OkStatus();
   }
 
@@ -198,18 +200,22 @@ class BatchResource : public serving::BatchResourceBase {
   BatchResource(bool has_process_batch_function,
                 std::shared_ptr<BatcherT> batcher,
                 const BatcherT::QueueOptions& batcher_queue_options,
-                std::vector<int32> allowed_batch_sizes)
+                std::vector<int32> allowed_batch_sizes,
+                bool enable_ragged_batching)
       : BatchResourceBase(has_process_batch_function, std::move(batcher),
                           batcher_queue_options,
-                          std::move(allowed_batch_sizes)) {}
+                          std::move(allowed_batch_sizes),
+                          enable_ragged_batching) {}
 
   BatchResource(bool has_process_batch_function,
                 std::shared_ptr<AdaptiveBatcherT> batcher,
                 const AdaptiveBatcherT::QueueOptions& batcher_queue_options,
-                std::vector<int32> allowed_batch_sizes)
+                std::vector<int32> allowed_batch_sizes,
+                bool enable_ragged_batching)
       : BatchResourceBase(has_process_batch_function, std::move(batcher),
                           batcher_queue_options,
-                          std::move(allowed_batch_sizes)) {}
+                          std::move(allowed_batch_sizes),
+                          enable_ragged_batching) {}
 
   void ProcessFuncBatchImpl(
       const serving::BatchResourceBase::BatchTask& last_task,
@@ -267,6 +273,11 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
     has_attribute_enable_large_batch_splitting_ = false;
   }
 
+  if (c->HasAttr(kEnableRaggedBatchingAttr)) {
+    OP_REQUIRES_OK(c, c->GetAttr(kEnableRaggedBatchingAttr,
+                                 &enable_ragged_batching_));
+  }
+
   // Helper function `SetAdaptiveBatchSchedulerOptions` calls
   // `OP_REQUIRES_OK`, which exits the current function upon error.
   // So validate status of `op-kernel-construction`.
@@ -352,7 +363,7 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
           /*has_process_batch_function=*/true,
           adaptive_shared_batch_scheduler_options, max_batch_size_,
           batch_timeout_micros_, max_enqueued_batches_, allowed_batch_sizes_,
-          &new_resource));
+          enable_ragged_batching_, &new_resource));
       *r = new_resource.release();
       return OkStatus();
     };
@@ -362,7 +373,8 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
       TF_RETURN_IF_ERROR(BatchResource::Create(
           /*has_process_batch_function=*/true, num_batch_threads_,
           max_batch_size_, batch_timeout_micros_, max_enqueued_batches_,
-          allowed_batch_sizes_, enable_large_batch_splitting_, &new_resource));
+          allowed_batch_sizes_, enable_large_batch_splitting_,
+          enable_ragged_batching_, &new_resource));
       *r = new_resource.release();
       return OkStatus();
     };
@@ -420,6 +432,10 @@ Status BatchFunctionKernel::InstantiateFunction(
     } else {
       // Currently, inputs are on CPU since they are concatenated on CPU
       opts.input_devices.push_back(cpu_device->name());
+      if (enable_ragged_batching_) {
+        // The row splits of the ragged input.
+        opts.input_devices.push_back(cpu_device->name());
+      }
     }
   }
   OpInputList captured_tensors;
@@ -595,7 +611,8 @@ class BatchKernel : public AsyncOpKernel {
       TF_RETURN_IF_ERROR(BatchResource::Create(
           /*has_process_batch_function=*/false, num_batch_threads_,
           max_batch_size_, batch_timeout_micros_, max_enqueued_batches_,
-          allowed_batch_sizes_, false, &new_resource));
+          allowed_batch_sizes_, false, /*enable_ragged_batching=*/false,
+          &new_resource));
       *r = new_resource.release();
       return OkStatus();
     };
@@ -94,6 +94,9 @@ class BatchFunctionKernel : public AsyncOpKernel {
   bool enable_large_batch_splitting_;
   bool has_attribute_enable_large_batch_splitting_;
   bool enable_adaptive_batch_threads_ = false;
+  // If true, every input is passed to the function as packed values and row
+  // splits, without padding. See BatchResourceBase.
+  bool enable_ragged_batching_ = false;
 
   mutex mu_;
 
@@ -771,6 +771,7 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
       // Can't fit within current batch, close it off and try to create another.
       if (current_batch_ &&
           current_batch_->size() + task->size() > options_.max_batch_size) {
+        current_batch_->set_dispatch_trigger(BatchDispatchTrigger::kFull);
         current_batch_->Close();
         closed_batch = true;
         current_batch_ = nullptr;
@@ -805,6 +806,7 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
            current_batch_->num_tasks() >= options_.max_tasks_per_batch.value());
       if (current_batch_->size() == options_.max_batch_size ||
           reached_max_tasks) {
+        current_batch_->set_dispatch_trigger(BatchDispatchTrigger::kFull);
         current_batch_->Close();
         closed_batch = true;
         current_batch_ = nullptr;
@@ -828,6 +830,8 @@ void ASBSQueue<TaskType>::ReleaseBatch(const ASBSBatch<TaskType>* batch) {
   num_enqueued_batches_--;
   num_enqueued_tasks_ -= batch->num_tasks();
   if (batch == current_batch_) {
+    // The batch is released while still open, i.e. underfull.
+    current_batch_->set_dispatch_trigger(BatchDispatchTrigger::kTimeout);
     current_batch_->Close();
     current_batch_ = nullptr;
   }
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batching_util/batch_resource_base.h"
 
+#include <cstring>
 #include <sstream>
 
 #include "absl/strings/str_cat.h"
@@ -201,6 +202,58 @@ void RecordBatchParamAllowedBatchSizes(const string& allowed_batch_sizes,
   cell->GetCell(model_name, op_name)->Set(allowed_batch_sizes);
 }
 
+void RecordPaddingFraction(double padding_fraction, const string& model_name,
+                           const string& op_name) {
+  static auto* cell = tensorflow::monitoring::Sampler<2>::New(
+      {"/tensorflow/serving/batching/padding_fraction",
+       "Tracks the fraction of each processed batch that is padding, by "
+       "model_name (if available).",
+       "model_name", "op_name"},
+      monitoring::Buckets::Explicit(
+          {0.05, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9}));
+  cell->GetCell(model_name, op_name)->Add(padding_fraction);
+}
+
+void RecordBatchProcessingUs(int64_t batch_processing_us,
+                             const string& model_name, const string& op_name,
+                             int32_t batch_size) {
+  static auto* cell = tensorflow::monitoring::Sampler<3>::New(
+      {"/tensorflow/serving/batching/batch_processing_us",
+       "Tracks the time (in microseconds) the batch function takes to process "
+       "a batch, by model_name (if available).",
+       "model_name", "op_name", "processed_batch_size"},
+      // It's 27 buckets with the last bucket being 2^26 to DBL_MAX;
+      // so the limits are [1, 2, 4, 8, ..., 64 * 1024 * 1024, DBL_MAX].
+      monitoring::Buckets::Exponential(1, 2, 27));
+  cell->GetCell(model_name, op_name, std::to_string(batch_size))
+      ->Add(static_cast<double>(batch_processing_us));
+}
+
+void RecordBatchDispatchTrigger(BatchDispatchTrigger dispatch_trigger,
+                                const string& model_name,
+                                const string& op_name) {
+  static auto* cell = monitoring::Counter<3>::New(
+      "/tensorflow/serving/batching/batch_dispatch_trigger",
+      "Tracks what made the scheduler dispatch a batch (full, timeout, "
+      "queue_closed or unknown), by model_name (if available).",
+      "model_name", "op_name", "trigger");
+  const char* trigger = "unknown";
+  switch (dispatch_trigger) {
+    case BatchDispatchTrigger::kFull:
+      trigger = "full";
+      break;
+    case BatchDispatchTrigger::kTimeout:
+      trigger = "timeout";
+      break;
+    case BatchDispatchTrigger::kQueueClosed:
+      trigger = "queue_closed";
+      break;
+    case BatchDispatchTrigger::kUnknown:
+      break;
+  }
+  cell->GetCell(model_name, op_name, trigger)->IncrementBy(1);
+}
+
 const string& GetModelName(OpKernelContext* ctx) {
   static string* kModelNameUnset = new string("model_name_unset");
   if (!ctx->session_metadata()) return *kModelNameUnset;
@@ -208,6 +261,36 @@ const string& GetModelName(OpKernelContext* ctx) {
   return ctx->session_metadata()->name();
 }
 
+// Copies the inputs of 'task' into the rows of 'staging' following the ones
+// written so far, and makes the inputs of 'task' views of the copies. Returns
+// false, leaving 'task' untouched, if the inputs do not fit.
+bool CopyIntoStagingBuffer(BatchResourceBase::BatchTask* task,
+                           BatchResourceBase::BatchStagingBuffer* staging) {
+  if (task->inputs.size() != staging->inputs.size()) return false;
+  const int64_t begin = staging->num_rows;
+  const int64_t end = begin + task->size();
+  for (int i = 0; i < task->inputs.size(); ++i) {
+    const Tensor& input = task->inputs[i];
+    const Tensor& buffer = staging->inputs[i];
+    if (input.dtype() != buffer.dtype() || input.dims() != buffer.dims() ||
+        end > buffer.dim_size(0)) {
+      return false;
+    }
+    for (int d = 1; d < input.dims(); ++d) {
+      if (input.dim_size(d) != buffer.dim_size(d)) return false;
+    }
+  }
+  for (int i = 0; i < task->inputs.size(); ++i) {
+    Tensor slot = staging->inputs[i].Slice(begin, end);
+    const StringPiece input_data = task->inputs[i].tensor_data();
+    std::memcpy(const_cast<char*>(slot.tensor_data().data()),
+                input_data.data(), input_data.size());
+    task->inputs[i] = std::move(slot);
+  }
+  staging->num_rows = end;
+  return true;
+}
+
 }  // namespace
 
 std::unique_ptr<BatchResourceBase::BatchTask>
@@ -227,6 +310,7 @@ BatchResourceBase::BatchTask::CreateSplitTask(
   task->is_partial = true;
   task->start_time = this->start_time;
   task->request_cost = this->request_cost;
+  task->task_priority = this->task_priority;
 
   return task;
 }
@@ -464,6 +548,51 @@ Status BatchResourceBase::ConcatInputTensors(
                              context->op_kernel().name());
   RecordBatchSize(batch.size(), GetModelName(context),
                   context->op_kernel().name());
+  const int applied_padding_amount = disable_padding_ ? 0 : padding_amount;
+  RecordPaddingFraction(
+      static_cast<double>(applied_padding_amount) / padded_batch_size,
+      GetModelName(context), context->op_kernel().name());
+  RecordBatchDispatchTrigger(batch.dispatch_trigger(), GetModelName(context),
+                             context->op_kernel().name());
+
+  if (enable_ragged_batching_) {
+    return ConcatRaggedInputTensors(batch, context,
+                                    disable_padding_ ? 0 : padding_amount,
+                                    concatenated_tensors);
+  }
+
+  const int64_t num_rows =
+      batch.size() + (disable_padding_ ? 0 : padding_amount);
+
+  // A single task needs neither concatenation nor padding.
+  if (num_rows == batch.size() && batch.num_tasks() == 1) {
+    *concatenated_tensors = batch.task(0).inputs;
+    return OkStatus();
+  }
+
+  // If every task was staged at enqueue time, the batch is already laid out
+  // in the staging buffer; only the padding is left to write.
+  const std::shared_ptr<BatchStagingBuffer>& staging = batch.task(0).staging;
+  bool all_tasks_staged = staging != nullptr &&
+                          staging->num_rows == batch.size() &&
+                          num_rows <= staging->inputs[0].dim_size(0);
+  for (int task_idx = 1; all_tasks_staged && task_idx < batch.num_tasks();
+       ++task_idx) {
+    all_tasks_staged = batch.task(task_idx).staging == staging;
+  }
+  if (all_tasks_staged) {
+    concatenated_tensors->reserve(staging->inputs.size());
+    for (const Tensor& buffer : staging->inputs) {
+      // Use the first row as the data for padding, as below.
+      const int64_t row_bytes = buffer.TotalBytes() / buffer.dim_size(0);
+      char* data = const_cast<char*>(buffer.tensor_data().data());
+      for (int64_t row = batch.size(); row < num_rows; ++row) {
+        std::memcpy(data + row * row_bytes, data, row_bytes);
+      }
+      concatenated_tensors->push_back(buffer.Slice(0, num_rows));
+    }
+    return OkStatus();
+  }
 
   // All tasks should have the same number of input edges.
   const int num_inputs = batch.task(0).inputs.size();
@@ -508,6 +637,102 @@ Status BatchResourceBase::ConcatInputTensors(
   return OkStatus();
 }
 
+void BatchResourceBase::StageTask(BatchTask* task, BatchT* open_batch) const {
+  const int num_tasks = open_batch->num_tasks();
+  if (num_tasks == 0) {
+    return;
+  }
+  if (num_tasks == 1) {
+    // The second task joins the batch; stage the first one along with it.
+    BatchTask* first_task = open_batch->mutable_task(0);
+    const int64_t max_batch_size =
+        batcher_queue_options_.enable_large_batch_splitting
+            ? batcher_queue_options_.max_execution_batch_size
+            : batcher_queue_options_.input_batch_size_limit;
+    auto staging = std::make_shared<BatchStagingBuffer>();
+    staging->inputs.reserve(first_task->inputs.size());
+    for (const Tensor& input : first_task->inputs) {
+      if (!DataTypeCanUseMemcpy(input.dtype())) {
+        return;
+      }
+      TensorShape buffer_shape = input.shape();
+      buffer_shape.set_dim(0, max_batch_size);
+      Tensor buffer;
+      AllocatorAttributes attr;
+      attr.set_on_host(true);
+      if (!task->context
+               ->allocate_temp(input.dtype(), buffer_shape, &buffer, attr)
+               .ok()) {
+        return;
+      }
+      staging->inputs.push_back(std::move(buffer));
+    }
+    if (!CopyIntoStagingBuffer(first_task, staging.get())) {
+      return;
+    }
+    first_task->staging = std::move(staging);
+  }
+  const BatchTask& last_task = open_batch->task(num_tasks - 1);
+  if (last_task.staging != nullptr &&
+      CopyIntoStagingBuffer(task, last_task.staging.get())) {
+    task->staging = last_task.staging;
+  }
+}
+
+Status BatchResourceBase::ConcatRaggedInputTensors(
+    const BatchT& batch, OpKernelContext* context, int padding_amount,
+    std::vector<Tensor>* concatenated_tensors) const {
+  // All tasks should have the same number of input edges.
+  const int num_inputs = batch.task(0).inputs.size();
+  concatenated_tensors->reserve(2 * num_inputs);
+
+  for (int i = 0; i < num_inputs; ++i) {
+    // Views the ith input of every task as the values of its sequences, packed
+    // along the 0th dimension, and records where the sequences start.
+    std::vector<Tensor> to_concatenate;
+    to_concatenate.reserve(batch.num_tasks());
+    Tensor row_splits(DT_INT64, TensorShape({static_cast<int64_t>(
+                                    batch.size() + padding_amount + 1)}));
+    auto row_splits_vec = row_splits.vec<int64_t>();
+    int64_t row = 0;
+    row_splits_vec(row) = 0;
+    for (int task_idx = 0; task_idx < batch.num_tasks(); ++task_idx) {
+      const Tensor& input = batch.task(task_idx).inputs.at(i);
+      if (input.dims() < 2) {
+        return errors::InvalidArgument(
+            "Ragged batching requires inputs with at least 2 dimensions, but "
+            "input ",
+            i, " has shape ", input.shape().DebugString(), ".");
+      }
+      const int64_t num_sequences = input.dim_size(0);
+      const int64_t sequence_length = input.dim_size(1);
+      TensorShape values_shape = input.shape();
+      values_shape.RemoveDim(0);
+      values_shape.set_dim(0, num_sequences * sequence_length);
+      Tensor values;
+      if (!values.CopyFrom(input, values_shape)) {
+        return errors::Internal("Cannot view input ", i, " of shape ",
+                                input.shape().DebugString(), " as shape ",
+                                values_shape.DebugString());
+      }
+      to_concatenate.push_back(std::move(values));
+      for (int64_t j = 0; j < num_sequences; ++j, ++row) {
+        row_splits_vec(row + 1) = row_splits_vec(row) + sequence_length;
+      }
+    }
+    // Padding sequences are empty.
+    for (int j = 0; j < padding_amount; ++j, ++row) {
+      row_splits_vec(row + 1) = row_splits_vec(row);
+    }
+
+    Tensor concatenated_tensor;
+    TF_RETURN_IF_ERROR(Concat(context, to_concatenate, &concatenated_tensor));
+    concatenated_tensors->push_back(std::move(concatenated_tensor));
+    concatenated_tensors->push_back(std::move(row_splits));
+  }
+  return OkStatus();
+}
+
 /*static*/ Status BatchResourceBase::SplitInputTask(
     std::unique_ptr<BatchTask>* input_task_ptr, int open_batch_remaining_slot,
     int max_batch_size, std::vector<std::unique_ptr<BatchTask>>* output_tasks) {
@@ -611,6 +836,10 @@ Status BatchResourceBase::SplitOutputTensors(
                             batch->num_tasks());
   }
 
+  if (enable_ragged_batching_) {
+    return SplitRaggedOutputTensors(combined_outputs, batch);
+  }
+
   std::vector<int64_t> task_sizes_plus_optional_padding;
   task_sizes_plus_optional_padding.reserve(batch->num_tasks());
   for (int i = 0; i < batch->num_tasks(); ++i) {
@@ -678,6 +907,77 @@ Status BatchResourceBase::SplitOutputTensors(
   return OkStatus();
 }
 
+Status BatchResourceBase::SplitRaggedOutputTensors(
+    const std::vector<Tensor>& combined_outputs, BatchT* batch) const {
+  // Every output has one row per packed value of the 0th input. Padding
+  // sequences are empty, so they have no rows.
+  std::vector<int64_t> task_num_values;
+  task_num_values.reserve(batch->num_tasks());
+  int64_t num_values = 0;
+  for (int i = 0; i < batch->num_tasks(); ++i) {
+    const Tensor& input = batch->task(i).inputs[0];
+    task_num_values.push_back(input.dim_size(0) * input.dim_size(1));
+    num_values += task_num_values.back();
+  }
+
+  DCHECK_EQ(batch->task(0).context->num_outputs(), combined_outputs.size());
+  int combined_outputs_size = combined_outputs.size();
+  if (combined_outputs_size != batch->task(0).context->num_outputs()) {
+    return errors::Internal("Wrong number of batched output tensors");
+  }
+
+  for (int i = 0; i < combined_outputs_size; ++i) {
+    const Tensor& output_tensor = combined_outputs[i];
+    if (output_tensor.shape().dims() == 0) {
+      return errors::FailedPrecondition(
+          "Batched output tensor has 0 dimensions");
+    }
+    if (output_tensor.shape().dim_size(0) != num_values) {
+      return errors::FailedPrecondition(
+          "Batched output tensor's 0th dimension does not equal the number of "
+          "packed values of the 0th ragged input");
+    }
+
+    std::vector<Tensor> split_tensor;
+    const Status split_status =
+        tensor::Split(output_tensor, task_num_values, &split_tensor);
+    if (!split_status.ok()) {
+      return errors::Internal("Tensor split operation failed: ",
+                              split_status.error_message());
+    }
+    if (split_tensor.size() != task_num_values.size()) {
+      return errors::Internal(
+          "Tensor split operation did not work as expected; got ",
+          split_tensor.size(), " splits; expected ", task_num_values.size());
+    }
+
+    for (int j = 0; j < batch->num_tasks(); ++j) {
+      BatchTask& task = *(batch->mutable_task(j));
+      // Restores the [num_sequences, sequence_length] leading dimensions of
+      // the task.
+      TensorShape task_shape({task.inputs[0].dim_size(0),
+                              task.inputs[0].dim_size(1)});
+      for (int d = 1; d < output_tensor.dims(); ++d) {
+        task_shape.AddDim(output_tensor.dim_size(d));
+      }
+      Tensor task_output;
+      if (!task_output.CopyFrom(split_tensor[j], task_shape)) {
+        return errors::Internal("Cannot view split output of shape ",
+                                split_tensor[j].shape().DebugString(),
+                                " as shape ", task_shape.DebugString());
+      }
+      if (task.is_partial) {
+        std::vector<Tensor>& tensor_vector = (*task.output)[task.split_index];
+        tensor_vector[i] = std::move(task_output);
+      } else {
+        task.context->set_output(i, task_output);
+      }
+    }
+  }
+
+  return OkStatus();
+}
+
 void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
   if (batch->empty()) {
     return;
@@ -761,6 +1061,10 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
   finally.release();
   ProcessFuncBatchImpl(
       last_task, args, &combined_outputs, [&](const Status& run_status) {
+        RecordBatchProcessingUs((EnvTime::NowNanos() - current_time) * 1e-3,
+                                model_name,
+                                last_task_context->op_kernel().name(),
+                                processed_size);
         Status final_status;
         auto run_finally = gtl::MakeCleanup([&]() {
           // We do the cleanup here as an optimization, so that
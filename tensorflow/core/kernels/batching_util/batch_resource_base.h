@@ -40,6 +40,15 @@ namespace serving {
 
 // Base class for resource that encapsulating the state and logic for batching
 // tensors.
+//
+// With ragged batching, the inputs of a task have shape
+// [num_sequences, sequence_length, ...], and the sequence length may differ
+// between tasks. Instead of padding the sequences to a common length, every
+// input is passed to the batch function as two tensors: the values of all
+// sequences packed along the 0th dimension, and the int64 row splits of the
+// sequences. Every output of the batch function must have one row per packed
+// value of the 0th input, and is split back into the sequences of the tasks.
+// Padding to 'allowed_batch_sizes' only appends empty sequences.
 class BatchResourceBase : public ResourceBase {
  public:
   // Given a BatchTask (from one op invocation) with 'num_outputs'== M and
@@ -48,6 +57,17 @@ class BatchResourceBase : public ResourceBase {
   // concatenating tensors along the 2nd dimension gives a output tensor.
   typedef std::vector<std::vector<Tensor>> TensorMatrix;
 
+  // Inputs of the tasks of one batch, copied in one after another as the tasks
+  // are enqueued, so that the batch needs no concatenation when processed.
+  struct BatchStagingBuffer {
+    // One tensor per batch input, with room for a full batch along the 0th
+    // dimension.
+    std::vector<Tensor> inputs;
+
+    // The number of rows written so far.
+    int64_t num_rows = 0;
+  };
+
   // One task to be batched, corresponds to a `slice` of input from one batch-op
   // invocation.
   //
@@ -88,8 +108,17 @@ class BatchResourceBase : public ResourceBase {
 
     uint64 start_time;
 
+    // If set, `inputs` are slices of `staging`, which also holds the inputs of
+    // the tasks enqueued before this one into the same batch.
+    std::shared_ptr<BatchStagingBuffer> staging;
+
     size_t size() const override { return inputs[0].shape().dim_size(0); }
 
+    // The priority of the task; split tasks inherit it.
+    TaskPriority task_priority = TaskPriority::kHigh;
+
+    TaskPriority priority() const override { return task_priority; }
+
     // Create a split task from this one. The caller needs to setup the inputs
     // of the new task
     std::unique_ptr<BatchTask> CreateSplitTask(
@@ -124,24 +153,35 @@ class BatchResourceBase : public ResourceBase {
   BatchResourceBase(bool has_process_batch_function,
                     std::shared_ptr<BatcherT> batcher,
                     const BatcherT::QueueOptions& batcher_queue_options,
-                    std::vector<int32> allowed_batch_sizes)
+                    std::vector<int32> allowed_batch_sizes,
+                    bool enable_ragged_batching = false)
       : has_process_batch_function_(has_process_batch_function),
         batcher_(std::move(batcher)),
         batcher_queue_options_(batcher_queue_options),
         allowed_batch_sizes_(std::move(allowed_batch_sizes)),
         allowed_batch_sizes_str_(absl::StrJoin(allowed_batch_sizes_, ",")),
-        disable_padding_(batcher_queue_options.disable_padding) {}
+        disable_padding_(batcher_queue_options.disable_padding),
+        enable_ragged_batching_(enable_ragged_batching) {
+    if (!enable_ragged_batching_) {
+      batcher_queue_options_.stage_task_func = [this](BatchTask* task,
+                                                      BatchT* open_batch) {
+        StageTask(task, open_batch);
+      };
+    }
+  }
 
   BatchResourceBase(bool has_process_batch_function,
                     std::shared_ptr<AdaptiveBatcherT> batcher,
                     const AdaptiveBatcherT::QueueOptions& batcher_queue_options,
-                    std::vector<int32> allowed_batch_sizes)
+                    std::vector<int32> allowed_batch_sizes,
+                    bool enable_ragged_batching = false)
       : has_process_batch_function_(has_process_batch_function),
         adaptive_batcher_(std::move(batcher)),
         adaptive_batcher_queue_options_(batcher_queue_options),
         allowed_batch_sizes_(std::move(allowed_batch_sizes)),
         allowed_batch_sizes_str_(absl::StrJoin(allowed_batch_sizes_, ",")),
-        disable_padding_(batcher_queue_options.disable_padding) {}
+        disable_padding_(batcher_queue_options.disable_padding),
+        enable_ragged_batching_(enable_ragged_batching) {}
 
   using CreateBatchTaskFn =
       std::function<StatusOr<std::unique_ptr<BatchTask>>()>;
@@ -222,9 +262,28 @@ class BatchResourceBase : public ResourceBase {
   Status ConcatInputTensors(const BatchT& batch, OpKernelContext* context,
                             std::vector<Tensor>* concatenated_tensors) const;
 
+  // Copies the inputs of 'task', which is about to join 'open_batch', into the
+  // staging buffer of the batch. The buffer is created when the second task
+  // joins, so that a batch of a single task is never copied. Leaves 'task' as
+  // is if its inputs cannot be staged, in which case ConcatInputTensors()
+  // concatenates the batch as usual.
+  void StageTask(BatchTask* task, BatchT* open_batch) const;
+
+  // Packs the inputs of the tasks for ragged batching, adding
+  // 'padding_amount' empty sequences. Emits the values and the row splits of
+  // every input.
+  Status ConcatRaggedInputTensors(
+      const BatchT& batch, OpKernelContext* context, int padding_amount,
+      std::vector<Tensor>* concatenated_tensors) const;
+
   Status SplitOutputTensors(const std::vector<Tensor>& combined_outputs,
                             BatchT* batch) const;
 
+  // Splits the packed outputs of ragged batching into the sequences of the
+  // tasks.
+  Status SplitRaggedOutputTensors(const std::vector<Tensor>& combined_outputs,
+                                  BatchT* batch) const;
+
   void ProcessFuncBatch(std::unique_ptr<BatchT> batch) const;
 
   // Processes a batch of one or more BatchTask entries.
@@ -269,6 +328,10 @@ class BatchResourceBase : public ResourceBase {
 
   // If true, the padding will not be appended.
   bool disable_padding_;
+
+  // If true, the inputs are packed without padding the sequences. See the
+  // class comment.
+  const bool enable_ragged_batching_;
 };
 
 }  // namespace serving
@@ -46,6 +46,13 @@ limitations under the License.
 namespace tensorflow {
 namespace serving {
 
+// The priority of a task. See SharedBatchScheduler::QueueOptions::
+// enable_priority_queue.
+enum class TaskPriority {
+  kHigh,
+  kLow,
+};
+
 // The abstract superclass for a unit of work to be done as part of a batch.
 //
 // An implementing subclass typically contains (or points to):
@@ -64,6 +71,21 @@ class BatchTask {
   // Returns the size of the task, in terms of how much it contributes to the
   // size of a batch. (A batch's size is the sum of its task sizes.)
   virtual size_t size() const = 0;
+
+  // Returns the priority of the task.
+  virtual TaskPriority priority() const { return TaskPriority::kHigh; }
+};
+
+// What made a scheduler dispatch a batch.
+enum class BatchDispatchTrigger {
+  // The scheduler does not record it.
+  kUnknown,
+  // The batch reached its size limit, or the next task did not fit in it.
+  kFull,
+  // The batch reached its timeout.
+  kTimeout,
+  // The queue of the batch was closed.
+  kQueueClosed,
 };
 
 // A thread-safe collection of BatchTasks, to be executed together in some
@@ -125,6 +147,13 @@ class Batch {
   // Returns the TraceMe context id of this batch.
   uint64 traceme_context_id() const;
 
+  // Returns what made the scheduler dispatch the batch.
+  BatchDispatchTrigger dispatch_trigger() const;
+
+  // Records what made the scheduler dispatch the batch. Called by schedulers,
+  // typically right before closing the batch.
+  void set_dispatch_trigger(BatchDispatchTrigger dispatch_trigger);
+
  private:
   mutable mutex mu_;
 
@@ -142,6 +171,9 @@ class Batch {
   // The TracMe context id.
   const uint64 traceme_context_id_;
 
+  BatchDispatchTrigger dispatch_trigger_ TF_GUARDED_BY(mu_) =
+      BatchDispatchTrigger::kUnknown;
+
   TF_DISALLOW_COPY_AND_ASSIGN(Batch);
 };
 
@@ -325,6 +357,19 @@ uint64 Batch<TaskType>::traceme_context_id() const {
   return traceme_context_id_;
 }
 
+template <typename TaskType>
+BatchDispatchTrigger Batch<TaskType>::dispatch_trigger() const {
+  mutex_lock l(mu_);
+  return dispatch_trigger_;
+}
+
+template <typename TaskType>
+void Batch<TaskType>::set_dispatch_trigger(
+    BatchDispatchTrigger dispatch_trigger) {
+  mutex_lock l(mu_);
+  dispatch_trigger_ = dispatch_trigger;
+}
+
 }  // namespace serving
 }  // namespace tensorflow
 
@@ -0,0 +1,137 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_size_controller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace serving {
+
+namespace {
+
+// The 99th percentile of the standard normal distribution.
+constexpr double kP99StddevMultiplier = 2.33;
+
+// Folds `sample` into the moving average `mean` and variance `variance`.
+void UpdateMovingStats(double sample, double alpha, double* mean,
+                       double* variance) {
+  const double diff = sample - *mean;
+  const double increment = alpha * diff;
+  *mean += increment;
+  *variance = (1 - alpha) * (*variance + diff * increment);
+}
+
+}  // namespace
+
+BatchSizeController::BatchSizeController(const Options& options)
+    : options_(options) {
+  DCHECK_GT(options_.latency_slo_micros, 0);
+  DCHECK_GT(options_.max_batch_size, 0);
+  DCHECK_GT(options_.smoothing_factor, 0);
+  DCHECK_LE(options_.smoothing_factor, 1);
+  buckets_.resize(BucketIndex(options_.max_batch_size) + 1);
+}
+
+int BatchSizeController::BucketIndex(int batch_size) {
+  int index = 0;
+  while ((1 << index) < batch_size) ++index;
+  return index;
+}
+
+int BatchSizeController::BucketBatchSize(int index) const {
+  return std::min(1 << index, options_.max_batch_size);
+}
+
+void BatchSizeController::RecordArrival(uint64 now_micros, int size) {
+  if (size <= 0) return;
+  if (has_arrival_ && now_micros >= last_arrival_micros_) {
+    const double sample =
+        static_cast<double>(now_micros - last_arrival_micros_) / size;
+    if (micros_per_unit_ < 0) {
+      micros_per_unit_ = sample;
+    } else {
+      micros_per_unit_ +=
+          options_.smoothing_factor * (sample - micros_per_unit_);
+    }
+  }
+  has_arrival_ = true;
+  last_arrival_micros_ = now_micros;
+  UpdateDecision();
+}
+
+void BatchSizeController::RecordBatchLatency(int batch_size,
+                                             int64_t latency_micros) {
+  if (batch_size <= 0) return;
+  const int index = BucketIndex(std::min(batch_size, options_.max_batch_size));
+  LatencyStats& stats = buckets_[index];
+  const double sample =
+      static_cast<double>(std::max<int64_t>(latency_micros, 0));
+  if (!stats.observed) {
+    stats.mean = sample;
+    stats.variance = 0;
+    stats.observed = true;
+  } else {
+    UpdateMovingStats(sample, options_.smoothing_factor, &stats.mean,
+                      &stats.variance);
+  }
+  UpdateDecision();
+}
+
+double BatchSizeController::EstimatedLatencyMicros(int batch_size) const {
+  const int index = BucketIndex(std::min(batch_size, options_.max_batch_size));
+  auto p99 = [](const LatencyStats& stats) {
+    return stats.mean + kP99StddevMultiplier * std::sqrt(stats.variance);
+  };
+  if (buckets_[index].observed) return p99(buckets_[index]);
+  // Extrapolate linearly from the nearest smaller observed bucket.
+  for (int i = index - 1; i >= 0; --i) {
+    if (buckets_[i].observed) {
+      return p99(buckets_[i]) * batch_size / BucketBatchSize(i);
+    }
+  }
+  // A smaller batch is assumed to be no slower than a larger one.
+  for (int i = index + 1; i < buckets_.size(); ++i) {
+    if (buckets_[i].observed) return p99(buckets_[i]);
+  }
+  return -1;
+}
+
+void BatchSizeController::UpdateDecision() {
+  const double slo = options_.latency_slo_micros;
+  int batch_size = 1;
+  int64_t batch_timeout_micros = 0;
+  for (int i = 0; i < buckets_.size(); ++i) {
+    const int candidate = BucketBatchSize(i);
+    const double latency = EstimatedLatencyMicros(candidate);
+    if (latency < 0 || latency > slo) break;
+    if (candidate > 1) {
+      if (micros_per_unit_ < 0) break;
+      // The first task of the batch waits for the remaining ones to arrive.
+      const double fill_micros = (candidate - 1) * micros_per_unit_;
+      if (fill_micros + latency > slo) break;
+    }
+    batch_size = candidate;
+    batch_timeout_micros = static_cast<int64_t>(slo - latency);
+  }
+  batch_size_ = batch_size;
+  batch_timeout_micros_ = batch_timeout_micros;
+}
+
+}  // namespace serving
+}  // namespace tensorflow
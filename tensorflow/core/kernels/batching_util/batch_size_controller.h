@@ -0,0 +1,115 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SIZE_CONTROLLER_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SIZE_CONTROLLER_H_
+
+#include <vector>
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Learns online how the processing latency of a batch depends on its size, and
+// picks the batch size and batch timeout a queue should use to form batches
+// that are as large as possible while the p99 latency of a task (time spent
+// waiting for its batch to fill plus time spent processing the batch) stays
+// within a latency SLO.
+//
+// Batch sizes are grouped into power-of-two buckets. Per bucket the controller
+// keeps exponentially weighted moving averages of the mean and variance of the
+// observed processing latency, and estimates the p99 latency as
+// mean + 2.33 * stddev. A bucket that has not been observed yet is
+// extrapolated from the nearest smaller observed bucket assuming latency grows
+// linearly with batch size; that is pessimistic for models that batch well, so
+// the chosen batch size grows a bucket at a time as evidence accumulates.
+//
+// The task arrival rate is tracked the same way, and the chosen batch size is
+// the largest one whose expected fill time plus p99 processing latency fit in
+// the SLO. The chosen timeout is the SLO slack left after processing, so a
+// batch that fills more slowly than expected is still dispatched in time.
+// Since all statistics decay, the choice follows changes in load and in model
+// cost.
+//
+// Not thread-safe.
+class BatchSizeController {
+ public:
+  struct Options {
+    // The p99 latency target of a task, in microseconds. Must be positive.
+    int64_t latency_slo_micros = 0;
+
+    // Upper bound of the chosen batch size. Must be positive.
+    int max_batch_size = 0;
+
+    // Weight of a new sample in the moving averages, in (0, 1].
+    double smoothing_factor = 0.05;
+  };
+
+  explicit BatchSizeController(const Options& options);
+
+  // Records that tasks of total size `size` were enqueued at `now_micros`.
+  void RecordArrival(uint64 now_micros, int size);
+
+  // Records that processing a batch of size `batch_size` took
+  // `latency_micros`.
+  void RecordBatchLatency(int batch_size, int64_t latency_micros);
+
+  // The size at which the open batch should be dispatched.
+  int batch_size() const { return batch_size_; }
+
+  // How long the open batch may wait for more tasks, in microseconds.
+  int64_t batch_timeout_micros() const { return batch_timeout_micros_; }
+
+  // Returns the estimated p99 processing latency of a batch of size
+  // `batch_size` in microseconds, or a negative value if no batch has been
+  // observed yet.
+  double EstimatedLatencyMicros(int batch_size) const;
+
+ private:
+  struct LatencyStats {
+    double mean = 0;
+    double variance = 0;
+    bool observed = false;
+  };
+
+  // Returns the index of the bucket holding batches of size `batch_size`.
+  static int BucketIndex(int batch_size);
+
+  // Returns the largest batch size falling in bucket `index`.
+  int BucketBatchSize(int index) const;
+
+  // Recomputes `batch_size_` and `batch_timeout_micros_`.
+  void UpdateDecision();
+
+  const Options options_;
+
+  // Processing latency statistics, indexed by BucketIndex().
+  std::vector<LatencyStats> buckets_;
+
+  // Moving average of the time between the arrival of two consecutive units
+  // of work; negative until two arrivals have been recorded.
+  double micros_per_unit_ = -1;
+  uint64 last_arrival_micros_ = 0;
+  bool has_arrival_ = false;
+
+  int batch_size_ = 1;
+  int64_t batch_timeout_micros_ = 0;
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SIZE_CONTROLLER_H_
@@ -0,0 +1,113 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_size_controller.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+BatchSizeController::Options MakeOptions(int64_t latency_slo_micros,
+                                         int max_batch_size) {
+  BatchSizeController::Options options;
+  options.latency_slo_micros = latency_slo_micros;
+  options.max_batch_size = max_batch_size;
+  options.smoothing_factor = 0.5;
+  return options;
+}
+
+// Records arrivals of single tasks every `interval_micros`.
+void RecordArrivals(int num_arrivals, uint64 interval_micros,
+                    BatchSizeController* controller, uint64* now_micros) {
+  for (int i = 0; i < num_arrivals; ++i) {
+    *now_micros += interval_micros;
+    controller->RecordArrival(*now_micros, 1);
+  }
+}
+
+TEST(BatchSizeControllerTest, DispatchesImmediatelyWithoutObservations) {
+  BatchSizeController controller(MakeOptions(1000, 16));
+  EXPECT_EQ(controller.batch_size(), 1);
+  EXPECT_EQ(controller.batch_timeout_micros(), 0);
+  EXPECT_LT(controller.EstimatedLatencyMicros(1), 0);
+}
+
+TEST(BatchSizeControllerTest, ExtrapolatesLinearlyFromSmallerBuckets) {
+  BatchSizeController controller(MakeOptions(1000, 16));
+  controller.RecordBatchLatency(2, 100);
+  EXPECT_DOUBLE_EQ(controller.EstimatedLatencyMicros(2), 100);
+  EXPECT_DOUBLE_EQ(controller.EstimatedLatencyMicros(8), 400);
+  // Smaller batches are assumed to be no slower.
+  EXPECT_DOUBLE_EQ(controller.EstimatedLatencyMicros(1), 100);
+}
+
+TEST(BatchSizeControllerTest, GrowsBatchSizeWithinSlo) {
+  BatchSizeController controller(MakeOptions(1000, 16));
+  uint64 now_micros = 0;
+  RecordArrivals(10, 10, &controller, &now_micros);
+  // Latency is nearly constant, so bigger batches are cheap.
+  for (int batch_size : {1, 2, 4, 8, 16}) {
+    controller.RecordBatchLatency(batch_size, 200);
+  }
+  EXPECT_EQ(controller.batch_size(), 16);
+  EXPECT_EQ(controller.batch_timeout_micros(), 800);
+}
+
+TEST(BatchSizeControllerTest, ShrinksBatchSizeWhenLatencyGrows) {
+  BatchSizeController controller(MakeOptions(1000, 16));
+  uint64 now_micros = 0;
+  RecordArrivals(10, 10, &controller, &now_micros);
+  for (int batch_size : {1, 2, 4, 8, 16}) {
+    controller.RecordBatchLatency(batch_size, 200);
+  }
+  ASSERT_EQ(controller.batch_size(), 16);
+
+  // Batches of 16 and 8 become too slow to meet the SLO.
+  for (int i = 0; i < 20; ++i) {
+    controller.RecordBatchLatency(16, 5000);
+    controller.RecordBatchLatency(8, 2000);
+  }
+  EXPECT_EQ(controller.batch_size(), 4);
+  EXPECT_EQ(controller.batch_timeout_micros(), 800);
+}
+
+TEST(BatchSizeControllerTest, LimitsBatchSizeByArrivalRate) {
+  BatchSizeController controller(MakeOptions(1000, 16));
+  for (int batch_size : {1, 2, 4, 8, 16}) {
+    controller.RecordBatchLatency(batch_size, 200);
+  }
+  // Without an arrival rate estimate only single tasks are dispatched.
+  EXPECT_EQ(controller.batch_size(), 1);
+
+  // One task every 200us: filling a batch of 4 takes 600us, and 8 would take
+  // 1400us, which exceeds the SLO.
+  uint64 now_micros = 0;
+  RecordArrivals(10, 200, &controller, &now_micros);
+  EXPECT_EQ(controller.batch_size(), 4);
+  EXPECT_EQ(controller.batch_timeout_micros(), 800);
+}
+
+TEST(BatchSizeControllerTest, DispatchesImmediatelyWhenSloIsUnreachable) {
+  BatchSizeController controller(MakeOptions(1000, 16));
+  controller.RecordBatchLatency(1, 2000);
+  EXPECT_EQ(controller.batch_size(), 1);
+  EXPECT_EQ(controller.batch_timeout_micros(), 0);
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
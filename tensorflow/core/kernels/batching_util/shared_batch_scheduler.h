@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <deque>
 #include <functional>
 #include <list>
@@ -31,6 +32,7 @@ limitations under the License.
 #include "absl/utility/utility.h"
 #include "tensorflow/core/kernels/batching_util/batch_input_task.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/batch_size_controller.h"
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -100,9 +102,13 @@ namespace serving {
 // For bulk processing jobs and throughput-oriented benchmarks, you may want to
 // set the maximum queue size to a large value.
 //
-// TODO(b/26539183): Support queue servicing policies other than round-robin.
-// E.g. let each queue specify a "share" (an int >= 1), so e.g. with queues A
-// and B having shares 1 and 2 respectively, the servicing pattern is ABBABB...
+// Each queue may specify a "share" (an int >= 1), the number of consecutive
+// batches taken from it before moving on; e.g. with queues A and B having
+// shares 1 and 2 respectively, the servicing pattern is ABBABB...
+//
+// A queue may also batch low-priority tasks separately from the others, in a
+// second queue with its own options and share; see
+// QueueOptions::enable_priority_queue.
 //
 //
 // PERFORMANCE TUNING: See README.md.
@@ -221,6 +227,55 @@ class SharedBatchScheduler
 
     // If true, the padding will not be appended.
     bool disable_padding = false;
+
+    // If set, invoked with the queue lock held for every task (after any
+    // eager split) right before it is added to `open_batch`. Lets the caller
+    // lay out the data of the tasks of a batch at enqueue time, instead of
+    // when the batch is processed. Not invoked if `enable_lazy_split` is true.
+    std::function<void(TaskType* task, Batch<TaskType>* open_batch)>
+        stage_task_func;
+
+    // If positive, the queue learns online how batch processing latency
+    // depends on batch size and picks the size at which the open batch is
+    // dispatched, and its timeout, to make batches as large as possible while
+    // keeping the p99 latency of a task (queueing plus processing, in
+    // microseconds) within this value. `batch_timeout_micros` is then ignored
+    // and `max_execution_batch_size` bounds the chosen size. If no batch
+    // thread is free when the chosen size is reached, the open batch keeps
+    // growing as usual. See BatchSizeController for details.
+    //
+    // Disabled if 0. Must be non-negative.
+    int64_t latency_slo_micros = 0;
+
+    // The number of consecutive batches the batch threads take from this
+    // queue, when it has batches to offer, before moving on to the next one.
+    // Must be positive.
+    int scheduling_share = 1;
+
+    // Options of the queue of low-priority tasks. See `enable_priority_queue`.
+    struct PriorityQueueOptions {
+      size_t input_batch_size_limit = 1000;
+      int64_t batch_timeout_micros = 0;
+      size_t max_enqueued_batches = 10;
+      size_t max_execution_batch_size = 1000;
+      int scheduling_share = 1;
+    };
+
+    // If true, tasks whose priority() is TaskPriority::kLow are batched in a
+    // queue of their own, configured by `low_priority_queue_options` and
+    // otherwise like this one, so that they never delay the batches of the
+    // other tasks by more than the batch threads' share given to them. The
+    // SchedulingCapacity() and max_task_size() of the returned queue refer to
+    // the high-priority tasks.
+    //
+    // Must be false if `enable_lazy_split` is true.
+    bool enable_priority_queue = false;
+    PriorityQueueOptions low_priority_queue_options;
+
+    // If true, when an open batch of high-priority tasks is dispatched with
+    // room to spare, the most recently enqueued low-priority tasks that fit
+    // are moved into it. Used iff `enable_priority_queue` is true.
+    bool fill_with_low_priority_tasks = false;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -267,6 +322,10 @@ class SharedBatchScheduler
   // available batch thread should grab work.
   typename QueueList::iterator next_queue_to_schedule_ TF_GUARDED_BY(mu_);
 
+  // The number of consecutive batches taken from 'next_queue_to_schedule_',
+  // which moves on once it reaches the queue's scheduling share.
+  int num_batches_from_next_queue_ TF_GUARDED_BY(mu_) = 0;
+
   // Used by idle batch threads to wait for work to enter the system. Notified
   // whenever a batch becomes schedulable.
   condition_variable schedulable_batch_cv_;
@@ -369,6 +428,20 @@ class Queue {
 
   bool closed() const TF_NO_THREAD_SAFETY_ANALYSIS { return closed_.load(); }
 
+  int scheduling_share() const { return options_.scheduling_share; }
+
+  // Makes the open batches of this queue take tasks from the open batch of
+  // `low_priority_queue` when they are dispatched with room to spare. Must be
+  // called before any task is scheduled; `low_priority_queue` must outlive
+  // the tasks of this queue.
+  void set_low_priority_queue(Queue<TaskType>* low_priority_queue) {
+    low_priority_queue_ = low_priority_queue;
+  }
+
+  // Moves the most recently enqueued tasks of the open batch into `batch`, as
+  // long as `batch` stays within `batch_size_limit`.
+  void MoveOpenBatchTasksInto(Batch<TaskType>* batch, size_t batch_size_limit);
+
  private:
   // Computes the max_execution_batch_size of the queue based on queue options.
   static size_t GetMaxExecutionBatchSize(
@@ -389,9 +462,10 @@ class Queue {
   // Same as IsEmpty(), but assumes the caller already holds a lock on 'mu_'.
   bool IsEmptyInternal() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
-  // Closes the open batch residing at the back of std::deque, and inserts a
-  // fresh open batch behind it.
-  void StartNewBatch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Closes the open batch residing at the back of std::deque, recording
+  // `dispatch_trigger` on it, and inserts a fresh open batch behind it.
+  void StartNewBatch(BatchDispatchTrigger dispatch_trigger)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Split `input task` into `output_tasks` according to 'task_sizes'.
   Status SplitInputBatchIntoSubtasks(
@@ -408,6 +482,10 @@ class Queue {
   bool IsOpenBatchSchedulableAfterEagerSplit() const
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns what made the open batch schedulable. Requires that it is.
+  BatchDispatchTrigger OpenBatchDispatchTrigger() const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Same as SchedulingCapacity(), but assumes the caller already holds a
   // lock on 'mu_'.
   size_t SchedulingCapacityInternal() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -424,6 +502,13 @@ class Queue {
   // Returns the number of enqueued batches.
   int64 num_enqueued_batches() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // The size at which the open batch becomes schedulable.
+  size_t open_batch_target_size() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // How long the open batch may wait for more tasks before it becomes
+  // schedulable.
+  int64_t open_batch_timeout_micros() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const typename SharedBatchScheduler<TaskType>::QueueOptions options_;
 
   // The environment to use.
@@ -442,8 +527,17 @@ class Queue {
   // schedulable.
   SchedulableBatchCallback schedulable_batch_callback_;
 
+  // The queue whose tasks fill the spare room of the batches of this queue,
+  // or null.
+  Queue<TaskType>* low_priority_queue_ = nullptr;
+
   mutable mutex mu_;
 
+  // Picks the open batch target size and timeout when
+  // `options_.latency_slo_micros` is positive; null otherwise.
+  std::unique_ptr<BatchSizeController> batch_size_controller_
+      TF_GUARDED_BY(mu_);
+
   // Whether this queue can accept new tasks. This variable is monotonic: it
   // starts as false, and then at some point gets set to true and remains true
   // for the duration of this object's life.
@@ -495,8 +589,10 @@ class Queue {
 template <typename TaskType>
 class QueueHandle : public BatchScheduler<TaskType> {
  public:
-  QueueHandle(std::shared_ptr<SharedBatchScheduler<TaskType>> scheduler,
-              Queue<TaskType>* queue);
+  QueueHandle(
+      std::shared_ptr<SharedBatchScheduler<TaskType>> scheduler,
+      Queue<TaskType>* queue,
+      std::unique_ptr<BatchScheduler<TaskType>> low_priority_queue = nullptr);
   ~QueueHandle() override;
 
   Status Schedule(std::unique_ptr<TaskType>* task) override;
@@ -505,6 +601,8 @@ class QueueHandle : public BatchScheduler<TaskType> {
 
   size_t max_task_size() const override { return queue_->max_task_size(); }
 
+  Queue<TaskType>* queue() const { return queue_; }
+
  private:
   // The scheduler that owns 'queue_'.
   std::shared_ptr<SharedBatchScheduler<TaskType>> scheduler_;
@@ -513,6 +611,11 @@ class QueueHandle : public BatchScheduler<TaskType> {
   // least until this class's destructor closes it.
   Queue<TaskType>* queue_;
 
+  // The handle of the queue of low-priority tasks, or null. Destroyed, and
+  // thereby closed, after 'queue_' is closed, since 'queue_' may process its
+  // tasks.
+  std::unique_ptr<BatchScheduler<TaskType>> low_priority_queue_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(QueueHandle);
 };
 
@@ -591,6 +694,20 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         "max_enqueued_batches must be positive; was ",
         options.max_enqueued_batches);
   }
+  if (options.latency_slo_micros < 0) {
+    return errors::InvalidArgument(
+        "latency_slo_micros must be non-negative; was ",
+        options.latency_slo_micros);
+  }
+  if (options.scheduling_share < 1) {
+    return errors::InvalidArgument("scheduling_share must be positive; was ",
+                                   options.scheduling_share);
+  }
+  if (options.enable_priority_queue && options.enable_lazy_split) {
+    return errors::InvalidArgument(
+        "enable_priority_queue should be enabled only if enable_lazy_split is "
+        "disabled.");
+  }
 
   if (options.enable_large_batch_splitting &&
       options.split_input_task_func == nullptr) {
@@ -616,6 +733,28 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         options.max_execution_batch_size);
   }
 
+  std::unique_ptr<BatchScheduler<TaskType>> low_priority_queue;
+  if (options.enable_priority_queue) {
+    const typename QueueOptions::PriorityQueueOptions& low_priority_options =
+        options.low_priority_queue_options;
+    QueueOptions low_priority_queue_options = options;
+    low_priority_queue_options.input_batch_size_limit =
+        low_priority_options.input_batch_size_limit;
+    low_priority_queue_options.batch_timeout_micros =
+        low_priority_options.batch_timeout_micros;
+    low_priority_queue_options.max_enqueued_batches =
+        low_priority_options.max_enqueued_batches;
+    low_priority_queue_options.max_execution_batch_size =
+        low_priority_options.max_execution_batch_size;
+    low_priority_queue_options.scheduling_share =
+        low_priority_options.scheduling_share;
+    low_priority_queue_options.enable_priority_queue = false;
+    low_priority_queue_options.fill_with_low_priority_tasks = false;
+    TF_RETURN_IF_ERROR(AddQueueAfterRewritingOptions(
+        low_priority_queue_options, process_batch_callback,
+        &low_priority_queue));
+  }
+
   auto schedulable_batch_callback = [this] {
     mutex_lock l(mu_);
     schedulable_batch_cv_.notify_one();
@@ -624,9 +763,15 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
       std::unique_ptr<internal::Queue<TaskType>>(new internal::Queue<TaskType>(
           options, options_.env, process_batch_callback,
           schedulable_batch_callback));
+  if (low_priority_queue != nullptr && options.fill_with_low_priority_tasks) {
+    internal_queue->set_low_priority_queue(
+        static_cast<internal::QueueHandle<TaskType>*>(low_priority_queue.get())
+            ->queue());
+  }
   auto handle = std::unique_ptr<BatchScheduler<TaskType>>(
       new internal::QueueHandle<TaskType>(this->shared_from_this(),
-                                          internal_queue.get()));
+                                          internal_queue.get(),
+                                          std::move(low_priority_queue)));
   {
     mutex_lock l(mu_);
     queues_.push_back(std::move(internal_queue));
@@ -693,8 +838,14 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
       // We've encountered a closed queue with no work to do. Drop it.
       DCHECK_NE(queue_for_batch, next_queue_to_schedule_->get());
       next_queue_to_schedule_ = queues_.erase(next_queue_to_schedule_);
+      num_batches_from_next_queue_ = 0;
+    } else if (BatchExists(batch_to_process) &&
+               ++num_batches_from_next_queue_ <
+                   (*next_queue_to_schedule_)->scheduling_share()) {
+      // Stay on this queue until it has used up its share.
     } else {
       ++next_queue_to_schedule_;
+      num_batches_from_next_queue_ = 0;
     }
     if (next_queue_to_schedule_ == queues_.end() && !queues_.empty()) {
       // We've hit the end. Wrap to the first queue.
@@ -741,6 +892,7 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
     for (int i = 0; i < task_handles.size(); i++) {
       batch_to_schedule->AddTask(std::move(task_handles[i]->GetSplitTask()));
     }
+    batch_to_schedule->set_dispatch_trigger(ptr->dispatch_trigger());
     batch_to_schedule->Close();
 
   } else {
@@ -770,6 +922,13 @@ Queue<TaskType>::Queue(
   // the same traceme_context_id_counter_.
   traceme_context_id_counter_ = (absl::GetCurrentTimeNanos() & 0xFFFFFFFF)
                                 << 32;
+  if (options_.latency_slo_micros > 0) {
+    BatchSizeController::Options controller_options;
+    controller_options.latency_slo_micros = options_.latency_slo_micros;
+    controller_options.max_batch_size = max_execution_batch_size_;
+    batch_size_controller_ =
+        std::make_unique<BatchSizeController>(controller_options);
+  }
   // Create an initial, open batch.
   if (options_.enable_lazy_split) {
     task_handle_batches_.emplace_back(
@@ -822,6 +981,10 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
     DCHECK(!closed_);
 
     TF_RETURN_IF_ERROR(ValidateBatchTaskQueueCapacity((*task).get()));
+    if (batch_size_controller_ != nullptr) {
+      batch_size_controller_->RecordArrival(env_->NowMicros(),
+                                            (*task)->size());
+    }
 
     const int64 open_batch_capacity =
         max_execution_batch_size - this->tail_batch_task_size();
@@ -836,7 +999,7 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
     for (int i = 0; i < task_handles.size(); ++i) {
       if (task_handle_batches_.back()->size() + task_handles[i]->size() >
           options_.max_execution_batch_size) {
-        StartNewBatch();
+        StartNewBatch(BatchDispatchTrigger::kFull);
       }
       if (task_handle_batches_.back()->empty()) {
         open_batch_start_time_micros_ = env_->NowMicros();
@@ -893,6 +1056,10 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
     // Add test coverage when when concurrent incoming batches arrives and
     // use up all queue capacity.
     TF_RETURN_IF_ERROR(ValidateBatchTaskQueueCapacity((*task).get()));
+    if (batch_size_controller_ != nullptr) {
+      batch_size_controller_->RecordArrival(env_->NowMicros(),
+                                            (*task)->size());
+    }
 
     const int64_t open_batch_remaining_slot =
         max_execution_batch_size() - batches_.back()->size();
@@ -912,7 +1079,7 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
     for (int i = 0; i < output_tasks.size(); ++i) {
       if (batches_.back()->size() + output_tasks[i]->size() >
           max_execution_batch_size()) {
-        StartNewBatch();
+        StartNewBatch(BatchDispatchTrigger::kFull);
       }
       if (batches_.back()->empty()) {
         open_batch_start_time_micros_ = env_->NowMicros();
@@ -924,6 +1091,9 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
           },
           profiler::ContextType::kSharedBatchScheduler,
           batches_.back()->traceme_context_id());
+      if (options_.stage_task_func != nullptr) {
+        options_.stage_task_func(output_tasks[i].get(), batches_.back().get());
+      }
       batches_.back()->AddTask(std::move(output_tasks[i]));
     }
 
@@ -1032,7 +1202,11 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
 
     // Consider closing the open batch at this time, to schedule it.
     if (batches_.size() == 1 && IsOpenBatchSchedulable()) {
-      StartNewBatch();
+      if (low_priority_queue_ != nullptr) {
+        low_priority_queue_->MoveOpenBatchTasksInto(batches_.back().get(),
+                                                    max_execution_batch_size());
+      }
+      StartNewBatch(OpenBatchDispatchTrigger());
     }
 
     if (batches_.size() >= 2) {
@@ -1064,7 +1238,7 @@ Queue<TaskType>::ScheduleBatch() {
 
     // Consider closing the open batch at this time, to schedule it.
     if (task_handle_batches_.size() == 1 && IsOpenBatchSchedulable()) {
-      StartNewBatch();
+      StartNewBatch(OpenBatchDispatchTrigger());
     }
 
     if (task_handle_batches_.size() >= 2) {
@@ -1090,10 +1264,17 @@ void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
       },
       profiler::ContextType::kSharedBatchScheduler,
       batch->traceme_context_id());
+  const int batch_size = batch->size();
+  const uint64 start_time_micros = env_->NowMicros();
   process_batch_callback_(std::move(batch));
+  const uint64 end_time_micros = env_->NowMicros();
 
   {
     mutex_lock l(mu_);
+    if (batch_size_controller_ != nullptr) {
+      batch_size_controller_->RecordBatchLatency(
+          batch_size, end_time_micros - start_time_micros);
+    }
     --num_batches_being_processed_;
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
@@ -1101,6 +1282,19 @@ void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
   }
 }
 
+template <typename TaskType>
+void Queue<TaskType>::MoveOpenBatchTasksInto(Batch<TaskType>* batch,
+                                             size_t batch_size_limit) {
+  mutex_lock l(mu_);
+  DCHECK(!options_.enable_lazy_split);
+  Batch<TaskType>* open_batch = batches_.back().get();
+  while (!open_batch->empty() &&
+         batch->size() + open_batch->task(open_batch->num_tasks() - 1).size() <=
+             batch_size_limit) {
+    batch->AddTask(open_batch->RemoveTask());
+  }
+}
+
 template <typename TaskType>
 bool Queue<TaskType>::IsEmpty() const {
   mutex_lock l(mu_);
@@ -1135,13 +1329,15 @@ bool Queue<TaskType>::IsEmptyInternal() const {
 }
 
 template <typename TaskType>
-void Queue<TaskType>::StartNewBatch() {
+void Queue<TaskType>::StartNewBatch(BatchDispatchTrigger dispatch_trigger) {
   if (options_.enable_lazy_split) {
+    task_handle_batches_.back()->set_dispatch_trigger(dispatch_trigger);
     task_handle_batches_.back()->Close();
     task_handle_batches_.emplace_back(new Batch<BatchInputTaskHandle<TaskType>>(
         ++traceme_context_id_counter_));
     return;
   }
+  batches_.back()->set_dispatch_trigger(dispatch_trigger);
   batches_.back()->Close();
   batches_.emplace_back(new Batch<TaskType>(++traceme_context_id_counter_));
 }
@@ -1163,9 +1359,9 @@ bool Queue<TaskType>::IsOpenBatchSchedulableAfterEagerSplit() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
+  return closed_ || open_batch->size() >= open_batch_target_size() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + open_batch_timeout_micros();
 }
 
 template <typename TaskType>
@@ -1178,9 +1374,37 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
+  return closed_ || open_batch->size() >= open_batch_target_size() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + open_batch_timeout_micros();
+}
+
+template <typename TaskType>
+BatchDispatchTrigger Queue<TaskType>::OpenBatchDispatchTrigger() const {
+  if (closed_) {
+    return BatchDispatchTrigger::kQueueClosed;
+  }
+  if (tail_batch_task_size() >= open_batch_target_size()) {
+    return BatchDispatchTrigger::kFull;
+  }
+  return BatchDispatchTrigger::kTimeout;
+}
+
+template <typename TaskType>
+size_t Queue<TaskType>::open_batch_target_size() const {
+  if (batch_size_controller_ != nullptr) {
+    return std::min<size_t>(batch_size_controller_->batch_size(),
+                            max_execution_batch_size());
+  }
+  return max_execution_batch_size();
+}
+
+template <typename TaskType>
+int64_t Queue<TaskType>::open_batch_timeout_micros() const {
+  if (batch_size_controller_ != nullptr) {
+    return batch_size_controller_->batch_timeout_micros();
+  }
+  return options_.batch_timeout_micros;
 }
 
 template <typename TaskType>
@@ -1203,8 +1427,11 @@ int64 Queue<TaskType>::num_enqueued_batches() const {
 template <typename TaskType>
 QueueHandle<TaskType>::QueueHandle(
     std::shared_ptr<SharedBatchScheduler<TaskType>> scheduler,
-    Queue<TaskType>* queue)
-    : scheduler_(scheduler), queue_(queue) {}
+    Queue<TaskType>* queue,
+    std::unique_ptr<BatchScheduler<TaskType>> low_priority_queue)
+    : scheduler_(scheduler),
+      queue_(queue),
+      low_priority_queue_(std::move(low_priority_queue)) {}
 
 template <typename TaskType>
 QueueHandle<TaskType>::~QueueHandle() {
@@ -1213,11 +1440,18 @@ QueueHandle<TaskType>::~QueueHandle() {
 
 template <typename TaskType>
 Status QueueHandle<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
+  if (low_priority_queue_ != nullptr &&
+      (*task)->priority() == TaskPriority::kLow) {
+    return low_priority_queue_->Schedule(task);
+  }
   return queue_->Schedule(task);
 }
 
 template <typename TaskType>
 size_t QueueHandle<TaskType>::NumEnqueuedTasks() const {
+  if (low_priority_queue_ != nullptr) {
+    return queue_->NumEnqueuedTasks() + low_priority_queue_->NumEnqueuedTasks();
+  }
   return queue_->NumEnqueuedTasks();
 }
 
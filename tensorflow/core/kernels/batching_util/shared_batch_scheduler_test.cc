@@ -44,14 +44,18 @@ using ::testing::HasSubstr;
 
 class FakeTask : public BatchTask {
  public:
-  explicit FakeTask(size_t size) : size_(size) {}
+  explicit FakeTask(size_t size, TaskPriority priority = TaskPriority::kHigh)
+      : size_(size), priority_(priority) {}
 
   ~FakeTask() override = default;
 
   size_t size() const override { return size_; }
 
+  TaskPriority priority() const override { return priority_; }
+
  private:
   const size_t size_;
+  const TaskPriority priority_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FakeTask);
 };
@@ -66,8 +70,9 @@ using SplitFunc =
 
 // Creates a FakeTask of size 'task_size', and calls 'scheduler->Schedule()' on
 // that task. Returns the resulting status.
-Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler) {
-  std::unique_ptr<FakeTask> task(new FakeTask(task_size));
+Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler,
+                    TaskPriority priority = TaskPriority::kHigh) {
+  std::unique_ptr<FakeTask> task(new FakeTask(task_size, priority));
   Status status = scheduler->Schedule(&task);
   // Schedule() should have consumed 'task' iff it returned Status::OK.
   CHECK_EQ(status.ok(), task == nullptr);
@@ -339,14 +344,17 @@ TEST_P(SharedBatchSchedulerTest, ObeysTimeout) {
     auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
       ASSERT_TRUE(batch->IsClosed());
       if (notify_first_batch && (!first_batch_processed.HasBeenNotified())) {
+        EXPECT_EQ(batch->dispatch_trigger(), BatchDispatchTrigger::kTimeout);
         first_batch_processed.Notify();
         return;
       }
       if (notify_second_batch && (!second_batch_processed.HasBeenNotified())) {
+        EXPECT_EQ(batch->dispatch_trigger(), BatchDispatchTrigger::kFull);
         second_batch_processed.Notify();
         return;
       }
       if (notify_third_batch && (!third_batch_processed.HasBeenNotified())) {
+        EXPECT_EQ(batch->dispatch_trigger(), BatchDispatchTrigger::kTimeout);
         third_batch_processed.Notify();
         return;
       }
@@ -793,6 +801,195 @@ TEST_P(SharedBatchSchedulerTest, ZeroQueueRewrittenToOneQueue) {
   }
 }
 
+// Tests that a queue with a latency SLO dispatches tasks right away, instead of
+// waiting for `batch_timeout_micros`, until it has learned that larger batches
+// fit in the SLO.
+TEST_P(SharedBatchSchedulerTest, LatencySloOverridesBatchTimeout) {
+  mutex mu;
+  std::vector<int> batch_sizes;
+  Notification batches_processed;
+  auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    mutex_lock l(mu);
+    batch_sizes.push_back(batch->size());
+    if (batch_sizes.size() == 2) batches_processed.Notify();
+  };
+
+  auto scheduler = CreateSharedBatchScheduler(1);
+
+  const size_t input_batch_size_limit = 10;
+  const size_t batch_timeout_micros = 3600LL * 1000 * 1000;  // 1 hour
+  const size_t max_enqueued_batches = 2;
+  QueueOptions options =
+      CreateQueueOptions(input_batch_size_limit, input_batch_size_limit,
+                         batch_timeout_micros, max_enqueued_batches);
+  options.latency_slo_micros = 10 * 1000;  // 10 milliseconds
+  {
+    auto queue = CreateQueue(scheduler, options, callback);
+    TF_ASSERT_OK(ScheduleTask(3, queue.get()));
+    Env::Default()->SleepForMicroseconds(100 * 1000 /* 100 milliseconds */);
+    TF_ASSERT_OK(ScheduleTask(2, queue.get()));
+    batches_processed.WaitForNotification();
+  }
+  mutex_lock l(mu);
+  EXPECT_EQ(batch_sizes, std::vector<int>({3, 2}));
+}
+
+// Tests that `stage_task_func` sees every task, right before it joins the open
+// batch.
+TEST_P(SharedBatchSchedulerTest, StageTaskFuncSeesOpenBatch) {
+  if (enable_lazy_split()) {
+    GTEST_SKIP() << "stage_task_func is not invoked with lazy split.";
+  }
+  mutex mu;
+  std::vector<std::pair<int, int>> staged;  // (task size, open batch size)
+  Notification batch_processed;
+  auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    EXPECT_EQ(batch->size(), 4);
+    batch_processed.Notify();
+  };
+
+  auto scheduler = CreateSharedBatchScheduler(1);
+
+  const size_t input_batch_size_limit = 4;
+  const size_t batch_timeout_micros = 3600LL * 1000 * 1000;  // 1 hour
+  const size_t max_enqueued_batches = 2;
+  QueueOptions options =
+      CreateQueueOptions(input_batch_size_limit, input_batch_size_limit,
+                         batch_timeout_micros, max_enqueued_batches);
+  options.stage_task_func = [&](FakeTask* task, Batch<FakeTask>* open_batch) {
+    mutex_lock l(mu);
+    staged.emplace_back(task->size(), open_batch->size());
+  };
+  {
+    auto queue = CreateQueue(scheduler, options, callback);
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(3, queue.get()));
+    batch_processed.WaitForNotification();
+  }
+  mutex_lock l(mu);
+  EXPECT_EQ(staged, (std::vector<std::pair<int, int>>({{1, 0}, {3, 1}})));
+}
+
+// Returns options of a queue whose high-priority batches wait for an hour,
+// and whose low-priority ones are dispatched right away.
+QueueOptions CreatePriorityQueueOptions(QueueOptions options) {
+  options.batch_timeout_micros = 3600LL * 1000 * 1000;  // 1 hour
+  options.enable_priority_queue = true;
+  options.low_priority_queue_options.input_batch_size_limit =
+      options.input_batch_size_limit;
+  options.low_priority_queue_options.max_execution_batch_size =
+      options.max_execution_batch_size;
+  options.low_priority_queue_options.batch_timeout_micros = 0;
+  return options;
+}
+
+TEST_P(SharedBatchSchedulerTest, PriorityQueueBatchesLowPriorityTasksApart) {
+  if (enable_lazy_split()) {
+    GTEST_SKIP() << "enable_priority_queue requires enable_lazy_split=false.";
+  }
+  mutex mu;
+  std::vector<std::vector<TaskPriority>> batches;
+  Notification low_priority_batch_processed;
+  auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    mutex_lock l(mu);
+    batches.emplace_back();
+    for (int i = 0; i < batch->num_tasks(); ++i) {
+      batches.back().push_back(batch->task(i).priority());
+    }
+    if (!low_priority_batch_processed.HasBeenNotified()) {
+      low_priority_batch_processed.Notify();
+    }
+  };
+
+  auto scheduler = CreateSharedBatchScheduler(1);
+  QueueOptions options = CreatePriorityQueueOptions(
+      CreateQueueOptions(/*max_execution_batch_size=*/10,
+                         /*input_batch_size_limit=*/10,
+                         /*batch_timeout_micros=*/0,
+                         /*max_enqueued_batches=*/2));
+  {
+    auto queue = CreateQueue(scheduler, options, callback);
+    TF_ASSERT_OK(ScheduleTask(1, queue.get(), TaskPriority::kHigh));
+    TF_ASSERT_OK(ScheduleTask(2, queue.get(), TaskPriority::kLow));
+    // The low-priority task doesn't wait for the high-priority batch.
+    low_priority_batch_processed.WaitForNotification();
+  }
+  mutex_lock l(mu);
+  EXPECT_EQ(batches, (std::vector<std::vector<TaskPriority>>(
+                         {{TaskPriority::kLow}, {TaskPriority::kHigh}})));
+}
+
+TEST_P(SharedBatchSchedulerTest, FillWithLowPriorityTasks) {
+  if (enable_lazy_split()) {
+    GTEST_SKIP() << "enable_priority_queue requires enable_lazy_split=false.";
+  }
+  mutex mu;
+  std::vector<size_t> batch_sizes;
+  Notification batch_processed;
+  auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    mutex_lock l(mu);
+    batch_sizes.push_back(batch->size());
+    if (!batch_processed.HasBeenNotified()) batch_processed.Notify();
+  };
+
+  auto scheduler = CreateSharedBatchScheduler(1);
+  QueueOptions options = CreatePriorityQueueOptions(
+      CreateQueueOptions(/*max_execution_batch_size=*/10,
+                         /*input_batch_size_limit=*/10,
+                         /*batch_timeout_micros=*/0,
+                         /*max_enqueued_batches=*/2));
+  // Swap the timeouts: low-priority tasks wait, high-priority ones don't.
+  options.low_priority_queue_options.batch_timeout_micros =
+      options.batch_timeout_micros;
+  options.batch_timeout_micros = 0;
+  options.fill_with_low_priority_tasks = true;
+  {
+    auto queue = CreateQueue(scheduler, options, callback);
+    TF_ASSERT_OK(ScheduleTask(8, queue.get(), TaskPriority::kLow));
+    TF_ASSERT_OK(ScheduleTask(2, queue.get(), TaskPriority::kLow));
+    TF_ASSERT_OK(ScheduleTask(3, queue.get(), TaskPriority::kHigh));
+    batch_processed.WaitForNotification();
+  }
+  // Only the most recent low-priority task fits in the high-priority batch.
+  mutex_lock l(mu);
+  EXPECT_EQ(batch_sizes, std::vector<size_t>({5, 8}));
+}
+
+TEST_P(SharedBatchSchedulerTest, InvalidSchedulingShare) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {
+    // do nothing.
+  };
+
+  auto scheduler = CreateSharedBatchScheduler(2);
+
+  QueueOptions options = CreateQueueOptions(10, 10, 0, 2);
+  options.scheduling_share = 0;
+  std::unique_ptr<Queue> queue;
+  EXPECT_THAT(scheduler->AddQueue(options, callback, &queue),
+              testing::StatusIs(error::INVALID_ARGUMENT,
+                                "scheduling_share must be positive; was 0"));
+}
+
+TEST_P(SharedBatchSchedulerTest, InvalidLatencySlo) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {
+    // do nothing.
+  };
+
+  auto scheduler = CreateSharedBatchScheduler(2);
+
+  QueueOptions options = CreateQueueOptions(10, 10, 0, 2);
+  options.latency_slo_micros = -1;
+  std::unique_ptr<Queue> queue;
+  EXPECT_THAT(scheduler->AddQueue(options, callback, &queue),
+              testing::StatusIs(error::INVALID_ARGUMENT,
+                                "latency_slo_micros must be non-negative; "
+                                "was -1"));
+}
+
 // TODO(b/161857471):
 // Add test coverage when input-split and no-split returns differently.
 INSTANTIATE_TEST_SUITE_P(
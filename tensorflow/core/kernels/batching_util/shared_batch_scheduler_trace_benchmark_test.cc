@@ -0,0 +1,273 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks SharedBatchScheduler by replaying a recorded trace of task
+// arrivals, and reports task latency, batch size and how batches were
+// dispatched (full vs. timeout).
+//
+// The trace given by --arrival_trace is a text file with one arrival per
+// line, "<offset_micros>[,<task_size>]", where 'offset_micros' is the arrival
+// time relative to the start of the trace. Lines starting with '#' are
+// ignored. Without a trace, a synthetic Poisson arrival process is replayed.
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+using ::tensorflow::histogram::Histogram;
+
+// Path of the arrival trace to replay. Empty means a synthetic trace.
+static std::string arrival_trace_path;
+
+// Parameters of the synthetic trace.
+static int synthetic_trace_qps = 5000;
+static int synthetic_trace_duration_secs = 10;
+
+struct Arrival {
+  int64_t offset_micros;
+  int size;
+};
+
+std::vector<Arrival> LoadArrivalTrace() {
+  std::vector<Arrival> trace;
+  if (arrival_trace_path.empty()) {
+    std::mt19937 rng(/*seed=*/42);
+    std::exponential_distribution<double> interval_micros(synthetic_trace_qps /
+                                                          1e6);
+    const int64_t duration_micros = synthetic_trace_duration_secs * 1000000LL;
+    for (double t = 0; t < duration_micros; t += interval_micros(rng)) {
+      trace.push_back({static_cast<int64_t>(t), 1});
+    }
+    return trace;
+  }
+
+  std::string contents;
+  TF_CHECK_OK(ReadFileToString(Env::Default(), arrival_trace_path, &contents));
+  for (absl::string_view line : absl::StrSplit(contents, '\n')) {
+    if (line.empty() || line[0] == '#') continue;
+    std::vector<absl::string_view> fields = absl::StrSplit(line, ',');
+    Arrival arrival{0, 1};
+    CHECK(absl::SimpleAtoi(fields[0], &arrival.offset_micros))
+        << "Malformed trace line: " << line;
+    if (fields.size() > 1) {
+      CHECK(absl::SimpleAtoi(fields[1], &arrival.size) && arrival.size > 0)
+          << "Malformed trace line: " << line;
+    }
+    trace.push_back(arrival);
+  }
+  std::stable_sort(trace.begin(), trace.end(),
+                   [](const Arrival& a, const Arrival& b) {
+                     return a.offset_micros < b.offset_micros;
+                   });
+  CHECK(!trace.empty()) << "Empty arrival trace: " << arrival_trace_path;
+  return trace;
+}
+
+class TraceTask : public BatchTask {
+ public:
+  explicit TraceTask(size_t size)
+      : size_(size), start_time_micros_(Env::Default()->NowMicros()) {}
+
+  size_t size() const override { return size_; }
+
+  uint64 start_time_micros() const { return start_time_micros_; }
+
+ private:
+  const size_t size_;
+
+  // The time at which the task was created, in microseconds.
+  const uint64 start_time_micros_;
+};
+
+// Replays an arrival trace into a single SharedBatchScheduler queue and
+// collects per-task and per-batch statistics.
+class TraceReplayBenchmark {
+ public:
+  TraceReplayBenchmark(int num_batch_threads,
+                       const SharedBatchScheduler<TraceTask>::QueueOptions&
+                           queue_options,
+                       int64_t batch_cost_micros)
+      : batch_cost_micros_(batch_cost_micros) {
+    SharedBatchScheduler<TraceTask>::Options options;
+    options.num_batch_threads = num_batch_threads;
+    TF_CHECK_OK(SharedBatchScheduler<TraceTask>::Create(options, &scheduler_));
+    TF_CHECK_OK(scheduler_->AddQueue(
+        queue_options,
+        [this](std::unique_ptr<Batch<TraceTask>> batch) {
+          ProcessBatch(std::move(batch));
+        },
+        &queue_));
+  }
+
+  TraceReplayBenchmark(const TraceReplayBenchmark&) = delete;
+  TraceReplayBenchmark& operator=(const TraceReplayBenchmark&) = delete;
+
+  // Schedules the tasks of 'trace', each at its recorded offset from the time
+  // of the call.
+  void Replay(const std::vector<Arrival>& trace) {
+    const int64_t start_time_micros = Env::Default()->NowMicros();
+    for (const Arrival& arrival : trace) {
+      const int64_t due_micros = start_time_micros + arrival.offset_micros;
+      int64_t now_micros = Env::Default()->NowMicros();
+      while (now_micros < due_micros) {
+        if (due_micros - now_micros >= 1000) {
+          Env::Default()->SleepForMicroseconds(1 /* minimum time */);
+        }
+        now_micros = Env::Default()->NowMicros();
+      }
+      auto task = std::make_unique<TraceTask>(arrival.size);
+      Status status = queue_->Schedule(&task);
+      if (!status.ok()) {
+        mutex_lock l(mu_);
+        ++num_rejected_tasks_;
+      }
+    }
+  }
+
+  // Waits for all scheduled work to complete.
+  void Drain() {
+    queue_.reset();
+    scheduler_.reset();
+  }
+
+  string Report() {
+    mutex_lock l(mu_);
+    return absl::StrCat(
+        "lat_p50=", task_latency_millis_histogram_.Percentile(50),
+        "ms,lat_p99=", task_latency_millis_histogram_.Percentile(99),
+        "ms,batchsz_p50=", batch_size_histogram_.Percentile(50),
+        ",batchsz_p99=", batch_size_histogram_.Percentile(99),
+        ",full=", num_full_batches_, ",timeout=", num_timeout_batches_,
+        ",rejected=", num_rejected_tasks_);
+  }
+
+ private:
+  // Processes a batch of tasks. (Invoked by 'scheduler_' on one of its batch
+  // threads.)
+  void ProcessBatch(std::unique_ptr<Batch<TraceTask>> batch) {
+    Env::Default()->SleepForMicroseconds(batch_cost_micros_);
+    const uint64 batch_completion_time = Env::Default()->NowMicros();
+
+    mutex_lock l(mu_);
+    batch_size_histogram_.Add(batch->size());
+    switch (batch->dispatch_trigger()) {
+      case BatchDispatchTrigger::kFull:
+        ++num_full_batches_;
+        break;
+      case BatchDispatchTrigger::kTimeout:
+        ++num_timeout_batches_;
+        break;
+      default:
+        break;
+    }
+    for (int i = 0; i < batch->num_tasks(); ++i) {
+      task_latency_millis_histogram_.Add(
+          (batch_completion_time - batch->task(i).start_time_micros()) /
+          1000.0);
+    }
+  }
+
+  // The simulated cost of processing one batch, regardless of its size.
+  const int64_t batch_cost_micros_;
+
+  std::shared_ptr<SharedBatchScheduler<TraceTask>> scheduler_;
+  std::unique_ptr<BatchScheduler<TraceTask>> queue_;
+
+  mutex mu_;
+
+  // A histogram of the task latencies, i.e. queue time plus processing time, in
+  // milliseconds.
+  Histogram task_latency_millis_histogram_ TF_GUARDED_BY(mu_);
+
+  // A histogram of the batch sizes.
+  Histogram batch_size_histogram_ TF_GUARDED_BY(mu_);
+
+  int64_t num_full_batches_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_timeout_batches_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_rejected_tasks_ TF_GUARDED_BY(mu_) = 0;
+};
+
+// Replays the arrival trace once per configuration, and reports latency, batch
+// size and dispatch trigger counts in the benchmark label.
+void TraceReplayBM(::testing::benchmark::State& state) {
+  static const std::vector<Arrival>* const trace =
+      new std::vector<Arrival>(LoadArrivalTrace());
+
+  SharedBatchScheduler<TraceTask>::QueueOptions queue_options;
+  queue_options.input_batch_size_limit = 64;
+  queue_options.batch_timeout_micros = state.range(0);
+  queue_options.max_enqueued_batches = INT_MAX;  // Unbounded queue.
+  queue_options.latency_slo_micros = state.range(2);
+  TraceReplayBenchmark bm(/*num_batch_threads=*/state.range(1), queue_options,
+                          /*batch_cost_micros=*/500);
+
+  for (auto s : state) {
+    bm.Replay(*trace);
+    bm.Drain();
+  }
+  state.SetItemsProcessed(state.iterations() * trace->size());
+  state.SetLabel(bm.Report());
+}
+BENCHMARK(TraceReplayBM)
+    ->UseRealTime()
+    ->Iterations(1)
+    ->ArgNames({"timeout", "batch_threads", "latency_slo"})
+    ->ArgsProduct({{0, 1000, 5000}, {1, 4}, {0, 10000}});
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
+
+int main(int argc, char** argv) {
+  const std::vector<tensorflow::Flag> flag_list = {
+      tensorflow::Flag("arrival_trace",
+                       &tensorflow::serving::arrival_trace_path,
+                       "Arrival trace to replay, one "
+                       "\"<offset_micros>[,<task_size>]\" per line."),
+      tensorflow::Flag("synthetic_trace_qps",
+                       &tensorflow::serving::synthetic_trace_qps,
+                       "Arrival rate of the synthetic trace."),
+      tensorflow::Flag("synthetic_trace_duration_secs",
+                       &tensorflow::serving::synthetic_trace_duration_secs,
+                       "Duration of the synthetic trace.")};
+  if (!tensorflow::Flags::Parse(&argc, argv, flag_list)) {
+    std::cout << tensorflow::Flags::Usage(argv[0], flag_list);
+    return -1;
+  }
+
+  ::benchmark::Initialize(&argc, argv);
+  tensorflow::port::InitMain(argv[0], &argc, &argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
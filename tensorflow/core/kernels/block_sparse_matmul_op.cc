@@ -0,0 +1,185 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Computes columns [block_col * kBlockCols, (block_col + 1) * kBlockCols) of
+// row `row` of the product. The block shape is known at compile time, so the
+// loops over a block are unrolled and vectorized by the compiler, and the
+// accumulators stay in registers across the blocks of a column.
+template <typename T, int kBlockRows, int kBlockCols>
+void MultiplyBlockColumn(const T* a_row, const T* block_values,
+                         const int32* block_col_ptr,
+                         const int32* block_row_indices, int64_t block_col,
+                         T* product_row) {
+  T acc[kBlockCols] = {};
+  for (int32 p = block_col_ptr[block_col]; p < block_col_ptr[block_col + 1];
+       ++p) {
+    const T* a =
+        a_row + static_cast<int64_t>(block_row_indices[p]) * kBlockRows;
+    const T* block =
+        block_values + static_cast<int64_t>(p) * kBlockRows * kBlockCols;
+    for (int i = 0; i < kBlockRows; ++i) {
+      for (int j = 0; j < kBlockCols; ++j) {
+        acc[j] += a[i] * block[i * kBlockCols + j];
+      }
+    }
+  }
+  T* out = product_row + block_col * kBlockCols;
+  for (int j = 0; j < kBlockCols; ++j) {
+    out[j] = acc[j];
+  }
+}
+
+}  // namespace
+
+// Multiplies a dense matrix by a matrix that is sparse in blocks, visiting
+// only the stored blocks. See _BlockSparseMatMul in ../ops/math_ops.cc for the
+// layout of the sparse matrix.
+template <typename T>
+class BlockSparseMatMulOp : public OpKernel {
+ public:
+  explicit BlockSparseMatMulOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& a = context->input(0);
+    const Tensor& block_values = context->input(1);
+    const Tensor& block_col_ptr = context->input(2);
+    const Tensor& block_row_indices = context->input(3);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(a.shape()),
+                errors::InvalidArgument("a must be a matrix, got shape ",
+                                        a.shape().DebugString()));
+    OP_REQUIRES(context, block_values.dims() == 3,
+                errors::InvalidArgument(
+                    "block_values must be 3-D, got shape ",
+                    block_values.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(block_col_ptr.shape()) &&
+                             block_col_ptr.NumElements() >= 1,
+                errors::InvalidArgument(
+                    "block_col_ptr must be a non-empty vector, got shape ",
+                    block_col_ptr.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(block_row_indices.shape()),
+                errors::InvalidArgument(
+                    "block_row_indices must be a vector, got shape ",
+                    block_row_indices.shape().DebugString()));
+
+    const int64_t num_blocks = block_values.dim_size(0);
+    const int64_t block_rows = block_values.dim_size(1);
+    const int64_t block_cols = block_values.dim_size(2);
+    OP_REQUIRES(context, block_row_indices.NumElements() == num_blocks,
+                errors::InvalidArgument(
+                    "block_row_indices must have one element per block, got ",
+                    block_row_indices.NumElements(), " for ", num_blocks,
+                    " blocks"));
+    OP_REQUIRES(context,
+                (block_rows == 4 && block_cols == 4) ||
+                    (block_rows == 8 && block_cols == 1),
+                errors::Unimplemented("Unsupported block shape ", block_rows,
+                                      "x", block_cols));
+    OP_REQUIRES(context, a.dim_size(1) % block_rows == 0,
+                errors::InvalidArgument(
+                    "The inner dimension of a must be a multiple of ",
+                    block_rows, ", got ", a.dim_size(1)));
+
+    const int64_t num_rows = a.dim_size(0);
+    const int64_t num_block_rows = a.dim_size(1) / block_rows;
+    const int64_t num_block_cols = block_col_ptr.NumElements() - 1;
+    const auto col_ptr = block_col_ptr.vec<int32>();
+    const auto row_indices = block_row_indices.vec<int32>();
+    OP_REQUIRES(
+        context, col_ptr(0) == 0 && col_ptr(num_block_cols) == num_blocks,
+        errors::InvalidArgument(
+            "block_col_ptr must start at 0 and end at the number of blocks"));
+    for (int64_t j = 0; j < num_block_cols; ++j) {
+      OP_REQUIRES(context, col_ptr(j) <= col_ptr(j + 1),
+                  errors::InvalidArgument("block_col_ptr must be sorted"));
+    }
+    for (int64_t p = 0; p < num_blocks; ++p) {
+      OP_REQUIRES(context, FastBoundsCheck(row_indices(p), num_block_rows),
+                  errors::InvalidArgument("block_row_indices[", p,
+                                          "] = ", row_indices(p),
+                                          " is not in [0, ", num_block_rows,
+                                          ")"));
+    }
+
+    Tensor* product = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({num_rows, num_block_cols * block_cols}),
+                       &product));
+    if (product->NumElements() == 0) return;
+
+    const T* a_data = a.flat<T>().data();
+    const T* values_data = block_values.flat<T>().data();
+    const int32* col_ptr_data = col_ptr.data();
+    const int32* row_indices_data = row_indices.data();
+    T* product_data = product->flat<T>().data();
+    const int64_t a_cols = a.dim_size(1);
+    const int64_t product_cols = product->dim_size(1);
+
+    auto work = [&](int64_t start, int64_t limit) {
+      for (int64_t unit = start; unit < limit; ++unit) {
+        const int64_t row = unit / num_block_cols;
+        const int64_t block_col = unit % num_block_cols;
+        const T* a_row = a_data + row * a_cols;
+        T* product_row = product_data + row * product_cols;
+        if (block_rows == 4) {
+          MultiplyBlockColumn<T, 4, 4>(a_row, values_data, col_ptr_data,
+                                       row_indices_data, block_col,
+                                       product_row);
+        } else {
+          MultiplyBlockColumn<T, 8, 1>(a_row, values_data, col_ptr_data,
+                                       row_indices_data, block_col,
+                                       product_row);
+        }
+      }
+    };
+    // Every unit computes one block of columns of one row of the product.
+    const int64_t cost_per_unit =
+        2 * block_rows * block_cols *
+        std::max<int64_t>(num_blocks / num_block_cols, 1);
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          num_rows * num_block_cols, cost_per_unit, work);
+  }
+};
+
+#define REGISTER_CPU(T)                                                     \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("_BlockSparseMatMul").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      BlockSparseMatMulOp<T>);
+
+REGISTER_CPU(float);
+
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
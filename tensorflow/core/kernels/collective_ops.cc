@@ -1346,6 +1346,80 @@ REGISTER_KERNEL_BUILDER(Name("CollectiveAllToAllV3").Device(DEVICE_CPU),
 REGISTER_KERNEL_BUILDER(Name("CollectiveAllToAllV3").Device(DEVICE_GPU),
                         CollectiveAllToAllV3OpKernel);
 
+class CollectiveAllToAllSplitVOpKernel : public CollectiveOpV3Kernel {
+ public:
+  explicit CollectiveAllToAllSplitVOpKernel(OpKernelConstruction* c)
+      : CollectiveOpV3Kernel(c) {
+    name_ = strings::StrCat(c->def().name(), ": AllToAllSplitV");
+    VLOG(2) << "CollectiveAllToAllSplitV " << this << " name " << name_;
+  }
+
+  void ComputeAsync(OpKernelContext* c, DoneCallback done) override {
+    auto col_params = new CollectiveParams();
+    auto done_with_cleanup = [col_params, done = std::move(done)]() {
+      done();
+      col_params->Unref();
+    };
+    core::RefCountPtr<CollectiveGroupResource> resource;
+    OP_REQUIRES_OK_ASYNC(c, LookupResource(c, HandleFromInput(c, 1), &resource),
+                         done_with_cleanup);
+
+    Tensor group_assignment = c->input(2);
+
+    OP_REQUIRES_OK_ASYNC(
+        c,
+        FillCollectiveParams(col_params, group_assignment,
+                             ALL_TO_ALL_V_COLLECTIVE, resource.get()),
+        done_with_cleanup);
+    col_params->instance.shape = c->input(0).shape();
+
+    const Tensor& send_splits = c->input(3);
+    const Tensor& recv_splits = c->input(4);
+    OP_REQUIRES_ASYNC(
+        c,
+        TensorShapeUtils::IsVector(send_splits.shape()) &&
+            TensorShapeUtils::IsVector(recv_splits.shape()),
+        errors::InvalidArgument("send_splits and recv_splits must be vectors, "
+                                "got shapes ",
+                                send_splits.shape().DebugString(), " and ",
+                                recv_splits.shape().DebugString()),
+        done_with_cleanup);
+    const auto send = send_splits.vec<int64_t>();
+    const auto recv = recv_splits.vec<int64_t>();
+    col_params->send_splits.assign(send.data(), send.data() + send.size());
+    col_params->recv_splits.assign(recv.data(), recv.data() + recv.size());
+    int64_t recv_rows = 0;
+    for (int64_t rows : col_params->recv_splits) {
+      OP_REQUIRES_ASYNC(c, rows >= 0,
+                        errors::InvalidArgument(
+                            "recv_splits must be non-negative, got ", rows),
+                        done_with_cleanup);
+      recv_rows += rows;
+    }
+    VLOG(1) << "CollectiveAllToAllSplitV group_size "
+            << col_params->group.group_size << " group_key "
+            << col_params->group.group_key << " instance_key "
+            << col_params->instance.instance_key;
+    // Allocate the output tensor. The split sizes are validated by the
+    // collective implementation.
+    TensorShape output_shape = c->input(0).shape();
+    OP_REQUIRES_ASYNC(c, output_shape.dims() > 0,
+                      errors::InvalidArgument(
+                          "input must have at least one dimension"),
+                      done_with_cleanup);
+    output_shape.set_dim(0, recv_rows);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK_ASYNC(c, c->allocate_output(0, output_shape, &output),
+                         done_with_cleanup);
+    Run(c, col_params, std::move(done_with_cleanup));
+  }
+};
+
+// The split sizes are exchanged on the host, so only a CPU kernel is
+// registered.
+REGISTER_KERNEL_BUILDER(Name("CollectiveAllToAllSplitV").Device(DEVICE_CPU),
+                        CollectiveAllToAllSplitVOpKernel);
+
 class CollectiveReduceScatterV2OpKernel : public CollectiveOpV2Kernel {
  public:
   explicit CollectiveReduceScatterV2OpKernel(OpKernelConstruction* c)
@@ -63,6 +63,47 @@ class LaunchDeepConvOp<CPUDevice, float> {
   }
 };
 
+// Conditionally launches FFTConv operation based on convolution parameters.
+template <>
+class LaunchFFTConvOp<CPUDevice, float> {
+ public:
+  static bool Run(OpKernelContext* ctx, const Tensor& input,
+                  const Tensor& filter, int batch, int input_rows,
+                  int input_cols, int in_depth, int filter_rows,
+                  int filter_cols, int pad_rows, int pad_cols, int out_rows,
+                  int out_cols, int out_depth, int dilation_rows,
+                  int dilation_cols, int stride_rows, int stride_cols,
+                  Tensor* output, TensorFormat data_format) {
+    if (data_format != FORMAT_NHWC ||
+        !CanUseFFTConv2D(stride_rows, stride_cols, dilation_rows,
+                         dilation_cols, filter_rows, filter_cols, batch,
+                         in_depth, out_depth, out_rows, out_cols)) {
+      return false;
+    }
+
+    Conv2DArgs args;
+    args.batch = batch;
+    args.in_rows = input_rows;
+    args.in_cols = input_cols;
+    args.in_depth = in_depth;
+    args.filter_rows = filter_rows;
+    args.filter_cols = filter_cols;
+    args.pad_rows = pad_rows;
+    args.pad_cols = pad_cols;
+    args.out_rows = out_rows;
+    args.out_cols = out_cols;
+    args.out_depth = out_depth;
+
+    auto input_ptr = input.template flat<float>().data();
+    auto filter_ptr = filter.template flat<float>().data();
+    auto output_ptr = output->template flat<float>().data();
+
+    functor::FFTConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
+                                           output_ptr);
+    return true;
+  }
+};
+
 // Explicit instantiation.
 template struct LaunchConv2DOp<CPUDevice, float>;
 template struct Conv2DOp<CPUDevice, float>;
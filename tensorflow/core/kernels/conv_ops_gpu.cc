@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
 #include "tensorflow/core/protobuf/autotuning.pb.h"
+#include "tensorflow/core/util/autotune_maps/conv_layout_timings.h"
 #include "tensorflow/core/util/proto/proto_utils.h"
 #include "tensorflow/core/util/use_cudnn.h"
 
@@ -230,6 +231,28 @@ AutotuneFusedConv<Eigen::half>(
     se::DeviceMemory<Eigen::half> bias_ptr,
     se::DeviceMemory<Eigen::half> side_input_ptr, int64_t scratch_size_limit);
 
+namespace {
+
+// Records the fastest forward run time among `results`, so that the layout
+// optimizer can compare the data formats of the convolution.
+void RecordConvRunTime(se::dnn::ConvolutionKind kind,
+                       const ConvParameters& conv_parameters,
+                       absl::Span<const AutotuneResult> results) {
+  if (kind != se::dnn::ConvolutionKind::FORWARD) return;
+  absl::Duration best_run_time = absl::InfiniteDuration();
+  for (const AutotuneResult& result : results) {
+    if (result.has_failure()) continue;
+    best_run_time = std::min(
+        best_run_time, proto_utils::FromDurationProto(result.run_time()));
+  }
+  if (best_run_time != absl::InfiniteDuration()) {
+    ConvLayoutTimings::Global()->RecordRunTime(conv_parameters.proto(),
+                                               best_run_time);
+  }
+}
+
+}  // namespace
+
 template <typename T>
 StatusOr<AutotuneEntry<se::dnn::ConvOp>> AutotuneUnfusedConv(
     bool cudnn_use_autotune,
@@ -298,6 +321,7 @@ StatusOr<AutotuneEntry<se::dnn::ConvOp>> AutotuneUnfusedConv(
     LogConvAutotuneResults(kind, se::dnn::ToDataType<T>::value, input_ptr,
                            filter_ptr, output_ptr, input_desc, filter_desc,
                            output_desc, conv_desc, stream->parent(), results);
+    RecordConvRunTime(kind, conv_parameters, results);
 
     // Two-level autotuning: Cudnn frontend supports two engine lists:
     // heuristics and fallback. Heuristics engines are normally faster.
@@ -336,6 +360,7 @@ StatusOr<AutotuneEntry<se::dnn::ConvOp>> AutotuneUnfusedConv(
                              filter_ptr, output_ptr, input_desc, filter_desc,
                              output_desc, conv_desc, stream->parent(),
                              fallback_results);
+      RecordConvRunTime(kind, conv_parameters, fallback_results);
 
       TF_ASSIGN_OR_RETURN(autotune_entry,
                           BestCudnnConvAlgorithm<se::dnn::ConvOp>(
@@ -390,6 +415,7 @@ StatusOr<AutotuneEntry<se::dnn::ConvOp>> AutotuneUnfusedConv(
     LogConvAutotuneResults(kind, se::dnn::ToDataType<T>::value, input_ptr,
                            filter_ptr, output_ptr, input_desc, filter_desc,
                            output_desc, conv_desc, stream->parent(), results);
+    RecordConvRunTime(kind, conv_parameters, results);
 
     TF_ASSIGN_OR_RETURN(auto algo_desc, BestCudnnConvAlgorithm(results));
     autotune_entry = AutotuneEntry<se::dnn::ConvOp>(algo_desc);
@@ -14,11 +14,17 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 
+#include <algorithm>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/match.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/hash_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -29,10 +35,15 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/cache_ops.h"
 #include "tensorflow/core/kernels/data/iterator_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
@@ -46,6 +57,7 @@ namespace data {
 /* static */ constexpr const char* const CacheDatasetOp::kFileName;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputTypes;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const CacheDatasetOp::kContentAddressed;
 
 namespace {
 
@@ -64,6 +76,14 @@ constexpr char kCacheCompleted[] = "cache_completed";
 constexpr char kIndex[] = "index";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
+constexpr char kContentAddressedDatasetPrefix[] = "ContentAddressed";
+constexpr char kContentAddressedMetadata[] = "metadata";
+constexpr char kContentAddressedChunk[] = "chunk_";
+constexpr char kTempDirInfix[] = ".tmp_";
+constexpr char kChunkSizes[] = "chunk_sizes";
+constexpr char kChunkIndex[] = "chunk_index";
+constexpr char kElementOffset[] = "element_offset";
+constexpr char kTempDir[] = "temp_dir";
 constexpr char kIncompleteCacheErrorMessage[] =
     "The calling iterator did not fully read the dataset being cached. In "
     "order to avoid unexpected truncation of the dataset, the partially cached "
@@ -723,6 +743,595 @@ class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
   const Tensor resource_handle_;
 };
 
+// A file cache that is keyed by the fingerprint of the input dataset graph,
+// so that it can be shared by jobs whose input pipelines only differ after
+// the cache. Under the `filename` directory, the cache of an input with
+// fingerprint <fp> is laid out as follows:
+//
+//   <fp>/metadata             Bundle with the number of elements per chunk.
+//   <fp>/chunk_<i>            Bundle with the elements of chunk `i`.
+//   <fp>.lockfile             Claim of the iterator that writes the cache.
+//   <fp>.tmp_<id>/            The cache while it is being written.
+//
+// A writer writes its chunks to a temporary directory and commits the cache
+// by renaming that directory to <fp>, so readers only ever see complete
+// caches. Iterators that find a live claim of another writer pass their
+// input through without writing. If several writers race for the claim, the
+// first one to commit wins and the others discard their copy.
+class CacheDatasetOp::ContentAddressedDataset : public DatasetBase {
+ public:
+  ContentAddressedDataset(OpKernelContext* ctx, const DatasetBase* input,
+                          string filename, uint64 fingerprint, Env* env,
+                          int op_version, const Tensor& resource_handle)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        filename_(std::move(filename)),
+        fingerprint_(fingerprint),
+        cache_dir_(io::JoinPath(
+            filename_, strings::StrCat(strings::Hex(
+                           fingerprint_, strings::kZeroPad16)))),
+        env_(env),
+        num_tensors_(input->output_dtypes().size()),
+        op_version_(op_version),
+        resource_handle_(resource_handle) {
+    input_->Ref();
+  }
+
+  ~ContentAddressedDataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    name_utils::IteratorPrefixParams params;
+    params.dataset_prefix = kContentAddressedDatasetPrefix;
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix, params)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.dataset_prefix = kContentAddressedDatasetPrefix;
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    return input_->Cardinality(options);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_node));
+    Node* filename_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename_node));
+    std::vector<Node*> inputs = {input_node, filename_node};
+    if (op_version_ == 2) {
+      Node* resource_handle_node = nullptr;
+      TF_RETURN_IF_ERROR(
+          b->AddTensor(resource_handle_, &resource_handle_node));
+      inputs.push_back(resource_handle_node);
+    }
+    AttrValue content_addressed;
+    b->BuildAttrValue(true, &content_addressed);
+    return b->AddDataset(this, inputs,
+                         {{kContentAddressed, content_addressed}}, output);
+  }
+
+ private:
+  // Elements are written to chunks of about this many bytes. A chunk is also
+  // sealed whenever a writing iterator is checkpointed.
+  static constexpr int64_t kTargetChunkBytes = 16 << 20;  // 16 MB
+  // The maximum number of chunks that are read ahead.
+  static constexpr int64_t kMaxParallelChunkReads = 8;
+  // A claim is live if it was created or refreshed this recently. Writers
+  // refresh their claim whenever they seal a chunk.
+  static constexpr int64_t kClaimExpirationSeconds = 600;
+
+  string LockfileName() const {
+    return strings::StrCat(cache_dir_, kLockFileSuffix);
+  }
+
+  string MetadataPrefix(const string& dir) const {
+    return io::JoinPath(dir, kContentAddressedMetadata);
+  }
+
+  string ChunkPrefix(const string& dir, int64_t chunk_index) const {
+    return io::JoinPath(dir, strings::StrCat(kContentAddressedChunk,
+                                             chunk_index));
+  }
+
+  static string ElementKey(int64_t element_index, size_t tensor_index) {
+    return strings::StrCat(element_index, "_", tensor_index);
+  }
+
+  // Returns true iff a committed cache exists for this dataset.
+  bool IsCommitted() const {
+    return env_->FileExists(MetaFilename(MetadataPrefix(cache_dir_))).ok();
+  }
+
+  // Reads the number of elements in each chunk of the committed cache.
+  Status ReadChunkSizes(std::vector<int64_t>* chunk_sizes) const {
+    BundleReader reader(env_, MetadataPrefix(cache_dir_));
+    TF_RETURN_IF_ERROR(reader.status());
+    Tensor sizes;
+    TF_RETURN_IF_ERROR(reader.Lookup(kChunkSizes, &sizes));
+    if (sizes.dtype() != DT_INT64 || sizes.dims() != 1) {
+      return errors::DataLoss("Invalid cache metadata in ", cache_dir_, ".");
+    }
+    auto flat = sizes.flat<int64_t>();
+    chunk_sizes->assign(flat.data(), flat.data() + flat.size());
+    return OkStatus();
+  }
+
+  class Iterator : public DatasetIterator<ContentAddressedDataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<ContentAddressedDataset>(params) {}
+
+    ~Iterator() override {
+      CancelReads(/*wait=*/true);
+      if (deregister_fn_) deregister_fn_();
+      mutex_lock l(mu_);
+      if (mode_ == Mode::write && claimed_ && !iteration_completed_ &&
+          !checkpointed_) {
+        // Nothing refers to the partial cache, so it can be removed right
+        // away. Otherwise, it is removed by the next writer that takes over
+        // the expired claim.
+        LOG(WARNING) << kIncompleteCacheErrorMessage;
+        DiscardTempDir();
+        ReleaseClaim();
+      }
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(RegisterCancellationCallback(
+          ctx->cancellation_manager(),
+          [this]() { CancelReads(/*wait=*/false); }, &deregister_fn_));
+      if (dataset()->IsCommitted()) {
+        mode_ = Mode::read;
+        return InitializeReader(ctx);
+      }
+      mode_ = Mode::write;
+      return dataset()->input_->MakeIterator(ctx, this, prefix(),
+                                             &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      *end_of_sequence = false;
+      if (iteration_completed_) {
+        *end_of_sequence = true;
+        return OkStatus();
+      }
+      switch (mode_) {
+        case Mode::read:
+          return ReadNext(ctx, out_tensors, end_of_sequence, l);
+        case Mode::write:
+          return WriteNext(ctx, out_tensors, end_of_sequence);
+        case Mode::pass_through:
+          return input_impl_->GetNext(ctx, out_tensors, end_of_sequence);
+      }
+      return errors::Internal("Invalid cache mode ", mode_);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args),
+                                       /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kMode), mode_));
+      if (iteration_completed_) {
+        return writer->WriteScalar(full_name(kIterationCompleted), "");
+      }
+      if (mode_ == Mode::read) {
+        // The chunks that have been read ahead are read again on restore.
+        int64_t chunk_index = next_chunk_index_;
+        int64_t element_offset = next_element_offset_;
+        if (!chunks_.empty()) {
+          chunk_index = chunks_.front()->chunk_index;
+          element_offset = chunks_.front()->element_offset;
+        }
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kChunkIndex), chunk_index));
+        return writer->WriteScalar(full_name(kElementOffset), element_offset);
+      }
+      if (mode_ == Mode::write && claimed_) {
+        // Seal the current chunk, so that a restored iterator can continue
+        // writing from the checkpointed input position.
+        TF_RETURN_IF_ERROR(SealChunk());
+        Tensor chunk_sizes(DT_INT64,
+                           TensorShape({static_cast<int64_t>(
+                               chunk_sizes_.size())}));
+        std::copy(chunk_sizes_.begin(), chunk_sizes_.end(),
+                  chunk_sizes.flat<int64_t>().data());
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kTempDir), temp_dir_));
+        TF_RETURN_IF_ERROR(
+            writer->WriteTensor(full_name(kChunkSizes), chunk_sizes));
+        checkpointed_ = true;
+      }
+      return SaveInput(ctx, writer, input_impl_);
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t temp;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kMode), &temp));
+      if (temp != Mode::read && temp != Mode::write &&
+          temp != Mode::pass_through) {
+        return errors::DataLoss("Invalid cache mode ", temp);
+      }
+      mode_ = static_cast<Mode>(temp);
+      if (reader->Contains(full_name(kIterationCompleted))) {
+        iteration_completed_ = true;
+        return OkStatus();
+      }
+      if (mode_ == Mode::read) {
+        int64_t chunk_index, element_offset;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name(kChunkIndex), &chunk_index));
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name(kElementOffset), &element_offset));
+        TF_RETURN_IF_ERROR(InitializeReader(ctx));
+        if (chunk_index < 0 ||
+            chunk_index > static_cast<int64_t>(chunk_sizes_.size()) ||
+            element_offset < 0 ||
+            (chunk_index < static_cast<int64_t>(chunk_sizes_.size()) &&
+             element_offset > chunk_sizes_[chunk_index])) {
+          return errors::DataLoss("Invalid cache position: chunk ",
+                                  chunk_index, ", element ", element_offset,
+                                  ".");
+        }
+        // Reads that are still in flight complete into chunks that are no
+        // longer referenced by `chunks_`.
+        chunks_.clear();
+        next_chunk_index_ = chunk_index;
+        next_element_offset_ = element_offset;
+        return OkStatus();
+      }
+      if (input_impl_ == nullptr) {
+        // The cache was committed after the checkpoint was saved.
+        TF_RETURN_IF_ERROR(dataset()->input_->MakeIterator(ctx, this, prefix(),
+                                                           &input_impl_));
+      }
+      TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      if (mode_ == Mode::write && reader->Contains(full_name(kTempDir))) {
+        tstring temp_dir;
+        Tensor chunk_sizes;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kTempDir), &temp_dir));
+        TF_RETURN_IF_ERROR(
+            reader->ReadTensor(full_name(kChunkSizes), &chunk_sizes));
+        if (!dataset()->env_->IsDirectory(temp_dir).ok()) {
+          // The partial cache is gone, e.g. because it was discarded by a
+          // writer that took over the claim. The elements that were produced
+          // before the checkpoint cannot be written again.
+          LOG(WARNING) << "The partially written cache " << temp_dir
+                       << " no longer exists. The elements of this iteration "
+                       << "will not be cached.";
+          mode_ = Mode::pass_through;
+          return OkStatus();
+        }
+        temp_dir_ = temp_dir;
+        auto flat = chunk_sizes.flat<int64_t>();
+        chunk_sizes_.assign(flat.data(), flat.data() + flat.size());
+        // Chunks written after the checkpoint are overwritten.
+        claimed_ = true;
+        checkpointed_ = true;
+        TF_RETURN_IF_ERROR(RefreshClaim());
+      }
+      return OkStatus();
+    }
+
+   private:
+    enum Mode { read, write, pass_through };
+
+    // The elements of one chunk. Once `done` is set, only `element_offset` is
+    // modified, and only by the consumer.
+    struct ChunkResult {
+      int64_t chunk_index = 0;
+      // The number of elements that have been consumed.
+      int64_t element_offset = 0;
+      std::vector<std::vector<Tensor>> elements;
+      bool done = false;
+      Status status;
+    };
+
+    void CancelReads(bool wait) TF_LOCKS_EXCLUDED(mu_) {
+      mutex_lock l(mu_);
+      cancelled_ = true;
+      cond_var_.notify_all();
+      while (wait && num_in_flight_ > 0) {
+        cond_var_.wait(l);
+      }
+    }
+
+    Status InitializeReader(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      num_parallel_reads_ = std::min<int64_t>(
+          kMaxParallelChunkReads, GetAutotuneDefaultParallelism(ctx));
+      return dataset()->ReadChunkSizes(&chunk_sizes_);
+    }
+
+    Status ReadNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
+                    bool* end_of_sequence, mutex_lock& l)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      while (true) {
+        ScheduleReadsLocked(ctx);
+        if (chunks_.empty()) {
+          *end_of_sequence = true;
+          return OkStatus();
+        }
+        std::shared_ptr<ChunkResult> chunk = chunks_.front();
+        while (!chunk->done && !cancelled_) {
+          RecordStop(ctx);
+          cond_var_.wait(l);
+          RecordStart(ctx);
+        }
+        if (cancelled_) {
+          return errors::Cancelled("Iterator was cancelled");
+        }
+        if (!chunk->status.ok()) {
+          chunks_.pop_front();
+          return chunk->status;
+        }
+        if (chunk->element_offset <
+            static_cast<int64_t>(chunk->elements.size())) {
+          *out_tensors = std::move(chunk->elements[chunk->element_offset++]);
+          if (chunk->element_offset ==
+              static_cast<int64_t>(chunk->elements.size())) {
+            chunks_.pop_front();
+          }
+          return OkStatus();
+        }
+        chunks_.pop_front();
+      }
+    }
+
+    // Starts reading chunks until `num_parallel_reads_` chunks are pending or
+    // there are no more chunks.
+    void ScheduleReadsLocked(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      while (!cancelled_ &&
+             static_cast<int64_t>(chunks_.size()) < num_parallel_reads_ &&
+             next_chunk_index_ < static_cast<int64_t>(chunk_sizes_.size())) {
+        const int64_t num_elements = chunk_sizes_[next_chunk_index_];
+        auto chunk = std::make_shared<ChunkResult>();
+        chunk->chunk_index = next_chunk_index_++;
+        chunk->element_offset = next_element_offset_;
+        next_element_offset_ = 0;
+        chunks_.push_back(chunk);
+        ++num_in_flight_;
+        (*ctx->runner())([this, chunk = std::move(chunk), num_elements]() {
+          ReadChunk(chunk.get(), num_elements);
+        });
+      }
+    }
+
+    void ReadChunk(ChunkResult* chunk, int64_t num_elements)
+        TF_LOCKS_EXCLUDED(mu_) {
+      std::vector<std::vector<Tensor>> elements(num_elements);
+      BundleReader reader(
+          dataset()->env_,
+          dataset()->ChunkPrefix(dataset()->cache_dir_, chunk->chunk_index));
+      Status s = reader.status();
+      for (int64_t i = chunk->element_offset; i < num_elements && s.ok();
+           ++i) {
+        elements[i].resize(dataset()->num_tensors_);
+        for (size_t j = 0; j < dataset()->num_tensors_ && s.ok(); ++j) {
+          s = reader.Lookup(ElementKey(i, j), &elements[i][j]);
+        }
+      }
+      mutex_lock l(mu_);
+      chunk->elements = std::move(elements);
+      chunk->status = s;
+      chunk->done = true;
+      --num_in_flight_;
+      cond_var_.notify_all();
+    }
+
+    Status WriteNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
+                     bool* end_of_sequence) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!claimed_) {
+        TF_RETURN_IF_ERROR(Claim());
+        if (!claimed_) {
+          mode_ = Mode::pass_through;
+          return input_impl_->GetNext(ctx, out_tensors, end_of_sequence);
+        }
+      }
+      TF_RETURN_IF_ERROR(
+          input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
+      if (*end_of_sequence) {
+        return Commit();
+      }
+      if (out_tensors->size() != dataset()->num_tensors_) {
+        return errors::Internal(
+            "Upstream iterator returned invalid number of tensors. Expected ",
+            dataset()->num_tensors_, " got: ", out_tensors->size());
+      }
+      if (writer_ == nullptr) {
+        writer_ = std::make_unique<BundleWriter>(
+            dataset()->env_,
+            dataset()->ChunkPrefix(temp_dir_, chunk_sizes_.size()));
+        TF_RETURN_IF_ERROR(writer_->status());
+      }
+      for (size_t i = 0; i < out_tensors->size(); ++i) {
+        TF_RETURN_IF_ERROR(
+            writer_->Add(ElementKey(chunk_size_, i), (*out_tensors)[i]));
+        chunk_bytes_ += (*out_tensors)[i].TotalBytes();
+      }
+      ++chunk_size_;
+      if (chunk_bytes_ >= kTargetChunkBytes) {
+        TF_RETURN_IF_ERROR(SealChunk());
+      }
+      return OkStatus();
+    }
+
+    // Claims the cache for this iterator, unless another writer holds a live
+    // claim, and creates the temporary directory to write the cache to.
+    Status Claim() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Env* env = dataset()->env_;
+      const string lockfile = dataset()->LockfileName();
+      string contents;
+      if (env->FileExists(lockfile).ok() &&
+          ReadFileToString(env, lockfile, &contents).ok()) {
+        std::vector<string> parts = str_util::Split(contents, '\n');
+        int64_t claimed_at;
+        if (parts.size() == 2 && strings::safe_strto64(parts[1], &claimed_at)) {
+          if (EnvTime::NowSeconds() - claimed_at < kClaimExpirationSeconds) {
+            VLOG(1) << "The cache " << dataset()->cache_dir_
+                    << " is being written by another iterator. Passing the "
+                    << "input through.";
+            return OkStatus();
+          }
+          // Take over the expired claim and discard the abandoned cache.
+          int64_t undeleted_files, undeleted_dirs;
+          env->DeleteRecursively(parts[0], &undeleted_files, &undeleted_dirs)
+              .IgnoreError();
+        }
+      }
+      TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dataset()->filename_));
+      temp_dir_ = strings::StrCat(dataset()->cache_dir_, kTempDirInfix,
+                                  env->NowMicros(), "_", random::New64());
+      TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(temp_dir_));
+      claimed_ = true;
+      return RefreshClaim();
+    }
+
+    Status RefreshClaim() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return WriteStringToFile(
+          dataset()->env_, dataset()->LockfileName(),
+          strings::StrCat(temp_dir_, "\n", EnvTime::NowSeconds()));
+    }
+
+    // Deletes the lockfile if it still holds the claim of this iterator.
+    void ReleaseClaim() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Env* env = dataset()->env_;
+      const string lockfile = dataset()->LockfileName();
+      string contents;
+      if (ReadFileToString(env, lockfile, &contents).ok() &&
+          absl::StartsWith(contents, strings::StrCat(temp_dir_, "\n"))) {
+        env->DeleteFile(lockfile).IgnoreError();
+      }
+    }
+
+    void DiscardTempDir() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      int64_t undeleted_files, undeleted_dirs;
+      Status s = dataset()->env_->DeleteRecursively(
+          temp_dir_, &undeleted_files, &undeleted_dirs);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to delete " << temp_dir_ << " : "
+                     << s.ToString();
+      }
+    }
+
+    Status SealChunk() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (writer_ == nullptr) return OkStatus();
+      TF_RETURN_IF_ERROR(writer_->Finish());
+      writer_.reset();
+      chunk_sizes_.push_back(chunk_size_);
+      chunk_size_ = 0;
+      chunk_bytes_ = 0;
+      return RefreshClaim();
+    }
+
+    // Writes the metadata of the cache and moves it to its final location.
+    Status Commit() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      iteration_completed_ = true;
+      TF_RETURN_IF_ERROR(SealChunk());
+      Env* env = dataset()->env_;
+      {
+        BundleWriter metadata(env, dataset()->MetadataPrefix(temp_dir_));
+        Tensor chunk_sizes(
+            DT_INT64, TensorShape({static_cast<int64_t>(chunk_sizes_.size())}));
+        std::copy(chunk_sizes_.begin(), chunk_sizes_.end(),
+                  chunk_sizes.flat<int64_t>().data());
+        TF_RETURN_IF_ERROR(metadata.Add(kChunkSizes, chunk_sizes));
+        TF_RETURN_IF_ERROR(metadata.Finish());
+      }
+      Status s = env->RenameFile(temp_dir_, dataset()->cache_dir_);
+      if (!s.ok()) {
+        if (!dataset()->IsCommitted()) return s;
+        // Another writer committed the same cache first.
+        VLOG(1) << "The cache " << dataset()->cache_dir_
+                << " was committed by another iterator.";
+        DiscardTempDir();
+      }
+      ReleaseClaim();
+      return OkStatus();
+    }
+
+    mutex mu_;
+    condition_variable cond_var_;
+    Mode mode_ TF_GUARDED_BY(mu_) = Mode::write;
+    bool iteration_completed_ TF_GUARDED_BY(mu_) = false;
+    // The number of elements in each chunk. In read mode, these are the
+    // chunks of the committed cache. In write mode, these are the chunks that
+    // have been sealed.
+    std::vector<int64_t> chunk_sizes_ TF_GUARDED_BY(mu_);
+
+    // Read mode.
+    int64_t num_parallel_reads_ TF_GUARDED_BY(mu_) = 1;
+    // The position of the next chunk to read.
+    int64_t next_chunk_index_ TF_GUARDED_BY(mu_) = 0;
+    // The number of elements of the next chunk that have already been
+    // consumed. Only non-zero after restoring from a checkpoint.
+    int64_t next_element_offset_ TF_GUARDED_BY(mu_) = 0;
+    // Chunks that are read or being read, in order.
+    std::deque<std::shared_ptr<ChunkResult>> chunks_ TF_GUARDED_BY(mu_);
+    int64_t num_in_flight_ TF_GUARDED_BY(mu_) = 0;
+    bool cancelled_ TF_GUARDED_BY(mu_) = false;
+    // Method for deregistering the cancellation callback.
+    std::function<void()> deregister_fn_;
+
+    // Write and pass-through modes.
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    // Whether this iterator holds the claim to write the cache.
+    bool claimed_ TF_GUARDED_BY(mu_) = false;
+    // Whether a checkpoint refers to the partial cache in `temp_dir_`.
+    bool checkpointed_ TF_GUARDED_BY(mu_) = false;
+    string temp_dir_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<BundleWriter> writer_ TF_GUARDED_BY(mu_);
+    // The number of elements and bytes in the chunk being written.
+    int64_t chunk_size_ TF_GUARDED_BY(mu_) = 0;
+    int64_t chunk_bytes_ TF_GUARDED_BY(mu_) = 0;
+  };
+
+  const DatasetBase* const input_;
+  const tstring filename_;
+  const uint64 fingerprint_;
+  const string cache_dir_;
+  Env* const env_;
+  const size_t num_tensors_;
+  const int op_version_;
+  const Tensor resource_handle_;
+};
+
 class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
  public:
   explicit MemoryDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
@@ -887,8 +1496,8 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
      protected:
       std::shared_ptr<model::Node> CreateNode(
           IteratorContext* ctx, model::Node::Args args) const override {
-        return model::MakeKnownRatioNode(std::move(args),
-                                         /*ratio=*/1);
+        return model::MakeMemoryCacheNode(std::move(args),
+                                          dataset()->input_->Cardinality());
       }
 
       Status SaveInternal(SerializationContext* ctx,
@@ -958,8 +1567,8 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
      protected:
       std::shared_ptr<model::Node> CreateNode(
           IteratorContext* ctx, model::Node::Args args) const override {
-        return model::MakeKnownRatioNode(std::move(args),
-                                         /*ratio=*/1);
+        return model::MakeMemoryCacheNode(std::move(args),
+                                          dataset()->input_->Cardinality());
       }
 
       Status SaveInternal(SerializationContext* ctx,
@@ -1110,13 +1719,36 @@ class CacheDatasetOp::MemoryDatasetV2
 
 CacheDatasetOp::CacheDatasetOp(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {
+  if (ctx->HasAttr(kContentAddressed)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kContentAddressed, &content_addressed_));
+  }
+}
 
 void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                                  DatasetBase** output) {
   // Parse out the filenames tensor.
   tstring filename;
   OP_REQUIRES_OK(ctx, ParseScalarArgument<tstring>(ctx, kFileName, &filename));
+  if (content_addressed_) {
+    OP_REQUIRES(ctx, !filename.empty(),
+                errors::InvalidArgument(
+                    "A content-addressed cache requires a non-empty filename."));
+    // Computes the fingerprint of the graph of the input dataset.
+    GraphDef graph_def;
+    SerializationContext::Params params(ctx);
+    std::vector<std::pair<string, Tensor>> input_list;
+    params.input_list = &input_list;
+    params.external_state_policy = ExternalStatePolicy::POLICY_IGNORE;
+    OP_REQUIRES_OK(ctx,
+                   AsGraphDef(input, SerializationContext(params), &graph_def));
+    uint64 fingerprint;
+    OP_REQUIRES_OK(ctx, HashGraph(graph_def, &fingerprint));
+    *output = new ContentAddressedDataset(
+        ctx, input, filename, fingerprint, ctx->env(), op_version_,
+        op_version_ == 2 ? ctx->input(2) : Tensor());
+    return;
+  }
   if (filename.empty()) {
     static std::atomic<int64_t> resource_id_counter(0);
     const string& container = ctx->resource_manager()->default_container();
@@ -30,6 +30,7 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
   static constexpr const char* const kFileName = "filename";
   static constexpr const char* const kOutputTypes = "output_types";
   static constexpr const char* const kOutputShapes = "output_shapes";
+  static constexpr const char* const kContentAddressed = "content_addressed";
 
   explicit CacheDatasetOp(OpKernelConstruction* ctx);
 
@@ -40,10 +41,12 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
  private:
   class FileDataset;
   class FileDatasetV2;
+  class ContentAddressedDataset;
   class MemoryDataset;
   class MemoryDatasetV2;
 
   const int op_version_;
+  bool content_addressed_ = false;
 };
 
 }  // namespace data
@@ -33,10 +33,11 @@ class CacheDatasetParams : public DatasetParams {
   CacheDatasetParams(T input_dataset_params, string filename,
                      DataTypeVector output_dtypes,
                      std::vector<PartialTensorShape> output_shapes,
-                     string node_name)
+                     string node_name, bool content_addressed = false)
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
-        filename_(filename) {
+        filename_(filename),
+        content_addressed_(content_addressed) {
     input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
     iterator_prefix_ =
         name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
@@ -57,7 +58,8 @@ class CacheDatasetParams : public DatasetParams {
   Status GetAttributes(AttributeVector* attr_vector) const override {
     *attr_vector = {{"output_types", output_dtypes_},
                     {"output_shapes", output_shapes_},
-                    {"metadata", ""}};
+                    {"metadata", ""},
+                    {"content_addressed", content_addressed_}};
     return OkStatus();
   }
 
@@ -65,8 +67,11 @@ class CacheDatasetParams : public DatasetParams {
 
   string filename() const { return filename_; }
 
+  bool content_addressed() const { return content_addressed_; }
+
  private:
   string filename_;
+  bool content_addressed_;
 };
 
 class CacheDatasetOpTest : public DatasetOpsTestBase {
@@ -75,11 +80,20 @@ class CacheDatasetOpTest : public DatasetOpsTestBase {
     TF_RETURN_IF_ERROR(DatasetOpsTestBase::Initialize(dataset_params));
     auto params = static_cast<const CacheDatasetParams&>(dataset_params);
     cache_filename_ = params.filename();
+    content_addressed_ = params.content_addressed();
     return OkStatus();
   }
 
   ~CacheDatasetOpTest() override {
-    if (!cache_filename_.empty()) {
+    if (content_addressed_) {
+      int64_t undeleted_files, undeleted_dirs;
+      Status s = device_->env()->DeleteRecursively(
+          cache_filename_, &undeleted_files, &undeleted_dirs);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to delete " << cache_filename_ << " : "
+                     << s.ToString();
+      }
+    } else if (!cache_filename_.empty()) {
       std::vector<string> cache_files;
       Status s = device_->env()->GetMatchingPaths(
           strings::StrCat(cache_filename_, "*"), &cache_files);
@@ -98,6 +112,7 @@ class CacheDatasetOpTest : public DatasetOpsTestBase {
 
  protected:
   tstring cache_filename_;
+  bool content_addressed_ = false;
 };
 
 // Test case 1: cache data in file.
@@ -150,6 +165,33 @@ CacheDatasetParams CacheDatasetParams4() {
                             kNodeName);
 }
 
+// Test case 5: cache data in a content-addressed file cache.
+CacheDatasetParams CacheDatasetParams5() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(TensorShape{3, 3, 1},
+                                            {0, 1, 2, 3, 4, 5, 6, 7, 8})},
+      /*node_name=*/"tensor_slice");
+  return CacheDatasetParams(
+      std::move(tensor_slice_dataset_params),
+      /*filename=*/io::JoinPath(testing::TmpDir(), "content_addressed_cache"),
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({3, 1})}, kNodeName,
+      /*content_addressed=*/true);
+}
+
+// Test case 6: cache empty data in a content-addressed file cache.
+CacheDatasetParams CacheDatasetParams6() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(TensorShape{0}, {})},
+      /*node_name=*/"tensor_slice");
+  return CacheDatasetParams(
+      std::move(tensor_slice_dataset_params),
+      /*filename=*/io::JoinPath(testing::TmpDir(), "content_addressed_cache"),
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})}, kNodeName,
+      /*content_addressed=*/true);
+}
+
 std::vector<GetNextTestCase<CacheDatasetParams>> GetNextTestCases() {
   return {{/*dataset_params=*/CacheDatasetParams1(),
            /*expected_outputs=*/
@@ -162,6 +204,12 @@ std::vector<GetNextTestCase<CacheDatasetParams>> GetNextTestCases() {
            CreateTensors<int64_t>(TensorShape({3, 1}),
                                   {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}})},
           {/*dataset_params=*/CacheDatasetParams4(),
+           /*expected_outputs=*/{}},
+          {/*dataset_params=*/CacheDatasetParams5(),
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(TensorShape({3, 1}),
+                                  {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}})},
+          {/*dataset_params=*/CacheDatasetParams6(),
            /*expected_outputs=*/{}}};
 }
 
@@ -302,6 +350,14 @@ IteratorSaveAndRestoreTestCases() {
            CreateTensors<int64_t>(TensorShape({3, 1}),
                                   {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}})},
           {/*dataset_params=*/CacheDatasetParams4(),
+           /*breakpoints=*/{0, 2, 4, 11},
+           /*expected_outputs=*/{}},
+          {/*dataset_params=*/CacheDatasetParams5(),
+           /*breakpoints=*/{0, 2, 4, 11},
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(TensorShape({3, 1}),
+                                  {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}})},
+          {/*dataset_params=*/CacheDatasetParams6(),
            /*breakpoints=*/{0, 2, 4, 11},
            /*expected_outputs=*/{}}};
 }
@@ -370,6 +426,111 @@ INSTANTIATE_TEST_CASE_P(CacheDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+TEST_F(CacheDatasetOpTest, ContentAddressedCacheIsShared) {
+  auto dataset_params = CacheDatasetParams5();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::unique_ptr<TestDataset> other_dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &other_dataset));
+  std::unique_ptr<TestIterator> other_iterator;
+  TF_ASSERT_OK(MakeIterator(dataset_params, *other_dataset, &other_iterator));
+
+  // The first iterator writes the cache. The second one finds its claim and
+  // passes the input through.
+  auto expected_outputs = CreateTensors<int64_t>(
+      TensorShape({3, 1}), {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}});
+  std::vector<Tensor> outputs, other_outputs;
+  bool end_of_sequence = false, other_end_of_sequence = false;
+  while (!end_of_sequence || !other_end_of_sequence) {
+    std::vector<Tensor> next;
+    if (!end_of_sequence) {
+      TF_ASSERT_OK(
+          iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      outputs.insert(outputs.end(), next.begin(), next.end());
+    }
+    next.clear();
+    if (!other_end_of_sequence) {
+      TF_ASSERT_OK(other_iterator->GetNext(&next, &other_end_of_sequence));
+      other_outputs.insert(other_outputs.end(), next.begin(), next.end());
+    }
+  }
+  TF_EXPECT_OK(ExpectEqual(outputs, expected_outputs, /*compare_order=*/true));
+  TF_EXPECT_OK(
+      ExpectEqual(other_outputs, expected_outputs, /*compare_order=*/true));
+
+  // Only the committed cache remains.
+  std::vector<string> children;
+  TF_ASSERT_OK(device_->env()->GetChildren(cache_filename_, &children));
+  ASSERT_EQ(children.size(), 1);
+  TF_EXPECT_OK(device_->env()->IsDirectory(
+      io::JoinPath(cache_filename_, children[0])));
+
+  // Another dataset with the same input reads the committed cache.
+  TF_ASSERT_OK(MakeIterator(dataset_params, *other_dataset, &other_iterator));
+  other_outputs.clear();
+  other_end_of_sequence = false;
+  while (!other_end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(other_iterator->GetNext(&next, &other_end_of_sequence));
+    other_outputs.insert(other_outputs.end(), next.begin(), next.end());
+  }
+  TF_EXPECT_OK(
+      ExpectEqual(other_outputs, expected_outputs, /*compare_order=*/true));
+  TF_ASSERT_OK(device_->env()->GetChildren(cache_filename_, &children));
+  EXPECT_EQ(children.size(), 1);
+}
+
+TEST_F(CacheDatasetOpTest, ContentAddressedCacheSaveAndRestoreWhileReading) {
+  auto dataset_params = CacheDatasetParams5();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::unique_ptr<SerializationContext> serialization_ctx;
+  TF_ASSERT_OK(CreateSerializationContext(&serialization_ctx));
+
+  // Checkpoint after every element, so that each element is written to its
+  // own chunk.
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  while (!end_of_sequence) {
+    VariantTensorDataWriter writer;
+    TF_ASSERT_OK(iterator_->Save(serialization_ctx.get(), &writer));
+    TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                    &end_of_sequence));
+  }
+
+  TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &iterator_));
+  auto expected_outputs = CreateTensors<int64_t>(
+      TensorShape({3, 1}), {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}});
+  std::vector<Tensor> outputs;
+  end_of_sequence = false;
+  while (!end_of_sequence) {
+    VariantTensorDataWriter writer;
+    TF_ASSERT_OK(iterator_->Save(serialization_ctx.get(), &writer));
+    std::vector<const VariantTensorData*> data;
+    writer.GetData(&data);
+    VariantTensorDataReader reader(data);
+    TF_ASSERT_OK(RestoreIterator(iterator_ctx_.get(), &reader,
+                                 dataset_params.iterator_prefix(), *dataset_,
+                                 &iterator_));
+    out_tensors.clear();
+    TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                    &end_of_sequence));
+    outputs.insert(outputs.end(), out_tensors.begin(), out_tensors.end());
+  }
+  TF_EXPECT_OK(ExpectEqual(outputs, expected_outputs, /*compare_order=*/true));
+}
+
+TEST_F(CacheDatasetOpTest, ContentAddressedCacheRequiresFilename) {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(TensorShape{3}, {0, 1, 2})},
+      /*node_name=*/"tensor_slice");
+  auto dataset_params = CacheDatasetParams(
+      std::move(tensor_slice_dataset_params), /*filename=*/"",
+      /*output_dtypes=*/{DT_INT64}, /*output_shapes=*/{PartialTensorShape({})},
+      kNodeName, /*content_addressed=*/true);
+  EXPECT_EQ(Initialize(dataset_params).code(), error::INVALID_ARGUMENT);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -0,0 +1,528 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/input_colocation_exemption_registry.h"
+#include "tensorflow/core/data/captured_function.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// Groups the elements of its input into buckets by the length computed by
+// `element_length_func`, and emits a padded batch from a bucket as soon as it
+// holds that bucket's batch size. This produces the same batches, in the same
+// order, as the `group_by_window` and `padded_batch` composition that
+// `Dataset.bucket_by_sequence_length` otherwise builds, without creating a
+// window dataset and running a reduce function per batch.
+class BucketBySequenceLengthDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  explicit BucketBySequenceLengthDatasetOp(OpKernelConstruction* ctx)
+      : UnaryDatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, FunctionMetadata::Create(ctx, "element_length_func",
+                                                 /*params=*/{},
+                                                 &func_metadata_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("pad_to_bucket_boundary",
+                                     &pad_to_bucket_boundary_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    std::unique_ptr<CapturedFunction> captured_func;
+    OP_REQUIRES_OK(ctx, CapturedFunction::Create(
+                            ctx, func_metadata_,
+                            "element_length_func_other_arguments",
+                            &captured_func));
+
+    const Tensor* boundaries_t;
+    OP_REQUIRES_OK(ctx, ctx->input("bucket_boundaries", &boundaries_t));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(boundaries_t->shape()),
+                errors::InvalidArgument("bucket_boundaries must be a vector"));
+    const auto boundaries_vec = boundaries_t->vec<int64_t>();
+    std::vector<int64_t> boundaries(boundaries_vec.data(),
+                                    boundaries_vec.data() +
+                                        boundaries_vec.size());
+    for (size_t i = 1; i < boundaries.size(); ++i) {
+      OP_REQUIRES(ctx, boundaries[i - 1] < boundaries[i],
+                  errors::InvalidArgument(
+                      "bucket_boundaries must be strictly increasing, got ",
+                      boundaries[i - 1], " before ", boundaries[i]));
+    }
+
+    const Tensor* batch_sizes_t;
+    OP_REQUIRES_OK(ctx, ctx->input("bucket_batch_sizes", &batch_sizes_t));
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsVector(batch_sizes_t->shape()) &&
+                    batch_sizes_t->NumElements() == boundaries.size() + 1,
+                errors::InvalidArgument(
+                    "bucket_batch_sizes must be a vector with ",
+                    boundaries.size() + 1, " elements, got shape ",
+                    batch_sizes_t->shape().DebugString()));
+    const auto batch_sizes_vec = batch_sizes_t->vec<int64_t>();
+    std::vector<int64_t> batch_sizes(batch_sizes_vec.data(),
+                                     batch_sizes_vec.data() +
+                                         batch_sizes_vec.size());
+    for (int64_t batch_size : batch_sizes) {
+      OP_REQUIRES(ctx, batch_size > 0,
+                  errors::InvalidArgument(
+                      "Batch size must be greater than zero, but got ",
+                      batch_size, "."));
+    }
+
+    OpInputList padded_shape_tensors;
+    OP_REQUIRES_OK(ctx,
+                   ctx->input_list("padded_shapes", &padded_shape_tensors));
+    OP_REQUIRES(ctx,
+                padded_shape_tensors.size() == input->output_shapes().size(),
+                errors::InvalidArgument("Number of padded shapes (",
+                                        padded_shape_tensors.size(),
+                                        ") must match the number of components "
+                                        "in the input dataset's elements (",
+                                        input->output_shapes().size(), ")"));
+    std::vector<PartialTensorShape> padded_shapes;
+    padded_shapes.reserve(padded_shape_tensors.size());
+    for (const Tensor& padded_shape_t : padded_shape_tensors) {
+      OP_REQUIRES(ctx, TensorShapeUtils::IsVector(padded_shape_t.shape()),
+                  errors::InvalidArgument("All padded shapes must be vectors"));
+      PartialTensorShape padded_shape;
+      OP_REQUIRES_OK(ctx, PartialTensorShape::MakePartialShape(
+                              padded_shape_t.vec<int64_t>().data(),
+                              padded_shape_t.NumElements(), &padded_shape));
+      padded_shapes.push_back(std::move(padded_shape));
+    }
+
+    OpInputList padding_values_list;
+    OP_REQUIRES_OK(ctx,
+                   ctx->input_list("padding_values", &padding_values_list));
+    OP_REQUIRES(ctx,
+                padding_values_list.size() == input->output_shapes().size(),
+                errors::InvalidArgument(
+                    "Number of padding values (", padding_values_list.size(),
+                    ") must match the number of components in the input "
+                    "dataset's elements (",
+                    input->output_shapes().size(), ")"));
+    std::vector<Tensor> padding_values;
+    padding_values.reserve(padding_values_list.size());
+    for (int i = 0; i < padding_values_list.size(); ++i) {
+      const Tensor& padding_value_t = padding_values_list[i];
+      OP_REQUIRES(
+          ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+          errors::InvalidArgument("All padding values must be scalars"));
+      OP_REQUIRES(ctx, padding_value_t.dtype() == input->output_dtypes()[i],
+                  errors::InvalidArgument(
+                      "Mismatched type between padding value ", i,
+                      " and input dataset's component ", i, ": ",
+                      DataTypeString(padding_value_t.dtype()), " vs. ",
+                      DataTypeString(input->output_dtypes()[i])));
+      padding_values.push_back(tensor::DeepCopy(padding_value_t));
+    }
+
+    bool drop_remainder;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<bool>(ctx, "drop_remainder",
+                                                  &drop_remainder));
+
+    *output = new Dataset(ctx, input, std::move(captured_func),
+                          std::move(boundaries), std::move(batch_sizes),
+                          std::move(padded_shapes), std::move(padding_values),
+                          pad_to_bucket_boundary_, drop_remainder,
+                          output_shapes_);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const DatasetBase* input,
+            std::unique_ptr<CapturedFunction> captured_func,
+            std::vector<int64_t> boundaries, std::vector<int64_t> batch_sizes,
+            std::vector<PartialTensorShape> padded_shapes,
+            std::vector<Tensor> padding_values, bool pad_to_bucket_boundary,
+            bool drop_remainder,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : DatasetBase(DatasetContext(ctx)),
+          input_(input),
+          captured_func_(std::move(captured_func)),
+          boundaries_(std::move(boundaries)),
+          batch_sizes_(std::move(batch_sizes)),
+          padded_shapes_(std::move(padded_shapes)),
+          padding_values_(std::move(padding_values)),
+          pad_to_bucket_boundary_(pad_to_bucket_boundary),
+          drop_remainder_(drop_remainder),
+          output_shapes_(output_shapes) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return std::make_unique<Iterator>(Iterator::Params{
+          this, strings::StrCat(prefix, "::BucketBySequenceLength")});
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return input_->output_dtypes();
+    }
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() const override {
+      return "BucketBySequenceLengthDatasetOp::Dataset";
+    }
+
+    int64_t CardinalityInternal(CardinalityOptions options) const override {
+      int64_t n = input_->Cardinality(options);
+      if (n == kInfiniteCardinality) {
+        return n;
+      }
+      return kUnknownCardinality;
+    }
+
+    Status InputDatasets(
+        std::vector<const DatasetBase*>* inputs) const override {
+      inputs->push_back(input_);
+      return OkStatus();
+    }
+
+    Status CheckExternalState() const override {
+      TF_RETURN_IF_ERROR(captured_func_->CheckExternalState());
+      return input_->CheckExternalState();
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* input_graph_node = nullptr;
+      TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+
+      std::vector<Node*> other_arguments;
+      DataTypeVector other_arguments_types;
+      TF_RETURN_IF_ERROR(captured_func_->AddToGraph(ctx, b, &other_arguments,
+                                                    &other_arguments_types));
+
+      Node* boundaries = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(boundaries_, &boundaries));
+      Node* batch_sizes = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(batch_sizes_, &batch_sizes));
+
+      std::vector<Node*> padded_shapes;
+      padded_shapes.reserve(padded_shapes_.size());
+      for (const PartialTensorShape& padded_shape : padded_shapes_) {
+        Node* node;
+        Tensor t(DT_INT64, TensorShape({padded_shape.dims()}));
+        for (int j = 0; j < padded_shape.dims(); ++j) {
+          t.vec<int64_t>()(j) = padded_shape.dim_size(j);
+        }
+        TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+        padded_shapes.emplace_back(node);
+      }
+
+      std::vector<Node*> padding_values;
+      padding_values.reserve(padding_values_.size());
+      for (const Tensor& t : padding_values_) {
+        Node* node;
+        TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+        padding_values.emplace_back(node);
+      }
+
+      Node* drop_remainder = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(drop_remainder_, &drop_remainder));
+
+      AttrValue func;
+      b->BuildAttrValue(captured_func_->func(), &func);
+      AttrValue other_arguments_types_attr;
+      b->BuildAttrValue(other_arguments_types, &other_arguments_types_attr);
+      AttrValue pad_to_bucket_boundary;
+      b->BuildAttrValue(pad_to_bucket_boundary_, &pad_to_bucket_boundary);
+      AttrValue output_types;
+      b->BuildAttrValue(output_dtypes(), &output_types);
+      AttrValue N;
+      b->BuildAttrValue<int64_t>(padded_shapes_.size(), &N);
+
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this,
+          {{0, input_graph_node},
+           {2, boundaries},
+           {3, batch_sizes},
+           {6, drop_remainder}},
+          {{1, other_arguments}, {4, padded_shapes}, {5, padding_values}},
+          {{"element_length_func", func},
+           {"Telement_length_func_other_arguments",
+            other_arguments_types_attr},
+           {"pad_to_bucket_boundary", pad_to_bucket_boundary},
+           {"Toutput_types", output_types},
+           {"N", N}},
+          output));
+      return OkStatus();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params),
+            buckets_(params.dataset->batch_sizes_.size()) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        TF_RETURN_IF_ERROR(
+            dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+        return dataset()->captured_func_->Instantiate(ctx, &instantiated_func_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        while (!end_of_input_) {
+          std::vector<Tensor> element;
+          TF_RETURN_IF_ERROR(input_impl_->GetNext(
+              MakeNestedIteratorContext(ctx), &element, &end_of_input_));
+          if (end_of_input_) break;
+
+          int64_t bucket;
+          TF_RETURN_IF_ERROR(GetBucket(ctx, element, &bucket));
+          std::vector<std::vector<Tensor>>& elements = buckets_[bucket];
+          elements.push_back(std::move(element));
+          if (elements.size() == dataset()->batch_sizes_[bucket]) {
+            *end_of_sequence = false;
+            return FlushBucket(ctx, bucket, out_tensors);
+          }
+        }
+
+        // We have consumed all of the input, so flush the partial buckets in
+        // order, as `group_by_window` would.
+        for (int64_t bucket = 0; bucket < buckets_.size(); ++bucket) {
+          if (buckets_[bucket].empty()) continue;
+          if (dataset()->drop_remainder_) {
+            buckets_[bucket].clear();
+            continue;
+          }
+          *end_of_sequence = false;
+          return FlushBucket(ctx, bucket, out_tensors);
+        }
+        *end_of_sequence = true;
+        return OkStatus();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeUnknownRatioNode(std::move(args));
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        TF_RETURN_IF_ERROR(ctx->HandleCheckExternalStateStatus(
+            dataset()->captured_func_->CheckExternalState()));
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+        if (end_of_input_) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name("end_of_input"), ""));
+        }
+        for (int64_t bucket = 0; bucket < buckets_.size(); ++bucket) {
+          const string name = full_name(strings::StrCat("buckets_[", bucket,
+                                                        "]"));
+          const std::vector<std::vector<Tensor>>& elements = buckets_[bucket];
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              strings::StrCat(name, "_size"), elements.size()));
+          for (int i = 0; i < elements.size(); ++i) {
+            for (int j = 0; j < elements[i].size(); ++j) {
+              TF_RETURN_IF_ERROR(writer->WriteTensor(
+                  strings::StrCat(name, "[", i, "][", j, "]"),
+                  elements[i][j]));
+            }
+          }
+        }
+        return OkStatus();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+        end_of_input_ = reader->Contains(full_name("end_of_input"));
+        const size_t num_components = dataset()->output_dtypes().size();
+        for (int64_t bucket = 0; bucket < buckets_.size(); ++bucket) {
+          const string name = full_name(strings::StrCat("buckets_[", bucket,
+                                                        "]"));
+          int64_t size;
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(strings::StrCat(name, "_size"), &size));
+          std::vector<std::vector<Tensor>>& elements = buckets_[bucket];
+          elements.clear();
+          elements.resize(size);
+          for (int i = 0; i < size; ++i) {
+            elements[i].resize(num_components);
+            for (int j = 0; j < num_components; ++j) {
+              TF_RETURN_IF_ERROR(reader->ReadTensor(
+                  ctx->flr(), strings::StrCat(name, "[", i, "][", j, "]"),
+                  &elements[i][j]));
+            }
+          }
+        }
+        return OkStatus();
+      }
+
+     private:
+      // Runs `element_length_func` on `element` and returns the index of the
+      // first bucket whose boundary is greater than the length.
+      Status GetBucket(IteratorContext* ctx, const std::vector<Tensor>& element,
+                       int64_t* bucket) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        std::vector<Tensor> func_output;
+        TF_RETURN_IF_ERROR(instantiated_func_->RunWithBorrowedArgs(
+            ctx, element, &func_output, model_node()));
+        if (func_output.size() != 1 ||
+            !TensorShapeUtils::IsScalar(func_output[0].shape()) ||
+            (func_output[0].dtype() != DT_INT32 &&
+             func_output[0].dtype() != DT_INT64)) {
+          return errors::InvalidArgument(
+              "`element_length_func` must return a scalar int32 or int64.");
+        }
+        const int64_t length = func_output[0].dtype() == DT_INT32
+                                   ? func_output[0].scalar<int32>()()
+                                   : func_output[0].scalar<int64_t>()();
+        const std::vector<int64_t>& boundaries = dataset()->boundaries_;
+        *bucket = std::upper_bound(boundaries.begin(), boundaries.end(),
+                                   length) -
+                  boundaries.begin();
+        return OkStatus();
+      }
+
+      // Pads and batches the elements of `bucket` into `out_tensors`, and
+      // clears the bucket.
+      Status FlushBucket(IteratorContext* ctx, int64_t bucket,
+                         std::vector<Tensor>* out_tensors)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        std::vector<std::vector<Tensor>> batch_elements;
+        std::swap(batch_elements, buckets_[bucket]);
+        const int64_t num_batch_elements = batch_elements.size();
+        for (size_t component_index = 0;
+             component_index < dataset()->padded_shapes_.size();
+             ++component_index) {
+          // 1. Determine the shape of the padded tensor.
+          const PartialTensorShape& padded_shape =
+              dataset()->padded_shapes_[component_index];
+          TensorShape batch_component_shape({num_batch_elements});
+          for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+            int64_t dim_size = padded_shape.dim_size(dim);
+            if (dim_size == -1 && dataset()->pad_to_bucket_boundary_) {
+              if (bucket == dataset()->boundaries_.size()) {
+                return errors::InvalidArgument(
+                    "When pad_to_bucket_boundary=True, elements must have "
+                    "length < max(bucket_boundaries).");
+              }
+              dim_size = dataset()->boundaries_[bucket] - 1;
+            }
+            TF_RETURN_IF_ERROR(
+                batch_component_shape.AddDimWithStatus(std::max<int64_t>(
+                    dim_size, 0)));
+          }
+          for (const std::vector<Tensor>& element : batch_elements) {
+            const TensorShape& element_shape = element[component_index].shape();
+            if (element_shape.dims() != padded_shape.dims()) {
+              return errors::InvalidArgument(
+                  "All elements in a batch must have the same rank as the "
+                  "padded shape for component",
+                  component_index, ": expected rank ", padded_shape.dims(),
+                  " but got element with rank ", element_shape.dims());
+            }
+            for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+              const int64_t element_dim = element_shape.dim_size(dim);
+              if (element_dim <= batch_component_shape.dim_size(dim + 1)) {
+                continue;
+              }
+              if (padded_shape.dim_size(dim) == -1 &&
+                  !dataset()->pad_to_bucket_boundary_) {
+                // Take the max of all batch elements in this dimension.
+                batch_component_shape.set_dim(dim + 1, element_dim);
+              } else {
+                return errors::DataLoss(
+                    "Attempted to pad to a smaller size than the input "
+                    "element.");
+              }
+            }
+          }
+
+          // 2. Copy each batch element to the appropriate location in the
+          // output component tensor.
+          out_tensors->emplace_back(ctx->allocator({}),
+                                    dataset()->output_dtypes()[component_index],
+                                    batch_component_shape);
+          Tensor& batch_component = out_tensors->back();
+          TF_RETURN_IF_ERROR(batch_util::SetElementZero(
+              &batch_component, dataset()->padding_values_[component_index]));
+          TensorShape component_shape = batch_component_shape;
+          component_shape.RemoveDim(0);
+          for (int64_t i = 0; i < num_batch_elements; ++i) {
+            Tensor& element = batch_elements[i][component_index];
+            // Take the fast path if possible.
+            if (element.shape() == component_shape) {
+              TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+                  std::move(element), &batch_component, i));
+            } else {
+              TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
+                  element, &batch_component, i));
+            }
+          }
+        }
+        return OkStatus();
+      }
+
+      mutex mu_;
+      std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+      bool end_of_input_ TF_GUARDED_BY(mu_) = false;
+      // The elements buffered for each bucket, fewer than its batch size.
+      std::vector<std::vector<std::vector<Tensor>>> buckets_
+          TF_GUARDED_BY(mu_);
+      std::unique_ptr<InstantiatedCapturedFunction> instantiated_func_;
+    };
+
+    const DatasetBase* const input_;
+    const std::unique_ptr<CapturedFunction> captured_func_;
+    const std::vector<int64_t> boundaries_;
+    const std::vector<int64_t> batch_sizes_;
+    const std::vector<PartialTensorShape> padded_shapes_;
+    const std::vector<Tensor> padding_values_;
+    const bool pad_to_bucket_boundary_;
+    const bool drop_remainder_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  std::shared_ptr<FunctionMetadata> func_metadata_ = nullptr;
+  bool pad_to_bucket_boundary_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("BucketBySequenceLengthDataset").Device(DEVICE_CPU),
+    BucketBySequenceLengthDatasetOp);
+
+REGISTER_INPUT_COLOCATION_EXEMPTION("BucketBySequenceLengthDataset");
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,765 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/columnar_dataset_op.h"
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/data/columnar_utils.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/utils.h"
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/ragged_tensor_variant.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const ColumnarDatasetOp::kDatasetType;
+/* static */ constexpr const char* const ColumnarDatasetOp::kFileNames;
+/* static */ constexpr const char* const ColumnarDatasetOp::kBatchSize;
+/* static */ constexpr const char* const ColumnarDatasetOp::kNumParallelReads;
+/* static */ constexpr const char* const ColumnarDatasetOp::kDenseColumns;
+/* static */ constexpr const char* const ColumnarDatasetOp::kRaggedColumns;
+/* static */ constexpr const char* const ColumnarDatasetOp::kRaggedValueTypes;
+/* static */ constexpr const char* const ColumnarDatasetOp::kRaggedSplitTypes;
+/* static */ constexpr const char* const ColumnarDatasetOp::kOutputExamples;
+/* static */ constexpr const char* const ColumnarDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const ColumnarDatasetOp::kOutputShapes;
+
+namespace {
+
+constexpr char kFileIndex[] = "file_index";
+constexpr char kRowGroup[] = "row_group";
+constexpr char kRowOffset[] = "row_offset";
+
+// A column read by the dataset.
+struct ProjectedColumn {
+  std::string name;
+  bool ragged = false;
+  // The type of the column values.
+  DataType dtype = DT_INVALID;
+  // The type of the row splits of a ragged column.
+  DataType split_type = DT_INVALID;
+  // The shape of the output component of a dense column.
+  PartialTensorShape output_shape;
+};
+
+// Appends the values in `[begin, end)` of the flattened `values` to `feature`.
+Status AppendToFeature(const Tensor& values, int64_t begin, int64_t end,
+                       Feature* feature) {
+  switch (values.dtype()) {
+    case DT_FLOAT: {
+      auto flat = values.flat<float>();
+      auto* list = feature->mutable_float_list();
+      for (int64_t i = begin; i < end; ++i) list->add_value(flat(i));
+      return OkStatus();
+    }
+    case DT_INT64: {
+      auto flat = values.flat<int64_t>();
+      auto* list = feature->mutable_int64_list();
+      for (int64_t i = begin; i < end; ++i) list->add_value(flat(i));
+      return OkStatus();
+    }
+    case DT_STRING: {
+      auto flat = values.flat<tstring>();
+      auto* list = feature->mutable_bytes_list();
+      for (int64_t i = begin; i < end; ++i) {
+        list->add_value(flat(i).data(), flat(i).size());
+      }
+      return OkStatus();
+    }
+    default:
+      return errors::InvalidArgument(
+          "Only float, int64, and string columns can be converted to "
+          "tf.Example, but got a column of type ",
+          DataTypeString(values.dtype()), ".");
+  }
+}
+
+}  // namespace
+
+class ColumnarDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, std::vector<std::string> filenames,
+          int64_t batch_size, int64_t num_parallel_reads,
+          std::vector<ProjectedColumn> columns,
+          const std::vector<std::string>& dense_columns,
+          const std::vector<std::string>& ragged_columns,
+          const DataTypeVector& ragged_value_types,
+          const DataTypeVector& ragged_split_types, bool output_examples,
+          const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        filenames_(std::move(filenames)),
+        batch_size_(batch_size),
+        num_parallel_reads_(num_parallel_reads),
+        columns_(std::move(columns)),
+        dense_columns_(dense_columns),
+        ragged_columns_(ragged_columns),
+        ragged_value_types_(ragged_value_types),
+        ragged_split_types_(ragged_split_types),
+        output_examples_(output_examples),
+        output_types_(output_types),
+        output_shapes_(output_shapes) {}
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return output_types_;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override { return OkStatus(); }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* filenames = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+    Node* batch_size = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(batch_size_, &batch_size));
+    Node* num_parallel_reads = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(num_parallel_reads_, &num_parallel_reads));
+    AttrValue dense_columns;
+    b->BuildAttrValue(dense_columns_, &dense_columns);
+    AttrValue ragged_columns;
+    b->BuildAttrValue(ragged_columns_, &ragged_columns);
+    AttrValue ragged_value_types;
+    b->BuildAttrValue(ragged_value_types_, &ragged_value_types);
+    AttrValue ragged_split_types;
+    b->BuildAttrValue(ragged_split_types_, &ragged_split_types);
+    AttrValue output_examples;
+    b->BuildAttrValue(output_examples_, &output_examples);
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {filenames, batch_size, num_parallel_reads},
+        {{kDenseColumns, dense_columns},
+         {kRaggedColumns, ragged_columns},
+         {kRaggedValueTypes, ragged_value_types},
+         {kRaggedSplitTypes, ragged_split_types},
+         {kOutputExamples, output_examples}},
+        output));
+    return OkStatus();
+  }
+
+ private:
+  // Reads up to `num_parallel_reads` row groups ahead of the consumer, in
+  // file order, and assembles batches of rows from them. Row groups are read
+  // with `ctx->runner()`, one task per row group.
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    ~Iterator() override {
+      CancelReads(/*wait=*/true);
+      if (deregister_fn_) deregister_fn_();
+    }
+
+    bool SymbolicCheckpointCompatible() const override { return true; }
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      num_parallel_reads_ = dataset()->num_parallel_reads_;
+      if (num_parallel_reads_ == model::kAutotune) {
+        num_parallel_reads_ = GetAutotuneDefaultParallelism(ctx);
+      }
+      return RegisterCancellationCallback(
+          ctx->cancellation_manager(),
+          [this]() { CancelReads(/*wait=*/false); }, &deregister_fn_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      std::vector<Slice> slices;
+      {
+        mutex_lock l(mu_);
+        int64_t num_rows = 0;
+        while (num_rows < dataset()->batch_size_) {
+          ScheduleReadsLocked(ctx);
+          if (results_.empty()) break;
+          std::shared_ptr<RowGroupResult> result = results_.front();
+          while (!result->done && !cancelled_) {
+            RecordStop(ctx);
+            cond_var_.wait(l);
+            RecordStart(ctx);
+          }
+          if (cancelled_) {
+            return errors::Cancelled("Iterator was cancelled");
+          }
+          if (!result->status.ok()) {
+            results_.pop_front();
+            return result->status;
+          }
+          const int64_t n =
+              std::min(dataset()->batch_size_ - num_rows,
+                       result->num_rows - result->row_offset);
+          if (n > 0) slices.push_back({result, result->row_offset, n});
+          result->row_offset += n;
+          num_rows += n;
+          if (result->row_offset == result->num_rows) results_.pop_front();
+        }
+        // Keep the reads going while the batch is being assembled.
+        ScheduleReadsLocked(ctx);
+      }
+      if (slices.empty()) {
+        *end_of_sequence = true;
+        return OkStatus();
+      }
+      *end_of_sequence = false;
+      if (dataset()->output_examples_) {
+        return AssembleExamples(ctx, slices, out_tensors);
+      }
+      return AssembleColumns(ctx, slices, out_tensors);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      // The checkpoint records the position of the next row to produce. The
+      // row groups that have been read ahead are read again on restore.
+      int64_t file_index = next_file_index_;
+      int64_t row_group = next_row_group_;
+      int64_t row_offset = next_row_offset_;
+      if (!results_.empty()) {
+        file_index = results_.front()->file_index;
+        row_group = results_.front()->row_group;
+        row_offset = results_.front()->row_offset;
+      }
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kFileIndex), file_index));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kRowGroup), row_group));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kRowOffset), row_offset));
+      return OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t file_index, row_group, row_offset;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kFileIndex), &file_index));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kRowGroup), &row_group));
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kRowOffset), &row_offset));
+      if (file_index < 0 ||
+          file_index > static_cast<int64_t>(dataset()->filenames_.size()) ||
+          row_group < 0 || row_offset < 0) {
+        return errors::DataLoss("Invalid checkpoint position: file ",
+                                file_index, ", row group ", row_group,
+                                ", row offset ", row_offset, ".");
+      }
+      // Reads that are still in flight complete into results that are no
+      // longer referenced by `results_`.
+      results_.clear();
+      file_.reset();
+      next_file_index_ = file_index;
+      next_row_group_ = row_group;
+      next_row_offset_ = row_offset;
+      return OkStatus();
+    }
+
+   private:
+    // A file whose footer has been read.
+    struct OpenFile {
+      std::unique_ptr<ColumnarFileReader> reader;
+      // The index of each read column in the file's schema, in the order of
+      // `dataset()->columns_` (or of the schema in `output_examples` mode).
+      std::vector<int64_t> column_indices;
+    };
+
+    // The columns of one row group. Once `done` is set, only `row_offset` is
+    // modified, and only by the consumer.
+    struct RowGroupResult {
+      int64_t file_index = 0;
+      int64_t row_group = 0;
+      int64_t num_rows = 0;
+      // The number of rows that have been consumed.
+      int64_t row_offset = 0;
+      std::shared_ptr<const OpenFile> file;
+      std::vector<ColumnarChunk> chunks;
+      bool done = false;
+      Status status;
+    };
+
+    // A range of rows of a row group.
+    struct Slice {
+      std::shared_ptr<RowGroupResult> result;
+      int64_t begin;
+      int64_t num_rows;
+    };
+
+    void CancelReads(bool wait) TF_LOCKS_EXCLUDED(mu_) {
+      mutex_lock l(mu_);
+      cancelled_ = true;
+      cond_var_.notify_all();
+      while (wait && num_in_flight_ > 0) {
+        cond_var_.wait(l);
+      }
+    }
+
+    // Opens the file at `next_file_index_` and resolves the read columns.
+    Status OpenFileLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const std::string& filename = dataset()->filenames_[next_file_index_];
+      auto file = std::make_shared<OpenFile>();
+      TF_RETURN_IF_ERROR(ColumnarFileReader::Open(
+          env, TranslateFileName(filename), &file->reader));
+      const ColumnarFileFooter& footer = file->reader->footer();
+      if (dataset()->output_examples_) {
+        for (int64_t i = 0; i < footer.columns_size(); ++i) {
+          const DataType dtype = footer.columns(i).dtype();
+          if (dtype != DT_FLOAT && dtype != DT_INT64 && dtype != DT_STRING) {
+            return errors::InvalidArgument(
+                "Column ", footer.columns(i).name(), " of file ", filename,
+                " has type ", DataTypeString(dtype),
+                ", which cannot be converted to tf.Example.");
+          }
+          file->column_indices.push_back(i);
+        }
+      } else {
+        for (const ProjectedColumn& column : dataset()->columns_) {
+          TF_ASSIGN_OR_RETURN(int64_t index,
+                              file->reader->FindColumn(column.name));
+          const ColumnarColumnSchema& schema = footer.columns(index);
+          if (schema.ragged() != column.ragged ||
+              schema.dtype() != column.dtype) {
+            return errors::InvalidArgument(
+                "Column ", column.name, " of file ", filename, " is a ",
+                schema.ragged() ? "ragged" : "dense", " column of type ",
+                DataTypeString(schema.dtype()), ", but a ",
+                column.ragged ? "ragged" : "dense", " column of type ",
+                DataTypeString(column.dtype), " was requested.");
+          }
+          if (!column.ragged) {
+            TF_ASSIGN_OR_RETURN(
+                PartialTensorShape row_shape,
+                PartialTensorShape::BuildPartialTensorShape(
+                    schema.row_shape()));
+            PartialTensorShape shape({-1});
+            TF_RETURN_IF_ERROR(shape.ConcatenateWithStatus(row_shape, &shape));
+            if (!shape.IsCompatibleWith(column.output_shape)) {
+              return errors::InvalidArgument(
+                  "Column ", column.name, " of file ", filename,
+                  " has batched shape ", shape.DebugString(),
+                  ", which is incompatible with the output shape ",
+                  column.output_shape.DebugString(), ".");
+            }
+          }
+          file->column_indices.push_back(index);
+        }
+      }
+      if (next_row_group_ > file->reader->num_row_groups()) {
+        return errors::DataLoss("Invalid row group ", next_row_group_,
+                                " for file ", filename, " with ",
+                                file->reader->num_row_groups(),
+                                " row groups.");
+      }
+      file_ = std::move(file);
+      return OkStatus();
+    }
+
+    // Starts reading row groups until `num_parallel_reads_` row groups are
+    // pending or there are no more row groups. Errors are queued as results,
+    // so that they are returned in order.
+    void ScheduleReadsLocked(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      while (!cancelled_ &&
+             static_cast<int64_t>(results_.size()) < num_parallel_reads_ &&
+             next_file_index_ <
+                 static_cast<int64_t>(dataset()->filenames_.size())) {
+        auto result = std::make_shared<RowGroupResult>();
+        result->file_index = next_file_index_;
+        result->row_group = next_row_group_;
+        result->row_offset = next_row_offset_;
+        if (file_ == nullptr) {
+          Status s = OpenFileLocked(ctx->env());
+          if (!s.ok()) {
+            result->status = s;
+            result->done = true;
+            results_.push_back(std::move(result));
+            AdvanceFileLocked();
+            continue;
+          }
+        }
+        if (next_row_group_ == file_->reader->num_row_groups()) {
+          AdvanceFileLocked();
+          continue;
+        }
+        result->file = file_;
+        result->num_rows =
+            file_->reader->footer().row_groups(next_row_group_).num_rows();
+        if (result->row_offset > result->num_rows) {
+          result->status = errors::DataLoss(
+              "Invalid row offset ", result->row_offset, " for row group ",
+              next_row_group_, " with ", result->num_rows, " rows.");
+          result->done = true;
+        }
+        results_.push_back(result);
+        ++next_row_group_;
+        next_row_offset_ = 0;
+        if (result->done) continue;
+        ++num_in_flight_;
+        (*ctx->runner())([this, result = std::move(result)]() {
+          ReadRowGroup(result.get());
+        });
+      }
+    }
+
+    void AdvanceFileLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      file_.reset();
+      ++next_file_index_;
+      next_row_group_ = 0;
+      next_row_offset_ = 0;
+    }
+
+    void ReadRowGroup(RowGroupResult* result) TF_LOCKS_EXCLUDED(mu_) {
+      std::vector<ColumnarChunk> chunks(result->file->column_indices.size());
+      Status s;
+      for (int i = 0; i < chunks.size() && s.ok(); ++i) {
+        s = result->file->reader->ReadChunk(
+            result->row_group, result->file->column_indices[i], &chunks[i]);
+      }
+      mutex_lock l(mu_);
+      result->chunks = std::move(chunks);
+      result->status = s;
+      result->done = true;
+      --num_in_flight_;
+      cond_var_.notify_all();
+    }
+
+    Status AssembleColumns(IteratorContext* ctx,
+                           const std::vector<Slice>& slices,
+                           std::vector<Tensor>* out_tensors) {
+      int64_t num_rows = 0;
+      for (const Slice& slice : slices) num_rows += slice.num_rows;
+      const std::vector<ProjectedColumn>& columns = dataset()->columns_;
+      out_tensors->reserve(columns.size());
+      for (int i = 0; i < columns.size(); ++i) {
+        const ProjectedColumn& column = columns[i];
+        if (column.ragged) {
+          TF_ASSIGN_OR_RETURN(Tensor ragged,
+                              AssembleRaggedColumn(ctx, slices, i, num_rows));
+          out_tensors->push_back(std::move(ragged));
+          continue;
+        }
+        TensorShape shape = slices[0].result->chunks[i].values.shape();
+        shape.set_dim(0, num_rows);
+        Tensor values(ctx->allocator({}), column.dtype, shape);
+        int64_t offset = 0;
+        for (const Slice& slice : slices) {
+          const Tensor& chunk = slice.result->chunks[i].values;
+          bool same_row_shape = chunk.dims() == shape.dims();
+          for (int d = 1; same_row_shape && d < shape.dims(); ++d) {
+            same_row_shape = chunk.dim_size(d) == shape.dim_size(d);
+          }
+          if (!same_row_shape) {
+            return errors::InvalidArgument("Cannot batch rows of column ",
+                                           column.name,
+                                           " with different shapes.");
+          }
+          TF_RETURN_IF_ERROR(batch_util::CopyContiguousSlices(
+              chunk, slice.begin, offset, slice.num_rows, &values));
+          offset += slice.num_rows;
+        }
+        out_tensors->push_back(std::move(values));
+      }
+      return OkStatus();
+    }
+
+    StatusOr<Tensor> AssembleRaggedColumn(IteratorContext* ctx,
+                                          const std::vector<Slice>& slices,
+                                          int column_index, int64_t num_rows) {
+      const ProjectedColumn& column = dataset()->columns_[column_index];
+      int64_t num_values = 0;
+      for (const Slice& slice : slices) {
+        auto splits =
+            slice.result->chunks[column_index].row_splits.vec<int64_t>();
+        num_values +=
+            splits(slice.begin + slice.num_rows) - splits(slice.begin);
+      }
+      if (column.split_type == DT_INT32 &&
+          num_values > std::numeric_limits<int32>::max()) {
+        return errors::InvalidArgument(
+            "Ragged column ", column.name, " has ", num_values,
+            " values in a batch, which do not fit int32 row splits.");
+      }
+      Tensor values(ctx->allocator({}), column.dtype,
+                    TensorShape({num_values}));
+      Tensor row_splits(ctx->allocator({}), column.split_type,
+                        TensorShape({num_rows + 1}));
+      int64_t row = 0;
+      int64_t offset = 0;
+      auto set_split = [&](int64_t index, int64_t value) {
+        if (column.split_type == DT_INT32) {
+          row_splits.vec<int32>()(index) = static_cast<int32>(value);
+        } else {
+          row_splits.vec<int64_t>()(index) = value;
+        }
+      };
+      set_split(0, 0);
+      for (const Slice& slice : slices) {
+        const ColumnarChunk& chunk = slice.result->chunks[column_index];
+        auto splits = chunk.row_splits.vec<int64_t>();
+        const int64_t begin = splits(slice.begin);
+        for (int64_t r = 1; r <= slice.num_rows; ++r) {
+          set_split(row + r, offset + splits(slice.begin + r) - begin);
+        }
+        const int64_t count = splits(slice.begin + slice.num_rows) - begin;
+        if (count > 0) {
+          TF_RETURN_IF_ERROR(batch_util::CopyContiguousSlices(
+              chunk.values, begin, offset, count, &values));
+        }
+        row += slice.num_rows;
+        offset += count;
+      }
+      RaggedTensorVariant ragged;
+      ragged.set_values(values);
+      ragged.append_splits(row_splits);
+      Tensor output(ctx->allocator({}), DT_VARIANT, TensorShape({}));
+      output.scalar<Variant>()() = std::move(ragged);
+      return output;
+    }
+
+    Status AssembleExamples(IteratorContext* ctx,
+                            const std::vector<Slice>& slices,
+                            std::vector<Tensor>* out_tensors) {
+      int64_t num_rows = 0;
+      for (const Slice& slice : slices) num_rows += slice.num_rows;
+      Tensor serialized(ctx->allocator({}), DT_STRING,
+                        TensorShape({num_rows}));
+      auto flat = serialized.vec<tstring>();
+      int64_t row = 0;
+      for (const Slice& slice : slices) {
+        const ColumnarFileFooter& footer = slice.result->file->reader->footer();
+        const std::vector<ColumnarChunk>& chunks = slice.result->chunks;
+        for (int64_t r = slice.begin; r < slice.begin + slice.num_rows; ++r) {
+          Example example;
+          auto& features = *example.mutable_features()->mutable_feature();
+          for (int i = 0; i < chunks.size(); ++i) {
+            const ColumnarColumnSchema& schema =
+                footer.columns(slice.result->file->column_indices[i]);
+            Feature& feature = features[schema.name()];
+            const Tensor& values = chunks[i].values;
+            int64_t begin, end;
+            if (schema.ragged()) {
+              auto splits = chunks[i].row_splits.vec<int64_t>();
+              begin = splits(r);
+              end = splits(r + 1);
+            } else {
+              const int64_t row_size =
+                  values.NumElements() / slice.result->num_rows;
+              begin = r * row_size;
+              end = begin + row_size;
+            }
+            TF_RETURN_IF_ERROR(AppendToFeature(values, begin, end, &feature));
+          }
+          if (!SerializeToTString(example, &flat(row))) {
+            return errors::Internal("Failed to serialize a tf.Example.");
+          }
+          ++row;
+        }
+      }
+      out_tensors->push_back(std::move(serialized));
+      return OkStatus();
+    }
+
+    mutex mu_;
+    condition_variable cond_var_;
+    int64_t num_parallel_reads_ TF_GUARDED_BY(mu_) = 1;
+    // The position of the next row group to read.
+    int64_t next_file_index_ TF_GUARDED_BY(mu_) = 0;
+    int64_t next_row_group_ TF_GUARDED_BY(mu_) = 0;
+    // The number of rows of the next row group that have already been
+    // consumed. Only non-zero after restoring from a checkpoint.
+    int64_t next_row_offset_ TF_GUARDED_BY(mu_) = 0;
+    // The file at `next_file_index_`, once opened.
+    std::shared_ptr<const OpenFile> file_ TF_GUARDED_BY(mu_);
+    // Row groups that are read or being read, in file order.
+    std::deque<std::shared_ptr<RowGroupResult>> results_ TF_GUARDED_BY(mu_);
+    int64_t num_in_flight_ TF_GUARDED_BY(mu_) = 0;
+    bool cancelled_ TF_GUARDED_BY(mu_) = false;
+    // Method for deregistering the cancellation callback.
+    std::function<void()> deregister_fn_;
+  };
+
+  const std::vector<std::string> filenames_;
+  const int64_t batch_size_;
+  const int64_t num_parallel_reads_;
+  // The read columns, sorted by name, in output order.
+  const std::vector<ProjectedColumn> columns_;
+  const std::vector<std::string> dense_columns_;
+  const std::vector<std::string> ragged_columns_;
+  const DataTypeVector ragged_value_types_;
+  const DataTypeVector ragged_split_types_;
+  const bool output_examples_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+};
+
+ColumnarDatasetOp::ColumnarDatasetOp(OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kDenseColumns, &dense_columns_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kRaggedColumns, &ragged_columns_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kRaggedValueTypes, &ragged_value_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kRaggedSplitTypes, &ragged_split_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputExamples, &output_examples_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+  OP_REQUIRES(ctx,
+              ragged_value_types_.size() == ragged_columns_.size() &&
+                  ragged_split_types_.size() == ragged_columns_.size(),
+              errors::InvalidArgument(
+                  "`ragged_value_types` and `ragged_split_types` must have "
+                  "the same length as `ragged_columns`."));
+  OP_REQUIRES(ctx, output_types_.size() == output_shapes_.size(),
+              errors::InvalidArgument(
+                  "`output_types` and `output_shapes` must have the same "
+                  "length."));
+  if (output_examples_) {
+    OP_REQUIRES(
+        ctx,
+        dense_columns_.empty() && ragged_columns_.empty() &&
+            output_types_.size() == 1 && output_types_[0] == DT_STRING,
+        errors::InvalidArgument(
+            "If `output_examples` is set, no columns may be specified and "
+            "the output must be a single string component."));
+  } else {
+    OP_REQUIRES(ctx,
+                output_types_.size() ==
+                    dense_columns_.size() + ragged_columns_.size(),
+                errors::InvalidArgument(
+                    "Expected one output per column, but got ",
+                    output_types_.size(), " outputs for ",
+                    dense_columns_.size() + ragged_columns_.size(),
+                    " columns."));
+  }
+}
+
+void ColumnarDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                    DatasetBase** output) {
+  const Tensor* filenames_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kFileNames, &filenames_tensor));
+  OP_REQUIRES(
+      ctx, filenames_tensor->dims() <= 1,
+      errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+  std::vector<std::string> filenames;
+  filenames.reserve(filenames_tensor->NumElements());
+  for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+    filenames.push_back(filenames_tensor->flat<tstring>()(i));
+  }
+
+  int64_t batch_size = 0;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, kBatchSize, &batch_size));
+  OP_REQUIRES(ctx, batch_size > 0,
+              errors::InvalidArgument("`batch_size` must be greater than 0."));
+
+  int64_t num_parallel_reads = 0;
+  OP_REQUIRES_OK(
+      ctx, ParseScalarArgument(ctx, kNumParallelReads, &num_parallel_reads));
+  OP_REQUIRES(
+      ctx, num_parallel_reads > 0 || num_parallel_reads == model::kAutotune,
+      errors::InvalidArgument(
+          "`num_parallel_reads` must be greater than 0 or AUTOTUNE."));
+
+  std::vector<ProjectedColumn> columns;
+  absl::flat_hash_set<std::string> names;
+  for (const std::string& name : dense_columns_) {
+    ProjectedColumn column;
+    column.name = name;
+    columns.push_back(std::move(column));
+  }
+  for (int i = 0; i < ragged_columns_.size(); ++i) {
+    ProjectedColumn column;
+    column.name = ragged_columns_[i];
+    column.ragged = true;
+    column.dtype = ragged_value_types_[i];
+    column.split_type = ragged_split_types_[i];
+    columns.push_back(std::move(column));
+  }
+  for (const ProjectedColumn& column : columns) {
+    OP_REQUIRES(ctx, names.insert(column.name).second,
+                errors::InvalidArgument("Duplicate column: ", column.name));
+  }
+  std::sort(columns.begin(), columns.end(),
+            [](const ProjectedColumn& a, const ProjectedColumn& b) {
+              return a.name < b.name;
+            });
+  for (int i = 0; i < columns.size(); ++i) {
+    ProjectedColumn& column = columns[i];
+    if (column.ragged) {
+      OP_REQUIRES(ctx, output_types_[i] == DT_VARIANT,
+                  errors::InvalidArgument(
+                      "The output of ragged column ", column.name,
+                      " must have type variant."));
+      continue;
+    }
+    column.dtype = output_types_[i];
+    column.output_shape = output_shapes_[i];
+  }
+
+  *output = new Dataset(ctx, std::move(filenames), batch_size,
+                        num_parallel_reads, std::move(columns), dense_columns_,
+                        ragged_columns_, ragged_value_types_,
+                        ragged_split_types_, output_examples_, output_types_,
+                        output_shapes_);
+}
+
+namespace {
+
+REGISTER_KERNEL_BUILDER(Name("ColumnarDataset").Device(DEVICE_CPU),
+                        ColumnarDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,314 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/columnar_dataset_op.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/columnar_utils.h"
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ragged_tensor_variant.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "columnar_dataset";
+
+class ColumnarDatasetParams : public DatasetParams {
+ public:
+  ColumnarDatasetParams(std::vector<tstring> filenames, int64_t batch_size,
+                        int64_t num_parallel_reads,
+                        std::vector<string> dense_columns,
+                        std::vector<string> ragged_columns,
+                        DataTypeVector ragged_value_types,
+                        DataTypeVector ragged_split_types,
+                        bool output_examples, DataTypeVector output_dtypes,
+                        std::vector<PartialTensorShape> output_shapes,
+                        string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        filenames_(std::move(filenames)),
+        batch_size_(batch_size),
+        num_parallel_reads_(num_parallel_reads),
+        dense_columns_(std::move(dense_columns)),
+        ragged_columns_(std::move(ragged_columns)),
+        ragged_value_types_(std::move(ragged_value_types)),
+        ragged_split_types_(std::move(ragged_split_types)),
+        output_examples_(output_examples) {}
+
+  std::vector<Tensor> GetInputTensors() const override {
+    int num_files = filenames_.size();
+    return {CreateTensor<tstring>(TensorShape({num_files}), filenames_),
+            CreateTensor<int64_t>(TensorShape({}), {batch_size_}),
+            CreateTensor<int64_t>(TensorShape({}), {num_parallel_reads_})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {ColumnarDatasetOp::kFileNames,
+                    ColumnarDatasetOp::kBatchSize,
+                    ColumnarDatasetOp::kNumParallelReads};
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {
+        {ColumnarDatasetOp::kDenseColumns, dense_columns_},
+        {ColumnarDatasetOp::kRaggedColumns, ragged_columns_},
+        {ColumnarDatasetOp::kRaggedValueTypes, ragged_value_types_},
+        {ColumnarDatasetOp::kRaggedSplitTypes, ragged_split_types_},
+        {ColumnarDatasetOp::kOutputExamples, output_examples_},
+        {ColumnarDatasetOp::kOutputTypes, output_dtypes_},
+        {ColumnarDatasetOp::kOutputShapes, output_shapes_},
+        {"metadata", ""}};
+    return OkStatus();
+  }
+
+  string dataset_type() const override {
+    return ColumnarDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<tstring> filenames_;
+  int64_t batch_size_;
+  int64_t num_parallel_reads_;
+  std::vector<string> dense_columns_;
+  std::vector<string> ragged_columns_;
+  DataTypeVector ragged_value_types_;
+  DataTypeVector ragged_split_types_;
+  bool output_examples_;
+};
+
+class ColumnarDatasetOpTest : public DatasetOpsTestBase {};
+
+// Writes a file with columns `ids` (int64), `embedding` (float, [2]), and
+// `tokens` (ragged string). Row `r` (counting from `first_row`) has id `r`,
+// embedding `[r, -r]`, and `r % 3` tokens.
+Status WriteTestFile(const std::string& filename, int64_t first_row,
+                     const std::vector<int64_t>& row_group_sizes) {
+  std::vector<ColumnarColumnSchema> columns(3);
+  columns[0].set_name("ids");
+  columns[0].set_dtype(DT_INT64);
+  columns[1].set_name("embedding");
+  columns[1].set_dtype(DT_FLOAT);
+  columns[1].mutable_row_shape()->add_dim()->set_size(2);
+  columns[2].set_name("tokens");
+  columns[2].set_dtype(DT_STRING);
+  columns[2].set_ragged(true);
+  std::unique_ptr<ColumnarFileWriter> writer;
+  TF_RETURN_IF_ERROR(ColumnarFileWriter::Create(Env::Default(), filename,
+                                                std::move(columns), &writer));
+  int64_t row = first_row;
+  for (int64_t num_rows : row_group_sizes) {
+    std::vector<ColumnarChunk> chunks(3);
+    chunks[0].values = Tensor(DT_INT64, {num_rows});
+    chunks[1].values = Tensor(DT_FLOAT, {num_rows, 2});
+    chunks[2].row_splits = Tensor(DT_INT64, {num_rows + 1});
+    chunks[2].row_splits.vec<int64_t>()(0) = 0;
+    std::vector<tstring> tokens;
+    for (int64_t i = 0; i < num_rows; ++i, ++row) {
+      chunks[0].values.vec<int64_t>()(i) = row;
+      chunks[1].values.matrix<float>()(i, 0) = row;
+      chunks[1].values.matrix<float>()(i, 1) = -row;
+      for (int64_t j = 0; j < row % 3; ++j) {
+        tokens.push_back(absl::StrCat("token_", row, "_", j));
+      }
+      chunks[2].row_splits.vec<int64_t>()(i + 1) = tokens.size();
+    }
+    chunks[2].values = test::AsTensor<tstring>(tokens);
+    TF_RETURN_IF_ERROR(writer->WriteRowGroup(chunks));
+  }
+  return writer->Close();
+}
+
+// Returns two files with five rows in total: the first file has row groups of
+// two and one rows, and the second file has one row group of two rows.
+std::vector<tstring> TestFiles() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(::tensorflow::testing::TmpDir(), "/columnar_1"),
+      absl::StrCat(::tensorflow::testing::TmpDir(), "/columnar_2")};
+  Status s = WriteTestFile(filenames[0], /*first_row=*/0, {2, 1});
+  if (s.ok()) s = WriteTestFile(filenames[1], /*first_row=*/3, {2});
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to create the test files: " << s;
+  }
+  return filenames;
+}
+
+// Reads the dense `embedding` and `ids` columns in batches of two.
+ColumnarDatasetParams DenseColumnsParams(int64_t num_parallel_reads) {
+  return ColumnarDatasetParams(
+      TestFiles(), /*batch_size=*/2, num_parallel_reads,
+      /*dense_columns=*/{"ids", "embedding"}, /*ragged_columns=*/{},
+      /*ragged_value_types=*/{}, /*ragged_split_types=*/{},
+      /*output_examples=*/false,
+      /*output_dtypes=*/{DT_FLOAT, DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, 2}), PartialTensorShape({-1})},
+      /*node_name=*/kNodeName);
+}
+
+std::vector<Tensor> DenseColumnsOutputs() {
+  return {CreateTensor<float>(TensorShape({2, 2}), {0, 0, 1, -1}),
+          CreateTensor<int64_t>(TensorShape({2}), {0, 1}),
+          CreateTensor<float>(TensorShape({2, 2}), {2, -2, 3, -3}),
+          CreateTensor<int64_t>(TensorShape({2}), {2, 3}),
+          CreateTensor<float>(TensorShape({1, 2}), {4, -4}),
+          CreateTensor<int64_t>(TensorShape({1}), {4})};
+}
+
+std::vector<GetNextTestCase<ColumnarDatasetParams>> GetNextTestCases() {
+  return {{/*dataset_params=*/DenseColumnsParams(/*num_parallel_reads=*/1),
+           /*expected_outputs=*/DenseColumnsOutputs()},
+          {/*dataset_params=*/DenseColumnsParams(/*num_parallel_reads=*/3),
+           /*expected_outputs=*/DenseColumnsOutputs()},
+          {/*dataset_params=*/DenseColumnsParams(model::kAutotune),
+           /*expected_outputs=*/DenseColumnsOutputs()}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(ColumnarDatasetOpTest, ColumnarDatasetParams,
+                         GetNextTestCases())
+
+std::vector<IteratorSaveAndRestoreTestCase<ColumnarDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/DenseColumnsParams(/*num_parallel_reads=*/1),
+           /*breakpoints=*/{0, 1, 4},
+           /*expected_outputs=*/DenseColumnsOutputs()},
+          {/*dataset_params=*/DenseColumnsParams(/*num_parallel_reads=*/3),
+           /*breakpoints=*/{0, 2, 4},
+           /*expected_outputs=*/DenseColumnsOutputs()}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(ColumnarDatasetOpTest, ColumnarDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+TEST_F(ColumnarDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = DenseColumnsParams(/*num_parallel_reads=*/1);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(ColumnarDatasetOp::kDatasetType)));
+}
+
+TEST_F(ColumnarDatasetOpTest, Cardinality) {
+  auto dataset_params = DenseColumnsParams(/*num_parallel_reads=*/1);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
+}
+
+TEST_F(ColumnarDatasetOpTest, IteratorPrefix) {
+  auto dataset_params = DenseColumnsParams(/*num_parallel_reads=*/1);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorPrefix(name_utils::IteratorPrefix(
+      ColumnarDatasetOp::kDatasetType, dataset_params.iterator_prefix())));
+}
+
+TEST_F(ColumnarDatasetOpTest, RaggedColumn) {
+  auto dataset_params = ColumnarDatasetParams(
+      TestFiles(), /*batch_size=*/4, /*num_parallel_reads=*/2,
+      /*dense_columns=*/{}, /*ragged_columns=*/{"tokens"},
+      /*ragged_value_types=*/{DT_STRING}, /*ragged_split_types=*/{DT_INT32},
+      /*output_examples=*/false, /*output_dtypes=*/{DT_VARIANT},
+      /*output_shapes=*/{PartialTensorShape({})}, /*node_name=*/kNodeName);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> out_tensors;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                  &end_of_sequence));
+  ASSERT_FALSE(end_of_sequence);
+  ASSERT_EQ(out_tensors.size(), 1);
+  const auto* ragged =
+      out_tensors[0].scalar<Variant>()().get<RaggedTensorVariant>();
+  ASSERT_NE(ragged, nullptr);
+  // Rows 0 to 3 have 0, 1, 2, and 0 tokens.
+  test::ExpectTensorEqual<int32>(ragged->splits(0),
+                                 test::AsTensor<int32>({0, 0, 1, 3, 3}));
+  test::ExpectTensorEqual<tstring>(
+      ragged->values(),
+      test::AsTensor<tstring>({"token_1_0", "token_2_0", "token_2_1"}));
+}
+
+TEST_F(ColumnarDatasetOpTest, OutputExamples) {
+  auto dataset_params = ColumnarDatasetParams(
+      TestFiles(), /*batch_size=*/5, /*num_parallel_reads=*/2,
+      /*dense_columns=*/{}, /*ragged_columns=*/{}, /*ragged_value_types=*/{},
+      /*ragged_split_types=*/{}, /*output_examples=*/true,
+      /*output_dtypes=*/{DT_STRING},
+      /*output_shapes=*/{PartialTensorShape({-1})}, /*node_name=*/kNodeName);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> out_tensors;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                  &end_of_sequence));
+  ASSERT_FALSE(end_of_sequence);
+  ASSERT_EQ(out_tensors[0].NumElements(), 5);
+  Example example;
+  ASSERT_TRUE(example.ParseFromString(out_tensors[0].vec<tstring>()(4)));
+  const auto& features = example.features().feature();
+  EXPECT_EQ(features.at("ids").int64_list().value(0), 4);
+  EXPECT_EQ(features.at("embedding").float_list().value_size(), 2);
+  EXPECT_EQ(features.at("embedding").float_list().value(1), -4);
+  ASSERT_EQ(features.at("tokens").bytes_list().value_size(), 1);
+  EXPECT_EQ(features.at("tokens").bytes_list().value(0), "token_4_0");
+}
+
+TEST_F(ColumnarDatasetOpTest, MissingColumn) {
+  auto dataset_params = ColumnarDatasetParams(
+      TestFiles(), /*batch_size=*/2, /*num_parallel_reads=*/1,
+      /*dense_columns=*/{"labels"}, /*ragged_columns=*/{},
+      /*ragged_value_types=*/{}, /*ragged_split_types=*/{},
+      /*output_examples=*/false, /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1})}, /*node_name=*/kNodeName);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> out_tensors;
+  bool end_of_sequence = false;
+  EXPECT_EQ(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                               &end_of_sequence)
+                .code(),
+            error::NOT_FOUND);
+}
+
+TEST_F(ColumnarDatasetOpTest, MismatchedColumnType) {
+  auto dataset_params = ColumnarDatasetParams(
+      TestFiles(), /*batch_size=*/2, /*num_parallel_reads=*/1,
+      /*dense_columns=*/{"ids"}, /*ragged_columns=*/{},
+      /*ragged_value_types=*/{}, /*ragged_split_types=*/{},
+      /*output_examples=*/false, /*output_dtypes=*/{DT_FLOAT},
+      /*output_shapes=*/{PartialTensorShape({-1})}, /*node_name=*/kNodeName);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> out_tensors;
+  bool end_of_sequence = false;
+  EXPECT_EQ(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                               &end_of_sequence)
+                .code(),
+            error::INVALID_ARGUMENT);
+}
+
+TEST_F(ColumnarDatasetOpTest, InvalidBatchSize) {
+  auto dataset_params = ColumnarDatasetParams(
+      TestFiles(), /*batch_size=*/0, /*num_parallel_reads=*/1,
+      /*dense_columns=*/{"ids"}, /*ragged_columns=*/{},
+      /*ragged_value_types=*/{}, /*ragged_split_types=*/{},
+      /*output_examples=*/false, /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1})}, /*node_name=*/kNodeName);
+  EXPECT_EQ(Initialize(dataset_params).code(), error::INVALID_ARGUMENT);
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/experimental/compression_ops.h"
 
+#include <string>
+
 #include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
@@ -25,7 +27,22 @@ namespace data {
 namespace experimental {
 
 CompressElementOp::CompressElementOp(OpKernelConstruction* ctx)
-    : OpKernel(ctx) {}
+    : OpKernel(ctx) {
+  // Graphs created before the attr was added default to Snappy.
+  if (ctx->HasAttr(kCodec)) {
+    std::string codec;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kCodec, &codec));
+    if (codec == "zstd") {
+      codec_ = CompressedElement::CODEC_ZSTD;
+    } else if (codec == "none") {
+      codec_ = CompressedElement::CODEC_NONE;
+    } else {
+      OP_REQUIRES(ctx, codec == "snappy",
+                  errors::InvalidArgument("Unsupported compression codec: ",
+                                          codec));
+    }
+  }
+}
 
 void CompressElementOp::Compute(OpKernelContext* ctx) {
   std::vector<Tensor> components;
@@ -33,7 +50,7 @@ void CompressElementOp::Compute(OpKernelContext* ctx) {
     components.push_back(ctx->input(i));
   }
   CompressedElement compressed;
-  OP_REQUIRES_OK(ctx, CompressElement(components, &compressed));
+  OP_REQUIRES_OK(ctx, CompressElement(components, codec_, &compressed));
 
   Tensor* output;
   OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
@@ -85,6 +85,8 @@ namespace data {
 /* static */ constexpr const char* const DataServiceDatasetOp::kUncompressFn;
 /* static */ constexpr const char* const
     DataServiceDatasetOp::kCrossTrainerCacheOptions;
+/* static */ constexpr const char* const
+    DataServiceDatasetOp::kMaxElementsPerRequest;
 
 namespace {
 constexpr char kDataServiceDatasetV1[] = "DataServiceDataset";
@@ -114,7 +116,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       std::unique_ptr<CapturedFunction> captured_uncompress_func,
       const std::optional<CrossTrainerCacheOptions>&
           cross_trainer_cache_options,
-      const DataTypeVector& output_types,
+      int64_t max_elements_per_request, const DataTypeVector& output_types,
       const std::vector<PartialTensorShape>& output_shapes)
       : DatasetBase(DatasetContext(ctx)),
         op_version_(op_version),
@@ -137,6 +139,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
         resource_mgr_(ctx->resource_manager()),
         captured_uncompress_func_(std::move(captured_uncompress_func)),
         cross_trainer_cache_options_(cross_trainer_cache_options),
+        max_elements_per_request_(max_elements_per_request),
         output_types_(output_types),
         output_shapes_(output_shapes) {}
 
@@ -163,7 +166,8 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
                           num_consumers_, consumer_index_,
                           max_outstanding_requests_, task_refresh_interval_,
                           target_workers_, metadata_,
-                          cross_trainer_cache_options_});
+                          cross_trainer_cache_options_,
+                          max_elements_per_request_});
   }
 
   const DataTypeVector& output_dtypes() const override { return output_types_; }
@@ -301,6 +305,13 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
                       &cross_trainer_cache_options_attr);
     attrs.push_back(
         {kCrossTrainerCacheOptions, cross_trainer_cache_options_attr});
+
+    if (op_version_ >= 4) {
+      AttrValue max_elements_per_request_attr;
+      b->BuildAttrValue(max_elements_per_request_,
+                        &max_elements_per_request_attr);
+      attrs.push_back({kMaxElementsPerRequest, max_elements_per_request_attr});
+    }
     return b->AddDataset(this, inputs, attrs, output);
   }
 
@@ -414,6 +425,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
   ResourceMgr* const resource_mgr_;  // Not owned
   const std::unique_ptr<CapturedFunction> captured_uncompress_func_;
   const std::optional<CrossTrainerCacheOptions> cross_trainer_cache_options_;
+  const int64_t max_elements_per_request_;
   const DataTypeVector output_types_;
   const std::vector<PartialTensorShape> output_shapes_;
 };
@@ -472,6 +484,17 @@ DataServiceDatasetOp::DataServiceDatasetOp(OpKernelConstruction* ctx)
     OP_REQUIRES_OK(ctx, ctx->GetAttr(kCrossTrainerCacheOptions,
                                      &seriazlied_cross_trainer_cache_options_));
   }
+
+  if (ctx->HasAttr(kMaxElementsPerRequest)) {
+    OP_REQUIRES_OK(
+        ctx, ctx->GetAttr(kMaxElementsPerRequest, &max_elements_per_request_));
+  }
+  OP_REQUIRES(
+      ctx,
+      max_elements_per_request_ == model::kAutotune ||
+          max_elements_per_request_ > 0,
+      errors::InvalidArgument(kMaxElementsPerRequest, " must be positive or ",
+                              model::kAutotune));
 }
 
 void DataServiceDatasetOp::MakeDataset(OpKernelContext* ctx,
@@ -595,7 +618,8 @@ void DataServiceDatasetOp::MakeDataset(OpKernelContext* ctx,
     OP_REQUIRES_OK(ctx, compression.status());
     should_uncompress =
         should_uncompress &&
-        (*compression == DataServiceMetadata::COMPRESSION_SNAPPY);
+        (*compression == DataServiceMetadata::COMPRESSION_SNAPPY ||
+         *compression == DataServiceMetadata::COMPRESSION_ZSTD);
   }
   DataTypeVector data_service_output_types = output_types_;
   std::vector<PartialTensorShape> data_service_output_shapes = output_shapes_;
@@ -624,7 +648,8 @@ void DataServiceDatasetOp::MakeDataset(OpKernelContext* ctx,
       max_outstanding_requests, task_refresh_interval_hint_, target_workers_,
       *metadata, iteration_counter, owns_resource, iteration_counter_handle,
       std::move(captured_uncompress_func), cross_trainer_cache_options,
-      data_service_output_types, data_service_output_shapes);
+      max_elements_per_request_, data_service_output_types,
+      data_service_output_shapes);
   if (should_uncompress) {
     VLOG(2) << "Inserting a ParallelMap dataset to uncompress tf.data service "
             << "dataset " << dataset_id << ".";
@@ -308,6 +308,9 @@ class LoadDatasetOp::DatasetV2 : public DatasetBase {
     Status Initialize(IteratorContext* ctx) override {
       SnapshotReaderParams params{dataset()->path_, dataset()->metadata_,
                                   dataset()->output_types_, ctx->env()};
+      // The snapshot may still be written, so reads the chunks as they are
+      // committed.
+      params.read_while_write = true;
       snapshot_reader_ = std::make_unique<SnapshotReader>(params);
       return OkStatus();
     }
@@ -0,0 +1,625 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/shuffled_tf_record_dataset_op.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/random_seed_ops.h"
+#include "tensorflow/core/kernels/random_index_shuffle.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/raw_coding.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// See documentation in ../../ops/experimental_dataset_ops.cc for a high-level
+// description of the following op.
+
+/* static */ constexpr const char* const
+    ShuffledTFRecordDatasetOp::kDatasetType;
+/* static */ constexpr const char* const ShuffledTFRecordDatasetOp::kFileNames;
+/* static */ constexpr const char* const ShuffledTFRecordDatasetOp::kSeed;
+/* static */ constexpr const char* const ShuffledTFRecordDatasetOp::kSeed2;
+/* static */ constexpr const char* const ShuffledTFRecordDatasetOp::kReadAhead;
+/* static */ constexpr const char* const
+    ShuffledTFRecordDatasetOp::kIndexSuffix;
+/* static */ constexpr const char* const
+    ShuffledTFRecordDatasetOp::kReshuffleEachIteration;
+
+namespace {
+
+constexpr char kEpoch[] = "epoch";
+constexpr char kNextIndex[] = "next_index";
+
+// Number of records fetched per batched read when `read_ahead` is 0.
+constexpr int64_t kDefaultReadAhead = 64;
+
+// Number of rounds of the index shuffle; see random_index_shuffle.h.
+constexpr int32_t kShuffleRounds = 8;
+
+// Size of a record with an empty payload.
+constexpr uint64 kRecordOverhead =
+    io::RecordReader::kHeaderSize + io::RecordReader::kFooterSize;
+
+// The record offsets of one TFRecord file: record `i` occupies the bytes
+// [offsets[i], offsets[i + 1]) of the file, and the last offset is the size of
+// the file.
+//
+// An index sidecar file stores the offsets as
+//
+//   fixed64 num_records
+//   fixed64 offsets[num_records + 1]
+//   fixed32 masked crc32c of the above
+using RecordOffsets = std::vector<uint64>;
+
+// Parses the index sidecar `data` of a TFRecord file of `file_size` bytes.
+Status DecodeRecordOffsets(StringPiece data, uint64 file_size,
+                           RecordOffsets* offsets) {
+  if (data.size() < 2 * sizeof(uint64) + sizeof(uint32)) {
+    return errors::DataLoss("truncated record index");
+  }
+  const uint64 num_records = core::DecodeFixed64(data.data());
+  if ((data.size() - sizeof(uint32)) / sizeof(uint64) != num_records + 2 ||
+      (data.size() - sizeof(uint32)) % sizeof(uint64) != 0) {
+    return errors::DataLoss("record index of ", data.size(),
+                            " bytes does not hold ", num_records, " records");
+  }
+  const size_t crc_offset = data.size() - sizeof(uint32);
+  const uint32 masked_crc = core::DecodeFixed32(data.data() + crc_offset);
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(data.data(), crc_offset)) {
+    return errors::DataLoss("corrupted record index");
+  }
+  offsets->resize(num_records + 1);
+  for (uint64 i = 0; i <= num_records; ++i) {
+    (*offsets)[i] = core::DecodeFixed64(data.data() + (i + 1) * sizeof(uint64));
+    if (i > 0 && (*offsets)[i] < (*offsets)[i - 1] + kRecordOverhead) {
+      return errors::DataLoss("corrupted record index");
+    }
+  }
+  if (offsets->front() != 0 || offsets->back() != file_size) {
+    return errors::DataLoss("record index covers ", offsets->back(),
+                            " bytes but the file has ", file_size);
+  }
+  return OkStatus();
+}
+
+std::string EncodeRecordOffsets(const RecordOffsets& offsets) {
+  std::string data;
+  core::PutFixed64(&data, offsets.size() - 1);
+  for (uint64 offset : offsets) {
+    core::PutFixed64(&data, offset);
+  }
+  core::PutFixed32(&data,
+                   crc32c::Mask(crc32c::Value(data.data(), data.size())));
+  return data;
+}
+
+// Collects the record offsets of `filename` by walking its record headers.
+Status ScanRecordOffsets(Env* env, const std::string& filename,
+                         RecordOffsets* offsets) {
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  io::RecordReaderOptions options;
+  options.buffer_size = 256 << 10;
+  io::RecordReader reader(file.get(), options);
+  offsets->clear();
+  uint64 offset = 0;
+  while (true) {
+    offsets->push_back(offset);
+    int num_skipped;
+    Status s = reader.SkipRecords(&offset, 1, &num_skipped);
+    if (errors::IsOutOfRange(s)) break;
+    TF_RETURN_IF_ERROR(s);
+  }
+  // A partial header at the end of the file also reads as the end of the file.
+  if (offsets->back() != file_size) {
+    return errors::DataLoss("truncated record at ", offsets->back());
+  }
+  return OkStatus();
+}
+
+// Loads the record offsets of `filename` from its index sidecar, or scans the
+// file and writes the sidecar if it is missing or does not match the file.
+// Failures to write the sidecar are not fatal.
+Status GetRecordOffsets(Env* env, const std::string& filename,
+                        const std::string& index_suffix,
+                        RecordOffsets* offsets) {
+  if (index_suffix.empty()) {
+    return ScanRecordOffsets(env, filename, offsets);
+  }
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  const std::string index_filename = strings::StrCat(filename, index_suffix);
+  std::string data;
+  Status s = ReadFileToString(env, index_filename, &data);
+  if (s.ok()) {
+    s = DecodeRecordOffsets(data, file_size, offsets);
+    if (s.ok()) return OkStatus();
+    LOG(WARNING) << "Ignoring record index " << index_filename << ": " << s;
+  } else if (!errors::IsNotFound(s)) {
+    return s;
+  }
+  TF_RETURN_IF_ERROR(ScanRecordOffsets(env, filename, offsets));
+  // Write to a unique temporary file so that concurrent writers of the same
+  // index never expose a partial sidecar.
+  const std::string tmp_filename =
+      strings::StrCat(index_filename, ".tmp.", random::New64());
+  s = WriteStringToFile(env, tmp_filename, EncodeRecordOffsets(*offsets));
+  if (s.ok()) s = env->RenameFile(tmp_filename, index_filename);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to write record index " << index_filename << ": "
+                 << s;
+    env->DeleteFile(tmp_filename).IgnoreError();
+  }
+  return OkStatus();
+}
+
+// The record offsets of all files of the dataset.
+struct RecordIndex {
+  std::vector<RecordOffsets> files;
+  // `first_record[i]` is the global position of the first record of file `i`;
+  // the last element is the total number of records.
+  std::vector<uint64> first_record;
+
+  uint64 num_records() const { return first_record.back(); }
+
+  // Returns the file holding the record at global position `record`.
+  size_t FileForRecord(uint64 record) const {
+    return std::upper_bound(first_record.begin(), first_record.end(), record) -
+           first_record.begin() - 1;
+  }
+};
+
+// Returns the shuffle key of epoch `epoch`. Epoch 0 uses the seeds as they
+// are, so that random access agrees with the first iteration.
+std::array<uint32_t, 3> ShuffleKey(int64_t seed, int64_t seed2,
+                                   int64_t epoch) {
+  uint64 s = seed;
+  uint64 s2 = seed2;
+  if (epoch > 0) {
+    s = Hash64Combine(s, epoch);
+    s2 = Hash64Combine(s2, epoch);
+  }
+  return {static_cast<uint32_t>(s), static_cast<uint32_t>(s >> 32),
+          static_cast<uint32_t>(s2 ^ (s2 >> 32))};
+}
+
+// Turns the bytes of a whole record read into `buffer` into its payload,
+// verifying the length and both checksums.
+Status ExtractRecord(uint64 offset, tstring* buffer) {
+  const char* data = buffer->data();
+  const size_t n = buffer->size();
+  const uint32 masked_length_crc = core::DecodeFixed32(data + sizeof(uint64));
+  if (crc32c::Unmask(masked_length_crc) !=
+      crc32c::Value(data, sizeof(uint64))) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  const uint64 length = core::DecodeFixed64(data);
+  if (length != n - kRecordOverhead) {
+    return errors::DataLoss("record at ", offset, " has length ", length,
+                            " but the record index expects ",
+                            n - kRecordOverhead,
+                            "; the index may be out of date");
+  }
+  const char* payload = data + io::RecordReader::kHeaderSize;
+  const uint32 masked_crc = core::DecodeFixed32(payload + length);
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(payload, length)) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  std::memmove(buffer->data(), payload, length);
+  buffer->resize(length);
+  return OkStatus();
+}
+
+}  // namespace
+
+class ShuffledTFRecordDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, std::vector<std::string> filenames,
+          RandomSeeds&& seeds, int64_t read_ahead, std::string index_suffix,
+          bool reshuffle_each_iteration)
+      : DatasetBase(DatasetContext(ctx)),
+        filenames_(std::move(filenames)),
+        seeds_(std::move(seeds)),
+        read_ahead_(read_ahead),
+        index_suffix_(std::move(index_suffix)),
+        reshuffle_each_iteration_(reshuffle_each_iteration) {}
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    static DataTypeVector* dtypes = new DataTypeVector({DT_STRING});
+    return *dtypes;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    static std::vector<PartialTensorShape>* shapes =
+        new std::vector<PartialTensorShape>({{}});
+    return *shapes;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  // The cardinality is only known once the record index is built, which
+  // requires reading the files, so it is not computed at the lowest level.
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    std::shared_ptr<const RecordIndex> index;
+    {
+      tf_shared_lock l(mu_);
+      index = index_;
+    }
+    if (index == nullptr) {
+      if (options.compute_level() ==
+          CardinalityOptions::CARDINALITY_COMPUTE_LOW) {
+        return kUnknownCardinality;
+      }
+      if (!GetIndex(Env::Default(), &index).ok()) {
+        return kUnknownCardinality;
+      }
+    }
+    return index->num_records();
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override { return OkStatus(); }
+
+  // Returns the element at position `index` of the first iteration.
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    std::shared_ptr<const RecordIndex> record_index;
+    TF_RETURN_IF_ERROR(GetIndex(ctx->env(), &record_index));
+    const uint64 record = random::index_shuffle(
+        index, ShuffleKey(seeds_.seed(), seeds_.seed2(), /*epoch=*/0),
+        record_index->num_records() - 1, kShuffleRounds);
+    const size_t file = record_index->FileForRecord(record);
+    const RecordOffsets& offsets = record_index->files[file];
+    const uint64 i = record - record_index->first_record[file];
+    std::unique_ptr<RandomAccessFile> f;
+    TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(filenames_[file], &f));
+    Tensor tensor(ctx->get_allocator({}), DT_STRING, TensorShape({}));
+    tstring& buffer = tensor.scalar<tstring>()();
+    const size_t n = offsets[i + 1] - offsets[i];
+    buffer.resize_uninitialized(n);
+    StringPiece result;
+    Status s = f->Read(offsets[i], n, &result, buffer.data());
+    if (!s.ok() && !errors::IsOutOfRange(s)) return s;
+    if (result.size() != n) {
+      return errors::DataLoss("truncated record at ", offsets[i]);
+    }
+    if (result.data() != buffer.data()) {
+      std::memmove(buffer.data(), result.data(), n);
+    }
+    TF_RETURN_IF_ERROR(ExtractRecord(offsets[i], &buffer));
+    out_tensors->clear();
+    out_tensors->push_back(std::move(tensor));
+    return OkStatus();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* filenames = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+    Node* seed = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(seeds_.input_seed(), &seed));
+    Node* seed2 = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(seeds_.input_seed2(), &seed2));
+    Node* read_ahead = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(read_ahead_, &read_ahead));
+    AttrValue index_suffix;
+    b->BuildAttrValue(index_suffix_, &index_suffix);
+    AttrValue reshuffle_each_iteration;
+    b->BuildAttrValue(reshuffle_each_iteration_, &reshuffle_each_iteration);
+    return b->AddDataset(
+        this, {filenames, seed, seed2, read_ahead},
+        {{kIndexSuffix, index_suffix},
+         {kReshuffleEachIteration, reshuffle_each_iteration}},
+        output);
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(dataset()->GetIndex(ctx->env(), &index_));
+      files_.resize(dataset()->filenames_.size());
+      if (dataset()->reshuffle_each_iteration_) {
+        epoch_ = dataset()->next_epoch_.fetch_add(1);
+      }
+      return OkStatus();
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      if (buffer_.empty()) {
+        if (next_index_ >= index_->num_records()) {
+          *end_of_sequence = true;
+          return OkStatus();
+        }
+        TF_RETURN_IF_ERROR(FillBufferLocked(ctx));
+      }
+      static monitoring::CounterCell* bytes_counter =
+          metrics::GetTFDataBytesReadCounter(kDatasetType);
+      bytes_counter->IncrementBy(buffer_.front().scalar<tstring>()().size());
+      out_tensors->push_back(std::move(buffer_.front()));
+      buffer_.pop_front();
+      *end_of_sequence = false;
+      return OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      // Buffered records are read again after a restore.
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kEpoch), epoch_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          full_name(kNextIndex),
+          static_cast<int64_t>(next_index_ - buffer_.size())));
+      return OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t next_index;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kEpoch), &epoch_));
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kNextIndex), &next_index));
+      if (next_index < 0 || next_index > index_->num_records()) {
+        return errors::DataLoss("Restored position ", next_index,
+                                " is out of range [0, ",
+                                index_->num_records(), "]");
+      }
+      next_index_ = next_index;
+      buffer_.clear();
+      return OkStatus();
+    }
+
+   private:
+    // Reads the next `read_ahead` records of the permutation into `buffer_`,
+    // issuing one batched read per file.
+    Status FillBufferLocked(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const uint64 num_records = index_->num_records();
+      const uint64 end =
+          std::min<uint64>(num_records, next_index_ + dataset()->read_ahead_);
+      const std::array<uint32_t, 3> key =
+          ShuffleKey(dataset()->seeds_.seed(), dataset()->seeds_.seed2(),
+                     epoch_);
+      std::vector<Tensor> records;
+      records.reserve(end - next_index_);
+      // Batched reads per file, and the position in `records` of each read.
+      std::vector<std::vector<RandomAccessFile::ReadRequest>> requests(
+          files_.size());
+      std::vector<std::vector<size_t>> positions(files_.size());
+      for (uint64 position = next_index_; position < end; ++position) {
+        const uint64 record = random::index_shuffle(position, key,
+                                                    num_records - 1,
+                                                    kShuffleRounds);
+        const size_t file = index_->FileForRecord(record);
+        const RecordOffsets& offsets = index_->files[file];
+        const uint64 i = record - index_->first_record[file];
+        records.emplace_back(ctx->allocator({}), DT_STRING, TensorShape({}));
+        tstring& buffer = records.back().scalar<tstring>()();
+        RandomAccessFile::ReadRequest request;
+        request.offset = offsets[i];
+        request.n = offsets[i + 1] - offsets[i];
+        buffer.resize_uninitialized(request.n);
+        request.scratch = buffer.data();
+        requests[file].push_back(request);
+        positions[file].push_back(records.size() - 1);
+      }
+      for (size_t file = 0; file < files_.size(); ++file) {
+        if (requests[file].empty()) continue;
+        if (files_[file] == nullptr) {
+          TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(
+              dataset()->filenames_[file], &files_[file]));
+        }
+        files_[file]->ReadBatch(&requests[file]);
+        for (size_t j = 0; j < requests[file].size(); ++j) {
+          const RandomAccessFile::ReadRequest& request = requests[file][j];
+          tstring& buffer = records[positions[file][j]].scalar<tstring>()();
+          if (!request.status.ok() && !errors::IsOutOfRange(request.status)) {
+            return request.status;
+          }
+          if (request.result.size() != request.n) {
+            return errors::DataLoss("truncated record at ", request.offset,
+                                    " in ", dataset()->filenames_[file],
+                                    "; the record index may be out of date");
+          }
+          if (request.result.data() != buffer.data()) {
+            std::memmove(buffer.data(), request.result.data(), request.n);
+          }
+          Status s = ExtractRecord(request.offset, &buffer);
+          if (!s.ok()) {
+            return errors::CreateWithUpdatedMessage(
+                s, strings::StrCat(s.error_message(), " in ",
+                                   dataset()->filenames_[file]));
+          }
+        }
+      }
+      next_index_ = end;
+      for (Tensor& record : records) {
+        buffer_.push_back(std::move(record));
+      }
+      return OkStatus();
+    }
+
+    mutex mu_;
+    std::shared_ptr<const RecordIndex> index_ TF_GUARDED_BY(mu_);
+    // Files are opened the first time one of their records is read.
+    std::vector<std::unique_ptr<RandomAccessFile>> files_ TF_GUARDED_BY(mu_);
+    int64_t epoch_ TF_GUARDED_BY(mu_) = 0;
+    // Position in the permutation of the next record to read into `buffer_`.
+    uint64 next_index_ TF_GUARDED_BY(mu_) = 0;
+    std::deque<Tensor> buffer_ TF_GUARDED_BY(mu_);
+  };
+
+  // Builds the record index on first use and shares it between iterators.
+  Status GetIndex(Env* env, std::shared_ptr<const RecordIndex>* index) const {
+    mutex_lock l(index_mu_);
+    {
+      tf_shared_lock sl(mu_);
+      if (index_ != nullptr) {
+        *index = index_;
+        return OkStatus();
+      }
+    }
+    auto new_index = std::make_shared<RecordIndex>();
+    const size_t num_files = filenames_.size();
+    new_index->files.resize(num_files);
+    std::vector<Status> statuses(num_files);
+    if (num_files > 1) {
+      thread::ThreadPool pool(
+          env, ThreadOptions(), "shuffled_tf_record_index",
+          std::min<int>(num_files, port::MaxParallelism()));
+      BlockingCounter counter(num_files);
+      for (size_t i = 0; i < num_files; ++i) {
+        pool.Schedule([this, env, i, &new_index, &statuses, &counter]() {
+          statuses[i] = GetRecordOffsets(env, filenames_[i], index_suffix_,
+                                         &new_index->files[i]);
+          counter.DecrementCount();
+        });
+      }
+      counter.Wait();
+    } else if (num_files == 1) {
+      statuses[0] = GetRecordOffsets(env, filenames_[0], index_suffix_,
+                                     &new_index->files[0]);
+    }
+    new_index->first_record.reserve(num_files + 1);
+    new_index->first_record.push_back(0);
+    for (size_t i = 0; i < num_files; ++i) {
+      if (!statuses[i].ok()) {
+        return errors::CreateWithUpdatedMessage(
+            statuses[i],
+            strings::StrCat("Failed to index ", filenames_[i], ": ",
+                            statuses[i].error_message()));
+      }
+      new_index->first_record.push_back(new_index->first_record.back() +
+                                        new_index->files[i].size() - 1);
+    }
+    mutex_lock ml(mu_);
+    index_ = std::move(new_index);
+    *index = index_;
+    return OkStatus();
+  }
+
+  const std::vector<std::string> filenames_;
+  const RandomSeeds seeds_;
+  const int64_t read_ahead_;
+  const std::string index_suffix_;
+  const bool reshuffle_each_iteration_;
+
+  // Serializes building the index; `mu_` guards reading it.
+  mutable mutex index_mu_;
+  mutable mutex mu_;
+  mutable std::shared_ptr<const RecordIndex> index_ TF_GUARDED_BY(mu_);
+  mutable std::atomic<int64_t> next_epoch_{0};
+};
+
+ShuffledTFRecordDatasetOp::ShuffledTFRecordDatasetOp(OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kIndexSuffix, &index_suffix_));
+  OP_REQUIRES_OK(
+      ctx, ctx->GetAttr(kReshuffleEachIteration, &reshuffle_each_iteration_));
+}
+
+void ShuffledTFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                            DatasetBase** output) {
+  const Tensor* filenames_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kFileNames, &filenames_tensor));
+  OP_REQUIRES(
+      ctx, filenames_tensor->dims() <= 1,
+      errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+  std::vector<std::string> filenames;
+  filenames.reserve(filenames_tensor->NumElements());
+  for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+    filenames.push_back(filenames_tensor->flat<tstring>()(i));
+    metrics::RecordTFDataFilename(kDatasetType, filenames.back());
+  }
+
+  int64_t seed;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kSeed, &seed));
+  int64_t seed2;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kSeed2, &seed2));
+
+  int64_t read_ahead;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kReadAhead, &read_ahead));
+  OP_REQUIRES(ctx, read_ahead >= 0,
+              errors::InvalidArgument("`read_ahead` must be >= 0 (0 == ",
+                                      kDefaultReadAhead, " records)"));
+  if (read_ahead == 0) {
+    read_ahead = kDefaultReadAhead;
+  }
+
+  *output = new Dataset(ctx, std::move(filenames), RandomSeeds(seed, seed2),
+                        read_ahead, index_suffix_, reshuffle_each_iteration_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("ShuffledTFRecordDataset").Device(DEVICE_CPU),
+                        ShuffledTFRecordDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
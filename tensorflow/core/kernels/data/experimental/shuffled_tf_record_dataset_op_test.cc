@@ -0,0 +1,253 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/shuffled_tf_record_dataset_op.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "shuffled_tf_record_dataset";
+
+class ShuffledTFRecordDatasetParams : public DatasetParams {
+ public:
+  ShuffledTFRecordDatasetParams(std::vector<tstring> filenames, int64_t seed,
+                                int64_t seed2, int64_t read_ahead,
+                                string index_suffix,
+                                bool reshuffle_each_iteration,
+                                string node_name)
+      : DatasetParams({DT_STRING}, {PartialTensorShape({})},
+                      std::move(node_name)),
+        filenames_(std::move(filenames)),
+        seed_(seed),
+        seed2_(seed2),
+        read_ahead_(read_ahead),
+        index_suffix_(std::move(index_suffix)),
+        reshuffle_each_iteration_(reshuffle_each_iteration) {}
+
+  std::vector<Tensor> GetInputTensors() const override {
+    int num_files = filenames_.size();
+    return {CreateTensor<tstring>(TensorShape({num_files}), filenames_),
+            CreateTensor<int64_t>(TensorShape({}), {seed_}),
+            CreateTensor<int64_t>(TensorShape({}), {seed2_}),
+            CreateTensor<int64_t>(TensorShape({}), {read_ahead_})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {
+        ShuffledTFRecordDatasetOp::kFileNames,
+        ShuffledTFRecordDatasetOp::kSeed,
+        ShuffledTFRecordDatasetOp::kSeed2,
+        ShuffledTFRecordDatasetOp::kReadAhead,
+    };
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {
+        {ShuffledTFRecordDatasetOp::kIndexSuffix, index_suffix_},
+        {ShuffledTFRecordDatasetOp::kReshuffleEachIteration,
+         reshuffle_each_iteration_},
+        {"metadata", ""}};
+    return OkStatus();
+  }
+
+  string dataset_type() const override {
+    return ShuffledTFRecordDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<tstring> filenames_;
+  int64_t seed_;
+  int64_t seed2_;
+  int64_t read_ahead_;
+  string index_suffix_;
+  bool reshuffle_each_iteration_;
+};
+
+class ShuffledTFRecordDatasetOpTest : public DatasetOpsTestBase {};
+
+Status CreateTestFiles(const std::vector<tstring>& filenames,
+                       const std::vector<std::vector<string>>& contents) {
+  if (filenames.size() != contents.size()) {
+    return tensorflow::errors::InvalidArgument(
+        "The number of files does not match with the contents");
+  }
+  for (int i = 0; i < filenames.size(); ++i) {
+    CompressionParams params;
+    std::vector<absl::string_view> records(contents[i].begin(),
+                                           contents[i].end());
+    TF_RETURN_IF_ERROR(WriteDataToTFRecordFile(filenames[i], records, params));
+  }
+  return OkStatus();
+}
+
+ShuffledTFRecordDatasetParams MakeParams(const string& name,
+                                         int64_t read_ahead,
+                                         const string& index_suffix,
+                                         bool reshuffle_each_iteration) {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/shuffled_tf_record_", name, "_1"),
+      absl::StrCat(testing::TmpDir(), "/shuffled_tf_record_", name, "_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb", "ccc"}};
+  if (!CreateTestFiles(filenames, contents).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return ShuffledTFRecordDatasetParams(filenames, /*seed=*/7, /*seed2=*/11,
+                                       read_ahead, index_suffix,
+                                       reshuffle_each_iteration, kNodeName);
+}
+
+// Test case 1: records are read one at a time.
+ShuffledTFRecordDatasetParams ShuffledTFRecordDatasetParams1() {
+  return MakeParams("1", /*read_ahead=*/1, /*index_suffix=*/"",
+                    /*reshuffle_each_iteration=*/true);
+}
+
+// Test case 2: records are read in batches that span both files.
+ShuffledTFRecordDatasetParams ShuffledTFRecordDatasetParams2() {
+  return MakeParams("2", /*read_ahead=*/4, /*index_suffix=*/"",
+                    /*reshuffle_each_iteration=*/false);
+}
+
+// Test case 3: the record offsets are kept in index sidecar files.
+ShuffledTFRecordDatasetParams ShuffledTFRecordDatasetParams3() {
+  return MakeParams("3", /*read_ahead=*/0, /*index_suffix=*/".index",
+                    /*reshuffle_each_iteration=*/false);
+}
+
+std::vector<Tensor> ExpectedOutputs() {
+  return CreateTensors<tstring>(
+      TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}});
+}
+
+std::vector<GetNextTestCase<ShuffledTFRecordDatasetParams>>
+GetNextTestCases() {
+  return {{/*dataset_params=*/ShuffledTFRecordDatasetParams1(),
+           /*expected_outputs=*/ExpectedOutputs(), /*compare_order=*/false},
+          {/*dataset_params=*/ShuffledTFRecordDatasetParams2(),
+           /*expected_outputs=*/ExpectedOutputs(), /*compare_order=*/false},
+          {/*dataset_params=*/ShuffledTFRecordDatasetParams3(),
+           /*expected_outputs=*/ExpectedOutputs(), /*compare_order=*/false}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(ShuffledTFRecordDatasetOpTest,
+                         ShuffledTFRecordDatasetParams, GetNextTestCases())
+
+TEST_F(ShuffledTFRecordDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = ShuffledTFRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(ShuffledTFRecordDatasetOp::kDatasetType)));
+}
+
+TEST_F(ShuffledTFRecordDatasetOpTest, Cardinality) {
+  auto dataset_params = ShuffledTFRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(6));
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<ShuffledTFRecordDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/ShuffledTFRecordDatasetParams1(),
+           /*breakpoints=*/{0, 2, 7}, /*expected_outputs=*/ExpectedOutputs(),
+           /*compare_order=*/false},
+          {/*dataset_params=*/ShuffledTFRecordDatasetParams2(),
+           /*breakpoints=*/{0, 3, 7}, /*expected_outputs=*/ExpectedOutputs(),
+           /*compare_order=*/false}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(ShuffledTFRecordDatasetOpTest,
+                                 ShuffledTFRecordDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+// Reads all elements of `iterator`.
+Status ReadAll(TestIterator* iterator, std::vector<tstring>* records) {
+  bool end_of_sequence = false;
+  while (true) {
+    std::vector<Tensor> out_tensors;
+    TF_RETURN_IF_ERROR(iterator->GetNext(&out_tensors, &end_of_sequence));
+    if (end_of_sequence) return OkStatus();
+    records->push_back(out_tensors[0].scalar<tstring>()());
+  }
+}
+
+TEST_F(ShuffledTFRecordDatasetOpTest, SameOrderWithoutReshuffle) {
+  auto dataset_params = ShuffledTFRecordDatasetParams2();
+  TF_ASSERT_OK(InitializeRuntime(dataset_params));
+  std::unique_ptr<TestDataset> dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &dataset));
+  std::vector<tstring> first, second;
+  std::unique_ptr<TestIterator> iterator;
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &iterator));
+  TF_ASSERT_OK(ReadAll(iterator.get(), &first));
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &iterator));
+  TF_ASSERT_OK(ReadAll(iterator.get(), &second));
+  EXPECT_EQ(first.size(), 6);
+  EXPECT_EQ(first, second);
+
+  // Random access agrees with the iteration order.
+  for (int64_t i = 0; i < first.size(); ++i) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(dataset->dataset()->Get(dataset->op_kernel_context(), i,
+                                         &out_tensors));
+    EXPECT_EQ(out_tensors[0].scalar<tstring>()(), first[i]);
+  }
+}
+
+TEST_F(ShuffledTFRecordDatasetOpTest, StaleIndexIsRebuilt) {
+  auto dataset_params = ShuffledTFRecordDatasetParams3();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  const string filename = absl::StrCat(
+      testing::TmpDir(), "/shuffled_tf_record_3_1");
+  TF_ASSERT_OK(Env::Default()->FileExists(absl::StrCat(filename, ".index")));
+
+  // Rewrite one file so that its sidecar no longer matches it.
+  TF_ASSERT_OK(CreateTestFiles({filename}, {{"x", "yy", "zzz", "wwww"}}));
+  std::unique_ptr<TestDataset> dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &dataset));
+  std::unique_ptr<TestIterator> iterator;
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &iterator));
+  std::vector<tstring> records;
+  TF_ASSERT_OK(ReadAll(iterator.get(), &records));
+  std::sort(records.begin(), records.end());
+  EXPECT_EQ(records, std::vector<tstring>(
+                         {"a", "bb", "ccc", "wwww", "x", "yy", "zzz"}));
+}
+
+TEST_F(ShuffledTFRecordDatasetOpTest, TruncatedFile) {
+  auto dataset_params = ShuffledTFRecordDatasetParams1();
+  const string filename =
+      absl::StrCat(testing::TmpDir(), "/shuffled_tf_record_1_2");
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  contents.resize(contents.size() - 2);
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, contents));
+  EXPECT_TRUE(errors::IsDataLoss(Initialize(dataset_params)));
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -65,6 +65,7 @@ const char kAnonymousIteratorV3[] = "AnonymousIteratorV3";
 const char kIteratorVariantTypeName[] = "tensorflow::Iterator";
 const char kOutputShapes[] = "output_shapes";
 const char kOutputTypes[] = "output_types";
+const char kIteratorStatsExperiment[] = "iterator_stats";
 
 bool SymbolicCheckpointEnabled(const Options& options) {
   return options.optional_symbolic_checkpoint_case() ==
@@ -72,6 +73,14 @@ bool SymbolicCheckpointEnabled(const Options& options) {
          options.symbolic_checkpoint();
 }
 
+// Returns whether iterators should record per-iterator resource usage for
+// /tfdataz and the profiler.
+bool IteratorStatsEnabled() {
+  static const bool enabled =
+      GetExperiments().contains(kIteratorStatsExperiment);
+  return enabled;
+}
+
 }  // namespace
 
 /* static */ constexpr const char* const
@@ -126,6 +135,7 @@ Status IteratorResource::GetNext(OpKernelContext* ctx,
   params.thread_factory = unbounded_thread_pool_.get_thread_factory();
   params.thread_pool = &unbounded_thread_pool_;
   params.id_registry = captured_state->id_registry();
+  params.iterator_stats = captured_state->iterator_stats();
   params.warm_start = dataset->options().optimization_options().warm_start();
   std::function<void()> deregister_fn;
   TF_RETURN_IF_ERROR(RegisterCancellationCallback(
@@ -199,6 +209,9 @@ Status IteratorResource::Restore(OpKernelContext* ctx,
                                 /*iterator=*/nullptr);
     input_dataset = iterator_state_->dataset();
   }
+  if (IteratorStatsEnabled()) {
+    new_state->EnableIteratorStats();
+  }
   core::ScopedUnref scoped_unref(dataset);
   IteratorContext::Params params(ctx);
   params.cancellation_manager = new_state->cancellation_manager();
@@ -210,6 +223,7 @@ Status IteratorResource::Restore(OpKernelContext* ctx,
   params.thread_factory = unbounded_thread_pool_.get_thread_factory();
   params.thread_pool = &unbounded_thread_pool_;
   params.id_registry = new_state->id_registry();
+  params.iterator_stats = new_state->iterator_stats();
   std::function<void()> deregister_fn;
   TF_RETURN_IF_ERROR(RegisterCancellationCallback(
       ctx->cancellation_manager(),
@@ -238,6 +252,9 @@ Status IteratorResource::SetIteratorFromDataset(OpKernelContext* ctx,
                                 iterator_state_->pflr(), iterator_state_->flr(),
                                 /*iterator=*/nullptr);
   }
+  if (IteratorStatsEnabled()) {
+    new_state->EnableIteratorStats();
+  }
 
   // Create new iterator.
   IteratorContext::Params params(ctx);
@@ -249,6 +266,7 @@ Status IteratorResource::SetIteratorFromDataset(OpKernelContext* ctx,
   params.thread_factory = unbounded_thread_pool_.get_thread_factory();
   params.thread_pool = &unbounded_thread_pool_;
   params.id_registry = new_state->id_registry();
+  params.iterator_stats = new_state->iterator_stats();
   params.warm_start = dataset->options().optimization_options().warm_start();
   std::function<void()> deregister_fn;
   TF_RETURN_IF_ERROR(RegisterCancellationCallback(
@@ -278,7 +296,7 @@ Status IteratorResource::SetIteratorFromDataset(OpKernelContext* ctx,
   mutex_lock l(mu_);
   std::swap(iterator_state_, new_state);
   tf_dataz_metrics_collector_ = std::make_shared<TfDatazMetricsCollector>(
-      env_, iterator_state_->iterator());
+      env_, iterator_state_->iterator(), iterator_state_->iterator_stats());
   TfDatazMetricsRegistry::Register(tf_dataz_metrics_collector_);
   return OkStatus();
 }
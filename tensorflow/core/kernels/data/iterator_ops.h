@@ -130,6 +130,16 @@ class IteratorResource : public ResourceBase {
       return id_registry_;
     }
 
+    // Makes the iterators created with this state record their resource usage
+    // in a new `IteratorStatsRegistry`.
+    void EnableIteratorStats() {
+      iterator_stats_ = std::make_shared<IteratorStatsRegistry>();
+    }
+
+    std::shared_ptr<IteratorStatsRegistry> iterator_stats() {
+      return iterator_stats_;
+    }
+
    private:
     std::shared_ptr<FunctionLibraryDefinition> flib_def_;
     FunctionLibraryRuntime* flr_ = nullptr;  // not owned
@@ -141,6 +151,7 @@ class IteratorResource : public ResourceBase {
     core::RefCountPtr<DatasetBase> dataset_;
     std::shared_ptr<MemoryCheckpoint::IdRegistry> id_registry_;
     MemoryCheckpoint checkpoint_;
+    std::shared_ptr<IteratorStatsRegistry> iterator_stats_;
   };
 
   IteratorMetricsCollector metrics_collector_;
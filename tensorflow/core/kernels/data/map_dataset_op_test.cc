@@ -161,6 +161,42 @@ TEST_F(MapDatasetOpTest, IteratorPrefix) {
       MapDatasetOp::kDatasetType, dataset_params.iterator_prefix())));
 }
 
+TEST_F(MapDatasetOpTest, IteratorStats) {
+  auto dataset_params = MapDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  auto iterator_stats = std::make_shared<IteratorStatsRegistry>();
+  IteratorContext::Params params(iterator_ctx_.get());
+  params.iterator_stats = iterator_stats;
+  IteratorContext iterator_ctx(std::move(params));
+  std::unique_ptr<IteratorBase> iterator;
+  TF_ASSERT_OK(dataset_->MakeIterator(&iterator_ctx, /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &iterator));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  while (!end_of_sequence) {
+    TF_ASSERT_OK(
+        iterator->GetNext(&iterator_ctx, &out_tensors, &end_of_sequence));
+  }
+
+  const auto stats = iterator_stats->GetStats();
+  // Two map iterators and one range iterator.
+  ASSERT_EQ(stats.size(), 3);
+  const std::string outer_prefix = name_utils::IteratorPrefix(
+      MapDatasetOp::kDatasetType, dataset_params.iterator_prefix());
+  ASSERT_TRUE(stats.contains(outer_prefix));
+  const IteratorStats& outer = stats.at(outer_prefix);
+  EXPECT_EQ(outer.num_elements, 4);
+  EXPECT_EQ(outer.bytes_produced, 4 * static_cast<int64_t>(sizeof(int64_t)));
+  EXPECT_GT(outer.wall_time_ns, 0);
+  EXPECT_GE(outer.wall_time_ns, outer.input_time_ns);
+  EXPECT_GT(outer.input_time_ns, 0);
+  for (const auto& [prefix, prefix_stats] : stats) {
+    EXPECT_EQ(prefix_stats.num_elements, 4) << prefix;
+    EXPECT_GE(prefix_stats.cpu_time_ns, 0) << prefix;
+  }
+}
+
 std::vector<IteratorSaveAndRestoreTestCase<MapDatasetParams>>
 IteratorSaveAndRestoreTestCases() {
   return {{/*dataset_params=*/MapDatasetParams1(),
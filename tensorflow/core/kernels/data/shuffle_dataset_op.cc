@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/shuffle_dataset_op.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <deque>
 #include <memory>
@@ -32,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/random_seed_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
@@ -54,6 +56,8 @@ namespace data {
     ShuffleDatasetOpBase::kReshuffleEachIteration;
 
 /* static */ constexpr const char* const ShuffleDatasetOp::kDatasetType;
+/* static */ constexpr const char* const ShuffleDatasetOp::kNumShards;
+/* static */ constexpr const char* const ShuffleDatasetOp::kDeterministic;
 
 /* static */ constexpr const char* const
     ShuffleAndRepeatDatasetOp::kDatasetType;
@@ -72,6 +76,9 @@ constexpr char kSlicesStart[] = "slices_start";
 constexpr char kSlicesEnd[] = "slices_end";
 constexpr char kSeedGenerator[] = "SeedGenerator";
 constexpr char kEpochNumRandomSamples[] = "epoch_num_random_samples";
+constexpr char kNextFillShard[] = "next_fill_shard";
+constexpr char kNextReadShard[] = "next_read_shard";
+constexpr char kShard[] = "shard";
 constexpr char kShuffleDatasetV1[] = "ShuffleDataset";
 constexpr char kShuffleDatasetV2[] = "ShuffleDatasetV2";
 constexpr char kShuffleDatasetV3[] = "ShuffleDatasetV3";
@@ -87,15 +94,20 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   ShuffleDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
                      int64_t buffer_size,
                      std::shared_ptr<SeedGenerator> seed_generator,
-                     int64_t count)
+                     int64_t count, int64_t num_shards = 1,
+                     DeterminismPolicy deterministic = DeterminismPolicy())
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         buffer_size_(buffer_size),
         seed_generator_(std::move(seed_generator)),
         count_(count),
+        num_shards_(num_shards),
+        deterministic_(deterministic),
         traceme_metadata_(
             {{"buffer_size",
-              strings::Printf("%lld", static_cast<long long>(buffer_size))}}) {
+              strings::Printf("%lld", static_cast<long long>(buffer_size))},
+             {"num_shards",
+              strings::Printf("%lld", static_cast<long long>(num_shards))}}) {
     input_->Ref();
   }
 
@@ -157,6 +169,12 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
       const string& prefix) const override {
+    if (num_shards_ > 1 && count_ == 1) {
+      return std::make_unique<ShardedIterator>(
+          ShardedIterator::Params{this,
+                                  name_utils::IteratorPrefix(op_type(), prefix)},
+          seed_generator_.get());
+    }
     return std::make_unique<Iterator>(
         Iterator::Params{this, name_utils::IteratorPrefix(op_type(), prefix)},
         seed_generator_.get());
@@ -492,6 +510,331 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
     bool data_produced_ TF_GUARDED_BY(mu_) = false;
   };
 
+  // Iterator used when the shuffle buffer is split into `num_shards_` shards.
+  //
+  // Each shard holds up to `ceil(buffer_size / num_shards)` elements and is
+  // filled by background threads that read from a single input iterator. An
+  // element is produced from a shard once the shard is full (or the input is
+  // exhausted), by picking an element of the shard uniformly at random using
+  // a per-shard RNG seeded with `(seed, seed2 + shard_index)`.
+  //
+  // In deterministic mode, a single background thread assigns input elements
+  // to the shards round-robin and the shards are sampled round-robin, so the
+  // output order only depends on the seeds. Otherwise, each shard has its own
+  // background thread and the iterator samples whichever shard becomes ready
+  // first, which lets the shards be filled by concurrent calls to the input
+  // iterator.
+  class ShardedIterator : public DatasetIterator<ShuffleDatasetBase> {
+   public:
+    explicit ShardedIterator(const Params& params,
+                             SeedGenerator* seed_generator)
+        : DatasetIterator<ShuffleDatasetBase>(params),
+          seed_generator_(seed_generator),
+          deterministic_(params.dataset->deterministic_.IsDeterministic() ||
+                         params.dataset->deterministic_.IsDefault()),
+          shard_capacity_((params.dataset->buffer_size_ +
+                           params.dataset->num_shards_ - 1) /
+                          params.dataset->num_shards_),
+          shards_(params.dataset->num_shards_) {}
+
+    ~ShardedIterator() override {
+      CancelThreads();
+      if (deregister_fn_) deregister_fn_();
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      seed_generator_->GenerateSeeds(&seed_, &seed2_);
+      cancellation_manager_ = std::make_unique<CancellationManager>();
+      TF_RETURN_IF_ERROR(RegisterCancellationCallback(
+          ctx->cancellation_manager(), [this]() { CancelThreads(); },
+          &deregister_fn_));
+      IteratorContext::Params params(ctx);
+      params.cancellation_manager = cancellation_manager_.get();
+      IteratorContext iter_ctx(std::move(params));
+      return dataset()->input_->MakeIterator(&iter_ctx, this, prefix(),
+                                             &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      EnsureThreadsStarted(ctx);
+      while (true) {
+        if (cancelled_) {
+          return errors::Cancelled("Iterator was cancelled");
+        }
+        if (!status_.ok()) {
+          Status s = status_;
+          status_ = OkStatus();
+          return s;
+        }
+        int64_t shard_index;
+        if (SelectShard(&shard_index)) {
+          Shard& shard = shards_[shard_index];
+          const int64_t index = Random(shard_index) % shard.elements.size();
+          *out_tensors = std::move(shard.elements[index]);
+          RecordBufferDequeue(ctx, *out_tensors);
+          std::swap(shard.elements[index], shard.elements.back());
+          shard.elements.pop_back();
+          next_read_shard_ = (shard_index + 1) % shards_.size();
+          cond_var_.notify_all();
+          *end_of_sequence = false;
+          return OkStatus();
+        }
+        if (AllShardsDrained()) {
+          *end_of_sequence = true;
+          return OkStatus();
+        }
+        RecordStop(ctx);
+        cond_var_.wait(l);
+        RecordStart(ctx);
+      }
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args),
+                                       /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      // Acquiring `input_mu_` exclusively waits for in-flight calls to the
+      // input iterator, so that every element it has produced is in a shard.
+      mutex_lock input_l(input_mu_);
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kEpochNumRandomSamples),
+                              seed_generator_->num_random_samples()));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kSeed), seed_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kSeed2), seed2_));
+      if (input_exhausted_) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kEndOfInputSequence), ""));
+      } else {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      }
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kNextFillShard), next_fill_shard_));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kNextReadShard), next_read_shard_));
+      for (size_t i = 0; i < shards_.size(); ++i) {
+        const std::string shard_prefix = ShardPrefix(i);
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            shard_prefix, kNumRandomSamples, shards_[i].num_random_samples));
+        TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(writer, shard_prefix,
+                                                     shards_[i].elements));
+      }
+      return OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock input_l(input_mu_);
+      mutex_lock l(mu_);
+      int64_t num_random_samples;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kEpochNumRandomSamples),
+                                            &num_random_samples));
+      seed_generator_->set_num_random_samples(num_random_samples);
+      seed_generator_->Reset();
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kSeed), &seed_));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kSeed2), &seed2_));
+      input_exhausted_ = reader->Contains(full_name(kEndOfInputSequence));
+      if (!input_exhausted_) {
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      }
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kNextFillShard), &next_fill_shard_));
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kNextReadShard), &next_read_shard_));
+      for (size_t i = 0; i < shards_.size(); ++i) {
+        const std::string shard_prefix = ShardPrefix(i);
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            shard_prefix, kNumRandomSamples, &shards_[i].num_random_samples));
+        shards_[i].elements.clear();
+        TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+            ctx, reader, shard_prefix, &shards_[i].elements));
+        for (const auto& element : shards_[i].elements) {
+          RecordBufferEnqueue(ctx, element);
+        }
+      }
+      status_ = OkStatus();
+      return OkStatus();
+    }
+
+    TraceMeMetadata GetTraceMeMetadata() const override {
+      return dataset()->traceme_metadata_;
+    }
+
+   private:
+    struct Shard {
+      std::vector<std::vector<Tensor>> elements;
+      // The number of samples drawn from the shard's RNG. The RNG itself is
+      // counter-based, so it is recreated from this number when sampling.
+      int64_t num_random_samples = 0;
+    };
+
+    std::string ShardPrefix(size_t index) const {
+      return full_name(absl::StrCat(kShard, "_", index));
+    }
+
+    random::SingleSampleAdapter<random::PhiloxRandom>::ResultType Random(
+        int64_t shard_index) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      random::PhiloxRandom parent_generator(seed_, seed2_ + shard_index);
+      random::SingleSampleAdapter<random::PhiloxRandom> generator(
+          &parent_generator);
+      generator.Skip(shards_[shard_index].num_random_samples++);
+      return generator();
+    }
+
+    // Returns true if no further input elements will be added to the shards.
+    bool InputDone() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return input_exhausted_ && num_active_fills_ == 0;
+    }
+
+    bool IsShardReady(const Shard& shard) const
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return shard.elements.size() >= shard_capacity_ ||
+             (InputDone() && !shard.elements.empty());
+    }
+
+    bool AllShardsDrained() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!InputDone()) return false;
+      for (const Shard& shard : shards_) {
+        if (!shard.elements.empty()) return false;
+      }
+      return true;
+    }
+
+    // Selects the shard to produce the next element from, if one is ready.
+    bool SelectShard(int64_t* shard_index) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (size_t i = 0; i < shards_.size(); ++i) {
+        const int64_t index = (next_read_shard_ + i) % shards_.size();
+        if (IsShardReady(shards_[index])) {
+          *shard_index = index;
+          return true;
+        }
+        // In deterministic mode, shards are visited in order and a shard is
+        // only skipped once it is known to stay empty.
+        if (deterministic_ &&
+            !(InputDone() && shards_[index].elements.empty())) {
+          return false;
+        }
+      }
+      return false;
+    }
+
+    void EnsureThreadsStarted(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!threads_.empty()) return;
+      auto ctx_copy = std::make_shared<IteratorContext>(*ctx);
+      const int64_t num_threads = deterministic_ ? 1 : shards_.size();
+      for (int64_t i = 0; i < num_threads; ++i) {
+        threads_.push_back(ctx->StartThread(
+            absl::StrCat("tf_data_sharded_shuffle_", i),
+            [this, ctx_copy, i]() { FillerThread(ctx_copy, i); }));
+      }
+    }
+
+    void CancelThreads() TF_LOCKS_EXCLUDED(mu_) {
+      if (cancellation_manager_) cancellation_manager_->StartCancel();
+      mutex_lock l(mu_);
+      cancelled_ = true;
+      cond_var_.notify_all();
+    }
+
+    // Returns the shard that filler thread `thread_index` should add its next
+    // element to, or -1 if that shard is full.
+    int64_t ShardToFill(int64_t thread_index) const
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64_t index = deterministic_ ? next_fill_shard_ : thread_index;
+      return shards_[index].elements.size() < shard_capacity_ ? index : -1;
+    }
+
+    void FillerThread(const std::shared_ptr<IteratorContext>& ctx,
+                      int64_t thread_index) {
+      RecordStart(ctx.get());
+      auto cleanup = gtl::MakeCleanup([this, ctx] { RecordStop(ctx.get()); });
+      while (true) {
+        {
+          mutex_lock l(mu_);
+          while (!cancelled_ && !input_exhausted_ &&
+                 ShardToFill(thread_index) < 0) {
+            RecordStop(ctx.get());
+            cond_var_.wait(l);
+            RecordStart(ctx.get());
+          }
+          if (cancelled_ || input_exhausted_) return;
+        }
+        // The shard is picked again after acquiring `input_mu_`, so that a
+        // checkpoint never observes a fill that has been assigned a shard but
+        // has not fetched its element yet.
+        tf_shared_lock input_l(input_mu_);
+        int64_t shard_index;
+        {
+          mutex_lock l(mu_);
+          if (cancelled_ || input_exhausted_) return;
+          shard_index = ShardToFill(thread_index);
+          if (shard_index < 0) continue;
+          ++num_active_fills_;
+        }
+        std::vector<Tensor> element;
+        bool end_of_input = false;
+        Status s = input_impl_->GetNext(ctx.get(), &element, &end_of_input);
+        mutex_lock l(mu_);
+        --num_active_fills_;
+        if (!s.ok()) {
+          if (status_.ok()) status_ = s;
+        } else if (end_of_input) {
+          input_exhausted_ = true;
+        } else {
+          RecordBufferEnqueue(ctx.get(), element);
+          shards_[shard_index].elements.push_back(std::move(element));
+          if (deterministic_) {
+            next_fill_shard_ = (next_fill_shard_ + 1) % shards_.size();
+          }
+        }
+        cond_var_.notify_all();
+      }
+    }
+
+    SeedGenerator* const seed_generator_;  // Not owned.
+    const bool deterministic_;
+    const size_t shard_capacity_;
+
+    // Guards the input iterator. Filler threads hold it in shared mode while
+    // they fetch an element and add it to a shard; checkpointing holds it in
+    // exclusive mode.
+    mutex input_mu_;
+    mutex mu_ TF_ACQUIRED_AFTER(input_mu_);
+    condition_variable cond_var_;
+    std::vector<Shard> shards_ TF_GUARDED_BY(mu_);
+    int64_t seed_ TF_GUARDED_BY(mu_) = 0;
+    int64_t seed2_ TF_GUARDED_BY(mu_) = 0;
+    // The next shard to fill in deterministic mode.
+    int64_t next_fill_shard_ TF_GUARDED_BY(mu_) = 0;
+    // The first shard to consider when producing the next element.
+    int64_t next_read_shard_ TF_GUARDED_BY(mu_) = 0;
+    // The number of calls to the input iterator that are in flight.
+    int64_t num_active_fills_ TF_GUARDED_BY(mu_) = 0;
+    bool input_exhausted_ TF_GUARDED_BY(mu_) = false;
+    bool cancelled_ TF_GUARDED_BY(mu_) = false;
+    // An input error to be returned by the next call to `GetNext`.
+    Status status_ TF_GUARDED_BY(mu_);
+
+    std::unique_ptr<CancellationManager> cancellation_manager_;
+    // Must be ordered after `cancellation_manager_` so that `input_impl_` is
+    // destroyed first.
+    std::unique_ptr<IteratorBase> input_impl_ TF_PT_GUARDED_BY(input_mu_);
+    std::function<void()> deregister_fn_;
+    // Must be ordered after `input_impl_` so that the threads are joined
+    // before the input iterator is destroyed.
+    std::vector<std::unique_ptr<Thread>> threads_ TF_GUARDED_BY(mu_);
+  };
+
   const DatasetBase* const input_;
   const int64_t buffer_size_;
   const std::shared_ptr<SeedGenerator> seed_generator_;
@@ -499,6 +842,10 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   // fuse shuffle and repeat together, and make the shuffle dataset op
   // responsible for repeating as well.
   const int64_t count_;
+  // The number of shards the shuffle buffer is split into. Only the
+  // `ShuffleDatasetV3` op supports more than one shard.
+  const int64_t num_shards_;
+  const DeterminismPolicy deterministic_;
   const TraceMeMetadata traceme_metadata_;
   mutable mutex mu_;
   mutable std::vector<std::int64_t> shuffled_indices_ TF_GUARDED_BY(mu_);
@@ -624,8 +971,10 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
  public:
   DatasetV3(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
             int64_t count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-            ResourceHandle&& resource_handle, bool owns_resource)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+            ResourceHandle&& resource_handle, bool owns_resource,
+            int64_t num_shards, DeterminismPolicy deterministic)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           num_shards, deterministic),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -664,12 +1013,18 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
     AttrValue reshuffle_each_iteration;
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    AttrValue num_shards;
+    b->BuildAttrValue(num_shards_, &num_shards);
+    AttrValue deterministic;
+    b->BuildAttrValue(deterministic_.String(), &deterministic);
     TF_RETURN_IF_ERROR(
         b->AddDataset(this,
                       {input_graph_node, buffer_size_node, seed_node,
                        seed2_node, resource_handle_node},  // Inputs
                       {std::make_pair(kReshuffleEachIteration,
-                                      reshuffle_each_iteration)},  // Attrs
+                                      reshuffle_each_iteration),
+                       std::make_pair(kNumShards, num_shards),
+                       std::make_pair(kDeterministic, deterministic)},  // Attrs
                       output));
     return OkStatus();
   }
@@ -696,6 +1051,17 @@ ShuffleDatasetOp::ShuffleDatasetOp(OpKernelConstruction* ctx)
     OP_REQUIRES_OK(
         ctx, ctx->GetAttr(kReshuffleEachIteration, &reshuffle_each_iteration_));
   }
+  if (ctx->HasAttr(kNumShards)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kNumShards, &num_shards_));
+    OP_REQUIRES(ctx, num_shards_ > 0,
+                errors::InvalidArgument("num_shards must be greater than zero."));
+  }
+  if (ctx->HasAttr(kDeterministic)) {
+    std::string deterministic;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kDeterministic, &deterministic));
+    OP_REQUIRES_OK(
+        ctx, DeterminismPolicy::FromString(deterministic, &deterministic_));
+  }
 }
 
 void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -746,9 +1112,11 @@ void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
     }
 
     // Ownership of manager is transferred onto `DatasetV3`.
-    *output = new ShuffleDatasetOp::DatasetV3(ctx, input, buffer_size, count,
-                                              std::move(seeds), manager,
-                                              std::move(handle), owns_resource);
+    // Each shard holds at least one element.
+    const int64_t num_shards = std::min(num_shards_, buffer_size);
+    *output = new ShuffleDatasetOp::DatasetV3(
+        ctx, input, buffer_size, count, std::move(seeds), manager,
+        std::move(handle), owns_resource, num_shards, deterministic_);
   } else if (op_version_ == 2) {
     auto handle = HandleFromInput(ctx, 2);
     SeedGeneratorManager* manager = nullptr;
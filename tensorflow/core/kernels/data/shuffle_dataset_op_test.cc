@@ -33,14 +33,21 @@ class ShuffleDatasetParams : public DatasetParams {
                        bool reshuffle_each_iteration,
                        DataTypeVector output_dtypes,
                        std::vector<PartialTensorShape> output_shapes,
-                       string node_name)
+                       string node_name, int64_t num_shards = 1,
+                       string deterministic = DeterminismPolicy::kDefault)
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
         buffer_size_(buffer_size),
         seed_(seed),
         seed2_(seed2),
         count_(count),
-        reshuffle_each_iteration_(reshuffle_each_iteration) {
+        reshuffle_each_iteration_(reshuffle_each_iteration),
+        num_shards_(num_shards),
+        deterministic_(std::move(deterministic)) {
+    // Only `ShuffleDatasetV3` supports a sharded buffer.
+    if (num_shards_ != 1) {
+      op_version_ = 3;
+    }
     input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
     iterator_prefix_ =
         name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
@@ -52,6 +59,11 @@ class ShuffleDatasetParams : public DatasetParams {
         CreateTensor<int64_t>(TensorShape({}), {buffer_size_}),
         CreateTensor<int64_t>(TensorShape({}), {seed_}),
         CreateTensor<int64_t>(TensorShape({}), {seed2_})};
+    if (op_version_ == 3) {
+      // A handle to a resource that does not exist, which makes the dataset
+      // create its own seed generator.
+      input_tensors.emplace_back(DT_RESOURCE, TensorShape({}));
+    }
     if (count_ != 1) {
       input_tensors.emplace_back(
           CreateTensor<int64_t>(TensorShape({}), {count_}));
@@ -65,6 +77,9 @@ class ShuffleDatasetParams : public DatasetParams {
     input_names->emplace_back(ShuffleDatasetOpBase::kBufferSize);
     input_names->emplace_back(ShuffleDatasetOpBase::kSeed);
     input_names->emplace_back(ShuffleDatasetOpBase::kSeed2);
+    if (op_version_ == 3) {
+      input_names->emplace_back("seed_generator");
+    }
     if (count_ != 1) {
       input_names->emplace_back(ShuffleAndRepeatDatasetOp::kCount);
     }
@@ -78,6 +93,11 @@ class ShuffleDatasetParams : public DatasetParams {
     attr_vector->emplace_back("reshuffle_each_iteration",
                               reshuffle_each_iteration_);
     attr_vector->emplace_back("metadata", "");
+    if (op_version_ == 3) {
+      attr_vector->emplace_back(ShuffleDatasetOp::kNumShards, num_shards_);
+      attr_vector->emplace_back(ShuffleDatasetOp::kDeterministic,
+                                deterministic_);
+    }
     return OkStatus();
   }
 
@@ -96,6 +116,8 @@ class ShuffleDatasetParams : public DatasetParams {
   int64_t seed2_;
   int64_t count_;
   bool reshuffle_each_iteration_;
+  int64_t num_shards_;
+  string deterministic_;
 };
 
 class ShuffleDatasetOpTest : public DatasetOpsTestBase {};
@@ -565,6 +587,122 @@ TEST_F(ShuffleDatasetOpTest, InvalidArguments) {
   }
 }
 
+ShuffleDatasetParams ShardedShuffleDatasetParams(int64_t num_shards,
+                                                 string deterministic) {
+  return ShuffleDatasetParams(RangeDatasetParams(0, 20, 1),
+                              /*buffer_size=*/6,
+                              /*seed=*/1,
+                              /*seed2=*/2,
+                              /*count=*/1,
+                              /*reshuffle_each_iteration=*/false,
+                              /*output_dtypes=*/{DT_INT64},
+                              /*output_shapes=*/{PartialTensorShape({})},
+                              /*node_name=*/kShuffleNodeName, num_shards,
+                              std::move(deterministic));
+}
+
+class ShardedShuffleDatasetOpTest : public ShuffleDatasetOpTest {
+ protected:
+  // Reads all elements from a new iterator over `dataset_`.
+  Status ReadAll(const ShuffleDatasetParams& dataset_params,
+                 std::vector<Tensor>* out_tensors) {
+    TF_RETURN_IF_ERROR(dataset_->MakeIterator(iterator_ctx_.get(),
+                                              /*parent=*/nullptr,
+                                              dataset_params.iterator_prefix(),
+                                              &iterator_));
+    bool end_of_sequence = false;
+    while (!end_of_sequence) {
+      std::vector<Tensor> next;
+      TF_RETURN_IF_ERROR(
+          iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      out_tensors->insert(out_tensors->end(), next.begin(), next.end());
+    }
+    return OkStatus();
+  }
+};
+
+TEST_F(ShardedShuffleDatasetOpTest, ProducesAllElements) {
+  std::vector<Tensor> expected_outputs;
+  for (int64_t i = 0; i < 20; ++i) {
+    expected_outputs.push_back(CreateTensor<int64_t>(TensorShape({}), {i}));
+  }
+  for (int64_t num_shards : {2, 3, 6, 10}) {
+    for (const char* deterministic :
+         {DeterminismPolicy::kDeterministic,
+          DeterminismPolicy::kNondeterministic}) {
+      auto dataset_params =
+          ShardedShuffleDatasetParams(num_shards, deterministic);
+      TF_ASSERT_OK(Initialize(dataset_params));
+      std::vector<Tensor> out_tensors;
+      TF_ASSERT_OK(ReadAll(dataset_params, &out_tensors));
+      TF_EXPECT_OK(ExpectEqual(out_tensors, expected_outputs,
+                               /*compare_order=*/false));
+    }
+  }
+}
+
+TEST_F(ShardedShuffleDatasetOpTest, DeterministicOrder) {
+  auto dataset_params =
+      ShardedShuffleDatasetParams(/*num_shards=*/3,
+                                  DeterminismPolicy::kDeterministic);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> expected_outputs;
+  TF_ASSERT_OK(ReadAll(dataset_params, &expected_outputs));
+  for (int i = 0; i < 5; ++i) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(ReadAll(dataset_params, &out_tensors));
+    TF_EXPECT_OK(ExpectEqual(out_tensors, expected_outputs,
+                             /*compare_order=*/true));
+  }
+}
+
+TEST_F(ShardedShuffleDatasetOpTest, SaveAndRestore) {
+  auto dataset_params =
+      ShardedShuffleDatasetParams(/*num_shards=*/3,
+                                  DeterminismPolicy::kDeterministic);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> expected_outputs;
+  TF_ASSERT_OK(ReadAll(dataset_params, &expected_outputs));
+  TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &iterator_));
+
+  std::unique_ptr<SerializationContext> serialization_ctx;
+  TF_ASSERT_OK(CreateSerializationContext(&serialization_ctx));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  int cur_iteration = 0;
+  for (int breakpoint : {0, 4, 11, 25}) {
+    VariantTensorDataWriter writer;
+    TF_EXPECT_OK(iterator_->Save(serialization_ctx.get(), &writer));
+    std::vector<const VariantTensorData*> data;
+    writer.GetData(&data);
+    VariantTensorDataReader reader(data);
+    TF_EXPECT_OK(RestoreIterator(iterator_ctx_.get(), &reader,
+                                 dataset_params.iterator_prefix(), *dataset_,
+                                 &iterator_));
+
+    while (cur_iteration <= breakpoint) {
+      std::vector<Tensor> next;
+      TF_EXPECT_OK(
+          iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+      cur_iteration++;
+    }
+  }
+  EXPECT_TRUE(end_of_sequence);
+  TF_EXPECT_OK(
+      ExpectEqual(out_tensors, expected_outputs, /*compare_order=*/true));
+}
+
+TEST_F(ShardedShuffleDatasetOpTest, InvalidNumShards) {
+  auto dataset_params =
+      ShardedShuffleDatasetParams(/*num_shards=*/0,
+                                  DeterminismPolicy::kDeterministic);
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -14,17 +14,25 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/raw_coding.h"
 
 namespace tensorflow {
 namespace data {
@@ -36,6 +44,7 @@ namespace data {
 /* static */ constexpr const char* const TFRecordDatasetOp::kFileNames;
 /* static */ constexpr const char* const TFRecordDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TFRecordDatasetOp::kBufferSize;
+/* static */ constexpr const char* const TFRecordDatasetOp::kUseMmap;
 
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kOffset[] = "offset";
@@ -52,15 +61,84 @@ bool is_cloud_tpu_gcs_fs() {
   return false;
 }
 
+namespace {
+
+// Returns a memory mapping of `filename`, or nullptr in `*region` if the file
+// is empty. Files must not be truncated while they are mapped.
+//
+// Only files on the local file system are mapped. Other file systems either do
+// not support memory mapping or emulate it by reading the whole file into
+// memory, so Unimplemented is returned for them and they are streamed instead.
+Status MapLocalFile(Env* env, const string& filename,
+                    std::unique_ptr<ReadOnlyMemoryRegion>* region) {
+  StringPiece scheme, host, path;
+  io::ParseURI(filename, &scheme, &host, &path);
+  if (!scheme.empty() && scheme != "file") {
+    return errors::Unimplemented(
+        "Memory mapping is only used for local files.");
+  }
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  region->reset();
+  if (file_size == 0) return OkStatus();
+  return env->NewReadOnlyMemoryRegionFromFile(filename, region);
+}
+
+// Validates the (length, masked crc32c of length) header of the record at
+// `offset` in `data` and returns the length of the record. Returns OutOfRange
+// at the end of the data, like `io::RecordReader`.
+Status ReadMappedRecordHeader(StringPiece data, uint64 offset,
+                              uint64* length) {
+  if (offset == data.size()) {
+    return errors::OutOfRange("eof");
+  }
+  if (data.size() - offset < io::RecordReader::kHeaderSize) {
+    return errors::DataLoss("truncated record at ", offset);
+  }
+  const char* header = data.data() + offset;
+  const uint32 masked_crc = core::DecodeFixed32(header + sizeof(uint64));
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(header, sizeof(uint64))) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  *length = core::DecodeFixed64(header);
+  const uint64 remaining =
+      data.size() - offset - io::RecordReader::kHeaderSize;
+  if (remaining < io::RecordReader::kFooterSize ||
+      *length > remaining - io::RecordReader::kFooterSize) {
+    return errors::DataLoss("truncated record at ", offset);
+  }
+  return OkStatus();
+}
+
+// Reads the record at `*offset` in `data` into `*record` without copying it,
+// verifies its checksum, and advances `*offset` past it.
+Status ReadMappedRecord(StringPiece data, uint64* offset, StringPiece* record) {
+  uint64 length;
+  TF_RETURN_IF_ERROR(ReadMappedRecordHeader(data, *offset, &length));
+  const char* start = data.data() + *offset + io::RecordReader::kHeaderSize;
+  const uint32 masked_crc = core::DecodeFixed32(start + length);
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(start, length)) {
+    return errors::DataLoss("corrupted record at ", *offset);
+  }
+  *record = StringPiece(start, length);
+  *offset += io::RecordReader::kHeaderSize + length +
+             io::RecordReader::kFooterSize;
+  return OkStatus();
+}
+
+}  // namespace
+
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                   const string& compression_type, int64_t buffer_size)
+                   const string& compression_type, int64_t buffer_size,
+                   bool use_mmap)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
-            compression_type)) {
+            compression_type)),
+        use_mmap_(use_mmap) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
@@ -103,8 +181,11 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     Node* buffer_size = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
-    TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {filenames, compression_type, buffer_size}, output));
+    AttrValue use_mmap;
+    b->BuildAttrValue(use_mmap_, &use_mmap);
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {filenames, compression_type, buffer_size},
+                      {{kUseMmap, use_mmap}}, output));
     return OkStatus();
   }
 
@@ -122,6 +203,30 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       out_tensors->reserve(1);
       mutex_lock l(mu_);
       do {
+        // We are currently processing a memory-mapped file, so try to read
+        // the next record.
+        if (mapped_) {
+          StringPiece record;
+          Status s = ReadMappedRecord(MappedDataLocked(), &offset_, &record);
+          if (s.ok()) {
+            static monitoring::CounterCell* bytes_counter =
+                metrics::GetTFDataBytesReadCounter(kDatasetType);
+            bytes_counter->IncrementBy(record.size());
+            // The record is copied out of the mapping, which is released as
+            // soon as the iterator moves past the file. A view would dangle
+            // in copies of the element, e.g. in the output of `batch`.
+            out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                      TensorShape({}));
+            out_tensors->back().scalar<tstring>()().assign(record.data(),
+                                                           record.size());
+            *end_of_sequence = false;
+            return OkStatus();
+          }
+          ResetStreamsLocked();
+          ++current_file_index_;
+          if (!errors::IsOutOfRange(s)) return s;
+        }
+
         // We are currently processing a file, so try to read the next record.
         if (reader_) {
           out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
@@ -167,6 +272,28 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       *num_skipped = 0;
       mutex_lock l(mu_);
       do {
+        // We are currently processing a memory-mapped file, so skip the
+        // records without verifying their data checksums, like
+        // `io::RecordReader::SkipRecords()`.
+        if (mapped_) {
+          Status s;
+          while (*num_skipped < num_to_skip) {
+            uint64 length;
+            s = ReadMappedRecordHeader(MappedDataLocked(), offset_, &length);
+            if (!s.ok()) break;
+            offset_ += io::RecordReader::kHeaderSize + length +
+                       io::RecordReader::kFooterSize;
+            ++*num_skipped;
+          }
+          if (s.ok()) {
+            *end_of_sequence = false;
+            return OkStatus();
+          }
+          ResetStreamsLocked();
+          ++current_file_index_;
+          if (!errors::IsOutOfRange(s)) return s;
+        }
+
         // We are currently processing a file, so try to skip reading
         // the next (num_to_skip - *num_skipped) record.
         if (reader_) {
@@ -215,7 +342,10 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCurrentFileIndex),
                                              current_file_index_));
 
-      if (reader_) {
+      if (mapped_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kOffset),
+                                               static_cast<int64_t>(offset_)));
+      } else if (reader_) {
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(full_name(kOffset), reader_->TellOffset()));
       }
@@ -234,7 +364,16 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
         int64_t offset;
         TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kOffset), &offset));
         TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
-        TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
+        if (mapped_) {
+          if (offset < 0 || offset > MappedDataLocked().size()) {
+            return errors::DataLoss("Invalid offset ", offset, " in file ",
+                                    dataset()->filenames_[current_file_index_],
+                                    " of size ", MappedDataLocked().size());
+          }
+          offset_ = offset;
+        } else {
+          TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
+        }
       }
       return OkStatus();
     }
@@ -249,9 +388,20 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       }
 
       // Actually move on to next file.
-      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
-          TranslateFileName(dataset()->filenames_[current_file_index_]),
-          &file_));
+      const string filename =
+          TranslateFileName(dataset()->filenames_[current_file_index_]);
+      if (dataset()->UseMmap()) {
+        Status s = MapLocalFile(env, filename, &region_);
+        if (s.ok()) {
+          mapped_ = true;
+          offset_ = 0;
+          return OkStatus();
+        }
+        if (!errors::IsUnimplemented(s)) return s;
+        VLOG(2) << "Memory mapping is not supported for " << filename
+                << ", reading it through a RandomAccessFile.";
+      }
+      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file_));
       reader_ = std::make_unique<io::SequentialRecordReader>(
           file_.get(), dataset()->options_);
       return OkStatus();
@@ -261,6 +411,16 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       reader_.reset();
       file_.reset();
+      mapped_ = false;
+      region_.reset();
+      offset_ = 0;
+    }
+
+    // Returns the contents of the current memory-mapped file.
+    StringPiece MappedDataLocked() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (region_ == nullptr) return StringPiece();
+      return StringPiece(static_cast<const char*>(region_->data()),
+                         region_->length());
     }
 
     mutex mu_;
@@ -270,15 +430,33 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
+
+    // Set while reading a memory-mapped file, in which case `region_` is the
+    // mapping (or nullptr for an empty file) and `offset_` the offset of the
+    // next record. Only the current file is mapped.
+    bool mapped_ TF_GUARDED_BY(mu_) = false;
+    std::unique_ptr<ReadOnlyMemoryRegion> region_ TF_GUARDED_BY(mu_);
+    uint64 offset_ TF_GUARDED_BY(mu_) = 0;
   };
 
+  // Memory mapping is only used for uncompressed files.
+  bool UseMmap() const {
+    return use_mmap_ &&
+           options_.compression_type == io::RecordReaderOptions::NONE;
+  }
+
   const std::vector<string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
+  const bool use_mmap_;
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
-    : DatasetOpKernel(ctx) {}
+    : DatasetOpKernel(ctx) {
+  if (ctx->HasAttr(kUseMmap)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kUseMmap, &use_mmap_));
+  }
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -326,8 +504,8 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     buffer_size = kS3BlockSize;
   }
 
-  *output =
-      new Dataset(ctx, std::move(filenames), compression_type, buffer_size);
+  *output = new Dataset(ctx, std::move(filenames), compression_type,
+                        buffer_size, use_mmap_);
 }
 
 namespace {
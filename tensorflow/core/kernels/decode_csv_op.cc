@@ -14,13 +14,17 @@ limitations under the License.
 ==============================================================================*/
 
 // See docs in ../ops/parsing_ops.cc.
+#include <algorithm>
 #include <vector>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -76,143 +80,180 @@ class DecodeCSVOp : public OpKernel {
     OpOutputList output;
     OP_REQUIRES_OK(ctx, ctx->output_list("output", &output));
 
+    std::vector<Tensor*> outputs(out_type_.size());
     for (int i = 0; i < static_cast<int>(out_type_.size()); ++i) {
-      Tensor* out = nullptr;
-      OP_REQUIRES_OK(ctx, output.allocate(i, records->shape(), &out));
+      OP_REQUIRES_OK(ctx, output.allocate(i, records->shape(), &outputs[i]));
+    }
+    std::vector<const Tensor*> defaults(record_defaults.size());
+    for (int i = 0; i < record_defaults.size(); ++i) {
+      defaults[i] = &record_defaults[i];
     }
 
-    for (int64_t i = 0; i < records_size; ++i) {
-      const StringPiece record(records_t(i));
+    // Records are parsed in parallel. If several records are invalid, the
+    // error of the first one is reported, as when parsing them in order.
+    mutex mu;
+    int64_t first_invalid_record = records_size;
+    Status first_error;
+    auto parse = [&](int64_t start, int64_t limit) {
+      // The fields are reused across records, so that their buffers are only
+      // reallocated when a field is longer than in all the previous records.
       std::vector<string> fields;
-      ExtractFields(ctx, record, &fields);
-      OP_REQUIRES(ctx, fields.size() == out_type_.size(),
-                  errors::InvalidArgument("Expect ", out_type_.size(),
-                                          " fields but have ", fields.size(),
-                                          " in record ", i));
+      for (int64_t i = start; i < limit; ++i) {
+        Status s = ParseRecord(i, records_t(i), defaults, &fields, &outputs);
+        if (!s.ok()) {
+          mutex_lock l(mu);
+          if (i < first_invalid_record) {
+            first_invalid_record = i;
+            first_error = s;
+          }
+          return;
+        }
+      }
+    };
+    int64_t records_bytes = 0;
+    for (int64_t i = 0; i < records_size; ++i) {
+      records_bytes += records_t(i).size();
+    }
+    const int64_t cost_per_record =
+        kCostPerField * out_type_.size() +
+        (records_size > 0 ? kCostPerByte * records_bytes / records_size : 0);
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, records_size,
+          cost_per_record, parse);
+    OP_REQUIRES_OK(ctx, first_error);
+  }
 
-      // Check each field in the record
-      for (int f = 0; f < static_cast<int>(out_type_.size()); ++f) {
-        const DataType& dtype = out_type_[f];
-        switch (dtype) {
-          case DT_INT32: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
+ private:
+  // Costs used to shard the records over the threads.
+  static constexpr int64_t kCostPerField = 100;
+  static constexpr int64_t kCostPerByte = 4;
 
-              output[f]->flat<int32>()(i) = record_defaults[f].flat<int32>()(0);
-            } else {
-              int32_t value;
-              OP_REQUIRES(ctx, strings::safe_strto32(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid int32: ", fields[f]));
-              output[f]->flat<int32>()(i) = value;
-            }
-            break;
-          }
-          case DT_INT64: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
+  std::vector<DataType> out_type_;
+  std::vector<int64_t> select_cols_;
+  char delim_;
+  bool use_quote_delim_;
+  bool select_all_cols_;
+  string na_value_;
 
-              output[f]->flat<int64_t>()(i) =
-                  record_defaults[f].flat<int64_t>()(0);
-            } else {
-              int64_t value;
-              OP_REQUIRES(ctx, strings::safe_strto64(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid int64: ", fields[f]));
-              output[f]->flat<int64_t>()(i) = value;
+  // Parses the record at index `i` into the outputs. `fields` is the scratch
+  // space for the fields of the record.
+  Status ParseRecord(int64_t i, StringPiece record,
+                     const std::vector<const Tensor*>& record_defaults,
+                     std::vector<string>* fields,
+                     std::vector<Tensor*>* output) const {
+    int64_t num_fields = 0;
+    TF_RETURN_IF_ERROR(ExtractFields(record, fields, &num_fields));
+    if (num_fields != static_cast<int64_t>(out_type_.size())) {
+      return errors::InvalidArgument("Expect ", out_type_.size(),
+                                     " fields but have ", num_fields,
+                                     " in record ", i);
+    }
+
+    // Check each field in the record
+    for (int f = 0; f < static_cast<int>(out_type_.size()); ++f) {
+      const DataType& dtype = out_type_[f];
+      string& field = (*fields)[f];
+      Tensor* out = (*output)[f];
+      // If this field is empty or NA value, check if default is given:
+      // If yes, use default value; Otherwise report error.
+      const bool missing = field.empty() || field == na_value_;
+      if (missing && record_defaults[f]->NumElements() != 1) {
+        return errors::InvalidArgument(
+            "Field ", f, " is required but missing in record ", i, "!");
+      }
+      switch (dtype) {
+        case DT_INT32: {
+          if (missing) {
+            out->flat<int32>()(i) = record_defaults[f]->flat<int32>()(0);
+          } else {
+            int32_t value;
+            if (!strings::safe_strto32(field, &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid int32: ", field);
             }
-            break;
+            out->flat<int32>()(i) = value;
           }
-          case DT_FLOAT: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<float>()(i) = record_defaults[f].flat<float>()(0);
-            } else {
-              float value;
-              OP_REQUIRES(ctx, strings::safe_strtof(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid float: ", fields[f]));
-              output[f]->flat<float>()(i) = value;
+          break;
+        }
+        case DT_INT64: {
+          if (missing) {
+            out->flat<int64_t>()(i) = record_defaults[f]->flat<int64_t>()(0);
+          } else {
+            int64_t value;
+            if (!strings::safe_strto64(field, &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid int64: ", field);
             }
-            break;
+            out->flat<int64_t>()(i) = value;
           }
-          case DT_DOUBLE: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<double>()(i) =
-                  record_defaults[f].flat<double>()(0);
-            } else {
-              double value;
-              OP_REQUIRES(ctx, strings::safe_strtod(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid double: ", fields[f]));
-              output[f]->flat<double>()(i) = value;
+          break;
+        }
+        case DT_FLOAT: {
+          if (missing) {
+            out->flat<float>()(i) = record_defaults[f]->flat<float>()(0);
+          } else {
+            float value;
+            if (!strings::safe_strtof(field, &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid float: ", field);
             }
-            break;
+            out->flat<float>()(i) = value;
           }
-          case DT_STRING: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<tstring>()(i) =
-                  record_defaults[f].flat<tstring>()(0);
-            } else {
-              output[f]->flat<tstring>()(i) = std::move(fields[f]);
+          break;
+        }
+        case DT_DOUBLE: {
+          if (missing) {
+            out->flat<double>()(i) = record_defaults[f]->flat<double>()(0);
+          } else {
+            double value;
+            if (!strings::safe_strtod(field, &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid double: ",
+                                             field);
             }
-            break;
+            out->flat<double>()(i) = value;
           }
-          default:
-            OP_REQUIRES(ctx, false,
-                        errors::InvalidArgument("csv: data type ", dtype,
-                                                " not supported in field ", f));
+          break;
         }
+        case DT_STRING: {
+          if (missing) {
+            out->flat<tstring>()(i) = record_defaults[f]->flat<tstring>()(0);
+          } else {
+            out->flat<tstring>()(i).assign(field.data(), field.size());
+          }
+          break;
+        }
+        default:
+          return errors::InvalidArgument("csv: data type ", dtype,
+                                         " not supported in field ", f);
       }
     }
+    return OkStatus();
   }
 
- private:
-  std::vector<DataType> out_type_;
-  std::vector<int64_t> select_cols_;
-  char delim_;
-  bool use_quote_delim_;
-  bool select_all_cols_;
-  string na_value_;
-
-  void ExtractFields(OpKernelContext* ctx, StringPiece input,
-                     std::vector<string>* result) {
+  // Stores the selected fields of `input` in the first `*num_fields` elements
+  // of `result`. The elements are overwritten so that their buffers are
+  // reused.
+  Status ExtractFields(StringPiece input, std::vector<string>* result,
+                       int64_t* num_fields) const {
     int64_t current_idx = 0;
     int64_t num_fields_parsed = 0;
     int64_t selector_idx = 0;  // Keep track of index into select_cols
+    *num_fields = 0;
+    // Returns the next field to fill in.
+    auto next_field = [&]() -> string& {
+      if (*num_fields == static_cast<int64_t>(result->size())) {
+        result->emplace_back();
+      }
+      string& field = (*result)[(*num_fields)++];
+      field.clear();
+      return field;
+    };
 
     if (!input.empty()) {
+      // Characters that are invalid in unquoted fields.
+      const StringPiece unquoted_invalid =
+          use_quote_delim_ ? StringPiece("\"\n\r") : StringPiece("\n\r");
       while (static_cast<size_t>(current_idx) < input.size()) {
         if (input[current_idx] == '\n' || input[current_idx] == '\r') {
           current_idx++;
@@ -229,58 +270,64 @@ class DecodeCSVOp : public OpKernel {
           current_idx++;
         }
 
-        // This is the body of the field;
-        string field;
+        // This is the body of the field. The delimiters and quotes are found
+        // with memchr, which scans many bytes at a time, and the body is
+        // copied in bulk.
+        string* field = include ? &next_field() : nullptr;
         if (!quoted) {
-          while (static_cast<size_t>(current_idx) < input.size() &&
-                 input[current_idx] != delim_) {
-            OP_REQUIRES(ctx,
-                        (!use_quote_delim_ || input[current_idx] != '"') &&
-                            input[current_idx] != '\n' &&
-                            input[current_idx] != '\r',
-                        errors::InvalidArgument(
-                            "Unquoted fields cannot have quotes/CRLFs inside"));
-            if (include) field += input[current_idx];
-            current_idx++;
+          size_t end = input.find(delim_, current_idx);
+          if (end == StringPiece::npos) end = input.size();
+          const StringPiece body =
+              input.substr(current_idx, end - current_idx);
+          if (body.find_first_of(unquoted_invalid) != StringPiece::npos) {
+            return errors::InvalidArgument(
+                "Unquoted fields cannot have quotes/CRLFs inside");
           }
+          if (include) field->assign(body.data(), body.size());
 
           // Go to next field or the end
-          current_idx++;
+          current_idx = end + 1;
         } else if (use_quote_delim_) {
           // Quoted field needs to be ended with '"' and delim or end
+          const size_t last_idx = input.size() - 1;
           while (
-              (static_cast<size_t>(current_idx) < input.size() - 1) &&
+              (static_cast<size_t>(current_idx) < last_idx) &&
               (input[current_idx] != '"' || input[current_idx + 1] != delim_)) {
-            if (input[current_idx] != '"') {
-              if (include) field += input[current_idx];
-              current_idx++;
+            // Copies everything up to the next quote or the last character.
+            const size_t quote_idx = std::min(input.find('"', current_idx),
+                                              last_idx);
+            if (quote_idx > static_cast<size_t>(current_idx)) {
+              if (include) {
+                field->append(input.data() + current_idx,
+                              quote_idx - current_idx);
+              }
+              current_idx = quote_idx;
             } else {
-              OP_REQUIRES(
-                  ctx, input[current_idx + 1] == '"',
-                  errors::InvalidArgument("Quote inside a string has to be "
-                                          "escaped by another quote"));
-              if (include) field += '"';
+              if (input[current_idx + 1] != '"') {
+                return errors::InvalidArgument(
+                    "Quote inside a string has to be escaped by another "
+                    "quote");
+              }
+              if (include) *field += '"';
               current_idx += 2;
             }
           }
 
-          OP_REQUIRES(
-              ctx,
-              (static_cast<size_t>(current_idx) < input.size() &&
-               input[current_idx] == '"' &&
-               (static_cast<size_t>(current_idx) == input.size() - 1 ||
-                input[current_idx + 1] == delim_)),
-              errors::InvalidArgument("Quoted field has to end with quote "
-                                      "followed by delim or end"));
+          if (!(static_cast<size_t>(current_idx) < input.size() &&
+                input[current_idx] == '"' &&
+                (static_cast<size_t>(current_idx) == last_idx ||
+                 input[current_idx + 1] == delim_))) {
+            return errors::InvalidArgument(
+                "Quoted field has to end with quote followed by delim or end");
+          }
 
           current_idx += 2;
         }
 
         num_fields_parsed++;
         if (include) {
-          result->push_back(field);
           selector_idx++;
-          if (selector_idx == select_cols_.size()) return;
+          if (selector_idx == select_cols_.size()) return OkStatus();
         }
       }
 
@@ -288,9 +335,9 @@ class DecodeCSVOp : public OpKernel {
           (select_all_cols_ || select_cols_[selector_idx] ==
                                    static_cast<size_t>(num_fields_parsed));
       // Check if the last field is missing
-      if (include && input[input.size() - 1] == delim_)
-        result->push_back(string());
+      if (include && input[input.size() - 1] == delim_) next_field();
     }
+    return OkStatus();
   }
 };
 
@@ -15,12 +15,16 @@ limitations under the License.
 
 // See docs in ../ops/data_flow_ops.cc.
 
+#include <algorithm>
+#include <cstring>
 #include <vector>
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/util/util.h"
 
@@ -39,9 +43,13 @@ class DynamicPartitionOp_Shared : public OpKernel {
     //   in the graph?
   }
 
+  // The rows of `data` are split into `num_blocks` contiguous blocks that are
+  // partitioned in parallel. On return, `block_offsets[b * num_partitions_ +
+  // p]` is the first row of output `p` written by block `b`.
   void ValidateAndAllocateOutputs(OpKernelContext* c, const Tensor** data,
                                   const Tensor** partitions,
-                                  OpOutputList* Tout) {
+                                  OpOutputList* Tout, int64_t* num_blocks,
+                                  std::vector<int64_t>* block_offsets) {
     OP_REQUIRES_OK(c, c->input("data", data));
     OP_REQUIRES_OK(c, c->input("partitions", partitions));
     OP_REQUIRES(
@@ -52,17 +60,45 @@ class DynamicPartitionOp_Shared : public OpKernel {
             "got data.shape = ", (*data)->shape().DebugString(),
             ", partitions.shape = ", (*partitions)->shape().DebugString()));
 
-    // Count how many occurrences of each partition id we have in partitions
-    gtl::InlinedVector<int, 32> partition_count(num_partitions_);
     auto e_partitions = (*partitions)->flat<int32>();
     const int64_t N = e_partitions.dimension(0);
-    for (int64_t i = 0; i < N; i++) {
-      const int32_t p = internal::SubtleMustCopy(e_partitions(i));
-      OP_REQUIRES(c, FastBoundsCheck(p, num_partitions_),
+    *num_blocks = NumBlocks(c, N, (*data)->NumElements());
+
+    // Count how many occurrences of each partition id every block has.
+    block_offsets->assign(*num_blocks * num_partitions_, 0);
+    std::vector<int64_t> bad_rows(*num_blocks, -1);
+    auto count_block = [&](int64_t b) {
+      int64_t* counts = block_offsets->data() + b * num_partitions_;
+      for (int64_t i = BlockStart(b, *num_blocks, N),
+                   end = BlockStart(b + 1, *num_blocks, N);
+           i < end; i++) {
+        const int32_t p = internal::SubtleMustCopy(e_partitions(i));
+        if (!FastBoundsCheck(p, num_partitions_)) {
+          bad_rows[b] = i;
+          return;
+        }
+        counts[p]++;
+      }
+    };
+    ForEachBlock(c, *num_blocks, count_block);
+    for (int64_t b = 0; b < *num_blocks; b++) {
+      const int64_t i = bad_rows[b];
+      OP_REQUIRES(c, i < 0,
                   errors::InvalidArgument(
                       "partitions", SliceDebugString((*partitions)->shape(), i),
-                      " = ", p, " is not in [0, ", num_partitions_, ")"));
-      partition_count[p]++;
+                      " = ", e_partitions(i), " is not in [0, ",
+                      num_partitions_, ")"));
+    }
+
+    // Turn the counts into the first output row of every block.
+    gtl::InlinedVector<int64_t, 32> partition_count(num_partitions_);
+    for (int64_t b = 0; b < *num_blocks; b++) {
+      int64_t* offsets = block_offsets->data() + b * num_partitions_;
+      for (int p = 0; p < num_partitions_; p++) {
+        const int64_t count = offsets[p];
+        offsets[p] = partition_count[p];
+        partition_count[p] += count;
+      }
     }
 
     // Allocate output tensors of the right size
@@ -79,7 +115,39 @@ class DynamicPartitionOp_Shared : public OpKernel {
   }
 
  protected:
+  // First row of block `b` out of `num_blocks` blocks of `N` rows.
+  static int64_t BlockStart(int64_t b, int64_t num_blocks, int64_t N) {
+    return b * N / num_blocks;
+  }
+
+  // Runs `fn(b)` for every block, in parallel when there is more than one.
+  template <typename Fn>
+  static void ForEachBlock(OpKernelContext* c, int64_t num_blocks,
+                           const Fn& fn) {
+    if (num_blocks == 1) {
+      fn(0);
+      return;
+    }
+    // Blocks are sized so that each one is worth a thread of its own.
+    c->device()->tensorflow_cpu_worker_threads()->workers->ParallelFor(
+        num_blocks, kMinElementsPerBlock, [&](int64_t first, int64_t last) {
+          for (int64_t b = first; b < last; b++) fn(b);
+        });
+  }
+
   int num_partitions_;
+
+ private:
+  // Inputs smaller than this are partitioned by a single thread.
+  static constexpr int64_t kMinElementsPerBlock = 1 << 16;
+
+  static int64_t NumBlocks(OpKernelContext* c, int64_t N,
+                           int64_t num_elements) {
+    const int64_t num_threads =
+        c->device()->tensorflow_cpu_worker_threads()->num_threads;
+    return std::max<int64_t>(
+        1, std::min({num_threads, N, num_elements / kMinElementsPerBlock}));
+  }
 };
 
 template <class T>
@@ -91,69 +159,61 @@ class DynamicPartitionOp : public DynamicPartitionOp_Shared {
     const Tensor* data;
     const Tensor* partitions;
     OpOutputList outputs;
-    ValidateAndAllocateOutputs(c, &data, &partitions, &outputs);
+    int64_t num_blocks;
+    std::vector<int64_t> block_offsets;
+    ValidateAndAllocateOutputs(c, &data, &partitions, &outputs, &num_blocks,
+                               &block_offsets);
     if (!c->status().ok()) return;
     if (num_partitions_ == 0 || data->NumElements() == 0) return;
 
     auto e_partitions = partitions->flat<int32>();
     const int64_t N = e_partitions.dimension(0);
-    gtl::InlinedVector<int, 32> output_index(num_partitions_);
-
-    if (partitions->dims() == data->dims()) {
-      // Walk through data and copy the data to the appropriate output tensor
-      const auto data_flat = data->flat<T>();
-      std::vector<Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
-                                   Eigen::Aligned> >
-          out_vec;
-      out_vec.reserve(num_partitions_);
-      for (int p = 0; p < num_partitions_; p++) {
-        out_vec.push_back(outputs[p]->vec<T>());
-      }
-      for (int64_t i = 0; i < N; i++) {
-        const int32_t p = internal::SubtleMustCopy(e_partitions(i));
-        OP_REQUIRES(
-            c, FastBoundsCheck(p, num_partitions_),
-            errors::InvalidArgument("indices[", i, "] is out of range"));
-        auto oi = output_index[p];
-        OP_REQUIRES(c, FastBoundsCheck(oi, out_vec[p].size()),
-                    errors::InvalidArgument(
-                        "out_vec[", p, "] size: ", out_vec[p].size(),
-                        " is not LTE output_index[", p, "] : ", oi));
-        out_vec[p](oi) = data_flat(i);
-        output_index[p]++;
-      }
-    } else {
-      // If data has extra dimensions, use Eigen slices
-      std::vector<Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
-                                   Eigen::Aligned> >
-          out_flat;
-      out_flat.reserve(num_partitions_);
-      for (int p = 0; p < num_partitions_; p++) {
-        out_flat.push_back(outputs[p]->flat_outer_dims<T>());
-      }
+    const int64_t slice_size = data->NumElements() / N;
+    const T* data_base = data->flat<T>().data();
+    gtl::InlinedVector<T*, 32> out_base(num_partitions_);
+    gtl::InlinedVector<int64_t, 32> out_rows(num_partitions_);
+    for (int p = 0; p < num_partitions_; p++) {
+      out_base[p] = outputs[p]->flat<T>().data();
+      out_rows[p] = outputs[p]->dim_size(0);
+    }
 
-      // Walk through data and copy the data to the appropriate output tensor
-      const int64_t slice_size = data->NumElements() / N;
-      const auto data_flat = data->shaped<T, 2>({N, slice_size});
-      Eigen::DSizes<Eigen::DenseIndex, 2> sizes(1, slice_size);
-      for (int64_t i = 0; i < N; i++) {
+    // Walk through the rows of every block and copy them to the appropriate
+    // output tensor, starting at the rows reserved for the block.
+    std::vector<int64_t> bad_rows(num_blocks, -1);
+    auto partition_block = [&](int64_t b) {
+      const int64_t* first = block_offsets.data() + b * num_partitions_;
+      const int64_t* last = first + num_partitions_;
+      gtl::InlinedVector<int64_t, 32> output_index(first, last);
+      for (int64_t i = BlockStart(b, num_blocks, N),
+                   end = BlockStart(b + 1, num_blocks, N);
+           i < end; i++) {
         // outputs[p][output_index[p]++] = data[i]
         const int32_t p = internal::SubtleMustCopy(e_partitions(i));
-        OP_REQUIRES(
-            c, FastBoundsCheck(p, num_partitions_),
-            errors::InvalidArgument("indices[", i,
-                                    "] has been asynchronously overwritten and "
-                                    "is no longer in range!"));
-        auto oi = output_index[p];
-        OP_REQUIRES(c, FastBoundsCheck(oi, out_flat[p].dimension(0)),
-                    errors::InvalidArgument("Size of output_index: ", oi,
-                                            " is no longer in range."));
-        Eigen::DSizes<Eigen::DenseIndex, 2> out_indices(oi, 0);
-        Eigen::DSizes<Eigen::DenseIndex, 2> data_indices(i, 0);
-        out_flat[p].slice(out_indices, sizes) =
-            data_flat.slice(data_indices, sizes);
-        output_index[p]++;
+        // `partitions` may have been asynchronously overwritten since the
+        // rows were counted: never write past the rows of this block.
+        if (!FastBoundsCheck(p, num_partitions_) ||
+            output_index[p] >=
+                (b + 1 < num_blocks ? last[p] : out_rows[p])) {
+          bad_rows[b] = i;
+          return;
+        }
+        const int64_t oi = output_index[p]++;
+        T* out = out_base[p] + oi * slice_size;
+        const T* in = data_base + i * slice_size;
+        if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v())) {
+          memcpy(out, in, slice_size * sizeof(T));
+        } else {
+          std::copy(in, in + slice_size, out);
+        }
       }
+    };
+    ForEachBlock(c, num_blocks, partition_block);
+    for (int64_t b = 0; b < num_blocks; b++) {
+      OP_REQUIRES(c, bad_rows[b] < 0,
+                  errors::InvalidArgument(
+                      "partitions[", bad_rows[b],
+                      "] has been asynchronously overwritten and "
+                      "is no longer in range!"));
     }
   }
 };
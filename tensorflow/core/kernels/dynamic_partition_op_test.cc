@@ -146,6 +146,31 @@ TEST_F(DynamicPartitionOpTest, SomeOutputsEmpty) {
   }
 }
 
+TEST_F(DynamicPartitionOpTest, Large_TwoD) {
+  MakeOp();
+
+  // Large enough to be partitioned by several threads.
+  const int N = 100000;
+  const int D = 3;
+  auto partition = [](int i) { return (i * 7 + i / 1000) % 4; };
+  AddInput<float>(TensorShape({N, D}), [](int i) -> float { return i; });
+  AddInput<int32>(TensorShape({N}), partition);
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<std::vector<float>> expected_values(4);
+  for (int i = 0; i < N; ++i) {
+    for (int j = 0; j < D; ++j) {
+      expected_values[partition(i)].push_back(i * D + j);
+    }
+  }
+  for (int p = 0; p < 4; ++p) {
+    const int rows = expected_values[p].size() / D;
+    Tensor expected(allocator(), DT_FLOAT, TensorShape({rows, D}));
+    test::FillValues<float>(&expected, expected_values[p]);
+    test::ExpectTensorEqual<float>(expected, *GetOutput(p));
+  }
+}
+
 TEST_F(DynamicPartitionOpTest, Error_IndexOutOfRange) {
   MakeOp();
 
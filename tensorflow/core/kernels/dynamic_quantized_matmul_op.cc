@@ -0,0 +1,214 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Number of columns of the product computed by one unit of work.
+constexpr int64_t kColsPerUnit = 64;
+
+// Largest inner dimension whose int8 dot products cannot overflow int32.
+constexpr int64_t kMaxInnerDim =
+    std::numeric_limits<int32>::max() / (127 * 127);
+
+// Quantizes `a_row` symmetrically to int8 and returns the scale, or 0 if the
+// row is not finite and has to be multiplied in float.
+template <typename T>
+T QuantizeRow(const T* a_row, int64_t k, int8* quantized_row) {
+  T max_abs = 0;
+  for (int64_t i = 0; i < k; ++i) {
+    max_abs = std::max<T>(max_abs, std::abs(a_row[i]));
+  }
+  if (!std::isfinite(max_abs)) return 0;
+  if (max_abs == 0) {
+    std::fill(quantized_row, quantized_row + k, 0);
+    return 1;
+  }
+  const T scale = max_abs / 127;
+  const T inverse_scale = 127 / max_abs;
+  for (int64_t i = 0; i < k; ++i) {
+    quantized_row[i] = static_cast<int8>(std::max<T>(
+        -127, std::min<T>(127, std::round(a_row[i] * inverse_scale))));
+  }
+  return scale;
+}
+
+// Returns the int32 dot products of `a_row` with the `kCols` rows of `b`
+// starting at `b_rows`. Computing several columns at once reuses the loads of
+// `a_row`, and the widening multiply-adds are vectorized by the compiler.
+template <int kCols>
+void DotInt8(const int8* a_row, const int8* b_rows, int64_t k, int32* dots) {
+  int32 acc[kCols] = {};
+  for (int64_t i = 0; i < k; ++i) {
+    const int32 a = a_row[i];
+    for (int j = 0; j < kCols; ++j) {
+      acc[j] += a * static_cast<int32>(b_rows[j * k + i]);
+    }
+  }
+  for (int j = 0; j < kCols; ++j) {
+    dots[j] = acc[j];
+  }
+}
+
+}  // namespace
+
+// Multiplies a float matrix by int8 weights that are quantized per output
+// channel, quantizing the rows of the float matrix on the fly.
+template <typename T>
+class DynamicQuantizedMatMulOp : public OpKernel {
+ public:
+  explicit DynamicQuantizedMatMulOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& a = context->input(0);
+    const Tensor& b = context->input(1);
+    const Tensor& b_scales = context->input(2);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(a.shape()),
+                errors::InvalidArgument("a must be a matrix, got shape ",
+                                        a.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(b.shape()),
+                errors::InvalidArgument("b must be a matrix, got shape ",
+                                        b.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(b_scales.shape()),
+                errors::InvalidArgument("b_scales must be a vector, got shape ",
+                                        b_scales.shape().DebugString()));
+    OP_REQUIRES(context, a.dim_size(1) == b.dim_size(1),
+                errors::InvalidArgument(
+                    "Matrix size-incompatible: In[0]: ",
+                    a.shape().DebugString(),
+                    ", In[1] (transposed): ", b.shape().DebugString()));
+    OP_REQUIRES(context, b_scales.dim_size(0) == b.dim_size(0),
+                errors::InvalidArgument(
+                    "b_scales must have one element per row of b, got ",
+                    b_scales.dim_size(0), " for ", b.dim_size(0), " rows"));
+
+    const int64_t m = a.dim_size(0);
+    const int64_t k = a.dim_size(1);
+    const int64_t n = b.dim_size(0);
+    OP_REQUIRES(context, k <= kMaxInnerDim,
+                errors::InvalidArgument("The inner dimension must be at most ",
+                                        kMaxInnerDim, ", got ", k));
+
+    Tensor* product = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                0, TensorShape({m, n}), &product));
+    if (product->NumElements() == 0) return;
+
+    Tensor quantized_a;
+    OP_REQUIRES_OK(context, context->allocate_temp(
+                                DT_INT8, TensorShape({m, k}), &quantized_a));
+    Tensor a_scales;
+    OP_REQUIRES_OK(context, context->allocate_temp(DataTypeToEnum<T>::value,
+                                                   TensorShape({m}),
+                                                   &a_scales));
+
+    const T* a_data = a.flat<T>().data();
+    const int8* b_data = b.flat<int8>().data();
+    const T* b_scales_data = b_scales.flat<T>().data();
+    int8* quantized_a_data = quantized_a.flat<int8>().data();
+    T* a_scales_data = a_scales.flat<T>().data();
+    T* product_data = product->flat<T>().data();
+
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+
+    // Quantizes every row of `a` once, before the rows are shared by the
+    // units of work of the product.
+    auto quantize = [&](int64_t start, int64_t limit) {
+      for (int64_t row = start; row < limit; ++row) {
+        a_scales_data[row] =
+            QuantizeRow(a_data + row * k, k, quantized_a_data + row * k);
+      }
+    };
+    Shard(worker_threads->num_threads, worker_threads->workers, m, 3 * k,
+          quantize);
+
+    // Every unit computes up to kColsPerUnit columns of one row of the
+    // product.
+    const int64_t num_col_units = (n + kColsPerUnit - 1) / kColsPerUnit;
+    auto multiply = [&](int64_t start, int64_t limit) {
+      int32 dots[4];
+      for (int64_t unit = start; unit < limit; ++unit) {
+        const int64_t row = unit / num_col_units;
+        const int64_t col_begin = (unit % num_col_units) * kColsPerUnit;
+        const int64_t col_end = std::min(n, col_begin + kColsPerUnit);
+        const T a_scale = a_scales_data[row];
+        T* product_row = product_data + row * n;
+
+        if (a_scale == 0) {
+          // The row is not finite: multiplies it in float so that infinities
+          // and NaNs propagate as in MatMul.
+          const T* a_row = a_data + row * k;
+          for (int64_t col = col_begin; col < col_end; ++col) {
+            const int8* b_row = b_data + col * k;
+            T sum = 0;
+            for (int64_t i = 0; i < k; ++i) {
+              sum += a_row[i] * static_cast<T>(b_row[i]);
+            }
+            product_row[col] = sum * b_scales_data[col];
+          }
+          continue;
+        }
+
+        const int8* a_row = quantized_a_data + row * k;
+        int64_t col = col_begin;
+        for (; col + 4 <= col_end; col += 4) {
+          DotInt8<4>(a_row, b_data + col * k, k, dots);
+          for (int j = 0; j < 4; ++j) {
+            product_row[col + j] =
+                static_cast<T>(dots[j]) * a_scale * b_scales_data[col + j];
+          }
+        }
+        for (; col < col_end; ++col) {
+          DotInt8<1>(a_row, b_data + col * k, k, dots);
+          product_row[col] =
+              static_cast<T>(dots[0]) * a_scale * b_scales_data[col];
+        }
+      }
+    };
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          m * num_col_units, 2 * k * kColsPerUnit, multiply);
+  }
+};
+
+#define REGISTER_CPU(T)                                          \
+  REGISTER_KERNEL_BUILDER(Name("_DynamicQuantizedMatMul")        \
+                              .Device(DEVICE_CPU)                \
+                              .TypeConstraint<T>("T"),           \
+                          DynamicQuantizedMatMulOp<T>);
+
+REGISTER_CPU(float);
+
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
@@ -15,6 +15,11 @@ limitations under the License.
 
 // See docs in ../ops/data_flow_ops.cc.
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -291,15 +296,19 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
           }
         }
       };
-      if (Parallel &&
-          c->device()->tensorflow_cpu_worker_threads()->num_threads > 1) {
+      const int num_threads =
+          c->device()->tensorflow_cpu_worker_threads()->num_threads;
+      int64_t total_indices_size = 0;
+      for (const Tensor& indices : indices_inputs) {
+        total_indices_size += indices.NumElements();
+      }
+      if (num_threads > 1 &&
+          total_indices_size * slice_bytes >= kMinParallelStitchBytes) {
+        ParallelStitch(c, indices_inputs, data_inputs, total_indices_size,
+                       merged_flat);
+      } else if (Parallel && num_threads > 1) {
         auto thread_pool =
             c->device()->tensorflow_cpu_worker_threads()->workers;
-        size_t total_indices_size = 0;
-        for (int input_num = 0; input_num < indices_inputs.size();
-             ++input_num) {
-          total_indices_size += indices_inputs[input_num].NumElements();
-        }
         const double avg_indices_size =
             static_cast<double>(total_indices_size) / indices_inputs.size();
         auto bytes_processed = slice_bytes * avg_indices_size;
@@ -318,6 +327,81 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
       }
     }
   }
+
+ private:
+  // Stitches smaller than this are done input by input.
+  static constexpr int64_t kMinParallelStitchBytes = 1 << 20;
+
+  // Stitches in two parallel passes over all the (input, position) pairs,
+  // numbered by a prefix sum over the sizes of the inputs. The first pass
+  // picks the last pair written to every row of `merged`, as the serial
+  // stitch would. The second pass copies every row of `merged` from its
+  // pair, so that no two threads ever write the same row.
+  void ParallelStitch(OpKernelContext* c, const OpInputList& indices_inputs,
+                      const OpInputList& data_inputs,
+                      int64_t total_indices_size,
+                      typename TTypes<T, 2>::Tensor merged_flat) {
+    auto* thread_pool = c->device()->tensorflow_cpu_worker_threads()->workers;
+    const int64_t first_dim_size = merged_flat.dimension(0);
+    const int64_t slice_size = merged_flat.dimension(1);
+
+    std::vector<int64_t> input_offsets(indices_inputs.size() + 1, 0);
+    for (int input_num = 0; input_num < indices_inputs.size(); ++input_num) {
+      input_offsets[input_num + 1] =
+          input_offsets[input_num] + indices_inputs[input_num].NumElements();
+    }
+    // Returns the input holding pair `k`.
+    auto input_of = [&](int64_t k) -> int {
+      return std::upper_bound(input_offsets.begin(), input_offsets.end(), k) -
+             input_offsets.begin() - 1;
+    };
+
+    std::unique_ptr<std::atomic<int64_t>[]> source(
+        new std::atomic<int64_t>[first_dim_size]);
+    thread_pool->ParallelFor(first_dim_size, 1, [&](int64_t first,
+                                                    int64_t last) {
+      for (int64_t j = first; j < last; ++j) {
+        source[j].store(-1, std::memory_order_relaxed);
+      }
+    });
+
+    thread_pool->ParallelFor(
+        total_indices_size, 5, [&](int64_t first, int64_t last) {
+          int input_num = input_of(first);
+          for (int64_t k = first; k < last; ++k) {
+            while (k >= input_offsets[input_num + 1]) ++input_num;
+            auto indices_vec = indices_inputs[input_num].flat<int32>();
+            const int32_t index = internal::SubtleMustCopy(
+                indices_vec(k - input_offsets[input_num]));
+            // `indices` may have been asynchronously overwritten since it
+            // was checked.
+            if (!FastBoundsCheck(index, first_dim_size)) continue;
+            std::atomic<int64_t>& row_source = source[index];
+            int64_t current = row_source.load(std::memory_order_relaxed);
+            while (current < k && !row_source.compare_exchange_weak(
+                                      current, k, std::memory_order_relaxed)) {
+            }
+          }
+        });
+
+    const int64_t slice_bytes = slice_size * sizeof(T);
+    thread_pool->ParallelFor(
+        first_dim_size, slice_bytes, [&](int64_t first, int64_t last) {
+          for (int64_t j = first; j < last; ++j) {
+            const int64_t k = source[j].load(std::memory_order_relaxed);
+            if (k < 0) continue;
+            const int input_num = input_of(k);
+            const T* in = data_inputs[input_num].flat<T>().data() +
+                          (k - input_offsets[input_num]) * slice_size;
+            T* out = merged_flat.data() + j * slice_size;
+            if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v())) {
+              memcpy(out, in, slice_bytes);
+            } else {
+              std::copy(in, in + slice_size, out);
+            }
+          }
+        });
+  }
 };
 
 // Using inheritance rather than a typedef so that these classes might have more
@@ -80,6 +80,38 @@ TEST_F(DynamicStitchOpTest, Simple_TwoD) {
   test::ExpectTensorEqual<float>(expected, *GetOutput(0));
 }
 
+TEST_F(DynamicStitchOpTest, Large_DuplicateIndices) {
+  MakeOp(2, DT_FLOAT);
+
+  // Large enough to be stitched by several threads. Rows written by both
+  // inputs must come from the last one, as in the serial stitch.
+  const int N = 100000;
+  const int D = 4;
+  auto index0 = [](int i) { return (i * 13) % N; };
+  auto index1 = [](int i) { return (i * 3) % N; };
+  AddInput<int32>(TensorShape({N}), index0);
+  AddInput<int32>(TensorShape({N / 2}), index1);
+  AddInput<float>(TensorShape({N, D}), [](int i) -> float { return i; });
+  AddInput<float>(TensorShape({N / 2, D}),
+                  [](int i) -> float { return -1 - i; });
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<float> expected_values(N * D);
+  for (int i = 0; i < N; ++i) {
+    for (int j = 0; j < D; ++j) {
+      expected_values[index0(i) * D + j] = i * D + j;
+    }
+  }
+  for (int i = 0; i < N / 2; ++i) {
+    for (int j = 0; j < D; ++j) {
+      expected_values[index1(i) * D + j] = -1 - (i * D + j);
+    }
+  }
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({N, D}));
+  test::FillValues<float>(&expected, expected_values);
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
 TEST_F(DynamicStitchOpTest, Error_IndicesMultiDimensional) {
   MakeOp(2, DT_FLOAT);
 
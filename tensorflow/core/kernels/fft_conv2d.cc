@@ -0,0 +1,268 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/fft_conv2d.h"
+
+#include <algorithm>
+#include <complex>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/kernels/fft_impl.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// FFTConv2D computes a stride 1 cross-correlation in the frequency domain:
+//
+//   Y[n, k, o] = sum_i X[n, k, i] * conj(G[k, i, o])
+//
+//   X: 2D DFT of the zero-padded input image 'n', channel 'i'
+//   G: 2D DFT of the zero-padded filter for channels 'i' -> 'o'
+//   Y: 2D DFT of the output image 'n', channel 'o'
+//   k: frequency
+//
+// The DFT size is at least the linear correlation size in each dimension
+// (out + filter - 1), so the circular correlation computed by the DFT does not
+// wrap around into the output window. The cost of the transforms grows with
+// the log of the filter size rather than linearly, which pays off for large
+// filters, e.g. the long 1D filters of audio models.
+
+// Returns the DFT length used for a linear correlation of length 'n'.
+// Eigen uses its radix-2 FFT for powers of two, and the much slower Bluestein
+// algorithm for any other length.
+static int64_t GetFFTLength(int64_t n) {
+  int64_t length = 1;
+  while (length < n) length <<= 1;
+  return length;
+}
+
+// Approximate cost models (in flops) for direct and FFT convolutions.
+static int64_t GetFFTConvCost(int64_t fft_rows, int64_t fft_cols, int batch,
+                              int in_depth, int out_depth) {
+  const int64_t fft_size = fft_rows * fft_cols;
+  int64_t log2_fft_size = 0;
+  while ((int64_t{1} << log2_fft_size) < fft_size) ++log2_fft_size;
+  // A complex 2D DFT of size N costs about 5 N log2(N) flops.
+  const int64_t transform_cost =
+      5 * fft_size * std::max<int64_t>(log2_fft_size, 1);
+  const int64_t num_transforms = static_cast<int64_t>(batch) * in_depth +
+                                 static_cast<int64_t>(in_depth) * out_depth +
+                                 static_cast<int64_t>(batch) * out_depth;
+  // Element-wise products (each product is a complex MatMul across depth),
+  // over the non-redundant half of the spectrum.
+  const int64_t product_cost = 8 * fft_rows * (fft_cols / 2 + 1) * batch *
+                               in_depth * static_cast<int64_t>(out_depth);
+  return num_transforms * transform_cost + product_cost;
+}
+
+static int64_t GetDirectConvCost(int filter_rows, int filter_cols, int batch,
+                                 int in_depth, int out_depth, int out_rows,
+                                 int out_cols) {
+  return 2 * static_cast<int64_t>(filter_rows) * filter_cols * in_depth *
+         out_depth * batch * out_rows * out_cols;
+}
+
+// The direct convolution runs as a highly tuned GEMM, while the DFTs reach a
+// fraction of its throughput, so FFTConv2D must save more than this factor in
+// flops to be faster.
+static constexpr int64_t kDirectToFFTConvEfficiency = 4;
+
+bool CanUseFFTConv2D(int stride_rows, int stride_cols, int dilation_rows,
+                     int dilation_cols, int filter_rows, int filter_cols,
+                     int batch, int in_depth, int out_depth, int out_rows,
+                     int out_cols) {
+  // Check if convolution parameters are supported.
+  if (stride_rows > 1 || stride_cols > 1 || dilation_rows > 1 ||
+      dilation_cols > 1) {
+    return false;
+  }
+
+  // Check if FFT convolution is enabled by environment variable.
+  // NOTE: If this environment variable name changes, update conv_ops_test.py.
+  bool use_fft_conv2d = false;
+  TF_CHECK_OK(
+      ReadBoolFromEnvVar("TF_USE_FFT_CONV2D", false, &use_fft_conv2d));
+  if (!use_fft_conv2d) {
+    return false;
+  }
+
+  const int64_t fft_rows = GetFFTLength(out_rows + filter_rows - 1);
+  const int64_t fft_cols = GetFFTLength(out_cols + filter_cols - 1);
+  const int64_t fft_conv_cost =
+      GetFFTConvCost(fft_rows, fft_cols, batch, in_depth, out_depth);
+  const int64_t direct_conv_cost = GetDirectConvCost(
+      filter_rows, filter_cols, batch, in_depth, out_depth, out_rows, out_cols);
+
+  VLOG(2) << "CanUseFFTConv2D"
+          << " fft_conv_cost: " << fft_conv_cost
+          << " direct_conv_cost: " << direct_conv_cost << " fft_direct_ratio: "
+          << (static_cast<float>(fft_conv_cost) /
+              static_cast<float>(direct_conv_cost));
+  return kDirectToFFTConvEfficiency * fft_conv_cost < direct_conv_cost;
+}
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace functor {
+
+// Conv2D operation specialized for large filters.
+// Details:
+// *) Transforms the zero-padded input and filter with sharded 2D DFTs.
+// *) Multiplies the spectra in parallel across frequencies, as one
+//    [batch, in_depth] x [in_depth, out_depth] MatMul per frequency, over the
+//    non-redundant half of the spectrum (the input and filter are real).
+// *) Restores the redundant half from Hermitian symmetry, takes the inverse
+//    DFT and crops the output window.
+template <typename T>
+struct FFTConv2D<CPUDevice, T> {
+  void operator()(OpKernelContext* ctx, const Conv2DArgs& args, const T* input,
+                  const T* filter, T* output) {
+    typedef std::complex<T> ComplexT;
+    typedef Eigen::Matrix<ComplexT, Eigen::Dynamic, Eigen::Dynamic,
+                          Eigen::RowMajor>
+        Matrix;
+    typedef Eigen::DSizes<Eigen::DenseIndex, 4> Index4;
+
+    const int64_t batch = args.batch;
+    const int64_t in_depth = args.in_depth;
+    const int64_t out_depth = args.out_depth;
+    const int64_t fft_rows = GetFFTLength(args.out_rows + args.filter_rows - 1);
+    const int64_t fft_cols = GetFFTLength(args.out_cols + args.filter_cols - 1);
+    const int64_t half_cols = fft_cols / 2 + 1;
+    const CPUDevice& device = ctx->eigen_device<CPUDevice>();
+
+    typename TTypes<T, 4>::ConstTensor in(input, batch, args.in_rows,
+                                          args.in_cols, in_depth);
+    typename TTypes<T, 4>::ConstTensor in_filter(
+        filter, args.filter_rows, args.filter_cols, in_depth, out_depth);
+    typename TTypes<T, 4>::Tensor out(output, batch, args.out_rows,
+                                      args.out_cols, out_depth);
+
+    // Transform the input, placed at the padding offset of a zero image.
+    // Input rows and columns past the DFT size are only needed by outputs
+    // outside the output window.
+    Tensor input_fft_tensor;
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(
+                            DataTypeToEnum<ComplexT>::v(),
+                            TensorShape({batch, fft_rows, fft_cols, in_depth}),
+                            &input_fft_tensor));
+    auto input_fft = input_fft_tensor.tensor<ComplexT, 4>();
+    input_fft.device(device) = input_fft.constant(ComplexT());
+    const Index4 in_sizes(
+        batch, std::min<int64_t>(args.in_rows, fft_rows - args.pad_rows),
+        std::min<int64_t>(args.in_cols, fft_cols - args.pad_cols), in_depth);
+    input_fft.slice(Index4(0, args.pad_rows, args.pad_cols, 0), in_sizes)
+        .device(device) =
+        in.slice(Index4(0, 0, 0, 0), in_sizes).template cast<ComplexT>();
+    InPlaceFFT<Eigen::FFT_FORWARD, ComplexT, 4>(ctx, input_fft,
+                                                /*first_axis=*/1,
+                                                /*num_axes=*/2);
+
+    // Transform the filter.
+    Tensor filter_fft_tensor;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_temp(
+                 DataTypeToEnum<ComplexT>::v(),
+                 TensorShape({fft_rows, fft_cols, in_depth, out_depth}),
+                 &filter_fft_tensor));
+    auto filter_fft = filter_fft_tensor.tensor<ComplexT, 4>();
+    filter_fft.device(device) = filter_fft.constant(ComplexT());
+    filter_fft.slice(Index4(0, 0, 0, 0), in_filter.dimensions())
+        .device(device) = in_filter.template cast<ComplexT>();
+    InPlaceFFT<Eigen::FFT_FORWARD, ComplexT, 4>(ctx, filter_fft,
+                                                /*first_axis=*/0,
+                                                /*num_axes=*/2);
+
+    // Multiply the spectra, one MatMul across depth per frequency.
+    Tensor output_fft_tensor;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_temp(
+                 DataTypeToEnum<ComplexT>::v(),
+                 TensorShape({batch, fft_rows, half_cols, out_depth}),
+                 &output_fft_tensor));
+    auto output_fft = output_fft_tensor.tensor<ComplexT, 4>();
+    const ComplexT* input_fft_data = input_fft.data();
+    const ComplexT* filter_fft_data = filter_fft.data();
+    ComplexT* output_fft_data = output_fft.data();
+    auto multiply = [&](int64_t begin, int64_t end) {
+      for (int64_t k = begin; k < end; ++k) {
+        const int64_t row = k / half_cols;
+        const int64_t col = k % half_cols;
+        Eigen::Map<const Matrix, 0, Eigen::OuterStride<>> x(
+            input_fft_data + (row * fft_cols + col) * in_depth, batch,
+            in_depth, Eigen::OuterStride<>(fft_rows * fft_cols * in_depth));
+        Eigen::Map<const Matrix> g(
+            filter_fft_data + (row * fft_cols + col) * in_depth * out_depth,
+            in_depth, out_depth);
+        Eigen::Map<Matrix, 0, Eigen::OuterStride<>> y(
+            output_fft_data + (row * half_cols + col) * out_depth, batch,
+            out_depth, Eigen::OuterStride<>(fft_rows * half_cols * out_depth));
+        y.noalias() = x * g.conjugate();
+      }
+    };
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          fft_rows * half_cols, 8 * batch * in_depth * out_depth, multiply);
+
+    // Take the inverse DFT along rows on the half spectrum, then restore the
+    // negative column frequencies of each (real) output row before the
+    // inverse DFT along columns. The input spectrum buffer is reused when it
+    // has the right size.
+    InPlaceFFT<Eigen::FFT_REVERSE, ComplexT, 4>(ctx, output_fft,
+                                                /*first_axis=*/1,
+                                                /*num_axes=*/1);
+    Tensor full_fft_tensor;
+    if (in_depth == out_depth) {
+      full_fft_tensor = input_fft_tensor;
+    } else {
+      OP_REQUIRES_OK(
+          ctx, ctx->allocate_temp(
+                   DataTypeToEnum<ComplexT>::v(),
+                   TensorShape({batch, fft_rows, fft_cols, out_depth}),
+                   &full_fft_tensor));
+    }
+    auto full_fft = full_fft_tensor.tensor<ComplexT, 4>();
+    full_fft.slice(Index4(0, 0, 0, 0), output_fft.dimensions())
+        .device(device) = output_fft;
+    const Index4 neg_sizes(batch, fft_rows, fft_cols - half_cols, out_depth);
+    if (neg_sizes[2] != 0) {
+      const Eigen::array<bool, 4> reverse_cols{false, false, true, false};
+      full_fft.slice(Index4(0, 0, half_cols, 0), neg_sizes).device(device) =
+          output_fft.slice(Index4(0, 0, 1, 0), neg_sizes)
+              .reverse(reverse_cols)
+              .conjugate();
+    }
+    InPlaceFFT<Eigen::FFT_REVERSE, ComplexT, 4>(ctx, full_fft,
+                                                /*first_axis=*/2,
+                                                /*num_axes=*/1);
+
+    out.device(device) =
+        full_fft.slice(Index4(0, 0, 0, 0), out.dimensions()).real();
+  }
+};
+
+}  // namespace functor
+
+template struct functor::FFTConv2D<CPUDevice, float>;
+
+}  // namespace tensorflow
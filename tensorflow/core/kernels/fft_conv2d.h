@@ -0,0 +1,51 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_FFT_CONV2D_H_
+#define TENSORFLOW_CORE_KERNELS_FFT_CONV2D_H_
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/deep_conv2d.h"
+
+namespace tensorflow {
+
+class OpKernelContext;
+
+// FFTConv2D is a Conv2D implementation for convolutions with large filters
+// (see fft_conv2d.cc for details). Conv1D, which runs as a Conv2D with a
+// single filter row, benefits the most because its filters can be long.
+
+// Returns true if convolution operation specified by function arguments
+// can use FFTConv2D implementation, and false otherwise.
+// May return false based on parameters, cost, or whether feature is disabled.
+bool CanUseFFTConv2D(int stride_rows, int stride_cols, int dilation_rows,
+                     int dilation_cols, int filter_rows, int filter_cols,
+                     int batch, int in_depth, int out_depth, int out_rows,
+                     int out_cols);
+
+namespace functor {
+
+// Calls FFTConv2D implementation (see fft_conv2d.cc for details).
+template <typename Device, typename T>
+struct FFTConv2D {
+  void operator()(OpKernelContext* ctx, const Conv2DArgs& args, const T* input,
+                  const T* filter, T* output);
+};
+
+}  // namespace functor
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_FFT_CONV2D_H_
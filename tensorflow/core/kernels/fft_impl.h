@@ -0,0 +1,93 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_FFT_IMPL_H_
+#define TENSORFLOW_CORE_KERNELS_FFT_IMPL_H_
+
+#include <cmath>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace functor {
+
+// Computes, in place, the 1D FFT along the middle dimension of 'data', which
+// is viewed as [outer, fft_length, inner].
+//
+// Eigen's tensor FFT runs on the calling thread, whatever device it is
+// assigned on. The outer * inner transforms are independent, so this shards
+// them over the intra-op thread pool, along 'outer' or 'inner' whichever
+// offers more parallelism.
+template <Eigen::FFTDirection Direction, typename ComplexT>
+void InPlaceFFTAlongMiddleAxis(OpKernelContext* ctx,
+                               typename TTypes<ComplexT, 3>::Tensor data) {
+  const int64_t outer = data.dimension(0);
+  const int64_t fft_length = data.dimension(1);
+  const int64_t inner = data.dimension(2);
+  if (fft_length <= 1) return;
+
+  // Roughly 5 N log2(N) flops per transform of length N.
+  const int64_t cost_per_transform =
+      5 * fft_length *
+      static_cast<int64_t>(std::ceil(std::log2(static_cast<double>(
+          fft_length))));
+  const Eigen::array<int, 1> axis{1};
+  const bool shard_outer = outer >= inner;
+  const int64_t num_units = shard_outer ? outer : inner;
+  const int64_t cost_per_unit =
+      cost_per_transform * (shard_outer ? inner : outer);
+
+  auto work = [&data, &axis, outer, fft_length, inner, shard_outer](
+                  int64_t begin, int64_t end) {
+    Eigen::DSizes<Eigen::DenseIndex, 3> start(0, 0, 0);
+    Eigen::DSizes<Eigen::DenseIndex, 3> sizes(outer, fft_length, inner);
+    start[shard_outer ? 0 : 2] = begin;
+    sizes[shard_outer ? 0 : 2] = end - begin;
+    // The FFT evaluates into its own buffer before the assignment, so the
+    // source and destination may alias.
+    data.slice(start, sizes) = data.slice(start, sizes)
+                                   .template fft<Eigen::BothParts, Direction>(
+                                       axis);
+  };
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *(ctx->device()->tensorflow_cpu_worker_threads());
+  Shard(worker_threads.num_threads, worker_threads.workers, num_units,
+        cost_per_unit, work);
+}
+
+// Computes, in place, the FFT of 'data' over the 'num_axes' dimensions
+// starting at 'first_axis', one axis at a time.
+template <Eigen::FFTDirection Direction, typename ComplexT, int NDIMS>
+void InPlaceFFT(OpKernelContext* ctx,
+                typename TTypes<ComplexT, NDIMS>::Tensor data, int first_axis,
+                int num_axes) {
+  for (int axis = first_axis; axis < first_axis + num_axes; ++axis) {
+    int64_t outer = 1;
+    int64_t inner = 1;
+    for (int i = 0; i < axis; ++i) outer *= data.dimension(i);
+    for (int i = axis + 1; i < NDIMS; ++i) inner *= data.dimension(i);
+    typename TTypes<ComplexT, 3>::Tensor view(data.data(), outer,
+                                              data.dimension(axis), inner);
+    InPlaceFFTAlongMiddleAxis<Direction, ComplexT>(ctx, view);
+  }
+}
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_FFT_IMPL_H_
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/fft_impl.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
@@ -149,6 +150,10 @@ class FFTBase : public OpKernel {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
+// FFTs with fewer elements than this are computed by a single Eigen tensor
+// FFT call, which runs on one thread.
+constexpr int64_t kMinShardedFFTElements = 1 << 15;
+
 template <bool Forward, bool _Real, int FFTRank>
 class FFTCPU : public FFTBase {
  public:
@@ -161,31 +166,18 @@ class FFTCPU : public FFTBase {
 
   void DoFFT(OpKernelContext* ctx, const Tensor& in, uint64* fft_shape,
              Tensor* out) override {
-    // Create the axes (which are always trailing).
-    const auto axes = Eigen::ArrayXi::LinSpaced(FFTRank, 1, FFTRank);
-    auto device = ctx->eigen_device<CPUDevice>();
-
     const bool is_complex128 =
         in.dtype() == DT_COMPLEX128 || out->dtype() == DT_COMPLEX128;
 
     if (!IsReal()) {
-      // Compute the FFT using Eigen.
-      constexpr auto direction =
-          Forward ? Eigen::FFT_FORWARD : Eigen::FFT_REVERSE;
       if (is_complex128) {
         DCHECK_EQ(in.dtype(), DT_COMPLEX128);
         DCHECK_EQ(out->dtype(), DT_COMPLEX128);
-        auto input = Tensor(in).flat_inner_dims<complex128, FFTRank + 1>();
-        auto output = out->flat_inner_dims<complex128, FFTRank + 1>();
-        output.device(device) =
-            input.template fft<Eigen::BothParts, direction>(axes);
+        DoComplexFFT<complex128>(ctx, in, out);
       } else {
         DCHECK_EQ(in.dtype(), DT_COMPLEX64);
         DCHECK_EQ(out->dtype(), DT_COMPLEX64);
-        auto input = Tensor(in).flat_inner_dims<complex64, FFTRank + 1>();
-        auto output = out->flat_inner_dims<complex64, FFTRank + 1>();
-        output.device(device) =
-            input.template fft<Eigen::BothParts, direction>(axes);
+        DoComplexFFT<complex64>(ctx, in, out);
       }
     } else {
       if (IsForward()) {
@@ -212,6 +204,46 @@ class FFTCPU : public FFTBase {
     }
   }
 
+  // Returns true if the FFT over the inner-most FFTRank dimensions of 'dims'
+  // should be computed one axis at a time, sharding the 1D transforms of each
+  // axis over the intra-op thread pool.
+  static bool ShouldShardFFT(
+      OpKernelContext* ctx,
+      const Eigen::DSizes<Eigen::DenseIndex, FFTRank + 1>& dims) {
+    if (ctx->device()->tensorflow_cpu_worker_threads()->num_threads <= 1) {
+      return false;
+    }
+    int64_t num_elements = 1;
+    int64_t max_fft_length = 1;
+    for (int i = 0; i <= FFTRank; ++i) {
+      num_elements *= dims[i];
+      if (i > 0) max_fft_length = std::max<int64_t>(max_fft_length, dims[i]);
+    }
+    // Sharding needs several independent transforms along every axis.
+    return num_elements >= kMinShardedFFTElements &&
+           num_elements >= 2 * max_fft_length;
+  }
+
+  template <typename ComplexT>
+  void DoComplexFFT(OpKernelContext* ctx, const Tensor& in, Tensor* out) {
+    // Create the axes (which are always trailing).
+    const auto axes = Eigen::ArrayXi::LinSpaced(FFTRank, 1, FFTRank);
+    auto device = ctx->eigen_device<CPUDevice>();
+    constexpr auto direction =
+        Forward ? Eigen::FFT_FORWARD : Eigen::FFT_REVERSE;
+    auto input = Tensor(in).flat_inner_dims<ComplexT, FFTRank + 1>();
+    auto output = out->flat_inner_dims<ComplexT, FFTRank + 1>();
+    if (ShouldShardFFT(ctx, output.dimensions())) {
+      output.device(device) = input;
+      functor::InPlaceFFT<direction, ComplexT, FFTRank + 1>(
+          ctx, output, /*first_axis=*/1, /*num_axes=*/FFTRank);
+      return;
+    }
+    // Compute the FFT using Eigen.
+    output.device(device) =
+        input.template fft<Eigen::BothParts, direction>(axes);
+  }
+
   template <typename RealT, typename ComplexT>
   void DoRealForwardFFT(OpKernelContext* ctx, uint64* fft_shape,
                         const Tensor& in, Tensor* out) {
@@ -241,9 +273,17 @@ class FFTCPU : public FFTBase {
     OP_REQUIRES_OK(ctx, ctx->allocate_temp(DataTypeToEnum<ComplexT>::v(),
                                            temp_shape, &temp));
     auto full_fft = temp.flat_inner_dims<ComplexT, FFTRank + 1>();
-    full_fft.device(device) =
-        input.slice(zero_start_indices, input_slice_sizes)
-            .template fft<Eigen::BothParts, Eigen::FFT_FORWARD>(axes);
+    if (ShouldShardFFT(ctx, full_fft.dimensions())) {
+      full_fft.device(device) =
+          input.slice(zero_start_indices, input_slice_sizes)
+              .template cast<ComplexT>();
+      functor::InPlaceFFT<Eigen::FFT_FORWARD, ComplexT, FFTRank + 1>(
+          ctx, full_fft, /*first_axis=*/1, /*num_axes=*/FFTRank);
+    } else {
+      full_fft.device(device) =
+          input.slice(zero_start_indices, input_slice_sizes)
+              .template fft<Eigen::BothParts, Eigen::FFT_FORWARD>(axes);
+    }
 
     // Slice away the negative frequency components.
     output.device(device) =
@@ -295,6 +335,35 @@ class FFTCPU : public FFTBase {
     full_fft.slice(start_indices, input_slice_sizes).device(device) =
         input.slice(start_indices, input_slice_sizes);
 
+    // Reconstruct the full FFT by appending reversed and conjugated
+    // spectrum as the negative frequency part.
+    Eigen::array<bool, FFTRank + 1> reverse_last_axis;
+    for (auto i = 0; i <= FFTRank; i++) {
+      reverse_last_axis[i] = i == FFTRank;
+    }
+
+    if (ShouldShardFFT(ctx, full_fft.dimensions())) {
+      // The sharded outer IFFTs run over whole lines of full_fft, so clear
+      // the negative frequency part rather than transform uninitialized
+      // memory; it is overwritten below.
+      if (neg_sizes[FFTRank] != 0) {
+        full_fft.slice(neg_target_indices, neg_sizes).device(device) =
+            full_fft.slice(neg_target_indices, neg_sizes).constant(ComplexT());
+      }
+      functor::InPlaceFFT<Eigen::FFT_REVERSE, ComplexT, FFTRank + 1>(
+          ctx, full_fft, /*first_axis=*/1, /*num_axes=*/FFTRank - 1);
+      if (neg_sizes[FFTRank] != 0) {
+        full_fft.slice(neg_target_indices, neg_sizes).device(device) =
+            full_fft.slice(neg_start_indices, neg_sizes)
+                .reverse(reverse_last_axis)
+                .conjugate();
+      }
+      functor::InPlaceFFT<Eigen::FFT_REVERSE, ComplexT, FFTRank + 1>(
+          ctx, full_fft, /*first_axis=*/FFTRank, /*num_axes=*/1);
+      output.device(device) = full_fft.real();
+      return;
+    }
+
     // First, conduct IFFTs on outer dimensions. We save computation (and
     // avoid touching uninitialized memory) by slicing full_fft to the
     // subregion we wrote input to.
@@ -306,13 +375,6 @@ class FFTCPU : public FFTBase {
               .template fft<Eigen::BothParts, Eigen::FFT_REVERSE>(outer_axes);
     }
 
-    // Reconstruct the full FFT by appending reversed and conjugated
-    // spectrum as the negative frequency part.
-    Eigen::array<bool, FFTRank + 1> reverse_last_axis;
-    for (auto i = 0; i <= FFTRank; i++) {
-      reverse_last_axis[i] = i == FFTRank;
-    }
-
     if (neg_sizes[FFTRank] != 0) {
       full_fft.slice(neg_target_indices, neg_sizes).device(device) =
           full_fft.slice(neg_start_indices, neg_sizes)
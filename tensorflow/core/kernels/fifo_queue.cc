@@ -51,6 +51,29 @@ void FIFOQueue::DequeueLocked(OpKernelContext* ctx, Tuple* tuple) {
 void FIFOQueue::TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
                            DoneCallback callback) {
   CancellationManager* cm = ctx->cancellation_manager();
+  if (!cm->IsCancelled()) {
+    bool flush;
+    bool enqueued;
+    {
+      mutex_lock l(mu_);
+      // Fast path: with no earlier enqueue (or close) pending there is
+      // nothing to order this one after, so an open queue with room takes
+      // the element without registering a cancellation callback or Attempt.
+      enqueued = enqueue_attempts_.empty() && !closed_ &&
+                 queues_[0].size() < static_cast<size_t>(capacity_);
+      if (enqueued) {
+        for (int i = 0; i < num_components(); ++i) {
+          queues_[i].push_back(tuple[i]);
+        }
+      }
+      flush = enqueued && !dequeue_attempts_.empty();
+    }
+    if (enqueued) {
+      if (flush) FlushUnlocked();
+      callback();
+      return;
+    }
+  }
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
   {
@@ -154,6 +177,24 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
 
 void FIFOQueue::TryDequeue(OpKernelContext* ctx, CallbackWithTuple callback) {
   CancellationManager* cm = ctx->cancellation_manager();
+  if (!cm->IsCancelled()) {
+    Tuple tuple;
+    bool flush;
+    {
+      mutex_lock l(mu_);
+      // Fast path, as in TryEnqueue: nothing earlier is waiting to dequeue
+      // and there is an element to take.
+      if (dequeue_attempts_.empty() && !queues_[0].empty()) {
+        DequeueLocked(ctx, &tuple);
+      }
+      flush = !tuple.empty() && !enqueue_attempts_.empty();
+    }
+    if (!tuple.empty()) {
+      if (flush) FlushUnlocked();
+      callback(tuple);
+      return;
+    }
+  }
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
   {
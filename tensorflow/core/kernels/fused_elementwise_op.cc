@@ -0,0 +1,315 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/cwise_ops.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+enum class FusedElementwiseOpKind {
+  // Unary ops.
+  kAbs,
+  kExp,
+  kLog,
+  kNeg,
+  kRelu,
+  kRelu6,
+  kRsqrt,
+  kSigmoid,
+  kSqrt,
+  kSquare,
+  kTanh,
+  // Binary ops, whose first input is the output of the preceding op.
+  kAdd,
+  kMaximum,
+  kMinimum,
+  kMul,
+  kRealDiv,
+  kSub,
+  // Converts the result to the output type; only valid as the last op.
+  kCast,
+};
+
+Status ParseFusedElementwiseOp(const string& name,
+                               FusedElementwiseOpKind* kind) {
+  static const auto* const kinds =
+      new std::unordered_map<string, FusedElementwiseOpKind>({
+          {"Abs", FusedElementwiseOpKind::kAbs},
+          {"Exp", FusedElementwiseOpKind::kExp},
+          {"Log", FusedElementwiseOpKind::kLog},
+          {"Neg", FusedElementwiseOpKind::kNeg},
+          {"Relu", FusedElementwiseOpKind::kRelu},
+          {"Relu6", FusedElementwiseOpKind::kRelu6},
+          {"Rsqrt", FusedElementwiseOpKind::kRsqrt},
+          {"Sigmoid", FusedElementwiseOpKind::kSigmoid},
+          {"Sqrt", FusedElementwiseOpKind::kSqrt},
+          {"Square", FusedElementwiseOpKind::kSquare},
+          {"Tanh", FusedElementwiseOpKind::kTanh},
+          {"Add", FusedElementwiseOpKind::kAdd},
+          {"AddV2", FusedElementwiseOpKind::kAdd},
+          {"Maximum", FusedElementwiseOpKind::kMaximum},
+          {"Minimum", FusedElementwiseOpKind::kMinimum},
+          {"Mul", FusedElementwiseOpKind::kMul},
+          {"RealDiv", FusedElementwiseOpKind::kRealDiv},
+          {"Sub", FusedElementwiseOpKind::kSub},
+          {"Cast", FusedElementwiseOpKind::kCast},
+      });
+  auto it = kinds->find(name);
+  if (it == kinds->end()) {
+    return errors::Unimplemented("Unsupported fused elementwise op: ", name);
+  }
+  *kind = it->second;
+  return OkStatus();
+}
+
+bool IsBinary(FusedElementwiseOpKind kind) {
+  return kind >= FusedElementwiseOpKind::kAdd &&
+         kind <= FusedElementwiseOpKind::kSub;
+}
+
+// The elements are processed in blocks of this size, small enough to stay in
+// L1 cache while every op of the chain makes its pass over them.
+constexpr int64_t kBlockSize = 1024;
+
+}  // namespace
+
+template <typename T, typename Tout>
+class FusedElementwiseOp : public OpKernel {
+ public:
+  explicit FusedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> fused_ops;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    OP_REQUIRES(context, !fused_ops.empty(),
+                errors::InvalidArgument("fused_ops must not be empty"));
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+
+    int arg = 0;
+    for (int i = 0; i < fused_ops.size(); ++i) {
+      Step step;
+      OP_REQUIRES_OK(context, ParseFusedElementwiseOp(fused_ops[i], &step.op));
+      if (step.op == FusedElementwiseOpKind::kCast) {
+        OP_REQUIRES(context, i == fused_ops.size() - 1,
+                    errors::InvalidArgument(
+                        "Cast must be the last of fused_ops, got: ",
+                        absl::StrJoin(fused_ops, ",")));
+        has_cast_ = true;
+        continue;
+      }
+      if (IsBinary(step.op)) step.arg = arg++;
+      steps_.push_back(step);
+    }
+    OP_REQUIRES(context, arg == num_args,
+                errors::InvalidArgument(
+                    "fused_ops has ", arg, " binary ops but num_args is ",
+                    num_args));
+    OP_REQUIRES(context, has_cast_ || kNoCast,
+                errors::InvalidArgument(
+                    "fused_ops must end with Cast when T and Tout differ"));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& x = context->input(0);
+    OpInputList args;
+    OP_REQUIRES_OK(context, context->input_list("args", &args));
+
+    // The fused ops do not broadcast: every other operand is either a scalar
+    // or has the shape of 'x'.
+    std::vector<const T*> arg_data(args.size());
+    std::vector<bool> arg_is_scalar(args.size());
+    for (int i = 0; i < args.size(); ++i) {
+      arg_is_scalar[i] = TensorShapeUtils::IsScalar(args[i].shape());
+      OP_REQUIRES(context,
+                  arg_is_scalar[i] || args[i].shape() == x.shape(),
+                  errors::InvalidArgument(
+                      "args[", i, "] must be a scalar or have the shape of x ",
+                      x.shape().DebugString(),
+                      ", got: ", args[i].shape().DebugString()));
+      arg_data[i] = args[i].flat<T>().data();
+    }
+
+    // Overwrite 'x' when nothing else holds its buffer.
+    Tensor* output = nullptr;
+    if (kNoCast) {
+      OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                  {0}, 0, x.shape(), &output));
+    } else {
+      OP_REQUIRES_OK(context,
+                     context->allocate_output(0, x.shape(), &output));
+    }
+    const int64_t size = x.NumElements();
+    if (size == 0) return;
+
+    const T* x_data = x.flat<T>().data();
+    Tout* output_data = output->flat<Tout>().data();
+    auto work = [&](int64_t begin_block, int64_t end_block) {
+      T buffer[kBlockSize];
+      for (int64_t block = begin_block; block < end_block; ++block) {
+        const int64_t begin = block * kBlockSize;
+        const int64_t n = std::min(kBlockSize, size - begin);
+        // Without a Cast the chain runs in the output block itself.
+        T* data = kNoCast
+                      ? reinterpret_cast<T*>(output_data + begin)
+                      : buffer;
+        if (data != x_data + begin) {
+          std::copy_n(x_data + begin, n, data);
+        }
+        typename TTypes<T>::Tensor values(data, n);
+        for (const Step& step : steps_) {
+          const T* arg = step.arg >= 0 ? arg_data[step.arg] : nullptr;
+          if (arg != nullptr && !arg_is_scalar[step.arg]) {
+            typename TTypes<T>::ConstTensor other(arg + begin, n);
+            ApplyBinary(step.op, other, values);
+          } else if (arg != nullptr) {
+            ApplyBinary(step.op, values.constant(*arg), values);
+          } else {
+            ApplyUnary(step.op, values);
+          }
+        }
+        if (!kNoCast) {
+          typename TTypes<Tout>::Tensor out(output_data + begin, n);
+          out = values.template cast<Tout>();
+        }
+      }
+    };
+    const int64_t num_blocks = (size + kBlockSize - 1) / kBlockSize;
+    const int64_t cost_per_block = kBlockSize * 4 * (steps_.size() + 1);
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          cost_per_block, work);
+  }
+
+ private:
+  // Whether the chain keeps its input type.
+  static constexpr bool kNoCast = std::is_same<T, Tout>::value;
+
+  struct Step {
+    FusedElementwiseOpKind op;
+    // Index of the other operand in 'args' for binary ops, -1 otherwise.
+    int arg = -1;
+  };
+
+  static void ApplyUnary(FusedElementwiseOpKind op,
+                         typename TTypes<T>::Tensor values) {
+    switch (op) {
+      case FusedElementwiseOpKind::kAbs:
+        values = values.unaryExpr(typename functor::abs<T>::func());
+        break;
+      case FusedElementwiseOpKind::kExp:
+        values = values.unaryExpr(typename functor::exp<T>::func());
+        break;
+      case FusedElementwiseOpKind::kLog:
+        values = values.unaryExpr(typename functor::log<T>::func());
+        break;
+      case FusedElementwiseOpKind::kNeg:
+        values = values.unaryExpr(typename functor::neg<T>::func());
+        break;
+      case FusedElementwiseOpKind::kRelu:
+        values = values.cwiseMax(static_cast<T>(0));
+        break;
+      case FusedElementwiseOpKind::kRelu6:
+        values =
+            values.cwiseMax(static_cast<T>(0)).cwiseMin(static_cast<T>(6));
+        break;
+      case FusedElementwiseOpKind::kRsqrt:
+        values = values.unaryExpr(typename functor::rsqrt<T>::func());
+        break;
+      case FusedElementwiseOpKind::kSigmoid:
+        values = values.unaryExpr(typename functor::sigmoid<T>::func());
+        break;
+      case FusedElementwiseOpKind::kSqrt:
+        values = values.unaryExpr(typename functor::sqrt<T>::func());
+        break;
+      case FusedElementwiseOpKind::kSquare:
+        values = values.unaryExpr(typename functor::square<T>::func());
+        break;
+      case FusedElementwiseOpKind::kTanh:
+        values = values.unaryExpr(typename functor::tanh<T>::func());
+        break;
+      default:
+        LOG(FATAL) << "Not a unary op: " << static_cast<int>(op);
+    }
+  }
+
+  template <typename Other>
+  static void ApplyBinary(FusedElementwiseOpKind op, const Other& other,
+                          typename TTypes<T>::Tensor values) {
+    switch (op) {
+      case FusedElementwiseOpKind::kAdd:
+        values = values.binaryExpr(other, typename functor::add<T>::func());
+        break;
+      case FusedElementwiseOpKind::kMaximum:
+        values =
+            values.binaryExpr(other, typename functor::maximum<T>::func());
+        break;
+      case FusedElementwiseOpKind::kMinimum:
+        values =
+            values.binaryExpr(other, typename functor::minimum<T>::func());
+        break;
+      case FusedElementwiseOpKind::kMul:
+        values = values.binaryExpr(other, typename functor::mul<T>::func());
+        break;
+      case FusedElementwiseOpKind::kRealDiv:
+        values = values.binaryExpr(other, typename functor::div<T>::func());
+        break;
+      case FusedElementwiseOpKind::kSub:
+        values = values.binaryExpr(other, typename functor::sub<T>::func());
+        break;
+      default:
+        LOG(FATAL) << "Not a binary op: " << static_cast<int>(op);
+    }
+  }
+
+  std::vector<Step> steps_;
+  bool has_cast_ = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedElementwiseOp);
+};
+
+#define REGISTER_CPU(T, Tout)                                 \
+  REGISTER_KERNEL_BUILDER(Name("_FusedElementwise")           \
+                              .Device(DEVICE_CPU)             \
+                              .TypeConstraint<T>("T")         \
+                              .TypeConstraint<Tout>("Tout"),  \
+                          FusedElementwiseOp<T, Tout>);
+
+REGISTER_CPU(float, float);
+REGISTER_CPU(float, Eigen::half);
+REGISTER_CPU(float, bfloat16);
+REGISTER_CPU(double, double);
+REGISTER_CPU(double, float);
+
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_GATHER_FUNCTOR_H_
 #define TENSORFLOW_CORE_KERNELS_GATHER_FUNCTOR_H_
 
+#include <algorithm>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 
 #include "tensorflow/core/framework/bounds_check.h"
@@ -57,33 +59,51 @@ SliceIndex HandleCopies(OpKernelContext* ctx,
   // Store the value of invalidate index for printing error information, it's a
   // shared variable.
   SliceIndex result = -1;
+  // Rows are prefetched this many copies ahead, so that the cache misses of
+  // tables much larger than the caches overlap. Only the first bytes of a row
+  // are prefetched; the hardware prefetcher streams the rest of long rows.
+  constexpr int64_t kPrefetchDistance = 8;
+  constexpr size_t kMaxPrefetchBytes = 256;
+  constexpr size_t kCacheLineBytes = 64;
+  const size_t prefetch_bytes = std::min(slice_bytes, kMaxPrefetchBytes);
   auto work = [&](int64_t start, int64_t end) {
     SliceIndex batch_idx = static_cast<SliceIndex>(start / indices_size);
     SliceIndex indices_idx = static_cast<SliceIndex>(start % indices_size);
-    SliceIndex batch_idx_end = static_cast<SliceIndex>(end / indices_size);
-    SliceIndex indices_idx_end = static_cast<SliceIndex>(end % indices_size);
+    SliceIndex prefetch_batch_idx = batch_idx;
+    SliceIndex prefetch_indices_idx = indices_idx;
+    int64_t prefetch_pos = start;
+    auto prefetch_next = [&]() {
+      if (prefetch_pos >= end) return;
+      const Index index = indices(prefetch_indices_idx);
+      // The index is checked again before its copy.
+      if (FastBoundsCheck(index, limit)) {
+        const char* row = reinterpret_cast<const char*>(
+            params_base + (prefetch_batch_idx * static_cast<SliceIndex>(limit) +
+                           static_cast<SliceIndex>(index)) *
+                              slice_elems);
+        for (size_t offset = 0; offset < prefetch_bytes;
+             offset += kCacheLineBytes) {
+          port::prefetch<port::PREFETCH_HINT_T0>(row + offset);
+        }
+      }
+      ++prefetch_pos;
+      if (++prefetch_indices_idx == indices_size) {
+        prefetch_indices_idx = 0;
+        ++prefetch_batch_idx;
+      }
+    };
+    for (int64_t k = 0; k < kPrefetchDistance; ++k) {
+      prefetch_next();
+    }
 
-    while ((batch_idx < batch_idx_end) ||
-           (batch_idx == batch_idx_end && indices_idx < indices_idx_end)) {
-      SliceIndex i_next = indices_idx + 1;
-      SliceIndex b_next = batch_idx + 1;
+    for (int64_t pos = start; pos < end; ++pos) {
+      prefetch_next();
       const Index index = internal::SubtleMustCopy(indices(indices_idx));
       if (!FastBoundsCheck(index, limit)) {
         mutex_lock l(mu);
         result = indices_idx;
         return;
       }
-      if ((batch_idx == batch_idx_end && i_next < indices_idx_end) ||
-          (i_next < indices_size)) {
-        port::prefetch<port::PREFETCH_HINT_T0>(
-            &params(batch_idx, indices(i_next), 0));
-        port::prefetch<port::PREFETCH_HINT_T0>(&out(batch_idx, i_next, 0));
-        b_next = batch_idx;
-      } else if (b_next <= batch_idx_end) {
-        port::prefetch<port::PREFETCH_HINT_T0>(&params(b_next, indices(0), 0));
-        port::prefetch<port::PREFETCH_HINT_T0>(&out(b_next, 0, 0));
-        i_next = 0;
-      }
       // Copy using memcpy if possible, otherwise an Eigen loop
       // TODO(cwhipkey): avoid linking to framework to get Allocator (to improve
       // ahead-of-time compilation binary size).
@@ -100,8 +120,10 @@ SliceIndex HandleCopies(OpKernelContext* ctx,
         out.template chip<0>(batch_idx).template chip<0>(indices_idx) =
             params.template chip<0>(batch_idx).template chip<0>(index);
       }
-      indices_idx = i_next;
-      batch_idx = b_next;
+      if (++indices_idx == indices_size) {
+        indices_idx = 0;
+        ++batch_idx;
+      }
     }
   };
 
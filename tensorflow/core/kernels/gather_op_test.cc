@@ -163,6 +163,36 @@ TEST_F(GatherOpTest, HighRank) {
   test::ExpectTensorEqual<float>(expected, *GetOutput(0));
 }
 
+TEST_F(GatherOpTest, ManyIndices_Axis0) {
+  MakeOp(DT_FLOAT, DT_INT32);
+
+  // More indices than the prefetch distance, in no particular order.
+  constexpr int kRows = 1000;
+  constexpr int kCols = 4;
+  constexpr int kIndices = 257;
+  std::vector<float> params(kRows * kCols);
+  for (int i = 0; i < kRows * kCols; ++i) params[i] = i;
+  std::vector<int32> indices(kIndices);
+  std::vector<float> expected_values;
+  for (int i = 0; i < kIndices; ++i) {
+    indices[i] = (i * 37) % kRows;
+    for (int j = 0; j < kCols; ++j) {
+      expected_values.push_back(indices[i] * kCols + j);
+    }
+  }
+
+  // Feed and run
+  AddInputFromArray<float>(TensorShape({kRows, kCols}), params);
+  AddInputFromArray<int32>(TensorShape({kIndices}), indices);
+  AddInputFromArray<int32>(TensorShape({}), {0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Check the output.
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kIndices, kCols}));
+  test::FillValues<float>(&expected, expected_values);
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
 TEST_F(GatherOpTest, Error_IndexOutOfRange) {
   MakeOp(DT_FLOAT, DT_INT32);
 
@@ -15,8 +15,11 @@ limitations under the License.
 
 // See docs in ../ops/image_ops.cc
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/lib/gtl/cleanup.h"
 
@@ -37,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap_tensor.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -69,6 +73,40 @@ FileFormat ClassifyFileFormat(StringPiece data) {
   return kUnknownFormat;
 }
 
+// Picks the largest ratio at which the (cropped) `height` x `width` image
+// still decodes to at least `min_height` x `min_width` pixels, and scales the
+// crop window of `flags` to it. The scaled window covers the requested one.
+// Invalid crop windows are left for `jpeg::Uncompress` to reject.
+void ApplyDraftSize(int min_height, int min_width, int height, int width,
+                    jpeg::UncompressFlags* flags) {
+  if (flags->crop) {
+    if (flags->crop_y < 0 || flags->crop_x < 0 || flags->crop_height <= 0 ||
+        flags->crop_width <= 0 || flags->crop_height > height - flags->crop_y ||
+        flags->crop_width > width - flags->crop_x) {
+      return;
+    }
+  }
+  const int target_height = flags->crop ? flags->crop_height : height;
+  const int target_width = flags->crop ? flags->crop_width : width;
+  int ratio = 1;
+  while (ratio < 8 && target_height / (2 * ratio) >= min_height &&
+         target_width / (2 * ratio) >= min_width) {
+    ratio *= 2;
+  }
+  flags->ratio = ratio;
+  if (!flags->crop || ratio == 1) return;
+
+  // libjpeg rounds the scaled image size up.
+  auto scale_down = [ratio](int x) { return x / ratio; };
+  auto scale_up = [ratio](int x) { return (x + ratio - 1) / ratio; };
+  const int crop_y = scale_down(flags->crop_y);
+  const int crop_x = scale_down(flags->crop_x);
+  flags->crop_height = scale_up(flags->crop_y + flags->crop_height) - crop_y;
+  flags->crop_width = scale_up(flags->crop_x + flags->crop_width) - crop_x;
+  flags->crop_y = crop_y;
+  flags->crop_x = crop_x;
+}
+
 // Decode an image. Supported image formats are JPEG, PNG, GIF and BMP. This is
 // a newer version of `DecodeImageOp` for enabling image data parsing to take
 // place in kernels only, reducing security vulnerabilities and redundancy.
@@ -123,6 +161,10 @@ class DecodeImageV2Op : public OpKernel {
       } else if (dct_method == "INTEGER_ACCURATE") {
         flags_.dct_method = JDCT_ISLOW;
       }
+      OP_REQUIRES_OK(context, context->GetAttr("draft_size", &draft_size_));
+      OP_REQUIRES(context, draft_size_ >= 0,
+                  errors::InvalidArgument(
+                      "draft_size must be non-negative, got ", draft_size_));
     } else {
       flags_ = jpeg::UncompressFlags();
       flags_.dct_method = JDCT_IFAST;
@@ -256,6 +298,14 @@ class DecodeImageV2Op : public OpKernel {
                       "`decode_jpeg` or `decode_image` instead."));
     }
 
+    if (draft_size_ > 0) {
+      int width, height, components;
+      if (jpeg::GetImageInfo(input.data(), input.size(), &width, &height,
+                             &components)) {
+        ApplyDraftSize(draft_size_, draft_size_, height, width, &flags);
+      }
+    }
+
     // Output tensor and the image buffer size.
     Tensor* output = nullptr;
     int buffer_size = 0;
@@ -670,6 +720,7 @@ class DecodeImageV2Op : public OpKernel {
   DataType data_type_ = DataType::DT_UINT8;
   bool expand_animations_ = true;
   jpeg::UncompressFlags flags_;
+  int32 draft_size_ = 0;
   string op_type_;
 };
 
@@ -744,5 +795,209 @@ void DecodeImageV2Op::DecodeBMP(const uint8* input, const int row_size,
   }
 }
 
+// Decodes the crop window of a JPEG image at the coarsest DCT scale that still
+// covers the output size, and resizes it bilinearly (with half-pixel centers,
+// as `ResizeBilinear`) and normalizes it into the float output in one pass.
+class DecodeCropAndResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeCropAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context,
+                channels_ == 0 || channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 0, 1 or 3, got ",
+                                        channels_));
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    flags_.dct_method =
+        dct_method == "INTEGER_ACCURATE" ? JDCT_ISLOW : JDCT_IFAST;
+    flags_.components = channels_;
+    flags_.crop = true;
+    OP_REQUIRES_OK(context, context->GetAttr("mean", &mean_));
+    std::vector<float> stddev;
+    OP_REQUIRES_OK(context, context->GetAttr("stddev", &stddev));
+    for (float s : stddev) {
+      OP_REQUIRES(context, s != 0,
+                  errors::InvalidArgument("stddev must be non-zero"));
+      inv_stddev_.push_back(1.0f / s);
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(contents.shape()),
+                errors::InvalidArgument("contents must be scalar, got shape ",
+                                        contents.shape().DebugString()));
+    const StringPiece input = contents.scalar<tstring>()();
+    OP_REQUIRES(context, input.size() <= std::numeric_limits<int>::max(),
+                errors::InvalidArgument(
+                    "Input contents are too large for int: ", input.size()));
+    OP_REQUIRES(context, ClassifyFileFormat(input) == kJpgFormat,
+                errors::InvalidArgument(
+                    "DecodeCropAndResizeJpeg operation can run on JPEG only"));
+    const Tensor& crop_window = context->input(1);
+    OP_REQUIRES(context,
+                crop_window.dims() == 1 && crop_window.dim_size(0) == 4,
+                errors::InvalidArgument(
+                    "crop_window must have four elements, got shape ",
+                    crop_window.shape().DebugString()));
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(context, size.dims() == 1 && size.dim_size(0) == 2,
+                errors::InvalidArgument("size must have two elements, got ",
+                                        size.shape().DebugString()));
+    const int out_height = size.vec<int32>()(0);
+    const int out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("size must be positive, got [",
+                                        out_height, ", ", out_width, "]"));
+
+    int width, height, components;
+    OP_REQUIRES(context,
+                jpeg::GetImageInfo(input.data(), input.size(), &width, &height,
+                                   &components),
+                errors::InvalidArgument("Invalid JPEG data"));
+    jpeg::UncompressFlags flags = flags_;
+    const auto crop_window_vec = crop_window.vec<int32>();
+    flags.crop_y = crop_window_vec(0);
+    flags.crop_x = crop_window_vec(1);
+    flags.crop_height = crop_window_vec(2);
+    flags.crop_width = crop_window_vec(3);
+    const jpeg::UncompressFlags requested = flags;
+    ApplyDraftSize(out_height, out_width, height, width, &flags);
+
+    Tensor decoded;
+    uint8* buffer = jpeg::Uncompress(
+        input.data(), input.size(), flags, nullptr /* nwarn */,
+        [&](int width, int height, int channels) -> uint8* {
+          Status status = context->allocate_temp(
+              DT_UINT8, TensorShape({height, width, channels}), &decoded);
+          if (!status.ok()) {
+            context->SetStatus(status);
+            return nullptr;
+          }
+          return decoded.flat<uint8>().data();
+        });
+    OP_REQUIRES(
+        context, buffer,
+        errors::InvalidArgument(
+            "jpeg::Uncompress failed. Invalid JPEG data or crop window."));
+
+    const int in_height = decoded.dim_size(0);
+    const int in_width = decoded.dim_size(1);
+    const int num_channels = decoded.dim_size(2);
+    OP_REQUIRES(context,
+                mean_.empty() || mean_.size() == 1 ||
+                    mean_.size() == num_channels,
+                errors::InvalidArgument("mean must have 1 or ", num_channels,
+                                        " elements, got ", mean_.size()));
+    OP_REQUIRES(context,
+                inv_stddev_.empty() || inv_stddev_.size() == 1 ||
+                    inv_stddev_.size() == num_channels,
+                errors::InvalidArgument("stddev must have 1 or ", num_channels,
+                                        " elements, got ", inv_stddev_.size()));
+    std::vector<float> offset(num_channels), scale(num_channels);
+    for (int c = 0; c < num_channels; ++c) {
+      const float mean =
+          mean_.empty() ? 0.0f : mean_[mean_.size() == 1 ? 0 : c];
+      scale[c] = inv_stddev_.empty()
+                     ? 1.0f
+                     : inv_stddev_[inv_stddev_.size() == 1 ? 0 : c];
+      offset[c] = -mean * scale[c];
+    }
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({out_height, out_width, num_channels}),
+                       &output));
+
+    // The requested window within the decoded (scaled) window.
+    const float ratio = flags.ratio;
+    const float window_y = requested.crop_y / ratio - flags.crop_y;
+    const float window_x = requested.crop_x / ratio - flags.crop_x;
+    const float height_scale = requested.crop_height / ratio / out_height;
+    const float width_scale = requested.crop_width / ratio / out_width;
+    std::vector<CachedInterpolation> xs(out_width);
+    for (int x = 0; x < out_width; ++x) {
+      xs[x] = Interpolation(window_x, width_scale, x, in_width);
+      xs[x].lower *= num_channels;
+      xs[x].upper *= num_channels;
+    }
+
+    const uint8* in = decoded.flat<uint8>().data();
+    float* out = output->flat<float>().data();
+    const int64_t in_row_size = static_cast<int64_t>(in_width) * num_channels;
+    const int64_t out_row_size = static_cast<int64_t>(out_width) * num_channels;
+    auto resize_rows = [&](int64_t start, int64_t limit) {
+      for (int64_t y = start; y < limit; ++y) {
+        const CachedInterpolation ys =
+            Interpolation(window_y, height_scale, y, in_height);
+        const uint8* top = in + ys.lower * in_row_size;
+        const uint8* bottom = in + ys.upper * in_row_size;
+        float* out_row = out + y * out_row_size;
+        for (int x = 0; x < out_width; ++x) {
+          for (int c = 0; c < num_channels; ++c) {
+            const float top_left = top[xs[x].lower + c];
+            const float top_right = top[xs[x].upper + c];
+            const float bottom_left = bottom[xs[x].lower + c];
+            const float bottom_right = bottom[xs[x].upper + c];
+            const float top_value =
+                top_left + (top_right - top_left) * xs[x].lerp;
+            const float bottom_value =
+                bottom_left + (bottom_right - bottom_left) * xs[x].lerp;
+            const float value =
+                top_value + (bottom_value - top_value) * ys.lerp;
+            out_row[x * num_channels + c] = value * scale[c] + offset[c];
+          }
+        }
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, out_height,
+          /*cost_per_unit=*/out_row_size * 20, resize_rows);
+  }
+
+ private:
+  struct CachedInterpolation {
+    int64_t lower;
+    int64_t upper;
+    float lerp;
+  };
+
+  // Returns the source rows (or columns) and weight for output `out` of a
+  // half-pixel-centered resize from the `scale` times larger window that
+  // starts at `start` in an input of `in_size` pixels.
+  static CachedInterpolation Interpolation(float start, float scale,
+                                           int64_t out, int in_size) {
+    const float in = start + (out + 0.5f) * scale - 0.5f;
+    const float in_floor = std::floor(in);
+    CachedInterpolation result;
+    result.lower = std::min<int64_t>(
+        std::max<int64_t>(static_cast<int64_t>(in_floor), 0), in_size - 1);
+    result.upper = std::min<int64_t>(
+        std::max<int64_t>(static_cast<int64_t>(std::ceil(in)), 0),
+        in_size - 1);
+    result.lerp = in - in_floor;
+    return result;
+  }
+
+  int32 channels_;
+  jpeg::UncompressFlags flags_;
+  std::vector<float> mean_;
+  std::vector<float> inv_stddev_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeCropAndResizeJpeg").Device(DEVICE_CPU),
+                        DecodeCropAndResizeJpegOp);
+
 }  // namespace
 }  // namespace tensorflow
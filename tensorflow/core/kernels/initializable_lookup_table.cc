@@ -95,12 +95,26 @@ Status InitializableLookupTable::Initialize(
   if (!errors::IsOutOfRange(iter.status())) {
     return iter.status();
   }
+  TF_RETURN_IF_ERROR(DoFinalize());
 
   initializer_serializer_ = std::move(serializer);
   is_initialized_.store(true, std::memory_order_release);
   return OkStatus();
 }
 
+Status InitializableLookupTable::InitializeWith(
+    std::function<Status()> populate,
+    std::unique_ptr<InitializerSerializer> serializer) {
+  mutex_lock l(mu_);
+  if (is_initialized()) {
+    return errors::FailedPrecondition("Table already initialized.");
+  }
+  TF_RETURN_IF_ERROR(populate());
+  initializer_serializer_ = std::move(serializer);
+  is_initialized_.store(true, std::memory_order_release);
+  return OkStatus();
+}
+
 Status InitializableLookupTable::AreEntriesSame(const InitTableIterator& iter,
                                                 bool* result) {
   *result = static_cast<size_t>(iter.total_size()) == size();
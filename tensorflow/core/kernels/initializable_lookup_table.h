@@ -198,8 +198,19 @@ class InitializableLookupTable : public LookupInterface {
   virtual Status DoFind(const Tensor& keys, Tensor* values,
                         const Tensor& default_value) = 0;
 
+  // Called once all the elements have been inserted, before the table is
+  // marked as initialized. Tables that build an immutable structure out of the
+  // inserted elements can do it here.
+  virtual Status DoFinalize() { return OkStatus(); }
+
   virtual Status AreEntriesSame(const InitTableIterator& iter, bool* result);
 
+  // Initializes the table by running `populate` instead of inserting the
+  // elements of an iterator, for tables that load prebuilt contents directly.
+  // Returns FailedPrecondition if the table is already initialized.
+  Status InitializeWith(std::function<Status()> populate,
+                        std::unique_ptr<InitializerSerializer> serializer);
+
   mutex mu_;
 
  protected:
@@ -0,0 +1,247 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Roofline benchmarks of the kernels that dominate the step time of common
+// models, on shapes taken from those models. Every benchmark reports the
+// achieved FLOP/s and bytes/s and how close they are to the peaks of the
+// machine (see test::Benchmark::ReportRoofline).
+//
+// Run with --benchmark_format=json --benchmark_out=<file> to record a build,
+// and compare two such files with tensorflow/tools/test/compare_benchmarks.py.
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr double kFloatBytes = sizeof(float);
+
+Tensor MakeRandomTensor(const TensorShape& shape) {
+  Tensor tensor(DT_FLOAT, shape);
+  tensor.flat<float>() = tensor.flat<float>().setRandom();
+  return tensor;
+}
+
+Node* RandomConstant(Graph* g, const TensorShape& shape) {
+  return test::graph::Constant(g, MakeRandomTensor(shape));
+}
+
+Node* Int32Constant(Graph* g, const std::vector<int32>& values) {
+  return test::graph::Constant(g, test::AsTensor<int32>(values));
+}
+
+void RunRoofline(benchmark::State& state, const string& device, Graph* g,
+                 double flops, double bytes) {
+  test::Benchmark bm(device, g, /*old_benchmark_api=*/false);
+  bm.Run(state);
+  bm.ReportRoofline(state, flops, bytes);
+}
+
+// Shapes of the dense layers of BERT-base at 8x128 tokens and of the
+// classifier of ResNet-50.
+void MatMulShapes(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"m", "k", "n"});
+  b->Args({1024, 768, 768});
+  b->Args({1024, 768, 3072});
+  b->Args({1024, 3072, 768});
+  b->Args({32, 2048, 1000});
+}
+
+void BM_MatMul(benchmark::State& state, const string& device) {
+  const int64_t m = state.range(0);
+  const int64_t k = state.range(1);
+  const int64_t n = state.range(2);
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Matmul(g, RandomConstant(g, {m, k}), RandomConstant(g, {k, n}),
+                      /*transpose_a=*/false, /*transpose_b=*/false);
+  RunRoofline(state, device, g, 2.0 * m * k * n,
+              kFloatBytes * (m * k + k * n + m * n));
+}
+
+// Attention score (q * k^T) and context (p * v) products of BERT-base with 8
+// sequences of 128 tokens and 12 heads of size 64.
+void BatchMatMulShapes(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"batch", "m", "k", "n"});
+  b->Args({96, 128, 64, 128});
+  b->Args({96, 128, 128, 64});
+}
+
+void BM_BatchMatMul(benchmark::State& state, const string& device) {
+  const int64_t batch = state.range(0);
+  const int64_t m = state.range(1);
+  const int64_t k = state.range(2);
+  const int64_t n = state.range(3);
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::BatchMatmul(g, RandomConstant(g, {batch, m, k}),
+                           RandomConstant(g, {batch, k, n}), /*adj_x=*/false,
+                           /*adj_y=*/false);
+  RunRoofline(state, device, g, 2.0 * batch * m * k * n,
+              kFloatBytes * batch * (m * k + k * n + m * n));
+}
+
+// 3x3 and 1x1 convolutions of the four stages of ResNet-50 at batch 32.
+void Conv2DShapes(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"batch", "hw", "in", "filter", "out"});
+  b->Args({32, 56, 64, 3, 64});
+  b->Args({32, 56, 64, 1, 256});
+  b->Args({32, 28, 128, 3, 128});
+  b->Args({32, 14, 256, 3, 256});
+  b->Args({32, 7, 512, 3, 512});
+}
+
+void BM_Conv2D(benchmark::State& state, const string& device) {
+  const int64_t batch = state.range(0);
+  const int64_t hw = state.range(1);
+  const int64_t in_depth = state.range(2);
+  const int64_t filter = state.range(3);
+  const int64_t out_depth = state.range(4);
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* conv;
+  TF_CHECK_OK(
+      NodeBuilder(g->NewName("conv"), "Conv2D")
+          .Input(RandomConstant(g, {batch, hw, hw, in_depth}))
+          .Input(RandomConstant(g, {filter, filter, in_depth, out_depth}))
+          .Attr("T", DT_FLOAT)
+          .Attr("strides", {1, 1, 1, 1})
+          .Attr("padding", "SAME")
+          .Finalize(g, &conv));
+  const double pixels = batch * hw * hw;
+  RunRoofline(state, device, g,
+              2.0 * pixels * out_depth * filter * filter * in_depth,
+              kFloatBytes * (pixels * in_depth +
+                             filter * filter * in_depth * out_depth +
+                             pixels * out_depth));
+}
+
+// BERT-base feed-forward activations and a ResNet-50 stage 1 activation.
+void ElementwiseShapes(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"rows", "cols"});
+  b->Args({1024, 3072});
+  b->Args({100352, 256});
+}
+
+void BM_Relu(benchmark::State& state, const string& device) {
+  const int64_t rows = state.range(0);
+  const int64_t cols = state.range(1);
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Unary(g, "Relu", RandomConstant(g, {rows, cols}));
+  const double n = rows * cols;
+  RunRoofline(state, device, g, n, kFloatBytes * 2 * n);
+}
+
+void BM_BiasAdd(benchmark::State& state, const string& device) {
+  const int64_t rows = state.range(0);
+  const int64_t cols = state.range(1);
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Binary(g, "BiasAdd", RandomConstant(g, {rows, cols}),
+                      RandomConstant(g, {cols}));
+  const double n = rows * cols;
+  RunRoofline(state, device, g, n, kFloatBytes * (2 * n + cols));
+}
+
+void BM_AddV2(benchmark::State& state, const string& device) {
+  const int64_t rows = state.range(0);
+  const int64_t cols = state.range(1);
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Binary(g, "AddV2", RandomConstant(g, {rows, cols}),
+                      RandomConstant(g, {rows, cols}));
+  const double n = rows * cols;
+  RunRoofline(state, device, g, n, kFloatBytes * 3 * n);
+}
+
+// Layer norm style reduction over the hidden dimension of BERT-base.
+void BM_SumLastAxis(benchmark::State& state, const string& device) {
+  const int64_t rows = 1024;
+  const int64_t cols = 768;
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Reduce(g, "Sum", RandomConstant(g, {rows, cols}),
+                      Int32Constant(g, {1}));
+  const double n = rows * cols;
+  RunRoofline(state, device, g, n, kFloatBytes * (n + rows));
+}
+
+// Global average pooling before the classifier of ResNet-50.
+void BM_MeanSpatial(benchmark::State& state, const string& device) {
+  const int64_t batch = 32;
+  const int64_t hw = 7;
+  const int64_t depth = 2048;
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Reduce(g, "Mean", RandomConstant(g, {batch, hw, hw, depth}),
+                      Int32Constant(g, {1, 2}));
+  const double n = batch * hw * hw * depth;
+  RunRoofline(state, device, g, n, kFloatBytes * (n + batch * depth));
+}
+
+// Attention probabilities of BERT-base: 8 sequences x 12 heads x 128 queries
+// over 128 keys.
+void BM_Softmax(benchmark::State& state, const string& device) {
+  const int64_t rows = 12288;
+  const int64_t cols = 128;
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Unary(g, "Softmax", RandomConstant(g, {rows, cols}));
+  // Max, subtract, exp, sum and divide per element.
+  const double n = rows * cols;
+  RunRoofline(state, device, g, 5 * n, kFloatBytes * 2 * n);
+}
+
+// Splitting the BERT-base hidden dimension into heads.
+void BM_TransposeHeads(benchmark::State& state, const string& device) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Binary(g, "Transpose", RandomConstant(g, {8, 128, 12, 64}),
+                      Int32Constant(g, {0, 2, 1, 3}));
+  const double n = 8 * 128 * 12 * 64;
+  RunRoofline(state, device, g, 0, kFloatBytes * 2 * n);
+}
+
+#define BM_ROOFLINE_DEVICE(name, device, shapes) \
+  BENCHMARK_CAPTURE(name, device, #device)->Apply(shapes)->UseRealTime()
+
+#define BM_ROOFLINE_DEVICE_SCALAR(name, device) \
+  BENCHMARK_CAPTURE(name, device, #device)->UseRealTime()
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#define BM_ROOFLINE(name, shapes)           \
+  BM_ROOFLINE_DEVICE(name, cpu, shapes);    \
+  BM_ROOFLINE_DEVICE(name, gpu, shapes)
+#define BM_ROOFLINE_SCALAR(name)            \
+  BM_ROOFLINE_DEVICE_SCALAR(name, cpu);     \
+  BM_ROOFLINE_DEVICE_SCALAR(name, gpu)
+#else
+#define BM_ROOFLINE(name, shapes) BM_ROOFLINE_DEVICE(name, cpu, shapes)
+#define BM_ROOFLINE_SCALAR(name) BM_ROOFLINE_DEVICE_SCALAR(name, cpu)
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+BM_ROOFLINE(BM_MatMul, MatMulShapes);
+BM_ROOFLINE(BM_BatchMatMul, BatchMatMulShapes);
+BM_ROOFLINE(BM_Conv2D, Conv2DShapes);
+BM_ROOFLINE(BM_Relu, ElementwiseShapes);
+BM_ROOFLINE(BM_BiasAdd, ElementwiseShapes);
+BM_ROOFLINE(BM_AddV2, ElementwiseShapes);
+BM_ROOFLINE_SCALAR(BM_SumLastAxis);
+BM_ROOFLINE_SCALAR(BM_MeanSpatial);
+BM_ROOFLINE_SCALAR(BM_Softmax);
+BM_ROOFLINE_SCALAR(BM_TransposeHeads);
+
+}  // namespace
+}  // namespace tensorflow
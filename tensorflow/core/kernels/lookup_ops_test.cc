@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -100,5 +101,101 @@ TEST_F(LookupOpsTest, AnonymousHashTable_RefCounting) {
   EXPECT_FALSE(alive);
 }
 
+TEST_F(LookupOpsTest, AnonymousMutableHashTable_BatchedOps) {
+  TF_ASSERT_OK(
+      NodeDefBuilder("anonymous_mutable_hash_table", "AnonymousMutableHashTable")
+          .Attr("key_dtype", DT_INT64)
+          .Attr("value_dtype", DT_INT64)
+          .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  TF_ASSERT_OK(RunOpKernel());
+  auto table_or = GetOutput(0)
+                      ->scalar<ResourceHandle>()()
+                      .GetResource<lookup::LookupInterface>();
+  TF_ASSERT_OK(table_or.status());
+  lookup::LookupInterface* table = table_or.value();
+
+  // Enough keys to cover every shard, with a duplicate key whose last value
+  // wins.
+  constexpr int kNumKeys = 1000;
+  Tensor keys(DT_INT64, TensorShape({kNumKeys + 1}));
+  Tensor values(DT_INT64, TensorShape({kNumKeys + 1}));
+  for (int i = 0; i < kNumKeys; ++i) {
+    keys.vec<int64_t>()(i) = i * 7919;
+    values.vec<int64_t>()(i) = i;
+  }
+  keys.vec<int64_t>()(kNumKeys) = 0;
+  values.vec<int64_t>()(kNumKeys) = -2;
+  TF_ASSERT_OK(table->Insert(context_.get(), keys, values));
+  EXPECT_EQ(table->size(), kNumKeys);
+
+  Tensor removed(DT_INT64, TensorShape({1}));
+  removed.vec<int64_t>()(0) = 7919;
+  TF_ASSERT_OK(table->Remove(context_.get(), removed));
+  EXPECT_EQ(table->size(), kNumKeys - 1);
+
+  Tensor default_value(DT_INT64, TensorShape({}));
+  default_value.scalar<int64_t>()() = -1;
+  Tensor found(DT_INT64, TensorShape({kNumKeys + 1}));
+  TF_ASSERT_OK(table->Find(context_.get(), keys, &found, default_value));
+  EXPECT_EQ(found.vec<int64_t>()(0), -2);
+  EXPECT_EQ(found.vec<int64_t>()(1), -1);
+  for (int i = 2; i < kNumKeys; ++i) {
+    EXPECT_EQ(found.vec<int64_t>()(i), i);
+  }
+  EXPECT_EQ(found.vec<int64_t>()(kNumKeys), -2);
+}
+
+TEST_F(LookupOpsTest, AnonymousMutableHashTable_BatchesAreAtomic) {
+  TF_ASSERT_OK(
+      NodeDefBuilder("anonymous_mutable_hash_table", "AnonymousMutableHashTable")
+          .Attr("key_dtype", DT_INT64)
+          .Attr("value_dtype", DT_INT64)
+          .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  TF_ASSERT_OK(RunOpKernel());
+  auto table_or = GetOutput(0)
+                      ->scalar<ResourceHandle>()()
+                      .GetResource<lookup::LookupInterface>();
+  TF_ASSERT_OK(table_or.status());
+  lookup::LookupInterface* table = table_or.value();
+
+  // Every batch sets all the keys, which span every shard, to the same value,
+  // so a lookup of all the keys must never see two different values.
+  constexpr int kNumKeys = 1000;
+  constexpr int kNumBatches = 200;
+  Tensor keys(DT_INT64, TensorShape({kNumKeys}));
+  for (int i = 0; i < kNumKeys; ++i) {
+    keys.vec<int64_t>()(i) = i * 7919;
+  }
+  auto insert_all = [&](int64_t value) {
+    Tensor values(DT_INT64, TensorShape({kNumKeys}));
+    values.vec<int64_t>().setConstant(value);
+    return table->Insert(context_.get(), keys, values);
+  };
+  TF_ASSERT_OK(insert_all(0));
+
+  std::unique_ptr<Thread> writer(Env::Default()->StartThread(
+      ThreadOptions(), "writer", [&]() {
+        for (int64_t value = 1; value <= kNumBatches; ++value) {
+          TF_EXPECT_OK(insert_all(value));
+        }
+      }));
+  Tensor default_value(DT_INT64, TensorShape({}));
+  default_value.scalar<int64_t>()() = -1;
+  Tensor found(DT_INT64, TensorShape({kNumKeys}));
+  int64_t last_value = 0;
+  while (last_value < kNumBatches) {
+    TF_ASSERT_OK(table->Find(context_.get(), keys, &found, default_value));
+    const auto found_values = found.vec<int64_t>();
+    ASSERT_GE(found_values(0), last_value);
+    for (int i = 1; i < kNumKeys; ++i) {
+      ASSERT_EQ(found_values(i), found_values(0)) << "key " << i;
+    }
+    last_value = found_values(0);
+  }
+  writer.reset();
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -16,10 +16,14 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <array>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
+#include "absl/hash/hash.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
@@ -36,7 +40,198 @@ std::string UniqueNodeName(const std::string& base) {
   return strings::StrCat(base, "/", counter.fetch_add(1), "/", random::New64());
 }
 
-// Lookup table that wraps an unordered_map, where the key and value data type
+// The hash function of the keys of ShardedHashMap.
+template <class K>
+struct ShardedHashMapHash : absl::Hash<K> {};
+
+template <>
+struct ShardedHashMapHash<tstring> {
+  size_t operator()(const tstring& key) const {
+    return static_cast<size_t>(Hash64(key.data(), key.size()));
+  }
+};
+
+// A hash map split into kNumShards open-addressing maps, each guarded by its
+// own mutex, so that threads looking up the keys of different shards do not
+// contend on the same lock. Batched operations group their keys by shard, so
+// that each shard is locked once per batch, and prefetch the slots of the
+// keys ahead of their lookup. A batch holds the locks of all the shards of its
+// keys at once, taken in increasing shard order, so that batches stay atomic
+// with respect to each other.
+template <class K, class V>
+class ShardedHashMap {
+ public:
+  using Map = absl::flat_hash_map<K, V, ShardedHashMapHash<K>>;
+
+  size_t size() const {
+    size_t size = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      size += shard.map.size();
+    }
+    return size;
+  }
+
+  // Returns the number of slots of the shards.
+  size_t capacity() const {
+    size_t capacity = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      capacity += shard.map.capacity();
+    }
+    return capacity;
+  }
+
+  // Calls fn(i, value) for i in [0, n), where value points to the value of
+  // key(i), or is nullptr if key(i) is not in the map. The value must not be
+  // retained after fn returns. The shards of the keys are locked shared for the
+  // whole batch.
+  template <typename KeyFn, typename Fn>
+  void BatchFind(int64_t n, const KeyFn& key, const Fn& fn) const
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    std::vector<int64_t> order;
+    std::array<int64_t, kNumShards + 1> offsets;
+    GroupByShard(n, key, &order, &offsets);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (offsets[s] != offsets[s + 1]) shards_[s].mu.lock_shared();
+    }
+    for (int s = 0; s < kNumShards; ++s) {
+      if (offsets[s] == offsets[s + 1]) continue;
+      const Shard& shard = shards_[s];
+      ForEachPrefetched(shard.map, order, offsets[s], offsets[s + 1], key,
+                        [&](int64_t i, const K& k) {
+                          auto it = shard.map.find(k);
+                          fn(i, it == shard.map.end() ? nullptr : &it->second);
+                        });
+    }
+    for (int s = 0; s < kNumShards; ++s) {
+      if (offsets[s] != offsets[s + 1]) shards_[s].mu.unlock_shared();
+    }
+  }
+
+  // Calls fn(i, key(i), map) for i in [0, n) in increasing order of i among
+  // the keys of each shard, where map is the shard of key(i). The shards of the
+  // keys are locked exclusively for the whole batch, so that readers never see
+  // a partially applied batch.
+  template <typename KeyFn, typename Fn>
+  void BatchUpdate(int64_t n, const KeyFn& key, const Fn& fn)
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    std::vector<int64_t> order;
+    std::array<int64_t, kNumShards + 1> offsets;
+    GroupByShard(n, key, &order, &offsets);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (offsets[s] != offsets[s + 1]) shards_[s].mu.lock();
+    }
+    for (int s = 0; s < kNumShards; ++s) {
+      if (offsets[s] == offsets[s + 1]) continue;
+      Shard& shard = shards_[s];
+      ForEachPrefetched(shard.map, order, offsets[s], offsets[s + 1], key,
+                        [&](int64_t i, const K& k) { fn(i, k, &shard.map); });
+    }
+    for (int s = 0; s < kNumShards; ++s) {
+      if (offsets[s] != offsets[s + 1]) shards_[s].mu.unlock();
+    }
+  }
+
+  // Calls size_fn(size), and if it succeeds, fn(key, value) for each entry,
+  // with all the shards locked shared. Returns the status of size_fn.
+  template <typename SizeFn, typename Fn>
+  Status ForAll(const SizeFn& size_fn, const Fn& fn) const
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (const Shard& shard : shards_) shard.mu.lock_shared();
+    size_t size = 0;
+    for (const Shard& shard : shards_) size += shard.map.size();
+    Status status = size_fn(static_cast<int64_t>(size));
+    if (status.ok()) {
+      for (const Shard& shard : shards_) {
+        for (const auto& entry : shard.map) fn(entry.first, entry.second);
+      }
+    }
+    for (const Shard& shard : shards_) shard.mu.unlock_shared();
+    return status;
+  }
+
+  // Like BatchUpdate(), but clears the map first. All the shards stay locked
+  // exclusively meanwhile, so that readers never see a partial replacement.
+  template <typename KeyFn, typename Fn>
+  void BatchReplace(int64_t n, const KeyFn& key, const Fn& fn)
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    std::vector<int64_t> order;
+    std::array<int64_t, kNumShards + 1> offsets;
+    GroupByShard(n, key, &order, &offsets);
+    for (Shard& shard : shards_) shard.mu.lock();
+    for (int s = 0; s < kNumShards; ++s) {
+      Shard& shard = shards_[s];
+      shard.map.clear();
+      ForEachPrefetched(shard.map, order, offsets[s], offsets[s + 1], key,
+                        [&](int64_t i, const K& k) { fn(i, k, &shard.map); });
+    }
+    for (Shard& shard : shards_) shard.mu.unlock();
+  }
+
+  // Returns the shard of 'key'.
+  static int ShardForKey(const K& key) {
+    // The low bits of the hash select the slots of a key in its shard.
+    return static_cast<uint64>(ShardedHashMapHash<K>()(key)) >>
+           (64 - kNumShardBits);
+  }
+
+ private:
+  static constexpr int kNumShardBits = 4;
+  static constexpr int kNumShards = 1 << kNumShardBits;
+  // How many keys ahead of a lookup the slots of a key are prefetched.
+  static constexpr int64_t kPrefetchDistance = 8;
+
+  struct alignas(64) Shard {
+    mutable mutex mu;
+    Map map TF_GUARDED_BY(mu);
+  };
+
+  // Sorts [0, n) into '*order' by the shard of key(i), keeping the order of
+  // the keys of each shard. The keys of shard s are at positions
+  // [(*offsets)[s], (*offsets)[s + 1]) of '*order'.
+  template <typename KeyFn>
+  static void GroupByShard(int64_t n, const KeyFn& key,
+                           std::vector<int64_t>* order,
+                           std::array<int64_t, kNumShards + 1>* offsets) {
+    std::vector<uint8> shard_of(n);
+    offsets->fill(0);
+    for (int64_t i = 0; i < n; ++i) {
+      shard_of[i] = ShardForKey(key(i));
+      ++(*offsets)[shard_of[i] + 1];
+    }
+    for (int s = 0; s < kNumShards; ++s) {
+      (*offsets)[s + 1] += (*offsets)[s];
+    }
+    std::array<int64_t, kNumShards> next;
+    std::copy(offsets->begin(), offsets->end() - 1, next.begin());
+    order->resize(n);
+    for (int64_t i = 0; i < n; ++i) {
+      (*order)[next[shard_of[i]]++] = i;
+    }
+  }
+
+  template <typename KeyFn, typename Fn>
+  static void ForEachPrefetched(const Map& map,
+                                const std::vector<int64_t>& order,
+                                int64_t begin, int64_t end, const KeyFn& key,
+                                const Fn& fn) {
+    for (int64_t j = begin; j < std::min(begin + kPrefetchDistance, end); ++j) {
+      map.prefetch(key(order[j]));
+    }
+    for (int64_t j = begin; j < end; ++j) {
+      if (j + kPrefetchDistance < end) {
+        map.prefetch(key(order[j + kPrefetchDistance]));
+      }
+      const int64_t i = order[j];
+      fn(i, key(i));
+    }
+  }
+
+  std::array<Shard, kNumShards> shards_;
+};
+
+// Lookup table that wraps a ShardedHashMap, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
 //
@@ -55,10 +250,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
  public:
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -70,18 +262,23 @@ class MutableHashTableOfScalars final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      // is_full_size_default is true:
-      //   Each key has an independent default value, key_values(i)
-      //   corresponding uses default_flat(i) as its default value.
-      //
-      // is_full_size_default is false:
-      //   All keys will share the default_flat(0) as default value.
-      value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)),
-          is_full_size_default ? default_flat(i) : default_flat(0));
-    }
+    table_.BatchFind(
+        key_values.size(),
+        [&](int64_t i) -> decltype(auto) {
+          return SubtleMustCopyIfIntegral(key_values(i));
+        },
+        [&](int64_t i, const V* found) {
+          // is_full_size_default is true:
+          //   Each key has an independent default value, key_values(i)
+          //   corresponding uses default_flat(i) as its default value.
+          //
+          // is_full_size_default is false:
+          //   All keys will share the default_flat(0) as default value.
+          value_values(i) =
+              found != nullptr
+                  ? *found
+                  : (is_full_size_default ? default_flat(i) : default_flat(0));
+        });
 
     return OkStatus();
   }
@@ -90,13 +287,16 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
+    auto insert = [&](int64_t i, const K& key, typename Table::Map* map) {
+      gtl::InsertOrUpdate(map, key, SubtleMustCopyIfIntegral(value_values(i)));
+    };
+    auto key = [&](int64_t i) -> decltype(auto) {
+      return SubtleMustCopyIfIntegral(key_values(i));
+    };
     if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          SubtleMustCopyIfIntegral(value_values(i)));
+      table_.BatchReplace(key_values.size(), key, insert);
+    } else {
+      table_.BatchUpdate(key_values.size(), key, insert);
     }
     return OkStatus();
   }
@@ -109,10 +309,14 @@ class MutableHashTableOfScalars final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.BatchUpdate(
+        key_values.size(),
+        [&](int64_t i) -> decltype(auto) {
+          return SubtleMustCopyIfIntegral(key_values(i));
+        },
+        [](int64_t i, const K& key, typename Table::Map* map) {
+          map->erase(key);
+        });
     return OkStatus();
   }
 
@@ -122,17 +326,17 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-
     Tensor* keys;
     Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("values", TensorShape({size}), &values));
-    ExportKeysAndValues(keys, values);
-    return OkStatus();
+    return ExportKeysAndValues(
+        [&](int64_t size) {
+          TF_RETURN_IF_ERROR(
+              ctx->allocate_output("keys", TensorShape({size}), &keys));
+          TF_RETURN_IF_ERROR(
+              ctx->allocate_output("values", TensorShape({size}), &values));
+          return OkStatus();
+        },
+        &keys, &values);
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -144,25 +348,21 @@ class MutableHashTableOfScalars final : public LookupInterface {
   TensorShape value_shape() const override { return TensorShape(); }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfScalars) + ret;
+    return sizeof(MutableHashTableOfScalars) + table_.capacity();
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys;
+    Tensor values;
+    Tensor* keys_ptr = &keys;
+    Tensor* values_ptr = &values;
+    TF_RETURN_IF_ERROR(ExportKeysAndValues(
+        [&](int64_t size) {
+          keys = Tensor(key_dtype(), TensorShape({size}));
+          values = Tensor(value_dtype(), TensorShape({size}));
+          return OkStatus();
+        },
+        &keys_ptr, &values_ptr));
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableV2 kernel. This means that the lifetime
@@ -195,24 +395,33 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
  private:
-  // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
-    auto keys_data = keys->flat<K>();
-    auto values_data = values->flat<V>();
-    int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
-    }
+  using Table = ShardedHashMap<K, V>;
+
+  // Calls allocate(size) with the size of the table, which must point `*keys`
+  // and `*values` to tensors of that size, and writes all keys and values
+  // into them.
+  template <typename AllocateFn>
+  Status ExportKeysAndValues(const AllocateFn& allocate, Tensor** keys,
+                             Tensor** values) const {
+    K* keys_data = nullptr;
+    V* values_data = nullptr;
+    return table_.ForAll(
+        [&](int64_t size) {
+          TF_RETURN_IF_ERROR(allocate(size));
+          keys_data = (*keys)->flat<K>().data();
+          values_data = (*values)->flat<V>().data();
+          return OkStatus();
+        },
+        [&](const K& key, const V& value) {
+          *keys_data++ = key;
+          *values_data++ = value;
+        });
   }
 
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
+  Table table_;
 };
 
-// Lookup table that wraps an unordered_map. Behaves identical to
+// Lookup table that wraps a ShardedHashMap. Behaves identical to
 // MutableHashTableOfScalars except that each value must be a vector.
 template <class K, class V>
 class MutableHashTableOfTensors final : public LookupInterface {
@@ -226,10 +435,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
                                 value_shape_.DebugString()));
   }
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -242,27 +448,29 @@ class MutableHashTableOfTensors final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec =
-          gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
-      if (value_vec != nullptr) {
-        for (int64_t j = 0; j < value_dim; j++) {
-          value_values(i, j) = value_vec->at(j);
-        }
-      } else {
-        // is_full_size_default is true:
-        //   Each key has an independent default value, key_values(i)
-        //   corresponding uses default_flat(i) as its default value.
-        //
-        // is_full_size_default is false:
-        //   All keys will share the default_flat(0) as default value.
-        for (int64_t j = 0; j < value_dim; j++) {
-          value_values(i, j) =
-              is_full_size_default ? default_flat(i, j) : default_flat(0, j);
-        }
-      }
-    }
+    table_.BatchFind(
+        key_values.size(),
+        [&](int64_t i) -> decltype(auto) {
+          return SubtleMustCopyIfIntegral(key_values(i));
+        },
+        [&](int64_t i, const ValueArray* value_vec) {
+          if (value_vec != nullptr) {
+            for (int64_t j = 0; j < value_dim; j++) {
+              value_values(i, j) = value_vec->at(j);
+            }
+          } else {
+            // is_full_size_default is true:
+            //   Each key has an independent default value, key_values(i)
+            //   corresponding uses default_flat(i) as its default value.
+            //
+            // is_full_size_default is false:
+            //   All keys will share the default_flat(0) as default value.
+            for (int64_t j = 0; j < value_dim; j++) {
+              value_values(i, j) = is_full_size_default ? default_flat(i, j)
+                                                        : default_flat(0, j);
+            }
+          }
+        });
 
     return OkStatus();
   }
@@ -272,18 +480,21 @@ class MutableHashTableOfTensors final : public LookupInterface {
     const auto value_values = values.flat_inner_dims<V, 2>();
     int64_t value_dim = value_shape_.dim_size(0);
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
+    auto insert = [&](int64_t i, const K& key, typename Table::Map* map) {
       ValueArray value_vec;
       for (int64_t j = 0; j < value_dim; j++) {
         V value = value_values(i, j);
         value_vec.push_back(value);
       }
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          value_vec);
+      gtl::InsertOrUpdate(map, key, value_vec);
+    };
+    auto key = [&](int64_t i) -> decltype(auto) {
+      return SubtleMustCopyIfIntegral(key_values(i));
+    };
+    if (clear) {
+      table_.BatchReplace(key_values.size(), key, insert);
+    } else {
+      table_.BatchUpdate(key_values.size(), key, insert);
     }
     return OkStatus();
   }
@@ -296,10 +507,14 @@ class MutableHashTableOfTensors final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.BatchUpdate(
+        key_values.size(),
+        [&](int64_t i) -> decltype(auto) {
+          return SubtleMustCopyIfIntegral(key_values(i));
+        },
+        [](int64_t i, const K& key, typename Table::Map* map) {
+          map->erase(key);
+        });
     return OkStatus();
   }
 
@@ -309,18 +524,19 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
     int64_t value_dim = value_shape_.dim_size(0);
 
     Tensor* keys;
     Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(ctx->allocate_output(
-        "values", TensorShape({size, value_dim}), &values));
-    ExportKeysAndValues(keys, values);
-    return OkStatus();
+    return ExportKeysAndValues(
+        [&](int64_t size) {
+          TF_RETURN_IF_ERROR(
+              ctx->allocate_output("keys", TensorShape({size}), &keys));
+          TF_RETURN_IF_ERROR(ctx->allocate_output(
+              "values", TensorShape({size, value_dim}), &values));
+          return OkStatus();
+        },
+        &keys, &values);
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -332,25 +548,22 @@ class MutableHashTableOfTensors final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfTensors) + ret;
+    return sizeof(MutableHashTableOfTensors) + table_.capacity();
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys;
+    Tensor values;
+    Tensor* keys_ptr = &keys;
+    Tensor* values_ptr = &values;
+    TF_RETURN_IF_ERROR(ExportKeysAndValues(
+        [&](int64_t size) {
+          keys = Tensor(key_dtype(), TensorShape({size}));
+          values = Tensor(value_dtype(),
+                          TensorShape({size, value_shape_.dim_size(0)}));
+          return OkStatus();
+        },
+        &keys_ptr, &values_ptr));
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableOfTensorsV2 kernel. This means that the
@@ -384,28 +597,35 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
  private:
-  // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  typedef gtl::InlinedVector<V, 4> ValueArray;
+  using Table = ShardedHashMap<K, ValueArray>;
+
+  // Calls allocate(size) with the size of the table, which must point `*keys`
+  // and `*values` to tensors of `size` keys and values, and writes all keys
+  // and values into them.
+  template <typename AllocateFn>
+  Status ExportKeysAndValues(const AllocateFn& allocate, Tensor** keys,
+                             Tensor** values) const {
     int64_t value_dim = value_shape_.dim_size(0);
-    auto keys_data = keys->flat<K>();
-    auto values_data = values->matrix<V>();
-    int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      K key = it->first;
-      ValueArray value = it->second;
-      keys_data(i) = key;
-      for (int64_t j = 0; j < value_dim; j++) {
-        values_data(i, j) = value[j];
-      }
-    }
+    K* keys_data = nullptr;
+    V* values_data = nullptr;
+    return table_.ForAll(
+        [&](int64_t size) {
+          TF_RETURN_IF_ERROR(allocate(size));
+          keys_data = (*keys)->flat<K>().data();
+          values_data = (*values)->flat<V>().data();
+          return OkStatus();
+        },
+        [&](const K& key, const ValueArray& value) {
+          *keys_data++ = key;
+          for (int64_t j = 0; j < value_dim; j++) {
+            *values_data++ = value[j];
+          }
+        });
   }
 
   TensorShape value_shape_;
-  mutable mutex mu_;
-  typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ TF_GUARDED_BY(mu_);
+  Table table_;
 };
 
 namespace {
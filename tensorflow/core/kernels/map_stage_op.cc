@@ -98,6 +98,9 @@ class StagingMap : public ResourceBase {
   std::size_t capacity_ TF_GUARDED_BY(mu_);
   std::size_t memory_limit_ TF_GUARDED_BY(mu_);
   std::size_t current_bytes_ TF_GUARDED_BY(mu_);
+  // Number of threads blocked waiting for space, and for data, respectively.
+  std::size_t waiting_inserters_ TF_GUARDED_BY(mu_) = 0;
+  std::size_t waiting_removers_ TF_GUARDED_BY(mu_) = 0;
   tensorflow::mutex mu_;
   tensorflow::condition_variable not_empty_;
   tensorflow::condition_variable full_;
@@ -110,7 +113,7 @@ class StagingMap : public ResourceBase {
   // If map is configured for bounded capacity, notify
   // waiting inserters that space is now available
   void notify_inserters_if_bounded() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    if (has_capacity() || has_memory_limit()) {
+    if ((has_capacity() || has_memory_limit()) && waiting_inserters_ > 0) {
       // Notify all inserters. The removal of an element
       // may make memory available for many inserters
       // to insert new elements
@@ -120,11 +123,28 @@ class StagingMap : public ResourceBase {
 
   // Notify all removers waiting to extract values
   // that data is now available
-  void notify_removers() {
+  void notify_removers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     // Notify all removers. This is because they are
     // waiting for specific keys to appear in the map
     // so we don't know which one to wake up.
-    not_empty_.notify_all();
+    if (waiting_removers_ > 0) not_empty_.notify_all();
+  }
+
+  // Waits for a removal, keeping count of the waiting inserters so that
+  // removals only wake them when there are some.
+  void wait_for_space(tensorflow::mutex_lock* lock)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    ++waiting_inserters_;
+    full_.wait(*lock);
+    --waiting_inserters_;
+  }
+
+  // Waits for an insertion, as `wait_for_space`.
+  void wait_for_data(tensorflow::mutex_lock* lock)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    ++waiting_removers_;
+    not_empty_.wait(*lock);
+    --waiting_removers_;
   }
 
   bool has_capacity() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -268,7 +288,7 @@ class StagingMap : public ResourceBase {
 
     // Wait until we don't exceed the memory limit
     while (would_exceed_memory_limit(tuple_bytes)) {
-      full_.wait(*lock);
+      wait_for_space(lock);
     }
 
     // This key isn't present in the incomplete set
@@ -367,7 +387,7 @@ class StagingMap : public ResourceBase {
 
     // Wait until there's space for insertion.
     while (would_exceed_memory_limit(tuple_bytes) || is_capacity_full()) {
-      full_.wait(lock);
+      wait_for_space(&lock);
     }
 
     // Do the put operation
@@ -389,7 +409,7 @@ class StagingMap : public ResourceBase {
 
     // Wait until the element with the requested key is present
     while ((it = map_.find(*key)) == map_.end()) {
-      not_empty_.wait(lock);
+      wait_for_data(&lock);
     }
 
     TF_RETURN_IF_ERROR(
@@ -411,7 +431,7 @@ class StagingMap : public ResourceBase {
 
     // Wait until the element with the requested key is present
     while ((it = map_.find(*key)) == map_.end()) {
-      not_empty_.wait(lock);
+      wait_for_data(&lock);
     }
 
     TF_RETURN_IF_ERROR(
@@ -440,7 +460,7 @@ class StagingMap : public ResourceBase {
 
     // Wait until map is not empty
     while (this->map_.empty()) {
-      not_empty_.wait(lock);
+      wait_for_data(&lock);
     }
 
     // Move from the first element and erase it
@@ -0,0 +1,237 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/perfect_hash_table_op.h"
+
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/lookup_table_op.h"
+#include "tensorflow/core/kernels/lookup_util.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace lookup {
+
+Status PerfectHashTable::InitializeFromFile(
+    Env* env, const std::string& filename,
+    std::unique_ptr<InitializerSerializer> serializer) {
+  if (is_initialized()) {
+    if (filename_ == filename) return OkStatus();
+    return errors::FailedPrecondition(
+        "Table was already initialized with different data.");
+  }
+  return InitializeWith(
+      [this, env, &filename]() {
+        TF_RETURN_IF_ERROR(
+            PerfectHashVocabulary::FromFile(env, filename, &vocabulary_));
+        filename_ = filename;
+        return OkStatus();
+      },
+      std::move(serializer));
+}
+
+Status PerfectHashTable::AsGraphDef(GraphDefBuilder* builder,
+                                    Node** out) const {
+  // Like HashTable, use node name sharing with a unique node name so that the
+  // resource can outlive the PerfectHashTable kernel.
+  Node* table_node = ops::SourceOp(
+      "PerfectHashTable",
+      builder->opts()
+          .WithName(UniqueNodeName("PerfectHashTableFromGraphDef"))
+          .WithAttr("use_node_name_sharing", true));
+  if (size() == 0) {
+    *out = table_node;
+    return OkStatus();
+  }
+
+  if (initializer_serializer_ == nullptr) {
+    std::string message =
+        "Failed to serialize lookup table: no initialization function was "
+        "specified. Falling back to serializing a handle to the table.";
+    LOG(WARNING) << message;
+    return errors::Unimplemented(message);
+  }
+  Node* initializer;
+  TF_RETURN_IF_ERROR(
+      initializer_serializer_->AsGraphDef(builder, table_node, &initializer));
+  *out = ops::UnaryOp("Identity", table_node,
+                      builder->opts().WithControlInput(initializer));
+  return OkStatus();
+}
+
+size_t PerfectHashTable::size() const {
+  if (!is_initialized()) return 0;
+  return vocabulary_->size();
+}
+
+Status PerfectHashTable::ExportValues(OpKernelContext* context) {
+  if (!is_initialized()) {
+    return errors::Aborted("PerfectHashTable is not initialized.");
+  }
+
+  const int64_t size = vocabulary_->size();
+
+  Tensor* keys;
+  Tensor* values;
+  TF_RETURN_IF_ERROR(
+      context->allocate_output("keys", TensorShape({size}), &keys));
+  TF_RETURN_IF_ERROR(
+      context->allocate_output("values", TensorShape({size}), &values));
+
+  auto keys_data = keys->flat<tstring>();
+  auto values_data = values->flat<int64_t>();
+  for (int64_t i = 0; i < size; ++i) {
+    keys_data(i) = tstring(vocabulary_->key(i));
+    values_data(i) = vocabulary_->value(i);
+  }
+  return OkStatus();
+}
+
+int64_t PerfectHashTable::MemoryUsed() const {
+  if (!is_initialized()) return 0;
+  return vocabulary_->MemoryUsed();
+}
+
+Status PerfectHashTable::DoPrepare(size_t size) {
+  if (is_initialized()) {
+    return errors::Aborted("PerfectHashTable already initialized.");
+  }
+  if (size > 0) {
+    pending_.reserve(size);
+  }
+  return OkStatus();
+}
+
+Status PerfectHashTable::DoInsert(const Tensor& keys, const Tensor& values) {
+  const auto key_values = keys.flat<tstring>();
+  const auto value_values = values.flat<int64_t>();
+  for (int64_t i = 0; i < key_values.size(); ++i) {
+    const int64_t value = SubtleMustCopyIfIntegral(value_values(i));
+    auto result = pending_.try_emplace(key_values(i), value);
+    if (!result.second && result.first->second != value) {
+      return errors::FailedPrecondition(
+          "PerfectHashTable has different value for same key. Key ",
+          key_values(i), " has ", result.first->second,
+          " and trying to add value ", value);
+    }
+  }
+  return OkStatus();
+}
+
+Status PerfectHashTable::DoFinalize() {
+  std::vector<absl::string_view> keys;
+  std::vector<int64_t> values;
+  keys.reserve(pending_.size());
+  values.reserve(pending_.size());
+  for (const auto& it : pending_) {
+    keys.push_back(it.first);
+    values.push_back(it.second);
+  }
+  std::string data;
+  TF_RETURN_IF_ERROR(PerfectHashVocabulary::Build(keys, values, &data));
+  TF_RETURN_IF_ERROR(
+      PerfectHashVocabulary::FromString(std::move(data), &vocabulary_));
+  pending_ = absl::flat_hash_map<tstring, int64_t>();
+  return OkStatus();
+}
+
+Status PerfectHashTable::DoFind(const Tensor& keys, Tensor* values,
+                                const Tensor& default_value) {
+  const int64_t num_keys = keys.NumElements();
+  vocabulary_->Find(
+      absl::MakeConstSpan(keys.flat<tstring>().data(), num_keys),
+      default_value.flat<int64_t>()(0),
+      absl::MakeSpan(values->flat<int64_t>().data(), num_keys));
+  return OkStatus();
+}
+
+}  // namespace lookup
+
+REGISTER_KERNEL_BUILDER(
+    Name("PerfectHashTable").Device(DEVICE_CPU),
+    LookupTableOp<lookup::PerfectHashTable, tstring, int64_t>);
+
+// Kernel to initialize a PerfectHashTable from a prebuilt vocabulary file.
+//
+// After this operation, the table becomes read-only.
+class InitializeTableFromPerfectHashFileOp : public OpKernel {
+ public:
+  explicit InitializeTableFromPerfectHashFileOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    lookup::InitializableLookupTable* table;
+    OP_REQUIRES_OK(ctx,
+                   GetInitializableLookupTable("table_handle", ctx, &table));
+    core::ScopedUnref unref_me(table);
+    auto* perfect_hash_table = dynamic_cast<lookup::PerfectHashTable*>(table);
+    OP_REQUIRES(ctx, perfect_hash_table != nullptr,
+                errors::InvalidArgument(
+                    "InitializeTableFromPerfectHashFile requires a "
+                    "PerfectHashTable."));
+
+    const Tensor& filename_tensor = ctx->input(1);
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsScalar(filename_tensor.shape()),
+        errors::InvalidArgument("filename should be a single string, but got ",
+                                filename_tensor.shape().DebugString()));
+    const string& filename = filename_tensor.scalar<tstring>()();
+    OP_REQUIRES(ctx, !filename.empty(),
+                errors::InvalidArgument("filename cannot be empty."));
+
+    int64_t memory_used_before = 0;
+    if (ctx->track_allocations()) {
+      memory_used_before = table->MemoryUsed();
+    }
+    OP_REQUIRES_OK(ctx, perfect_hash_table->InitializeFromFile(
+                            ctx->env(), filename,
+                            MakeInitializerSerializer(filename_tensor)));
+    if (ctx->track_allocations()) {
+      ctx->record_persistent_memory_allocation(table->MemoryUsed() -
+                                               memory_used_before);
+    }
+  }
+
+ private:
+  std::unique_ptr<lookup::InitializableLookupTable::InitializerSerializer>
+  MakeInitializerSerializer(Tensor filename) {
+    return std::make_unique<
+        lookup::InitializableLookupTable::InitializerSerializer>(
+        [filename](GraphDefBuilder* builder, Node* table, Node** out) {
+          Node* filename_node =
+              ops::SourceOp("Const", builder->opts()
+                                         .WithAttr("dtype", filename.dtype())
+                                         .WithAttr("value", filename));
+          Node* import_table =
+              ops::BinaryOp("InitializeTableFromPerfectHashFile", table,
+                            filename_node, builder->opts());
+          *out = ops::UnaryOp("Identity", table,
+                              builder->opts().WithControlInput(import_table));
+          return OkStatus();
+        });
+  }
+
+  TF_DISALLOW_COPY_AND_ASSIGN(InitializeTableFromPerfectHashFileOp);
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("InitializeTableFromPerfectHashFile").Device(DEVICE_CPU),
+    InitializeTableFromPerfectHashFileOp);
+
+}  // namespace tensorflow
@@ -0,0 +1,86 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_PERFECT_HASH_TABLE_OP_H_
+#define TENSORFLOW_CORE_KERNELS_PERFECT_HASH_TABLE_OP_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/kernels/perfect_hash_vocabulary.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace lookup {
+
+// Immutable string -> int64 lookup table backed by a PerfectHashVocabulary.
+//
+// The table is either initialized like a HashTable, in which case the perfect
+// hash is built once all the elements have been inserted, or by memory mapping
+// a vocabulary file prebuilt with `WritePerfectHashVocabularyFile`, which
+// neither parses nor copies the file.
+class PerfectHashTable final : public InitializableLookupTable {
+ public:
+  PerfectHashTable(OpKernelContext* ctx, OpKernel* kernel) {}
+
+  // Initializes the table from a vocabulary file. Initializing an initialized
+  // table again from the same file is a no-op.
+  Status InitializeFromFile(Env* env, const std::string& filename,
+                            std::unique_ptr<InitializerSerializer> serializer);
+
+  Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override;
+
+  size_t size() const override;
+
+  Status ExportValues(OpKernelContext* context) override;
+
+  DataType key_dtype() const override { return DT_STRING; }
+
+  DataType value_dtype() const override { return DT_INT64; }
+
+  int64_t MemoryUsed() const override;
+
+ protected:
+  Status DoPrepare(size_t size) override;
+
+  Status DoLazyPrepare(std::function<int64(void)> size_fn) override {
+    return DoPrepare(size_fn());
+  }
+
+  Status DoInsert(const Tensor& keys, const Tensor& values) override;
+
+  Status DoFinalize() override;
+
+  Status DoFind(const Tensor& keys, Tensor* values,
+                const Tensor& default_value) override;
+
+ private:
+  // Elements inserted while the table is being initialized. Cleared once the
+  // vocabulary is built from them.
+  absl::flat_hash_map<tstring, int64_t> pending_;
+  std::unique_ptr<PerfectHashVocabulary> vocabulary_;
+  // The file the vocabulary was loaded from, if any.
+  std::string filename_;
+};
+
+}  // namespace lookup
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_PERFECT_HASH_TABLE_OP_H_
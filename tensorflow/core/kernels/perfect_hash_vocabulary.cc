@@ -0,0 +1,401 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/perfect_hash_vocabulary.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/platform/prefetch.h"
+#include "tensorflow/core/util/presized_cuckoo_map.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+using presized_cuckoo_map::multiply_high_u64;
+
+// The serialized vocabulary is the header followed by
+//   uint32 pilots[num_buckets], padded to a multiple of 8 bytes,
+//   uint64 offsets[num_keys + 1], where the key in slot `i` is
+//     keys[offsets[i], offsets[i + 1]),
+//   int64 values[num_keys],
+//   char keys[key_bytes].
+struct Header {
+  uint64 magic;
+  uint64 num_keys;
+  uint64 num_buckets;
+  uint64 seed;
+  uint64 key_bytes;
+};
+
+// The low byte is the format version.
+constexpr uint64 kMagic = 0x5446504856000001ULL;
+
+// A pilot with this bit set stores the slot of the single key of its bucket
+// directly, instead of a displacement to hash the keys of the bucket with.
+constexpr uint32 kDirectSlot = 1u << 31;
+
+// Number of pilots tried for a bucket before giving up on the seed.
+constexpr uint32 kMaxPilotSearch = 1u << 20;
+
+// Number of seeds tried before giving up building the vocabulary.
+constexpr int kMaxSeedAttempts = 16;
+
+constexpr uint64 kSeedBase = 0x9ae16a3b2f90404fULL;
+
+// Number of keys whose lookups are interleaved by the batched `Find`.
+constexpr int kLookupBlockSize = 16;
+
+uint64 NumBuckets(uint64 num_keys) {
+  return (num_keys + PerfectHashVocabulary::kKeysPerBucket - 1) /
+         PerfectHashVocabulary::kKeysPerBucket;
+}
+
+uint64 PaddedPilotBytes(uint64 num_buckets) {
+  return (num_buckets + 1) / 2 * 2 * sizeof(uint32);
+}
+
+uint64 Bucket(uint64 hash, uint64 num_buckets) {
+  return multiply_high_u64(hash, num_buckets);
+}
+
+// Mixes the pilot into the key hash with the 64-bit finalizer of MurmurHash3.
+uint64 SlotForPilot(uint64 hash, uint32 pilot, uint64 num_slots) {
+  uint64 x = hash ^ (pilot * 0x9e3779b97f4a7c15ULL);
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return multiply_high_u64(x, num_slots);
+}
+
+// Places every key in its own slot with the hash seed `seed`. Sets `*placed`
+// to false if the seed does not work and another one has to be tried.
+Status PlaceKeys(absl::Span<const absl::string_view> keys, uint64 seed,
+                 std::vector<uint32>* pilots, std::vector<uint64>* slot_to_key,
+                 bool* placed) {
+  const uint64 num_keys = keys.size();
+  const uint64 num_buckets = pilots->size();
+  std::vector<uint64> hashes(num_keys);
+  std::vector<uint64> bucket_start(num_buckets + 1, 0);
+  for (uint64 i = 0; i < num_keys; ++i) {
+    hashes[i] = Hash64(keys[i].data(), keys[i].size(), seed);
+    ++bucket_start[Bucket(hashes[i], num_buckets) + 1];
+  }
+  std::partial_sum(bucket_start.begin(), bucket_start.end(),
+                   bucket_start.begin());
+  std::vector<uint64> bucket_keys(num_keys);
+  {
+    std::vector<uint64> next(bucket_start.begin(), bucket_start.end() - 1);
+    for (uint64 i = 0; i < num_keys; ++i) {
+      bucket_keys[next[Bucket(hashes[i], num_buckets)]++] = i;
+    }
+  }
+
+  // Keys with the same hash cannot be told apart by any pilot.
+  for (uint64 b = 0; b < num_buckets; ++b) {
+    auto begin = bucket_keys.begin() + bucket_start[b];
+    auto end = bucket_keys.begin() + bucket_start[b + 1];
+    std::sort(begin, end,
+              [&](uint64 x, uint64 y) { return hashes[x] < hashes[y]; });
+    for (auto it = begin; end - it > 1; ++it) {
+      if (hashes[*it] != hashes[*(it + 1)]) continue;
+      if (keys[*it] == keys[*(it + 1)]) {
+        return errors::InvalidArgument("Duplicate vocabulary key: ",
+                                       keys[*it]);
+      }
+      *placed = false;
+      return OkStatus();
+    }
+  }
+
+  // Place the largest buckets first, while most slots are still free.
+  std::vector<uint64> buckets(num_buckets);
+  std::iota(buckets.begin(), buckets.end(), 0);
+  auto bucket_size = [&](uint64 b) {
+    return bucket_start[b + 1] - bucket_start[b];
+  };
+  std::stable_sort(buckets.begin(), buckets.end(), [&](uint64 x, uint64 y) {
+    return bucket_size(x) > bucket_size(y);
+  });
+
+  std::vector<bool> taken(num_keys, false);
+  std::vector<uint64> slots;
+  uint64 next_free_slot = 0;
+  for (uint64 b : buckets) {
+    const uint64 size = bucket_size(b);
+    if (size == 0) break;
+    absl::Span<const uint64> members(bucket_keys.data() + bucket_start[b],
+                                     size);
+    if (size == 1) {
+      // Only single-key buckets are left, so the free slots are handed out
+      // directly and no search is needed.
+      while (taken[next_free_slot]) ++next_free_slot;
+      taken[next_free_slot] = true;
+      (*slot_to_key)[next_free_slot] = members[0];
+      (*pilots)[b] = kDirectSlot | static_cast<uint32>(next_free_slot);
+      continue;
+    }
+    uint32 pilot = 0;
+    for (;; ++pilot) {
+      if (pilot == kMaxPilotSearch) {
+        *placed = false;
+        return OkStatus();
+      }
+      slots.clear();
+      for (uint64 key : members) {
+        uint64 slot = SlotForPilot(hashes[key], pilot, num_keys);
+        if (taken[slot] ||
+            std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+          break;
+        }
+        slots.push_back(slot);
+      }
+      if (slots.size() == size) break;
+    }
+    for (uint64 i = 0; i < size; ++i) {
+      taken[slots[i]] = true;
+      (*slot_to_key)[slots[i]] = members[i];
+    }
+    (*pilots)[b] = pilot;
+  }
+  *placed = true;
+  return OkStatus();
+}
+
+}  // namespace
+
+Status PerfectHashVocabulary::Build(absl::Span<const absl::string_view> keys,
+                                    absl::Span<const int64_t> values,
+                                    std::string* output) {
+  if (keys.size() != values.size()) {
+    return errors::InvalidArgument(
+        "Keys and values must have the same size: ", keys.size(), " vs ",
+        values.size());
+  }
+  const uint64 num_keys = keys.size();
+  if (num_keys >= kDirectSlot) {
+    return errors::InvalidArgument("Too many vocabulary keys: ", num_keys);
+  }
+  const uint64 num_buckets = NumBuckets(num_keys);
+  std::vector<uint32> pilots(num_buckets);
+  std::vector<uint64> slot_to_key(num_keys);
+  uint64 seed = kSeedBase;
+  bool placed = false;
+  for (int attempt = 0; attempt < kMaxSeedAttempts && !placed; ++attempt) {
+    seed = Hash64Combine(kSeedBase, attempt);
+    TF_RETURN_IF_ERROR(PlaceKeys(keys, seed, &pilots, &slot_to_key, &placed));
+  }
+  if (!placed) {
+    return errors::Internal("Failed to build a perfect hash for ", num_keys,
+                            " keys.");
+  }
+
+  Header header;
+  header.magic = kMagic;
+  header.num_keys = num_keys;
+  header.num_buckets = num_buckets;
+  header.seed = seed;
+  header.key_bytes = 0;
+  std::vector<uint64> offsets(num_keys + 1);
+  std::vector<int64_t> slot_values(num_keys);
+  for (uint64 slot = 0; slot < num_keys; ++slot) {
+    offsets[slot] = header.key_bytes;
+    header.key_bytes += keys[slot_to_key[slot]].size();
+    slot_values[slot] = values[slot_to_key[slot]];
+  }
+  offsets[num_keys] = header.key_bytes;
+
+  const uint64 pilot_bytes = PaddedPilotBytes(num_buckets);
+  output->clear();
+  output->resize(sizeof(Header) + pilot_bytes +
+                 offsets.size() * sizeof(uint64) +
+                 slot_values.size() * sizeof(int64_t) + header.key_bytes);
+  char* out = &(*output)[0];
+  std::memcpy(out, &header, sizeof(Header));
+  out += sizeof(Header);
+  std::memcpy(out, pilots.data(), pilots.size() * sizeof(uint32));
+  out += pilot_bytes;
+  std::memcpy(out, offsets.data(), offsets.size() * sizeof(uint64));
+  out += offsets.size() * sizeof(uint64);
+  std::memcpy(out, slot_values.data(), slot_values.size() * sizeof(int64_t));
+  out += slot_values.size() * sizeof(int64_t);
+  for (uint64 slot = 0; slot < num_keys; ++slot) {
+    const absl::string_view key = keys[slot_to_key[slot]];
+    std::memcpy(out, key.data(), key.size());
+    out += key.size();
+  }
+  return OkStatus();
+}
+
+Status PerfectHashVocabulary::FromString(
+    std::string data, std::unique_ptr<PerfectHashVocabulary>* output) {
+  std::unique_ptr<PerfectHashVocabulary> vocabulary(new PerfectHashVocabulary);
+  vocabulary->owned_data_ = std::move(data);
+  TF_RETURN_IF_ERROR(vocabulary->Init(vocabulary->owned_data_));
+  *output = std::move(vocabulary);
+  return OkStatus();
+}
+
+Status PerfectHashVocabulary::FromFile(
+    Env* env, const std::string& filename,
+    std::unique_ptr<PerfectHashVocabulary>* output) {
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  Status s = env->NewReadOnlyMemoryRegionFromFile(filename, &region);
+  if (errors::IsUnimplemented(s)) {
+    // The file system cannot memory map files, read the file instead.
+    std::string data;
+    TF_RETURN_IF_ERROR(ReadFileToString(env, filename, &data));
+    return FromString(std::move(data), output);
+  }
+  TF_RETURN_IF_ERROR(s);
+  std::unique_ptr<PerfectHashVocabulary> vocabulary(new PerfectHashVocabulary);
+  absl::string_view data(static_cast<const char*>(region->data()),
+                         region->length());
+  vocabulary->region_ = std::move(region);
+  TF_RETURN_IF_ERROR(vocabulary->Init(data));
+  *output = std::move(vocabulary);
+  return OkStatus();
+}
+
+Status PerfectHashVocabulary::Init(absl::string_view data) {
+  if (reinterpret_cast<uintptr_t>(data.data()) % alignof(uint64) != 0) {
+    return errors::InvalidArgument(
+        "Perfect hash vocabulary data must be 8-byte aligned.");
+  }
+  Header header;
+  if (data.size() < sizeof(Header)) {
+    return errors::DataLoss("Perfect hash vocabulary is truncated.");
+  }
+  std::memcpy(&header, data.data(), sizeof(Header));
+  if (header.magic != kMagic) {
+    return errors::DataLoss(
+        "Not a perfect hash vocabulary, or it was built on a host with a "
+        "different byte order.");
+  }
+  if (header.num_keys >= kDirectSlot ||
+      header.num_buckets != NumBuckets(header.num_keys) ||
+      header.key_bytes > data.size()) {
+    return errors::DataLoss("Invalid perfect hash vocabulary header.");
+  }
+  const uint64 pilot_bytes = PaddedPilotBytes(header.num_buckets);
+  const uint64 offset_bytes = (header.num_keys + 1) * sizeof(uint64);
+  const uint64 value_bytes = header.num_keys * sizeof(int64_t);
+  if (data.size() != sizeof(Header) + pilot_bytes + offset_bytes +
+                         value_bytes + header.key_bytes) {
+    return errors::DataLoss("Perfect hash vocabulary has size ", data.size(),
+                            " but its header describes a different size.");
+  }
+
+  data_ = data;
+  num_keys_ = header.num_keys;
+  num_buckets_ = header.num_buckets;
+  seed_ = header.seed;
+  key_bytes_ = header.key_bytes;
+  const char* p = data.data() + sizeof(Header);
+  pilots_ = reinterpret_cast<const uint32*>(p);
+  p += pilot_bytes;
+  offsets_ = reinterpret_cast<const uint64*>(p);
+  p += offset_bytes;
+  values_ = reinterpret_cast<const int64_t*>(p);
+  p += value_bytes;
+  keys_ = p;
+  if (offsets_[0] != 0 || offsets_[num_keys_] != key_bytes_) {
+    return errors::DataLoss("Invalid perfect hash vocabulary key offsets.");
+  }
+  return OkStatus();
+}
+
+absl::string_view PerfectHashVocabulary::key(int64_t i) const {
+  // The offsets are not all validated when the vocabulary is loaded, so that
+  // loading a memory mapped file does not touch all of it.
+  const uint64 begin = offsets_[i];
+  const uint64 end = offsets_[i + 1];
+  if (begin > end || end > key_bytes_) return absl::string_view();
+  return absl::string_view(keys_ + begin, end - begin);
+}
+
+uint64 PerfectHashVocabulary::Slot(uint64 hash) const {
+  const uint32 pilot = pilots_[Bucket(hash, num_buckets_)];
+  if (pilot & kDirectSlot) return pilot & ~kDirectSlot;
+  return SlotForPilot(hash, pilot, num_keys_);
+}
+
+int64_t PerfectHashVocabulary::ValueIfMatches(uint64 slot,
+                                              absl::string_view key,
+                                              int64_t default_value) const {
+  if (slot >= num_keys_ || this->key(slot) != key) return default_value;
+  return values_[slot];
+}
+
+int64_t PerfectHashVocabulary::Find(absl::string_view key,
+                                    int64_t default_value) const {
+  if (num_keys_ == 0) return default_value;
+  return ValueIfMatches(Slot(Hash64(key.data(), key.size(), seed_)), key,
+                        default_value);
+}
+
+void PerfectHashVocabulary::Find(absl::Span<const tstring> keys,
+                                 int64_t default_value,
+                                 absl::Span<int64_t> values) const {
+  if (num_keys_ == 0) {
+    std::fill(values.begin(), values.end(), default_value);
+    return;
+  }
+  uint64 hashes[kLookupBlockSize];
+  uint64 slots[kLookupBlockSize];
+  for (size_t start = 0; start < keys.size(); start += kLookupBlockSize) {
+    const size_t size =
+        std::min<size_t>(kLookupBlockSize, keys.size() - start);
+    const tstring* block = keys.data() + start;
+    for (size_t i = 0; i < size; ++i) {
+      hashes[i] = Hash64(block[i].data(), block[i].size(), seed_);
+      port::prefetch<port::PREFETCH_HINT_T0>(
+          &pilots_[Bucket(hashes[i], num_buckets_)]);
+    }
+    for (size_t i = 0; i < size; ++i) {
+      slots[i] = Slot(hashes[i]);
+      if (slots[i] < num_keys_) {
+        port::prefetch<port::PREFETCH_HINT_T0>(&offsets_[slots[i]]);
+        port::prefetch<port::PREFETCH_HINT_T0>(&values_[slots[i]]);
+      }
+    }
+    for (size_t i = 0; i < size; ++i) {
+      if (slots[i] < num_keys_ && offsets_[slots[i]] < key_bytes_) {
+        port::prefetch<port::PREFETCH_HINT_T0>(keys_ + offsets_[slots[i]]);
+      }
+    }
+    for (size_t i = 0; i < size; ++i) {
+      values[start + i] = ValueIfMatches(slots[i], block[i], default_value);
+    }
+  }
+}
+
+Status WritePerfectHashVocabularyFile(Env* env, const std::string& filename,
+                                      absl::Span<const absl::string_view> keys,
+                                      absl::Span<const int64_t> values) {
+  std::string data;
+  TF_RETURN_IF_ERROR(PerfectHashVocabulary::Build(keys, values, &data));
+  return WriteStringToFile(env, filename, data);
+}
+
+}  // namespace lookup
+}  // namespace tensorflow
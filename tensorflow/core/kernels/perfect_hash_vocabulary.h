@@ -0,0 +1,127 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_PERFECT_HASH_VOCABULARY_H_
+#define TENSORFLOW_CORE_KERNELS_PERFECT_HASH_VOCABULARY_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace lookup {
+
+// An immutable string -> int64 map stored in a single flat buffer, meant for
+// large vocabularies where a hash map of strings costs too much memory and too
+// many cache misses per lookup.
+//
+// The keys are placed with a minimal perfect hash (hash and displace): each key
+// is hashed into a bucket of about `kKeysPerBucket` keys, and every bucket
+// stores a 32-bit pilot that maps its keys to distinct slots in [0, size()).
+// The keys are stored back to back in slot order next to their values, so a
+// lookup hashes the key once, reads one pilot and compares the key against the
+// single candidate slot.
+//
+// The buffer has no pointers and can be written to a file by `Build` and
+// memory mapped by `FromFile` without any parsing or copying. Files use the
+// byte order of the host that built them.
+//
+// This class is thread-safe.
+class PerfectHashVocabulary {
+ public:
+  // Average number of keys per bucket of the perfect hash.
+  static constexpr int kKeysPerBucket = 3;
+
+  // Builds the serialized vocabulary mapping `keys[i]` to `values[i]` into
+  // `*output`. Returns InvalidArgument if the keys are not unique.
+  static Status Build(absl::Span<const absl::string_view> keys,
+                      absl::Span<const int64_t> values, std::string* output);
+
+  // Creates a vocabulary over the serialized `data`, which is moved into it.
+  static Status FromString(std::string data,
+                           std::unique_ptr<PerfectHashVocabulary>* output);
+
+  // Creates a vocabulary over the memory mapped contents of `filename`, which
+  // must have been written from the output of `Build`.
+  static Status FromFile(Env* env, const std::string& filename,
+                         std::unique_ptr<PerfectHashVocabulary>* output);
+
+  PerfectHashVocabulary(const PerfectHashVocabulary&) = delete;
+  PerfectHashVocabulary& operator=(const PerfectHashVocabulary&) = delete;
+
+  // Number of keys in the vocabulary.
+  int64_t size() const { return num_keys_; }
+
+  // Returns the value of `key`, or `default_value` if it is not present.
+  int64_t Find(absl::string_view key, int64_t default_value) const;
+
+  // Writes the value of `keys[i]`, or `default_value` if it is not present, to
+  // `values[i]`. The keys are processed in blocks: all the hashes of a block
+  // are computed first and the memory the block touches is prefetched before
+  // any key is compared, so the cache misses of a block overlap.
+  void Find(absl::Span<const tstring> keys, int64_t default_value,
+            absl::Span<int64_t> values) const;
+
+  // Returns the key and value stored in slot `i`, for `0 <= i < size()`.
+  absl::string_view key(int64_t i) const;
+  int64_t value(int64_t i) const { return values_[i]; }
+
+  // Size of the serialized vocabulary, in bytes.
+  int64_t MemoryUsed() const { return data_.size(); }
+
+ private:
+  PerfectHashVocabulary() = default;
+
+  Status Init(absl::string_view data);
+
+  // Returns the candidate slot of a key hashing to `hash`, which is only valid
+  // if the key stored in it is equal to the looked up key.
+  uint64 Slot(uint64 hash) const;
+
+  // Returns the value of the key in `slot` if it is `key`, and `default_value`
+  // otherwise.
+  int64_t ValueIfMatches(uint64 slot, absl::string_view key,
+                         int64_t default_value) const;
+
+  // Exactly one of these owns the serialized vocabulary.
+  std::string owned_data_;
+  std::unique_ptr<ReadOnlyMemoryRegion> region_;
+
+  absl::string_view data_;
+  uint64 num_keys_ = 0;
+  uint64 num_buckets_ = 0;
+  uint64 seed_ = 0;
+  uint64 key_bytes_ = 0;
+  const uint32* pilots_ = nullptr;
+  const uint64* offsets_ = nullptr;
+  const int64_t* values_ = nullptr;
+  const char* keys_ = nullptr;
+};
+
+// Builds the vocabulary mapping `keys[i]` to `values[i]` and writes it to
+// `filename`, to be loaded with `PerfectHashVocabulary::FromFile`.
+Status WritePerfectHashVocabularyFile(Env* env, const std::string& filename,
+                                      absl::Span<const absl::string_view> keys,
+                                      absl::Span<const int64_t> values);
+
+}  // namespace lookup
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_PERFECT_HASH_VOCABULARY_H_
@@ -0,0 +1,195 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/perfect_hash_vocabulary.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/kernels/perfect_hash_table_op.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+
+constexpr int64_t kDefaultValue = -1;
+
+class PerfectHashVocabularyTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    for (int i = 0; i < 1000; ++i) {
+      key_storage_.push_back(absl::StrCat("key_", i));
+      values_.push_back(i * 7);
+    }
+    keys_.assign(key_storage_.begin(), key_storage_.end());
+  }
+
+  std::vector<std::string> key_storage_;
+  std::vector<absl::string_view> keys_;
+  std::vector<int64_t> values_;
+};
+
+TEST_F(PerfectHashVocabularyTest, Find) {
+  std::string data;
+  TF_ASSERT_OK(PerfectHashVocabulary::Build(keys_, values_, &data));
+  std::unique_ptr<PerfectHashVocabulary> vocabulary;
+  TF_ASSERT_OK(PerfectHashVocabulary::FromString(std::move(data), &vocabulary));
+
+  EXPECT_EQ(vocabulary->size(), keys_.size());
+  for (int i = 0; i < keys_.size(); ++i) {
+    EXPECT_EQ(vocabulary->Find(keys_[i], kDefaultValue), values_[i]);
+  }
+  EXPECT_EQ(vocabulary->Find("key_1000", kDefaultValue), kDefaultValue);
+  EXPECT_EQ(vocabulary->Find("", kDefaultValue), kDefaultValue);
+  EXPECT_EQ(vocabulary->Find("key_", kDefaultValue), kDefaultValue);
+}
+
+TEST_F(PerfectHashVocabularyTest, BatchedFind) {
+  std::string data;
+  TF_ASSERT_OK(PerfectHashVocabulary::Build(keys_, values_, &data));
+  std::unique_ptr<PerfectHashVocabulary> vocabulary;
+  TF_ASSERT_OK(PerfectHashVocabulary::FromString(std::move(data), &vocabulary));
+
+  std::vector<tstring> lookups;
+  std::vector<int64_t> expected;
+  for (int i = 0; i < 100; ++i) {
+    lookups.push_back(absl::StrCat("key_", i * 13));
+    expected.push_back(i * 13 < 1000 ? i * 13 * 7 : kDefaultValue);
+  }
+  std::vector<int64_t> values(lookups.size());
+  vocabulary->Find(lookups, kDefaultValue, absl::MakeSpan(values));
+  EXPECT_EQ(values, expected);
+}
+
+TEST_F(PerfectHashVocabularyTest, SlotsHoldEveryKeyOnce) {
+  std::string data;
+  TF_ASSERT_OK(PerfectHashVocabulary::Build(keys_, values_, &data));
+  std::unique_ptr<PerfectHashVocabulary> vocabulary;
+  TF_ASSERT_OK(PerfectHashVocabulary::FromString(std::move(data), &vocabulary));
+
+  std::vector<bool> seen(keys_.size(), false);
+  for (int64_t i = 0; i < vocabulary->size(); ++i) {
+    const int64_t value = vocabulary->value(i);
+    ASSERT_EQ(value % 7, 0);
+    ASSERT_FALSE(seen[value / 7]);
+    seen[value / 7] = true;
+    EXPECT_EQ(vocabulary->key(i), keys_[value / 7]);
+  }
+}
+
+TEST_F(PerfectHashVocabularyTest, Empty) {
+  std::string data;
+  TF_ASSERT_OK(PerfectHashVocabulary::Build({}, {}, &data));
+  std::unique_ptr<PerfectHashVocabulary> vocabulary;
+  TF_ASSERT_OK(PerfectHashVocabulary::FromString(std::move(data), &vocabulary));
+  EXPECT_EQ(vocabulary->size(), 0);
+  EXPECT_EQ(vocabulary->Find("key_0", kDefaultValue), kDefaultValue);
+}
+
+TEST_F(PerfectHashVocabularyTest, DuplicateKeys) {
+  keys_.push_back("key_10");
+  values_.push_back(70);
+  std::string data;
+  EXPECT_THAT(PerfectHashVocabulary::Build(keys_, values_, &data),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST_F(PerfectHashVocabularyTest, File) {
+  const std::string filename =
+      io::JoinPath(::testing::TempDir(), "perfect_hash_vocabulary");
+  TF_ASSERT_OK(WritePerfectHashVocabularyFile(Env::Default(), filename, keys_,
+                                              values_));
+  std::unique_ptr<PerfectHashVocabulary> vocabulary;
+  TF_ASSERT_OK(
+      PerfectHashVocabulary::FromFile(Env::Default(), filename, &vocabulary));
+  for (int i = 0; i < keys_.size(); ++i) {
+    EXPECT_EQ(vocabulary->Find(keys_[i], kDefaultValue), values_[i]);
+  }
+}
+
+TEST_F(PerfectHashVocabularyTest, CorruptedData) {
+  std::string data;
+  TF_ASSERT_OK(PerfectHashVocabulary::Build(keys_, values_, &data));
+  std::unique_ptr<PerfectHashVocabulary> vocabulary;
+  EXPECT_THAT(PerfectHashVocabulary::FromString(
+                  data.substr(0, data.size() - 1), &vocabulary),
+              StatusIs(error::DATA_LOSS));
+  std::string bad_magic = data;
+  bad_magic[0] ^= 1;
+  EXPECT_THAT(
+      PerfectHashVocabulary::FromString(std::move(bad_magic), &vocabulary),
+      StatusIs(error::DATA_LOSS));
+}
+
+TEST_F(PerfectHashVocabularyTest, InitializeTable) {
+  Tensor keys = test::AsTensor<tstring>({"a", "b", "c"});
+  Tensor values = test::AsTensor<int64_t>({1, 2, 3});
+  KeyValueTensorIterator iter(&keys, &values);
+  core::RefCountPtr<PerfectHashTable> table(
+      new PerfectHashTable(/*ctx=*/nullptr, /*kernel=*/nullptr));
+  TF_ASSERT_OK(table->Initialize(iter));
+  EXPECT_EQ(table->size(), 3);
+
+  Tensor lookups = test::AsTensor<tstring>({"c", "d", "a"});
+  Tensor output(DT_INT64, lookups.shape());
+  TF_ASSERT_OK(table->Find(/*ctx=*/nullptr, lookups, &output,
+                           test::AsScalar<int64_t>(kDefaultValue)));
+  test::ExpectTensorEqual<int64_t>(
+      output, test::AsTensor<int64_t>({3, kDefaultValue, 1}));
+}
+
+TEST_F(PerfectHashVocabularyTest, InitializeTableFromFile) {
+  const std::string filename =
+      io::JoinPath(::testing::TempDir(), "perfect_hash_table");
+  TF_ASSERT_OK(WritePerfectHashVocabularyFile(Env::Default(), filename, keys_,
+                                              values_));
+  core::RefCountPtr<PerfectHashTable> table(
+      new PerfectHashTable(/*ctx=*/nullptr, /*kernel=*/nullptr));
+  TF_ASSERT_OK(table->InitializeFromFile(Env::Default(), filename,
+                                         /*serializer=*/nullptr));
+  EXPECT_EQ(table->size(), keys_.size());
+
+  Tensor lookups = test::AsTensor<tstring>({"key_3", "key_-1"});
+  Tensor output(DT_INT64, lookups.shape());
+  TF_ASSERT_OK(table->Find(/*ctx=*/nullptr, lookups, &output,
+                           test::AsScalar<int64_t>(kDefaultValue)));
+  test::ExpectTensorEqual<int64_t>(
+      output, test::AsTensor<int64_t>({21, kDefaultValue}));
+
+  // Initializing again from the same file is a no-op, but not from another.
+  TF_EXPECT_OK(table->InitializeFromFile(Env::Default(), filename,
+                                         /*serializer=*/nullptr));
+  EXPECT_THAT(table->InitializeFromFile(Env::Default(), filename + "_other",
+                                        /*serializer=*/nullptr),
+              StatusIs(error::FAILED_PRECONDITION));
+}
+
+}  // namespace
+}  // namespace lookup
+}  // namespace tensorflow
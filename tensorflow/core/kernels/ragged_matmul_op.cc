@@ -0,0 +1,230 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <cstdint>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/util/work_sharder.h"
+#include "tensorflow/tsl/platform/errors.h"
+
+namespace tensorflow {
+
+using errors::InvalidArgument;
+
+namespace {
+
+template <typename T>
+using ConstMatrixMap = Eigen::Map<
+    const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>;
+template <typename T>
+using MatrixMap = Eigen::Map<
+    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>;
+
+// Checks that `splits` partitions `nvals` rows into `nrows` batches.
+template <typename SPLITS_TYPE>
+Status ValidateSplits(const Tensor& splits_in, int64_t nrows, int64_t nvals) {
+  if (splits_in.dims() != 1 || splits_in.dim_size(0) != nrows + 1) {
+    return InvalidArgument("rt_splits must be a vector with ", nrows + 1,
+                           " elements, got shape ",
+                           splits_in.shape().DebugString());
+  }
+  const auto splits = splits_in.vec<SPLITS_TYPE>();
+  if (splits(0) != 0) {
+    return InvalidArgument("rt_splits must start with 0, got ", splits(0));
+  }
+  for (int64_t i = 1; i <= nrows; ++i) {
+    if (splits(i) < splits(i - 1)) {
+      return InvalidArgument("rt_splits must be sorted, got ", splits(i - 1),
+                             " before ", splits(i));
+    }
+  }
+  if (splits(nrows) != nvals) {
+    return InvalidArgument("rt_splits must end with the number of values (",
+                           nvals, "), got ", splits(nrows));
+  }
+  return OkStatus();
+}
+
+// Runs `fn(batch, begin, end)` for each batch, where rows [begin, end) of the
+// values belong to that batch, in parallel across batches.
+template <typename SPLITS_TYPE, typename Fn>
+void ForEachBatch(OpKernelContext* context, const Tensor& splits_in,
+                  int64_t cost_per_value, const Fn& fn) {
+  const auto splits = splits_in.vec<SPLITS_TYPE>();
+  const int64_t nrows = splits.size() - 1;
+  const int64_t cost_per_batch =
+      nrows == 0 ? 0 : cost_per_value * splits(nrows) / nrows + 1;
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads.num_threads, worker_threads.workers, nrows,
+        cost_per_batch, [&](int64_t start, int64_t limit) {
+          for (int64_t i = start; i < limit; ++i) {
+            fn(i, splits(i), splits(i + 1));
+          }
+        });
+}
+
+}  // namespace
+
+// Multiplies the rows of each batch of a ragged [B, (I), J] tensor by that
+// batch's [J, K] matrix, directly on the flat values.
+template <typename T, typename SPLITS_TYPE>
+class RaggedBatchMatMulOp : public OpKernel {
+ public:
+  explicit RaggedBatchMatMulOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_b", &transpose_b_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& values_in = context->input(0);
+    const Tensor& splits_in = context->input(1);
+    const Tensor& b_in = context->input(2);
+    OP_REQUIRES(context, values_in.dims() == 2,
+                InvalidArgument("rt_dense_values must be a matrix, got shape ",
+                                values_in.shape().DebugString()));
+    OP_REQUIRES(context, b_in.dims() == 3,
+                InvalidArgument("b must have rank 3, got shape ",
+                                b_in.shape().DebugString()));
+    const int64_t nrows = b_in.dim_size(0);
+    const int64_t inner = values_in.dim_size(1);
+    const int64_t b_inner = b_in.dim_size(transpose_b_ ? 2 : 1);
+    const int64_t outer = b_in.dim_size(transpose_b_ ? 1 : 2);
+    OP_REQUIRES(context, inner == b_inner,
+                InvalidArgument("Matrix size-incompatible: rt_dense_values: ",
+                                values_in.shape().DebugString(),
+                                ", b: ", b_in.shape().DebugString()));
+    OP_REQUIRES_OK(context, ValidateSplits<SPLITS_TYPE>(
+                                splits_in, nrows, values_in.dim_size(0)));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                0, TensorShape({values_in.dim_size(0), outer}),
+                                &output));
+    if (inner == 0 || outer == 0) {
+      output->flat<T>().setZero();
+      return;
+    }
+    const T* values = values_in.flat<T>().data();
+    const T* b = b_in.flat<T>().data();
+    T* out = output->flat<T>().data();
+    ForEachBatch<SPLITS_TYPE>(
+        context, splits_in, inner * outer,
+        [&](int64_t batch, int64_t begin, int64_t end) {
+          if (begin == end) return;
+          ConstMatrixMap<T> a(values + begin * inner, end - begin, inner);
+          MatrixMap<T> c(out + begin * outer, end - begin, outer);
+          const T* b_batch = b + batch * inner * outer;
+          if (transpose_b_) {
+            c.noalias() = a * ConstMatrixMap<T>(b_batch, outer, inner)
+                                  .transpose();
+          } else {
+            c.noalias() = a * ConstMatrixMap<T>(b_batch, inner, outer);
+          }
+        });
+  }
+
+ private:
+  bool transpose_b_;
+};
+
+// Computes the gradient of `RaggedBatchMatMul` with respect to `b`: the
+// product of the transposed rows of each batch with that batch's gradient.
+template <typename T, typename SPLITS_TYPE>
+class RaggedBatchMatMulGradOp : public OpKernel {
+ public:
+  explicit RaggedBatchMatMulGradOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_b", &transpose_b_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& values_in = context->input(0);
+    const Tensor& splits_in = context->input(1);
+    const Tensor& grad_in = context->input(2);
+    OP_REQUIRES(context, values_in.dims() == 2,
+                InvalidArgument("rt_dense_values must be a matrix, got shape ",
+                                values_in.shape().DebugString()));
+    OP_REQUIRES(context,
+                grad_in.dims() == 2 &&
+                    grad_in.dim_size(0) == values_in.dim_size(0),
+                InvalidArgument("grad must be a matrix with ",
+                                values_in.dim_size(0), " rows, got shape ",
+                                grad_in.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(splits_in.shape()),
+                InvalidArgument("rt_splits must be a vector, got shape ",
+                                splits_in.shape().DebugString()));
+    const int64_t nrows = splits_in.dim_size(0) - 1;
+    OP_REQUIRES(context, nrows >= 0,
+                InvalidArgument("rt_splits must not be empty"));
+    OP_REQUIRES_OK(context, ValidateSplits<SPLITS_TYPE>(
+                                splits_in, nrows, values_in.dim_size(0)));
+    const int64_t inner = values_in.dim_size(1);
+    const int64_t outer = grad_in.dim_size(1);
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(
+        context,
+        context->allocate_output(
+            0,
+            transpose_b_ ? TensorShape({nrows, outer, inner})
+                         : TensorShape({nrows, inner, outer}),
+            &output));
+    const T* values = values_in.flat<T>().data();
+    const T* grad = grad_in.flat<T>().data();
+    T* out = output->flat<T>().data();
+    ForEachBatch<SPLITS_TYPE>(
+        context, splits_in, inner * outer,
+        [&](int64_t batch, int64_t begin, int64_t end) {
+          ConstMatrixMap<T> a(values + begin * inner, end - begin, inner);
+          ConstMatrixMap<T> g(grad + begin * outer, end - begin, outer);
+          T* out_batch = out + batch * inner * outer;
+          if (begin == end) {
+            std::fill(out_batch, out_batch + inner * outer, T(0));
+          } else if (transpose_b_) {
+            MatrixMap<T>(out_batch, outer, inner).noalias() =
+                g.transpose() * a;
+          } else {
+            MatrixMap<T>(out_batch, inner, outer).noalias() =
+                a.transpose() * g;
+          }
+        });
+  }
+
+ private:
+  bool transpose_b_;
+};
+
+#define REGISTER_CPU_KERNEL_WITH_SPLITS(NAME, TYPE, SPLITS_TYPE)        \
+  REGISTER_KERNEL_BUILDER(Name(#NAME)                                   \
+                              .Device(DEVICE_CPU)                       \
+                              .TypeConstraint<TYPE>("T")                \
+                              .TypeConstraint<SPLITS_TYPE>("Tsplits"),  \
+                          NAME##Op<TYPE, SPLITS_TYPE>);
+#define REGISTER_CPU_KERNEL(TYPE)                                      \
+  REGISTER_CPU_KERNEL_WITH_SPLITS(RaggedBatchMatMul, TYPE, int32)      \
+  REGISTER_CPU_KERNEL_WITH_SPLITS(RaggedBatchMatMul, TYPE, int64_t)    \
+  REGISTER_CPU_KERNEL_WITH_SPLITS(RaggedBatchMatMulGrad, TYPE, int32)  \
+  REGISTER_CPU_KERNEL_WITH_SPLITS(RaggedBatchMatMulGrad, TYPE, int64_t)
+TF_CALL_float(REGISTER_CPU_KERNEL);
+TF_CALL_double(REGISTER_CPU_KERNEL);
+#undef REGISTER_CPU_KERNEL
+#undef REGISTER_CPU_KERNEL_WITH_SPLITS
+
+}  // namespace tensorflow
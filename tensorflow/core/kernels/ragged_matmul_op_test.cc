@@ -0,0 +1,108 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <gtest/gtest.h>
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class RaggedBatchMatMulOpTest : public ::tensorflow::OpsTestBase {
+ protected:
+  // Builds the tensorflow test graph for `op_name`.
+  void BuildRaggedBatchMatMulGraph(const string& op_name, bool transpose_b) {
+    TF_ASSERT_OK(NodeDefBuilder("tested_op", op_name)
+                     .Input(FakeInput(DT_FLOAT))  // rt_dense_values
+                     .Input(FakeInput(DT_INT64))  // rt_splits
+                     .Input(FakeInput(DT_FLOAT))  // b or grad
+                     .Attr("transpose_b", transpose_b)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(RaggedBatchMatMulOpTest, MatMul) {
+  BuildRaggedBatchMatMulGraph("RaggedBatchMatMul", /*transpose_b=*/false);
+  // rt = [[[1, 2], [3, 4]], [], [[5, 6]]]
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<int64_t>(TensorShape({4}), {0, 2, 2, 3});
+  AddInputFromArray<float>(TensorShape({3, 2, 1}), {1, 10, 7, 7, 2, -1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0), test::AsTensor<float>({21, 43, 4}, TensorShape({3, 1})));
+}
+
+TEST_F(RaggedBatchMatMulOpTest, MatMulTransposeB) {
+  BuildRaggedBatchMatMulGraph("RaggedBatchMatMul", /*transpose_b=*/true);
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 1, 3});
+  AddInputFromArray<float>(TensorShape({2, 2, 2}), {1, 0, 0, 1, 1, 1, 2, 0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0),
+      test::AsTensor<float>({1, 2, 7, 6, 11, 10}, TensorShape({3, 2})));
+}
+
+TEST_F(RaggedBatchMatMulOpTest, Grad) {
+  BuildRaggedBatchMatMulGraph("RaggedBatchMatMulGrad", /*transpose_b=*/false);
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<int64_t>(TensorShape({4}), {0, 2, 2, 3});
+  AddInputFromArray<float>(TensorShape({3, 1}), {1, 2, 3});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // The empty batch gets a zero gradient.
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0),
+      test::AsTensor<float>({7, 10, 0, 0, 15, 18}, TensorShape({3, 2, 1})));
+}
+
+TEST_F(RaggedBatchMatMulOpTest, BadSplits) {
+  BuildRaggedBatchMatMulGraph("RaggedBatchMatMul", /*transpose_b=*/false);
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 2, 4});
+  AddInputFromArray<float>(TensorShape({2, 2, 1}), {1, 1, 1, 1});
+  EXPECT_TRUE(
+      absl::StrContains(RunOpKernel().error_message(),
+                        "rt_splits must end with the number of values"));
+}
+
+TEST_F(RaggedBatchMatMulOpTest, ShapeFn) {
+  ShapeInferenceTestOp op("RaggedBatchMatMul");
+  TF_ASSERT_OK(NodeDefBuilder("test", "RaggedBatchMatMul")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_INT64))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("transpose_b", false)
+                   .Finalize(&op.node_def));
+  INFER_OK(op, "?;?;?", "[?,?]");
+  INFER_OK(op, "[?,2];[4];[3,2,5]", "[d0_0,d2_2]");
+  INFER_ERROR("Dimensions must be equal", op, "[?,2];[3];[3,2,5]");
+  INFER_ERROR("Dimensions must be equal", op, "[?,2];?;[3,4,5]");
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -449,12 +449,28 @@ class AssignVariableOp : public OpKernel {
               value.shape().DebugString()));
     }
     if (variable->copy_on_read_mode.load()) {
-      AllocatorAttributes attr;
-      attr.set_gpu_compatible(true);
-      attr.set_nic_compatible(true);
-      OP_REQUIRES_OK(context,
-                     context->allocate_temp(value.dtype(), value.shape(),
-                                            variable->tensor(), attr));
+      // In copy-on-read mode the variable must be the only user of its
+      // buffer. Adopt the buffer of `value` if we are its last user, else
+      // copy `value`, into the variable's own buffer if it has the right
+      // shape so that large variables are not reallocated on every assign.
+      std::unique_ptr<Tensor> input_alias = context->forward_input(
+          1, OpKernelContext::Params::kNoReservation /*output_index*/,
+          value.dtype(), value.shape(), DEVICE_MEMORY, AllocatorAttributes());
+      if (input_alias) {
+        *variable->tensor() = *input_alias;
+        variable->is_initialized = true;
+        return;
+      }
+      if (!variable->is_initialized ||
+          !variable->tensor()->RefCountIsOne() ||
+          !variable->tensor()->shape().IsSameSize(value.shape())) {
+        AllocatorAttributes attr;
+        attr.set_gpu_compatible(true);
+        attr.set_nic_compatible(true);
+        OP_REQUIRES_OK(context,
+                       context->allocate_temp(value.dtype(), value.shape(),
+                                              variable->tensor(), attr));
+      }
       functor::DenseUpdate<Device, T, ASSIGN> copy_functor;
       copy_functor(context->eigen_device<Device>(),
                    variable->tensor()->flat<T>(), value.flat<T>());
@@ -588,13 +604,27 @@ class AssignUpdateVariableOp : public OpKernel {
                                            &variable));
 
     const Tensor& value = context->input(1);
-    // TODO(apassos): We could possibly avoid the copy done by
-    // PrepareToUpdateVariable() for commutative operations like Op ==
-    // ADD if value's refcount was 1.
     mutex_lock ml(*variable->mu());
     Tensor* var_tensor = variable->tensor();
     OP_REQUIRES_OK(context, ValidateAssignUpdateVariableOpShapes(
                                 var_tensor->shape(), value.shape()));
+    // PrepareToUpdateVariable() would copy the variable before updating it in
+    // place. Since ADD is commutative, we can instead add the variable into
+    // the buffer of `value` when we are its last user and adopt the sum,
+    // which saves both the allocation and a pass over the variable.
+    if (Op == ADD && (variable->copy_on_read_mode.load() ||
+                      !var_tensor->RefCountIsOne())) {
+      std::unique_ptr<Tensor> input_alias = context->forward_input(
+          1, OpKernelContext::Params::kNoReservation /*output_index*/,
+          value.dtype(), value.shape(), DEVICE_MEMORY, AllocatorAttributes());
+      if (input_alias) {
+        functor::DenseUpdate<Device, T, ADD> update_functor;
+        update_functor(context->eigen_device<Device>(), input_alias->flat<T>(),
+                       const_cast<const Tensor*>(var_tensor)->flat<T>());
+        *var_tensor = *input_alias;
+        return;
+      }
+    }
     OP_REQUIRES_OK(
         context, PrepareToUpdateVariable<Device, T>(
                      context, var_tensor, variable->copy_on_read_mode.load()));
@@ -0,0 +1,239 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Number of query rows processed together, so that every key and value row
+// loaded from memory is used for several queries.
+constexpr int64_t kQueryBlock = 8;
+// Number of keys whose scores are kept at a time. The scores of one block of
+// queries against one block of keys stay in L1.
+constexpr int64_t kKeyBlock = 128;
+
+// Computes the attention of `num_queries` <= kQueryBlock query rows against
+// all the keys of one batch, visiting the keys in blocks and keeping a running
+// maximum and sum of the softmax for every query row. `scores` has room for
+// kQueryBlock * kKeyBlock values, and `row_max` and `row_sum` for kQueryBlock
+// values.
+template <typename T>
+void AttendQueryBlock(const T* query, const T* key, const T* value,
+                      int64_t num_queries, int64_t num_keys, int64_t depth,
+                      int64_t value_depth, T scale, T* scores, T* row_max,
+                      T* row_sum, T* output) {
+  std::fill(output, output + num_queries * value_depth, T(0));
+  std::fill(row_max, row_max + num_queries,
+            -std::numeric_limits<T>::infinity());
+  std::fill(row_sum, row_sum + num_queries, T(0));
+
+  for (int64_t key_begin = 0; key_begin < num_keys; key_begin += kKeyBlock) {
+    const int64_t key_end = std::min(num_keys, key_begin + kKeyBlock);
+    const int64_t block_keys = key_end - key_begin;
+
+    // Scores of the block of queries against the block of keys.
+    for (int64_t j = 0; j < block_keys; ++j) {
+      const T* key_row = key + (key_begin + j) * depth;
+      for (int64_t r = 0; r < num_queries; ++r) {
+        const T* query_row = query + r * depth;
+        T dot = 0;
+        for (int64_t d = 0; d < depth; ++d) {
+          dot += query_row[d] * key_row[d];
+        }
+        scores[r * kKeyBlock + j] = dot * scale;
+      }
+    }
+
+    // Updates the running softmax, rescaling what has been accumulated so far
+    // if the maximum grew.
+    for (int64_t r = 0; r < num_queries; ++r) {
+      T* score_row = scores + r * kKeyBlock;
+      T block_max = row_max[r];
+      for (int64_t j = 0; j < block_keys; ++j) {
+        block_max = std::max(block_max, score_row[j]);
+      }
+      if (block_max > row_max[r]) {
+        const T correction = std::exp(row_max[r] - block_max);
+        row_sum[r] *= correction;
+        T* output_row = output + r * value_depth;
+        for (int64_t d = 0; d < value_depth; ++d) {
+          output_row[d] *= correction;
+        }
+        row_max[r] = block_max;
+      }
+      for (int64_t j = 0; j < block_keys; ++j) {
+        score_row[j] = std::exp(score_row[j] - row_max[r]);
+        row_sum[r] += score_row[j];
+      }
+    }
+
+    // Accumulates the values weighted by the unnormalized probabilities.
+    for (int64_t j = 0; j < block_keys; ++j) {
+      const T* value_row = value + (key_begin + j) * value_depth;
+      for (int64_t r = 0; r < num_queries; ++r) {
+        const T p = scores[r * kKeyBlock + j];
+        T* output_row = output + r * value_depth;
+        for (int64_t d = 0; d < value_depth; ++d) {
+          output_row[d] += p * value_row[d];
+        }
+      }
+    }
+  }
+
+  for (int64_t r = 0; r < num_queries; ++r) {
+    const T inverse_sum = T(1) / row_sum[r];
+    T* output_row = output + r * value_depth;
+    for (int64_t d = 0; d < value_depth; ++d) {
+      output_row[d] *= inverse_sum;
+    }
+  }
+}
+
+}  // namespace
+
+// Computes softmax(scale * query * transpose(key)) * value over the last two
+// dimensions without materializing the [..., num_queries, num_keys] scores.
+// The softmax is computed online over blocks of keys as in FlashAttention
+// (Dao et al., 2022, https://arxiv.org/abs/2205.14135).
+template <typename T>
+class FusedScaledDotProductAttentionOp : public OpKernel {
+ public:
+  explicit FusedScaledDotProductAttentionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    float scale;
+    OP_REQUIRES_OK(context, context->GetAttr("scale", &scale));
+    scale_ = static_cast<T>(scale);
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& query = context->input(0);
+    const Tensor& key = context->input(1);
+    const Tensor& value = context->input(2);
+
+    OP_REQUIRES(context, query.dims() >= 3,
+                errors::InvalidArgument("query must be at least 3-D, got ",
+                                        query.shape().DebugString()));
+    OP_REQUIRES(context, key.dims() == query.dims() &&
+                             value.dims() == query.dims(),
+                errors::InvalidArgument(
+                    "query, key and value must have the same rank, got ",
+                    query.shape().DebugString(), ", ",
+                    key.shape().DebugString(), " and ",
+                    value.shape().DebugString()));
+    const int rank = query.dims();
+    TensorShape output_shape;
+    for (int i = 0; i < rank - 2; ++i) {
+      OP_REQUIRES(context, key.dim_size(i) == query.dim_size(i) &&
+                               value.dim_size(i) == query.dim_size(i),
+                  errors::InvalidArgument(
+                      "query, key and value must have the same batch "
+                      "dimensions, got ",
+                      query.shape().DebugString(), ", ",
+                      key.shape().DebugString(), " and ",
+                      value.shape().DebugString()));
+      OP_REQUIRES_OK(context, output_shape.AddDimWithStatus(query.dim_size(i)));
+    }
+    const int64_t num_queries = query.dim_size(rank - 2);
+    const int64_t depth = query.dim_size(rank - 1);
+    const int64_t num_keys = key.dim_size(rank - 2);
+    const int64_t value_depth = value.dim_size(rank - 1);
+    OP_REQUIRES(context, key.dim_size(rank - 1) == depth,
+                errors::InvalidArgument(
+                    "query and key must have the same depth, got ",
+                    query.shape().DebugString(), " and ",
+                    key.shape().DebugString()));
+    OP_REQUIRES(context, value.dim_size(rank - 2) == num_keys,
+                errors::InvalidArgument(
+                    "key and value must have the same number of rows, got ",
+                    key.shape().DebugString(), " and ",
+                    value.shape().DebugString()));
+    OP_REQUIRES_OK(context, output_shape.AddDimWithStatus(num_queries));
+    OP_REQUIRES_OK(context, output_shape.AddDimWithStatus(value_depth));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+    if (num_keys == 0) {
+      // The product with the empty probabilities is zero.
+      output->flat<T>().setZero();
+      return;
+    }
+
+    const int64_t batch = output_shape.num_elements() /
+                          (num_queries * value_depth);
+    const int64_t query_blocks = (num_queries + kQueryBlock - 1) / kQueryBlock;
+    const T* query_data = query.flat<T>().data();
+    const T* key_data = key.flat<T>().data();
+    const T* value_data = value.flat<T>().data();
+    T* output_data = output->flat<T>().data();
+
+    auto work = [&](int64_t start, int64_t limit) {
+      std::vector<T> scores(kQueryBlock * kKeyBlock);
+      std::vector<T> row_max(kQueryBlock);
+      std::vector<T> row_sum(kQueryBlock);
+      for (int64_t unit = start; unit < limit; ++unit) {
+        const int64_t b = unit / query_blocks;
+        const int64_t query_begin = (unit % query_blocks) * kQueryBlock;
+        const int64_t block_queries =
+            std::min(kQueryBlock, num_queries - query_begin);
+        AttendQueryBlock(
+            query_data + (b * num_queries + query_begin) * depth,
+            key_data + b * num_keys * depth,
+            value_data + b * num_keys * value_depth, block_queries, num_keys,
+            depth, value_depth, scale_, scores.data(), row_max.data(),
+            row_sum.data(),
+            output_data + (b * num_queries + query_begin) * value_depth);
+      }
+    };
+    // Every unit computes the attention of one block of queries.
+    const int64_t cost_per_unit =
+        kQueryBlock * num_keys * (2 * depth + 2 * value_depth + 10);
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          batch * query_blocks, cost_per_unit, work);
+  }
+
+ private:
+  T scale_;
+};
+
+#define REGISTER_CPU(T)                                           \
+  REGISTER_KERNEL_BUILDER(Name("_FusedScaledDotProductAttention") \
+                              .Device(DEVICE_CPU)                 \
+                              .TypeConstraint<T>("T"),            \
+                          FusedScaledDotProductAttentionOp<T>);
+
+REGISTER_CPU(float);
+
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
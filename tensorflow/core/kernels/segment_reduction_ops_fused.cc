@@ -0,0 +1,137 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#include "tensorflow/core/kernels/segment_reduction_ops_impl.h"
+
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/kernels/training_op_helpers.h"
+#include "tensorflow/core/lib/core/refcount.h"
+
+namespace tensorflow {
+
+// Gathers rows of a resource variable and reduces them into segments, without
+// materializing the gathered rows. Computes
+//   SparseSegment<combiner>(ResourceGather(resource, gather_indices),
+//                           indices, segment_ids)
+// by reducing the variable rows gather_indices[indices[i]] directly.
+template <typename T, typename GatherIndex, typename Index, typename SegmentId>
+class FusedResourceSparseSegmentReductionOp
+    : public SparseSegmentReductionOpBase<CPUDevice, T, GatherIndex,
+                                          SegmentId> {
+ public:
+  using Base =
+      SparseSegmentReductionOpBase<CPUDevice, T, GatherIndex, SegmentId>;
+
+  explicit FusedResourceSparseSegmentReductionOp(OpKernelConstruction* context)
+      : Base(context, /*is_mean=*/CombinerIs(context, "mean"),
+             /*is_sqrtn=*/CombinerIs(context, "sqrtn"),
+             /*has_num_segments=*/false, /*default_value=*/T(0)) {}
+
+  void Compute(OpKernelContext* context) override {
+    core::RefCountPtr<Var> v;
+    OP_REQUIRES_OK(context,
+                   LookupResource(context, HandleFromInput(context, 0), &v));
+    OP_REQUIRES_OK(context,
+                   EnsureSparseVariableAccess<CPUDevice, T>(context, v.get()));
+    // As in ResourceGather, the lock is held for the whole reduction instead
+    // of taking a reference to the variable's buffer, so that concurrent
+    // writes do not copy the (potentially very large) buffer.
+    tf_shared_lock ml(*v->mu());
+    const Tensor& params = *v->tensor();
+    const Tensor& gather_indices = context->input(1);
+    const Tensor& indices = context->input(2);
+    const Tensor& segment_ids = context->input(3);
+    OP_REQUIRES(context, params.dtype() == DataTypeToEnum<T>::v(),
+                errors::InvalidArgument(
+                    "Trying to read variable with wrong dtype. Expected ",
+                    DataTypeString(DataTypeToEnum<T>::v()), " got ",
+                    DataTypeString(params.dtype())));
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsVectorOrHigher(params.shape()),
+        errors::InvalidArgument("params must be at least 1 dimensional"));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(gather_indices.shape()),
+                errors::InvalidArgument("gather_indices should be a vector."));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(indices.shape()),
+                errors::InvalidArgument("indices should be a vector."));
+
+    // Maps the reduction indices to rows of the variable. Only the indices
+    // are composed; the rows are read once, by the reduction.
+    const auto gather_indices_vec = gather_indices.vec<GatherIndex>();
+    const auto indices_vec = indices.vec<Index>();
+    const Index num_gather_indices = gather_indices.NumElements();
+    Tensor variable_indices;
+    OP_REQUIRES_OK(context, context->allocate_temp(
+                                DataTypeToEnum<GatherIndex>::v(),
+                                indices.shape(), &variable_indices));
+    auto variable_indices_vec = variable_indices.vec<GatherIndex>();
+    for (int64_t i = 0; i < indices.NumElements(); ++i) {
+      const Index index = internal::SubtleMustCopy(indices_vec(i));
+      OP_REQUIRES(context, FastBoundsCheck(index, num_gather_indices),
+                  errors::InvalidArgument("indices[", i, "] = ", index,
+                                          " is not in [0, ",
+                                          num_gather_indices, ")"));
+      variable_indices_vec(i) = gather_indices_vec(index);
+    }
+
+    this->ComputeWithInputs(context, params, variable_indices, segment_ids);
+  }
+
+ private:
+  static bool CombinerIs(OpKernelConstruction* context,
+                         const string& combiner) {
+    string value;
+    return context->GetAttr("combiner", &value).ok() && value == combiner;
+  }
+};
+
+#define REGISTER_CPU_KERNELS(type, gather_index_type, index_type,         \
+                             segment_ids_type)                            \
+  REGISTER_KERNEL_BUILDER(                                                \
+      Name("_FusedResourceSparseSegmentReduction")                        \
+          .Device(DEVICE_CPU)                                             \
+          .HostMemory("resource")                                         \
+          .TypeConstraint<type>("dtype")                                  \
+          .TypeConstraint<gather_index_type>("Tgather")                   \
+          .TypeConstraint<index_type>("Tidx")                             \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),               \
+      FusedResourceSparseSegmentReductionOp<type, gather_index_type,      \
+                                            index_type, segment_ids_type>);
+
+#define REGISTER_CPU_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, gather_index_type, \
+                                                      index_type)              \
+  REGISTER_CPU_KERNELS(type, gather_index_type, index_type, int32)             \
+  REGISTER_CPU_KERNELS(type, gather_index_type, index_type, int64_t)
+
+#define REGISTER_CPU_KERNELS_FOR_EACH_INDEX_TYPE(type, gather_index_type)    \
+  REGISTER_CPU_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, gather_index_type,     \
+                                                int32)                       \
+  REGISTER_CPU_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, gather_index_type,     \
+                                                int64_t)
+
+#define REGISTER_CPU_KERNELS_FOR_EACH_GATHER_INDEX_TYPE(type) \
+  REGISTER_CPU_KERNELS_FOR_EACH_INDEX_TYPE(type, int32)       \
+  REGISTER_CPU_KERNELS_FOR_EACH_INDEX_TYPE(type, int64_t)
+
+TF_CALL_FLOAT_TYPES(REGISTER_CPU_KERNELS_FOR_EACH_GATHER_INDEX_TYPE);
+
+#undef REGISTER_CPU_KERNELS_FOR_EACH_GATHER_INDEX_TYPE
+#undef REGISTER_CPU_KERNELS_FOR_EACH_INDEX_TYPE
+#undef REGISTER_CPU_KERNELS_FOR_EACH_SEGMENT_ID_TYPE
+#undef REGISTER_CPU_KERNELS
+
+}  // namespace tensorflow
@@ -18,7 +18,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 #define TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <vector>
 
 #include "tensorflow/core/framework/op_requires.h"
 #include "tensorflow/core/platform/types.h"
@@ -40,8 +42,11 @@ limitations under the License.
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -362,7 +367,6 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
 
     // `num_real_segment` counts the rows actually reduced from input,
     // the rows with negative segment index will be excluded.
-    // It will be used for cost model.
     int64_t num_real_segment = N;
     // `num_reductions` counts the rows actually reduced in output,
     // the rows only filled with InitialValueF() will be excluded.
@@ -370,10 +374,16 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
     // `row_counter` records how many input rows will be reduced in each
     // output row, the row only fills with InitialValueF() will keep 0.
     // Length of non-zero elements is `num_reductions`.
-    std::vector<Index> row_counter(num_segments, 0);
+    std::vector<int64_t> row_counter(num_segments, 0);
+    // Whether `segment_ids` is non-decreasing, in which case the rows of
+    // every segment are contiguous in `data`.
+    bool is_sorted = true;
 
+    Index prev_j = 0;
     for (int64_t i = 0; i < N; ++i) {
       Index j = internal::SubtleMustCopy(segment_ids(i));
+      if (i > 0 && j < prev_j) is_sorted = false;
+      prev_j = j;
       if (j < 0) {
         --num_real_segment;
         continue;
@@ -389,23 +399,48 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
     // Nothing to reduce. All output values equal to `InitialValueF()`.
     if (num_reductions == 0) return;
 
-    // Parallelize by `num_segments`. It's simple, efficient and safe
-    // (no data dependency):
+    // `row_offsets[j]` is the position of the first row of segment `j` among
+    // the `num_real_segment` rows grouped by segment.
+    std::vector<int64_t> row_offsets(num_segments + 1);
+    row_offsets[0] = 0;
+    for (int64_t j = 0; j < num_segments; ++j) {
+      row_offsets[j + 1] = row_offsets[j] + row_counter[j];
+    }
+
+    // Unsorted ids are grouped by segment with a (stable) counting sort, so
+    // that every worker only visits the rows of its own segments. Sorted ids
+    // are already grouped, after the rows with negative ids.
+    const int64_t first_sorted_row = N - num_real_segment;
+    std::vector<int64_t> sorted_rows;
+    if (!is_sorted) {
+      sorted_rows.resize(num_real_segment);
+      std::vector<int64_t> next_row(row_offsets.begin(), row_offsets.end() - 1);
+      for (int64_t i = 0; i < N; ++i) {
+        Index j = internal::SubtleMustCopy(segment_ids(i));
+        if (j >= 0) sorted_rows[next_row[j]++] = i;
+      }
+    }
+
+    // Parallelize over the grouped rows, but give every segment to the single
+    // worker whose range holds its first row. Workers write disjoint output
+    // rows (no data dependency), and the work stays balanced when some
+    // segments are much larger than others:
     //
-    //   input   segment_ids                 num_segments  operation
-    //   | a0 |  | 0 |            worker 1:  |0|           f(a0, a1)
-    //   | b0 |  | 1 |            worker 2:  |1|           f(b0, b1)
-    // N | c0 |  | 2 |       -->  worker 3:  |2|           f(c0)
-    //   | b1 |  | 1 |
-    //   | a1 |  | 0 |
+    //   input   segment_ids      grouped rows   operation
+    //   | a0 |  | 0 |            | a0 |         worker 1:  |0| f(a0, a1)
+    //   | b0 |  | 1 |            | a1 |
+    // N | c0 |  | 2 |       -->  | b0 |         worker 2:  |1| f(b0, b1)
+    //   | b1 |  | 1 |            | b1 |
+    //   | a1 |  | 0 |            | c0 |         worker 3:  |2| f(c0)
     //
-    // TODO(intel-tf): Balance workload in `row_counter` to make parallelism
-    //                 more efficient.
     auto reductionWorker = [&](int64_t begin, int64_t end) -> void {
-      for (int64_t i = 0; i < N; i++) {
-        Index j = internal::SubtleMustCopy(segment_ids(i));
-        // If `j` is in work scope of this worker, do the reduction.
-        if (j >= begin && j < end) {
+      const int64_t first_segment =
+          std::lower_bound(row_offsets.begin(), row_offsets.end() - 1, begin) -
+          row_offsets.begin();
+      for (int64_t j = first_segment;
+           j < num_segments && row_offsets[j] < end; ++j) {
+        for (int64_t k = row_offsets[j]; k < row_offsets[j + 1]; ++k) {
+          const int64_t i = is_sorted ? first_sorted_row + k : sorted_rows[k];
           reduction(data.template chip<0>(i), output.template chip<0>(j));
         }
       }
@@ -413,12 +448,11 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
 
     // Reduction functors includes Sum, Max, Min, etc. Simply consider it
     // will cost 5 cycles per operation.
-    const int64_t kAverTaskSize = num_real_segment / num_segments;
-    const int64_t compute_cycles = 5 * inner_dim * kAverTaskSize;
-    const int64_t input_bytes = sizeof(T) * inner_dim * kAverTaskSize;
-    const int64_t output_bytes = sizeof(T) * inner_dim * kAverTaskSize;
+    const int64_t compute_cycles = 5 * inner_dim;
+    const int64_t input_bytes = sizeof(T) * inner_dim;
+    const int64_t output_bytes = sizeof(T) * inner_dim;
     const Eigen::TensorOpCost cost(input_bytes, output_bytes, compute_cycles);
-    cpu_device.parallelFor(num_segments, cost, reductionWorker);
+    cpu_device.parallelFor(num_real_segment, cost, reductionWorker);
   }
 };
 
@@ -526,10 +560,15 @@ class SparseSegmentReductionOpBase : public OpKernel {
         default_value_(default_value) {}
 
   void Compute(OpKernelContext* context) override {
-    const Tensor& input = context->input(0);
-    const Tensor& indices = context->input(1);
-    const Tensor& segment_ids = context->input(2);
+    ComputeWithInputs(context, context->input(0), context->input(1),
+                      context->input(2));
+  }
 
+ protected:
+  // Reduces the rows of 'input' selected by 'indices' into the segments given
+  // by 'segment_ids'. Fused kernels call this with inputs they computed.
+  void ComputeWithInputs(OpKernelContext* context, const Tensor& input,
+                         const Tensor& indices, const Tensor& segment_ids) {
     OP_REQUIRES_OK(
         context, internal::ValidateSparseSegmentReduction(
                      context, input, indices, segment_ids, has_num_segments_));
@@ -596,6 +635,14 @@ class SparseSegmentReductionOpBase : public OpKernel {
     }
     auto temp_flat = temp.flat_outer_dims<float>();
 
+    // Segments are delimited sequentially, which validates the segment ids and
+    // fills the gaps between them. The segments are then reduced in parallel.
+    struct Segment {
+      int64_t start;
+      int64_t end;
+      SegmentId out_index;
+    };
+    std::vector<Segment> segments;
     int64_t start = 0, end = 1;
     // Index from which the output is not initialized.
     SegmentId uninitialized_index = 0;
@@ -633,15 +680,7 @@ class SparseSegmentReductionOpBase : public OpKernel {
         gap_slice.setConstant(default_value_);
       }
 
-      auto out = output_flat.template chip<0>(out_index);
-      auto temp = temp_flat.template chip<0>(out_index);
-      const int bad_offset = Reduce<T, Index>(input_flat, indices_vec, start,
-                                              end - start, out, temp);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
+      segments.push_back({start, end, out_index});
 
       start = end;
       ++end;
@@ -650,6 +689,61 @@ class SparseSegmentReductionOpBase : public OpKernel {
       if (end > num_indices) break;
     }
 
+    // The rows of the following indices are prefetched while a segment is
+    // reduced, so that the cache misses of large embedding tables overlap.
+    constexpr int64_t kPrefetchDistance = 8;
+    constexpr size_t kMaxPrefetchBytes = 256;
+    constexpr size_t kCacheLineBytes = 64;
+    const size_t prefetch_bytes =
+        std::min(static_cast<size_t>(num_col) * sizeof(T), kMaxPrefetchBytes);
+    const Index num_input_rows = input_flat.dimension(0);
+
+    mutex mu;
+    // Position of the first out of range index, or -1.
+    int64_t bad_index_pos = -1;
+    auto work = [&](int64_t first_segment, int64_t last_segment) {
+      const int64_t prefetch_end = segments[last_segment - 1].end;
+      for (int64_t s = first_segment; s < last_segment; ++s) {
+        const Segment& segment = segments[s];
+        const int64_t prefetch_limit =
+            std::min(segment.end + kPrefetchDistance, prefetch_end);
+        for (int64_t i = segment.end; i < prefetch_limit; ++i) {
+          const Index index = indices_vec(i);
+          if (!FastBoundsCheck(index, num_input_rows)) continue;
+          const char* row =
+              reinterpret_cast<const char*>(&input_flat(index, 0));
+          for (size_t offset = 0; offset < prefetch_bytes;
+               offset += kCacheLineBytes) {
+            port::prefetch<port::PREFETCH_HINT_T0>(row + offset);
+          }
+        }
+
+        auto out = output_flat.template chip<0>(segment.out_index);
+        auto temp = temp_flat.template chip<0>(segment.out_index);
+        const int bad_offset =
+            Reduce<T, Index>(input_flat, indices_vec, segment.start,
+                             segment.end - segment.start, out, temp);
+        if (bad_offset >= 0) {
+          mutex_lock l(mu);
+          if (bad_index_pos < 0 || segment.start + bad_offset < bad_index_pos) {
+            bad_index_pos = segment.start + bad_offset;
+          }
+          return;
+        }
+      }
+    };
+    const int64_t cost_per_segment =
+        (num_indices / static_cast<int64_t>(segments.size()) + 1) * num_col *
+        sizeof(T);
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          static_cast<int64_t>(segments.size()), cost_per_segment, work);
+    OP_REQUIRES(context, bad_index_pos < 0,
+                errors::InvalidArgument(
+                    "Bad: indices[", bad_index_pos,
+                    "] == ", indices_vec(bad_index_pos), " out of range [0, ",
+                    input_flat.dimension(0), ")"));
+
     // Fill the gap at the end with the default value.
     if (uninitialized_index < output_rows) {
       Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
@@ -15,7 +15,9 @@ limitations under the License.
 
 // See docs in ../ops/string_ops.cc.
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/kernel_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -24,6 +26,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -99,8 +103,9 @@ std::vector<StringPiece> Split(const tstring& str, const tstring& delimiter,
   return SplitOnCharSet(str, delimiter, predicate);
 }
 
-std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
-                                 int maxsplit) {
+// Appends the tokens of `str` to `result`.
+void SplitV2(const tstring& str, StringPiece sep, int maxsplit,
+             std::vector<StringPiece>* result) {
   // This SplitV2 method matches the behavior of python's str.split:
   //   If sep is given, consecutive delimiters are not grouped together
   //   and are deemed to delimit empty strings (for example, '1,,2'.split(',')
@@ -115,12 +120,10 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
   //   splitting an empty string or a string consisting of just whitespace
   //   with a None separator returns [].
 
-  std::vector<StringPiece> result;
-
   StringPiece text(str);
   if (maxsplit == 0) {
-    result.emplace_back(text);
-    return result;
+    result->emplace_back(text);
+    return;
   }
 
   if (sep.empty()) {
@@ -129,32 +132,32 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
     str_util::RemoveLeadingWhitespace(&text);
     int split = 0;
     while (str_util::ConsumeNonWhitespace(&text, &token)) {
-      result.push_back(token);
+      result->push_back(token);
       str_util::RemoveLeadingWhitespace(&text);
       ++split;
       if (maxsplit > 0 && split == maxsplit) {
-        result.push_back(text);
-        return result;
+        result->push_back(text);
+        return;
       }
     }
-    return result;
+    return;
   }
-  auto p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
+  // StringPiece::find looks for the first character of the separator with
+  // memchr, which scans many bytes at a time, instead of comparing every byte
+  // as std::search does.
+  auto p = text.find(sep);
   int split = 0;
-  while (p != text.end()) {
-    StringPiece token = text.substr(0, p - text.begin());
-    result.push_back(token);
-    text.remove_prefix(token.size());
-    text.remove_prefix(sep.size());
+  while (p != StringPiece::npos) {
+    result->push_back(text.substr(0, p));
+    text.remove_prefix(p + sep.size());
     ++split;
     if (maxsplit > 0 && split == maxsplit) {
-      result.push_back(StringPiece(text));
-      return result;
+      result->push_back(text);
+      return;
     }
-    p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
+    p = text.find(sep);
   }
-  result.push_back(text);
-  return result;
+  result->push_back(text);
 }
 
 }  // namespace
@@ -239,11 +242,17 @@ class StringSplitOp : public OpKernel {
   bool skip_empty_;
 };
 
+// When `kToHashBucket` is true, the tokens are not output but hashed into
+// buckets, as StringToHashBucketFast would, which avoids copying them.
+template <bool kToHashBucket>
 class StringSplitV2Op : public OpKernel {
  public:
   explicit StringSplitV2Op(OpKernelConstruction* context)
       : OpKernel(context), maxsplit_(-1) {
     OP_REQUIRES_OK(context, context->GetAttr("maxsplit", &maxsplit_));
+    if (kToHashBucket) {
+      OP_REQUIRES_OK(context, context->GetAttr("num_buckets", &num_buckets_));
+    }
   }
 
   void Compute(OpKernelContext* ctx) override {
@@ -263,21 +272,56 @@ class StringSplitV2Op : public OpKernel {
                                         sep_tensor->shape().DebugString()));
     const auto sep_vec = sep_tensor->flat<tstring>();
     StringPiece sep(sep_vec(0));
-    std::vector<StringPiece> tokens;
-    // Guess that we'll be unpacking a handful of tokens per example.
-    static constexpr int kReserveSize = 4;
-    tokens.reserve(batch_size * kReserveSize);
+
+    // The batch is split into blocks of consecutive strings. Every block is
+    // split by one thread into its own tokens in a first pass, and the tokens
+    // of all blocks are written at their offsets into the outputs in a second
+    // pass, so the output order does not depend on the sharding.
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    const int64_t num_blocks = std::min<int64_t>(
+        batch_size, kBlocksPerThread * worker_threads->num_threads);
+    int64_t input_bytes = 0;
+    for (int64_t i = 0; i < batch_size; ++i) {
+      input_bytes += input_vec(i).size();
+    }
+    const int64_t cost_per_block =
+        num_blocks > 0
+            ? (kCostPerString * batch_size + kCostPerByte * input_bytes) /
+                  num_blocks
+            : 0;
+    auto block_begin = [&](int64_t block) {
+      return block * batch_size / num_blocks;
+    };
+
+    std::vector<std::vector<StringPiece>> block_tokens(num_blocks);
+    std::vector<int64_t> num_indices(batch_size);
+    std::vector<int64_t> block_max_num_entries(num_blocks);
+    auto split = [&](int64_t start, int64_t limit) {
+      for (int64_t block = start; block < limit; ++block) {
+        std::vector<StringPiece>& tokens = block_tokens[block];
+        tokens.reserve((block_begin(block + 1) - block_begin(block)) *
+                       kReserveSize);
+        int64_t max_num_entries = 0;
+        for (int64_t i = block_begin(block); i < block_begin(block + 1); ++i) {
+          const size_t num_tokens = tokens.size();
+          SplitV2(input_vec(i), sep, maxsplit_, &tokens);
+          num_indices[i] = tokens.size() - num_tokens;
+          max_num_entries = std::max(max_num_entries, num_indices[i]);
+        }
+        block_max_num_entries[block] = max_num_entries;
+      }
+    };
+    Shard(worker_threads->num_threads, worker_threads->workers, num_blocks,
+          cost_per_block, split);
 
     int64_t output_size = 0;
     int64_t max_num_entries = 0;
-    std::vector<int64_t> num_indices(batch_size);
-    for (int64_t i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts = SplitV2(input_vec(i), sep, maxsplit_);
-      int64_t n_entries = parts.size();
-      num_indices[i] = n_entries;
-      output_size += n_entries;
-      max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), parts.begin(), parts.end());
+    std::vector<int64_t> block_offsets(num_blocks);
+    for (int64_t block = 0; block < num_blocks; ++block) {
+      block_offsets[block] = output_size;
+      output_size += block_tokens[block].size();
+      max_num_entries =
+          std::max(max_num_entries, block_max_num_entries[block]);
     }
 
     Tensor* sp_indices_t;
@@ -290,27 +334,59 @@ class StringSplitV2Op : public OpKernel {
     OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
 
     auto sp_indices = sp_indices_t->matrix<int64_t>();
-    auto sp_tokens = sp_tokens_t->vec<tstring>();
     auto sp_shape = sp_shape_t->vec<int64_t>();
     sp_shape(0) = batch_size;
     sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
-        sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
-        ++c;
+    auto write = [&](int64_t start, int64_t limit) {
+      for (int64_t block = start; block < limit; ++block) {
+        int64_t c = block_offsets[block];
+        for (int64_t i = block_begin(block); i < block_begin(block + 1); ++i) {
+          for (int64_t j = 0; j < num_indices[i]; ++j) {
+            sp_indices(c, 0) = i;
+            sp_indices(c, 1) = j;
+            ++c;
+          }
+        }
+        const std::vector<StringPiece>& tokens = block_tokens[block];
+        const int64_t offset = block_offsets[block];
+        if constexpr (kToHashBucket) {
+          auto sp_buckets = sp_tokens_t->vec<int64_t>();
+          for (size_t t = 0; t < tokens.size(); ++t) {
+            // The number of buckets is positive, so the cast is safe.
+            sp_buckets(offset + t) = static_cast<int64_t>(
+                Fingerprint64(tokens[t]) % static_cast<uint64>(num_buckets_));
+          }
+        } else {
+          // The output strings are allocated once with their final size.
+          auto sp_tokens = sp_tokens_t->vec<tstring>();
+          for (size_t t = 0; t < tokens.size(); ++t) {
+            sp_tokens(offset + t).assign(tokens[t].data(), tokens[t].size());
+          }
+        }
       }
-    }
+    };
+    Shard(worker_threads->num_threads, worker_threads->workers, num_blocks,
+          cost_per_block, write);
   }
 
  private:
+  // Guess that we'll be unpacking a handful of tokens per example.
+  static constexpr int kReserveSize = 4;
+  // Number of blocks of strings per thread, so that threads stay busy when
+  // the strings have different lengths.
+  static constexpr int64_t kBlocksPerThread = 4;
+  static constexpr int64_t kCostPerString = 50;
+  static constexpr int64_t kCostPerByte = 2;
+
   int maxsplit_;
+  int64_t num_buckets_ = 0;
 };
 
 REGISTER_KERNEL_BUILDER(Name("StringSplit").Device(DEVICE_CPU), StringSplitOp);
 REGISTER_KERNEL_BUILDER(Name("StringSplitV2").Device(DEVICE_CPU),
-                        StringSplitV2Op);
+                        StringSplitV2Op</*kToHashBucket=*/false>);
+REGISTER_KERNEL_BUILDER(
+    Name("_StringSplitToHashBucketFast").Device(DEVICE_CPU),
+    StringSplitV2Op</*kToHashBucket=*/true>);
 
 }  // namespace tensorflow
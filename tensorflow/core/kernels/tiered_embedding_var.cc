@@ -0,0 +1,475 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/tiered_embedding_var.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+namespace {
+
+// Number of rows sampled to pick a row to evict.
+constexpr int kNumEvictionSamples = 8;
+
+// The cold store is compacted once it has more than this many rows, at least
+// half of which are outdated.
+constexpr int64_t kMinCompactionRows = 1024;
+
+// Number of threads reading prefetched rows.
+constexpr int kNumPrefetchThreads = 2;
+
+// Reads `row_bytes` bytes at `offset` of `file` into `row`.
+Status ReadRow(const RandomAccessFile& file, int64_t offset, size_t row_bytes,
+               float* row) {
+  char* buffer = reinterpret_cast<char*>(row);
+  StringPiece result;
+  TF_RETURN_IF_ERROR(file.Read(offset, row_bytes, &result, buffer));
+  if (result.size() != row_bytes) {
+    return errors::DataLoss("Failed to read a row of ", row_bytes,
+                            " bytes at offset ", offset,
+                            " of a tiered embedding variable cold store: got ",
+                            result.size(), " bytes.");
+  }
+  if (result.data() != buffer) {
+    std::memcpy(buffer, result.data(), row_bytes);
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+Status TieredEmbeddingVar::Create(Env* env,
+                                  const TieredEmbeddingVarOptions& options,
+                                  TieredEmbeddingVar** var) {
+  if (options.embedding_dim <= 0) {
+    return errors::InvalidArgument(
+        "embedding_dim must be positive, got: ", options.embedding_dim);
+  }
+  if (options.hot_capacity <= 0) {
+    return errors::InvalidArgument("hot_capacity must be positive, got: ",
+                                   options.hot_capacity);
+  }
+  if (options.admission_threshold < 0) {
+    return errors::InvalidArgument(
+        "admission_threshold must be non-negative, got: ",
+        options.admission_threshold);
+  }
+  if (options.storage_path.empty()) {
+    return errors::InvalidArgument(
+        "A tiered embedding variable requires a storage_path for its cold "
+        "store.");
+  }
+  auto* new_var = new TieredEmbeddingVar(env, options);
+  Status s = new_var->Initialize();
+  if (!s.ok()) {
+    new_var->Unref();
+    return s;
+  }
+  *var = new_var;
+  return OkStatus();
+}
+
+TieredEmbeddingVar::TieredEmbeddingVar(Env* env,
+                                       const TieredEmbeddingVarOptions& options)
+    : env_(env),
+      options_(options),
+      row_bytes_(options.embedding_dim * sizeof(float)),
+      hot_values_(options.hot_capacity * options.embedding_dim),
+      hot_slots_(options.hot_capacity),
+      prefetch_thread_pool_(std::make_unique<thread::ThreadPool>(
+          env, "tiered_embedding_var_prefetch", kNumPrefetchThreads)) {
+  free_hot_slots_.reserve(options.hot_capacity);
+  for (int64_t slot = options.hot_capacity - 1; slot >= 0; --slot) {
+    free_hot_slots_.push_back(slot);
+  }
+}
+
+TieredEmbeddingVar::~TieredEmbeddingVar() {
+  // Waits for pending prefetches, which access the other members.
+  prefetch_thread_pool_.reset();
+  mutex_lock l(mu_);
+  cold_reader_.reset();
+  if (cold_writer_ != nullptr) {
+    cold_writer_->Close().IgnoreError();
+    cold_writer_.reset();
+    Status s = env_->DeleteFile(cold_filename_);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete tiered embedding variable cold store "
+                   << cold_filename_ << ": " << s;
+    }
+  }
+}
+
+Status TieredEmbeddingVar::Initialize() {
+  mutex_lock l(mu_);
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(options_.storage_path));
+  cold_file_prefix_ =
+      io::JoinPath(options_.storage_path, "tiered_embedding_var_");
+  if (!env_->CreateUniqueFileName(&cold_file_prefix_, "")) {
+    return errors::Internal(
+        "Failed to create a unique file name for a tiered embedding variable "
+        "cold store in ",
+        options_.storage_path);
+  }
+  return NewColdFile(&cold_filename_, &cold_writer_, &cold_reader_);
+}
+
+Status TieredEmbeddingVar::NewColdFile(
+    std::string* filename, std::unique_ptr<WritableFile>* writer,
+    std::shared_ptr<RandomAccessFile>* reader) {
+  *filename = absl::StrCat(cold_file_prefix_, "_", next_cold_file_id_++);
+  TF_RETURN_IF_ERROR(env_->NewWritableFile(*filename, writer));
+  std::unique_ptr<RandomAccessFile> new_reader;
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(*filename, &new_reader));
+  *reader = std::move(new_reader);
+  return OkStatus();
+}
+
+Status TieredEmbeddingVar::Gather(absl::Span<const int64_t> keys,
+                                  const float* default_value, float* values) {
+  const int64_t dim = options_.embedding_dim;
+  mutex_lock l(mu_);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    const int64_t key = keys[i];
+    float* row = values + i * dim;
+    KeyInfo& info = keys_[key];
+    ++info.frequency;
+    if (info.hot_slot >= 0) {
+      std::copy_n(HotRow(info.hot_slot), dim, row);
+      continue;
+    }
+
+    TF_ASSIGN_OR_RETURN(bool found, ReadColdRow(key, info, row));
+    if (!found) {
+      std::copy_n(default_value, dim, row);
+    }
+    if (info.frequency >= options_.admission_threshold) {
+      TF_RETURN_IF_ERROR(AdmitRow(key, info, row, /*dirty=*/!found));
+    } else if (!found) {
+      TF_RETURN_IF_ERROR(WriteColdRow(key, info, row));
+    }
+  }
+  return MaybeCompactColdStore();
+}
+
+Status TieredEmbeddingVar::ApplyGradientDescent(absl::Span<const int64_t> keys,
+                                                float alpha,
+                                                const float* grads) {
+  const int64_t dim = options_.embedding_dim;
+  std::vector<float> cold_row(dim);
+  mutex_lock l(mu_);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    const int64_t key = keys[i];
+    const float* grad = grads + i * dim;
+    KeyInfo& info = keys_[key];
+    if (info.hot_slot >= 0) {
+      float* row = HotRow(info.hot_slot);
+      for (int64_t j = 0; j < dim; ++j) {
+        row[j] -= alpha * grad[j];
+      }
+      HotSlot& slot = hot_slots_[info.hot_slot];
+      if (!slot.dirty) {
+        // The cold copy of the row is now outdated.
+        slot.dirty = true;
+        if (info.cold_offset >= 0) {
+          info.cold_offset = -1;
+          --num_live_cold_rows_;
+        }
+      }
+      continue;
+    }
+
+    TF_ASSIGN_OR_RETURN(bool found, ReadColdRow(key, info, cold_row.data()));
+    if (!found) {
+      std::fill(cold_row.begin(), cold_row.end(), 0.0f);
+    }
+    for (int64_t j = 0; j < dim; ++j) {
+      cold_row[j] -= alpha * grad[j];
+    }
+    TF_RETURN_IF_ERROR(WriteColdRow(key, info, cold_row.data()));
+  }
+  return MaybeCompactColdStore();
+}
+
+void TieredEmbeddingVar::Prefetch(absl::Span<const int64_t> keys) {
+  // Keys and cold store offsets of the rows to read.
+  std::vector<std::pair<int64_t, int64_t>> rows_to_read;
+  std::shared_ptr<RandomAccessFile> reader;
+  {
+    mutex_lock l(mu_);
+    for (const int64_t key : keys) {
+      // Prefetched rows are bounded by the memory budget of the hot tier.
+      if (prefetched_rows_.size() + prefetching_keys_.size() >=
+          options_.hot_capacity) {
+        break;
+      }
+      auto it = keys_.find(key);
+      if (it == keys_.end() || it->second.hot_slot >= 0 ||
+          it->second.cold_offset < 0 || prefetched_rows_.contains(key) ||
+          !prefetching_keys_.insert(key).second) {
+        continue;
+      }
+      rows_to_read.push_back({key, it->second.cold_offset});
+    }
+    if (rows_to_read.empty()) {
+      return;
+    }
+    Status s = FlushColdStore();
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to prefetch tiered embedding variable rows: "
+                   << s;
+      for (const auto& [key, offset] : rows_to_read) {
+        prefetching_keys_.erase(key);
+      }
+      return;
+    }
+    reader = cold_reader_;
+  }
+
+  prefetch_thread_pool_->Schedule(
+      [this, reader = std::move(reader),
+       rows_to_read = std::move(rows_to_read)]() {
+        std::vector<std::vector<float>> rows(rows_to_read.size());
+        std::vector<Status> statuses(rows_to_read.size());
+        for (size_t i = 0; i < rows_to_read.size(); ++i) {
+          rows[i].resize(options_.embedding_dim);
+          statuses[i] = ReadRow(*reader, rows_to_read[i].second, row_bytes_,
+                                rows[i].data());
+        }
+
+        mutex_lock l(mu_);
+        for (size_t i = 0; i < rows_to_read.size(); ++i) {
+          const auto& [key, offset] = rows_to_read[i];
+          prefetching_keys_.erase(key);
+          if (!statuses[i].ok()) {
+            VLOG(2) << "Failed to prefetch tiered embedding variable row "
+                    << key << ": " << statuses[i];
+            continue;
+          }
+          // Drops the row if it has changed since it was read.
+          auto it = keys_.find(key);
+          if (it == keys_.end() || it->second.hot_slot >= 0 ||
+              it->second.cold_offset != offset || reader != cold_reader_) {
+            continue;
+          }
+          prefetched_rows_[key] = std::move(rows[i]);
+        }
+      });
+}
+
+int64_t TieredEmbeddingVar::size() const {
+  tf_shared_lock l(mu_);
+  return keys_.size();
+}
+
+int64_t TieredEmbeddingVar::num_hot_rows() const {
+  tf_shared_lock l(mu_);
+  return options_.hot_capacity - free_hot_slots_.size();
+}
+
+int64_t TieredEmbeddingVar::num_prefetched_rows() const {
+  tf_shared_lock l(mu_);
+  return prefetched_rows_.size();
+}
+
+std::string TieredEmbeddingVar::DebugString() const {
+  tf_shared_lock l(mu_);
+  return absl::StrCat("TieredEmbeddingVar(embedding_dim=",
+                      options_.embedding_dim, ", rows=", keys_.size(),
+                      ", hot_rows=",
+                      options_.hot_capacity - free_hot_slots_.size(), ")");
+}
+
+int64_t TieredEmbeddingVar::MemoryUsed() const {
+  tf_shared_lock l(mu_);
+  return hot_values_.size() * sizeof(float) +
+         hot_slots_.size() * sizeof(HotSlot) +
+         keys_.size() * (sizeof(int64_t) + sizeof(KeyInfo)) +
+         prefetched_rows_.size() * row_bytes_;
+}
+
+float* TieredEmbeddingVar::HotRow(int64_t slot) {
+  return hot_values_.data() + slot * options_.embedding_dim;
+}
+
+StatusOr<bool> TieredEmbeddingVar::ReadColdRow(int64_t key,
+                                               const KeyInfo& info,
+                                               float* row) {
+  auto it = prefetched_rows_.find(key);
+  if (it != prefetched_rows_.end()) {
+    std::copy(it->second.begin(), it->second.end(), row);
+    prefetched_rows_.erase(it);
+    return true;
+  }
+  if (info.cold_offset < 0) {
+    return false;
+  }
+  TF_RETURN_IF_ERROR(FlushColdStore());
+  TF_RETURN_IF_ERROR(ReadRow(*cold_reader_, info.cold_offset, row_bytes_, row));
+  return true;
+}
+
+Status TieredEmbeddingVar::WriteColdRow(int64_t key, KeyInfo& info,
+                                        const float* row) {
+  TF_RETURN_IF_ERROR(cold_writer_->Append(
+      StringPiece(reinterpret_cast<const char*>(row), row_bytes_)));
+  if (info.cold_offset < 0) {
+    ++num_live_cold_rows_;
+  }
+  info.cold_offset = cold_file_size_;
+  cold_file_size_ += row_bytes_;
+  cold_store_dirty_ = true;
+  prefetched_rows_.erase(key);
+  return OkStatus();
+}
+
+Status TieredEmbeddingVar::AdmitRow(int64_t key, KeyInfo& info,
+                                    const float* row, bool dirty) {
+  int64_t slot;
+  if (!free_hot_slots_.empty()) {
+    slot = free_hot_slots_.back();
+    free_hot_slots_.pop_back();
+  } else {
+    TF_ASSIGN_OR_RETURN(slot, EvictRow());
+  }
+  std::copy_n(row, options_.embedding_dim, HotRow(slot));
+  hot_slots_[slot] = HotSlot{key, dirty};
+  info.hot_slot = slot;
+  if (dirty && info.cold_offset >= 0) {
+    info.cold_offset = -1;
+    --num_live_cold_rows_;
+  }
+  return OkStatus();
+}
+
+StatusOr<int64_t> TieredEmbeddingVar::EvictRow() {
+  // Samples a few slots and evicts the least frequently looked up row, which
+  // approximates LFU eviction without maintaining a priority queue.
+  int64_t victim_slot = -1;
+  int64_t victim_frequency = 0;
+  for (int i = 0; i < kNumEvictionSamples; ++i) {
+    // xorshift64
+    eviction_rng_ ^= eviction_rng_ << 13;
+    eviction_rng_ ^= eviction_rng_ >> 7;
+    eviction_rng_ ^= eviction_rng_ << 17;
+    const int64_t slot = eviction_rng_ % options_.hot_capacity;
+    const int64_t frequency = keys_.at(hot_slots_[slot].key).frequency;
+    if (victim_slot < 0 || frequency < victim_frequency) {
+      victim_slot = slot;
+      victim_frequency = frequency;
+    }
+  }
+
+  HotSlot& slot = hot_slots_[victim_slot];
+  KeyInfo& info = keys_.at(slot.key);
+  if (slot.dirty || info.cold_offset < 0) {
+    TF_RETURN_IF_ERROR(WriteColdRow(slot.key, info, HotRow(victim_slot)));
+  }
+  info.hot_slot = -1;
+  slot = HotSlot();
+  return victim_slot;
+}
+
+Status TieredEmbeddingVar::FlushColdStore() {
+  if (cold_store_dirty_) {
+    TF_RETURN_IF_ERROR(cold_writer_->Flush());
+    cold_store_dirty_ = false;
+  }
+  return OkStatus();
+}
+
+Status TieredEmbeddingVar::MaybeCompactColdStore() {
+  const int64_t num_cold_rows = cold_file_size_ / row_bytes_;
+  if (num_cold_rows <= kMinCompactionRows ||
+      num_cold_rows <= 2 * num_live_cold_rows_) {
+    return OkStatus();
+  }
+  TF_RETURN_IF_ERROR(FlushColdStore());
+
+  std::string filename;
+  std::unique_ptr<WritableFile> writer;
+  std::shared_ptr<RandomAccessFile> reader;
+  TF_RETURN_IF_ERROR(NewColdFile(&filename, &writer, &reader));
+  std::vector<std::pair<int64_t, int64_t>> new_offsets;
+  new_offsets.reserve(num_live_cold_rows_);
+  std::vector<float> row(options_.embedding_dim);
+  int64_t file_size = 0;
+  Status s;
+  for (const auto& [key, info] : keys_) {
+    if (info.cold_offset < 0) {
+      continue;
+    }
+    s = ReadRow(*cold_reader_, info.cold_offset, row_bytes_, row.data());
+    if (s.ok()) {
+      s = writer->Append(
+          StringPiece(reinterpret_cast<const char*>(row.data()), row_bytes_));
+    }
+    if (!s.ok()) {
+      break;
+    }
+    new_offsets.push_back({key, file_size});
+    file_size += row_bytes_;
+  }
+  if (s.ok()) {
+    s = writer->Flush();
+  }
+  if (!s.ok()) {
+    // Keeps the current cold store.
+    writer.reset();
+    env_->DeleteFile(filename).IgnoreError();
+    LOG(WARNING) << "Failed to compact tiered embedding variable cold store "
+                 << cold_filename_ << ": " << s;
+    return OkStatus();
+  }
+
+  for (const auto& [key, offset] : new_offsets) {
+    keys_.at(key).cold_offset = offset;
+  }
+  VLOG(2) << "Compacted tiered embedding variable cold store from "
+          << cold_file_size_ << " to " << file_size << " bytes.";
+  std::unique_ptr<WritableFile> old_writer =
+      std::exchange(cold_writer_, std::move(writer));
+  std::string old_filename = std::exchange(cold_filename_, std::move(filename));
+  cold_reader_ = std::move(reader);
+  cold_file_size_ = file_size;
+  // Prefetches still reading the old file keep it open.
+  s = old_writer->Close();
+  if (s.ok()) {
+    s = env_->DeleteFile(old_filename);
+  }
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete tiered embedding variable cold store "
+                 << old_filename << ": " << s;
+  }
+  return OkStatus();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,189 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_TIERED_EMBEDDING_VAR_H_
+#define TENSORFLOW_CORE_KERNELS_TIERED_EMBEDDING_VAR_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/resource_base.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Options of a `TieredEmbeddingVar`.
+struct TieredEmbeddingVarOptions {
+  // Number of values in each row.
+  int64_t embedding_dim = 0;
+  // Maximum number of rows kept in memory.
+  int64_t hot_capacity = 0;
+  // Number of lookups of a key after which its row is admitted into memory.
+  // Rows looked up less often stay in the cold store.
+  int64_t admission_threshold = 1;
+  // Local directory of the cold store, ideally on an SSD.
+  std::string storage_path;
+};
+
+// An embedding table keyed by int64 ids whose rows live in two tiers: up to
+// `hot_capacity` frequently looked up rows are kept in host memory, and all
+// other rows in a cold store on local disk. This allows tables larger than the
+// host memory of a single parameter server.
+//
+// The lookup frequency of each key decides which rows are kept in memory: a
+// row is admitted once its key has been looked up `admission_threshold` times,
+// and when memory is full, the least frequently looked up of a few sampled
+// rows is evicted to the cold store. `Prefetch` reads cold rows back in the
+// background so that a following `Gather` of the same keys does not wait for
+// the disk.
+//
+// The cold store is an append-only file of rows. Rows are appended when they
+// are evicted or updated, and the file is compacted when most of it holds
+// outdated rows.
+//
+// This class is thread-safe.
+class TieredEmbeddingVar : public ResourceBase {
+ public:
+  // Creates a variable in `*var`, which the caller owns a reference of.
+  static Status Create(Env* env, const TieredEmbeddingVarOptions& options,
+                       TieredEmbeddingVar** var);
+  ~TieredEmbeddingVar() override;
+
+  // Writes the rows of `keys` to `values`, a row-major [keys.size(),
+  // embedding_dim] buffer. Rows of keys which have never been seen are
+  // initialized to `default_value`, which has `embedding_dim` values.
+  Status Gather(absl::Span<const int64_t> keys, const float* default_value,
+                float* values);
+
+  // Updates the rows of `keys` to `row - alpha * grad`, where `grads` is a
+  // row-major [keys.size(), embedding_dim] buffer. Rows of keys which have
+  // never been seen start at zero. Updates do not count as lookups.
+  Status ApplyGradientDescent(absl::Span<const int64_t> keys, float alpha,
+                              const float* grads);
+
+  // Asynchronously reads the rows of `keys` which are only in the cold store
+  // into memory, ahead of a `Gather` of those keys.
+  void Prefetch(absl::Span<const int64_t> keys);
+
+  int64_t embedding_dim() const { return options_.embedding_dim; }
+
+  // Returns the number of rows.
+  int64_t size() const;
+  // Returns the number of rows in memory.
+  int64_t num_hot_rows() const;
+  // Returns the number of rows read ahead by `Prefetch` and not yet gathered.
+  int64_t num_prefetched_rows() const;
+
+  std::string DebugString() const override;
+  int64_t MemoryUsed() const override;
+
+ private:
+  struct KeyInfo {
+    // Number of lookups of the key.
+    int64_t frequency = 0;
+    // Index of the row in `hot_values_`, or -1 if the row is not in memory.
+    int64_t hot_slot = -1;
+    // Offset of the latest version of the row in the cold store, or -1 if the
+    // cold store does not have it.
+    int64_t cold_offset = -1;
+  };
+
+  struct HotSlot {
+    // Key of the row in this slot, or -1 if the slot is free.
+    int64_t key = -1;
+    // True if the row changed since it was last written to the cold store.
+    bool dirty = false;
+  };
+
+  TieredEmbeddingVar(Env* env, const TieredEmbeddingVarOptions& options);
+  Status Initialize();
+
+  // Creates a new empty cold store file.
+  Status NewColdFile(std::string* filename,
+                     std::unique_ptr<WritableFile>* writer,
+                     std::shared_ptr<RandomAccessFile>* reader)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the row in hot slot `slot`.
+  float* HotRow(int64_t slot) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Copies the current value of the row of `key`, which is not in memory, to
+  // `row`. Returns false if the row has never been written.
+  StatusOr<bool> ReadColdRow(int64_t key, const KeyInfo& info, float* row)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Writes `row` to the cold store as the latest version of the row of `key`.
+  Status WriteColdRow(int64_t key, KeyInfo& info, const float* row)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Moves `row` for `key` into memory, evicting another row if necessary.
+  Status AdmitRow(int64_t key, KeyInfo& info, const float* row, bool dirty)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Frees a hot slot by writing one of the least frequently used rows to the
+  // cold store, and returns the slot.
+  StatusOr<int64_t> EvictRow() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Flushes the rows written to the cold store so they can be read back.
+  Status FlushColdStore() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Rewrites the cold store without outdated rows if they make up most of it.
+  Status MaybeCompactColdStore() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Env* const env_;
+  const TieredEmbeddingVarOptions options_;
+  // Size of a row in bytes.
+  const size_t row_bytes_;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<int64_t, KeyInfo> keys_ TF_GUARDED_BY(mu_);
+
+  // Rows in memory, `hot_capacity * embedding_dim` values.
+  std::vector<float> hot_values_ TF_GUARDED_BY(mu_);
+  std::vector<HotSlot> hot_slots_ TF_GUARDED_BY(mu_);
+  std::vector<int64_t> free_hot_slots_ TF_GUARDED_BY(mu_);
+  // State of the pseudo-random generator sampling eviction candidates.
+  uint64_t eviction_rng_ TF_GUARDED_BY(mu_) = 0x9e3779b97f4a7c15;
+
+  // Cold store. The reader is shared with prefetches, which read outside the
+  // lock, so it stays valid when the store is compacted.
+  std::string cold_file_prefix_ TF_GUARDED_BY(mu_);
+  int64_t next_cold_file_id_ TF_GUARDED_BY(mu_) = 0;
+  std::string cold_filename_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<WritableFile> cold_writer_ TF_GUARDED_BY(mu_);
+  std::shared_ptr<RandomAccessFile> cold_reader_ TF_GUARDED_BY(mu_);
+  int64_t cold_file_size_ TF_GUARDED_BY(mu_) = 0;
+  // Number of rows whose latest version is in the cold store.
+  int64_t num_live_cold_rows_ TF_GUARDED_BY(mu_) = 0;
+  bool cold_store_dirty_ TF_GUARDED_BY(mu_) = false;
+
+  // Cold rows read by `Prefetch`, by key. A row is removed from here as soon
+  // as it is gathered or updated.
+  absl::flat_hash_map<int64_t, std::vector<float>> prefetched_rows_
+      TF_GUARDED_BY(mu_);
+  absl::flat_hash_set<int64_t> prefetching_keys_ TF_GUARDED_BY(mu_);
+
+  // Threads running prefetches. Declared last so that pending prefetches
+  // finish before the other members are destroyed.
+  std::unique_ptr<thread::ThreadPool> prefetch_thread_pool_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_TIERED_EMBEDDING_VAR_H_
@@ -0,0 +1,143 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Kernels of the ops on a `TieredEmbeddingVar`.
+
+#include <string>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/tiered_embedding_var.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/refcount.h"
+
+namespace tensorflow {
+namespace {
+
+class TieredEmbeddingVarOp : public ResourceOpKernel<TieredEmbeddingVar> {
+ public:
+  explicit TieredEmbeddingVarOp(OpKernelConstruction* ctx)
+      : ResourceOpKernel<TieredEmbeddingVar>(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("embedding_dim", &options_.embedding_dim));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("hot_capacity", &options_.hot_capacity));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("admission_threshold",
+                                     &options_.admission_threshold));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("storage_path", &options_.storage_path));
+    env_ = ctx->env();
+  }
+
+ private:
+  Status CreateResource(TieredEmbeddingVar** resource) override
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return TieredEmbeddingVar::Create(env_, options_, resource);
+  }
+
+  TieredEmbeddingVarOptions options_;
+  Env* env_;
+};
+
+// Returns the flat keys of `indices`.
+absl::Span<const int64_t> Keys(const Tensor& indices) {
+  return absl::MakeConstSpan(indices.flat<int64_t>().data(),
+                             indices.NumElements());
+}
+
+class TieredEmbeddingVarGatherOp : public OpKernel {
+ public:
+  explicit TieredEmbeddingVarGatherOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<TieredEmbeddingVar> var;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &var));
+    const Tensor& indices = ctx->input(1);
+    const Tensor& default_value = ctx->input(2);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(default_value.shape()),
+                errors::InvalidArgument(
+                    "default_value must be a vector, got shape ",
+                    default_value.shape().DebugString()));
+    OP_REQUIRES(ctx, default_value.NumElements() == var->embedding_dim(),
+                errors::InvalidArgument(
+                    "default_value must have embedding_dim = ",
+                    var->embedding_dim(), " elements, got ",
+                    default_value.NumElements()));
+
+    TensorShape output_shape = indices.shape();
+    output_shape.AddDim(var->embedding_dim());
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, output_shape, &output));
+    OP_REQUIRES_OK(ctx, var->Gather(Keys(indices),
+                                    default_value.flat<float>().data(),
+                                    output->flat<float>().data()));
+  }
+};
+
+class TieredEmbeddingVarSparseApplyGradientDescentOp : public OpKernel {
+ public:
+  explicit TieredEmbeddingVarSparseApplyGradientDescentOp(
+      OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<TieredEmbeddingVar> var;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &var));
+    const Tensor& alpha = ctx->input(1);
+    const Tensor& grad = ctx->input(2);
+    const Tensor& indices = ctx->input(3);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(alpha.shape()),
+                errors::InvalidArgument("alpha must be a scalar, got shape ",
+                                        alpha.shape().DebugString()));
+    TensorShape expected_grad_shape = indices.shape();
+    expected_grad_shape.AddDim(var->embedding_dim());
+    OP_REQUIRES(ctx, grad.shape() == expected_grad_shape,
+                errors::InvalidArgument(
+                    "grad must have shape ", expected_grad_shape.DebugString(),
+                    " to match indices, got ", grad.shape().DebugString()));
+    OP_REQUIRES_OK(ctx, var->ApplyGradientDescent(Keys(indices),
+                                                  alpha.scalar<float>()(),
+                                                  grad.flat<float>().data()));
+  }
+};
+
+class TieredEmbeddingVarPrefetchOp : public OpKernel {
+ public:
+  explicit TieredEmbeddingVarPrefetchOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<TieredEmbeddingVar> var;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &var));
+    var->Prefetch(Keys(ctx->input(1)));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("TieredEmbeddingVariable").Device(DEVICE_CPU),
+                        TieredEmbeddingVarOp);
+REGISTER_KERNEL_BUILDER(
+    Name("TieredEmbeddingVariableGather").Device(DEVICE_CPU),
+    TieredEmbeddingVarGatherOp);
+REGISTER_KERNEL_BUILDER(
+    Name("TieredEmbeddingVariableSparseApplyGradientDescent")
+        .Device(DEVICE_CPU),
+    TieredEmbeddingVarSparseApplyGradientDescentOp);
+REGISTER_KERNEL_BUILDER(
+    Name("TieredEmbeddingVariablePrefetch").Device(DEVICE_CPU),
+    TieredEmbeddingVarPrefetchOp);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,175 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/tiered_embedding_var.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+using ::testing::Each;
+using ::testing::ElementsAre;
+using ::testing::SizeIs;
+
+constexpr int64_t kEmbeddingDim = 2;
+
+TieredEmbeddingVarOptions Options(int64_t hot_capacity,
+                                  int64_t admission_threshold = 1) {
+  TieredEmbeddingVarOptions options;
+  options.embedding_dim = kEmbeddingDim;
+  options.hot_capacity = hot_capacity;
+  options.admission_threshold = admission_threshold;
+  EXPECT_TRUE(Env::Default()->LocalTempFilename(&options.storage_path));
+  return options;
+}
+
+core::RefCountPtr<TieredEmbeddingVar> CreateVar(
+    const TieredEmbeddingVarOptions& options) {
+  TieredEmbeddingVar* var = nullptr;
+  TF_CHECK_OK(TieredEmbeddingVar::Create(Env::Default(), options, &var));
+  return core::RefCountPtr<TieredEmbeddingVar>(var);
+}
+
+std::vector<float> Gather(TieredEmbeddingVar& var,
+                          const std::vector<int64_t>& keys) {
+  const std::vector<float> default_value(kEmbeddingDim, 0.5f);
+  std::vector<float> values(keys.size() * kEmbeddingDim);
+  TF_CHECK_OK(var.Gather(keys, default_value.data(), values.data()));
+  return values;
+}
+
+// Sets the row of each key in `keys` to `{key, -key}` by applying gradients
+// to the rows of new keys, which start at zero.
+void SetRows(TieredEmbeddingVar& var, const std::vector<int64_t>& keys) {
+  std::vector<float> grads;
+  for (int64_t key : keys) {
+    grads.push_back(-key);
+    grads.push_back(key);
+  }
+  TF_CHECK_OK(var.ApplyGradientDescent(keys, /*alpha=*/1.0, grads.data()));
+}
+
+TEST(TieredEmbeddingVarTest, GatherInitializesNewRows) {
+  core::RefCountPtr<TieredEmbeddingVar> var = CreateVar(Options(10));
+  EXPECT_THAT(Gather(*var, {1, 2, 1}), Each(0.5f));
+  EXPECT_EQ(var->size(), 2);
+  EXPECT_EQ(var->num_hot_rows(), 2);
+}
+
+TEST(TieredEmbeddingVarTest, ApplyGradientDescent) {
+  core::RefCountPtr<TieredEmbeddingVar> var = CreateVar(Options(10));
+  Gather(*var, {1, 2});
+  const std::vector<float> grads = {1.0, 2.0, 3.0, 4.0};
+  TF_ASSERT_OK(var->ApplyGradientDescent({1, 2}, /*alpha=*/0.5, grads.data()));
+  EXPECT_THAT(Gather(*var, {2, 1}), ElementsAre(-1.0, -1.5, 0.0, -0.5));
+}
+
+TEST(TieredEmbeddingVarTest, EvictsRowsToColdStore) {
+  core::RefCountPtr<TieredEmbeddingVar> var = CreateVar(Options(4));
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 100; ++key) {
+    keys.push_back(key);
+  }
+  SetRows(*var, keys);
+  for (int round = 0; round < 3; ++round) {
+    for (int64_t key : keys) {
+      EXPECT_THAT(Gather(*var, {key}), ElementsAre(key, -key));
+    }
+  }
+  EXPECT_EQ(var->size(), 100);
+  EXPECT_EQ(var->num_hot_rows(), 4);
+}
+
+TEST(TieredEmbeddingVarTest, AdmissionThreshold) {
+  core::RefCountPtr<TieredEmbeddingVar> var =
+      CreateVar(Options(/*hot_capacity=*/4, /*admission_threshold=*/3));
+  SetRows(*var, {7});
+  EXPECT_THAT(Gather(*var, {7}), ElementsAre(7, -7));
+  EXPECT_THAT(Gather(*var, {7}), ElementsAre(7, -7));
+  EXPECT_EQ(var->num_hot_rows(), 0);
+  EXPECT_THAT(Gather(*var, {7}), ElementsAre(7, -7));
+  EXPECT_EQ(var->num_hot_rows(), 1);
+}
+
+TEST(TieredEmbeddingVarTest, Prefetch) {
+  core::RefCountPtr<TieredEmbeddingVar> var =
+      CreateVar(Options(/*hot_capacity=*/4, /*admission_threshold=*/100));
+  SetRows(*var, {1, 2, 3});
+  var->Prefetch({1, 2, 3, 4});
+  for (int i = 0; i < 1000 && var->num_prefetched_rows() < 3; ++i) {
+    Env::Default()->SleepForMicroseconds(10 * 1000);
+  }
+  ASSERT_EQ(var->num_prefetched_rows(), 3);
+
+  // Updated rows are not read from stale prefetched copies.
+  SetRows(*var, {3});
+  EXPECT_EQ(var->num_prefetched_rows(), 2);
+  EXPECT_THAT(Gather(*var, {1, 2, 3}), ElementsAre(1, -1, 2, -2, 6, -6));
+  EXPECT_EQ(var->num_prefetched_rows(), 0);
+}
+
+TEST(TieredEmbeddingVarTest, CompactsColdStore) {
+  TieredEmbeddingVarOptions options =
+      Options(/*hot_capacity=*/4, /*admission_threshold=*/100);
+  core::RefCountPtr<TieredEmbeddingVar> var = CreateVar(options);
+  // Each update appends the updated rows to the cold store.
+  for (int i = 0; i < 500; ++i) {
+    SetRows(*var, {1, 2, 3, 4, 5});
+  }
+  EXPECT_THAT(Gather(*var, {1, 5}), ElementsAre(500, -500, 2500, -2500));
+
+  std::vector<std::string> files;
+  TF_ASSERT_OK(Env::Default()->GetChildren(options.storage_path, &files));
+  EXPECT_THAT(files, SizeIs(1));
+  uint64_t file_size = 0;
+  TF_ASSERT_OK(Env::Default()->GetFileSize(
+      io::JoinPath(options.storage_path, files[0]), &file_size));
+  EXPECT_LE(file_size, 2048 * kEmbeddingDim * sizeof(float));
+}
+
+TEST(TieredEmbeddingVarTest, DeletesColdStore) {
+  TieredEmbeddingVarOptions options = Options(/*hot_capacity=*/1);
+  {
+    core::RefCountPtr<TieredEmbeddingVar> var = CreateVar(options);
+    SetRows(*var, {1, 2, 3});
+  }
+  std::vector<std::string> files;
+  TF_ASSERT_OK(Env::Default()->GetChildren(options.storage_path, &files));
+  EXPECT_THAT(files, SizeIs(0));
+}
+
+TEST(TieredEmbeddingVarTest, InvalidOptions) {
+  TieredEmbeddingVar* var = nullptr;
+  TieredEmbeddingVarOptions options = Options(/*hot_capacity=*/0);
+  EXPECT_THAT(TieredEmbeddingVar::Create(Env::Default(), options, &var),
+              StatusIs(error::INVALID_ARGUMENT));
+  options = Options(/*hot_capacity=*/1);
+  options.storage_path.clear();
+  EXPECT_THAT(TieredEmbeddingVar::Create(Env::Default(), options, &var),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -142,6 +142,20 @@ struct TopKFunctor<CPUDevice, T> {
       return OkStatus();
     }
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+
+    // With few rows, the rows themselves are split across the threads.
+    const int64_t num_chunks =
+        std::min<int64_t>(Eigen::divup<int64_t>(worker_threads.num_threads,
+                                                num_rows),
+                          num_cols / kMinColsPerChunk);
+    if (k < num_cols && num_chunks > 1 &&
+        k * kMinColsPerCandidate <= num_cols / num_chunks) {
+      ComputeInRowChunks(worker_threads, sorted, k, input, num_rows, num_cols,
+                         num_chunks, values, indices);
+      return OkStatus();
+    }
+
     auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
       for (int32_t b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
@@ -229,12 +243,133 @@ struct TopKFunctor<CPUDevice, T> {
     const int64_t final_cost = (total_cost >= static_cast<double>(kint64max))
                                    ? kint64max
                                    : static_cast<int64_t>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
     return OkStatus();
   }
+
+ private:
+  // Rows are only split when every chunk has at least this many columns.
+  static constexpr int64_t kMinColsPerChunk = 1 << 14;
+  // ... and when every chunk has this many columns per candidate it keeps.
+  static constexpr int64_t kMinColsPerCandidate = 16;
+
+  // Computes the top k of every row by splitting the row into `num_chunks`
+  // chunks of columns. The chunks are reduced to their own top k in parallel,
+  // and the candidates of all chunks of a row are then merged. Both steps use
+  // the same order as the sequential implementation (larger values first,
+  // then smaller indices), so the results are the same.
+  static void ComputeInRowChunks(
+      const DeviceBase::CpuWorkerThreads& worker_threads, bool sorted, int k,
+      const typename TTypes<T, 2>::ConstTensor& input, const int64_t num_rows,
+      const int64_t num_cols, const int64_t num_chunks,
+      typename TTypes<T, 2>::Tensor values,
+      typename TTypes<int, 2>::Tensor indices) {
+    // The candidates of chunk c of row b start at (b * num_chunks + c) * k.
+    std::vector<int32> candidates(num_rows * num_chunks * k);
+
+    auto FindCandidates = [&](int64_t start, int64_t limit) {
+      for (int64_t unit = start; unit < limit; ++unit) {
+        const int64_t b = unit / num_chunks;
+        const int64_t chunk = unit % num_chunks;
+        const int32 chunk_begin = num_cols * chunk / num_chunks;
+        const int32 chunk_end = num_cols * (chunk + 1) / num_chunks;
+        const T* input_data = &input(b, 0);
+        const auto stable_comp = [input_data](const int32_t a,
+                                              const int32_t b) {
+          if (input_data[b] < input_data[a]) {
+            return true;
+          } else if (input_data[b] > input_data[a]) {
+            return false;
+          } else {
+            return a < b;
+          }
+        };
+        gtl::TopN<int32, decltype(stable_comp)> filter(k, stable_comp);
+        filter.reserve(k + 1);
+        int32 c = chunk_begin;
+        for (; c < chunk_begin + k; ++c) {
+          filter.push(c);
+        }
+        // Columns are visited in increasing order, so a column only enters
+        // the candidates if its value is larger than the smallest candidate.
+        // Most columns of a long row fail that test, and it is done for a
+        // block of columns at once, without branches.
+        T threshold = input_data[filter.peek_bottom()];
+        auto push = [&](int32 column) {
+          if (input_data[column] > threshold) {
+            filter.push(column);
+            threshold = input_data[filter.peek_bottom()];
+          }
+        };
+        constexpr int32 kBlockSize = 16;
+        for (; chunk_end - c >= kBlockSize; c += kBlockSize) {
+          bool any_larger = false;
+          for (int32 i = 0; i < kBlockSize; ++i) {
+            any_larger |= input_data[c + i] > threshold;
+          }
+          if (!any_larger) continue;
+          for (int32 i = 0; i < kBlockSize; ++i) {
+            push(c + i);
+          }
+        }
+        for (; c < chunk_end; ++c) {
+          push(c);
+        }
+        std::copy(filter.unsorted_begin(), filter.unsorted_end(),
+                  &candidates[unit * k]);
+      }
+    };
+    const double cmp_cost = Eigen::TensorOpCost::AddCost<T>();
+    const int64_t chunk_cost =
+        static_cast<int64_t>(cmp_cost * (num_cols / num_chunks));
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          num_rows * num_chunks, chunk_cost, FindCandidates);
+
+    auto MergeCandidates = [&](int64_t start_batch, int64_t limit_batch) {
+      for (int64_t b = start_batch; b < limit_batch; ++b) {
+        const T* input_data = &input(b, 0);
+        const auto stable_comp = [input_data](const int32_t a,
+                                              const int32_t b) {
+          if (input_data[b] < input_data[a]) {
+            return true;
+          } else if (input_data[b] > input_data[a]) {
+            return false;
+          } else {
+            return a < b;
+          }
+        };
+        gtl::TopN<int32, decltype(stable_comp)> filter(k, stable_comp);
+        filter.reserve(num_chunks * k);
+        const int32* row_candidates = &candidates[b * num_chunks * k];
+        for (int64_t i = 0; i < num_chunks * k; ++i) {
+          filter.push(row_candidates[i]);
+        }
+        int32_t i = 0;
+        if (sorted) {
+          std::unique_ptr<std::vector<int32>> top_k(filter.Extract());
+          for (auto top_k_it = top_k->begin(); top_k_it != top_k->end();
+               ++top_k_it, ++i) {
+            indices(b, i) = *top_k_it;
+          }
+        } else {
+          for (auto top_k_it = filter.unsorted_begin();
+               top_k_it != filter.unsorted_end(); ++top_k_it, ++i) {
+            indices(b, i) = *top_k_it;
+          }
+        }
+        std::transform(
+            &indices(b, 0), &indices(b, k), &values(b, 0),
+            [b, &input](const int32_t loc) { return input(b, loc); });
+      }
+    };
+    const int64_t merge_cost = static_cast<int64_t>(
+        4 * cmp_cost * num_chunks * k *
+        Eigen::numext::log2(static_cast<float>(k + 1)));
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          merge_cost, MergeCandidates);
+  }
 };
 
 }  // namespace functor
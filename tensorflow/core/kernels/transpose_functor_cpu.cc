@@ -15,7 +15,9 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
+#include <type_traits>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -68,12 +70,176 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+// Edge of the square micro-tiles transposed in registers.
+constexpr int64_t kMicroTile = 8;
+// Edge of the square tiles, made of micro-tiles, whose source and destination
+// stay in L1 while they are transposed.
+constexpr int64_t kCacheTile = 32;
+
+// Transposes the kMicroTile x kMicroTile block at `src` (whose rows are
+// `src_stride` apart) to `dst` (whose rows are `dst_stride` apart).
+template <typename T, bool conjugate>
+inline void TransposeMicroTile(const T* src, int64_t src_stride, T* dst,
+                               int64_t dst_stride) {
+  for (int64_t c = 0; c < kMicroTile; ++c) {
+    for (int64_t r = 0; r < kMicroTile; ++r) {
+      if (conjugate) {
+        dst[c * dst_stride + r] = Eigen::numext::conj(src[r * src_stride + c]);
+      } else {
+        dst[c * dst_stride + r] = src[r * src_stride + c];
+      }
+    }
+  }
+}
+
+#ifdef EIGEN_VECTORIZE_AVX
+// 32-bit elements: eight AVX registers hold the whole micro-tile.
+template <>
+inline void TransposeMicroTile<uint32, false>(const uint32* src,
+                                              int64_t src_stride, uint32* dst,
+                                              int64_t dst_stride) {
+  __m256 r[kMicroTile];
+  for (int i = 0; i < kMicroTile; ++i) {
+    r[i] =
+        _mm256_loadu_ps(reinterpret_cast<const float*>(src + i * src_stride));
+  }
+  __m256 t[kMicroTile];
+  for (int i = 0; i < kMicroTile; i += 2) {
+    t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+    t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+  }
+  for (int i = 0; i < kMicroTile; i += 4) {
+    r[i] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+    r[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+    r[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+    r[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+  }
+  for (int i = 0; i < kMicroTile / 2; ++i) {
+    _mm256_storeu_ps(reinterpret_cast<float*>(dst + i * dst_stride),
+                     _mm256_permute2f128_ps(r[i], r[i + 4], 0x20));
+    _mm256_storeu_ps(reinterpret_cast<float*>(dst + (i + 4) * dst_stride),
+                     _mm256_permute2f128_ps(r[i], r[i + 4], 0x31));
+  }
+}
+#endif  // EIGEN_VECTORIZE_AVX
+
+// Transposes the `rows` x `cols` matrix at `src` (whose rows are `src_stride`
+// apart) to `dst` (whose rows are `dst_stride` apart), one micro-tile at a
+// time.
+template <typename T, bool conjugate>
+void TransposeCacheTile(const T* src, int64_t src_stride, T* dst,
+                        int64_t dst_stride, int64_t rows, int64_t cols) {
+  const int64_t full_rows = rows - rows % kMicroTile;
+  const int64_t full_cols = cols - cols % kMicroTile;
+  for (int64_t r = 0; r < full_rows; r += kMicroTile) {
+    for (int64_t c = 0; c < full_cols; c += kMicroTile) {
+      TransposeMicroTile<T, conjugate>(src + r * src_stride + c, src_stride,
+                                       dst + c * dst_stride + r, dst_stride);
+    }
+  }
+  // Ragged edges.
+  for (int64_t r = 0; r < rows; ++r) {
+    for (int64_t c = r < full_rows ? full_cols : 0; c < cols; ++c) {
+      if (conjugate) {
+        dst[c * dst_stride + r] = Eigen::numext::conj(src[r * src_stride + c]);
+      } else {
+        dst[c * dst_stride + r] = src[r * src_stride + c];
+      }
+    }
+  }
+}
+
+// Transposes with cache tiling when the innermost dimension moves, which is
+// where Eigen's shuffle reads or writes with a large stride for every
+// element. `dims` and `perm` must be reduced as by ReduceTransposeDimensions,
+// with `perm[i]` the input dimension of output dimension `i`.
+// The input's innermost dimension `A` and the output's innermost dimension
+// `B` form a strided matrix for every index of the other dimensions; each
+// matrix is transposed in kCacheTile x kCacheTile tiles.
+// Returns false, doing nothing, if the permutation does not qualify.
+template <typename T, bool conjugate>
+bool TransposeBlocked(const CPUDevice& device, const Tensor& in,
+                      const internal::TransposeDimsVec& dims,
+                      const internal::TransposePermsVec& perm, Tensor* out) {
+  const int ndims = dims.size();
+  if (!std::is_trivially_copyable<T>::value || ndims < 2) return false;
+  const int a = ndims - 1;
+  const int b = perm[ndims - 1];
+  if (b == a || dims[a] < kMicroTile || dims[b] < kMicroTile) return false;
+
+  gtl::InlinedVector<int64_t, 8> in_strides(ndims, 1);
+  gtl::InlinedVector<int64_t, 8> out_strides(ndims, 1);
+  for (int i = ndims - 2; i >= 0; --i) {
+    in_strides[i] = in_strides[i + 1] * dims[i + 1];
+    out_strides[i] = out_strides[i + 1] * dims[perm[i + 1]];
+  }
+  // The output position of `A`, and the remaining "batch" dimensions, in
+  // output order.
+  const int a_out = std::find(perm.begin(), perm.end(), a) - perm.begin();
+  gtl::InlinedVector<int, 8> batch_dims;
+  for (int i = 0; i < ndims - 1; ++i) {
+    if (i != a_out) batch_dims.push_back(i);
+  }
+  const int64_t num_matrices = in.NumElements() / (dims[a] * dims[b]);
+  const int64_t num_row_tiles = (dims[b] + kCacheTile - 1) / kCacheTile;
+
+  const T* p = reinterpret_cast<const T*>(in.tensor_data().data());
+  T* q = reinterpret_cast<T*>(const_cast<char*>((out->tensor_data().data())));
+  // Every work unit transposes one strip of kCacheTile rows of a matrix.
+  auto transpose_fn = [&](int64_t begin, int64_t end) {
+    for (int64_t unit = begin; unit < end; ++unit) {
+      int64_t t = unit / num_row_tiles;
+      const int64_t row = (unit % num_row_tiles) * kCacheTile;
+      int64_t in_offset = row * in_strides[b];
+      int64_t out_offset = row;
+      for (int i = batch_dims.size() - 1; i >= 0; --i) {
+        const int k = batch_dims[i];
+        const int64_t size = dims[perm[k]];
+        const int64_t idx = t % size;
+        t /= size;
+        in_offset += idx * in_strides[perm[k]];
+        out_offset += idx * out_strides[k];
+      }
+      const int64_t rows = std::min(kCacheTile, dims[b] - row);
+      for (int64_t col = 0; col < dims[a]; col += kCacheTile) {
+        TransposeCacheTile<T, conjugate>(
+            p + in_offset + col, in_strides[b],
+            q + out_offset + col * out_strides[a_out], out_strides[a_out],
+            rows, std::min(kCacheTile, dims[a] - col));
+      }
+    }
+  };
+  const int64_t unit_elements = kCacheTile * dims[a];
+  Eigen::TensorOpCost cost(/*bytes_loaded=*/unit_elements * sizeof(T),
+                           /*bytes_stored=*/unit_elements * sizeof(T),
+                           /*compute_cycles=*/unit_elements);
+  device.parallelFor(num_matrices * num_row_tiles, cost,
+                     std::move(transpose_fn));
+  return true;
+}
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
+    if (in.dims() >= 2) {
+      internal::TransposePermsVec reduced_perm;
+      internal::TransposeDimsVec reduced_dims(in.dims());
+      internal::ReduceTransposeDimensions(in.shape(), perm, &reduced_perm,
+                                          &reduced_dims);
+      // `reduced_perm[i]` is the output position of input dimension `i`;
+      // invert it to get the output -> input mapping of `perm`.
+      internal::TransposePermsVec blocked_perm(reduced_perm.size());
+      for (int i = 0; i < reduced_perm.size(); ++i) {
+        blocked_perm[reduced_perm[i]] = i;
+      }
+      if (TransposeBlocked<T, conjugate>(d, in, reduced_dims, blocked_perm,
+                                         out)) {
+        return;
+      }
+    }
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
@@ -13,9 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -150,6 +153,13 @@ class UniqueOp : public OpKernel {
       auto Tin = input.flat<T>();
       const int64_t N = static_cast<int64_t>(Tin.size());
 
+      const auto* worker_threads =
+          context->device()->tensorflow_cpu_worker_threads();
+      if (N >= kMinParallelSize && worker_threads->num_threads > 1) {
+        ComputeInParallel(context, input.shape(), axis, Tin, idx_vec);
+        return;
+      }
+
       typename UniqueOpHashMap<T, TIndex>::map_type uniq;
       uniq.reserve(2 * N);
       for (Eigen::Index i = 0, j = 0; i < N; ++i) {
@@ -237,6 +247,186 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+ private:
+  // Inputs with fewer elements are uniquified by a single thread.
+  static constexpr int64_t kMinParallelSize = 1 << 16;
+  // Elements are partitioned by hash into at most this many partitions.
+  static constexpr int kMaxPartitions = 128;
+
+  // Computes all outputs for a vector of elements `Tin`, using the worker
+  // threads. The elements are partitioned by hash, so that equal elements fall
+  // into the same partition and every partition is uniquified independently.
+  // The unique elements are then numbered in order of first occurrence with a
+  // prefix sum over the input, which gives the same outputs as the sequential
+  // implementation.
+  void ComputeInParallel(OpKernelContext* context,
+                         const TensorShape& input_shape, int64_t axis,
+                         typename TTypes<T>::ConstFlat Tin,
+                         typename TTypes<TIndex>::Vec idx_vec) {
+    using map_type = typename UniqueOpHashMap<T, TIndex>::map_type;
+    const int64_t N = static_cast<int64_t>(Tin.size());
+    const auto* worker_threads =
+        context->device()->tensorflow_cpu_worker_threads();
+    const int num_partitions =
+        std::min(worker_threads->num_threads, kMaxPartitions);
+    // The input is split into as many contiguous chunks as there are
+    // partitions.
+    auto chunk_begin = [N, num_partitions](int64_t chunk) {
+      return N * chunk / num_partitions;
+    };
+    auto shard = [&](int64_t cost_per_element,
+                     const std::function<void(int64_t, int64_t)>& work) {
+      Shard(worker_threads->num_threads, worker_threads->workers,
+            num_partitions, cost_per_element * (N / num_partitions), work);
+    };
+
+    // Partition of each element, and later whether the element is the first
+    // occurrence of its value.
+    Tensor partition_of_t;
+    OP_REQUIRES_OK(context, context->allocate_temp(DT_UINT8, TensorShape({N}),
+                                                   &partition_of_t));
+    auto partition_of = partition_of_t.vec<uint8>();
+    // counts[chunk * num_partitions + partition] is the number of elements of
+    // the chunk in the partition.
+    std::vector<int64_t> counts(num_partitions * num_partitions, 0);
+    const typename map_type::hasher hasher;
+    shard(/*cost_per_element=*/20, [&](int64_t begin, int64_t end) {
+      for (int64_t chunk = begin; chunk < end; ++chunk) {
+        int64_t* chunk_counts = &counts[chunk * num_partitions];
+        for (int64_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+          // Multiplicative hashing spreads hash functions that are the
+          // identity on integers, and the high bits select the partition.
+          const uint64 mixed =
+              static_cast<uint64>(hasher(Tin(i))) * 0x9E3779B97F4A7C15ULL;
+          const uint8 partition = ((mixed >> 32) * num_partitions) >> 32;
+          partition_of(i) = partition;
+          ++chunk_counts[partition];
+        }
+      }
+    });
+
+    // Elements are stored grouped by partition, in input order within each
+    // partition. offsets[chunk * num_partitions + partition] is where the
+    // elements of the chunk in the partition start.
+    std::vector<int64_t> partition_begin(num_partitions + 1, 0);
+    std::vector<int64_t> offsets(num_partitions * num_partitions);
+    int64_t offset = 0;
+    for (int partition = 0; partition < num_partitions; ++partition) {
+      partition_begin[partition] = offset;
+      for (int chunk = 0; chunk < num_partitions; ++chunk) {
+        offsets[chunk * num_partitions + partition] = offset;
+        offset += counts[chunk * num_partitions + partition];
+      }
+    }
+    partition_begin[num_partitions] = offset;
+
+    Tensor positions_t;
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DataTypeToEnum<TIndex>::v(),
+                                          TensorShape({N}), &positions_t));
+    auto positions = positions_t.vec<TIndex>();
+    shard(/*cost_per_element=*/5, [&](int64_t begin, int64_t end) {
+      for (int64_t chunk = begin; chunk < end; ++chunk) {
+        int64_t* chunk_offsets = &offsets[chunk * num_partitions];
+        for (int64_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+          positions(chunk_offsets[partition_of(i)]++) = i;
+        }
+      }
+    });
+
+    // Uniquifies each partition. `idx_vec` temporarily holds the index of
+    // each element among the unique elements of its partition, and
+    // first_positions[partition] the positions of those unique elements.
+    std::vector<std::vector<TIndex>> first_positions(num_partitions);
+    shard(/*cost_per_element=*/50, [&](int64_t begin, int64_t end) {
+      for (int64_t partition = begin; partition < end; ++partition) {
+        std::vector<TIndex>& firsts = first_positions[partition];
+        map_type uniq;
+        uniq.reserve(partition_begin[partition + 1] -
+                     partition_begin[partition]);
+        for (int64_t k = partition_begin[partition];
+             k < partition_begin[partition + 1]; ++k) {
+          const TIndex i = positions(k);
+          auto it = uniq.emplace(Tin(i), static_cast<TIndex>(firsts.size()));
+          idx_vec(i) = it.first->second;
+          partition_of(i) = it.second;
+          if (it.second) {
+            firsts.push_back(i);
+          }
+        }
+      }
+    });
+
+    // Numbers the first occurrences in input order.
+    std::vector<int64_t> chunk_firsts(num_partitions + 1, 0);
+    shard(/*cost_per_element=*/1, [&](int64_t begin, int64_t end) {
+      for (int64_t chunk = begin; chunk < end; ++chunk) {
+        int64_t count = 0;
+        for (int64_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+          count += partition_of(i);
+        }
+        chunk_firsts[chunk + 1] = count;
+      }
+    });
+    for (int chunk = 0; chunk < num_partitions; ++chunk) {
+      chunk_firsts[chunk + 1] += chunk_firsts[chunk];
+    }
+    const int64_t uniq_size = chunk_firsts[num_partitions];
+    Tensor first_index_t;
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DataTypeToEnum<TIndex>::v(),
+                                          TensorShape({N}), &first_index_t));
+    auto first_index = first_index_t.vec<TIndex>();
+    shard(/*cost_per_element=*/1, [&](int64_t begin, int64_t end) {
+      for (int64_t chunk = begin; chunk < end; ++chunk) {
+        TIndex next = static_cast<TIndex>(chunk_firsts[chunk]);
+        for (int64_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+          if (partition_of(i)) {
+            first_index(i) = next++;
+          }
+        }
+      }
+    });
+
+    TensorShape output_shape(input_shape);
+    output_shape.set_dim(axis, uniq_size);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    auto Tout = output->flat<T>();
+    Tensor* count_output = nullptr;
+    if (num_outputs() > 2) {
+      OP_REQUIRES_OK(context,
+                     context->allocate_output(2, TensorShape({uniq_size}),
+                                              &count_output));
+      count_output->vec<TIndex>().setZero();
+    }
+
+    // Maps partition indices to output indices. Every unique element belongs
+    // to a single partition, so partitions write disjoint outputs.
+    shard(/*cost_per_element=*/10, [&](int64_t begin, int64_t end) {
+      for (int64_t partition = begin; partition < end; ++partition) {
+        const std::vector<TIndex>& firsts = first_positions[partition];
+        std::vector<TIndex> output_index(firsts.size());
+        for (size_t k = 0; k < firsts.size(); ++k) {
+          output_index[k] = first_index(firsts[k]);
+          Tout(output_index[k]) = Tin(firsts[k]);
+        }
+        for (int64_t k = partition_begin[partition];
+             k < partition_begin[partition + 1]; ++k) {
+          const TIndex i = positions(k);
+          idx_vec(i) = output_index[idx_vec(i)];
+        }
+        if (count_output != nullptr) {
+          auto count_output_vec = count_output->vec<TIndex>();
+          for (int64_t k = partition_begin[partition];
+               k < partition_begin[partition + 1]; ++k) {
+            count_output_vec(idx_vec(positions(k)))++;
+          }
+        }
+      }
+    });
+  }
 };
 
 #define REGISTER_UNIQUE(type)                                      \
@@ -371,6 +371,51 @@ TEST(ThreadPool, Parallelism) {
   }
 }
 
+TEST(ThreadPool, Stats) {
+  {
+    ThreadPool pool(Env::Default(), "test", kNumThreads);
+    ThreadPool::Stats stats;
+    EXPECT_FALSE(pool.GetStats(&stats));
+  }
+
+  setenv("TF_ENABLE_THREADPOOL_STATS", "1", /*overwrite=*/1);
+  ThreadPool pool(Env::Default(), "test_with_stats", 4);
+  unsetenv("TF_ENABLE_THREADPOOL_STATS");
+  const int kTasks = 100;
+  absl::BlockingCounter counter(kTasks);
+  for (int i = 0; i < kTasks; ++i) {
+    pool.Schedule([&counter]() { counter.DecrementCount(); });
+  }
+  counter.Wait();
+
+  // A task is counted right after it returns.
+  ThreadPool::Stats stats;
+  ASSERT_TRUE(pool.GetStats(&stats));
+  while (stats.tasks_completed < kTasks) {
+    Env::Default()->SleepForMicroseconds(1000);
+    ASSERT_TRUE(pool.GetStats(&stats));
+  }
+  EXPECT_EQ(stats.name, "test_with_stats");
+  EXPECT_EQ(stats.num_threads, 4);
+  EXPECT_EQ(stats.queue_depth, 0);
+  EXPECT_EQ(stats.tasks_completed, kTasks);
+  int64_t num_waits = 0;
+  int64_t num_runs = 0;
+  for (int i = 0; i < ThreadPool::Stats::kNumHistogramBins; ++i) {
+    num_waits += stats.wait_time_histogram[i];
+    num_runs += stats.run_time_histogram[i];
+  }
+  EXPECT_EQ(num_waits, kTasks);
+  EXPECT_EQ(num_runs, kTasks);
+  EXPECT_EQ(stats.busy_time_usecs_per_thread.size(), 4);
+
+  bool found = false;
+  ThreadPool::ForEachPoolStats([&found](const ThreadPool::Stats& stats) {
+    if (stats.name == "test_with_stats") found = true;
+  });
+  EXPECT_TRUE(found);
+}
+
 static void BM_Sequential(::testing::benchmark::State& state) {
   for (auto s : state) {
     state.PauseTiming();
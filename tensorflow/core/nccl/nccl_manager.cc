@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/annotated_traceme.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/util/env_var.h"
 #if GOOGLE_CUDA
 #include "tensorflow/compiler/xla/stream_executor/cuda/cuda_activation.h"
 #elif TENSORFLOW_USE_ROCM
@@ -148,6 +149,17 @@ void StringToNcclUniqueId(const string& str_id, ncclUniqueId* nccl_id) {
   }
 }
 
+bool GroupLaunchesFromEnv() {
+  bool group_launches;
+  Status s = ReadBoolFromEnvVar("TF_NCCL_GROUP_LAUNCHES",
+                                /*default_val=*/false, &group_launches);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring TF_NCCL_GROUP_LAUNCHES: " << s;
+    return false;
+  }
+  return group_launches;
+}
+
 }  // namespace
 
 // A `Collective` encapsulates state for a collective instance at one node.
@@ -225,7 +237,7 @@ struct NcclManager::Collective : public core::RefCounted {
   Status status;
 };
 
-NcclManager::NcclManager() {
+NcclManager::NcclManager() : group_launches_(GroupLaunchesFromEnv()) {
   VLOG(2) << "New NcclManager " << this;
 #if TENSORFLOW_USE_ROCM
   ++instance_count;
@@ -715,19 +727,189 @@ size_t ComputeBufferSize(const NcclManager::Participant* p,
 }
 }  // namespace
 
-void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
+bool NcclManager::LaunchKernel(Collective* collective, int p_idx,
+                               NcclStream* nccl_stream,
+                               ncclResult_t* result) {
 #if TENSORFLOW_USE_ROCM
   se::Stream* comm_stream = nccl_stream->stream;
 #else
   se::Stream* comm_stream = nccl_stream->stream.get();
 #endif
-  ScopedActivateExecutorContext scoped_context(nccl_stream->executor);
   const cudaStream_t* cu_stream = reinterpret_cast<const cudaStream_t*>(
       comm_stream->implementation()->GpuStreamMemberHack());
+  tensorflow::profiler::TraceMeConsumer traceme("Run Collective",
+                                                collective->trace_context);
+
+  ncclDataType_t data_type = ToNcclType(collective->data_type);
+  Participant* p = collective->participants[p_idx].get();
+  auto nccl_comm = collective->communicator->members[p_idx].nccl_comm;
+  ncclResult_t nccl_result = ncclSuccess;
+  switch (collective->type) {
+    case kAllReduce: {
+      const void* sendbuff = p->input->tensor_data().data();
+      void* recvbuff = const_cast<char*>(p->output->tensor_data().data());
+
+      VLOG(2) << "call NcclAllReduce collective_key "
+              << collective->collective_key << " participant " << p_idx
+              << " num_participants " << collective->participants.size()
+              << " sendbuff " << sendbuff << " recvbuff " << recvbuff
+              << " nccl_comm " << nccl_comm << " comm_stream " << comm_stream
+              << " cuda_stream " << cu_stream;
+      profiler::AnnotatedTraceMe traceme([&] {
+        return profiler::TraceMeEncode(
+            "ncclAllReduce",
+            {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
+             {"collective_type", "all_reduce"}});
+      });
+      nccl_result = ncclAllReduce(sendbuff, recvbuff, p->input->NumElements(),
+                                  data_type, collective->reduction_op,
+                                  nccl_comm, *cu_stream);
+      break;
+    }
+    case kBroadcast: {
+      const void* sendbuff = nullptr;
+      void* recvbuff = nullptr;
+      int num_elements = -1;
+      if (p->input) {
+        sendbuff = p->input->tensor_data().data();
+        num_elements = p->input->NumElements();
+      }
+      if (p->output) {
+        recvbuff = const_cast<char*>(p->output->tensor_data().data());
+        num_elements = p->output->NumElements();
+      } else {
+        // Operate in-place if no output (for the src node).
+        recvbuff = const_cast<void*>(sendbuff);
+      }
+      if (num_elements < 0) {
+        p->done_callback(errors::Internal(
+            "Both input and output are null in ncclBroadcast"));
+        collective->Unref();
+        return false;
+      }
+      VLOG(2) << "call NcclBroadcast collective_key "
+              << collective->collective_key << " participant " << p_idx
+              << " sendbuff " << sendbuff << " recvbuff " << recvbuff
+              << " nccl_comm " << nccl_comm << " comm_stream " << comm_stream
+              << " cuda_stream " << cu_stream;
+      profiler::AnnotatedTraceMe traceme([&] {
+        return profiler::TraceMeEncode(
+            "ncclBroadcast",
+            {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
+             {"collective_type", "broadcast"}});
+      });
+      nccl_result =
+          ncclBroadcast(sendbuff, recvbuff, num_elements, data_type,
+                        collective->root_rank, nccl_comm, *cu_stream);
+      break;
+    }
+    case kReduce: {
+      const void* sendbuff = p->input->tensor_data().data();
+      void* recvbuff =
+          p->output ? const_cast<char*>(p->output->tensor_data().data())
+                    : nullptr;
+      profiler::AnnotatedTraceMe traceme([&] {
+        return profiler::TraceMeEncode(
+            "buffer_size",
+            {{"output_size", ComputeBufferSize(p, collective->data_type)},
+             {"collective_type", "reduce"}});
+      });
+      nccl_result = ncclReduce(sendbuff, recvbuff, p->input->NumElements(),
+                               data_type, collective->reduction_op,
+                               collective->root_rank, nccl_comm, *cu_stream);
+      break;
+    }
+    case kAllGather: {
+      const void* sendbuff = p->input->tensor_data().data();
+      void* recvbuff = const_cast<char*>(p->output->tensor_data().data());
+
+      VLOG(2) << "call NcclAllGather collective_key "
+              << collective->collective_key << " participant " << p_idx
+              << " sendbuff " << sendbuff << " sendcount "
+              << p->input->NumElements() << " recvbuff " << recvbuff
+              << " recvcount " << p->output->NumElements() << " nccl_comm "
+              << nccl_comm << " comm_stream " << comm_stream
+              << " cuda_stream " << cu_stream;
+      profiler::AnnotatedTraceMe traceme([&] {
+        return profiler::TraceMeEncode(
+            "ncclAllGather",
+            {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
+             {"collective_type", "all_gather"}});
+      });
+      nccl_result = ncclAllGather(sendbuff, recvbuff, p->input->NumElements(),
+                                  data_type, nccl_comm, *cu_stream);
+      break;
+    }
+    case kReduceScatter: {
+      const void* sendbuff = p->input->tensor_data().data();
+      void* recvbuff = const_cast<char*>(p->output->tensor_data().data());
+
+      VLOG(2) << "call NcclReduceScatter collective_key "
+              << collective->collective_key << " participant " << p_idx
+              << " num_participants " << collective->participants.size()
+              << " sendbuff " << sendbuff << " recvbuff " << recvbuff
+              << " nccl_comm " << nccl_comm << " comm_stream " << comm_stream
+              << " cuda_stream " << cu_stream;
+      profiler::AnnotatedTraceMe traceme([&] {
+        return profiler::TraceMeEncode(
+            "ncclReduceScatter",
+            {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
+             {"collective_type", "reduce_scatter"}});
+      });
+      nccl_result = ncclReduceScatter(
+          sendbuff, recvbuff, p->output->NumElements(), data_type,
+          collective->reduction_op, nccl_comm, *cu_stream);
+      break;
+    }
+    case kAllToAll: {
+      const char* sendbuff = p->input->tensor_data().data();
+      char* recvbuff = const_cast<char*>(p->output->tensor_data().data());
+      size_t count =
+          p->input->NumElements() / collective->participants.size();
+      size_t rank_offset = count * DataTypeSize(collective->data_type);
+
+      VLOG(2) << "call Nccl All to All collective_key "
+              << collective->collective_key << " participant " << p_idx
+              << " num_participants " << collective->participants.size()
+              << " sendbuff " << static_cast<const char*>(sendbuff)
+              << " recvbuff " << static_cast<char*>(recvbuff) << " nccl_comm "
+              << nccl_comm << " comm_stream " << comm_stream
+              << " cuda_stream " << cu_stream;
+      profiler::AnnotatedTraceMe traceme([&] {
+        return profiler::TraceMeEncode(
+            "ncclAllToAll",
+            {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
+             {"collective_type", "all_to_all"}});
+      });
+      ncclGroupStart();
+      for (int r = 0; r < collective->participants.size(); ++r) {
+        ncclSend(sendbuff + r * rank_offset, count, data_type, r, nccl_comm,
+                 *cu_stream);
+        ncclRecv(recvbuff + r * rank_offset, count, data_type, r, nccl_comm,
+                 *cu_stream);
+      }
+      nccl_result = ncclGroupEnd();
+      break;
+    }
+  }
+  *result = nccl_result;
+  return true;
+}
+
+void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
+#if TENSORFLOW_USE_ROCM
+  se::Stream* comm_stream = nccl_stream->stream;
+#else
+  se::Stream* comm_stream = nccl_stream->stream.get();
+#endif
+  ScopedActivateExecutorContext scoped_context(nccl_stream->executor);
 
+  std::vector<std::pair<Collective*, int>> launches;
+  std::vector<ncclResult_t> results;
+  std::vector<bool> launched;
   while (true) {
-    // Find collective to run.
-    std::pair<Collective*, int> next_launch;
+    // Find collectives to run.
+    launches.clear();
     {
       VLOG(3) << "Locking mutex nccl_stream " << nccl_stream;
       mutex_lock l(nccl_stream->mu);
@@ -738,185 +920,61 @@ void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
         }
         nccl_stream->cv.wait(l);
       }
-      next_launch = nccl_stream->pending_launches_.back();
-      nccl_stream->pending_launches_.pop_back();
+      // With grouped launches, take every collective queued so far, in the
+      // order in which they were queued.
+      do {
+        launches.push_back(nccl_stream->pending_launches_.back());
+        nccl_stream->pending_launches_.pop_back();
+      } while (group_launches_ && !nccl_stream->pending_launches_.empty());
     }
 
-    // Launch the nccl kernel.
-    Collective* collective = next_launch.first;
-    tensorflow::profiler::TraceMeConsumer traceme("Run Collective",
-                                                  collective->trace_context);
-
-    ncclDataType_t data_type = ToNcclType(collective->data_type);
-    int p_idx = next_launch.second;
-    Participant* p = collective->participants[p_idx].get();
-    auto nccl_comm = collective->communicator->members[p_idx].nccl_comm;
-    ncclResult_t nccl_result = ncclSuccess;
-    switch (collective->type) {
-      case kAllReduce: {
-        const void* sendbuff = p->input->tensor_data().data();
-        void* recvbuff = const_cast<char*>(p->output->tensor_data().data());
-
-        VLOG(2) << "call NcclAllReduce collective_key "
-                << collective->collective_key << " participant " << p_idx
-                << " num_participants " << collective->participants.size()
-                << " sendbuff " << sendbuff << " recvbuff " << recvbuff
-                << " nccl_comm " << nccl_comm << " comm_stream " << comm_stream
-                << " cuda_stream " << cu_stream;
-        profiler::AnnotatedTraceMe traceme([&] {
-          return profiler::TraceMeEncode(
-              "ncclAllReduce",
-              {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
-               {"collective_type", "all_reduce"}});
-        });
-        nccl_result = ncclAllReduce(sendbuff, recvbuff, p->input->NumElements(),
-                                    data_type, collective->reduction_op,
-                                    nccl_comm, *cu_stream);
-        break;
-      }
-      case kBroadcast: {
-        const void* sendbuff = nullptr;
-        void* recvbuff = nullptr;
-        int num_elements = -1;
-        if (p->input) {
-          sendbuff = p->input->tensor_data().data();
-          num_elements = p->input->NumElements();
-        }
-        if (p->output) {
-          recvbuff = const_cast<char*>(p->output->tensor_data().data());
-          num_elements = p->output->NumElements();
-        } else {
-          // Operate in-place if no output (for the src node).
-          recvbuff = const_cast<void*>(sendbuff);
-        }
-        if (num_elements < 0) {
-          p->done_callback(errors::Internal(
-              "Both input and output are null in ncclBroadcast"));
-          collective->Unref();
-          continue;
-        }
-        VLOG(2) << "call NcclBroadcast collective_key "
-                << collective->collective_key << " participant " << p_idx
-                << " sendbuff " << sendbuff << " recvbuff " << recvbuff
-                << " nccl_comm " << nccl_comm << " comm_stream " << comm_stream
-                << " cuda_stream " << cu_stream;
-        profiler::AnnotatedTraceMe traceme([&] {
-          return profiler::TraceMeEncode(
-              "ncclBroadcast",
-              {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
-               {"collective_type", "broadcast"}});
-        });
-        nccl_result =
-            ncclBroadcast(sendbuff, recvbuff, num_elements, data_type,
-                          collective->root_rank, nccl_comm, *cu_stream);
-        break;
-      }
-      case kReduce: {
-        const void* sendbuff = p->input->tensor_data().data();
-        void* recvbuff =
-            p->output ? const_cast<char*>(p->output->tensor_data().data())
-                      : nullptr;
-        profiler::AnnotatedTraceMe traceme([&] {
-          return profiler::TraceMeEncode(
-              "buffer_size",
-              {{"output_size", ComputeBufferSize(p, collective->data_type)},
-               {"collective_type", "reduce"}});
-        });
-        nccl_result = ncclReduce(sendbuff, recvbuff, p->input->NumElements(),
-                                 data_type, collective->reduction_op,
-                                 collective->root_rank, nccl_comm, *cu_stream);
-        break;
-      }
-      case kAllGather: {
-        const void* sendbuff = p->input->tensor_data().data();
-        void* recvbuff = const_cast<char*>(p->output->tensor_data().data());
-
-        VLOG(2) << "call NcclAllGather collective_key "
-                << collective->collective_key << " participant " << p_idx
-                << " sendbuff " << sendbuff << " sendcount "
-                << p->input->NumElements() << " recvbuff " << recvbuff
-                << " recvcount " << p->output->NumElements() << " nccl_comm "
-                << nccl_comm << " comm_stream " << comm_stream
-                << " cuda_stream " << cu_stream;
-        profiler::AnnotatedTraceMe traceme([&] {
-          return profiler::TraceMeEncode(
-              "ncclAllGather",
-              {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
-               {"collective_type", "all_gather"}});
-        });
-        nccl_result = ncclAllGather(sendbuff, recvbuff, p->input->NumElements(),
-                                    data_type, nccl_comm, *cu_stream);
-        break;
-      }
-      case kReduceScatter: {
-        const void* sendbuff = p->input->tensor_data().data();
-        void* recvbuff = const_cast<char*>(p->output->tensor_data().data());
+    // Launch the nccl kernels. Several launches are issued in one NCCL group,
+    // which launches them together instead of paying the launch overhead of
+    // each collective separately.
+    const bool grouped = launches.size() > 1;
+    ncclResult_t group_result = ncclSuccess;
+    if (grouped) {
+      VLOG(2) << "Launching " << launches.size()
+              << " Nccl kernels in a group on comm_stream " << comm_stream;
+      group_result = ncclGroupStart();
+    }
+    results.assign(launches.size(), ncclSuccess);
+    launched.assign(launches.size(), false);
+    for (int i = 0; i < launches.size(); ++i) {
+      launched[i] = LaunchKernel(launches[i].first, launches[i].second,
+                                 nccl_stream, &results[i]);
+    }
+    if (grouped) {
+      const ncclResult_t group_end_result = ncclGroupEnd();
+      if (group_result == ncclSuccess) group_result = group_end_result;
+    }
 
-        VLOG(2) << "call NcclReduceScatter collective_key "
+    for (int i = 0; i < launches.size(); ++i) {
+      if (!launched[i]) continue;
+      Collective* collective = launches[i].first;
+      const int p_idx = launches[i].second;
+      Participant* p = collective->participants[p_idx].get();
+      // Errors of a group are reported by ncclGroupEnd().
+      const ncclResult_t nccl_result =
+          results[i] != ncclSuccess ? results[i] : group_result;
+
+      // Run the done_callback when the nccl kernel finishes running.
+      auto done_callback = [collective, p_idx, nccl_result]() {
+        VLOG(2) << "done Nccl kernel collective_key "
                 << collective->collective_key << " participant " << p_idx
-                << " num_participants " << collective->participants.size()
-                << " sendbuff " << sendbuff << " recvbuff " << recvbuff
-                << " nccl_comm " << nccl_comm << " comm_stream " << comm_stream
-                << " cuda_stream " << cu_stream;
-        profiler::AnnotatedTraceMe traceme([&] {
-          return profiler::TraceMeEncode(
-              "ncclReduceScatter",
-              {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
-               {"collective_type", "reduce_scatter"}});
-        });
-        nccl_result = ncclReduceScatter(
-            sendbuff, recvbuff, p->output->NumElements(), data_type,
-            collective->reduction_op, nccl_comm, *cu_stream);
-        break;
-      }
-      case kAllToAll: {
-        const char* sendbuff = p->input->tensor_data().data();
-        char* recvbuff = const_cast<char*>(p->output->tensor_data().data());
-        size_t count =
-            p->input->NumElements() / collective->participants.size();
-        size_t rank_offset = count * DataTypeSize(collective->data_type);
-
-        VLOG(2) << "call Nccl All to All collective_key "
-                << collective->collective_key << " participant " << p_idx
-                << " num_participants " << collective->participants.size()
-                << " sendbuff " << static_cast<const char*>(sendbuff)
-                << " recvbuff " << static_cast<char*>(recvbuff) << " nccl_comm "
-                << nccl_comm << " comm_stream " << comm_stream
-                << " cuda_stream " << cu_stream;
-        profiler::AnnotatedTraceMe traceme([&] {
-          return profiler::TraceMeEncode(
-              "ncclAllToAll",
-              {{"buffer_size", ComputeBufferSize(p, collective->data_type)},
-               {"collective_type", "all_to_all"}});
-        });
-        ncclGroupStart();
-        for (int r = 0; r < collective->participants.size(); ++r) {
-          ncclSend(sendbuff + r * rank_offset, count, data_type, r, nccl_comm,
-                   *cu_stream);
-          ncclRecv(recvbuff + r * rank_offset, count, data_type, r, nccl_comm,
-                   *cu_stream);
+                << " ncclResult " << nccl_result;
+        if (nccl_result == ncclSuccess) {
+          collective->participants[p_idx]->done_callback(OkStatus());
+        } else {
+          // Propagate the error, but note that if other members of the
+          // collective did launch their kernels, then they are hanging.
+          collective->participants[p_idx]->done_callback(errors::Unknown(
+              "Error invoking NCCL: ", ncclGetErrorString(nccl_result)));
         }
-        nccl_result = ncclGroupEnd();
-        break;
-      }
+        collective->Unref();
+      };
+      p->event_mgr->ThenExecute(comm_stream, done_callback);
     }
-
-    // Run the done_callback when the nccl kernel finishes running.
-    auto done_callback = [collective, p_idx, nccl_result]() {
-      VLOG(2) << "done Nccl kernel collective_key "
-              << collective->collective_key << " participant " << p_idx
-              << " ncclResult " << nccl_result;
-      if (nccl_result == ncclSuccess) {
-        collective->participants[p_idx]->done_callback(OkStatus());
-      } else {
-        // Propagate the error, but note that if other members of the collective
-        // did launch their kernels, then they are hanging.
-        collective->participants[p_idx]->done_callback(errors::Unknown(
-            "Error invoking NCCL: ", ncclGetErrorString(nccl_result)));
-      }
-      collective->Unref();
-    };
-    p->event_mgr->ThenExecute(comm_stream, done_callback);
   }
 }
 
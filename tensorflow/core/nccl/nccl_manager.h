@@ -256,6 +256,17 @@ class NcclManager {
   void RunCollective(Collective* collective);
   void LoopKernelLaunches(NcclStream* stream);
 
+  // Enqueues the NCCL kernel of participant `p_idx` of `collective` on
+  // `nccl_stream` and sets `*result` to the NCCL result. Returns false if the
+  // participant was instead completed with an error.
+  bool LaunchKernel(Collective* collective, int p_idx, NcclStream* nccl_stream,
+                    ncclResult_t* result);
+
+  // If true, LoopKernelLaunches launches all the collectives queued on a
+  // stream in one NCCL group. Set by the TF_NCCL_GROUP_LAUNCHES environment
+  // variable.
+  const bool group_launches_;
+
   mutex mu_;
 
   // Maps key to collectives currently being assembled or run.
@@ -280,4 +280,28 @@ REGISTER_OP("CollectiveAllToAllV3")
     .SetIsDistributedCommunication()
     .SetShapeFn(shape_inference::UnchangedShape);
 
+REGISTER_OP("CollectiveAllToAllSplitV")
+    .Input("input: T")
+    .Input("communicator: resource")
+    .Input("group_assignment: int32")
+    .Input("send_splits: int64")
+    .Input("recv_splits: int64")
+    .Output("data: T")
+    .Attr("T: {bfloat16, float, float16, float64, int32, int64}")
+    .Attr("timeout_seconds: float = 0")
+    .SetIsStateful()
+    .SetIsDistributedCommunication()
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 1, &unused));
+      // The output has sum(recv_splits) rows of the same shape as the input.
+      shape_inference::ShapeHandle input;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &input));
+      shape_inference::ShapeHandle output;
+      TF_RETURN_IF_ERROR(c->ReplaceDim(input, 0, c->UnknownDim(), &output));
+      c->set_output(0, output);
+      return OkStatus();
+    });
+
 }  // namespace tensorflow
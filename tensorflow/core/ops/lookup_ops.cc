@@ -384,6 +384,14 @@ REGISTER_OP("AnonymousHashTable")
     .SetIsStateful()
     .SetShapeFn(ScalarOutput);
 
+REGISTER_OP("PerfectHashTable")
+    .Output("table_handle: resource")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("use_node_name_sharing: bool = false")
+    .SetIsStateful()
+    .SetShapeFn(ScalarOutput);
+
 REGISTER_OP("MutableHashTable")
     .Output("table_handle: Ref(string)")
     .Attr("container: string = ''")
@@ -550,4 +558,73 @@ REGISTER_OP("InitializeTableFromTextFileV2")
       return OkStatus();
     });
 
+REGISTER_OP("InitializeTableFromPerfectHashFile")
+    .Input("table_handle: resource")
+    .Input("filename: string")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &handle));
+      return OkStatus();
+    });
+
+REGISTER_OP("TieredEmbeddingVariable")
+    .Output("resource: resource")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("embedding_dim: int >= 1")
+    .Attr("hot_capacity: int >= 1")
+    .Attr("admission_threshold: int >= 0 = 1")
+    .Attr("storage_path: string")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::ScalarShape);
+
+REGISTER_OP("TieredEmbeddingVariableGather")
+    .Input("resource: resource")
+    .Input("indices: int64")
+    .Input("default_value: float")
+    .Output("output: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      ShapeHandle default_value;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &default_value));
+      ShapeHandle output;
+      TF_RETURN_IF_ERROR(
+          c->Concatenate(c->input(1), default_value, &output));
+      c->set_output(0, output);
+      return OkStatus();
+    });
+
+REGISTER_OP("TieredEmbeddingVariableSparseApplyGradientDescent")
+    .Input("resource: resource")
+    .Input("alpha: float")
+    .Input("grad: float")
+    .Input("indices: int64")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      // `grad` has the shape of the gathered rows of `indices`.
+      ShapeHandle indices = c->input(3);
+      if (c->RankKnown(indices)) {
+        TF_RETURN_IF_ERROR(
+            c->WithRank(c->input(2), c->Rank(indices) + 1, &unused));
+        ShapeHandle grad_indices;
+        TF_RETURN_IF_ERROR(
+            c->Subshape(c->input(2), 0, c->Rank(indices), &grad_indices));
+        TF_RETURN_IF_ERROR(c->Merge(grad_indices, indices, &unused));
+      }
+      return OkStatus();
+    });
+
+REGISTER_OP("TieredEmbeddingVariablePrefetch")
+    .Input("resource: resource")
+    .Input("indices: int64")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      return c->WithRank(c->input(0), 0, &unused);
+    });
+
 }  // namespace tensorflow
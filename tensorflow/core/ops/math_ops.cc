@@ -978,6 +978,81 @@ REGISTER_OP("SparseMatMul")
     .Attr("Tb: {float, bfloat16} = DT_FLOAT")
     .SetShapeFn(shape_inference::MatMulShape);
 
+REGISTER_OP("_BlockSparseMatMul")
+    .Input("a: T")
+    .Input("block_values: T")
+    .Input("block_col_ptr: int32")
+    .Input("block_row_indices: int32")
+    .Output("product: T")
+    .Attr("T: {float}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle a;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 2, &a));
+      ShapeHandle block_values;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 3, &block_values));
+      ShapeHandle block_col_ptr;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &block_col_ptr));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &unused));
+
+      DimensionHandle num_block_cols;
+      TF_RETURN_IF_ERROR(
+          c->Subtract(c->Dim(block_col_ptr, 0), 1, &num_block_cols));
+      DimensionHandle num_cols;
+      TF_RETURN_IF_ERROR(
+          c->Multiply(num_block_cols, c->Dim(block_values, 2), &num_cols));
+      c->set_output(0, c->Matrix(c->Dim(a, 0), num_cols));
+      return OkStatus();
+    })
+    .Doc(R"doc(
+Internal operation which multiplies a dense matrix `a` by a matrix `b` that is
+stored as dense blocks of shape `block_values.shape[1:]`: reserved for internal
+use.
+
+`b` is stored by columns of blocks. The blocks of the j-th column of blocks are
+`block_values[block_col_ptr[j]:block_col_ptr[j + 1]]`, and
+`block_row_indices` holds the row of blocks of each block. Blocks that are not
+stored are zero.
+
+Do not invoke this operator directly in Python. A graph optimization is
+expected to create these operators for constant weights.
+)doc");
+
+REGISTER_OP("_DynamicQuantizedMatMul")
+    .Input("a: T")
+    .Input("b: int8")
+    .Input("b_scales: T")
+    .Output("product: T")
+    .Attr("T: {float}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle a;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 2, &a));
+      ShapeHandle b;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &b));
+      ShapeHandle b_scales;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &b_scales));
+
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(a, 1), c->Dim(b, 1), &unused));
+      DimensionHandle num_cols;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(b, 0), c->Dim(b_scales, 0), &num_cols));
+      c->set_output(0, c->Matrix(c->Dim(a, 0), num_cols));
+      return OkStatus();
+    })
+    .Doc(R"doc(
+Internal operation which multiplies a float matrix `a` by the int8 quantized
+matrix `b`: reserved for internal use.
+
+`b` has shape `[n, k]` and holds the transposed weights, quantized
+symmetrically per output channel, so that the weights are
+`transpose(b) * b_scales`. Every row of `a` is quantized symmetrically to int8
+on the fly, the product is accumulated in int32 and scaled back to float.
+
+Do not invoke this operator directly in Python. A graph optimization is
+expected to create these operators for constant weights.
+)doc");
+
 REGISTER_OP("_FusedMatMul")
     .Input("a: T")
     .Input("b: T")
@@ -1016,6 +1091,33 @@ _FusedConv2D output.
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_FusedElementwise")
+    .Input("x: T")
+    .Input("args: num_args * T")
+    .Output("y: Tout")
+    .Attr("T: {float, double}")
+    .Attr("Tout: {half, bfloat16, float, double}")
+    .Attr("num_args: int >= 0")
+    .Attr("fused_ops: list(string)")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Performs a chain of elementwise operations in a single pass over memory.
+
+The chain is specified by the `fused_ops` attribute, a list of TF op names
+(e.g. "Mul", "Relu"). They are performed in order, where the first input to
+each op is `x` for the first op and the output of the preceding op otherwise.
+Each binary op takes its second input from `args`, in order, which must be a
+scalar or have the shape of `x`. Only "Cast" changes the type from T to Tout,
+and it must be the last op.
+
+Supported ops are "Abs", "Exp", "Log", "Neg", "Relu", "Relu6", "Rsqrt",
+"Sigmoid", "Sqrt", "Square", "Tanh", "Add", "AddV2", "Maximum", "Minimum",
+"Mul", "RealDiv", "Sub" and "Cast".
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 // --------------------------------------------------------------------------
 
 // For operations where the output is a reduction function along some
@@ -1491,6 +1593,53 @@ REGISTER_OP("SparseSegmentSqrtNGrad")
     .Attr("Tsegmentids: {int32, int64} = DT_INT32")
     .SetShapeFn(SparseSegmentReductionGradShapeFn);
 
+REGISTER_OP("_FusedResourceSparseSegmentReduction")
+    .Input("resource: resource")
+    .Input("gather_indices: Tgather")
+    .Input("indices: Tidx")
+    .Input("segment_ids: Tsegmentids")
+    .Output("output: dtype")
+    .Attr("dtype: {bfloat16, half, float, double}")
+    .Attr("Tgather: {int32, int64} = DT_INT32")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      ShapeHandle indices_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &indices_shape));
+      ShapeHandle segment_ids_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &segment_ids_shape));
+      // indices and segment_ids should merge cleanly.
+      TF_RETURN_IF_ERROR(c->Merge(indices_shape, segment_ids_shape, &unused));
+
+      auto* handle_data = c->input_handle_shapes_and_types(0);
+      if (handle_data == nullptr || handle_data->empty()) {
+        c->set_output(0, c->UnknownShape());
+        return OkStatus();
+      }
+      ShapeHandle params_shape;
+      TF_RETURN_IF_ERROR(
+          c->WithRankAtLeast((*handle_data)[0].shape, 1, &params_shape));
+      ShapeHandle subshape;
+      TF_RETURN_IF_ERROR(c->Subshape(params_shape, 1, &subshape));
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(c->Concatenate(
+          c->Vector(InferenceContext::kUnknownDim), subshape, &out));
+      c->set_output(0, out);
+      return OkStatus();
+    })
+    .Doc(R"doc(
+Internal operation which is a composition of gathering rows of a resource
+variable (ResourceGather) and reducing them into segments (SparseSegmentSum,
+SparseSegmentMean or SparseSegmentSqrtN, selected by `combiner`) without
+materializing the gathered rows: reserved for internal use.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("All")
     .Input("input: bool")
     .Input("reduction_indices: Tidx")
@@ -23,6 +23,8 @@ using shape_inference::InferenceContext;
 using shape_inference::ShapeHandle;
 
 Status RaggedRangeShapeFn(InferenceContext* c);
+Status RaggedBatchMatMulShapeFn(InferenceContext* c);
+Status RaggedBatchMatMulGradShapeFn(InferenceContext* c);
 
 //==============================================================================
 // Registered Ops
@@ -38,6 +40,26 @@ REGISTER_OP("RaggedRange")
     .Attr("Tsplits: {int32, int64} = DT_INT64")
     .SetShapeFn(RaggedRangeShapeFn);
 
+REGISTER_OP("RaggedBatchMatMul")
+    .Input("rt_dense_values: T")
+    .Input("rt_splits: Tsplits")
+    .Input("b: T")
+    .Output("output_dense_values: T")
+    .Attr("transpose_b: bool = false")
+    .Attr("T: {float, double}")
+    .Attr("Tsplits: {int32, int64} = DT_INT64")
+    .SetShapeFn(RaggedBatchMatMulShapeFn);
+
+REGISTER_OP("RaggedBatchMatMulGrad")
+    .Input("rt_dense_values: T")
+    .Input("rt_splits: Tsplits")
+    .Input("grad: T")
+    .Output("output: T")
+    .Attr("transpose_b: bool = false")
+    .Attr("T: {float, double}")
+    .Attr("Tsplits: {int32, int64} = DT_INT64")
+    .SetShapeFn(RaggedBatchMatMulGradShapeFn);
+
 //==============================================================================
 // Shape Functions
 //==============================================================================
@@ -78,4 +100,46 @@ Status RaggedRangeShapeFn(InferenceContext* c) {
   return OkStatus();
 }
 
+Status RaggedBatchMatMulShapeFn(InferenceContext* c) {
+  ShapeHandle values;
+  ShapeHandle splits;
+  ShapeHandle b;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 2, &values));
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &splits));
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 3, &b));
+  bool transpose_b;
+  TF_RETURN_IF_ERROR(c->GetAttr("transpose_b", &transpose_b));
+
+  DimensionHandle nrows;
+  TF_RETURN_IF_ERROR(c->Add(c->Dim(b, 0), 1, &nrows));
+  TF_RETURN_IF_ERROR(c->Merge(c->Dim(splits, 0), nrows, &nrows));
+  DimensionHandle inner;
+  TF_RETURN_IF_ERROR(
+      c->Merge(c->Dim(values, 1), c->Dim(b, transpose_b ? 2 : 1), &inner));
+  c->set_output(0,
+                c->Matrix(c->Dim(values, 0), c->Dim(b, transpose_b ? 1 : 2)));
+  return OkStatus();
+}
+
+Status RaggedBatchMatMulGradShapeFn(InferenceContext* c) {
+  ShapeHandle values;
+  ShapeHandle splits;
+  ShapeHandle grad;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 2, &values));
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &splits));
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 2, &grad));
+  bool transpose_b;
+  TF_RETURN_IF_ERROR(c->GetAttr("transpose_b", &transpose_b));
+
+  DimensionHandle unused;
+  TF_RETURN_IF_ERROR(c->Merge(c->Dim(values, 0), c->Dim(grad, 0), &unused));
+  DimensionHandle nrows;
+  TF_RETURN_IF_ERROR(c->Subtract(c->Dim(splits, 0), 1, &nrows));
+  DimensionHandle inner = c->Dim(values, 1);
+  DimensionHandle outer = c->Dim(grad, 1);
+  c->set_output(0, transpose_b ? c->MakeShape({nrows, outer, inner})
+                               : c->MakeShape({nrows, inner, outer}));
+  return OkStatus();
+}
+
 }  // namespace tensorflow
@@ -92,6 +92,39 @@ TEST_F(DefaultEnvTest, IncompleteReadOutOfRange) {
   EXPECT_EQ(input, result);
 }
 
+TEST_F(DefaultEnvTest, ReadBatch) {
+  // Exercise the io_uring path where it is available; elsewhere ReadBatch
+  // must behave the same way through pread().
+  setenv("TF_POSIX_USE_IO_URING", "1", /*overwrite=*/1);
+  const string filename = io::JoinPath(BaseDir(), "read_batch");
+  const int kLength = 1 << 20;
+  const string input = CreateTestFile(env_, filename, kLength);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+
+  // More requests than fit in a single submission, plus one reading past EOF.
+  const int kNumRequests = 300;
+  const int kReadSize = 3000;
+  std::vector<string> scratch(kNumRequests + 1, string(kReadSize, '\0'));
+  std::vector<RandomAccessFile::ReadRequest> requests(kNumRequests + 1);
+  for (int i = 0; i < kNumRequests; ++i) {
+    requests[i].offset = (i * 7919) % (kLength - kReadSize);
+    requests[i].n = kReadSize;
+    requests[i].scratch = &scratch[i][0];
+  }
+  requests[kNumRequests].offset = kLength - 10;
+  requests[kNumRequests].n = kReadSize;
+  requests[kNumRequests].scratch = &scratch[kNumRequests][0];
+
+  f->ReadBatch(&requests);
+  for (int i = 0; i < kNumRequests; ++i) {
+    TF_EXPECT_OK(requests[i].status);
+    EXPECT_EQ(input.substr(requests[i].offset, kReadSize), requests[i].result);
+  }
+  EXPECT_EQ(error::OUT_OF_RANGE, requests[kNumRequests].status.code());
+  EXPECT_EQ(input.substr(kLength - 10), requests[kNumRequests].result);
+}
+
 TEST_F(DefaultEnvTest, ReadFileToString) {
   for (const int length : {0, 1, 1212, 2553, 4928, 8196, 9000, (1 << 20) - 1,
                            1 << 20, (1 << 20) + 1, (256 << 20) + 100}) {
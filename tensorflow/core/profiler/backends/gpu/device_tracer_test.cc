@@ -331,6 +331,51 @@ TEST_F(DeviceTracerTest, TraceToXSpace) {
   EXPECT_GE(total_events, 5);
 }
 
+TEST_F(DeviceTracerTest, TraceActivityOnlyToXSpace) {
+  ProfileOptions options = ProfilerSession::DefaultOptions();
+  options.set_gpu_activity_only(true);
+  auto tracer = xla::profiler::CreateGpuTracer(options);
+  if (!tracer) return;
+
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<std::pair<string, Tensor>> inputs;
+  std::vector<string> output_names = {y_ + ":0"};
+  std::vector<string> target_nodes = {y_neg_};
+  std::vector<Tensor> outputs;
+
+  TF_ASSERT_OK(tracer->Start());
+  TF_ASSERT_OK(session->Run(inputs, output_names, target_nodes, &outputs));
+  TF_ASSERT_OK(tracer->Stop());
+  XSpace space;
+  TF_ASSERT_OK(tracer->CollectData(&space));
+
+  // No driver API events are recorded.
+  const XPlane* host_plane = FindPlaneWithName(space, kCuptiDriverApiPlaneName);
+  if (host_plane != nullptr) {
+    XPlaneVisitor host = CreateTfXPlaneVisitor(host_plane);
+    host.ForEachLine([&](const tensorflow::profiler::XLineVisitor& line) {
+      EXPECT_EQ(line.NumEvents(), 0u);
+    });
+  }
+
+  // Kernels and memcpys still show up on the device plane, memsets do not.
+  const XPlane* device_plane = FindPlaneWithName(space, GpuPlaneName(0));
+  ASSERT_NE(device_plane, nullptr);
+  XPlaneVisitor plane = CreateTfXPlaneVisitor(device_plane);
+  int total_events = 0;
+  plane.ForEachLine([&](const tensorflow::profiler::XLineVisitor& line) {
+    line.ForEachEvent([&](const tensorflow::profiler::XEventVisitor& event) {
+      EXPECT_GT(event.TimestampNs(), 0);
+      EXPECT_GT(event.DurationNs(), 0);
+      ++total_events;
+    });
+  });
+  EXPECT_GE(total_events, 4);
+}
+
 TEST_F(DeviceTracerTest, CudaRuntimeResource) {
   auto tracer = CreateGpuTracer();
   if (!tracer) return;
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/summary/summary_converter.h"
+#include "tensorflow/core/util/async_record_writer.h"
 #include "tensorflow/core/util/events_writer.h"
 
 namespace tensorflow {
@@ -61,7 +62,24 @@ class SummaryFileWriter : public SummaryWriterInterface {
     TF_RETURN_WITH_CONTEXT_IF_ERROR(
         events_writer_->InitWithSuffix(uniquified_filename_suffix),
         "Could not initialize events writer.");
-    last_flush_ = env_->NowMicros();
+    // Appending to and flushing the events file happen on the writer's
+    // background thread, so that summary ops do not wait for file I/O.
+    AsyncRecordWriter::Options options;
+    // Flushes once more than max_queue_ events are pending, or on every event
+    // when there is no flush interval.
+    options.flush_every_records = flush_millis_ > 0 ? max_queue_ + 1 : 1;
+    options.flush_every_millis = flush_millis_;
+    async_writer_ = std::make_unique<AsyncRecordWriter>(
+        env_, "summary_file_writer", options,
+        [this](StringPiece event) {
+          events_writer_->WriteSerializedEvent(event);
+          return OkStatus();
+        },
+        [this]() -> Status {
+          TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
+                                          "Could not flush events file.");
+          return OkStatus();
+        });
     is_initialized_ = true;
     return OkStatus();
   }
@@ -71,7 +89,7 @@ class SummaryFileWriter : public SummaryWriterInterface {
     if (!is_initialized_) {
       return errors::FailedPrecondition("Class was not properly initialized.");
     }
-    return InternalFlush();
+    return async_writer_->Flush();
   }
 
   ~SummaryFileWriter() override {
@@ -151,12 +169,9 @@ class SummaryFileWriter : public SummaryWriterInterface {
   }
 
   Status WriteEvent(std::unique_ptr<Event> event) override {
-    mutex_lock ml(mu_);
-    queue_.emplace_back(std::move(event));
-    if (queue_.size() > max_queue_ ||
-        env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
-    }
+    string record;
+    event->SerializeToString(&record);
+    async_writer_->Write(std::move(record));
     return OkStatus();
   }
 
@@ -167,26 +182,16 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
-  Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
-      events_writer_->WriteEvent(*e);
-    }
-    queue_.clear();
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
-                                    "Could not flush events file.");
-    last_flush_ = env_->NowMicros();
-    return OkStatus();
-  }
-
   bool is_initialized_;
   const int max_queue_;
   const int flush_millis_;
-  uint64 last_flush_;
   Env* env_;
   mutex mu_;
-  std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
-  // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
+  // A pointer to allow deferred construction. Only used by the background
+  // thread of async_writer_ once Initialize() returns.
+  std::unique_ptr<EventsWriter> events_writer_;
+  // Declared after events_writer_ so that it is drained and joined first.
+  std::unique_ptr<AsyncRecordWriter> async_writer_;
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
 };
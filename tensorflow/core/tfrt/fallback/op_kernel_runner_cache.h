@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_FALLBACK_OP_KERNEL_RUNNER_CACHE_H_
 #define TENSORFLOW_CORE_TFRT_FALLBACK_OP_KERNEL_RUNNER_CACHE_H_
 
+#include <array>
 #include <functional>
 #include <memory>
 
@@ -47,6 +48,11 @@ class OpLocationKey {
 };
 
 // OpKernelRunnerCache is similar to OpKernelRunnerTable but thread-safe.
+//
+// Ops whose kernels are created at model load are looked up by index in an
+// OpKernelRunnerTable instead; this cache serves the ops that are only known
+// at execution time. It is split into shards, each with its own lock, so that
+// concurrent requests running different ops rarely contend on a lookup.
 class OpKernelRunnerCache {
  public:
   OpKernelRunnerCache() = default;
@@ -60,9 +66,15 @@ class OpKernelRunnerCache {
           process_function_library_runtime);
 
  private:
-  mutable mutex mu_;
-  absl::flat_hash_map<OpLocationKey, std::unique_ptr<OpKernelRunner>> map_
-      TF_GUARDED_BY(mu_);
+  static constexpr int kNumShards = 16;
+
+  struct Shard {
+    mutable mutex mu;
+    absl::flat_hash_map<OpLocationKey, std::unique_ptr<OpKernelRunner>> map
+        TF_GUARDED_BY(mu);
+  };
+
+  std::array<Shard, kNumShards> shards_;
 };
 
 }  // namespace tfrt_stub
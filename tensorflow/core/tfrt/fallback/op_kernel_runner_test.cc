@@ -15,7 +15,9 @@ limitations under the License.
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
 
 #include <string>
+#include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/device_factory.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -23,7 +25,9 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner_cache.h"
@@ -120,6 +124,58 @@ TEST(OpKernelRunnerTest, OpKernelRunnerCache) {
   EXPECT_EQ(runner->op_kernel()->name(), "TestOp_100_0");
 }
 
+TEST(OpKernelRunnerTest, OpKernelRunnerCacheConcurrentGetOrCreate) {
+  tensorflow::SessionOptions session_options;
+  tensorflow::FunctionDefLibrary fdef_lib;
+  TF_ASSERT_OK_AND_ASSIGN(auto fallback_state,
+                          FallbackState::Create(session_options, fdef_lib));
+
+  OpKernelRunnerCache cache;
+
+  // More locations than shards, so that every shard is both read and written
+  // concurrently. Each thread visits the locations in a different order.
+  constexpr int kNumThreads = 8;
+  constexpr int kNumLocations = 64;
+  std::vector<std::vector<OpKernelRunner*>> runners(
+      kNumThreads, std::vector<OpKernelRunner*>(kNumLocations));
+  {
+    thread::ThreadPool thread_pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      thread_pool.Schedule([&, t]() {
+        for (int i = 0; i < kNumLocations; ++i) {
+          const int location = (i * (2 * t + 1)) % kNumLocations;
+          tfrt::Location loc(/*handler=*/nullptr, /*data=*/location);
+          auto runner = cache.GetOrCreate(
+              loc,
+              /*op_name=*/"TestOp",
+              /*device_name=*/"/job:localhost/replica:0/task:0/device:CPU:0",
+              /*num_args=*/1,
+              /*attr_builder=*/
+              [](tensorflow::AttrValueMap*) { return OkStatus(); },
+              fallback_state->device_manager(),
+              fallback_state->process_function_library_runtime());
+          TF_EXPECT_OK(runner.status());
+          runners[t][location] = runner.ok() ? *runner : nullptr;
+        }
+      });
+    }
+  }
+
+  // Every thread gets the same runner for a location, and each location has
+  // its own runner.
+  for (int location = 0; location < kNumLocations; ++location) {
+    ASSERT_TRUE(runners[0][location]);
+    EXPECT_EQ(runners[0][location]->op_kernel()->name(),
+              absl::StrCat("TestOp_", location, "_0"));
+    for (int t = 1; t < kNumThreads; ++t) {
+      EXPECT_EQ(runners[t][location], runners[0][location]);
+    }
+    if (location > 0) {
+      EXPECT_NE(runners[0][location], runners[0][location - 1]);
+    }
+  }
+}
+
 TEST(OpKernelRunnerTest, OpKernelRunState) {
   SessionOptions options;
   auto* device_count = options.config.mutable_device_count();
@@ -92,6 +92,10 @@ std::ostream& operator<<(std::ostream& os,
             << ", enable_tfrt_gpu = " << options.enable_tfrt_gpu
             << ", runtime = " << options.runtime
             << ", model_metadata = " << options.model_metadata.DebugString()
+            << ", enable_online_cost_analysis = "
+            << options.enable_online_cost_analysis
+            << ", online_cost_analysis_refresh_period_in_requests = "
+            << options.online_cost_analysis_refresh_period_in_requests
             << ", compile_options = " << options.compile_options << "}";
 }
 
@@ -57,6 +57,12 @@ struct GraphExecutionOptions {
   // TODO(b/266251216): Maybe flip the default value or remote it.
   bool enable_online_cost_analysis = false;
 
+  // If positive and `enable_online_cost_analysis` is true, the op costs are
+  // recorded again on every request whose index within the client graph is a
+  // multiple of this period, and the client graph is re-compiled with them,
+  // so that the costs track the production traffic.
+  int64_t online_cost_analysis_refresh_period_in_requests = 0;
+
   // If true, the MLRT interpreter will be used instead of the BEF executor.
   // This option is experimental.
   bool enable_mlrt = false;
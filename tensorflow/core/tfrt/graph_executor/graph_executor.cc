@@ -37,7 +37,6 @@ limitations under the License.
 #include "learning/infra/mira/mlrt/bytecode/executable.h"
 #include "learning/infra/mira/mlrt/interpreter/context.h"
 #include "learning/infra/mira/mlrt/interpreter/execute.h"
-#include "absl/base/call_once.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
@@ -507,7 +506,8 @@ tensorflow::Status GraphExecutor::Run(
   // Conduct cost analysis for the first request on this `loaded_client_graph`.
   std::unique_ptr<CostRecorder> cost_recorder;
   if (options_.enable_online_cost_analysis) {
-    cost_recorder = loaded_client_graph.MaybeCreateCostRecorder();
+    cost_recorder = loaded_client_graph.MaybeCreateCostRecorder(
+        options_.online_cost_analysis_refresh_period_in_requests);
   }
 
   std::vector<tensorflow::Tensor> flat_outputs;
@@ -519,8 +519,9 @@ tensorflow::Status GraphExecutor::Run(
       &req_deadline_tracker_, cost_recorder.get()));
 
   if (cost_recorder != nullptr) {
-    TF_RETURN_IF_ERROR(
-        loaded_client_graph.UpdateCost(*cost_recorder, runtime()));
+    TF_RETURN_IF_ERROR(loaded_client_graph.UpdateCost(
+        *cost_recorder, runtime(),
+        options_.online_cost_analysis_refresh_period_in_requests));
   }
 
   // Create the outputs from the actual function results, which are sorted
@@ -864,23 +865,40 @@ tensorflow::Status GraphExecutor::RunWithSyncInterpreter(
 }
 
 std::unique_ptr<CostRecorder>
-GraphExecutor::LoadedClientGraph::MaybeCreateCostRecorder() const {
-  std::unique_ptr<CostRecorder> cost_recorder;
-  absl::call_once(create_cost_recorder_once_,
-                  [&]() { cost_recorder = std::make_unique<CostRecorder>(); });
-  return cost_recorder;
+GraphExecutor::LoadedClientGraph::MaybeCreateCostRecorder(
+    int64_t refresh_period_in_requests) const {
+  const int64_t request_index = num_cost_recorder_requests_.fetch_add(1);
+  if (request_index == 0 || (refresh_period_in_requests > 0 &&
+                             request_index % refresh_period_in_requests == 0)) {
+    return std::make_unique<CostRecorder>();
+  }
+  return nullptr;
 }
 
 Status GraphExecutor::LoadedClientGraph::UpdateCost(
-    const CostRecorder& cost_recorder, const Runtime& runtime) {
-  auto tfrt_mlir = std::move(tfrt_mlir_);
-  mlir::StatusScopedDiagnosticHandler diag_handler(
-      tfrt_mlir.get().getContext());
+    const CostRecorder& cost_recorder, const Runtime& runtime,
+    int64_t refresh_period_in_requests) {
+  // Refreshes of the costs may overlap, so serialize the updates.
+  tensorflow::mutex_lock tfrt_mlir_lock(tfrt_mlir_mu_);
+  // Without periodic refreshes this is the only update, so the module is freed
+  // when it returns. Otherwise `tfrt_mlir_` is kept for the next refresh.
+  mlir::OwningOpRef<mlir::ModuleOp> released_tfrt_mlir;
+  if (refresh_period_in_requests <= 0) {
+    released_tfrt_mlir = std::move(tfrt_mlir_);
+  }
+  mlir::ModuleOp tfrt_mlir =
+      released_tfrt_mlir ? released_tfrt_mlir.get() : tfrt_mlir_.get();
+  if (!tfrt_mlir) {
+    return tensorflow::errors::FailedPrecondition(
+        "The TFRT MLIR of client graph ", name_,
+        " has already been released after its cost update.");
+  }
+  mlir::StatusScopedDiagnosticHandler diag_handler(tfrt_mlir.getContext());
   // TODO(b/259602527): Update costs in bytecode path.
   // Update costs in MLIR.
-  tfrt_compiler::UpdateOpCostInTfrtMlir(tfrt_mlir.get(), cost_recorder);
+  tfrt_compiler::UpdateOpCostInTfrtMlir(tfrt_mlir, cost_recorder);
   // Create a new `BefContext` with the updated MLIR.
-  auto bef = tfrt::ConvertMLIRToBEF(tfrt_mlir.get(),
+  auto bef = tfrt::ConvertMLIRToBEF(tfrt_mlir,
                                     /*disable_optional_sections=*/true);
 
   if (bef.empty()) {
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_GRAPH_EXECUTOR_GRAPH_EXECUTOR_H_
 #define TENSORFLOW_CORE_TFRT_GRAPH_EXECUTOR_GRAPH_EXECUTOR_H_
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -26,7 +28,6 @@ limitations under the License.
 #include "learning/infra/mira/mlrt/bytecode/bytecode.h"
 #include "learning/infra/mira/mlrt/bytecode/executable.h"
 #include "learning/infra/mira/mlrt/interpreter/context.h"
-#include "absl/base/call_once.h"
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/runtime_fallback/kernel/kernel_fallback_execute_compat.h"
@@ -130,14 +131,17 @@ class GraphExecutor {
           bytecode_buffer_(std::move(bytecode_buffer)),
           bytecode_executable_(std::move(bytecode_executable)) {}
 
-    // Returns a `CostRecorder` if none has been created before for this
-    // `LoadedClientGraph`.
-    std::unique_ptr<CostRecorder> MaybeCreateCostRecorder() const;
+    // Returns a `CostRecorder` for the first request on this
+    // `LoadedClientGraph` and, if `refresh_period_in_requests` is positive, for
+    // every `refresh_period_in_requests`-th request after it.
+    std::unique_ptr<CostRecorder> MaybeCreateCostRecorder(
+        int64_t refresh_period_in_requests = 0) const;
 
     // Updates the op cost values in this `LoadedClientGraph` with records from
-    // `cost_recorder`.
-    Status UpdateCost(const CostRecorder& cost_recorder,
-                      const Runtime& runtime);
+    // `cost_recorder`. The TFRT MLIR is only kept for later updates if
+    // `refresh_period_in_requests` is positive; otherwise it is freed.
+    Status UpdateCost(const CostRecorder& cost_recorder, const Runtime& runtime,
+                      int64_t refresh_period_in_requests = 0);
 
     // Getters.
     std::shared_ptr<BefContext> bef_context() const {
@@ -145,6 +149,10 @@ class GraphExecutor {
       return bef_context_;
     }
     absl::string_view name() const { return name_; }
+    bool has_tfrt_mlir() const {
+      tensorflow::mutex_lock lock(tfrt_mlir_mu_);
+      return static_cast<bool>(tfrt_mlir_);
+    }
 
     OpKernelRunnerTable& runner_table() { return runner_table_; }
     tfd::FallbackResourceArray& resource_array() { return resource_array_; }
@@ -158,8 +166,8 @@ class GraphExecutor {
     OpKernelRunnerTable runner_table_;
     tfd::FallbackResourceArray resource_array_;
     std::unique_ptr<mlir::MLIRContext> mlir_context_;
-    // Thread-safety resulted from `create_cost_recorder_once_`.
-    mlir::OwningOpRef<mlir::ModuleOp> tfrt_mlir_;
+    mutable tensorflow::mutex tfrt_mlir_mu_;
+    mlir::OwningOpRef<mlir::ModuleOp> tfrt_mlir_ TF_GUARDED_BY(tfrt_mlir_mu_);
     // Only one of `bef_context_` or `bytecode_executable_` should be filled for
     // a single `LoadedClientGraph`.
     mutable tensorflow::mutex bef_context_mu_;
@@ -167,7 +175,8 @@ class GraphExecutor {
     std::shared_ptr<BefContext> bef_context_ TF_GUARDED_BY(bef_context_mu_);
     mlrt::bc::Buffer bytecode_buffer_;
     std::unique_ptr<mlrt::LoadedExecutable> bytecode_executable_ = nullptr;
-    mutable absl::once_flag create_cost_recorder_once_;
+    // Number of requests that asked for a `CostRecorder`.
+    mutable std::atomic<int64_t> num_cost_recorder_requests_{0};
   };
 
   // A subgraph constructed by specifying input/output tensors.
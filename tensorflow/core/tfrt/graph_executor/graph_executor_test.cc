@@ -26,6 +26,9 @@ limitations under the License.
 #include "learning/infra/mira/mlrt/interpreter/value.h"
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "mlir/IR/BuiltinOps.h"  // from @llvm-project
+#include "mlir/IR/Location.h"  // from @llvm-project
+#include "mlir/IR/MLIRContext.h"  // from @llvm-project
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/cc/ops/const_op.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -33,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
+#include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 #include "tensorflow/core/tfrt/saved_model/saved_model_testutil.h"
 #include "tensorflow/tsl/lib/core/status_test_util.h"
 #include "tensorflow/tsl/platform/statusor.h"
@@ -160,6 +164,55 @@ TEST_F(GraphExecutorTest, DoOnlineCostAnalysisExactlyOnce) {
   EXPECT_TRUE(loaded_client_graph_1.MaybeCreateCostRecorder() == nullptr);
 }
 
+TEST_F(GraphExecutorTest, RefreshOnlineCostAnalysisPeriodically) {
+  GraphExecutor::LoadedClientGraph loaded_client_graph(
+      "name", /*mlir_context=*/nullptr, /*tfrt_mlir=*/{},
+      /*bef_context=*/nullptr, /*bytecode_buffer=*/{},
+      /*bytecode_executable=*/nullptr);
+
+  // The costs of the first request and then of every third request are
+  // recorded.
+  for (int i = 0; i < 7; ++i) {
+    EXPECT_EQ(loaded_client_graph.MaybeCreateCostRecorder(
+                  /*refresh_period_in_requests=*/3) != nullptr,
+              i % 3 == 0)
+        << "request " << i;
+  }
+}
+
+TEST_F(GraphExecutorTest, ReleaseTfrtMlirAfterOneShotCostUpdate) {
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  auto mlir_context = std::make_unique<mlir::MLIRContext>();
+  auto tfrt_mlir =
+      mlir::ModuleOp::create(mlir::UnknownLoc::get(mlir_context.get()));
+  GraphExecutor::LoadedClientGraph loaded_client_graph(
+      "name", std::move(mlir_context), tfrt_mlir, /*bef_context=*/nullptr,
+      /*bytecode_buffer=*/{}, /*bytecode_executable=*/nullptr);
+  ASSERT_TRUE(loaded_client_graph.has_tfrt_mlir());
+
+  // Without periodic refreshes, the module is not needed after the only cost
+  // update.
+  TF_ASSERT_OK(loaded_client_graph.UpdateCost(CostRecorder(), *runtime));
+  EXPECT_FALSE(loaded_client_graph.has_tfrt_mlir());
+  EXPECT_NE(loaded_client_graph.bef_context(), nullptr);
+}
+
+TEST_F(GraphExecutorTest, KeepTfrtMlirForPeriodicCostRefreshes) {
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  auto mlir_context = std::make_unique<mlir::MLIRContext>();
+  auto tfrt_mlir =
+      mlir::ModuleOp::create(mlir::UnknownLoc::get(mlir_context.get()));
+  GraphExecutor::LoadedClientGraph loaded_client_graph(
+      "name", std::move(mlir_context), tfrt_mlir, /*bef_context=*/nullptr,
+      /*bytecode_buffer=*/{}, /*bytecode_executable=*/nullptr);
+
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK(loaded_client_graph.UpdateCost(
+        CostRecorder(), *runtime, /*refresh_period_in_requests=*/3));
+    EXPECT_TRUE(loaded_client_graph.has_tfrt_mlir());
+  }
+}
+
 TEST_F(GraphExecutorTest, Extend) {
   GraphDef graph_def;
   {
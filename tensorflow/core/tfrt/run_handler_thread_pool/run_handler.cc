@@ -350,6 +350,7 @@ RunHandlerThreadPool::RunHandlerThreadPool(
       blocking_thread_max_waiting_time_(
           options.blocking_threads_max_sleep_time_micro_sec),
       enable_wake_up_(options.enable_wake_up),
+      enable_work_stealing_(options.enable_work_stealing),
       thread_data_(num_threads_),
       env_(env, thread_options, name),
       name_(name),
@@ -469,7 +470,29 @@ int RunHandlerThreadPool::NumNonBlockingThreads() const {
 }
 
 RunHandlerThreadPool::ThreadData::ThreadData()
-    : new_version(0), current_index(0), current_version(0) {}
+    : new_version(0),
+      current_index(0),
+      current_version(0),
+      last_work_source(nullptr) {}
+
+Task RunHandlerThreadPool::PopTask(ThreadWorkSource* tws, int thread_id,
+                                   int max_blocking_inflight,
+                                   bool may_steal_blocking_work,
+                                   bool* task_from_blocking_queue) {
+  Task t;
+  // For blocking thread, search for blocking tasks first.
+  if (may_steal_blocking_work &&
+      tws->GetInflightTaskCount(true) < max_blocking_inflight) {
+    t = tws->PopBlockingTask();
+    if (t.f) {
+      *task_from_blocking_queue = true;
+      return t;
+    }
+  }
+
+  // Search for non-blocking tasks.
+  return tws->PopNonBlockingTask(thread_id, true);
+}
 
 Task RunHandlerThreadPool::FindTask(
     int searching_range_start, int searching_range_end, int thread_id,
@@ -489,18 +512,8 @@ Task RunHandlerThreadPool::FindTask(
     *tws = thread_work_sources[current_index];
     ++current_index;
 
-    // For blocking thread, search for blocking tasks first.
-    if (may_steal_blocking_work &&
-        (*tws)->GetInflightTaskCount(true) < max_blocking_inflight) {
-      t = (*tws)->PopBlockingTask();
-      if (t.f) {
-        *task_from_blocking_queue = true;
-        break;
-      }
-    }
-
-    // Search for non-blocking tasks.
-    t = (*tws)->PopNonBlockingTask(thread_id, true);
+    t = PopTask(*tws, thread_id, max_blocking_inflight,
+                may_steal_blocking_work, task_from_blocking_queue);
     if (t.f) {
       break;
     }
@@ -509,6 +522,49 @@ Task RunHandlerThreadPool::FindTask(
   return t;
 }
 
+Task RunHandlerThreadPool::FindTaskFromLastWorkSource(
+    int thread_id, int max_blocking_inflight, bool may_steal_blocking_work,
+    const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+    bool* task_from_blocking_queue, ThreadWorkSource** tws) {
+  *task_from_blocking_queue = false;
+  ThreadWorkSource* last_work_source = thread_data_[thread_id].last_work_source;
+  if (last_work_source == nullptr) {
+    return Task();
+  }
+  // The handler of the last request may have been returned to the pool, so
+  // only go back to it if it is still one of the active requests.
+  for (int i = 0; i < thread_work_sources.size(); ++i) {
+    if (thread_work_sources[i] == last_work_source) {
+      *tws = last_work_source;
+      return PopTask(*tws, thread_id, max_blocking_inflight,
+                     may_steal_blocking_work, task_from_blocking_queue);
+    }
+  }
+  return Task();
+}
+
+Task RunHandlerThreadPool::StealTask(
+    int thread_id, int max_blocking_inflight, bool may_steal_blocking_work,
+    const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+    bool* task_from_blocking_queue, ThreadWorkSource** tws) {
+  *task_from_blocking_queue = false;
+  int victim = -1;
+  int64_t max_pending_tasks = 0;
+  for (int i = 0; i < thread_work_sources.size(); ++i) {
+    int64_t pending_tasks = thread_work_sources[i]->GetPendingTaskCount();
+    if (pending_tasks > max_pending_tasks) {
+      max_pending_tasks = pending_tasks;
+      victim = i;
+    }
+  }
+  if (victim < 0) {
+    return Task();
+  }
+  *tws = thread_work_sources[victim];
+  return PopTask(*tws, thread_id, max_blocking_inflight,
+                 may_steal_blocking_work, task_from_blocking_queue);
+}
+
 // Main worker thread loop.
 void RunHandlerThreadPool::WorkerLoop(int thread_id,
                                       bool may_steal_blocking_work) {
@@ -537,7 +593,17 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
         thread_data_[thread_id].current_thread_work_sources.get();
     sub_thread_pool_id = thread_data_[thread_id].sub_thread_pool_id;
     int active_requests = thread_work_sources->size();
-    if (may_steal_blocking_work) {
+    if (enable_work_stealing_) {
+      // Keep running the request this thread ran last, so that its data stays
+      // in this thread's cache.
+      t = FindTaskFromLastWorkSource(thread_id, kMaxBlockingInflight,
+                                     may_steal_blocking_work,
+                                     *thread_work_sources,
+                                     &task_from_blocking_queue, &tws);
+    }
+    if (t.f) {
+      // Found a task from the last request.
+    } else if (may_steal_blocking_work) {
       // Each thread will first look for tasks from requests that belongs to
       // its sub thread pool.
       int search_range_start =
@@ -556,6 +622,13 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
                    sub_thread_pool_id, kMaxBlockingInflight,
                    /*may_steal_blocking_work=*/true, *thread_work_sources,
                    &task_from_blocking_queue, &tws);
+      if (!t.f && enable_work_stealing_) {
+        // Help the request with the most pending tasks first instead of
+        // picking the next request in round robin order.
+        t = StealTask(thread_id, kMaxBlockingInflight,
+                      /*may_steal_blocking_work=*/true, *thread_work_sources,
+                      &task_from_blocking_queue, &tws);
+      }
       if (!t.f) {
         // Search from all requests if the thread cannot find tasks from
         // requests that belong to its own sub thread pool.
@@ -567,12 +640,22 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
     } else {
       // For non-blocking threads, it will always search from all pending
       // requests.
-      t = FindTask(0, active_requests, thread_id, sub_thread_pool_id,
-                   kMaxBlockingInflight,
-                   /*may_steal_blocking_work=*/false, *thread_work_sources,
-                   &task_from_blocking_queue, &tws);
+      if (enable_work_stealing_) {
+        t = StealTask(thread_id, kMaxBlockingInflight,
+                      /*may_steal_blocking_work=*/false, *thread_work_sources,
+                      &task_from_blocking_queue, &tws);
+      }
+      if (!t.f) {
+        t = FindTask(0, active_requests, thread_id, sub_thread_pool_id,
+                     kMaxBlockingInflight,
+                     /*may_steal_blocking_work=*/false, *thread_work_sources,
+                     &task_from_blocking_queue, &tws);
+      }
     }
     if (t.f) {
+      if (enable_work_stealing_) {
+        thread_data_[thread_id].last_work_source = tws;
+      }
       VLOG(2) << "Running " << (task_from_blocking_queue ? "inter" : "intra")
               << " work from " << tws->GetTracemeId();
       tws->IncrementInflightTaskCount(task_from_blocking_queue);
@@ -726,7 +809,8 @@ class RunHandlerPool::Impl {
                 options.use_adaptive_waiting_time, options.enable_wake_up,
                 options.max_concurrent_handler,
                 options.num_threads_in_sub_thread_pool,
-                options.sub_thread_request_percentage),
+                options.sub_thread_request_percentage,
+                options.enable_work_stealing),
             tensorflow::Env::Default(), tensorflow::ThreadOptions(),
             "tf_run_handler_pool", &waiters_mu_, &queue_waiters_)),
         iterations_(0),
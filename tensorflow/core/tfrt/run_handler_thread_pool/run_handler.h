@@ -103,6 +103,12 @@ class RunHandlerPool {
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // If true, a thread first goes back to the request it ran its last task
+    // from, and a thread that runs out of work in its own sub thread pool
+    // steals from the request with the most pending tasks before falling back
+    // to the round robin search over all requests.
+    bool enable_work_stealing = false;
   };
   explicit RunHandlerPool(Options options);
   ~RunHandlerPool();
@@ -296,6 +302,7 @@ class RunHandlerThreadPool {
     int max_concurrent_handler;
     std::vector<int> num_threads_in_sub_thread_pool;
     std::vector<double> sub_thread_request_percentage;
+    bool enable_work_stealing;
     Options(int num_blocking_threads, int num_non_blocking_threads,
             bool wait_if_no_active_request,
             int non_blocking_threads_sleep_time_micro_sec,
@@ -303,7 +310,8 @@ class RunHandlerThreadPool {
             bool use_adaptive_waiting_time, bool enable_wake_up,
             int max_concurrent_handler,
             const std::vector<int>& num_threads_in_sub_thread_pool,
-            const std::vector<double>& sub_thread_request_percentage)
+            const std::vector<double>& sub_thread_request_percentage,
+            bool enable_work_stealing = false)
         : num_blocking_threads(num_blocking_threads),
           num_non_blocking_threads(num_non_blocking_threads),
           wait_if_no_active_request(wait_if_no_active_request),
@@ -315,7 +323,8 @@ class RunHandlerThreadPool {
           enable_wake_up(enable_wake_up),
           max_concurrent_handler(max_concurrent_handler),
           num_threads_in_sub_thread_pool(num_threads_in_sub_thread_pool),
-          sub_thread_request_percentage(sub_thread_request_percentage) {}
+          sub_thread_request_percentage(sub_thread_request_percentage),
+          enable_work_stealing(enable_work_stealing) {}
   };
   struct PerThread {
     constexpr PerThread() : pool(nullptr), thread_id(-1) {}
@@ -364,10 +373,27 @@ class RunHandlerThreadPool {
       const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
       bool* task_from_blocking_queue, ThreadWorkSource** tws);
 
+  // Tries to pop a task from the request the thread ran its last task from.
+  // Only used when work stealing is enabled.
+  Task FindTaskFromLastWorkSource(
+      int thread_id, int max_blocking_inflight, bool may_steal_blocking_work,
+      const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+      bool* task_from_blocking_queue, ThreadWorkSource** tws);
+
+  // Tries to pop a task from the request with the most pending tasks. Only
+  // used when work stealing is enabled.
+  Task StealTask(
+      int thread_id, int max_blocking_inflight, bool may_steal_blocking_work,
+      const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+      bool* task_from_blocking_queue, ThreadWorkSource** tws);
+
   void WaitForWorkInSubThreadPool(int thread_id, bool is_blocking,
                                   int sub_thread_pool_id);
 
  private:
+  Task PopTask(ThreadWorkSource* tws, int thread_id, int max_blocking_inflight,
+               bool may_steal_blocking_work, bool* task_from_blocking_queue);
+
   struct ThreadData {
     ThreadData();
     tensorflow::mutex mu;
@@ -384,6 +410,10 @@ class RunHandlerThreadPool {
         current_thread_work_sources;
 
     int sub_thread_pool_id;
+
+    // The work source of the last task run by this thread. Only used when work
+    // stealing is enabled.
+    ThreadWorkSource* last_work_source;
   };
 
   const int num_threads_;
@@ -394,6 +424,7 @@ class RunHandlerThreadPool {
   const int non_blocking_thread_sleep_time_;
   const int blocking_thread_max_waiting_time_;
   const bool enable_wake_up_;
+  const bool enable_work_stealing_;
   Eigen::MaxSizeVector<ThreadData> thread_data_;
   internal::RunHandlerEnvironment env_;
   std::atomic<bool> cancelled_;
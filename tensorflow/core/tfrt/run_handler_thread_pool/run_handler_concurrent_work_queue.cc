@@ -56,6 +56,7 @@ RunHandlerThreadWorkQueue::RunHandlerThreadWorkQueue(const Options& options)
   pool_options.enable_wake_up = options.enable_wake_up;
   pool_options.wait_if_no_active_request = options.wait_if_no_active_request;
   pool_options.use_adaptive_waiting_time = options.use_adaptive_waiting_time;
+  pool_options.enable_work_stealing = options.enable_work_stealing;
   handler_pool_ = std::make_unique<RunHandlerPool>(pool_options);
 }
 
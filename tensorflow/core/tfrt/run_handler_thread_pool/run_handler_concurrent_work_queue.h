@@ -78,6 +78,12 @@ class RunHandlerThreadWorkQueue
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // If true, a thread first goes back to the request it ran its last task
+    // from, and a thread that runs out of work in its own sub thread pool
+    // steals from the request with the most pending tasks before falling back
+    // to the round robin search over all requests.
+    bool enable_work_stealing = false;
   };
 
   explicit RunHandlerThreadWorkQueue(const Options& options);
@@ -14,15 +14,20 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/tfrt/run_handler_thread_pool/run_handler_concurrent_work_queue.h"
 
+#include <atomic>
 #include <cstdio>
 #include <memory>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tfrt/host_context/concurrent_work_queue.h"  // from @tf_runtime
 #include "tfrt/host_context/diagnostic.h"  // from @tf_runtime
@@ -39,6 +44,64 @@ namespace {
 const int kNumMainThreads = 1;
 const int kNumComplementaryThreads = 1;
 
+// Keeps the calling thread busy for `micros` microseconds.
+void Spin(int64_t micros) {
+  const uint64_t end = tensorflow::Env::Default()->NowMicros() + micros;
+  while (tensorflow::Env::Default()->NowMicros() < end) {
+  }
+}
+
+RunHandlerThreadWorkQueue::Options MixedRequestsOptions(
+    bool enable_work_stealing) {
+  RunHandlerThreadWorkQueue::Options options;
+  options.num_main_threads = 4;
+  options.num_complementary_threads = 2;
+  options.init_timeout_ms = 1000;
+  options.num_sub_thread_pool = 2;
+  options.num_threads_in_sub_thread_pool = {2, 2};
+  options.sub_thread_request_percentage = {0.5, 1.0};
+  options.enable_work_stealing = enable_work_stealing;
+  return options;
+}
+
+// Runs one heavy request with many long tasks next to `num_light_requests`
+// requests with a few short tasks each, and waits for all of them to finish.
+// Returns the number of tasks that ran.
+int RunMixedRequests(RunHandlerThreadWorkQueue* pool, int num_light_requests) {
+  constexpr int kHeavyTasks = 64;
+  constexpr int kHeavyTaskMicros = 200;
+  constexpr int kLightTasks = 4;
+  constexpr int kLightTaskMicros = 10;
+
+  std::vector<std::unique_ptr<tensorflow::tfrt_stub::WorkQueueInterface>>
+      queues;
+  for (int i = 0; i <= num_light_requests; ++i) {
+    auto queue = pool->InitializeRequest(/*request_id=*/i);
+    TF_CHECK_OK(queue.status());
+    queues.push_back(std::move(*queue));
+  }
+
+  std::atomic<int> num_tasks_run{0};
+  tensorflow::BlockingCounter counter(kHeavyTasks +
+                                      num_light_requests * kLightTasks);
+  auto add_tasks = [&](tensorflow::tfrt_stub::WorkQueueInterface* queue,
+                       int num_tasks, int task_micros) {
+    for (int i = 0; i < num_tasks; ++i) {
+      queue->AddTask(TaskFunction([&, task_micros] {
+        Spin(task_micros);
+        num_tasks_run.fetch_add(1);
+        counter.DecrementCount();
+      }));
+    }
+  };
+  add_tasks(queues[0].get(), kHeavyTasks, kHeavyTaskMicros);
+  for (int i = 1; i <= num_light_requests; ++i) {
+    add_tasks(queues[i].get(), kLightTasks, kLightTaskMicros);
+  }
+  counter.Wait();
+  return num_tasks_run.load();
+}
+
 class RunHandlerThreadWorkQueueTest : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -187,6 +250,22 @@ TEST_F(RunHandlerThreadWorkQueueTest, NoHandlerReturnsError) {
           "Could not obtain RunHandler for request after waiting for 1 ms."));
 }
 
+TEST(RunHandlerThreadWorkQueueWorkStealingTest, RunsMixedRequests) {
+  for (bool enable_work_stealing : {false, true}) {
+    RunHandlerThreadWorkQueue pool(MixedRequestsOptions(enable_work_stealing));
+    EXPECT_EQ(RunMixedRequests(&pool, /*num_light_requests=*/7), 64 + 7 * 4);
+  }
+}
+
+// Arg 0 toggles work stealing.
+void BM_MixedHeavyLightRequests(::testing::benchmark::State& state) {
+  RunHandlerThreadWorkQueue pool(MixedRequestsOptions(state.range(0) != 0));
+  for (auto s : state) {
+    RunMixedRequests(&pool, /*num_light_requests=*/7);
+  }
+}
+BENCHMARK(BM_MixedHeavyLightRequests)->Arg(0)->Arg(1);
+
 }  // namespace
 }  // namespace tf
 }  // namespace tfrt
@@ -0,0 +1,148 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/util/async_record_writer.h"
+
+#include <chrono>  // NOLINT
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+AsyncRecordWriter::AsyncRecordWriter(Env* env, const std::string& name,
+                                     const Options& options, WriteFn write_fn,
+                                     FlushFn flush_fn)
+    : env_(env),
+      options_(options),
+      write_fn_(std::move(write_fn)),
+      flush_fn_(std::move(flush_fn)) {
+  thread_.reset(
+      env_->StartThread(ThreadOptions(), name, [this]() { WriterLoop(); }));
+}
+
+AsyncRecordWriter::~AsyncRecordWriter() {
+  {
+    mutex_lock l(mu_);
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+  // Joins the background thread, which drains the queue before it exits.
+  thread_.reset();
+}
+
+void AsyncRecordWriter::Write(std::string record) {
+  const int64_t size = record.size();
+  mutex_lock l(mu_);
+  while (queued_bytes_ > 0 &&
+         queued_bytes_ + size > options_.max_queued_bytes) {
+    if (options_.drop_when_full) {
+      if (num_dropped_records_++ % 1000 == 0) {
+        LOG(WARNING) << "Record queue is full (" << queued_bytes_
+                     << " bytes), dropped " << num_dropped_records_
+                     << " records so far.";
+      }
+      return;
+    }
+    done_cv_.wait(l);
+  }
+  queued_bytes_ += size;
+  queue_.push_back(std::move(record));
+  work_cv_.notify_one();
+}
+
+Status AsyncRecordWriter::Flush() {
+  mutex_lock l(mu_);
+  const int64_t flush_id = ++flushes_requested_;
+  work_cv_.notify_one();
+  while (flushes_done_ < flush_id) {
+    done_cv_.wait(l);
+  }
+  Status status = status_;
+  status_ = OkStatus();
+  return status;
+}
+
+int64_t AsyncRecordWriter::num_dropped_records() const {
+  mutex_lock l(mu_);
+  return num_dropped_records_;
+}
+
+bool AsyncRecordWriter::HasWorkLocked() const {
+  return !queue_.empty() || flushes_requested_ > flushes_done_ || stop_;
+}
+
+void AsyncRecordWriter::WriterLoop() {
+  std::deque<std::string> batch;
+  while (true) {
+    int64_t flush_target;
+    bool flush_requested;
+    bool stop;
+    {
+      mutex_lock l(mu_);
+      while (!HasWorkLocked()) {
+        if (records_since_flush_ == 0 || options_.flush_every_millis <= 0) {
+          work_cv_.wait(l);
+          continue;
+        }
+        const uint64 deadline =
+            first_unflushed_micros_ + options_.flush_every_millis * 1000;
+        const uint64 now = env_->NowMicros();
+        if (now >= deadline) break;
+        work_cv_.wait_for(l, std::chrono::microseconds(deadline - now));
+      }
+      batch.swap(queue_);
+      queued_bytes_ = 0;
+      flush_target = flushes_requested_;
+      flush_requested = flushes_requested_ > flushes_done_;
+      stop = stop_;
+    }
+    // There is room in the queue again.
+    done_cv_.notify_all();
+
+    Status status;
+    if (!batch.empty() && records_since_flush_ == 0) {
+      first_unflushed_micros_ = env_->NowMicros();
+    }
+    for (const std::string& record : batch) {
+      status.Update(write_fn_(record));
+    }
+    records_since_flush_ += batch.size();
+    batch.clear();
+
+    const bool flush =
+        flush_requested || stop ||
+        (options_.flush_every_records > 0 &&
+         records_since_flush_ >= options_.flush_every_records) ||
+        (options_.flush_every_millis > 0 && records_since_flush_ > 0 &&
+         env_->NowMicros() >=
+             first_unflushed_micros_ + options_.flush_every_millis * 1000);
+    if (flush && (flush_requested || records_since_flush_ > 0)) {
+      status.Update(flush_fn_());
+      records_since_flush_ = 0;
+    }
+
+    {
+      mutex_lock l(mu_);
+      status_.Update(status);
+      if (flush_requested) flushes_done_ = flush_target;
+    }
+    done_cv_.notify_all();
+    // Write() is not called concurrently with the destructor, so the queue
+    // taken above is the last one.
+    if (stop) return;
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,132 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_UTIL_ASYNC_RECORD_WRITER_H_
+#define TENSORFLOW_CORE_UTIL_ASYNC_RECORD_WRITER_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Moves the appending and flushing of serialized records (e.g. Events for
+// summaries or DebugEvents for tfdbg) off the calling thread.
+//
+// Write() only enqueues the record in a bounded in-memory queue. A background
+// thread takes everything that is queued at once, appends the whole batch
+// with `write_fn` and then calls `flush_fn` if a flush was requested or one of
+// the flush triggers in Options fired. `write_fn` and `flush_fn` are only ever
+// called from the background thread, so the sink they write to (an
+// EventsWriter, an io::RecordWriter, ...) needs no locking of its own.
+//
+// Errors returned by `write_fn` and `flush_fn` are recorded and reported by
+// the next call to Flush().
+class AsyncRecordWriter {
+ public:
+  struct Options {
+    // Upper bound on the total size of the records waiting to be written. A
+    // single record larger than this is still accepted when the queue is
+    // empty.
+    int64_t max_queued_bytes = 64 << 20;
+
+    // What Write() does when the record does not fit into the queue: if
+    // false, it waits for the background thread to make room
+    // (backpressure); if true, it drops the record and counts it in
+    // num_dropped_records().
+    bool drop_when_full = false;
+
+    // The background thread calls `flush_fn` once this many records have
+    // been written since the last flush. 0 disables this trigger.
+    int64_t flush_every_records = 0;
+
+    // The background thread calls `flush_fn` when written records have been
+    // pending for this long. 0 disables this trigger.
+    int64_t flush_every_millis = 0;
+  };
+
+  using WriteFn = std::function<Status(StringPiece record)>;
+  using FlushFn = std::function<Status()>;
+
+  // Starts the background thread. `name` is used for the thread name.
+  AsyncRecordWriter(Env* env, const std::string& name, const Options& options,
+                    WriteFn write_fn, FlushFn flush_fn);
+
+  // Writes and flushes the records that are still queued, then stops the
+  // background thread.
+  ~AsyncRecordWriter();
+
+  // Enqueues `record` for writing. Blocks only if the queue is full and
+  // `drop_when_full` is false.
+  void Write(std::string record);
+
+  // Blocks until every record enqueued before the call has been written and
+  // `flush_fn` has run after them. Returns the first error encountered by
+  // the background thread since the previous Flush().
+  Status Flush();
+
+  // Number of records dropped because the queue was full.
+  int64_t num_dropped_records() const;
+
+ private:
+  void WriterLoop();
+
+  // Whether the background thread has queued records, a flush request or a
+  // shutdown request to act on.
+  bool HasWorkLocked() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Env* const env_;
+  const Options options_;
+  const WriteFn write_fn_;
+  const FlushFn flush_fn_;
+
+  mutable mutex mu_;
+  // Signalled when records, flush requests or the shutdown request arrive.
+  condition_variable work_cv_;
+  // Signalled when the background thread has taken records from the queue
+  // or finished a flush.
+  condition_variable done_cv_;
+  std::deque<std::string> queue_ TF_GUARDED_BY(mu_);
+  int64_t queued_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // Flush() calls are numbered; the background thread has completed every
+  // flush up to `flushes_done_`.
+  int64_t flushes_requested_ TF_GUARDED_BY(mu_) = 0;
+  int64_t flushes_done_ TF_GUARDED_BY(mu_) = 0;
+  Status status_ TF_GUARDED_BY(mu_);
+  int64_t num_dropped_records_ TF_GUARDED_BY(mu_) = 0;
+  bool stop_ TF_GUARDED_BY(mu_) = false;
+
+  // Only accessed by the background thread.
+  int64_t records_since_flush_ = 0;
+  uint64 first_unflushed_micros_ = 0;
+
+  // Declared last so that the thread starts after, and is joined before, the
+  // members above are destroyed.
+  std::unique_ptr<Thread> thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AsyncRecordWriter);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_ASYNC_RECORD_WRITER_H_
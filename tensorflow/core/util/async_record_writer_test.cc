@@ -0,0 +1,166 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/util/async_record_writer.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Sink that records what the background thread wrote and flushed.
+class FakeSink {
+ public:
+  AsyncRecordWriter::WriteFn write_fn() {
+    return [this](StringPiece record) {
+      mutex_lock l(mu_);
+      records_.emplace_back(record);
+      return write_status_;
+    };
+  }
+
+  AsyncRecordWriter::FlushFn flush_fn() {
+    return [this]() {
+      mutex_lock l(mu_);
+      flushed_ = records_.size();
+      return OkStatus();
+    };
+  }
+
+  void set_write_status(const Status& status) {
+    mutex_lock l(mu_);
+    write_status_ = status;
+  }
+
+  std::vector<std::string> records() {
+    mutex_lock l(mu_);
+    return records_;
+  }
+
+  // Number of records that had been written at the last flush.
+  size_t flushed() {
+    mutex_lock l(mu_);
+    return flushed_;
+  }
+
+ private:
+  mutex mu_;
+  std::vector<std::string> records_ TF_GUARDED_BY(mu_);
+  size_t flushed_ TF_GUARDED_BY(mu_) = 0;
+  Status write_status_ TF_GUARDED_BY(mu_);
+};
+
+TEST(AsyncRecordWriterTest, FlushWritesRecordsInOrder) {
+  FakeSink sink;
+  AsyncRecordWriter writer(Env::Default(), "test_writer",
+                           AsyncRecordWriter::Options(), sink.write_fn(),
+                           sink.flush_fn());
+  writer.Write("a");
+  writer.Write("b");
+  writer.Write("c");
+  TF_ASSERT_OK(writer.Flush());
+  EXPECT_EQ(sink.records(), std::vector<std::string>({"a", "b", "c"}));
+  EXPECT_EQ(sink.flushed(), 3);
+
+  writer.Write("d");
+  TF_ASSERT_OK(writer.Flush());
+  EXPECT_EQ(sink.records(), std::vector<std::string>({"a", "b", "c", "d"}));
+  EXPECT_EQ(sink.flushed(), 4);
+}
+
+TEST(AsyncRecordWriterTest, DestructorDrainsQueue) {
+  FakeSink sink;
+  {
+    AsyncRecordWriter writer(Env::Default(), "test_writer",
+                             AsyncRecordWriter::Options(), sink.write_fn(),
+                             sink.flush_fn());
+    for (int i = 0; i < 100; ++i) writer.Write(std::to_string(i));
+  }
+  ASSERT_EQ(sink.records().size(), 100);
+  EXPECT_EQ(sink.records()[99], "99");
+  EXPECT_EQ(sink.flushed(), 100);
+}
+
+TEST(AsyncRecordWriterTest, FlushReportsWriteErrorsOnce) {
+  FakeSink sink;
+  AsyncRecordWriter writer(Env::Default(), "test_writer",
+                           AsyncRecordWriter::Options(), sink.write_fn(),
+                           sink.flush_fn());
+  sink.set_write_status(errors::DataLoss("disk on fire"));
+  writer.Write("a");
+  EXPECT_EQ(writer.Flush().code(), error::DATA_LOSS);
+
+  sink.set_write_status(OkStatus());
+  writer.Write("b");
+  TF_EXPECT_OK(writer.Flush());
+}
+
+TEST(AsyncRecordWriterTest, DropsRecordsWhenFull) {
+  Notification writing;
+  Notification unblock;
+  FakeSink sink;
+  AsyncRecordWriter::WriteFn sink_write_fn = sink.write_fn();
+  AsyncRecordWriter::Options options;
+  options.max_queued_bytes = 10;
+  options.drop_when_full = true;
+  AsyncRecordWriter writer(
+      Env::Default(), "test_writer", options,
+      [&](StringPiece record) {
+        // Keep the background thread busy with the first record.
+        if (!writing.HasBeenNotified()) {
+          writing.Notify();
+          unblock.WaitForNotification();
+        }
+        return sink_write_fn(record);
+      },
+      sink.flush_fn());
+  writer.Write("0000");
+  writing.WaitForNotification();
+  // The queue is empty again; two more records fit into it, the third does
+  // not.
+  writer.Write("1111");
+  writer.Write("2222");
+  writer.Write("3333");
+  EXPECT_EQ(writer.num_dropped_records(), 1);
+  unblock.Notify();
+  TF_ASSERT_OK(writer.Flush());
+  EXPECT_EQ(sink.records(),
+            std::vector<std::string>({"0000", "1111", "2222"}));
+}
+
+TEST(AsyncRecordWriterTest, FlushEveryMillis) {
+  FakeSink sink;
+  AsyncRecordWriter::Options options;
+  options.flush_every_millis = 1;
+  AsyncRecordWriter writer(Env::Default(), "test_writer", options,
+                           sink.write_fn(), sink.flush_fn());
+  writer.Write("a");
+  // The background thread flushes without an explicit Flush().
+  while (sink.flushed() < 1) {
+    Env::Default()->SleepForMicroseconds(1000);
+  }
+  EXPECT_EQ(sink.records(), std::vector<std::string>({"a"}));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/util/activation_mode.h"
 #include "tensorflow/core/util/autotune_maps/autotune_map.pb.h"
 #include "tensorflow/core/util/autotune_maps/conv_autotune_maps.h"
+#include "tensorflow/core/util/autotune_maps/conv_layout_timings.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
 #include "tensorflow/tsl/lib/strings/proto_serialization.h"
@@ -180,12 +181,12 @@ Status SerializeAutotuneMaps(std::string *output) {
   TF_ASSIGN_OR_RETURN(*proto.mutable_fused_conv_map(),
                       ConvMapToProto(*FusedConvAutotuneMap::GetInstance()));
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  ConvLayoutTimings::Global()->ToProto(&proto);
   TF_RET_CHECK(tsl::SerializeToStringDeterministic(proto, output));
   return OkStatus();
 }
 
 Status LoadSerializedAutotuneMaps(absl::string_view s) {
-#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   AutotuneMapsProto proto;
   // The explicit string conversion here is a workaround for
   // resolving the issue that OSS proto library's ParseFromString only accepts
@@ -194,6 +195,8 @@ Status LoadSerializedAutotuneMaps(absl::string_view s) {
     return errors::InvalidArgument(
         "Failed to parse the autotune maps from string.");
   }
+  ConvLayoutTimings::Global()->MergeFromProto(proto);
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   TF_RETURN_IF_ERROR(
       PopulateConvMap(proto.conv_map(), ConvAutotuneMap::GetInstance()));
   TF_RETURN_IF_ERROR(PopulateConvMap(proto.fused_conv_map(),
@@ -204,6 +207,7 @@ Status LoadSerializedAutotuneMaps(absl::string_view s) {
 }
 
 void ResetAutotuneMaps() {
+  ConvLayoutTimings::Global()->Clear();
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   ConvAutotuneMap::GetInstance()->ClearMap();
   FusedConvAutotuneMap::GetInstance()->ClearMap();
@@ -0,0 +1,101 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/autotune_maps/conv_layout_timings.h"
+
+#include "tensorflow/tsl/lib/strings/proto_serialization.h"
+
+namespace tensorflow {
+
+ConvLayoutTimings* ConvLayoutTimings::Global() {
+  static ConvLayoutTimings* timings = new ConvLayoutTimings();
+  return timings;
+}
+
+// static
+std::string ConvLayoutTimings::Key(const ConvParametersProto& params) {
+  ConvParametersProto key = params;
+  key.clear_version();
+  std::string serialized;
+  tsl::SerializeToStringDeterministic(key, &serialized);
+  return serialized;
+}
+
+void ConvLayoutTimings::RecordRunTime(const ConvParametersProto& params,
+                                      absl::Duration run_time) {
+  const int64_t run_time_ns = absl::ToInt64Nanoseconds(run_time);
+  if (run_time_ns <= 0) return;
+  const std::string key = Key(params);
+  mutex_lock l(mu_);
+  auto it = run_times_.find(key);
+  if (it == run_times_.end()) {
+    ConvRunTimeMapProto::Entry& entry = run_times_[key];
+    *entry.mutable_key() = params;
+    entry.mutable_key()->clear_version();
+    entry.set_run_time_ns(run_time_ns);
+  } else if (run_time_ns < it->second.run_time_ns()) {
+    it->second.set_run_time_ns(run_time_ns);
+  }
+}
+
+std::optional<absl::Duration> ConvLayoutTimings::GetRunTime(
+    const ConvParametersProto& params) const {
+  const std::string key = Key(params);
+  tf_shared_lock l(mu_);
+  auto it = run_times_.find(key);
+  if (it == run_times_.end()) return std::nullopt;
+  return absl::Nanoseconds(it->second.run_time_ns());
+}
+
+void ConvLayoutTimings::RecordLayoutDecision(const std::string& region,
+                                             const std::string& data_format) {
+  mutex_lock l(mu_);
+  layout_decisions_[region] = data_format;
+}
+
+std::optional<std::string> ConvLayoutTimings::GetLayoutDecision(
+    const std::string& region) const {
+  tf_shared_lock l(mu_);
+  auto it = layout_decisions_.find(region);
+  if (it == layout_decisions_.end()) return std::nullopt;
+  return it->second;
+}
+
+void ConvLayoutTimings::ToProto(AutotuneMapsProto* proto) const {
+  tf_shared_lock l(mu_);
+  for (const auto& run_time : run_times_) {
+    *proto->mutable_conv_run_times()->add_kv_pairs() = run_time.second;
+  }
+  for (const auto& decision : layout_decisions_) {
+    (*proto->mutable_layout_decisions())[decision.first] = decision.second;
+  }
+}
+
+void ConvLayoutTimings::MergeFromProto(const AutotuneMapsProto& proto) {
+  for (const auto& entry : proto.conv_run_times().kv_pairs()) {
+    RecordRunTime(entry.key(), absl::Nanoseconds(entry.run_time_ns()));
+  }
+  for (const auto& decision : proto.layout_decisions()) {
+    RecordLayoutDecision(decision.first, decision.second);
+  }
+}
+
+void ConvLayoutTimings::Clear() {
+  mutex_lock l(mu_);
+  run_times_.clear();
+  layout_decisions_.clear();
+}
+
+}  // namespace tensorflow
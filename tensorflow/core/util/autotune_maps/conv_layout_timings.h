@@ -0,0 +1,73 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_CONV_LAYOUT_TIMINGS_H_
+#define TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_CONV_LAYOUT_TIMINGS_H_
+
+#include <map>
+#include <optional>
+#include <string>
+
+#include "absl/time/time.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/autotune_maps/autotune_map.pb.h"
+#include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
+
+namespace tensorflow {
+
+// The fastest run times measured by conv autotuning, so that the layout
+// optimizer can compare the data formats of a convolution, and the data
+// formats it picked from them. Unlike the autotune maps, this doesn't depend
+// on GPU support, and is saved and restored with the autotune maps by
+// SerializeAutotuneMaps and LoadSerializedAutotuneMaps.
+class ConvLayoutTimings {
+ public:
+  static ConvLayoutTimings* Global();
+
+  // Keeps the fastest run time of the convolution `params`, whose data_format
+  // is the format the convolution was computed in. The version of `params`
+  // is ignored.
+  void RecordRunTime(const ConvParametersProto& params,
+                     absl::Duration run_time);
+  std::optional<absl::Duration> GetRunTime(
+      const ConvParametersProto& params) const;
+
+  // `region` identifies the convolutions `data_format` was picked for.
+  void RecordLayoutDecision(const std::string& region,
+                            const std::string& data_format);
+  std::optional<std::string> GetLayoutDecision(
+      const std::string& region) const;
+
+  // Writes the run times and layout decisions into `proto`, deterministically.
+  void ToProto(AutotuneMapsProto* proto) const;
+  // Adds the run times and layout decisions of `proto`.
+  void MergeFromProto(const AutotuneMapsProto& proto);
+
+  void Clear();
+
+ private:
+  static std::string Key(const ConvParametersProto& params);
+
+  mutable mutex mu_;
+  // Keyed by the deterministic serialization of the parameters.
+  std::map<std::string, ConvRunTimeMapProto::Entry> run_times_
+      TF_GUARDED_BY(mu_);
+  std::map<std::string, std::string> layout_decisions_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_CONV_LAYOUT_TIMINGS_H_
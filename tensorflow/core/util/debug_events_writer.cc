@@ -57,6 +57,19 @@ Status SingleDebugEventFileWriter::Init() {
     return errors::Unknown("Could not create record writer at path: ",
                            file_path_);
   }
+  async_writer_ = std::make_unique<AsyncRecordWriter>(
+      env_, "debug_event_file_writer", AsyncRecordWriter::Options(),
+      [this](StringPiece record) {
+        mutex_lock l(writer_mu_);
+        return record_writer_->WriteRecord(record);
+      },
+      [this]() -> Status {
+        {
+          mutex_lock l(writer_mu_);
+          TF_RETURN_IF_ERROR(record_writer_->Flush());
+        }
+        return writable_file_->Sync();
+      });
   num_outstanding_events_.store(0);
   VLOG(1) << "Successfully opened debug events file: " << file_path_;
   return OkStatus();
@@ -71,10 +84,7 @@ void SingleDebugEventFileWriter::WriteSerializedDebugEvent(
     }
   }
   num_outstanding_events_.fetch_add(1);
-  {
-    mutex_lock l(writer_mu_);
-    record_writer_->WriteRecord(debug_event_str).IgnoreError();
-  }
+  async_writer_->Write(std::string(debug_event_str));
 }
 
 Status SingleDebugEventFileWriter::Flush() {
@@ -86,14 +96,7 @@ Status SingleDebugEventFileWriter::Flush() {
     return errors::Unknown("Unexpected NULL file for path: ", file_path_);
   }
 
-  {
-    mutex_lock l(writer_mu_);
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(record_writer_->Flush(), "Failed to flush ",
-                                    num_outstanding, " debug events to ",
-                                    file_path_);
-  }
-
-  TF_RETURN_WITH_CONTEXT_IF_ERROR(writable_file_->Sync(), "Failed to sync ",
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(async_writer_->Flush(), "Failed to flush ",
                                   num_outstanding, " debug events to ",
                                   file_path_);
   num_outstanding_events_.store(0);
@@ -103,6 +106,8 @@ Status SingleDebugEventFileWriter::Flush() {
 Status SingleDebugEventFileWriter::Close() {
   Status status = Flush();
   if (writable_file_ != nullptr) {
+    // Stop the background thread before the file it writes to is closed.
+    async_writer_.reset();
     Status close_status = writable_file_->Close();
     if (!close_status.ok()) {
       status = close_status;
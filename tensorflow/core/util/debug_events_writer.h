@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/debug_event.pb.h"
+#include "tensorflow/core/util/async_record_writer.h"
 
 namespace tensorflow {
 namespace tfdbg {
@@ -44,6 +45,8 @@ enum DebugEventFileType {
 // This class manages the writing of data to a single TFRecord file.
 // Each object of the DebugEventsWriter class below involves multiple
 // TFRecord files, and hence utilizes multiple objects of this helper class.
+// Records are appended to the file by a background thread; Flush() waits for
+// the records written so far to reach the file.
 class SingleDebugEventFileWriter {
  public:
   explicit SingleDebugEventFileWriter(const string& file_path);
@@ -65,6 +68,7 @@ class SingleDebugEventFileWriter {
   std::unique_ptr<WritableFile> writable_file_;
   std::unique_ptr<io::RecordWriter> record_writer_ TF_PT_GUARDED_BY(writer_mu_);
   mutex writer_mu_;
+  std::unique_ptr<AsyncRecordWriter> async_writer_;
 };
 
 // The DebugEvents writer class.
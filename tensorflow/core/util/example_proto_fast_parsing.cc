@@ -14,10 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <cstring>
 #include <vector>
 
 #include "absl/base/casts.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/numeric/bits.h"
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -113,6 +115,72 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+// Mask of the continuation bits of eight consecutive varint bytes.
+constexpr uint64 kVarintContinuationBits = 0x8080808080808080ULL;
+
+// Returns a pointer to the `size` bytes at the current position of `stream`,
+// or nullptr if they are not all in its buffer.
+const uint8* GetContiguousBytes(protobuf::io::CodedInputStream* stream,
+                                uint32 size) {
+  const void* ptr;
+  int buffer_size;
+  if (!stream->GetDirectBufferPointer(&ptr, &buffer_size) ||
+      static_cast<uint32>(buffer_size) < size) {
+    return nullptr;
+  }
+  return static_cast<const uint8*>(ptr);
+}
+
+// Returns the number of varints that end in the packed buffer [begin, end),
+// i.e. the number of bytes without a continuation bit.
+size_t CountPackedVarints(const uint8* begin, const uint8* end) {
+  size_t num_continuation_bytes = 0;
+  const uint8* p = begin;
+  for (; end - p >= 8; p += 8) {
+    uint64 word;
+    std::memcpy(&word, p, sizeof(word));
+    num_continuation_bytes += absl::popcount(word & kVarintContinuationBits);
+  }
+  for (; p < end; ++p) num_continuation_bytes += *p >> 7;
+  return (end - begin) - num_continuation_bytes;
+}
+
+// Decodes the packed varints in [begin, end) into `out`, which has room for
+// `max_values` values. Values beyond `max_values` are validated but dropped.
+// Returns false if the buffer does not hold a sequence of valid varints.
+//
+// Runs of eight one-byte varints (e.g. small ids or counts) are detected with
+// a single mask test and widened with a loop that compilers vectorize.
+bool DecodePackedVarints(const uint8* begin, const uint8* end, int64_t* out,
+                         size_t max_values) {
+  const uint8* p = begin;
+  size_t index = 0;
+  while (p < end) {
+    if (end - p >= 8 && index + 8 <= max_values) {
+      uint64 word;
+      std::memcpy(&word, p, sizeof(word));
+      if ((word & kVarintContinuationBits) == 0) {
+        int64_t* dst = out + index;
+        for (int i = 0; i < 8; ++i) dst[i] = p[i];
+        p += 8;
+        index += 8;
+        continue;
+      }
+    }
+    uint64 value = 0;
+    for (int shift = 0;; shift += 7) {
+      // A varint has at most 10 bytes.
+      if (p == end || shift > 63) return false;
+      const uint8 byte = *p++;
+      value |= static_cast<uint64>(byte & 0x7f) << shift;
+      if (byte < 0x80) break;
+    }
+    if (index < max_values) out[index] = static_cast<int64_t>(value);
+    ++index;
+  }
+  return true;
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -301,6 +369,24 @@ class Feature {
         if (!stream.ReadVarint32(&packed_length)) return false;
         auto packed_limit = stream.PushLimit(packed_length);
 
+        // The stream reads from a flat buffer, so the packed values can be
+        // counted and decoded in bulk, straight into the resized output.
+        const uint8* packed = GetContiguousBytes(&stream, packed_length);
+        if (packed_length > 0 && packed != nullptr) {
+          const uint8* packed_end = packed + packed_length;
+          const size_t initial_size = int64_list->size();
+          int64_list->resize(initial_size +
+                             CountPackedVarints(packed, packed_end));
+          // The available room can be less than what was requested in
+          // resize in case of a LimitedArraySlice.
+          const size_t max_values = int64_list->size() - initial_size;
+          if (!DecodePackedVarints(packed, packed_end,
+                                   int64_list->data() + initial_size,
+                                   max_values)) {
+            return false;
+          }
+          if (!stream.Skip(packed_length)) return false;
+        }
         while (!stream.ExpectAtEnd()) {
           protobuf_uint64 n;  // There is no API for int64
           if (!stream.ReadVarint64(&n)) return false;
@@ -1921,6 +2007,14 @@ inline int ParseFloatFeature(protobuf::io::CodedInputStream* stream,
         return -1;
       }
       auto packed_limit = stream->PushLimit(packed_length);
+      // On a little endian machine, the packed values can be copied as is.
+      const uint8* packed = GetContiguousBytes(stream, packed_length);
+      if (port::kLittleEndian && packed_length > 0 && packed != nullptr &&
+          packed_length % sizeof(float) == 0) {
+        if (out != nullptr) std::memcpy(out, packed, packed_length);
+        num_elements = packed_length / sizeof(float);
+        if (!stream->Skip(packed_length)) return -1;
+      }
       while (!stream->ExpectAtEnd()) {
         uint32 buffer32;
         if (!stream->ReadLittleEndian32(&buffer32)) {
@@ -1972,6 +2066,17 @@ inline int ParseInt64Feature(protobuf::io::CodedInputStream* stream,
         return -1;
       }
       auto packed_limit = stream->PushLimit(packed_length);
+      const uint8* packed = GetContiguousBytes(stream, packed_length);
+      if (packed_length > 0 && packed != nullptr) {
+        const uint8* packed_end = packed + packed_length;
+        const size_t count = CountPackedVarints(packed, packed_end);
+        if (!DecodePackedVarints(packed, packed_end, out,
+                                 out == nullptr ? 0 : count)) {
+          return -1;
+        }
+        num_elements = count;
+        if (!stream->Skip(packed_length)) return -1;
+      }
       while (!stream->ExpectAtEnd()) {
         protobuf_uint64 n;  // There is no API for int64
         if (!stream->ReadVarint64(&n)) {
@@ -13,12 +13,14 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <limits>
 #include <utility>
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -217,6 +219,33 @@ TEST(FastParse, SingleInt64) {
   TestCorrectness(Serialize(example));
 }
 
+// Returns an example with an int64 list that mixes runs of one-byte varints
+// with multi-byte and negative (ten-byte) values.
+static string ExampleWithPackedInt64s() {
+  Example example;
+  Int64List* int64_list =
+      (*example.mutable_features()->mutable_feature())["ids"]
+          .mutable_int64_list();
+  for (int64_t i = 0; i < 20; ++i) int64_list->add_value(i);
+  int64_list->add_value(300);
+  int64_list->add_value(-1);
+  for (int64_t i = 0; i < 9; ++i) int64_list->add_value(127 - i);
+  int64_list->add_value(std::numeric_limits<int64_t>::max());
+  int64_list->add_value(std::numeric_limits<int64_t>::min());
+  int64_list->add_value(128);
+  return Serialize(example);
+}
+
+TEST(FastParse, PackedInt64s) { TestCorrectness(ExampleWithPackedInt64s()); }
+
+TEST(FastParse, TruncatedPackedInt64) {
+  // The packed int64 list holds a single byte with a continuation bit.
+  Example example;
+  EXPECT_FALSE(TestFastParse(
+      "\x0a\x0e\x0a\x0c\x0a\x03\x61\x67\x65\x12\x05\x1a\x03\x0a\x01\x80",
+      &example));
+}
+
 static string ExampleWithSomeFeatures() {
   Example example;
 
@@ -427,6 +456,33 @@ TEST(TestFastParseExample, Empty) {
   EXPECT_TRUE(status.ok()) << status;
 }
 
+TEST(TestFastParseExample, DensePackedInt64s) {
+  const std::vector<tstring> serialized(3, ExampleWithPackedInt64s());
+  Example example;
+  ASSERT_TRUE(example.ParseFromString(serialized[0]));
+  const auto& expected = example.features().feature().at("ids").int64_list();
+
+  FastParseExampleConfig config;
+  AddDenseFeature("ids", DT_INT64, {expected.value_size()}, false,
+                  expected.value_size(), &config);
+  Result result;
+  TF_ASSERT_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  ASSERT_EQ(result.dense_values.size(), 1);
+  const auto values = result.dense_values[0].matrix<int64_t>();
+  for (int i = 0; i < serialized.size(); ++i) {
+    for (int j = 0; j < expected.value_size(); ++j) {
+      EXPECT_EQ(values(i, j), expected.value(j));
+    }
+  }
+
+  // One value too many for the dense shape.
+  FastParseExampleConfig short_config;
+  AddDenseFeature("ids", DT_INT64, {expected.value_size() - 1}, false,
+                  expected.value_size() - 1, &short_config);
+  EXPECT_FALSE(
+      FastParseExample(short_config, serialized, {}, nullptr, &result).ok());
+}
+
 }  // namespace
 }  // namespace example
 }  // namespace tensorflow
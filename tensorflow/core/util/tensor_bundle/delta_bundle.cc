@@ -0,0 +1,447 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/util/tensor_bundle/delta_bundle.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Suffixes of the bundle keys that hold the parts of a tensor added under a
+// key `k`. A dense tensor is stored in full under `k`, or as a delta under
+// `k/.delta_base`, `k/.delta_rows` and `k/.delta_values`. A keyed tensor is
+// stored in full under `k/.keys` and `k/.values`, or as a delta under
+// `k/.delta_base`, `k/.delta_keys`, `k/.delta_values` and
+// `k/.delta_deleted_keys`.
+constexpr char kDeltaBaseSuffix[] = "/.delta_base";
+constexpr char kDeltaRowsSuffix[] = "/.delta_rows";
+constexpr char kDeltaValuesSuffix[] = "/.delta_values";
+constexpr char kKeysSuffix[] = "/.keys";
+constexpr char kValuesSuffix[] = "/.values";
+constexpr char kDeltaKeysSuffix[] = "/.delta_keys";
+constexpr char kDeltaDeletedKeysSuffix[] = "/.delta_deleted_keys";
+
+// Bounds the length of a chain of bundles, which also guards against cycles.
+constexpr int kMaxChainDepth = 1000;
+
+// Returns true iff the rows of `t` can be fingerprinted and copied.
+bool SupportsRows(const Tensor& t) {
+  return t.dims() > 0 &&
+         (DataTypeCanUseMemcpy(t.dtype()) || t.dtype() == DT_STRING);
+}
+
+uint64 RowFingerprint(const Tensor& t, int64_t row) {
+  const int64_t row_elements = t.NumElements() / t.dim_size(0);
+  if (t.dtype() == DT_STRING) {
+    const tstring* elements = t.flat<tstring>().data() + row * row_elements;
+    uint64 fingerprint = 0;
+    for (int64_t i = 0; i < row_elements; ++i) {
+      fingerprint = FingerprintCat64(fingerprint, Fingerprint64(elements[i]));
+    }
+    return fingerprint;
+  }
+  const int64_t row_bytes = t.TotalBytes() / t.dim_size(0);
+  return Fingerprint64(
+      StringPiece(t.tensor_data().data() + row * row_bytes, row_bytes));
+}
+
+// Copies row `src_row` of `src` to row `dst_row` of `dst`, which must have
+// the same dtype and row shape.
+void CopyRow(const Tensor& src, int64_t src_row, Tensor* dst,
+             int64_t dst_row) {
+  if (src.dtype() == DT_STRING) {
+    const int64_t row_elements = src.NumElements() / src.dim_size(0);
+    const tstring* from = src.flat<tstring>().data() + src_row * row_elements;
+    tstring* to = dst->flat<tstring>().data() + dst_row * row_elements;
+    std::copy(from, from + row_elements, to);
+    return;
+  }
+  const int64_t row_bytes = src.TotalBytes() / src.dim_size(0);
+  std::memcpy(const_cast<char*>(dst->tensor_data().data()) + dst_row * row_bytes,
+              src.tensor_data().data() + src_row * row_bytes, row_bytes);
+}
+
+// Returns a tensor holding the given rows of `t`.
+Tensor GatherRows(const Tensor& t, const std::vector<int64_t>& rows) {
+  TensorShape shape = t.shape();
+  shape.set_dim(0, rows.size());
+  Tensor result(t.dtype(), shape);
+  for (int64_t i = 0; i < rows.size(); ++i) {
+    CopyRow(t, rows[i], &result, i);
+  }
+  return result;
+}
+
+// Returns the shape of the rows of `t`, with a first dimension of size 0.
+TensorShape RowShape(const Tensor& t) {
+  TensorShape shape = t.shape();
+  shape.set_dim(0, 0);
+  return shape;
+}
+
+Status ReadTensor(BundleReader* reader, const string& key, Tensor* val) {
+  DataType dtype;
+  TensorShape shape;
+  TF_RETURN_IF_ERROR(reader->LookupDtypeAndShape(key, &dtype, &shape));
+  *val = Tensor(dtype, shape);
+  return reader->Lookup(key, val);
+}
+
+Status ReadBasePrefix(BundleReader* reader, const string& key,
+                      string* base_prefix) {
+  Tensor base;
+  TF_RETURN_IF_ERROR(ReadTensor(reader, key + kDeltaBaseSuffix, &base));
+  if (base.dtype() != DT_STRING || base.NumElements() != 1) {
+    return errors::DataLoss("Invalid delta base of ", key);
+  }
+  *base_prefix = base.flat<tstring>()(0);
+  return OkStatus();
+}
+
+// Returns an error unless the rows of `delta` can be copied into `val`.
+Status CheckSameRows(const string& key, const Tensor& val,
+                     const Tensor& delta) {
+  if (delta.dtype() != val.dtype() || !SupportsRows(delta) ||
+      RowShape(delta) != RowShape(val)) {
+    return errors::DataLoss("Delta of ", key, " with dtype ",
+                            DataTypeString(delta.dtype()), " and shape ",
+                            delta.shape().DebugString(),
+                            " does not match its base with dtype ",
+                            DataTypeString(val.dtype()), " and shape ",
+                            val.shape().DebugString());
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+DeltaCheckpointState::DeltaCheckpointState(int max_chain_length)
+    : max_chain_length_(max_chain_length) {}
+
+string DeltaCheckpointState::base_prefix() const {
+  mutex_lock l(mu_);
+  return base_prefix_;
+}
+
+void DeltaCheckpointState::Reset() {
+  mutex_lock l(mu_);
+  base_prefix_.clear();
+  chain_length_ = 0;
+  tensors_.clear();
+}
+
+DeltaBundleWriter::DeltaBundleWriter(Env* env, StringPiece prefix,
+                                     DeltaCheckpointState* state,
+                                     const BundleWriter::Options& options)
+    : state_(state), prefix_(prefix), writer_(env, prefix, options) {
+  mutex_lock l(state_->mu_);
+  if (state_->chain_length_ < state_->max_chain_length_ &&
+      state_->base_prefix_ != prefix_) {
+    base_prefix_ = state_->base_prefix_;
+  }
+}
+
+Status DeltaBundleWriter::Add(StringPiece key, const Tensor& val) {
+  const string key_string(key);
+  if (new_states_.contains(key_string)) {
+    return errors::InvalidArgument("Adding duplicate key: ", key);
+  }
+  DeltaCheckpointState::TensorState& new_state = new_states_[key_string];
+  new_state.dtype = val.dtype();
+  new_state.shape = val.shape();
+  if (!SupportsRows(val)) return writer_.Add(key_string, val);
+
+  const int64_t num_rows = val.dim_size(0);
+  new_state.row_fingerprints.resize(num_rows);
+  for (int64_t i = 0; i < num_rows; ++i) {
+    new_state.row_fingerprints[i] = RowFingerprint(val, i);
+  }
+
+  bool use_delta = false;
+  std::vector<int64_t> changed_rows;
+  if (!base_prefix_.empty()) {
+    mutex_lock l(state_->mu_);
+    auto it = state_->tensors_.find(key_string);
+    if (it != state_->tensors_.end() && it->second.dtype == val.dtype() &&
+        it->second.shape == val.shape() &&
+        it->second.row_fingerprints.size() == num_rows) {
+      for (int64_t i = 0; i < num_rows; ++i) {
+        if (it->second.row_fingerprints[i] != new_state.row_fingerprints[i]) {
+          changed_rows.push_back(i);
+        }
+      }
+      use_delta = changed_rows.size() * 2 <= num_rows;
+    }
+  }
+  if (!use_delta) return writer_.Add(key_string, val);
+
+  VLOG(1) << "Writing " << changed_rows.size() << " of " << num_rows
+          << " rows of " << key << " relative to " << base_prefix_;
+  Tensor rows(DT_INT64, TensorShape({static_cast<int64_t>(changed_rows.size())}));
+  std::copy(changed_rows.begin(), changed_rows.end(),
+            rows.flat<int64_t>().data());
+  TF_RETURN_IF_ERROR(writer_.Add(key_string + kDeltaBaseSuffix,
+                                 Tensor(tstring(base_prefix_))));
+  TF_RETURN_IF_ERROR(writer_.Add(key_string + kDeltaRowsSuffix, rows));
+  return writer_.Add(key_string + kDeltaValuesSuffix,
+                     GatherRows(val, changed_rows));
+}
+
+Status DeltaBundleWriter::AddKeyed(StringPiece key, const Tensor& keys,
+                                   const Tensor& values) {
+  const string key_string(key);
+  if (new_states_.contains(key_string)) {
+    return errors::InvalidArgument("Adding duplicate key: ", key);
+  }
+  if (keys.dims() != 1 || !SupportsRows(keys) || !SupportsRows(values) ||
+      values.dim_size(0) != keys.dim_size(0)) {
+    return errors::InvalidArgument(
+        "Keyed tensor ", key, " needs keys of shape [N] and values of shape ",
+        "[N, ...], with numeric or string dtypes, got keys ",
+        keys.shape().DebugString(), " and values ",
+        values.shape().DebugString());
+  }
+  const int64_t num_rows = keys.dim_size(0);
+  DeltaCheckpointState::TensorState new_state;
+  new_state.dtype = values.dtype();
+  new_state.shape = RowShape(values);
+  new_state.keys = tensor::DeepCopy(keys);
+  new_state.keyed_rows.reserve(num_rows);
+  for (int64_t i = 0; i < num_rows; ++i) {
+    if (!new_state.keyed_rows
+             .emplace(RowFingerprint(keys, i),
+                      std::make_pair(i, RowFingerprint(values, i)))
+             .second) {
+      return errors::InvalidArgument("Duplicate keys in keyed tensor ", key);
+    }
+  }
+
+  bool use_delta = false;
+  std::vector<int64_t> upserted_rows;
+  std::vector<int64_t> deleted_rows;
+  Tensor old_keys;
+  if (!base_prefix_.empty()) {
+    mutex_lock l(state_->mu_);
+    auto it = state_->tensors_.find(key_string);
+    if (it != state_->tensors_.end() && it->second.keys.IsInitialized() &&
+        it->second.dtype == new_state.dtype &&
+        it->second.shape == new_state.shape &&
+        it->second.keys.dtype() == keys.dtype()) {
+      const DeltaCheckpointState::TensorState& old_state = it->second;
+      for (const auto& entry : new_state.keyed_rows) {
+        auto old = old_state.keyed_rows.find(entry.first);
+        if (old == old_state.keyed_rows.end() ||
+            old->second.second != entry.second.second) {
+          upserted_rows.push_back(entry.second.first);
+        }
+      }
+      for (const auto& entry : old_state.keyed_rows) {
+        if (!new_state.keyed_rows.contains(entry.first)) {
+          deleted_rows.push_back(entry.second.first);
+        }
+      }
+      old_keys = old_state.keys;
+      use_delta = upserted_rows.size() * 2 <= num_rows;
+    }
+  }
+  new_states_[key_string] = std::move(new_state);
+  if (!use_delta) {
+    TF_RETURN_IF_ERROR(writer_.Add(key_string + kKeysSuffix, keys));
+    return writer_.Add(key_string + kValuesSuffix, values);
+  }
+
+  VLOG(1) << "Writing " << upserted_rows.size() << " updated and "
+          << deleted_rows.size() << " deleted of " << num_rows << " keys of "
+          << key << " relative to " << base_prefix_;
+  // Keeps the delta independent of the iteration order of the table.
+  std::sort(upserted_rows.begin(), upserted_rows.end());
+  std::sort(deleted_rows.begin(), deleted_rows.end());
+  TF_RETURN_IF_ERROR(writer_.Add(key_string + kDeltaBaseSuffix,
+                                 Tensor(tstring(base_prefix_))));
+  TF_RETURN_IF_ERROR(writer_.Add(key_string + kDeltaKeysSuffix,
+                                 GatherRows(keys, upserted_rows)));
+  TF_RETURN_IF_ERROR(writer_.Add(key_string + kDeltaValuesSuffix,
+                                 GatherRows(values, upserted_rows)));
+  return writer_.Add(key_string + kDeltaDeletedKeysSuffix,
+                     GatherRows(old_keys, deleted_rows));
+}
+
+Status DeltaBundleWriter::Finish() {
+  TF_RETURN_IF_ERROR(writer_.Finish());
+  mutex_lock l(state_->mu_);
+  state_->chain_length_ =
+      base_prefix_.empty() ? 0 : state_->chain_length_ + 1;
+  state_->base_prefix_ = prefix_;
+  state_->tensors_ = std::move(new_states_);
+  return OkStatus();
+}
+
+DeltaBundleReader::DeltaBundleReader(Env* env, StringPiece prefix)
+    : env_(env), prefix_(prefix) {
+  BundleReader* reader;
+  status_ = GetReader(prefix_, &reader);
+}
+
+Status DeltaBundleReader::GetReader(const string& prefix,
+                                    BundleReader** reader) {
+  std::unique_ptr<BundleReader>& cached = readers_[prefix];
+  if (cached == nullptr) {
+    auto new_reader = std::make_unique<BundleReader>(env_, prefix);
+    if (!new_reader->status().ok()) {
+      readers_.erase(prefix);
+      return new_reader->status();
+    }
+    cached = std::move(new_reader);
+  }
+  *reader = cached.get();
+  return OkStatus();
+}
+
+Status DeltaBundleReader::Lookup(StringPiece key, Tensor* val) {
+  TF_RETURN_IF_ERROR(status_);
+  return LookupIn(prefix_, string(key), /*depth=*/0, val);
+}
+
+Status DeltaBundleReader::LookupKeyed(StringPiece key, Tensor* keys,
+                                      Tensor* values) {
+  TF_RETURN_IF_ERROR(status_);
+  return LookupKeyedIn(prefix_, string(key), /*depth=*/0, keys, values);
+}
+
+Status DeltaBundleReader::LookupIn(const string& prefix, const string& key,
+                                   int depth, Tensor* val) {
+  if (depth > kMaxChainDepth) {
+    return errors::DataLoss("Too many delta bundles for ", key, " at ",
+                            prefix_);
+  }
+  BundleReader* reader;
+  TF_RETURN_IF_ERROR(GetReader(prefix, &reader));
+  if (reader->Contains(key)) return ReadTensor(reader, key, val);
+  if (!reader->Contains(key + kDeltaBaseSuffix)) {
+    return errors::NotFound("Key ", key, " not found in checkpoint ", prefix);
+  }
+  string base_prefix;
+  TF_RETURN_IF_ERROR(ReadBasePrefix(reader, key, &base_prefix));
+  TF_RETURN_IF_ERROR(LookupIn(base_prefix, key, depth + 1, val));
+
+  Tensor rows, values;
+  TF_RETURN_IF_ERROR(ReadTensor(reader, key + kDeltaRowsSuffix, &rows));
+  TF_RETURN_IF_ERROR(ReadTensor(reader, key + kDeltaValuesSuffix, &values));
+  TF_RETURN_IF_ERROR(CheckSameRows(key, *val, values));
+  if (rows.dtype() != DT_INT64 || rows.dims() != 1 ||
+      rows.dim_size(0) != values.dim_size(0)) {
+    return errors::DataLoss("Invalid delta rows of ", key, " in ", prefix);
+  }
+  const auto rows_flat = rows.flat<int64_t>();
+  for (int64_t i = 0; i < rows.dim_size(0); ++i) {
+    if (rows_flat(i) < 0 || rows_flat(i) >= val->dim_size(0)) {
+      return errors::DataLoss("Delta row ", rows_flat(i), " of ", key,
+                              " is out of range in ", prefix);
+    }
+    CopyRow(values, i, val, rows_flat(i));
+  }
+  return OkStatus();
+}
+
+Status DeltaBundleReader::LookupKeyedIn(const string& prefix,
+                                        const string& key, int depth,
+                                        Tensor* keys, Tensor* values) {
+  if (depth > kMaxChainDepth) {
+    return errors::DataLoss("Too many delta bundles for ", key, " at ",
+                            prefix_);
+  }
+  BundleReader* reader;
+  TF_RETURN_IF_ERROR(GetReader(prefix, &reader));
+  if (reader->Contains(key + kKeysSuffix)) {
+    TF_RETURN_IF_ERROR(ReadTensor(reader, key + kKeysSuffix, keys));
+    return ReadTensor(reader, key + kValuesSuffix, values);
+  }
+  if (!reader->Contains(key + kDeltaBaseSuffix)) {
+    return errors::NotFound("Key ", key, " not found in checkpoint ", prefix);
+  }
+  string base_prefix;
+  TF_RETURN_IF_ERROR(ReadBasePrefix(reader, key, &base_prefix));
+  Tensor base_keys, base_values;
+  TF_RETURN_IF_ERROR(LookupKeyedIn(base_prefix, key, depth + 1, &base_keys,
+                                   &base_values));
+
+  Tensor delta_keys, delta_values, deleted_keys;
+  TF_RETURN_IF_ERROR(ReadTensor(reader, key + kDeltaKeysSuffix, &delta_keys));
+  TF_RETURN_IF_ERROR(
+      ReadTensor(reader, key + kDeltaValuesSuffix, &delta_values));
+  TF_RETURN_IF_ERROR(
+      ReadTensor(reader, key + kDeltaDeletedKeysSuffix, &deleted_keys));
+  TF_RETURN_IF_ERROR(CheckSameRows(key, base_keys, delta_keys));
+  TF_RETURN_IF_ERROR(CheckSameRows(key, base_keys, deleted_keys));
+  TF_RETURN_IF_ERROR(CheckSameRows(key, base_values, delta_values));
+  if (delta_keys.dim_size(0) != delta_values.dim_size(0)) {
+    return errors::DataLoss("Invalid delta keys of ", key, " in ", prefix);
+  }
+
+  // The source of each row of the merged table, by fingerprint of its key.
+  struct Source {
+    const Tensor* keys;
+    const Tensor* values;
+    int64_t row;
+  };
+  std::vector<Source> sources;
+  absl::flat_hash_map<uint64, int64_t> source_by_key;
+  auto upsert = [&](const Tensor* keys, const Tensor* values, int64_t row) {
+    auto result = source_by_key.emplace(RowFingerprint(*keys, row),
+                                        static_cast<int64_t>(sources.size()));
+    if (result.second) {
+      sources.push_back({keys, values, row});
+    } else {
+      sources[result.first->second] = {keys, values, row};
+    }
+  };
+  for (int64_t i = 0; i < base_keys.dim_size(0); ++i) {
+    upsert(&base_keys, &base_values, i);
+  }
+  for (int64_t i = 0; i < deleted_keys.dim_size(0); ++i) {
+    auto it = source_by_key.find(RowFingerprint(deleted_keys, i));
+    if (it != source_by_key.end()) {
+      sources[it->second].keys = nullptr;
+      source_by_key.erase(it);
+    }
+  }
+  for (int64_t i = 0; i < delta_keys.dim_size(0); ++i) {
+    upsert(&delta_keys, &delta_values, i);
+  }
+
+  TensorShape values_shape = base_values.shape();
+  values_shape.set_dim(0, source_by_key.size());
+  *keys = Tensor(base_keys.dtype(),
+                 TensorShape({static_cast<int64_t>(source_by_key.size())}));
+  *values = Tensor(base_values.dtype(), values_shape);
+  int64_t num_rows = 0;
+  for (const Source& source : sources) {
+    if (source.keys == nullptr) continue;
+    CopyRow(*source.keys, source.row, keys, num_rows);
+    CopyRow(*source.values, source.row, values, num_rows);
+    ++num_rows;
+  }
+  return OkStatus();
+}
+
+}  // namespace tensorflow
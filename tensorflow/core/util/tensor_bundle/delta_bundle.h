@@ -0,0 +1,177 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Delta checkpoints of large row-partitioned tensors on top of tensor bundles.
+//
+// A delta bundle is an ordinary tensor bundle in which a tensor is either
+// stored in full, or as the rows that differ from its value in a base
+// checkpoint, together with the prefix of that checkpoint. The base may itself
+// be a delta bundle, so that a chain of hourly saves only writes what changed
+// since the previous save. Typical usage:
+//
+//   DeltaCheckpointState state;  // Kept across saves.
+//   // Every hour:
+//   DeltaBundleWriter writer(env, prefix, &state);
+//   writer.Add("embedding", embedding_tensor);
+//   writer.AddKeyed("table", table_keys, table_values);
+//   TF_RETURN_IF_ERROR(writer.Finish());
+//
+//   // To restore:
+//   DeltaBundleReader reader(env, prefix);
+//   reader.Lookup("embedding", &embedding_tensor);
+//   reader.LookupKeyed("table", &table_keys, &table_values);
+//
+// Modified rows are detected by comparing the fingerprint of every row with
+// its fingerprint at the previous save, so the tensors need no dirty tracking
+// of their own: a save reads every row from memory, but only writes the rows
+// that changed. All checkpoints of a chain must be kept until a later save
+// writes every tensor in full.
+
+#ifndef TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_DELTA_BUNDLE_H_
+#define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_DELTA_BUNDLE_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+
+// The fingerprints of the tensors written by the last successful save of a
+// delta checkpoint chain, against which the next save is computed.
+//
+// This class is thread-safe.
+class DeltaCheckpointState {
+ public:
+  // After `max_chain_length` consecutive delta saves, the next save writes
+  // every tensor in full, which bounds the number of bundles read by a
+  // restore.
+  explicit DeltaCheckpointState(int max_chain_length = 8);
+
+  // Returns the prefix of the last successful save, or "" if there is none.
+  string base_prefix() const;
+
+  // Forgets the last save, so that the next save writes every tensor in full.
+  void Reset();
+
+ private:
+  friend class DeltaBundleWriter;
+
+  struct TensorState {
+    DataType dtype = DT_INVALID;
+    TensorShape shape;
+    // For dense tensors, the fingerprint of each row.
+    std::vector<uint64> row_fingerprints;
+    // For keyed tensors, the keys, and the row of each key and the
+    // fingerprint of its value, by fingerprint of the key.
+    Tensor keys;
+    absl::flat_hash_map<uint64, std::pair<int64_t, uint64>> keyed_rows;
+  };
+
+  const int max_chain_length_;
+  mutable mutex mu_;
+  string base_prefix_ TF_GUARDED_BY(mu_);
+  int chain_length_ TF_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<string, TensorState> tensors_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DeltaCheckpointState);
+};
+
+// Writes a delta bundle at `prefix` against the last save recorded in
+// `state`, and records this save in `state` once it is finished. Tensors are
+// written in full if there is no base save, if their dtype or shape changed,
+// or if more than half of their rows changed.
+//
+// All threads accessing the same DeltaBundleWriter must synchronize.
+class DeltaBundleWriter {
+ public:
+  DeltaBundleWriter(Env* env, StringPiece prefix, DeltaCheckpointState* state,
+                    const BundleWriter::Options& options =
+                        BundleWriter::Options());
+
+  Status status() const { return writer_.status(); }
+
+  // Adds the tensor "val", whose rows are its slices along the first
+  // dimension, under key "key". Rows are compared by content; string tensors
+  // are supported, variant tensors are always written in full.
+  Status Add(StringPiece key, const Tensor& val);
+
+  // Adds the contents of a hash table, as exported into "keys" of shape [N]
+  // and "values" of shape [N, ...] in any order, under key "key". Only the
+  // inserted, updated and removed keys are written.
+  Status AddKeyed(StringPiece key, const Tensor& keys, const Tensor& values);
+
+  // Finishes the writer, and records this save as the base of the next one.
+  Status Finish() TF_MUST_USE_RESULT;
+
+ private:
+  DeltaCheckpointState* const state_;  // Not owned.
+  const string prefix_;
+  string base_prefix_;
+  BundleWriter writer_;
+  // Tensor states to record in `state_` by Finish().
+  absl::flat_hash_map<string, DeltaCheckpointState::TensorState> new_states_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DeltaBundleWriter);
+};
+
+// Reads the tensors of a delta bundle, merging each with the bundles it is
+// relative to. Plain tensor bundles can be read as well.
+//
+// All threads accessing the same DeltaBundleReader must synchronize.
+class DeltaBundleReader {
+ public:
+  DeltaBundleReader(Env* env, StringPiece prefix);
+
+  // Is ok() iff the bundle at `prefix` could be opened.
+  Status status() const { return status_; }
+
+  // Looks up the tensor added with DeltaBundleWriter::Add() under "key".
+  // Unlike BundleReader::Lookup(), allocates "val".
+  Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
+
+  // Looks up the keys and values added with DeltaBundleWriter::AddKeyed()
+  // under "key".
+  Status LookupKeyed(StringPiece key, Tensor* keys,
+                     Tensor* values) TF_MUST_USE_RESULT;
+
+ private:
+  // Returns the (cached) reader of the bundle at `prefix`.
+  Status GetReader(const string& prefix, BundleReader** reader);
+  Status LookupIn(const string& prefix, const string& key, int depth,
+                  Tensor* val);
+  Status LookupKeyedIn(const string& prefix, const string& key, int depth,
+                       Tensor* keys, Tensor* values);
+
+  Env* const env_;  // Not owned.
+  const string prefix_;
+  Status status_;
+  absl::flat_hash_map<string, std::unique_ptr<BundleReader>> readers_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DeltaBundleReader);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_DELTA_BUNDLE_H_
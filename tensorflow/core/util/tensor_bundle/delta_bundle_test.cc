@@ -0,0 +1,199 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/util/tensor_bundle/delta_bundle.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace {
+
+string Prefix(const string& prefix) {
+  return strings::StrCat(testing::TmpDir(), "/", prefix);
+}
+
+Tensor Embedding(float offset) {
+  Tensor t(DT_FLOAT, TensorShape({10, 4}));
+  auto matrix = t.matrix<float>();
+  for (int i = 0; i < 10; ++i) {
+    for (int j = 0; j < 4; ++j) matrix(i, j) = offset + i * 4 + j;
+  }
+  return t;
+}
+
+Status Save(DeltaCheckpointState* state, const string& prefix,
+            const Tensor& embedding) {
+  DeltaBundleWriter writer(Env::Default(), prefix, state);
+  TF_RETURN_IF_ERROR(writer.status());
+  TF_RETURN_IF_ERROR(writer.Add("embedding", embedding));
+  TF_RETURN_IF_ERROR(writer.Add("step", test::AsScalar<int64_t>(1)));
+  return writer.Finish();
+}
+
+// Returns the number of rows stored by the bundle at `prefix` as a delta of
+// "embedding", or -1 if it is stored in full.
+int64_t NumDeltaRows(const string& prefix) {
+  BundleReader reader(Env::Default(), prefix);
+  TF_CHECK_OK(reader.status());
+  if (reader.Contains("embedding")) return -1;
+  TensorShape shape;
+  TF_CHECK_OK(reader.LookupTensorShape("embedding/.delta_rows", &shape));
+  return shape.dim_size(0);
+}
+
+void ExpectEmbedding(const string& prefix, const Tensor& expected) {
+  DeltaBundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("embedding", &val));
+  test::ExpectTensorEqual<float>(val, expected);
+  TF_ASSERT_OK(reader.Lookup("step", &val));
+  test::ExpectTensorEqual<int64_t>(val, test::AsScalar<int64_t>(1));
+}
+
+TEST(DeltaBundleTest, WritesChangedRows) {
+  DeltaCheckpointState state;
+  Tensor embedding = Embedding(0);
+  TF_ASSERT_OK(Save(&state, Prefix("dense-0"), embedding));
+  EXPECT_EQ(NumDeltaRows(Prefix("dense-0")), -1);
+  EXPECT_EQ(state.base_prefix(), Prefix("dense-0"));
+
+  embedding.matrix<float>()(3, 1) = -1;
+  embedding.matrix<float>()(7, 0) = -2;
+  TF_ASSERT_OK(Save(&state, Prefix("dense-1"), embedding));
+  EXPECT_EQ(NumDeltaRows(Prefix("dense-1")), 2);
+  ExpectEmbedding(Prefix("dense-1"), embedding);
+  const Tensor dense_1 = tensor::DeepCopy(embedding);
+
+  // Unchanged rows are read through the chain of bases.
+  embedding.matrix<float>()(3, 2) = -3;
+  TF_ASSERT_OK(Save(&state, Prefix("dense-2"), embedding));
+  EXPECT_EQ(NumDeltaRows(Prefix("dense-2")), 1);
+  ExpectEmbedding(Prefix("dense-2"), embedding);
+  ExpectEmbedding(Prefix("dense-1"), dense_1);
+
+  // Most rows changed.
+  const Tensor other = Embedding(100);
+  TF_ASSERT_OK(Save(&state, Prefix("dense-3"), other));
+  EXPECT_EQ(NumDeltaRows(Prefix("dense-3")), -1);
+  ExpectEmbedding(Prefix("dense-3"), other);
+}
+
+TEST(DeltaBundleTest, BoundsChainLength) {
+  DeltaCheckpointState state(/*max_chain_length=*/1);
+  Tensor embedding = Embedding(0);
+  TF_ASSERT_OK(Save(&state, Prefix("chain-0"), embedding));
+  TF_ASSERT_OK(Save(&state, Prefix("chain-1"), embedding));
+  EXPECT_EQ(NumDeltaRows(Prefix("chain-1")), 0);
+  TF_ASSERT_OK(Save(&state, Prefix("chain-2"), embedding));
+  EXPECT_EQ(NumDeltaRows(Prefix("chain-2")), -1);
+
+  state.Reset();
+  TF_ASSERT_OK(Save(&state, Prefix("chain-3"), embedding));
+  EXPECT_EQ(NumDeltaRows(Prefix("chain-3")), -1);
+}
+
+TEST(DeltaBundleTest, ReshapedTensorIsWrittenInFull) {
+  DeltaCheckpointState state;
+  TF_ASSERT_OK(Save(&state, Prefix("reshape-0"), Embedding(0)));
+  Tensor reshaped(DT_FLOAT, TensorShape({20, 2}));
+  ASSERT_TRUE(reshaped.CopyFrom(Embedding(0), TensorShape({20, 2})));
+  TF_ASSERT_OK(Save(&state, Prefix("reshape-1"), reshaped));
+  EXPECT_EQ(NumDeltaRows(Prefix("reshape-1")), -1);
+  ExpectEmbedding(Prefix("reshape-1"), reshaped);
+}
+
+std::map<int64_t, std::vector<tstring>> ToMap(const Tensor& keys,
+                                              const Tensor& values) {
+  std::map<int64_t, std::vector<tstring>> result;
+  for (int i = 0; i < keys.dim_size(0); ++i) {
+    result[keys.vec<int64_t>()(i)] = {values.matrix<tstring>()(i, 0),
+                                      values.matrix<tstring>()(i, 1)};
+  }
+  return result;
+}
+
+TEST(DeltaBundleTest, KeyedTensors) {
+  DeltaCheckpointState state;
+  Tensor keys = test::AsTensor<int64_t>({1, 2, 3, 4, 5, 6});
+  Tensor values = test::AsTensor<tstring>(
+      {"a", "A", "b", "B", "c", "C", "d", "D", "e", "E", "f", "F"},
+      TensorShape({6, 2}));
+  {
+    DeltaBundleWriter writer(Env::Default(), Prefix("keyed-0"), &state);
+    TF_ASSERT_OK(writer.AddKeyed("table", keys, values));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  // Updates 2, removes 3, adds 7, in a different order.
+  Tensor new_keys = test::AsTensor<int64_t>({7, 6, 5, 4, 2, 1});
+  Tensor new_values = test::AsTensor<tstring>(
+      {"g", "G", "f", "F", "e", "E", "d", "D", "x", "X", "a", "A"},
+      TensorShape({6, 2}));
+  {
+    DeltaBundleWriter writer(Env::Default(), Prefix("keyed-1"), &state);
+    TF_ASSERT_OK(writer.AddKeyed("table", new_keys, new_values));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleReader reader(Env::Default(), Prefix("keyed-1"));
+    TF_ASSERT_OK(reader.status());
+    TensorShape shape;
+    TF_ASSERT_OK(reader.LookupTensorShape("table/.delta_keys", &shape));
+    EXPECT_EQ(shape.dim_size(0), 2);
+    TF_ASSERT_OK(
+        reader.LookupTensorShape("table/.delta_deleted_keys", &shape));
+    EXPECT_EQ(shape.dim_size(0), 1);
+  }
+
+  DeltaBundleReader reader(Env::Default(), Prefix("keyed-1"));
+  TF_ASSERT_OK(reader.status());
+  Tensor restored_keys, restored_values;
+  TF_ASSERT_OK(reader.LookupKeyed("table", &restored_keys, &restored_values));
+  EXPECT_EQ(ToMap(restored_keys, restored_values),
+            ToMap(new_keys, new_values));
+}
+
+TEST(DeltaBundleTest, Errors) {
+  DeltaCheckpointState state;
+  DeltaBundleWriter writer(Env::Default(), Prefix("errors"), &state);
+  TF_ASSERT_OK(writer.Add("embedding", Embedding(0)));
+  EXPECT_TRUE(errors::IsInvalidArgument(writer.Add("embedding", Embedding(0))));
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      writer.AddKeyed("table", test::AsTensor<int64_t>({1, 1}),
+                      test::AsTensor<float>({1, 2}))));
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      writer.AddKeyed("table", test::AsTensor<int64_t>({1, 2}),
+                      test::AsTensor<float>({1}))));
+  TF_ASSERT_OK(writer.Finish());
+
+  DeltaBundleReader reader(Env::Default(), Prefix("errors"));
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  EXPECT_TRUE(errors::IsNotFound(reader.Lookup("missing", &val)));
+  DeltaBundleReader missing(Env::Default(), Prefix("missing"));
+  EXPECT_FALSE(missing.status().ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
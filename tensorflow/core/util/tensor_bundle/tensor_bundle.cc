@@ -19,8 +19,11 @@ limitations under the License.
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <numeric>
 #include <utility>
+#include <vector>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -72,11 +75,11 @@ static const int kBufferSize = 1024 * 1024;
 const char* const kHeaderEntryKey = "";
 
 // The size threshold for multi-threaded tensor loading.
-const int64_t kLargeTensorThreshold = static_cast<int64_t>(1) << 32;
+const int64_t kLargeTensorThreshold = static_cast<int64_t>(1) << 30;
 // Maximum number of threads to load the tensor from the file.
 const int kMaxFileReadThreads = 8;
 // Minimum size of a file section handled by each thread.
-const int64_t kMinSectionSize = static_cast<int64_t>(1) << 31;
+const int64_t kMinSectionSize = static_cast<int64_t>(1) << 28;
 
 namespace {
 
@@ -420,6 +423,55 @@ Status PadAlignment(tsl::BufferedWritableFile* out, int alignment,
   return status;
 }
 
+// Appends the contents of "val" to "out", whose current size is "*size", and
+// records their offset, size and checksum in "entry". Pads the file to
+// "alignment" afterwards.
+Status AppendTensor(const Tensor& val, int alignment,
+                    tsl::BufferedWritableFile* out, int64_t* size,
+                    BundleEntryProto* entry) {
+  entry->set_offset(*size);
+  size_t data_bytes_written = 0;
+  uint32 crc32c = 0;
+  out->reset_crc32();
+  Status status;
+  if (val.dtype() == DT_STRING) {
+    status = WriteStringTensor(val, out, &data_bytes_written, &crc32c);
+  } else if (val.dtype() == DT_VARIANT) {
+    status = WriteVariantTensor(val, out, &data_bytes_written, &crc32c);
+  } else {
+    status = WriteTensor(val, out, &data_bytes_written);
+    crc32c = out->crc32();
+  }
+  if (!status.ok()) return status;
+  entry->set_size(data_bytes_written);
+  entry->set_crc32c(crc32c::Mask(crc32c));
+  *size += data_bytes_written;
+  return PadAlignment(out, alignment, size);
+}
+
+// A TensorBuffer whose data is part of a memory-mapped data file. The buffer
+// keeps the mapping alive.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("mapped_tensor_bundle");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
@@ -439,6 +491,11 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
   if (!status_.ok() && !errors::IsAlreadyExists(status_)) {
     return;
   }
+  // The data files are only created by Finish(), once their number is known.
+  if (options_.num_data_files > 1) {
+    status_ = OkStatus();
+    return;
+  }
 
   std::unique_ptr<WritableFile> wrapper;
   status_ = env_->NewWritableFile(data_path_, &wrapper);
@@ -462,27 +519,14 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   entry->set_dtype(val.dtype());
   val.shape().AsProto(entry->mutable_shape());
   entry->set_shard_id(0);
-  entry->set_offset(size_);
-
-  // Updates the data file.
-  size_t data_bytes_written = 0;
-  uint32 crc32c = 0;
-  out_->reset_crc32();
-  if (val.dtype() == DT_STRING) {
-    status_ = WriteStringTensor(val, out_.get(), &data_bytes_written, &crc32c);
-  } else if (val.dtype() == DT_VARIANT) {
-    status_ = WriteVariantTensor(val, out_.get(), &data_bytes_written, &crc32c);
-  } else {
-    status_ = WriteTensor(val, out_.get(), &data_bytes_written);
-    crc32c = out_->crc32();
+  if (options_.num_data_files > 1) {
+    pending_.push_back({entry, val});
+    return status_;
   }
 
-  if (status_.ok()) {
-    entry->set_size(data_bytes_written);
-    entry->set_crc32c(crc32c::Mask(crc32c));
-    size_ += data_bytes_written;
-    status_ = PadAlignment(out_.get(), options_.data_alignment, &size_);
-  }
+  // Updates the data file.
+  status_ =
+      AppendTensor(val, options_.data_alignment, out_.get(), &size_, entry);
   return status_;
 }
 
@@ -527,9 +571,82 @@ Status BundleWriter::AddSlice(StringPiece full_tensor_key,
   return status_;
 }
 
+Status BundleWriter::WritePendingTensors() {
+  // Assigns the largest tensors first, each to the data file with the fewest
+  // bytes so far. Using no more files than tensors keeps every file non-empty.
+  const int num_files = std::max<int64_t>(
+      1, std::min<int64_t>(options_.num_data_files, pending_.size()));
+  std::vector<int> order(pending_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+    return pending_[a].val.TotalBytes() > pending_[b].val.TotalBytes();
+  });
+  std::vector<std::vector<int>> assigned(num_files);
+  std::vector<std::pair<int64_t, int>> load(num_files);  // (bytes, tensors)
+  for (int i : order) {
+    const int file =
+        std::min_element(load.begin(), load.end()) - load.begin();
+    assigned[file].push_back(i);
+    load[file].first += pending_[i].val.TotalBytes();
+    ++load[file].second;
+  }
+
+  std::vector<string> paths(num_files);
+  std::vector<Status> statuses(num_files);
+  {
+    thread::ThreadPool pool(env_, "save_data_files", num_files);
+    for (int file = 0; file < num_files; ++file) {
+      // Within a file, the tensors are written in the order they were added.
+      std::sort(assigned[file].begin(), assigned[file].end());
+      paths[file] = DataFilename(prefix_, file, num_files);
+      if (use_temp_file_) {
+        paths[file] =
+            strings::StrCat(paths[file], ".tempstate", random::New64());
+      }
+      pool.Schedule([this, file, &assigned, &paths, &statuses]() {
+        std::unique_ptr<WritableFile> wrapper;
+        Status s = env_->NewWritableFile(paths[file], &wrapper);
+        if (!s.ok()) {
+          statuses[file] = s;
+          return;
+        }
+        tsl::BufferedWritableFile out(std::move(wrapper),
+                                      8 << 20 /* 8MB write buffer */);
+        int64_t size = 0;
+        for (int i : assigned[file]) {
+          PendingTensor& pending = pending_[i];
+          pending.entry->set_shard_id(file);
+          s = AppendTensor(pending.val, options_.data_alignment, &out, &size,
+                           pending.entry);
+          if (!s.ok()) break;
+        }
+        s.Update(out.Close());
+        statuses[file] = s;
+      });
+    }
+  }
+  pending_.clear();
+
+  Status status;
+  for (const Status& s : statuses) status.Update(s);
+  for (int file = 0; file < num_files; ++file) {
+    if (!status.ok()) {
+      env_->DeleteFile(paths[file]).IgnoreError();
+    } else if (use_temp_file_) {
+      status.Update(env_->RenameFile(paths[file],
+                                     DataFilename(prefix_, file, num_files)));
+    }
+  }
+  num_shards_ = num_files;
+  return status;
+}
+
 // TODO(zongheng): on metadata write failure or !status_.ok(), consider removing
 // the orphaned data file.
 Status BundleWriter::Finish() {
+  if (status_.ok() && options_.num_data_files > 1) {
+    status_ = WritePendingTensors();
+  }
   if (out_) {
     status_.Update(out_->Close());
     out_ = nullptr;
@@ -555,7 +672,7 @@ Status BundleWriter::Finish() {
     table::TableBuilder builder(options, file.get());
     // Header entry.
     BundleHeaderProto header;
-    header.set_num_shards(1);
+    header.set_num_shards(num_shards_);
     header.set_endianness(BundleHeaderProto::LITTLE);
     if (!port::kLittleEndian) header.set_endianness(BundleHeaderProto::BIG);
     VersionDef* version = header.mutable_version();
@@ -933,35 +1050,43 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
           section_size =
               (entry.size() + kMaxFileReadThreads - 1) / kMaxFileReadThreads;
         }
+        // Sections start at file offsets that are multiples of kBufferSize,
+        // so that the reads are aligned to the underlying storage blocks.
+        std::vector<int64_t> section_starts(thread_pool_size + 1);
+        section_starts[0] = entry.offset();
+        for (int i = 1; i < thread_pool_size; ++i) {
+          const int64_t start = entry.offset() + i * section_size;
+          section_starts[i] =
+              std::min<int64_t>(entry.offset() + entry.size(),
+                                (start + kBufferSize - 1) / kBufferSize *
+                                    kBufferSize);
+        }
+        section_starts[thread_pool_size] = entry.offset() + entry.size();
 
+        // RandomAccessFile::Read is safe for concurrent use, so all sections
+        // are read through the already open data file.
+        RandomAccessFile* file = buffered_file->file();
         std::vector<Status> statuses(thread_pool_size);
         auto reader_pool = std::make_unique<thread::ThreadPool>(
             Env::Default(), "restore_large_tensor", thread_pool_size);
 
         for (int i = 0; i < thread_pool_size; ++i) {
           reader_pool->Schedule([&, i]() {
-            int64_t offset = i * section_size;
-            int64_t size = i == thread_pool_size - 1 ? entry.size() - offset
-                                                     : section_size;
-            std::unique_ptr<RandomAccessFile> section_reader = nullptr;
+            const int64_t offset = section_starts[i] - entry.offset();
+            const int64_t size = section_starts[i + 1] - section_starts[i];
+            if (size == 0) return;
             StringPiece sp;
-            if (auto file_status = env_->NewRandomAccessFile(
-                    DataFilename(prefix_, entry.shard_id(), num_shards_),
-                    &section_reader);
-                !file_status.ok()) {
-              statuses[i] = file_status;
-              return;
-            }
-
             auto backing_buffer_current_pos = backing_buffer + offset;
-            auto status = section_reader->Read(entry.offset() + offset, size,
-                                               &sp, backing_buffer_current_pos);
+            auto status = file->Read(section_starts[i], size, &sp,
+                                     backing_buffer_current_pos);
             if (sp.data() != backing_buffer_current_pos) {
               memmove(backing_buffer_current_pos, sp.data(), size);
             }
             statuses[i] = std::move(status);
           });
         }
+        // Waits for the reads to finish.
+        reader_pool.reset();
         for (const auto& status : statuses) {
           TF_RETURN_IF_ERROR(status);
         }
@@ -1022,6 +1147,73 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+Status BundleReader::GetMappedDataFile(
+    int32_t shard_id, std::shared_ptr<ReadOnlyMemoryRegion>* region) {
+  auto it = mapped_data_.find(shard_id);
+  if (it == mapped_data_.end()) {
+    std::unique_ptr<ReadOnlyMemoryRegion> new_region;
+    Status s = env_->NewReadOnlyMemoryRegionFromFile(
+        DataFilename(prefix_, shard_id, num_shards_), &new_region);
+    if (!s.ok() && !errors::IsUnimplemented(s)) return s;
+    it = mapped_data_.emplace(shard_id, std::move(new_region)).first;
+  }
+  *region = it->second;
+  return OkStatus();
+}
+
+Status BundleReader::LookupReadOnly(StringPiece key, Tensor* val,
+                                    bool* mapped) {
+  CHECK(val != nullptr);
+  if (mapped != nullptr) *mapped = false;
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  const TensorShape shape(entry.shape());
+  std::shared_ptr<ReadOnlyMemoryRegion> region;
+  if (entry.slices().empty() && DataTypeCanUseMemcpy(entry.dtype()) &&
+      !need_to_swap_bytes_) {
+    TF_RETURN_IF_ERROR(GetMappedDataFile(entry.shard_id(), &region));
+  }
+  if (region != nullptr && shape.num_elements() > 0) {
+    const size_t size = shape.num_elements() * DataTypeSize(entry.dtype());
+    if (entry.size() != size) {
+      return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                              "; stored size ", entry.size(),
+                              "; expected size ", size);
+    }
+    if (entry.offset() > region->length() ||
+        region->length() - entry.offset() < size) {
+      return errors::DataLoss("Bundle entry ", key, " at offset ",
+                              entry.offset(), " exceeds data file shard ",
+                              entry.shard_id(), " of ", region->length(),
+                              " bytes");
+    }
+    const char* data =
+        static_cast<const char*>(region->data()) + entry.offset();
+    core::RefCountPtr<TensorBuffer> buffer(
+        new MappedTensorBuffer(region, data, size));
+    Tensor tensor(entry.dtype(), shape, std::move(buffer));
+    if (tensor.IsAligned()) {
+      const uint32 actual_crc32c = crc32c::Value(data, size);
+      if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+        return errors::DataLoss(
+            "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+            entry.size(), " bytes): Checksum does not match: stored ",
+            strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+            " vs. calculated on the mapped bytes ", actual_crc32c);
+      }
+      *val = std::move(tensor);
+      if (mapped != nullptr) *mapped = true;
+      return OkStatus();
+    }
+  }
+  *val = Tensor(entry.dtype(), shape);
+  if (entry.slices().empty()) {
+    return GetValue(entry, val);
+  }
+  return GetSliceValue(key, entry,
+                       /* a full slice */ TensorSlice(shape.dims()), val);
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -39,7 +39,8 @@ limitations under the License.
 //   reader.Lookup("name", &tensor);
 //
 // A tensor bundle can be built using BundleWriter.  Each BundleWriter builds a
-// single data file bundle.  Multiple bundles can then be merged by
+// bundle with a single data file, or with a few data files written in parallel
+// (see BundleWriter::Options::num_data_files).  Multiple bundles can then be merged by
 // MergeBundles() without reading and writing large chunk of data: it reads the
 // metadata files and outputs a single merged metadata.  Typical usage:
 //
@@ -65,6 +66,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
@@ -114,8 +116,15 @@ class BundleWriter {
   struct Options {
     Options() {}
     // Alignment, in bytes, for tensor data.
-    // Must be >= 1. The default size of 1 densely packs tensors.
+    // Must be >= 1. The default size of 1 densely packs tensors. A multiple of
+    // EIGEN_MAX_ALIGN_BYTES lets BundleReader::LookupReadOnly() map tensors
+    // instead of copying them.
     int data_alignment{1};
+    // Maximum number of data files that the tensors are spread over. If
+    // greater than 1, Add() only records the tensors, and Finish() writes
+    // them to up to this many data files in parallel, balancing their sizes.
+    // The added tensors are then referenced until Finish() returns.
+    int num_data_files{1};
   };
   BundleWriter(Env* env, StringPiece prefix,
                const Options& options = Options());
@@ -150,6 +159,16 @@ class BundleWriter {
   Status status() const { return status_; }
 
  private:
+  // A tensor added with `options_.num_data_files` > 1, to be written by
+  // Finish().
+  struct PendingTensor {
+    BundleEntryProto* entry;  // Points into `entries_`.
+    Tensor val;
+  };
+
+  // Writes `pending_` to data files in parallel.
+  Status WritePendingTensors();
+
   Env* const env_;  // Not owned.
   const Options options_;
   const string prefix_;
@@ -159,6 +178,9 @@ class BundleWriter {
   std::unique_ptr<tsl::BufferedWritableFile> out_;
   int64_t size_;  // Number of bytes written into out_.
   std::map<string, BundleEntryProto> entries_;
+  std::vector<PendingTensor> pending_;
+  // Number of data files written by Finish().
+  int num_shards_ = 1;
   Status status_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(BundleWriter);
@@ -246,6 +268,20 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Like "Lookup()", but sets "val" to a tensor of the stored dtype and shape
+  // whose buffer aliases a read-only memory mapping of the data file instead
+  // of a copy, which lets processes that load the same bundle share its pages.
+  // Mapping requires a file system that supports read-only memory regions, a
+  // fixed-size dtype in this machine's byte order, an unpartitioned tensor,
+  // and tensor data aligned for Eigen (see BundleWriter::Options); other
+  // tensors are copied as by "Lookup()". "*mapped", if not null, is set to
+  // whether "val" aliases the mapping. Such a tensor must never be modified.
+  //
+  // Validates the stored crc32c checksum against the restored bytes.
+  // REQUIRES: status().ok()
+  Status LookupReadOnly(StringPiece key, Tensor* val,
+                        bool* mapped = nullptr) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -302,6 +338,11 @@ class BundleReader {
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Returns the memory mapping of data file "shard_id" in "*region", or
+  // nullptr if the file system cannot map it.
+  Status GetMappedDataFile(int32_t shard_id,
+                           std::shared_ptr<ReadOnlyMemoryRegion>* region);
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -320,6 +361,9 @@ class BundleReader {
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
+  // Memory mappings of the data files, created by "LookupReadOnly()".
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -1148,6 +1148,67 @@ TEST(TensorBundleTest, LargeVariableLoadingTest) {
   }
 }
 
+TEST(TensorBundleTest, MultipleDataFiles) {
+  Env* env = Env::Default();
+  Tensor strs(DT_STRING, TensorShape({3}));
+  strs.flat<tstring>()(0) = "foo";
+  strs.flat<tstring>()(1) = "";
+  strs.flat<tstring>()(2) = string(100, 'x');
+  // Larger than the read buffer, so that it is read in parallel sections.
+  const Tensor large = Constant<float>(5, TensorShape({600, 600}));
+  {
+    BundleWriter::Options options;
+    options.num_data_files = 3;
+    options.data_alignment = 8;
+    BundleWriter writer(env, Prefix("multi"), options);
+    TF_ASSERT_OK(writer.status());
+    TF_EXPECT_OK(writer.Add("large", large));
+    TF_EXPECT_OK(writer.Add("small_0", Constant_2x3<float>(0)));
+    TF_EXPECT_OK(writer.Add("small_1", Constant_2x3<int32>(1)));
+    TF_EXPECT_OK(writer.Add("strs", strs));
+    TF_EXPECT_OK(writer.Add("medium", Constant_100x100<double>(2)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  const string dir(io::Dirname(Prefix("multi")));
+  for (const char* file :
+       {"multi.index", "multi.data-00000-of-00003", "multi.data-00001-of-00003",
+        "multi.data-00002-of-00003"}) {
+    TF_EXPECT_OK(env->FileExists(io::JoinPath(dir, file)));
+  }
+  {
+    BundleReader reader(env, Prefix("multi"),
+                        /* enable_multi_threading_for_testing = */ true);
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "large", large);
+    Expect<float>(&reader, "small_0", Constant_2x3<float>(0));
+    Expect<int32>(&reader, "small_1", Constant_2x3<int32>(1));
+    Expect<tstring>(&reader, "strs", strs);
+    Expect<double>(&reader, "medium", Constant_100x100<double>(2));
+  }
+
+  // Fewer tensors than data files.
+  {
+    BundleWriter::Options options;
+    options.num_data_files = 4;
+    BundleWriter writer(env, Prefix("single"), options);
+    TF_EXPECT_OK(writer.Add("single", Constant_2x3<float>(7)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_EXPECT_OK(
+      env->FileExists(io::JoinPath(dir, "single.data-00000-of-00001")));
+
+  // Multi-file bundles can be merged like any other bundle.
+  TF_ASSERT_OK(
+      MergeBundles(env, {Prefix("multi"), Prefix("single")}, Prefix("all")));
+  {
+    BundleReader reader(env, Prefix("all"));
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "large", large);
+    Expect<tstring>(&reader, "strs", strs);
+    Expect<float>(&reader, "single", Constant_2x3<float>(7));
+  }
+}
+
 class TensorBundleAlignmentTest : public ::testing::Test {
  protected:
   template <typename T>
@@ -1201,6 +1262,31 @@ TEST_F(TensorBundleAlignmentTest, AlignmentTest) {
   }
 }
 
+TEST_F(TensorBundleAlignmentTest, LookupReadOnly) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = 64;
+    BundleWriter writer(Env::Default(), Prefix("foo"), opts);
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_2x3<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<tstring>("1")));
+    TF_EXPECT_OK(writer.Add("foo_002", Constant_2x3<int32>(2)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("foo"));
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  bool mapped = false;
+  TF_ASSERT_OK(reader.LookupReadOnly("foo_000", &val, &mapped));
+  EXPECT_TRUE(mapped);
+  test::ExpectTensorEqual<float>(val, Constant_2x3<float>(0));
+  TF_ASSERT_OK(reader.LookupReadOnly("foo_001", &val, &mapped));
+  EXPECT_FALSE(mapped);
+  test::ExpectTensorEqual<tstring>(val, Constant_2x3<tstring>("1"));
+  TF_ASSERT_OK(reader.LookupReadOnly("foo_002", &val, &mapped));
+  EXPECT_TRUE(mapped);
+  test::ExpectTensorEqual<int32>(val, Constant_2x3<int32>(2));
+}
+
 static void BM_BundleAlignment(::testing::benchmark::State& state) {
   {
     const int alignment = state.range(0);
@@ -371,8 +371,14 @@ class DTensorDevice {
       int num_outputs, DTensorOperationLoweringContext& lowering_context,
       const ExecutionFunctions** execution_functions, TF_Status* status);
 
-  // Execute a given function.
-  void ExecuteFunctionAndWait(
+  // Executes a given function on its mesh and waits for the outputs of that
+  // function only. Computations still running on other meshes are not waited
+  // for, so that the host mesh can prepare the next step while the device
+  // meshes finish the previous one. Their failures are reported at the next
+  // sync point, `AsyncWait`, e.g. when a tensor is copied off the device. If
+  // this function fails, all meshes are waited for before returning, to flush
+  // the cancellations caused by the failure.
+  void ExecuteFunctionAndJoin(
       TFE_Context* context, const TranslatedFunction* function_ptr,
       const MeshWithParallelDevice* parallel_device_mesh,
       const std::vector<parallel_device::ParallelTensor*>& parallel_inputs,
@@ -1666,7 +1672,7 @@ void DTensorDevice::ModuleToExecutionFunctions(
       .IgnoreError();
 }
 
-void DTensorDevice::ExecuteFunctionAndWait(
+void DTensorDevice::ExecuteFunctionAndJoin(
     TFE_Context* context, const TranslatedFunction* function_ptr,
     const MeshWithParallelDevice* parallel_device_mesh,
     const std::vector<parallel_device::ParallelTensor*>& parallel_inputs,
@@ -1686,7 +1692,9 @@ void DTensorDevice::ExecuteFunctionAndWait(
   parallel_device_mesh->parallel_device().Join(
       function_ptr->local_output_shapes, status);
   VLOG(4) << "Joining status: " << TF_Message(status);
-  if (TF_GetCode(status) != TF_OK && TF_GetCode(status) != TF_CANCELLED) {
+  // Unlike `AsyncWait`, a successful Join does not sync the other meshes.
+  if (TF_GetCode(status) == TF_OK) return;
+  if (TF_GetCode(status) != TF_CANCELLED) {
     LOG(ERROR) << "Encountered error while executing function: "
                << function_ptr->translated_function_name
                << " for mesh : " << mesh_str
@@ -1845,7 +1853,7 @@ void DTensorDevice::ExecuteRegularOperation(
 
   // Execute excluded functions in sequence.
   if (epu_fn_ptr != nullptr) {
-    ExecuteFunctionAndWait(
+    ExecuteFunctionAndJoin(
         context,
         /*function_ptr=*/epu_fn_ptr.get(),
         /*parallel_device_mesh=*/
@@ -1861,7 +1869,7 @@ void DTensorDevice::ExecuteRegularOperation(
       RETURN_STATUS(status, TF_INTERNAL,
                     parallel_inputs.status().error_message().c_str());
     }
-    ExecuteFunctionAndWait(
+    ExecuteFunctionAndJoin(
         context,
         /*function_ptr=*/load_embedding_ptr.get(),
         /*parallel_device_mesh=*/
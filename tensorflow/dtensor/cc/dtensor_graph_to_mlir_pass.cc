@@ -16,8 +16,11 @@ limitations under the License.
 #include "tensorflow/dtensor/cc/dtensor_graph_to_mlir_pass.h"
 
 #include <memory>
+#include <optional>
+#include <string>
 #include <utility>
 
+#include "absl/strings/str_cat.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
 #include "mlir/IR/Builders.h"  // from @llvm-project
 #include "mlir/IR/BuiltinAttributes.h"  // from @llvm-project
@@ -45,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/dtensor/cc/constants.h"
 #include "tensorflow/dtensor/cc/dtensor_utils.h"
+#include "tensorflow/dtensor/cc/expansion_cache.h"
 #include "tensorflow/dtensor/mlir/dtensor_dialect/ir/dialect.h"
 #include "tensorflow/dtensor/mlir/dtensor_mlir_passes.h"
 #include "tensorflow/dtensor/mlir/ir/tf_dtensor.h"
@@ -68,6 +72,12 @@ DTensorMlirPassRunner::DTensorMlirPassRunner()
   // Creates a pipeline that include each DTensor related passes.
   mlir::TF::StandardPipelineOptions pipeline_options;
   dtensor::CreateDTensorMLIRPass(pipeline_options, &pass_manager_);
+
+  // Modules read back from the expansion cache may use any dialect the
+  // pipeline produces, before the pipeline ever ran in this process.
+  mlir::DialectRegistry registry;
+  pass_manager_.getDependentDialects(registry);
+  context_.appendDialectRegistry(registry);
 }
 
 StatusOr<mlir::OwningOpRef<mlir::ModuleOp>>
@@ -117,6 +127,15 @@ DTensorMlirPassRunner::ImportGraphToMlir(
 }
 
 Status DTensorMlirPassRunner::Run(mlir::ModuleOp module) {
+  std::optional<dtensor::ExpansionCache> cache;
+  std::string cache_path;
+  const std::string cache_dir = dtensor::ExpansionCacheDir();
+  if (!cache_dir.empty()) {
+    cache.emplace(cache_dir);
+    cache_path = cache->EntryPath(module);
+    if (cache->Load(cache_path, module)) return OkStatus();
+  }
+
   // Executes and collects results from the passes.
   mlir::StatusScopedDiagnosticHandler diag_handler(&context_);
 
@@ -127,6 +146,7 @@ Status DTensorMlirPassRunner::Run(mlir::ModuleOp module) {
   TF_RETURN_IF_ERROR(diag_handler.ConsumeStatus());
 
   if (logging_enabled_) pass_manager_.getContext()->enableMultithreading();
+  if (cache.has_value()) cache->Save(cache_path, module);
   return OkStatus();
 }
 
@@ -41,6 +41,10 @@ class DTensorMlirPassRunner {
       Fprint128 cache_key);
 
   // Transforms input MLIR module with DTensor Pass pipeline.
+  //
+  // If DTENSOR_EXPANSION_CACHE_DIR is set, the transformed module is also
+  // written to that directory, and later runs of the same module, including
+  // runs in other processes, read it back instead of running the pipeline.
   Status Run(mlir::ModuleOp module);
 
  private:
@@ -15,15 +15,39 @@ limitations under the License.
 
 #include "tensorflow/dtensor/cc/dtensor_utils.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <string>
+#include <vector>
 
 #include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/platform/logging.h"
 
+#if defined(__APPLE__)
+#include <crt_externs.h>
+#elif !defined(_WIN32)
+extern char** environ;
+#endif
+
 namespace tensorflow {
 namespace dtensor {
+namespace {
+
+char** Environment() {
+#if defined(__APPLE__)
+  return *_NSGetEnviron();
+#elif defined(_WIN32)
+  return _environ;
+#else
+  return environ;
+#endif
+}
+
+}  // namespace
 
 // LINT.IfChange
 int ClientId() {
@@ -127,5 +151,42 @@ bool EnableReplicatedSpmdAsDefault(const std::string& op_name) {
   return dtensor_enable_replicated_spmd_as_default != nullptr;
 }
 
+std::string ExpansionCacheDir() {
+  // The lowered modules are keyed on the module before lowering, the
+  // TensorFlow version and PassPipelineFlags().
+  char* dtensor_expansion_cache_dir_str =
+      std::getenv("DTENSOR_EXPANSION_CACHE_DIR");
+  if (dtensor_expansion_cache_dir_str == nullptr) return "";
+  return dtensor_expansion_cache_dir_str;
+}
+
+std::string PassPipelineFlags() {
+  // Every DTENSOR_* variable is included, since the passes read some of them
+  // under names built at runtime (see EnableReplicatedSpmdAsDefault). Only
+  // variables that cannot change the lowered module are left out, so that
+  // the clients of a job share cache entries.
+  constexpr absl::string_view kIgnoredFlags[] = {
+      "DTENSOR_CLIENT_ID",
+      "DTENSOR_EXPANSION_CACHE_DIR",
+      "DTENSOR_LOG_ON_ALL_TASKS",
+  };
+  std::vector<std::string> flags;
+  for (char** env = Environment(); env != nullptr && *env != nullptr; ++env) {
+    const absl::string_view flag = *env;
+    const absl::string_view name = flag.substr(0, flag.find('='));
+    if (!absl::StartsWith(name, "DTENSOR_") &&
+        !absl::StartsWith(name, "LOWER_DTENSOR_")) {
+      continue;
+    }
+    if (std::find(std::begin(kIgnoredFlags), std::end(kIgnoredFlags), name) !=
+        std::end(kIgnoredFlags)) {
+      continue;
+    }
+    flags.emplace_back(flag);
+  }
+  std::sort(flags.begin(), flags.end());
+  return absl::StrJoin(flags, "\n");
+}
+
 }  // namespace dtensor
 }  // namespace tensorflow
@@ -60,6 +60,14 @@ bool LowerCollectiveGatherToCollectiveGatherV2();
 // implementation to default to the ReplicatedOpSpmdExpander.
 bool EnableReplicatedSpmdAsDefault(const std::string& op_name);
 
+// Returns the directory in which to persist the results of the DTensor MLIR
+// pass pipeline across runs, or an empty string if they are not persisted.
+std::string ExpansionCacheDir();
+
+// Returns the DTensor environment variables that can change the result of the
+// DTensor MLIR pass pipeline, as sorted NAME=VALUE lines.
+std::string PassPipelineFlags();
+
 }  // namespace dtensor
 }  // namespace tensorflow
 
@@ -0,0 +1,99 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/dtensor/cc/expansion_cache.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/OperationSupport.h"  // from @llvm-project
+#include "mlir/Parser/Parser.h"  // from @llvm-project
+#include "tensorflow/compiler/mlir/tensorflow/utils/error_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/dtensor/cc/dtensor_utils.h"
+
+namespace tensorflow {
+namespace dtensor {
+
+std::string ExpansionCache::EntryPath(mlir::ModuleOp module) const {
+  std::string key = absl::StrCat(TF_VERSION_STRING, "\n", PassPipelineFlags(),
+                                 "\n");
+  llvm::raw_string_ostream os(key);
+  module.print(os, mlir::OpPrintingFlags().enableDebugInfo());
+  os.flush();
+  const Fprint128 fingerprint = Fingerprint128(key);
+  return io::JoinPath(
+      dir_, absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                         absl::Hex(fingerprint.low64, absl::kZeroPad16),
+                         ".mlir"));
+}
+
+bool ExpansionCache::Load(const std::string& path,
+                          mlir::ModuleOp module) const {
+  Env* env = Env::Default();
+  if (!env->FileExists(path).ok()) return false;
+  std::string text;
+  Status status = ReadFileToString(env, path, &text);
+  if (!status.ok()) {
+    LOG(WARNING) << "Ignoring DTensor expansion cache entry " << path << ": "
+                 << status;
+    return false;
+  }
+  mlir::StatusScopedDiagnosticHandler diag_handler(module->getContext());
+  mlir::OwningOpRef<mlir::ModuleOp> cached_module =
+      mlir::parseSourceString<mlir::ModuleOp>(text, module->getContext());
+  status = diag_handler.ConsumeStatus();
+  if (!cached_module) {
+    LOG(WARNING) << "Ignoring DTensor expansion cache entry " << path << ": "
+                 << status;
+    return false;
+  }
+  module.getBodyRegion().takeBody(cached_module->getBodyRegion());
+  module->setAttrs(cached_module->getOperation()->getAttrDictionary());
+  VLOG(1) << "Read the DTensor expansion of a module from " << path;
+  return true;
+}
+
+void ExpansionCache::Save(const std::string& path,
+                          mlir::ModuleOp module) const {
+  // Locations name the nodes of the exported graph, so keep them.
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  module.print(os,
+               mlir::OpPrintingFlags().enableDebugInfo().printGenericOpForm());
+  os.flush();
+
+  // Write to a temporary file first, so that other clients sharing the
+  // directory never read a partial module.
+  Env* env = Env::Default();
+  const std::string tmp_path =
+      absl::StrCat(path, ".", random::New64(), ".tmp");
+  Status status = env->RecursivelyCreateDir(std::string(io::Dirname(path)));
+  if (status.ok()) status = WriteStringToFile(env, tmp_path, text);
+  if (status.ok()) status = env->RenameFile(tmp_path, path);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write DTensor expansion cache entry " << path
+                 << ": " << status;
+    env->DeleteFile(tmp_path).IgnoreError();
+  }
+}
+
+}  // namespace dtensor
+}  // namespace tensorflow
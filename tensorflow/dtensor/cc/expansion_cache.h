@@ -0,0 +1,56 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_DTENSOR_CC_EXPANSION_CACHE_H_
+#define TENSORFLOW_DTENSOR_CC_EXPANSION_CACHE_H_
+
+#include <string>
+#include <utility>
+
+#include "mlir/IR/BuiltinOps.h"  // from @llvm-project
+
+namespace tensorflow {
+namespace dtensor {
+
+// Persists the results of the DTensor MLIR pass pipeline in a directory, so
+// that later runs of the same module, including runs in other processes, can
+// skip the pipeline.
+//
+// Entries are keyed by a fingerprint of the module before the pipeline, the
+// TensorFlow version and the PassPipelineFlags(). The module carries the
+// function, the layouts, the devices and the default mesh.
+class ExpansionCache {
+ public:
+  explicit ExpansionCache(std::string dir) : dir_(std::move(dir)) {}
+
+  // Returns the path of the entry for `module`, which must not have been
+  // transformed yet.
+  std::string EntryPath(mlir::ModuleOp module) const;
+
+  // Replaces `module` with the transformed module stored at `path`. Returns
+  // false and leaves `module` unchanged if there is no such entry or if it
+  // cannot be parsed.
+  bool Load(const std::string& path, mlir::ModuleOp module) const;
+
+  // Stores the transformed `module` at `path`. Failures are only logged.
+  void Save(const std::string& path, mlir::ModuleOp module) const;
+
+ private:
+  const std::string dir_;
+};
+
+}  // namespace dtensor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_DTENSOR_CC_EXPANSION_CACHE_H_
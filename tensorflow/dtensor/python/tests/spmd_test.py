@@ -1733,6 +1733,44 @@ class DTensorSPMDTest(test_util.DTensorBaseTest):
     ):
       array_ops.gather_v2(d_variable.DVariable(sharded_tensor), indices)
 
+  def testErrorOnOneMeshIsRaisedAndOtherMeshesKeepRunning(self):
+    self.skipForDeviceType(['GPU', 'TPU'],
+                           'Splits the 8 CPU devices into two meshes.')
+    devices = test_util.create_device_list((8,), 'CPU')
+    global_ids = test_util.create_device_ids_array((4,))
+    local_ids = np.ravel(global_ids).tolist()
+    mesh_a = Mesh([_MESH_DIM_X], global_ids, local_ids, devices[:4], 'mesh_a')
+    mesh_b = Mesh([_MESH_DIM_X], global_ids, local_ids, devices[4:], 'mesh_b')
+    layout_a = Layout.replicated(mesh_a, rank=1)
+    layout_b = Layout.replicated(mesh_b, rank=1)
+
+    expected = constant_op.constant([1.0, 2.0])
+    bad_a = api.copy_to_mesh(constant_op.constant([1.0, np.nan]), layout_a)
+    good_a = api.copy_to_mesh(expected, layout_a)
+    good_b = api.copy_to_mesh(expected, layout_b)
+
+    @polymorphic_function.function
+    def check_numerics(x, y):
+      return (gen_array_ops.check_numerics(x, message='bad value'),
+              gen_array_ops.check_numerics(y, message='bad value'))
+
+    # A failure on one mesh is raised by a function spanning both meshes,
+    # whichever mesh it is on and whichever output is read first.
+    with self.assertRaisesRegex(errors_impl.OpError, 'bad value'):
+      got_a, got_b = check_numerics(bad_a, good_b)
+      self.evaluate(got_b)
+      self.evaluate(got_a)
+    with self.assertRaisesRegex(errors_impl.OpError, 'bad value'):
+      self.evaluate(check_numerics(good_b, bad_a))
+
+    # Once it has been reported, the failure does not affect later steps on
+    # either mesh.
+    got_a, got_b = check_numerics(good_a, good_b)
+    self.assertDTensorEqual(expected, layout_a, got_a)
+    self.assertDTensorEqual(expected, layout_b, got_b)
+    self.assertDTensorEqual(2 * expected, layout_b,
+                            math_ops.add(good_b, good_b))
+
   def testUnsortedSegmentSum(self):
     self.skipForDeviceType(['TPU'], 'waiting for cl/344197900')
     num_segments = 12
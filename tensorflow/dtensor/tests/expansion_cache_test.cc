@@ -0,0 +1,148 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/dtensor/cc/expansion_cache.h"
+
+#include <stdlib.h>
+
+#include <string>
+
+#include <gtest/gtest.h>
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/IR/BuiltinOps.h"  // from @llvm-project
+#include "mlir/IR/MLIRContext.h"  // from @llvm-project
+#include "mlir/Parser/Parser.h"  // from @llvm-project
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace dtensor {
+namespace {
+
+constexpr char kModule[] = R"(
+module {
+  func.func @main(%arg0: tensor<i32>) -> tensor<i32> {
+    return %arg0 : tensor<i32>
+  }
+})";
+
+constexpr char kExpandedModule[] = R"(
+module attributes {dtensor.expanded} {
+  func.func @main(%arg0: tensor<i32>) -> tensor<i32> {
+    %0 = call @expanded(%arg0) : (tensor<i32>) -> tensor<i32>
+    return %0 : tensor<i32>
+  }
+  func.func private @expanded(%arg0: tensor<i32>) -> tensor<i32> {
+    return %arg0 : tensor<i32>
+  }
+})";
+
+std::string Print(mlir::ModuleOp module) {
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  module.print(os);
+  os.flush();
+  return text;
+}
+
+class ExpansionCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    context_.loadDialect<mlir::func::FuncDialect>();
+    dir_ = io::JoinPath(
+        testing::TmpDir(),
+        ::testing::UnitTest::GetInstance()->current_test_info()->name());
+    int64_t undeleted_files, undeleted_dirs;
+    Env::Default()
+        ->DeleteRecursively(dir_, &undeleted_files, &undeleted_dirs)
+        .IgnoreError();
+  }
+
+  mlir::OwningOpRef<mlir::ModuleOp> Parse(const char* text) {
+    mlir::OwningOpRef<mlir::ModuleOp> module =
+        mlir::parseSourceString<mlir::ModuleOp>(text, &context_);
+    CHECK(module);
+    return module;
+  }
+
+  mlir::MLIRContext context_;
+  std::string dir_;
+};
+
+TEST_F(ExpansionCacheTest, SaveAndLoad) {
+  ExpansionCache cache(dir_);
+  mlir::OwningOpRef<mlir::ModuleOp> module = Parse(kModule);
+  const std::string path = cache.EntryPath(*module);
+  EXPECT_FALSE(cache.Load(path, *module));
+
+  mlir::OwningOpRef<mlir::ModuleOp> expanded = Parse(kExpandedModule);
+  cache.Save(path, *expanded);
+  EXPECT_EQ(cache.EntryPath(*Parse(kModule)), path);
+  ASSERT_TRUE(cache.Load(path, *module));
+  EXPECT_EQ(Print(*module), Print(*expanded));
+}
+
+TEST_F(ExpansionCacheTest, IgnoresCorruptEntry) {
+  ExpansionCache cache(dir_);
+  mlir::OwningOpRef<mlir::ModuleOp> module = Parse(kModule);
+  const std::string path = cache.EntryPath(*module);
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(dir_));
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), path, "not a module"));
+
+  const std::string before = Print(*module);
+  EXPECT_FALSE(cache.Load(path, *module));
+  EXPECT_EQ(Print(*module), before);
+}
+
+TEST_F(ExpansionCacheTest, IgnoresTruncatedEntry) {
+  ExpansionCache cache(dir_);
+  mlir::OwningOpRef<mlir::ModuleOp> module = Parse(kModule);
+  const std::string path = cache.EntryPath(*module);
+  cache.Save(path, *Parse(kExpandedModule));
+  std::string text;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), path, &text));
+  TF_ASSERT_OK(
+      WriteStringToFile(Env::Default(), path, text.substr(0, text.size() / 2)));
+
+  const std::string before = Print(*module);
+  EXPECT_FALSE(cache.Load(path, *module));
+  EXPECT_EQ(Print(*module), before);
+}
+
+TEST_F(ExpansionCacheTest, EntryPathDependsOnPassFlags) {
+  ExpansionCache cache(dir_);
+  mlir::OwningOpRef<mlir::ModuleOp> module = Parse(kModule);
+  const std::string path = cache.EntryPath(*module);
+
+  setenv("DTENSOR_ENABLE_REPLICATED_SPMD_AS_DEFAULT_TF.MOD", "1", 1);
+  const std::string replicated_path = cache.EntryPath(*module);
+  EXPECT_NE(replicated_path, path);
+  setenv("LOWER_DTENSOR_GATHER_TO_COLLECTIVE_GATHER_V2", "1", 1);
+  EXPECT_NE(cache.EntryPath(*module), replicated_path);
+  unsetenv("DTENSOR_ENABLE_REPLICATED_SPMD_AS_DEFAULT_TF.MOD");
+  unsetenv("LOWER_DTENSOR_GATHER_TO_COLLECTIVE_GATHER_V2");
+  EXPECT_EQ(cache.EntryPath(*module), path);
+
+  // Clients of the same job share entries.
+  setenv("DTENSOR_CLIENT_ID", "3", 1);
+  EXPECT_EQ(cache.EntryPath(*module), path);
+  unsetenv("DTENSOR_CLIENT_ID");
+}
+
+}  // namespace
+}  // namespace dtensor
+}  // namespace tensorflow
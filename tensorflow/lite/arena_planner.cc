@@ -35,6 +35,9 @@ constexpr int32_t kLastActiveNodeUndefined =
     std::numeric_limits<int32_t>::max();
 constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
 
+// The maximum number of whole graph plans kept by the planner.
+constexpr size_t kMaxCachedPlans = 4;
+
 bool ShareFirstInputWithFirstOutputForNode(const TfLiteRegistration& node_reg) {
   // TODO (b/254230751): add support for more ops which support forwarding.
   switch (node_reg.builtin_code) {
@@ -161,6 +164,7 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   // Invalidate any existing data.
   const size_t num_tensors = graph_info_->num_tensors();
   TF_LITE_ENSURE_STATUS(ResetAllocations());
+  cached_plans_.clear();
   // Maybe other verb instead of 'Assigned'
   alloc_node_.assign(num_tensors, kNodeNotAssigned);
   dealloc_node_.assign(num_tensors, kNodeNotAssigned);
@@ -243,13 +247,18 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   for (size_t i = 0; i < num_execution_nodes; ++i) {
     const TfLiteNode& node = graph_info_->node(i);
 
+    // Nodes that may run concurrently with this one could touch its tensors at
+    // any point of their group, so lifetimes are widened to the whole group.
+    const int first_concurrent_node = graph_info_->first_concurrent_node(i);
+    const int last_concurrent_node = graph_info_->last_concurrent_node(i);
+
     // First queue output tensors for allocation.
     TfLiteIntArray* node_outputs = node.outputs;
     for (int j = 0; j < node_outputs->size; ++j) {
       int tensor_index = node_outputs->data[j];
       //  Don't allocate output tensors here for shared memory parts.
       nodes_to_tensors_[i].insert(tensor_index);
-      TF_LITE_ENSURE_STATUS(allocate(i, tensor_index));
+      TF_LITE_ENSURE_STATUS(allocate(first_concurrent_node, tensor_index));
     }
 
     // Then update the ref-counts of the node's inputs, and if necessary queue
@@ -264,7 +273,8 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
           tensor_index = FindSharedTensor(tensor_index);
           refcounts[tensor_index]--;
           if (refcounts[tensor_index] == 0) {
-            TF_LITE_ENSURE_STATUS(deallocate(i, tensor_index));
+            TF_LITE_ENSURE_STATUS(
+                deallocate(last_concurrent_node, tensor_index));
           }
         }
       }
@@ -291,22 +301,40 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
     TfLiteIntArray* node_temporaries = node.temporaries;
     for (int j = 0; j < node_temporaries->size; ++j) {
       int tensor_index = node_temporaries->data[j];
-      alloc_node_[tensor_index] = i;
+      alloc_node_[tensor_index] = graph_info_->first_concurrent_node(i);
       nodes_to_tensors_[i].insert(tensor_index);
       if (!preserve_all_tensors_) {
-        dealloc_node_[tensor_index] = i;
+        dealloc_node_[tensor_index] = graph_info_->last_concurrent_node(i);
       }
     }
   }
 
+  // Plans for the whole graph computed after ResetAllocations() are cached.
+  const bool plan_whole_graph = first_node == 0 &&
+                                last_node >= num_execution_nodes - 1 &&
+                                last_active_node_ == kLastActiveNodeUndefined;
+  std::vector<size_t> signature;
+  bool plan_restored = false;
+  if (plan_whole_graph) {
+    signature = GetPlanSignature();
+    plan_restored = RestoreCachedPlan(signature);
+  }
+
   std::vector<int32_t> tensors_allocated;
-  TF_LITE_ENSURE_STATUS(
-      CalculateAllocations(first_node, last_node, &tensors_allocated));
+  if (plan_restored) {
+    last_active_node_ = last_node;
+  } else {
+    TF_LITE_ENSURE_STATUS(
+        CalculateAllocations(first_node, last_node, &tensors_allocated));
+    if (plan_whole_graph) {
+      CachePlan(std::move(signature));
+    }
+  }
   bool arena_reallocated = false;
   TF_LITE_ENSURE_STATUS(Commit(&arena_reallocated));
 
   TfLiteTensor* tensors = graph_info_->tensors();
-  if (arena_reallocated) {
+  if (arena_reallocated || plan_restored) {
     for (int i = 0; i < static_cast<int>(num_tensors); ++i) {
       TF_LITE_ENSURE_STATUS(ResolveTensorAllocation(i, tensors));
     }
@@ -365,6 +393,21 @@ void ArenaPlanner::GetAllocInfo(size_t* arena_size,
   *arena_persist_size = persistent_arena_.GetBufferSize();
 }
 
+void ArenaPlanner::GetArenaAllocations(
+    std::vector<ArenaTensorAllocation>* allocs) const {
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  const int last_node =
+      static_cast<int>(graph_info_->num_execution_nodes()) - 1;
+  for (const auto& alloc : allocs_) {
+    if (alloc.tensor < 0 || alloc.size == 0) continue;
+    const TfLiteAllocationType type = tensors[alloc.tensor].allocation_type;
+    if (type != kTfLiteArenaRw && type != kTfLiteArenaRwPersistent) continue;
+    allocs->push_back({alloc.tensor, type, alloc.offset, alloc.size,
+                       std::min(alloc.first_node, last_node),
+                       std::min(alloc.last_node, last_node)});
+  }
+}
+
 TfLiteStatus ArenaPlanner::Commit(bool* reallocated) {
   bool arena_reallocated, persistent_arena_reallocated;
   TF_LITE_ENSURE_STATUS(arena_.Commit(context_, &arena_reallocated));
@@ -497,6 +540,51 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
   return kTfLiteOk;
 }
 
+std::vector<size_t> ArenaPlanner::GetPlanSignature() {
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  const int num_tensors = static_cast<int>(graph_info_->num_tensors());
+  std::vector<size_t> signature;
+  signature.reserve(5 * num_tensors + 1);
+  signature.push_back(num_tensors);
+  for (int i = 0; i < num_tensors; ++i) {
+    const TfLiteTensor& tensor = tensors[i];
+    signature.push_back(tensor.allocation_type);
+    if (tensor.allocation_type == kTfLiteArenaRw ||
+        tensor.allocation_type == kTfLiteArenaRwPersistent) {
+      signature.push_back(tensor.bytes);
+      signature.push_back(alloc_node_[i]);
+      signature.push_back(dealloc_node_[i]);
+      signature.push_back(FindSharedTensor(i));
+    }
+  }
+  return signature;
+}
+
+bool ArenaPlanner::RestoreCachedPlan(const std::vector<size_t>& signature) {
+  for (auto it = cached_plans_.begin(); it != cached_plans_.end(); ++it) {
+    if (it->signature != signature) {
+      continue;
+    }
+    cached_plans_.splice(cached_plans_.begin(), cached_plans_, it);
+    const CachedPlan& plan = cached_plans_.front();
+    allocs_ = plan.allocs;
+    actual_tensor_id_ = plan.actual_tensor_id;
+    arena_.SetPlan(plan.arena_plan);
+    persistent_arena_.SetPlan(plan.persistent_arena_plan);
+    return true;
+  }
+  return false;
+}
+
+void ArenaPlanner::CachePlan(std::vector<size_t> signature) {
+  if (cached_plans_.size() >= kMaxCachedPlans) {
+    cached_plans_.pop_back();
+  }
+  cached_plans_.push_front(CachedPlan{std::move(signature), allocs_,
+                                      actual_tensor_id_, arena_.GetPlan(),
+                                      persistent_arena_.GetPlan()});
+}
+
 bool AreTensorsAllocatedInSameArena(int32_t root_tensor_index,
                                     int32_t tensor_index,
                                     const TfLiteTensor* tensors) {
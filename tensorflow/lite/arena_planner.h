@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_ARENA_PLANNER_H_
 
 #include <cstdint>
+#include <list>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
@@ -45,6 +46,11 @@ struct AllocationInfo;
 // execution. Since dynamic tensors don't have sizes until after the
 // corresponding operation is executed, this class supports incremental
 // planning.
+//
+// Plans computed from scratch for the whole graph are cached, keyed by the
+// sizes and lifetimes of the tensors they place. When the input shapes of a
+// model flip between a few values, switching back to a known shape reuses the
+// cached tensor offsets instead of placing all tensors again.
 class ArenaPlanner : public MemoryPlanner {
  public:
   // Ownership of 'context' is not taken and it must remain util the
@@ -68,6 +74,8 @@ class ArenaPlanner : public MemoryPlanner {
   void DumpDebugInfo(const std::vector<int>& execution_plan) const override;
   void GetAllocInfo(size_t* arena_size,
                     size_t* arena_persist_size) const override;
+  void GetArenaAllocations(
+      std::vector<ArenaTensorAllocation>* allocs) const override;
 
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
@@ -112,6 +120,30 @@ class ArenaPlanner : public MemoryPlanner {
   // Return the index of the tensor owing `tensor_index's` buffer.
   int FindSharedTensor(int tensor_index);
 
+  // A plan for the whole graph, computed by CalculateAllocations after
+  // ResetAllocations.
+  struct CachedPlan {
+    // Everything the plan is computed from, see GetPlanSignature.
+    std::vector<size_t> signature;
+    std::vector<ArenaAllocWithUsageInterval> allocs;
+    // NOLINTNEXTLINE - absl::flat_hash_map increases binary size by 106kB.
+    std::unordered_map<int32_t, int32_t> actual_tensor_id;
+    SimpleMemoryArena::Plan arena_plan;
+    SimpleMemoryArena::Plan persistent_arena_plan;
+  };
+
+  // Returns the allocation type, size and lifetime of all tensors. Planning
+  // all tensors from scratch gives the same result for equal signatures.
+  std::vector<size_t> GetPlanSignature();
+
+  // Restores the cached plan for `signature` and returns true, or returns
+  // false if there is none.
+  bool RestoreCachedPlan(const std::vector<size_t>& signature);
+
+  // Adds the current plan to the cache, evicting the least recently used plan
+  // if the cache is full.
+  void CachePlan(std::vector<size_t> signature);
+
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
 
@@ -153,6 +185,9 @@ class ArenaPlanner : public MemoryPlanner {
   // data with another tensor.
   // NOLINTNEXTLINE - absl::flat_hash_map increases binary size by 106kB.
   std::unordered_map<int32_t, int32_t> actual_tensor_id_;
+
+  // Plans for the whole graph, most recently used first.
+  std::list<CachedPlan> cached_plans_;
 };
 
 }  // namespace tflite
@@ -144,6 +144,30 @@ class TestGraph {
     variables_ = variables;
   }
 
+  // Makes the nodes in [first, last] of every given group run concurrently.
+  void SetConcurrentGroups(const std::vector<std::pair<int, int>>& groups) {
+    concurrent_group_first_.resize(nodes_.size());
+    concurrent_group_last_.resize(nodes_.size());
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      concurrent_group_first_[i] = concurrent_group_last_[i] = i;
+    }
+    for (const auto& group : groups) {
+      for (int i = group.first; i <= group.second; ++i) {
+        concurrent_group_first_[i] = group.first;
+        concurrent_group_last_[i] = group.second;
+      }
+    }
+  }
+
+  size_t first_concurrent_node(size_t index) const {
+    return concurrent_group_first_.empty() ? index
+                                           : concurrent_group_first_[index];
+  }
+  size_t last_concurrent_node(size_t index) const {
+    return concurrent_group_last_.empty() ? index
+                                          : concurrent_group_last_[index];
+  }
+
   void Swap(TestGraph* other) {
     std::swap(nodes_, other->nodes_);
     std::swap(tensors_, other->tensors_);
@@ -159,6 +183,8 @@ class TestGraph {
   std::vector<int> inputs_;
   std::vector<int> outputs_;
   std::vector<int> variables_;
+  std::vector<size_t> concurrent_group_first_;
+  std::vector<size_t> concurrent_group_last_;
 };
 
 // The GraphInfo for a TestGraph.
@@ -185,6 +211,12 @@ class TestGraphInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return graph_->variables();
   }
+  size_t first_concurrent_node(size_t index) const override {
+    return graph_->first_concurrent_node(index);
+  }
+  size_t last_concurrent_node(size_t index) const override {
+    return graph_->last_concurrent_node(index);
+  }
 
  private:
   TestGraph* graph_;
@@ -950,6 +982,127 @@ TEST_F(ArenaPlannerTest, DebugTensors) {
   EXPECT_EQ(tensorOffsets.size(), 8);
 }
 
+TEST_F(ArenaPlannerTest, CachedPlanReusedAfterResize) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  std::vector<std::ptrdiff_t> offsets;
+  for (int i = 0; i < 6; ++i) {
+    offsets.push_back(GetOffset(i));
+  }
+
+  // Plan for a few other input sizes, more than the planner caches.
+  std::vector<TfLiteTensor>& tensors = *graph.tensors();
+  const size_t original_bytes = tensors[0].bytes;
+  for (int i = 1; i <= 8; ++i) {
+    ResetAllocations();
+    tensors[0].bytes = original_bytes + 64 * i;
+    Execute(0, graph.nodes().size() - 1);
+    EXPECT_EQ(GetOffset(1), GetOffsetAfter(0));
+  }
+
+  // Switching back gives the same offsets as planning from scratch.
+  for (int repeat = 0; repeat < 2; ++repeat) {
+    ResetAllocations();
+    tensors[0].bytes = original_bytes;
+    Execute(0, graph.nodes().size() - 1);
+    for (int i = 0; i < 6; ++i) {
+      EXPECT_EQ(GetOffset(i), offsets[i]);
+    }
+  }
+}
+
+TEST_F(ArenaPlannerTest, CachedPlanNotReusedForDifferentTemporaries) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},   // First op
+                      {{2, 0}, {4}, {5}},  // Second op, with temporary
+                      {{4}, {3}, {}}       // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
+
+  // Grow the temporary, which only ops' Prepare knows about. The output of the
+  // second op must be moved past it.
+  ResetAllocations();
+  std::vector<TfLiteTensor>& tensors = *graph.tensors();
+  tensors[5].bytes = 1000;
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
+}
+
+TEST_F(ArenaPlannerTest, ConcurrentNodesDontShareMemory) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},     // First op
+                      {{1}, {2}, {5}},    // Second op
+                      {{0}, {3}, {6}},    // Third op
+                      {{2, 3}, {4}, {}},  // Fourth op
+                  },
+                  {4});
+  (*graph.tensors())[1].bytes = 100;
+  (*graph.tensors())[5].bytes = 100;
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  // Run one at a time, the third op reuses the memory of the tensor that the
+  // second op is done with.
+  EXPECT_EQ(GetOffset(6), GetOffset(1));
+
+  // Run together, the tensors of the second and third op must not overlap.
+  graph.SetConcurrentGroups({{1, 2}});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  std::vector<int> group_tensors = {1, 2, 3, 5, 6};
+  for (int a : group_tensors) {
+    for (int b : group_tensors) {
+      if (a == b) continue;
+      EXPECT_TRUE(GetOffsetAfter(a) <= GetOffset(b) ||
+                  GetOffsetAfter(b) <= GetOffset(a))
+          << "tensors " << a << " and " << b << " overlap";
+    }
+  }
+}
+
+TEST_F(ArenaPlannerTest, GetArenaAllocations) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  (*graph.tensors())[5].allocation_type = kTfLiteArenaRwPersistent;
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+
+  std::vector<ArenaTensorAllocation> allocs;
+  planner_->GetArenaAllocations(&allocs);
+  ASSERT_EQ(allocs.size(), 6);
+  const std::vector<std::pair<int, int>> expected_lifetimes = {
+      {0, 2}, {0, 2}, {0, 1}, {2, 2}, {1, 2}, {1, 2}};
+  for (int i = 0; i < allocs.size(); ++i) {
+    const TfLiteTensor& tensor = (*graph.tensors())[i];
+    EXPECT_EQ(allocs[i].tensor, i);
+    EXPECT_EQ(allocs[i].allocation_type, tensor.allocation_type);
+    EXPECT_EQ(allocs[i].offset, GetOffset(i));
+    EXPECT_EQ(allocs[i].size, tensor.bytes);
+    EXPECT_EQ(allocs[i].first_node, expected_lifetimes[i].first);
+    EXPECT_EQ(allocs[i].last_node, expected_lifetimes[i].second);
+  }
+}
+
 TEST_F(ArenaPlannerTest, SimpleProfilerTest) {
   gNumAlloc = 0;
   gNumDealloc = 0;
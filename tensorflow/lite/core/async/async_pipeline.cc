@@ -0,0 +1,157 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/async_pipeline.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/async/async_signature_runner.h"
+#include "tensorflow/lite/core/async/c/task.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/signature_runner.h"
+
+namespace tflite {
+namespace async {
+
+namespace {
+
+bool HasName(const std::vector<const char*>& names, const std::string& name) {
+  return std::any_of(names.begin(), names.end(),
+                     [&name](const char* n) { return name == n; });
+}
+
+}  // namespace
+
+AsyncPipeline::AsyncPipeline(SignatureRunner* cpu_stage,
+                             AsyncSignatureRunner* async_stage,
+                             FrameDoneCallback on_frame_done)
+    : cpu_stage_(cpu_stage),
+      async_stage_(async_stage),
+      on_frame_done_(std::move(on_frame_done)) {}
+
+AsyncPipeline::~AsyncPipeline() {
+  // `Finish` blocks until the frame in flight, if any, is done.
+  for (auto& slot : slots_) {
+    if (slot.task != nullptr) async_stage_->Finish(slot.task);
+  }
+}
+
+int AsyncPipeline::AddSlot(std::vector<HandoffBuffer> handoff,
+                           std::vector<OutputBuffer> outputs) {
+  slots_.emplace_back();
+  slots_.back().handoff = std::move(handoff);
+  slots_.back().outputs = std::move(outputs);
+  return depth() - 1;
+}
+
+TfLiteStatus AsyncPipeline::Prepare() {
+  if (prepared_ || slots_.empty()) {
+    TFLITE_LOG(tflite::TFLITE_LOG_ERROR,
+               "AsyncPipeline needs at least one slot and must be prepared "
+               "once.");
+    return kTfLiteError;
+  }
+  for (auto& slot : slots_) {
+    for (const auto& buffer : slot.handoff) {
+      if (!HasName(cpu_stage_->output_names(), buffer.name) ||
+          !HasName(async_stage_->input_names(), buffer.name)) {
+        TFLITE_LOG(tflite::TFLITE_LOG_ERROR,
+                   "Hand-off tensor %s is not both an output of the CPU stage "
+                   "and an input of the async stage.",
+                   buffer.name.c_str());
+        return kTfLiteError;
+      }
+    }
+    for (const char* name : async_stage_->input_names()) {
+      const bool handed_off = std::any_of(
+          slot.handoff.begin(), slot.handoff.end(),
+          [name](const HandoffBuffer& buffer) { return buffer.name == name; });
+      if (HasName(cpu_stage_->output_names(), name) && !handed_off) {
+        TFLITE_LOG(tflite::TFLITE_LOG_ERROR,
+                   "No hand-off buffer for tensor %s.", name);
+        return kTfLiteError;
+      }
+    }
+  }
+  for (auto& slot : slots_) {
+    slot.task = async_stage_->CreateTask();
+    if (slot.task == nullptr) return kTfLiteError;
+    for (const auto& buffer : slot.handoff) {
+      TF_LITE_ENSURE_STATUS(TfLiteExecutionTaskSetBuffer(
+          slot.task, kTfLiteIoTypeInput, buffer.name.c_str(), buffer.handle));
+    }
+    for (const auto& buffer : slot.outputs) {
+      TF_LITE_ENSURE_STATUS(TfLiteExecutionTaskSetBuffer(
+          slot.task, kTfLiteIoTypeOutput, buffer.name.c_str(), buffer.handle));
+    }
+  }
+  prepared_ = true;
+  return kTfLiteOk;
+}
+
+TfLiteStatus AsyncPipeline::Submit() {
+  if (!prepared_) {
+    TFLITE_LOG(tflite::TFLITE_LOG_ERROR, "AsyncPipeline is not prepared.");
+    return kTfLiteError;
+  }
+  const int index = next_slot_;
+  Slot& slot = slots_[index];
+  // The previous frame of this slot still reads the hand-off buffers. Its
+  // status goes to `on_frame_done_`, it doesn't affect this frame.
+  Retire(index);
+
+  // Point the CPU stage outputs at the slot's hand-off buffers. Once the
+  // tensors have custom allocations this doesn't change the memory plan, so
+  // AllocateTensors() only verifies the buffers.
+  for (const auto& buffer : slot.handoff) {
+    TfLiteCustomAllocation allocation{buffer.data, buffer.bytes};
+    TF_LITE_ENSURE_STATUS(cpu_stage_->SetCustomAllocationForOutputTensor(
+        buffer.name.c_str(), allocation));
+  }
+  TF_LITE_ENSURE_STATUS(cpu_stage_->AllocateTensors());
+  TF_LITE_ENSURE_STATUS(cpu_stage_->Invoke());
+
+  next_slot_ = (next_slot_ + 1) % depth();
+  // `InvokeAsync` and `Wait` must be called in pairs, even if scheduling
+  // failed.
+  slot.in_flight = true;
+  return async_stage_->InvokeAsync(slot.task);
+}
+
+TfLiteStatus AsyncPipeline::Flush() {
+  TfLiteStatus status = kTfLiteOk;
+  // `next_slot_` holds the oldest frame in flight.
+  for (int i = 0; i < depth(); ++i) {
+    if (Retire((next_slot_ + i) % depth()) != kTfLiteOk) status = kTfLiteError;
+  }
+  return status;
+}
+
+TfLiteStatus AsyncPipeline::Retire(int index) {
+  Slot& slot = slots_[index];
+  if (!slot.in_flight) return kTfLiteOk;
+  const TfLiteStatus status = async_stage_->Wait(slot.task);
+  slot.in_flight = false;
+  if (on_frame_done_) on_frame_done_(index, status);
+  return status;
+}
+
+}  // namespace async
+}  // namespace tflite
@@ -0,0 +1,147 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_ASYNC_ASYNC_PIPELINE_H_
+#define TENSORFLOW_LITE_CORE_ASYNC_ASYNC_PIPELINE_H_
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/async/async_signature_runner.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/signature_runner.h"
+
+namespace tflite {
+namespace async {
+
+// WARNING: Experimental interface, subject to change
+//
+// Runs frames through two stages: a synchronous CPU stage (`SignatureRunner`)
+// followed by an asynchronous stage (`AsyncSignatureRunner`, e.g. a GPU or NPU
+// delegate). Every output of the CPU stage whose name matches an input of the
+// async stage is handed off without a copy: the CPU stage writes it straight
+// into the CPU mapping of a buffer registered with the async stage (e.g. a
+// locked AHardwareBuffer or a mmap-ed dma-buf).
+//
+// Up to `depth` frames are in flight, one per slot. Each slot owns an
+// execution task and its own set of hand-off buffers, so while the async
+// stage processes frame N the CPU stage can already produce frame N + 1 into
+// another slot.
+//
+// Typical usage:
+//
+//   AsyncPipeline pipeline(cpu_runner, async_runner, on_frame_done);
+//   for (int i = 0; i < depth; ++i) {
+//     pipeline.AddSlot({{"features", handle[i], mapped[i], bytes}}, ...);
+//   }
+//   pipeline.Prepare();
+//   while (...) {
+//     FillInputs(cpu_runner);
+//     pipeline.Submit();
+//   }
+//   pipeline.Flush();
+//
+// The pipeline is not thread-safe; all calls, including `on_frame_done`,
+// happen on the calling thread.
+class AsyncPipeline {
+ public:
+  // A buffer carrying one tensor from the CPU stage to the async stage.
+  struct HandoffBuffer {
+    // Name of the async stage input, and of the CPU stage output, it carries.
+    std::string name;
+    // Handle of the buffer, registered with the async stage as an input.
+    TfLiteBufferHandle handle;
+    // CPU mapping of the buffer. Must stay valid and writable for the lifetime
+    // of the pipeline and be aligned to `kDefaultTensorAlignment`.
+    void* data;
+    // Size of the mapping in bytes.
+    size_t bytes;
+  };
+
+  // A buffer receiving one output of the async stage.
+  struct OutputBuffer {
+    // Name of the async stage output.
+    std::string name;
+    // Handle of the buffer, registered with the async stage as an output.
+    TfLiteBufferHandle handle;
+  };
+
+  // Called once for every submitted frame, in submission order, after the
+  // async stage finished it. `slot` identifies the output buffers holding the
+  // results, which stay valid until the slot's next frame is submitted.
+  using FrameDoneCallback = std::function<void(int slot, TfLiteStatus status)>;
+
+  // `cpu_stage` and `async_stage` must outlive the pipeline.
+  AsyncPipeline(SignatureRunner* cpu_stage, AsyncSignatureRunner* async_stage,
+                FrameDoneCallback on_frame_done);
+  ~AsyncPipeline();
+
+  AsyncPipeline(const AsyncPipeline&) = delete;
+  AsyncPipeline& operator=(const AsyncPipeline&) = delete;
+
+  // Adds a slot, i.e. allows one more frame in flight. `handoff` must cover
+  // every async stage input produced by the CPU stage. Other async stage
+  // inputs (and their syncs) can be set on `task(slot)` after `Prepare`.
+  // Returns the index of the slot.
+  int AddSlot(std::vector<HandoffBuffer> handoff,
+              std::vector<OutputBuffer> outputs);
+
+  // Validates the slots and creates their execution tasks. Must be called
+  // once, after all slots have been added and after the async stage backends
+  // have been prepared.
+  TfLiteStatus Prepare();
+
+  // Runs the CPU stage on its current inputs and schedules the async stage on
+  // the result. If the next slot still holds a frame in flight, waits for it
+  // and reports it through `on_frame_done` first.
+  TfLiteStatus Submit();
+
+  // Waits for all frames in flight and reports them through `on_frame_done`.
+  TfLiteStatus Flush();
+
+  // Number of slots, i.e. the maximum number of frames in flight.
+  int depth() const { return static_cast<int>(slots_.size()); }
+
+  // The execution task of `slot`. Only valid after `Prepare`.
+  TfLiteExecutionTask* task(int slot) { return slots_[slot].task; }
+
+ private:
+  struct Slot {
+    std::vector<HandoffBuffer> handoff;
+    std::vector<OutputBuffer> outputs;
+    TfLiteExecutionTask* task = nullptr;
+    bool in_flight = false;
+  };
+
+  // Waits for the frame in flight in slot `index`, if any, and reports it.
+  TfLiteStatus Retire(int index);
+
+  // Not owned.
+  SignatureRunner* cpu_stage_;
+  AsyncSignatureRunner* async_stage_;
+
+  FrameDoneCallback on_frame_done_;
+  std::vector<Slot> slots_;
+  // The slot receiving the next submitted frame.
+  int next_slot_ = 0;
+  bool prepared_ = false;
+};
+
+}  // namespace async
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_ASYNC_ASYNC_PIPELINE_H_
@@ -0,0 +1,177 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/async_pipeline.h"
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/async/async_signature_runner.h"
+#include "tensorflow/lite/core/async/c/task.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/testing/mock_async_kernel.h"
+#include "tensorflow/lite/core/async/testing/test_backend.h"
+#include "tensorflow/lite/core/c/builtin_op_data.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/kernels/builtin_op_kernels.h"
+#include "tensorflow/lite/interpreter_test_util.h"
+#include "tensorflow/lite/signature_runner.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace async {
+namespace {
+
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+constexpr char kSignatureKey[] = "serving_default";
+
+class AsyncPipelineTest : public InterpreterTest {
+ protected:
+  // Builds `output = input + input` on tensors of 3 floats.
+  static std::unique_ptr<Interpreter> BuildAdd(const char* input,
+                                               const char* output) {
+    auto interpreter = std::make_unique<Interpreter>();
+    interpreter->AddTensors(2);
+    interpreter->SetInputs({0});
+    interpreter->SetOutputs({1});
+    TfLiteQuantizationParams quant;
+    interpreter->SetTensorParametersReadWrite(0, kTfLiteFloat32, input, {3},
+                                              quant);
+    interpreter->SetTensorParametersReadWrite(1, kTfLiteFloat32, output, {3},
+                                              quant);
+    TfLiteRegistration* reg = ops::builtin::Register_ADD();
+    void* builtin_data = malloc(sizeof(TfLiteAddParams));
+    *static_cast<TfLiteAddParams*>(builtin_data) = {};
+    interpreter->AddNodeWithParameters({0, 0}, {1}, nullptr, 0, builtin_data,
+                                       reg);
+    BuildSignature(interpreter.get(), kSignatureKey, {{input, 0}},
+                   {{output, 1}});
+    return interpreter;
+  }
+
+  void SetUp() override {
+    kernel_ =
+        std::make_unique<::testing::StrictMock<testing::MockAsyncKernel>>();
+    backend_ = std::make_unique<testing::TestBackend>(kernel_->kernel());
+
+    cpu_interpreter_ = BuildAdd("x", "y");
+    async_interpreter_ = BuildAdd("y", "z");
+    async_interpreter_->ModifyGraphWithDelegate(backend_->get_delegate());
+
+    cpu_stage_ = cpu_interpreter_->GetSignatureRunner(kSignatureKey);
+    ASSERT_EQ(kTfLiteOk, cpu_stage_->AllocateTensors());
+    async_stage_ = async_interpreter_->GetAsyncSignatureRunner(kSignatureKey);
+    ASSERT_NE(nullptr, async_stage_);
+  }
+
+  void SetInput(float value) {
+    float* x = cpu_stage_->input_tensor("x")->data.f;
+    x[0] = x[1] = x[2] = value;
+  }
+
+  std::unique_ptr<::testing::StrictMock<testing::MockAsyncKernel>> kernel_;
+  std::unique_ptr<testing::TestBackend> backend_;
+  std::unique_ptr<Interpreter> cpu_interpreter_;
+  std::unique_ptr<Interpreter> async_interpreter_;
+  SignatureRunner* cpu_stage_ = nullptr;
+  AsyncSignatureRunner* async_stage_ = nullptr;
+};
+
+TEST_F(AsyncPipelineTest, HandsOffCpuOutputsWithoutCopies) {
+  // Stand-ins for the CPU mappings of two buffers registered with the async
+  // stage.
+  alignas(kDefaultTensorAlignment) float mapped[2][16] = {};
+  const std::map<TfLiteBufferHandle, float*> buffers = {{10, mapped[0]},
+                                                        {11, mapped[1]}};
+
+  // Records the hand-off buffer and the value the async stage sees in it.
+  std::vector<std::pair<TfLiteBufferHandle, float>> evaluated;
+  EXPECT_CALL(*kernel_, Eval(_, _, _))
+      .Times(3)
+      .WillRepeatedly([&](TfLiteOpaqueContext*, TfLiteOpaqueNode*,
+                          TfLiteExecutionTask* task) {
+        const TfLiteBufferHandle handle =
+            TfLiteExecutionTaskGetBufferByName(task, kTfLiteIoTypeInput, "y");
+        evaluated.emplace_back(handle, buffers.at(handle)[2]);
+        return kTfLiteOk;
+      });
+  EXPECT_CALL(*kernel_, Wait(_, _)).Times(3);
+  EXPECT_CALL(*kernel_, Finish(_, _)).Times(2);
+
+  std::vector<int> done;
+  {
+    AsyncPipeline pipeline(cpu_stage_, async_stage_,
+                           [&done](int slot, TfLiteStatus status) {
+                             EXPECT_EQ(kTfLiteOk, status);
+                             done.push_back(slot);
+                           });
+    EXPECT_EQ(0, pipeline.AddSlot({{"y", 10, mapped[0], sizeof(mapped[0])}},
+                                  {{"z", 20}}));
+    EXPECT_EQ(1, pipeline.AddSlot({{"y", 11, mapped[1], sizeof(mapped[1])}},
+                                  {{"z", 21}}));
+    ASSERT_EQ(kTfLiteOk, pipeline.Prepare());
+    EXPECT_EQ(20, TfLiteExecutionTaskGetBufferByName(pipeline.task(0),
+                                                     kTfLiteIoTypeOutput, "z"));
+
+    SetInput(1);
+    ASSERT_EQ(kTfLiteOk, pipeline.Submit());
+    SetInput(2);
+    ASSERT_EQ(kTfLiteOk, pipeline.Submit());
+    // Both frames are in flight.
+    EXPECT_TRUE(done.empty());
+
+    // Reusing the first slot retires its frame first.
+    SetInput(3);
+    ASSERT_EQ(kTfLiteOk, pipeline.Submit());
+    EXPECT_THAT(done, ElementsAre(0));
+
+    ASSERT_EQ(kTfLiteOk, pipeline.Flush());
+    EXPECT_THAT(done, ElementsAre(0, 1, 0));
+  }
+
+  EXPECT_THAT(evaluated, ElementsAre(Pair(10, 2.f), Pair(11, 4.f),
+                                     Pair(10, 6.f)));
+  // The CPU stage wrote its outputs straight into the mapped buffers.
+  EXPECT_EQ(6.f, mapped[0][0]);
+  EXPECT_EQ(4.f, mapped[1][0]);
+}
+
+TEST_F(AsyncPipelineTest, PrepareFailsWithoutHandoffBuffer) {
+  AsyncPipeline pipeline(cpu_stage_, async_stage_, nullptr);
+  pipeline.AddSlot({}, {{"z", 20}});
+  EXPECT_EQ(kTfLiteError, pipeline.Prepare());
+  EXPECT_EQ(kTfLiteError, pipeline.Submit());
+}
+
+TEST_F(AsyncPipelineTest, PrepareFailsWithUnknownHandoffTensor) {
+  alignas(kDefaultTensorAlignment) float mapped[16] = {};
+  AsyncPipeline pipeline(cpu_stage_, async_stage_, nullptr);
+  pipeline.AddSlot({{"y", 10, mapped, sizeof(mapped)},
+                    {"x", 11, mapped, sizeof(mapped)}},
+                   {});
+  EXPECT_EQ(kTfLiteError, pipeline.Prepare());
+}
+
+}  // namespace
+}  // namespace async
+}  // namespace tflite
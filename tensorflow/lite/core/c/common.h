@@ -283,6 +283,9 @@ typedef enum TfLiteQuantizationType {
   // Affine quantization (with support for per-channel quantization).
   // Corresponds to TfLiteAffineQuantization.
   kTfLiteAffineQuantization = 1,
+  // Block-wise quantization, with a scale per block of values.
+  // Corresponds to TfLiteBlockwiseQuantization.
+  kTfLiteBlockwiseQuantization = 2,
 } TfLiteQuantizationType;
 
 // Structure specifying the quantization used by the tensor, if-any.
@@ -308,6 +311,22 @@ typedef struct TfLiteAffineQuantization {
   int32_t quantized_dimension;
 } TfLiteAffineQuantization;
 
+// Parameters for block-wise quantization. Each slice of the tensor along
+// quantized_dimension is split into blocks of `blocksize` consecutive values
+// along the last dimension. For a particular value in block b of slice c,
+// quantized values can be converted back to float using:
+//     real_value = scale[c, b] * (quantized_value - zero_point[c, b])
+// where scale and zero_point are tensors of the same subgraph, of shape
+// [num_slices, last_dim / blocksize].
+typedef struct TfLiteBlockwiseQuantization {
+  // Index of the tensor holding the scales.
+  int32_t scale;
+  // Index of the tensor holding the zero points, or -1 if they are all zero.
+  int32_t zero_point;
+  int32_t blocksize;
+  int32_t quantized_dimension;
+} TfLiteBlockwiseQuantization;
+
 /* A union of pointers that points to memory for a given tensor. */
 typedef union TfLitePtrUnion {
   /* Do not access these members directly, if possible, use
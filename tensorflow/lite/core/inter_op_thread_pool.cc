@@ -0,0 +1,84 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/inter_op_thread_pool.h"
+
+#include <functional>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+
+namespace tflite {
+
+InterOpThreadPool::InterOpThreadPool(int num_threads) {
+  for (int thread = 1; thread < num_threads; ++thread) {
+    workers_.emplace_back([this, thread]() { WorkerLoop(thread); });
+  }
+}
+
+InterOpThreadPool::~InterOpThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void InterOpThreadPool::ParallelFor(int num_tasks,
+                                    const std::function<void(int, int)>& fn) {
+  if (num_tasks <= 0) return;
+  if (workers_.empty() || num_tasks == 1) {
+    for (int task = 0; task < num_tasks; ++task) fn(task, /*thread=*/0);
+    return;
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  fn_ = &fn;
+  num_tasks_ = num_tasks;
+  next_task_ = 0;
+  pending_tasks_ = num_tasks;
+  ++batch_;
+  work_cv_.notify_all();
+  RunTasks(/*thread=*/0, lock);
+  done_cv_.wait(lock, [this]() { return pending_tasks_ == 0; });
+  fn_ = nullptr;
+}
+
+void InterOpThreadPool::WorkerLoop(int thread) {
+  uint64_t last_batch = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_cv_.wait(lock, [this, last_batch]() {
+      return stop_ || batch_ != last_batch;
+    });
+    if (stop_) return;
+    last_batch = batch_;
+    RunTasks(thread, lock);
+  }
+}
+
+void InterOpThreadPool::RunTasks(int thread,
+                                 std::unique_lock<std::mutex>& lock) {
+  while (next_task_ < num_tasks_) {
+    const int task = next_task_++;
+    const std::function<void(int, int)>* fn = fn_;
+    lock.unlock();
+    (*fn)(task, thread);
+    lock.lock();
+    if (--pending_tasks_ == 0) done_cv_.notify_one();
+  }
+}
+
+}  // namespace tflite
@@ -0,0 +1,68 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_INTER_OP_THREAD_POOL_H_
+#define TENSORFLOW_LITE_CORE_INTER_OP_THREAD_POOL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <functional>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace tflite {
+
+// A minimal fork-join pool used by `Subgraph` to run independent nodes of the
+// execution plan concurrently. `ParallelFor` runs on the calling thread plus
+// `num_threads - 1` workers, so a pool of one thread never spawns any.
+class InterOpThreadPool {
+ public:
+  explicit InterOpThreadPool(int num_threads);
+  ~InterOpThreadPool();
+
+  // Total number of threads tasks run on, including the calling thread.
+  int num_threads() const { return static_cast<int>(workers_.size()) + 1; }
+
+  // Calls `fn(task, thread)` for every `task` in [0, num_tasks) and returns
+  // once all calls have finished. `thread` is in [0, num_threads()) and is 0
+  // for the calling thread. Must not be called concurrently, nor from within
+  // `fn`.
+  void ParallelFor(int num_tasks, const std::function<void(int, int)>& fn);
+
+ private:
+  void WorkerLoop(int thread);
+
+  // Runs tasks of the current batch until none are left. Must be called with
+  // `lock` held; the lock is released while a task runs.
+  void RunTasks(int thread, std::unique_lock<std::mutex>& lock);
+
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  const std::function<void(int, int)>* fn_ = nullptr;
+  int num_tasks_ = 0;
+  int next_task_ = 0;
+  int pending_tasks_ = 0;
+  uint64_t batch_ = 0;
+  bool stop_ = false;
+  std::vector<std::thread> workers_;
+
+  InterOpThreadPool(const InterOpThreadPool&) = delete;
+  InterOpThreadPool& operator=(const InterOpThreadPool&) = delete;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_INTER_OP_THREAD_POOL_H_
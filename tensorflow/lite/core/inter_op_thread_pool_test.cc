@@ -0,0 +1,70 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/core/inter_op_thread_pool.h"
+
+#include <atomic>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace {
+
+TEST(InterOpThreadPoolTest, RunsEveryTaskOnce) {
+  InterOpThreadPool pool(4);
+  EXPECT_EQ(pool.num_threads(), 4);
+  for (int num_tasks : {0, 1, 3, 4, 17}) {
+    std::vector<std::atomic<int>> runs(num_tasks);
+    for (auto& count : runs) count = 0;
+    pool.ParallelFor(num_tasks, [&runs](int task, int thread) {
+      EXPECT_GE(thread, 0);
+      EXPECT_LT(thread, 4);
+      ++runs[task];
+    });
+    for (const auto& count : runs) {
+      EXPECT_EQ(count, 1);
+    }
+  }
+}
+
+TEST(InterOpThreadPoolTest, RunsTasksConcurrently) {
+  InterOpThreadPool pool(2);
+  std::atomic<int> arrived(0);
+  std::atomic<int> met(0);
+  pool.ParallelFor(2, [&](int, int) {
+    ++arrived;
+    // Waits until the other task started. Fails rather than hangs if the
+    // tasks ran one after the other.
+    for (int i = 0; i < 1000000000 && arrived < 2; ++i) {
+    }
+    if (arrived == 2) ++met;
+  });
+  EXPECT_EQ(met, 2);
+}
+
+TEST(InterOpThreadPoolTest, SingleThreadRunsOnCaller) {
+  InterOpThreadPool pool(1);
+  EXPECT_EQ(pool.num_threads(), 1);
+  std::vector<int> threads;
+  pool.ParallelFor(3, [&threads](int, int thread) {
+    threads.push_back(thread);
+  });
+  EXPECT_THAT(threads, ::testing::ElementsAre(0, 0, 0));
+}
+
+}  // namespace
+}  // namespace tflite
@@ -622,6 +622,17 @@ class Interpreter {
     return primary_subgraph().EnsureTensorDataIsReadable(tensor_index);
   }
 
+  /// \warning This is an experimental API and subject to change. \n
+  /// \brief Get the memory plan of the primary subgraph: for every arena
+  /// allocated tensor, its offset and size in the arena and the first and last
+  /// node of the execution plan using it, as planned by the last
+  /// `AllocateTensors()`. The arena sizes are reported by
+  /// `Subgraph::GetMemoryAllocInfo()`, and `tensorflow/lite/tools:arena_layout`
+  /// prints a timeline of the plan and compares it to other strategies.
+  std::vector<ArenaTensorAllocation> GetArenaAllocations() const {
+    return primary_subgraph().GetArenaAllocations();
+  }
+
   /// \warning This is an experimental API and subject to change. \n
   /// \brief Set the delegate buffer handle to a tensor. It can be called in the
   /// following cases:
@@ -395,6 +395,32 @@ TfLiteStatus InterpreterBuilder::ParseQuantization(
     const QuantizationParameters* src_quantization,
     TfLiteQuantization* quantization, const std::vector<int>& dims) {
   quantization->type = kTfLiteNoQuantization;
+  const BlockwiseQuantization* src_blockwise =
+      src_quantization ? src_quantization->details_as_BlockwiseQuantization()
+                       : nullptr;
+  if (src_blockwise) {
+    if (src_blockwise->block_size() <= 0 ||
+        src_quantization->quantized_dimension() < 0 ||
+        (!dims.empty() &&
+         src_quantization->quantized_dimension() >= dims.size())) {
+      error_reporter_->Report(
+          "Invalid block-wise quantization: block_size %d, quantized_dimension "
+          "%d.",
+          src_blockwise->block_size(), src_quantization->quantized_dimension());
+      return kTfLiteError;
+    }
+    auto* blockwise_quantization =
+        reinterpret_cast<TfLiteBlockwiseQuantization*>(
+            malloc(sizeof(TfLiteBlockwiseQuantization)));
+    blockwise_quantization->scale = src_blockwise->scales();
+    blockwise_quantization->zero_point = src_blockwise->zero_points();
+    blockwise_quantization->blocksize = src_blockwise->block_size();
+    blockwise_quantization->quantized_dimension =
+        src_quantization->quantized_dimension();
+    quantization->type = kTfLiteBlockwiseQuantization;
+    quantization->params = reinterpret_cast<void*>(blockwise_quantization);
+    return kTfLiteOk;
+  }
   if (!src_quantization || !src_quantization->scale() ||
       src_quantization->scale()->size() == 0) {
     return kTfLiteOk;
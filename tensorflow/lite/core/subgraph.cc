@@ -26,6 +26,7 @@ limitations under the License.
 #include <iterator>
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -39,9 +40,11 @@ limitations under the License.
 #include "tensorflow/lite/core/api/tensor_utils.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/inter_op_thread_pool.h"
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/experimental/remat/metadata_util.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/minimal_logging.h"
@@ -79,6 +82,10 @@ struct TfLiteSparsityDeleter {
 using ScopedTfLiteSparsity =
     std::unique_ptr<TfLiteSparsity, TfLiteSparsityDeleter>;
 
+// The CPU backend context of the inter-op worker thread that is running a node
+// of a concurrent group, or null on any other thread.
+thread_local TfLiteExternalContext* inter_op_cpu_backend_context = nullptr;
+
 TfLiteStatus ReportOpError(TfLiteContext* context, const TfLiteNode& node,
                            const TfLiteRegistration& registration,
                            int node_index, const char* message) {
@@ -243,6 +250,14 @@ class InterpreterInfo : public GraphInfo {
     return subgraph_->variables();
   }
 
+  size_t first_concurrent_node(size_t index) const override {
+    return subgraph_->first_concurrent_node(index);
+  }
+
+  size_t last_concurrent_node(size_t index) const override {
+    return subgraph_->last_concurrent_node(index);
+  }
+
  public:
   Subgraph* subgraph_;
 };
@@ -287,6 +302,8 @@ Subgraph::Subgraph(ErrorReporter* error_reporter,
 }
 
 Subgraph::~Subgraph() {
+  StopWeightPrefetch();
+
   for (int node_index = 0; node_index < nodes_and_registration_.size();
        ++node_index) {
     CleanupNode(node_index);
@@ -587,6 +604,9 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  if (type == kTfLiteCpuBackendContext && inter_op_cpu_backend_context) {
+    return inter_op_cpu_backend_context;
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -858,6 +878,9 @@ TfLiteStatus Subgraph::AllocateTensors() {
   // Restore delegation state if applicable.
   TF_LITE_ENSURE_STATUS(RedoAllDelegates());
 
+  // Regroup the nodes that can run concurrently if the plan changed.
+  TF_LITE_ENSURE_STATUS(ScheduleConcurrentNodes());
+
   // The runtime doesn't need to adjust any allocations if the state is
   // invokable & no inputs are dynamic (which implies memory plan is unchanged).
   const bool no_reallocations_necessary =
@@ -895,6 +918,17 @@ TfLiteStatus Subgraph::AllocateTensors() {
 
   TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
 
+  // Tensors of dynamic size are allocated one node at a time while invoking,
+  // which doesn't work for nodes that run concurrently. Fall back to running
+  // nodes one at a time until the execution plan changes.
+  if (!concurrent_group_first_.empty() && has_dynamic_tensors_) {
+    TF_LITE_ENSURE_STATUS(ClearConcurrentNodes());
+    next_execution_plan_index_to_prepare_ = 0;
+    next_execution_plan_index_to_plan_allocation_ = 0;
+    next_original_execution_plan_index_to_prepare_ = 0;
+    TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
+  }
+
   state_ = kStateInvokable;
 
   // Reset the variable tensors to zero after (re)allocating the tensors.
@@ -907,6 +941,8 @@ TfLiteStatus Subgraph::AllocateTensors() {
   // index that uses the tensor.
   InitializeTensorReleaseMap();
 
+  MaybeStartWeightPrefetch();
+
   // Temporary tensors allocated during Prepare for nodes which are subsequently
   // delegated are not required and can be freed.
   if (!pre_delegation_execution_plan_.empty()) {
@@ -1470,6 +1506,306 @@ TfLiteStatus Subgraph::RemoveUnusedInputs() {
   return kTfLiteOk;
 }
 
+void Subgraph::MaybeStartWeightPrefetch() {
+  if (weights_prefetch_started_ || !ShouldPrefetchWeightsInBackground()) {
+    return;
+  }
+  weights_prefetch_started_ = true;
+
+  // Collect the read-only buffers up front so the thread doesn't touch graph
+  // state, which may change while it runs. The buffers themselves belong to
+  // the model, which outlives the subgraph.
+  std::vector<std::pair<const char*, size_t>> buffers;
+  std::vector<bool> visited(tensors_.size(), false);
+  for (int node_index : execution_plan_) {
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index == kTfLiteOptionalTensor || visited[tensor_index]) {
+        continue;
+      }
+      visited[tensor_index] = true;
+      const TfLiteTensor& t = tensors_[tensor_index];
+      if (t.allocation_type == kTfLiteMmapRo && t.data.raw != nullptr &&
+          t.bytes > 0) {
+        buffers.emplace_back(t.data.raw_const, t.bytes);
+      }
+    }
+  }
+  if (buffers.empty()) return;
+
+  stop_weight_prefetch_ = false;
+  weight_prefetch_thread_ = std::thread([this, buffers = std::move(buffers)] {
+    // Touching one byte per page is enough to page it in; larger pages are
+    // simply touched more than once.
+    constexpr size_t kPageSize = 4096;
+    char sink = 0;
+    for (const auto& [data, bytes] : buffers) {
+      for (size_t offset = 0; offset < bytes; offset += kPageSize) {
+        if (stop_weight_prefetch_.load(std::memory_order_relaxed)) return;
+        sink ^= *static_cast<const volatile char*>(data + offset);
+      }
+      sink ^= *static_cast<const volatile char*>(data + bytes - 1);
+    }
+    (void)sink;
+  });
+}
+
+void Subgraph::StopWeightPrefetch() {
+  if (!weight_prefetch_thread_.joinable()) return;
+  stop_weight_prefetch_ = true;
+  weight_prefetch_thread_.join();
+}
+
+TfLiteStatus Subgraph::EnsureNodeInputsAreReadable(int node_index) {
+  const TfLiteNode& node = nodes_and_registration_[node_index].first;
+  const TfLiteRegistration& registration =
+      nodes_and_registration_[node_index].second;
+  for (int i = 0; i < node.inputs->size; ++i) {
+    int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) {
+      continue;
+    }
+    TfLiteTensor* tensor = &tensors_[tensor_index];
+    if (tensor->delegate && tensor->delegate != node.delegate &&
+        tensor->data_is_stale) {
+      TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+    }
+    if (tensor->data.raw == nullptr && tensor->bytes > 0) {
+      if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+          tensor->dims->size != 1) {
+        // In general, having a tensor here with no buffer will be an error.
+        // However, for the reshape operator, the second input tensor is
+        // sometimes only used for the shape, not for the data. Thus, null
+        // buffer is ok in this situation.
+        // The situation where null buffer is not ok for reshape operator is
+        // only when there are 2 inputs given to the node and the one
+        // corresponding to the shape (i == 1) is a vector that contains all
+        // dimensions. See `GetOutputShape()` function in
+        // `tensorflow/lite/kernels/reshape.cc`
+        continue;
+      } else {
+        // In all other cases, we need to return an error as otherwise we will
+        // trigger a null pointer dereference (likely).
+        ReportError("Input tensor %d lacks data", tensor_index);
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+bool Subgraph::MustRunSerially(int execution_plan_index) const {
+  const int node_index = execution_plan_[execution_plan_index];
+  const TfLiteNode& node = nodes_and_registration_[node_index].first;
+  const TfLiteRegistration& registration =
+      nodes_and_registration_[node_index].second;
+  // Delegate kernels and custom ops may share state between nodes, and control
+  // flow ops invoke other subgraphs.
+  if (node.delegate != nullptr || registration.registration_external) {
+    return true;
+  }
+  switch (registration.builtin_code) {
+    case kTfLiteBuiltinCustom:
+    case kTfLiteBuiltinDelegate:
+    case kTfLiteBuiltinWhile:
+    case kTfLiteBuiltinIf:
+    case kTfLiteBuiltinCallOnce:
+    case kTfLiteBuiltinVarHandle:
+    case kTfLiteBuiltinReadVariable:
+    case kTfLiteBuiltinAssignVariable:
+      return true;
+    default:
+      break;
+  }
+  // Ops on variable or resource tensors update state that other nodes read.
+  for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    const TfLiteTensor& tensor = tensors_[tensor_index];
+    if (tensor.is_variable || tensor.type == kTfLiteResource) return true;
+  }
+  return false;
+}
+
+TfLiteStatus Subgraph::ScheduleConcurrentNodes() {
+  const int num_threads = InterOpParallelism();
+  if (num_threads <= 1) {
+    concurrent_execution_plan_.clear();
+    if (!concurrent_group_first_.empty()) {
+      TF_LITE_ENSURE_STATUS(ClearConcurrentNodes());
+    }
+    return kTfLiteOk;
+  }
+  if (!execution_plan_.empty() &&
+      concurrent_execution_plan_ == execution_plan_) {
+    return kTfLiteOk;
+  }
+
+  // Assign levels in plan order: a node comes right after the latest of its
+  // producers and control dependencies. A node that must run serially gets a
+  // new level after all nodes seen so far, and all later nodes come after it.
+  const int num_nodes = static_cast<int>(execution_plan_.size());
+  std::vector<int> tensor_level(tensors_.size(), 0);
+  std::vector<int> node_level(nodes_and_registration_.size(), 0);
+  std::vector<int> plan_level(num_nodes, 0);
+  int barrier_level = 0;
+  int max_level = 0;
+  for (int i = 0; i < num_nodes; ++i) {
+    const int node_index = execution_plan_[i];
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    int level = barrier_level + 1;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      level = std::max(level, tensor_level[tensor_index] + 1);
+    }
+    if (control_edges_ != nullptr) {
+      for (const ControlEdge& edge : *control_edges_) {
+        if (edge.second == node_index && edge.first >= 0 &&
+            edge.first < static_cast<int>(node_level.size())) {
+          level = std::max(level, node_level[edge.first] + 1);
+        }
+      }
+    }
+    if (MustRunSerially(i)) {
+      level = max_level + 1;
+      barrier_level = level;
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      tensor_level[tensor_index] = level;
+    }
+    node_level[node_index] = level;
+    plan_level[i] = level;
+    max_level = std::max(max_level, level);
+  }
+
+  // Stably order the plan by level; each level makes up one group.
+  std::vector<int> order(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&plan_level](int a, int b) {
+    return plan_level[a] < plan_level[b];
+  });
+  std::vector<int> new_plan(num_nodes);
+  std::vector<size_t> group_first(num_nodes);
+  std::vector<size_t> group_last(num_nodes);
+  bool has_concurrent_nodes = false;
+  for (int i = 0; i < num_nodes; ++i) {
+    new_plan[i] = execution_plan_[order[i]];
+    const bool starts_group =
+        i == 0 || plan_level[order[i]] != plan_level[order[i - 1]];
+    group_first[i] = starts_group ? i : group_first[i - 1];
+    has_concurrent_nodes |= !starts_group;
+  }
+  for (int i = num_nodes - 1; i >= 0; --i) {
+    const bool ends_group =
+        i == num_nodes - 1 || group_first[i + 1] != static_cast<size_t>(i + 1);
+    group_last[i] = ends_group ? i : group_last[i + 1];
+  }
+  if (!has_concurrent_nodes) {
+    group_first.clear();
+    group_last.clear();
+  }
+
+  if (new_plan != execution_plan_ || group_first != concurrent_group_first_ ||
+      group_last != concurrent_group_last_) {
+    execution_plan_ = std::move(new_plan);
+    concurrent_group_first_ = std::move(group_first);
+    concurrent_group_last_ = std::move(group_last);
+    state_ = kStateUninvokable;
+    if (memory_planner_) {
+      TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+    }
+  }
+  concurrent_execution_plan_ = execution_plan_;
+
+  if (has_concurrent_nodes &&
+      (!inter_op_thread_pool_ ||
+       inter_op_thread_pool_->num_threads() != num_threads)) {
+    inter_op_thread_pool_ = std::make_unique<InterOpThreadPool>(num_threads);
+    inter_op_cpu_backend_contexts_.clear();
+    inter_op_cpu_backend_contexts_.resize(num_threads);
+    for (int thread = 1; thread < num_threads; ++thread) {
+      inter_op_cpu_backend_contexts_[thread] =
+          std::make_unique<ExternalCpuBackendContext>();
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::ClearConcurrentNodes() {
+  concurrent_group_first_.clear();
+  concurrent_group_last_.clear();
+  state_ = kStateUninvokable;
+  if (memory_planner_) {
+    TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::InvokeConcurrentNodes(int first_execution_plan_index,
+                                             int last_execution_plan_index) {
+  // Everything that may report errors or cancel the invocation is done on the
+  // invoking thread before any node of the group runs.
+  for (int i = first_execution_plan_index; i <= last_execution_plan_index;
+       ++i) {
+    const int node_index = execution_plan_[i];
+    TF_LITE_ENSURE_STATUS(EnsureNodeInputsAreReadable(node_index));
+    MayAllocateOpOutput(&nodes_and_registration_[node_index].first);
+  }
+
+  if (check_cancelled_func_ != nullptr &&
+      check_cancelled_func_(cancellation_data_)) {
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteError;
+  }
+
+  if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+    // `Cancel` is called and cancellation flag is flipped.
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteCancelled;
+  }
+
+  EnsureTensorsVectorCapacity();
+  tensor_resized_since_op_invoke_ = false;
+  const int num_nodes =
+      last_execution_plan_index - first_execution_plan_index + 1;
+  std::vector<TfLiteStatus> statuses(num_nodes, kTfLiteOk);
+  inter_op_thread_pool_->ParallelFor(num_nodes, [&](int task, int thread) {
+    const int node_index = execution_plan_[first_execution_plan_index + task];
+    auto& node_and_registration = nodes_and_registration_[node_index];
+    ExternalCpuBackendContext* cpu_backend_context =
+        inter_op_cpu_backend_contexts_[thread].get();
+    // Worker contexts aren't refreshed by `Interpreter::SetNumThreads`.
+    if (cpu_backend_context &&
+        cpu_backend_context->internal_backend_context() &&
+        context_.recommended_num_threads != -1) {
+      cpu_backend_context->internal_backend_context()->SetMaxNumThreads(
+          context_.recommended_num_threads);
+    }
+    inter_op_cpu_backend_context = cpu_backend_context;
+    statuses[task] =
+        OpInvoke(node_and_registration.second, &node_and_registration.first);
+    inter_op_cpu_backend_context = nullptr;
+  });
+
+  for (int task = 0; task < num_nodes; ++task) {
+    if (statuses[task] == kTfLiteOk) continue;
+    const int node_index = execution_plan_[first_execution_plan_index + task];
+    const auto& node_and_registration = nodes_and_registration_[node_index];
+    auto err =
+        ReportOpError(&context_, node_and_registration.first,
+                      node_and_registration.second, node_index,
+                      "failed to invoke");
+    return statuses[task] == kTfLiteCancelled ? statuses[task] : err;
+  }
+  for (int i = first_execution_plan_index; i <= last_execution_plan_index;
+       ++i) {
+    const int node_index = execution_plan_[i];
+    MaybeReleaseDynamicTensors(nodes_and_registration_[node_index].first,
+                               node_index);
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::Invoke() {
   auto status = InvokeImpl();
   telemetry::TelemetryReportEvent(&context_, "Invoke", status);
@@ -1506,6 +1842,19 @@ TfLiteStatus Subgraph::InvokeImpl() {
       TF_LITE_ENSURE(&context_, next_execution_plan_index_to_prepare_ >=
                                     execution_plan_index);
     }
+    // Nodes of a concurrent group run together once all of them are
+    // prepared. Profiled invocations keep running one node at a time so that
+    // per-op events don't overlap.
+    const int last_concurrent_index =
+        last_concurrent_node(execution_plan_index);
+    if (last_concurrent_index > execution_plan_index && !profiler_ &&
+        next_execution_plan_index_to_prepare_ > last_concurrent_index) {
+      TF_LITE_ENSURE_STATUS(
+          InvokeConcurrentNodes(execution_plan_index, last_concurrent_index));
+      execution_plan_index = last_concurrent_index;
+      continue;
+    }
+
     int node_index = execution_plan_[execution_plan_index];
     TfLiteNode& node = nodes_and_registration_[node_index].first;
     const TfLiteRegistration& registration =
@@ -1529,37 +1878,7 @@ TfLiteStatus Subgraph::InvokeImpl() {
     TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(
         profile_op ? profiler_.get() : nullptr, op_name, node_index);
 
-    for (int i = 0; i < node.inputs->size; ++i) {
-      int tensor_index = node.inputs->data[i];
-      if (tensor_index == kTfLiteOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor* tensor = &tensors_[tensor_index];
-      if (tensor->delegate && tensor->delegate != node.delegate &&
-          tensor->data_is_stale) {
-        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
-      }
-      if (tensor->data.raw == nullptr && tensor->bytes > 0) {
-        if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
-            tensor->dims->size != 1) {
-          // In general, having a tensor here with no buffer will be an error.
-          // However, for the reshape operator, the second input tensor is
-          // sometimes only used for the shape, not for the data. Thus, null
-          // buffer is ok in this situation.
-          // The situation where null buffer is not ok for reshape operator is
-          // only when there are 2 inputs given to the node and the one
-          // corresponding to the shape (i == 1) is a vector that contains all
-          // dimensions. See `GetOutputShape()` function in
-          // `tensorflow/lite/kernels/reshape.cc`
-          continue;
-        } else {
-          // In all other cases, we need to return an error as otherwise we will
-          // trigger a null pointer dereference (likely).
-          ReportError("Input tensor %d lacks data", tensor_index);
-          return kTfLiteError;
-        }
-      }
-    }
+    TF_LITE_ENSURE_STATUS(EnsureNodeInputsAreReadable(node_index));
     // Allocate dynamic tensors which memory is required to be allocated
     // before executing the node.
     MayAllocateOpOutput(&node);
@@ -2222,6 +2541,12 @@ void Subgraph::DumpMemoryPlannerDebugInfo() const {
   memory_planner_->DumpDebugInfo(execution_plan());
 }
 
+std::vector<ArenaTensorAllocation> Subgraph::GetArenaAllocations() const {
+  std::vector<ArenaTensorAllocation> allocs;
+  if (memory_planner_ != nullptr) memory_planner_->GetArenaAllocations(&allocs);
+  return allocs;
+}
+
 void Subgraph::GetMemoryAllocInfo(SubgraphAllocInfo* alloc_info) const {
   memset(alloc_info, 0, sizeof(SubgraphAllocInfo));
   if (memory_planner_ == nullptr) return;
@@ -25,6 +25,7 @@ limitations under the License.
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -34,9 +35,11 @@ limitations under the License.
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/inter_op_thread_pool.h"
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/memory_planner.h"
@@ -410,6 +413,11 @@ class Subgraph {
   // Returns memory allocation status.
   void GetMemoryAllocInfo(SubgraphAllocInfo* alloc_info) const;
 
+  // WARNING: This is an experimental API and subject to change.
+  // Returns the place of the arena allocated tensors in the memory arenas, as
+  // planned by the memory planner, see MemoryPlanner::GetArenaAllocations.
+  std::vector<ArenaTensorAllocation> GetArenaAllocations() const;
+
   // WARNING: This is an experimental API and subject to change.
   // Set the given `InterpreterOptions` object.
   void SetOptions(InterpreterOptions* options) { options_ = options; }
@@ -456,6 +464,35 @@ class Subgraph {
     return (options_ && options_->GetDisableDelegateClustering());
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // Number of threads that independent nodes of the execution plan run on, or
+  // 1 if nodes run one at a time.
+  int InterOpParallelism() const {
+    if (!options_ || options_->GetInterOpParallelism() < 1) return 1;
+    return options_->GetInterOpParallelism();
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // True if read-only tensors are paged in by a background thread, see
+  // `InterpreterOptions::SetPrefetchWeightsInBackground`.
+  bool ShouldPrefetchWeightsInBackground() const {
+    return (options_ && options_->GetPrefetchWeightsInBackground());
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // Returns the first and last execution plan indices of the group of nodes
+  // that run concurrently with the node at `execution_plan_index`.
+  size_t first_concurrent_node(size_t execution_plan_index) const {
+    return concurrent_group_first_.size() == execution_plan_.size()
+               ? concurrent_group_first_[execution_plan_index]
+               : execution_plan_index;
+  }
+  size_t last_concurrent_node(size_t execution_plan_index) const {
+    return concurrent_group_last_.size() == execution_plan_.size()
+               ? concurrent_group_last_[execution_plan_index]
+               : execution_plan_index;
+  }
+
   // Retrieves the corresponding TfLiteContext of a subgraph given a subgraph
   // index. If an invalid subgraph index is given, then returns nullptr.
   TfLiteContext* GetSubgraphContext(int subgraph_index);
@@ -577,6 +614,42 @@ class Subgraph {
   // to wait until Invoke() to resolve the sizes of dynamic tensors.
   TfLiteStatus PrepareOpsAndTensors();
 
+  // Groups the nodes of the execution plan that can run concurrently when
+  // `InterOpParallelism()` is greater than one. Nodes are assigned to levels
+  // so that every node comes after the producers of its inputs, and the plan
+  // is stably reordered by level; nodes of the same level form a group. Nodes
+  // with side effects get a level of their own. May reorder `execution_plan_`,
+  // in which case the memory plan is invalidated.
+  TfLiteStatus ScheduleConcurrentNodes();
+
+  // Drops the concurrent groups computed by `ScheduleConcurrentNodes` so that
+  // all nodes run one at a time, and invalidates the memory plan. The
+  // execution plan keeps its order.
+  TfLiteStatus ClearConcurrentNodes();
+
+  // True if the node at `execution_plan_index` may not run concurrently with
+  // any other node.
+  bool MustRunSerially(int execution_plan_index) const;
+
+  // Starts a thread reading every page of the read-only (e.g. memory-mapped)
+  // tensors in execution plan order, if enabled by
+  // `InterpreterOptions::SetPrefetchWeightsInBackground` and not already done.
+  // Invoking doesn't wait for the thread, so the first nodes run as soon as
+  // their own weights are paged in rather than after the whole model is.
+  void MaybeStartWeightPrefetch();
+
+  // Stops and joins the thread started by `MaybeStartWeightPrefetch`.
+  void StopWeightPrefetch();
+
+  // Makes sure that all inputs of the node at `node_index` are readable before
+  // it is invoked, and reports an error for inputs without a buffer.
+  TfLiteStatus EnsureNodeInputsAreReadable(int node_index);
+
+  // Invokes the nodes of the execution plan in [first, last] concurrently on
+  // `inter_op_thread_pool_`. All of them must already be prepared.
+  TfLiteStatus InvokeConcurrentNodes(int first_execution_plan_index,
+                                     int last_execution_plan_index);
+
   // Call OpPrepare() for all ops starting at 'first_node'. Stop when a
   // dynamic tensors is found or all ops have been prepared. Fill
   // 'last_node_prepared' with the id of the op containing dynamic tensors, or
@@ -1022,6 +1095,28 @@ class Subgraph {
   // metadata_ by appropriately parametrized SetMetadata method calls.
   const ControlEdges* control_edges_ = nullptr;
 
+  // The execution plan that concurrent groups were last computed for. Groups
+  // are recomputed by `AllocateTensors` whenever the plan changes.
+  std::vector<int> concurrent_execution_plan_;
+
+  // For every execution plan index, the first and last execution plan index
+  // of its concurrent group. Empty if nodes run one at a time.
+  std::vector<size_t> concurrent_group_first_;
+  std::vector<size_t> concurrent_group_last_;
+
+  // Threads that concurrent groups run on, and the CPU backend context of each
+  // of them. Contexts aren't thread-safe, so each worker has its own; the one
+  // at index 0, used by the invoking thread, is always null.
+  std::unique_ptr<InterOpThreadPool> inter_op_thread_pool_;
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      inter_op_cpu_backend_contexts_;
+
+  // Thread reading the read-only tensors ahead of execution, and the flag
+  // asking it to stop early. Weights are prefetched at most once.
+  std::thread weight_prefetch_thread_;
+  std::atomic<bool> stop_weight_prefetch_{false};
+  bool weights_prefetch_started_ = false;
+
   // Whether this subgraph is "delegation skippable". If a subgraph is
   // delegation-skippable, then the subgraph will be handled by a TfLiteDelegate
   // (and that the delegate is supposed to be already aware of this state), and
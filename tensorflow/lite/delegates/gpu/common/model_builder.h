@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/op_resolver.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/model.h"
+#include "tensorflow/lite/delegates/utils.h"
 #include "tensorflow/lite/delegates/gpu/common/model.h"
 #include "tensorflow/lite/delegates/gpu/common/shape.h"
 #include "tensorflow/lite/delegates/gpu/common/status.h"
@@ -37,10 +38,13 @@ namespace gpu {
 // consists of a subset of ops) to be replaced.
 // 'excluded_ops', if not null, specifies a set of ops that should not be
 // replaced with GPU kernels.
+// 'cost_model', if not null, leaves partitions on the CPU that it doesn't
+// consider faster on the GPU.
 TfLiteIntArray* GetOpsToReplace(
     TfLiteContext* context, bool allow_quant_ops = false,
     int max_delegated_partitions = 1,
-    const absl::flat_hash_set<TfLiteBuiltinOperator>* excluded_ops = nullptr);
+    const absl::flat_hash_set<TfLiteBuiltinOperator>* excluded_ops = nullptr,
+    const delegates::PartitionCostModel* cost_model = nullptr);
 
 // Extracts TFLite delegate execution plan from the input TFLite context and
 // converts it into generic graph format.
@@ -53,6 +53,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/common/quantization_util.h"
 #include "tensorflow/lite/delegates/gpu/delegate_options.h"
 #include "tensorflow/lite/delegates/serialization.h"
+#include "tensorflow/lite/delegates/utils.h"
 
 #if defined(__ANDROID__)
 #include "tensorflow/lite/delegates/utils/async_type_helpers.h"
@@ -120,6 +121,39 @@ using delegates::Serialization;
 using delegates::SerializationParams;
 
 constexpr char kSerializedDataPrefix[] = "gpuv2_data_";
+// Part of every serialization key. Bump it whenever the layout of the
+// serialized InferenceContext changes, so that entries written by an older
+// delegate are simply missed instead of failing to decode.
+constexpr char kSerializedDataVersion[] = "v1_";
+
+// Derives a model token from the operators and the constant tensors of the
+// delegated partition. Used when serialization is enabled without an explicit
+// model_token, so that two models with the same structure but different
+// weights never share cache entries.
+std::string ComputeModelToken(TfLiteContext* context,
+                              const TfLiteDelegateParams* delegate_params) {
+  std::string token_data;
+  const TfLiteIntArray* nodes = delegate_params->nodes_to_replace;
+  for (int i = 0; i < nodes->size; ++i) {
+    TfLiteNode* node;
+    TfLiteRegistration* registration;
+    if (context->GetNodeAndRegistration(context, nodes->data[i], &node,
+                                        &registration) != kTfLiteOk) {
+      continue;
+    }
+    token_data += std::to_string(registration->builtin_code) + ":";
+    for (int j = 0; j < node->inputs->size; ++j) {
+      const int tensor_index = node->inputs->data[j];
+      if (tensor_index < 0) continue;
+      const TfLiteTensor& tensor = context->tensors[tensor_index];
+      if (tensor.allocation_type != kTfLiteMmapRo) continue;
+      token_data +=
+          delegates::StrFingerprint(tensor.data.raw_const, tensor.bytes) + ",";
+    }
+  }
+  return "auto_" +
+         delegates::StrFingerprint(token_data.data(), token_data.size());
+}
 
 #if defined(__ANDROID__)
 // Xeno API does not impose alignment or padding requirements.
@@ -185,11 +219,17 @@ class Delegate {
       serialization_ = std::make_unique<Serialization>(params);
       telemetry_settings_ =
           std::make_unique<TfLiteTelemetryGpuDelegateSettings>();
+    } else if (options_.experimental_flags &
+                   TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION &&
+               options_.serialization_dir) {
+      // The model token is derived per partition, see ComputeModelToken.
+      derive_model_token_ = true;
     }
   }
 
   TfLiteDelegate* tflite_delegate() { return &delegate_; }
   Serialization* serialization() { return serialization_.get(); }
+  bool derive_model_token() const { return derive_model_token_; }
   const TfLiteGpuDelegateOptionsV2& options() const { return options_; }
   bool async() const { return async_; }
 
@@ -200,6 +240,13 @@ class Delegate {
   int MaxDelegatedPartitions() const {
     return options_.max_delegated_partitions;
   }
+  // Returns the partition cost model, or nullptr if it isn't enabled.
+  const delegates::PartitionCostModel* partition_cost_model() const {
+    return (options_.experimental_flags &
+            TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_PARTITION_COST_MODEL)
+               ? &partition_cost_model_
+               : nullptr;
+  }
   int num_delegate_kernels() const { return num_delegate_kernels_; }
   TfLiteTelemetryGpuDelegateSettings* telemetry_settings() {
     return telemetry_settings_.get();
@@ -211,6 +258,10 @@ class Delegate {
   std::atomic<int> num_delegate_kernels_ = 0;
 
   std::unique_ptr<Serialization> serialization_;
+  // Serialization was requested without a model token.
+  bool derive_model_token_ = false;
+
+  delegates::PartitionCostModel partition_cost_model_;
 
   std::unique_ptr<TfLiteTelemetryGpuDelegateSettings> telemetry_settings_;
 
@@ -395,6 +446,17 @@ absl::Status DelegateKernelCore::Setup(
   RETURN_IF_ERROR(InitializeGraph(context, delegate_params, &graph, &input_refs,
                                   &output_refs));
 
+  Serialization* serialization = delegate_->serialization();
+  std::unique_ptr<Serialization> derived_serialization;
+  if (!serialization && delegate_->derive_model_token()) {
+    const std::string model_token = ComputeModelToken(context, delegate_params);
+    SerializationParams params;
+    params.model_token = model_token.c_str();
+    params.cache_dir = delegate_->options().serialization_dir;
+    derived_serialization = std::make_unique<Serialization>(params);
+    serialization = derived_serialization.get();
+  }
+
   std::unique_ptr<InferenceBuilder> builder;
   bool graph_is_destroyed;
   bool backend_opencl = false;
@@ -402,7 +464,7 @@ absl::Status DelegateKernelCore::Setup(
   if (experimental_flags & TFLITE_GPU_EXPERIMENTAL_FLAGS_CL_ONLY) {
     RETURN_IF_ERROR(InitializeOpenClApi(&graph, &builder, &graph_is_destroyed,
                                         context, delegate_params,
-                                        delegate_->serialization()));
+                                        serialization));
     backend_opencl = true;
   } else if (experimental_flags & TFLITE_GPU_EXPERIMENTAL_FLAGS_GL_ONLY) {
     if (delegate_->async()) {
@@ -415,7 +477,7 @@ absl::Status DelegateKernelCore::Setup(
     // By default, we try CL first & fall back to GL if that fails.
     absl::Status status =
         InitializeOpenClApi(&graph, &builder, &graph_is_destroyed, context,
-                            delegate_params, delegate_->serialization());
+                            delegate_params, serialization);
     if (!status.ok()) {
       TF_LITE_KERNEL_LOG(context, std::string(status.message()).c_str());
       TF_LITE_KERNEL_LOG(context, "Falling back to OpenGL");
@@ -574,8 +636,9 @@ absl::Status DelegateKernelCore::MaybeInitializeSerializedOpenCL(
   std::string options_fingerprint =
       delegates::StrFingerprint(options, sizeof(cl::InferenceOptions));
   auto data_key = serialization->GetEntryForKernel(
-      std::string(kSerializedDataPrefix) + options_fingerprint, context,
-      delegate_params);
+      std::string(kSerializedDataPrefix) + kSerializedDataVersion +
+          options_fingerprint,
+      context, delegate_params);
 
   std::string model_data;
   auto model_data_status = data_key.GetData(context, &model_data);
@@ -605,8 +668,9 @@ absl::Status DelegateKernelCore::SaveSerializedOpenCL(
 
   // Save data.
   auto data_key = serialization->GetEntryForKernel(
-      std::string(kSerializedDataPrefix) + options_fingerprint, context,
-      delegate_params);
+      std::string(kSerializedDataPrefix) + kSerializedDataVersion +
+          options_fingerprint,
+      context, delegate_params);
   auto save_status = data_key.SetData(
       context, reinterpret_cast<const char*>(serialized_model.data()),
       serialized_model.size());
@@ -1485,7 +1549,8 @@ TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
   }
   TfLiteIntArray* ops_to_replace =
       GetOpsToReplace(context, gpu_delegate->IsQuantOpsAllowed(),
-                      gpu_delegate->MaxDelegatedPartitions(), &excluded_ops);
+                      gpu_delegate->MaxDelegatedPartitions(), &excluded_ops,
+                      gpu_delegate->partition_cost_model());
   const auto status = context->ReplaceNodeSubsetsWithDelegateKernels(
       context, kRegistration, ops_to_replace, delegate);
   TFLITE_LOG_PROD(TFLITE_LOG_INFO, "Created %d GPU delegate kernels.",
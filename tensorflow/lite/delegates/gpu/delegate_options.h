@@ -67,10 +67,20 @@ enum TfLiteGpuExperimentalFlags {
   // model or inference params. Later initializations are fast.
   // ModifyGraphWithDelegate will fail if data cannot be serialized.
   //
-  // NOTE: User also needs to set serialization_dir & model_token in
-  // TfLiteGpuDelegateOptionsV2.
+  // The serialized data contains the compiled OpenCL programs and the tuned
+  // work group sizes. It is versioned, tied to the OpenCL driver version and
+  // rebuilt automatically when either changes. Concurrent writers, in the same
+  // or in different processes, never corrupt an entry.
+  //
+  // NOTE: User also needs to set serialization_dir in
+  // TfLiteGpuDelegateOptionsV2. model_token is optional, see below.
   // Currently works only if CL backend is used.
   TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION = 1 << 3,
+  // Only delegates partitions that are estimated to run faster on the GPU than
+  // on the CPU, including the cost of copying their inputs and outputs. Small
+  // partitions of cheap ops are left on the CPU. See
+  // tflite::delegates::PartitionCostModel.
+  TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_PARTITION_COST_MODEL = 1 << 4,
 };
 
 // IMPORTANT: Always use TfLiteGpuDelegateOptionsV2Default() method to create
@@ -133,8 +143,11 @@ typedef struct {
   // For an example of how to generate this from a TFLite model, see
   // StrFingerprint() in lite/delegates/serialization.h.
   //
-  // Set to nullptr in TfLiteGpuDelegateOptionsV2Default(), which implies the
-  // delegate will not try serialization.
+  // Set to nullptr in TfLiteGpuDelegateOptionsV2Default(). If serialization
+  // is enabled with a serialization_dir but no model_token, the delegate
+  // derives a token from the operators and constant tensors it delegates.
+  // That costs a pass over the weights at every initialization, so prefer
+  // passing a token when one is readily available.
   const char* model_token;
 } TfLiteGpuDelegateOptionsV2;
 
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/hexagon/hexagon_delegate_kernel.h"
 #include "tensorflow/lite/delegates/hexagon/hexagon_implementation.h"
 #include "tensorflow/lite/delegates/hexagon/utils.h"
+#include "tensorflow/lite/delegates/utils.h"
 #include "tensorflow/lite/delegates/utils/simple_delegate.h"
 #include "tensorflow/lite/minimal_logging.h"
 
@@ -72,6 +73,9 @@ class HexagonDelegate : public SimpleDelegateInterface {
     auto options = SimpleDelegateInterface::Options();
     options.max_delegated_partitions = params_.max_delegated_partitions;
     options.min_nodes_per_partition = params_.min_nodes_per_partition;
+    if (params_.enable_partition_cost_model) {
+      options.partition_cost_model = &partition_cost_model_;
+    }
     return options;
   }
 
@@ -110,6 +114,7 @@ class HexagonDelegate : public SimpleDelegateInterface {
 
  private:
   TfLiteHexagonDelegateOptions params_;
+  delegates::PartitionCostModel partition_cost_model_;
 };
 
 }  // namespace
@@ -88,6 +88,12 @@ struct TFL_CAPI_EXPORT TfLiteHexagonDelegateOptions {
   // should be -1. Delegate will take ownership of the pointer. WARNING:
   // Experimental and subject to change anytime.
   TfLiteIntArray* output_batch_dimensions;
+
+  // If set to true, only partitions that are estimated to run faster on the
+  // DSP than on the CPU, including the cost of copying their inputs and
+  // outputs, are delegated. See tflite::delegates::PartitionCostModel.
+  // WARNING: Experimental and subject to change anytime.
+  bool enable_partition_cost_model;
 };
 
 // Return a delegate that uses Hexagon SDK for ops execution.
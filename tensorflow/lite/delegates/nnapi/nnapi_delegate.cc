@@ -28,6 +28,7 @@ limitations under the License.
 #include <limits>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -6453,6 +6454,7 @@ void StatefulNnApiDelegate::StatefulNnApiDelegateConstructorImpl(
   delegate_data_.tensor_max_size_hints = options.tensor_max_size_hints;
   delegate_data_.disable_debugging_diagnostics_callbacks =
       options.disable_debugging_diagnostics_callbacks;
+  delegate_data_.partition_cost_model = options.partition_cost_model;
 
   TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_INFO,
                        "Created TensorFlow Lite delegate for NNAPI.");
@@ -6527,6 +6529,7 @@ const StatefulNnApiDelegate::Options StatefulNnApiDelegate::GetOptions(
   options.tensor_max_size_hints = delegate_data->tensor_max_size_hints;
   options.disable_debugging_diagnostics_callbacks =
       delegate_data->disable_debugging_diagnostics_callbacks;
+  options.partition_cost_model = delegate_data->partition_cost_model;
   return options;
 }
 
@@ -6964,11 +6967,34 @@ TfLiteStatus StatefulNnApiDelegate::DoPrepare(TfLiteContext* context,
     return kTfLiteOk;
   }
 
+  std::vector<TfLiteDelegateParams> partitions(params_array,
+                                               params_array + num_partitions);
+  if (delegate_options.partition_cost_model != nullptr) {
+    // Partitions that are estimated to run faster on the CPU stay there.
+    std::vector<TfLiteDelegateParams> profitable_partitions;
+    std::set<int> unprofitable_nodes;
+    for (const TfLiteDelegateParams& partition : partitions) {
+      if (delegate_options.partition_cost_model->IsProfitable(context,
+                                                              partition)) {
+        profitable_partitions.push_back(partition);
+      } else {
+        unprofitable_nodes.insert(partition.nodes_to_replace->data,
+                                  partition.nodes_to_replace->data +
+                                      partition.nodes_to_replace->size);
+      }
+    }
+    nodes_to_delegate.erase(
+        std::remove_if(nodes_to_delegate.begin(), nodes_to_delegate.end(),
+                       [&unprofitable_nodes](int node_index) {
+                         return unprofitable_nodes.count(node_index) > 0;
+                       }),
+        nodes_to_delegate.end());
+    partitions = std::move(profitable_partitions);
+  }
+
   TF_LITE_ENSURE_STATUS(
       LimitDelegatedPartitions(delegate_options.max_number_delegated_partitions,
-                               std::vector<TfLiteDelegateParams>(
-                                   params_array, params_array + num_partitions),
-                               &nodes_to_delegate));
+                               std::move(partitions), &nodes_to_delegate));
 
   auto nodes_to_delegate_int_array = BuildTfLiteIntArray(nodes_to_delegate);
 
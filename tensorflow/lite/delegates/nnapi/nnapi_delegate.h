@@ -37,6 +37,10 @@ class NNAPIDelegateKernel;
 }  // namespace nnapi
 }  // namespace delegate
 
+namespace delegates {
+class PartitionCostModel;
+}  // namespace delegates
+
 using tflite::delegate::nnapi::NNAPIDelegateKernel;
 
 // TFliteDelegate to interface with NNAPI.
@@ -179,6 +183,12 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     // Use this in case different callbacks are being registered elsewhere, such
     // as for example to send logs through some logger.
     bool disable_debugging_diagnostics_callbacks = false;
+
+    // If set, partitions that the cost model doesn't consider faster on the
+    // NNAPI accelerator than on the CPU, including the cost of copying their
+    // inputs and outputs, are not delegated. It is the users responsibility
+    // to make sure that the cost model outlives the delegate instance.
+    const delegates::PartitionCostModel* partition_cost_model = nullptr;
   };
 
   // Uses default options.
@@ -370,6 +380,9 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     // as for example to send logs through some logger.
     bool disable_debugging_diagnostics_callbacks = false;
 
+    // Not owned. Copied from StatefulNnApiDelegate::Options.
+    const delegates::PartitionCostModel* partition_cost_model = nullptr;
+
     explicit Data(const NnApi* nnapi);
     explicit Data(std::unique_ptr<const NnApi> nnapi);
     ~Data();
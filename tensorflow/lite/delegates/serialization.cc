@@ -15,6 +15,8 @@ limitations under the License.
 #include "tensorflow/lite/delegates/serialization.h"
 
 #if defined(_WIN32)
+#include <process.h>
+
 #include <fstream>
 #include <iostream>
 #else
@@ -29,6 +31,7 @@ limitations under the License.
 #include <time.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -70,6 +73,22 @@ inline std::string GetFilePath(const std::string& cache_dir,
   return JoinPath(cache_dir, file_name);
 }
 
+// Returns a path next to `filepath` that no other writer uses concurrently,
+// whether it runs in this process or in another one. The process id and a
+// per-process counter keep the name unique, so that two writers never append
+// to the same temporary file before it is renamed into place.
+inline std::string GetTempFilePath(const std::string& filepath) {
+  static std::atomic<uint64_t> counter{0};
+#if defined(_WIN32)
+  const int pid = _getpid();
+#else
+  const int pid = getpid();
+#endif  // defined(_WIN32)
+  return filepath + "." + std::to_string(pid) + "." +
+         std::to_string(counter.fetch_add(1)) + "." +
+         std::to_string(time(nullptr)) + ".tmp";
+}
+
 }  // namespace
 
 std::string StrFingerprint(const void* data, const size_t num_bytes) {
@@ -89,9 +108,7 @@ TfLiteStatus SerializationEntry::SetData(TfLiteContext* context,
                                          const size_t size) const {
   auto filepath = GetFilePath(cache_dir_, model_token_, fingerprint_);
   // Temporary file to write data to.
-  const std::string temp_filepath =
-      JoinPath(cache_dir_, (model_token_ + std::to_string(fingerprint_) +
-                            std::to_string(time(nullptr))));
+  const std::string temp_filepath = GetTempFilePath(filepath);
 
 #if defined(_WIN32)
   std::ofstream out_file(temp_filepath.c_str());
@@ -103,15 +120,19 @@ TfLiteStatus SerializationEntry::SetData(TfLiteContext* context,
   out_file.write(data, size);
   out_file.flush();
   out_file.close();
-  // rename is an atomic operation in most systems.
+  // rename is an atomic operation in most systems, but unlike POSIX it does
+  // not replace an existing file on Windows.
+  remove(filepath.c_str());
   if (rename(temp_filepath.c_str(), filepath.c_str()) < 0) {
     TF_LITE_KERNEL_LOG(context, "Failed to rename to %s", filepath.c_str());
+    remove(temp_filepath.c_str());
     return kTfLiteDelegateDataWriteError;
   }
 #else   // !defined(_WIN32)
   // This method only works on unix/POSIX systems.
+  // O_EXCL guarantees that this writer owns the temporary file.
   const int fd = open(temp_filepath.c_str(),
-                      O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+                      O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
   if (fd < 0) {
     TF_LITE_KERNEL_LOG(context, "Failed to open for writing: %s",
                        temp_filepath.c_str());
@@ -121,11 +142,12 @@ TfLiteStatus SerializationEntry::SetData(TfLiteContext* context,
   ssize_t len = 0;
   const char* buf = data;
   do {
-    ssize_t ret = write(fd, buf, size);
+    ssize_t ret = write(fd, buf, size - len);
     if (ret <= 0) {
       close(fd);
       TF_LITE_KERNEL_LOG(context, "Failed to write data to: %s, error: %s",
                          temp_filepath.c_str(), std::strerror(errno));
+      unlink(temp_filepath.c_str());
       return kTfLiteDelegateDataWriteError;
     }
 
@@ -137,16 +159,19 @@ TfLiteStatus SerializationEntry::SetData(TfLiteContext* context,
     close(fd);
     TF_LITE_KERNEL_LOG(context, "Could not fsync: %s, error: %s",
                        temp_filepath.c_str(), std::strerror(errno));
+    unlink(temp_filepath.c_str());
     return kTfLiteDelegateDataWriteError;
   }
   if (close(fd) < 0) {
     TF_LITE_KERNEL_LOG(context, "Could not close fd: %s, error: %s",
                        temp_filepath.c_str(), std::strerror(errno));
+    unlink(temp_filepath.c_str());
     return kTfLiteDelegateDataWriteError;
   }
   if (rename(temp_filepath.c_str(), filepath.c_str()) < 0) {
     TF_LITE_KERNEL_LOG(context, "Failed to rename to %s, error: %s",
                        filepath.c_str(), std::strerror(errno));
+    unlink(temp_filepath.c_str());
     return kTfLiteDelegateDataWriteError;
   }
 #endif  // defined(_WIN32)
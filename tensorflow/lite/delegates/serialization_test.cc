@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <cstdint>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -310,6 +311,49 @@ TEST_F(SerializationTest, SerializationData) {
   }
 }
 
+TEST_F(SerializationTest, ConcurrentWritersDoNotCorruptData) {
+  std::string model_token = "concurrent_model";
+  std::string test_dir = getSerializationDir();
+  SerializationParams serialization_params = {model_token.c_str(),
+                                              test_dir.c_str()};
+  TfLiteContext context = GenerateTfLiteContext(/*num_tensors*/ 30);
+  TfLiteDelegateParams partition = GenerateTfLiteDelegateParams(
+      /*num_nodes=*/2, /*num_input_tensors=*/3, /*num_output_tensors=*/1);
+
+  // Every writer stores a payload of a different size and content under the
+  // same entry. Whatever ends up on disk has to be one of them, intact.
+  constexpr int kNumWriters = 8;
+  std::vector<std::string> payloads;
+  for (int i = 0; i < kNumWriters; ++i) {
+    payloads.push_back(std::string(1000 + i * 357, 'a' + i));
+  }
+  std::vector<std::thread> writers;
+  for (int i = 0; i < kNumWriters; ++i) {
+    writers.emplace_back([&, i]() {
+      Serialization serialization(serialization_params);
+      auto entry =
+          serialization.GetEntryForKernel("concurrent", &context, &partition);
+      for (int iteration = 0; iteration < 10; ++iteration) {
+        EXPECT_EQ(entry.SetData(&context, payloads[i].data(),
+                                payloads[i].size()),
+                  kTfLiteOk);
+      }
+    });
+  }
+  for (auto& writer : writers) writer.join();
+
+  Serialization serialization(serialization_params);
+  auto entry =
+      serialization.GetEntryForKernel("concurrent", &context, &partition);
+  std::string read_back;
+  ASSERT_EQ(entry.GetData(&context, &read_back), kTfLiteOk);
+  ASSERT_FALSE(read_back.empty());
+  const int writer = read_back[0] - 'a';
+  ASSERT_GE(writer, 0);
+  ASSERT_LT(writer, kNumWriters);
+  EXPECT_EQ(read_back, payloads[writer]);
+}
+
 TEST_F(SerializationTest, CachingDelegatedNodes) {
   std::string model_token = "model1";
   std::string test_dir = getSerializationDir();
@@ -18,7 +18,9 @@ limitations under the License.
 #include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <fstream>
 #include <set>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -87,6 +89,114 @@ TfLiteStatus GraphPartitionHelper::PartitionImpl(
   return kTfLiteOk;
 }
 
+bool PartitionCostModel::LoadMeasuredCpuLatencies(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) return false;
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream stream(line);
+    int node_index;
+    char separator;
+    double latency_us;
+    if (!(stream >> node_index >> separator >> latency_us) ||
+        separator != ',') {
+      return false;
+    }
+    SetMeasuredCpuLatency(node_index, latency_us);
+  }
+  return true;
+}
+
+double PartitionCostModel::EstimateOps(TfLiteContext* context,
+                                       int node_index) const {
+  TfLiteNode* node;
+  TfLiteRegistration* registration;
+  if (context->GetNodeAndRegistration(context, node_index, &node,
+                                      &registration) != kTfLiteOk) {
+    return 0.0;
+  }
+  double num_outputs = 0.0;
+  for (int tensor_index : TfLiteIntArrayView(node->outputs)) {
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    num_outputs += NumElements(&context->tensors[tensor_index]);
+  }
+  const TfLiteTensor* filter = nullptr;
+  if (node->inputs->size > 1 &&
+      node->inputs->data[1] != kTfLiteOptionalTensor) {
+    filter = &context->tensors[node->inputs->data[1]];
+  }
+  // Number of multiply-accumulates per output element.
+  double ops_per_output = 1.0;
+  switch (registration->builtin_code) {
+    case kTfLiteBuiltinConv2d:
+    case kTfLiteBuiltinFullyConnected:
+      // Filters are laid out as [output_channels, ...].
+      if (filter != nullptr && NumDimensions(filter) > 0 &&
+          SizeOfDimension(filter, 0) > 0) {
+        ops_per_output = static_cast<double>(NumElements(filter)) /
+                         SizeOfDimension(filter, 0);
+      }
+      break;
+    case kTfLiteBuiltinDepthwiseConv2d:
+      // Filters are laid out as [1, height, width, output_channels].
+      if (filter != nullptr && NumDimensions(filter) == 4) {
+        ops_per_output = static_cast<double>(SizeOfDimension(filter, 1)) *
+                         SizeOfDimension(filter, 2);
+      }
+      break;
+    case kTfLiteBuiltinBatchMatmul: {
+      // The reduction dimension, ignoring adj_x.
+      const TfLiteTensor* lhs = &context->tensors[node->inputs->data[0]];
+      if (NumDimensions(lhs) > 0) {
+        ops_per_output = SizeOfDimension(lhs, NumDimensions(lhs) - 1);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  return num_outputs * ops_per_output;
+}
+
+PartitionCostModel::Cost PartitionCostModel::EstimateCost(
+    TfLiteContext* context, const TfLiteDelegateParams& partition) const {
+  Cost cost;
+  for (int node_index : TfLiteIntArrayView(partition.nodes_to_replace)) {
+    const auto it = measured_cpu_us_.find(node_index);
+    // Measured latencies carry over to the delegate at the ratio of the two
+    // throughputs.
+    const double ops = it != measured_cpu_us_.end()
+                           ? it->second * options_.cpu_ops_per_us
+                           : EstimateOps(context, node_index);
+    cost.cpu_us += ops / options_.cpu_ops_per_us;
+    cost.delegate_us += ops / options_.delegate_ops_per_us;
+  }
+  cost.delegate_us += options_.partition_overhead_us;
+
+  // Constant tensors are uploaded once when the delegate kernel is prepared,
+  // so only the runtime inputs and outputs of the partition are copied.
+  double num_bytes = 0.0;
+  for (const TfLiteIntArray* tensors :
+       {partition.input_tensors, partition.output_tensors}) {
+    if (tensors == nullptr) continue;
+    for (int tensor_index : TfLiteIntArrayView(tensors)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = context->tensors[tensor_index];
+      if (tensor.allocation_type == kTfLiteMmapRo) continue;
+      num_bytes += tensor.bytes;
+    }
+  }
+  cost.transfer_us = num_bytes / options_.transfer_bytes_per_us;
+  return cost;
+}
+
+bool PartitionCostModel::IsProfitable(
+    TfLiteContext* context, const TfLiteDelegateParams& partition) const {
+  const Cost cost = EstimateCost(context, partition);
+  return cost.delegate_us + cost.transfer_us < cost.cpu_us;
+}
+
 std::vector<TfLiteDelegateParams*>
 GraphPartitionHelper::GetFirstNLargestPartitions(
     int n, int min_nodes_per_partition) const {
@@ -103,13 +213,14 @@ GraphPartitionHelper::GetFirstNLargestPartitions(
             });
 
   std::vector<TfLiteDelegateParams*> results;
-  auto p_it = sorted_partitions.begin();
-  const int total = sorted_partitions.size();
-  for (int i = 0; i < std::min(total, n); ++i, ++p_it) {
-    auto* p = (*p_it);
+  for (auto* p : sorted_partitions) {
+    if (static_cast<int>(results.size()) >= n) break;
     if (p->nodes_to_replace->size < min_nodes_per_partition) {
       break;
     }
+    if (cost_model_ != nullptr && !cost_model_->IsProfitable(context_, *p)) {
+      continue;
+    }
     results.push_back(p);
   }
   return results;
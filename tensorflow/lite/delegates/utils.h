@@ -64,6 +64,68 @@ using IsNodeSupportedFn =
     std::function<bool(TfLiteContext*, TfLiteNode*, TfLiteRegistration*,
                        std::string* unsupported_details)>;
 
+// Estimates whether running a partition on a delegate is faster than leaving
+// it on the CPU, once the copies of its boundary tensors between CPU and
+// delegate memory are accounted for. Delegating every supported node greedily
+// often makes small partitions slower than the CPU.
+//
+// The compute cost of a node is its number of multiply-accumulates for
+// convolutions and matrix multiplications, and its number of output elements
+// otherwise. Node latencies measured on the CPU in a calibration run, e.g.
+// with the op profiler of the benchmark tool, replace the estimate for the
+// nodes they cover.
+class PartitionCostModel {
+ public:
+  struct Options {
+    // Sustained CPU throughput, in operations per microsecond.
+    double cpu_ops_per_us = 2000.0;
+    // Sustained delegate throughput, in operations per microsecond.
+    double delegate_ops_per_us = 10000.0;
+    // Bandwidth of a copy between CPU and delegate memory, in bytes per
+    // microsecond.
+    double transfer_bytes_per_us = 2000.0;
+    // Fixed cost of invoking one delegate kernel, in microseconds.
+    double partition_overhead_us = 50.0;
+  };
+
+  // Estimated latencies of a partition, in microseconds.
+  struct Cost {
+    double cpu_us = 0.0;
+    double delegate_us = 0.0;
+    double transfer_us = 0.0;
+  };
+
+  PartitionCostModel() = default;
+  explicit PartitionCostModel(const Options& options) : options_(options) {}
+
+  const Options& options() const { return options_; }
+
+  // Records the CPU latency of 'node_index' measured in a calibration run.
+  void SetMeasuredCpuLatency(int node_index, double latency_us) {
+    measured_cpu_us_[node_index] = latency_us;
+  }
+
+  // Reads measured CPU latencies from 'path', one "node_index,latency_us" pair
+  // per line. Empty lines and lines starting with '#' are ignored. Returns
+  // false if the file cannot be read or a line is malformed.
+  bool LoadMeasuredCpuLatencies(const std::string& path);
+
+  Cost EstimateCost(TfLiteContext* context,
+                    const TfLiteDelegateParams& partition) const;
+
+  // Returns true if delegating 'partition' is estimated to be faster than
+  // running it on the CPU.
+  bool IsProfitable(TfLiteContext* context,
+                    const TfLiteDelegateParams& partition) const;
+
+ private:
+  // Returns the estimated number of operations of 'node_index'.
+  double EstimateOps(TfLiteContext* context, int node_index) const;
+
+  Options options_;
+  std::unordered_map<int, double> measured_cpu_us_;
+};
+
 // A utility class to help model graph parition.
 // Note the class *needs* to be used in TfLiteDelegate::Prepare.
 class GraphPartitionHelper {
@@ -110,6 +172,7 @@ class GraphPartitionHelper {
 
   // Returns the first n largest partitions or all if #partitions is less than
   // 'n' and each parition has at least (>=) 'min_nodes_per_partition' nodes.
+  // Partitions rejected by the partition cost model, if any, are skipped.
   // Note that partitions are ranked according to the number of nodes that
   // a partition has, and the returned TfLiteDelegateParams objects are *owned*
   // by the TfLite runtime.
@@ -132,6 +195,13 @@ class GraphPartitionHelper {
   int num_supported_nodes() const { return num_supported_nodes_; }
   int num_partitions() const { return partitions_.size(); }
 
+  // If set, partitions that 'cost_model' doesn't consider profitable are
+  // skipped when selecting the largest partitions, and stay on the CPU. The
+  // model is not owned and must outlive this helper.
+  void set_partition_cost_model(const PartitionCostModel* cost_model) {
+    cost_model_ = cost_model;
+  }
+
  protected:
   virtual bool IsNodeSupported(TfLiteContext* context, TfLiteNode* node,
                                TfLiteRegistration* registration, int node_id,
@@ -156,6 +226,8 @@ class GraphPartitionHelper {
   // PrepareSupportedNodes
   TfLiteIntArray* original_execution_plan_ = nullptr;
 
+  const PartitionCostModel* cost_model_ = nullptr;
+
  private:
   // Generate a list of supported nodes (i.e. populating 'supported_nodes_') by
   // iterating over all nodes (i,e. those listed in the execution_plan
@@ -93,6 +93,7 @@ TfLiteStatus DelegatePrepare(TfLiteContext* context,
   };
   // TODO(b/149484598): Update to have method that gets all supported nodes.
   delegates::GraphPartitionHelper helper(context, node_supported_fn);
+  helper.set_partition_cost_model(delegate_options.partition_cost_model);
   TF_LITE_ENSURE_STATUS(helper.Partition(nullptr));
 
   std::vector<int> supported_nodes = helper.GetNodesOfFirstNLargestPartitions(
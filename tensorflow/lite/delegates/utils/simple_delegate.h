@@ -35,6 +35,10 @@ limitations under the License.
 
 namespace tflite {
 
+namespace delegates {
+class PartitionCostModel;
+}  // namespace delegates
+
 using TfLiteDelegateUniquePtr =
     std::unique_ptr<TfLiteDelegate, void (*)(TfLiteDelegate*)>;
 
@@ -83,6 +87,11 @@ class SimpleDelegateInterface {
     // The minimum number of nodes allowed in a delegated graph, values <=0
     // means unlimited.
     int min_nodes_per_partition = 0;
+
+    // If set, partitions that the cost model doesn't consider faster on the
+    // delegate than on the CPU are not delegated. Not owned, and must outlive
+    // the call to TfLiteDelegate::Prepare.
+    const delegates::PartitionCostModel* partition_cost_model = nullptr;
   };
 
   virtual ~SimpleDelegateInterface() {}
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/delegates/utils.h"
 
+#include <fstream>
 #include <memory>
 #include <string>
 #include <utility>
@@ -22,8 +23,10 @@ limitations under the License.
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/memory/memory.h"
+#include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
 
 namespace tflite {
 namespace delegates {
@@ -291,6 +294,177 @@ TEST(GraphPartitionHelper, CheckPartitionsWithSupportedNodeList) {
   EXPECT_THAT(nodes, testing::ElementsAreArray({0, 3, 7, 8, 2, 4, 9}));
 }
 
+// A mock TfLiteContext with a large FULLY_CONNECTED node (0) and a small ADD
+// node (1) consuming its output, each in its own partition.
+class CostModelTestContext : public TfLiteContext {
+ public:
+  CostModelTestContext() : TfLiteContext({0}), tensors_(4) {
+    // 0: input, 1: constant weights, 2: FULLY_CONNECTED output, 3: ADD output.
+    SetTensor(0, {1, 1024}, kTfLiteArenaRw);
+    SetTensor(1, {1024, 1024}, kTfLiteMmapRo);
+    SetTensor(2, {1, 1024}, kTfLiteArenaRw);
+    SetTensor(3, {1, 1024}, kTfLiteArenaRw);
+    this->tensors = tensors_.data();
+    this->tensors_size = tensors_.size();
+
+    nodes_[0].inputs = ConvertVectorToTfLiteIntArray({0, 1});
+    nodes_[0].outputs = ConvertVectorToTfLiteIntArray({2});
+    registrations_[0].builtin_code = kTfLiteBuiltinFullyConnected;
+    nodes_[1].inputs = ConvertVectorToTfLiteIntArray({2, 2});
+    nodes_[1].outputs = ConvertVectorToTfLiteIntArray({3});
+    registrations_[1].builtin_code = kTfLiteBuiltinAdd;
+    exec_plan_ = ConvertVectorToTfLiteIntArray({0, 1});
+
+    for (int i = 0; i < 2; ++i) {
+      TfLiteDelegateParams params({nullptr});
+      params.nodes_to_replace = ConvertVectorToTfLiteIntArray({i});
+      params.input_tensors =
+          ConvertVectorToTfLiteIntArray(i == 0 ? std::vector<int>{0, 1}
+                                               : std::vector<int>{2});
+      params.output_tensors = ConvertVectorToTfLiteIntArray({i + 2});
+      delegate_params_.push_back(params);
+    }
+
+    this->GetExecutionPlan = MockGetExecutionPlan;
+    this->GetNodeAndRegistration = MockGetNodeAndRegistration;
+    this->PreviewDelegatePartitioning = MockPreviewDelegatePartitioning;
+  }
+  ~CostModelTestContext() {
+    for (auto& tensor : tensors_) TfLiteIntArrayFree(tensor.dims);
+    for (auto& node : nodes_) {
+      TfLiteIntArrayFree(node.inputs);
+      TfLiteIntArrayFree(node.outputs);
+    }
+    TfLiteIntArrayFree(exec_plan_);
+    for (auto& params : delegate_params_) {
+      TfLiteIntArrayFree(params.nodes_to_replace);
+      TfLiteIntArrayFree(params.input_tensors);
+      TfLiteIntArrayFree(params.output_tensors);
+    }
+  }
+
+  const TfLiteDelegateParams& fully_connected_partition() const {
+    return delegate_params_[0];
+  }
+  const TfLiteDelegateParams& add_partition() const {
+    return delegate_params_[1];
+  }
+
+ private:
+  void SetTensor(int index, const std::vector<int>& shape,
+                 TfLiteAllocationType allocation_type) {
+    TfLiteTensor& tensor = tensors_[index];
+    tensor.type = kTfLiteFloat32;
+    tensor.dims = ConvertVectorToTfLiteIntArray(shape);
+    tensor.bytes = NumElements(tensor.dims) * sizeof(float);
+    tensor.allocation_type = allocation_type;
+  }
+
+  static TfLiteStatus MockGetExecutionPlan(TfLiteContext* context,
+                                           TfLiteIntArray** execution_plan) {
+    auto* mock = static_cast<CostModelTestContext*>(context);
+    *execution_plan = mock->exec_plan_;
+    return kTfLiteOk;
+  }
+
+  static TfLiteStatus MockGetNodeAndRegistration(
+      TfLiteContext* context, int node_index, TfLiteNode** node,
+      TfLiteRegistration** registration) {
+    auto* mock = static_cast<CostModelTestContext*>(context);
+    *node = &mock->nodes_[node_index];
+    *registration = &mock->registrations_[node_index];
+    return kTfLiteOk;
+  }
+
+  static TfLiteStatus MockPreviewDelegatePartitioning(
+      TfLiteContext* context, const TfLiteIntArray* nodes_to_replace,
+      TfLiteDelegateParams** partition_params_array, int* num_partitions) {
+    auto* mock = static_cast<CostModelTestContext*>(context);
+    *partition_params_array = mock->delegate_params_.data();
+    *num_partitions = mock->delegate_params_.size();
+    return kTfLiteOk;
+  }
+
+  std::vector<TfLiteTensor> tensors_;
+  TfLiteNode nodes_[2] = {};
+  TfLiteRegistration registrations_[2] = {};
+  TfLiteIntArray* exec_plan_;
+  std::vector<TfLiteDelegateParams> delegate_params_;
+};
+
+TEST(PartitionCostModel, EstimatesComputeAndTransfer) {
+  CostModelTestContext context;
+  PartitionCostModel::Options options;
+  options.cpu_ops_per_us = 1000.0;
+  options.delegate_ops_per_us = 4000.0;
+  options.transfer_bytes_per_us = 1024.0;
+  options.partition_overhead_us = 10.0;
+  PartitionCostModel cost_model(options);
+
+  // 1024 x 1024 multiply-accumulates. Only the input and the output are
+  // copied, the constant weights are not.
+  auto cost = cost_model.EstimateCost(&context,
+                                      context.fully_connected_partition());
+  EXPECT_DOUBLE_EQ(cost.cpu_us, 1024.0 * 1024.0 / 1000.0);
+  EXPECT_DOUBLE_EQ(cost.delegate_us, 1024.0 * 1024.0 / 4000.0 + 10.0);
+  EXPECT_DOUBLE_EQ(cost.transfer_us, 2 * 1024 * sizeof(float) / 1024.0);
+  EXPECT_TRUE(cost_model.IsProfitable(&context,
+                                      context.fully_connected_partition()));
+
+  // One operation per output element doesn't pay for the copies.
+  cost = cost_model.EstimateCost(&context, context.add_partition());
+  EXPECT_DOUBLE_EQ(cost.cpu_us, 1024.0 / 1000.0);
+  EXPECT_FALSE(cost_model.IsProfitable(&context, context.add_partition()));
+}
+
+TEST(PartitionCostModel, MeasuredLatencyOverridesEstimate) {
+  CostModelTestContext context;
+  PartitionCostModel cost_model;
+  cost_model.SetMeasuredCpuLatency(1, 1000.0);
+  const auto cost = cost_model.EstimateCost(&context, context.add_partition());
+  EXPECT_DOUBLE_EQ(cost.cpu_us, 1000.0);
+  EXPECT_TRUE(cost_model.IsProfitable(&context, context.add_partition()));
+}
+
+TEST(PartitionCostModel, LoadMeasuredCpuLatencies) {
+  const std::string path = testing::TempDir() + "/cpu_latencies.csv";
+  {
+    std::ofstream file(path);
+    file << "# node_index,latency_us\n\n1,1000\n";
+  }
+  CostModelTestContext context;
+  PartitionCostModel cost_model;
+  ASSERT_TRUE(cost_model.LoadMeasuredCpuLatencies(path));
+  EXPECT_DOUBLE_EQ(
+      cost_model.EstimateCost(&context, context.add_partition()).cpu_us,
+      1000.0);
+
+  {
+    std::ofstream file(path);
+    file << "1 1000\n";
+  }
+  EXPECT_FALSE(cost_model.LoadMeasuredCpuLatencies(path));
+  EXPECT_FALSE(cost_model.LoadMeasuredCpuLatencies(path + ".missing"));
+}
+
+TEST(GraphPartitionHelper, SkipsUnprofitablePartitions) {
+  CostModelTestContext context;
+  GraphPartitionHelper helper(&context, IsNodeSupported);
+  EXPECT_EQ(kTfLiteOk, helper.Partition(nullptr));
+  EXPECT_EQ(2, helper.GetFirstNLargestPartitions().size());
+
+  PartitionCostModel cost_model;
+  helper.set_partition_cost_model(&cost_model);
+  EXPECT_THAT(helper.GetNodesOfFirstNLargestPartitions(),
+              testing::ElementsAre(0));
+
+  // The skipped partition doesn't count towards the limit.
+  cost_model.SetMeasuredCpuLatency(0, 0.0);
+  cost_model.SetMeasuredCpuLatency(1, 1000.0);
+  EXPECT_THAT(helper.GetNodesOfFirstNLargestPartitions(1),
+              testing::ElementsAre(1));
+}
+
 }  // namespace
 }  // namespace delegates
 }  // namespace tflite
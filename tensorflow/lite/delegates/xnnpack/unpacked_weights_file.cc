@@ -0,0 +1,170 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/xnnpack/unpacked_weights_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !defined(_WIN32)
+
+#include "tensorflow/lite/minimal_logging.h"
+
+namespace tflite {
+namespace xnnpack {
+namespace {
+
+constexpr char kMagic[8] = {'X', 'N', 'N', 'U', 'N', 'P', 'K', '\0'};
+constexpr uint32_t kVersion = 1;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t data_offset;
+  uint64_t fingerprint;
+  uint64_t size;
+};
+
+#if !defined(_WIN32)
+bool WriteAll(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    const ssize_t written = write(fd, data, size);
+    if (written < 0) {
+      return false;
+    }
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+#endif  // !defined(_WIN32)
+
+}  // namespace
+
+uint64_t FingerprintBytes(uint64_t seed, const void* data, size_t size) {
+  // FNV-1a over 8-byte words followed by the remaining bytes.
+  constexpr uint64_t kPrime = 0x100000001b3ULL;
+  uint64_t hash = seed ^ 0xcbf29ce484222325ULL;
+  const char* bytes = static_cast<const char*>(data);
+  for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    hash = (hash ^ word) * kPrime;
+    bytes += sizeof(word);
+  }
+  for (; size > 0; --size) {
+    hash = (hash ^ static_cast<unsigned char>(*bytes++)) * kPrime;
+  }
+  return hash;
+}
+
+#if defined(_WIN32)
+
+std::unique_ptr<UnpackedWeightsFile> UnpackedWeightsFile::Open(
+    const char* path, uint64_t fingerprint, size_t size) {
+  return nullptr;
+}
+
+bool UnpackedWeightsFile::Write(const char* path, uint64_t fingerprint,
+                                const char* data, size_t size) {
+  TFLITE_LOG_PROD_ONCE(TFLITE_LOG_WARNING,
+                       "Unpacked weights files are not supported on Windows.");
+  return false;
+}
+
+UnpackedWeightsFile::~UnpackedWeightsFile() {}
+
+#else  // defined(_WIN32)
+
+std::unique_ptr<UnpackedWeightsFile> UnpackedWeightsFile::Open(
+    const char* path, uint64_t fingerprint, size_t size) {
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+  FileHeader header;
+  struct stat st;
+  const size_t mapping_size = kDataOffset + size + kTrailingPadding;
+  if (pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+      std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion || header.data_offset != kDataOffset ||
+      header.fingerprint != fingerprint || header.size != size ||
+      fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) != mapping_size) {
+    TFLITE_LOG(TFLITE_LOG_INFO,
+               "Ignoring unpacked weights file %s that does not match the "
+               "model.",
+               path);
+    close(fd);
+    return nullptr;
+  }
+  void* mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    TFLITE_LOG_PROD(TFLITE_LOG_WARNING,
+                    "Failed to map unpacked weights file %s.", path);
+    return nullptr;
+  }
+  return std::unique_ptr<UnpackedWeightsFile>(
+      new UnpackedWeightsFile(mapping, mapping_size));
+}
+
+bool UnpackedWeightsFile::Write(const char* path, uint64_t fingerprint,
+                                const char* data, size_t size) {
+  const std::string tmp_path =
+      std::string(path) + ".tmp." + std::to_string(getpid());
+  const int fd = open(tmp_path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0644);
+  if (fd < 0) {
+    TFLITE_LOG_PROD(TFLITE_LOG_WARNING,
+                    "Failed to create unpacked weights file %s.",
+                    tmp_path.c_str());
+    return false;
+  }
+  char prefix[kDataOffset] = {0};
+  FileHeader header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.data_offset = kDataOffset;
+  header.fingerprint = fingerprint;
+  header.size = size;
+  std::memcpy(prefix, &header, sizeof(header));
+  const char padding[kTrailingPadding] = {0};
+  bool ok = WriteAll(fd, prefix, sizeof(prefix)) &&
+            WriteAll(fd, data, size) &&
+            WriteAll(fd, padding, sizeof(padding));
+  ok = close(fd) == 0 && ok;
+  if (!ok || rename(tmp_path.c_str(), path) != 0) {
+    TFLITE_LOG_PROD(TFLITE_LOG_WARNING,
+                    "Failed to write unpacked weights file %s.", path);
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+UnpackedWeightsFile::~UnpackedWeightsFile() { munmap(mapping_, mapping_size_); }
+
+#endif  // defined(_WIN32)
+
+}  // namespace xnnpack
+}  // namespace tflite
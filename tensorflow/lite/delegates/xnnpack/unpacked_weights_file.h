@@ -0,0 +1,81 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_DELEGATES_XNNPACK_UNPACKED_WEIGHTS_FILE_H_
+#define TENSORFLOW_LITE_DELEGATES_XNNPACK_UNPACKED_WEIGHTS_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace tflite {
+namespace xnnpack {
+
+// Returns `seed` combined with a fingerprint of `size` bytes at `data`.
+uint64_t FingerprintBytes(uint64_t seed, const void* data, size_t size);
+
+// A read-only, shared memory mapping of a file holding the unpacked static
+// weights (e.g. FP16 weights dequantized to FP32) of a model. The pages of
+// the mapping are shared by all delegates and processes that map the same
+// file, so they are only counted once against the resident memory.
+//
+// The file starts with a small header that records a fingerprint of the
+// weights it was unpacked from, so that a stale file left behind by another
+// model is never used.
+class UnpackedWeightsFile {
+ public:
+  // Maps `path` if it holds `size` bytes of unpacked weights with the given
+  // `fingerprint`. Returns nullptr if the file does not exist, does not match
+  // or cannot be mapped.
+  static std::unique_ptr<UnpackedWeightsFile> Open(const char* path,
+                                                   uint64_t fingerprint,
+                                                   size_t size);
+
+  // Writes `size` bytes at `data` to `path` with the given `fingerprint`. The
+  // file is written under a temporary name and renamed into place, so that
+  // concurrent readers never observe a partially written file. Returns true
+  // on success.
+  static bool Write(const char* path, uint64_t fingerprint, const char* data,
+                    size_t size);
+
+  ~UnpackedWeightsFile();
+
+  UnpackedWeightsFile(const UnpackedWeightsFile&) = delete;
+  UnpackedWeightsFile& operator=(const UnpackedWeightsFile&) = delete;
+
+  // The unpacked weights. The pointer is aligned to 64 bytes and at least 64
+  // readable bytes follow the end of the weights.
+  const char* data() const {
+    return static_cast<const char*>(mapping_) + kDataOffset;
+  }
+
+ private:
+  // Offset of the weights from the start of the file.
+  static constexpr size_t kDataOffset = 64;
+  // Zero bytes written after the weights, so that XNNPACK kernels may read
+  // past the end of the last tensor.
+  static constexpr size_t kTrailingPadding = 64;
+
+  UnpackedWeightsFile(void* mapping, size_t mapping_size)
+      : mapping_(mapping), mapping_size_(mapping_size) {}
+
+  void* mapping_;
+  size_t mapping_size_;
+};
+
+}  // namespace xnnpack
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_XNNPACK_UNPACKED_WEIGHTS_FILE_H_
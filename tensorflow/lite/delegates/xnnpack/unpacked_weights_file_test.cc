@@ -0,0 +1,108 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/core/model_builder.h"
+#include "tensorflow/lite/delegates/xnnpack/conv_2d_tester.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace tflite {
+namespace xnnpack {
+namespace {
+
+// Runs `model` with the XNNPACK delegate using `unpacked_weights_file_path`
+// on a fixed input and returns the output.
+std::vector<float> RunModel(const Model* model,
+                            const char* unpacked_weights_file_path) {
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  std::unique_ptr<Interpreter> interpreter;
+  EXPECT_EQ(kTfLiteOk, InterpreterBuilder(model, resolver)(&interpreter));
+
+  TfLiteXNNPackDelegateOptions delegate_options =
+      TfLiteXNNPackDelegateOptionsDefault();
+  delegate_options.unpacked_weights_file_path = unpacked_weights_file_path;
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      delegate(TfLiteXNNPackDelegateCreate(&delegate_options),
+               TfLiteXNNPackDelegateDelete);
+  EXPECT_EQ(kTfLiteOk, interpreter->ModifyGraphWithDelegate(delegate.get()));
+  EXPECT_EQ(kTfLiteOk, interpreter->AllocateTensors());
+
+  const TfLiteTensor* input = interpreter->input_tensor(0);
+  float* input_data = interpreter->typed_input_tensor<float>(0);
+  for (size_t i = 0; i < input->bytes / sizeof(float); ++i) {
+    input_data[i] = 0.01f * (i % 100);
+  }
+  EXPECT_EQ(kTfLiteOk, interpreter->Invoke());
+
+  const TfLiteTensor* output = interpreter->output_tensor(0);
+  const float* output_data = interpreter->typed_output_tensor<float>(0);
+  return std::vector<float>(output_data,
+                            output_data + output->bytes / sizeof(float));
+}
+
+bool FileExists(const std::string& path) {
+  FILE* file = std::fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  std::fclose(file);
+  return true;
+}
+
+TEST(XNNPACK_UNPACKED_WEIGHTS_FILE, SharedBetweenInterpreters) {
+  std::vector<char> buffer = Conv2DTester().FP16Weights().CreateTfLiteModel();
+  const Model* model = GetModel(buffer.data());
+  const std::string path = testing::TempDir() + "/shared_unpacked_weights";
+  std::remove(path.c_str());
+
+  const std::vector<float> expected = RunModel(model, nullptr);
+  // The first interpreter unpacks the weights and writes the file, the second
+  // one maps it.
+  EXPECT_THAT(RunModel(model, path.c_str()), testing::ContainerEq(expected));
+  ASSERT_TRUE(FileExists(path));
+  EXPECT_THAT(RunModel(model, path.c_str()), testing::ContainerEq(expected));
+}
+
+TEST(XNNPACK_UNPACKED_WEIGHTS_FILE, IgnoresFileOfAnotherModel) {
+  const std::string path = testing::TempDir() + "/stale_unpacked_weights";
+  std::remove(path.c_str());
+
+  std::vector<char> other_buffer = Conv2DTester()
+                                       .InputChannels(3)
+                                       .OutputChannels(5)
+                                       .FP16Weights()
+                                       .CreateTfLiteModel();
+  RunModel(GetModel(other_buffer.data()), path.c_str());
+  ASSERT_TRUE(FileExists(path));
+
+  std::vector<char> buffer = Conv2DTester().FP16Weights().CreateTfLiteModel();
+  const Model* model = GetModel(buffer.data());
+  const std::vector<float> expected = RunModel(model, nullptr);
+  EXPECT_THAT(RunModel(model, path.c_str()), testing::ContainerEq(expected));
+  // The file was rewritten for the new model.
+  EXPECT_THAT(RunModel(model, path.c_str()), testing::ContainerEq(expected));
+}
+
+}  // namespace
+}  // namespace xnnpack
+}  // namespace tflite
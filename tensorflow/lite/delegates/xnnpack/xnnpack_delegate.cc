@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/delegates/xnnpack/quantization_util.h"
+#include "tensorflow/lite/delegates/xnnpack/unpacked_weights_file.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
@@ -577,7 +578,19 @@ class Delegate {
 
   TfLiteXNNPackDelegateOptions options() const { return options_; }
 
+  const char* static_unpacked_data() const {
+    return static_unpacked_data_file_ != nullptr
+               ? static_unpacked_data_file_->data()
+               : static_unpacked_data_.data();
+  }
+
  private:
+  // Returns a fingerprint of everything the unpacked data of the given
+  // quasi-static tensors is computed from, or 0 if it cannot be computed.
+  uint64_t FingerprintQuasiStaticTensors(
+      TfLiteContext* context, const std::vector<int>& tensors,
+      const std::unordered_map<int, int>& producers) const;
+
   TfLiteDelegate delegate_ = {
       reinterpret_cast<void*>(this),             // .data_
       DelegatePrepare,                           // .Prepare
@@ -590,6 +603,9 @@ class Delegate {
   // Unpacked data for quasi-static tensors, i.e. tensors produced by
   // dequantizing or unpacking static buffers.
   std::vector<char> static_unpacked_data_;
+  // Memory-mapped unpacked data for quasi-static tensors. Used instead of
+  // static_unpacked_data_ when options_.unpacked_weights_file_path is set.
+  std::unique_ptr<UnpackedWeightsFile> static_unpacked_data_file_;
   // Mapping from a tensor index for a quasi-static tensor to the offset to
   // its unpacked data within static_unpacked_data_.
   std::unordered_map<int, size_t> static_unpacked_data_map_;
@@ -848,7 +864,7 @@ class Subgraph {
         // Check for quasi-static data.
         const auto it = delegate.static_unpacked_data_map_.find(t);
         if (it != delegate.static_unpacked_data_map_.end()) {
-          data = delegate.static_unpacked_data_.data() + it->second;
+          data = delegate.static_unpacked_data() + it->second;
         }
       }
       if (inputs.count(t) != 0) {
@@ -5567,10 +5583,91 @@ class Subgraph {
   bool variables_set_up_ = false;
 };
 
+uint64_t Delegate::FingerprintQuasiStaticTensors(
+    TfLiteContext* context, const std::vector<int>& tensors,
+    const std::unordered_map<int, int>& producers) const {
+  const auto fingerprint_int_array = [](uint64_t hash,
+                                        const TfLiteIntArray* array) {
+    if (array == nullptr) {
+      return FingerprintBytes(hash, nullptr, 0);
+    }
+    return FingerprintBytes(hash, array->data, array->size * sizeof(int));
+  };
+  const auto fingerprint_value = [](uint64_t hash, auto value) {
+    return FingerprintBytes(hash, &value, sizeof(value));
+  };
+
+  const std::unordered_set<int> quasi_static_tensors(tensors.cbegin(),
+                                                     tensors.cend());
+  uint64_t hash = fingerprint_value(0, XNN_EXTRA_BYTES);
+  for (int t : tensors) {
+    const auto producer_it = producers.find(t);
+    if (producer_it == producers.end()) {
+      return 0;
+    }
+    TfLiteNode* node = nullptr;
+    TfLiteRegistration* registration = nullptr;
+    if (context->GetNodeAndRegistration(context, producer_it->second, &node,
+                                        &registration) != kTfLiteOk ||
+        node->inputs->size != 1) {
+      return 0;
+    }
+    const TfLiteTensor& output_tensor = context->tensors[t];
+    hash = fingerprint_value(hash, t);
+    hash = fingerprint_value(hash, registration->builtin_code);
+    hash = fingerprint_value(hash, output_tensor.type);
+    hash = fingerprint_value(hash, output_tensor.bytes);
+    hash = fingerprint_int_array(hash, output_tensor.dims);
+
+    const int input = node->inputs->data[0];
+    const TfLiteTensor& input_tensor = context->tensors[input];
+    hash = fingerprint_value(hash, input);
+    hash = fingerprint_value(hash, input_tensor.type);
+    hash = fingerprint_value(hash, input_tensor.bytes);
+    hash = fingerprint_int_array(hash, input_tensor.dims);
+    if (quasi_static_tensors.count(input) == 0) {
+      if (input_tensor.allocation_type != kTfLiteMmapRo) {
+        return 0;
+      }
+      hash = FingerprintBytes(hash, input_tensor.data.raw_const,
+                              input_tensor.bytes);
+    }
+
+    hash = fingerprint_value(hash, input_tensor.params.scale);
+    hash = fingerprint_value(hash, input_tensor.params.zero_point);
+    if (input_tensor.quantization.type == kTfLiteAffineQuantization &&
+        input_tensor.quantization.params != nullptr) {
+      const auto* quant_params = static_cast<const TfLiteAffineQuantization*>(
+          input_tensor.quantization.params);
+      if (quant_params->scale != nullptr) {
+        hash = FingerprintBytes(hash, quant_params->scale->data,
+                                quant_params->scale->size * sizeof(float));
+      }
+      hash = fingerprint_int_array(hash, quant_params->zero_point);
+      hash = fingerprint_value(hash, quant_params->quantized_dimension);
+    }
+    if (input_tensor.sparsity != nullptr) {
+      const TfLiteSparsity& sparsity = *input_tensor.sparsity;
+      hash = fingerprint_int_array(hash, sparsity.traversal_order);
+      hash = fingerprint_int_array(hash, sparsity.block_map);
+      for (int i = 0; i < sparsity.dim_metadata_size; ++i) {
+        const TfLiteDimensionMetadata& metadata = sparsity.dim_metadata[i];
+        hash = fingerprint_value(hash, metadata.format);
+        hash = fingerprint_value(hash, metadata.dense_size);
+        hash = fingerprint_int_array(hash, metadata.array_segments);
+        hash = fingerprint_int_array(hash, metadata.array_indices);
+      }
+    }
+  }
+  // 0 is reserved for "no fingerprint".
+  return hash == 0 ? 1 : hash;
+}
+
 TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
   // Clear previous data, in case the delegate is reused without re-creation.
   static_unpacked_data_map_.clear();
   static_unpacked_data_.clear();
+  static_unpacked_data_file_.reset();
   static_unpack_nodes_.clear();
   static_sparse_weights_.clear();
   variable_holder_.ClearTensorIdToGlobalId();
@@ -5716,6 +5813,29 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
                      quasi_static_tensors_producers[t2];
             });
 
+  // Try to map the unpacked data from a file written by an earlier delegate.
+  const auto align_unpacked_data_offset = [](size_t offset) {
+    return (offset + XNN_EXTRA_BYTES - 1) / XNN_EXTRA_BYTES * XNN_EXTRA_BYTES;
+  };
+  uint64_t unpacked_data_fingerprint = 0;
+  if (options_.unpacked_weights_file_path != nullptr &&
+      !sorted_quasi_static_tensors_to_unpack.empty()) {
+    unpacked_data_fingerprint = FingerprintQuasiStaticTensors(
+        context, sorted_quasi_static_tensors_to_unpack,
+        quasi_static_tensors_producers);
+    size_t unpacked_data_size = 0;
+    for (int t : sorted_quasi_static_tensors_to_unpack) {
+      unpacked_data_size = align_unpacked_data_offset(unpacked_data_size) +
+                           context->tensors[t].bytes;
+    }
+    if (unpacked_data_fingerprint != 0) {
+      static_unpacked_data_file_ = UnpackedWeightsFile::Open(
+          options_.unpacked_weights_file_path, unpacked_data_fingerprint,
+          unpacked_data_size);
+    }
+  }
+  size_t static_unpacked_data_size = 0;
+
   // Unpack static data of all tensors
   for (int t : sorted_quasi_static_tensors_to_unpack) {
     const int producer_index = quasi_static_tensors_producers[t];
@@ -5786,11 +5906,15 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
     }
 
     // Align to XNN_EXTRA_BYTES bytes
-    while (static_unpacked_data_.size() % XNN_EXTRA_BYTES != 0) {
-      static_unpacked_data_.push_back(0);
+    const size_t tensor_offset =
+        align_unpacked_data_offset(static_unpacked_data_size);
+    static_unpacked_data_size = tensor_offset + context->tensors[t].bytes;
+    static_unpacked_data_map_[t] = tensor_offset;
+    if (static_unpacked_data_file_ != nullptr) {
+      // Already unpacked in the mapped file.
+      continue;
     }
-    const size_t tensor_offset = static_unpacked_data_.size();
-    static_unpacked_data_.resize(tensor_offset + context->tensors[t].bytes);
+    static_unpacked_data_.resize(static_unpacked_data_size);
 
     char* unpacked_data = static_unpacked_data_.data() + tensor_offset;
     const char* packed_data =
@@ -5900,8 +6024,22 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
         TfLiteIntArrayFree(nodes_to_delegate);
         return nullptr;  // Hard error.
     }
+  }
 
-    static_unpacked_data_map_[t] = tensor_offset;
+  if (unpacked_data_fingerprint != 0 && static_unpacked_data_file_ == nullptr) {
+    // Persist the unpacked data and switch to the shared mapping of the file,
+    // so that the private copy can be released.
+    if (UnpackedWeightsFile::Write(options_.unpacked_weights_file_path,
+                                   unpacked_data_fingerprint,
+                                   static_unpacked_data_.data(),
+                                   static_unpacked_data_.size())) {
+      static_unpacked_data_file_ = UnpackedWeightsFile::Open(
+          options_.unpacked_weights_file_path, unpacked_data_fingerprint,
+          static_unpacked_data_.size());
+    }
+    if (static_unpacked_data_file_ != nullptr) {
+      std::vector<char>().swap(static_unpacked_data_);
+    }
   }
 
   // Add nodes that unpack static data consumed by delegated nodes.
@@ -6063,6 +6201,7 @@ TfLiteXNNPackDelegateOptions TfLiteXNNPackDelegateOptionsDefault() {
 #endif  // XNNPACK_DELEGATE_TEST_MODE
 
   options.handle_variable_ops = false;
+  options.unpacked_weights_file_path = nullptr;
   return options;
 }
 
@@ -47,6 +47,13 @@ typedef struct {
   // Whether READ_VARIABLE, ASSIGN_VARIABLE, and VARIABLE_HANDLE operations
   // should be handled by XNNPACK.
   bool handle_variable_ops;
+  // Path of a file to keep the unpacked static weights (e.g. FP16 or INT8
+  // weights dequantized to FP32, or densified sparse weights) in. If the file
+  // holds the unpacked weights of the same model, they are memory-mapped
+  // instead of being unpacked again, and the mapping is shared read-only by
+  // all delegates and processes using the file. Otherwise the weights are
+  // unpacked and the file is (re)written. Null disables the file.
+  const char* unpacked_weights_file_path;
 } TfLiteXNNPackDelegateOptions;
 
 // Returns a structure with the default XNNPack delegate options.
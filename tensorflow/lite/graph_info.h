@@ -70,6 +70,13 @@ class GraphInfo {
 
   // Returns the indices of the variable tensors.
   virtual const std::vector<int>& variables() const = 0;
+
+  // Returns the first and last execution plan indices of the group of nodes
+  // that may run concurrently with the node at execution plan index `index`.
+  // Memory planners must keep the tensors of such a group alive for the whole
+  // group. By default every node runs on its own.
+  virtual size_t first_concurrent_node(size_t index) const { return index; }
+  virtual size_t last_concurrent_node(size_t index) const { return index; }
 };
 
 // Represents a subset of nodes in a TensorFlow Lite graph.
@@ -29,7 +29,9 @@ class InterpreterOptions {
       : experimental_preserve_all_tensors_(false),
         experimental_ensure_dynamic_tensors_are_released_(false),
         experimental_optimize_memory_for_large_tensors_(0),
-        experimental_disable_delegate_clustering_(false) {}
+        experimental_disable_delegate_clustering_(false),
+        experimental_inter_op_parallelism_(1),
+        experimental_prefetch_weights_in_background_(false) {}
 
   /// Preserving all intermediates tensors for debugging.
   /// WARNING: This is an experimental API and subject to change.
@@ -93,11 +95,51 @@ class InterpreterOptions {
     experimental_disable_delegate_clustering_ = value;
   }
 
+  /// Runs nodes of the execution plan that don't depend on each other
+  /// concurrently on up to `num_threads` threads (the invoking thread
+  /// included). Nodes that have side effects (delegate kernels, custom and
+  /// control flow ops, and ops on resource or variable tensors) still run on
+  /// their own. Tensors of nodes that run together can't share memory, so the
+  /// arena may grow. Values <= 1 run all nodes one at a time, which is the
+  /// default. Each worker thread uses its own CPU backend context; see
+  /// `Interpreter::SetNumThreads` for the threads available to each op.
+  /// This must be called before `AllocateTensors`.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetInterOpParallelism(int num_threads) {
+    experimental_inter_op_parallelism_ = num_threads;
+  }
+
+  /// Returns the number of threads used to run independent nodes.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetInterOpParallelism() { return experimental_inter_op_parallelism_; }
+
+  /// Reads every page of the read-only tensors, e.g. the weights of a
+  /// memory-mapped model, on a background thread started by
+  /// `AllocateTensors`, in the order the nodes using them are executed.
+  /// Kernels pack or transpose their weights on first use rather than in
+  /// Prepare, so with a large model the first `Invoke` would otherwise page in
+  /// the whole file on the invoking thread. With this option it only waits for
+  /// weights the prefetcher hasn't reached yet. The thread stops once it is
+  /// done, or when the interpreter is destroyed.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetPrefetchWeightsInBackground(bool value = true) {
+    experimental_prefetch_weights_in_background_ = value;
+  }
+
+  /// Returns if the `experimental_prefetch_weights_in_background_` feature is
+  /// enabled.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetPrefetchWeightsInBackground() {
+    return experimental_prefetch_weights_in_background_;
+  }
+
  private:
   bool experimental_preserve_all_tensors_;
   bool experimental_ensure_dynamic_tensors_are_released_;
   int experimental_optimize_memory_for_large_tensors_;
   bool experimental_disable_delegate_clustering_;
+  int experimental_inter_op_parallelism_;
+  bool experimental_prefetch_weights_in_background_;
 };
 
 }  // namespace tflite
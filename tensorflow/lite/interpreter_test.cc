@@ -20,6 +20,7 @@ limitations under the License.
 #include <stdlib.h>
 #include <string.h>
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <new>
@@ -1164,6 +1165,173 @@ TEST(InterpreterTensorsCapacityTest, TestExceedHeadroom) {
   ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
 }
 
+// Number of nodes created with `GetWaitForPeerRegistration` that started, and
+// that saw their peer start while they were running.
+std::atomic<int> inter_op_nodes_started(0);
+std::atomic<int> inter_op_nodes_met(0);
+
+// Sets the output to the sum of the inputs plus one.
+TfLiteStatus AddOne(TfLiteContext* context, TfLiteNode* node) {
+  float sum = 1;
+  for (int i = 0; i < node->inputs->size; ++i) {
+    sum += GetInput(context, node, i)->data.f[0];
+  }
+  GetOutput(context, node, 0)->data.f[0] = sum;
+  return kTfLiteOk;
+}
+
+TfLiteRegistration GetAddOneRegistration() {
+  TfLiteRegistration registration = {nullptr, nullptr, nullptr, nullptr};
+  registration.invoke = AddOne;
+  return registration;
+}
+
+// Like `GetAddOneRegistration`, but waits until a second node of this kind
+// started before returning, or gives up if that doesn't happen.
+TfLiteRegistration GetWaitForPeerRegistration() {
+  TfLiteRegistration registration = GetAddOneRegistration();
+  registration.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    ++inter_op_nodes_started;
+    for (int i = 0; i < 1000000000 && inter_op_nodes_started < 2; ++i) {
+    }
+    if (inter_op_nodes_started == 2) ++inter_op_nodes_met;
+    return AddOne(context, node);
+  };
+  return registration;
+}
+
+TEST(InterOpParallelismTest, RunsIndependentNodesConcurrently) {
+  inter_op_nodes_started = 0;
+  inter_op_nodes_met = 0;
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetInterOpParallelism(2);
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  ASSERT_EQ(interpreter.AddTensors(5), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({4}), kTfLiteOk);
+  TfLiteQuantizationParams quant;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {1}, quant),
+              kTfLiteOk);
+  }
+  TfLiteRegistration add_one = GetAddOneRegistration();
+  TfLiteRegistration wait_for_peer = GetWaitForPeerRegistration();
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                              &wait_for_peer),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr,
+                                              &add_one),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {3}, nullptr, 0, nullptr,
+                                              &wait_for_peer),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({2, 3}, {4}, nullptr, 0,
+                                              nullptr, &add_one),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  // The nodes that only consume the input are moved next to each other.
+  EXPECT_THAT(interpreter.execution_plan(), ElementsAre(0, 2, 1, 3));
+  Subgraph& subgraph = interpreter.primary_subgraph();
+  EXPECT_EQ(subgraph.first_concurrent_node(1), 0u);
+  EXPECT_EQ(subgraph.last_concurrent_node(0), 1u);
+  EXPECT_NE(interpreter.tensor(1)->data.raw, interpreter.tensor(3)->data.raw);
+
+  *interpreter.typed_tensor<float>(0) = 1;
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_EQ(*interpreter.typed_tensor<float>(4), 6);
+  EXPECT_EQ(inter_op_nodes_met, 2);
+}
+
+TEST(InterOpParallelismTest, NodesWithSideEffectsRunAlone) {
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetInterOpParallelism(2);
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  ASSERT_EQ(interpreter.AddTensors(4), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({1, 2, 3}), kTfLiteOk);
+  TfLiteQuantizationParams quant;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {1}, quant),
+              kTfLiteOk);
+  }
+  TfLiteRegistration add_one = GetAddOneRegistration();
+  TfLiteRegistration custom_add_one = GetAddOneRegistration();
+  custom_add_one.builtin_code = kTfLiteBuiltinCustom;
+  custom_add_one.custom_name = "AddOne";
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                              &add_one),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {2}, nullptr, 0, nullptr,
+                                              &custom_add_one),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {3}, nullptr, 0, nullptr,
+                                              &add_one),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  // The custom op separates the two other nodes, which can't run together.
+  EXPECT_THAT(interpreter.execution_plan(), ElementsAre(0, 1, 2));
+  Subgraph& subgraph = interpreter.primary_subgraph();
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(subgraph.first_concurrent_node(i), i);
+    EXPECT_EQ(subgraph.last_concurrent_node(i), i);
+  }
+
+  *interpreter.typed_tensor<float>(0) = 1;
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_EQ(*interpreter.typed_tensor<float>(1), 2);
+  EXPECT_EQ(*interpreter.typed_tensor<float>(2), 2);
+  EXPECT_EQ(*interpreter.typed_tensor<float>(3), 2);
+}
+
+TEST(PrefetchWeightsTest, InvokesWhileWeightsArePrefetched) {
+  // Large enough to span many pages, and outlives the interpreter like the
+  // buffer of a model would.
+  std::vector<float> weights(1 << 20, 2.f);
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetPrefetchWeightsInBackground();
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  ASSERT_EQ(interpreter.AddTensors(3), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({2}), kTfLiteOk);
+  TfLiteQuantizationParams quant;
+  ASSERT_EQ(interpreter.SetTensorParametersReadOnly(
+                1, kTfLiteFloat32, "", {static_cast<int>(weights.size())},
+                quant, reinterpret_cast<const char*>(weights.data()),
+                weights.size() * sizeof(float)),
+            kTfLiteOk);
+  for (int i : {0, 2}) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {1}, quant),
+              kTfLiteOk);
+  }
+  TfLiteRegistration add_last_weight = {nullptr, nullptr, nullptr, nullptr};
+  add_last_weight.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* weights = &context->tensors[node->inputs->data[1]];
+    const int num_weights = weights->dims->data[0];
+    context->tensors[node->outputs->data[0]].data.f[0] =
+        context->tensors[node->inputs->data[0]].data.f[0] +
+        weights->data.f[num_weights - 1];
+    return kTfLiteOk;
+  };
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0, 1}, {2}, nullptr, 0,
+                                              nullptr, &add_last_weight),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  // Reallocating doesn't start a second prefetch.
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  *interpreter.typed_tensor<float>(0) = 1;
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_EQ(*interpreter.typed_tensor<float>(2), 3);
+}
+
 TEST_F(InterpreterTest, SubgraphNumbering) {
   EXPECT_THAT(interpreter_->subgraph(0)->GetSubgraphIndex(), 0);
   AddSubgraphs(2);
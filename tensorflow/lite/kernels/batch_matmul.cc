@@ -291,11 +291,56 @@ TfLiteStatus InitializeTemporaries(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+// Float LHS against a 2-D int4 RHS quantized block-wise along its rows. The
+// packed nibbles cannot be transposed cheaply, so only an RHS that is already
+// laid out as [units, depth] (adj_y) is supported. A single dequantized RHS
+// row is kept in a temporary.
+TfLiteStatus PrepareBlockwiseInt4(TfLiteContext* context, TfLiteNode* node,
+                                  OpContext* op_context) {
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+  const TfLiteTensor* lhs = op_context->lhs;
+  const TfLiteTensor* rhs = op_context->rhs;
+  TfLiteTensor* output = op_context->output;
+  if (op_context->params->adj_x || !op_context->params->adj_y) {
+    TF_LITE_KERNEL_LOG(context,
+                       "BatchMatMul with a block-wise int4 RHS requires "
+                       "adj_x = false and adj_y = true.");
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteFloat32);
+  TF_LITE_ENSURE(context, NumDimensions(lhs) >= 2);
+  TF_LITE_ENSURE(context, NumDimensions(lhs) <= 5);
+  TF_LITE_ENSURE_STATUS(CheckBlockwiseInt4Weights(context, rhs));
+  const int depth = SizeOfDimension(rhs, 1);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(lhs, NumDimensions(lhs) - 1),
+                    depth);
+
+  TfLiteIntArrayFree(node->temporaries);
+  node->temporaries = TfLiteIntArrayCreate(1);
+  node->temporaries->data[0] = op_data->scratch_tensor_index;
+  TfLiteTensor* rhs_row;
+  TF_LITE_ENSURE_OK(context,
+                    GetTemporarySafe(context, node, /*index=*/0, &rhs_row));
+  rhs_row->type = kTfLiteFloat32;
+  rhs_row->allocation_type = kTfLiteArenaRw;
+  TfLiteIntArray* rhs_row_size = TfLiteIntArrayCreate(1);
+  rhs_row_size->data[0] = depth;
+  TF_LITE_ENSURE_OK(context,
+                    context->ResizeTensor(context, rhs_row, rhs_row_size));
+
+  TfLiteIntArray* output_size = TfLiteIntArrayCopy(lhs->dims);
+  output_size->data[output_size->size - 1] = SizeOfDimension(rhs, 0);
+  return context->ResizeTensor(context, output, output_size);
+}
+
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, NumInputs(node), 2);
   TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
 
   OpContext op_context(context, node);
+  if (IsBlockwiseInt4Op(op_context.lhs, op_context.rhs)) {
+    return PrepareBlockwiseInt4(context, node, &op_context);
+  }
   TF_LITE_ENSURE_OK(context, InitializeTemporaries(context, node, &op_context));
   OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
 
@@ -697,6 +742,45 @@ TfLiteTensor* GetTempLhs(TfLiteContext* context, TfLiteNode* node,
 // (this Op will apply broadcasting rules).
 // We assume that LHS and RHS are both row oriented (adjacent values in memory
 // are in the same row) and will output in the same memory layout. However,
+TfLiteStatus EvalBlockwiseInt4(TfLiteContext* context, TfLiteNode* node,
+                               const TfLiteTensor* lhs, const TfLiteTensor* rhs,
+                               TfLiteTensor* output) {
+  const auto* blockwise =
+      reinterpret_cast<TfLiteBlockwiseQuantization*>(rhs->quantization.params);
+  const float* scales =
+      GetTensorData<float>(&context->tensors[blockwise->scale]);
+  const int8_t* zero_points =
+      blockwise->zero_point >= 0
+          ? GetTensorData<int8_t>(&context->tensors[blockwise->zero_point])
+          : nullptr;
+  TfLiteTensor* rhs_row;
+  TF_LITE_ENSURE_OK(context,
+                    GetTemporarySafe(context, node, /*index=*/0, &rhs_row));
+  float* rhs_row_data = GetTensorData<float>(rhs_row);
+
+  const int num_units = SizeOfDimension(rhs, 0);
+  const int depth = SizeOfDimension(rhs, 1);
+  const int num_blocks = depth / blockwise->blocksize;
+  const int num_rows = NumElements(lhs) / depth;
+  const int8_t* rhs_data = GetTensorData<int8_t>(rhs);
+  const float* lhs_data = GetTensorData<float>(lhs);
+  float* output_data = GetTensorData<float>(output);
+  // Dequantize each RHS row once and reuse it for every LHS row, so that the
+  // RHS is never materialized in float.
+  for (int unit = 0; unit < num_units; ++unit) {
+    tensor_utils::UnpackBlockwiseInt4IntoFloat(
+        rhs_data + unit * (depth / 2), depth, blockwise->blocksize,
+        scales + unit * num_blocks,
+        zero_points ? zero_points + unit * num_blocks : nullptr, rhs_row_data);
+    for (int row = 0; row < num_rows; ++row) {
+      output_data[row * num_units + unit] =
+          tensor_utils::VectorVectorDotProduct(
+              rhs_row_data, lhs_data + row * depth, depth);
+    }
+  }
+  return kTfLiteOk;
+}
+
 // our fast GEMM libraries assume RCC layout (LHS row oriented,
 // RHS column oriented, output column oriented). Therefore, we perform
 // RHS <..., C, B> X LHS <..., B, A>
@@ -715,6 +799,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TfLiteTensor* output;
   TF_LITE_ENSURE_OK(context,
                     GetOutputSafe(context, node, kOutputTensor, &output));
+  if (IsBlockwiseInt4Op(lhs, rhs)) {
+    return EvalBlockwiseInt4(context, node, lhs, rhs, output);
+  }
   RuntimeShape orig_lhs_shape = GetTensorShape(lhs);
   RuntimeShape orig_rhs_shape = GetTensorShape(rhs);
 
@@ -314,6 +314,58 @@ TEST_P(BatchMatMulOpTest, Float32Test_BroadcastFromRHS) {
   EXPECT_THAT(model.GetOutputShape(), ElementsAreArray({3, 1, 4, 2}));
 }
 
+class BlockwiseInt4BatchMatMulOpModel : public SingleOpModel {
+ public:
+  BlockwiseInt4BatchMatMulOpModel(const TensorData& lhs,
+                                  const std::vector<int>& rhs_shape,
+                                  const std::vector<int8_t>& rhs_values,
+                                  const std::vector<float>& scales,
+                                  const std::vector<int8_t>& zero_points,
+                                  int block_size) {
+    lhs_id_ = AddInput(lhs);
+    rhs_id_ = AddConstBlockwiseInt4Input(rhs_shape, rhs_values, scales,
+                                         zero_points, block_size);
+    output_id_ = AddOutput(TensorType_FLOAT32);
+    SetBuiltinOp(BuiltinOperator_BATCH_MATMUL,
+                 BuiltinOptions_BatchMatMulOptions,
+                 CreateBatchMatMulOptions(builder_, /*adj_x=*/false,
+                                          /*adj_y=*/true)
+                     .Union());
+    BuildInterpreter({GetShape(lhs_id_), GetShape(rhs_id_)});
+  }
+
+  int lhs() const { return lhs_id_; }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_id_); }
+  std::vector<int32_t> GetOutputShape() { return GetTensorShape(output_id_); }
+
+ protected:
+  int lhs_id_;
+  int rhs_id_;
+  int output_id_;
+};
+
+TEST_P(BatchMatMulOpTest, Float32Test_BlockwiseInt4RHS) {
+  // Three RHS rows of two blocks of four values each.
+  BlockwiseInt4BatchMatMulOpModel model(
+      {TensorType_FLOAT32, {2, 1, 8}}, /*rhs_shape=*/{3, 8},
+      /*rhs_values=*/
+      {
+          1, 2,  3, 4, -1, -2, -3, -4,  //
+          7, -8, 0, 1, 2,  2,  2,  2,   //
+          0, 0,  0, 0, 1,  1,  1,  1,   //
+      },
+      /*scales=*/{0.5, 1, 1, 0.25, 2, -1},
+      /*zero_points=*/{1, -1, 0, 2, 0, 1}, /*block_size=*/4);
+  model.PopulateTensor<float>(model.lhs(), {
+                                               1, 1, 1, 1, 1,  1, 1, 1,  //
+                                               1, 2, 3, 4, -1, 0, 1, 2,  //
+                                           });
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  EXPECT_THAT(model.GetOutput(),
+              ElementsAreArray(ArrayFloatNear({-3., 0., 0., 2., -5., 0.})));
+  EXPECT_THAT(model.GetOutputShape(), ElementsAreArray({2, 1, 3}));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     BatchMatMulOpTest, BatchMatMulOpTest,
     ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMap)));
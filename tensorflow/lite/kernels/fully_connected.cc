@@ -339,6 +339,29 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node) {
       (input->type == kTfLiteFloat32 &&
        (filter->type == kTfLiteUInt8 || filter->type == kTfLiteInt8));
   const bool is_sparse = filter->sparsity != nullptr;
+  if (IsBlockwiseInt4Op(input, filter)) {
+    TF_LITE_ENSURE(context, !is_sparse);
+    TF_LITE_ENSURE_STATUS(CheckBlockwiseInt4Weights(context, filter));
+    // One dequantized filter row per thread.
+    const int max_threads =
+        CpuBackendContext::GetFromContext(context)->max_num_threads();
+    TfLiteIntArrayFree(node->temporaries);
+    node->temporaries = TfLiteIntArrayCreate(1);
+    node->temporaries->data[0] = data->scratch_tensor_index;
+    TfLiteTensor* filter_rows;
+    TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, /*index=*/0,
+                                                &filter_rows));
+    filter_rows->type = kTfLiteFloat32;
+    filter_rows->allocation_type = kTfLiteArenaRw;
+    int filter_rows_dims[2] = {max_threads, SizeOfDimension(filter, 1)};
+    if (!TfLiteIntArrayEqualsArray(filter_rows->dims, 2, filter_rows_dims)) {
+      TfLiteIntArray* filter_rows_size = TfLiteIntArrayCreate(2);
+      filter_rows_size->data[0] = filter_rows_dims[0];
+      filter_rows_size->data[1] = filter_rows_dims[1];
+      TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, filter_rows,
+                                                       filter_rows_size));
+    }
+  }
   if (is_hybrid) {
     TfLiteIntArrayFree(node->temporaries);
     data->compute_row_sums = true;
@@ -791,6 +814,124 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+// Computes output units [unit_start, unit_end) for every batch. Each filter
+// row is dequantized once into `filter_row` and then reused across batches.
+void EvalBlockwiseInt4Impl(const TfLiteTensor* input,
+                           const TfLiteTensor* filter, const TfLiteTensor* bias,
+                           const TfLiteBlockwiseQuantization& blockwise,
+                           const float* scales, const int8_t* zero_points,
+                           int unit_start, int unit_end, float* filter_row,
+                           TfLiteTensor* output) {
+  const int num_units = SizeOfDimension(filter, 0);
+  const int input_depth = SizeOfDimension(filter, 1);
+  const int batch_size = NumElements(input) / input_depth;
+  const int block_size = blockwise.blocksize;
+  const int num_blocks = input_depth / block_size;
+  const int8_t* filter_data = GetTensorData<int8_t>(filter);
+  const float* bias_data = bias ? GetTensorData<float>(bias) : nullptr;
+  const float* input_data = GetTensorData<float>(input);
+  float* output_data = GetTensorData<float>(output);
+  for (int unit = unit_start; unit < unit_end; ++unit) {
+    tensor_utils::UnpackBlockwiseInt4IntoFloat(
+        filter_data + unit * (input_depth / 2), input_depth, block_size,
+        scales + unit * num_blocks,
+        zero_points ? zero_points + unit * num_blocks : nullptr, filter_row);
+    const float unit_bias = bias_data ? bias_data[unit] : 0.0f;
+    for (int b = 0; b < batch_size; ++b) {
+      output_data[b * num_units + unit] =
+          tensor_utils::VectorVectorDotProduct(
+              filter_row, input_data + b * input_depth, input_depth) +
+          unit_bias;
+    }
+  }
+}
+
+struct BlockwiseInt4FullyConnectedTask : cpu_backend_threadpool::Task {
+  BlockwiseInt4FullyConnectedTask(const TfLiteTensor* input,
+                                  const TfLiteTensor* filter,
+                                  const TfLiteTensor* bias,
+                                  const TfLiteBlockwiseQuantization& blockwise,
+                                  const float* scales,
+                                  const int8_t* zero_points,
+                                  const int unit_start, const int unit_end,
+                                  float* filter_row, TfLiteTensor* output)
+      : input(input),
+        filter(filter),
+        bias(bias),
+        blockwise(blockwise),
+        scales(scales),
+        zero_points(zero_points),
+        unit_start(unit_start),
+        unit_end(unit_end),
+        filter_row(filter_row),
+        output(output) {}
+
+  void Run() override {
+    EvalBlockwiseInt4Impl(input, filter, bias, blockwise, scales, zero_points,
+                          unit_start, unit_end, filter_row, output);
+  }
+
+ private:
+  const TfLiteTensor* input;
+  const TfLiteTensor* filter;
+  const TfLiteTensor* bias;
+  const TfLiteBlockwiseQuantization& blockwise;
+  const float* scales;
+  const int8_t* zero_points;
+  const int unit_start;
+  const int unit_end;
+  float* filter_row;
+  TfLiteTensor* output;
+};
+
+TfLiteStatus EvalBlockwiseInt4(TfLiteContext* context, TfLiteNode* node,
+                               TfLiteFullyConnectedParams* params,
+                               const TfLiteTensor* input,
+                               const TfLiteTensor* filter,
+                               const TfLiteTensor* bias, TfLiteTensor* output) {
+  const auto& blockwise = *reinterpret_cast<TfLiteBlockwiseQuantization*>(
+      filter->quantization.params);
+  const float* scales =
+      GetTensorData<float>(&context->tensors[blockwise.scale]);
+  const int8_t* zero_points =
+      blockwise.zero_point >= 0
+          ? GetTensorData<int8_t>(&context->tensors[blockwise.zero_point])
+          : nullptr;
+  TfLiteTensor* filter_rows;
+  TF_LITE_ENSURE_OK(context,
+                    GetTemporarySafe(context, node, /*index=*/0, &filter_rows));
+  const int input_depth = SizeOfDimension(filter, 1);
+
+  // Slice along the output units: unlike the batch dimension this is large
+  // even for single-batch inference, which is where weight-only quantization
+  // is used the most.
+  CpuBackendContext* cpu_backend_context =
+      CpuBackendContext::GetFromContext(context);
+  const int num_units = SizeOfDimension(filter, 0);
+  const int thread_count =
+      std::max(1, std::min({num_units, cpu_backend_context->max_num_threads(),
+                            SizeOfDimension(filter_rows, 0)}));
+  std::vector<BlockwiseInt4FullyConnectedTask> tasks;
+  tasks.reserve(thread_count);
+  int unit_start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    int unit_end = unit_start + num_units / thread_count;
+    if (i < num_units % thread_count) unit_end++;
+    tasks.emplace_back(input, filter, bias, blockwise, scales, zero_points,
+                       unit_start, unit_end,
+                       GetTensorData<float>(filter_rows) + i * input_depth,
+                       output);
+    unit_start = unit_end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+
+  tensor_utils::ApplyActivationToVector(
+      GetTensorData<float>(output), NumElements(output), params->activation,
+      GetTensorData<float>(output));
+  return kTfLiteOk;
+}
+
 namespace {
 template <KernelType kernel_type>
 void FullyConnectedInt8(const OpData* data, const TfLiteTensor* input,
@@ -1325,6 +1466,10 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       }
     case kTfLiteInt4:
       if (params->weights_format == kTfLiteFullyConnectedWeightsFormatDefault) {
+        if (IsBlockwiseInt4Op(input, filter)) {
+          return EvalBlockwiseInt4(context, node, params, input, filter, bias,
+                                   output);
+        }
         return EvalQuantized<kernel_type>(context, node, params, data, input,
                                           filter, bias, output);
       } else {
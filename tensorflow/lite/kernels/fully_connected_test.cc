@@ -473,6 +473,44 @@ class HybridFullyConnectedOpModel : public SingleOpModel {
   int input_size_;
 };
 
+// Float activations with a constant int4 filter quantized block-wise along
+// the input depth.
+class BlockwiseInt4FullyConnectedOpModel : public SingleOpModel {
+ public:
+  BlockwiseInt4FullyConnectedOpModel(
+      TfLiteRegistration* registration, int units, int batches, int input_size,
+      const std::vector<int8_t>& weights, const std::vector<float>& scales,
+      const std::vector<int8_t>& zero_points, int block_size,
+      ActivationFunctionType activation_func = ActivationFunctionType_NONE,
+      int num_threads = 1) {
+    input_ = AddInput({TensorType_FLOAT32, {batches, input_size}});
+    weights_ = AddConstBlockwiseInt4Input({units, input_size}, weights, scales,
+                                          zero_points, block_size);
+    bias_ = AddInput({TensorType_FLOAT32, {units}});
+    output_ = AddOutput({TensorType_FLOAT32});
+
+    SetBuiltinOp(
+        BuiltinOperator_FULLY_CONNECTED, BuiltinOptions_FullyConnectedOptions,
+        CreateFullyConnectedOptions(builder_, activation_func).Union());
+    resolver_ = std::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({GetShape(input_), GetShape(weights_), GetShape(bias_)},
+                     num_threads, /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/false);
+  }
+
+  void SetBias(const std::vector<float>& f) { PopulateTensor(bias_, f); }
+  void SetInput(const std::vector<float>& f) { PopulateTensor(input_, f); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ protected:
+  int input_;
+  int weights_;
+  int bias_;
+  int output_;
+};
+
 const auto kKernelMap = new std::map<string, TfLiteRegistration*>({
     {"Reference", ops::builtin::Register_FULLY_CONNECTED_REF()},
     {"GenericOptimized", ops::builtin::Register_FULLY_CONNECTED_GENERIC_OPT()},
@@ -1511,6 +1549,75 @@ TEST_P(QuantizedFullyConnectedOpTest,
               ElementsAre(175, 177, 179, 243, 245, 247));
 }
 
+// Two blocks of four values per output unit.
+const std::vector<int8_t>& BlockwiseInt4Weights() {
+  static const auto* weights = new std::vector<int8_t>({
+      1, 2,  3, 4, -1, -2, -3, -4,  // u = 0
+      7, -8, 0, 1, 2,  2,  2,  2,   // u = 1
+      0, 0,  0, 0, 1,  1,  1,  1,   // u = 2
+  });
+  return *weights;
+}
+
+TEST_P(FloatFullyConnectedOpTest, BlockwiseInt4Symmetric) {
+  BlockwiseInt4FullyConnectedOpModel m(
+      GetRegistration(), /*units=*/3, /*batches=*/2, /*input_size=*/8,
+      BlockwiseInt4Weights(), /*scales=*/{0.5, 1, 1, 0.25, 2, -1},
+      /*zero_points=*/{}, /*block_size=*/4);
+  m.SetBias({1, 2, 3});
+  m.SetInput({
+      1, 1, 1, 1, 1,  1, 1, 1,  // b = 0
+      1, 2, 3, 4, -1, 0, 1, 2,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 3));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 -4, 4, -1,  // b = 0
+                                 6, -2, 1,   // b = 1
+                             })));
+}
+
+TEST_P(FloatFullyConnectedOpTest, BlockwiseInt4Asymmetric) {
+  BlockwiseInt4FullyConnectedOpModel m(
+      GetRegistration(), /*units=*/3, /*batches=*/2, /*input_size=*/8,
+      BlockwiseInt4Weights(), /*scales=*/{0.5, 1, 1, 0.25, 2, -1},
+      /*zero_points=*/{1, -1, 0, 2, 0, 1}, /*block_size=*/4);
+  m.SetBias({1, 2, 3});
+  m.SetInput({
+      1, 1, 1, 1, 1,  1, 1, 1,  // b = 0
+      1, 2, 3, 4, -1, 0, 1, 2,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 -2, 2, 3,  // b = 0
+                                 3, -3, 3,  // b = 1
+                             })));
+}
+
+TEST_P(FloatFullyConnectedOpTest, BlockwiseInt4ReluMultithreaded) {
+  BlockwiseInt4FullyConnectedOpModel m(
+      GetRegistration(), /*units=*/3, /*batches=*/2, /*input_size=*/8,
+      BlockwiseInt4Weights(), /*scales=*/{0.5, 1, 1, 0.25, 2, -1},
+      /*zero_points=*/{}, /*block_size=*/4, ActivationFunctionType_RELU,
+      /*num_threads=*/2);
+  m.SetBias({1, 2, 3});
+  m.SetInput({
+      1, 1, 1, 1, 1,  1, 1, 1,  // b = 0
+      1, 2, 3, 4, -1, 0, 1, 2,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 0, 4, 0,  // b = 0
+                                 6, 0, 1,  // b = 1
+                             })));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     FloatFullyConnectedOpTest, FloatFullyConnectedOpTest,
     ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMap)));
@@ -8271,6 +8271,202 @@ inline void AddN(const RuntimeShape& input_shape, const size_t num_inputs,
   }
 }
 
+// Writes the `count` scalars at `input_data` in reverse order to
+// `output_data`.
+template <typename Scalar>
+inline void ReverseElements(const Scalar* input_data, int count,
+                            Scalar* output_data) {
+  std::reverse_copy(input_data, input_data + count, output_data);
+}
+
+#ifdef USE_NEON
+template <>
+inline void ReverseElements(const float* input_data, int count,
+                            float* output_data) {
+  int i = 0;
+  for (; i <= count - 4; i += 4) {
+    // Swap the lanes within each half, then swap the halves.
+    float32x4_t v = vrev64q_f32(vld1q_f32(input_data + count - 4 - i));
+    vst1q_f32(output_data + i, vcombine_f32(vget_high_f32(v), vget_low_f32(v)));
+  }
+  for (; i < count; ++i) {
+    output_data[i] = input_data[count - 1 - i];
+  }
+}
+#endif  // USE_NEON
+
+// Reverses the rows [start, end) of a tensor viewed as
+// [outer_size, dims_at_axis, copy_size]. If `copy_size` is 1 a row is one of
+// the `outer_size` vectors being reversed, otherwise it is one of the
+// `outer_size * dims_at_axis` blocks being moved.
+template <typename Scalar>
+inline void ReverseImpl(int dims_at_axis, int copy_size,
+                        const Scalar* input_data, Scalar* output_data,
+                        int start, int end) {
+  if (copy_size == 1) {
+    for (int i = start; i < end; ++i) {
+      ReverseElements(input_data + i * dims_at_axis, dims_at_axis,
+                      output_data + i * dims_at_axis);
+    }
+    return;
+  }
+  for (int row = start; row < end; ++row) {
+    const int i = row / dims_at_axis;
+    const int j = row % dims_at_axis;
+    memcpy(output_data + row * copy_size,
+           input_data + (i * dims_at_axis + dims_at_axis - j - 1) * copy_size,
+           copy_size * sizeof(Scalar));
+  }
+}
+
+template <typename Scalar>
+struct ReverseWorkerTask : cpu_backend_threadpool::Task {
+  ReverseWorkerTask(int dims_at_axis, int copy_size, const Scalar* input_data,
+                    Scalar* output_data, int start, int end)
+      : dims_at_axis(dims_at_axis),
+        copy_size(copy_size),
+        input_data(input_data),
+        output_data(output_data),
+        start(start),
+        end(end) {}
+  void Run() override {
+    ReverseImpl(dims_at_axis, copy_size, input_data, output_data, start, end);
+  }
+
+  int dims_at_axis;
+  int copy_size;
+  const Scalar* input_data;
+  Scalar* output_data;
+  int start;
+  int end;
+};
+
+// Same as reference_ops::Reverse, but reverses the innermost dimension with
+// SIMD instead of one memcpy per element, and splits large tensors across the
+// threads of `cpu_backend_context`.
+template <typename Scalar>
+void Reverse(int axis, const RuntimeShape& input_shape,
+             const Scalar* input_data, const RuntimeShape& output_shape,
+             Scalar* output_data, CpuBackendContext* cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("Reverse");
+
+  int outer_size = 1;
+  for (int i = 0; i < axis; ++i) {
+    outer_size *= input_shape.Dims(i);
+  }
+  int copy_size = 1;
+  for (int i = axis + 1; i < input_shape.DimensionsCount(); ++i) {
+    copy_size *= input_shape.Dims(i);
+  }
+  const int dims_at_axis = input_shape.Dims(axis);
+  const int rows = copy_size == 1 ? outer_size : outer_size * dims_at_axis;
+
+  // Copying is cheap, only use threads for tensors that take a while.
+  constexpr int kMinElementsPerThread = 16384;
+  const int flat_size = outer_size * dims_at_axis * copy_size;
+  const int thread_count =
+      std::max(1, std::min({rows, flat_size / kMinElementsPerThread,
+                            cpu_backend_context->max_num_threads()}));
+  if (thread_count == 1) {
+    ReverseImpl(dims_at_axis, copy_size, input_data, output_data, 0, rows);
+    return;
+  }
+  std::vector<ReverseWorkerTask<Scalar>> tasks;
+  tasks.reserve(thread_count);
+  int start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    const int end = start + (rows - start) / (thread_count - i);
+    tasks.emplace_back(dims_at_axis, copy_size, input_data, output_data, start,
+                       end);
+    start = end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
+// Accumulates the rows [start, end) of `input_data` into their segments.
+template <typename T>
+inline void SegmentSumImpl(const T* input_data, const int32_t* segment_ids_data,
+                           int segment_flat_size, int start, int end,
+                           T* output_data) {
+  using ArrayMap = Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>;
+  using ConstArrayMap = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>;
+  for (int i = start; i < end; ++i) {
+    ArrayMap(output_data + segment_ids_data[i] * segment_flat_size,
+             segment_flat_size) +=
+        ConstArrayMap(input_data + i * segment_flat_size, segment_flat_size);
+  }
+}
+
+template <typename T>
+struct SegmentSumWorkerTask : cpu_backend_threadpool::Task {
+  SegmentSumWorkerTask(const T* input_data, const int32_t* segment_ids_data,
+                       int segment_flat_size, int start, int end,
+                       T* output_data)
+      : input_data(input_data),
+        segment_ids_data(segment_ids_data),
+        segment_flat_size(segment_flat_size),
+        start(start),
+        end(end),
+        output_data(output_data) {}
+  void Run() override {
+    SegmentSumImpl(input_data, segment_ids_data, segment_flat_size, start, end,
+                   output_data);
+  }
+
+  const T* input_data;
+  const int32_t* segment_ids_data;
+  int segment_flat_size;
+  int start;
+  int end;
+  T* output_data;
+};
+
+// Same as reference_ops::SegmentSum, but vectorizes the accumulation of each
+// row and splits large inputs across the threads of `cpu_backend_context`.
+// The segment ids must be sorted, which the kernel verifies in Prepare, so
+// that every segment is accumulated by a single thread.
+template <typename T>
+inline void SegmentSum(const RuntimeShape& input_shape, const T* input_data,
+                       const RuntimeShape& segment_ids_shape,
+                       const int32_t* segment_ids_data,
+                       const RuntimeShape& output_shape, T* output_data,
+                       CpuBackendContext* cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("SegmentSum");
+  const int segment_flat_size =
+      MatchingFlatSizeSkipDim(input_shape, 0, output_shape);
+  const int rows = input_shape.Dims(0);
+
+  memset(output_data, 0, sizeof(T) * output_shape.FlatSize());
+
+  constexpr int kMinElementsPerThread = 16384;
+  const int thread_count = std::max(
+      1, std::min({rows, rows * segment_flat_size / kMinElementsPerThread,
+                   cpu_backend_context->max_num_threads()}));
+  if (thread_count == 1) {
+    SegmentSumImpl(input_data, segment_ids_data, segment_flat_size, 0, rows,
+                   output_data);
+    return;
+  }
+  std::vector<SegmentSumWorkerTask<T>> tasks;
+  tasks.reserve(thread_count);
+  int start = 0;
+  for (int i = 0; i < thread_count && start < rows; ++i) {
+    int end = start + (rows - start) / (thread_count - i);
+    // Don't split a segment between two threads.
+    while (end > start && end < rows &&
+           segment_ids_data[end] == segment_ids_data[end - 1]) {
+      ++end;
+    }
+    if (end == start) continue;
+    tasks.emplace_back(input_data, segment_ids_data, segment_flat_size, start,
+                       end, output_data);
+    start = end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
 }  // namespace optimized_ops
 }  // namespace tflite
 
@@ -80,6 +80,29 @@ void UnpackDenseInt4IntoInt8(const int8_t* src_buffer, int num_elements,
   }
 }
 
+void UnpackBlockwiseInt4IntoFloat(const int8_t* src_buffer, int num_elements,
+                                  int block_size, const float* scales,
+                                  const int8_t* zero_points,
+                                  float* dst_buffer) {
+  const int num_blocks = num_elements / block_size;
+  const int bytes_per_block = block_size / 2;
+  for (int b = 0; b < num_blocks; ++b) {
+    const int8_t* __restrict__ src = src_buffer + b * bytes_per_block;
+    float* __restrict__ dst = dst_buffer + b * block_size;
+    const float scale = scales[b];
+    const float zero_point =
+        zero_points == nullptr ? 0.0f : static_cast<float>(zero_points[b]);
+    // Keep the inner loop branch free so that it vectorizes.
+    for (int j = 0; j < bytes_per_block; ++j) {
+      const int8_t packed = src[j];
+      const int8_t low = static_cast<int8_t>(packed << 4) >> 4;
+      const int8_t high = packed >> 4;
+      dst[2 * j] = scale * (static_cast<float>(low) - zero_point);
+      dst[2 * j + 1] = scale * (static_cast<float>(high) - zero_point);
+    }
+  }
+}
+
 }  // namespace tensor_utils
 }  // namespace tflite
 
@@ -616,6 +616,27 @@ void ApplySignbitToVector(const float* __restrict__ vector, int v_size,
 void UnpackDenseInt4IntoInt8(const int8_t* src_buffer, int num_elements,
                              int8_t* dst_buffer);
 
+// Dequantizes a densely packed int4 buffer that carries one scale (and
+// optionally one zero point) per block of `block_size` consecutive elements.
+// Parameters:
+//   src_buffer   : Densely packed buffer containing int4 values, in the same
+//                  nibble order as `UnpackDenseInt4IntoInt8`.
+//   num_elements : Number of int4 values to dequantize. Must be a multiple of
+//                  `block_size`.
+//   block_size   : Number of consecutive elements sharing a scale. Must be
+//                  even so that every block starts on a byte boundary.
+//   scales       : `num_elements / block_size` scales.
+//   zero_points  : `num_elements / block_size` zero points, or nullptr if the
+//                  quantization is symmetric.
+//   dst_buffer   : Buffer of size at least `num_elements` to write into.
+// Notes:
+//   dst_buffer[i] = scales[i / block_size] *
+//                   (q[i] - zero_points[i / block_size])
+void UnpackBlockwiseInt4IntoFloat(const int8_t* src_buffer, int num_elements,
+                                  int block_size, const float* scales,
+                                  const int8_t* zero_points,
+                                  float* dst_buffer);
+
 }  // namespace tensor_utils
 
 }  // namespace tflite
@@ -2124,6 +2124,31 @@ TEST(uKernels, UnpackInt4OddLength) {
               testing::Pointwise(testing::Eq(), expected_output));
 }
 
+TEST(uKernels, UnpackBlockwiseInt4IntoFloat) {
+  // Two blocks of four elements: {-8, 3, -2, -5} and {1, 2, 3, 4}.
+  const int8_t input[4] = {0x38, static_cast<int8_t>(0xBE), 0x21, 0x43};
+  const float scales[2] = {0.5f, 2.0f};
+  const int8_t zero_points[2] = {0, 1};
+  const float expected_output[8] = {-4.0f, 1.5f, -1.0f, -2.5f,
+                                    0.0f,  2.0f, 4.0f,  6.0f};
+  float actual_output[8];
+  UnpackBlockwiseInt4IntoFloat(input, 8, 4, scales, zero_points,
+                               actual_output);
+  EXPECT_THAT(actual_output,
+              testing::Pointwise(testing::FloatEq(), expected_output));
+}
+
+TEST(uKernels, UnpackBlockwiseInt4IntoFloatSymmetric) {
+  const int8_t input[2] = {0x38, static_cast<int8_t>(0xBE)};
+  const float scales[2] = {1.0f, -1.0f};
+  const float expected_output[4] = {-8.0f, 3.0f, 2.0f, 5.0f};
+  float actual_output[4];
+  UnpackBlockwiseInt4IntoFloat(input, 4, 2, scales, /*zero_points=*/nullptr,
+                               actual_output);
+  EXPECT_THAT(actual_output,
+              testing::Pointwise(testing::FloatEq(), expected_output));
+}
+
 }  // namespace tensor_utils
 }  // namespace tflite
 
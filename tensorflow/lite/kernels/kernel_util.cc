@@ -336,6 +336,36 @@ TfLiteStatus GetQuantizedConvolutionMultipler(TfLiteContext* context,
   return kTfLiteOk;
 }
 
+TfLiteStatus CheckBlockwiseInt4Weights(TfLiteContext* context,
+                                       const TfLiteTensor* weight) {
+  const auto* blockwise = reinterpret_cast<TfLiteBlockwiseQuantization*>(
+      weight->quantization.params);
+  TF_LITE_ENSURE(context, blockwise != nullptr);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(weight), 2);
+  TF_LITE_ENSURE_EQ(context, blockwise->quantized_dimension, 0);
+  const int rows = SizeOfDimension(weight, 0);
+  const int depth = SizeOfDimension(weight, 1);
+  const int block_size = blockwise->blocksize;
+  // Every block has to start on a byte boundary of the packed weights.
+  TF_LITE_ENSURE(context, block_size > 0 && block_size % 2 == 0);
+  TF_LITE_ENSURE_EQ(context, depth % block_size, 0);
+
+  TF_LITE_ENSURE(context, blockwise->scale >= 0 &&
+                              blockwise->scale < context->tensors_size);
+  const TfLiteTensor* scale = &context->tensors[blockwise->scale];
+  TF_LITE_ENSURE_TYPES_EQ(context, scale->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(scale), 2);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(scale, 0), rows);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(scale, 1), depth / block_size);
+  if (blockwise->zero_point >= 0) {
+    TF_LITE_ENSURE(context, blockwise->zero_point < context->tensors_size);
+    const TfLiteTensor* zero_point = &context->tensors[blockwise->zero_point];
+    TF_LITE_ENSURE_TYPES_EQ(context, zero_point->type, kTfLiteInt8);
+    TF_LITE_ENSURE_EQ(context, NumElements(zero_point), NumElements(scale));
+  }
+  return kTfLiteOk;
+}
+
 namespace {
 
 inline TfLiteStatus Quantize(TfLiteContext* context, float scale,
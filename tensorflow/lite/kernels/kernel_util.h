@@ -228,6 +228,22 @@ inline bool IsHybridOp(const TfLiteTensor* input, const TfLiteTensor* weight) {
           input->type == kTfLiteFloat32);
 }
 
+// Determines whether it is a weight-only op - one that has float inputs and
+// int4 weights carrying one scale (and optionally one zero point) per block of
+// consecutive values along the innermost dimension.
+inline bool IsBlockwiseInt4Op(const TfLiteTensor* input,
+                              const TfLiteTensor* weight) {
+  return input->type == kTfLiteFloat32 && weight->type == kTfLiteInt4 &&
+         weight->quantization.type == kTfLiteBlockwiseQuantization;
+}
+
+// Checks that the block-wise quantization of a 2-D [rows, depth] int4 weight
+// tensor can be used by the weight-only kernels: blocks of an even size along
+// the depth, a float32 [rows, depth / block_size] scale tensor and an optional
+// int8 zero point tensor of the same shape.
+TfLiteStatus CheckBlockwiseInt4Weights(TfLiteContext* context,
+                                       const TfLiteTensor* weight);
+
 // Check dimensionality match and populate OpData for Conv and DepthwiseConv.
 TfLiteStatus PopulateConvolutionQuantizationParams(
     TfLiteContext* context, const TfLiteTensor* input,
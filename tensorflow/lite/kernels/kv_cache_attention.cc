@@ -0,0 +1,254 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace kv_cache_attention {
+
+// Causal scaled dot-product attention over a key/value cache owned by the op.
+//
+// Inputs:
+//   0: query     float32 [batch, steps, num_heads, head_dim]
+//   1: key       float32 [batch, steps, num_kv_heads, head_dim]
+//   2: value     float32 [batch, steps, num_kv_heads, head_dim]
+//   3: start_pos int32 scalar, the position of the first of the `steps` new
+//                tokens. Passing 0 starts a new sequence.
+// Outputs:
+//   0: output    float32 [batch, steps, num_heads, head_dim]
+//
+// The new keys and values are written in place at [start_pos, start_pos +
+// steps) of the cache, which keeps its contents across invocations. Query `t`
+// then attends to the cached positions [0, start_pos + t]. Only the new rows
+// are copied, so the per-token cost of updating the cache is proportional to
+// num_kv_heads * head_dim rather than to the cache size. num_heads has to be
+// a multiple of num_kv_heads (grouped-query attention).
+//
+// Custom options (flexbuffer map):
+//   max_seq_len: int   capacity of the cache, required.
+//   scale:       float scale applied to the logits, 1 / sqrt(head_dim) if
+//                absent or zero.
+
+constexpr int kQueryTensor = 0;
+constexpr int kKeyTensor = 1;
+constexpr int kValueTensor = 2;
+constexpr int kStartPosTensor = 3;
+constexpr int kOutputTensor = 0;
+
+constexpr char kMaxSeqLenStr[] = "max_seq_len";
+constexpr char kScaleStr[] = "scale";
+
+struct OpData {
+  int max_seq_len = 0;
+  float scale = 0.0f;
+  // Cache layout is [batch, max_seq_len, num_kv_heads, head_dim].
+  std::vector<float> key_cache;
+  std::vector<float> value_cache;
+  // Attention weights of a single query.
+  std::vector<float> scores;
+};
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  OpData* op_data = new OpData;
+  if (buffer != nullptr && length > 0) {
+    const flexbuffers::Map& m =
+        flexbuffers::GetRoot(reinterpret_cast<const uint8_t*>(buffer), length)
+            .AsMap();
+    op_data->max_seq_len = m[kMaxSeqLenStr].AsInt32();
+    op_data->scale = m[kScaleStr].AsFloat();
+  }
+  return op_data;
+}
+
+void Free(TfLiteContext* context, void* buffer) {
+  delete reinterpret_cast<OpData*>(buffer);
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 4);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+  TF_LITE_ENSURE(context, op_data->max_seq_len > 0);
+
+  const TfLiteTensor* query;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kQueryTensor, &query));
+  const TfLiteTensor* key;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kKeyTensor, &key));
+  const TfLiteTensor* value;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kValueTensor, &value));
+  const TfLiteTensor* start_pos;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kStartPosTensor, &start_pos));
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kOutputTensor, &output));
+
+  TF_LITE_ENSURE_TYPES_EQ(context, query->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_TYPES_EQ(context, key->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_TYPES_EQ(context, value->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_TYPES_EQ(context, start_pos->type, kTfLiteInt32);
+  TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, NumElements(start_pos), 1);
+
+  TF_LITE_ENSURE_EQ(context, NumDimensions(query), 4);
+  TF_LITE_ENSURE(context, HaveSameShapes(key, value));
+  TF_LITE_ENSURE_EQ(context, NumDimensions(key), 4);
+  const int batch = SizeOfDimension(query, 0);
+  const int steps = SizeOfDimension(query, 1);
+  const int num_heads = SizeOfDimension(query, 2);
+  const int head_dim = SizeOfDimension(query, 3);
+  const int num_kv_heads = SizeOfDimension(key, 2);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(key, 0), batch);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(key, 1), steps);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(key, 3), head_dim);
+  TF_LITE_ENSURE(context, num_kv_heads > 0);
+  TF_LITE_ENSURE_EQ(context, num_heads % num_kv_heads, 0);
+  TF_LITE_ENSURE(context, steps <= op_data->max_seq_len);
+
+  // Resizing the inputs, e.g. to switch between prefill and decoding, must not
+  // drop the cache unless its shape changes.
+  const size_t cache_size = static_cast<size_t>(batch) * op_data->max_seq_len *
+                            num_kv_heads * head_dim;
+  if (op_data->key_cache.size() != cache_size) {
+    op_data->key_cache.assign(cache_size, 0.0f);
+    op_data->value_cache.assign(cache_size, 0.0f);
+  }
+  op_data->scores.resize(op_data->max_seq_len);
+
+  return context->ResizeTensor(context, output,
+                               TfLiteIntArrayCopy(query->dims));
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+  const TfLiteTensor* query;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kQueryTensor, &query));
+  const TfLiteTensor* key;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kKeyTensor, &key));
+  const TfLiteTensor* value;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kValueTensor, &value));
+  const TfLiteTensor* start_pos_tensor;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kStartPosTensor,
+                                          &start_pos_tensor));
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kOutputTensor, &output));
+
+  const int batch = SizeOfDimension(query, 0);
+  const int steps = SizeOfDimension(query, 1);
+  const int num_heads = SizeOfDimension(query, 2);
+  const int head_dim = SizeOfDimension(query, 3);
+  const int num_kv_heads = SizeOfDimension(key, 2);
+  const int heads_per_kv_head = num_heads / num_kv_heads;
+  const int max_seq_len = op_data->max_seq_len;
+  const int start_pos = *GetTensorData<int32_t>(start_pos_tensor);
+  if (start_pos < 0 || start_pos + steps > max_seq_len) {
+    TF_LITE_KERNEL_LOG(context,
+                       "KV cache overflow: start_pos %d with %d steps does not "
+                       "fit a cache of %d positions.",
+                       start_pos, steps, max_seq_len);
+    return kTfLiteError;
+  }
+  const float scale = op_data->scale != 0.0f
+                          ? op_data->scale
+                          : 1.0f / std::sqrt(static_cast<float>(head_dim));
+
+  // Append the new keys and values. Rows of all kv heads are contiguous in
+  // both the inputs and the cache, so each step is a single copy.
+  const int row_size = num_kv_heads * head_dim;
+  const float* key_data = GetTensorData<float>(key);
+  const float* value_data = GetTensorData<float>(value);
+  for (int b = 0; b < batch; ++b) {
+    const size_t cache_offset =
+        (static_cast<size_t>(b) * max_seq_len + start_pos) * row_size;
+    const size_t input_offset = static_cast<size_t>(b) * steps * row_size;
+    std::memcpy(op_data->key_cache.data() + cache_offset,
+                key_data + input_offset, steps * row_size * sizeof(float));
+    std::memcpy(op_data->value_cache.data() + cache_offset,
+                value_data + input_offset, steps * row_size * sizeof(float));
+  }
+
+  const float* query_data = GetTensorData<float>(query);
+  float* output_data = GetTensorData<float>(output);
+  float* scores = op_data->scores.data();
+  for (int b = 0; b < batch; ++b) {
+    const float* key_cache =
+        op_data->key_cache.data() + static_cast<size_t>(b) * max_seq_len *
+                                        row_size;
+    const float* value_cache =
+        op_data->value_cache.data() + static_cast<size_t>(b) * max_seq_len *
+                                          row_size;
+    for (int t = 0; t < steps; ++t) {
+      // Causal mask: the query only sees itself and earlier positions.
+      const int length = start_pos + t + 1;
+      for (int h = 0; h < num_heads; ++h) {
+        const int kv_head = h / heads_per_kv_head;
+        const size_t qo_offset =
+            ((static_cast<size_t>(b) * steps + t) * num_heads + h) * head_dim;
+        const float* q = query_data + qo_offset;
+
+        float max_score = -INFINITY;
+        for (int j = 0; j < length; ++j) {
+          const float* k = key_cache + j * row_size + kv_head * head_dim;
+          float dot = 0.0f;
+          for (int d = 0; d < head_dim; ++d) dot += q[d] * k[d];
+          scores[j] = dot * scale;
+          max_score = std::max(max_score, scores[j]);
+        }
+        float sum = 0.0f;
+        for (int j = 0; j < length; ++j) {
+          scores[j] = std::exp(scores[j] - max_score);
+          sum += scores[j];
+        }
+        const float inv_sum = 1.0f / sum;
+
+        float* out = output_data + qo_offset;
+        std::fill(out, out + head_dim, 0.0f);
+        for (int j = 0; j < length; ++j) {
+          const float weight = scores[j] * inv_sum;
+          const float* v = value_cache + j * row_size + kv_head * head_dim;
+          for (int d = 0; d < head_dim; ++d) out[d] += weight * v[d];
+        }
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace kv_cache_attention
+
+TfLiteRegistration* Register_KV_CACHE_ATTENTION() {
+  static TfLiteRegistration r = {kv_cache_attention::Init,
+                                 kv_cache_attention::Free,
+                                 kv_cache_attention::Prepare,
+                                 kv_cache_attention::Eval};
+  return &r;
+}
+
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
@@ -0,0 +1,129 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <stdint.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/kernels/custom_ops_register.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+class KVCacheAttentionOpModel : public SingleOpModel {
+ public:
+  KVCacheAttentionOpModel(const std::vector<int>& query_shape,
+                          const std::vector<int>& kv_shape, int max_seq_len) {
+    query_ = AddInput({TensorType_FLOAT32, query_shape});
+    key_ = AddInput({TensorType_FLOAT32, kv_shape});
+    value_ = AddInput({TensorType_FLOAT32, kv_shape});
+    start_pos_ = AddInput({TensorType_INT32, {1}});
+    output_ = AddOutput({TensorType_FLOAT32, {}});
+
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() { fbb.Int("max_seq_len", max_seq_len); });
+    fbb.Finish();
+    SetCustomOp("KVCacheAttention", fbb.GetBuffer(),
+                ops::custom::Register_KV_CACHE_ATTENTION);
+    BuildInterpreter({GetShape(query_), GetShape(key_), GetShape(value_),
+                      GetShape(start_pos_)});
+  }
+
+  TfLiteStatus Step(int start_pos, const std::vector<float>& query,
+                    const std::vector<float>& key,
+                    const std::vector<float>& value) {
+    PopulateTensor(query_, query);
+    PopulateTensor(key_, key);
+    PopulateTensor(value_, value);
+    PopulateTensor<int32_t>(start_pos_, {start_pos});
+    return Invoke();
+  }
+
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ private:
+  int query_;
+  int key_;
+  int value_;
+  int start_pos_;
+  int output_;
+};
+
+// Attention weight of the first of two keys whose logits differ by `delta`.
+float FirstWeight(float delta) { return 1.0f / (1.0f + std::exp(-delta)); }
+
+TEST(KVCacheAttentionOpTest, DecodesOneTokenAtATime) {
+  // batch = 1, steps = 1, heads = 1, head_dim = 2.
+  KVCacheAttentionOpModel m({1, 1, 1, 2}, {1, 1, 1, 2}, /*max_seq_len=*/4);
+
+  // A single cached position is attended to with weight 1.
+  ASSERT_EQ(m.Step(0, {1, 0}, {1, 0}, {1, 2}), kTfLiteOk);
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({1, 1, 1, 2}));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({1, 2})));
+
+  // The second step sees both cached positions.
+  ASSERT_EQ(m.Step(1, {1, 0}, {0, 1}, {3, 4}), kTfLiteOk);
+  const float w = FirstWeight(1.0f / std::sqrt(2.0f));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
+                                 {w * 1 + (1 - w) * 3, w * 2 + (1 - w) * 4})));
+
+  // Restarting at position 0 drops what was cached.
+  ASSERT_EQ(m.Step(0, {1, 0}, {1, 0}, {5, 6}), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({5, 6})));
+}
+
+TEST(KVCacheAttentionOpTest, PrefillIsCausal) {
+  // batch = 1, steps = 2, heads = 1, head_dim = 2.
+  KVCacheAttentionOpModel m({1, 2, 1, 2}, {1, 2, 1, 2}, /*max_seq_len=*/4);
+  ASSERT_EQ(m.Step(0, {1, 0, 1, 0}, {1, 0, 0, 1}, {1, 2, 3, 4}), kTfLiteOk);
+  const float w = FirstWeight(1.0f / std::sqrt(2.0f));
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray(ArrayFloatNear({
+                  1, 2,                                        // t = 0
+                  w * 1 + (1 - w) * 3, w * 2 + (1 - w) * 4,  // t = 1
+              })));
+}
+
+TEST(KVCacheAttentionOpTest, GroupedQueryHeadsShareKVHead) {
+  // Two query heads read the same kv head.
+  KVCacheAttentionOpModel m({1, 1, 2, 2}, {1, 1, 1, 2}, /*max_seq_len=*/2);
+  ASSERT_EQ(m.Step(0, {1, 0, 0, 1}, {1, 0}, {1, 2}), kTfLiteOk);
+  ASSERT_EQ(m.Step(1, {1, 0, 0, 1}, {0, 1}, {3, 4}), kTfLiteOk);
+  const float w = FirstWeight(1.0f / std::sqrt(2.0f));
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray(ArrayFloatNear({
+                  w * 1 + (1 - w) * 3, w * 2 + (1 - w) * 4,  // h = 0
+                  (1 - w) * 1 + w * 3, (1 - w) * 2 + w * 4,  // h = 1
+              })));
+}
+
+TEST(KVCacheAttentionOpTest, RejectsCacheOverflow) {
+  KVCacheAttentionOpModel m({1, 1, 1, 2}, {1, 1, 1, 2}, /*max_seq_len=*/2);
+  ASSERT_EQ(m.Step(1, {1, 0}, {1, 0}, {1, 2}), kTfLiteOk);
+  EXPECT_EQ(m.Step(2, {1, 0}, {1, 0}, {1, 2}), kTfLiteError);
+  EXPECT_EQ(m.Step(-1, {1, 0}, {1, 0}, {1, 2}), kTfLiteError);
+}
+
+}  // namespace
+}  // namespace tflite
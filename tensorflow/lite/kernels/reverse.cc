@@ -16,7 +16,8 @@ limitations under the License.
 #include <stdint.h>
 
 #include "tensorflow/lite/core/c/common.h"
-#include "tensorflow/lite/kernels/internal/reference/reference_ops.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/tensor.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
@@ -88,42 +89,50 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_OK(context,
                     GetOutputSafe(context, node, kOutputTensor, &output));
 
+  CpuBackendContext* cpu_backend_context =
+      CpuBackendContext::GetFromContext(context);
   switch (output->type) {
     case kTfLiteFloat32: {
-      reference_ops::Reverse<float>(
+      optimized_ops::Reverse<float>(
           axis, GetTensorShape(input), GetTensorData<float>(input),
-          GetTensorShape(output), GetTensorData<float>(output));
+          GetTensorShape(output), GetTensorData<float>(output),
+          cpu_backend_context);
       break;
     }
     case kTfLiteUInt8:
     case kTfLiteInt8: {
-      reference_ops::Reverse<uint8_t>(
+      optimized_ops::Reverse<uint8_t>(
           axis, GetTensorShape(input), GetTensorData<uint8_t>(input),
-          GetTensorShape(output), GetTensorData<uint8_t>(output));
+          GetTensorShape(output), GetTensorData<uint8_t>(output),
+          cpu_backend_context);
       break;
     }
     case kTfLiteInt16: {
-      reference_ops::Reverse<int16_t>(
+      optimized_ops::Reverse<int16_t>(
           axis, GetTensorShape(input), GetTensorData<int16_t>(input),
-          GetTensorShape(output), GetTensorData<int16_t>(output));
+          GetTensorShape(output), GetTensorData<int16_t>(output),
+          cpu_backend_context);
       break;
     }
     case kTfLiteInt32: {
-      reference_ops::Reverse<int32_t>(
+      optimized_ops::Reverse<int32_t>(
           axis, GetTensorShape(input), GetTensorData<int32_t>(input),
-          GetTensorShape(output), GetTensorData<int32_t>(output));
+          GetTensorShape(output), GetTensorData<int32_t>(output),
+          cpu_backend_context);
       break;
     }
     case kTfLiteInt64: {
-      reference_ops::Reverse<int64_t>(
+      optimized_ops::Reverse<int64_t>(
           axis, GetTensorShape(input), GetTensorData<int64_t>(input),
-          GetTensorShape(output), GetTensorData<int64_t>(output));
+          GetTensorShape(output), GetTensorData<int64_t>(output),
+          cpu_backend_context);
       break;
     }
     case kTfLiteBool: {
-      reference_ops::Reverse<bool>(
+      optimized_ops::Reverse<bool>(
           axis, GetTensorShape(input), GetTensorData<bool>(input),
-          GetTensorShape(output), GetTensorData<bool>(output));
+          GetTensorShape(output), GetTensorData<bool>(output),
+          cpu_backend_context);
       break;
     }
     default: {
@@ -29,7 +29,8 @@ using ::testing::ElementsAreArray;
 template <typename T>
 class ReverseOpModel : public SingleOpModel {
  public:
-  ReverseOpModel(const TensorData& input, const TensorData& axis) {
+  ReverseOpModel(const TensorData& input, const TensorData& axis,
+                 int num_threads = -1) {
     input_ = AddInput(input);
     axis_ = AddInput(axis);
 
@@ -37,7 +38,9 @@ class ReverseOpModel : public SingleOpModel {
 
     SetBuiltinOp(BuiltinOperator_REVERSE_V2, BuiltinOptions_ReverseV2Options,
                  CreateReverseV2Options(builder_).Union());
-    BuildInterpreter({GetShape(input_)});
+    BuildInterpreter({GetShape(input_)}, num_threads,
+                     /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/true);
   }
 
   int input() { return input_; }
@@ -80,6 +83,49 @@ TEST(ReverseOpTest, FloatMultiDimensions) {
                         17, 18, 15, 16, 13, 14, 23, 24, 21, 22, 19, 20}));
 }
 
+// Large enough to be split across threads, with an innermost dimension that
+// isn't a multiple of the SIMD width.
+TEST(ReverseOpTest, FloatLargeInnermostDimensionMultiThreaded) {
+  constexpr int kRows = 512;
+  constexpr int kCols = 67;
+  ReverseOpModel<float> model({TensorType_FLOAT32, {kRows, kCols}},
+                              {TensorType_INT32, {1}}, /*num_threads=*/4);
+  std::vector<float> input(kRows * kCols);
+  std::vector<float> expected(kRows * kCols);
+  for (int i = 0; i < kRows; ++i) {
+    for (int j = 0; j < kCols; ++j) {
+      input[i * kCols + j] = i * kCols + j;
+      expected[i * kCols + kCols - j - 1] = i * kCols + j;
+    }
+  }
+  model.PopulateTensor<float>(model.input(), input);
+  model.PopulateTensor<int32_t>(model.axis(), {-1});
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(model.GetOutputShape(), ElementsAre(kRows, kCols));
+  EXPECT_THAT(model.GetOutput(), ElementsAreArray(expected));
+}
+
+TEST(ReverseOpTest, FloatLargeOuterDimensionMultiThreaded) {
+  constexpr int kRows = 1024;
+  constexpr int kCols = 33;
+  ReverseOpModel<float> model({TensorType_FLOAT32, {kRows, kCols}},
+                              {TensorType_INT32, {1}}, /*num_threads=*/4);
+  std::vector<float> input(kRows * kCols);
+  std::vector<float> expected(kRows * kCols);
+  for (int i = 0; i < kRows; ++i) {
+    for (int j = 0; j < kCols; ++j) {
+      input[i * kCols + j] = i * kCols + j;
+      expected[(kRows - i - 1) * kCols + j] = i * kCols + j;
+    }
+  }
+  model.PopulateTensor<float>(model.input(), input);
+  model.PopulateTensor<int32_t>(model.axis(), {0});
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(model.GetOutput(), ElementsAreArray(expected));
+}
+
 // int32 tests
 TEST(ReverseOpTest, Int32OneDimension) {
   ReverseOpModel<int32_t> model({TensorType_INT32, {4}},
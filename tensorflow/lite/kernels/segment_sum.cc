@@ -16,7 +16,8 @@ limitations under the License.
 #include <stdint.h>
 
 #include "tensorflow/lite/core/c/common.h"
-#include "tensorflow/lite/kernels/internal/reference/reference_ops.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/tensor.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
@@ -101,11 +102,14 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
                       ResizeOutputTensor(context, data, segment_ids, output));
   }
 
+  CpuBackendContext* cpu_backend_context =
+      CpuBackendContext::GetFromContext(context);
 #define TF_LITE_SEGMENT_SUM(dtype)                                      \
-  reference_ops::SegmentSum<dtype>(                                     \
+  optimized_ops::SegmentSum<dtype>(                                     \
       GetTensorShape(data), GetTensorData<dtype>(data),                 \
       GetTensorShape(segment_ids), GetTensorData<int32_t>(segment_ids), \
-      GetTensorShape(output), GetTensorData<dtype>(output));
+      GetTensorShape(output), GetTensorData<dtype>(output),             \
+      cpu_backend_context);
   switch (data->type) {
     case kTfLiteInt32:
       TF_LITE_SEGMENT_SUM(int32_t);
@@ -28,12 +28,15 @@ using ::testing::ElementsAreArray;
 template <typename T>
 class SegmentSumOpModel : public SingleOpModel {
  public:
-  SegmentSumOpModel(const TensorData& data, const TensorData& segment_ids) {
+  SegmentSumOpModel(const TensorData& data, const TensorData& segment_ids,
+                    int num_threads = -1) {
     data_id_ = AddInput(data);
     segment_ids_id_ = AddInput(segment_ids);
     output_id_ = AddOutput(data.type);
     SetBuiltinOp(BuiltinOperator_SEGMENT_SUM, BuiltinOptions_NONE, 0);
-    BuildInterpreter({GetShape(data_id_), GetShape(segment_ids_id_)});
+    BuildInterpreter({GetShape(data_id_), GetShape(segment_ids_id_)},
+                     num_threads, /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/true);
   }
 
   int data() const { return data_id_; }
@@ -110,6 +113,33 @@ TEST(SegmentSumOpModelTest, Float32Test_ThreeDimensions) {
   EXPECT_THAT(model.GetOutputShape(), ElementsAreArray({2, 2, 1}));
 }
 
+TEST(SegmentSumOpModelTest, Float32Test_LargeMultiThreaded) {
+  // Large enough to be split across threads, with segments that straddle the
+  // even split points.
+  constexpr int kRows = 1000;
+  constexpr int kCols = 64;
+  constexpr int kRowsPerSegment = 7;
+  constexpr int kSegments = (kRows + kRowsPerSegment - 1) / kRowsPerSegment;
+  SegmentSumOpModel<float> model({TensorType_FLOAT32, {kRows, kCols}},
+                                 {TensorType_INT32, {kRows}},
+                                 /*num_threads=*/4);
+  std::vector<float> data(kRows * kCols);
+  std::vector<int32_t> segment_ids(kRows);
+  std::vector<float> expected(kSegments * kCols, 0);
+  for (int i = 0; i < kRows; ++i) {
+    segment_ids[i] = i / kRowsPerSegment;
+    for (int j = 0; j < kCols; ++j) {
+      data[i * kCols + j] = (i + j) % 10;
+      expected[segment_ids[i] * kCols + j] += (i + j) % 10;
+    }
+  }
+  model.PopulateTensor<float>(model.data(), data);
+  model.PopulateTensor<int32_t>(model.segment_ids(), segment_ids);
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  EXPECT_THAT(model.GetOutput(), ElementsAreArray(expected));
+  EXPECT_THAT(model.GetOutputShape(), ElementsAreArray({kSegments, kCols}));
+}
+
 TEST(SegmentSumOpModelTest, TestFailIfSegmentsAreNotSorted) {
   SegmentSumOpModel<int32_t> model({TensorType_INT32, {3, 2}},
                                    {TensorType_INT32, {3}});
@@ -284,6 +284,54 @@ class SingleOpModel {
     return AddConstInput(t, data.data(), data.size());
   }
 
+  // Adds a constant INT4 input of the given 2-D shape whose rows are quantized
+  // with one scale, and optionally one zero point, per `block_size` values.
+  // `values` holds one int4 value per element; they are packed densely. The
+  // scale and zero point tensors are part of the model but not op inputs.
+  int AddConstBlockwiseInt4Input(const std::vector<int>& shape,
+                                 const std::vector<int8_t>& values,
+                                 const std::vector<float>& scales,
+                                 const std::vector<int8_t>& zero_points,
+                                 int block_size) {
+    CHECK_EQ(shape.size(), 2);
+    const std::vector<int> scale_shape = {shape[0], shape[1] / block_size};
+    const int scale_id = AddTensor<float>(
+        TensorData{TensorType_FLOAT32, scale_shape}, scales.data(),
+        scales.size());
+    int zero_point_id = -1;
+    if (!zero_points.empty()) {
+      zero_point_id =
+          AddTensor<int8_t>(TensorData{TensorType_INT8, scale_shape},
+                            zero_points.data(), zero_points.size());
+    }
+
+    std::vector<uint8_t> packed((values.size() + 1) / 2, 0);
+    for (size_t i = 0; i < values.size(); ++i) {
+      const uint8_t nibble = static_cast<uint8_t>(values[i]) & 0x0F;
+      packed[i / 2] |= (i % 2 == 0) ? nibble : (nibble << 4);
+    }
+    if (buffers_.empty()) {
+      buffers_.push_back(CreateBuffer(builder_, builder_.CreateVector({})));
+    }
+    const int buffer_id = buffers_.size();
+    buffers_.push_back(CreateBuffer(builder_, builder_.CreateVector(packed)));
+
+    auto q_params = CreateQuantizationParameters(
+        builder_, /*min=*/0, /*max=*/0, /*scale=*/0, /*zero_point=*/0,
+        QuantizationDetails_BlockwiseQuantization,
+        CreateBlockwiseQuantization(builder_, scale_id, zero_point_id,
+                                    block_size)
+            .Union(),
+        /*quantized_dimension=*/0);
+    const int id = tensors_.size();
+    tensors_.push_back(CreateTensor(builder_, builder_.CreateVector<int>(shape),
+                                    TensorType_INT4, /*buffer=*/buffer_id,
+                                    /*name=*/0, q_params));
+    tensor_data_[id] = TensorData{TensorType_INT4, shape};
+    inputs_.push_back(id);
+    return id;
+  }
+
   // TODO(b/166202747): Use a better way to do type specialization. Reduce
   // duplicate code in the two functions below.
   int AddConstSparseInput(const TensorData& t,
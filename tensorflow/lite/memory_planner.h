@@ -15,12 +15,30 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_MEMORY_PLANNER_H_
 #define TENSORFLOW_LITE_MEMORY_PLANNER_H_
 
+#include <cstddef>
 #include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
 
 namespace tflite {
 
+// The place of a tensor in one of the memory arenas of a MemoryPlanner, see
+// MemoryPlanner::GetArenaAllocations().
+struct ArenaTensorAllocation {
+  int tensor;
+  // Either kTfLiteArenaRw or kTfLiteArenaRwPersistent.
+  TfLiteAllocationType allocation_type;
+  // Offset of the tensor from the start of its arena, and its size in bytes.
+  size_t offset;
+  size_t size;
+  // Indices in the execution plan of the first and the last node which need
+  // the tensor to be allocated. Tensors that must survive the whole inference,
+  // like graph outputs and persistent tensors, have the index of the last node
+  // as `last_node`.
+  int first_node;
+  int last_node;
+};
+
 // A MemoryPlanner is responsible for planning and executing a number of
 // memory-related operations that are necessary in TF Lite.
 class MemoryPlanner {
@@ -69,6 +87,13 @@ class MemoryPlanner {
   // Returns a map of allocation information. It's only used for debugging.
   virtual void GetAllocInfo(size_t *arena_size,
                             size_t *arena_persist_size) const = 0;
+
+  // Appends the planned place of every arena allocated tensor to `allocs`, in
+  // order of tensor index. Tensors sharing the buffer of another tensor take no
+  // space of their own and are not included. Planners that don't use arenas
+  // return nothing. It's only used for debugging.
+  virtual void GetArenaAllocations(
+      std::vector<ArenaTensorAllocation>* allocs) const {}
 };
 
 }  // namespace tflite
@@ -15,7 +15,11 @@ limitations under the License.
 
 #include "tensorflow/lite/signature_runner.h"
 
+#include <cstring>
+#include <vector>
+
 #include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
 
 namespace tflite {
 
@@ -50,6 +54,28 @@ const TfLiteTensor* SignatureRunner::output_tensor(
   return subgraph_->tensor(it->second);
 }
 
+TfLiteStatus SignatureRunner::SetCustomAllocationForInputTensor(
+    const char* input_name, const TfLiteCustomAllocation& allocation,
+    int64_t flags) {
+  const auto& it = signature_def_->inputs.find(input_name);
+  if (it == signature_def_->inputs.end()) {
+    subgraph_->ReportError("Input name %s was not found", input_name);
+    return kTfLiteError;
+  }
+  return subgraph_->SetCustomAllocationForTensor(it->second, allocation, flags);
+}
+
+TfLiteStatus SignatureRunner::SetCustomAllocationForOutputTensor(
+    const char* output_name, const TfLiteCustomAllocation& allocation,
+    int64_t flags) {
+  const auto& it = signature_def_->outputs.find(output_name);
+  if (it == signature_def_->outputs.end()) {
+    subgraph_->ReportError("Output name %s was not found", output_name);
+    return kTfLiteError;
+  }
+  return subgraph_->SetCustomAllocationForTensor(it->second, allocation, flags);
+}
+
 TfLiteStatus SignatureRunner::ResizeInputTensor(
     const char* input_name, const std::vector<int>& new_size) {
   const auto& it = signature_def_->inputs.find(input_name);
@@ -85,4 +111,86 @@ TfLiteStatus SignatureRunner::Invoke() {
   return kTfLiteOk;
 }
 
+TfLiteStatus SignatureRunner::InvokeBatched(
+    const std::vector<BatchedRequest>& requests) {
+  for (const BatchedRequest& request : requests) {
+    if (request.inputs.size() != input_names_.size() ||
+        request.outputs.size() != output_names_.size()) {
+      subgraph_->ReportError(
+          "Batched request has %zu inputs and %zu outputs, expected %zu and "
+          "%zu",
+          request.inputs.size(), request.outputs.size(), input_names_.size(),
+          output_names_.size());
+      return kTfLiteError;
+    }
+  }
+  if (requests.empty()) return kTfLiteOk;
+
+  std::vector<int> input_indices;
+  bool batch_resizable = true;
+  for (const char* input_name : input_names_) {
+    const int tensor_index = signature_def_->inputs.at(input_name);
+    const TfLiteTensor* tensor = subgraph_->tensor(tensor_index);
+    if (tensor->dims->size == 0 || tensor->type == kTfLiteString) {
+      subgraph_->ReportError("Input %s can't be batched", input_name);
+      return kTfLiteError;
+    }
+    batch_resizable &= tensor->dims_signature != nullptr &&
+                       tensor->dims_signature->size > 0 &&
+                       tensor->dims_signature->data[0] == -1;
+    input_indices.push_back(tensor_index);
+  }
+  const int num_requests = static_cast<int>(requests.size());
+  const int num_inputs = static_cast<int>(input_indices.size());
+  const int num_outputs = static_cast<int>(output_names_.size());
+  const int batch_size = batch_resizable ? num_requests : 1;
+
+  bool resized = false;
+  for (int i = 0; i < num_inputs; ++i) {
+    const TfLiteTensor* tensor = subgraph_->tensor(input_indices[i]);
+    if (tensor->dims->data[0] == batch_size) continue;
+    if (!batch_resizable) {
+      subgraph_->ReportError("Input %s doesn't have a batch size of 1",
+                             input_names_[i]);
+      return kTfLiteError;
+    }
+    std::vector<int> new_size(tensor->dims->data,
+                              tensor->dims->data + tensor->dims->size);
+    new_size[0] = batch_size;
+    TF_LITE_ENSURE_STATUS(
+        subgraph_->ResizeInputTensor(input_indices[i], new_size));
+    resized = true;
+  }
+  if (resized) {
+    TF_LITE_ENSURE_STATUS(AllocateTensors());
+  }
+
+  for (int first = 0; first < num_requests; first += batch_size) {
+    for (int i = 0; i < num_inputs; ++i) {
+      TfLiteTensor* tensor = subgraph_->tensor(input_indices[i]);
+      const size_t item_bytes = tensor->bytes / batch_size;
+      for (int b = 0; b < batch_size; ++b) {
+        std::memcpy(tensor->data.raw + b * item_bytes,
+                    requests[first + b].inputs[i], item_bytes);
+      }
+    }
+    TF_LITE_ENSURE_STATUS(Invoke());
+    for (int i = 0; i < num_outputs; ++i) {
+      const TfLiteTensor* tensor = output_tensor(output_names_[i]);
+      if (tensor->dims->size == 0 || tensor->dims->data[0] != batch_size ||
+          tensor->type == kTfLiteString) {
+        subgraph_->ReportError("Output %s can't be split into requests",
+                               output_names_[i]);
+        return kTfLiteError;
+      }
+      const size_t item_bytes = tensor->bytes / batch_size;
+      for (int b = 0; b < batch_size; ++b) {
+        std::memcpy(requests[first + b].outputs[i],
+                    tensor->data.raw + b * item_bytes, item_bytes);
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
 }  // namespace tflite
@@ -137,6 +137,47 @@ class SignatureRunner {
   /// signature in dependency order).
   TfLiteStatus Invoke();
 
+  /// \brief Assigns (or reassigns) a custom memory allocation for the given
+  /// input or output tensor of the signature. `flags` is a bitmask, see
+  /// TfLiteCustomAllocationFlags. The runtime does NOT take ownership of the
+  /// underlying memory. See `Interpreter::SetCustomAllocationForTensor` for
+  /// the conditions the allocation has to satisfy.
+  ///
+  /// NOTE: User needs to call AllocateTensors() after this. Reassigning the
+  /// allocation of a tensor that already has a custom allocation doesn't
+  /// change the memory plan, so that call is cheap.
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetCustomAllocationForInputTensor(
+      const char* input_name, const TfLiteCustomAllocation& allocation,
+      int64_t flags = kTfLiteCustomAllocationFlagsNone);
+  TfLiteStatus SetCustomAllocationForOutputTensor(
+      const char* output_name, const TfLiteCustomAllocation& allocation,
+      int64_t flags = kTfLiteCustomAllocationFlagsNone);
+
+  /// The data of one request for `InvokeBatched`.
+  /// WARNING: This is an experimental API and subject to change.
+  struct BatchedRequest {
+    /// The data of every input, in `input_names()` order. Each holds the
+    /// bytes of the input tensor for a batch size of 1.
+    std::vector<const void*> inputs;
+    /// Buffers receiving every output, in `output_names()` order. Each must
+    /// hold the bytes of the output tensor for a batch size of 1.
+    std::vector<void*> outputs;
+  };
+
+  /// Runs independent requests whose inputs have a batch size of 1, i.e. a
+  /// leading dimension of 1. If the leading dimension of every input can be
+  /// resized (it is `-1` in `dims_signature`), the inputs of all requests are
+  /// stacked along that dimension and the signature is invoked once, after
+  /// which every output is split along its leading dimension. Otherwise the
+  /// requests are invoked one after the other.
+  /// Input tensors keep the batch size of the last invocation so that
+  /// repeated calls with the same number of requests don't reallocate; calls
+  /// with different numbers of requests reuse the memory plan of each size.
+  /// String tensors aren't supported.
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus InvokeBatched(const std::vector<BatchedRequest>& requests);
+
   /// Attempts to cancel in flight invocation if any.
   /// This will not affect calls to `Invoke` that happend after this.
   /// Non blocking and thread safe.
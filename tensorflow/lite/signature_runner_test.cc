@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/lite/signature_runner.h"
 
 #include <string>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -22,6 +23,7 @@ limitations under the License.
 #include "tensorflow/lite/core/interpreter_builder.h"
 #include "tensorflow/lite/core/kernels/register.h"
 #include "tensorflow/lite/testing/util.h"
+#include "tensorflow/lite/util.h"
 
 namespace tflite {
 namespace {
@@ -93,5 +95,86 @@ TEST(SignatureRunnerTest, TestMultiSignatures) {
   ASSERT_EQ(sub_output->data.f[2], 3);
 }
 
+TEST(SignatureRunnerTest, TestInvokeBatched) {
+  TestErrorReporter reporter;
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_signatures.bin", &reporter);
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolver resolver;
+  InterpreterBuilder builder(*model, resolver);
+
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(builder(&interpreter), kTfLiteOk);
+  ASSERT_NE(interpreter, nullptr);
+
+  SignatureRunner* add_runner = interpreter->GetSignatureRunner("add");
+  ASSERT_NE(add_runner, nullptr);
+  ASSERT_EQ(add_runner->ResizeInputTensor("x", {1}), kTfLiteOk);
+  ASSERT_EQ(add_runner->AllocateTensors(), kTfLiteOk);
+
+  // Runs different numbers of requests, each adding 2 to its input.
+  for (int num_requests : {3, 1, 2, 3}) {
+    std::vector<float> inputs(num_requests);
+    std::vector<float> outputs(num_requests, 0);
+    std::vector<SignatureRunner::BatchedRequest> requests(num_requests);
+    for (int i = 0; i < num_requests; ++i) {
+      inputs[i] = 2 * i;
+      requests[i].inputs = {&inputs[i]};
+      requests[i].outputs = {&outputs[i]};
+    }
+    ASSERT_EQ(add_runner->InvokeBatched(requests), kTfLiteOk);
+    for (int i = 0; i < num_requests; ++i) {
+      EXPECT_EQ(outputs[i], 2 * i + 2);
+    }
+  }
+
+  // Requests must provide every input and output.
+  std::vector<SignatureRunner::BatchedRequest> requests(1);
+  EXPECT_EQ(add_runner->InvokeBatched(requests), kTfLiteError);
+  EXPECT_EQ(add_runner->InvokeBatched({}), kTfLiteOk);
+}
+
+TEST(SignatureRunnerTest, TestCustomAllocationForOutputTensor) {
+  TestErrorReporter reporter;
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_signatures.bin", &reporter);
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolver resolver;
+  InterpreterBuilder builder(*model, resolver);
+
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(builder(&interpreter), kTfLiteOk);
+  ASSERT_NE(interpreter, nullptr);
+
+  SignatureRunner* add_runner = interpreter->GetSignatureRunner("add");
+  ASSERT_NE(add_runner, nullptr);
+  ASSERT_EQ(add_runner->ResizeInputTensor("x", {2}), kTfLiteOk);
+  ASSERT_EQ(add_runner->AllocateTensors(), kTfLiteOk);
+
+  alignas(kDefaultTensorAlignment) float buffers[2][16] = {};
+  TfLiteTensor* add_input = add_runner->input_tensor("x");
+  for (int i = 0; i < 2; ++i) {
+    TfLiteCustomAllocation allocation{buffers[i], sizeof(buffers[i])};
+    ASSERT_EQ(add_runner->SetCustomAllocationForOutputTensor("output_0",
+                                                             allocation),
+              kTfLiteOk);
+    ASSERT_EQ(add_runner->AllocateTensors(), kTfLiteOk);
+    add_input->data.f[0] = i;
+    add_input->data.f[1] = 2 * i;
+    ASSERT_EQ(add_runner->Invoke(), kTfLiteOk);
+    EXPECT_EQ(add_runner->output_tensor("output_0")->data.f, buffers[i]);
+  }
+  EXPECT_EQ(buffers[0][0], 2);
+  EXPECT_EQ(buffers[1][0], 3);
+  EXPECT_EQ(buffers[1][1], 4);
+
+  TfLiteCustomAllocation allocation{buffers[0], sizeof(buffers[0])};
+  EXPECT_EQ(add_runner->SetCustomAllocationForOutputTensor("dummy",
+                                                           allocation),
+            kTfLiteError);
+  EXPECT_EQ(add_runner->SetCustomAllocationForInputTensor("dummy", allocation),
+            kTfLiteError);
+}
+
 }  // namespace
 }  // namespace tflite
@@ -202,6 +202,12 @@ TfLiteStatus SimpleMemoryArena::ResolveAlloc(
   return kTfLiteOk;
 }
 
+void SimpleMemoryArena::SetPlan(const Plan& plan) {
+  committed_ = false;
+  high_water_mark_ = plan.high_water_mark;
+  active_allocs_ = plan.active_allocs;
+}
+
 TfLiteStatus SimpleMemoryArena::ClearPlan() {
   committed_ = false;
   high_water_mark_ = 0;
@@ -62,6 +62,12 @@ struct ArenaAllocWithUsageInterval {
 // zero-sized allocations are explicitly allowed, and will resolve to null.
 class SimpleMemoryArena {
  public:
+  // The allocation plan of the arena, i.e. the state computed by Allocate().
+  struct Plan {
+    size_t high_water_mark = 0;
+    std::vector<ArenaAllocWithUsageInterval> active_allocs;
+  };
+
   explicit SimpleMemoryArena(size_t arena_alignment, int subgraph_index = 0)
       : subgraph_index_(subgraph_index),
         committed_(false),
@@ -112,6 +118,14 @@ class SimpleMemoryArena {
                             const ArenaAllocWithUsageInterval& alloc,
                             char** output_ptr);
 
+  // Returns the current allocation plan.
+  Plan GetPlan() const { return Plan{high_water_mark_, active_allocs_}; }
+
+  // Replaces the allocation plan with one returned by GetPlan(). As after
+  // Allocate(), the arena must be committed and allocations resolved before
+  // using this arena again.
+  void SetPlan(const Plan& plan);
+
   // This clears allocation details but does not release the underlying buffer.
   // New allocations should be committed & resolved before using this arena
   // again.
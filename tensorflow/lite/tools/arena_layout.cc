@@ -0,0 +1,385 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/arena_layout.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/memory_planner.h"
+
+namespace tflite {
+namespace tools {
+namespace {
+
+bool LifetimesOverlap(const ArenaTensorAllocation& a,
+                      const ArenaTensorAllocation& b) {
+  return a.first_node <= b.last_node && b.first_node <= a.last_node;
+}
+
+size_t AlignTo(size_t alignment, size_t offset) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+size_t End(const ArenaTensorAllocation& alloc) {
+  return alloc.offset + alloc.size;
+}
+
+bool OffsetLess(const ArenaTensorAllocation& a,
+                const ArenaTensorAllocation& b) {
+  return a.offset < b.offset;
+}
+
+// Returns the offset of `alloc` among the tensors `placed`, which are ordered
+// by offset, skipping those it isn't live at the same time as. Takes the
+// smallest gap that fits with `best_fit`, like SimpleMemoryArena, or the lowest
+// one otherwise, and the end of the tensors if no gap fits.
+size_t FindOffset(const ArenaTensorAllocation& alloc,
+                  const std::vector<ArenaTensorAllocation>& placed,
+                  size_t alignment, bool best_fit) {
+  constexpr size_t kNotFound = std::numeric_limits<size_t>::max();
+  size_t best_offset = kNotFound;
+  size_t best_gap = kNotFound;
+  size_t current_offset = 0;
+  for (const auto& other : placed) {
+    if (!LifetimesOverlap(alloc, other)) continue;
+    const size_t aligned_offset = AlignTo(alignment, current_offset);
+    if (aligned_offset + alloc.size <= other.offset &&
+        other.offset - aligned_offset < best_gap) {
+      best_offset = aligned_offset;
+      best_gap = other.offset - aligned_offset;
+      if (!best_fit || best_gap == alloc.size) break;
+    }
+    current_offset = std::max(current_offset, End(other));
+  }
+  return best_offset == kNotFound ? AlignTo(alignment, current_offset)
+                                  : best_offset;
+}
+
+// Sets the offset of `alloc` and adds it to `placed`, keeping it ordered.
+void Place(ArenaTensorAllocation* alloc, size_t alignment, bool best_fit,
+           std::vector<ArenaTensorAllocation>* placed) {
+  alloc->offset = FindOffset(*alloc, *placed, alignment, best_fit);
+  placed->insert(
+      std::upper_bound(placed->begin(), placed->end(), *alloc, OffsetLess),
+      *alloc);
+}
+
+void LayoutBySize(size_t alignment,
+                  std::vector<ArenaTensorAllocation>* allocs) {
+  std::vector<ArenaTensorAllocation*> order;
+  for (auto& alloc : *allocs) order.push_back(&alloc);
+  std::stable_sort(order.begin(), order.end(),
+                   [](const ArenaTensorAllocation* a,
+                      const ArenaTensorAllocation* b) {
+                     if (a->size != b->size) return a->size > b->size;
+                     return a->first_node < b->first_node;
+                   });
+  std::vector<ArenaTensorAllocation> placed;
+  for (ArenaTensorAllocation* alloc : order) {
+    Place(alloc, alignment, /*best_fit=*/true, &placed);
+  }
+}
+
+int GetLastNode(const std::vector<ArenaTensorAllocation>& allocs) {
+  int last_node = -1;
+  for (const auto& alloc : allocs) {
+    last_node = std::max(last_node, alloc.last_node);
+  }
+  return last_node;
+}
+
+std::vector<size_t> GetLiveBytesPerNode(
+    const std::vector<ArenaTensorAllocation>& allocs) {
+  std::vector<size_t> live_bytes(GetLastNode(allocs) + 1, 0);
+  for (const auto& alloc : allocs) {
+    for (int node = std::max(alloc.first_node, 0); node <= alloc.last_node;
+         ++node) {
+      live_bytes[node] += alloc.size;
+    }
+  }
+  return live_bytes;
+}
+
+void LayoutByBreadth(size_t alignment,
+                     std::vector<ArenaTensorAllocation>* allocs) {
+  const std::vector<size_t> breadth = GetLiveBytesPerNode(*allocs);
+  std::vector<int> nodes(breadth.size());
+  for (size_t i = 0; i < nodes.size(); ++i) nodes[i] = i;
+  std::stable_sort(nodes.begin(), nodes.end(),
+                   [&](int a, int b) { return breadth[a] > breadth[b]; });
+
+  std::vector<bool> is_placed(allocs->size(), false);
+  std::vector<ArenaTensorAllocation> placed;
+  for (int node : nodes) {
+    std::vector<size_t> live;
+    for (size_t i = 0; i < allocs->size(); ++i) {
+      const ArenaTensorAllocation& alloc = (*allocs)[i];
+      if (!is_placed[i] && alloc.first_node <= node &&
+          node <= alloc.last_node) {
+        live.push_back(i);
+      }
+    }
+    std::stable_sort(live.begin(), live.end(), [&](size_t a, size_t b) {
+      return (*allocs)[a].size > (*allocs)[b].size;
+    });
+    for (size_t i : live) {
+      Place(&(*allocs)[i], alignment, /*best_fit=*/true, &placed);
+      is_placed[i] = true;
+    }
+  }
+}
+
+// Depth-first search over the orders of placing the tensors, pruning orders
+// whose arena already is as large as the best one found.
+class OptimalLayoutSearch {
+ public:
+  OptimalLayoutSearch(const std::vector<ArenaTensorAllocation>& allocs,
+                      size_t alignment)
+      : allocs_(allocs),
+        alignment_(alignment),
+        is_placed_(allocs.size(), false),
+        best_(allocs),
+        lower_bound_(GetPeakLiveBytes(allocs)) {
+    LayoutBySize(alignment, &best_);
+    best_size_ = GetArenaSize(best_);
+  }
+
+  std::vector<ArenaTensorAllocation> Run() {
+    Search(0);
+    return best_;
+  }
+
+ private:
+  void Search(size_t size) {
+    if (best_size_ <= lower_bound_) return;
+    if (placed_.size() == allocs_.size()) {
+      best_size_ = size;
+      for (auto& alloc : best_) {
+        alloc.offset = std::find_if(placed_.begin(), placed_.end(),
+                                    [&](const ArenaTensorAllocation& p) {
+                                      return p.tensor == alloc.tensor;
+                                    })
+                           ->offset;
+      }
+      return;
+    }
+    for (size_t i = 0; i < allocs_.size(); ++i) {
+      if (is_placed_[i]) continue;
+      ArenaTensorAllocation alloc = allocs_[i];
+      alloc.offset = FindOffset(alloc, placed_, alignment_, /*best_fit=*/false);
+      if (std::max(size, End(alloc)) >= best_size_) continue;
+      // The search reallocates `placed_` but leaves it as it found it.
+      const auto position =
+          std::upper_bound(placed_.begin(), placed_.end(), alloc, OffsetLess) -
+          placed_.begin();
+      placed_.insert(placed_.begin() + position, alloc);
+      is_placed_[i] = true;
+      Search(std::max(size, End(alloc)));
+      is_placed_[i] = false;
+      placed_.erase(placed_.begin() + position);
+    }
+  }
+
+  const std::vector<ArenaTensorAllocation>& allocs_;
+  const size_t alignment_;
+  std::vector<bool> is_placed_;
+  std::vector<ArenaTensorAllocation> placed_;
+  std::vector<ArenaTensorAllocation> best_;
+  size_t best_size_;
+  const size_t lower_bound_;
+};
+
+void WriteBytes(size_t bytes, std::ostream& out) {
+  out << bytes << " bytes (" << std::fixed << std::setprecision(3)
+      << static_cast<double>(bytes) / (1 << 20) << " MB)";
+}
+
+void WriteAlloc(const ArenaTensorAllocation& alloc, std::ostream& out) {
+  out << "tensor " << alloc.tensor << ": [" << alloc.offset << ", "
+      << End(alloc) << "), nodes [" << alloc.first_node << ", "
+      << alloc.last_node << "]";
+}
+
+const char* ArenaName(TfLiteAllocationType allocation_type) {
+  return allocation_type == kTfLiteArenaRw ? "kTfLiteArenaRw"
+                                           : "kTfLiteArenaRwPersistent";
+}
+
+}  // namespace
+
+const char* ArenaLayoutStrategyName(ArenaLayoutStrategy strategy) {
+  switch (strategy) {
+    case ArenaLayoutStrategy::kGreedyBySize:
+      return "greedy_by_size";
+    case ArenaLayoutStrategy::kGreedyByBreadth:
+      return "greedy_by_breadth";
+    case ArenaLayoutStrategy::kOptimal:
+      return "optimal";
+  }
+  return "unknown";
+}
+
+std::vector<ArenaTensorAllocation> GetArenaTensors(
+    const std::vector<ArenaTensorAllocation>& allocs,
+    TfLiteAllocationType allocation_type) {
+  std::vector<ArenaTensorAllocation> arena_tensors;
+  for (const auto& alloc : allocs) {
+    if (alloc.allocation_type == allocation_type) {
+      arena_tensors.push_back(alloc);
+    }
+  }
+  return arena_tensors;
+}
+
+size_t GetArenaSize(const std::vector<ArenaTensorAllocation>& allocs) {
+  size_t size = 0;
+  for (const auto& alloc : allocs) size = std::max(size, End(alloc));
+  return size;
+}
+
+size_t GetPeakLiveBytes(const std::vector<ArenaTensorAllocation>& allocs,
+                        int* node) {
+  const std::vector<size_t> live_bytes = GetLiveBytesPerNode(allocs);
+  if (live_bytes.empty()) {
+    if (node) *node = -1;
+    return 0;
+  }
+  const auto peak = std::max_element(live_bytes.begin(), live_bytes.end());
+  if (node) *node = static_cast<int>(peak - live_bytes.begin());
+  return *peak;
+}
+
+std::vector<ArenaTensorAllocation> GetHighWaterMarkTensors(
+    const std::vector<ArenaTensorAllocation>& allocs) {
+  std::vector<ArenaTensorAllocation> tensors;
+  if (allocs.empty()) return tensors;
+  const ArenaTensorAllocation& top = *std::max_element(
+      allocs.begin(), allocs.end(),
+      [](const ArenaTensorAllocation& a, const ArenaTensorAllocation& b) {
+        return End(a) < End(b);
+      });
+  tensors.push_back(top);
+  for (const auto& alloc : allocs) {
+    if (&alloc != &top && alloc.offset < top.offset &&
+        LifetimesOverlap(alloc, top)) {
+      tensors.push_back(alloc);
+    }
+  }
+  std::stable_sort(tensors.begin() + 1, tensors.end(), OffsetLess);
+  return tensors;
+}
+
+bool LayoutArena(ArenaLayoutStrategy strategy, size_t alignment,
+                 std::vector<ArenaTensorAllocation>* allocs) {
+  switch (strategy) {
+    case ArenaLayoutStrategy::kGreedyBySize:
+      LayoutBySize(alignment, allocs);
+      return true;
+    case ArenaLayoutStrategy::kGreedyByBreadth:
+      LayoutByBreadth(alignment, allocs);
+      return true;
+    case ArenaLayoutStrategy::kOptimal:
+      if (allocs->size() > kMaxTensorsForOptimalLayout) return false;
+      *allocs = OptimalLayoutSearch(*allocs, alignment).Run();
+      return true;
+  }
+  return false;
+}
+
+void WriteArenaTimeline(const std::vector<ArenaTensorAllocation>& allocs,
+                        std::ostream& out) {
+  for (TfLiteAllocationType type : {kTfLiteArenaRw, kTfLiteArenaRwPersistent}) {
+    std::vector<ArenaTensorAllocation> tensors = GetArenaTensors(allocs, type);
+    if (tensors.empty()) continue;
+    const size_t arena_size = GetArenaSize(tensors);
+    out << "=== " << ArenaName(type) << ": ";
+    WriteBytes(arena_size, out);
+    out << ", " << tensors.size() << " tensors ===\n";
+
+    std::stable_sort(
+        tensors.begin(), tensors.end(),
+        [](const ArenaTensorAllocation& a, const ArenaTensorAllocation& b) {
+          if (a.first_node != b.first_node) return a.first_node < b.first_node;
+          return a.offset < b.offset;
+        });
+    for (const auto& alloc : tensors) {
+      WriteAlloc(alloc, out);
+      out << ", " << alloc.size << " bytes\n";
+    }
+
+    out << "Live bytes per node:\n";
+    const std::vector<size_t> live_bytes = GetLiveBytesPerNode(tensors);
+    for (size_t node = 0; node < live_bytes.size(); ++node) {
+      out << "node " << node << ": ";
+      WriteBytes(live_bytes[node], out);
+      out << ", " << std::setprecision(1)
+          << 100.0 * live_bytes[node] / arena_size << "% of the arena\n";
+    }
+
+    const std::vector<ArenaTensorAllocation> high_water_mark =
+        GetHighWaterMarkTensors(tensors);
+    out << "High-water mark set by ";
+    WriteAlloc(high_water_mark.front(), out);
+    out << ", placed above " << high_water_mark.size() - 1
+        << " tensors live at the same time:\n";
+    for (size_t i = 1; i < high_water_mark.size(); ++i) {
+      out << "  ";
+      WriteAlloc(high_water_mark[i], out);
+      out << "\n";
+    }
+    out << "\n";
+  }
+}
+
+void WriteArenaLayoutComparison(
+    const std::vector<ArenaTensorAllocation>& allocs, size_t alignment,
+    std::ostream& out) {
+  const size_t current_size = GetArenaSize(allocs);
+  int peak_node;
+  const size_t peak_live_bytes = GetPeakLiveBytes(allocs, &peak_node);
+  out << "Layouts of " << allocs.size() << " tensors, at most ";
+  WriteBytes(peak_live_bytes, out);
+  out << " live at node " << peak_node << ":\n";
+  out << "current: ";
+  WriteBytes(current_size, out);
+  out << "\n";
+  for (ArenaLayoutStrategy strategy :
+       {ArenaLayoutStrategy::kGreedyBySize,
+        ArenaLayoutStrategy::kGreedyByBreadth, ArenaLayoutStrategy::kOptimal}) {
+    out << ArenaLayoutStrategyName(strategy) << ": ";
+    std::vector<ArenaTensorAllocation> layout = allocs;
+    if (!LayoutArena(strategy, alignment, &layout)) {
+      out << "skipped, more than " << kMaxTensorsForOptimalLayout
+          << " tensors\n";
+      continue;
+    }
+    const size_t size = GetArenaSize(layout);
+    WriteBytes(size, out);
+    const double change =
+        current_size == 0 ? 0.0
+                          : 100.0 * (static_cast<double>(size) - current_size) /
+                                current_size;
+    out << ", " << std::showpos << std::setprecision(1) << change
+        << std::noshowpos << "%\n";
+  }
+}
+
+}  // namespace tools
+}  // namespace tflite
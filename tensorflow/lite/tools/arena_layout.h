@@ -0,0 +1,88 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_TOOLS_ARENA_LAYOUT_H_
+#define TENSORFLOW_LITE_TOOLS_ARENA_LAYOUT_H_
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/memory_planner.h"
+
+namespace tflite {
+namespace tools {
+
+// Ways of placing the tensors of a memory arena, which all keep the size and
+// lifetime of each tensor and only change its offset.
+enum class ArenaLayoutStrategy {
+  // Largest tensors first, each in the smallest gap that fits. This is what
+  // ArenaPlanner does, except that it always places graph inputs first.
+  kGreedyBySize,
+  // Nodes with the most live bytes first, placing the tensors live at each
+  // node largest first in the smallest gap that fits.
+  kGreedyByBreadth,
+  // Tries every order of placing the tensors, each at the lowest offset where
+  // it fits, and keeps the smallest arena. Only for arenas of at most
+  // kMaxTensorsForOptimalLayout tensors.
+  kOptimal,
+};
+
+constexpr int kMaxTensorsForOptimalLayout = 10;
+
+const char* ArenaLayoutStrategyName(ArenaLayoutStrategy strategy);
+
+// Returns the tensors of `allocs` placed in the arena of `allocation_type`.
+std::vector<ArenaTensorAllocation> GetArenaTensors(
+    const std::vector<ArenaTensorAllocation>& allocs,
+    TfLiteAllocationType allocation_type);
+
+// Returns the size of the arena holding `allocs`, i.e. the end of the tensor
+// placed last.
+size_t GetArenaSize(const std::vector<ArenaTensorAllocation>& allocs);
+
+// Returns the largest number of bytes live at the same node, and sets `node`
+// to that node if not null. No layout of `allocs` can be smaller than this.
+size_t GetPeakLiveBytes(const std::vector<ArenaTensorAllocation>& allocs,
+                        int* node = nullptr);
+
+// Returns the tensors that the size of the arena is attributed to: the tensor
+// ending at the high-water mark, followed by the tensors placed below it that
+// are live at the same time, ordered by offset.
+std::vector<ArenaTensorAllocation> GetHighWaterMarkTensors(
+    const std::vector<ArenaTensorAllocation>& allocs);
+
+// Recomputes the offsets of `allocs`, which must all be in the same arena,
+// with `strategy`, aligning them to `alignment` bytes. Returns false, leaving
+// `allocs` unchanged, if `strategy` is kOptimal and there are too many tensors.
+bool LayoutArena(ArenaLayoutStrategy strategy, size_t alignment,
+                 std::vector<ArenaTensorAllocation>* allocs);
+
+// Writes the offset, size and lifetime of every tensor of `allocs`, ordered by
+// first use, then the live bytes at each node, and the tensors the size of each
+// arena is attributed to.
+void WriteArenaTimeline(const std::vector<ArenaTensorAllocation>& allocs,
+                        std::ostream& out);
+
+// Writes the size of the arena holding `allocs` when laid out with each
+// strategy, compared to their current layout.
+void WriteArenaLayoutComparison(
+    const std::vector<ArenaTensorAllocation>& allocs, size_t alignment,
+    std::ostream& out);
+
+}  // namespace tools
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_ARENA_LAYOUT_H_
@@ -0,0 +1,83 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter_builder.h"
+#include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/core/model_builder.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/tools/arena_layout.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/logging.h"
+#include "tensorflow/lite/util.h"
+
+const char kGraphFlag[] = "graph";
+const char kPrintPerNodeInfoFlag[] = "print_per_node_info";
+
+// Prints the arena layout of every subgraph of a model, and how large the
+// arenas would be with other layout strategies.
+int main(int argc, char** argv) {
+  std::string graph;
+  bool print_per_node_info = false;
+  std::vector<tflite::Flag> flag_list = {
+      tflite::Flag::CreateFlag(kGraphFlag, &graph, "path to the tflite model.",
+                               tflite::Flag::kRequired),
+      tflite::Flag::CreateFlag(
+          kPrintPerNodeInfoFlag, &print_per_node_info,
+          "also print the memory planner debug info of each subgraph, with the "
+          "live tensors at each node."),
+  };
+  if (!tflite::Flags::Parse(&argc, const_cast<const char**>(argv),
+                            flag_list)) {
+    return 1;
+  }
+
+  std::unique_ptr<tflite::FlatBufferModel> model =
+      tflite::FlatBufferModel::BuildFromFile(graph.c_str());
+  if (!model) {
+    TFLITE_LOG(ERROR) << "Failed to load model " << graph;
+    return 1;
+  }
+  tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  std::unique_ptr<tflite::Interpreter> interpreter;
+  if (tflite::InterpreterBuilder(*model, resolver)(&interpreter) !=
+          kTfLiteOk ||
+      interpreter->AllocateTensors() != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Failed to allocate the tensors of " << graph;
+    return 1;
+  }
+
+  for (int i = 0; i < interpreter->subgraphs_size(); ++i) {
+    const tflite::Subgraph& subgraph = *interpreter->subgraph(i);
+    std::cout << "##### Subgraph " << i << " " << subgraph.GetName()
+              << " #####\n";
+    const std::vector<tflite::ArenaTensorAllocation> allocs =
+        subgraph.GetArenaAllocations();
+    tflite::tools::WriteArenaTimeline(allocs, std::cout);
+    // Persistent tensors are all live until the end, so only the layout of
+    // the other arena can change.
+    tflite::tools::WriteArenaLayoutComparison(
+        tflite::tools::GetArenaTensors(allocs, kTfLiteArenaRw),
+        tflite::kDefaultTensorAlignment, std::cout);
+    std::cout << "\n";
+    if (print_per_node_info) subgraph.DumpMemoryPlannerDebugInfo();
+  }
+  return 0;
+}
@@ -0,0 +1,139 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/arena_layout.h"
+
+#include <sstream>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/memory_planner.h"
+
+namespace tflite {
+namespace tools {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+// Returns tensors with the given sizes and lifetimes, placed one after the
+// other.
+std::vector<ArenaTensorAllocation> MakeTensors(
+    const std::vector<std::vector<int>>& size_first_last) {
+  std::vector<ArenaTensorAllocation> allocs;
+  size_t offset = 0;
+  for (const auto& t : size_first_last) {
+    allocs.push_back({static_cast<int>(allocs.size()), kTfLiteArenaRw, offset,
+                      static_cast<size_t>(t[0]), t[1], t[2]});
+    offset += t[0];
+  }
+  return allocs;
+}
+
+void ExpectValidLayout(const std::vector<ArenaTensorAllocation>& allocs,
+                       size_t alignment) {
+  for (const auto& a : allocs) {
+    EXPECT_EQ(a.offset % alignment, 0) << "tensor " << a.tensor;
+    for (const auto& b : allocs) {
+      if (a.tensor == b.tensor || a.last_node < b.first_node ||
+          b.last_node < a.first_node) {
+        continue;
+      }
+      EXPECT_TRUE(a.offset + a.size <= b.offset ||
+                  b.offset + b.size <= a.offset)
+          << "tensors " << a.tensor << " and " << b.tensor << " overlap";
+    }
+  }
+}
+
+// Placing the largest tensors first leaves a gap that no other tensor fits.
+std::vector<ArenaTensorAllocation> MakeGreedyUnfriendlyTensors() {
+  return MakeTensors({{3, 1, 2}, {3, 1, 2}, {3, 2, 4}, {5, 3, 3}, {4, 2, 3}});
+}
+
+TEST(ArenaLayoutTest, PeakLiveBytes) {
+  int node;
+  EXPECT_EQ(GetPeakLiveBytes(MakeGreedyUnfriendlyTensors(), &node), 13);
+  EXPECT_EQ(node, 2);
+  EXPECT_EQ(GetPeakLiveBytes({}, &node), 0);
+  EXPECT_EQ(node, -1);
+}
+
+TEST(ArenaLayoutTest, HighWaterMarkTensors) {
+  std::vector<ArenaTensorAllocation> allocs =
+      MakeTensors({{16, 0, 1}, {32, 1, 2}, {8, 3, 3}, {4, 2, 2}});
+  EXPECT_EQ(GetArenaSize(allocs), 60);
+  std::vector<int> tensors;
+  for (const auto& alloc : GetHighWaterMarkTensors(allocs)) {
+    tensors.push_back(alloc.tensor);
+  }
+  // Tensor 2 is placed above tensor 0 but isn't live at the same time.
+  EXPECT_THAT(tensors, ElementsAre(3, 1));
+}
+
+TEST(ArenaLayoutTest, StrategiesGiveValidLayouts) {
+  for (ArenaLayoutStrategy strategy :
+       {ArenaLayoutStrategy::kGreedyBySize,
+        ArenaLayoutStrategy::kGreedyByBreadth, ArenaLayoutStrategy::kOptimal}) {
+    SCOPED_TRACE(ArenaLayoutStrategyName(strategy));
+    std::vector<ArenaTensorAllocation> allocs = MakeTensors(
+        {{10, 0, 1}, {20, 1, 2}, {30, 0, 3}, {7, 2, 4}, {100, 3, 4}});
+    ASSERT_TRUE(LayoutArena(strategy, 16, &allocs));
+    ExpectValidLayout(allocs, 16);
+    EXPECT_GE(GetArenaSize(allocs), GetPeakLiveBytes(allocs));
+  }
+}
+
+TEST(ArenaLayoutTest, OptimalBeatsGreedyBySize) {
+  std::vector<ArenaTensorAllocation> by_size = MakeGreedyUnfriendlyTensors();
+  ASSERT_TRUE(LayoutArena(ArenaLayoutStrategy::kGreedyBySize, 1, &by_size));
+  EXPECT_EQ(GetArenaSize(by_size), 15);
+
+  std::vector<ArenaTensorAllocation> optimal = MakeGreedyUnfriendlyTensors();
+  ASSERT_TRUE(LayoutArena(ArenaLayoutStrategy::kOptimal, 1, &optimal));
+  ExpectValidLayout(optimal, 1);
+  EXPECT_EQ(GetArenaSize(optimal), 13);
+}
+
+TEST(ArenaLayoutTest, OptimalSkipsLargeArenas) {
+  std::vector<std::vector<int>> sizes(kMaxTensorsForOptimalLayout + 1,
+                                      {64, 0, 0});
+  std::vector<ArenaTensorAllocation> allocs = MakeTensors(sizes);
+  EXPECT_FALSE(LayoutArena(ArenaLayoutStrategy::kOptimal, 64, &allocs));
+  EXPECT_EQ(allocs[1].offset, 64);
+}
+
+TEST(ArenaLayoutTest, WritesTimelineAndComparison) {
+  std::vector<ArenaTensorAllocation> allocs = MakeGreedyUnfriendlyTensors();
+  allocs.push_back({7, kTfLiteArenaRwPersistent, 0, 64, 0, 4});
+  std::stringstream timeline;
+  WriteArenaTimeline(allocs, timeline);
+  EXPECT_THAT(timeline.str(), HasSubstr("=== kTfLiteArenaRw: 18 bytes"));
+  EXPECT_THAT(timeline.str(), HasSubstr("=== kTfLiteArenaRwPersistent: 64"));
+  EXPECT_THAT(timeline.str(),
+              HasSubstr("tensor 3: [9, 14), nodes [3, 3], 5 bytes"));
+  EXPECT_THAT(timeline.str(), HasSubstr("High-water mark set by tensor 4"));
+
+  std::stringstream comparison;
+  WriteArenaLayoutComparison(GetArenaTensors(allocs, kTfLiteArenaRw), 1,
+                             comparison);
+  EXPECT_THAT(comparison.str(), HasSubstr("greedy_by_size: 15 bytes"));
+  EXPECT_THAT(comparison.str(), HasSubstr("optimal: 13 bytes"));
+}
+
+}  // namespace
+}  // namespace tools
+}  // namespace tflite
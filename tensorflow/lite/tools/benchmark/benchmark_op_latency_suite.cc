@@ -0,0 +1,178 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/benchmark_op_latency_suite.h"
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/benchmark/op_latency_listener.h"
+#include "tensorflow/lite/tools/benchmark/op_latency_stats.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+
+std::unique_ptr<BenchmarkListener>
+OpLatencyBenchmarkModel::MayCreateProfilingListener() const {
+  return std::make_unique<OpLatencyListener>(
+      interpreter_.get(), params_.Get<int32_t>("max_profiling_buffer_entries"),
+      config_, params_.Get<std::string>("graph"), latencies_);
+}
+
+BenchmarkOpLatencySuite::BenchmarkOpLatencySuite()
+    : params_(DefaultParams()), model_run_(&latencies_) {}
+
+BenchmarkParams BenchmarkOpLatencySuite::DefaultParams() {
+  BenchmarkParams params;
+  params.AddParam("graphs", BenchmarkParam::Create<std::string>(""));
+  params.AddParam("op_latency_config",
+                  BenchmarkParam::Create<std::string>("default"));
+  params.AddParam("op_latency_output_file",
+                  BenchmarkParam::Create<std::string>(""));
+  params.AddParam("op_latency_baseline_file",
+                  BenchmarkParam::Create<std::string>(""));
+  const OpLatencyRegressionOptions defaults;
+  params.AddParam("op_latency_max_p_value",
+                  BenchmarkParam::Create<float>(defaults.max_p_value));
+  params.AddParam("op_latency_min_relative_change",
+                  BenchmarkParam::Create<float>(defaults.min_relative_change));
+  params.AddParam("op_latency_min_change_us",
+                  BenchmarkParam::Create<float>(defaults.min_change_us));
+  return params;
+}
+
+std::vector<Flag> BenchmarkOpLatencySuite::GetFlags() {
+  return {
+      CreateFlag<std::string>(
+          "graphs", &params_,
+          "A comma-separated list of the TFLite models to benchmark."),
+      CreateFlag<std::string>(
+          "op_latency_config", &params_,
+          "A label for the benchmark configuration, e.g. 'xnnpack'. Latencies "
+          "are only compared against baseline latencies of the same label."),
+      CreateFlag<std::string>(
+          "op_latency_output_file", &params_,
+          "File to write the latency samples of every op to, as "
+          "tab-separated values."),
+      CreateFlag<std::string>(
+          "op_latency_baseline_file", &params_,
+          "A file written through --op_latency_output_file by a previous run, "
+          "to compare the latencies against."),
+      CreateFlag<float>("op_latency_max_p_value", &params_,
+                        "Maximum p-value of the Mann-Whitney U test for an op "
+                        "to be reported as regressed."),
+      CreateFlag<float>("op_latency_min_relative_change", &params_,
+                        "Minimum relative increase of the median latency for "
+                        "an op to be reported as regressed."),
+      CreateFlag<float>("op_latency_min_change_us", &params_,
+                        "Minimum increase of the median latency, in "
+                        "microseconds, for an op to be reported as "
+                        "regressed."),
+  };
+}
+
+TfLiteStatus BenchmarkOpLatencySuite::ParseFlags(int* argc, char** argv) {
+  auto flag_list = GetFlags();
+  const bool parse_result =
+      Flags::Parse(argc, const_cast<const char**>(argv), flag_list);
+  if (!parse_result) {
+    std::string usage = Flags::Usage(argv[0], flag_list);
+    TFLITE_LOG(ERROR) << usage;
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkOpLatencySuite::Run(int argc, char** argv) {
+  // Parse flags that are supported by this particular binary first.
+  TF_LITE_ENSURE_STATUS(ParseFlags(&argc, argv));
+  // Then parse flags for the runs of the individual models.
+  TF_LITE_ENSURE_STATUS(model_run_.ParseFlags(&argc, argv));
+  for (int i = 1; i < argc; ++i) {
+    TFLITE_LOG(WARN) << "WARNING: unrecognized commandline flag: " << argv[i];
+  }
+  return Run();
+}
+
+TfLiteStatus BenchmarkOpLatencySuite::Run() {
+  std::vector<std::string> graphs;
+  if (!util::SplitAndParse(params_.Get<std::string>("graphs"), ',', &graphs) ||
+      graphs.empty()) {
+    TFLITE_LOG(ERROR) << "Please specify the models to benchmark with --graphs";
+    return kTfLiteError;
+  }
+  model_run_.set_config(params_.Get<std::string>("op_latency_config"));
+
+  // Listeners created by a run become invalid in the next one, see
+  // BenchmarkPerformanceOptions::Run.
+  const int num_external_listeners = model_run_.NumListeners();
+  for (const auto& graph : graphs) {
+    model_run_.RemoveListeners(num_external_listeners);
+    model_run_.mutable_params()->Set<std::string>("graph", graph);
+    if (TfLiteStatus status = model_run_.Run(); status != kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Error while benchmarking " << graph;
+      return status;
+    }
+  }
+
+  const auto& output_file = params_.Get<std::string>("op_latency_output_file");
+  if (!output_file.empty()) {
+    std::ofstream output(output_file);
+    WriteOpLatencies(latencies_, &output);
+    if (!output.good()) {
+      TFLITE_LOG(ERROR) << "Failed to write " << output_file;
+      return kTfLiteError;
+    }
+  }
+
+  const auto& baseline_file =
+      params_.Get<std::string>("op_latency_baseline_file");
+  if (baseline_file.empty()) return kTfLiteOk;
+  std::ifstream baseline_stream(baseline_file);
+  OpLatencies baseline;
+  if (!baseline_stream.good() ||
+      !ReadOpLatencies(&baseline_stream, &baseline)) {
+    TFLITE_LOG(ERROR) << "Failed to read the baseline " << baseline_file;
+    return kTfLiteError;
+  }
+  OpLatencyRegressionOptions options;
+  options.max_p_value = params_.Get<float>("op_latency_max_p_value");
+  options.min_relative_change =
+      params_.Get<float>("op_latency_min_relative_change");
+  options.min_change_us = params_.Get<float>("op_latency_min_change_us");
+  regressions_ = FindOpLatencyRegressions(baseline, latencies_, options);
+
+  for (const auto& regression : regressions_) {
+    TFLITE_LOG(ERROR) << "Regression: " << regression.key.model << " "
+                      << regression.key.op << " (" << regression.type
+                      << "): median " << regression.baseline_median_us
+                      << " us -> " << regression.median_us
+                      << " us, p-value " << regression.p_value;
+  }
+  TFLITE_LOG(INFO) << regressions_.size() << " of " << latencies_.size()
+                   << " ops regressed against " << baseline_file;
+  return regressions_.empty() ? kTfLiteOk : kTfLiteError;
+}
+
+}  // namespace benchmark
+}  // namespace tflite
@@ -0,0 +1,96 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_OP_LATENCY_SUITE_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_OP_LATENCY_SUITE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
+#include "tensorflow/lite/tools/benchmark/op_latency_stats.h"
+
+namespace tflite {
+namespace benchmark {
+
+// A BenchmarkTfLiteModel recording the latency of every op of every regular
+// run into `latencies`, in place of the regular op profiling.
+class OpLatencyBenchmarkModel : public BenchmarkTfLiteModel {
+ public:
+  // Doesn't own `latencies`.
+  explicit OpLatencyBenchmarkModel(OpLatencies* latencies)
+      : latencies_(latencies) {}
+
+  // Label of the benchmark configuration recorded with every latency.
+  void set_config(const std::string& config) { config_ = config; }
+
+ protected:
+  std::unique_ptr<BenchmarkListener> MayCreateProfilingListener()
+      const override;
+
+ private:
+  OpLatencies* latencies_;
+  std::string config_;
+};
+
+// Benchmarks a corpus of models, collects the latency distribution of every
+// op, writes them to a machine-readable file and compares them against a
+// baseline written by a previous run. An op is reported as regressed if its
+// median latency grew beyond the configured thresholds and the Mann-Whitney U
+// test finds the change significant, which keeps run-to-run noise from being
+// reported.
+//
+// Every model is run with the same benchmark flags, e.g. --use_xnnpack or
+// --num_runs, passed through to BenchmarkTfLiteModel.
+class BenchmarkOpLatencySuite {
+ public:
+  BenchmarkOpLatencySuite();
+
+  // Parses the flags of the suite and of BenchmarkTfLiteModel, then runs.
+  TfLiteStatus Run(int argc, char** argv);
+
+  // Returns kTfLiteError if a model failed to run, the results couldn't be
+  // written or the baseline couldn't be read, or if any op regressed.
+  TfLiteStatus Run();
+
+  const OpLatencies& latencies() const { return latencies_; }
+  const std::vector<OpLatencyRegression>& regressions() const {
+    return regressions_;
+  }
+
+  BenchmarkParams* mutable_params() { return &params_; }
+  BenchmarkParams* mutable_model_params() {
+    return model_run_.mutable_params();
+  }
+
+ private:
+  static BenchmarkParams DefaultParams();
+  TfLiteStatus ParseFlags(int* argc, char** argv);
+  std::vector<Flag> GetFlags();
+
+  BenchmarkParams params_;
+  OpLatencies latencies_;
+  OpLatencyBenchmarkModel model_run_;
+  std::vector<OpLatencyRegression> regressions_;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_OP_LATENCY_SUITE_H_
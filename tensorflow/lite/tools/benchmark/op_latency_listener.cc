@@ -0,0 +1,83 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/op_latency_listener.h"
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+
+OpLatencyListener::OpLatencyListener(Interpreter* interpreter,
+                                     uint32_t max_num_entries,
+                                     const std::string& config,
+                                     const std::string& model,
+                                     OpLatencies* latencies)
+    : interpreter_(interpreter),
+      profiler_(max_num_entries, /*allow_dynamic_buffer_increase=*/true),
+      config_(config),
+      model_(model),
+      latencies_(latencies) {
+  TFLITE_TOOLS_CHECK(interpreter);
+  interpreter_->SetProfiler(&profiler_);
+}
+
+void OpLatencyListener::OnSingleRunStart(RunType run_type) {
+  // Warmup runs are dominated by one-time costs, e.g. lazy packing of weights.
+  profiling_ = run_type == REGULAR;
+  if (!profiling_) return;
+  profiler_.Reset();
+  profiler_.StartProfiling();
+}
+
+void OpLatencyListener::OnSingleRunEnd() {
+  if (!profiling_) return;
+  profiler_.StopProfiling();
+
+  std::map<std::string, std::pair<std::string, int64_t>> run_us;
+  for (const auto* event : profiler_.GetProfileEvents()) {
+    std::string op;
+    std::string type(event->tag);
+    switch (event->event_type) {
+      case Profiler::EventType::OPERATOR_INVOKE_EVENT:
+        op = std::to_string(event->extra_event_metadata) + ":" +
+             std::to_string(event->event_metadata);
+        break;
+      case Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT:
+      case Profiler::EventType::DELEGATE_PROFILED_OPERATOR_INVOKE_EVENT:
+        op = "Delegate/" + type + ":" + std::to_string(event->event_metadata);
+        break;
+      default:
+        // Not an op, e.g. the whole Invoke or AllocateTensors.
+        continue;
+    }
+    auto& entry = run_us[op];
+    entry.first = type;
+    entry.second += event->elapsed_time;
+  }
+  for (const auto& [op, type_and_us] : run_us) {
+    OpLatency& latency = (*latencies_)[{config_, model_, op}];
+    latency.type = type_and_us.first;
+    latency.samples_us.push_back(type_and_us.second);
+  }
+}
+
+}  // namespace benchmark
+}  // namespace tflite
@@ -0,0 +1,56 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_OP_LATENCY_LISTENER_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_OP_LATENCY_LISTENER_H_
+
+#include <cstdint>
+#include <string>
+
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/profiling/buffered_profiler.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/lite/tools/benchmark/op_latency_stats.h"
+
+namespace tflite {
+namespace benchmark {
+
+// Records the latency of every op in every regular (i.e. non-warmup) run into
+// `latencies`, under the given `config` and `model`. Ops invoked several times
+// in a run, e.g. in the body of a WHILE, get the sum of their invocations.
+class OpLatencyListener : public BenchmarkListener {
+ public:
+  // Doesn't own `interpreter` or `latencies`.
+  OpLatencyListener(Interpreter* interpreter, uint32_t max_num_entries,
+                    const std::string& config, const std::string& model,
+                    OpLatencies* latencies);
+
+  void OnSingleRunStart(RunType run_type) override;
+
+  void OnSingleRunEnd() override;
+
+ private:
+  Interpreter* interpreter_;
+  profiling::BufferedProfiler profiler_;
+  const std::string config_;
+  const std::string model_;
+  OpLatencies* latencies_;
+  bool profiling_ = false;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_OP_LATENCY_LISTENER_H_
@@ -0,0 +1,163 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/op_latency_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+
+namespace tflite {
+namespace benchmark {
+
+namespace {
+
+constexpr char kHeader[] =
+    "config\tmodel\top\ttype\tcount\tmedian_us\tmean_us\tsamples_us";
+
+// The normal approximation of the U statistic is poor below this size.
+constexpr int kMinSamplesForSignificance = 5;
+
+double Mean(const std::vector<int64_t>& samples) {
+  if (samples.empty()) return 0;
+  return static_cast<double>(
+             std::accumulate(samples.begin(), samples.end(), int64_t{0})) /
+         samples.size();
+}
+
+}  // namespace
+
+double Median(std::vector<int64_t> samples) {
+  if (samples.empty()) return 0;
+  const size_t mid = samples.size() / 2;
+  std::nth_element(samples.begin(), samples.begin() + mid, samples.end());
+  if (samples.size() % 2 == 1) return samples[mid];
+  const int64_t upper = samples[mid];
+  const int64_t lower =
+      *std::max_element(samples.begin(), samples.begin() + mid);
+  return (lower + upper) / 2.0;
+}
+
+double MannWhitneyPValue(const std::vector<int64_t>& a,
+                         const std::vector<int64_t>& b) {
+  const size_t n1 = a.size();
+  const size_t n2 = b.size();
+  if (n1 < kMinSamplesForSignificance || n2 < kMinSamplesForSignificance) {
+    return 1;
+  }
+  // Rank all samples together; `true` marks samples of `a`.
+  std::vector<std::pair<int64_t, bool>> all;
+  all.reserve(n1 + n2);
+  for (int64_t v : a) all.emplace_back(v, true);
+  for (int64_t v : b) all.emplace_back(v, false);
+  std::sort(all.begin(), all.end());
+
+  const double n = n1 + n2;
+  double rank_sum_a = 0;
+  double tie_term = 0;
+  for (size_t i = 0; i < all.size();) {
+    size_t j = i;
+    while (j < all.size() && all[j].first == all[i].first) ++j;
+    // Tied samples share the average of their ranks, which are 1-based.
+    const double rank = (i + 1 + j) / 2.0;
+    for (size_t k = i; k < j; ++k) {
+      if (all[k].second) rank_sum_a += rank;
+    }
+    const double t = j - i;
+    tie_term += t * t * t - t;
+    i = j;
+  }
+
+  const double u = rank_sum_a - n1 * (n1 + 1) / 2.0;
+  const double mean_u = n1 * n2 / 2.0;
+  const double variance_u =
+      n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)));
+  if (variance_u <= 0) return 1;
+  // Two-sided, with continuity correction.
+  const double z =
+      std::max(0.0, std::abs(u - mean_u) - 0.5) / std::sqrt(variance_u);
+  return std::erfc(z / std::sqrt(2.0));
+}
+
+void WriteOpLatencies(const OpLatencies& latencies, std::ostream* stream) {
+  (*stream) << kHeader << "\n";
+  for (const auto& [key, latency] : latencies) {
+    (*stream) << key.config << "\t" << key.model << "\t" << key.op << "\t"
+              << latency.type << "\t" << latency.samples_us.size() << "\t"
+              << Median(latency.samples_us) << "\t"
+              << Mean(latency.samples_us) << "\t";
+    for (size_t i = 0; i < latency.samples_us.size(); ++i) {
+      if (i > 0) (*stream) << ",";
+      (*stream) << latency.samples_us[i];
+    }
+    (*stream) << "\n";
+  }
+}
+
+bool ReadOpLatencies(std::istream* stream, OpLatencies* latencies) {
+  std::string line;
+  if (!std::getline(*stream, line) || line != kHeader) return false;
+  while (std::getline(*stream, line)) {
+    if (line.empty()) continue;
+    std::vector<std::string> columns;
+    std::istringstream columns_stream(line);
+    for (std::string column; std::getline(columns_stream, column, '\t');) {
+      columns.push_back(std::move(column));
+    }
+    // The samples column is empty, and dropped by getline, for ops without
+    // samples.
+    if (columns.size() == 7) columns.emplace_back();
+    if (columns.size() != 8) return false;
+
+    OpLatency latency;
+    latency.type = columns[3];
+    if (!util::SplitAndParse(columns[7], ',', &latency.samples_us)) {
+      return false;
+    }
+    (*latencies)[{columns[0], columns[1], columns[2]}] = std::move(latency);
+  }
+  return true;
+}
+
+std::vector<OpLatencyRegression> FindOpLatencyRegressions(
+    const OpLatencies& baseline, const OpLatencies& current,
+    const OpLatencyRegressionOptions& options) {
+  std::vector<OpLatencyRegression> regressions;
+  for (const auto& [key, latency] : current) {
+    const auto it = baseline.find(key);
+    if (it == baseline.end()) continue;
+    const double baseline_median = Median(it->second.samples_us);
+    const double median = Median(latency.samples_us);
+    if (median - baseline_median < options.min_change_us ||
+        median < baseline_median * (1 + options.min_relative_change)) {
+      continue;
+    }
+    const double p_value =
+        MannWhitneyPValue(it->second.samples_us, latency.samples_us);
+    if (p_value > options.max_p_value) continue;
+    regressions.push_back(
+        {key, latency.type, baseline_median, median, p_value});
+  }
+  return regressions;
+}
+
+}  // namespace benchmark
+}  // namespace tflite
@@ -0,0 +1,101 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_OP_LATENCY_STATS_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_OP_LATENCY_STATS_H_
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace tflite {
+namespace benchmark {
+
+// Identifies an op across benchmark runs.
+struct OpLatencyKey {
+  // Free-form label of the benchmark configuration, e.g. the delegate used.
+  std::string config;
+  // Path of the benchmarked model.
+  std::string model;
+  // The op within the model, e.g. "0:12" for node 12 of subgraph 0.
+  std::string op;
+
+  bool operator<(const OpLatencyKey& other) const {
+    return std::tie(config, model, op) <
+           std::tie(other.config, other.model, other.op);
+  }
+};
+
+// The latencies of an op, one sample per benchmark run.
+struct OpLatency {
+  // The op type, e.g. "CONV_2D", or the name of the delegate kernel.
+  std::string type;
+  std::vector<int64_t> samples_us;
+};
+
+using OpLatencies = std::map<OpLatencyKey, OpLatency>;
+
+// Returns the median of `samples`, or 0 if there are none.
+double Median(std::vector<int64_t> samples);
+
+// Returns the two-sided p-value of the Mann-Whitney U test on `a` and `b`,
+// i.e. the probability of observing samples at least this far apart if both
+// came from the same distribution. Uses the normal approximation with tie
+// correction, so it returns 1 if either side has fewer than 5 samples.
+double MannWhitneyPValue(const std::vector<int64_t>& a,
+                         const std::vector<int64_t>& b);
+
+// Writes `latencies` as tab-separated values, one op per line, with a header.
+// Columns: config, model, op, type, count, median_us, mean_us and samples_us,
+// the latter being a comma-separated list.
+void WriteOpLatencies(const OpLatencies& latencies, std::ostream* stream);
+
+// Reads latencies written by `WriteOpLatencies` into `latencies`. Returns
+// false on malformed input.
+bool ReadOpLatencies(std::istream* stream, OpLatencies* latencies);
+
+// Thresholds for reporting an op as regressed. All of them must be exceeded.
+struct OpLatencyRegressionOptions {
+  // Maximum p-value of the Mann-Whitney U test.
+  double max_p_value = 0.01;
+  // Minimum increase of the median, relative to the baseline median.
+  double min_relative_change = 0.05;
+  // Minimum increase of the median in microseconds, which keeps ops that take
+  // about as long as the profiler's resolution from being reported.
+  double min_change_us = 2;
+};
+
+struct OpLatencyRegression {
+  OpLatencyKey key;
+  std::string type;
+  double baseline_median_us;
+  double median_us;
+  double p_value;
+};
+
+// Returns the ops of `current` that are significantly slower than in
+// `baseline`. Ops missing from either side are ignored.
+std::vector<OpLatencyRegression> FindOpLatencyRegressions(
+    const OpLatencies& baseline, const OpLatencies& current,
+    const OpLatencyRegressionOptions& options);
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_OP_LATENCY_STATS_H_
@@ -0,0 +1,93 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/op_latency_stats.h"
+
+#include <sstream>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+using ::testing::DoubleNear;
+using ::testing::ElementsAre;
+using ::testing::SizeIs;
+
+TEST(OpLatencyStatsTest, Median) {
+  EXPECT_EQ(0, Median({}));
+  EXPECT_EQ(3, Median({5, 3, 1}));
+  EXPECT_EQ(2.5, Median({4, 1, 3, 2}));
+}
+
+TEST(OpLatencyStatsTest, MannWhitneyPValue) {
+  // Not enough samples to tell.
+  EXPECT_EQ(1, MannWhitneyPValue({1, 2, 3}, {10, 20, 30}));
+  // Identical samples.
+  EXPECT_EQ(1, MannWhitneyPValue({5, 5, 5, 5, 5}, {5, 5, 5, 5, 5}));
+  // Interleaved samples are consistent with one distribution.
+  EXPECT_GT(MannWhitneyPValue({1, 3, 5, 7, 9, 11}, {2, 4, 6, 8, 10, 12}),
+            0.5);
+  // Fully separated samples: U = 0, mean 18, variance 39, z = 17.5 / 6.245.
+  EXPECT_THAT(MannWhitneyPValue({1, 2, 3, 4, 5, 6}, {7, 8, 9, 10, 11, 12}),
+              DoubleNear(0.00507, 1e-4));
+}
+
+TEST(OpLatencyStatsTest, WriteAndReadOpLatencies) {
+  OpLatencies latencies;
+  latencies[{"cpu", "model.tflite", "0:1"}] = {"CONV_2D", {10, 12, 11}};
+  latencies[{"cpu", "model.tflite", "0:2"}] = {"ADD", {}};
+  std::stringstream stream;
+  WriteOpLatencies(latencies, &stream);
+
+  OpLatencies read;
+  ASSERT_TRUE(ReadOpLatencies(&stream, &read));
+  ASSERT_THAT(read, SizeIs(2));
+  const OpLatency& conv = read[{"cpu", "model.tflite", "0:1"}];
+  EXPECT_EQ("CONV_2D", conv.type);
+  EXPECT_THAT(conv.samples_us, ElementsAre(10, 12, 11));
+  EXPECT_EQ("ADD", (read[{"cpu", "model.tflite", "0:2"}].type));
+
+  std::stringstream malformed("not a header\n");
+  EXPECT_FALSE(ReadOpLatencies(&malformed, &read));
+}
+
+TEST(OpLatencyStatsTest, FindOpLatencyRegressions) {
+  OpLatencies baseline;
+  baseline[{"cpu", "m", "slower"}] = {"CONV_2D", {100, 101, 99, 100, 102, 98}};
+  baseline[{"cpu", "m", "noisy"}] = {"ADD", {10, 30, 12, 28, 11, 29}};
+  baseline[{"cpu", "m", "tiny"}] = {"ADD", {1, 1, 1, 1, 1, 1}};
+  OpLatencies current;
+  current[{"cpu", "m", "slower"}] = {"CONV_2D", {120, 119, 121, 122, 118, 120}};
+  current[{"cpu", "m", "noisy"}] = {"ADD", {13, 31, 14, 29, 12, 30}};
+  // Doubles, but stays within the profiler's resolution.
+  current[{"cpu", "m", "tiny"}] = {"ADD", {2, 2, 2, 2, 2, 2}};
+  current[{"cpu", "m", "new"}] = {"MUL", {5, 5, 5, 5, 5, 5}};
+
+  const auto regressions =
+      FindOpLatencyRegressions(baseline, current, OpLatencyRegressionOptions());
+  ASSERT_THAT(regressions, SizeIs(1));
+  EXPECT_EQ("slower", regressions[0].key.op);
+  EXPECT_EQ(100, regressions[0].baseline_median_us);
+  EXPECT_EQ(120, regressions[0].median_us);
+  EXPECT_LT(regressions[0].p_value, 0.01);
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
@@ -121,13 +121,15 @@ PROFILE_STRATEGY_RANGE = "Range"
 PROFILE_STRATEGY_OPTIMAL = "Optimal"
 PROFILE_STRATEGY_RANGE_OPTIMAL = "Range+Optimal"
 PROFILE_STRATEGY_IMPLICIT_BATCH_MODE_COMPATIBLE = "ImplicitBatchModeCompatible"
+PROFILE_STRATEGY_CLUSTERED = "Clustered"
 
 
 def supported_profile_strategies():
   return [
       PROFILE_STRATEGY_RANGE, PROFILE_STRATEGY_OPTIMAL,
       PROFILE_STRATEGY_RANGE_OPTIMAL,
-      PROFILE_STRATEGY_IMPLICIT_BATCH_MODE_COMPATIBLE
+      PROFILE_STRATEGY_IMPLICIT_BATCH_MODE_COMPATIBLE,
+      PROFILE_STRATEGY_CLUSTERED
   ]
 
 
@@ -1134,6 +1136,13 @@ class TrtGraphConverterV2(object):
        inputs with the same dimensions as the input it is created for. The GPU
        engine will be run with optimal performance with such inputs.
      * `Range+Optimal`: create the profiles for both `Range` and `Optimal`.
+     * `Clustered`: weigh the inputs by how often each shape occurs and create
+       a few `Range` profiles that split the inputs into groups of similarly
+       sized shapes. Each profile is optimized for the most frequent shape of
+       its group. Use this when the input function replays recorded serving
+       traffic: build once with the recorded inputs, save the engines with the
+       SavedModel, and load them with `allow_build_at_runtime=False` so that no
+       engine is ever built on the request path.
   """
 
   def _verify_profile_strategy(self, strategy):
@@ -77,6 +77,21 @@ class DataServiceOpsTest(
     with self.assertRaisesRegex(ValueError, "Invalid `compression` argument"):
       self.make_distributed_range_dataset(10, cluster, compression="foo")
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(max_elements_per_request=[4, -1])))
+  def testDistributeBatchedRequests(self, max_elements_per_request):
+    cluster = self.make_test_cluster(num_workers=2)
+    num_elements = 100
+    ds = self.make_distributed_range_dataset(
+        num_elements,
+        cluster,
+        processing_mode=data_service_ops.ShardingPolicy.DYNAMIC,
+        max_elements_per_request=max_elements_per_request)
+    self.assertDatasetProduces(
+        ds, list(range(num_elements)), assert_items_equal=True)
+
   @combinations.generate(test_base.eager_only_combinations())
   def testDistributeSparse(self):
     cluster = self.make_test_cluster(num_workers=1)
@@ -38,6 +38,7 @@ from tensorflow.python.util import lazy_loader
 from tensorflow.python.util.tf_export import tf_export
 
 COMPRESSION_AUTO = "AUTO"
+COMPRESSION_ZSTD = "ZSTD"
 COMPRESSION_NONE = None
 _PARALLEL_EPOCHS = "parallel_epochs"
 _DISTRIBUTED_EPOCH = "distributed_epoch"
@@ -188,7 +189,7 @@ def _validate_job_name(job_name):
 
 
 def _validate_compression(compression):
-  valid_compressions = [COMPRESSION_AUTO, COMPRESSION_NONE]
+  valid_compressions = [COMPRESSION_AUTO, COMPRESSION_ZSTD, COMPRESSION_NONE]
   if compression not in valid_compressions:
     raise ValueError(f"Invalid `compression` argument: {compression}. "
                      f"Must be one of {valid_compressions}.")
@@ -197,10 +198,13 @@ def _validate_compression(compression):
 def _get_compression_proto(compression):
   if compression == COMPRESSION_AUTO:
     return data_service_pb2.DataServiceMetadata.COMPRESSION_SNAPPY
+  if compression == COMPRESSION_ZSTD:
+    return data_service_pb2.DataServiceMetadata.COMPRESSION_ZSTD
   if compression == COMPRESSION_NONE:
     return data_service_pb2.DataServiceMetadata.COMPRESSION_OFF
+  valid_compressions = [COMPRESSION_AUTO, COMPRESSION_ZSTD, COMPRESSION_NONE]
   raise ValueError(f"Invalid `compression` argument: {compression}. "
-                   f"Must be one of {[COMPRESSION_AUTO, COMPRESSION_NONE]}.")
+                   f"Must be one of {valid_compressions}.")
 
 
 def _to_tensor(dataset_id):
@@ -241,7 +245,8 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
                max_outstanding_requests=None,
                task_refresh_interval_hint_ms=None,
                cross_trainer_cache=None,
-               target_workers="AUTO"):
+               target_workers="AUTO",
+               max_elements_per_request=None):
     """Constructs a _DataServiceDatasetV2.
 
     Args:
@@ -293,6 +298,11 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
         avoid RPCs and data copy if every TF worker colocates with a tf.data
         service worker. Consumers of a shared job must use the same
         `target_workers`. Defaults to `"AUTO"`.
+      max_elements_per_request: (Optional.) The maximum number of elements to
+        fetch with each request to a worker. Values other than 1 also allow
+        several requests in flight per worker, to hide the request latency. If
+        set to `tf.data.AUTOTUNE`, the number is adapted to the element size
+        and the request latency. Ignored for coordinated reads. Defaults to 1.
     """
     if consumer_index is None != num_consumers is None:
       raise ValueError(
@@ -348,6 +358,8 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
     compat_kwargs = {}
     if data_transfer_protocol is not None:
       compat_kwargs["data_transfer_protocol"] = data_transfer_protocol
+    if max_elements_per_request is not None:
+      compat_kwargs["max_elements_per_request"] = max_elements_per_request
 
     # If `uncompress` is `True`, the dataset will query the servers to find
     # out the actual compression used. It is always set to `True` the first
@@ -387,7 +399,7 @@ class _DataServiceDatasetV1(dataset_ops.DatasetV1Adapter):
                protocol, data_transfer_protocol, job_name, consumer_index,
                num_consumers, max_outstanding_requests,
                task_refresh_interval_hint_ms, cross_trainer_cache,
-               target_workers):
+               target_workers, max_elements_per_request=None):
 
     self._wrapped = _DataServiceDatasetV2(
         dataset_id=dataset_id,
@@ -402,7 +414,8 @@ class _DataServiceDatasetV1(dataset_ops.DatasetV1Adapter):
         max_outstanding_requests=max_outstanding_requests,
         task_refresh_interval_hint_ms=task_refresh_interval_hint_ms,
         cross_trainer_cache=cross_trainer_cache,
-        target_workers=target_workers)
+        target_workers=target_workers,
+        max_elements_per_request=max_elements_per_request)
     super(_DataServiceDatasetV1, self).__init__(self._wrapped)
 
 
@@ -450,7 +463,8 @@ def _distribute(processing_mode,
                 data_transfer_protocol=None,
                 compression="AUTO",
                 cross_trainer_cache=None,
-                target_workers="AUTO"):
+                target_workers="AUTO",
+                max_elements_per_request=None):
   """A transformation that moves dataset processing to the tf.data service.
 
   This transformation is similar to `distribute`, but supports additional
@@ -493,7 +507,9 @@ def _distribute(processing_mode,
       data with the tf.data service. By default, data is transferred using gRPC.
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
-      tf.data service runtime. `None` indicates not to compress.
+      tf.data service runtime. "ZSTD" compresses with Zstandard, and sends
+      elements which do not compress well, such as encoded images,
+      uncompressed. `None` indicates not to compress.
     cross_trainer_cache: (Optional.) If a `CrossTrainerCache` object is
       provided, dataset iteration will be shared across concurrently running
       trainers. See
@@ -507,6 +523,11 @@ def _distribute(processing_mode,
       data copy if every TF worker colocates with a tf.data service worker.
       Consumers of a shared job must use the same `target_workers`. Defaults to
       `"AUTO"`.
+    max_elements_per_request: (Optional.) The maximum number of elements to
+      fetch with each request to a worker. Values other than 1 also allow
+      several requests in flight per worker, to hide the request latency. If set
+      to `tf.data.AUTOTUNE`, the number is adapted to the element size and the
+      request latency. Ignored for coordinated reads. Defaults to 1.
 
   Returns:
     Dataset: A `Dataset` of the elements produced by the data service.
@@ -529,7 +550,8 @@ def _distribute(processing_mode,
         data_transfer_protocol=data_transfer_protocol,
         compression=compression,
         cross_trainer_cache=cross_trainer_cache,
-        target_workers=target_workers)
+        target_workers=target_workers,
+        max_elements_per_request=max_elements_per_request)
 
   return _apply_fn
 
@@ -750,7 +772,9 @@ def distribute(processing_mode,
       data with the tf.data service. By default, data is transferred using gRPC.
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
-      tf.data service runtime. `None` indicates not to compress.
+      tf.data service runtime. "ZSTD" compresses with Zstandard, and sends
+      elements which do not compress well, such as encoded images,
+      uncompressed. `None` indicates not to compress.
     cross_trainer_cache: (Optional.) If a `CrossTrainerCache` object is
       provided, dataset iteration will be shared across concurrently running
       trainers. See
@@ -797,7 +821,9 @@ def _register_dataset(service, dataset, compression, dataset_id=None):
     dataset: A `tf.data.Dataset` to register with the tf.data service.
     compression: How to compress the dataset's elements before transferring them
       over the network. "AUTO" leaves the decision of how to compress up to the
-      tf.data service runtime. `None` indicates not to compress.
+      tf.data service runtime. "ZSTD" compresses with Zstandard, and sends
+      elements which do not compress well, such as encoded images,
+      uncompressed. `None` indicates not to compress.
     dataset_id: (Optional.) By default, tf.data service generates a unique
       (string) ID for each registered dataset. If a `dataset_id` is provided, it
       will use the specified ID. If a dataset with a matching ID already exists,
@@ -822,9 +848,10 @@ def _register_dataset(service, dataset, compression, dataset_id=None):
     encoded_spec = nested_structure_coder.encode_structure(
         dataset.element_spec).SerializeToString()
 
-  if compression == COMPRESSION_AUTO:
+  if compression in (COMPRESSION_AUTO, COMPRESSION_ZSTD):
+    codec = "zstd" if compression == COMPRESSION_ZSTD else "snappy"
     dataset = dataset.map(
-        lambda *x: compression_ops.compress(x),
+        lambda *x: compression_ops.compress(x, codec=codec),
         num_parallel_calls=dataset_ops.AUTOTUNE)
   dataset = dataset._apply_debug_options()  # pylint: disable=protected-access
 
@@ -881,8 +908,9 @@ def register_dataset(service, dataset, compression="AUTO", dataset_id=None):
     dataset: A `tf.data.Dataset` to register with the tf.data service.
     compression: (Optional.) How to compress the dataset's elements before
       transferring them over the network. "AUTO" leaves the decision of how to
-      compress up to the tf.data service runtime. `None` indicates not to
-      compress.
+      compress up to the tf.data service runtime. "ZSTD" compresses with
+      Zstandard, and sends elements which do not compress well, such as
+      encoded images, uncompressed. `None` indicates not to compress.
     dataset_id: (Optional.) By default, tf.data service generates a unique
       (string) ID for each registered dataset. If a `dataset_id` is provided, it
       will use the specified ID. If a dataset with a matching ID already exists,
@@ -908,7 +936,8 @@ def _from_dataset_id(processing_mode,
                      data_transfer_protocol=None,
                      compression="AUTO",
                      cross_trainer_cache=None,
-                     target_workers="AUTO"):
+                     target_workers="AUTO",
+                     max_elements_per_request=None):
   """Creates a dataset which reads data from the tf.data service.
 
   This transformation is similar to `from_dataset_id`, but supports additional
@@ -971,6 +1000,11 @@ def _from_dataset_id(processing_mode,
       data copy if every TF worker colocates with a tf.data service worker.
       Consumers of a shared job must use the same `target_workers`. Defaults to
       `"AUTO"`.
+    max_elements_per_request: (Optional.) The maximum number of elements to
+      fetch with each request to a worker. Values other than 1 also allow
+      several requests in flight per worker, to hide the request latency. If set
+      to `tf.data.AUTOTUNE`, the number is adapted to the element size and the
+      request latency. Ignored for coordinated reads. Defaults to 1.
 
   Returns:
     A `tf.data.Dataset` which reads from the tf.data service.
@@ -1039,7 +1073,8 @@ def _from_dataset_id(processing_mode,
       max_outstanding_requests=max_outstanding_requests,
       task_refresh_interval_hint_ms=task_refresh_interval_hint_ms,
       cross_trainer_cache=cross_trainer_cache,
-      target_workers=target_workers)
+      target_workers=target_workers,
+      max_elements_per_request=max_elements_per_request)
 
   # Disable autosharding for shared jobs.
   if job_name is not None:
@@ -307,9 +307,10 @@ class WorkerConfig(
     dispatcher_timeout_ms: How long, in milliseconds, to retry requests to the
       dispatcher before giving up and reporting an error. Defaults to 1 hour.
     data_transfer_protocol: A string indicating the protocol to be used by the
-      worker to transfer data to the client. E.g. "grpc".
+      worker to transfer data to the client. E.g. "grpc", or "shm" to transfer
+      elements through shared memory to clients on the same host (Linux only).
     data_transfer_address: A string indicating the data transfer address of the
-      worker server.
+      worker server. For the "shm" protocol, use e.g. "localhost:%port%".
   """
 
   def __new__(cls,
@@ -17,6 +17,7 @@ import random
 
 from absl.testing import parameterized
 
+from tensorflow.python.data.kernel_tests import checkpoint_test_base
 from tensorflow.python.data.kernel_tests import test_base
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.eager import context
@@ -492,5 +493,23 @@ class BucketBySequenceLengthTest(test_base.DatasetTestBase,
     self.assertEqual(self.evaluate(dataset.cardinality()), dataset_ops.INFINITE)
 
 
+class BucketBySequenceLengthCheckpointTest(
+    checkpoint_test_base.CheckpointTestBase, parameterized.TestCase):
+
+  def _build_dataset(self):
+    dataset = dataset_ops.Dataset.range(1, 11).map(
+        lambda x: array_ops.fill([x], x))
+    return dataset.bucket_by_sequence_length(
+        element_length_func=lambda x: array_ops.shape(x)[0],
+        bucket_boundaries=[4, 8],
+        bucket_batch_sizes=[2, 2, 2])
+
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         checkpoint_test_base.default_test_combinations()))
+  def test(self, verify_fn):
+    verify_fn(self, self._build_dataset, num_outputs=6)
+
+
 if __name__ == "__main__":
   test.main()
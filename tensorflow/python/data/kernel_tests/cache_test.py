@@ -192,6 +192,51 @@ class FileCacheTest(test_base.DatasetTestBase, parameterized.TestCase):
     second_order = self.getDatasetOutput(dataset)
     self.assertEqual(first_order, second_order)
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testContentAddressedCache(self):
+
+    def dataset_fn(count):
+      return dataset_ops.Dataset.range(count).map(lambda x: x * x).cache(
+          self.tmp_dir, content_addressed=True)
+
+    # Each input pipeline writes its own cache.
+    self.assertDatasetProduces(
+        dataset_fn(5), expected_output=[x * x for x in range(5)])
+    self.assertDatasetProduces(
+        dataset_fn(10), expected_output=[x * x for x in range(10)])
+    cache_dirs = [
+        d for d in os.listdir(self.tmp_dir)
+        if path.isdir(path.join(self.tmp_dir, d))
+    ]
+    self.assertLen(cache_dirs, 2)
+    # Reading a committed cache does not write another one.
+    self.assertDatasetProduces(
+        dataset_fn(5), expected_output=[x * x for x in range(5)])
+    self.assertLen(os.listdir(self.tmp_dir), 2)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testContentAddressedCacheConcurrentWriters(self):
+    dataset = dataset_ops.Dataset.range(4).cache(
+        self.tmp_dir, content_addressed=True)
+    get_next1 = self.getNext(dataset)
+    get_next2 = self.getNext(dataset)
+    # The second iterator computes its elements from the input instead of
+    # failing or writing a second copy of the cache.
+    for i in range(4):
+      self.assertEqual(i, self.evaluate(get_next1()))
+      self.assertEqual(i, self.evaluate(get_next2()))
+    with self.assertRaises(errors.OutOfRangeError):
+      self.evaluate(get_next1())
+    with self.assertRaises(errors.OutOfRangeError):
+      self.evaluate(get_next2())
+    self.assertLen(os.listdir(self.tmp_dir), 1)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testContentAddressedCacheRequiresFilename(self):
+    with self.assertRaises(errors.InvalidArgumentError):
+      dataset = dataset_ops.Dataset.range(4).cache(content_addressed=True)
+      self.evaluate(self.getNext(dataset)())
+
   @combinations.generate(test_base.default_test_combinations())
   def testCleaningUpCacheFiles(self):
 
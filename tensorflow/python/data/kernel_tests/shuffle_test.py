@@ -25,6 +25,7 @@ from tensorflow.python.data.experimental.ops import random_access
 from tensorflow.python.data.kernel_tests import checkpoint_test_base
 from tensorflow.python.data.kernel_tests import test_base
 from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.ops import options as options_lib
 from tensorflow.python.eager import def_function
 from tensorflow.python.framework import combinations
 from tensorflow.python.framework import dtypes
@@ -418,6 +419,36 @@ class ShuffleTest(test_base.DatasetTestBase, parameterized.TestCase):
     dataset = dataset_ops.Dataset.from_tensors(42).shuffle(1, name="shuffle")
     self.assertDatasetProduces(dataset, [42])
 
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(num_shards=[2, 4, 16])))
+  def testShardedBuffer(self, num_shards):
+    dataset = dataset_ops.Dataset.range(100).shuffle(
+        10, seed=42, num_shards=num_shards)
+    output = self.getDatasetOutput(dataset, requires_initialization=True)
+    self.assertCountEqual(output, range(100))
+    self.assertNotEqual(output, list(range(100)))
+    # The output order only depends on the seed.
+    dataset = dataset_ops.Dataset.range(100).shuffle(
+        10, seed=42, num_shards=num_shards)
+    self.assertEqual(
+        output, self.getDatasetOutput(dataset, requires_initialization=True))
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testShardedBufferNondeterministic(self):
+    dataset = dataset_ops.Dataset.range(100).shuffle(10, num_shards=4)
+    options = options_lib.Options()
+    options.deterministic = False
+    dataset = dataset.with_options(options)
+    self.assertDatasetProduces(
+        dataset, range(100), assert_items_equal=True,
+        requires_initialization=True)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testInvalidNumShards(self):
+    with self.assertRaisesRegex(ValueError, "Invalid `num_shards`"):
+      dataset_ops.Dataset.range(10).shuffle(10, num_shards=0)
+
 
 class ShuffleCheckpointTest(checkpoint_test_base.CheckpointTestBase,
                             parameterized.TestCase):
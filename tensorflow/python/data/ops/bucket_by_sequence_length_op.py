@@ -0,0 +1,145 @@
+# Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""The native implementation of `tf.data.Dataset.bucket_by_sequence_length`."""
+
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.ops import padded_batch_op
+from tensorflow.python.data.ops import structured_function
+from tensorflow.python.data.util import nest
+from tensorflow.python.data.util import structure
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.framework import tensor_shape
+from tensorflow.python.framework import tensor_spec
+from tensorflow.python.framework import tensor_util
+from tensorflow.python.ops import gen_experimental_dataset_ops as ged_ops
+
+
+def _is_supported(input_dataset, bucket_boundaries):
+  """Returns whether the native kernel can replace the windowed fallback."""
+  try:
+    boundaries = [int(b) for b in bucket_boundaries]
+  except TypeError:
+    return False
+  if any(a >= b for a, b in zip(boundaries, boundaries[1:])):
+    return False
+  return all(
+      isinstance(spec, tensor_spec.TensorSpec)
+      for spec in nest.flatten(input_dataset.element_spec))
+
+
+class _BucketBySequenceLengthDataset(dataset_ops.UnaryDataset):
+  """A `Dataset` that pads and batches its input in buckets by length."""
+
+  def __init__(self,
+               input_dataset,
+               element_length_func,
+               bucket_boundaries,
+               bucket_batch_sizes,
+               padded_shapes,
+               padding_values,
+               pad_to_bucket_boundary,
+               drop_remainder,
+               name=None):
+    """See `Dataset.bucket_by_sequence_length()` for details."""
+    self._input_dataset = input_dataset
+    # pylint: disable=protected-access
+    self._make_element_length_func(element_length_func, input_dataset)
+
+    input_shapes = dataset_ops.get_legacy_output_shapes(input_dataset)
+    if padded_shapes is None:
+      padded_shapes = input_shapes
+    flat_padded_shapes = nest.flatten_up_to(input_shapes, padded_shapes)
+    flat_padded_shapes_as_tensors = [
+        padded_batch_op._padded_shape_to_tensor(padded_shape, input_shape)
+        for input_shape, padded_shape in zip(
+            nest.flatten(input_shapes), flat_padded_shapes)
+    ]
+
+    padding_values = padded_batch_op._padding_values_or_default(
+        padding_values, input_dataset)
+    # If padding_values is a single element and input_shapes is a structure,
+    # "broadcast" padding_values to the same structure as input_shapes.
+    if nest.is_nested(input_shapes) and not nest.is_nested(padding_values):
+      padding_values = nest.map_structure(lambda _: padding_values,
+                                          input_shapes)
+    self._padding_values = nest.map_structure_up_to(
+        input_shapes,
+        padded_batch_op._padding_value_to_tensor,
+        padding_values,
+        dataset_ops.get_legacy_output_types(input_dataset))
+
+    # Batches from different buckets have different sizes, and unknown
+    # dimensions are padded per batch (or per bucket), so only the known
+    # padded dimensions are static.
+    def _padded_shape_to_batch_shape(s):
+      return tensor_shape.TensorShape([None]).concatenate(
+          tensor_util.constant_value_as_shape(s))
+
+    output_shapes = nest.pack_sequence_as(input_shapes, [
+        _padded_shape_to_batch_shape(s) for s in flat_padded_shapes_as_tensors
+    ])
+    self._structure = structure.convert_legacy_structure(
+        dataset_ops.get_legacy_output_types(input_dataset), output_shapes,
+        dataset_ops.get_legacy_output_classes(input_dataset))
+
+    self._name = name
+    variant_tensor = ged_ops.bucket_by_sequence_length_dataset(
+        input_dataset._variant_tensor,
+        self._element_length_func.function.captured_inputs,
+        bucket_boundaries=ops.convert_to_tensor(
+            list(bucket_boundaries), dtype=dtypes.int64),
+        bucket_batch_sizes=ops.convert_to_tensor(
+            list(bucket_batch_sizes), dtype=dtypes.int64),
+        padded_shapes=flat_padded_shapes_as_tensors,
+        padding_values=nest.flatten(self._padding_values),
+        drop_remainder=ops.convert_to_tensor(
+            drop_remainder, dtype=dtypes.bool, name="drop_remainder"),
+        element_length_func=self._element_length_func.function,
+        pad_to_bucket_boundary=pad_to_bucket_boundary,
+        output_shapes=structure.get_flat_tensor_shapes(self._structure),
+        metadata=self._metadata.SerializeToString())
+    # pylint: enable=protected-access
+    super().__init__(input_dataset, variant_tensor)
+
+  def _make_element_length_func(self, element_length_func, input_dataset):
+    """Make wrapping defun for element_length_func."""
+
+    def element_length_func_wrapper(*args):
+      return ops.convert_to_tensor(
+          element_length_func(*args), dtype_hint=dtypes.int64)
+
+    self._element_length_func = structured_function.StructuredFunctionWrapper(
+        element_length_func_wrapper,
+        self._transformation_name(),
+        dataset=input_dataset)
+    output_structure = self._element_length_func.output_structure
+    if not (output_structure.is_compatible_with(
+        tensor_spec.TensorSpec([], dtypes.int64)) or
+            output_structure.is_compatible_with(
+                tensor_spec.TensorSpec([], dtypes.int32))):
+      raise ValueError(f"Invalid `element_length_func`. `element_length_func` "
+                       f"must return a single `tf.int32` or `tf.int64` scalar "
+                       f"tensor but its return type is {output_structure}.")
+
+  @property
+  def element_spec(self):
+    return self._structure
+
+  def _functions(self):
+    return [self._element_length_func]
+
+  def _transformation_name(self):
+    return "Dataset.bucket_by_sequence_length()"
@@ -22,28 +22,37 @@ from tensorflow.python.framework import ops
 from tensorflow.python.ops import gen_dataset_ops
 
 
-def _cache(input_dataset, filename, name):  # pylint: disable=unused-private-name
-  return CacheDataset(input_dataset, filename, name)
+def _cache(input_dataset, filename, content_addressed, name):  # pylint: disable=unused-private-name
+  return CacheDataset(input_dataset, filename, content_addressed, name)
 
 
 class CacheDataset(dataset_ops.UnaryUnchangedStructureDataset):
   """A `Dataset` that caches elements of its input."""
 
-  def __init__(self, input_dataset, filename, name=None):
+  def __init__(self,
+               input_dataset,
+               filename,
+               content_addressed=None,
+               name=None):
     """See `Dataset.cache()` for details."""
     self._input_dataset = input_dataset
     self._filename = ops.convert_to_tensor(
         filename, dtype=dtypes.string, name="filename")
+    if content_addressed is None:
+      content_addressed = False
+    self._content_addressed = content_addressed
     self._name = name
     if tf2.enabled() and (context.executing_eagerly() or ops.inside_function()):
       variant_tensor = gen_dataset_ops.cache_dataset_v2(
           input_dataset._variant_tensor,  # pylint: disable=protected-access
           filename=self._filename,
           cache=gen_dataset_ops.dummy_memory_cache(),
+          content_addressed=self._content_addressed,
           **self._common_args)
     else:
       variant_tensor = gen_dataset_ops.cache_dataset(
           input_dataset._variant_tensor,  # pylint: disable=protected-access
           filename=self._filename,
+          content_addressed=self._content_addressed,
           **self._common_args)
     super().__init__(input_dataset, variant_tensor)
@@ -1381,6 +1381,7 @@ class DatasetV2(
               buffer_size,
               seed=None,
               reshuffle_each_iteration=None,
+              num_shards=None,
               name=None):
     """Randomly shuffles the elements of this dataset.
 
@@ -1441,15 +1442,27 @@ class DatasetV2(
       reshuffle_each_iteration: (Optional.) A boolean, which if true indicates
         that the dataset should be pseudorandomly reshuffled each time it is
         iterated over. (Defaults to `True`.)
+      num_shards: (Optional.) An integer, representing the number of
+        shards the shuffle buffer is split into. Each shard holds up to
+        `ceil(buffer_size / num_shards)` elements and is filled and sampled
+        independently by background threads, which lets a slow input fill the
+        buffer in parallel. Unless `tf.data.Options.deterministic` is `False`,
+        the output order only depends on the seed. (Defaults to 1, which
+        uses a single, unsharded buffer.)
       name: (Optional.) A name for the tf.data operation.
 
     Returns:
       A new `Dataset` with the transformation applied as described above.
     """
     return shuffle_op._shuffle(  # pylint: disable=protected-access
-        self, buffer_size, seed, reshuffle_each_iteration, name=name)
+        self,
+        buffer_size,
+        seed,
+        reshuffle_each_iteration,
+        num_shards=num_shards,
+        name=name)
 
-  def cache(self, filename="", name=None):
+  def cache(self, filename="", content_addressed=None, name=None):
     """Caches the elements in this dataset.
 
     The first time the dataset is iterated over, its elements will be cached
@@ -1487,6 +1500,27 @@ class DatasetV2(
     # [0, 1, 2, 3, 4]
     ```
 
+    With `content_addressed=True`, `filename` names a directory that can be
+    shared by jobs with different input pipelines. Each cache is stored in a
+    subdirectory named after the fingerprint of the input pipeline, so changing
+    the pipeline before the call to `.cache()` writes a new cache instead of
+    reading a stale one, and jobs with the same input pipeline (e.g. the trials
+    of a hyperparameter sweep) share one cache. A cache only becomes visible
+    once it has been completely written, and it is read in parallel chunks.
+    While one job writes a cache, other jobs with the same input pipeline
+    compute their elements from the input instead of writing it again.
+
+    ```python
+    dataset = tf.data.Dataset.range(5).map(lambda x: x**2)
+    dataset = dataset.cache("/path/to/dir", content_addressed=True)
+    list(dataset.as_numpy_iterator())
+    # [0, 1, 4, 9, 16]
+    dataset = tf.data.Dataset.range(10).map(lambda x: x**2)
+    dataset = dataset.cache("/path/to/dir", content_addressed=True)
+    list(dataset.as_numpy_iterator())  # Writes a second cache.
+    # [0, 1, 4, 9, 16, 25, 36, 49, 64, 81]
+    ```
+
     Note: `cache` will produce exactly the same elements during each iteration
     through the dataset. If you wish to randomize the iteration order, make sure
     to call `shuffle` *after* calling `cache`.
@@ -1495,6 +1529,10 @@ class DatasetV2(
       filename: A `tf.string` scalar `tf.Tensor`, representing the name of a
         directory on the filesystem to use for caching elements in this Dataset.
         If a filename is not provided, the dataset will be cached in memory.
+      content_addressed: (Optional.) A boolean, which if true indicates that
+        the cache is stored in a subdirectory of `filename` named after the
+        fingerprint of the input dataset, as described above. Requires a
+        non-empty `filename`. (Defaults to `False`.)
       name: (Optional.) A name for the tf.data operation.
 
     Returns:
@@ -1504,7 +1542,7 @@ class DatasetV2(
     # -> dataset_ops).
     # pylint: disable=g-import-not-at-top,protected-access
     from tensorflow.python.data.ops import cache_op
-    return cache_op._cache(self, filename, name)
+    return cache_op._cache(self, filename, content_addressed, name)
     # pylint: enable=g-import-not-at-top,protected-access
 
   def take(self, count, name=None):
@@ -3110,6 +3148,24 @@ name=None))
           f"but `len(bucket_batch_sizes)={len(bucket_batch_sizes)}` and "
           f"`len(bucket_boundaries)={len(bucket_boundaries)}`.")
 
+    # Loaded lazily due to a circular dependency (
+    # dataset_ops -> bucket_by_sequence_length_op -> dataset_ops).
+    # pylint: disable=g-import-not-at-top,protected-access
+    from tensorflow.python.data.ops import bucket_by_sequence_length_op
+    if not no_padding and bucket_by_sequence_length_op._is_supported(
+        self, bucket_boundaries):
+      return bucket_by_sequence_length_op._BucketBySequenceLengthDataset(
+          self,
+          element_length_func,
+          bucket_boundaries,
+          bucket_batch_sizes,
+          padded_shapes,
+          padding_values,
+          pad_to_bucket_boundary,
+          drop_remainder,
+          name=name)
+    # pylint: enable=g-import-not-at-top,protected-access
+
     batch_sizes = constant_op.constant(bucket_batch_sizes, dtype=dtypes.int64)
 
     def element_to_bucket_id(*args):
@@ -3965,14 +4021,21 @@ class DatasetV1(DatasetV2, data_types.DatasetV1):
               buffer_size,
               seed=None,
               reshuffle_each_iteration=None,
+              num_shards=None,
               name=None):
     return DatasetV1Adapter(
         super(DatasetV1, self).shuffle(
-            buffer_size, seed, reshuffle_each_iteration, name=name))
+            buffer_size,
+            seed,
+            reshuffle_each_iteration,
+            num_shards=num_shards,
+            name=name))
 
   @functools.wraps(DatasetV2.cache)
-  def cache(self, filename="", name=None):
-    return DatasetV1Adapter(super(DatasetV1, self).cache(filename, name=name))
+  def cache(self, filename="", content_addressed=None, name=None):
+    return DatasetV1Adapter(
+        super(DatasetV1, self).cache(
+            filename, content_addressed=content_addressed, name=name))
 
   @functools.wraps(DatasetV2.take)
   def take(self, count, name=None):
@@ -322,6 +322,15 @@ class OptimizationOptions(options_lib.OptionsBase):
       "Whether to apply default graph optimizations. If False, only graph "
       "optimizations that have been explicitly enabled will be applied.")
 
+  columnar_projection_pushdown = options_lib.create_option(
+      name="columnar_projection_pushdown",
+      ty=bool,
+      docstring=
+      "Whether to read only the parsed features of a columnar source whose "
+      "serialized `tf.Example`s are parsed by `parse_example_dataset`. The "
+      "dense and ragged features must be stored as dense columns of the same "
+      "shape and as ragged columns respectively. If None, defaults to False.")
+
   filter_fusion = options_lib.create_option(
       name="filter_fusion",
       ty=bool,
@@ -370,6 +379,14 @@ class OptimizationOptions(options_lib.OptionsBase):
       "Whether to parallelize stateless map transformations. If None, defaults "
       "to True.")
 
+  map_vectorization = options_lib.create_option(
+      name="map_vectorization",
+      ty=bool,
+      docstring=
+      "Whether to vectorize map transformations whose function is "
+      "elementwise, by applying the function to whole batches of a subsequent "
+      "batch transformation. If None, defaults to False.")
+
   noop_elimination = options_lib.create_option(
       name="noop_elimination",
       ty=bool,
@@ -406,6 +423,8 @@ class OptimizationOptions(options_lib.OptionsBase):
     pb = dataset_options_pb2.OptimizationOptions()
     if self.apply_default_optimizations is not None:
       pb.apply_default_optimizations = self.apply_default_optimizations
+    if self.columnar_projection_pushdown is not None:
+      pb.columnar_projection_pushdown = self.columnar_projection_pushdown
     if self.filter_fusion is not None:
       pb.filter_fusion = self.filter_fusion
     if self.filter_parallelization is not None:
@@ -420,6 +439,8 @@ class OptimizationOptions(options_lib.OptionsBase):
       pb.map_fusion = self.map_fusion
     if self.map_parallelization is not None:
       pb.map_parallelization = self.map_parallelization
+    if self.map_vectorization is not None:
+      pb.map_vectorization = self.map_vectorization
     if self.noop_elimination is not None:
       pb.noop_elimination = self.noop_elimination
     if self.parallel_batch is not None:
@@ -433,6 +454,8 @@ class OptimizationOptions(options_lib.OptionsBase):
   def _from_proto(self, pb):
     if pb.WhichOneof("optional_apply_default_optimizations") is not None:
       self.apply_default_optimizations = pb.apply_default_optimizations
+    if pb.WhichOneof("optional_columnar_projection_pushdown") is not None:
+      self.columnar_projection_pushdown = pb.columnar_projection_pushdown
     if pb.WhichOneof("optional_filter_fusion") is not None:
       self.filter_fusion = pb.filter_fusion
     if pb.WhichOneof("optional_filter_parallelization") is not None:
@@ -447,6 +470,8 @@ class OptimizationOptions(options_lib.OptionsBase):
       self.map_fusion = pb.map_fusion
     if pb.WhichOneof("optional_map_parallelization") is not None:
       self.map_parallelization = pb.map_parallelization
+    if pb.WhichOneof("optional_map_vectorization") is not None:
+      self.map_vectorization = pb.map_vectorization
     if pb.WhichOneof("optional_noop_elimination") is not None:
       self.noop_elimination = pb.noop_elimination
     if pb.WhichOneof("optional_parallel_batch") is not None:
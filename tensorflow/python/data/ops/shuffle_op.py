@@ -27,9 +27,15 @@ def _shuffle(  # pylint: disable=unused-private-name
     buffer_size,
     seed=None,
     reshuffle_each_iteration=None,
+    num_shards=None,
     name=None):
   return _ShuffleDataset(
-      input_dataset, buffer_size, seed, reshuffle_each_iteration, name=name)
+      input_dataset,
+      buffer_size,
+      seed,
+      reshuffle_each_iteration,
+      num_shards=num_shards,
+      name=name)
 
 
 class _ShuffleDataset(dataset_ops.UnaryUnchangedStructureDataset):
@@ -40,6 +46,7 @@ class _ShuffleDataset(dataset_ops.UnaryUnchangedStructureDataset):
                buffer_size,
                seed=None,
                reshuffle_each_iteration=None,
+               num_shards=None,
                name=None):
     """See `Dataset.shuffle()` for details."""
     self._input_dataset = input_dataset
@@ -49,10 +56,18 @@ class _ShuffleDataset(dataset_ops.UnaryUnchangedStructureDataset):
     if reshuffle_each_iteration is None:
       reshuffle_each_iteration = True
     self._reshuffle_each_iteration = reshuffle_each_iteration
+    if num_shards is None:
+      num_shards = 1
+    if num_shards < 1:
+      raise ValueError(
+          f"Invalid `num_shards`. `num_shards` must be at least 1, but got "
+          f"{num_shards}.")
+    self._num_shards = num_shards
     self._name = name
 
-    if (tf2.enabled() and
-        (context.executing_eagerly() or ops.inside_function())):
+    if self._num_shards > 1 or (tf2.enabled() and
+                                (context.executing_eagerly() or
+                                 ops.inside_function())):
       variant_tensor = gen_dataset_ops.shuffle_dataset_v3(
           input_dataset._variant_tensor,  # pylint: disable=protected-access
           buffer_size=self._buffer_size,
@@ -60,6 +75,7 @@ class _ShuffleDataset(dataset_ops.UnaryUnchangedStructureDataset):
           seed2=self._seed2,
           seed_generator=gen_dataset_ops.dummy_seed_generator(),
           reshuffle_each_iteration=self._reshuffle_each_iteration,
+          num_shards=self._num_shards,
           **self._common_args)
     else:
       variant_tensor = gen_dataset_ops.shuffle_dataset(
@@ -166,6 +166,18 @@ class UniqueTest(test.TestCase):
     self.assertAllEqual(tf_y, true_y)
     self.assertAllEqual(tf_idx, true_idx)
 
+  def testLargeOrderedByAppearance(self):
+    # Large enough to be uniquified by several threads.
+    x = np.random.randint(-50000, high=50000, size=500000)
+    _, first, inverse = np.unique(x, return_index=True, return_inverse=True)
+    order = np.argsort(first)
+    rank = np.empty_like(order)
+    rank[order] = np.arange(len(order))
+    y, idx = array_ops.unique(x)
+    tf_y, tf_idx = self.evaluate([y, idx])
+    self.assertAllEqual(tf_y, x[np.sort(first)])
+    self.assertAllEqual(tf_idx, rank[inverse])
+
 
 class UniqueWithCountsTest(test.TestCase):
 
@@ -313,6 +325,20 @@ class UniqueWithCountsTest(test.TestCase):
     self.assertAllEqual(tf_idx, true_idx)
     self.assertAllEqual(tf_count, true_count)
 
+  def testLargeOrderedByAppearance(self):
+    # Large enough to be uniquified by several threads.
+    x = np.random.randint(-50000, high=50000, size=500000)
+    _, first, inverse, counts = np.unique(
+        x, return_index=True, return_inverse=True, return_counts=True)
+    order = np.argsort(first)
+    rank = np.empty_like(order)
+    rank[order] = np.arange(len(order))
+    y, idx, count = array_ops.unique_with_counts(x)
+    tf_y, tf_idx, tf_count = self.evaluate([y, idx, count])
+    self.assertAllEqual(tf_y, x[np.sort(first)])
+    self.assertAllEqual(tf_idx, rank[inverse])
+    self.assertAllEqual(tf_count, counts[order])
+
 
 if __name__ == '__main__':
   test.main()
@@ -213,6 +213,21 @@ class FIFOQueueTest(test.TestCase):
       self.assertEqual([x], x_val)
       self.assertEqual([y], y_val)
 
+  def testInterleavedEnqueueAndDequeue(self):
+    q = data_flow_ops.FIFOQueue(3, dtypes_lib.float32)
+    elems = [10.0, 20.0, 30.0, 40.0, 50.0, 60.0]
+
+    # Keep the queue partially full so that every operation can complete
+    # without waiting.
+    results = []
+    for x in elems:
+      self.evaluate(q.enqueue((x,)))
+      if self.evaluate(q.size()) == 2:
+        results.append(self.evaluate(q.dequeue()))
+    while self.evaluate(q.size()):
+      results.append(self.evaluate(q.dequeue()))
+    self.assertAllEqual(elems, results)
+
   def testQueueSizeEmpty(self):
     q = data_flow_ops.FIFOQueue(10, dtypes_lib.float32)
     self.assertEqual([0], self.evaluate(q.size()))
@@ -1236,6 +1251,112 @@ class FIFOQueueParallelTests(test.TestCase):
       with self.assertRaisesRegex(errors_impl.CancelledError, "is closed"):
         enqueue_op.run()
 
+  def testDequeueFromClosedQueueDrainsElements(self):
+    with self.cached_session():
+      q = data_flow_ops.FIFOQueue(10, dtypes_lib.float32)
+      elems = [10.0, 20.0]
+      enqueue_ops = [q.enqueue((x,)) for x in elems]
+      dequeued_t = q.dequeue()
+      close_op = q.close()
+
+      for enqueue_op in enqueue_ops:
+        enqueue_op.run()
+      close_op.run()
+
+      # Elements enqueued before the close are still dequeued in order.
+      for elem in elems:
+        self.assertEqual([elem], self.evaluate(dequeued_t))
+      with self.assertRaisesRegex(errors_impl.OutOfRangeError,
+                                  "is closed and has insufficient"):
+        self.evaluate(dequeued_t)
+      with self.assertRaisesRegex(errors_impl.CancelledError, "is closed"):
+        enqueue_ops[0].run()
+
+  def testBlockedDequeuesWakeOnEnqueue(self):
+    # We need each thread to keep its own device stack or the device scopes
+    # won't be properly nested.
+    ops.get_default_graph().switch_to_thread_local()
+    with self.cached_session() as sess:
+      q = data_flow_ops.FIFOQueue(10, dtypes_lib.float32)
+      elems = [10.0, 20.0, 30.0]
+      enqueue_ops = [q.enqueue((x,)) for x in elems]
+      dequeued_t = q.dequeue()
+
+      results = []
+
+      def dequeue():
+        results.append(self.evaluate(dequeued_t))
+
+      threads = [self.checkedThread(target=dequeue) for _ in elems]
+      for thread in threads:
+        thread.start()
+      # The enqueue ops should run after the dequeue ops have blocked.
+      time.sleep(0.1)
+      for enqueue_op in enqueue_ops:
+        self.evaluate(enqueue_op)
+      for thread in threads:
+        thread.join()
+      self.assertItemsEqual(elems, results)
+      self.assertEqual(0, self.evaluate(q.size()))
+
+  def testBlockedDequeueIsServedBeforeLaterDequeue(self):
+    # We need each thread to keep its own device stack or the device scopes
+    # won't be properly nested.
+    ops.get_default_graph().switch_to_thread_local()
+    with self.cached_session() as sess:
+      q = data_flow_ops.FIFOQueue(10, dtypes_lib.float32)
+      dequeued_t = q.dequeue()
+      enqueue_10 = q.enqueue((10.0,))
+      enqueue_20 = q.enqueue((20.0,))
+
+      def blocking_dequeue():
+        self.assertEqual([10.0], self.evaluate(dequeued_t))
+
+      thread = self.checkedThread(target=blocking_dequeue)
+      thread.start()
+      # The enqueue op should run after the dequeue op has blocked.
+      time.sleep(0.1)
+      self.evaluate(enqueue_10)
+      thread.join()
+
+      self.evaluate(enqueue_20)
+      self.assertEqual([20.0], self.evaluate(dequeued_t))
+
+  def testBlockedEnqueuesWakeOnDequeue(self):
+    # We need each thread to keep its own device stack or the device scopes
+    # won't be properly nested.
+    ops.get_default_graph().switch_to_thread_local()
+    with self.cached_session() as sess:
+      q = data_flow_ops.FIFOQueue(2, dtypes_lib.float32)
+      elems = [10.0, 20.0]
+      blocked_elems = [30.0, 40.0, 50.0]
+      enqueue_op = q.enqueue_many((elems,))
+      blocking_enqueue_ops = [q.enqueue((x,)) for x in blocked_elems]
+      dequeued_t = q.dequeue()
+
+      enqueue_op.run()
+
+      def blocking_enqueue(blocking_enqueue_op):
+        self.evaluate(blocking_enqueue_op)
+
+      threads = [
+          self.checkedThread(target=blocking_enqueue, args=(op,))
+          for op in blocking_enqueue_ops
+      ]
+      for thread in threads:
+        thread.start()
+      # The dequeue ops should run after the enqueue ops have blocked.
+      time.sleep(0.1)
+      self.assertEqual(2, self.evaluate(q.size()))
+
+      results = [self.evaluate(dequeued_t) for _ in elems + blocked_elems]
+      for thread in threads:
+        thread.join()
+      # The elements that were already in the queue come out first.
+      self.assertAllEqual([[x] for x in elems], results[:len(elems)])
+      self.assertItemsEqual([[x] for x in blocked_elems], results[len(elems):])
+      self.assertEqual(0, self.evaluate(q.size()))
+
   def testEnqueueManyToClosedQueue(self):
     with self.cached_session():
       q = data_flow_ops.FIFOQueue(10, dtypes_lib.float32)
@@ -1722,6 +1843,25 @@ class FIFOQueueWithTimeoutTest(test.TestCase):
       self.evaluate(enqueue_op)
       self.assertEqual(37, self.evaluate(dequeued_t))
 
+  def testReusableAfterEnqueueTimeout(self):
+    with self.cached_session() as sess:
+      q = data_flow_ops.FIFOQueue(1, dtypes_lib.float32)
+      dequeued_t = q.dequeue()
+      enqueue_10 = q.enqueue(10.0)
+      enqueue_20 = q.enqueue(20.0)
+      enqueue_30 = q.enqueue(30.0)
+
+      self.evaluate(enqueue_10)
+      with self.assertRaisesRegex(errors_impl.DeadlineExceededError,
+                                  "Timed out waiting for notification"):
+        sess.run(enqueue_20, options=config_pb2.RunOptions(timeout_in_ms=10))
+
+      # The cancelled enqueue must not have added its element.
+      self.assertEqual(1, self.evaluate(q.size()))
+      self.assertEqual(10.0, self.evaluate(dequeued_t))
+      self.evaluate(enqueue_30)
+      self.assertEqual(30.0, self.evaluate(dequeued_t))
+      self.assertEqual(0, self.evaluate(q.size()))
 
 class QueueContainerTest(test.TestCase):
 
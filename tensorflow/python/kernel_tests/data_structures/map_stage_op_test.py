@@ -17,6 +17,7 @@ import threading
 
 import numpy as np
 
+from tensorflow.core.protobuf import config_pb2
 from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import errors
@@ -30,6 +31,13 @@ from tensorflow.python.platform import test
 TIMEOUT = 1
 
 
+def _blocking_config(num_threads):
+  # Blocked staging ops hold on to their inter-op thread, so give the session
+  # enough threads for all of them and the ops that wake them up.
+  return config_pb2.ConfigProto(
+      inter_op_parallelism_threads=num_threads, use_per_session_threads=True)
+
+
 class MapStageTest(test.TestCase):
 
   @test_util.run_deprecated_v1
@@ -639,6 +647,94 @@ class MapStageTest(test.TestCase):
       )
       self.evaluate(v)
 
+  @test_util.run_deprecated_v1
+  def testBlockedGetsWakeOnPut(self):
+    with ops.Graph().as_default() as g:
+      with ops.device('/cpu:0'):
+        x = array_ops.placeholder(dtypes.int32, name='x')
+        pi = array_ops.placeholder(dtypes.int64, name='pi')
+        gi = array_ops.placeholder(dtypes.int64, name='gi')
+        stager = data_flow_ops.MapStagingArea([dtypes.int32], shapes=[[]])
+        stage = stager.put(pi, [x], [0])
+        peek = stager.peek(gi)
+        _, get = stager.get(gi)
+
+    g.finalize()
+
+    n = 3
+    with self.session(graph=g, config=_blocking_config(n + 2)) as sess:
+      # Block a getter for each key, and a peek for a key that is never
+      # removed.
+      values = {}
+      threads = [
+          threading.Thread(
+              target=lambda i=i: values.update(
+                  {i: sess.run(get, feed_dict={gi: i})})) for i in range(n)
+      ]
+      threads.append(
+          threading.Thread(
+              target=lambda: values.update(
+                  {'peek': sess.run(peek, feed_dict={gi: n})})))
+      for t in threads:
+        t.daemon = True
+        t.start()
+      threads[-1].join(TIMEOUT)
+      self.assertTrue(all(t.is_alive() for t in threads))
+
+      # Each put only lets the waiter for its key finish.
+      for i in reversed(range(n)):
+        sess.run(stage, feed_dict={pi: i, x: i})
+        threads[i].join(TIMEOUT)
+        self.assertFalse(threads[i].is_alive())
+        self.assertEqual(values[i], [i])
+        self.assertTrue(threads[-1].is_alive())
+
+      sess.run(stage, feed_dict={pi: n, x: n})
+      threads[-1].join(TIMEOUT)
+      self.assertFalse(threads[-1].is_alive())
+      self.assertEqual(values['peek'], [n])
+
+  @test_util.run_deprecated_v1
+  def testBlockedPutsWakeOnGet(self):
+    with ops.Graph().as_default() as g:
+      with ops.device('/cpu:0'):
+        x = array_ops.placeholder(dtypes.int32, name='x')
+        pi = array_ops.placeholder(dtypes.int64, name='pi')
+        stager = data_flow_ops.MapStagingArea([dtypes.int32],
+                                              capacity=1,
+                                              shapes=[[]])
+        stage = stager.put(pi, [x], [0])
+        get = stager.get()
+        size = stager.size()
+
+    g.finalize()
+
+    n = 3
+    with self.session(graph=g, config=_blocking_config(n + 2)) as sess:
+      sess.run(stage, feed_dict={pi: 0, x: 0})
+
+      # Block several inserters on the full map.
+      threads = [
+          threading.Thread(
+              target=lambda i=i: sess.run(stage, feed_dict={pi: i, x: i}))
+          for i in range(1, n + 1)
+      ]
+      for t in threads:
+        t.daemon = True
+        t.start()
+      threads[-1].join(TIMEOUT)
+      self.assertTrue(all(t.is_alive() for t in threads))
+      self.assertEqual(sess.run(size), 1)
+
+      # Every get makes room for one of them.
+      keys = [sess.run(get)[0] for _ in range(n + 1)]
+      for t in threads:
+        t.join(TIMEOUT)
+        self.assertFalse(t.is_alive())
+      self.assertEqual(keys[0], 0)
+      self.assertEqual(sorted(keys), list(range(n + 1)))
+      self.assertEqual(sess.run(size), 0)
+
 
 if __name__ == '__main__':
   test.main()
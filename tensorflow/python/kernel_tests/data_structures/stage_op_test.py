@@ -17,6 +17,7 @@ import threading
 
 import numpy as np
 
+from tensorflow.core.protobuf import config_pb2
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import errors
 from tensorflow.python.framework import ops
@@ -29,6 +30,13 @@ from tensorflow.python.platform import test
 TIMEOUT = 1
 
 
+def _blocking_config(num_threads):
+  # Blocked staging ops hold on to their inter-op thread, so give the session
+  # enough threads for all of them and the ops that wake them up.
+  return config_pb2.ConfigProto(
+      inter_op_parallelism_threads=num_threads, use_per_session_threads=True)
+
+
 class StageTest(test.TestCase):
 
   @test_util.run_deprecated_v1
@@ -294,6 +302,101 @@ class StageTest(test.TestCase):
 
       self.assertTrue(sess.run(size) == 0)
 
+  @test_util.run_deprecated_v1
+  def testBlockedGetsWakeOnPut(self):
+    with ops.Graph().as_default() as G:
+      with ops.device('/cpu:0'):
+        x = array_ops.placeholder(dtypes.int32, name='x')
+        stager = data_flow_ops.StagingArea([dtypes.int32], shapes=[[]])
+        stage = stager.put([x])
+        peek = stager.peek(1)
+        ret = stager.get()
+
+    G.finalize()
+
+    n = 3
+    with self.session(graph=G, config=_blocking_config(n + 2)) as sess:
+      # Block a peek for the second element first, as the getters remove
+      # elements once they are woken.
+      peeked = queue.Queue()
+      peek_thread = threading.Thread(
+          target=lambda: peeked.put(sess.run(peek)))
+      peek_thread.daemon = True
+      peek_thread.start()
+      peek_thread.join(TIMEOUT)
+      self.assertTrue(peek_thread.is_alive())
+
+      # Putting the first element must not wake a peek of the second one.
+      sess.run(stage, feed_dict={x: -1})
+      peek_thread.join(TIMEOUT)
+      self.assertTrue(peek_thread.is_alive())
+      sess.run(stage, feed_dict={x: -2})
+      peek_thread.join(TIMEOUT)
+      self.assertFalse(peek_thread.is_alive())
+      self.assertEqual(peeked.get_nowait(), [-2])
+      sess.run([ret, ret])
+
+      # Then block several getters on the empty staging area.
+      values = queue.Queue()
+      threads = [
+          threading.Thread(target=lambda: values.put(sess.run(ret)))
+          for _ in range(n)
+      ]
+      for t in threads:
+        t.daemon = True
+        t.start()
+      threads[-1].join(TIMEOUT)
+      self.assertTrue(all(t.is_alive() for t in threads))
+
+      # Every put wakes one of them.
+      for i in range(n):
+        sess.run(stage, feed_dict={x: i})
+      for t in threads:
+        t.join(TIMEOUT)
+        self.assertFalse(t.is_alive())
+      self.assertEqual(sorted(values.get_nowait()[0] for _ in range(n)),
+                       list(range(n)))
+
+  @test_util.run_deprecated_v1
+  def testBlockedPutsWakeOnGet(self):
+    with ops.Graph().as_default() as G:
+      with ops.device('/cpu:0'):
+        x = array_ops.placeholder(dtypes.int32, name='x')
+        stager = data_flow_ops.StagingArea([dtypes.int32],
+                                           capacity=1,
+                                           shapes=[[]])
+        stage = stager.put([x])
+        ret = stager.get()
+        size = stager.size()
+
+    G.finalize()
+
+    n = 3
+    with self.session(graph=G, config=_blocking_config(n + 2)) as sess:
+      sess.run(stage, feed_dict={x: 0})
+
+      # Block several inserters on the full staging area.
+      threads = [
+          threading.Thread(
+              target=lambda i=i: sess.run(stage, feed_dict={x: i}))
+          for i in range(1, n + 1)
+      ]
+      for t in threads:
+        t.daemon = True
+        t.start()
+      threads[-1].join(TIMEOUT)
+      self.assertTrue(all(t.is_alive() for t in threads))
+      self.assertEqual(sess.run(size), 1)
+
+      # Every get makes room for one of them.
+      values = [sess.run(ret)[0] for _ in range(n + 1)]
+      for t in threads:
+        t.join(TIMEOUT)
+        self.assertFalse(t.is_alive())
+      self.assertEqual(values[0], 0)
+      self.assertEqual(sorted(values), list(range(n + 1)))
+      self.assertEqual(sess.run(size), 0)
+
 
 if __name__ == '__main__':
   test.main()
@@ -149,6 +149,30 @@ class DecodeCSVOpTest(test.TestCase):
 
     self._test(args, expected_out)
 
+  def testManyRecords(self):
+    records = ['%d,"x""%d",%f' % (i, i, i / 4.0) for i in range(10000)]
+    args = {
+        "records": records,
+        "record_defaults": [[0], [""], [0.0]]
+    }
+
+    expected_out = [
+        list(range(10000)), [b'x"%d' % i for i in range(10000)],
+        [i / 4.0 for i in range(10000)]
+    ]
+
+    self._test(args, expected_out)
+
+  def testManyRecordsReportsFirstError(self):
+    records = ["%d" % i for i in range(10000)]
+    records[7000] = "7000a"
+    records[3000] = "3000a"
+    args = {"records": records, "record_defaults": [[0]]}
+
+    self._test(
+        args,
+        expected_err_re="Field 0 in record 3000 is not a valid int32: 3000a")
+
   def testNA(self):
     args = {
         "records": ["2.0,NA,aa", "NA,5,bb", "3,6,NA"],
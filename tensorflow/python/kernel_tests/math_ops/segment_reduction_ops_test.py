@@ -585,6 +585,30 @@ class UnsortedSegmentTest(SegmentReductionHelper, parameterized.TestCase):
         self.assertAllClose(np_ans, tf_ans)
         self.assertShapeEqual(np_ans, s)
 
+  def testSortedAndSkewedIndices(self):
+    num_segments = 40
+    rng = np.random.RandomState(0)
+    # A heavy segment next to many small ones, in shuffled and sorted order,
+    # with dropped (negative) ids in front of the sorted ones.
+    indices_flat = np.concatenate(
+        [np.full(600, 7), rng.randint(-1, num_segments, size=400)])
+    for indices in (rng.permutation(indices_flat), np.sort(indices_flat)):
+      shape = indices.shape + (33,)
+      tf_x, np_x = self._input(shape, dtype=dtypes_lib.float32)
+      with self.cached_session(use_gpu=False):
+        for np_op1, np_op2, tf_op, init_op in self.ops_list:
+          np_ans = self._segmentReduce(
+              np.where(indices < 0, num_segments, indices),
+              np_x,
+              np_op1,
+              np_op2,
+              num_segments=num_segments + 1,
+              initial_value=init_op(dtypes_lib.float32),
+              empty_value=init_op(dtypes_lib.float32),
+          )[:num_segments]
+          s = tf_op(tf_x, segment_ids=indices, num_segments=num_segments)
+          self.assertAllClose(np_ans, self.evaluate(s), rtol=1e-4, atol=1e-4)
+
   @test_util.run_deprecated_v1
   def testAllNegatives(self):
     with self.session(use_gpu=False):
@@ -434,6 +434,25 @@ class TransposeTest(test.TestCase):
     self._testBoth(
         np.arange(0, 1260).reshape([2, 3, 5, 7, 2, 3]).astype(np.int64))
 
+  def testBlocked5D(self):
+    # Dimensions of at least 8 elements, with ragged tiles, take the blocked
+    # CPU path whenever the innermost dimension moves.
+    shape = [2, 9, 3, 17, 33]
+    for dtype in [np.int8, np.float16, np.float32, np.float64, np.complex64,
+                  np.complex128]:
+      x = np.arange(np.prod(shape)).reshape(shape).astype(dtype)
+      if dtype in [np.complex64, np.complex128]:
+        x -= 1j * x
+      with self.cached_session(use_gpu=False):
+        for perm in itertools.permutations(range(5)):
+          for conjugate in [False, True] if x.dtype.kind == "c" else [False]:
+            np_ans = x.transpose(perm)
+            if conjugate:
+              np_ans = np.conj(np_ans)
+            tf_ans = self.evaluate(
+                array_ops.transpose(x, perm, conjugate=conjugate))
+            self.assertAllEqual(np_ans, tf_ans)
+
   def testTranspose2DAuto(self):
     x_np = [[1, 2, 3], [4, 5, 6]]
     for use_gpu in [False, True]:
@@ -2976,6 +2976,50 @@ class DeepConv2DTest(test.TestCase):
     self._RunTestCases([1, 1], "SAME")
 
 
+class FFTConv2DTest(test.TestCase):
+
+  def _CompareFwdConv2D(self, tensor_in_sizes, filter_in_sizes, padding):
+    """Verifies that FFTConv2D and Conv2D produce the same values.
+
+    Args:
+      tensor_in_sizes: Input tensor dimensions in
+        [batch, input_rows, input_cols, input_depth].
+      filter_in_sizes: Filter tensor dimensions in
+        [kernel_rows, kernel_cols, input_depth, output_depth].
+      padding: Padding type.
+    """
+    x1 = np.random.rand(*tensor_in_sizes).astype(np.float32)
+    x2 = np.random.rand(*filter_in_sizes).astype(np.float32)
+
+    with self.cached_session(use_gpu=False):
+      t1 = constant_op.constant(x1, shape=tensor_in_sizes)
+      t2 = constant_op.constant(x2, shape=filter_in_sizes)
+
+      conv = nn_ops.conv2d(t1, t2, strides=[1, 1, 1, 1], padding=padding)
+
+      os.environ["TF_USE_FFT_CONV2D"] = "0"
+      values_expect = self.evaluate([conv])
+
+      os.environ["TF_USE_FFT_CONV2D"] = "1"
+      values_test = self.evaluate([conv])
+
+      os.environ["TF_USE_FFT_CONV2D"] = "0"
+      self.assertAllClose(values_expect, values_test, rtol=1e-4, atol=1e-3)
+
+  def _RunTestCases(self, padding):
+    # Large 2D filters, and long 1D filters as used by Conv1D.
+    input_sizes = [[1, 64, 64, 8], [2, 1, 4000, 4], [3, 1, 2000, 2]]
+    filter_sizes = [[31, 31, 8, 8], [1, 513, 4, 8], [1, 1025, 2, 3]]
+    for input_shape, filter_shape in zip(input_sizes, filter_sizes):
+      self._CompareFwdConv2D(input_shape, filter_shape, padding)
+
+  def testConv2DLargeFilterValid(self):
+    self._RunTestCases("VALID")
+
+  def testConv2DLargeFilterSame(self):
+    self._RunTestCases("SAME")
+
+
 class Conv2DBenchmark(test.Benchmark):
 
   def benchmarkGPUConvStackFirst(self):
@@ -186,6 +186,16 @@ class FFTOpsTest(BaseFFTOpsTest, parameterized.TestCase):
         np.mod(np.arange(np.power(128, dims)), 10).reshape(
             (128,) * dims).astype(np_type), rank, rtol=tol, atol=tol)
 
+  @parameterized.parameters(itertools.product(
+      ((2, 256), (3, 48)), (np.complex64, np.complex128)))
+  def test_large_fft(self, rank_and_size, np_type):
+    # Large enough for the CPU kernel to shard the transforms of each axis.
+    rank, size = rank_and_size
+    tol = 1e-4 if np_type == np.complex64 else 5e-5
+    self._compare(
+        np.mod(np.arange(np.power(size, rank)), 10).reshape(
+            (size,) * rank).astype(np_type), rank, rtol=tol, atol=tol)
+
   # TODO(yangzihao): Disable before we can figure out a way to
   # properly test memory fail for large batch fft.
   # def test_large_batch_memory_fail(self):
@@ -393,6 +403,24 @@ class RFFTOpsTest(BaseFFTOpsTest, parameterized.TestCase):
                                            fft_length)
     self._compare_backward(c2r, rank, fft_length, rtol=tol, atol=tol)
 
+  @parameterized.parameters(itertools.product(
+      ((2, 256), (3, 48)), (np.float32, np.float64)))
+  def test_large_fft(self, rank_and_size, np_rtype):
+    # Large enough for the CPU kernel to shard the transforms of each axis.
+    rank, size = rank_and_size
+    np_ctype = np.complex64 if np_rtype == np.float32 else np.complex128
+    tol = 1e-3 if np_rtype == np.float32 else 1e-5
+    inner_dim = size // 2 + 1
+    r2c = np.mod(np.arange(np.power(size, rank)), 10).reshape((size,) * rank)
+    fft_length = (size,) * rank
+    self._compare_forward(
+        r2c.astype(np_rtype), rank, fft_length, rtol=tol, atol=tol)
+    c2r = np.mod(np.arange(np.power(size, rank - 1) * inner_dim),
+                 10).reshape((size,) * (rank - 1) + (inner_dim,))
+    c2r = self._generate_valid_irfft_input(c2r, np_ctype, r2c, np_rtype, rank,
+                                           fft_length)
+    self._compare_backward(c2r, rank, fft_length, rtol=tol, atol=tol)
+
   @parameterized.parameters(itertools.product(
       VALID_FFT_RANKS, range(3), (5, 6), (np.float32, np.float64)))
   def test_placeholder(self, rank, extra_dims, size, np_rtype):
@@ -227,6 +227,12 @@ class StringSplitOpTest(test.TestCase, parameterized.TestCase):
         self.assertAllEqual(result, expected)
 
 
+# Enough strings, with different numbers of tokens, to be split in parallel.
+_MANY_STRINGS = [
+    b",".join(b"%d" % j for j in range(i % 7)) for i in range(5000)
+]
+
+
 class StringSplitV2OpTest(test_util.TensorFlowTestCase, parameterized.TestCase):
 
   @parameterized.named_parameters([
@@ -268,6 +274,11 @@ class StringSplitV2OpTest(test_util.TensorFlowTestCase, parameterized.TestCase):
        "maxsplit": 1,
        "expected": [[b"1", b"2 3"], [b"4", b"5    6  "]]},
 
+      {"testcase_name": "ManyStrings",
+       "input": _MANY_STRINGS,
+       "sep": b",",
+       "expected": [string.split(b",") for string in _MANY_STRINGS]},
+
       {"testcase_name": "ScalarInput",
        "input": b"1,2,3",
        "sep": b",",
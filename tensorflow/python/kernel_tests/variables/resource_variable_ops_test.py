@@ -377,6 +377,26 @@ class ResourceVariableOpsTest(test_util.TensorFlowTestCase,
         resource_variable_ops.read_variable_op(handle, dtype=dtypes.int32))
     self.assertEqual(read, 2)
 
+  @test_util.run_in_graph_and_eager_modes
+  def testAssignAddKeepsEarlierRead(self):
+    handle = _eager_safe_var_handle_op(dtype=dtypes.float32, shape=[3])
+    create = resource_variable_ops.assign_variable_op(
+        handle, constant_op.constant([1., 2., 3.]))
+    with ops.control_dependencies([create]):
+      first_read = resource_variable_ops.read_variable_op(
+          handle, dtype=dtypes.float32)
+    with ops.control_dependencies([first_read]):
+      # A computed value that the kernel may add the variable into.
+      write = resource_variable_ops.assign_add_variable_op(
+          handle,
+          math_ops.multiply(constant_op.constant([1., 2., 3.]), 10.))
+    with ops.control_dependencies([write]):
+      second_read = resource_variable_ops.read_variable_op(
+          handle, dtype=dtypes.float32)
+    f, s = self.evaluate([first_read, second_read])
+    self.assertAllEqual(f, [1., 2., 3.])
+    self.assertAllEqual(s, [11., 22., 33.])
+
   @test_util.run_in_graph_and_eager_modes
   def testScatterAdd(self):
     handle = _eager_safe_var_handle_op(dtype=dtypes.int32, shape=[1, 1])
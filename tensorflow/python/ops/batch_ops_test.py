@@ -18,6 +18,7 @@ import threading
 import time
 import numpy as np
 
+from tensorflow.core.framework import attr_value_pb2
 from tensorflow.core.protobuf import config_pb2
 from tensorflow.python.eager import context
 from tensorflow.python.framework import constant_op
@@ -395,6 +396,43 @@ class BatchOpsTest(test.TestCase):
       self.assertEqual(thread_results[0], [2])
       self.assertEqual(main_results[0], [3])
 
+  def testBatchFunctionOpWithRaggedBatching(self):
+    """Tests that batch_function packs sequences of different lengths."""
+    if context.executing_eagerly():
+      return
+    with self.cached_session() as sess:
+
+      @function.Defun(dtypes.int32, dtypes.int64)
+      def computation(values, row_splits):
+        # Adds zero if the row splits cover all the packed values.
+        num_values = array_ops.size(values, out_type=dtypes.int64)
+        return values * 2 + math_ops.cast(row_splits[-1] - num_values,
+                                          dtypes.int32)
+
+      inp = array_ops.placeholder(dtype=dtypes.int32, shape=[1, None])
+      with ops.get_default_graph()._attr_scope(
+          {"_enable_ragged_batching": attr_value_pb2.AttrValue(b=True)}):
+        result = gen_batch_ops.batch_function(
+            [inp],
+            num_batch_threads=1,
+            max_batch_size=10,
+            batch_timeout_micros=100000,
+            Tout=[dtypes.int32],
+            f=computation,
+            captured_tensors=computation.captured_inputs)
+      thread_results = []
+
+      def worker():
+        thread_results.extend(
+            sess.run([result], feed_dict={inp: [[1, 2, 3]]}))
+
+      worker_thread = threading.Thread(target=worker)
+      worker_thread.start()
+      main_results = sess.run([result], feed_dict={inp: [[4, 5, 6, 7, 8]]})
+      worker_thread.join()
+      self.assertAllEqual(thread_results[0], [[2, 4, 6]])
+      self.assertAllEqual(main_results[0], [[8, 10, 12, 14, 16]])
+
   def testBatchFunctionOpWithCapturedInput(self):
     """Tests that batch_function op works with captured input."""
     if context.executing_eagerly():
@@ -4521,6 +4521,48 @@ class JpegTest(test_util.TensorFlowTestCase):
         image1_crop, image2 = self.evaluate([image1_crop, image2])
         self.assertAllEqual(image1_crop, image2)
 
+  def testDecodeJpegWithDraftSize(self):
+    base = "tensorflow/core/lib/jpeg/testdata"
+    jpeg0 = io_ops.read_file(os.path.join(base, "jpeg_merge_test1.jpg"))
+
+    # 256x128 decodes at ratio 4 to stay at least 32 pixels wide.
+    image0 = image_ops.decode_jpeg(jpeg0, ratio=4)
+    image1 = image_ops.decode_jpeg(jpeg0, draft_size=32)
+    image0, image1 = self.evaluate([image0, image1])
+    self.assertEqual(image1.shape, (64, 32, 3))
+    self.assertAllEqual(image0, image1)
+
+    # The 150x100 crop window decodes at ratio 2, and is scaled outward to
+    # [3, 2, 75, 51] in the image decoded at that ratio.
+    image0 = image_ops.decode_jpeg(jpeg0, ratio=2, channels=3)[3:78, 2:53]
+    image1 = image_ops.decode_and_crop_jpeg(
+        jpeg0, [6, 5, 150, 100], channels=3, draft_size=40)
+    image0, image1 = self.evaluate([image0, image1])
+    self.assertEqual(image1.shape, (75, 51, 3))
+    self.assertLess(self.averageError(image0, image1), 2)
+
+  def testDecodeCropAndResizeJpeg(self):
+    base = "tensorflow/core/lib/jpeg/testdata"
+    jpeg0 = io_ops.read_file(os.path.join(base, "jpeg_merge_test1.jpg"))
+    crop_window = [6, 5, 150, 100]
+    mean, stddev = [127.5, 120.0, 110.0], [127.5]
+    expected = image_ops.decode_and_crop_jpeg(jpeg0, crop_window, channels=3)
+    expected = (math_ops.cast(expected, dtypes.float32) - mean) / stddev
+
+    # At the size of the crop window the image is decoded at full scale and
+    # only normalized.
+    image = gen_image_ops.decode_crop_and_resize_jpeg(
+        jpeg0, crop_window, [150, 100], channels=3, mean=mean, stddev=stddev)
+    self.assertAllClose(self.evaluate(expected), self.evaluate(image))
+
+    # Smaller sizes are decoded at ratio 2 before resizing.
+    expected = image_ops.resize_images_v2(expected, [30, 20])
+    image = gen_image_ops.decode_crop_and_resize_jpeg(
+        jpeg0, crop_window, [30, 20], channels=3, mean=mean, stddev=stddev)
+    expected, image = self.evaluate([expected, image])
+    self.assertEqual(image.shape, (30, 20, 3))
+    self.assertLess(np.mean(np.abs(expected - image)), 0.02)
+
   def testCropAndDecodeJpegWithInvalidCropWindow(self):
     with self.cached_session() as sess:
       # Encode it, then decode it, then encode it
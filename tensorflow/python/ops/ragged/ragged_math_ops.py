@@ -1018,6 +1018,16 @@ def _matmul_3d_with_batch_dim_folding(a, b, **kwargs):
   Returns:
     A RaggedTensor with `shape=[B, (I), K].
   """
+  output_type = kwargs.get('output_type')
+  if (a.dtype in (dtypes.float32, dtypes.float64) and
+      (output_type is None or output_type == a.dtype)):
+    # Multiply each batch's rows by its matrix in place, rather than repeating
+    # `b` once per row.  For real types the adjoint is the transpose.
+    transpose_b = kwargs.get('transpose_b') or kwargs.get('adjoint_b')
+    flat_result = gen_ragged_math_ops.ragged_batch_mat_mul(
+        a.values, a.row_splits, b, transpose_b=bool(transpose_b))
+    return a.with_values(flat_result)
+
   # reshaped_a.shape = [sum(i_1, i_2, ..., i_B), 1, J]
   reshaped_a = array_ops.expand_dims(a.values, 1)
   # reshaped_b.shape = [sum(i_1, i_2, ..., i_B), J, K]
@@ -1028,6 +1038,19 @@ def _matmul_3d_with_batch_dim_folding(a, b, **kwargs):
   return a.with_values(array_ops.squeeze(flat_result, axis=1))
 
 
+@ops.RegisterGradient('RaggedBatchMatMul')
+def _ragged_batch_mat_mul_grad(op, grad):
+  """Gradients for RaggedBatchMatMul."""
+  values, splits, b = op.inputs
+  transpose_b = op.get_attr('transpose_b')
+  d_values = gen_ragged_math_ops.ragged_batch_mat_mul(
+      grad, splits, b, transpose_b=not transpose_b)
+  d_b = gen_ragged_math_ops.ragged_batch_mat_mul_grad(
+      values, splits, grad, transpose_b=transpose_b)
+  # d_values, d_splits, d_b.
+  return [d_values, None, d_b]
+
+
 #===============================================================================
 # ragged.softmax
 #===============================================================================
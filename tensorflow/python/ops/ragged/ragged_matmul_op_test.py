@@ -16,6 +16,7 @@
 
 from absl.testing import parameterized
 
+from tensorflow.python.eager import backprop
 from tensorflow.python.eager import context
 from tensorflow.python.eager import def_function
 from tensorflow.python.framework import constant_op
@@ -260,6 +261,29 @@ class RaggedMatmulOpTest(test_util.TensorFlowTestCase, parameterized.TestCase):
     with self.assertRaisesRegex(exc, message):
       self.evaluate(ragged_math_ops.matmul(a, b, **kwargs))
 
+  @parameterized.parameters([False, True])
+  def testMatmulFloatWithBatchDimFolding(self, transpose_b):
+    splits = [0, 2, 2, 5]
+    values = math_ops.cast(T([5, 3]), dtypes.float32)
+    b = math_ops.cast(T([3, 4, 3] if transpose_b else [3, 3, 4]),
+                      dtypes.float32)
+    with backprop.GradientTape(persistent=True) as tape:
+      tape.watch([values, b])
+      a = ragged_tensor.RaggedTensor.from_row_splits(values, splits)
+      result = ragged_math_ops.matmul(a, b, transpose_b=transpose_b)
+      loss = math_ops.reduce_sum(math_ops.square(result.values))
+      expected = array_ops.concat([
+          math_ops.matmul(
+              values[splits[i]:splits[i + 1]], b[i], transpose_b=transpose_b)
+          for i in range(3)
+      ], axis=0)
+      expected_loss = math_ops.reduce_sum(math_ops.square(expected))
+    self.assertAllClose(result.values, expected)
+    self.assertAllEqual(result.row_splits, splits)
+    self.assertAllClose(
+        tape.gradient(loss, [values, b]),
+        tape.gradient(expected_loss, [values, b]))
+
   def testUnknownRank(self):
     no_rank_spec = ragged_tensor.RaggedTensorSpec(None, dtypes.int32, 1)
     rank_only_spec = ragged_tensor.RaggedTensorSpec([None, None], dtypes.int32,
@@ -0,0 +1,110 @@
+# Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Compares two runs of a C++ benchmark binary.
+
+Both inputs are the output of a benchmark binary run with
+--benchmark_format=json (or --benchmark_out=<file>), e.g. of
+//tensorflow/core/kernels:kernel_roofline_benchmark_test built from two
+different revisions. For every benchmark present in both runs this prints the
+ratio of the new to the old time and the old and new values of the roofline
+counters. The exit status is 1 if any benchmark got slower by more than
+--regression_threshold.
+"""
+
+import json
+
+from absl import app
+from absl import flags
+
+FLAGS = flags.FLAGS
+
+flags.DEFINE_string("old", None, "JSON output of the baseline run.")
+flags.DEFINE_string("new", None, "JSON output of the run to compare.")
+flags.DEFINE_float(
+    "regression_threshold", 0.05,
+    "Relative slowdown above which a benchmark is reported as a regression.")
+flags.DEFINE_list(
+    "counters", ["FLOP/s", "bytes/s", "roofline_frac"],
+    "Counters to print next to the times.")
+
+_TIME_UNIT_SECONDS = {"ns": 1e-9, "us": 1e-6, "ms": 1e-3, "s": 1.0}
+
+
+def _load(path):
+  """Returns the iteration entries of a benchmark JSON file, keyed by name."""
+  with open(path) as f:
+    results = json.load(f)
+  benchmarks = {}
+  for entry in results.get("benchmarks", []):
+    # Skip the mean/median/stddev rows added by --benchmark_repetitions.
+    if entry.get("run_type", "iteration") != "iteration":
+      continue
+    benchmarks[entry["name"]] = entry
+  return benchmarks
+
+
+def _seconds(entry):
+  return entry["real_time"] * _TIME_UNIT_SECONDS[entry.get("time_unit", "ns")]
+
+
+def _format_counter(value):
+  if value is None:
+    return "-"
+  if abs(value) >= 1e3:
+    return "%.3g" % value
+  return "%.3f" % value
+
+
+def main(unused_args):
+  old = _load(FLAGS.old)
+  new = _load(FLAGS.new)
+  names = [name for name in old if name in new]
+  if not names:
+    print("No benchmarks in common.")
+    return 1
+
+  header = ["benchmark", "old_time_s", "new_time_s", "new/old"]
+  for counter in FLAGS.counters:
+    header += ["old_" + counter, "new_" + counter]
+  print("\t".join(header))
+
+  regressions = []
+  for name in names:
+    old_seconds = _seconds(old[name])
+    new_seconds = _seconds(new[name])
+    ratio = new_seconds / old_seconds if old_seconds > 0 else float("inf")
+    row = [name, "%.4g" % old_seconds, "%.4g" % new_seconds, "%.3f" % ratio]
+    for counter in FLAGS.counters:
+      row.append(_format_counter(old[name].get(counter)))
+      row.append(_format_counter(new[name].get(counter)))
+    print("\t".join(row))
+    if ratio > 1 + FLAGS.regression_threshold:
+      regressions.append((name, ratio))
+
+  for name in sorted(set(old) ^ set(new)):
+    print("Only in %s: %s" % ("old" if name in old else "new", name))
+
+  if regressions:
+    print("\n%d regression(s) above %.1f%%:" %
+          (len(regressions), 100 * FLAGS.regression_threshold))
+    for name, ratio in regressions:
+      print("  %s: %.3fx" % (name, ratio))
+    return 1
+  return 0
+
+
+if __name__ == "__main__":
+  flags.mark_flags_as_required(["old", "new"])
+  app.run(main)
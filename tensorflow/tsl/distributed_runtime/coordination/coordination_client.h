@@ -34,6 +34,8 @@ using tensorflow::GetKeyValueDirRequest;
 using tensorflow::GetKeyValueDirResponse;
 using tensorflow::GetKeyValueRequest;
 using tensorflow::GetKeyValueResponse;
+using tensorflow::GetKeyValuesRequest;
+using tensorflow::GetKeyValuesResponse;
 using tensorflow::GetTaskStateRequest;
 using tensorflow::GetTaskStateResponse;
 using tensorflow::HeartbeatRequest;
@@ -54,6 +56,8 @@ using tensorflow::TryGetKeyValueRequest;
 using tensorflow::TryGetKeyValueResponse;
 using tensorflow::WaitForAllTasksRequest;
 using tensorflow::WaitForAllTasksResponse;
+using tensorflow::WatchKeyValueDirRequest;
+using tensorflow::WatchKeyValueDirResponse;
 
 // Base class of client interface for communicating with coordination service.
 // Can be implemented by a variety of transports such as gRPC.
@@ -114,6 +118,16 @@ class CoordinationClient {
                                    GetKeyValueDirResponse* response,
                                    StatusCallback done) = 0;
 
+  virtual void GetKeyValuesAsync(CallOptions* call_opts,
+                                 const GetKeyValuesRequest* request,
+                                 GetKeyValuesResponse* response,
+                                 StatusCallback done) = 0;
+
+  virtual void WatchKeyValueDirAsync(CallOptions* call_opts,
+                                     const WatchKeyValueDirRequest* request,
+                                     WatchKeyValueDirResponse* response,
+                                     StatusCallback done) = 0;
+
   virtual void DeleteKeyValueAsync(const DeleteKeyValueRequest* request,
                                    DeleteKeyValueResponse* response,
                                    StatusCallback done) = 0;
@@ -123,11 +123,22 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
   StatusOr<std::string> TryGetKeyValue(const std::string& key) override;
   std::vector<KeyValueEntry> GetKeyValueDir(
       absl::string_view directory_key) override;
+  void GetKeyValuesAsync(const std::vector<std::string>& keys,
+                         StatusOrValuesCallback done) override;
+  void WatchKeyValueDirAsync(absl::string_view directory_key,
+                             int64_t since_revision,
+                             KeyValueDirUpdateCallback done) override;
   Status DeleteKeyValue(const std::string& key) override;
   void BarrierAsync(const std::string& barrier_id, absl::Duration timeout,
                     const CoordinatedTask& task,
                     const std::vector<CoordinatedTask>& participating_tasks,
                     StatusCallback done) override;
+  void GroupBarrierAsync(
+      const std::string& barrier_id, absl::Duration timeout,
+      const CoordinatedTask& task,
+      const std::vector<CoordinatedTask>& arriving_tasks,
+      const std::vector<CoordinatedTask>& participating_tasks,
+      StatusCallback done) override;
   Status CancelBarrier(const std::string& barrier_id,
                        const CoordinatedTask& task) override;
 
@@ -174,6 +185,16 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
                                 CoordinatedTaskEqual>& tasks_at_barrier,
       int64_t cluster_size);
   bool isRecoverableJob(const absl::string_view task_name) const;
+  // Returns the key-values in the directory `dir` (ending with a slash) that
+  // were inserted after `since_revision`.
+  std::vector<KeyValueEntry> GetKeyValuesInDir(const std::string& dir,
+                                               int64_t since_revision)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(kv_mu_);
+  // Returns the normalized key `norm_key` and the key-values under it that
+  // were inserted after `since_revision`.
+  std::vector<KeyValueEntry> GetWatchedKeyValues(const std::string& norm_key,
+                                                 int64_t since_revision)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(kv_mu_);
 
   class TaskState {
    public:
@@ -245,11 +266,26 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
       TF_GUARDED_BY(state_mu_);
   DeviceInfo cluster_devices_ TF_GUARDED_BY(state_mu_);
 
+  struct KeyValueRecord {
+    std::string value;
+    // Revision of the store at the insertion of the key-value.
+    int64_t revision;
+  };
+  struct DirWatch {
+    int64_t since_revision;
+    KeyValueDirUpdateCallback done;
+  };
+
   mutex kv_mu_;
   // Ordered map to store config key-values
-  std::map<std::string, std::string> kv_store_ TF_GUARDED_BY(kv_mu_);
+  std::map<std::string, KeyValueRecord> kv_store_ TF_GUARDED_BY(kv_mu_);
+  // Incremented by every insertion.
+  int64_t kv_revision_ TF_GUARDED_BY(kv_mu_) = 0;
   absl::flat_hash_map<std::string, std::vector<StatusOrValueCallback>> get_cb_
       TF_GUARDED_BY(kv_mu_);
+  // Pending watches, keyed by the watched key or directory.
+  absl::flat_hash_map<std::string, std::vector<DirWatch>> dir_watches_
+      TF_GUARDED_BY(kv_mu_);
 
   mutex check_staleness_thread_shutdown_mu_;
   condition_variable check_staleness_thread_cv_;
@@ -469,6 +505,16 @@ void CoordinationServiceStandaloneImpl::Stop(bool shut_staleness_thread) {
       }
     }
     get_cb_.clear();
+    for (const auto& [dir, watches] : dir_watches_) {
+      for (const auto& watch : watches) {
+        watch.done(errors::Cancelled(absl::StrCat(
+                       "Coordination service is shutting down. Cancelling "
+                       "WatchKeyValueDir() for directory: ",
+                       dir)),
+                   kv_revision_);
+      }
+    }
+    dir_watches_.clear();
   }
   {
     mutex_lock l(state_mu_);
@@ -851,18 +897,47 @@ Status CoordinationServiceStandaloneImpl::InsertKeyValue(
     const std::string& key, const std::string& value) {
   VLOG(3) << "InsertKeyValue(): " << key << ": " << value;
   const std::string& norm_key = NormalizeKey(key);
-  mutex_lock l(kv_mu_);
-  if (kv_store_.find(norm_key) != kv_store_.end()) {
-    return MakeCoordinationError(
-        errors::AlreadyExists("Config key ", key, " already exists."));
-  }
-  kv_store_.emplace(norm_key, value);
-  auto iter = get_cb_.find(norm_key);
-  if (iter != get_cb_.end()) {
-    for (const auto& cb : iter->second) {
-      cb(value);
+  // Callbacks are invoked after releasing the lock, so that requests waiting
+  // for the key do not serialize all other key-value operations.
+  std::vector<StatusOrValueCallback> get_callbacks;
+  std::vector<std::function<void()>> watch_callbacks;
+  {
+    mutex_lock l(kv_mu_);
+    if (kv_store_.find(norm_key) != kv_store_.end()) {
+      return MakeCoordinationError(
+          errors::AlreadyExists("Config key ", key, " already exists."));
+    }
+    kv_store_.emplace(norm_key, KeyValueRecord{value, ++kv_revision_});
+    auto iter = get_cb_.find(norm_key);
+    if (iter != get_cb_.end()) {
+      get_callbacks = std::move(iter->second);
+      get_cb_.erase(iter);
+    }
+    // Notify the watches of the key and of every directory containing it.
+    if (!dir_watches_.empty()) {
+      size_t pos = norm_key.find('/');
+      while (true) {
+        const std::string watched_key = norm_key.substr(0, pos);
+        auto watch_iter = dir_watches_.find(watched_key);
+        if (watch_iter != dir_watches_.end()) {
+          for (auto& watch : watch_iter->second) {
+            watch_callbacks.push_back(
+                [done = std::move(watch.done),
+                 kvs = GetWatchedKeyValues(watched_key, watch.since_revision),
+                 revision = kv_revision_]() { done(kvs, revision); });
+          }
+          dir_watches_.erase(watch_iter);
+        }
+        if (pos == std::string::npos) break;
+        pos = norm_key.find('/', pos + 1);
+      }
     }
-    get_cb_.erase(iter);
+  }
+  for (const auto& cb : get_callbacks) {
+    cb(value);
+  }
+  for (const auto& cb : watch_callbacks) {
+    cb();
   }
   return OkStatus();
 }
@@ -874,7 +949,7 @@ void CoordinationServiceStandaloneImpl::GetKeyValueAsync(
   mutex_lock l(kv_mu_);
   const auto& iter = kv_store_.find(norm_key);
   if (iter != kv_store_.end()) {
-    done(iter->second);
+    done(iter->second.value);
     return;
   }
   auto cb_iter = get_cb_.find(norm_key);
@@ -894,7 +969,7 @@ StatusOr<std::string> CoordinationServiceStandaloneImpl::TryGetKeyValue(
   if (iter == kv_store_.end()) {
     return errors::NotFound("Config key ", key, " not found.");
   }
-  return iter->second;
+  return iter->second.value;
 }
 
 std::vector<KeyValueEntry> CoordinationServiceStandaloneImpl::GetKeyValueDir(
@@ -905,9 +980,15 @@ std::vector<KeyValueEntry> CoordinationServiceStandaloneImpl::GetKeyValueDir(
   const std::string dir = absl::StrCat(norm_key, "/");
 
   mutex_lock l(kv_mu_);
+  return GetKeyValuesInDir(dir, /*since_revision=*/0);
+}
+
+std::vector<KeyValueEntry> CoordinationServiceStandaloneImpl::GetKeyValuesInDir(
+    const std::string& dir, int64_t since_revision) {
+  std::vector<KeyValueEntry> kvs_in_directory;
   // Find first key in ordered map that has the directory prefix.
   auto begin = kv_store_.lower_bound(dir);
-  std::map<std::string, std::string>::iterator it;
+  std::map<std::string, KeyValueRecord>::iterator it;
   // Iterate through key range that match directory prefix.
   for (it = begin; it != kv_store_.end(); ++it) {
     // Stop once the next key does not have the directory prefix. Since keys are
@@ -916,15 +997,111 @@ std::vector<KeyValueEntry> CoordinationServiceStandaloneImpl::GetKeyValueDir(
         dir.end()) {
       break;
     }
+    if (it->second.revision <= since_revision) continue;
     KeyValueEntry kv;
     kv.set_key(it->first);
-    kv.set_value(it->second);
+    kv.set_value(it->second.value);
     kvs_in_directory.push_back(kv);
   }
-
   return kvs_in_directory;
 }
 
+std::vector<KeyValueEntry>
+CoordinationServiceStandaloneImpl::GetWatchedKeyValues(
+    const std::string& norm_key, int64_t since_revision) {
+  std::vector<KeyValueEntry> kvs;
+  auto iter = kv_store_.find(norm_key);
+  if (iter != kv_store_.end() && iter->second.revision > since_revision) {
+    KeyValueEntry kv;
+    kv.set_key(iter->first);
+    kv.set_value(iter->second.value);
+    kvs.push_back(kv);
+  }
+  std::vector<KeyValueEntry> kvs_in_directory =
+      GetKeyValuesInDir(absl::StrCat(norm_key, "/"), since_revision);
+  kvs.insert(kvs.end(), std::make_move_iterator(kvs_in_directory.begin()),
+             std::make_move_iterator(kvs_in_directory.end()));
+  return kvs;
+}
+
+void CoordinationServiceStandaloneImpl::GetKeyValuesAsync(
+    const std::vector<std::string>& keys, StatusOrValuesCallback done) {
+  VLOG(3) << "GetKeyValues(): " << keys.size() << " keys";
+  struct MultiGetState {
+    mutex mu;
+    std::vector<std::string> values TF_GUARDED_BY(mu);
+    size_t num_pending TF_GUARDED_BY(mu) = 0;
+    bool done_called TF_GUARDED_BY(mu) = false;
+    StatusOrValuesCallback done;
+  };
+  auto state = std::make_shared<MultiGetState>();
+  state->done = std::move(done);
+  {
+    // Lock order: kv_mu_ before state->mu, as in the callbacks invoked by
+    // Stop().
+    mutex_lock l(kv_mu_);
+    mutex_lock state_lock(state->mu);
+    state->values.resize(keys.size());
+    // Released below, once all of the keys have been looked up.
+    state->num_pending = 1;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      const std::string norm_key = NormalizeKey(keys[i]);
+      const auto& iter = kv_store_.find(norm_key);
+      if (iter != kv_store_.end()) {
+        state->values[i] = iter->second.value;
+        continue;
+      }
+      ++state->num_pending;
+      get_cb_[norm_key].push_back(
+          [state, i](const StatusOr<std::string>& status_or_value) {
+            StatusOr<std::vector<std::string>> result;
+            {
+              mutex_lock l(state->mu);
+              if (state->done_called) return;
+              if (status_or_value.ok()) {
+                state->values[i] = status_or_value.value();
+                if (--state->num_pending > 0) return;
+                result = std::move(state->values);
+              } else {
+                result = status_or_value.status();
+              }
+              state->done_called = true;
+            }
+            state->done(result);
+          });
+    }
+  }
+  StatusOr<std::vector<std::string>> result;
+  {
+    mutex_lock l(state->mu);
+    if (state->done_called || --state->num_pending > 0) return;
+    state->done_called = true;
+    result = std::move(state->values);
+  }
+  state->done(result);
+}
+
+void CoordinationServiceStandaloneImpl::WatchKeyValueDirAsync(
+    absl::string_view directory_key, int64_t since_revision,
+    KeyValueDirUpdateCallback done) {
+  VLOG(3) << "WatchKeyValueDir(): " << directory_key << " since revision "
+          << since_revision;
+  const std::string norm_key = NormalizeKey(directory_key);
+  std::vector<KeyValueEntry> kvs;
+  int64_t revision;
+  {
+    mutex_lock l(kv_mu_);
+    kvs = GetWatchedKeyValues(norm_key, since_revision);
+    revision = kv_revision_;
+    if (kvs.empty()) {
+      dir_watches_[norm_key].push_back(
+          DirWatch{since_revision, std::move(done)});
+      return;
+    }
+  }
+  done(kvs, revision);
+}
+
 Status CoordinationServiceStandaloneImpl::DeleteKeyValue(
     const std::string& key) {
   VLOG(3) << "DeleteKeyValue(): " << key;
@@ -933,7 +1110,7 @@ Status CoordinationServiceStandaloneImpl::DeleteKeyValue(
   // Delete directory: find key range that match directory prefix
   const std::string& dir = strings::StrCat(norm_key, "/");
   auto begin = kv_store_.lower_bound(dir);
-  std::map<std::string, std::string>::iterator end;
+  std::map<std::string, KeyValueRecord>::iterator end;
   for (end = begin; end != kv_store_.end(); end++) {
     if (std::mismatch(dir.begin(), dir.end(), end->first.begin()).first !=
         dir.end())
@@ -967,8 +1144,18 @@ void CoordinationServiceStandaloneImpl::BarrierAsync(
     const CoordinatedTask& task,
     const std::vector<CoordinatedTask>& participating_tasks,
     StatusCallback done) {
+  GroupBarrierAsync(barrier_id, timeout, task, /*arriving_tasks=*/{task},
+                    participating_tasks, std::move(done));
+}
+
+void CoordinationServiceStandaloneImpl::GroupBarrierAsync(
+    const std::string& barrier_id, absl::Duration timeout,
+    const CoordinatedTask& task,
+    const std::vector<CoordinatedTask>& arriving_tasks,
+    const std::vector<CoordinatedTask>& participating_tasks,
+    StatusCallback done) {
   VLOG(3) << "Task " << GetTaskName(task) << "invoked BarrierAsync("
-          << barrier_id << ").";
+          << barrier_id << ") for " << arriving_tasks.size() << " tasks.";
   mutex_lock l(state_mu_);
   auto pair = barriers_.try_emplace(barrier_id);
   auto it = pair.first;
@@ -1056,14 +1243,16 @@ void CoordinationServiceStandaloneImpl::BarrierAsync(
   // Add pending callbacks.
   barrier->done_callbacks.push_back(done);
 
-  // Check if caller task is participating in the barrier.
-  if (!barrier->tasks_at_barrier.contains(task)) {
-    // Unexpected barrier call from a task not participating in the barrier.
-    Status error = MakeCoordinationError(errors::InvalidArgument(
-        absl::StrCat("A non-participating task (", GetTaskName(task),
-                     ") called the barrier: ", barrier_id)));
-    PassBarrier(barrier_id, error, barrier);
-    return;
+  // Check if the arriving tasks are participating in the barrier.
+  for (const auto& arriving_task : arriving_tasks) {
+    if (!barrier->tasks_at_barrier.contains(arriving_task)) {
+      // Unexpected barrier call from a task not participating in the barrier.
+      Status error = MakeCoordinationError(errors::InvalidArgument(
+          absl::StrCat("A non-participating task (", GetTaskName(arriving_task),
+                       ") called the barrier: ", barrier_id)));
+      PassBarrier(barrier_id, error, barrier);
+      return;
+    }
   }
 
   // Check if task args are specified consistently across barrier calls.
@@ -1075,17 +1264,19 @@ void CoordinationServiceStandaloneImpl::BarrierAsync(
     return;
   }
 
-  // Remove pending task.
-  // We need to check if task made a repeated call after reaching the barrier.
-  if (!barrier->tasks_at_barrier[task]) {
-    barrier->tasks_at_barrier[task] = true;
-    --barrier->num_pending_tasks;
-
-    if (barrier->num_pending_tasks == 0) {
-      PassBarrier(barrier_id, OkStatus(), barrier);
-      return;
+  // Remove pending tasks.
+  // We need to check if a task made a repeated call after reaching the barrier.
+  for (const auto& arriving_task : arriving_tasks) {
+    bool& at_barrier = barrier->tasks_at_barrier[arriving_task];
+    if (!at_barrier) {
+      at_barrier = true;
+      --barrier->num_pending_tasks;
     }
   }
+  if (barrier->num_pending_tasks == 0) {
+    PassBarrier(barrier_id, OkStatus(), barrier);
+    return;
+  }
 }
 
 Status CoordinationServiceStandaloneImpl::CancelBarrier(
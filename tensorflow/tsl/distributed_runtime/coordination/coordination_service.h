@@ -71,6 +71,13 @@ class CoordinationServiceInterface {
 
   using StatusOrValueCallback =
       std::function<void(const StatusOr<std::string>&)>;
+  using StatusOrValuesCallback =
+      std::function<void(const StatusOr<std::vector<std::string>>&)>;
+  // Invoked with the key-values inserted into a directory after a revision,
+  // and the latest revision of the key-value store.
+  using KeyValueDirUpdateCallback = std::function<void(
+      const StatusOr<std::vector<tensorflow::KeyValueEntry>>&,
+      int64_t revision)>;
 
   virtual ~CoordinationServiceInterface() = default;
 
@@ -178,6 +185,23 @@ class CoordinationServiceInterface {
   virtual std::vector<tensorflow::KeyValueEntry> GetKeyValueDir(
       absl::string_view directory_key) = 0;
 
+  // Get multiple configuration key-values from the coordination service. The
+  // `done` callback is invoked once, with the values in the order of `keys`,
+  // when all of the key-values are available.
+  virtual void GetKeyValuesAsync(const std::vector<std::string>& keys,
+                                 StatusOrValuesCallback done) = 0;
+
+  // Watches a key or directory of the key-value store. Every insertion is
+  // assigned an increasing revision, and `done` is invoked with the key-value
+  // of `directory_key` and the key-values under it that were inserted after
+  // `since_revision`, as soon as there is at least one. The revision passed to
+  // `done` should be used as `since_revision` of the next call; a
+  // `since_revision` of 0 returns all the key-values currently in the
+  // directory.
+  virtual void WatchKeyValueDirAsync(absl::string_view directory_key,
+                                     int64_t since_revision,
+                                     KeyValueDirUpdateCallback done) = 0;
+
   // Delete configuration key-value. If key is a directory, recursively clean
   // up all key-values under the directory.
   virtual Status DeleteKeyValue(const std::string& key) = 0;
@@ -217,6 +241,21 @@ class CoordinationServiceInterface {
       const std::vector<tensorflow::CoordinatedTask>& participating_tasks,
       StatusCallback done) = 0;
 
+  // Same as BarrierAsync(), but all of `arriving_tasks` arrive at the barrier
+  // with this call of `task`. A task that has already synchronized with a
+  // group of tasks can use this to arrive on behalf of the whole group, so that
+  // a barrier for many tasks only receives one call per group.
+  //
+  // Additional possible service errors:
+  //   - InvalidArgument: one of `arriving_tasks` is not participating in the
+  //       barrier.
+  virtual void GroupBarrierAsync(
+      const std::string& barrier_id, absl::Duration timeout,
+      const tensorflow::CoordinatedTask& task,
+      const std::vector<tensorflow::CoordinatedTask>& arriving_tasks,
+      const std::vector<tensorflow::CoordinatedTask>& participating_tasks,
+      StatusCallback done) = 0;
+
   // Aborts the barrier if it is ongoing.
   // Current and future WaitAtBarrier() calls with the same id will return a
   // CANCELLED error status.
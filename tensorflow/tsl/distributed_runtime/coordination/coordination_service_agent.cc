@@ -25,6 +25,8 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
@@ -101,6 +103,8 @@ class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
       const std::string& key) override;
   void GetKeyValueDirAsync(const std::string& key,
                            StatusOrValueDirCallback done) override;
+  StatusOr<std::vector<std::string>> GetKeyValues(
+      const std::vector<std::string>& keys) override;
   Status InsertKeyValue(const std::string& key,
                         const std::string& value) override;
   Status DeleteKeyValue(const std::string& key) override;
@@ -115,6 +119,10 @@ class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
   void WaitAtBarrierAsync(const std::string& barrier_id, absl::Duration timeout,
                           const std::vector<CoordinatedTask>& tasks,
                           StatusCallback done) override;
+  Status WaitAtHierarchicalBarrier(const std::string& barrier_id,
+                                   absl::Duration timeout,
+                                   const std::vector<CoordinatedTask>& tasks,
+                                   int group_size) override;
   Status CancelBarrier(const std::string& barrier_id) override;
   void CancelBarrierAsync(const std::string& barrier_id,
                           StatusCallback done) override;
@@ -131,6 +139,25 @@ class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
   void StopHeartbeat();
 
  private:
+  struct KeyWatch {
+    mutex mu;
+    bool stopped TF_GUARDED_BY(mu) = false;
+    // Revision of the key-value store observed by the last watch response.
+    int64_t revision TF_GUARDED_BY(mu) = 0;
+    // Options of the ongoing watch request.
+    std::shared_ptr<CallOptions> call_opts TF_GUARDED_BY(mu);
+    ChangedKeyValuesCallback on_change;
+  };
+  // Sends the next watch request for `key`. The request is sent again after
+  // every response, until the watch is stopped or the request fails.
+  void WatchKeyAsync(const std::string& key, std::shared_ptr<KeyWatch> watch);
+  // Sends a barrier request at which `arriving_tasks` arrive, or only this
+  // task if it is empty.
+  void SendBarrierRequestAsync(
+      const std::string& barrier_id, absl::Duration timeout,
+      const std::vector<CoordinatedTask>& tasks,
+      const std::vector<CoordinatedTask>& arriving_tasks, StatusCallback done);
+
   Env* env_ = nullptr;  // Not owned.
   const uint64_t incarnation_id_ = random::New64();
   CoordinatedTask task_;
@@ -158,6 +185,10 @@ class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
   CancellationManager cancellation_manager_;
   std::unique_ptr<CoordinationClient> leader_client_;
 
+  mutex watch_mu_;
+  absl::flat_hash_map<std::string, std::shared_ptr<KeyWatch>> watches_
+      TF_GUARDED_BY(watch_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(CoordinationServiceAgentImpl);
 };
 
@@ -674,6 +705,43 @@ void CoordinationServiceAgentImpl::GetKeyValueDirAsync(
       });
 }
 
+StatusOr<std::vector<std::string>> CoordinationServiceAgentImpl::GetKeyValues(
+    const std::vector<std::string>& keys) {
+  GetKeyValuesRequest request;
+  *request.mutable_keys() = {keys.begin(), keys.end()};
+  VLOG(3) << "GetKeyValuesRequest: " << request.DebugString();
+  GetKeyValuesResponse response;
+  auto call_opts = std::make_shared<CallOptions>();
+
+  const CancellationToken token =
+      cancellation_manager_.get_cancellation_token();
+  const bool already_cancelled = !cancellation_manager_.RegisterCallback(
+      token, [call_opts]() { call_opts->StartCancel(); });
+  if (already_cancelled) {
+    return errors::Cancelled("GetKeyValues() was cancelled.");
+  }
+  Status status;
+  absl::Notification n;
+  leader_client_->GetKeyValuesAsync(call_opts.get(), &request, &response,
+                                    [&](const Status& s) {
+                                      cancellation_manager_
+                                          .TryDeregisterCallback(token);
+                                      status = s;
+                                      n.Notify();
+                                    });
+  n.WaitForNotification();
+  VLOG(3) << "GetKeyValuesResponse: " << status;
+  if (!status.ok()) {
+    return status;
+  }
+  std::vector<std::string> values;
+  values.reserve(response.kv_size());
+  for (auto& kv : *response.mutable_kv()) {
+    values.push_back(std::move(*kv.mutable_value()));
+  }
+  return values;
+}
+
 Status CoordinationServiceAgentImpl::InsertKeyValue(const std::string& key,
                                                     const std::string& value) {
   InsertKeyValueRequest request;
@@ -720,13 +788,87 @@ Status CoordinationServiceAgentImpl::UpdateKeyValue(const std::string& key,
 Status CoordinationServiceAgentImpl::StartWatchKey(
     const std::string& key,
     CoordinationServiceAgentImpl::ChangedKeyValuesCallback on_change) {
-  return MakeCoordinationError(errors::Unimplemented(
-      "CoordinationServiceAgent::StartWatchKey is not implemented."));
+  auto watch = std::make_shared<KeyWatch>();
+  watch->on_change = std::move(on_change);
+  {
+    mutex_lock l(watch_mu_);
+    if (!watches_.try_emplace(key, watch).second) {
+      return errors::AlreadyExists("Key ", key, " is already being watched.");
+    }
+  }
+  WatchKeyAsync(key, std::move(watch));
+  return OkStatus();
 }
 
 Status CoordinationServiceAgentImpl::StopWatchKey(const std::string& key) {
-  return MakeCoordinationError(errors::Unimplemented(
-      "CoordinationServiceAgent::StopWatchKey is not implemented."));
+  std::shared_ptr<KeyWatch> watch;
+  {
+    mutex_lock l(watch_mu_);
+    auto it = watches_.find(key);
+    if (it == watches_.end()) {
+      return errors::NotFound("Key ", key, " is not being watched.");
+    }
+    watch = std::move(it->second);
+    watches_.erase(it);
+  }
+  mutex_lock l(watch->mu);
+  watch->stopped = true;
+  if (watch->call_opts != nullptr) watch->call_opts->StartCancel();
+  return OkStatus();
+}
+
+void CoordinationServiceAgentImpl::WatchKeyAsync(
+    const std::string& key, std::shared_ptr<KeyWatch> watch) {
+  auto request = std::make_shared<WatchKeyValueDirRequest>();
+  auto response = std::make_shared<WatchKeyValueDirResponse>();
+  auto call_opts = std::make_shared<CallOptions>();
+  request->set_directory_key(key);
+  {
+    mutex_lock l(watch->mu);
+    if (watch->stopped) return;
+    request->set_since_revision(watch->revision);
+    watch->call_opts = call_opts;
+  }
+  const CancellationToken token =
+      cancellation_manager_.get_cancellation_token();
+  const bool already_cancelled = !cancellation_manager_.RegisterCallback(
+      token, [call_opts]() { call_opts->StartCancel(); });
+  if (already_cancelled) {
+    return;
+  }
+  VLOG(3) << "WatchKeyValueDirRequest: " << request->DebugString();
+  leader_client_->WatchKeyValueDirAsync(
+      call_opts.get(), request.get(), response.get(),
+      [this, key, watch, call_opts, request, response,
+       token](const Status& s) {
+        cancellation_manager_.TryDeregisterCallback(token);
+        {
+          mutex_lock l(watch->mu);
+          if (watch->stopped) return;
+          if (s.ok()) {
+            watch->revision = response->revision();
+          } else {
+            watch->stopped = true;
+          }
+        }
+        if (!s.ok()) {
+          LOG(WARNING) << "Stopped watching key " << key << ": " << s;
+          mutex_lock l(watch_mu_);
+          auto it = watches_.find(key);
+          if (it != watches_.end() && it->second == watch) watches_.erase(it);
+          return;
+        }
+        VLOG(3) << "WatchKeyValueDirResponse: " << response->DebugString();
+        std::map<std::string, std::string> kvs;
+        for (const auto& kv : response->kv()) {
+          kvs.emplace(kv.key(), kv.value());
+        }
+        Status status = ActivateWatch(key, kvs);
+        if (!status.ok()) {
+          VLOG(3) << "Watch of key " << key << " was not activated: " << status;
+        }
+        WatchKeyAsync(key, watch);
+      });
 }
 
 void CoordinationServiceAgentImpl::SetError(const Status& error) {
@@ -742,8 +884,17 @@ void CoordinationServiceAgentImpl::SetError(const Status& error) {
 
 Status CoordinationServiceAgentImpl::ActivateWatch(
     const std::string& key, const std::map<std::string, std::string>& kvs) {
-  return MakeCoordinationError(errors::Unimplemented(
-      "CoordinationServiceAgent::ActivateWatch is not implemented."));
+  std::shared_ptr<KeyWatch> watch;
+  {
+    mutex_lock l(watch_mu_);
+    auto it = watches_.find(key);
+    if (it == watches_.end()) {
+      return errors::NotFound("Key ", key, " is not being watched.");
+    }
+    watch = it->second;
+  }
+  watch->on_change(kvs);
+  return OkStatus();
 }
 
 Status CoordinationServiceAgentImpl::WaitAtBarrier(
@@ -779,12 +930,22 @@ void CoordinationServiceAgentImpl::WaitAtBarrierAsync(
       return;
     }
   }
+  SendBarrierRequestAsync(barrier_id, timeout, tasks, /*arriving_tasks=*/{},
+                          std::move(done));
+}
+
+void CoordinationServiceAgentImpl::SendBarrierRequestAsync(
+    const std::string& barrier_id, absl::Duration timeout,
+    const std::vector<CoordinatedTask>& tasks,
+    const std::vector<CoordinatedTask>& arriving_tasks, StatusCallback done) {
   auto request = std::make_shared<BarrierRequest>();
   auto response = std::make_shared<BarrierResponse>();
   request->set_barrier_id(barrier_id);
   request->set_barrier_timeout_in_ms(timeout / absl::Milliseconds(1));
   *request->mutable_source_task() = task_;
   *request->mutable_tasks() = {tasks.begin(), tasks.end()};
+  *request->mutable_arriving_tasks() = {arriving_tasks.begin(),
+                                        arriving_tasks.end()};
   VLOG(3) << "WaitAtBarrierRequest: " << request->DebugString();
   leader_client_->BarrierAsync(
       request.get(), response.get(),
@@ -794,6 +955,71 @@ void CoordinationServiceAgentImpl::WaitAtBarrierAsync(
       });
 }
 
+Status CoordinationServiceAgentImpl::WaitAtHierarchicalBarrier(
+    const std::string& barrier_id, absl::Duration timeout,
+    const std::vector<CoordinatedTask>& tasks, int group_size) {
+  if (group_size <= 0) {
+    return MakeCoordinationError(errors::InvalidArgument(
+        "WaitAtHierarchicalBarrier() requires a positive group size, got ",
+        group_size));
+  }
+  auto it = absl::c_find_if(tasks, [this](const CoordinatedTask& task) {
+    return task.job_name() == task_.job_name() &&
+           task.task_id() == task_.task_id();
+  });
+  if (it == tasks.end()) {
+    return MakeCoordinationError(errors::InvalidArgument(
+        "WaitAtHierarchicalBarrier() must be called with a list of tasks "
+        "including the calling task. Barrier id: ",
+        barrier_id));
+  }
+  const absl::Time deadline = absl::Now() + timeout;
+  auto remaining = [deadline]() {
+    return std::max(deadline - absl::Now(), absl::ZeroDuration());
+  };
+  const int64_t index = it - tasks.begin();
+  const int64_t group = index / group_size;
+  const int64_t group_begin = group * group_size;
+  const int64_t group_end =
+      std::min<int64_t>(group_begin + group_size, tasks.size());
+  const std::vector<CoordinatedTask> group_tasks(tasks.begin() + group_begin,
+                                                 tasks.begin() + group_end);
+  const std::string group_barrier_id =
+      absl::StrCat(barrier_id, "::group_", group);
+  // Passed by the group after its first task arrived at the barrier.
+  const std::string group_done_barrier_id =
+      absl::StrCat(group_barrier_id, "::done");
+
+  TF_RETURN_IF_ERROR(WaitAtBarrier(group_barrier_id, remaining(), group_tasks));
+  if (index != group_begin) {
+    return WaitAtBarrier(group_done_barrier_id, remaining(), group_tasks);
+  }
+
+  {
+    mutex_lock l(state_mu_);
+    if (!used_barrier_ids_.insert(barrier_id).second) {
+      return errors::FailedPrecondition(
+          "WaitAtBarrier() should not be called with the same id more than "
+          "once. Barrier id: ",
+          barrier_id);
+    }
+  }
+  Status status;
+  absl::Notification n;
+  SendBarrierRequestAsync(barrier_id, remaining(), tasks, group_tasks,
+                          [&](const Status& s) {
+                            status = s;
+                            n.Notify();
+                          });
+  n.WaitForNotification();
+  if (!status.ok()) {
+    // Fail the other tasks of the group with a Cancelled error.
+    CancelBarrier(group_done_barrier_id).IgnoreError();
+    return status;
+  }
+  return WaitAtBarrier(group_done_barrier_id, remaining(), group_tasks);
+}
+
 Status CoordinationServiceAgentImpl::CancelBarrier(
     const std::string& barrier_id) {
   Status status;
@@ -190,6 +190,12 @@ class CoordinationServiceAgent {
   virtual void GetKeyValueDirAsync(const std::string& key,
                                    StatusOrValueDirCallback done) = 0;
 
+  // Get multiple config key-values from the service with one request. This is
+  // a blocking call that waits until all of the keys are inserted, and returns
+  // the values in the order of `keys`.
+  virtual StatusOr<std::vector<std::string>> GetKeyValues(
+      const std::vector<std::string>& keys) = 0;
+
   // Insert config key-value to the service.
   //   - errors::AlreadyExists: key is already set.
   virtual Status InsertKeyValue(const std::string& key,
@@ -204,6 +210,10 @@ class CoordinationServiceAgent {
 
   // Register a callback that will be invoked when the key or keys under the key
   // directory are changed (inserted, deleted, or updated).
+  // Currently only insertions are reported: `on_change` is invoked with the
+  // key-values inserted since its previous invocation (or, for the first one,
+  // with all existing key-values), from a long-polling request to the service.
+  //   - errors::AlreadyExists: the key is already being watched.
   virtual Status StartWatchKey(const std::string& key,
                                ChangedKeyValuesCallback on_change) = 0;
   virtual Status StopWatchKey(const std::string& key) = 0;
@@ -249,6 +259,25 @@ class CoordinationServiceAgent {
       const std::vector<tensorflow::CoordinatedTask>& tasks,
       StatusCallback done) = 0;
 
+  // Same as WaitAtBarrier(), for barriers among a large number of `tasks`.
+  // `tasks` is split into consecutive groups of `group_size` tasks, that first
+  // wait at a barrier of their own. The first task of each group then arrives
+  // at the barrier on behalf of its whole group, so that the service receives
+  // one call per group carrying the full list of `tasks`. All of the calls
+  // share the `timeout`.
+  //
+  // All participating tasks must call this with the same `tasks` in the same
+  // order, and the same `group_size`. If the barrier fails, the first task of
+  // each group receives the error of the barrier and the other tasks of the
+  // group receive a Cancelled error.
+  // Additional possible errors:
+  //   - InvalidArgument: `tasks` is empty or does not include this task, or
+  //       `group_size` is not positive.
+  virtual Status WaitAtHierarchicalBarrier(
+      const std::string& barrier_id, absl::Duration timeout,
+      const std::vector<tensorflow::CoordinatedTask>& tasks,
+      int group_size) = 0;
+
   // Aborts the barrier if it is ongoing.
   // Current and future WaitAtBarrier() calls with the same id will return a
   // CANCELLED error status.
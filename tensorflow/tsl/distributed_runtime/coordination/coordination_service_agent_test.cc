@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/tsl/distributed_runtime/coordination/coordination_service_agent.h"
 
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
@@ -41,7 +42,9 @@ using tensorflow::KeyValueEntry;
 
 using ::testing::_;
 using ::testing::DoAll;
+using ::testing::ElementsAre;
 using ::testing::InvokeArgument;
+using ::testing::Pair;
 using ::testing::SetArgPointee;
 using ::testing::UnorderedPointwise;
 using ::testing::WithArgs;
@@ -73,6 +76,12 @@ class TestCoordinationClient : public CoordinationClient {
   MOCK_METHOD3(GetKeyValueDirAsync,
                void(const GetKeyValueDirRequest*, GetKeyValueDirResponse*,
                     StatusCallback));
+  MOCK_METHOD4(GetKeyValuesAsync,
+               void(CallOptions* call_opts, const GetKeyValuesRequest*,
+                    GetKeyValuesResponse*, StatusCallback));
+  MOCK_METHOD4(WatchKeyValueDirAsync,
+               void(CallOptions* call_opts, const WatchKeyValueDirRequest*,
+                    WatchKeyValueDirResponse*, StatusCallback));
   MOCK_METHOD4(RegisterTaskAsync, void(CallOptions*, const RegisterTaskRequest*,
                                        RegisterTaskResponse*, StatusCallback));
   MOCK_METHOD4(ShutdownTaskAsync, void(CallOptions*, const ShutdownTaskRequest*,
@@ -345,6 +354,97 @@ TEST_F(CoordinationServiceAgentTest, GetKeyValueDir_Simple_Success) {
   EXPECT_THAT(*result, UnorderedPointwise(KvEq(), test_values));
 }
 
+TEST_F(CoordinationServiceAgentTest, GetKeyValues_Simple_Success) {
+  // Mock server response: set key-value pairs and invoke done callback.
+  GetKeyValuesResponse mocked_response;
+  *mocked_response.add_kv() = CreateKv("key_0", "value_0");
+  *mocked_response.add_kv() = CreateKv("key_1", "value_1");
+  ON_CALL(*GetClient(), GetKeyValuesAsync(_, _, _, _))
+      .WillByDefault(DoAll(SetArgPointee<2>(mocked_response),
+                           InvokeArgument<3>(OkStatus())));
+  // Initialize coordination agent.
+  InitializeAgent();
+
+  auto result = agent_->GetKeyValues({"key_0", "key_1"});
+
+  TF_ASSERT_OK(result.status());
+  EXPECT_THAT(*result, ElementsAre("value_0", "value_1"));
+}
+
+TEST_F(CoordinationServiceAgentTest, StartWatchKey_InvokesCallbackOnChanges) {
+  WatchKeyValueDirResponse mocked_response;
+  *mocked_response.add_kv() = CreateKv("dir/key", "value");
+  mocked_response.set_revision(7);
+  int64_t second_since_revision = -1;
+  StatusCallback owned_done;
+  EXPECT_CALL(*GetClient(), WatchKeyValueDirAsync(_, _, _, _))
+      .WillOnce(DoAll(SetArgPointee<2>(mocked_response),
+                      InvokeArgument<3>(OkStatus())))
+      .WillOnce(WithArgs<1, 3>(
+          [&](const WatchKeyValueDirRequest* request, StatusCallback done) {
+            second_since_revision = request->since_revision();
+            owned_done = done;
+          }));
+  InitializeAgent();
+  std::map<std::string, std::string> changes;
+
+  TF_ASSERT_OK(agent_->StartWatchKey(
+      "dir", [&](const std::map<std::string, std::string>& kvs) {
+        changes = kvs;
+      }));
+
+  EXPECT_THAT(changes, ElementsAre(Pair("dir/key", "value")));
+  // The next watch request continues from the returned revision.
+  EXPECT_EQ(second_since_revision, 7);
+  EXPECT_TRUE(errors::IsAlreadyExists(agent_->StartWatchKey(
+      "dir", [](const std::map<std::string, std::string>&) {})));
+  TF_ASSERT_OK(agent_->StopWatchKey("dir"));
+  EXPECT_TRUE(errors::IsNotFound(agent_->StopWatchKey("dir")));
+  owned_done(errors::Cancelled("cancelled"));
+}
+
+TEST_F(CoordinationServiceAgentTest,
+       WaitAtHierarchicalBarrier_GroupLeaderArrivesForGroup) {
+  std::vector<BarrierRequest> requests;
+  ON_CALL(*GetClient(), BarrierAsync(_, _, _))
+      .WillByDefault(WithArgs<0, 2>(
+          [&](const BarrierRequest* request, StatusCallback done) {
+            requests.push_back(*request);
+            done(OkStatus());
+          }));
+  InitializeAgent();
+  std::vector<CoordinatedTask> tasks(3);
+  for (int i = 0; i < 3; ++i) {
+    tasks[i].set_job_name("test_job");
+    tasks[i].set_task_id(i);
+  }
+
+  TF_ASSERT_OK(agent_->WaitAtHierarchicalBarrier(
+      "barrier", absl::Seconds(10), tasks, /*group_size=*/2));
+
+  // Group barrier, barrier for all tasks, and barrier releasing the group.
+  ASSERT_EQ(requests.size(), 3);
+  EXPECT_EQ(requests[0].barrier_id(), "barrier::group_0");
+  EXPECT_EQ(requests[0].tasks_size(), 2);
+  EXPECT_EQ(requests[1].barrier_id(), "barrier");
+  EXPECT_EQ(requests[1].tasks_size(), 3);
+  EXPECT_EQ(requests[1].arriving_tasks_size(), 2);
+  EXPECT_EQ(requests[2].barrier_id(), "barrier::group_0::done");
+}
+
+TEST_F(CoordinationServiceAgentTest,
+       WaitAtHierarchicalBarrier_TaskNotInList_Fails) {
+  InitializeAgent();
+  CoordinatedTask other_task;
+  other_task.set_job_name("test_job");
+  other_task.set_task_id(1);
+
+  Status s = agent_->WaitAtHierarchicalBarrier("barrier", absl::Seconds(10),
+                                               {other_task}, /*group_size=*/2);
+
+  EXPECT_TRUE(errors::IsInvalidArgument(s));
+}
+
 TEST_F(CoordinationServiceAgentTest, ShutdownInErrorShouldReturnError) {
   // Connect coordination agent and set it to error.
   InitializeAgent();
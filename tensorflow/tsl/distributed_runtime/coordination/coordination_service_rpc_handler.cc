@@ -252,6 +252,54 @@ void CoordinationServiceRpcHandler::GetKeyValueDirAsync(
   done(OkStatus());
 }
 
+void CoordinationServiceRpcHandler::GetKeyValuesAsync(
+    const GetKeyValuesRequest* request, GetKeyValuesResponse* response,
+    StatusCallback done) {
+  tf_shared_lock l(mu_);
+  if (service_ == nullptr) {
+    done(MakeCoordinationError(
+        errors::Internal("Coordination service is not enabled.")));
+    return;
+  }
+  std::vector<std::string> keys = {request->keys().begin(),
+                                   request->keys().end()};
+  service_->GetKeyValuesAsync(
+      keys, [request, response, done = std::move(done)](
+                const StatusOr<std::vector<std::string>>& status_or_values) {
+        if (status_or_values.ok()) {
+          for (int i = 0; i < request->keys_size(); ++i) {
+            KeyValueEntry* kv = response->add_kv();
+            kv->set_key(request->keys(i));
+            kv->set_value(status_or_values.value()[i]);
+          }
+        }
+        done(status_or_values.status());
+      });
+}
+
+void CoordinationServiceRpcHandler::WatchKeyValueDirAsync(
+    const WatchKeyValueDirRequest* request, WatchKeyValueDirResponse* response,
+    StatusCallback done) {
+  tf_shared_lock l(mu_);
+  if (service_ == nullptr) {
+    done(MakeCoordinationError(
+        errors::Internal("Coordination service is not enabled.")));
+    return;
+  }
+  service_->WatchKeyValueDirAsync(
+      request->directory_key(), request->since_revision(),
+      [response, done = std::move(done)](
+          const StatusOr<std::vector<KeyValueEntry>>& status_or_kvs,
+          int64_t revision) {
+        if (status_or_kvs.ok()) {
+          *response->mutable_kv() = {status_or_kvs.value().begin(),
+                                     status_or_kvs.value().end()};
+          response->set_revision(revision);
+        }
+        done(status_or_kvs.status());
+      });
+}
+
 void CoordinationServiceRpcHandler::DeleteKeyValueAsync(
     const DeleteKeyValueRequest* request, DeleteKeyValueResponse* response,
     StatusCallback done) {
@@ -275,10 +323,20 @@ void CoordinationServiceRpcHandler::BarrierAsync(const BarrierRequest* request,
   }
   std::vector<CoordinatedTask> tasks = {request->tasks().begin(),
                                         request->tasks().end()};
-  service_->BarrierAsync(
+  if (request->arriving_tasks().empty()) {
+    service_->BarrierAsync(
+        request->barrier_id(),
+        absl::Milliseconds(request->barrier_timeout_in_ms()),
+        request->source_task(), tasks,
+        [done = std::move(done)](const Status& status) { done(status); });
+    return;
+  }
+  std::vector<CoordinatedTask> arriving_tasks = {
+      request->arriving_tasks().begin(), request->arriving_tasks().end()};
+  service_->GroupBarrierAsync(
       request->barrier_id(),
       absl::Milliseconds(request->barrier_timeout_in_ms()),
-      request->source_task(), tasks,
+      request->source_task(), arriving_tasks, tasks,
       [done = std::move(done)](const Status& status) { done(status); });
 }
 
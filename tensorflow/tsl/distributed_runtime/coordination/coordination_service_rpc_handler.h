@@ -80,6 +80,14 @@ class CoordinationServiceRpcHandler {
                            tensorflow::GetKeyValueDirResponse* response,
                            StatusCallback done);
 
+  void GetKeyValuesAsync(const tensorflow::GetKeyValuesRequest* request,
+                         tensorflow::GetKeyValuesResponse* response,
+                         StatusCallback done);
+
+  void WatchKeyValueDirAsync(
+      const tensorflow::WatchKeyValueDirRequest* request,
+      tensorflow::WatchKeyValueDirResponse* response, StatusCallback done);
+
   void DeleteKeyValueAsync(const tensorflow::DeleteKeyValueRequest* request,
                            tensorflow::DeleteKeyValueResponse* response,
                            StatusCallback done);
@@ -41,6 +41,7 @@ limitations under the License.
 
 namespace tsl {
 namespace {
+using ::testing::ElementsAre;
 using ::testing::EqualsProto;
 using ::testing::IsEmpty;
 using ::testing::UnorderedElementsAre;
@@ -125,6 +126,8 @@ class TestCoordinationClient : public CoordinationClient {
   }
 
   UNIMPLEMENTED_WITH_CALL_OPTS(GetKeyValue);
+  UNIMPLEMENTED_WITH_CALL_OPTS(GetKeyValues);
+  UNIMPLEMENTED_WITH_CALL_OPTS(WatchKeyValueDir);
   UNIMPLEMENTED_WITH_CALL_OPTS(Heartbeat);
   UNIMPLEMENTED_WITH_CALL_OPTS(ShutdownTask);
 #undef UNIMPLEMENTED_WITH_CALL_OPTS
@@ -631,6 +634,112 @@ TEST_F(CoordinateTwoTasksTest,
   EXPECT_THAT(result, IsEmpty());
 }
 
+TEST_F(CoordinateTwoTasksTest, GetKeyValues_WaitsForAllKeys) {
+  EnableCoordinationService();
+  TF_ASSERT_OK(coord_service_->InsertKeyValue("key0", "value0"));
+
+  absl::Notification n;
+  StatusOr<std::vector<std::string>> result;
+  coord_service_->GetKeyValuesAsync(
+      {"key1", "/key0", "key2"},
+      [&](const StatusOr<std::vector<std::string>>& status_or_values) {
+        result = status_or_values;
+        n.Notify();
+      });
+  TF_ASSERT_OK(coord_service_->InsertKeyValue("key2", "value2"));
+  EXPECT_FALSE(n.HasBeenNotified());
+  TF_ASSERT_OK(coord_service_->InsertKeyValue("key1", "value1"));
+
+  n.WaitForNotification();
+  TF_ASSERT_OK(result.status());
+  EXPECT_THAT(result.value(), ElementsAre("value1", "value0", "value2"));
+}
+
+TEST_F(CoordinateTwoTasksTest, GetKeyValues_CancelledAtShutdown) {
+  EnableCoordinationService();
+  auto n = std::make_shared<absl::Notification>();
+  auto result = std::make_shared<Status>();
+  coord_service_->GetKeyValuesAsync(
+      {"key0", "key1"},
+      [n, result](const StatusOr<std::vector<std::string>>& status_or_values) {
+        *result = status_or_values.status();
+        n->Notify();
+      });
+
+  coord_service_.reset();
+
+  ASSERT_TRUE(n->HasBeenNotified());
+  EXPECT_TRUE(errors::IsCancelled(*result)) << *result;
+}
+
+TEST_F(CoordinateTwoTasksTest, WatchKeyValueDir_ReturnsExistingKeyValues) {
+  EnableCoordinationService();
+  KeyValueEntry kv = CreateKv("dir/path", "value0");
+  TF_ASSERT_OK(coord_service_->InsertKeyValue(kv.key(), kv.value()));
+  TF_ASSERT_OK(coord_service_->InsertKeyValue("other_dir/path", "value1"));
+
+  std::vector<KeyValueEntry> result;
+  int64_t revision = 0;
+  coord_service_->WatchKeyValueDirAsync(
+      "dir", /*since_revision=*/0,
+      [&](const StatusOr<std::vector<KeyValueEntry>>& status_or_kvs,
+          int64_t r) {
+        TF_ASSERT_OK(status_or_kvs.status());
+        result = status_or_kvs.value();
+        revision = r;
+      });
+
+  EXPECT_THAT(result, UnorderedElementsAre(EqualsProto(kv)));
+  EXPECT_EQ(revision, 2);
+}
+
+TEST_F(CoordinateTwoTasksTest, WatchKeyValueDir_WaitsForNewKeyValues) {
+  EnableCoordinationService();
+  TF_ASSERT_OK(coord_service_->InsertKeyValue("dir/path0", "value0"));
+  KeyValueEntry kv = CreateKv("dir/sub_dir/path1", "value1");
+
+  absl::Notification n;
+  std::vector<KeyValueEntry> result;
+  int64_t revision = 0;
+  coord_service_->WatchKeyValueDirAsync(
+      "dir", /*since_revision=*/1,
+      [&](const StatusOr<std::vector<KeyValueEntry>>& status_or_kvs,
+          int64_t r) {
+        TF_ASSERT_OK(status_or_kvs.status());
+        result = status_or_kvs.value();
+        revision = r;
+        n.Notify();
+      });
+  // Insertions outside of the directory do not trigger the watch.
+  TF_ASSERT_OK(coord_service_->InsertKeyValue("dir_key", "value"));
+  EXPECT_FALSE(n.HasBeenNotified());
+  TF_ASSERT_OK(coord_service_->InsertKeyValue(kv.key(), kv.value()));
+
+  ASSERT_TRUE(n.HasBeenNotified());
+  EXPECT_THAT(result, UnorderedElementsAre(EqualsProto(kv)));
+  EXPECT_EQ(revision, 3);
+}
+
+TEST_F(CoordinateTwoTasksTest, WatchKeyValueDir_WatchesSingleKey) {
+  EnableCoordinationService();
+  KeyValueEntry kv = CreateKv("key", "value");
+
+  absl::Notification n;
+  std::vector<KeyValueEntry> result;
+  coord_service_->WatchKeyValueDirAsync(
+      "key", /*since_revision=*/0,
+      [&](const StatusOr<std::vector<KeyValueEntry>>& status_or_kvs,
+          int64_t r) {
+        TF_ASSERT_OK(status_or_kvs.status());
+        result = status_or_kvs.value();
+        n.Notify();
+      });
+  TF_ASSERT_OK(coord_service_->InsertKeyValue(kv.key(), kv.value()));
+
+  ASSERT_TRUE(n.HasBeenNotified());
+  EXPECT_THAT(result, UnorderedElementsAre(EqualsProto(kv)));
+}
+
 }  // namespace
 
 // Verify that coordination service can gather each task's device info and
@@ -897,6 +1006,55 @@ TEST_F(CoordinationBarrierTest, BarrierWithSubsetOfTasks) {
   TF_EXPECT_OK(barrier_status_1);
 }
 
+TEST_F(CoordinationBarrierTest, GroupBarrier) {
+  const std::string barrier_id = "barrier_id";
+  absl::Duration timeout = absl::Seconds(5);
+  Status barrier_status_0;
+  Status barrier_status_2;
+  absl::Notification n_0;
+  absl::Notification n_2;
+
+  // Task 0 arrives on behalf of tasks 0 and 1.
+  GetCoordinationService()->GroupBarrierAsync(
+      barrier_id, timeout, GetTask(0),
+      /*arriving_tasks=*/{GetTask(0), GetTask(1)},
+      /*participating_tasks=*/{}, [&barrier_status_0, &n_0](Status s) {
+        barrier_status_0 = s;
+        n_0.Notify();
+      });
+  EXPECT_FALSE(n_0.HasBeenNotified());
+  GetCoordinationService()->GroupBarrierAsync(
+      barrier_id, timeout, GetTask(2), /*arriving_tasks=*/{GetTask(2)},
+      /*participating_tasks=*/{}, [&barrier_status_2, &n_2](Status s) {
+        barrier_status_2 = s;
+        n_2.Notify();
+      });
+
+  EXPECT_TRUE(n_0.HasBeenNotified());
+  EXPECT_TRUE(n_2.HasBeenNotified());
+  TF_EXPECT_OK(barrier_status_0);
+  TF_EXPECT_OK(barrier_status_2);
+}
+
+TEST_F(CoordinationBarrierTest, GroupBarrierWithNonParticipatingTask) {
+  const std::string barrier_id = "barrier_id";
+  absl::Duration timeout = absl::Seconds(5);
+  Status barrier_status;
+  absl::Notification n;
+
+  GetCoordinationService()->GroupBarrierAsync(
+      barrier_id, timeout, GetTask(0),
+      /*arriving_tasks=*/{GetTask(0), GetTask(2)},
+      /*participating_tasks=*/{GetTask(0), GetTask(1)},
+      [&barrier_status, &n](Status s) {
+        barrier_status = s;
+        n.Notify();
+      });
+
+  EXPECT_TRUE(n.HasBeenNotified());
+  EXPECT_TRUE(errors::IsInvalidArgument(barrier_status));
+}
+
 TEST_F(CoordinationBarrierTest, BarrierWithMismatchedTasks) {
   const std::string barrier_id = "barrier_id";
   absl::Duration timeout = absl::Seconds(5);
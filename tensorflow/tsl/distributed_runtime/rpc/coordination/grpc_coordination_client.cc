@@ -45,6 +45,8 @@ using tensorflow::GetKeyValueDirRequest;
 using tensorflow::GetKeyValueDirResponse;
 using tensorflow::GetKeyValueRequest;
 using tensorflow::GetKeyValueResponse;
+using tensorflow::GetKeyValuesRequest;
+using tensorflow::GetKeyValuesResponse;
 using tensorflow::GetTaskStateRequest;
 using tensorflow::GetTaskStateResponse;
 using tensorflow::HeartbeatRequest;
@@ -234,6 +236,28 @@ class GrpcCoordinationClient : public CoordinationClient {
         &target_);
   }
 
+  void GetKeyValuesAsync(CallOptions* call_opts,
+                         const GetKeyValuesRequest* request,
+                         GetKeyValuesResponse* response,
+                         StatusCallback done) override {
+    new RPCState<protobuf::Message>(
+        &stub_, cq_, "/tensorflow.CoordinationService/GetKeyValues", *request,
+        response, std::move(done), call_opts,
+        /*threadpool=*/nullptr, /*max_retries=*/0, /*fail_fast=*/true,
+        &target_);
+  }
+
+  void WatchKeyValueDirAsync(CallOptions* call_opts,
+                             const WatchKeyValueDirRequest* request,
+                             WatchKeyValueDirResponse* response,
+                             StatusCallback done) override {
+    new RPCState<protobuf::Message>(
+        &stub_, cq_, "/tensorflow.CoordinationService/WatchKeyValueDir",
+        *request, response, std::move(done), call_opts,
+        /*threadpool=*/nullptr, /*max_retries=*/0, /*fail_fast=*/true,
+        &target_);
+  }
+
   void DeleteKeyValueAsync(const DeleteKeyValueRequest* request,
                            DeleteKeyValueResponse* response,
                            StatusCallback done) override {
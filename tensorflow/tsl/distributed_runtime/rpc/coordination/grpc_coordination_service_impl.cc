@@ -54,6 +54,8 @@ void GrpcCoordinationServiceImpl::HandleRPCsLoop() {
   ENQUEUE_REQUEST(GetKeyValue);
   ENQUEUE_REQUEST(TryGetKeyValue);
   ENQUEUE_REQUEST(GetKeyValueDir);
+  ENQUEUE_REQUEST(GetKeyValues);
+  ENQUEUE_REQUEST(WatchKeyValueDir);
   ENQUEUE_REQUEST(DeleteKeyValue);
   ENQUEUE_REQUEST(Barrier);
   ENQUEUE_REQUEST(CancelBarrier);
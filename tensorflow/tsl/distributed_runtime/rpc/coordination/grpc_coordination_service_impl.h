@@ -93,6 +93,8 @@ class GrpcCoordinationServiceImpl : public AsyncServiceInterface {
   HANDLER(GetKeyValue);
   HANDLER(TryGetKeyValue);
   HANDLER(GetKeyValueDir);
+  HANDLER(GetKeyValues);
+  HANDLER(WatchKeyValueDir);
   HANDLER(DeleteKeyValue);
   HANDLER(Barrier);
   HANDLER(CancelBarrier);
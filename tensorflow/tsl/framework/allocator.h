@@ -232,6 +232,18 @@ class Allocator {
   // preallocation.
   virtual void SetStreamAndPreallocateMemory(void* stream) {}
 
+  // For stream-ordered allocators, whose memory belongs to one stream: records
+  // that the memory at `ptr`, which was returned by AllocateRaw() and is not
+  // yet deallocated, is used by work enqueued on another stream. Once `ptr` is
+  // deallocated, its memory is not reused until CompleteStreamUse() is called
+  // with the returned id, which is positive. Returns 0 if the use is not
+  // tracked, in which case the caller must keep the memory allocated until the
+  // work completes.
+  virtual int64_t RecordStreamUse(const void* ptr) { return 0; }
+
+  // Reports that the work of a use recorded by RecordStreamUse() completed.
+  virtual void CompleteStreamUse(int64_t use_id) {}
+
   // Returns the type of the memory allocated by this allocator.
   virtual AllocatorMemoryType GetMemoryType() const {
     return AllocatorMemoryType::kUnknown;
@@ -292,6 +304,14 @@ class AllocatorWrapper : public Allocator {
     return wrapped_->GetMemoryType();
   }
 
+  int64_t RecordStreamUse(const void* ptr) override {
+    return wrapped_->RecordStreamUse(ptr);
+  }
+
+  void CompleteStreamUse(int64_t use_id) override {
+    wrapped_->CompleteStreamUse(use_id);
+  }
+
  private:
   Allocator* const wrapped_;
 };
@@ -17,11 +17,15 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <functional>
 #include <memory>
+#include <thread>  // NOLINT
 #include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "tensorflow/tsl/framework/allocator_retry.h"
+#include "tensorflow/tsl/framework/metrics.h"
 #include "tensorflow/tsl/lib/core/bits.h"
 #include "tensorflow/tsl/platform/file_system.h"
 #include "tensorflow/tsl/platform/logging.h"
@@ -56,6 +60,10 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
   } else {
     curr_region_allocation_bytes_ = RoundedBytes(total_memory);
   }
+  for (int i = 0; i < kNumSizeClasses; ++i) {
+    size_class_region_bytes_[i] =
+        RoundedBytes(std::min(total_memory, size_t{2 << 20}));
+  }
 
   // Initially, we have not allocated any memory from the sub-allocator; our
   // pool of memory is empty.
@@ -84,9 +92,29 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       CHECK_NE(BinForSize(bin_size * 2), BinFromIndex(b));
     }
   }
+
+  if (opts.thread_cache_bytes > 0 && !opts.stream_ordered) {
+    thread_cache_shards_.reset(new ThreadCacheShard[kNumThreadCacheShards]);
+  }
+
+  if (opts.compaction_interval_micros > 0) {
+    compaction_thread_.reset(Env::Default()->StartThread(
+        ThreadOptions(), "bfc_allocator_compaction",
+        [this]() { CompactionLoop(); }));
+  }
 }
 
 BFCAllocator::~BFCAllocator() {
+  if (compaction_thread_ != nullptr) {
+    {
+      mutex_lock l(compaction_mu_);
+      stop_compaction_ = true;
+      compaction_cv_.notify_all();
+    }
+    // Joins the thread.
+    compaction_thread_.reset();
+  }
+
   // Return memory back.
   VLOG(2) << "Number of regions allocated: "
           << region_manager_.regions().size();
@@ -111,7 +139,15 @@ const BFCAllocator::Chunk* BFCAllocator::ChunkFromHandle(ChunkHandle h) const {
   return &(chunks_[h]);
 }
 
-bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
+int BFCAllocator::SizeClassForBytes(size_t rounded_bytes) const {
+  if (!opts_.segregate_size_classes) return 0;
+  if (rounded_bytes < kSmallSizeClassLimit) return 0;
+  if (rounded_bytes < kMediumSizeClassLimit) return 1;
+  return 2;
+}
+
+bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes,
+                          int size_class) {
   size_t available_bytes = memory_limit_ - *stats_.pool_bytes;
   // Rounds available_bytes down to the nearest multiple of kMinAllocationSize.
   available_bytes = (available_bytes / kMinAllocationSize) * kMinAllocationSize;
@@ -122,17 +158,20 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
     return false;
   }
 
-  // If curr_region_allocation_bytes_ is not enough to satisfy the
-  // allocation, keep multiplying by a power of two until that is
-  // sufficient.
+  size_t& region_allocation_bytes = opts_.segregate_size_classes
+                                       ? size_class_region_bytes_[size_class]
+                                       : curr_region_allocation_bytes_;
+
+  // If region_allocation_bytes is not enough to satisfy the allocation, keep
+  // multiplying by a power of two until that is sufficient.
   bool increased_allocation = false;
-  while (rounded_bytes > curr_region_allocation_bytes_) {
-    curr_region_allocation_bytes_ *= 2;
+  while (rounded_bytes > region_allocation_bytes) {
+    region_allocation_bytes *= 2;
     increased_allocation = true;
   }
 
   // Try allocating.
-  size_t bytes = std::min(curr_region_allocation_bytes_, available_bytes);
+  size_t bytes = std::min(region_allocation_bytes, available_bytes);
   size_t bytes_received;
   void* mem_addr = sub_allocator_->Alloc(alignment, bytes, &bytes_received);
   if (mem_addr == nullptr && !started_backpedal_) {
@@ -155,7 +194,7 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
 
   if (!increased_allocation) {
     // Increase the region size of the next required allocation.
-    curr_region_allocation_bytes_ *= 2;
+    region_allocation_bytes *= 2;
   }
 
   VLOG(1) << "Extending allocation by "
@@ -173,10 +212,11 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
 
   AllocationRegion* maybe_extended_region = nullptr;
   if (coalesce_regions_) {
-    maybe_extended_region =
-        region_manager_.AddOrExtendAllocationRegion(mem_addr, bytes_received);
+    maybe_extended_region = region_manager_.AddOrExtendAllocationRegion(
+        mem_addr, bytes_received, size_class);
+    sub_allocations_[mem_addr] = bytes_received;
   } else {
-    region_manager_.AddAllocationRegion(mem_addr, bytes_received);
+    region_manager_.AddAllocationRegion(mem_addr, bytes_received, size_class);
   }
 
   // Create one large chunk for the whole memory space that will
@@ -189,6 +229,7 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
   c->prev = kInvalidChunkHandle;
   c->next = kInvalidChunkHandle;
   c->freed_at_count = 0;
+  c->size_class = size_class;
 
   region_manager_.set_handle(c->ptr, h);
 
@@ -264,6 +305,15 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes;
+  const bool use_thread_cache = UseThreadCache(num_bytes, allocation_attr);
+  if (use_thread_cache) {
+    void* result = AllocateFromThreadCache(num_bytes);
+    if (result != nullptr) {
+      VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " "
+              << result << " from the thread cache";
+      return result;
+    }
+  }
   void* result = [&] {
     if (!opts_.allow_retry_on_failure || !allocation_attr.retry_on_failure) {
       // If we have globally disabled retry-on-failure and fail to allocate an
@@ -310,10 +360,102 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                           allocation_attr);
     }
   }();
+  if (use_thread_cache && result != nullptr) {
+    AddToThreadCache(result, num_bytes);
+  }
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << result;
   return result;
 }
 
+bool BFCAllocator::UseThreadCache(
+    size_t num_bytes, const AllocationAttributes& allocation_attr) const {
+  return thread_cache_shards_ != nullptr && num_bytes > 0 &&
+         num_bytes <= kMaxThreadCachedBytes &&
+         allocation_attr.freed_by_func == nullptr &&
+         timing_counter_ == nullptr;
+}
+
+BFCAllocator::ThreadCacheShard* BFCAllocator::ShardForThread() {
+  const size_t hash = std::hash<std::thread::id>()(std::this_thread::get_id());
+  return &thread_cache_shards_[hash % kNumThreadCacheShards];
+}
+
+BFCAllocator::ThreadCacheShard* BFCAllocator::ShardForPtr(const void* ptr) {
+  const std::uintptr_t p = reinterpret_cast<std::uintptr_t>(ptr);
+  return &thread_cache_shards_[(p >> kMinAllocationBits) %
+                               kNumThreadCacheShards];
+}
+
+void* BFCAllocator::AllocateFromThreadCache(size_t num_bytes) {
+  const size_t rounded_bytes = RoundedBytes(num_bytes);
+  ThreadCacheShard* shard = ShardForThread();
+  mutex_lock l(shard->mu);
+  std::vector<void*>& free_ptrs =
+      shard->free_ptrs[rounded_bytes / kMinAllocationSize - 1];
+  if (free_ptrs.empty()) return nullptr;
+  void* ptr = free_ptrs.back();
+  free_ptrs.pop_back();
+  shard->free_bytes -= rounded_bytes;
+  return ptr;
+}
+
+void BFCAllocator::AddToThreadCache(void* ptr, size_t num_bytes) {
+  ThreadCacheShard* shard = ShardForPtr(ptr);
+  mutex_lock l(shard->mu);
+  shard->rounded_sizes[ptr] = RoundedBytes(num_bytes);
+}
+
+bool BFCAllocator::DeallocateToThreadCache(void* ptr) {
+  ThreadCacheShard* owner = ShardForPtr(ptr);
+  size_t rounded_bytes;
+  {
+    mutex_lock l(owner->mu);
+    auto it = owner->rounded_sizes.find(ptr);
+    if (it == owner->rounded_sizes.end()) return false;
+    rounded_bytes = it->second;
+  }
+  {
+    ThreadCacheShard* shard = ShardForThread();
+    mutex_lock l(shard->mu);
+    if (shard->free_bytes + rounded_bytes <= opts_.thread_cache_bytes) {
+      shard->free_ptrs[rounded_bytes / kMinAllocationSize - 1].push_back(ptr);
+      shard->free_bytes += rounded_bytes;
+      return true;
+    }
+  }
+  // The cache is full: the chunk goes back to the bins.
+  mutex_lock l(owner->mu);
+  owner->rounded_sizes.erase(ptr);
+  return false;
+}
+
+bool BFCAllocator::FlushThreadCaches() {
+  if (thread_cache_shards_ == nullptr) return false;
+  std::vector<void*> ptrs;
+  for (int i = 0; i < kNumThreadCacheShards; ++i) {
+    ThreadCacheShard* shard = &thread_cache_shards_[i];
+    mutex_lock l(shard->mu);
+    for (std::vector<void*>& free_ptrs : shard->free_ptrs) {
+      ptrs.insert(ptrs.end(), free_ptrs.begin(), free_ptrs.end());
+      free_ptrs.clear();
+    }
+    shard->free_bytes = 0;
+  }
+  for (void* ptr : ptrs) {
+    {
+      ThreadCacheShard* owner = ShardForPtr(ptr);
+      mutex_lock l(owner->mu);
+      owner->rounded_sizes.erase(ptr);
+    }
+    FreeChunk(region_manager_.get_handle(ptr));
+  }
+  if (!ptrs.empty()) {
+    VLOG(1) << "Flushed " << ptrs.size() << " chunks of the thread caches of "
+            << Name();
+  }
+  return !ptrs.empty();
+}
+
 // static
 size_t BFCAllocator::RoundedBytes(size_t bytes) {
   size_t rounded_bytes =
@@ -331,26 +473,9 @@ bool BFCAllocator::DeallocateFreeRegions(size_t rounded_bytes)
   }
 
   // Searching for free regions.
-  absl::flat_hash_set<void*> free_region_ptrs;
   size_t total_free_bytes = 0;
-  for (const AllocationRegion& region : region_manager_.regions()) {
-    ChunkHandle h = region_manager_.get_handle(region.ptr());
-    bool any_use = false;
-    while (h != kInvalidChunkHandle) {
-      const Chunk* c = ChunkFromHandle(h);
-      if (c->in_use()) {
-        any_use = true;
-        break;
-      }
-      h = c->next;
-    }
-
-    if (!any_use) {
-      VLOG(2) << "Found free region with ptr = " << region.ptr();
-      free_region_ptrs.insert(region.ptr());
-      total_free_bytes += region.memory_size();
-    }
-  }
+  absl::flat_hash_set<void*> free_region_ptrs =
+      FindFreeRegions(&total_free_bytes);
 
   if (total_free_bytes == 0) {
     return false;
@@ -379,6 +504,30 @@ bool BFCAllocator::DeallocateFreeRegions(size_t rounded_bytes)
   return true;
 }
 
+absl::flat_hash_set<void*> BFCAllocator::FindFreeRegions(
+    size_t* total_free_bytes) {
+  absl::flat_hash_set<void*> free_region_ptrs;
+  for (const AllocationRegion& region : region_manager_.regions()) {
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    bool any_use = false;
+    while (h != kInvalidChunkHandle) {
+      const Chunk* c = ChunkFromHandle(h);
+      if (c->in_use()) {
+        any_use = true;
+        break;
+      }
+      h = c->next;
+    }
+
+    if (!any_use) {
+      VLOG(2) << "Found free region with ptr = " << region.ptr();
+      free_region_ptrs.insert(region.ptr());
+      *total_free_bytes += region.memory_size();
+    }
+  }
+  return free_region_ptrs;
+}
+
 void BFCAllocator::DeallocateRegions(
     const absl::flat_hash_set<void*>& region_ptrs)
     TF_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
@@ -410,6 +559,12 @@ void BFCAllocator::DeallocateRegions(
     // Deallocate the memory.
     sub_allocator_->Free(it->ptr(), it->memory_size());
     *stats_.pool_bytes -= it->memory_size();
+    idle_regions_.erase(it->ptr());
+    for (auto sub_it = sub_allocations_.lower_bound(it->ptr());
+         sub_it != sub_allocations_.end() && sub_it->first < it->end_ptr();) {
+      idle_tail_allocations_.erase(sub_it->first);
+      sub_it = sub_allocations_.erase(sub_it);
+    }
     it = region_manager_.RemoveAllocationRegion(it);
   }
 }
@@ -429,21 +584,24 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
 
   // The BFC allocator tries to find the best fit first.
   BinNum bin_num = BinNumForSize(rounded_bytes);
+  const int size_class = SizeClassForBytes(rounded_bytes);
 
   mutex_lock l(lock_);
   if (!timestamped_chunks_.empty()) {
     // Merge timestamped chunks whose counts have become safe for general use.
     MergeTimestampedChunks(0);
   }
-  void* ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+  void* ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                       size_class);
   if (ptr != nullptr) {
     AddTraceMe("MemoryAllocation", ptr);
     return ptr;
   }
 
   // Try to extend
-  if (Extend(unused_alignment, rounded_bytes)) {
-    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+  if (Extend(unused_alignment, rounded_bytes, size_class)) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                       size_class);
     if (ptr != nullptr) {
       AddTraceMe("MemoryAllocation", ptr);
       return ptr;
@@ -456,7 +614,8 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     // timestamped chunks more aggressively until a free chunk of the necessary
     // size is formed.
     if (MergeTimestampedChunks(rounded_bytes)) {
-      ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+      ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                       size_class);
       if (ptr != nullptr) {
         AddTraceMe("MemoryAllocation", ptr);
         return ptr;
@@ -464,13 +623,25 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  // The free chunks held by the thread caches may satisfy the request once
+  // they are coalesced in the bins.
+  if (FlushThreadCaches()) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                       size_class);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   // Reaching this point means that no chunks can satisfy the request. Also,
   // the unallocated bytes cannot satisfy the request. Before giving up, let's
   // try deallocating free regions so that suballocator can combine them with
   // the unallocated bytes and form a larger region.
   if (DeallocateFreeRegions(rounded_bytes) &&
-      Extend(unused_alignment, rounded_bytes)) {
-    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+      Extend(unused_alignment, rounded_bytes, size_class)) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                       size_class);
     if (ptr != nullptr) {
       AddTraceMe("MemoryAllocation", ptr);
       return ptr;
@@ -556,7 +727,8 @@ void BFCAllocator::AddTraceMe(absl::string_view traceme_name,
 }
 
 void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
-                                 size_t num_bytes, uint64 freed_before) {
+                                 size_t num_bytes, uint64 freed_before,
+                                 int size_class) {
   // First identify the first bin that could satisfy rounded_bytes.
   for (; bin_num < kNumBins; bin_num++) {
     // Start searching from the first bin for the smallest chunk that fits
@@ -570,6 +742,9 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
       if (freed_before > 0 && freed_before < chunk->freed_at_count) {
         continue;
       }
+      if (chunk->size_class != size_class) {
+        continue;
+      }
       if (chunk->size >= rounded_bytes) {
         // We found an existing chunk that fits us that wasn't in use, so remove
         // it from the free bin structure prior to using.
@@ -662,8 +837,9 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
   // The new chunk is not in use.
   new_chunk->allocation_id = -1;
 
-  // It inherits the freed time.
+  // It inherits the freed time and the size class.
   new_chunk->freed_at_count = c->freed_at_count;
+  new_chunk->size_class = c->size_class;
 
   // Maintain the pointers.
   // c <-> c_neighbor becomes
@@ -684,7 +860,10 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(3) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
-  DeallocateRawInternal(ptr);
+  if (ptr == nullptr || thread_cache_shards_ == nullptr ||
+      !DeallocateToThreadCache(ptr)) {
+    DeallocateRawInternal(ptr);
+  }
   retry_helper_.NotifyDealloc();
 }
 
@@ -698,6 +877,15 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
+  if (opts_.stream_ordered && num_stream_uses_.contains(h)) {
+    // Another stream may still access the chunk.
+    deferred_frees_.insert(h);
+    return;
+  }
+  FreeChunk(h);
+}
+
+void BFCAllocator::FreeChunk(ChunkHandle h) {
   // Record chunk information before it's freed.
   Chunk* chunk = ChunkFromHandle(h);
   void* chunk_ptr = chunk->ptr;
@@ -846,6 +1034,40 @@ BFCAllocator::ChunkHandle BFCAllocator::TryToCoalesce(ChunkHandle h,
   return coalesced_chunk;
 }
 
+int64_t BFCAllocator::RecordStreamUse(const void* ptr) {
+  if (!opts_.stream_ordered || ptr == nullptr) return 0;
+  mutex_lock l(lock_);
+  // 'ptr' may not have been returned by this allocator (e.g. if it points into
+  // a slice of a tensor).
+  const ChunkHandle h = region_manager_.find_handle(ptr);
+  if (h == kInvalidChunkHandle) return 0;
+  const Chunk* c = ChunkFromHandle(h);
+  if (!c->in_use() || c->ptr != ptr || deferred_frees_.contains(h)) return 0;
+  const int64_t use_id = next_stream_use_id_++;
+  stream_uses_[use_id] = h;
+  ++num_stream_uses_[h];
+  return use_id;
+}
+
+void BFCAllocator::CompleteStreamUse(int64_t use_id) {
+  {
+    mutex_lock l(lock_);
+    auto use = stream_uses_.find(use_id);
+    if (use == stream_uses_.end()) {
+      LOG(ERROR) << "Unknown stream use " << use_id << " in " << Name();
+      return;
+    }
+    const ChunkHandle h = use->second;
+    stream_uses_.erase(use);
+    auto num_uses = num_stream_uses_.find(h);
+    if (--num_uses->second > 0) return;
+    num_stream_uses_.erase(num_uses);
+    if (deferred_frees_.erase(h) == 0) return;
+    FreeChunk(h);
+  }
+  retry_helper_.NotifyDealloc();
+}
+
 void BFCAllocator::SetSafeFrontier(uint64 count) {
   uint64 current = safe_frontier_.load(std::memory_order_relaxed);
   while (count > current) {
@@ -1207,9 +1429,131 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
+  stats_.largest_free_block_bytes = LargestFreeChunk();
+  UpdateFragmentationMetrics();
   return stats_;
 }
 
+void BFCAllocator::UpdateFragmentationMetrics() {
+  metrics::UpdateBfcAllocatorFragmentation(
+      name_, *stats_.pool_bytes - stats_.bytes_in_use, LargestFreeChunk());
+}
+
+void BFCAllocator::Compact() {
+  mutex_lock l(lock_);
+  if (!timestamped_chunks_.empty()) {
+    MergeTimestampedChunks(0);
+  }
+  // The chunks of a released region must not be referenced by
+  // timestamped_chunks_.
+  if (opts_.segregate_size_classes && opts_.garbage_collection &&
+      timestamped_chunks_.empty()) {
+    size_t total_free_bytes = 0;
+    absl::flat_hash_set<void*> free_regions =
+        FindFreeRegions(&total_free_bytes);
+    absl::flat_hash_set<void*> to_release;
+    for (void* region_ptr : free_regions) {
+      if (idle_regions_.contains(region_ptr)) to_release.insert(region_ptr);
+    }
+    if (!to_release.empty()) {
+      VLOG(1) << "Releasing " << to_release.size() << " idle regions of "
+              << Name();
+      DeallocateRegions(to_release);
+    }
+    for (void* region_ptr : to_release) free_regions.erase(region_ptr);
+    idle_regions_ = std::move(free_regions);
+  }
+  if (coalesce_regions_ && opts_.garbage_collection &&
+      timestamped_chunks_.empty()) {
+    ReleaseIdleTailMemory();
+  }
+  UpdateFragmentationMetrics();
+}
+
+void BFCAllocator::ReleaseIdleTailMemory() {
+  struct TailRelease {
+    void* region_ptr;
+    ChunkHandle tail;
+    std::vector<std::pair<void*, size_t>> allocations;
+  };
+  std::vector<TailRelease> releases;
+  absl::flat_hash_set<void*> tail_allocations;
+  for (const AllocationRegion& region : region_manager_.regions()) {
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    const Chunk* c = ChunkFromHandle(h);
+    while (c->next != kInvalidChunkHandle) {
+      h = c->next;
+      c = ChunkFromHandle(h);
+    }
+    if (c->in_use() || c->bin_num == kInvalidBinNum) continue;
+
+    // The sub-allocations that the free tail chunk covers entirely. The first
+    // one of the region is kept so that the region itself survives.
+    std::vector<std::pair<void*, size_t>> covered;
+    for (auto it = c->ptr == region.ptr()
+                       ? sub_allocations_.upper_bound(c->ptr)
+                       : sub_allocations_.lower_bound(c->ptr);
+         it != sub_allocations_.end() && it->first < region.end_ptr(); ++it) {
+      covered.push_back(*it);
+      tail_allocations.insert(it->first);
+    }
+    // Only a suffix of the region can be given back.
+    size_t first_idle = covered.size();
+    while (first_idle > 0 &&
+           idle_tail_allocations_.contains(covered[first_idle - 1].first)) {
+      --first_idle;
+    }
+    if (first_idle < covered.size()) {
+      releases.push_back({region.ptr(), h,
+                          std::vector<std::pair<void*, size_t>>(
+                              covered.begin() + first_idle, covered.end())});
+    }
+  }
+
+  for (const TailRelease& release : releases) {
+    void* release_ptr = release.allocations.front().first;
+    size_t release_bytes = 0;
+    for (const auto& allocation : release.allocations) {
+      release_bytes += allocation.second;
+    }
+    VLOG(1) << "Releasing " << strings::HumanReadableNumBytes(release_bytes)
+            << " of idle memory at the end of region " << release.region_ptr
+            << " of " << Name();
+
+    RemoveFreeChunkFromBin(release.tail);
+    Chunk* c = ChunkFromHandle(release.tail);
+    if (c->ptr == release_ptr) {
+      ChunkFromHandle(c->prev)->next = kInvalidChunkHandle;
+      DeleteChunk(release.tail);
+    } else {
+      c->size -= release_bytes;
+      InsertFreeChunkIntoBin(release.tail);
+    }
+    region_manager_.ShrinkAllocationRegion(release.region_ptr, release_bytes);
+
+    // Frees from the end, so that a sub-allocator handing out consecutive
+    // addresses can hand out the same ones again.
+    for (auto it = release.allocations.rbegin();
+         it != release.allocations.rend(); ++it) {
+      sub_allocator_->Free(it->first, it->second);
+      *stats_.pool_bytes -= it->second;
+      sub_allocations_.erase(it->first);
+      tail_allocations.erase(it->first);
+    }
+  }
+  idle_tail_allocations_ = std::move(tail_allocations);
+}
+
+void BFCAllocator::CompactionLoop() {
+  mutex_lock l(compaction_mu_);
+  while (!stop_compaction_) {
+    compaction_cv_.wait_for(
+        l, std::chrono::microseconds(opts_.compaction_interval_micros));
+    if (stop_compaction_) break;
+    Compact();
+  }
+}
+
 bool BFCAllocator::ClearStats() {
   mutex_lock l(lock_);
   stats_.num_allocs = 0;
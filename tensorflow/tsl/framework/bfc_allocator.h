@@ -18,15 +18,18 @@ limitations under the License.
 
 #include <array>
 #include <deque>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/tsl/framework/allocator.h"
 #include "tensorflow/tsl/framework/allocator_retry.h"
 #include "tensorflow/tsl/framework/shared_counter.h"
+#include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/macros.h"
 #include "tensorflow/tsl/platform/mutex.h"
 #include "tensorflow/tsl/platform/numbers.h"
@@ -68,7 +71,42 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If true, the allocator tracks the uses of its memory by other streams
+    // than the one that owns it (see Allocator::RecordStreamUse()), and defers
+    // the reuse of a deallocated chunk until its recorded uses complete. The
+    // other chunks are reused immediately, as the work of the owning stream is
+    // ordered.
+    bool stream_ordered = false;
+
+    // If true, small (below kSmallSizeClassLimit), medium (below
+    // kMediumSizeClassLimit) and large allocations are served from separate
+    // regions, so that long-lived small tensors do not pin the free space
+    // between large ones. The regions of each class grow as with allow_growth.
+    bool segregate_size_classes = false;
+
+    // If positive, a background thread calls Compact() at this interval.
+    int64_t compaction_interval_micros = 0;
+
+    // If positive, allocations of at most kMaxThreadCachedBytes are returned
+    // on deallocation to a cache of the deallocating thread instead of the
+    // bins, and a thread reuses the chunks of its cache without taking the
+    // allocator lock. Threads share kNumThreadCacheShards caches of up to
+    // this many bytes each, which are flushed before an allocation fails.
+    //
+    // Cached chunks count as in use in the stats, and RequestedSize() and
+    // AllocationId() of a reused chunk are those of its first allocation.
+    // Ignored with stream_ordered. Allocations with a freed_by_func, or made
+    // once a timing counter is set, bypass the caches.
+    size_t thread_cache_bytes = 0;
   };
+
+  static constexpr size_t kSmallSizeClassLimit = 1 << 20;
+  static constexpr size_t kMediumSizeClassLimit = 64 << 20;
+
+  static constexpr size_t kMaxThreadCachedBytes = 64 << 10;
+  static constexpr int kNumThreadCacheShards = 16;
+
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
 
@@ -103,10 +141,24 @@ class BFCAllocator : public Allocator {
 
   AllocatorMemoryType GetMemoryType() const override;
 
+  int64_t RecordStreamUse(const void* ptr) override;
+
+  void CompleteStreamUse(int64_t use_id) override;
+
   bool ShouldRecordOpName() const { return true; }
 
   MemoryDump RecordMemoryMap();
 
+  // Merges the timestamped chunks that have become safe, and exports the
+  // fragmentation metrics of the allocator. With segregate_size_classes and
+  // garbage_collection, also returns to the sub-allocator the regions that
+  // were entirely free in the previous call and still are. With a coalescing
+  // sub-allocator and garbage_collection, also returns the allocations of the
+  // sub-allocator that the free tail chunk of a region covered in the
+  // previous call and still covers, so that their physical memory is unmapped
+  // while the address range stays reserved for the region to grow back into.
+  void Compact();
+
  private:
   struct Bin;
 
@@ -120,6 +172,33 @@ class BFCAllocator : public Allocator {
 
   void DeallocateRawInternal(void* ptr);
 
+  // Thread caches (see Options::thread_cache_bytes).
+  struct ThreadCacheShard;
+
+  // Returns true if an allocation with these arguments may use the caches.
+  bool UseThreadCache(size_t num_bytes,
+                      const AllocationAttributes& allocation_attr) const;
+
+  // Returns the shard of the calling thread, and the shard that records the
+  // rounded size of the cached allocation 'ptr'.
+  ThreadCacheShard* ShardForThread();
+  ThreadCacheShard* ShardForPtr(const void* ptr);
+
+  // Returns a free chunk of the cache of the calling thread for an
+  // allocation of 'num_bytes' bytes, or nullptr.
+  void* AllocateFromThreadCache(size_t num_bytes);
+
+  // Marks 'ptr', allocated from the bins, as a cached allocation.
+  void AddToThreadCache(void* ptr, size_t num_bytes);
+
+  // Returns 'ptr' to the cache of the calling thread if it is a cached
+  // allocation. Returns false if 'ptr' must be deallocated to the bins.
+  bool DeallocateToThreadCache(void* ptr);
+
+  // Returns the free chunks of all the caches to the bins. Returns true if
+  // any chunk was returned.
+  bool FlushThreadCaches() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
@@ -208,6 +287,10 @@ class BFCAllocator : public Allocator {
     // Optional count when this chunk was most recently made free.
     uint64 freed_at_count = 0;
 
+    // The size class of the region of this chunk (see
+    // Options::segregate_size_classes).
+    int size_class = 0;
+
     bool in_use() const { return allocation_id != -1; }
 
 #ifdef TENSORFLOW_MEM_DEBUG
@@ -290,11 +373,11 @@ class BFCAllocator : public Allocator {
   // This class is thread-compatible.
   class AllocationRegion {
    public:
-    AllocationRegion(void* ptr, size_t memory_size)
+    AllocationRegion(void* ptr, size_t memory_size, int size_class = 0)
         : ptr_(ptr),
           memory_size_(memory_size),
-          end_ptr_(
-              static_cast<void*>(static_cast<char*>(ptr_) + memory_size_)) {
+          end_ptr_(static_cast<void*>(static_cast<char*>(ptr_) + memory_size_)),
+          size_class_(size_class) {
       DCHECK_EQ(0, memory_size % kMinAllocationSize);
       const size_t n_handles =
           (memory_size + kMinAllocationSize - 1) / kMinAllocationSize;
@@ -311,6 +394,7 @@ class BFCAllocator : public Allocator {
     void* ptr() const { return ptr_; }
     void* end_ptr() const { return end_ptr_; }
     size_t memory_size() const { return memory_size_; }
+    int size_class() const { return size_class_; }
     void extend(size_t size) {
       memory_size_ += size;
       DCHECK_EQ(0, memory_size_ % kMinAllocationSize);
@@ -320,6 +404,17 @@ class BFCAllocator : public Allocator {
           (memory_size_ + kMinAllocationSize - 1) / kMinAllocationSize;
       handles_.resize(n_handles, kInvalidChunkHandle);
     }
+    // Removes the last 'size' bytes from the region.
+    void shrink(size_t size) {
+      DCHECK_LT(size, memory_size_);
+      memory_size_ -= size;
+      DCHECK_EQ(0, memory_size_ % kMinAllocationSize);
+
+      end_ptr_ = static_cast<void*>(static_cast<char*>(end_ptr_) - size);
+      const size_t n_handles =
+          (memory_size_ + kMinAllocationSize - 1) / kMinAllocationSize;
+      handles_.resize(n_handles);
+    }
     ChunkHandle get_handle(const void* p) const {
       return handles_[IndexFor(p)];
     }
@@ -328,6 +423,7 @@ class BFCAllocator : public Allocator {
 
    private:
     void Swap(AllocationRegion* other) {
+      std::swap(size_class_, other->size_class_);
       std::swap(ptr_, other->ptr_);
       std::swap(memory_size_, other->memory_size_);
       std::swap(end_ptr_, other->end_ptr_);
@@ -346,6 +442,7 @@ class BFCAllocator : public Allocator {
     void* ptr_ = nullptr;
     size_t memory_size_ = 0;
     void* end_ptr_ = nullptr;
+    int size_class_ = 0;
 
     // Array of size "memory_size / kMinAllocationSize".  It is
     // indexed by (p-base) / kMinAllocationSize, contains ChunkHandle
@@ -365,26 +462,29 @@ class BFCAllocator : public Allocator {
     RegionManager() {}
     ~RegionManager() {}
 
-    void AddAllocationRegion(void* ptr, size_t memory_size) {
+    void AddAllocationRegion(void* ptr, size_t memory_size,
+                             int size_class = 0) {
       // Insert sorted by end_ptr.
       auto entry =
           std::upper_bound(regions_.begin(), regions_.end(), ptr, &Comparator);
-      regions_.insert(entry, AllocationRegion(ptr, memory_size));
+      regions_.insert(entry, AllocationRegion(ptr, memory_size, size_class));
     }
 
     // Adds an alloation region for the given ptr and size, potentially
-    // extending a region if ptr matches the end_ptr of an existing region.
+    // extending a region of the same size class if ptr matches the end_ptr of
+    // an existing region.
     // If a region is extended, returns a pointer to the extended region so that
     // the BFC allocator can reason about chunkification.
-    AllocationRegion* AddOrExtendAllocationRegion(void* ptr,
-                                                  size_t memory_size) {
+    AllocationRegion* AddOrExtendAllocationRegion(void* ptr, size_t memory_size,
+                                                  int size_class = 0) {
       // Insert sorted by end_ptr.
       auto entry =
           std::upper_bound(regions_.begin(), regions_.end(), ptr, &Comparator);
       // Check if can be coalesced with preceding region.
       if (entry != regions_.begin()) {
         auto preceding_region = entry - 1;
-        if (preceding_region->end_ptr() == ptr) {
+        if (preceding_region->end_ptr() == ptr &&
+            preceding_region->size_class() == size_class) {
           if (VLOG_IS_ON(1)) {
             LOG(INFO) << "Extending region " << preceding_region->ptr()
                       << " of "
@@ -399,7 +499,7 @@ class BFCAllocator : public Allocator {
       }
       VLOG(1) << "Inserting new region " << ptr << " of "
               << strings::HumanReadableNumBytes(memory_size);
-      regions_.insert(entry, AllocationRegion(ptr, memory_size));
+      regions_.insert(entry, AllocationRegion(ptr, memory_size, size_class));
       return nullptr;
     }
 
@@ -408,10 +508,27 @@ class BFCAllocator : public Allocator {
       return regions_.erase(it);
     }
 
+    // Removes the last 'size' bytes from the region containing 'p'. The
+    // regions stay sorted as they do not overlap.
+    void ShrinkAllocationRegion(const void* p, size_t size) {
+      MutableRegionFor(p)->shrink(size);
+    }
+
     ChunkHandle get_handle(const void* p) const {
       return RegionFor(p)->get_handle(p);
     }
 
+    // Like get_handle(), but returns kInvalidChunkHandle if 'p' is not in any
+    // region.
+    ChunkHandle find_handle(const void* p) const {
+      auto entry =
+          std::upper_bound(regions_.begin(), regions_.end(), p, &Comparator);
+      if (entry == regions_.end() || p < entry->ptr()) {
+        return kInvalidChunkHandle;
+      }
+      return entry->get_handle(p);
+    }
+
     void set_handle(const void* p, ChunkHandle h) {
       return MutableRegionFor(p)->set_handle(p, h);
     }
@@ -447,12 +564,16 @@ class BFCAllocator : public Allocator {
   // Returns 'bytes' rounded up to the next highest kMinAllocationSize.
   static size_t RoundedBytes(size_t bytes);
 
-  // Try to add a new memory region that can satisfy an allocation of
-  // 'rounded_bytes' bytes.  Returns true on success and false on
-  // failure.
-  bool Extend(size_t alignment, size_t rounded_bytes)
+  // Try to add a new memory region of size class 'size_class' that can
+  // satisfy an allocation of 'rounded_bytes' bytes.  Returns true on success
+  // and false on failure.
+  bool Extend(size_t alignment, size_t rounded_bytes, int size_class)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Returns the size class of an allocation of 'rounded_bytes' bytes: 0 unless
+  // opts_.segregate_size_classes is set.
+  int SizeClassForBytes(size_t rounded_bytes) const;
+
   // Deallocate free regions to give back the memory to suballocator, so that
   // we can re-allocate a larger region.  The main use scenario of this function
   // is when OOM happens but we have free regions and the sum of sizes of free
@@ -465,10 +586,29 @@ class BFCAllocator : public Allocator {
   void DeallocateRegions(const absl::flat_hash_set<void*>& region_ptrs)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Returns the regions that have no chunk in use, and adds their size to
+  // '*total_free_bytes'.
+  absl::flat_hash_set<void*> FindFreeRegions(size_t* total_free_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns to the sub-allocator the allocations of 'sub_allocations_' that
+  // the free tail chunk of their region covered in the previous call and
+  // still covers, shrinking the chunk and the region accordingly.
+  void ReleaseIdleTailMemory() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Returns a pointer to an underlying allocated chunk of size
-  // 'rounded_bytes'.
+  // 'rounded_bytes' in a region of size class 'size_class'.
   void* FindChunkPtr(BinNum bin_num, size_t rounded_bytes, size_t num_bytes,
-                     uint64 freed_before) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+                     uint64 freed_before, int size_class)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Exports the free bytes and the largest free chunk of this allocator to
+  // the metrics.
+  void UpdateFragmentationMetrics() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Calls Compact() every opts_.compaction_interval_micros until the
+  // allocator is destroyed.
+  void CompactionLoop();
 
   // Splits the chunk specified by 'h' into two chunks, one at least
   // of size 'num_bytes'.
@@ -510,6 +650,9 @@ class BFCAllocator : public Allocator {
 
   void MarkFree(ChunkHandle h) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Marks the in-use chunk 'h' free and returns it to the bins.
+  void FreeChunk(ChunkHandle h) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   ChunkHandle TryToCoalesce(ChunkHandle h, bool ignore_freed_at)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
@@ -578,6 +721,12 @@ class BFCAllocator : public Allocator {
   // The size of the current region allocation.
   size_t curr_region_allocation_bytes_;
 
+  // With opts_.segregate_size_classes, the size of the current region
+  // allocation of each size class, used instead of
+  // curr_region_allocation_bytes_.
+  static constexpr int kNumSizeClasses = 3;
+  size_t size_class_region_bytes_[kNumSizeClasses];
+
   // An indicator that expansion of a region has hit the limits
   // of the available memory.
   bool started_backpedal_ = false;
@@ -611,6 +760,47 @@ class BFCAllocator : public Allocator {
 
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
+
+  // Stream-ordered mode (see Options::stream_ordered).
+  int64_t next_stream_use_id_ TF_GUARDED_BY(lock_) = 1;
+  // The chunk of each recorded stream use that has not completed.
+  absl::flat_hash_map<int64_t, ChunkHandle> stream_uses_ TF_GUARDED_BY(lock_);
+  // The number of uses in 'stream_uses_' of each chunk.
+  absl::flat_hash_map<ChunkHandle, int> num_stream_uses_ TF_GUARDED_BY(lock_);
+  // Chunks that were deallocated while they had uses in 'stream_uses_'. They
+  // stay in use until their last use completes.
+  absl::flat_hash_set<ChunkHandle> deferred_frees_ TF_GUARDED_BY(lock_);
+
+  // The regions that were free in the last call to Compact().
+  absl::flat_hash_set<void*> idle_regions_ TF_GUARDED_BY(lock_);
+
+  // With coalesce_regions_, the size of each allocation returned by the
+  // sub-allocator, by address. A region extended by adjacent allocations can
+  // only give back whole allocations.
+  std::map<void*, size_t> sub_allocations_ TF_GUARDED_BY(lock_);
+  // The allocations of 'sub_allocations_' that were covered by a free tail
+  // chunk in the last call to ReleaseIdleTailMemory().
+  absl::flat_hash_set<void*> idle_tail_allocations_ TF_GUARDED_BY(lock_);
+
+  // The caches of opts_.thread_cache_bytes, or nullptr if they are disabled.
+  struct ThreadCacheShard {
+    mutex mu;
+    // The rounded size of each allocation owned by the caches, whether it is
+    // in use or free. Keyed by the allocations of this shard (ShardForPtr()).
+    absl::flat_hash_map<void*, size_t> rounded_sizes TF_GUARDED_BY(mu);
+    // The free chunks of the threads of this shard (ShardForThread()), by
+    // rounded size / kMinAllocationSize - 1.
+    std::vector<void*> free_ptrs[kMaxThreadCachedBytes / kMinAllocationSize]
+        TF_GUARDED_BY(mu);
+    size_t free_bytes TF_GUARDED_BY(mu) = 0;
+  };
+  std::unique_ptr<ThreadCacheShard[]> thread_cache_shards_;
+
+  // The background thread of opts_.compaction_interval_micros.
+  mutex compaction_mu_;
+  condition_variable compaction_cv_;
+  bool stop_compaction_ TF_GUARDED_BY(compaction_mu_) = false;
+  std::unique_ptr<Thread> compaction_thread_;
 #ifdef TENSORFLOW_MEM_DEBUG
   int64 action_counter_ TF_GUARDED_BY(lock_) = 0;
 #define MEM_DEBUG_SIZE_HISTORY_SIZE 4096
@@ -18,6 +18,7 @@ limitations under the License.
 #include <cstdint>
 
 #include "tensorflow/tsl/lib/monitoring/counter.h"
+#include "tensorflow/tsl/lib/monitoring/gauge.h"
 
 namespace tsl {
 namespace metrics {
@@ -28,6 +29,15 @@ auto* bfc_allocator_delay =
                                 "The total time spent running each graph "
                                 "optimization pass in microseconds.");
 
+auto* bfc_allocator_free_bytes = monitoring::Gauge<int64_t, 1>::New(
+    "/tensorflow/core/bfc_allocator/free_bytes",
+    "The memory held by a BFC allocator that is not in use.", "allocator");
+
+auto* bfc_allocator_largest_free_chunk_bytes =
+    monitoring::Gauge<int64_t, 1>::New(
+        "/tensorflow/core/bfc_allocator/largest_free_chunk_bytes",
+        "The size of the largest free chunk of a BFC allocator.", "allocator");
+
 }  // namespace
 
 void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs) {
@@ -37,5 +47,13 @@ void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs) {
   }
 }
 
+void UpdateBfcAllocatorFragmentation(const std::string& allocator_name,
+                                     int64_t free_bytes,
+                                     int64_t largest_free_chunk_bytes) {
+  bfc_allocator_free_bytes->GetCell(allocator_name)->Set(free_bytes);
+  bfc_allocator_largest_free_chunk_bytes->GetCell(allocator_name)
+      ->Set(largest_free_chunk_bytes);
+}
+
 }  // namespace metrics
 }  // namespace tsl
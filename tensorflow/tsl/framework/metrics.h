@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_TSL_FRAMEWORK_METRICS_H_
 
 #include <cstdint>
+#include <string>
 
 namespace tsl {
 namespace metrics {
@@ -24,6 +25,13 @@ namespace metrics {
 // Updates the metrics stored about time BFC allocator spents during delay.
 void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs);
 
+// Updates the free memory of the BFC allocator `allocator_name` and the size
+// of its largest free chunk. Their difference is the free memory that is
+// fragmented.
+void UpdateBfcAllocatorFragmentation(const std::string& allocator_name,
+                                     int64_t free_bytes,
+                                     int64_t largest_free_chunk_bytes);
+
 }  // namespace metrics
 }  // namespace tsl
 
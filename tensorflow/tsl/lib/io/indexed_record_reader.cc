@@ -0,0 +1,120 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/indexed_record_reader.h"
+
+#include <utility>
+
+#include "tensorflow/tsl/lib/hash/crc32c.h"
+#include "tensorflow/tsl/lib/io/random_inputstream.h"
+#include "tensorflow/tsl/lib/io/record_reader.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_inputstream.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/raw_coding.h"
+
+namespace tsl {
+namespace io {
+
+Status IndexedRecordReader::Create(
+    RandomAccessFile* file, uint64 file_size,
+    const ZstdCompressionOptions& options,
+    std::unique_ptr<IndexedRecordReader>* reader) {
+  RecordBlockIndex index;
+  TF_RETURN_IF_ERROR(RecordBlockIndex::ReadFromFile(file, file_size, &index));
+  reader->reset(new IndexedRecordReader(file, options, std::move(index)));
+  return OkStatus();
+}
+
+IndexedRecordReader::IndexedRecordReader(RandomAccessFile* file,
+                                         const ZstdCompressionOptions& options,
+                                         RecordBlockIndex index)
+    : file_(file), options_(options), index_(std::move(index)) {}
+
+Status IndexedRecordReader::OpenBlock(
+    size_t block, std::unique_ptr<InputStreamInterface>* stream) const {
+  if (block >= index_.blocks.size()) {
+    return errors::OutOfRange("Block ", block, " requested, but the file has ",
+                              index_.blocks.size(), " blocks.");
+  }
+  auto file_stream = std::make_unique<RandomAccessInputStream>(file_);
+  TF_RETURN_IF_ERROR(file_stream->Seek(index_.blocks[block].offset));
+  stream->reset(new ZstdInputStream(
+      file_stream.release(), options_.input_buffer_size,
+      options_.output_buffer_size, options_, /*owns_input_stream=*/true));
+  return OkStatus();
+}
+
+Status IndexedRecordReader::ReadNextRecord(InputStreamInterface* stream,
+                                           tstring* record) {
+  tstring header;
+  Status s = stream->ReadNBytes(RecordReader::kHeaderSize, &header);
+  if (errors::IsOutOfRange(s)) {
+    return errors::DataLoss("Truncated block.");
+  }
+  TF_RETURN_IF_ERROR(s);
+  const uint32 length_crc = core::DecodeFixed32(header.data() + sizeof(uint64));
+  if (crc32c::Unmask(length_crc) !=
+      crc32c::Value(header.data(), sizeof(uint64))) {
+    return errors::DataLoss("Corrupted record length.");
+  }
+  const uint64 length = core::DecodeFixed64(header.data());
+  if (record == nullptr) {
+    s = stream->SkipNBytes(length + RecordReader::kFooterSize);
+    return errors::IsOutOfRange(s) ? errors::DataLoss("Truncated block.") : s;
+  }
+
+  s = stream->ReadNBytes(length + RecordReader::kFooterSize, record);
+  if (errors::IsOutOfRange(s)) {
+    return errors::DataLoss("Truncated block.");
+  }
+  TF_RETURN_IF_ERROR(s);
+  const uint32 data_crc = core::DecodeFixed32(record->data() + length);
+  if (crc32c::Unmask(data_crc) != crc32c::Value(record->data(), length)) {
+    return errors::DataLoss("Corrupted record.");
+  }
+  record->resize(length);
+  return OkStatus();
+}
+
+Status IndexedRecordReader::ReadBlock(size_t block,
+                                      std::vector<tstring>* records) const {
+  std::unique_ptr<InputStreamInterface> stream;
+  TF_RETURN_IF_ERROR(OpenBlock(block, &stream));
+  const uint64 num_records = index_.NumRecordsInBlock(block);
+  records->reserve(records->size() + num_records);
+  for (uint64 i = 0; i < num_records; ++i) {
+    records->emplace_back();
+    TF_RETURN_IF_ERROR(ReadNextRecord(stream.get(), &records->back()));
+  }
+  return OkStatus();
+}
+
+Status IndexedRecordReader::ReadRecord(uint64 record, tstring* result) const {
+  if (record >= index_.num_records) {
+    return errors::OutOfRange("Record ", record,
+                              " requested, but the file has ",
+                              index_.num_records, " records.");
+  }
+  const size_t block = index_.BlockForRecord(record);
+  std::unique_ptr<InputStreamInterface> stream;
+  TF_RETURN_IF_ERROR(OpenBlock(block, &stream));
+  for (uint64 i = index_.blocks[block].first_record; i < record; ++i) {
+    TF_RETURN_IF_ERROR(ReadNextRecord(stream.get(), /*record=*/nullptr));
+  }
+  return ReadNextRecord(stream.get(), result);
+}
+
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,94 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_INDEXED_RECORD_READER_H_
+#define TENSORFLOW_TSL_LIB_IO_INDEXED_RECORD_READER_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/tsl/lib/io/inputstream_interface.h"
+#include "tensorflow/tsl/lib/io/record_block_index.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/tsl/platform/file_system.h"
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+// Random access to TFRecord files written with zstd compression and
+// ZstdCompressionOptions::block_size > 0.
+//
+// Such files consist of independently compressed blocks of whole records and
+// an index of the blocks (see RecordBlockIndex). Reading a record only
+// decompresses the block that holds it, and different blocks can be
+// decompressed in parallel, e.g. by handing out blocks as splits to several
+// readers.
+//
+// All methods are safe for concurrent use by multiple threads.
+class IndexedRecordReader {
+ public:
+  // Reads the block index of `file`, which is `file_size` bytes long.
+  // `options` must hold the dictionary the file was written with, if any.
+  // `file` must remain live while the reader is in use.
+  static Status Create(RandomAccessFile* file, uint64 file_size,
+                       const ZstdCompressionOptions& options,
+                       std::unique_ptr<IndexedRecordReader>* reader);
+
+  uint64 num_records() const { return index_.num_records; }
+  size_t num_blocks() const { return index_.blocks.size(); }
+
+  // Returns the block holding record `record`.
+  size_t BlockForRecord(uint64 record) const {
+    return index_.BlockForRecord(record);
+  }
+
+  // Number of the first record in block `block`.
+  uint64 FirstRecordInBlock(size_t block) const {
+    return index_.blocks[block].first_record;
+  }
+
+  // Decompresses block `block` and appends its records to `*records`.
+  Status ReadBlock(size_t block, std::vector<tstring>* records) const;
+
+  // Reads record number `record` into `*record`. Returns OUT_OF_RANGE if the
+  // file has no such record.
+  Status ReadRecord(uint64 record, tstring* result) const;
+
+ private:
+  IndexedRecordReader(RandomAccessFile* file,
+                      const ZstdCompressionOptions& options,
+                      RecordBlockIndex index);
+
+  // Opens a decompressing stream positioned at the start of block `block`.
+  Status OpenBlock(size_t block,
+                   std::unique_ptr<InputStreamInterface>* stream) const;
+
+  // Reads the next record from `stream`, or skips it if `record` is null.
+  static Status ReadNextRecord(InputStreamInterface* stream, tstring* record);
+
+  RandomAccessFile* const file_;
+  const ZstdCompressionOptions options_;
+  const RecordBlockIndex index_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(IndexedRecordReader);
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_INDEXED_RECORD_READER_H_
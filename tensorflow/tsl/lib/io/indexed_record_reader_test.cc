@@ -0,0 +1,145 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/indexed_record_reader.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/lib/io/record_reader.h"
+#include "tensorflow/tsl/lib/io/record_writer.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/strcat.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+std::vector<string> MakeRecords(int n) {
+  std::vector<string> records;
+  for (int i = 0; i < n; ++i) {
+    records.push_back(strings::StrCat("record ", i, string(i % 50, 'x')));
+  }
+  return records;
+}
+
+void WriteRecords(const string& fname, const std::vector<string>& records,
+                  int64_t block_size) {
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(fname, &file));
+  RecordWriterOptions options =
+      RecordWriterOptions::CreateRecordWriterOptions("ZSTD");
+  options.zstd_options.block_size = block_size;
+  RecordWriter writer(file.get(), options);
+  for (const string& record : records) {
+    TF_ASSERT_OK(writer.WriteRecord(record));
+  }
+  TF_ASSERT_OK(writer.Close());
+  TF_ASSERT_OK(file->Close());
+}
+
+std::unique_ptr<IndexedRecordReader> OpenIndexed(
+    const string& fname, std::unique_ptr<RandomAccessFile>* file) {
+  uint64 file_size;
+  TF_CHECK_OK(Env::Default()->GetFileSize(fname, &file_size));
+  TF_CHECK_OK(Env::Default()->NewRandomAccessFile(fname, file));
+  std::unique_ptr<IndexedRecordReader> reader;
+  TF_CHECK_OK(IndexedRecordReader::Create(file->get(), file_size,
+                                          ZstdCompressionOptions(), &reader));
+  return reader;
+}
+
+TEST(IndexedRecordReaderTest, ReadsBlocksAndRecords) {
+  const string fname = testing::TmpDir() + "/indexed_record_reader_test";
+  const std::vector<string> records = MakeRecords(1000);
+  WriteRecords(fname, records, /*block_size=*/1024);
+
+  std::unique_ptr<RandomAccessFile> file;
+  std::unique_ptr<IndexedRecordReader> reader = OpenIndexed(fname, &file);
+  EXPECT_EQ(records.size(), reader->num_records());
+  EXPECT_GT(reader->num_blocks(), 10);
+
+  // Blocks can be read in any order and together hold all records.
+  std::vector<tstring> from_blocks;
+  for (size_t block = reader->num_blocks(); block > 0; --block) {
+    std::vector<tstring> block_records;
+    TF_ASSERT_OK(reader->ReadBlock(block - 1, &block_records));
+    EXPECT_EQ(reader->FirstRecordInBlock(block - 1) + block_records.size(),
+              block == reader->num_blocks()
+                  ? records.size()
+                  : reader->FirstRecordInBlock(block));
+    from_blocks.insert(from_blocks.begin(), block_records.begin(),
+                       block_records.end());
+  }
+  ASSERT_EQ(records.size(), from_blocks.size());
+  for (size_t i = 0; i < records.size(); ++i) {
+    EXPECT_EQ(records[i], from_blocks[i]);
+  }
+
+  for (uint64 i : {0, 1, 99, 500, 998, 999}) {
+    tstring record;
+    TF_ASSERT_OK(reader->ReadRecord(i, &record));
+    EXPECT_EQ(records[i], record);
+  }
+  tstring record;
+  EXPECT_TRUE(errors::IsOutOfRange(reader->ReadRecord(1000, &record)));
+}
+
+TEST(IndexedRecordReaderTest, RecordReaderSkipsIndex) {
+  const string fname = testing::TmpDir() + "/indexed_record_reader_compat";
+  const std::vector<string> records = MakeRecords(300);
+  WriteRecords(fname, records, /*block_size=*/512);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  SequentialRecordReader reader(
+      file.get(), RecordReaderOptions::CreateRecordReaderOptions("ZSTD"));
+  tstring record;
+  for (const string& expected : records) {
+    TF_ASSERT_OK(reader.ReadRecord(&record));
+    EXPECT_EQ(expected, record);
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&record)));
+}
+
+TEST(IndexedRecordReaderTest, EmptyFile) {
+  const string fname = testing::TmpDir() + "/indexed_record_reader_empty";
+  WriteRecords(fname, {}, /*block_size=*/512);
+
+  std::unique_ptr<RandomAccessFile> file;
+  std::unique_ptr<IndexedRecordReader> reader = OpenIndexed(fname, &file);
+  EXPECT_EQ(0, reader->num_records());
+  EXPECT_EQ(0, reader->num_blocks());
+}
+
+TEST(IndexedRecordReaderTest, NoIndex) {
+  const string fname = testing::TmpDir() + "/indexed_record_reader_no_index";
+  WriteRecords(fname, MakeRecords(10), /*block_size=*/0);
+
+  uint64 file_size;
+  TF_ASSERT_OK(Env::Default()->GetFileSize(fname, &file_size));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  std::unique_ptr<IndexedRecordReader> reader;
+  EXPECT_TRUE(errors::IsInvalidArgument(IndexedRecordReader::Create(
+      file.get(), file_size, ZstdCompressionOptions(), &reader)));
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,118 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/record_block_index.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "tensorflow/tsl/lib/hash/crc32c.h"
+#include "tensorflow/tsl/platform/coding.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+#include "tensorflow/tsl/platform/raw_coding.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+// zstd reserves the magic numbers 0x184D2A50 to 0x184D2A5F for skippable
+// frames.
+constexpr uint32 kSkippableFrameMagic = 0x184D2A5E;
+constexpr uint32 kRecordBlockIndexMagic = 0x49524654;  // "TFRI"
+
+constexpr size_t kSkippableHeaderSize = 2 * sizeof(uint32);
+constexpr size_t kBlockEntrySize = 2 * sizeof(uint64);
+constexpr size_t kFooterSize = 2 * sizeof(uint64) + 2 * sizeof(uint32);
+
+}  // namespace
+
+size_t RecordBlockIndex::BlockForRecord(uint64 record) const {
+  DCHECK_LT(record, num_records);
+  auto it = std::upper_bound(
+      blocks.begin(), blocks.end(), record,
+      [](uint64 r, const Block& block) { return r < block.first_record; });
+  return std::distance(blocks.begin(), it) - 1;
+}
+
+void RecordBlockIndex::Encode(std::string* out) const {
+  std::string payload;
+  payload.reserve(blocks.size() * kBlockEntrySize + kFooterSize);
+  for (const Block& block : blocks) {
+    core::PutFixed64(&payload, block.offset);
+    core::PutFixed64(&payload, block.first_record);
+  }
+  core::PutFixed64(&payload, num_records);
+  core::PutFixed64(&payload, blocks.size());
+  core::PutFixed32(&payload,
+                   crc32c::Mask(crc32c::Value(payload.data(), payload.size())));
+  core::PutFixed32(&payload, kRecordBlockIndexMagic);
+
+  core::PutFixed32(out, kSkippableFrameMagic);
+  core::PutFixed32(out, payload.size());
+  out->append(payload);
+}
+
+Status RecordBlockIndex::ReadFromFile(RandomAccessFile* file, uint64 file_size,
+                                      RecordBlockIndex* index) {
+  if (file_size < kSkippableHeaderSize + kFooterSize) {
+    return errors::InvalidArgument("File too short to hold a block index.");
+  }
+  char footer_scratch[kFooterSize];
+  StringPiece footer;
+  TF_RETURN_IF_ERROR(file->Read(file_size - kFooterSize, kFooterSize, &footer,
+                                footer_scratch));
+  if (core::DecodeFixed32(footer.data() + kFooterSize - sizeof(uint32)) !=
+      kRecordBlockIndexMagic) {
+    return errors::InvalidArgument(
+        "File has no block index. Was it written with "
+        "zstd_options.block_size > 0?");
+  }
+  const uint64 num_records = core::DecodeFixed64(footer.data());
+  const uint64 num_blocks = core::DecodeFixed64(footer.data() + sizeof(uint64));
+  if (num_blocks > (file_size - kSkippableHeaderSize - kFooterSize) /
+                       kBlockEntrySize) {
+    return errors::DataLoss("Corrupted block index: ", num_blocks,
+                            " blocks in a file of ", file_size, " bytes.");
+  }
+
+  const size_t payload_size = num_blocks * kBlockEntrySize + kFooterSize;
+  const size_t frame_size = kSkippableHeaderSize + payload_size;
+  std::unique_ptr<char[]> scratch(new char[frame_size]);
+  StringPiece frame;
+  TF_RETURN_IF_ERROR(
+      file->Read(file_size - frame_size, frame_size, &frame, scratch.get()));
+  const char* payload = frame.data() + kSkippableHeaderSize;
+  const size_t crc_offset = payload_size - 2 * sizeof(uint32);
+  if (core::DecodeFixed32(frame.data()) != kSkippableFrameMagic ||
+      core::DecodeFixed32(frame.data() + sizeof(uint32)) != payload_size ||
+      crc32c::Unmask(core::DecodeFixed32(payload + crc_offset)) !=
+          crc32c::Value(payload, crc_offset)) {
+    return errors::DataLoss("Corrupted block index.");
+  }
+
+  index->num_records = num_records;
+  index->blocks.resize(num_blocks);
+  for (uint64 i = 0; i < num_blocks; ++i) {
+    Block& block = index->blocks[i];
+    block.offset = core::DecodeFixed64(payload + i * kBlockEntrySize);
+    block.first_record =
+        core::DecodeFixed64(payload + i * kBlockEntrySize + sizeof(uint64));
+  }
+  return OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,80 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_RECORD_BLOCK_INDEX_H_
+#define TENSORFLOW_TSL_LIB_IO_RECORD_BLOCK_INDEX_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/tsl/platform/file_system.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+// Index of the independently compressed blocks of a TFRecord file written
+// with ZstdCompressionOptions::block_size > 0.
+//
+// Each block is a separate zstd frame holding whole records. The index
+// follows the last block in a zstd skippable frame, which zstd decoders (and
+// so RecordReader) ignore:
+//
+//  uint32    skippable frame magic
+//  uint32    payload size
+//  (uint64 block offset, uint64 first record) * num_blocks
+//  uint64    num_records
+//  uint64    num_blocks
+//  uint32    masked crc of the preceding payload bytes
+//  uint32    kRecordBlockIndexMagic
+//
+// All integers are little-endian.
+struct RecordBlockIndex {
+  struct Block {
+    // Offset of the block's zstd frame in the file.
+    uint64 offset;
+    // Number of the first record in the block.
+    uint64 first_record;
+  };
+
+  std::vector<Block> blocks;
+  uint64 num_records = 0;
+
+  // Number of records in block `block`.
+  uint64 NumRecordsInBlock(size_t block) const {
+    return (block + 1 < blocks.size() ? blocks[block + 1].first_record
+                                      : num_records) -
+           blocks[block].first_record;
+  }
+
+  // Returns the block holding record `record`, which must be less than
+  // `num_records`.
+  size_t BlockForRecord(uint64 record) const;
+
+  // Appends the index, framed as described above, to `*out`.
+  void Encode(std::string* out) const;
+
+  // Reads the index from the end of `file`, which is `file_size` bytes long.
+  // Returns InvalidArgument if the file has no index, and DataLoss if the
+  // index is corrupt.
+  static Status ReadFromFile(RandomAccessFile* file, uint64 file_size,
+                             RecordBlockIndex* index);
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_RECORD_BLOCK_INDEX_H_
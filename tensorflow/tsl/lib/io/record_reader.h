@@ -25,6 +25,11 @@ limitations under the License.
 #include "tensorflow/tsl/lib/io/zlib_compression_options.h"
 #include "tensorflow/tsl/lib/io/zlib_inputstream.h"
 #endif  // IS_SLIM_BUILD
+#include "tensorflow/tsl/platform/platform.h"
+#if !defined(IS_SLIM_BUILD) && !defined(IS_MOBILE_PLATFORM)
+#include "tensorflow/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_inputstream.h"
+#endif
 #include "tensorflow/tsl/platform/macros.h"
 #include "tensorflow/tsl/platform/types.h"
 
@@ -37,7 +42,9 @@ struct RecordReaderOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    // Not available on mobile platforms.
+    ZSTD_COMPRESSION = 3
   };
   CompressionType compression_type = NONE;
 
@@ -54,6 +61,9 @@ struct RecordReaderOptions {
   ZlibCompressionOptions zlib_options;
   SnappyCompressionOptions snappy_options;
 #endif  // IS_SLIM_BUILD
+#if !defined(IS_SLIM_BUILD) && !defined(IS_MOBILE_PLATFORM)
+  ZstdCompressionOptions zstd_options;
+#endif
 };
 
 // Low-level interface to read TFRecord files.
@@ -30,6 +30,10 @@ bool IsZlibCompressed(const RecordWriterOptions& options) {
 bool IsSnappyCompressed(const RecordWriterOptions& options) {
   return options.compression_type == RecordWriterOptions::SNAPPY_COMPRESSION;
 }
+
+bool IsZstdCompressed(const RecordWriterOptions& options) {
+  return options.compression_type == RecordWriterOptions::ZSTD_COMPRESSION;
+}
 }  // namespace
 
 RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
@@ -49,6 +53,10 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordWriterOptions::SNAPPY_COMPRESSION;
+#if !defined(IS_MOBILE_PLATFORM)
+  } else if (compression_type == compression::kZstd) {
+    options.compression_type = io::RecordWriterOptions::ZSTD_COMPRESSION;
+#endif
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -79,6 +87,21 @@ RecordWriter::RecordWriter(WritableFile* dest,
     dest_ =
         new SnappyOutputBuffer(dest, options.snappy_options.input_buffer_size,
                                options.snappy_options.output_buffer_size);
+#if !defined(IS_MOBILE_PLATFORM)
+  } else if (IsZstdCompressed(options)) {
+    ZstdOutputBuffer* zstd_output_buffer = new ZstdOutputBuffer(
+        dest, options.zstd_options.input_buffer_size,
+        options.zstd_options.output_buffer_size, options.zstd_options);
+    Status s = zstd_output_buffer->Init();
+    if (!s.ok()) {
+      LOG(FATAL) << "Failed to initialize Zstd outputbuffer. Error: "
+                 << s.ToString();
+    }
+    dest_ = zstd_output_buffer;
+    if (options.zstd_options.block_size > 0) {
+      zstd_blocks_ = zstd_output_buffer;
+    }
+#endif
   } else if (options.compression_type == RecordWriterOptions::NONE) {
     // Nothing to do
   } else {
@@ -110,9 +133,11 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   char footer[kFooterSize];
   PopulateHeader(header, data.data(), data.size());
   PopulateFooter(footer, data.data(), data.size());
+  TF_RETURN_IF_ERROR(MaybeStartBlock());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  return MaybeEndBlock(data.size());
 }
 
 #if defined(TF_CORD_SUPPORT)
@@ -130,15 +155,56 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   char footer[kFooterSize];
   PopulateHeader(header, data);
   PopulateFooter(footer, data);
+  TF_RETURN_IF_ERROR(MaybeStartBlock());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  return MaybeEndBlock(data.size());
+}
+#endif
+
+Status RecordWriter::MaybeStartBlock() {
+#if !defined(IS_SLIM_BUILD) && !defined(IS_MOBILE_PLATFORM)
+  if (zstd_blocks_ != nullptr && !block_open_) {
+    block_index_.blocks.push_back(
+        {zstd_blocks_->compressed_bytes(), block_index_.num_records});
+    block_open_ = true;
+  }
+#endif
+  return OkStatus();
 }
+
+Status RecordWriter::MaybeEndBlock(size_t data_size) {
+#if !defined(IS_SLIM_BUILD) && !defined(IS_MOBILE_PLATFORM)
+  if (zstd_blocks_ != nullptr) {
+    ++block_index_.num_records;
+    block_bytes_ += kHeaderSize + data_size + kFooterSize;
+    if (block_bytes_ >= options_.zstd_options.block_size) {
+      TF_RETURN_IF_ERROR(zstd_blocks_->EndFrame());
+      block_open_ = false;
+      block_bytes_ = 0;
+    }
+  }
 #endif
+  return OkStatus();
+}
 
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return OkStatus();
-  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
+#if !defined(IS_SLIM_BUILD) && !defined(IS_MOBILE_PLATFORM)
+  if (zstd_blocks_ != nullptr) {
+    if (block_open_) {
+      TF_RETURN_IF_ERROR(zstd_blocks_->EndFrame());
+      block_open_ = false;
+    }
+    string encoded_index;
+    block_index_.Encode(&encoded_index);
+    TF_RETURN_IF_ERROR(zstd_blocks_->AppendUncompressed(encoded_index));
+    zstd_blocks_ = nullptr;
+  }
+#endif
+  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_) ||
+      IsZstdCompressed(options_)) {
     Status s = dest_->Close();
     delete dest_;
     dest_ = nullptr;
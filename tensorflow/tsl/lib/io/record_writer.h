@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_TSL_LIB_IO_RECORD_WRITER_H_
 
 #include "tensorflow/tsl/lib/hash/crc32c.h"
+#include "tensorflow/tsl/lib/io/record_block_index.h"
 #include "tensorflow/tsl/platform/coding.h"
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/stringpiece.h"
@@ -26,6 +27,11 @@ limitations under the License.
 #include "tensorflow/tsl/lib/io/zlib_compression_options.h"
 #include "tensorflow/tsl/lib/io/zlib_outputbuffer.h"
 #endif  // IS_SLIM_BUILD
+#include "tensorflow/tsl/platform/platform.h"
+#if !defined(IS_SLIM_BUILD) && !defined(IS_MOBILE_PLATFORM)
+#include "tensorflow/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_outputbuffer.h"
+#endif
 #include "tensorflow/tsl/platform/cord.h"
 #include "tensorflow/tsl/platform/macros.h"
 #include "tensorflow/tsl/platform/types.h"
@@ -41,7 +47,9 @@ struct RecordWriterOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    // Not available on mobile platforms.
+    ZSTD_COMPRESSION = 3
   };
   CompressionType compression_type = NONE;
 
@@ -53,8 +61,13 @@ struct RecordWriterOptions {
   io::ZlibCompressionOptions zlib_options;
   io::SnappyCompressionOptions snappy_options;
 #endif  // IS_SLIM_BUILD
+#if !defined(IS_SLIM_BUILD) && !defined(IS_MOBILE_PLATFORM)
+  io::ZstdCompressionOptions zstd_options;
+#endif
 };
 
+class ZstdOutputBuffer;
+
 class RecordWriter {
  public:
   // Format of a single record:
@@ -89,6 +102,8 @@ class RecordWriter {
   Status Flush();
 
   // Writes all output to the file. Does *not* close the WritableFile.
+  // Files written with zstd_options.block_size > 0 get their block index
+  // appended here.
   //
   // After calling Close(), any further calls to `WriteRecord()` or `Flush()`
   // are invalid.
@@ -111,9 +126,20 @@ class RecordWriter {
 #endif
 
  private:
+  // Maintain the block index of files written with
+  // zstd_options.block_size > 0 around each record; no-ops otherwise.
+  Status MaybeStartBlock();
+  Status MaybeEndBlock(size_t data_size);
+
   WritableFile* dest_;
   RecordWriterOptions options_;
 
+  // Set iff blocks are indexed, in which case it aliases `dest_`.
+  ZstdOutputBuffer* zstd_blocks_ = nullptr;
+  RecordBlockIndex block_index_;
+  bool block_open_ = false;
+  int64_t block_bytes_ = 0;
+
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
   }
@@ -0,0 +1,55 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_COMPRESSION_OPTIONS_H_
+#define TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_COMPRESSION_OPTIONS_H_
+
+#include <string>
+
+#include "tensorflow/tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+struct ZstdCompressionOptions {
+  // Size of the buffer used for caching the data read from source file.
+  int64_t input_buffer_size = 256 << 10;
+
+  // Size of the sink buffer where the compressed/decompressed data produced by
+  // zstd is cached.
+  int64_t output_buffer_size = 256 << 10;
+
+  // Compression level. Levels 1 to 22 trade speed for ratio; negative levels
+  // are faster still. Ignored when decompressing.
+  int32 compression_level = 3;
+
+  // Optional dictionary, e.g. trained with `zstd --train` on sample records.
+  // Small records compress much better with a dictionary, but the same
+  // dictionary must be supplied when reading the data back.
+  std::string dictionary;
+
+  // If positive, RecordWriter ends the zstd frame at the first record
+  // boundary after every `block_size` uncompressed bytes, and appends an index
+  // of the frames to the file. Such files can still be read by RecordReader,
+  // and IndexedRecordReader can additionally seek to any record and decode
+  // blocks in parallel. Smaller blocks give finer-grained access at some cost
+  // in compression ratio.
+  int64_t block_size = 0;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_COMPRESSION_OPTIONS_H_
@@ -0,0 +1,192 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/zstd/zstd_inputstream.h"
+
+#include <zstd.h>
+
+#include <string>
+
+#include "tensorflow/tsl/platform/errors.h"
+
+namespace tsl {
+namespace io {
+
+struct ZstdStreamDef {
+  explicit ZstdStreamDef(size_t output_buffer_capacity)
+      : output(new char[output_buffer_capacity]) {}
+
+  ~ZstdStreamDef() { ZSTD_freeDCtx(context); }
+
+  ZSTD_DCtx* context = nullptr;
+
+  // Compressed contents of `input_stream_` not yet consumed by zstd start at
+  // `input[in.pos]`.
+  std::string input;
+  ZSTD_inBuffer in = {nullptr, 0, 0};
+
+  // Decompressed contents. Bytes `[output_pos, output_size)` have not been
+  // returned to the client yet.
+  std::unique_ptr<char[]> output;
+  size_t output_pos = 0;
+  size_t output_size = 0;
+};
+
+ZstdInputStream::ZstdInputStream(
+    InputStreamInterface* input_stream,
+    size_t input_buffer_bytes,   // size of the compressed input buffer
+    size_t output_buffer_bytes,  // size of the decompressed output buffer
+    const ZstdCompressionOptions& zstd_options, bool owns_input_stream)
+    : owns_input_stream_(owns_input_stream),
+      input_stream_(input_stream),
+      input_buffer_capacity_(input_buffer_bytes),
+      output_buffer_capacity_(output_buffer_bytes),
+      zstd_options_(zstd_options),
+      zstd_stream_def_(new ZstdStreamDef(output_buffer_bytes)),
+      bytes_read_(0) {
+  init_status_ = Init();
+}
+
+ZstdInputStream::ZstdInputStream(InputStreamInterface* input_stream,
+                                 size_t input_buffer_bytes,
+                                 size_t output_buffer_bytes,
+                                 const ZstdCompressionOptions& zstd_options)
+    : ZstdInputStream(input_stream, input_buffer_bytes, output_buffer_bytes,
+                      zstd_options, false) {}
+
+ZstdInputStream::~ZstdInputStream() {
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+Status ZstdInputStream::Init() {
+  if (input_buffer_capacity_ == 0 || output_buffer_capacity_ == 0) {
+    return errors::InvalidArgument(
+        "input_buffer_bytes and output_buffer_bytes should be positive");
+  }
+  zstd_stream_def_->context = ZSTD_createDCtx();
+  if (zstd_stream_def_->context == nullptr) {
+    return errors::ResourceExhausted("Unable to create zstd decompression "
+                                     "context.");
+  }
+  if (!zstd_options_.dictionary.empty()) {
+    size_t error = ZSTD_DCtx_loadDictionary(zstd_stream_def_->context,
+                                            zstd_options_.dictionary.data(),
+                                            zstd_options_.dictionary.size());
+    if (ZSTD_isError(error)) {
+      return errors::InvalidArgument("Unable to load zstd dictionary: ",
+                                     ZSTD_getErrorName(error));
+    }
+  }
+  return OkStatus();
+}
+
+Status ZstdInputStream::Reset() {
+  TF_RETURN_IF_ERROR(init_status_);
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
+  // Resetting the session only keeps the dictionary loaded.
+  ZSTD_DCtx_reset(zstd_stream_def_->context, ZSTD_reset_session_only);
+  zstd_stream_def_->input.clear();
+  zstd_stream_def_->in = {nullptr, 0, 0};
+  zstd_stream_def_->output_pos = 0;
+  zstd_stream_def_->output_size = 0;
+  bytes_read_ = 0;
+  return OkStatus();
+}
+
+Status ZstdInputStream::ReadFromStream() {
+  ZstdStreamDef* def = zstd_stream_def_.get();
+  // Drop the consumed prefix of the input buffer and append the next chunk
+  // of the compressed stream after any unconsumed bytes.
+  def->input.erase(0, def->in.pos);
+  tstring data;
+  Status s = input_stream_->ReadNBytes(input_buffer_capacity_, &data);
+  def->input.append(data.data(), data.size());
+  def->in = {def->input.data(), def->input.size(), 0};
+
+  if (!s.ok() && !errors::IsOutOfRange(s)) {
+    return s;
+  }
+  // We return OutOfRange error iff no new data has been read from stream.
+  if (data.empty()) {
+    return errors::OutOfRange("EOF reached");
+  }
+  return OkStatus();
+}
+
+Status ZstdInputStream::Decompress() {
+  ZstdStreamDef* def = zstd_stream_def_.get();
+  DCHECK_EQ(def->output_pos, def->output_size);
+  ZSTD_outBuffer out = {def->output.get(), output_buffer_capacity_, 0};
+  size_t error = ZSTD_decompressStream(def->context, &out, &def->in);
+  if (ZSTD_isError(error)) {
+    return errors::DataLoss("ZSTD_decompressStream() failed: ",
+                            ZSTD_getErrorName(error));
+  }
+  def->output_pos = 0;
+  def->output_size = out.pos;
+  return OkStatus();
+}
+
+size_t ZstdInputStream::ReadBytesFromCache(size_t bytes_to_read,
+                                           tstring* result) {
+  ZstdStreamDef* def = zstd_stream_def_.get();
+  size_t can_read_bytes =
+      std::min(bytes_to_read, def->output_size - def->output_pos);
+  if (can_read_bytes > 0) {
+    result->append(def->output.get() + def->output_pos, can_read_bytes);
+    def->output_pos += can_read_bytes;
+  }
+  bytes_read_ += can_read_bytes;
+  return can_read_bytes;
+}
+
+Status ZstdInputStream::ReadNBytes(int64_t bytes_to_read, tstring* result) {
+  TF_RETURN_IF_ERROR(init_status_);
+
+  result->clear();
+  // Read as many bytes as possible from cache.
+  bytes_to_read -= ReadBytesFromCache(bytes_to_read, result);
+
+  while (bytes_to_read > 0) {
+    // The cache is empty, so decompress more data. zstd either consumes all
+    // of its input or fills the output buffer, so if it produced nothing it
+    // needs more input.
+    TF_RETURN_IF_ERROR(Decompress());
+    if (zstd_stream_def_->output_size == 0) {
+      TF_RETURN_IF_ERROR(ReadFromStream());
+    } else {
+      bytes_to_read -= ReadBytesFromCache(bytes_to_read, result);
+    }
+  }
+
+  return OkStatus();
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status ZstdInputStream::ReadNBytes(int64_t bytes_to_read, absl::Cord* result) {
+  tstring buf;
+  TF_RETURN_IF_ERROR(ReadNBytes(bytes_to_read, &buf));
+  result->Clear();
+  result->Append(absl::string_view(buf.data(), buf.size()));
+  return OkStatus();
+}
+#endif
+
+int64_t ZstdInputStream::Tell() const { return bytes_read_; }
+
+}  // namespace io
+}  // namespace tsl
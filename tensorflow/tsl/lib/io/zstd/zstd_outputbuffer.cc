@@ -0,0 +1,192 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/zstd/zstd_outputbuffer.h"
+
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+
+namespace tsl {
+namespace io {
+
+ZstdOutputBuffer::ZstdOutputBuffer(WritableFile* file,
+                                   int32_t input_buffer_bytes,
+                                   int32_t output_buffer_bytes,
+                                   const ZstdCompressionOptions& zstd_options)
+    : file_(file),
+      input_buffer_capacity_(input_buffer_bytes),
+      output_buffer_capacity_(output_buffer_bytes),
+      zstd_options_(zstd_options),
+      output_buffer_(new char[output_buffer_bytes]) {
+  input_buffer_.reserve(input_buffer_capacity_);
+}
+
+ZstdOutputBuffer::~ZstdOutputBuffer() {
+  if (context_ != nullptr) {
+    LOG(WARNING) << "ZstdOutputBuffer::Close() not called. Possible data loss";
+    ZSTD_freeCCtx(context_);
+  }
+}
+
+Status ZstdOutputBuffer::Init() {
+  if (output_buffer_capacity_ == 0) {
+    return errors::InvalidArgument("output_buffer_bytes should be positive");
+  }
+  context_ = ZSTD_createCCtx();
+  if (context_ == nullptr) {
+    return errors::ResourceExhausted("Unable to create zstd compression "
+                                     "context.");
+  }
+  size_t error = ZSTD_CCtx_setParameter(context_, ZSTD_c_compressionLevel,
+                                        zstd_options_.compression_level);
+  // A checksum at the end of each frame lets the reader detect corruption
+  // that happens to still decode.
+  if (!ZSTD_isError(error)) {
+    error = ZSTD_CCtx_setParameter(context_, ZSTD_c_checksumFlag, 1);
+  }
+  if (!ZSTD_isError(error) && !zstd_options_.dictionary.empty()) {
+    error = ZSTD_CCtx_loadDictionary(context_, zstd_options_.dictionary.data(),
+                                     zstd_options_.dictionary.size());
+  }
+  if (ZSTD_isError(error)) {
+    ZSTD_freeCCtx(context_);
+    context_ = nullptr;
+    return errors::InvalidArgument("Unable to configure zstd compression: ",
+                                   ZSTD_getErrorName(error));
+  }
+  return OkStatus();
+}
+
+Status ZstdOutputBuffer::Compress(StringPiece data, ZSTD_EndDirective mode) {
+  if (context_ == nullptr) {
+    return errors::FailedPrecondition(
+        "ZstdOutputBuffer is not initialized or has been closed.");
+  }
+  if (data.empty() && !frame_open_) {
+    // Nothing to compress, and no frame to flush or end. Bail out so that
+    // no empty frame is started.
+    return OkStatus();
+  }
+  frame_open_ = true;
+  ZSTD_inBuffer in = {data.data(), data.size(), 0};
+  while (true) {
+    if (output_buffer_size_ == output_buffer_capacity_) {
+      TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+    }
+    ZSTD_outBuffer out = {output_buffer_.get(), output_buffer_capacity_,
+                          output_buffer_size_};
+    size_t remaining = ZSTD_compressStream2(context_, &out, &in, mode);
+    if (ZSTD_isError(remaining)) {
+      return errors::DataLoss("ZSTD_compressStream2() failed: ",
+                              ZSTD_getErrorName(remaining));
+    }
+    output_buffer_size_ = out.pos;
+    // For ZSTD_e_flush and ZSTD_e_end, `remaining` is the number of bytes
+    // zstd still has to write out.
+    if (mode == ZSTD_e_continue ? in.pos == in.size : remaining == 0) {
+      if (mode == ZSTD_e_end) frame_open_ = false;
+      return OkStatus();
+    }
+  }
+}
+
+Status ZstdOutputBuffer::CompressBuffered(ZSTD_EndDirective mode) {
+  Status s = Compress(input_buffer_, mode);
+  input_buffer_.clear();
+  return s;
+}
+
+Status ZstdOutputBuffer::FlushOutputBufferToFile() {
+  if (output_buffer_size_ > 0) {
+    TF_RETURN_IF_ERROR(
+        file_->Append(StringPiece(output_buffer_.get(), output_buffer_size_)));
+    compressed_bytes_written_ += output_buffer_size_;
+    output_buffer_size_ = 0;
+  }
+  return OkStatus();
+}
+
+Status ZstdOutputBuffer::Append(StringPiece data) {
+  // Small appends, such as the record headers and footers written by
+  // RecordWriter, are batched in `input_buffer_` before being handed to zstd.
+  if (data.size() <= input_buffer_capacity_ - input_buffer_.size()) {
+    input_buffer_.append(data.data(), data.size());
+    return OkStatus();
+  }
+  TF_RETURN_IF_ERROR(CompressBuffered(ZSTD_e_continue));
+  if (data.size() <= input_buffer_capacity_) {
+    input_buffer_.append(data.data(), data.size());
+    return OkStatus();
+  }
+  // `data` is too large to fit in the input buffer so we compress it
+  // directly.
+  return Compress(data, ZSTD_e_continue);
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status ZstdOutputBuffer::Append(const absl::Cord& cord) {
+  for (absl::string_view fragment : cord.Chunks()) {
+    TF_RETURN_IF_ERROR(Append(fragment));
+  }
+  return OkStatus();
+}
+#endif
+
+Status ZstdOutputBuffer::Flush() {
+  TF_RETURN_IF_ERROR(CompressBuffered(ZSTD_e_flush));
+  TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+  return file_->Flush();
+}
+
+Status ZstdOutputBuffer::EndFrame() {
+  return CompressBuffered(ZSTD_e_end);
+}
+
+Status ZstdOutputBuffer::AppendUncompressed(StringPiece data) {
+  if (frame_open_ || !input_buffer_.empty()) {
+    return errors::FailedPrecondition(
+        "AppendUncompressed() called in the middle of a zstd frame.");
+  }
+  TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+  TF_RETURN_IF_ERROR(file_->Append(data));
+  compressed_bytes_written_ += data.size();
+  return OkStatus();
+}
+
+Status ZstdOutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status ZstdOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status ZstdOutputBuffer::Close() {
+  if (context_ != nullptr) {
+    TF_RETURN_IF_ERROR(CompressBuffered(ZSTD_e_end));
+    TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+    ZSTD_freeCCtx(context_);
+    context_ = nullptr;
+  }
+  return OkStatus();
+}
+
+Status ZstdOutputBuffer::Tell(int64_t* position) {
+  return file_->Tell(position);
+}
+
+}  // namespace io
+}  // namespace tsl
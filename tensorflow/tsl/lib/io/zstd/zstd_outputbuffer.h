@@ -0,0 +1,149 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
+#define TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
+
+#include <zstd.h>
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/file_system.h"
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/stringpiece.h"
+#include "tensorflow/tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+// Provides support for writing compressed output to file using zstd
+// (https://facebook.github.io/zstd/).
+// A given instance of a ZstdOutputBuffer is NOT safe for concurrent use
+// by multiple threads
+class ZstdOutputBuffer : public WritableFile {
+ public:
+  // Create a ZstdOutputBuffer for `file` with two buffers that cache the
+  // 1. input data to be compressed
+  // 2. the compressed output
+  // with sizes `input_buffer_bytes` and `output_buffer_bytes` respectively.
+  // Does not take ownership of `file`.
+  ZstdOutputBuffer(WritableFile* file, int32_t input_buffer_bytes,
+                   int32_t output_buffer_bytes,
+                   const ZstdCompressionOptions& zstd_options);
+
+  ~ZstdOutputBuffer() override;
+
+  // Initializes some state necessary for the output buffer. This call is
+  // required before any other operation on the buffer.
+  Status Init();
+
+  // Adds `data` to the compression pipeline.
+  //
+  // The input data is buffered and is compressed in bulk when the buffer gets
+  // full. The compressed output is not immediately written to file but rather
+  // buffered and gets written to file when that buffer is full.
+  //
+  // To immediately write contents to file call `Flush()`.
+  Status Append(StringPiece data) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Compresses any cached input, ending the current zstd block, and writes
+  // all output to file.
+  Status Flush() override;
+
+  // Compresses any cached input, ends the zstd frame and writes all output to
+  // file. This must be called before the destructor to avoid any data loss.
+  //
+  // After calling this, any further calls to `Append()`, `Flush()` or
+  // `Sync()` will fail.
+  Status Close() override;
+
+  // Compresses any cached input and ends the current zstd frame. The next
+  // Append() starts a new frame, which can be decompressed independently of
+  // the data before it.
+  Status EndFrame();
+
+  // Writes `data` to the file as is. Must be called between frames, i.e.
+  // before any Append() or right after EndFrame(). Used to add zstd
+  // skippable frames, which decoders ignore.
+  Status AppendUncompressed(StringPiece data);
+
+  // Number of compressed bytes produced so far, including those not yet
+  // written to file. Between frames this is the offset of the next frame.
+  uint64 compressed_bytes() const {
+    return compressed_bytes_written_ + output_buffer_size_;
+  }
+
+  // Returns the name of the underlying file.
+  Status Name(StringPiece* result) const override;
+
+  // Compresses any cached input, writes all output to file and syncs it.
+  Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect buffered, un-flushed data.
+  Status Tell(int64_t* position) override;
+
+ private:
+  // Feeds `data` to zstd with the given end directive, writing compressed
+  // output to file whenever the output buffer fills up. With
+  // ZSTD_e_continue zstd may keep some of the data buffered internally; with
+  // ZSTD_e_flush or ZSTD_e_end everything is compressed into the output
+  // buffer.
+  Status Compress(StringPiece data, ZSTD_EndDirective mode);
+
+  // Compresses the contents of `input_buffer_` and empties it.
+  Status CompressBuffered(ZSTD_EndDirective mode);
+
+  // Appends the contents of `output_buffer_` to `file_`.
+  // Returns non-OK status if writing to file fails.
+  Status FlushOutputBufferToFile();
+
+  WritableFile* file_;  // Not owned
+  const size_t input_buffer_capacity_;
+  const size_t output_buffer_capacity_;
+  ZstdCompressionOptions const zstd_options_;
+
+  // Input not yet handed to zstd.
+  std::string input_buffer_;
+
+  // Compressed output not yet written to `file_`, of `output_buffer_size_`
+  // bytes.
+  std::unique_ptr<char[]> output_buffer_;
+  size_t output_buffer_size_ = 0;
+
+  // Bytes appended to `file_` so far.
+  uint64 compressed_bytes_written_ = 0;
+
+  // Whether zstd has been handed input of a frame that has not been ended.
+  bool frame_open_ = false;
+
+  // Null before Init() and after Close().
+  ZSTD_CCtx* context_ = nullptr;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ZstdOutputBuffer);
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
@@ -0,0 +1,173 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/lib/io/random_inputstream.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_inputstream.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_outputbuffer.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/strcat.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+string GenTestString(int copies = 1) {
+  string result;
+  for (int i = 0; i < copies; i++) {
+    strings::StrAppend(&result, "Record ", i % 97,
+                       ": lorem ipsum dolor sit amet, consectetur adipiscing "
+                       "elit. Fusce vehicula tincidunt libero sit amet.\n");
+  }
+  return result;
+}
+
+// Writes `num_writes` copies of `data` to `fname` through a ZstdOutputBuffer,
+// flushing after each write if `with_flush` is set.
+Status WriteCompressed(const string& fname, const string& data,
+                       size_t input_buf_size, size_t output_buf_size,
+                       int num_writes, bool with_flush,
+                       const ZstdCompressionOptions& options) {
+  std::unique_ptr<WritableFile> file_writer;
+  TF_RETURN_IF_ERROR(Env::Default()->NewWritableFile(fname, &file_writer));
+  ZstdOutputBuffer out(file_writer.get(), input_buf_size, output_buf_size,
+                       options);
+  TF_RETURN_IF_ERROR(out.Init());
+  for (int i = 0; i < num_writes; i++) {
+    TF_RETURN_IF_ERROR(out.Append(data));
+    if (with_flush) {
+      TF_RETURN_IF_ERROR(out.Flush());
+    }
+  }
+  TF_RETURN_IF_ERROR(out.Close());
+  return file_writer->Close();
+}
+
+// Reads `fname` back in chunks of `read_size` bytes until the end of the
+// stream and stores the decompressed contents in `result`.
+Status ReadCompressed(const string& fname, size_t input_buf_size,
+                      size_t output_buf_size, size_t read_size,
+                      const ZstdCompressionOptions& options, string* result) {
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_RETURN_IF_ERROR(Env::Default()->NewRandomAccessFile(fname, &file_reader));
+  std::unique_ptr<RandomAccessInputStream> input_stream(
+      new RandomAccessInputStream(file_reader.get()));
+  ZstdInputStream in(input_stream.get(), input_buf_size, output_buf_size,
+                     options);
+  result->clear();
+  tstring chunk;
+  while (true) {
+    Status s = in.ReadNBytes(read_size, &chunk);
+    result->append(chunk.data(), chunk.size());
+    if (errors::IsOutOfRange(s)) {
+      return OkStatus();
+    }
+    TF_RETURN_IF_ERROR(s);
+  }
+}
+
+void TestRoundTrip(size_t input_buf_size, size_t output_buf_size,
+                   size_t read_size, int num_writes, bool with_flush,
+                   const ZstdCompressionOptions& options = {}) {
+  const string fname = testing::TmpDir() + "/zstd_buffers_test";
+  const string data = GenTestString(100);
+  TF_ASSERT_OK(WriteCompressed(fname, data, input_buf_size, output_buf_size,
+                               num_writes, with_flush, options));
+  string result;
+  TF_ASSERT_OK(ReadCompressed(fname, input_buf_size, output_buf_size,
+                              read_size, options, &result));
+  string expected;
+  for (int i = 0; i < num_writes; i++) {
+    expected += data;
+  }
+  EXPECT_EQ(expected, result);
+}
+
+TEST(ZstdBuffers, MultipleWritesWithoutFlush) {
+  TestRoundTrip(10000, 10000, 1000, 5, false);
+}
+
+TEST(ZstdBuffers, MultipleWritesWithFlush) {
+  TestRoundTrip(10000, 10000, 1000, 5, true);
+}
+
+TEST(ZstdBuffers, TinyBuffers) { TestRoundTrip(1, 1, 7, 3, true); }
+
+TEST(ZstdBuffers, ReadsLargerThanBuffers) {
+  TestRoundTrip(100, 100, 50000, 3, false);
+}
+
+TEST(ZstdBuffers, Dictionary) {
+  ZstdCompressionOptions options;
+  options.dictionary = GenTestString(3);
+  options.compression_level = 19;
+  TestRoundTrip(10000, 10000, 1000, 2, true, options);
+}
+
+TEST(ZstdBuffers, MissingDictionary) {
+  const string fname = testing::TmpDir() + "/zstd_buffers_test_dict";
+  ZstdCompressionOptions options;
+  options.dictionary = GenTestString(3);
+  TF_ASSERT_OK(WriteCompressed(fname, GenTestString(10), 10000, 10000, 1,
+                               false, options));
+  string result;
+  Status s = ReadCompressed(fname, 10000, 10000, 1000, {}, &result);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+}
+
+TEST(ZstdBuffers, Corrupt) {
+  const string fname = testing::TmpDir() + "/zstd_buffers_test_corrupt";
+  const string data = GenTestString(100);
+  TF_ASSERT_OK(WriteCompressed(fname, data, 10000, 10000, 1, false, {}));
+  string compressed;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), fname, &compressed));
+  compressed[compressed.size() / 2] ^= 0x55;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), fname, compressed));
+  string result;
+  Status s = ReadCompressed(fname, 10000, 10000, 1000, {}, &result);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+}
+
+TEST(ZstdBuffers, TellAndReset) {
+  const string fname = testing::TmpDir() + "/zstd_buffers_test_tell";
+  const string data = GenTestString(100);
+  TF_ASSERT_OK(WriteCompressed(fname, data, 10000, 10000, 1, false, {}));
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file_reader));
+  std::unique_ptr<RandomAccessInputStream> input_stream(
+      new RandomAccessInputStream(file_reader.get()));
+  ZstdInputStream in(input_stream.get(), 100, 100, ZstdCompressionOptions());
+  tstring first;
+  TF_ASSERT_OK(in.ReadNBytes(1000, &first));
+  EXPECT_EQ(1000, in.Tell());
+  tstring second;
+  TF_ASSERT_OK(in.ReadNBytes(500, &second));
+  EXPECT_EQ(1500, in.Tell());
+  EXPECT_EQ(data.substr(1000, 500), second);
+
+  TF_ASSERT_OK(in.Reset());
+  EXPECT_EQ(0, in.Tell());
+  tstring again;
+  TF_ASSERT_OK(in.ReadNBytes(1000, &again));
+  EXPECT_EQ(first, again);
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
@@ -27,6 +27,8 @@ limitations under the License.
 #include <cstring>
 #include <fstream>
 #include <functional>
+#include <list>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -37,7 +39,9 @@ limitations under the License.
 #include <io.h>  // for _mktemp
 #endif
 #include "absl/base/macros.h"
+#include "absl/strings/match.h"
 #include "json/json.h"
+#include "tensorflow/tsl/platform/blocking_counter.h"
 #include "tensorflow/tsl/platform/cloud/curl_http_request.h"
 #include "tensorflow/tsl/platform/cloud/file_block_cache.h"
 #include "tensorflow/tsl/platform/cloud/google_auth_provider.h"
@@ -45,6 +49,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/cloud/time_util.h"
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/file_system_helper.h"
 #include "tensorflow/tsl/platform/mutex.h"
 #include "tensorflow/tsl/platform/numbers.h"
 #include "tensorflow/tsl/platform/path.h"
@@ -53,6 +58,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/str_util.h"
 #include "tensorflow/tsl/platform/stringprintf.h"
 #include "tensorflow/tsl/platform/thread_annotations.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 #include "tensorflow/tsl/profiler/lib/traceme.h"
 
 #ifdef _WIN32
@@ -94,6 +100,10 @@ constexpr uint64 kMatchingPathsCacheDefaultMaxAge = 0;
 constexpr char kMatchingPathsCacheMaxEntries[] =
     "GCS_MATCHING_PATHS_CACHE_MAX_ENTRIES";
 constexpr size_t kMatchingPathsCacheDefaultMaxEntries = 1024;
+// The environment variable that overrides the maximum number of list requests
+// GetMatchingPaths sends in parallel.
+constexpr char kListParallelism[] = "GCS_LIST_PARALLELISM";
+constexpr int32_t kListParallelismDefault = 16;
 // Number of bucket locations cached, most workloads wont touch more than one
 // bucket so this limit is set fairly low
 constexpr size_t kBucketLocationCacheMaxEntries = 10;
@@ -183,31 +193,6 @@ string JoinGcsPath(const string& path, const string& subpath) {
   return strings::StrCat(MaybeAppendSlash(path), subpath);
 }
 
-/// \brief Returns the given paths appending all their subfolders.
-///
-/// For every path X in the list, every subfolder in X is added to the
-/// resulting list.
-/// For example:
-///  - for 'a/b/c/d' it will append 'a', 'a/b' and 'a/b/c'
-///  - for 'a/b/c/' it will append 'a', 'a/b' and 'a/b/c'
-///  - for 'a//b/c/' it will append 'a', 'a//b' and 'a//b/c'
-///  - for '/a/b/c/' it will append '/a', '/a/b' and '/a/b/c'
-std::set<string> AddAllSubpaths(const std::vector<string>& paths) {
-  std::set<string> result;
-  result.insert(paths.begin(), paths.end());
-  for (const string& path : paths) {
-    StringPiece subpath = io::Dirname(path);
-    // If `path` starts with `/`, `subpath` will be `/` and then we get into an
-    // infinite loop. Same behavior happens if there is a `//` pattern in
-    // `path`, so we check for that and leave the loop quicker.
-    while (!(subpath.empty() || subpath == "/")) {
-      result.emplace(string(subpath));
-      subpath = io::Dirname(subpath);
-    }
-  }
-  return result;
-}
-
 Status ParseJson(StringPiece json, Json::Value* result) {
   Json::Reader reader;
   if (!reader.parse(json.data(), json.data() + json.size(), *result)) {
@@ -276,6 +261,119 @@ Status GetBoolValue(const Json::Value& parent, const char* name, bool* result) {
   return OkStatus();
 }
 
+/// A range of object names that is listed by one sequence of paginated list
+/// requests.
+struct ObjectNameRange {
+  // The names are in [start_offset, end_offset), an empty offset is unbounded.
+  string start_offset;
+  string end_offset;
+  // Whether the object named 'start_offset' was listed by the previous range.
+  bool skip_start = false;
+  // The page token of the next request, empty once the range is listed.
+  string page_token;
+  // The number of pages listed so far, and the names of the last page.
+  int num_pages = 0;
+  string page_first;
+  string page_last;
+  std::vector<string> names;
+};
+
+/// Returns the characters following 'c' in its class of digits, lowercase or
+/// uppercase letters, or an empty string for other characters.
+string CharsAfter(char c) {
+  char last;
+  if (c >= '0' && c <= '9') {
+    last = '9';
+  } else if (c >= 'a' && c <= 'z') {
+    last = 'z';
+  } else if (c >= 'A' && c <= 'Z') {
+    last = 'Z';
+  } else {
+    return "";
+  }
+  string result;
+  for (char next = c + 1; next <= last; ++next) result.push_back(next);
+  return result;
+}
+
+/// \brief Returns the names at which the objects after 'last' are split into
+/// ranges that are listed in parallel.
+///
+/// 'first' and 'last' are the first and last names of a page. Object names
+/// are usually numbered, e.g. 'train-00000-of-01024', so names with the same
+/// characters as 'last' up to some position, but a larger digit or letter at
+/// that position, are likely to exist. The position is the last one at which
+/// such a name can be formed, starting from the first character in which
+/// 'first' and 'last' differ, but not before 'min_size' (the object prefix).
+/// For example after the page 'train-00000' .. 'train-00999' the remaining
+/// names are split at 'train-01' .. 'train-09'.
+std::vector<string> ListSplitPoints(StringPiece first, StringPiece last,
+                                    size_t min_size, StringPiece end_offset) {
+  std::vector<string> splits;
+  size_t common = 0;
+  while (common < first.size() && common < last.size() &&
+         first[common] == last[common]) {
+    ++common;
+  }
+  for (size_t i = std::min(common + 1, last.size()); i > min_size; --i) {
+    const string chars = CharsAfter(last[i - 1]);
+    if (chars.empty()) continue;
+    for (char c : chars) {
+      string split = strings::StrCat(last.substr(0, i - 1), string(1, c));
+      // Larger characters only give larger names.
+      if (!end_offset.empty() && split >= end_offset) break;
+      splits.push_back(std::move(split));
+    }
+    break;
+  }
+  return splits;
+}
+
+/// Parses a page of the response to an object list request into 'range'.
+Status ParseListPage(const std::vector<char>& output_buffer,
+                     const string& object_prefix, ObjectNameRange* range) {
+  Json::Value root;
+  TF_RETURN_IF_ERROR(ParseJson(output_buffer, &root));
+  const size_t page_start = range->names.size();
+  const auto items = root.get("items", Json::Value::null);
+  if (!items.isNull()) {
+    if (!items.isArray()) {
+      return errors::Internal("Expected an array 'items' in the GCS response.");
+    }
+    for (size_t i = 0; i < items.size(); i++) {
+      const auto item = items.get(i, Json::Value::null);
+      if (!item.isObject()) {
+        return errors::Internal(
+            "Unexpected JSON format: 'items' should be a list of objects.");
+      }
+      string name;
+      TF_RETURN_IF_ERROR(GetStringValue(item, "name", &name));
+      if (!absl::StartsWith(name, object_prefix)) {
+        return errors::Internal(strings::StrCat(
+            "Unexpected response: the returned file name ", name,
+            " doesn't match the prefix ", object_prefix));
+      }
+      if (range->skip_start && name == range->start_offset) continue;
+      range->names.push_back(std::move(name));
+    }
+  }
+  ++range->num_pages;
+  if (range->names.size() > page_start) {
+    range->page_first = range->names[page_start];
+    range->page_last = range->names.back();
+  }
+  range->page_token.clear();
+  const auto token = root.get("nextPageToken", Json::Value::null);
+  if (!token.isNull()) {
+    if (!token.isString()) {
+      return errors::Internal(
+          "Unexpected response: nextPageToken is not a string");
+    }
+    range->page_token = token.asString();
+  }
+  return OkStatus();
+}
+
 /// Get GCS Retry Config by applying user overrides through env if any.
 RetryConfig GetGcsRetryConfig() {
   RetryConfig retryConfig(
@@ -846,12 +944,19 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &value)) {
     max_staleness = value;
   }
+  if (GetEnvVar(kReadaheadMaxBlocks, strings::safe_strtou64, &value)) {
+    readahead_max_blocks_ = value;
+  }
+  if (GetEnvVar(kReadaheadMaxSize, strings::safe_strtou64, &value)) {
+    readahead_max_bytes_ = value * 1024 * 1024;
+  }
   if (!make_default_cache) {
     max_bytes = 0;
   }
   VLOG(1) << "GCS cache max size = " << max_bytes << " ; "
           << "block size = " << block_size_ << " ; "
-          << "max staleness = " << max_staleness;
+          << "max staleness = " << max_staleness << " ; "
+          << "readahead blocks = " << readahead_max_blocks_;
   file_block_cache_ = MakeFileBlockCache(block_size_, max_bytes, max_staleness);
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
@@ -878,6 +983,9 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   }
   matching_paths_cache_.reset(new ExpiringLRUCache<std::vector<string>>(
       matching_paths_cache_max_age, matching_paths_cache_max_entries));
+  int32_t list_parallelism = kListParallelismDefault;
+  GetEnvVar(kListParallelism, strings::safe_strto32, &list_parallelism);
+  SetListParallelism(list_parallelism);
 
   bucket_location_cache_.reset(new ExpiringLRUCache<string>(
       kCacheNeverExpire, kBucketLocationCacheMaxEntries));
@@ -1003,6 +1111,13 @@ GcsFileSystem::GcsFileSystem(
       compose_append_(compose_append),
       additional_header_(additional_header) {}
 
+GcsFileSystem::~GcsFileSystem() {
+  // The readahead of the block cache loads blocks through this object, so
+  // wait for it before the members that it uses are destroyed.
+  mutex_lock l(block_cache_lock_);
+  file_block_cache_.reset();
+}
+
 Status GcsFileSystem::NewRandomAccessFile(
     const string& fname, TransactionToken* token,
     std::unique_ptr<RandomAccessFile>* result) {
@@ -1081,7 +1196,8 @@ std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      Env::Default(), readahead_max_blocks_, readahead_max_bytes_));
 
   // Check if cache is enabled here to avoid unnecessary mutex contention.
   cache_enabled_ = file_block_cache->IsCacheEnabled();
@@ -1674,42 +1790,33 @@ Status GcsFileSystem::GetChildren(const string& dirname,
 Status GcsFileSystem::GetMatchingPaths(const string& pattern,
                                        TransactionToken* token,
                                        std::vector<string>* results) {
+  // Lists the objects below `dir` starting with `name_prefix` with a single
+  // prefix listing, instead of listing every directory level of the pattern.
+  internal::ListPrefixFunc list_prefix = [this](const string& dir,
+                                                const string& name_prefix,
+                                                std::vector<string>* children) {
+    string bucket, object_prefix;
+    TF_RETURN_IF_ERROR(
+        ParseGcsPath(MaybeAppendSlash(dir), true, &bucket, &object_prefix));
+    std::vector<string> names;
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(
+        ListObjects(bucket, strings::StrCat(object_prefix, name_prefix),
+                    &names),
+        " when reading ", dir);
+    for (const string& name : names) {
+      // The names should be relative to the 'dir', and the self directory
+      // marker of 'dir' is not a child.
+      if (name.size() > object_prefix.size()) {
+        children->push_back(name.substr(object_prefix.size()));
+      }
+    }
+    return OkStatus();
+  };
   MatchingPathsCache::ComputeFunc compute_func =
-      [this](const string& pattern, std::vector<string>* results) {
-        results->clear();
-        // Find the fixed prefix by looking for the first wildcard.
-        const string& fixed_prefix =
-            pattern.substr(0, pattern.find_first_of("*?[\\"));
-        const string dir(this->Dirname(fixed_prefix));
-        if (dir.empty()) {
-          return errors::InvalidArgument(
-              "A GCS pattern doesn't have a bucket name: ", pattern);
-        }
-        std::vector<string> all_files;
-        TF_RETURN_IF_ERROR(GetChildrenBounded(
-            dir, UINT64_MAX, &all_files, true /* recursively */,
-            false /* include_self_directory_marker */));
-
-        const auto& files_and_folders = AddAllSubpaths(all_files);
-
-        // To handle `/` in the object names, we need to remove it from `dir`
-        // and then use `StrCat` to insert it back.
-        const StringPiece dir_no_slash = str_util::StripSuffix(dir, "/");
-
-        // Match all obtained paths to the input pattern.
-        for (const auto& path : files_and_folders) {
-          // Manually construct the path instead of using `JoinPath` for the
-          // cases where `path` starts with a `/` (which is a valid character in
-          // the filenames of GCS objects). `JoinPath` canonicalizes the result,
-          // removing duplicate slashes. We know that `dir_no_slash` does not
-          // end in `/`, so we are safe inserting the new `/` here as the path
-          // separator.
-          const string full_path = strings::StrCat(dir_no_slash, "/", path);
-          if (this->Match(full_path, pattern)) {
-            results->push_back(full_path);
-          }
-        }
-        return OkStatus();
+      [this, &list_prefix](const string& pattern,
+                           std::vector<string>* results) {
+        return internal::GetMatchingPathsByPrefix(this, pattern, list_prefix,
+                                                  results);
       };
   TF_RETURN_IF_ERROR(
       matching_paths_cache_->LookupOrCompute(pattern, results, compute_func));
@@ -1833,6 +1940,115 @@ Status GcsFileSystem::GetChildrenBounded(const string& dirname,
   }
 }
 
+Status GcsFileSystem::ListObjects(const string& bucket,
+                                  const string& object_prefix,
+                                  std::vector<string>* names) {
+  // The ranges partition the names, in order.
+  std::list<ObjectNameRange> ranges(1);
+  std::vector<std::list<ObjectNameRange>::iterator> pending = {ranges.begin()};
+  std::unique_ptr<thread::ThreadPool> pool;
+  if (list_parallelism_ > 1) {
+    pool = std::make_unique<thread::ThreadPool>(Env::Default(), "gcs_list",
+                                                list_parallelism_);
+  }
+  while (!pending.empty()) {
+    // Requests the next page of every pending range. The requests are created
+    // in order on this thread and only sent in parallel.
+    const size_t num_requests = pending.size();
+    std::vector<std::unique_ptr<HttpRequest>> requests(num_requests);
+    std::vector<std::vector<char>> output_buffers(num_requests);
+    for (size_t i = 0; i < num_requests; ++i) {
+      TF_RETURN_IF_ERROR(CreateHttpRequest(&requests[i]));
+      HttpRequest* request = requests[i].get();
+      const ObjectNameRange& range = *pending[i];
+      string uri = strings::StrCat(kGcsUriBase, "b/", bucket,
+                                   "/o?fields=items%2Fname%2CnextPageToken");
+      if (!object_prefix.empty()) {
+        strings::StrAppend(&uri,
+                           "&prefix=", request->EscapeString(object_prefix));
+      }
+      if (!range.start_offset.empty()) {
+        strings::StrAppend(&uri, "&startOffset=",
+                           request->EscapeString(range.start_offset));
+      }
+      if (!range.end_offset.empty()) {
+        strings::StrAppend(&uri, "&endOffset=",
+                           request->EscapeString(range.end_offset));
+      }
+      if (!range.page_token.empty()) {
+        strings::StrAppend(&uri, "&pageToken=",
+                           request->EscapeString(range.page_token));
+      }
+      request->SetUri(uri);
+      request->SetResultBuffer(&output_buffers[i]);
+      request->SetTimeouts(timeouts_.connect, timeouts_.idle,
+                           timeouts_.metadata);
+    }
+    std::vector<Status> statuses(num_requests);
+    auto send_request = [&](size_t i) {
+      statuses[i] = requests[i]->Send();
+      if (statuses[i].ok()) {
+        statuses[i] =
+            ParseListPage(output_buffers[i], object_prefix, &*pending[i]);
+      }
+    };
+    if (pool != nullptr && num_requests > 1) {
+      BlockingCounter counter(num_requests);
+      for (size_t i = 0; i < num_requests; ++i) {
+        pool->Schedule([&send_request, &counter, i] {
+          send_request(i);
+          counter.DecrementCount();
+        });
+      }
+      counter.Wait();
+    } else {
+      for (size_t i = 0; i < num_requests; ++i) send_request(i);
+    }
+    for (const Status& status : statuses) TF_RETURN_IF_ERROR(status);
+
+    // Continues the ranges with more pages. A range that has more than one
+    // page is split after its first page when running in parallel.
+    std::vector<std::list<ObjectNameRange>::iterator> next_pending;
+    for (auto it : pending) {
+      if (it->page_token.empty()) continue;
+      std::vector<string> splits;
+      if (pool != nullptr && it->num_pages == 1 && !it->page_last.empty()) {
+        splits = ListSplitPoints(it->page_first, it->page_last,
+                                 object_prefix.size(), it->end_offset);
+      }
+      if (splits.empty()) {
+        next_pending.push_back(it);
+        continue;
+      }
+      VLOG(1) << "Listing gs://" << bucket << "/" << object_prefix
+              << " after " << it->page_last << " in " << splits.size() + 1
+              << " ranges";
+      // The split range is done, the rest of its names are listed by the new
+      // ranges inserted after it.
+      auto next = std::next(it);
+      ObjectNameRange rest;
+      rest.start_offset = it->page_last;
+      rest.skip_start = true;
+      rest.end_offset = splits.front();
+      next_pending.push_back(ranges.insert(next, std::move(rest)));
+      for (size_t i = 0; i < splits.size(); ++i) {
+        ObjectNameRange split;
+        split.start_offset = splits[i];
+        split.end_offset =
+            i + 1 < splits.size() ? splits[i + 1] : it->end_offset;
+        next_pending.push_back(ranges.insert(next, std::move(split)));
+      }
+      it->page_token.clear();
+    }
+    pending = std::move(next_pending);
+  }
+  for (ObjectNameRange& range : ranges) {
+    names->insert(names->end(), std::make_move_iterator(range.names.begin()),
+                  std::make_move_iterator(range.names.end()));
+  }
+  return OkStatus();
+}
+
 Status GcsFileSystem::Stat(const string& fname, TransactionToken* token,
                            FileStatistics* stat) {
   if (!stat) {
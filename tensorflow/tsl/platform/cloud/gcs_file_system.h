@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_PLATFORM_CLOUD_GCS_FILE_SYSTEM_H_
 #define TENSORFLOW_TSL_PLATFORM_CLOUD_GCS_FILE_SYSTEM_H_
 
+#include <algorithm>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -62,6 +63,14 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that sets the maximum number of blocks fetched in
+// parallel ahead of sequential reads through the block cache. A value of 0
+// (the default) disables readahead.
+constexpr char kReadaheadMaxBlocks[] = "GCS_READ_CACHE_READAHEAD_BLOCKS";
+// The environment variable that overrides the maximum number of bytes fetched
+// ahead of sequential reads of all files at once. Specified in MB. Defaults
+// to the size of GCS_READ_CACHE_READAHEAD_BLOCKS blocks.
+constexpr char kReadaheadMaxSize[] = "GCS_READ_CACHE_READAHEAD_MAX_SIZE_MB";
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -142,6 +151,8 @@ class GcsFileSystem : public FileSystem {
                 std::pair<const string, const string>* additional_header,
                 bool compose_append);
 
+  ~GcsFileSystem() override;
+
   TF_USE_FILESYSTEM_METHODS_WITH_NO_TRANSACTION_SUPPORT;
 
   Status NewRandomAccessFile(
@@ -195,6 +206,12 @@ class GcsFileSystem : public FileSystem {
   /// Set an object to collect file block cache stats.
   void SetCacheStats(FileBlockCacheStatsInterface* cache_stats);
 
+  /// Set the maximum number of list requests GetMatchingPaths sends in
+  /// parallel. With 1, large listings are paginated sequentially.
+  void SetListParallelism(int list_parallelism) {
+    list_parallelism_ = std::max(list_parallelism, 1);
+  }
+
   /// These accessors are mainly for testing purposes, to verify that the
   /// environment variables that control these parameters are handled correctly.
   size_t block_size() {
@@ -394,6 +411,15 @@ class GcsFileSystem : public FileSystem {
                             std::vector<string>* result, bool recursively,
                             bool include_self_directory_marker);
 
+  /// \brief Lists the names of all objects in 'bucket' starting with
+  /// 'object_prefix', in lexicographic order.
+  ///
+  /// Once a listing turns out to span several pages, the remaining names are
+  /// split into ranges that are paginated concurrently, using up to
+  /// 'list_parallelism_' requests in flight.
+  Status ListObjects(const string& bucket, const string& object_prefix,
+                     std::vector<string>* names);
+
   /// Retrieves file statistics assuming fname points to a GCS object. The data
   /// may be read from cache or from GCS directly.
   Status StatForObject(const string& fname, const string& bucket,
@@ -415,6 +441,13 @@ class GcsFileSystem : public FileSystem {
   // Reads smaller than block_size_ will trigger a read of block_size_.
   uint64 block_size_;
 
+  // The readahead limits of the block cache.
+  size_t readahead_max_blocks_ = 0;
+  size_t readahead_max_bytes_ = 0;
+
+  // The maximum number of concurrent list requests of ListObjects.
+  int list_parallelism_ = 1;
+
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
@@ -15,13 +15,23 @@ limitations under the License.
 
 #include "tensorflow/tsl/platform/cloud/ram_file_block_cache.h"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/cleanup/cleanup.h"
 #include "tensorflow/tsl/platform/env.h"
 
 namespace tsl {
+namespace {
+
+// The maximum number of files whose readahead state is kept. The state of all
+// the files is dropped when a new file would exceed it.
+constexpr size_t kMaxReadaheadFiles = 1024;
+
+}  // namespace
 
 bool RamFileBlockCache::BlockNotStale(const std::shared_ptr<Block>& block) {
   mutex_lock l(block->mu);
@@ -80,16 +90,20 @@ Status RamFileBlockCache::UpdateLRU(const Key& key,
     lru_list_.push_front(key);
     block->lru_iterator = lru_list_.begin();
   }
+  block->prefetched = false;
 
   // Check for inconsistent state. If there is a block later in the same file
   // in the cache, and our current block is not block size, this likely means
-  // we have inconsistent state within the cache. Note: it's possible some
-  // incomplete reads may still go undetected.
+  // we have inconsistent state within the cache. Blocks that readahead added
+  // past the end of the file and that were never read do not count. Note:
+  // it's possible some incomplete reads may still go undetected.
   if (block->data.size() < block_size_) {
     Key fmax = std::make_pair(key.first, std::numeric_limits<size_t>::max());
     auto fcmp = block_map_.upper_bound(fmax);
-    if (fcmp != block_map_.begin() && key < (--fcmp)->first) {
-      return errors::Internal("Block cache contents are inconsistent.");
+    while (fcmp != block_map_.begin() && key < (--fcmp)->first) {
+      if (!fcmp->second->prefetched) {
+        return errors::Internal("Block cache contents are inconsistent.");
+      }
     }
   }
 
@@ -111,7 +125,8 @@ Status RamFileBlockCache::MaybeFetch(const Key& key,
           if (block->timestamp != 0) {
             // Use capacity() instead of size() to account for all  memory
             // used by the cache.
-            cache_size_ += block->data.capacity();
+            block->cached_bytes = block->data.capacity();
+            cache_size_ += block->cached_bytes;
             // Put to beginning of LRA list.
             lra_list_.erase(block->lra_iterator);
             lra_list_.push_front(key);
@@ -185,6 +200,10 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     finish += block_size_;
   }
   size_t total_bytes_transferred = 0;
+  // Whether a block was not ready yet, and the end of the file if we see it,
+  // for readahead.
+  bool waited = false;
+  size_t eof = std::numeric_limits<size_t>::max();
   // Now iterate through the blocks, reading them one at a time.
   for (size_t pos = start; pos < finish; pos += block_size_) {
     Key key = std::make_pair(filename, pos);
@@ -192,6 +211,10 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     // LRU iterator for the key and block.
     std::shared_ptr<Block> block = Lookup(key);
     DCHECK(block) << "No block for key " << key.first << "@" << key.second;
+    if (readahead_pool_ != nullptr && !waited) {
+      mutex_lock l(block->mu);
+      waited = block->state != FetchState::FINISHED;
+    }
     TF_RETURN_IF_ERROR(MaybeFetch(key, block));
     TF_RETURN_IF_ERROR(UpdateLRU(key, block));
     // Copy the relevant portion of the block into the result buffer.
@@ -222,13 +245,99 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     }
     if (data.size() < block_size_) {
       // The block was a partial block and thus signals EOF at its upper bound.
+      eof = pos + data.size();
       break;
     }
   }
   *bytes_transferred = total_bytes_transferred;
+  if (readahead_pool_ != nullptr) {
+    MaybeReadahead(filename, start, finish, waited, eof);
+  }
   return OkStatus();
 }
 
+void RamFileBlockCache::MaybeReadahead(const string& filename, size_t start,
+                                       size_t finish, bool waited,
+                                       size_t eof) {
+  // Keep the readahead window within half of the cache, so that prefetched
+  // blocks do not evict each other before they are read.
+  const size_t max_window =
+      std::min(max_readahead_blocks_, max_bytes_ / (2 * block_size_));
+  std::vector<std::pair<Key, std::shared_ptr<Block>>> prefetches;
+  {
+    mutex_lock lock(mu_);
+    if (readahead_.size() >= kMaxReadaheadFiles &&
+        readahead_.find(filename) == readahead_.end()) {
+      readahead_.clear();
+    }
+    Readahead& state = readahead_[filename];
+    state.eof = std::min(state.eof, eof);
+    if (start == state.next_offset) {
+      // The read continues the previous one. Grow the window if readahead did
+      // not keep up with it.
+      if (waited || state.window == 0) {
+        state.window = std::min(std::max<size_t>(1, 2 * state.window),
+                                max_window);
+      }
+    } else if (start != state.last_offset) {
+      // Random access: stop reading ahead. Reads that stay within the blocks
+      // of the previous read keep the window.
+      state.window = 0;
+    }
+    state.last_offset = start;
+    state.next_offset = finish;
+    size_t pos = finish;
+    for (size_t i = 0; i < state.window && pos < state.eof;
+         ++i, pos += block_size_) {
+      Key key = std::make_pair(filename, pos);
+      if (block_map_.find(key) != block_map_.end()) {
+        continue;
+      }
+      if (readahead_bytes_ + block_size_ > max_readahead_bytes_) {
+        break;
+      }
+      auto block = std::make_shared<Block>();
+      lru_list_.push_front(key);
+      lra_list_.push_front(key);
+      block->lru_iterator = lru_list_.begin();
+      block->lra_iterator = lra_list_.begin();
+      block->timestamp = env_->NowSeconds();
+      block->prefetched = true;
+      block_map_.emplace(key, block);
+      readahead_bytes_ += block_size_;
+      prefetches.emplace_back(std::move(key), std::move(block));
+    }
+  }
+  for (auto& prefetch : prefetches) {
+    readahead_pool_->Schedule(
+        [this, key = std::move(prefetch.first),
+         block = std::move(prefetch.second)] { Prefetch(key, block); });
+  }
+}
+
+void RamFileBlockCache::Prefetch(const Key& key,
+                                 const std::shared_ptr<Block>& block) {
+  // The fetch goes through the same fetcher as the reads, and thus through
+  // any throttling of the backing filesystem.
+  Status status = MaybeFetch(key, block);
+  mutex_lock lock(mu_);
+  readahead_bytes_ -= block_size_;
+  auto it = readahead_.find(key.first);
+  if (it != readahead_.end()) {
+    if (!status.ok()) {
+      // Back off, e.g. if the request was throttled. A read of the block
+      // fetches it again.
+      VLOG(1) << "Readahead of " << key.first << " @ " << key.second
+              << " failed: " << status;
+      it->second.window /= 2;
+    } else if (block->data.size() < block_size_) {
+      it->second.eof =
+          std::min(it->second.eof, key.second + block->data.size());
+    }
+  }
+  Trim();
+}
+
 bool RamFileBlockCache::ValidateAndUpdateFileSignature(const string& filename,
                                                        int64_t file_signature) {
   mutex_lock lock(mu_);
@@ -273,12 +382,14 @@ void RamFileBlockCache::Flush() {
   block_map_.clear();
   lru_list_.clear();
   lra_list_.clear();
+  readahead_.clear();
   cache_size_ = 0;
 }
 
 void RamFileBlockCache::RemoveFile(const string& filename) {
   mutex_lock lock(mu_);
   RemoveFile_Locked(filename);
+  readahead_.erase(filename);
 }
 
 void RamFileBlockCache::RemoveFile_Locked(const string& filename) {
@@ -297,7 +408,7 @@ void RamFileBlockCache::RemoveBlock(BlockMap::iterator entry) {
   entry->second->timestamp = 0;
   lru_list_.erase(entry->second->lru_iterator);
   lra_list_.erase(entry->second->lra_iterator);
-  cache_size_ -= entry->second->data.capacity();
+  cache_size_ -= entry->second->cached_bytes;
   block_map_.erase(entry);
 }
 
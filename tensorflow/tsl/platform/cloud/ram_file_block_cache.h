@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_TSL_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 
 #include <functional>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/stringpiece.h"
 #include "tensorflow/tsl/platform/thread_annotations.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 #include "tensorflow/tsl/platform/types.h"
 
 namespace tsl {
@@ -50,22 +52,42 @@ class RamFileBlockCache : public FileBlockCache {
                                size_t* bytes_transferred)>
       BlockFetcher;
 
+  /// If `max_readahead_blocks` is positive, sequential reads of a file also
+  /// fetch the blocks that follow in the background, so that several range
+  /// requests are in flight at a time. The readahead window of a file starts
+  /// at one block and doubles, up to `max_readahead_blocks`, every time a
+  /// sequential read still has to wait for a block. At most
+  /// `max_readahead_blocks` blocks are fetched in the background at once, and
+  /// at most `max_readahead_bytes` bytes (default: that many blocks) are in
+  /// flight for all the files sharing the cache.
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    size_t max_readahead_blocks = 0,
+                    size_t max_readahead_bytes = 0)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
-        env_(env) {
+        env_(env),
+        max_readahead_blocks_(max_readahead_blocks),
+        max_readahead_bytes_(max_readahead_bytes > 0
+                                 ? max_readahead_bytes
+                                 : max_readahead_blocks * block_size) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
     }
+    if (IsCacheEnabled() && max_readahead_blocks_ > 0) {
+      readahead_pool_ = std::make_unique<thread::ThreadPool>(
+          env_, "TF_readahead_FBC", max_readahead_blocks_);
+    }
     VLOG(1) << "GCS file block cache is "
             << (IsCacheEnabled() ? "enabled" : "disabled");
   }
 
   ~RamFileBlockCache() override {
+    // Destroying readahead_pool_ blocks until the background fetches finish.
+    readahead_pool_.reset();
     if (pruning_thread_) {
       stop_pruning_thread_.Notify();
       // Destroying pruning_thread_ will block until Prune() receives the above
@@ -131,6 +153,10 @@ class RamFileBlockCache : public FileBlockCache {
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
   Env* const env_;  // not owned
+  /// The maximum number of blocks fetched in the background at once.
+  const size_t max_readahead_blocks_;
+  /// The maximum number of bytes fetched in the background at once.
+  const size_t max_readahead_bytes_;
 
   /// \brief The key type for the file block cache.
   ///
@@ -158,10 +184,11 @@ class RamFileBlockCache : public FileBlockCache {
   /// was cached, a coordination lock, and state & condition variables.
   ///
   /// Thread safety:
-  /// The iterator and timestamp fields should only be accessed while holding
-  /// the block-cache-wide mu_ instance variable. The state variable should only
-  /// be accessed while holding the Block's mu lock. The data vector should only
-  /// be accessed after state == FINISHED, and it should never be modified.
+  /// The iterator, timestamp, prefetched and cached_bytes fields should only
+  /// be accessed while holding the block-cache-wide mu_ instance variable. The
+  /// state variable should only be accessed while holding the Block's mu lock.
+  /// The data vector should only be accessed after state == FINISHED, and it
+  /// should never be modified.
   ///
   /// In order to prevent deadlocks, never grab the block-cache-wide mu_ lock
   /// AFTER grabbing any block's mu lock. It is safe to grab mu without locking
@@ -175,6 +202,11 @@ class RamFileBlockCache : public FileBlockCache {
     std::list<Key>::iterator lra_iterator;
     /// The timestamp (seconds since epoch) at which the block was cached.
     uint64 timestamp;
+    /// True if the block was added by readahead and has not been read yet.
+    bool prefetched = false;
+    /// The number of bytes that the block adds to the cache size, which is
+    /// zero until its data has been fetched.
+    size_t cached_bytes = 0;
     /// Mutex to guard state variable
     mutex mu;
     /// The state of the block.
@@ -188,6 +220,18 @@ class RamFileBlockCache : public FileBlockCache {
   /// The block map is an ordered map from Key to Block.
   typedef std::map<Key, std::shared_ptr<Block>> BlockMap;
 
+  /// \brief The readahead state of a file.
+  struct Readahead {
+    /// The block-aligned start of the last read of the file.
+    size_t last_offset = 0;
+    /// The offset that a sequential read of the file would start at.
+    size_t next_offset = 0;
+    /// The number of blocks to fetch ahead of a sequential read.
+    size_t window = 0;
+    /// The end of the file, if readahead has seen it.
+    size_t eof = std::numeric_limits<size_t>::max();
+  };
+
   /// Prune the cache by removing files with expired blocks.
   void Prune() TF_LOCKS_EXCLUDED(mu_);
 
@@ -200,6 +244,17 @@ class RamFileBlockCache : public FileBlockCache {
   Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
       TF_LOCKS_EXCLUDED(mu_);
 
+  /// Update the readahead state of `filename` after a read of the blocks in
+  /// [`start`, `finish`), and start fetching the blocks that follow if the
+  /// read was sequential. `waited` is true if the read had to fetch or wait
+  /// for a block, and `eof` is the end of the file if the read reached it.
+  void MaybeReadahead(const string& filename, size_t start, size_t finish,
+                      bool waited, size_t eof) TF_LOCKS_EXCLUDED(mu_);
+
+  /// Fetch a block in the background for readahead.
+  void Prefetch(const Key& key, const std::shared_ptr<Block>& block)
+      TF_LOCKS_EXCLUDED(mu_);
+
   /// Trim the block cache to make room for another entry.
   void Trim() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -221,6 +276,9 @@ class RamFileBlockCache : public FileBlockCache {
   /// Notification for stopping the cache pruning thread.
   Notification stop_pruning_thread_;
 
+  /// The threads fetching blocks for readahead, if readahead is enabled.
+  std::unique_ptr<thread::ThreadPool> readahead_pool_;
+
   /// Guards access to the block map, LRU list, and cached byte count.
   mutable mutex mu_;
 
@@ -243,6 +301,12 @@ class RamFileBlockCache : public FileBlockCache {
 
   // A filename->file_signature map.
   std::map<string, int64_t> file_signature_map_ TF_GUARDED_BY(mu_);
+
+  /// The readahead state of the files read sequentially.
+  std::map<string, Readahead> readahead_ TF_GUARDED_BY(mu_);
+
+  /// The number of bytes being fetched in the background.
+  size_t readahead_bytes_ TF_GUARDED_BY(mu_) = 0;
 };
 
 }  // namespace tsl
@@ -16,11 +16,13 @@ limitations under the License.
 #include "tensorflow/tsl/platform/cloud/ram_file_block_cache.h"
 
 #include <cstring>
+#include <map>
 
 #include "tensorflow/tsl/lib/core/status_test_util.h"
 #include "tensorflow/tsl/platform/blocking_counter.h"
 #include "tensorflow/tsl/platform/cloud/now_seconds_env.h"
 #include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/mutex.h"
 #include "tensorflow/tsl/platform/notification.h"
 #include "tensorflow/tsl/platform/test.h"
 
@@ -566,5 +568,71 @@ TEST(RamFileBlockCacheTest, Flush) {
   EXPECT_EQ(calls, 2);
 }
 
+TEST(RamFileBlockCacheTest, ReadaheadSequential) {
+  const size_t block_size = 16;
+  const size_t file_size = 3 * block_size + 8;
+  mutex mu;
+  std::map<size_t, int> fetches;
+  auto fetcher = [&mu, &fetches, file_size](
+                     const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    {
+      mutex_lock l(mu);
+      ++fetches[offset];
+    }
+    *bytes_transferred = offset < file_size ? std::min(n, file_size - offset)
+                                            : 0;
+    memset(buffer, 'x', *bytes_transferred);
+    return OkStatus();
+  };
+  {
+    RamFileBlockCache cache(block_size, 16 * block_size, 0, fetcher,
+                            Env::Default(), /*max_readahead_blocks=*/2);
+    std::vector<char> out;
+    for (size_t offset = 0; offset < file_size; offset += block_size) {
+      TF_EXPECT_OK(ReadCache(&cache, "", offset, block_size, &out));
+      EXPECT_EQ(out.size(), std::min(block_size, file_size - offset));
+    }
+    // The destructor waits for the background fetches.
+  }
+  // Every block of the file was fetched once, whether by readahead or by the
+  // read itself, and readahead stopped at the end of the file.
+  for (size_t offset = 0; offset < file_size; offset += block_size) {
+    EXPECT_EQ(fetches[offset], 1) << offset;
+  }
+  for (const auto& fetch : fetches) {
+    EXPECT_LE(fetch.first, file_size + block_size);
+    EXPECT_EQ(fetch.second, 1);
+  }
+}
+
+TEST(RamFileBlockCacheTest, ReadaheadStopsOnRandomAccess) {
+  const size_t block_size = 16;
+  mutex mu;
+  std::map<size_t, int> fetches;
+  auto fetcher = [&mu, &fetches](const string& filename, size_t offset,
+                                 size_t n, char* buffer,
+                                 size_t* bytes_transferred) {
+    {
+      mutex_lock l(mu);
+      ++fetches[offset];
+    }
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return OkStatus();
+  };
+  {
+    RamFileBlockCache cache(block_size, 16 * block_size, 0, fetcher,
+                            Env::Default(), /*max_readahead_blocks=*/4);
+    std::vector<char> out;
+    TF_EXPECT_OK(ReadCache(&cache, "", 0, block_size, &out));
+    TF_EXPECT_OK(ReadCache(&cache, "", 6 * block_size, block_size, &out));
+  }
+  // Only the first read was followed by readahead of the next block.
+  std::map<size_t, int> expected = {
+      {0, 1}, {block_size, 1}, {6 * block_size, 1}};
+  EXPECT_EQ(fetches, expected);
+}
+
 }  // namespace
 }  // namespace tsl
@@ -22,6 +22,13 @@ limitations under the License.
 
 #if defined(__linux__)
 #include <sys/sendfile.h>
+#include <sys/syscall.h>
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define TSL_POSIX_HAS_IO_URING 1
+#endif
+#endif
 #endif
 #include <sys/stat.h>
 #include <sys/time.h>
@@ -29,6 +36,10 @@ limitations under the License.
 #include <time.h>
 #include <unistd.h>
 
+#include <cstring>
+#include <memory>
+#include <vector>
+
 #include "tensorflow/tsl/platform/default/posix_file_system.h"
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
@@ -45,6 +56,213 @@ using ::tsl::errors::IOError;
 // 128KB of copy buffer
 constexpr size_t kPosixCopyFileBufferSize = 128 * 1024;
 
+#if defined(TSL_POSIX_HAS_IO_URING)
+namespace {
+
+// Returns true if ReadBatch() should go through io_uring. Set
+// TF_POSIX_USE_IO_URING=1 to enable it.
+bool UseIoUring() {
+  static const bool use_io_uring = [] {
+    const char* value = getenv("TF_POSIX_USE_IO_URING");
+    return value != nullptr &&
+           (strcmp(value, "1") == 0 || strcasecmp(value, "true") == 0);
+  }();
+  return use_io_uring;
+}
+
+// A minimal io_uring instance driven with raw system calls, so that no
+// liburing dependency is needed. Each thread owns its own ring, so no locking
+// is required.
+class IoUring {
+ public:
+  // Returns the ring of the calling thread, or nullptr if io_uring cannot be
+  // used on this system.
+  static IoUring* ForThisThread() {
+    thread_local std::unique_ptr<IoUring> ring;
+    thread_local bool failed = false;
+    if (ring == nullptr && !failed) {
+      auto new_ring = std::make_unique<IoUring>();
+      if (new_ring->Init()) {
+        ring = std::move(new_ring);
+      } else {
+        failed = true;
+      }
+    }
+    return ring.get();
+  }
+
+  IoUring() = default;
+  IoUring(const IoUring&) = delete;
+  IoUring& operator=(const IoUring&) = delete;
+
+  ~IoUring() {
+    if (sqes_ != nullptr) munmap(sqes_, sqes_size_);
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr) munmap(sq_ring_, sq_ring_size_);
+    if (ring_fd_ >= 0) close(ring_fd_);
+  }
+
+  // Performs `*requests` against `fd`, keeping up to kEntries reads in
+  // flight. Short reads are resubmitted for the remainder; reads that the
+  // kernel does not support through io_uring fall back to `file`.
+  void Read(const RandomAccessFile& file, int fd, const string& filename,
+            std::vector<RandomAccessFile::ReadRequest>* requests) {
+    std::vector<size_t> done(requests->size(), 0);
+    // Requests that still need a submission, used as a stack.
+    std::vector<uint32> pending;
+    pending.reserve(requests->size());
+    for (size_t i = requests->size(); i > 0; --i) {
+      RandomAccessFile::ReadRequest& request = (*requests)[i - 1];
+      request.status = OkStatus();
+      if (request.n > 0) {
+        pending.push_back(i - 1);
+      }
+    }
+    unsigned in_flight = 0;
+    unsigned unsubmitted = 0;
+    while (!pending.empty() || in_flight > 0) {
+      // Queue as many reads as the ring has room for.
+      unsigned tail = *sq_tail_;
+      while (!pending.empty() && in_flight < kEntries) {
+        const uint32 index = pending.back();
+        pending.pop_back();
+        RandomAccessFile::ReadRequest& request = (*requests)[index];
+        const unsigned slot = tail & *sq_mask_;
+        io_uring_sqe* sqe = &sqes_[slot];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64>(request.scratch + done[index]);
+        sqe->len = static_cast<uint32>(
+            std::min<size_t>(request.n - done[index], INT32_MAX));
+        sqe->off = request.offset + done[index];
+        sqe->user_data = index;
+        sq_array_[slot] = slot;
+        ++tail;
+        ++in_flight;
+        ++unsubmitted;
+      }
+      __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+      const long r = syscall(__NR_io_uring_enter, ring_fd_, unsubmitted, 1,
+                             IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (r >= 0) {
+        unsubmitted -= static_cast<unsigned>(r);
+      } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+        // The ring was set up successfully, so this is not expected. Reads
+        // already submitted may still write into the callers' buffers, so
+        // returning here would not be safe.
+        LOG(FATAL) << "io_uring_enter() failed: " << strerror(errno);
+      }
+
+      // Reap all available completions.
+      unsigned head = *cq_head_;
+      const unsigned cq_tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      for (; head != cq_tail; ++head) {
+        const io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+        const uint32 index = static_cast<uint32>(cqe.user_data);
+        RandomAccessFile::ReadRequest& request = (*requests)[index];
+        --in_flight;
+        if (cqe.res > 0) {
+          done[index] += cqe.res;
+          if (done[index] < request.n) pending.push_back(index);
+        } else if (cqe.res == 0) {
+          request.status =
+              Status(error::OUT_OF_RANGE, "Read less bytes than requested");
+        } else if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+          pending.push_back(index);
+        } else if (cqe.res == -EINVAL || cqe.res == -EOPNOTSUPP) {
+          // Kernels before 5.6 have no IORING_OP_READ; read the remainder
+          // synchronously instead.
+          StringPiece rest;
+          request.status =
+              file.Read(request.offset + done[index], request.n - done[index],
+                        &rest, request.scratch + done[index]);
+          done[index] += rest.size();
+        } else {
+          request.status = IOError(filename, -cqe.res);
+        }
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    }
+    for (size_t i = 0; i < requests->size(); ++i) {
+      RandomAccessFile::ReadRequest& request = (*requests)[i];
+      request.result = StringPiece(request.scratch, done[i]);
+    }
+  }
+
+ private:
+  static constexpr unsigned kEntries = 64;
+
+  bool Init() {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd_ = static_cast<int>(
+        syscall(__NR_io_uring_setup, kEntries, &params));
+    if (ring_fd_ < 0) {
+      VLOG(1) << "io_uring unavailable, ReadBatch() falls back to pread(): "
+              << strerror(errno);
+      return false;
+    }
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = Map(sq_ring_size_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == nullptr) return false;
+    cq_ring_ = single_mmap ? sq_ring_ : Map(cq_ring_size_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == nullptr) return false;
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe*>(Map(sqes_size_, IORING_OFF_SQES));
+    if (sqes_ == nullptr) return false;
+
+    char* sq = static_cast<char*>(sq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    char* cq = static_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  void* Map(size_t size, off_t offset) {
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+    if (ptr == MAP_FAILED) {
+      VLOG(1) << "Mapping the io_uring ring failed: " << strerror(errno);
+      return nullptr;
+    }
+    return ptr;
+  }
+
+  int ring_fd_ = -1;
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_mask_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned* cq_mask_ = nullptr;
+  io_uring_cqe* cqes_ = nullptr;
+};
+
+}  // namespace
+#endif  // TSL_POSIX_HAS_IO_URING
+
 // pread() based random-access
 class PosixRandomAccessFile : public RandomAccessFile {
  private:
@@ -96,6 +314,17 @@ class PosixRandomAccessFile : public RandomAccessFile {
     return s;
   }
 
+#if defined(TSL_POSIX_HAS_IO_URING)
+  void ReadBatch(std::vector<ReadRequest>* requests) const override {
+    IoUring* ring = UseIoUring() ? IoUring::ForThisThread() : nullptr;
+    if (ring == nullptr || requests->size() < 2) {
+      RandomAccessFile::ReadBatch(requests);
+      return;
+    }
+    ring->Read(*this, fd_, filename_, requests);
+  }
+#endif
+
 #if defined(TF_CORD_SUPPORT)
   Status Read(uint64 offset, size_t n, absl::Cord* cord) const override {
     if (n == 0) {
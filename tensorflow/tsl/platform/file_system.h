@@ -765,6 +765,33 @@ class RandomAccessFile {
   virtual tsl::Status Read(uint64 offset, size_t n, StringPiece* result,
                            char* scratch) const = 0;
 
+  /// \brief One read issued through `ReadBatch()`.
+  ///
+  /// `offset`, `n` and `scratch` are as for `Read()`; `result` and `status`
+  /// are set to what `Read()` would have stored and returned.
+  struct ReadRequest {
+    uint64 offset = 0;
+    size_t n = 0;
+    char* scratch = nullptr;
+    StringPiece result;
+    tsl::Status status;
+  };
+
+  /// \brief Performs every read in `*requests`.
+  ///
+  /// Filesystems that can keep several reads in flight from a single thread
+  /// override this; the default implementation calls `Read()` for each
+  /// request in turn. The scratch buffers of distinct requests must not
+  /// overlap.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void ReadBatch(std::vector<ReadRequest>* requests) const {
+    for (ReadRequest& request : *requests) {
+      request.status = Read(request.offset, request.n, &request.result,
+                            request.scratch);
+    }
+  }
+
 #if defined(TF_CORD_SUPPORT)
   /// \brief Read up to `n` bytes from the file starting at `offset`.
   virtual tsl::Status Read(uint64 offset, size_t n, absl::Cord* cord) const {
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/file_system_helper.h"
 
 #include <deque>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -28,6 +29,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/platform.h"
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/str_util.h"
+#include "tensorflow/tsl/platform/strcat.h"
 #include "tensorflow/tsl/platform/threadpool.h"
 
 namespace tsl {
@@ -119,6 +121,31 @@ static inline int GetFirstGlobbingEntry(const std::vector<std::string>& dirs) {
   return i;
 }
 
+// Returns the given paths appending all their subfolders.
+//
+// For every path X in the list, every subfolder in X is added to the
+// resulting list.
+// For example:
+//  - for 'a/b/c/d' it will append 'a', 'a/b' and 'a/b/c'
+//  - for 'a/b/c/' it will append 'a', 'a/b' and 'a/b/c'
+//  - for 'a//b/c/' it will append 'a', 'a//b' and 'a//b/c'
+//  - for '/a/b/c/' it will append '/a', '/a/b' and '/a/b/c'
+static std::set<std::string> AddAllSubpaths(
+    const std::vector<std::string>& paths) {
+  std::set<std::string> result(paths.begin(), paths.end());
+  for (const std::string& path : paths) {
+    StringPiece subpath = io::Dirname(path);
+    // If `path` starts with `/`, `subpath` will be `/` and then we get into an
+    // infinite loop. Same behavior happens if there is a `//` pattern in
+    // `path`, so we check for that and leave the loop quicker.
+    while (!(subpath.empty() || subpath == "/")) {
+      result.emplace(subpath);
+      subpath = io::Dirname(subpath);
+    }
+  }
+  return result;
+}
+
 }  // namespace
 
 Status GetMatchingPaths(FileSystem* fs, Env* env, const string& pattern,
@@ -266,6 +293,50 @@ Status GetMatchingPaths(FileSystem* fs, Env* env, const string& pattern,
   return OkStatus();
 }
 
+Status GetMatchingPathsByPrefix(FileSystem* fs, const string& pattern,
+                                const ListPrefixFunc& list_prefix,
+                                std::vector<string>* results) {
+  if (fs == nullptr || results == nullptr) {
+    return errors::InvalidArgument(
+        "Filesystem calls GetMatchingPathsByPrefix with nullptr arguments");
+  }
+  results->clear();
+
+  // Find the fixed prefix by looking for the first wildcard. Everything that
+  // matches the pattern starts with it.
+  const string fixed_prefix =
+      pattern.substr(0, pattern.find_first_of(kGlobbingChars));
+  const string dir(fs->Dirname(fixed_prefix));
+  if (dir.empty()) {
+    return errors::InvalidArgument("A pattern doesn't have a directory: ",
+                                   pattern);
+  }
+  StringPiece name_prefix(fixed_prefix);
+  name_prefix.remove_prefix(dir.size());
+  str_util::ConsumePrefix(&name_prefix, "/");
+
+  std::vector<string> children;
+  TF_RETURN_IF_ERROR(list_prefix(dir, string(name_prefix), &children));
+
+  // To handle `/` in the file names, we need to remove it from `dir` and then
+  // use `StrCat` to insert it back.
+  const StringPiece dir_no_slash = str_util::StripSuffix(dir, "/");
+
+  // Match all obtained files and their directories to the input pattern.
+  for (const auto& path : AddAllSubpaths(children)) {
+    // Manually construct the path instead of using `JoinPath` for the cases
+    // where `path` starts with a `/` (which is a valid character in the names
+    // of objects). `JoinPath` canonicalizes the result, removing duplicate
+    // slashes. We know that `dir_no_slash` does not end in `/`, so we are safe
+    // inserting the new `/` here as the path separator.
+    const string full_path = strings::StrCat(dir_no_slash, "/", path);
+    if (fs->Match(full_path, pattern)) {
+      results->push_back(full_path);
+    }
+  }
+  return OkStatus();
+}
+
 StatusOr<bool> FileExists(Env* env, const string& fname) {
   Status status = env->FileExists(fname);
   if (errors::IsNotFound(status)) {
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_PLATFORM_FILE_SYSTEM_HELPER_H_
 #define TENSORFLOW_TSL_PLATFORM_FILE_SYSTEM_HELPER_H_
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -47,6 +48,34 @@ namespace internal {
 Status GetMatchingPaths(FileSystem* fs, Env* env, const string& pattern,
                         std::vector<string>* results);
 
+// Lists, in `children`, the paths relative to `dir` of all files below `dir`
+// (at any depth) whose relative path starts with `name_prefix`.
+using ListPrefixFunc = std::function<Status(const string& dir,
+                                            const string& name_prefix,
+                                            std::vector<string>* children)>;
+
+// Given a pattern, stores in 'results' the set of paths (in the given file
+// system) that match that pattern, like GetMatchingPaths() above.
+//
+// Instead of expanding the pattern directory by directory, this helper lists
+// all files whose path starts with the fixed (non-globbing) prefix of the
+// pattern with a single call to `list_prefix`, and matches the files and their
+// parent directories against the pattern. It may be used by implementations of
+// FileSystem::GetMatchingPaths() on object stores that can list by name prefix
+// natively, where directories are implicit and listing them one by one is slow.
+//
+// Arguments:
+//   fs: may not be null and will be used to split and match the paths.
+//   pattern: see FileSystem::GetMatchingPaths() for details.
+//   list_prefix: lists the files below the directory of the fixed prefix.
+//   results: will be cleared and may not be null.
+//
+// Returns an InvalidArgument error if the fixed prefix of `pattern` has no
+// directory, or the error returned by `list_prefix`.
+Status GetMatchingPathsByPrefix(FileSystem* fs, const string& pattern,
+                                const ListPrefixFunc& list_prefix,
+                                std::vector<string>* results);
+
 // Given a file path, determines whether the file exists. This helper simplifies
 // the use of Env::FileExists.
 //
@@ -17,6 +17,12 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+
 #include "absl/types/optional.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/tsl/platform/blocking_counter.h"
@@ -40,12 +46,79 @@ namespace tsl {
 
 namespace thread {
 
+// Execution statistics of a ThreadPool, updated by EigenEnvironment.
+struct ThreadPoolStatsRecorder {
+  static constexpr int kBins = ThreadPool::Stats::kNumHistogramBins;
+
+  ThreadPoolStatsRecorder(Env* env, const string& name, int num_threads)
+      : env(env),
+        name(name),
+        num_threads(num_threads),
+        start_micros(env->NowMicros()),
+        busy_time_usecs(new std::atomic<int64_t>[num_threads]) {
+    for (int i = 0; i < num_threads; ++i) busy_time_usecs[i] = 0;
+  }
+
+  static int HistogramBin(int64_t usecs) {
+    int bin = 0;
+    while (usecs > 0 && bin < kBins - 1) {
+      usecs >>= 1;
+      ++bin;
+    }
+    return bin;
+  }
+
+  Env* const env;
+  const string name;
+  const int num_threads;
+  const uint64 start_micros;
+  std::atomic<int> next_thread_index{0};
+  std::atomic<int64_t> queue_depth{0};
+  std::atomic<int64_t> tasks_completed{0};
+  std::atomic<int64_t> tasks_stolen{0};
+  std::atomic<int64_t> wait_time_histogram[kBins] = {};
+  std::atomic<int64_t> run_time_histogram[kBins] = {};
+  std::atomic<int64_t> total_wait_time_usecs{0};
+  std::atomic<int64_t> total_run_time_usecs{0};
+  std::unique_ptr<std::atomic<int64_t>[]> busy_time_usecs;
+};
+
+namespace {
+
+// Whether a pool created now collects statistics. Pools are created rarely
+// enough that the variable is read every time.
+bool StatsEnabledFromEnvironment() {
+  const char* value = std::getenv("TF_ENABLE_THREADPOOL_STATS");
+  return value != nullptr &&
+         (strcmp(value, "1") == 0 || strcmp(value, "true") == 0);
+}
+
+// The recorder of the pool the current thread belongs to, and the index of
+// the thread in that pool.
+thread_local const ThreadPoolStatsRecorder* current_thread_recorder = nullptr;
+thread_local int current_thread_index = -1;
+
+// Live pools that collect statistics.
+mutex* pools_with_stats_mu() {
+  static mutex* mu = new mutex();
+  return mu;
+}
+std::set<const ThreadPool*>* pools_with_stats() {
+  static auto* pools = new std::set<const ThreadPool*>();
+  return pools;
+}
+
+}  // namespace
+
 struct EigenEnvironment {
   typedef Thread EnvThread;
   struct TaskImpl {
     std::function<void()> f;
     Context context;
     uint64 trace_id;
+    // Only set when statistics are collected.
+    uint64 schedule_micros;
+    int scheduling_thread;
   };
   struct Task {
     std::unique_ptr<TaskImpl> f;
@@ -54,13 +127,22 @@ struct EigenEnvironment {
   Env* const env_;
   const ThreadOptions thread_options_;
   const string name_;
+  ThreadPoolStatsRecorder* const stats_;
 
   EigenEnvironment(Env* env, const ThreadOptions& thread_options,
-                   const string& name)
-      : env_(env), thread_options_(thread_options), name_(name) {}
+                   const string& name,
+                   ThreadPoolStatsRecorder* stats = nullptr)
+      : env_(env),
+        thread_options_(thread_options),
+        name_(name),
+        stats_(stats) {}
 
   EnvThread* CreateThread(std::function<void()> f) {
     return env_->StartThread(thread_options_, name_, [=]() {
+      if (stats_ != nullptr) {
+        current_thread_recorder = stats_;
+        current_thread_index = stats_->next_thread_index.fetch_add(1);
+      }
       // Set the processor flag to flush denormals to zero.
       port::ScopedFlushDenormal flush;
       // Set the processor rounding mode to ROUND TO NEAREST.
@@ -78,11 +160,22 @@ struct EigenEnvironment {
       id = tracing::GetUniqueArg();
       tracing::RecordEvent(tracing::EventCategory::kScheduleClosure, id);
     }
+    uint64 schedule_micros = 0;
+    int scheduling_thread = -1;
+    if (stats_ != nullptr) {
+      stats_->queue_depth.fetch_add(1, std::memory_order_relaxed);
+      schedule_micros = env_->NowMicros();
+      if (current_thread_recorder == stats_) {
+        scheduling_thread = current_thread_index;
+      }
+    }
     return Task{
         std::unique_ptr<TaskImpl>(new TaskImpl{
             std::move(f),
             Context(ContextKind::kThread),
             id,
+            schedule_micros,
+            scheduling_thread,
         }),
     };
   }
@@ -91,7 +184,40 @@ struct EigenEnvironment {
     WithContext wc(t.f->context);
     tracing::ScopedRegion region(tracing::EventCategory::kRunClosure,
                                  t.f->trace_id);
+    if (stats_ == nullptr) {
+      t.f->f();
+      return;
+    }
+    const uint64 start_micros = env_->NowMicros();
+    stats_->queue_depth.fetch_sub(1, std::memory_order_relaxed);
     t.f->f();
+    RecordTask(*t.f, start_micros, env_->NowMicros());
+  }
+
+  void RecordTask(const TaskImpl& task, uint64 start_micros,
+                  uint64 end_micros) {
+    constexpr auto kRelaxed = std::memory_order_relaxed;
+    const int64_t wait_usecs = start_micros - task.schedule_micros;
+    const int64_t run_usecs = end_micros - start_micros;
+    stats_->tasks_completed.fetch_add(1, kRelaxed);
+    stats_->wait_time_histogram[ThreadPoolStatsRecorder::HistogramBin(
+                                    wait_usecs)]
+        .fetch_add(1, kRelaxed);
+    stats_->run_time_histogram[ThreadPoolStatsRecorder::HistogramBin(
+                                   run_usecs)]
+        .fetch_add(1, kRelaxed);
+    stats_->total_wait_time_usecs.fetch_add(wait_usecs, kRelaxed);
+    stats_->total_run_time_usecs.fetch_add(run_usecs, kRelaxed);
+    // Eigen runs a task on the scheduling thread if the queues are full, so
+    // the task may run on a thread outside of the pool.
+    if (current_thread_recorder == stats_) {
+      stats_->busy_time_usecs[current_thread_index].fetch_add(run_usecs,
+                                                              kRelaxed);
+      if (task.scheduling_thread >= 0 &&
+          task.scheduling_thread != current_thread_index) {
+        stats_->tasks_stolen.fetch_add(1, kRelaxed);
+      }
+    }
   }
 };
 
@@ -113,12 +239,19 @@ ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
   if (num_threads < 1) num_threads = 1;
 #endif  // TENSORFLOW_THREADSCALING_EXPERIMENTAL
 
+  if (StatsEnabledFromEnvironment()) {
+    stats_ = std::make_unique<ThreadPoolStatsRecorder>(env, name, num_threads);
+  }
   eigen_threadpool_.reset(new Eigen::ThreadPoolTempl<EigenEnvironment>(
       num_threads, low_latency_hint,
-      EigenEnvironment(env, thread_options, "tf_" + name)));
+      EigenEnvironment(env, thread_options, "tf_" + name, stats_.get())));
   underlying_threadpool_ = eigen_threadpool_.get();
   threadpool_device_.reset(new Eigen::ThreadPoolDevice(underlying_threadpool_,
                                                        num_threads, allocator));
+  if (stats_ != nullptr) {
+    mutex_lock l(*pools_with_stats_mu());
+    pools_with_stats()->insert(this);
+  }
 }
 
 ThreadPool::ThreadPool(thread::ThreadPoolInterface* user_threadpool) {
@@ -127,7 +260,12 @@ ThreadPool::ThreadPool(thread::ThreadPoolInterface* user_threadpool) {
       underlying_threadpool_, underlying_threadpool_->NumThreads(), nullptr));
 }
 
-ThreadPool::~ThreadPool() {}
+ThreadPool::~ThreadPool() {
+  if (stats_ != nullptr) {
+    mutex_lock l(*pools_with_stats_mu());
+    pools_with_stats()->erase(this);
+  }
+}
 
 void ThreadPool::Schedule(std::function<void()> fn) {
   CHECK(fn != nullptr);
@@ -284,5 +422,62 @@ Eigen::ThreadPoolInterface* ThreadPool::AsEigenThreadPool() const {
   DCHECK(underlying_threadpool_ != nullptr);
   return underlying_threadpool_;
 }
+
+void ThreadPool::Stats::Add(const Stats& other) {
+  num_threads += other.num_threads;
+  queue_depth += other.queue_depth;
+  tasks_completed += other.tasks_completed;
+  tasks_stolen += other.tasks_stolen;
+  wait_time_histogram.resize(kNumHistogramBins);
+  run_time_histogram.resize(kNumHistogramBins);
+  for (int i = 0; i < kNumHistogramBins; ++i) {
+    wait_time_histogram[i] += other.wait_time_histogram[i];
+    run_time_histogram[i] += other.run_time_histogram[i];
+  }
+  total_wait_time_usecs += other.total_wait_time_usecs;
+  total_run_time_usecs += other.total_run_time_usecs;
+  busy_time_usecs_per_thread.insert(busy_time_usecs_per_thread.end(),
+                                    other.busy_time_usecs_per_thread.begin(),
+                                    other.busy_time_usecs_per_thread.end());
+  uptime_usecs = std::max(uptime_usecs, other.uptime_usecs);
+}
+
+bool ThreadPool::GetStats(Stats* stats) const {
+  if (stats_ == nullptr) return false;
+  constexpr auto kRelaxed = std::memory_order_relaxed;
+  stats->name = stats_->name;
+  stats->num_threads = stats_->num_threads;
+  stats->queue_depth = stats_->queue_depth.load(kRelaxed);
+  stats->tasks_completed = stats_->tasks_completed.load(kRelaxed);
+  stats->tasks_stolen = stats_->tasks_stolen.load(kRelaxed);
+  stats->wait_time_histogram.resize(Stats::kNumHistogramBins);
+  stats->run_time_histogram.resize(Stats::kNumHistogramBins);
+  for (int i = 0; i < Stats::kNumHistogramBins; ++i) {
+    stats->wait_time_histogram[i] =
+        stats_->wait_time_histogram[i].load(kRelaxed);
+    stats->run_time_histogram[i] =
+        stats_->run_time_histogram[i].load(kRelaxed);
+  }
+  stats->total_wait_time_usecs = stats_->total_wait_time_usecs.load(kRelaxed);
+  stats->total_run_time_usecs = stats_->total_run_time_usecs.load(kRelaxed);
+  stats->busy_time_usecs_per_thread.resize(stats_->num_threads);
+  for (int i = 0; i < stats_->num_threads; ++i) {
+    stats->busy_time_usecs_per_thread[i] =
+        stats_->busy_time_usecs[i].load(kRelaxed);
+  }
+  stats->uptime_usecs = stats_->env->NowMicros() - stats_->start_micros;
+  return true;
+}
+
+/* static */
+void ThreadPool::ForEachPoolStats(
+    const std::function<void(const Stats&)>& fn) {
+  mutex_lock l(*pools_with_stats_mu());
+  Stats stats;
+  for (const ThreadPool* pool : *pools_with_stats()) {
+    pool->GetStats(&stats);
+    fn(stats);
+  }
+}
 }  // namespace thread
 }  // namespace tsl
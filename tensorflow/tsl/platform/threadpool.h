@@ -18,6 +18,8 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "absl/types/optional.h"
 #include "tensorflow/tsl/platform/env.h"
@@ -38,6 +40,7 @@ namespace tsl {
 namespace thread {
 
 struct EigenEnvironment;
+struct ThreadPoolStatsRecorder;
 
 class ThreadPool {
  public:
@@ -99,6 +102,38 @@ class ThreadPool {
     absl::optional<int64_t> block_size_;
   };
 
+  // Execution statistics of a pool, see GetStats().
+  struct Stats {
+    // Number of bins of the histograms below. Bin 0 counts durations under
+    // 1us, bin i > 0 counts durations in [2^(i-1), 2^i) us, and the last bin
+    // also counts everything longer.
+    static constexpr int kNumHistogramBins = 32;
+
+    std::string name;
+    int num_threads = 0;
+    // Tasks that have been scheduled but have not started running yet.
+    int64_t queue_depth = 0;
+    int64_t tasks_completed = 0;
+    // Tasks that were scheduled from a thread of the pool and were run by a
+    // different thread of the pool. The scheduling thread puts such tasks into
+    // its own queue, so running them elsewhere means they were stolen.
+    int64_t tasks_stolen = 0;
+    // Time from Schedule() to the start of the task, and run time of the
+    // task, in microseconds.
+    std::vector<int64_t> wait_time_histogram;
+    std::vector<int64_t> run_time_histogram;
+    int64_t total_wait_time_usecs = 0;
+    int64_t total_run_time_usecs = 0;
+    // Time each thread of the pool spent running tasks, and the time since
+    // the pool was created; their ratio is the utilization of the thread.
+    std::vector<int64_t> busy_time_usecs_per_thread;
+    int64_t uptime_usecs = 0;
+
+    // Adds the statistics of the pool `other` to these, e.g. to report pools
+    // that have the same name together. The threads of `other` are appended.
+    void Add(const Stats& other);
+  };
+
   // Constructs a pool that contains "num_threads" threads with specified
   // "name". env->StartThread() is used to create individual threads with the
   // given ThreadOptions. If "low_latency_hint" is true the thread pool
@@ -216,6 +251,18 @@ class ThreadPool {
   // pointer points to, and should not attempt to delete.
   Eigen::ThreadPoolInterface* AsEigenThreadPool() const;
 
+  // Execution statistics are only collected for pools that own their threads
+  // and were created while the TF_ENABLE_THREADPOOL_STATS environment
+  // variable was set to "1" or "true"; collecting them costs two clock reads
+  // and a few atomic increments per task.
+  //
+  // Fills in `stats` and returns true if this pool collects statistics.
+  bool GetStats(Stats* stats) const;
+
+  // Calls `fn` with the statistics of every live pool that collects them.
+  // Pools cannot be destroyed while `fn` runs.
+  static void ForEachPoolStats(const std::function<void(const Stats&)>& fn);
+
  private:
   // Divides the work represented by the range [0, total) into k shards.
   // Calls fn(i*block_size, (i+1)*block_size) from the ith shard (0 <= i < k).
@@ -231,6 +278,9 @@ class ThreadPool {
   // underlying_threadpool_ is the user_threadpool if user_threadpool is
   // provided in the constructor. Otherwise it is the eigen_threadpool_.
   Eigen::ThreadPoolInterface* underlying_threadpool_;
+  // Null if statistics are not collected. Declared before eigen_threadpool_
+  // so that it outlives the threads, which update it.
+  std::unique_ptr<ThreadPoolStatsRecorder> stats_;
   // eigen_threadpool_ is instantiated and owned by thread::ThreadPool if
   // user_threadpool is not in the constructor.
   std::unique_ptr<Eigen::ThreadPoolTempl<EigenEnvironment>> eigen_threadpool_;
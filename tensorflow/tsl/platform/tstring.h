@@ -43,7 +43,10 @@ namespace tsl {
 // pass around existing character strings without incurring a per object heap
 // allocation.  Note that, like std::string_view, it is the user's
 // responsibility to ensure that the underlying buffer of a VIEW tstring exceeds
-// the lifetime of the associated tstring object.
+// the lifetime of the associated tstring object.  Copying or moving a VIEW (or
+// OFFSET) tstring yields another VIEW of the same buffer, so string tensors
+// whose elements are views must not be handed to arbitrary kernels (which copy
+// elements freely, e.g. Gather or Concat) unless the buffer outlives them all.
 //
 // TODO(dero): Methods for creating OFFSET tensors are not currently
 // implemented.
@@ -0,0 +1,37 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/tsl/profiler/lib/step_counter.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace tsl {
+namespace profiler {
+namespace {
+
+std::atomic<uint64_t> g_num_steps_started = ATOMIC_VAR_INIT(0);
+
+}  // namespace
+
+/*static*/ void StepCounter::StepStarted() {
+  g_num_steps_started.fetch_add(1, std::memory_order_relaxed);
+}
+
+/*static*/ uint64_t StepCounter::NumStepsStarted() {
+  return g_num_steps_started.load(std::memory_order_relaxed);
+}
+
+}  // namespace profiler
+}  // namespace tsl
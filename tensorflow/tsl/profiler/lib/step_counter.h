@@ -0,0 +1,39 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_TSL_PROFILER_LIB_STEP_COUNTER_H_
+#define TENSORFLOW_TSL_PROFILER_LIB_STEP_COUNTER_H_
+
+#include <cstdint>
+
+namespace tsl {
+namespace profiler {
+
+// Counts the steps started by the process, so that profiling sessions can
+// capture a number of steps instead of a duration. Runtimes call StepStarted()
+// once per step, i.e. per Session::Run, worker RunGraph or tf.function call.
+// This class is thread-safe.
+class StepCounter {
+ public:
+  // Records the start of a step. Cheap enough to be called unconditionally.
+  static void StepStarted();
+
+  // Returns the number of steps started so far.
+  static uint64_t NumStepsStarted();
+};
+
+}  // namespace profiler
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PROFILER_LIB_STEP_COUNTER_H_
@@ -0,0 +1,40 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/tsl/profiler/lib/step_counter.h"
+
+#include <cstdint>
+
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/platform/threadpool.h"
+
+namespace tsl {
+namespace profiler {
+namespace {
+
+TEST(StepCounterTest, CountsStepsFromAllThreads) {
+  const uint64_t start = StepCounter::NumStepsStarted();
+  {
+    thread::ThreadPool pool(Env::Default(), "steps", 4);
+    for (int i = 0; i < 100; ++i) {
+      pool.Schedule([] { StepCounter::StepStarted(); });
+    }
+  }
+  EXPECT_EQ(StepCounter::NumStepsStarted() - start, 100u);
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tsl
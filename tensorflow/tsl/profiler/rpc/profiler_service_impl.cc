@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/mutex.h"
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/profiler/lib/profiler_session.h"
+#include "tensorflow/tsl/profiler/lib/step_counter.h"
 #include "tensorflow/tsl/profiler/protobuf/profiler_service.grpc.pb.h"
 #include "tensorflow/tsl/profiler/protobuf/profiler_service.pb.h"
 #include "tensorflow/tsl/profiler/protobuf/xplane.pb.h"
@@ -85,7 +86,16 @@ class ProfilerServiceImpl : public tensorflow::grpc::ProfilerService::Service {
     Env* env = Env::Default();
     uint64 duration_ns = MilliToNano(req->opts().duration_ms());
     uint64 deadline = GetCurrentTimeNanos() + duration_ns;
-    while (GetCurrentTimeNanos() < deadline) {
+    // When a number of steps is requested, profile until the step after them
+    // starts, bounded by the duration if there is one.
+    const uint32 num_steps = req->opts().num_steps();
+    const uint64 last_step = StepCounter::NumStepsStarted() + num_steps;
+    const bool has_deadline = num_steps == 0 || duration_ns > 0;
+    while (!has_deadline || GetCurrentTimeNanos() < deadline) {
+      if (num_steps > 0 && StepCounter::NumStepsStarted() > last_step) {
+        VLOG(1) << "Profiled " << num_steps << " steps.";
+        break;
+      }
       env->SleepForMicroseconds(EnvTime::kMillisToMicros);
       if (ctx->IsCancelled()) {
         return ::grpc::Status::CANCELLED;
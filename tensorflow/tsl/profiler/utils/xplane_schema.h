@@ -59,6 +59,8 @@ TF_CONST_INIT extern const absl::string_view kPythonTracerPlaneName;
 TF_CONST_INIT extern const absl::string_view kHostCpusPlaneName;
 // Name of XPlane that contains kTrace system calls.
 TF_CONST_INIT extern const absl::string_view kSyscallsPlaneName;
+// Name of XPlane that contains thread pool statistics.
+TF_CONST_INIT extern const absl::string_view kThreadPoolsPlaneName;
 
 // Names of XLines that contain ML-level events.
 TF_CONST_INIT extern const absl::string_view kStepLineName;